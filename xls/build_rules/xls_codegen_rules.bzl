@@ -299,12 +299,16 @@ def xls_ir_verilog_impl(ctx, src):
         "clock_margin_percent",
         "period_relaxation_percent",
         "minimize_clock_on_error",
+        "retime_pipeline_registers",
         "worst_case_throughput",
+        "minimize_worst_case_throughput",
         "additional_input_delay_ps",
         "ffi_fallback_delay_ps",
         "io_constraints",
         "receives_first_sends_last",
         "mutual_exclusion_z3_rlimit",
+        "mutual_exclusion_z3_threads",
+        "mutual_exclusion_z3_time_budget_ms",
         "use_fdo",
         "fdo_iteration_number",
         "fdo_delay_driven_path_number",
@@ -315,6 +319,8 @@ def xls_ir_verilog_impl(ctx, src):
         "fdo_yosys_path",
         "fdo_sta_path",
         "fdo_synthesis_libraries",
+        "fdo_synthesis_cache_path",
+        "fdo_max_concurrent_synthesis_jobs",
     )
 
     is_args_valid(codegen_args, CODEGEN_FLAGS + SCHEDULING_FLAGS)
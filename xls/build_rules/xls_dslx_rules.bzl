@@ -107,6 +107,8 @@ def _get_dslx_test_cmdline(ctx, src, append_cmd_line_args = True):
         "disable_warnings",
         "max_ticks",
         "format_preference",
+        "quickcheck_threads",
+        "test_threads",
     )
 
     dslx_test_args = dict(_dslx_test_args)
@@ -223,6 +223,9 @@ def xls_ir_cc_library_macro(
 
     This will produce a cc_library that will execute the fn `bar` from the
     `foo` IR file. The call itself will be inside the namespace `a::b::c`.
+    The library also exposes `bar_batch`, which evaluates an array of inputs
+    in the native data layout in one call, optionally across multiple threads
+    (see xls/jit/aot_runtime.h).
 
     Args:
       name: The name of the resulting library.
@@ -260,6 +263,7 @@ def xls_ir_cc_library_macro(
         ],
         # The XLS AOT compiler does not currently support cross-compilation.
         deps = [
+            "@com_google_absl//absl/status",
             "@com_google_absl//absl/status:statusor",
             "@com_google_absl//absl/types:span",
             "//xls/ir:events",
@@ -212,6 +212,11 @@ def _optimize_ir(ctx, src):
         "opt_level",
         "convert_array_index_to_select",
         "inline_procs",
+        "function_base_parallelism",
+        "binary_output",
+        "inlining_node_budget",
+        "loop_unroll_node_budget",
+        "cache_dir",
         "top",
     )
 
@@ -290,6 +295,8 @@ def get_ir_equivalence_test_cmd(
     )
     IR_EQUIVALENCE_FLAGS = (
         "timeout",
+        "incremental",
+        "parallelism",
     )
 
     ir_equivalence_args = dict(ctx.attr.ir_equivalence_args)
@@ -346,8 +353,11 @@ def get_eval_ir_test_cmd(ctx, src, append_cmd_line_args = True):
         "optimize_ir",
         "eval_after_each_pass",
         "use_llvm_jit",
+        "use_tiered_jit",
         "test_llvm_jit",
         "llvm_opt_level",
+        "streaming_threads",
+        "streaming_chunk_size",
         "test_only_inject_jit_result",
         "dslx_path",
     )
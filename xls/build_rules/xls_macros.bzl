@@ -398,6 +398,7 @@ def xls_dslx_cpp_type_library(
             "@com_google_absl//absl/strings:str_format",
             "@com_google_absl//absl/status:statusor",
             "@com_google_absl//absl/types:span",
+            "//xls/jit:type_layout",
             "//xls/public:status_macros",
             "//xls/public:value",
         ],
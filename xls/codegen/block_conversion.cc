@@ -42,6 +42,7 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/tracing.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/node.h"
@@ -2654,6 +2655,7 @@ std::string PipelineSignalName(std::string_view root, int64_t stage) {
 absl::StatusOr<CodegenPassUnit> FunctionToPipelinedBlock(
     const PipelineSchedule& schedule, const CodegenOptions& options,
     Function* f) {
+  ScopedTraceSpan trace_span("codegen", "block_conversion");
   if (options.manual_control().has_value()) {
     return absl::UnimplementedError("Manual pipeline control not implemented");
   }
@@ -2739,6 +2741,7 @@ absl::StatusOr<CodegenPassUnit> FunctionToPipelinedBlock(
 absl::StatusOr<CodegenPassUnit> ProcToPipelinedBlock(
     const PipelineSchedule& schedule, const CodegenOptions& options,
     Proc* proc) {
+  ScopedTraceSpan trace_span("codegen", "block_conversion");
   XLS_VLOG(3) << "Converting proc to pipelined block:";
   XLS_VLOG_LINES(3, proc->DumpIr());
 
@@ -2873,6 +2876,7 @@ absl::StatusOr<CodegenPassUnit> FunctionBaseToPipelinedBlock(
 
 absl::StatusOr<CodegenPassUnit> FunctionToCombinationalBlock(
     Function* f, const CodegenOptions& options) {
+  ScopedTraceSpan trace_span("codegen", "block_conversion");
   XLS_RET_CHECK(!options.valid_control().has_value())
       << "Combinational block generator does not support valid control.";
   std::string module_name(
@@ -2916,6 +2920,7 @@ absl::StatusOr<CodegenPassUnit> FunctionToCombinationalBlock(
 
 absl::StatusOr<CodegenPassUnit> ProcToCombinationalBlock(
     Proc* proc, const CodegenOptions& options) {
+  ScopedTraceSpan trace_span("codegen", "block_conversion");
   XLS_VLOG(3) << "Converting proc to combinational block:";
   XLS_VLOG_LINES(3, proc->DumpIr());
 
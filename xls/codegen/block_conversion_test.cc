@@ -32,6 +32,7 @@
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
@@ -472,6 +473,46 @@ TEST_F(BlockConversionTest, SimplePipelinedFunction) {
                   m::Add(m::InputPort("x"), m::InputPort("y"))))))));
 }
 
+TEST_F(BlockConversionTest, ValidControlGatesPipelineRegisters) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * f, fb.BuildWithReturnValue(fb.Negate(fb.Not(fb.Add(x, y)))));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(f, TestDelayEstimator(),
+                          SchedulingOptions().pipeline_stages(3)));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      CodegenPassUnit unit,
+      FunctionToPipelinedBlock(schedule,
+                               CodegenOptions()
+                                   .flop_inputs(false)
+                                   .flop_outputs(false)
+                                   .clock_name("clk")
+                                   .valid_control("in_vld", "out_vld"),
+                               f));
+
+  // Each datapath pipeline register only loads when the data entering it is
+  // valid, so it holds its value (and doesn't toggle) across bubbles.
+  for (Register* reg : unit.block->GetRegisters()) {
+    XLS_ASSERT_OK_AND_ASSIGN(RegisterWrite * reg_write,
+                             unit.block->GetRegisterWrite(reg));
+    if (reg->name() == "p0_valid" || reg->name() == "p1_valid") {
+      EXPECT_FALSE(reg_write->load_enable().has_value()) << reg->name();
+    } else if (absl::StartsWith(reg->name(), "p0_")) {
+      ASSERT_TRUE(reg_write->load_enable().has_value()) << reg->name();
+      EXPECT_THAT(*reg_write->load_enable(), m::InputPort("in_vld"));
+    } else {
+      ASSERT_TRUE(reg_write->load_enable().has_value()) << reg->name();
+      EXPECT_THAT(*reg_write->load_enable(), m::RegisterRead("p0_valid"));
+    }
+  }
+}
+
 TEST_F(BlockConversionTest, TrivialPipelinedFunction) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
@@ -15,15 +15,22 @@
 #include "xls/codegen/block_generator.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <deque>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <thread>  // NOLINT(build/c++11)
 #include <variant>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/codegen/block_conversion.h"
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/flattening.h"
@@ -33,9 +40,12 @@
 #include "xls/codegen/vast.h"
 #include "xls/codegen/verilog_line_map.pb.h"
 #include "xls/common/logging/log_lines.h"
+#include "xls/common/thread.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
 #include "xls/ir/block.h"
 #include "xls/ir/instantiation.h"
 #include "xls/ir/node_iterator.h"
@@ -46,6 +56,20 @@ namespace xls {
 namespace verilog {
 namespace {
 
+// Name of the clock port of generated FIFO modules.
+constexpr std::string_view kFifoClockPortName = "clk";
+
+// Returns the name of the generated Verilog module implementing the given FIFO
+// instantiation. FIFO instantiations with the same configuration and data width
+// share a module.
+std::string FifoModuleName(FifoInstantiation* instantiation) {
+  const FifoConfig& config = instantiation->fifo_config();
+  return absl::StrFormat(
+      "xls_fifo_w%d_d%d%s%s", instantiation->data_type()->GetFlatBitCount(),
+      config.depth, config.bypass ? "_bypass" : "",
+      config.register_push_outputs ? "_regpush" : "");
+}
+
 // Returns true if the given type is representable in the Verilog.
 bool IsRepresentable(Type* type) {
   return !TypeHasToken(type) && type->GetFlatBitCount() > 0;
@@ -741,6 +765,20 @@ class BlockGenerator {
                 ->ForeignFunctionData()
                 ->code_template(),
             connections);
+      } else if (xls::FifoInstantiation* fifo_instantiation =
+                     dynamic_cast<FifoInstantiation*>(instantiation)) {
+        if (mb_.clock() == nullptr) {
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "FIFO instantiation `%s` requires a clock but the instantiating "
+              "block has no clock.",
+              fifo_instantiation->name()));
+        }
+        connections.push_back(
+            Connection{std::string{kFifoClockPortName}, mb_.clock()});
+        mb_.instantiation_section()->Add<Instantiation>(
+            SourceInfo(), FifoModuleName(fifo_instantiation),
+            fifo_instantiation->name(),
+            /*parameters=*/std::vector<Connection>(), connections);
       }
     }
     return absl::OkStatus();
@@ -761,6 +799,193 @@ class BlockGenerator {
   absl::flat_hash_map<xls::Register*, ModuleBuilder::Register> mb_registers_;
 };
 
+// Generates the module implementing the given FIFO instantiation into `file`.
+// The FIFO is a circular buffer of `depth` entries addressed by head (pop) and
+// tail (push) pointers. A push and a pop may occur in the same cycle so the
+// FIFO sustains one transfer per cycle. With bypass enabled, data pushed into
+// an empty FIFO is forwarded to the pop side combinationally.
+absl::Status GenerateFifoModule(FifoInstantiation* instantiation,
+                                const CodegenOptions& options,
+                                VerilogFile* file) {
+  const FifoConfig& config = instantiation->fifo_config();
+  int64_t data_width = instantiation->data_type()->GetFlatBitCount();
+  if (data_width == 0) {
+    return absl::UnimplementedError(absl::StrFormat(
+        "FIFO instantiation `%s` has zero-width data type %s which is not "
+        "supported in code generation",
+        instantiation->name(), instantiation->data_type()->ToString()));
+  }
+  ResetProto reset_proto;
+  reset_proto.set_name(std::string{FifoInstantiation::kResetPortName});
+  reset_proto.set_asynchronous(false);
+  reset_proto.set_active_low(false);
+  ModuleBuilder mb(FifoModuleName(instantiation), file, options,
+                   kFifoClockPortName, reset_proto);
+  SourceInfo loc;
+
+  LogicRef* push_data =
+      mb.AddInputPort(FifoInstantiation::kPushDataPortName, data_width);
+  LogicRef* push_valid =
+      mb.AddInputPort(FifoInstantiation::kPushValidPortName, 1);
+  LogicRef* pop_ready =
+      mb.AddInputPort(FifoInstantiation::kPopReadyPortName, 1);
+
+  if (config.depth == 0) {
+    XLS_RETURN_IF_ERROR(
+        mb.AddOutputPort(FifoInstantiation::kPushReadyPortName, 1, pop_ready));
+    XLS_RETURN_IF_ERROR(mb.AddOutputPort(FifoInstantiation::kPopDataPortName,
+                                         data_width, push_data));
+    return mb.AddOutputPort(FifoInstantiation::kPopValidPortName, 1,
+                            push_valid);
+  }
+
+  auto wire = [&](std::string_view name, int64_t bit_count,
+                  Expression* value) -> LogicRef* {
+    LogicRef* ref = mb.DeclareVariable(name, bit_count);
+    mb.assignment_section()->Add<ContinuousAssignment>(loc, ref, value);
+    return ref;
+  };
+
+  int64_t ptr_width = std::max(int64_t{1}, CeilOfLog2(config.depth));
+  int64_t count_width = Bits::MinBitCountUnsigned(config.depth);
+  LogicRef* head_next = mb.DeclareVariable("head_next", ptr_width);
+  LogicRef* tail_next = mb.DeclareVariable("tail_next", ptr_width);
+  LogicRef* count_next = mb.DeclareVariable("count_next", count_width);
+  XLS_ASSIGN_OR_RETURN(
+      ModuleBuilder::Register head,
+      mb.DeclareRegister("head", ptr_width, head_next,
+                         file->Literal(0, ptr_width, loc)));
+  XLS_ASSIGN_OR_RETURN(
+      ModuleBuilder::Register tail,
+      mb.DeclareRegister("tail", ptr_width, tail_next,
+                         file->Literal(0, ptr_width, loc)));
+  XLS_ASSIGN_OR_RETURN(
+      ModuleBuilder::Register count,
+      mb.DeclareRegister("count", count_width, count_next,
+                         file->Literal(0, count_width, loc)));
+
+  LogicRef* empty = wire(
+      "empty", 1,
+      file->Equals(count.ref, file->Literal(0, count_width, loc), loc));
+  LogicRef* full = wire(
+      "full", 1,
+      file->Equals(count.ref, file->Literal(config.depth, count_width, loc),
+                   loc));
+
+  // Entry storage. Entries are not reset; `count` guards reads of entries
+  // which have not been written.
+  std::vector<ModuleBuilder::Register> entries;
+  for (int64_t i = 0; i < config.depth; ++i) {
+    XLS_ASSIGN_OR_RETURN(
+        ModuleBuilder::Register entry,
+        mb.DeclareRegister(absl::StrFormat("entry_%d", i), data_width,
+                           push_data));
+    entries.push_back(entry);
+  }
+  Expression* head_entry = entries.back().ref;
+  for (int64_t i = config.depth - 2; i >= 0; --i) {
+    head_entry = file->Ternary(
+        file->Equals(head.ref, file->Literal(i, ptr_width, loc), loc),
+        entries[i].ref, head_entry, loc);
+  }
+
+  Expression* pop_valid_expr = file->LogicalNot(empty, loc);
+  Expression* pop_data_expr = head_entry;
+  if (config.bypass) {
+    pop_valid_expr = file->LogicalOr(pop_valid_expr, push_valid, loc);
+    pop_data_expr = file->Ternary(empty, push_data, head_entry, loc);
+  }
+  // Without registered push outputs a full FIFO accepts a push in a cycle in
+  // which an entry is popped.
+  Expression* push_ready_expr = file->LogicalNot(full, loc);
+  if (!config.register_push_outputs) {
+    push_ready_expr = file->LogicalOr(push_ready_expr, pop_ready, loc);
+  }
+  LogicRef* pop_valid = wire("pop_valid_int", 1, pop_valid_expr);
+  LogicRef* push_ready = wire("push_ready_int", 1, push_ready_expr);
+  LogicRef* push_fire =
+      wire("push_fire", 1, file->LogicalAnd(push_valid, push_ready, loc));
+  LogicRef* pop_fire =
+      wire("pop_fire", 1, file->LogicalAnd(pop_valid, pop_ready, loc));
+
+  // A bypassed transfer passes through the FIFO without being stored.
+  Expression* do_push = push_fire;
+  Expression* do_pop = pop_fire;
+  if (config.bypass) {
+    LogicRef* bypassed = wire(
+        "bypassed", 1,
+        file->LogicalAnd(empty, file->LogicalAnd(push_fire, pop_fire, loc),
+                         loc));
+    do_push = wire("do_push", 1,
+                   file->LogicalAnd(push_fire, file->LogicalNot(bypassed, loc),
+                                    loc));
+    do_pop = wire(
+        "do_pop", 1,
+        file->LogicalAnd(pop_fire, file->LogicalNot(bypassed, loc), loc));
+  }
+
+  auto increment = [&](LogicRef* ptr) -> Expression* {
+    return file->Ternary(
+        file->Equals(ptr, file->Literal(config.depth - 1, ptr_width, loc),
+                     loc),
+        file->Literal(0, ptr_width, loc),
+        file->Add(ptr, file->Literal(1, ptr_width, loc), loc), loc);
+  };
+  mb.assignment_section()->Add<ContinuousAssignment>(
+      loc, head_next,
+      file->Ternary(do_pop, increment(head.ref), head.ref, loc));
+  mb.assignment_section()->Add<ContinuousAssignment>(
+      loc, tail_next,
+      file->Ternary(do_push, increment(tail.ref), tail.ref, loc));
+  Expression* one = file->Literal(1, count_width, loc);
+  mb.assignment_section()->Add<ContinuousAssignment>(
+      loc, count_next,
+      file->Ternary(
+          file->LogicalAnd(do_push, file->LogicalNot(do_pop, loc), loc),
+          file->Add(count.ref, one, loc),
+          file->Ternary(
+              file->LogicalAnd(do_pop, file->LogicalNot(do_push, loc), loc),
+              file->Sub(count.ref, one, loc), count.ref, loc),
+          loc));
+  for (int64_t i = 0; i < config.depth; ++i) {
+    entries[i].load_enable = file->LogicalAnd(
+        do_push, file->Equals(tail.ref, file->Literal(i, ptr_width, loc), loc),
+        loc);
+  }
+
+  XLS_RETURN_IF_ERROR(mb.AssignRegisters({head, tail, count}));
+  XLS_RETURN_IF_ERROR(mb.AssignRegisters(entries));
+
+  XLS_RETURN_IF_ERROR(
+      mb.AddOutputPort(FifoInstantiation::kPushReadyPortName, 1, push_ready));
+  XLS_RETURN_IF_ERROR(mb.AddOutputPort(FifoInstantiation::kPopDataPortName,
+                                       data_width, pop_data_expr));
+  return mb.AddOutputPort(FifoInstantiation::kPopValidPortName, 1, pop_valid);
+}
+
+// Generates a module for each distinct FIFO configuration instantiated by the
+// given blocks. Each module is generated into its own VerilogFile.
+absl::StatusOr<std::vector<std::unique_ptr<VerilogFile>>> GenerateFifoFiles(
+    absl::Span<Block* const> blocks, const CodegenOptions& options,
+    FileType file_type) {
+  std::vector<std::unique_ptr<VerilogFile>> files;
+  absl::flat_hash_set<std::string> generated;
+  for (Block* block : blocks) {
+    for (xls::Instantiation* instantiation : block->GetInstantiations()) {
+      auto* fifo_instantiation =
+          dynamic_cast<FifoInstantiation*>(instantiation);
+      if (fifo_instantiation == nullptr ||
+          !generated.insert(FifoModuleName(fifo_instantiation)).second) {
+        continue;
+      }
+      files.push_back(std::make_unique<VerilogFile>(file_type));
+      XLS_RETURN_IF_ERROR(
+          GenerateFifoModule(fifo_instantiation, options, files.back().get()));
+    }
+  }
+  return files;
+}
+
 // Recursive visitor of blocks in a DFS order. Edges are block instantiations.
 // Visited blocks are collected into `post_order` in a DFS post-order.
 absl::Status DfsVisitBlocks(Block* block, absl::flat_hash_set<Block*>& visited,
@@ -776,8 +1001,9 @@ absl::Status DfsVisitBlocks(Block* block, absl::flat_hash_set<Block*>& visited,
           block_instantiation->instantiated_block(), visited, post_order));
       continue;
     }
-    if (instantiation->kind() == InstantiationKind::kExtern) {
-      // An external block is a leaf from our perspective.
+    if (instantiation->kind() == InstantiationKind::kExtern ||
+        instantiation->kind() == InstantiationKind::kFifo) {
+      // External blocks and FIFOs are leaves from our perspective.
       continue;
     }
 
@@ -799,11 +1025,53 @@ absl::StatusOr<std::vector<Block*>> GatherInstantiatedBlocks(Block* top) {
   return blocks;
 }
 
+// Generates each of the given blocks into its own VerilogFile. Generating a
+// block only reads the IR, and the VAST nodes of each block are owned by its
+// own file, so the blocks are generated concurrently. Errors are reported for
+// the first failing block in the given order.
+absl::StatusOr<std::vector<std::unique_ptr<VerilogFile>>> GenerateBlockFiles(
+    absl::Span<Block* const> blocks, const CodegenOptions& options,
+    FileType file_type) {
+  std::vector<std::unique_ptr<VerilogFile>> files;
+  files.reserve(blocks.size());
+  for (int64_t i = 0; i < blocks.size(); ++i) {
+    files.push_back(std::make_unique<VerilogFile>(file_type));
+  }
+  std::vector<absl::Status> statuses(blocks.size());
+  std::atomic<int64_t> next_block = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_block++; i < blocks.size(); i = next_block++) {
+      statuses[i] =
+          BlockGenerator::Generate(blocks[i], files[i].get(), options);
+    }
+  };
+  int64_t worker_count = std::min(
+      static_cast<int64_t>(blocks.size()),
+      std::max(int64_t{1},
+               static_cast<int64_t>(std::thread::hardware_concurrency())));
+  if (worker_count <= 1) {
+    worker();
+  } else {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(worker_count);
+    for (int64_t t = 0; t < worker_count; ++t) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return files;
+}
+
 }  // namespace
 
-absl::StatusOr<std::string> GenerateVerilog(Block* top,
-                                            const CodegenOptions& options,
-                                            VerilogLineMap* verilog_line_map) {
+absl::Status GenerateVerilog(Block* top, const CodegenOptions& options,
+                             VastStream* out,
+                             const VerilogLineMappingSink& line_mapping_sink) {
   XLS_VLOG(2) << absl::StreamFormat(
       "Generating Verilog for packge with with top level block `%s`:",
       top->name());
@@ -811,42 +1079,73 @@ absl::StatusOr<std::string> GenerateVerilog(Block* top,
 
   XLS_ASSIGN_OR_RETURN(std::vector<Block*> blocks,
                        GatherInstantiatedBlocks(top));
-  VerilogFile file(options.use_system_verilog() ? FileType::kSystemVerilog
-                                                : FileType::kVerilog);
-  for (Block* block : blocks) {
-    XLS_RETURN_IF_ERROR(BlockGenerator::Generate(block, &file, options));
-    if (block != blocks.back()) {
+  FileType file_type = options.use_system_verilog() ? FileType::kSystemVerilog
+                                                    : FileType::kVerilog;
+  XLS_ASSIGN_OR_RETURN(std::vector<std::unique_ptr<VerilogFile>> block_files,
+                       GenerateFifoFiles(blocks, options, file_type));
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<std::unique_ptr<VerilogFile>> generated_block_files,
+      GenerateBlockFiles(blocks, options, file_type));
+  for (std::unique_ptr<VerilogFile>& block_file : generated_block_files) {
+    block_files.push_back(std::move(block_file));
+  }
+
+  // Merge the per-block files in DFS post order so that instantiated blocks
+  // are defined before their instantiating blocks. FIFO modules, which
+  // instantiate nothing, come first. The merged file refers to nodes owned by
+  // `block_files` which must outlive the emission below.
+  VerilogFile file(file_type);
+  for (int64_t i = 0; i < block_files.size(); ++i) {
+    for (const FileMember& member : block_files[i]->members()) {
+      file.Add(member);
+    }
+    if (i + 1 < block_files.size()) {
       file.Add(file.Make<BlankLine>(SourceInfo()));
       file.Add(file.Make<BlankLine>(SourceInfo()));
     }
   }
 
-  LineInfo line_info;
-  std::string text = file.Emit(&line_info);
-  if (verilog_line_map != nullptr) {
-    for (const auto& [vast_node, partial_spans] : line_info.Spans()) {
-      std::optional<std::vector<LineSpan>> spans =
-          line_info.LookupNode(vast_node);
-      if (!spans.has_value()) {
-        return absl::InternalError(
-            "Unbalanced calls to LineInfo::{Start, End}");
-      }
-      for (const LineSpan& span : spans.value()) {
-        SourceInfo info = vast_node->loc();
-        for (const SourceLocation& loc : info.locations) {
-          int64_t line = static_cast<int32_t>(loc.lineno());
-          VerilogLineMapping* mapping = verilog_line_map->add_mapping();
-          mapping->set_source_file(
-              top->package()->GetFilename(loc.fileno()).value_or(""));
-          mapping->mutable_source_span()->set_line_start(line);
-          mapping->mutable_source_span()->set_line_end(line);
-          mapping->set_verilog_file("");  // to be updated later on
-          mapping->mutable_verilog_span()->set_line_start(span.StartLine());
-          mapping->mutable_verilog_span()->set_line_end(span.EndLine());
-        }
-      }
+  if (line_mapping_sink == nullptr) {
+    file.EmitTo(out);
+    return absl::OkStatus();
+  }
+
+  // Only nodes with source locations produce mappings. Spans are reported as
+  // they complete so the LineInfo holds just the currently open nodes.
+  VerilogLineMapping mapping;
+  LineInfo line_info([&](const VastNode* vast_node, const LineSpan& span) {
+    for (const SourceLocation& loc : vast_node->loc().locations) {
+      int64_t line = static_cast<int32_t>(loc.lineno());
+      mapping.set_source_file(
+          top->package()->GetFilename(loc.fileno()).value_or(""));
+      mapping.mutable_source_span()->set_line_start(line);
+      mapping.mutable_source_span()->set_line_end(line);
+      mapping.set_verilog_file("");  // to be updated later on
+      mapping.mutable_verilog_span()->set_line_start(span.StartLine());
+      mapping.mutable_verilog_span()->set_line_end(span.EndLine());
+      line_mapping_sink(mapping);
     }
+  });
+  file.EmitTo(out, &line_info);
+  if (!line_info.Spans().empty()) {
+    return absl::InternalError("Unbalanced calls to LineInfo::{Start, End}");
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::string> GenerateVerilog(Block* top,
+                                            const CodegenOptions& options,
+                                            VerilogLineMap* verilog_line_map) {
+  std::string text;
+  VastStream out(
+      [&](std::string_view chunk) { absl::StrAppend(&text, chunk); });
+  VerilogLineMappingSink line_mapping_sink;
+  if (verilog_line_map != nullptr) {
+    line_mapping_sink = [&](const VerilogLineMapping& mapping) {
+      *verilog_line_map->add_mapping() = mapping;
+    };
   }
+  XLS_RETURN_IF_ERROR(GenerateVerilog(top, options, &out, line_mapping_sink));
 
   XLS_VLOG(2) << "Verilog output:";
   XLS_VLOG_LINES(2, text);
@@ -15,10 +15,13 @@
 #ifndef XLS_CODEGEN_BLOCK_GENERATOR_H_
 #define XLS_CODEGEN_BLOCK_GENERATOR_H_
 
+#include <functional>
 #include <string>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/codegen/codegen_options.h"
+#include "xls/codegen/vast.h"
 #include "xls/codegen/verilog_line_map.pb.h"
 #include "xls/ir/block.h"
 
@@ -32,6 +35,18 @@ absl::StatusOr<std::string> GenerateVerilog(
     Block* top, const CodegenOptions& options,
     VerilogLineMap* verilog_line_map = nullptr);
 
+// Callback receiving line mappings as they are produced.
+using VerilogLineMappingSink = std::function<void(const VerilogLineMapping&)>;
+
+// Streaming variant of GenerateVerilog. The text is written to `out` as it is
+// emitted and, if `line_mapping_sink` is non-null, each line mapping is passed
+// to it as soon as the span of the corresponding VAST node is complete. Neither
+// the text nor the line map of the whole design is held in memory. The
+// `verilog_file` field of the mappings is left empty.
+absl::Status GenerateVerilog(Block* top, const CodegenOptions& options,
+                             VastStream* out,
+                             const VerilogLineMappingSink& line_mapping_sink);
+
 }  // namespace verilog
 }  // namespace xls
 
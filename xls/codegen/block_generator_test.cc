@@ -17,18 +17,23 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "xls/codegen/block_conversion.h"
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/codegen_pass.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/op_override_impls.h"
 #include "xls/codegen/signature_generator.h"
+#include "xls/codegen/vast.h"
+#include "xls/codegen/verilog_line_map.pb.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
@@ -38,9 +43,11 @@
 #include "xls/ir/block.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/function_builder.h"
+#include "xls/ir/instantiation.h"
 #include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/register.h"
+#include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/scheduling/pipeline_schedule.h"
@@ -53,6 +60,7 @@ namespace xls {
 namespace verilog {
 namespace {
 
+using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
 using ::testing::HasSubstr;
 
@@ -95,6 +103,33 @@ class BlockGeneratorTest : public VerilogTestBase {
     return bb.Build();
   }
 
+  // Make and return a block which passes a u32 ready/valid stream through a
+  // FIFO with the given configuration. The stream enters on `in`/`in_vld`/
+  // `in_rdy` and leaves on `out`/`out_vld`/`out_rdy`.
+  absl::StatusOr<Block*> MakeFifoBlock(std::string_view name,
+                                       const FifoConfig& config,
+                                       Package* package) {
+    Type* u1 = package->GetBitsType(1);
+    Type* u32 = package->GetBitsType(32);
+    BlockBuilder bb(name, package);
+    XLS_RETURN_IF_ERROR(bb.block()->AddClockPort("clk"));
+    BValue rst = bb.InputPort("rst", u1);
+    BValue in = bb.InputPort("in", u32);
+    BValue in_vld = bb.InputPort("in_vld", u1);
+    BValue out_rdy = bb.InputPort("out_rdy", u1);
+    XLS_ASSIGN_OR_RETURN(
+        FifoInstantiation * fifo,
+        bb.block()->AddFifoInstantiation("fifo", config, u32));
+    bb.InstantiationInput(fifo, "rst", rst);
+    bb.InstantiationInput(fifo, "push_data", in);
+    bb.InstantiationInput(fifo, "push_valid", in_vld);
+    bb.InstantiationInput(fifo, "pop_ready", out_rdy);
+    bb.OutputPort("out", bb.InstantiationOutput(fifo, "pop_data"));
+    bb.OutputPort("out_vld", bb.InstantiationOutput(fifo, "pop_valid"));
+    bb.OutputPort("in_rdy", bb.InstantiationOutput(fifo, "push_ready"));
+    return bb.Build();
+  }
+
   // Make and return a block which instantiates the given block. Given block
   // should take two u32s (`a` and `b`) and return a u32 (`result`).
   absl::StatusOr<Block*> MakeDelegatingBlock(std::string_view name,
@@ -149,6 +184,44 @@ TEST_P(BlockGeneratorTest, AandB) {
   XLS_ASSERT_OK(tb.Run());
 }
 
+TEST_P(BlockGeneratorTest, StreamingLineMap) {
+  Package package(TestBaseName());
+
+  Type* u32 = package.GetBitsType(32);
+  BlockBuilder bb(TestBaseName(), &package);
+  BValue a = bb.InputPort("a", u32);
+  BValue b = bb.InputPort("b", u32);
+  SourceInfo loc(package.AddSourceLocation("foo.x", Lineno(42), Colno(1)));
+  bb.OutputPort("sum", bb.And(a, b, loc));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  VerilogLineMap line_map;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string verilog,
+      GenerateVerilog(block, codegen_options(), &line_map));
+
+  std::string streamed_verilog;
+  std::vector<VerilogLineMapping> streamed_mappings;
+  VastStream out([&](std::string_view text) {
+    absl::StrAppend(&streamed_verilog, text);
+  });
+  XLS_ASSERT_OK(GenerateVerilog(block, codegen_options(), &out,
+                                [&](const VerilogLineMapping& mapping) {
+                                  streamed_mappings.push_back(mapping);
+                                }));
+
+  EXPECT_EQ(streamed_verilog, verilog);
+  ASSERT_GT(line_map.mapping_size(), 0);
+  ASSERT_EQ(streamed_mappings.size(), line_map.mapping_size());
+  for (int64_t i = 0; i < line_map.mapping_size(); ++i) {
+    const VerilogLineMapping& mapping = line_map.mapping(i);
+    EXPECT_EQ(mapping.source_file(), "foo.x");
+    EXPECT_EQ(mapping.source_span().line_start(), 42);
+    EXPECT_EQ(streamed_mappings[i].SerializeAsString(),
+              mapping.SerializeAsString());
+  }
+}
+
 TEST_P(BlockGeneratorTest, PipelinedAandB) {
   Package package(TestBaseName());
 
@@ -821,6 +894,108 @@ TEST_P(BlockGeneratorTest, InstantiatedBlockWithClockButNoClock) {
                                  "the instantiating block has no clock.")));
 }
 
+TEST_P(BlockGeneratorTest, FifoInstantiationSustainsFullThroughput) {
+  for (bool bypass : {false, true}) {
+    Package package(TestBaseName());
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Block * block,
+        MakeFifoBlock("my_block",
+                      FifoConfig{.depth = 2,
+                                 .bypass = bypass,
+                                 .register_push_outputs = false},
+                      &package));
+    XLS_ASSERT_OK_AND_ASSIGN(std::string verilog,
+                             GenerateVerilog(block, codegen_options()));
+    XLS_ASSERT_OK_AND_ASSIGN(ModuleSignature sig,
+                             GenerateSignature(codegen_options("clk"), block));
+
+    ModuleTestbench tb = NewModuleTestbench(verilog, sig);
+    XLS_ASSERT_OK_AND_ASSIGN(ModuleTestbenchThread * tbt, tb.CreateThread());
+    tbt->Set("rst", 1).Set("in", 0).Set("in_vld", 0).Set("out_rdy", 0);
+    tbt->NextCycle();
+    tbt->Set("rst", 0).Set("in_vld", 1).Set("out_rdy", 1);
+
+    // With the consumer always ready the FIFO accepts and delivers one value
+    // every cycle. Without bypass each value is delivered the cycle after it
+    // is pushed.
+    for (int64_t i = 0; i < 8; ++i) {
+      tbt->Set("in", 100 + i);
+      EndOfCycleEvent& event = tbt->AtEndOfCycle();
+      event.ExpectEq("in_rdy", 1);
+      if (bypass) {
+        event.ExpectEq("out_vld", 1).ExpectEq("out", 100 + i);
+      } else if (i == 0) {
+        event.ExpectEq("out_vld", 0);
+      } else {
+        event.ExpectEq("out_vld", 1).ExpectEq("out", 100 + i - 1);
+      }
+    }
+    XLS_ASSERT_OK(tb.Run());
+  }
+}
+
+TEST_P(BlockGeneratorTest, FifoInstantiationBackpressure) {
+  Package package(TestBaseName());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Block * block,
+      MakeFifoBlock("my_block",
+                    FifoConfig{.depth = 3,
+                               .bypass = false,
+                               .register_push_outputs = true},
+                    &package));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string verilog,
+                           GenerateVerilog(block, codegen_options()));
+  EXPECT_THAT(verilog, HasSubstr("xls_fifo_w32_d3_regpush fifo ("));
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleSignature sig,
+                           GenerateSignature(codegen_options("clk"), block));
+
+  ModuleTestbench tb = NewModuleTestbench(verilog, sig);
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleTestbenchThread * tbt, tb.CreateThread());
+  tbt->Set("rst", 1).Set("in", 0).Set("in_vld", 0).Set("out_rdy", 0);
+  tbt->NextCycle();
+
+  // Fill the FIFO while the consumer is stalled.
+  tbt->Set("rst", 0).Set("in_vld", 1);
+  for (int64_t i = 0; i < 3; ++i) {
+    tbt->Set("in", 42 + i);
+    tbt->AtEndOfCycle().ExpectEq("in_rdy", 1);
+  }
+  tbt->Set("in", 1000);
+  tbt->AtEndOfCycle().ExpectEq("in_rdy", 0).ExpectEq("out_vld", 1).ExpectEq(
+      "out", 42);
+
+  // Drain the FIFO in order.
+  tbt->Set("in_vld", 0).Set("out_rdy", 1);
+  for (int64_t i = 0; i < 3; ++i) {
+    tbt->AtEndOfCycle().ExpectEq("out_vld", 1).ExpectEq("out", 42 + i);
+  }
+  tbt->AtEndOfCycle().ExpectEq("out_vld", 0).ExpectEq("in_rdy", 1);
+  XLS_ASSERT_OK(tb.Run());
+}
+
+TEST_P(BlockGeneratorTest, FifoInstantiationWithoutClock) {
+  Package package(TestBaseName());
+  Type* u1 = package.GetBitsType(1);
+  Type* u32 = package.GetBitsType(32);
+  BlockBuilder bb("my_block", &package);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      FifoInstantiation * fifo,
+      bb.block()->AddFifoInstantiation(
+          "fifo",
+          FifoConfig{
+              .depth = 1, .bypass = false, .register_push_outputs = false},
+          u32));
+  bb.InstantiationInput(fifo, "rst", bb.InputPort("rst", u1));
+  bb.InstantiationInput(fifo, "push_data", bb.InputPort("in", u32));
+  bb.InstantiationInput(fifo, "push_valid", bb.InputPort("in_vld", u1));
+  bb.InstantiationInput(fifo, "pop_ready", bb.InputPort("out_rdy", u1));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  EXPECT_THAT(GenerateVerilog(block, codegen_options()).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("requires a clock")));
+}
+
 TEST_P(BlockGeneratorTest, InstantiatedBlockWithClock) {
   Package package(TestBaseName());
   Type* u32 = package.GetBitsType(32);
@@ -939,6 +1114,36 @@ TEST_P(BlockGeneratorTest, MultiplyInstantiatedBlock) {
   XLS_ASSERT_OK(tb.Run());
 }
 
+TEST_P(BlockGeneratorTest, ManyInstantiatedBlocksEmittedInPostOrder) {
+  // Blocks are generated concurrently; the modules must still be emitted in
+  // DFS post order and the output must be identical across runs.
+  Package package(TestBaseName());
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block,
+                           MakeSubtractBlock("subtractor", &package));
+  std::vector<std::string> module_names = {"subtractor"};
+  for (int64_t i = 0; i < 8; ++i) {
+    std::string name = absl::StrFormat("delegator%d", i);
+    XLS_ASSERT_OK_AND_ASSIGN(block,
+                             MakeDelegatingBlock(name, block, &package));
+    module_names.push_back(name);
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string verilog,
+                           GenerateVerilog(block, codegen_options()));
+  int64_t previous_position = -1;
+  for (const std::string& name : module_names) {
+    size_t position = verilog.find(absl::StrCat("module ", name, "("));
+    ASSERT_NE(position, std::string::npos) << name;
+    EXPECT_GT(static_cast<int64_t>(position), previous_position) << name;
+    previous_position = position;
+  }
+
+  for (int64_t i = 0; i < 4; ++i) {
+    EXPECT_THAT(GenerateVerilog(block, codegen_options()),
+                IsOkAndHolds(verilog));
+  }
+}
+
 TEST_P(BlockGeneratorTest, DiamondDependencyInstantiations) {
   Package package(TestBaseName());
   Type* u32 = package.GetBitsType(32);
@@ -15,11 +15,16 @@
 #include "xls/codegen/block_metrics.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/codegen/xls_metrics.pb.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/block.h"
@@ -63,9 +68,126 @@ bool HasFeedthroughPass(Block* block) {
   return false;
 }
 
-// Sets the delay fields of `proto` based on analysis of `block`.
-absl::Status SetDelayFields(Block* block, const DelayEstimator& delay_estimator,
-                            BlockMetricsProto* proto) {
+// Returns the delay of `node` according to `delay_estimator`, or zero if the
+// delay can't be estimated.
+int64_t GetNodeDelay(Node* node, const DelayEstimator* delay_estimator) {
+  if (delay_estimator == nullptr) {
+    return 0;
+  }
+  absl::StatusOr<int64_t> node_delay_or =
+      delay_estimator->GetOperationDelayInPs(node);
+  return node_delay_or.ok() ? node_delay_or.value() : 0;
+}
+
+// Adds an entry to `proto` for every pair of input and output ports connected
+// by a combinational path. The path delays are only set if `delay_estimator`
+// is non-null.
+void SetFeedthroughPaths(Block* block, const DelayEstimator* delay_estimator,
+                         BlockMetricsProto* proto) {
+  // Maximum delay from each input port with a combinational path to each node.
+  absl::flat_hash_map<Node*, absl::flat_hash_map<InputPort*, int64_t>>
+      input_delays;
+  std::vector<FeedthroughPathProto> paths;
+  for (Node* node : TopoSort(block)) {
+    if (node->Is<InputPort>()) {
+      input_delays[node][node->As<InputPort>()] = 0;
+      continue;
+    }
+    if (node->Is<OutputPort>()) {
+      auto it = input_delays.find(node->operand(0));
+      if (it == input_delays.end() ||
+          node->operand(0)->GetType()->GetFlatBitCount() == 0) {
+        continue;
+      }
+      for (const auto& [input_port, delay] : it->second) {
+        FeedthroughPathProto& path = paths.emplace_back();
+        path.set_input_port(input_port->GetName());
+        path.set_output_port(node->GetName());
+        if (delay_estimator != nullptr) {
+          path.set_delay_ps(delay);
+        }
+      }
+      continue;
+    }
+    int64_t node_delay = GetNodeDelay(node, delay_estimator);
+    absl::flat_hash_map<InputPort*, int64_t> node_input_delays;
+    for (Node* operand : node->operands()) {
+      auto it = input_delays.find(operand);
+      if (it == input_delays.end() ||
+          operand->GetType()->GetFlatBitCount() == 0) {
+        continue;
+      }
+      for (const auto& [input_port, delay] : it->second) {
+        int64_t& max_delay = node_input_delays[input_port];
+        max_delay = std::max(max_delay, delay + node_delay);
+      }
+    }
+    if (!node_input_delays.empty()) {
+      input_delays[node] = std::move(node_input_delays);
+    }
+  }
+
+  std::sort(paths.begin(), paths.end(),
+            [](const FeedthroughPathProto& a, const FeedthroughPathProto& b) {
+              return std::make_pair(a.output_port(), a.input_port()) <
+                     std::make_pair(b.output_port(), b.input_port());
+            });
+  for (FeedthroughPathProto& path : paths) {
+    *proto->add_feedthrough_paths() = std::move(path);
+  }
+}
+
+// Sets the fanout fields of `proto`.
+void SetFanoutFields(Block* block, BlockMetricsProto* proto) {
+  int64_t node_count = 0;
+  int64_t total_fanout = 0;
+  int64_t max_fanout = 0;
+  for (Node* node : block->nodes()) {
+    if (node->GetType()->GetFlatBitCount() == 0) {
+      continue;
+    }
+    int64_t fanout = node->users().size();
+    ++node_count;
+    total_fanout += fanout;
+    max_fanout = std::max(max_fanout, fanout);
+  }
+  proto->set_max_fanout(max_fanout);
+  proto->set_average_fanout(
+      node_count == 0 ? 0.0
+                      : static_cast<double>(total_fanout) / node_count);
+}
+
+// Sets the per-stage pipeline register fields of `proto`. `register_delays`
+// holds the maximum delay of any path ending at each register, if known.
+void SetPipelineStageFields(
+    absl::Span<const std::vector<Register*>> pipeline_stage_registers,
+    const absl::flat_hash_map<Register*, int64_t>* register_delays,
+    BlockMetricsProto* proto) {
+  for (int64_t stage = 0; stage < pipeline_stage_registers.size(); ++stage) {
+    PipelineStageMetricsProto* stage_proto = proto->add_pipeline_stages();
+    stage_proto->set_stage(stage);
+    stage_proto->set_register_count(pipeline_stage_registers[stage].size());
+    int64_t register_bits = 0;
+    std::optional<int64_t> max_delay;
+    for (Register* reg : pipeline_stage_registers[stage]) {
+      register_bits += reg->type()->GetFlatBitCount();
+      if (register_delays != nullptr && register_delays->contains(reg)) {
+        max_delay = std::max(max_delay.value_or(0), register_delays->at(reg));
+      }
+    }
+    stage_proto->set_register_bits(register_bits);
+    if (register_delays != nullptr) {
+      stage_proto->set_max_delay_ps(max_delay.value_or(0));
+    }
+  }
+}
+
+// Sets the delay fields of `proto` based on analysis of `block`. The maximum
+// delay of any path ending at each register is written to `register_delays`.
+absl::Status SetDelayFields(
+    Block* block, const DelayEstimator& delay_estimator,
+    BlockMetricsProto* proto,
+    absl::flat_hash_map<Register*, int64_t>* register_delays) {
   // Maximum delay from input to each node.
   absl::flat_hash_map<Node*, int64_t> input_delay_map;
   // Maximum delay from a register read to each node.
@@ -89,9 +211,7 @@ absl::Status SetDelayFields(Block* block, const DelayEstimator& delay_estimator,
       }
       return value;
     };
-    absl::StatusOr<int64_t> node_delay_or =
-        delay_estimator.GetOperationDelayInPs(node);
-    int64_t node_delay = node_delay_or.ok() ? node_delay_or.value() : 0;
+    int64_t node_delay = GetNodeDelay(node, &delay_estimator);
 
     std::optional<int64_t> input_delay;
     std::optional<int64_t> reg_delay;
@@ -139,14 +259,19 @@ absl::Status SetDelayFields(Block* block, const DelayEstimator& delay_estimator,
       if (node->As<RegisterWrite>()->load_enable().has_value()) {
         operands.push_back(node->As<RegisterWrite>()->load_enable().value());
       }
+      Register* reg = node->As<RegisterWrite>()->GetRegister();
       for (Node* operand : operands) {
         if (input_delay_map.contains(operand)) {
           max_input_to_reg_delay =
               optional_max(input_delay_map.at(operand), max_input_to_reg_delay);
+          (*register_delays)[reg] =
+              std::max((*register_delays)[reg], input_delay_map.at(operand));
         }
         if (reg_delay_map.contains(operand)) {
           max_reg_to_reg_delay =
               optional_max(reg_delay_map.at(operand), max_reg_to_reg_delay);
+          (*register_delays)[reg] =
+              std::max((*register_delays)[reg], reg_delay_map.at(operand));
         }
       }
       continue;
@@ -337,15 +462,23 @@ absl::Status GenerateBom(Block* block, BlockMetricsProto* proto) {
 }  // namespace
 
 absl::StatusOr<BlockMetricsProto> GenerateBlockMetrics(
-    Block* block, const DelayEstimator* delay_estimator) {
+    Block* block, const DelayEstimator* delay_estimator,
+    absl::Span<const std::vector<Register*>> pipeline_stage_registers) {
   BlockMetricsProto proto;
   proto.set_flop_count(GenerateFlopCount(block));
   proto.set_feedthrough_path_exists(HasFeedthroughPass(block));
+  SetFeedthroughPaths(block, delay_estimator, &proto);
+  SetFanoutFields(block, &proto);
 
+  absl::flat_hash_map<Register*, int64_t> register_delays;
   if (delay_estimator != nullptr) {
     proto.set_delay_model(delay_estimator->name());
-    XLS_RETURN_IF_ERROR(SetDelayFields(block, *delay_estimator, &proto));
+    XLS_RETURN_IF_ERROR(
+        SetDelayFields(block, *delay_estimator, &proto, &register_delays));
   }
+  SetPipelineStageFields(
+      pipeline_stage_registers,
+      delay_estimator == nullptr ? nullptr : &register_delays, &proto);
 
   XLS_RETURN_IF_ERROR(GenerateBom(block, &proto));
 
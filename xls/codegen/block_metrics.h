@@ -16,20 +16,27 @@
 #define XLS_CODEGEN_BLOCK_METRICS_GENERATOR_H_
 
 #include <optional>
+#include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/codegen/xls_metrics.pb.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/block.h"
+#include "xls/ir/register.h"
 
 namespace xls::verilog {
 
 // Collects and generate metrics related to the contents of the block.
 // (ex. flop count, number of operations, etc...).
 //
+// `pipeline_stage_registers` holds the pipeline registers at the end of each
+// stage of a pipelined block, from which per-stage metrics are generated.
+//
 // TODO(tedhong): 2022-01-28 Add a class around the proto.
 absl::StatusOr<BlockMetricsProto> GenerateBlockMetrics(
-    Block* block, const DelayEstimator* delay_estimator = nullptr);
+    Block* block, const DelayEstimator* delay_estimator = nullptr,
+    absl::Span<const std::vector<Register*>> pipeline_stage_registers = {});
 
 }  // namespace xls::verilog
 
@@ -14,10 +14,14 @@
 
 #include "xls/codegen/block_metrics_generation_pass.h"
 
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_format.h"
 #include "xls/codegen/block_metrics.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/node_util.h"
+#include "xls/ir/register.h"
 
 namespace xls::verilog {
 
@@ -30,9 +34,31 @@ absl::StatusOr<bool> BlockMetricsGenerationPass::RunInternal(
         "signature generation.");
   }
 
+  // Registers may have been removed from the block after block conversion
+  // recorded them, so only consider registers still in the block.
+  absl::flat_hash_set<Register*> block_registers(
+      unit->block->GetRegisters().begin(), unit->block->GetRegisters().end());
+  std::vector<std::vector<Register*>> pipeline_stage_registers;
+  for (const PipelineStageRegisters& stage_registers :
+       unit->streaming_io_and_pipeline.pipeline_registers) {
+    std::vector<Register*>& registers =
+        pipeline_stage_registers.emplace_back();
+    for (const PipelineRegister& pipeline_register : stage_registers) {
+      if (block_registers.contains(pipeline_register.reg)) {
+        registers.push_back(pipeline_register.reg);
+      }
+    }
+  }
+
   XLS_ASSIGN_OR_RETURN(
       BlockMetricsProto block_metrics,
-      GenerateBlockMetrics(unit->block, options.delay_estimator));
+      GenerateBlockMetrics(unit->block, options.delay_estimator,
+                           pipeline_stage_registers));
+  if (options.schedule.has_value() &&
+      options.schedule->register_bits_saved_by_retiming().has_value()) {
+    block_metrics.set_pipeline_register_bits_saved_by_retiming(
+        *options.schedule->register_bits_saved_by_retiming());
+  }
   XLS_RETURN_IF_ERROR(unit->signature->ReplaceBlockMetrics(block_metrics));
 
   return true;
@@ -14,6 +14,10 @@
 
 #include "xls/codegen/block_metrics.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "xls/codegen/block_conversion.h"
 #include "xls/codegen/codegen_options.h"
@@ -25,6 +29,7 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
+#include "xls/ir/register.h"
 #include "xls/ir/type.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/run_pipeline_schedule.h"
@@ -115,6 +120,79 @@ TEST(BlockMetricsGeneratorTest, PipelineRegistersCount) {
   EXPECT_EQ(proto.flop_count(), schedule.CountFinalInteriorPipelineRegisters());
 }
 
+TEST(BlockMetricsGeneratorTest, PipelineStages) {
+  Package package("test");
+
+  FunctionBuilder fb("test_func", &package);
+  BValue x = fb.Param("x", package.GetBitsType(32));
+  BValue y = fb.Param("y", package.GetBitsType(32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * f, fb.BuildWithReturnValue(fb.Negate(fb.Not(fb.Add(x, y)))));
+
+  XLS_ASSERT_OK_AND_ASSIGN(const DelayEstimator* delay_estimator,
+                           GetDelayEstimator("unit"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(f, *delay_estimator,
+                          SchedulingOptions().pipeline_stages(3)));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      CodegenPassUnit unit,
+      FunctionToPipelinedBlock(
+          schedule,
+          CodegenOptions().flop_inputs(false).flop_outputs(false).clock_name(
+              "clk"),
+          f));
+
+  std::vector<std::vector<Register*>> pipeline_stage_registers;
+  for (const PipelineStageRegisters& stage_registers :
+       unit.streaming_io_and_pipeline.pipeline_registers) {
+    std::vector<Register*>& registers =
+        pipeline_stage_registers.emplace_back();
+    for (const PipelineRegister& pipeline_register : stage_registers) {
+      registers.push_back(pipeline_register.reg);
+    }
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      BlockMetricsProto proto,
+      GenerateBlockMetrics(unit.block, delay_estimator,
+                           pipeline_stage_registers));
+
+  ASSERT_EQ(proto.pipeline_stages_size(), 2);
+  int64_t register_bits = 0;
+  for (int64_t stage = 0; stage < proto.pipeline_stages_size(); ++stage) {
+    const PipelineStageMetricsProto& stage_proto = proto.pipeline_stages(stage);
+    EXPECT_EQ(stage_proto.stage(), stage);
+    EXPECT_EQ(stage_proto.register_count(),
+              pipeline_stage_registers[stage].size());
+    EXPECT_TRUE(stage_proto.has_max_delay_ps());
+    EXPECT_LE(stage_proto.max_delay_ps(),
+              std::max(proto.max_reg_to_reg_delay_ps(),
+                       proto.max_input_to_reg_delay_ps()));
+    register_bits += stage_proto.register_bits();
+  }
+  EXPECT_EQ(register_bits, proto.flop_count());
+}
+
+TEST(BlockMetricsGeneratorTest, Fanout) {
+  Package package("test");
+  Type* u32 = package.GetBitsType(32);
+  BlockBuilder bb("fanout", &package);
+  BValue in = bb.InputPort("in", u32);
+  BValue not_in = bb.Not(in);
+  bb.OutputPort("out0", bb.Add(in, not_in));
+  bb.OutputPort("out1", bb.Negate(in));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(BlockMetricsProto proto,
+                           GenerateBlockMetrics(block));
+  // `in` has three users. `not_in`, the add and the negate have one each.
+  EXPECT_EQ(proto.max_fanout(), 3);
+  EXPECT_DOUBLE_EQ(proto.average_fanout(), 6.0 / 4.0);
+}
+
 TEST(BlockMetricsGeneratorTest, DelayModel) {
   Package package("test");
   BlockBuilder bb("pass_thru", &package);
@@ -182,6 +260,17 @@ TEST(BlockMetricsGeneratorTest, CombinationalPath) {
     EXPECT_TRUE(proto.feedthrough_path_exists());
     EXPECT_TRUE(proto.has_max_feedthrough_path_delay_ps());
     EXPECT_EQ(proto.max_feedthrough_path_delay_ps(), 3);
+
+    ASSERT_EQ(proto.feedthrough_paths_size(), 3);
+    EXPECT_EQ(proto.feedthrough_paths(0).output_port(), "out0");
+    EXPECT_EQ(proto.feedthrough_paths(0).input_port(), "in0");
+    EXPECT_EQ(proto.feedthrough_paths(0).delay_ps(), 2);
+    EXPECT_EQ(proto.feedthrough_paths(1).output_port(), "out0");
+    EXPECT_EQ(proto.feedthrough_paths(1).input_port(), "in1");
+    EXPECT_EQ(proto.feedthrough_paths(1).delay_ps(), 2);
+    EXPECT_EQ(proto.feedthrough_paths(2).output_port(), "out1");
+    EXPECT_EQ(proto.feedthrough_paths(2).input_port(), "in1");
+    EXPECT_EQ(proto.feedthrough_paths(2).delay_ps(), 3);
   }
 
   {
@@ -194,6 +283,7 @@ TEST(BlockMetricsGeneratorTest, CombinationalPath) {
                              GenerateBlockMetrics(block, delay_estimator));
     EXPECT_FALSE(proto.feedthrough_path_exists());
     EXPECT_FALSE(proto.has_max_feedthrough_path_delay_ps());
+    EXPECT_EQ(proto.feedthrough_paths_size(), 0);
   }
 
   {
@@ -219,6 +219,11 @@ struct CodegenPassUnit {
   // These methods are required by CompoundPassBase.
   std::string DumpIr() const;
   const std::string& name() const { return block->name(); }
+  int64_t GetNodeCount() const { return package->GetNodeCount(); }
+  int64_t GetApproximateIrByteSize() const {
+    return package->GetApproximateIrByteSize();
+  }
+  int64_t next_node_id() const { return package->next_node_id(); }
 };
 
 using CodegenPass = PassBase<CodegenPassUnit, CodegenPassOptions, PassResults>;
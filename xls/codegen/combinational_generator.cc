@@ -50,7 +50,7 @@ namespace verilog {
 
 absl::StatusOr<ModuleGeneratorResult> GenerateCombinationalModule(
     FunctionBase* module, const CodegenOptions& options,
-    const DelayEstimator* delay_estimator) {
+    const DelayEstimator* delay_estimator, PassResults* results) {
   XLS_ASSIGN_OR_RETURN(CodegenPassUnit unit,
                        FunctionBaseToCombinationalBlock(module, options));
 
@@ -58,10 +58,12 @@ absl::StatusOr<ModuleGeneratorResult> GenerateCombinationalModule(
   codegen_pass_options.codegen_options = options;
   codegen_pass_options.delay_estimator = delay_estimator;
 
-  PassResults results;
-  XLS_RETURN_IF_ERROR(CreateCodegenPassPipeline()
-                          ->Run(&unit, codegen_pass_options, &results)
-                          .status());
+  PassResults local_results;
+  XLS_RETURN_IF_ERROR(
+      CreateCodegenPassPipeline()
+          ->Run(&unit, codegen_pass_options,
+                results == nullptr ? &local_results : results)
+          .status());
   XLS_RET_CHECK(unit.signature.has_value());
   VerilogLineMap verilog_line_map;
   XLS_ASSIGN_OR_RETURN(std::string verilog,
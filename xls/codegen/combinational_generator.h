@@ -27,6 +27,7 @@
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/function.h"
 #include "xls/ir/proc.h"
+#include "xls/passes/pass_base.h"
 
 namespace xls {
 namespace verilog {
@@ -35,9 +36,12 @@ namespace verilog {
 // use_system_verilog is true the generated module will be SystemVerilog
 // otherwise it will be Verilog. This adds a proc to the package which
 // represents the combinational module. This proc is used for code generation.
+// If `results` is non-null, the invocations of the codegen passes are appended
+// to it.
 absl::StatusOr<ModuleGeneratorResult> GenerateCombinationalModule(
     FunctionBase* func, const CodegenOptions& options,
-    const DelayEstimator* delay_estimator = nullptr);
+    const DelayEstimator* delay_estimator = nullptr,
+    PassResults* results = nullptr);
 
 }  // namespace verilog
 }  // namespace xls
@@ -337,6 +337,70 @@ ModuleSignatureBuilder& ModuleSignatureBuilder::AddRam1R1W(
   return *this;
 }
 
+ModuleSignatureBuilder& ModuleSignatureBuilder::AddRamNR1W(
+    const RamNR1WArgs& args) {
+  RamProto* ram = proto_.add_rams();
+  ram->set_name(ToProtoString(args.ram_name));
+
+  RamNR1WProto* ram_nr1w = ram->mutable_ram_nr1w();
+  for (const RamRPortArgs& r_port_args : args.r_ports) {
+    RamRPortProto* r_port = ram_nr1w->add_r_ports();
+    RamRRequestProto* r_req = r_port->mutable_request();
+    RamRResponseProto* r_resp = r_port->mutable_response();
+    r_req->set_name(ToProtoString(r_port_args.req_name));
+    r_resp->set_name(ToProtoString(r_port_args.resp_name));
+
+    auto* address_proto = r_req->mutable_address();
+    address_proto->set_name(ToProtoString(r_port_args.address_name));
+    address_proto->set_direction(DIRECTION_OUTPUT);
+    address_proto->set_width(args.address_width);
+
+    auto* enable_proto = r_req->mutable_enable();
+    enable_proto->set_name(ToProtoString(r_port_args.enable_name));
+    enable_proto->set_direction(DIRECTION_OUTPUT);
+    enable_proto->set_width(1);
+
+    if (r_port_args.mask_width > 0) {
+      auto* mask_proto = r_req->mutable_mask();
+      mask_proto->set_name(ToProtoString(r_port_args.mask_name));
+      mask_proto->set_direction(DIRECTION_OUTPUT);
+      mask_proto->set_width(r_port_args.mask_width);
+    }
+
+    auto* data_proto = r_resp->mutable_data();
+    data_proto->set_name(ToProtoString(r_port_args.data_name));
+    data_proto->set_direction(DIRECTION_INPUT);
+    data_proto->set_width(args.data_width);
+  }
+
+  RamWRequestProto* w_req = ram_nr1w->mutable_w_port()->mutable_request();
+  w_req->set_name(ToProtoString(args.wr_req_name));
+
+  auto* wr_address_proto = w_req->mutable_address();
+  wr_address_proto->set_name(ToProtoString(args.write_address_name));
+  wr_address_proto->set_direction(DIRECTION_OUTPUT);
+  wr_address_proto->set_width(args.address_width);
+
+  auto* wr_data_proto = w_req->mutable_data();
+  wr_data_proto->set_name(ToProtoString(args.write_data_name));
+  wr_data_proto->set_direction(DIRECTION_OUTPUT);
+  wr_data_proto->set_width(args.data_width);
+
+  if (args.write_mask_width > 0) {
+    auto* write_mask_proto = w_req->mutable_mask();
+    write_mask_proto->set_name(ToProtoString(args.write_mask_name));
+    write_mask_proto->set_direction(DIRECTION_OUTPUT);
+    write_mask_proto->set_width(args.write_mask_width);
+  }
+
+  auto* wr_enable_proto = w_req->mutable_enable();
+  wr_enable_proto->set_name(ToProtoString(args.write_enable_name));
+  wr_enable_proto->set_direction(DIRECTION_OUTPUT);
+  wr_enable_proto->set_width(1);
+
+  return *this;
+}
+
 static absl::Status ValidateProto(const ModuleSignatureProto& proto) {
   // TODO(meheff): do more validation here.
   // Validate widths/number of function type.
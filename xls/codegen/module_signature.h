@@ -149,6 +149,30 @@ class ModuleSignatureBuilder {
   };
   ModuleSignatureBuilder& AddRam1R1W(const Ram1R1WArgs& args);
 
+  // Adds a RAM with any number of read ports and a single write port.
+  struct RamRPortArgs {
+    std::string_view req_name;
+    std::string_view resp_name;
+    int64_t mask_width;
+    std::string_view address_name;
+    std::string_view data_name;
+    std::string_view mask_name;
+    std::string_view enable_name;
+  };
+  struct RamNR1WArgs {
+    std::string_view ram_name;
+    std::vector<RamRPortArgs> r_ports;
+    std::string_view wr_req_name;
+    int64_t address_width;
+    int64_t data_width;
+    int64_t write_mask_width;
+    std::string_view write_address_name;
+    std::string_view write_data_name;
+    std::string_view write_mask_name;
+    std::string_view write_enable_name;
+  };
+  ModuleSignatureBuilder& AddRamNR1W(const RamNR1WArgs& args);
+
   absl::StatusOr<ModuleSignature> Build();
 
  private:
@@ -35,14 +35,16 @@ namespace verilog {
 
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PipelineSchedule& schedule, Function* func,
-    const CodegenOptions& options, const DelayEstimator* delay_estimator) {
+    const CodegenOptions& options, const DelayEstimator* delay_estimator,
+    PassResults* results) {
   return ToPipelineModuleText(schedule, static_cast<FunctionBase*>(func),
-                              options, delay_estimator);
+                              options, delay_estimator, results);
 }
 
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PipelineSchedule& schedule, FunctionBase* module,
-    const CodegenOptions& options, const DelayEstimator* delay_estimator) {
+    const CodegenOptions& options, const DelayEstimator* delay_estimator,
+    PassResults* results) {
   XLS_VLOG(2) << "Generating pipelined module for module:";
   XLS_VLOG_LINES(2, module->DumpIr());
   XLS_VLOG_LINES(2, schedule.ToString());
@@ -62,9 +64,11 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     pass_options.codegen_options.emit_as_pipeline(false);
   }
 
-  PassResults results;
-  XLS_RETURN_IF_ERROR(
-      CreateCodegenPassPipeline()->Run(&unit, pass_options, &results).status());
+  PassResults local_results;
+  XLS_RETURN_IF_ERROR(CreateCodegenPassPipeline()
+                          ->Run(&unit, pass_options,
+                                results == nullptr ? &local_results : results)
+                          .status());
   XLS_RET_CHECK(unit.signature.has_value());
   VerilogLineMap verilog_line_map;
   XLS_ASSIGN_OR_RETURN(std::string verilog,
@@ -25,6 +25,7 @@
 #include "xls/codegen/vast.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/function.h"
+#include "xls/passes/pass_base.h"
 #include "xls/scheduling/pipeline_schedule.h"
 
 namespace xls {
@@ -44,20 +45,26 @@ inline CodegenOptions BuildPipelineOptions() {
 // given in the signature.
 // If a delay estimator is provided, the signature also includes delay
 // information about the pipeline stages.
+// If `results` is non-null, the invocations of the codegen passes are appended
+// to it.
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PipelineSchedule& schedule, Function* func,
     const CodegenOptions& options = BuildPipelineOptions(),
-    const DelayEstimator* delay_estimator = nullptr);
+    const DelayEstimator* delay_estimator = nullptr,
+    PassResults* results = nullptr);
 
 // Emits the given function or proc as a verilog module which follows the given
 // schedule. The module is pipelined with a latency and initiation interval
 // given in the signature.
 // If a delay estimator is provided, the signature also includes delay
 // information about the pipeline stages.
+// If `results` is non-null, the invocations of the codegen passes are appended
+// to it.
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PipelineSchedule& schedule, FunctionBase* module,
     const CodegenOptions& options = BuildPipelineOptions(),
-    const DelayEstimator* delay_estimator = nullptr);
+    const DelayEstimator* delay_estimator = nullptr,
+    PassResults* results = nullptr);
 
 }  // namespace verilog
 }  // namespace xls
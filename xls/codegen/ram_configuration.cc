@@ -29,10 +29,26 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
 #include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/scheduling/scheduling_options.h"
 
 namespace xls::verilog {
 namespace {
+// Parses the latency field of a RAM configuration. Latency is the number of
+// cycles between a request and its response and must be positive.
+absl::StatusOr<int64_t> ParseLatency(std::string_view field) {
+  int64_t latency;
+  if (!absl::SimpleAtoi(field, &latency)) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Latency must be an integer, got %s.", field));
+  }
+  if (latency < 1) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Latency must be positive, got %d.", latency));
+  }
+  return latency;
+}
+
 // Parses a split configuration string of the form
 // "(ram_name, "1RW", request_channel_name, response_channel_name[,
 // latency])".
@@ -58,10 +74,7 @@ Ram1RWConfigurationParseSplitString(absl::Span<const std::string_view> fields) {
   std::string_view write_completion_channel_name = fields[4];
   int64_t latency = 1;
   if (fields.size() > 5) {
-    if (!absl::SimpleAtoi(fields[5], &latency)) {
-      return absl::InvalidArgumentError(
-          absl::StrFormat("Latency must be an integer, got %s.", fields[5]));
-    }
+    XLS_ASSIGN_OR_RETURN(latency, ParseLatency(fields[5]));
   }
   return std::make_unique<Ram1RWConfiguration>(
       name, latency, /*request_name=*/request_channel_name,
@@ -97,10 +110,7 @@ Ram1R1WConfigurationParseSplitString(
   std::string_view write_completion_channel_name = fields[5];
   int64_t latency = 1;
   if (fields.size() > 6) {
-    if (!absl::SimpleAtoi(fields[6], &latency)) {
-      return absl::InvalidArgumentError(
-          absl::StrFormat("Latency must be an integer, got %s.", fields[6]));
-    }
+    XLS_ASSIGN_OR_RETURN(latency, ParseLatency(fields[6]));
   }
   return std::make_unique<Ram1R1WConfiguration>(
       name, latency, /*read_request_name=*/read_request_channel_name,
@@ -109,6 +119,49 @@ Ram1R1WConfigurationParseSplitString(
       /*write_completion_channel_name=*/write_completion_channel_name);
 }
 
+// Parses a split configuration string of the form
+// "(ram_name, "nR1W", read_request_channel_name0, read_response_channel_name0,
+// [read_request_channel_name1, read_response_channel_name1, ...]
+// write_request_channel_name, write_completion_channel_name[, latency])".
+absl::StatusOr<std::unique_ptr<RamNR1WConfiguration>>
+RamNR1WConfigurationParseSplitString(
+    absl::Span<const std::string_view> fields) {
+  // Read ports contribute pairs of channel names, so an odd number of fields
+  // after the name and kind means the last field is the latency.
+  int64_t port_field_count = static_cast<int64_t>(fields.size()) - 2;
+  bool has_latency = port_field_count % 2 == 1;
+  if (has_latency) {
+    --port_field_count;
+  }
+  if (port_field_count < 4) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Expected arguments "
+        "name:nR1W:read_req_name0:read_resp_name0[:read_req_name1:"
+        "read_resp_name1...]:write_req_name:write_comp_name[:latency], got %d "
+        "fields instead.",
+        fields.size()));
+  }
+  if (fields[1] != "nR1W") {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Expected to see RAM kind nR1W, got %s.", fields[1]));
+  }
+  std::vector<RamRPortConfiguration> r_port_configurations;
+  for (int64_t i = 2; i < port_field_count; i += 2) {
+    r_port_configurations.push_back(RamRPortConfiguration{
+        .request_channel_name = std::string{fields[i]},
+        .response_channel_name = std::string{fields[i + 1]},
+    });
+  }
+  int64_t latency = 1;
+  if (has_latency) {
+    XLS_ASSIGN_OR_RETURN(latency, ParseLatency(fields.back()));
+  }
+  return std::make_unique<RamNR1WConfiguration>(
+      fields[0], latency, std::move(r_port_configurations),
+      /*write_request_name=*/fields[port_field_count],
+      /*write_completion_name=*/fields[port_field_count + 1]);
+}
+
 // Ram configurations are in the format
 // ram_name:ram_kind[:ram_specific_configuration]. ParseString() splits the
 // configuration string on ":" and calls a ram_configuration_parser_t function
@@ -124,6 +177,7 @@ GetRamConfigurationParserMap() {
       new absl::flat_hash_map<std::string, ram_configuration_parser_t>{
           {"1RW", Ram1RWConfigurationParseSplitString},
           {"1R1W", Ram1R1WConfigurationParseSplitString},
+          {"nR1W", RamNR1WConfigurationParseSplitString},
       };
   return singleton;
 }
@@ -198,4 +252,24 @@ std::vector<IOConstraint> Ram1R1WConfiguration::GetIOConstraints() const {
   };
 }
 
+std::unique_ptr<RamConfiguration> RamNR1WConfiguration::Clone() const {
+  return std::make_unique<RamNR1WConfiguration>(*this);
+}
+
+std::vector<IOConstraint> RamNR1WConfiguration::GetIOConstraints() const {
+  std::vector<IOConstraint> constraints;
+  for (const RamRPortConfiguration& r_port : r_port_configurations_) {
+    constraints.push_back(IOConstraint(
+        r_port.request_channel_name, IODirection::kSend,
+        r_port.response_channel_name, IODirection::kReceive,
+        /*minimum_latency=*/latency_, /*maximum_latency=*/latency_));
+  }
+  constraints.push_back(IOConstraint(
+      w_port_configuration_.request_channel_name, IODirection::kSend,
+      w_port_configuration_.write_completion_channel_name,
+      IODirection::kReceive,
+      /*minimum_latency=*/latency_, /*maximum_latency=*/latency_));
+  return constraints;
+}
+
 }  // namespace xls::verilog
@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/scheduling/scheduling_options.h"
 
 namespace xls::verilog {
@@ -129,6 +130,37 @@ class Ram1R1WConfiguration : public RamConfiguration {
   RamWPortConfiguration w_port_configuration_;
 };
 
+// Configuration for a RAM with one or more read ports and a single write port.
+// Each read port has its own request and response channels. All ports share
+// the RAM's latency, which may be greater than one for pipelined RAMs.
+class RamNR1WConfiguration : public RamConfiguration {
+ public:
+  RamNR1WConfiguration(std::string_view ram_name, int64_t latency,
+                       std::vector<RamRPortConfiguration> r_port_configurations,
+                       std::string_view write_request_name,
+                       std::string_view write_completion_name)
+      : RamConfiguration(ram_name, latency, /*ram_kind=*/"nR1W"),
+        r_port_configurations_(std::move(r_port_configurations)),
+        w_port_configuration_(RamWPortConfiguration{
+            .request_channel_name = std::string{write_request_name},
+            .write_completion_channel_name =
+                std::string{write_completion_name}}) {}
+
+  std::unique_ptr<RamConfiguration> Clone() const override;
+  std::vector<IOConstraint> GetIOConstraints() const override;
+
+  absl::Span<const RamRPortConfiguration> r_port_configurations() const {
+    return r_port_configurations_;
+  }
+  const RamWPortConfiguration& w_port_configuration() const {
+    return w_port_configuration_;
+  }
+
+ private:
+  std::vector<RamRPortConfiguration> r_port_configurations_;
+  RamWPortConfiguration w_port_configuration_;
+};
+
 }  // namespace xls::verilog
 
 #endif  // XLS_CODEGEN_RAM_CONFIGURATION_H_
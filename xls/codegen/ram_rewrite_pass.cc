@@ -359,11 +359,18 @@ absl::StatusOr<bool> Ram1RWRewrite(
   std::optional<xls::Reset> reset_behavior =
       pass_options.codegen_options.ResetBehavior();
 
-  XLS_ASSIGN_OR_RETURN(
-      Node * ram_resp_valid,
-      AddRegisterAfterNode(absl::StrCat(req_valid->GetName(), "_delay"),
-                           reset_behavior, std::nullopt, req_re_valid_buf,
-                           block));
+  // The response is valid `latency` cycles after the read is enabled.
+  const int64_t latency = ram_config.latency();
+  XLS_RET_CHECK_GE(latency, 1);
+  Node* ram_resp_valid = req_re_valid_buf;
+  for (int64_t stage = 0; stage < latency; ++stage) {
+    XLS_ASSIGN_OR_RETURN(
+        ram_resp_valid,
+        AddRegisterAfterNode(
+            stage == 0 ? absl::StrCat(req_valid->GetName(), "_delay")
+                       : absl::StrCat(req_valid->GetName(), "_delay", stage),
+            reset_behavior, std::nullopt, ram_resp_valid, block));
+  }
 
   // Make a new response port with a new name.
   std::string resp_rd_data_name =
@@ -393,15 +400,19 @@ absl::StatusOr<bool> Ram1RWRewrite(
   XLS_RETURN_IF_ERROR(
       rw_block_ports.req_ports.req_ready->ReplaceUsesWith(resp_ready_port_buf));
 
-  // Add zero-latency buffer at output of ram
+  // Add zero-latency buffers at output of ram, one per cycle of latency, to
+  // hold the responses in flight while the block isn't ready (see
+  // RewriteRPort).
   std::vector<Node*> valid_nodes;
-  std::string zero_latency_buffer_name =
-      absl::StrCat(ram_name, "_ram_zero_latency0");
-  XLS_RETURN_IF_ERROR(AddZeroLatencyBufferToRDVNodes(
-                          resp_rd_data_port, ram_resp_valid,
-                          resp_ready_port_buf, zero_latency_buffer_name,
-                          reset_behavior, block, valid_nodes)
-                          .status());
+  for (int64_t stage = 0; stage < latency; ++stage) {
+    std::string zero_latency_buffer_name =
+        absl::StrCat(ram_name, "_ram_zero_latency", stage);
+    XLS_RETURN_IF_ERROR(AddZeroLatencyBufferToRDVNodes(
+                            resp_rd_data_port, ram_resp_valid,
+                            resp_ready_port_buf, zero_latency_buffer_name,
+                            reset_behavior, block, valid_nodes)
+                            .status());
+  }
 
   // Add output ports for expanded req.data.
   XLS_ASSIGN_OR_RETURN(auto* req_addr_port,
@@ -500,20 +511,25 @@ absl::StatusOr<bool> Ram1RWRewrite(
   return true;
 }
 
-absl::StatusOr<bool> Ram1R1WRewrite(
-    CodegenPassUnit* unit, const CodegenPassOptions& pass_options,
-    const RamConfiguration& base_ram_configuration) {
-  auto& ram_config =
-      down_cast<const Ram1R1WConfiguration&>(base_ram_configuration);
-  Block* block = unit->block;
-
-  XLS_ASSIGN_OR_RETURN(
-      RamRPortBlockPorts r_block_ports,
-      GetRBlockPorts(block, ram_config.r_port_configuration()));
-  XLS_ASSIGN_OR_RETURN(
-      RamWPortBlockPorts w_block_ports,
-      GetWBlockPorts(block, ram_config.w_port_configuration()));
+// Ports added to the block by rewriting a RAM read port.
+struct RPortRewrite {
+  OutputPort* addr_port;
+  OutputPort* mask_port;
+  OutputPort* en_port;
+  InputPort* data_port;
+};
 
+// Rewrites the request and response channels of a RAM read port into address,
+// mask and enable output ports and a data input port. Port names are
+// `<name_prefix>_rd_addr` etc. The response valid signal is the read enable
+// delayed by `latency` cycles. A pipelined RAM can't stall responses which are
+// already in flight, so `latency` zero-latency buffers are added to hold them
+// while the block isn't ready to receive.
+absl::StatusOr<RPortRewrite> RewriteRPort(
+    Block* block, const RamRPortBlockPorts& r_block_ports,
+    std::string_view name_prefix, int64_t latency,
+    const std::optional<xls::Reset>& reset_behavior) {
+  XLS_RET_CHECK_GE(latency, 1);
   // rd_req is (rd_addr, rd_mask)
   XLS_RETURN_IF_ERROR(CheckDataPortType(
       r_block_ports.req_ports.req_data->operand(0)->GetType(), "rd_req",
@@ -522,58 +538,34 @@ absl::StatusOr<bool> Ram1R1WRewrite(
   XLS_RETURN_IF_ERROR(
       CheckDataPortType(r_block_ports.resp_ports.resp_data->GetType(),
                         "rd_resp", {std::nullopt}, {"rd_data"}));
-  // wr_req is (wr_addr, wr_data, wr_mask)
-  XLS_RETURN_IF_ERROR(
-      CheckDataPortType(w_block_ports.req_ports.req_data->operand(0)->GetType(),
-                        "wr_req", {TypeKind::kBits, std::nullopt, std::nullopt},
-                        {"wr_addr", "wr_data", "wr_mask"}));
-
-  auto tuple_index = [block](Node* node, int idx) {
-    return block->MakeNode<TupleIndex>(
-        /*loc=*/SourceInfo(), node, /*index=*/idx);
-  };
 
   // Peel off fields from the data ports' operands.
   XLS_ASSIGN_OR_RETURN(
       Node * rd_addr,
-      tuple_index(r_block_ports.req_ports.req_data->operand(0), 0));
+      block->MakeNode<TupleIndex>(
+          /*loc=*/SourceInfo(), r_block_ports.req_ports.req_data->operand(0),
+          /*index=*/0));
   XLS_ASSIGN_OR_RETURN(
       Node * rd_mask,
-      tuple_index(r_block_ports.req_ports.req_data->operand(0), 1));
-  XLS_ASSIGN_OR_RETURN(Node * rd_data,
-                       tuple_index(r_block_ports.resp_ports.resp_data, 0));
+      block->MakeNode<TupleIndex>(
+          /*loc=*/SourceInfo(), r_block_ports.req_ports.req_data->operand(0),
+          /*index=*/1));
   XLS_ASSIGN_OR_RETURN(
-      Node * wr_addr,
-      tuple_index(w_block_ports.req_ports.req_data->operand(0), 0));
-  XLS_ASSIGN_OR_RETURN(
-      Node * wr_data,
-      tuple_index(w_block_ports.req_ports.req_data->operand(0), 1));
-  XLS_ASSIGN_OR_RETURN(
-      Node * wr_mask,
-      tuple_index(w_block_ports.req_ports.req_data->operand(0), 2));
+      Node * rd_data,
+      block->MakeNode<TupleIndex>(/*loc=*/SourceInfo(),
+                                  r_block_ports.resp_ports.resp_data,
+                                  /*index=*/0));
 
   Node* rd_en = r_block_ports.req_ports.req_valid->operand(0);
-  Node* wr_en = w_block_ports.req_ports.req_valid->operand(0);
 
   // Make names for each element of the request tuple. They will end up each
   // having their own port.
-  std::string_view ram_name = ram_config.ram_name();
   std::string rd_addr_name =
-      block->UniquifyNodeName(absl::StrCat(ram_name, "_rd_addr"));
+      block->UniquifyNodeName(absl::StrCat(name_prefix, "_rd_addr"));
   std::string rd_mask_name =
-      block->UniquifyNodeName(absl::StrCat(ram_name, "_rd_mask"));
+      block->UniquifyNodeName(absl::StrCat(name_prefix, "_rd_mask"));
   std::string rd_en_name =
-      block->UniquifyNodeName(absl::StrCat(ram_name, "_rd_en"));
-  std::string wr_addr_name =
-      block->UniquifyNodeName(absl::StrCat(ram_name, "_wr_addr"));
-  std::string wr_data_name =
-      block->UniquifyNodeName(absl::StrCat(ram_name, "_wr_data"));
-  std::string wr_mask_name =
-      block->UniquifyNodeName(absl::StrCat(ram_name, "_wr_mask"));
-  std::string wr_en_name =
-      block->UniquifyNodeName(absl::StrCat(ram_name, "_wr_en"));
-
-  wr_en->SetName(wr_en_name);
+      block->UniquifyNodeName(absl::StrCat(name_prefix, "_rd_en"));
   rd_en->SetName(rd_en_name);
 
   std::string req_re_valid_buf_name =
@@ -583,18 +575,20 @@ absl::StatusOr<bool> Ram1R1WRewrite(
       block->MakeNodeWithName<UnOp>(
           /*loc=*/SourceInfo(), rd_en, Op::kIdentity, req_re_valid_buf_name));
 
-  std::optional<xls::Reset> reset_behavior =
-      pass_options.codegen_options.ResetBehavior();
-
-  XLS_ASSIGN_OR_RETURN(
-      Node * rd_resp_valid,
-      AddRegisterAfterNode(absl::StrCat(rd_en->GetName(), "_delay"),
-                           reset_behavior, std::nullopt, req_re_valid_buf,
-                           block));
+  // The response is valid `latency` cycles after the read is enabled.
+  Node* rd_resp_valid = req_re_valid_buf;
+  for (int64_t stage = 0; stage < latency; ++stage) {
+    XLS_ASSIGN_OR_RETURN(
+        rd_resp_valid,
+        AddRegisterAfterNode(
+            stage == 0 ? absl::StrCat(rd_en->GetName(), "_delay")
+                       : absl::StrCat(rd_en->GetName(), "_delay", stage),
+            reset_behavior, std::nullopt, rd_resp_valid, block));
+  }
 
   // Make a new response port with a new name.
   std::string rd_data_name =
-      block->UniquifyNodeName(absl::StrCat(ram_name, "_rd_data"));
+      block->UniquifyNodeName(absl::StrCat(name_prefix, "_rd_data"));
   XLS_ASSIGN_OR_RETURN(InputPort * rd_data_port,
                        block->AddInputPort(rd_data_name, rd_data->GetType()));
   XLS_ASSIGN_OR_RETURN(
@@ -621,38 +615,28 @@ absl::StatusOr<bool> Ram1R1WRewrite(
   XLS_RETURN_IF_ERROR(
       r_block_ports.req_ports.req_ready->ReplaceUsesWith(resp_ready_port_buf));
 
-  // Add zero-latency buffer at output of ram
+  // Add zero-latency buffers at output of ram, one per cycle of latency. Each
+  // buffer is inserted between the RAM and the previously added buffers.
   std::vector<Node*> valid_nodes;
-  std::string zero_latency_buffer_name =
-      absl::StrCat(ram_name, "_ram_zero_latency0");
-  XLS_RETURN_IF_ERROR(AddZeroLatencyBufferToRDVNodes(
-                          rd_data_port, rd_resp_valid, resp_ready_port_buf,
-                          zero_latency_buffer_name, reset_behavior, block,
-                          valid_nodes)
-                          .status());
-  // Replace write ready with literal 1 (RAM is always ready for write).
-  // TODO(rigge): should this signal check for hazards?
-  XLS_ASSIGN_OR_RETURN(
-      xls::Literal * literal_1,
-      block->MakeNode<xls::Literal>(/*loc=*/SourceInfo(), Value(UBits(1, 1))));
-  XLS_RETURN_IF_ERROR(
-      w_block_ports.req_ports.req_ready->ReplaceUsesWith(literal_1));
+  for (int64_t stage = 0; stage < latency; ++stage) {
+    std::string zero_latency_buffer_name =
+        absl::StrCat(name_prefix, "_ram_zero_latency", stage);
+    XLS_RETURN_IF_ERROR(AddZeroLatencyBufferToRDVNodes(
+                            rd_data_port, rd_resp_valid, resp_ready_port_buf,
+                            zero_latency_buffer_name, reset_behavior, block,
+                            valid_nodes)
+                            .status());
+  }
 
   // Add output ports for expanded req.data.
-  XLS_ASSIGN_OR_RETURN(auto* rd_addr_port,
+  RPortRewrite rewrite;
+  rewrite.data_port = rd_data_port;
+  XLS_ASSIGN_OR_RETURN(rewrite.addr_port,
                        block->AddOutputPort(rd_addr_name, rd_addr));
-  XLS_ASSIGN_OR_RETURN(auto* rd_mask_port,
+  XLS_ASSIGN_OR_RETURN(rewrite.mask_port,
                        block->AddOutputPort(rd_mask_name, rd_mask));
-  XLS_ASSIGN_OR_RETURN(auto* rd_en_port,
+  XLS_ASSIGN_OR_RETURN(rewrite.en_port,
                        block->AddOutputPort(rd_en_name, rd_en));
-  XLS_ASSIGN_OR_RETURN(auto* wr_addr_port,
-                       block->AddOutputPort(wr_addr_name, wr_addr));
-  XLS_ASSIGN_OR_RETURN(auto* wr_data_port,
-                       block->AddOutputPort(wr_data_name, wr_data));
-  XLS_ASSIGN_OR_RETURN(auto* wr_mask_port,
-                       block->AddOutputPort(wr_mask_name, wr_mask));
-  XLS_ASSIGN_OR_RETURN(auto* wr_en_port,
-                       block->AddOutputPort(wr_en_name, wr_en));
 
   // Remove ports that have been replaced.
   XLS_RETURN_IF_ERROR(block->RemoveNode(r_block_ports.req_ports.req_data));
@@ -661,82 +645,172 @@ absl::StatusOr<bool> Ram1R1WRewrite(
   XLS_RETURN_IF_ERROR(block->RemoveNode(r_block_ports.resp_ports.resp_valid));
   XLS_RETURN_IF_ERROR(block->RemoveNode(r_block_ports.resp_ports.resp_ready));
   XLS_RETURN_IF_ERROR(block->RemoveNode(r_block_ports.resp_ports.resp_data));
+
+  return rewrite;
+}
+
+// Ports added to the block by rewriting a RAM write port.
+struct WPortRewrite {
+  OutputPort* addr_port;
+  OutputPort* data_port;
+  OutputPort* mask_port;
+  OutputPort* en_port;
+};
+
+// Rewrites the request and write completion channels of a RAM write port into
+// address, data, mask and enable output ports named `<ram_name>_wr_addr` etc.
+absl::StatusOr<WPortRewrite> RewriteWPort(
+    Block* block, const RamWPortBlockPorts& w_block_ports,
+    std::string_view ram_name) {
+  // wr_req is (wr_addr, wr_data, wr_mask)
+  XLS_RETURN_IF_ERROR(
+      CheckDataPortType(w_block_ports.req_ports.req_data->operand(0)->GetType(),
+                        "wr_req", {TypeKind::kBits, std::nullopt, std::nullopt},
+                        {"wr_addr", "wr_data", "wr_mask"}));
+
+  Node* req_data = w_block_ports.req_ports.req_data->operand(0);
+  XLS_ASSIGN_OR_RETURN(Node * wr_addr,
+                       block->MakeNode<TupleIndex>(/*loc=*/SourceInfo(),
+                                                   req_data, /*index=*/0));
+  XLS_ASSIGN_OR_RETURN(Node * wr_data,
+                       block->MakeNode<TupleIndex>(/*loc=*/SourceInfo(),
+                                                   req_data, /*index=*/1));
+  XLS_ASSIGN_OR_RETURN(Node * wr_mask,
+                       block->MakeNode<TupleIndex>(/*loc=*/SourceInfo(),
+                                                   req_data, /*index=*/2));
+  Node* wr_en = w_block_ports.req_ports.req_valid->operand(0);
+
+  std::string wr_addr_name =
+      block->UniquifyNodeName(absl::StrCat(ram_name, "_wr_addr"));
+  std::string wr_data_name =
+      block->UniquifyNodeName(absl::StrCat(ram_name, "_wr_data"));
+  std::string wr_mask_name =
+      block->UniquifyNodeName(absl::StrCat(ram_name, "_wr_mask"));
+  std::string wr_en_name =
+      block->UniquifyNodeName(absl::StrCat(ram_name, "_wr_en"));
+  wr_en->SetName(wr_en_name);
+
+  // Replace write ready with literal 1 (RAM is always ready for write).
+  // TODO(rigge): should this signal check for hazards?
+  XLS_ASSIGN_OR_RETURN(
+      xls::Literal * literal_1,
+      block->MakeNode<xls::Literal>(/*loc=*/SourceInfo(), Value(UBits(1, 1))));
+  XLS_RETURN_IF_ERROR(
+      w_block_ports.req_ports.req_ready->ReplaceUsesWith(literal_1));
+
+  WPortRewrite rewrite;
+  XLS_ASSIGN_OR_RETURN(rewrite.addr_port,
+                       block->AddOutputPort(wr_addr_name, wr_addr));
+  XLS_ASSIGN_OR_RETURN(rewrite.data_port,
+                       block->AddOutputPort(wr_data_name, wr_data));
+  XLS_ASSIGN_OR_RETURN(rewrite.mask_port,
+                       block->AddOutputPort(wr_mask_name, wr_mask));
+  XLS_ASSIGN_OR_RETURN(rewrite.en_port,
+                       block->AddOutputPort(wr_en_name, wr_en));
+
   XLS_RETURN_IF_ERROR(block->RemoveNode(w_block_ports.req_ports.req_data));
   XLS_RETURN_IF_ERROR(block->RemoveNode(w_block_ports.req_ports.req_valid));
   XLS_RETURN_IF_ERROR(block->RemoveNode(w_block_ports.req_ports.req_ready));
 
   XLS_RETURN_IF_ERROR(WriteCompletionRewrite(
       block, w_block_ports.write_completion_ports, ram_name));
+  return rewrite;
+}
 
-  if (unit->signature.has_value()) {
-    ModuleSignature* signature = &unit->signature.value();
-    auto builder = ModuleSignatureBuilder::FromProto(signature->proto());
-    XLS_RETURN_IF_ERROR(builder.RemoveStreamingChannel(
-        ram_config.r_port_configuration().request_channel_name));
-    XLS_RETURN_IF_ERROR(builder.RemoveStreamingChannel(
-        ram_config.r_port_configuration().response_channel_name));
-    XLS_RETURN_IF_ERROR(builder.RemoveStreamingChannel(
-        ram_config.w_port_configuration().request_channel_name));
-    XLS_RETURN_IF_ERROR(builder.RemoveStreamingChannel(
-        ram_config.w_port_configuration().write_completion_channel_name));
-
-    for (std::string_view channel_name : {
-             ram_config.r_port_configuration().request_channel_name,
-             ram_config.r_port_configuration().response_channel_name,
-             ram_config.w_port_configuration().request_channel_name,
-             ram_config.w_port_configuration().write_completion_channel_name,
-         }) {
-      XLS_ASSIGN_OR_RETURN(Channel * channel,
-                           block->package()->GetChannel(channel_name));
-      if (channel->GetReadyPortName().has_value()) {
-        XLS_RETURN_IF_ERROR(
-            builder.RemoveData(channel->GetReadyPortName().value()));
-      }
-      if (channel->GetDataPortName().has_value()) {
-        XLS_RETURN_IF_ERROR(
-            builder.RemoveData(channel->GetDataPortName().value()));
-      }
-      if (channel->GetValidPortName().has_value()) {
-        XLS_RETURN_IF_ERROR(
-            builder.RemoveData(channel->GetValidPortName().value()));
-      }
+// Removes the given channels of a rewritten RAM from the module signature
+// builder and adds the new RAM ports as data ports.
+absl::Status UpdateSignatureForRamPorts(
+    Block* block, absl::Span<const std::string_view> channel_names,
+    absl::Span<const OutputPort* const> output_ports,
+    absl::Span<const InputPort* const> input_ports,
+    ModuleSignatureBuilder& builder) {
+  for (std::string_view channel_name : channel_names) {
+    XLS_RETURN_IF_ERROR(builder.RemoveStreamingChannel(channel_name));
+  }
+  for (std::string_view channel_name : channel_names) {
+    XLS_ASSIGN_OR_RETURN(Channel * channel,
+                         block->package()->GetChannel(channel_name));
+    if (channel->GetReadyPortName().has_value()) {
+      XLS_RETURN_IF_ERROR(
+          builder.RemoveData(channel->GetReadyPortName().value()));
     }
-    for (const xls::OutputPort* port : {
-             rd_addr_port,
-             rd_mask_port,
-             rd_en_port,
-             wr_addr_port,
-             wr_data_port,
-             wr_mask_port,
-             wr_en_port,
-         }) {
-      if (port->operand(0)->GetType()->GetFlatBitCount() > 0) {
-        builder.AddDataOutput(port->name(), port->operand(0)->GetType());
-      }
+    if (channel->GetDataPortName().has_value()) {
+      XLS_RETURN_IF_ERROR(
+          builder.RemoveData(channel->GetDataPortName().value()));
     }
-    for (const xls::InputPort* port : {rd_data_port}) {
-      if (port->GetType()->GetFlatBitCount() > 0) {
-        builder.AddDataInput(port->name(), port->GetType());
-      }
+    if (channel->GetValidPortName().has_value()) {
+      XLS_RETURN_IF_ERROR(
+          builder.RemoveData(channel->GetValidPortName().value()));
     }
+  }
+  for (const xls::OutputPort* port : output_ports) {
+    if (port->operand(0)->GetType()->GetFlatBitCount() > 0) {
+      builder.AddDataOutput(port->name(), port->operand(0)->GetType());
+    }
+  }
+  for (const xls::InputPort* port : input_ports) {
+    if (port->GetType()->GetFlatBitCount() > 0) {
+      builder.AddDataInput(port->name(), port->GetType());
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<bool> Ram1R1WRewrite(
+    CodegenPassUnit* unit, const CodegenPassOptions& pass_options,
+    const RamConfiguration& base_ram_configuration) {
+  auto& ram_config =
+      down_cast<const Ram1R1WConfiguration&>(base_ram_configuration);
+  Block* block = unit->block;
+
+  XLS_ASSIGN_OR_RETURN(
+      RamRPortBlockPorts r_block_ports,
+      GetRBlockPorts(block, ram_config.r_port_configuration()));
+  XLS_ASSIGN_OR_RETURN(
+      RamWPortBlockPorts w_block_ports,
+      GetWBlockPorts(block, ram_config.w_port_configuration()));
+
+  std::string_view ram_name = ram_config.ram_name();
+  XLS_ASSIGN_OR_RETURN(
+      RPortRewrite r_rewrite,
+      RewriteRPort(block, r_block_ports, ram_name, ram_config.latency(),
+                   pass_options.codegen_options.ResetBehavior()));
+  XLS_ASSIGN_OR_RETURN(WPortRewrite w_rewrite,
+                       RewriteWPort(block, w_block_ports, ram_name));
+
+  if (unit->signature.has_value()) {
+    ModuleSignature* signature = &unit->signature.value();
+    auto builder = ModuleSignatureBuilder::FromProto(signature->proto());
+    XLS_RETURN_IF_ERROR(UpdateSignatureForRamPorts(
+        block,
+        {
+            ram_config.r_port_configuration().request_channel_name,
+            ram_config.r_port_configuration().response_channel_name,
+            ram_config.w_port_configuration().request_channel_name,
+            ram_config.w_port_configuration().write_completion_channel_name,
+        },
+        {r_rewrite.addr_port, r_rewrite.mask_port, r_rewrite.en_port,
+         w_rewrite.addr_port, w_rewrite.data_port, w_rewrite.mask_port,
+         w_rewrite.en_port},
+        {r_rewrite.data_port}, builder));
 
     builder.AddRam1R1W({
         .ram_name = ram_name,
         .rd_req_name = ram_config.r_port_configuration().request_channel_name,
         .rd_resp_name = ram_config.r_port_configuration().response_channel_name,
         .wr_req_name = ram_config.w_port_configuration().request_channel_name,
-        .address_width = rd_addr_port->GetType()->GetFlatBitCount(),
-        .data_width = wr_data_port->GetType()->GetFlatBitCount(),
-        .read_mask_width = rd_mask_port->GetType()->GetFlatBitCount(),
-        .write_mask_width = wr_mask_port->GetType()->GetFlatBitCount(),
-        .read_address_name = rd_addr_port->GetName(),
-        .read_data_name = rd_data_port->GetName(),
-        .read_mask_name = rd_mask_port->GetName(),
-        .read_enable_name = rd_en_port->GetName(),
-        .write_address_name = wr_addr_port->GetName(),
-        .write_data_name = wr_data_port->GetName(),
-        .write_mask_name = wr_mask_port->GetName(),
-        .write_enable_name = wr_en_port->GetName(),
+        .address_width = r_rewrite.addr_port->GetType()->GetFlatBitCount(),
+        .data_width = w_rewrite.data_port->GetType()->GetFlatBitCount(),
+        .read_mask_width = r_rewrite.mask_port->GetType()->GetFlatBitCount(),
+        .write_mask_width = w_rewrite.mask_port->GetType()->GetFlatBitCount(),
+        .read_address_name = r_rewrite.addr_port->GetName(),
+        .read_data_name = r_rewrite.data_port->GetName(),
+        .read_mask_name = r_rewrite.mask_port->GetName(),
+        .read_enable_name = r_rewrite.en_port->GetName(),
+        .write_address_name = w_rewrite.addr_port->GetName(),
+        .write_data_name = w_rewrite.data_port->GetName(),
+        .write_mask_name = w_rewrite.mask_port->GetName(),
+        .write_enable_name = w_rewrite.en_port->GetName(),
     });
 
     XLS_ASSIGN_OR_RETURN(*signature, builder.Build());
@@ -745,12 +819,99 @@ absl::StatusOr<bool> Ram1R1WRewrite(
   return true;
 }
 
+// Rewrites a RAM with several read ports. Read port `i` gets ports named
+// `<ram_name>_<i>_rd_addr` etc. and the write port gets ports named as for a
+// 1R1W RAM.
+absl::StatusOr<bool> RamNR1WRewrite(
+    CodegenPassUnit* unit, const CodegenPassOptions& pass_options,
+    const RamConfiguration& base_ram_configuration) {
+  auto& ram_config =
+      down_cast<const RamNR1WConfiguration&>(base_ram_configuration);
+  Block* block = unit->block;
+  std::string_view ram_name = ram_config.ram_name();
+
+  std::vector<RamRPortBlockPorts> r_block_ports;
+  for (const RamRPortConfiguration& r_port_config :
+       ram_config.r_port_configurations()) {
+    XLS_ASSIGN_OR_RETURN(r_block_ports.emplace_back(),
+                         GetRBlockPorts(block, r_port_config));
+  }
+  XLS_ASSIGN_OR_RETURN(
+      RamWPortBlockPorts w_block_ports,
+      GetWBlockPorts(block, ram_config.w_port_configuration()));
+
+  std::vector<RPortRewrite> r_rewrites;
+  for (int64_t i = 0; i < r_block_ports.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(
+        r_rewrites.emplace_back(),
+        RewriteRPort(block, r_block_ports[i], absl::StrCat(ram_name, "_", i),
+                     ram_config.latency(),
+                     pass_options.codegen_options.ResetBehavior()));
+  }
+  XLS_ASSIGN_OR_RETURN(WPortRewrite w_rewrite,
+                       RewriteWPort(block, w_block_ports, ram_name));
+
+  if (unit->signature.has_value()) {
+    ModuleSignature* signature = &unit->signature.value();
+    auto builder = ModuleSignatureBuilder::FromProto(signature->proto());
+    std::vector<std::string_view> channel_names;
+    std::vector<const OutputPort*> output_ports;
+    std::vector<const InputPort*> input_ports;
+    ModuleSignatureBuilder::RamNR1WArgs args{
+        .ram_name = ram_name,
+        .wr_req_name = ram_config.w_port_configuration().request_channel_name,
+        .address_width = w_rewrite.addr_port->GetType()->GetFlatBitCount(),
+        .data_width = w_rewrite.data_port->GetType()->GetFlatBitCount(),
+        .write_mask_width = w_rewrite.mask_port->GetType()->GetFlatBitCount(),
+        .write_address_name = w_rewrite.addr_port->GetName(),
+        .write_data_name = w_rewrite.data_port->GetName(),
+        .write_mask_name = w_rewrite.mask_port->GetName(),
+        .write_enable_name = w_rewrite.en_port->GetName(),
+    };
+    for (int64_t i = 0; i < r_rewrites.size(); ++i) {
+      const RamRPortConfiguration& r_port_config =
+          ram_config.r_port_configurations()[i];
+      const RPortRewrite& r_rewrite = r_rewrites[i];
+      channel_names.push_back(r_port_config.request_channel_name);
+      channel_names.push_back(r_port_config.response_channel_name);
+      output_ports.insert(output_ports.end(),
+                          {r_rewrite.addr_port, r_rewrite.mask_port,
+                           r_rewrite.en_port});
+      input_ports.push_back(r_rewrite.data_port);
+      args.r_ports.push_back(ModuleSignatureBuilder::RamRPortArgs{
+          .req_name = r_port_config.request_channel_name,
+          .resp_name = r_port_config.response_channel_name,
+          .mask_width = r_rewrite.mask_port->GetType()->GetFlatBitCount(),
+          .address_name = r_rewrite.addr_port->GetName(),
+          .data_name = r_rewrite.data_port->GetName(),
+          .mask_name = r_rewrite.mask_port->GetName(),
+          .enable_name = r_rewrite.en_port->GetName(),
+      });
+    }
+    channel_names.push_back(
+        ram_config.w_port_configuration().request_channel_name);
+    channel_names.push_back(
+        ram_config.w_port_configuration().write_completion_channel_name);
+    output_ports.insert(output_ports.end(),
+                        {w_rewrite.addr_port, w_rewrite.data_port,
+                         w_rewrite.mask_port, w_rewrite.en_port});
+    XLS_RETURN_IF_ERROR(UpdateSignatureForRamPorts(
+        block, channel_names, output_ports, input_ports, builder));
+    builder.AddRamNR1W(args);
+
+    XLS_ASSIGN_OR_RETURN(*signature, builder.Build());
+  }
+
+  return true;
+}
+
 absl::flat_hash_map<std::string, ram_rewrite_function_t>*
 GetRamRewriteFunctionMap() {
   static auto* singleton =
       new absl::flat_hash_map<std::string, ram_rewrite_function_t>{
           {"1RW", Ram1RWRewrite},
           {"1R1W", Ram1R1WRewrite},
+          {"nR1W", RamNR1WRewrite},
       };
   return singleton;
 }
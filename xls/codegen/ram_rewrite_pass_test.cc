@@ -14,6 +14,7 @@
 
 #include "xls/codegen/ram_rewrite_pass.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -25,6 +26,7 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_replace.h"
 #include "absl/types/variant.h"
@@ -41,6 +43,7 @@
 #include "xls/delay_model/delay_estimators.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/proc.h"
+#include "xls/ir/register.h"
 #include "xls/scheduling/run_pipeline_schedule.h"
 #include "xls/scheduling/scheduling_options.h"
 
@@ -222,44 +225,8 @@ class RamRewritePassTest
     // Add constraints for each ram config to be scheduled according to the
     // config's latency
     for (const auto& ram_config : codegen_options.ram_configurations()) {
-      if (ram_config->ram_kind() == "1RW") {
-        auto* ram1rw_config = down_cast<Ram1RWConfiguration*>(ram_config.get());
-        scheduling_options.add_constraint(IOConstraint(
-            ram1rw_config->rw_port_configuration().request_channel_name,
-            IODirection::kSend,
-            ram1rw_config->rw_port_configuration().response_channel_name,
-            IODirection::kReceive,
-            /*minimum_latency=*/ram1rw_config->latency(),
-            /*maximum_latency=*/ram1rw_config->latency()));
-        scheduling_options.add_constraint(IOConstraint(
-            ram1rw_config->rw_port_configuration().request_channel_name,
-            IODirection::kSend,
-            ram1rw_config->rw_port_configuration()
-                .write_completion_channel_name,
-            IODirection::kReceive,
-            /*minimum_latency=*/ram1rw_config->latency(),
-            /*maximum_latency=*/ram1rw_config->latency()));
-        continue;
-      }
-      if (ram_config->ram_kind() == "1R1W") {
-        auto* ram1r1w_config =
-            down_cast<Ram1R1WConfiguration*>(ram_config.get());
-        scheduling_options.add_constraint(IOConstraint(
-            ram1r1w_config->r_port_configuration().request_channel_name,
-            IODirection::kSend,
-            ram1r1w_config->r_port_configuration().response_channel_name,
-            IODirection::kReceive,
-            /*minimum_latency=*/ram1r1w_config->latency(),
-            /*maximum_latency=*/ram1r1w_config->latency()));
-        scheduling_options.add_constraint(IOConstraint(
-            ram1r1w_config->w_port_configuration().request_channel_name,
-            IODirection::kSend,
-            ram1r1w_config->w_port_configuration()
-                .write_completion_channel_name,
-            IODirection::kReceive,
-            /*minimum_latency=*/ram1r1w_config->latency(),
-            /*maximum_latency=*/ram1r1w_config->latency()));
-        continue;
+      for (const IOConstraint& constraint : ram_config->GetIOConstraints()) {
+        scheduling_options.add_constraint(constraint);
       }
     }
 
@@ -294,7 +261,7 @@ TEST_P(RamRewritePassTest, PortsUpdated) {
 
   for (const auto& config : codegen_options.ram_configurations()) {
     std::vector<std::string_view> old_channel_names;
-    EXPECT_THAT(config->ram_kind(), AnyOf(Eq("1RW"), Eq("1R1W")));
+    EXPECT_THAT(config->ram_kind(), AnyOf(Eq("1RW"), Eq("1R1W"), Eq("nR1W")));
     if (config->ram_kind() == "1RW") {
       auto* ram1rw_config = down_cast<Ram1RWConfiguration*>(config.get());
       EXPECT_THAT(
@@ -367,6 +334,34 @@ TEST_P(RamRewritePassTest, PortsUpdated) {
           ram1r1w_config->r_port_configuration().response_channel_name);
       old_channel_names.push_back(
           ram1r1w_config->w_port_configuration().request_channel_name);
+    } else if (config->ram_kind() == "nR1W") {
+      auto* ramnr1w_config = down_cast<RamNR1WConfiguration*>(config.get());
+      for (int64_t i = 0; i < ramnr1w_config->r_port_configurations().size();
+           ++i) {
+        std::string prefix = absl::StrCat(config->ram_name(), "_", i);
+        EXPECT_THAT(
+            block->GetPorts(),
+            AllOf(Contains(PortByName(absl::StrCat(prefix, "_rd_en"))),
+                  Contains(PortByName(absl::StrCat(prefix, "_rd_addr"))),
+                  Contains(PortByName(absl::StrCat(prefix, "_rd_data")))));
+        if (ExpectReadMask()) {
+          EXPECT_THAT(block->GetPorts(),
+                      Contains(PortByName(absl::StrCat(prefix, "_rd_mask"))));
+        }
+        old_channel_names.push_back(ramnr1w_config->r_port_configurations()[i]
+                                        .request_channel_name);
+        old_channel_names.push_back(ramnr1w_config->r_port_configurations()[i]
+                                        .response_channel_name);
+      }
+      EXPECT_THAT(block->GetPorts(),
+                  AllOf(Contains(PortByName(
+                            absl::StrFormat("%s_wr_en", config->ram_name()))),
+                        Contains(PortByName(
+                            absl::StrFormat("%s_wr_addr", config->ram_name()))),
+                        Contains(PortByName(absl::StrFormat(
+                            "%s_wr_data", config->ram_name())))));
+      old_channel_names.push_back(
+          ramnr1w_config->w_port_configuration().request_channel_name);
     }
     for (auto old_channel_name : old_channel_names) {
       EXPECT_THAT(
@@ -413,7 +408,7 @@ TEST_P(RamRewritePassTest, ModuleSignatureUpdated) {
   EXPECT_TRUE(unit.signature.has_value());
   for (const auto& config : codegen_options.ram_configurations()) {
     absl::flat_hash_set<std::string_view> channel_names;
-    EXPECT_THAT(config->ram_kind(), AnyOf(Eq("1RW"), Eq("1R1W")));
+    EXPECT_THAT(config->ram_kind(), AnyOf(Eq("1RW"), Eq("1R1W"), Eq("nR1W")));
     if (config->ram_kind() == "1RW") {
       auto* ram1rw_config = down_cast<Ram1RWConfiguration*>(config.get());
       bool found = false;
@@ -538,6 +533,47 @@ TEST_P(RamRewritePassTest, ModuleSignatureUpdated) {
       EXPECT_THAT(unit.signature->data_inputs(),
                   Contains(PortProtoByName(
                       absl::StrCat(ram1r1w_config->ram_name(), "_rd_data"))));
+    } else if (config->ram_kind() == "nR1W") {
+      auto* ramnr1w_config = down_cast<RamNR1WConfiguration*>(config.get());
+      bool found = false;
+      for (auto& ram : unit.signature->rams()) {
+        if (ram.ram_oneof_case() != RamProto::RamOneofCase::kRamNr1W) {
+          continue;
+        }
+        if (ram.ram_nr1w().r_ports_size() ==
+                ramnr1w_config->r_port_configurations().size() &&
+            ram.ram_nr1w().w_port().request().name() ==
+                ramnr1w_config->w_port_configuration().request_channel_name) {
+          found = true;
+        }
+      }
+      EXPECT_TRUE(found);
+      for (int64_t i = 0; i < ramnr1w_config->r_port_configurations().size();
+           ++i) {
+        const RamRPortConfiguration& r_port_config =
+            ramnr1w_config->r_port_configurations()[i];
+        channel_names.insert(r_port_config.request_channel_name);
+        channel_names.insert(r_port_config.response_channel_name);
+        std::string prefix = absl::StrCat(ramnr1w_config->ram_name(), "_", i);
+        EXPECT_THAT(
+            unit.signature->data_outputs(),
+            AllOf(Contains(PortProtoByName(absl::StrCat(prefix, "_rd_addr"))),
+                  Contains(PortProtoByName(absl::StrCat(prefix, "_rd_en")))));
+        EXPECT_THAT(
+            unit.signature->data_inputs(),
+            Contains(PortProtoByName(absl::StrCat(prefix, "_rd_data"))));
+      }
+      channel_names.insert(
+          ramnr1w_config->w_port_configuration().request_channel_name);
+      channel_names.insert(
+          ramnr1w_config->w_port_configuration().write_completion_channel_name);
+      EXPECT_THAT(unit.signature->data_outputs(),
+                  AllOf(Contains(PortProtoByName(absl::StrCat(
+                            ramnr1w_config->ram_name(), "_wr_addr"))),
+                        Contains(PortProtoByName(absl::StrCat(
+                            ramnr1w_config->ram_name(), "_wr_data"))),
+                        Contains(PortProtoByName(absl::StrCat(
+                            ramnr1w_config->ram_name(), "_wr_en")))));
     }
     for (auto& channel : unit.signature->streaming_channels()) {
       EXPECT_THAT(channel_names, Not(Contains(Eq(channel.name()))));
@@ -594,10 +630,57 @@ TEST_P(RamRewritePassTest, WriteCompletionRemoved) {
                       PortByName(absl::StrCat(wr_comp_name, "_ready")),
                       PortByName(wr_comp_name),
                       PortByName(absl::StrCat(wr_comp_name, "_valid"))))));
+    } else if (config->ram_kind() == "nR1W") {
+      auto* ramnr1w_config = down_cast<RamNR1WConfiguration*>(config.get());
+      std::string_view wr_comp_name =
+          ramnr1w_config->w_port_configuration().write_completion_channel_name;
+      EXPECT_THAT(block->GetPorts(),
+                  Not(Contains(AnyOf(
+                      PortByName(absl::StrCat(wr_comp_name, "_ready")),
+                      PortByName(wr_comp_name),
+                      PortByName(absl::StrCat(wr_comp_name, "_valid"))))));
     }
   }
 }
 
+// A pipelined RAM can have `latency` responses in flight, so each read port
+// must get one skid buffer per cycle of latency.
+TEST_P(RamRewritePassTest, SkidBuffersMatchLatency) {
+  auto& param = std::get<0>(GetParam());
+  CodegenOptions codegen_options = GetCodegenOptions();
+  CodegenPassOptions pass_options{
+      .codegen_options = codegen_options,
+  };
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(param.ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(auto block,
+                           MakeBlock(package.get(), codegen_options));
+  auto pipeline = std::get<1>(GetParam());
+  CodegenPassUnit unit(block->package(), block);
+  PassResults results;
+  XLS_ASSERT_OK(pipeline->Run(&unit, pass_options, &results).status());
+
+  for (const auto& config : codegen_options.ram_configurations()) {
+    int64_t read_ports = 1;
+    if (config->ram_kind() == "nR1W") {
+      read_ports = down_cast<RamNR1WConfiguration*>(config.get())
+                       ->r_port_configurations()
+                       .size();
+    }
+    std::string prefix = absl::StrCat(config->ram_name(), "_");
+    int64_t skid_buffers = 0;
+    for (Register* reg : block->GetRegisters()) {
+      if (absl::StartsWith(reg->name(), prefix) &&
+          absl::StrContains(reg->name(), "_ram_zero_latency") &&
+          absl::EndsWith(reg->name(), "_valid_skid")) {
+        ++skid_buffers;
+      }
+    }
+    EXPECT_EQ(skid_buffers, read_ports * config->latency())
+        << config->ram_name();
+  }
+}
+
 // Tests implicitly rely on rams being named ram0, ram1, and so on.
 constexpr std::string_view kSingle1RW[] = {"ram0:1RW:req:resp:wr_comp"};
 
@@ -616,6 +699,15 @@ constexpr std::string_view kThree1R1W[] = {
     std::string_view("ram2:1R1W:rd_req2:rd_resp2:wr_req2:wr_comp2"),
 };
 
+constexpr std::string_view kSingle1RWLatency2[] = {
+    "ram0:1RW:req:resp:wr_comp:2"};
+
+constexpr std::string_view kSingle1R1WLatency2[] = {
+    "ram0:1R1W:rd_req:rd_resp:wr_req:wr_comp:2"};
+
+constexpr std::string_view kSingle2R1W[] = {
+    "ram0:nR1W:rd_req0:rd_resp0:rd_req1:rd_resp1:wr_req:wr_comp"};
+
 constexpr std::string_view k1RWAnd1R1W[] = {
     std::string_view("ram0:1RW:req0:resp0:wr_comp0"),
     std::string_view("ram1:1R1W:rd_req1:rd_resp1:wr_req1:wr_comp1"),
@@ -931,6 +1023,89 @@ proc my_proc(__token: token, __state: bits[32], init={0}) {
         .pipeline_stages = 4,
         .ram_config_strings = k1RWAnd1R1W,
     },
+    RamChannelRewriteTestParam{
+        .test_name = "Simple32Bit1RWLatency2",
+        .ir_text = R"(package  test
+chan req((bits[32], bits[32], (), (), bits[1], bits[1]), id=0, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="""""")
+chan resp((bits[32]), id=1, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="""""")
+chan wr_comp((), id=2, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="""""")
+
+proc my_proc(__token: token, __state: bits[32], init={0}) {
+  empty_tuple: () = literal(value=())
+  true_lit: bits[1] = literal(value=1)
+  false_lit: bits[1] = literal(value=0)
+  to_send: (bits[32], bits[32], (), (), bits[1], bits[1]) = tuple(__state, __state, empty_tuple, empty_tuple, true_lit, false_lit)
+  send_token: token = send(__token, to_send, channel_id=0)
+  rcv: (token, (bits[32])) = receive(send_token, channel_id=1)
+  rcv_token: token = tuple_index(rcv, index=0)
+  wr_comp_rcv: (token, ()) = receive(rcv_token, channel_id=2)
+  wr_comp_token: token = tuple_index(wr_comp_rcv, index=0)
+  one_lit: bits[32] = literal(value=1)
+  next_state: bits[32] = add(__state, one_lit)
+  next (wr_comp_token, next_state)
+}
+  )",
+        .pipeline_stages = 3,
+        .ram_config_strings = kSingle1RWLatency2,
+    },
+    RamChannelRewriteTestParam{
+        .test_name = "Simple32Bit1R1WLatency2",
+        .ir_text = R"(package  test
+chan rd_req((bits[32], ()), id=0, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="""""")
+chan rd_resp((bits[32]), id=1, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="""""")
+chan wr_req((bits[32], bits[32], ()), id=2, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="""""")
+chan wr_comp((), id=3, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="""""")
+
+proc my_proc(__token: token, __state: bits[32], init={0}) {
+  empty_tuple: () = literal(value=())
+  to_send0: (bits[32], ()) = tuple(__state, empty_tuple)
+  send_token0: token = send(__token, to_send0, channel_id=0)
+  rcv: (token, (bits[32])) = receive(send_token0, channel_id=1)
+  rcv_token: token = tuple_index(rcv, index=0)
+  to_send1: (bits[32], bits[32], ()) = tuple(__state, __state, empty_tuple)
+  send_token1: token = send(rcv_token, to_send1, channel_id=2)
+  wr_comp_rcv: (token, ()) = receive(send_token1, channel_id=3)
+  wr_comp_token: token = tuple_index(wr_comp_rcv, index=0)
+  one_lit: bits[32] = literal(value=1)
+  next_state: bits[32] = add(__state, one_lit)
+  next (wr_comp_token, next_state)
+}
+  )",
+        .pipeline_stages = 5,
+        .ram_config_strings = kSingle1R1WLatency2,
+    },
+    RamChannelRewriteTestParam{
+        .test_name = "Simple32Bit2R1W",
+        .ir_text = R"(package  test
+chan rd_req0((bits[32], ()), id=0, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="""""")
+chan rd_resp0((bits[32]), id=1, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="""""")
+chan rd_req1((bits[32], ()), id=2, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="""""")
+chan rd_resp1((bits[32]), id=3, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="""""")
+chan wr_req((bits[32], bits[32], ()), id=4, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="""""")
+chan wr_comp((), id=5, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="""""")
+
+proc my_proc(__token: token, __state: bits[32], init={0}) {
+  empty_tuple: () = literal(value=())
+  to_send0: (bits[32], ()) = tuple(__state, empty_tuple)
+  send_token0: token = send(__token, to_send0, channel_id=0)
+  send_token1: token = send(__token, to_send0, channel_id=2)
+  rcv0: (token, (bits[32])) = receive(send_token0, channel_id=1)
+  rcv1: (token, (bits[32])) = receive(send_token1, channel_id=3)
+  rcv_token0: token = tuple_index(rcv0, index=0)
+  rcv_token1: token = tuple_index(rcv1, index=0)
+  rcv_token: token = after_all(rcv_token0, rcv_token1)
+  to_send2: (bits[32], bits[32], ()) = tuple(__state, __state, empty_tuple)
+  send_token2: token = send(rcv_token, to_send2, channel_id=4)
+  wr_comp_rcv: (token, ()) = receive(send_token2, channel_id=5)
+  wr_comp_token: token = tuple_index(wr_comp_rcv, index=0)
+  one_lit: bits[32] = literal(value=1)
+  next_state: bits[32] = add(__state, one_lit)
+  next (wr_comp_token, next_state)
+}
+  )",
+        .pipeline_stages = 3,
+        .ram_config_strings = kSingle2R1W,
+    },
 };
 
 INSTANTIATE_TEST_SUITE_P(
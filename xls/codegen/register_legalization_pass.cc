@@ -14,6 +14,7 @@
 
 #include "xls/codegen/register_legalization_pass.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "xls/common/logging/logging.h"
@@ -44,6 +45,16 @@ absl::StatusOr<bool> RegisterLegalizationPass::RunInternal(
               .status());
       XLS_RETURN_IF_ERROR(block->RemoveNode(reg_read));
       XLS_RETURN_IF_ERROR(block->RemoveNode(reg_write));
+      // Drop the register from the pipeline metadata before it is destroyed.
+      for (PipelineStageRegisters& stage_registers :
+           unit->streaming_io_and_pipeline.pipeline_registers) {
+        stage_registers.erase(
+            std::remove_if(stage_registers.begin(), stage_registers.end(),
+                           [reg](const PipelineRegister& pipeline_register) {
+                             return pipeline_register.reg == reg;
+                           }),
+            stage_registers.end());
+      }
       XLS_RETURN_IF_ERROR(block->RemoveRegister(reg));
       changed = true;
     }
@@ -33,6 +33,7 @@
 #include "xls/common/indent.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/tracing.h"
 #include "xls/common/visitor.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/code_template.h"
@@ -102,6 +103,11 @@ void LineInfo::End(const VastNode* node) {
       << "LineInfoEnd can't be called twice in a row on the same node!";
   int64_t start_line = spans_.at(node).hanging_start_line.value();
   int64_t end_line = current_line_number_;
+  if (on_span_) {
+    spans_.erase(node);
+    on_span_(node, LineSpan(start_line, end_line));
+    return;
+  }
   spans_.at(node).completed_spans.push_back(LineSpan(start_line, end_line));
   spans_.at(node).hanging_start_line = std::nullopt;
 }
@@ -119,6 +125,45 @@ std::optional<std::vector<LineSpan>> LineInfo::LookupNode(
   return spans_.at(node).completed_spans;
 }
 
+void VastStream::Write(std::string_view text) {
+  if (indent_ == 0 && !drop_newlines_) {
+    if (!text.empty()) {
+      sink_(text);
+      at_line_start_ = text.back() == '\n';
+    }
+    return;
+  }
+  while (!text.empty()) {
+    if (text.front() == '\n') {
+      if (!drop_newlines_) {
+        sink_("\n");
+      }
+      at_line_start_ = true;
+      text.remove_prefix(1);
+      continue;
+    }
+    std::string_view line = text.substr(0, text.find('\n'));
+    if (at_line_start_) {
+      sink_(std::string(indent_, ' '));
+    }
+    sink_(line);
+    at_line_start_ = false;
+    drop_newlines_ = false;
+    text.remove_prefix(line.size());
+  }
+}
+
+void VastStream::Indent() {
+  indent_ += kDefaultIndentSpaces;
+  drop_newlines_ = true;
+}
+
+void VastStream::Dedent() {
+  XLS_CHECK_GE(indent_, kDefaultIndentSpaces);
+  indent_ -= kDefaultIndentSpaces;
+  drop_newlines_ = false;
+}
+
 std::string SanitizeIdentifier(std::string_view name) {
   if (name.empty()) {
     return "_";
@@ -217,21 +262,25 @@ DataType* VerilogFile::UnpackedArrayType(int64_t element_bit_count,
 }
 
 std::string VerilogFile::Emit(LineInfo* line_info) const {
-  auto file_member_str = [=](const FileMember& member) -> std::string {
-    return absl::visit(
-        Visitor{[=](Include* m) -> std::string { return m->Emit(line_info); },
-                [=](Module* m) -> std::string { return m->Emit(line_info); },
-                [=](BlankLine* m) -> std::string { return m->Emit(line_info); },
-                [=](Comment* m) -> std::string { return m->Emit(line_info); }},
-        member);
-  };
-
+  ScopedTraceSpan trace_span("codegen", "vast_emit");
   std::string out;
+  VastStream stream(
+      [&out](std::string_view text) { absl::StrAppend(&out, text); });
+  EmitTo(&stream, line_info);
+  return out;
+}
+
+void VerilogFile::EmitTo(VastStream* out, LineInfo* line_info) const {
   for (const FileMember& member : members_) {
-    absl::StrAppend(&out, file_member_str(member), "\n");
+    absl::visit(
+        Visitor{[=](Include* m) { out->Write(m->Emit(line_info)); },
+                [=](Module* m) { m->EmitTo(out, line_info); },
+                [=](BlankLine* m) { out->Write(m->Emit(line_info)); },
+                [=](Comment* m) { out->Write(m->Emit(line_info)); }},
+        member);
+    out->Write("\n");
     LineInfoIncrease(line_info, 1);
   }
-  return out;
 }
 
 LocalParamItemRef* LocalParam::AddItem(std::string_view name,
@@ -578,22 +627,38 @@ std::string EmitModuleMember(LineInfo* line_info, const ModuleMember& member) {
 }  // namespace
 
 std::string ModuleSection::Emit(LineInfo* line_info) const {
+  std::string out;
+  VastStream stream(
+      [&out](std::string_view text) { absl::StrAppend(&out, text); });
+  EmitTo(&stream, line_info);
+  return out;
+}
+
+void ModuleSection::EmitTo(VastStream* out, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::vector<std::string> elements;
+  bool first = true;
   for (const ModuleMember& member : members_) {
     if (std::holds_alternative<ModuleSection*>(member)) {
       if (std::get<ModuleSection*>(member)->members_.empty()) {
         continue;
       }
     }
-    elements.push_back(EmitModuleMember(line_info, member));
+    if (!first) {
+      out->Write("\n");
+    }
+    first = false;
+    if (std::holds_alternative<ModuleSection*>(member)) {
+      // Stream nested sections rather than emitting them to a string first.
+      std::get<ModuleSection*>(member)->EmitTo(out, line_info);
+    } else {
+      out->Write(EmitModuleMember(line_info, member));
+    }
     LineInfoIncrease(line_info, 1);
   }
-  if (!elements.empty()) {
+  if (!first) {
     LineInfoIncrease(line_info, -1);
   }
   LineInfoEnd(line_info, this);
-  return absl::StrJoin(elements, "\n");
 }
 
 std::string ContinuousAssignment::Emit(LineInfo* line_info) const {
@@ -698,29 +763,38 @@ std::string SystemFunctionCall::Emit(LineInfo* line_info) const {
 }
 
 std::string Module::Emit(LineInfo* line_info) const {
+  std::string out;
+  VastStream stream(
+      [&out](std::string_view text) { absl::StrAppend(&out, text); });
+  EmitTo(&stream, line_info);
+  return out;
+}
+
+void Module::EmitTo(VastStream* out, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::string result = absl::StrCat("module ", name_);
+  out->Write(absl::StrCat("module ", name_));
   if (ports_.empty()) {
-    absl::StrAppend(&result, ";\n");
+    out->Write(";\n");
     LineInfoIncrease(line_info, 1);
   } else {
-    absl::StrAppend(&result, "(\n  ");
+    out->Write("(\n  ");
     LineInfoIncrease(line_info, 1);
-    absl::StrAppend(
-        &result,
-        absl::StrJoin(ports_, ",\n  ", [=](std::string* out, const Port& port) {
-          absl::StrAppendFormat(out, "%s %s", ToString(port.direction),
+    out->Write(
+        absl::StrJoin(ports_, ",\n  ", [=](std::string* s, const Port& port) {
+          absl::StrAppendFormat(s, "%s %s", ToString(port.direction),
                                 port.wire->EmitNoSemi(line_info));
           LineInfoIncrease(line_info, 1);
         }));
-    absl::StrAppend(&result, "\n);\n");
+    out->Write("\n);\n");
     LineInfoIncrease(line_info, 1);
   }
-  absl::StrAppend(&result, Indent(top_.Emit(line_info)), "\n");
+  out->Indent();
+  top_.EmitTo(out, line_info);
+  out->Dedent();
+  out->Write("\n");
   LineInfoIncrease(line_info, 1);
-  absl::StrAppend(&result, "endmodule");
+  out->Write("endmodule");
   LineInfoEnd(line_info, this);
-  return result;
 }
 
 std::string Literal::Emit(LineInfo* line_info) const {
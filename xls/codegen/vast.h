@@ -19,6 +19,7 @@
 #define XLS_CODEGEN_VAST_H_
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <ostream>
@@ -101,8 +102,18 @@ struct PartialLineSpans {
 // accepts a `LineInfo*` can safely accept a `nullptr`.
 class LineInfo {
  public:
+  // Callback invoked with each completed span.
+  using SpanCallback = std::function<void(const VastNode*, const LineSpan&)>;
+
   LineInfo() = default;
 
+  // Creates a LineInfo which passes each span to `on_span` as soon as it is
+  // completed rather than retaining it. Only nodes with a hanging span are
+  // tracked, so memory use is bounded by the nesting depth of the emitted nodes
+  // instead of the size of the file. In this mode `Spans` and `LookupNode` only
+  // reflect hanging spans.
+  explicit LineInfo(SpanCallback on_span) : on_span_(std::move(on_span)) {}
+
   // Start recording a region in which the given node is active.
   // CHECK fails if called multiple times with no intervening `End` calls.
   void Start(const VastNode* node);
@@ -139,10 +150,38 @@ class LineInfo {
   std::optional<std::vector<LineSpan>> LookupNode(const VastNode* node) const;
 
  private:
+  SpanCallback on_span_;
   int64_t current_line_number_ = 0;
   absl::flat_hash_map<const VastNode*, PartialLineSpans> spans_;
 };
 
+// An output sink for incrementally emitted Verilog text. Text written to the
+// stream is forwarded to the sink function (e.g., writing to a file or
+// appending to an absl::Cord) as it is emitted, indented by the current
+// indentation level. Emitting through a VastStream avoids materializing the
+// text of a whole module or file as a single string.
+class VastStream {
+ public:
+  explicit VastStream(std::function<void(std::string_view)> sink)
+      : sink_(std::move(sink)) {}
+
+  // Writes the given text. Each non-empty line is prefixed with the current
+  // indentation.
+  void Write(std::string_view text);
+
+  // Increases/decreases the indentation of subsequently written lines by two
+  // spaces. Newlines written before any other text following a call to
+  // `Indent` are dropped, matching the behavior of `xls::Indent`.
+  void Indent();
+  void Dedent();
+
+ private:
+  std::function<void(std::string_view)> sink_;
+  int64_t indent_ = 0;
+  bool at_line_start_ = true;
+  bool drop_newlines_ = false;
+};
+
 // Returns a sanitized identifier string based on the given name. Invalid
 // characters are replaced with '_'.
 std::string SanitizeIdentifier(std::string_view name);
@@ -1499,6 +1538,9 @@ class ModuleSection : public VastNode {
 
   std::string Emit(LineInfo* line_info) const override;
 
+  // Writes the section to `out` one member at a time.
+  void EmitTo(VastStream* out, LineInfo* line_info) const;
+
  private:
   std::vector<ModuleMember> members_;
 };
@@ -1562,6 +1604,9 @@ class Module : public VastNode {
 
   std::string Emit(LineInfo* line_info) const override;
 
+  // Writes the module to `out` one member at a time.
+  void EmitTo(VastStream* out, LineInfo* line_info) const;
+
  private:
   // Add the given Def as a port on the module.
   LogicRef* AddPortDef(Direction direction, Def* def, const SourceInfo& loc);
@@ -1605,6 +1650,10 @@ class VerilogFile {
     members_.push_back(member);
     return member;
   }
+  void Add(FileMember member) { members_.push_back(member); }
+
+  // Returns the top-level members of the file in emission order.
+  absl::Span<const FileMember> members() const { return members_; }
 
   template <typename T, typename... Args>
   T* Make(const SourceInfo& loc, Args&&... args) {
@@ -1617,6 +1666,10 @@ class VerilogFile {
 
   std::string Emit(LineInfo* line_info = nullptr) const;
 
+  // Writes the file to `out` incrementally. Peak memory is bounded by the text
+  // of the largest module member rather than that of the whole file.
+  void EmitTo(VastStream* out, LineInfo* line_info = nullptr) const;
+
   verilog::Slice* Slice(IndexableExpression* subject, Expression* hi,
                         Expression* lo, const SourceInfo& loc) {
     return Make<verilog::Slice>(loc, subject, hi, lo);
@@ -21,7 +21,9 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/foreign_function.h"
 #include "xls/ir/number_parser.h"
@@ -1240,6 +1242,85 @@ endmodule)");
             std::vector<LineSpan>{LineSpan(7, 7)});
 }
 
+TEST_P(VastTest, StreamingEmission) {
+  VerilogFile f(GetFileType());
+  f.Add(f.Make<Comment>(SourceInfo(), "header"));
+  Module* module = f.AddModule("my_module", SourceInfo());
+  LogicRef* a =
+      module->AddInput("a", f.BitVectorType(8, SourceInfo()), SourceInfo());
+  LogicRef* out =
+      module->AddOutput("out", f.BitVectorType(8, SourceInfo()), SourceInfo());
+  ModuleSection* section = module->Add<ModuleSection>(SourceInfo());
+  section->Add<BlankLine>(SourceInfo());
+  section->Add<ContinuousAssignment>(SourceInfo(), out,
+                                     f.BitwiseNot(a, SourceInfo()));
+  section->Add<InlineVerilogStatement>(SourceInfo(), "`FOO\n`BAR");
+  f.Add(f.Make<BlankLine>(SourceInfo()));
+  f.AddModule("empty_module", SourceInfo());
+
+  std::vector<std::string> chunks;
+  VastStream stream(
+      [&](std::string_view text) { chunks.push_back(std::string(text)); });
+  LineInfo streamed_line_info;
+  f.EmitTo(&stream, &streamed_line_info);
+
+  // The file is written in pieces which concatenate to the same text (and line
+  // information) as the non-streaming emitter.
+  LineInfo line_info;
+  std::string text = f.Emit(&line_info);
+  EXPECT_GT(chunks.size(), 1);
+  EXPECT_EQ(absl::StrJoin(chunks, ""), text);
+  EXPECT_EQ(text, R"(// header
+module my_module(
+  input wire [7:0] a,
+  output wire [7:0] out
+);
+  assign out = ~a;
+  `FOO
+  `BAR
+endmodule
+
+module empty_module;
+
+endmodule
+)");
+  EXPECT_EQ(streamed_line_info.LookupNode(module),
+            line_info.LookupNode(module));
+  EXPECT_EQ(streamed_line_info.LookupNode(section),
+            line_info.LookupNode(section));
+}
+
+TEST_P(VastTest, LineInfoSpanCallback) {
+  VerilogFile f(GetFileType());
+  Module* module = f.AddModule("my_module", SourceInfo());
+  LogicRef* a =
+      module->AddInput("a", f.BitVectorType(8, SourceInfo()), SourceInfo());
+  LogicRef* out =
+      module->AddOutput("out", f.BitVectorType(8, SourceInfo()), SourceInfo());
+  ModuleSection* section = module->Add<ModuleSection>(SourceInfo());
+  section->Add<Comment>(SourceInfo(), "two\nlines");
+  section->Add<ContinuousAssignment>(SourceInfo(), out,
+                                     f.BitwiseNot(a, SourceInfo()));
+
+  absl::flat_hash_map<const VastNode*, std::vector<LineSpan>> reported;
+  LineInfo streamed_line_info(
+      [&](const VastNode* node, const LineSpan& span) {
+        reported[node].push_back(span);
+      });
+  VastStream stream([](std::string_view) {});
+  f.EmitTo(&stream, &streamed_line_info);
+
+  // Every span is reported and none are retained.
+  LineInfo line_info;
+  f.Emit(&line_info);
+  EXPECT_TRUE(streamed_line_info.Spans().empty());
+  EXPECT_EQ(reported.size(), line_info.Spans().size());
+  for (const auto& [node, spans] : line_info.Spans()) {
+    EXPECT_EQ(reported[node], spans.completed_spans);
+  }
+  EXPECT_EQ(reported[section], std::vector<LineSpan>{LineSpan(4, 6)});
+}
+
 TEST_P(VastTest, VerilogFunction) {
   VerilogFile f(GetFileType());
   Module* m = f.AddModule("top", SourceInfo());
@@ -0,0 +1,121 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/file/mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <string>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "xls/common/file/file_descriptor.h"
+#include "xls/common/status/error_code_to_status.h"
+
+namespace xls {
+
+/* static */ absl::StatusOr<MappedFile> MappedFile::Open(
+    const std::filesystem::path& path, AccessPattern access_pattern) {
+  FileDescriptor fd(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+  if (fd.get() == -1) {
+    return ErrnoToStatus(errno) << path.string();
+  }
+  struct stat st;
+  if (fstat(fd.get(), &st) != 0) {
+    return ErrnoToStatus(errno) << path.string();
+  }
+  if (!S_ISREG(st.st_mode)) {
+    std::string buffer;
+    char chunk[4096];
+    while (true) {
+      ssize_t bytes = read(fd.get(), chunk, sizeof(chunk));
+      if (bytes == -1 && errno == EINTR) {
+        continue;
+      }
+      if (bytes == -1) {
+        return ErrnoToStatus(errno) << path.string();
+      }
+      if (bytes == 0) {
+        return MappedFile(std::move(buffer));
+      }
+      buffer.append(chunk, bytes);
+    }
+  }
+  // Zero-length mappings are not permitted.
+  if (st.st_size == 0) {
+    return MappedFile(nullptr, 0);
+  }
+  void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+  if (data == MAP_FAILED) {
+    return ErrnoToStatus(errno) << path.string();
+  }
+  // The mapping remains valid after the descriptor is closed.
+  MappedFile file(data, st.st_size);
+  file.Advise(access_pattern);
+  return file;
+}
+
+void MappedFile::Advise(AccessPattern access_pattern) const {
+  if (data_ == nullptr) {
+    return;
+  }
+  int advice = POSIX_MADV_NORMAL;
+  switch (access_pattern) {
+    case AccessPattern::kNormal:
+      advice = POSIX_MADV_NORMAL;
+      break;
+    case AccessPattern::kSequential:
+      advice = POSIX_MADV_SEQUENTIAL;
+      break;
+    case AccessPattern::kRandom:
+      advice = POSIX_MADV_RANDOM;
+      break;
+  }
+  // This is only a hint, so failures are ignored.
+  posix_madvise(data_, size_, advice);
+}
+
+MappedFile::~MappedFile() { Unmap(); }
+
+MappedFile::MappedFile(MappedFile&& other)
+    : data_(other.data_),
+      size_(other.size_),
+      buffer_(std::move(other.buffer_)) {
+  other.data_ = nullptr;
+  other.size_ = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+  Unmap();
+  data_ = std::exchange(other.data_, nullptr);
+  size_ = std::exchange(other.size_, 0);
+  buffer_ = std::move(other.buffer_);
+  return *this;
+}
+
+void MappedFile::Unmap() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+    data_ = nullptr;
+    size_ = 0;
+  }
+}
+
+}  // namespace xls
@@ -0,0 +1,84 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_FILE_MAPPED_FILE_H_
+#define XLS_COMMON_FILE_MAPPED_FILE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/statusor.h"
+
+namespace xls {
+
+// RAII wrapper around a read-only memory mapping of a file. The contents are
+// paged in on demand, which avoids copying large inputs into memory up front.
+// Files which cannot be mapped, such as pipes (e.g. /dev/stdin), are read into
+// memory instead.
+class MappedFile {
+ public:
+  // How the contents are expected to be accessed. Passed to the kernel as an
+  // madvise hint to tune readahead.
+  enum class AccessPattern {
+    kNormal,
+    // Read front to back once, as done by the parsers. Pages are read ahead
+    // aggressively and may be dropped soon after they were accessed.
+    kSequential,
+    // Accessed at scattered offsets; readahead is disabled.
+    kRandom,
+  };
+
+  // Maps the file at `path` into memory.
+  static absl::StatusOr<MappedFile> Open(
+      const std::filesystem::path& path,
+      AccessPattern access_pattern = AccessPattern::kSequential);
+
+  // Changes the access pattern hint for the whole mapping.
+  void Advise(AccessPattern access_pattern) const;
+
+  ~MappedFile();
+
+  // MappedFile is movable but not copyable.
+  MappedFile(MappedFile&& other);
+  MappedFile& operator=(MappedFile&& other);
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // Returns the contents of the file. The view is valid for the lifetime of
+  // this object.
+  std::string_view contents() const {
+    if (data_ == nullptr) {
+      return buffer_;
+    }
+    return std::string_view(static_cast<const char*>(data_), size_);
+  }
+
+ private:
+  MappedFile(void* data, int64_t size) : data_(data), size_(size) {}
+  explicit MappedFile(std::string buffer) : buffer_(std::move(buffer)) {}
+
+  void Unmap();
+
+  void* data_ = nullptr;
+  int64_t size_ = 0;
+  // Contents of unmappable files.
+  std::string buffer_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_FILE_MAPPED_FILE_H_
@@ -0,0 +1,80 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/file/mapped_file.h"
+
+#include <unistd.h>
+
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/file/temp_file.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+
+TEST(MappedFileTest, MapsContents) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile temp,
+                           TempFile::CreateWithContent("hello world"));
+  XLS_ASSERT_OK_AND_ASSIGN(MappedFile file, MappedFile::Open(temp.path()));
+  EXPECT_EQ(file.contents(), "hello world");
+
+  MappedFile moved = std::move(file);
+  EXPECT_EQ(moved.contents(), "hello world");
+}
+
+TEST(MappedFileTest, AccessPatternHints) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile temp,
+                           TempFile::CreateWithContent("hello world"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      MappedFile file,
+      MappedFile::Open(temp.path(), MappedFile::AccessPattern::kRandom));
+  EXPECT_EQ(file.contents(), "hello world");
+  file.Advise(MappedFile::AccessPattern::kNormal);
+  EXPECT_EQ(file.contents(), "hello world");
+}
+
+TEST(MappedFileTest, EmptyFile) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile temp, TempFile::CreateWithContent(""));
+  XLS_ASSERT_OK_AND_ASSIGN(MappedFile file, MappedFile::Open(temp.path()));
+  EXPECT_TRUE(file.contents().empty());
+}
+
+TEST(MappedFileTest, ReadsUnmappableFiles) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  ASSERT_EQ(write(fds[1], "piped", 5), 5);
+  close(fds[1]);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      MappedFile file,
+      MappedFile::Open(absl::StrFormat("/dev/fd/%d", fds[0])));
+  close(fds[0]);
+
+  MappedFile moved = std::move(file);
+  EXPECT_EQ(moved.contents(), "piped");
+}
+
+TEST(MappedFileTest, MissingFile) {
+  EXPECT_THAT(MappedFile::Open("/does/not/exist"),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,74 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/memory_usage.h"
+
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "xls/common/file/filesystem.h"
+
+namespace xls {
+namespace {
+
+// Returns the value of the field `field` (e.g., "VmRSS") of /proc/self/status
+// in bytes.
+std::optional<int64_t> GetProcStatusBytes(std::string_view field) {
+  absl::StatusOr<std::string> status = GetFileContents("/proc/self/status");
+  if (!status.ok()) {
+    return std::nullopt;
+  }
+  for (std::string_view line : absl::StrSplit(*status, '\n')) {
+    if (!absl::ConsumePrefix(&line, field) ||
+        !absl::ConsumePrefix(&line, ":")) {
+      continue;
+    }
+    int64_t kilobytes;
+    if (absl::SimpleAtoi(
+            absl::StripSuffix(absl::StripAsciiWhitespace(line), " kB"),
+            &kilobytes)) {
+      return kilobytes * 1024;
+    }
+    return std::nullopt;
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+std::optional<int64_t> GetCurrentRssBytes() {
+  return GetProcStatusBytes("VmRSS");
+}
+
+std::optional<int64_t> GetPeakRssBytes() { return GetProcStatusBytes("VmHWM"); }
+
+bool ResetPeakRss() {
+  // Writing 5 to clear_refs resets the peak RSS (Linux 4.0 and later).
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  if (!clear_refs) {
+    return false;
+  }
+  clear_refs << "5";
+  return static_cast<bool>(clear_refs.flush());
+}
+
+}  // namespace xls
@@ -0,0 +1,65 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_MEMORY_USAGE_H_
+#define XLS_COMMON_MEMORY_USAGE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+
+namespace xls {
+
+// Returns the current resident set size of the process in bytes, if the
+// platform exposes it.
+std::optional<int64_t> GetCurrentRssBytes();
+
+// Returns the high-water mark of the resident set size of the process in bytes,
+// if the platform exposes it.
+std::optional<int64_t> GetPeakRssBytes();
+
+// Resets the high-water mark returned by GetPeakRssBytes() to the current
+// resident set size. Returns false if the platform does not support it.
+bool ResetPeakRss();
+
+// A process-wide high-water mark of the memory used by one kind of data
+// structure, recorded by the data structure itself as it grows. Thread-safe.
+class MemoryHighWaterMark {
+ public:
+  constexpr MemoryHighWaterMark() = default;
+
+  MemoryHighWaterMark(const MemoryHighWaterMark&) = delete;
+  MemoryHighWaterMark& operator=(const MemoryHighWaterMark&) = delete;
+
+  // Raises the high-water mark to `bytes` if it is lower.
+  void Record(int64_t bytes) {
+    int64_t peak = peak_bytes_.load(std::memory_order_relaxed);
+    while (bytes > peak && !peak_bytes_.compare_exchange_weak(
+                               peak, bytes, std::memory_order_relaxed)) {
+    }
+  }
+
+  int64_t peak_bytes() const {
+    return peak_bytes_.load(std::memory_order_relaxed);
+  }
+
+  void Reset() { peak_bytes_.store(0, std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> peak_bytes_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_MEMORY_USAGE_H_
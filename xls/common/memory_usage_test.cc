@@ -0,0 +1,64 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/memory_usage.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/thread.h"
+
+namespace xls {
+namespace {
+
+TEST(MemoryUsageTest, RssIsReported) {
+  std::optional<int64_t> current = GetCurrentRssBytes();
+  std::optional<int64_t> peak = GetPeakRssBytes();
+  if (!current.has_value()) {
+    GTEST_SKIP() << "Platform does not expose the resident set size";
+  }
+  EXPECT_GT(*current, 0);
+  ASSERT_TRUE(peak.has_value());
+  EXPECT_GE(*peak, *current);
+}
+
+TEST(MemoryUsageTest, HighWaterMark) {
+  MemoryHighWaterMark mark;
+  EXPECT_EQ(mark.peak_bytes(), 0);
+  mark.Record(100);
+  mark.Record(50);
+  EXPECT_EQ(mark.peak_bytes(), 100);
+  mark.Reset();
+  EXPECT_EQ(mark.peak_bytes(), 0);
+
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i <= 4; ++i) {
+    threads.push_back(std::make_unique<Thread>([&mark, i] {
+      for (int64_t j = 0; j < 1000; ++j) {
+        mark.Record(i * 1000 + j);
+      }
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  EXPECT_EQ(mark.peak_bytes(), 4999);
+}
+
+}  // namespace
+}  // namespace xls
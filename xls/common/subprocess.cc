@@ -16,24 +16,36 @@
 
 #include <fcntl.h>
 #include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/socket.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
 #include <atomic>
+#include <cstdint>
+#include <cstdio>
 #include <cerrno>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
 #include <filesystem>  // NOLINT
+#include <functional>
+#include <iostream>
+#include <memory>
 #include <optional>
 #include <ostream>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/cleanup/cleanup.h"
 #include "absl/container/fixed_array.h"
 #include "absl/status/status.h"
+#include "absl/memory/memory.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -47,6 +59,9 @@
 #include "xls/common/strerror.h"
 #include "xls/common/thread.h"
 
+// Not declared by unistd.h on all platforms.
+extern char** environ;
+
 namespace xls {
 namespace {
 
@@ -70,45 +85,74 @@ struct Pipe {
   FileDescriptor entrance;
 };
 
-absl::StatusOr<pid_t> ExecInChildProcess(
+// Spawns `argv_pointers` with the given file descriptors (if any) installed as
+// its standard streams. Uses posix_spawn rather than fork so that the cost of
+// starting a subprocess does not grow with the size of the parent: the child
+// shares the parent's address space until it execs instead of copying its page
+// tables.
+absl::StatusOr<pid_t> SpawnProcess(
     const std::vector<const char*>& argv_pointers,
-    const std::optional<std::filesystem::path>& cwd, Pipe& stdout_pipe,
-    Pipe& stderr_pipe) {
-  const char* cwd_c_str = nullptr;
-  if (cwd.has_value()) {
-    cwd_c_str = cwd->c_str();
-  }
-
-  pid_t pid = fork();
-  if (pid == -1) {
-    return absl::InternalError(
-        absl::StrCat("Failed to fork: ", Strerror(errno)));
+    const std::optional<std::filesystem::path>& cwd,
+    std::optional<int> stdin_fd, std::optional<int> stdout_fd,
+    std::optional<int> stderr_fd) {
+  posix_spawn_file_actions_t file_actions;
+  if (int error = posix_spawn_file_actions_init(&file_actions); error != 0) {
+    return absl::InternalError(absl::StrCat(
+        "Failed to initialize spawn file actions: ", Strerror(error)));
   }
-  if (pid != 0) {
-    // This is the parent process.
-    stdout_pipe.entrance.Close();
-    stderr_pipe.entrance.Close();
-    return pid;
+  absl::Cleanup destroy_file_actions = [&file_actions] {
+    posix_spawn_file_actions_destroy(&file_actions);
+  };
+  // The duplicated descriptors do not inherit FD_CLOEXEC, unlike the pipe
+  // ends they are copied from.
+  std::pair<std::optional<int>, int> redirections[] = {
+      {stdin_fd, STDIN_FILENO},
+      {stdout_fd, STDOUT_FILENO},
+      {stderr_fd, STDERR_FILENO}};
+  for (const auto& [fd, target] : redirections) {
+    if (!fd.has_value()) {
+      continue;
+    }
+    if (int error =
+            posix_spawn_file_actions_adddup2(&file_actions, *fd, target);
+        error != 0) {
+      return absl::InternalError(
+          absl::StrCat("Failed to redirect subprocess stream: ",
+                       Strerror(error)));
+    }
   }
-
-  // This is the child process.
-  //
-  // NOTE: It is not safe to allocate from here to the `exec` invocation, so
-  // logging is also unsafe.
-  if (cwd_c_str != nullptr) {
-    if (chdir(cwd_c_str) != 0) {
-      _exit(127);
+  if (cwd.has_value()) {
+    if (int error =
+            posix_spawn_file_actions_addchdir_np(&file_actions, cwd->c_str());
+        error != 0) {
+      return absl::InternalError(absl::StrCat(
+          "Failed to set subprocess working directory: ", Strerror(error)));
     }
   }
-  while ((dup2(stdout_pipe.entrance.get(), STDOUT_FILENO) == -1) &&
-         (errno == EINTR)) {
+
+  posix_spawnattr_t attributes;
+  if (int error = posix_spawnattr_init(&attributes); error != 0) {
+    return absl::InternalError(absl::StrCat(
+        "Failed to initialize spawn attributes: ", Strerror(error)));
   }
-  while ((dup2(stderr_pipe.entrance.get(), STDERR_FILENO) == -1) &&
-         (errno == EINTR)) {
+  absl::Cleanup destroy_attributes = [&attributes] {
+    posix_spawnattr_destroy(&attributes);
+  };
+#ifdef POSIX_SPAWN_USEVFORK
+  // Only meaningful for old glibc versions, which otherwise fork.
+  posix_spawnattr_setflags(&attributes, POSIX_SPAWN_USEVFORK);
+#endif
+
+  pid_t pid;
+  if (int error = posix_spawn(&pid, argv_pointers[0], &file_actions,
+                              &attributes,
+                              const_cast<char* const*>(argv_pointers.data()),
+                              environ);
+      error != 0) {
+    return absl::InternalError(absl::StrFormat(
+        "Failed to spawn %s: %s", argv_pointers[0], Strerror(error)));
   }
-  execv(argv_pointers[0], const_cast<char* const*>(argv_pointers.data()));
-  XLS_LOG(ERROR) << "Execv syscall failed: " << Strerror(errno);
-  _exit(127);
+  return pid;
 }
 
 // Takes a list of file descriptor data streams and reads them into a list of
@@ -186,6 +230,160 @@ absl::StatusOr<int> WaitForPid(pid_t pid) {
   return wait_status;
 }
 
+// Appends `data` to `out` as a netstring.
+void AppendNetstring(std::string_view data, std::string* out) {
+  absl::StrAppend(out, data.size(), ":", data, ",");
+}
+
+// Writes all of `data` to `fd`. A peer which has gone away is reported as
+// kUnavailable (rather than raising SIGPIPE where the platform allows).
+absl::Status WriteAll(int fd, std::string_view data) {
+  while (!data.empty()) {
+#ifdef MSG_NOSIGNAL
+    ssize_t written = send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+    if (written == -1 && errno == ENOTSOCK) {
+      written = write(fd, data.data(), data.size());
+    }
+#else
+    ssize_t written = write(fd, data.data(), data.size());
+#endif
+    if (written == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EPIPE || errno == ECONNRESET) {
+        return absl::UnavailableError("Persistent worker peer went away.");
+      }
+      return absl::InternalError(
+          absl::StrCat("Failed to write to persistent worker peer: ",
+                       Strerror(errno)));
+    }
+    data.remove_prefix(written);
+  }
+  return absl::OkStatus();
+}
+
+// Reads more data from `fd` onto the end of `buffer`, waiting no later than
+// `deadline`. Returns kDeadlineExceeded if the deadline passes and
+// kUnavailable if the peer closed its end.
+absl::Status ReadMore(int fd, absl::Time deadline, std::string& buffer) {
+  while (true) {
+    int timeout_ms = -1;
+    if (deadline != absl::InfiniteFuture()) {
+      absl::Duration remaining = deadline - absl::Now();
+      if (remaining <= absl::ZeroDuration()) {
+        return absl::DeadlineExceededError(
+            "Persistent worker invocation timed out.");
+      }
+      timeout_ms = static_cast<int>(absl::ToInt64Milliseconds(
+          absl::Ceil(remaining, absl::Milliseconds(1))));
+    }
+    pollfd poll_fd = {.fd = fd, .events = POLLIN};
+    int ready = poll(&poll_fd, 1, timeout_ms);
+    if (ready == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return absl::InternalError(
+          absl::StrCat("poll failed: ", Strerror(errno)));
+    }
+    if (ready == 0) {
+      continue;
+    }
+    char chunk[4096];
+    ssize_t bytes = read(fd, chunk, sizeof(chunk));
+    if (bytes == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == ECONNRESET) {
+        return absl::UnavailableError("Persistent worker peer went away.");
+      }
+      return absl::InternalError(
+          absl::StrCat("read failed: ", Strerror(errno)));
+    }
+    if (bytes == 0) {
+      return absl::UnavailableError("Persistent worker peer went away.");
+    }
+    buffer.append(chunk, bytes);
+    return absl::OkStatus();
+  }
+}
+
+// Reads a single netstring from `fd`, consuming it from `buffer` which holds
+// previously read but unconsumed data.
+absl::StatusOr<std::string> ReadNetstring(int fd, absl::Time deadline,
+                                          std::string& buffer) {
+  // Lengths beyond 19 digits cannot be represented and indicate garbage.
+  constexpr int64_t kMaxLengthDigits = 19;
+  size_t colon;
+  while ((colon = buffer.find(':')) == std::string::npos) {
+    if (buffer.size() > kMaxLengthDigits) {
+      return absl::InternalError("Malformed persistent worker message.");
+    }
+    XLS_RETURN_IF_ERROR(ReadMore(fd, deadline, buffer));
+  }
+  uint64_t length;
+  if (!absl::SimpleAtoi(std::string_view(buffer).substr(0, colon), &length) ||
+      colon > kMaxLengthDigits) {
+    return absl::InternalError("Malformed persistent worker message.");
+  }
+  while (buffer.size() < colon + 1 + length + 1) {
+    XLS_RETURN_IF_ERROR(ReadMore(fd, deadline, buffer));
+  }
+  if (buffer[colon + 1 + length] != ',') {
+    return absl::InternalError("Malformed persistent worker message.");
+  }
+  std::string data = buffer.substr(colon + 1, length);
+  buffer.erase(0, colon + 1 + length + 1);
+  return data;
+}
+
+absl::StatusOr<int64_t> ReadNetstringInt(int fd, absl::Time deadline,
+                                         std::string& buffer) {
+  XLS_ASSIGN_OR_RETURN(std::string text, ReadNetstring(fd, deadline, buffer));
+  int64_t value;
+  if (!absl::SimpleAtoi(text, &value)) {
+    return absl::InternalError(absl::StrFormat(
+        "Expected integer in persistent worker message, got: \"%s\"", text));
+  }
+  return value;
+}
+
+// Returns the entire contents of the file open as `fd`.
+absl::StatusOr<std::string> ReadFromStart(int fd) {
+  if (lseek(fd, 0, SEEK_SET) == -1) {
+    return absl::InternalError(absl::StrCat("lseek failed: ", Strerror(errno)));
+  }
+  std::string contents;
+  char chunk[4096];
+  while (true) {
+    ssize_t bytes = read(fd, chunk, sizeof(chunk));
+    if (bytes == -1 && errno == EINTR) {
+      continue;
+    }
+    if (bytes == -1) {
+      return absl::InternalError(
+          absl::StrCat("read failed: ", Strerror(errno)));
+    }
+    if (bytes == 0) {
+      return contents;
+    }
+    contents.append(chunk, bytes);
+  }
+}
+
+// Points file descriptor `target` at `fd`.
+absl::Status Redirect(int fd, int target) {
+  while (dup2(fd, target) == -1) {
+    if (errno != EINTR) {
+      return absl::InternalError(
+          absl::StrCat("dup2 failed: ", Strerror(errno)));
+    }
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 absl::StatusOr<SubprocessResult> InvokeSubprocess(
@@ -212,8 +410,12 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
   XLS_ASSIGN_OR_RETURN(auto stdout_pipe, Pipe::Open());
   XLS_ASSIGN_OR_RETURN(auto stderr_pipe, Pipe::Open());
 
-  XLS_ASSIGN_OR_RETURN(pid_t pid, ExecInChildProcess(argv_pointers, cwd,
-                                                     stdout_pipe, stderr_pipe));
+  XLS_ASSIGN_OR_RETURN(
+      pid_t pid,
+      SpawnProcess(argv_pointers, cwd, /*stdin_fd=*/std::nullopt,
+                   stdout_pipe.entrance.get(), stderr_pipe.entrance.get()));
+  stdout_pipe.entrance.Close();
+  stderr_pipe.entrance.Close();
 
   // Order is important here. The optional<Thread> must appear after the mutex
   // because the thread's destructor calls Join() and because the thread has
@@ -274,6 +476,187 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
                           .timeout_expired = timeout_expired.load()};
 }
 
+absl::StatusOr<std::unique_ptr<PersistentWorker>> PersistentWorker::Create(
+    std::vector<std::string> argv, std::optional<std::filesystem::path> cwd) {
+  if (argv.empty()) {
+    return absl::InvalidArgumentError("Cannot start worker with empty argv.");
+  }
+  auto worker = absl::WrapUnique(
+      new PersistentWorker(std::move(argv), std::move(cwd)));
+  XLS_RETURN_IF_ERROR(worker->Start());
+  return worker;
+}
+
+PersistentWorker::~PersistentWorker() {
+  if (pid_ != -1) {
+    absl::StatusOr<int> wait_status = Stop(/*kill_worker=*/false);
+    if (!wait_status.ok()) {
+      XLS_LOG(ERROR) << "Failed to stop persistent worker: "
+                     << wait_status.status();
+    }
+  }
+}
+
+absl::Status PersistentWorker::Start() {
+  XLS_VLOG(1) << absl::StreamFormat(
+      "Starting persistent worker; argv: [ %s ], cwd: %s",
+      absl::StrJoin(argv_, " "),
+      cwd_.has_value() ? cwd_->string()
+                       : std::filesystem::current_path().string());
+  int descriptors[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, descriptors) != 0 ||
+      fcntl(descriptors[0], F_SETFD, FD_CLOEXEC) != 0 ||
+      fcntl(descriptors[1], F_SETFD, FD_CLOEXEC) != 0) {
+    return absl::InternalError(
+        absl::StrCat("Failed to create worker socket: ", Strerror(errno)));
+  }
+  FileDescriptor client_end(descriptors[0]);
+  FileDescriptor worker_end(descriptors[1]);
+
+  std::vector<const char*> argv_pointers;
+  argv_pointers.reserve(argv_.size() + 1);
+  for (const std::string& arg : argv_) {
+    argv_pointers.push_back(arg.c_str());
+  }
+  argv_pointers.push_back(nullptr);
+  XLS_ASSIGN_OR_RETURN(
+      pid_, SpawnProcess(argv_pointers, cwd_, worker_end.get(),
+                         worker_end.get(), /*stderr_fd=*/std::nullopt));
+  socket_ = std::move(client_end);
+  read_buffer_.clear();
+  return absl::OkStatus();
+}
+
+absl::StatusOr<int> PersistentWorker::Stop(bool kill_worker) {
+  socket_.Close();
+  if (kill_worker) {
+    kill(pid_, SIGKILL);
+  }
+  pid_t pid = pid_;
+  pid_ = -1;
+  return WaitForPid(pid);
+}
+
+absl::StatusOr<SubprocessResult> PersistentWorker::Invoke(
+    absl::Span<const std::string> args,
+    std::optional<absl::Duration> optional_timeout) {
+  if (pid_ == -1) {
+    XLS_RETURN_IF_ERROR(Start());
+  }
+  absl::Time deadline = absl::InfiniteFuture();
+  if (optional_timeout.has_value() &&
+      *optional_timeout > absl::ZeroDuration()) {
+    deadline = absl::Now() + *optional_timeout;
+  }
+
+  std::string request;
+  AppendNetstring(absl::StrCat(args.size()), &request);
+  for (const std::string& arg : args) {
+    AppendNetstring(arg, &request);
+  }
+  absl::StatusOr<SubprocessResult> result = [&]()
+      -> absl::StatusOr<SubprocessResult> {
+    XLS_RETURN_IF_ERROR(WriteAll(socket_.get(), request));
+    XLS_ASSIGN_OR_RETURN(int64_t exit_status,
+                         ReadNetstringInt(socket_.get(), deadline,
+                                          read_buffer_));
+    XLS_ASSIGN_OR_RETURN(std::string stdout_output,
+                         ReadNetstring(socket_.get(), deadline, read_buffer_));
+    XLS_ASSIGN_OR_RETURN(std::string stderr_output,
+                         ReadNetstring(socket_.get(), deadline, read_buffer_));
+    return SubprocessResult{.stdout = std::move(stdout_output),
+                            .stderr = std::move(stderr_output),
+                            .exit_status = static_cast<int>(exit_status),
+                            .normal_termination = true,
+                            .timeout_expired = false};
+  }();
+  if (result.ok()) {
+    return result;
+  }
+
+  // The worker is unusable after any failure; it is restarted by the next
+  // invocation.
+  XLS_VLOG(1) << "Persistent worker invocation failed: " << result.status();
+  bool timeout_expired = absl::IsDeadlineExceeded(result.status());
+  bool worker_died = absl::IsUnavailable(result.status());
+  XLS_ASSIGN_OR_RETURN(int wait_status, Stop(/*kill_worker=*/true));
+  if (!timeout_expired && !worker_died) {
+    return result.status();
+  }
+  return SubprocessResult{.stdout = "",
+                          .stderr = "",
+                          .exit_status = WEXITSTATUS(wait_status),
+                          .normal_termination = WIFEXITED(wait_status) &&
+                                                !timeout_expired,
+                          .timeout_expired = timeout_expired};
+}
+
+absl::Status RunPersistentWorkerLoop(
+    const std::function<int(absl::Span<const std::string>)>& handler) {
+  // Move the protocol off the standard streams so the handler cannot read
+  // or corrupt it. Between invocations stray output goes to stderr.
+  FileDescriptor requests(dup(STDIN_FILENO));
+  FileDescriptor responses(dup(STDOUT_FILENO));
+  FileDescriptor original_stderr(dup(STDERR_FILENO));
+  FileDescriptor dev_null(open("/dev/null", O_RDONLY));
+  if (requests.get() == -1 || responses.get() == -1 ||
+      original_stderr.get() == -1 || dev_null.get() == -1) {
+    return absl::InternalError(absl::StrCat(
+        "Failed to set up persistent worker streams: ", Strerror(errno)));
+  }
+  XLS_RETURN_IF_ERROR(Redirect(dev_null.get(), STDIN_FILENO));
+  XLS_RETURN_IF_ERROR(Redirect(original_stderr.get(), STDOUT_FILENO));
+
+  std::string buffer;
+  while (true) {
+    absl::StatusOr<int64_t> arg_count =
+        ReadNetstringInt(requests.get(), absl::InfiniteFuture(), buffer);
+    if (absl::IsUnavailable(arg_count.status()) && buffer.empty()) {
+      // The client closed the connection between invocations.
+      return absl::OkStatus();
+    }
+    XLS_RETURN_IF_ERROR(arg_count.status());
+    std::vector<std::string> args;
+    args.reserve(*arg_count);
+    for (int64_t i = 0; i < *arg_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          std::string arg,
+          ReadNetstring(requests.get(), absl::InfiniteFuture(), buffer));
+      args.push_back(std::move(arg));
+    }
+
+    std::unique_ptr<FILE, decltype(&fclose)> stdout_file(tmpfile(), &fclose);
+    std::unique_ptr<FILE, decltype(&fclose)> stderr_file(tmpfile(), &fclose);
+    if (stdout_file == nullptr || stderr_file == nullptr) {
+      return absl::InternalError(absl::StrCat(
+          "Failed to create output capture files: ", Strerror(errno)));
+    }
+    auto flush_streams = []() {
+      std::cout.flush();
+      std::cerr.flush();
+      fflush(stdout);
+      fflush(stderr);
+    };
+    flush_streams();
+    XLS_RETURN_IF_ERROR(Redirect(fileno(stdout_file.get()), STDOUT_FILENO));
+    XLS_RETURN_IF_ERROR(Redirect(fileno(stderr_file.get()), STDERR_FILENO));
+    int exit_status = handler(args);
+    flush_streams();
+    XLS_RETURN_IF_ERROR(Redirect(original_stderr.get(), STDOUT_FILENO));
+    XLS_RETURN_IF_ERROR(Redirect(original_stderr.get(), STDERR_FILENO));
+
+    std::string response;
+    AppendNetstring(absl::StrCat(exit_status), &response);
+    XLS_ASSIGN_OR_RETURN(std::string stdout_output,
+                         ReadFromStart(fileno(stdout_file.get())));
+    AppendNetstring(stdout_output, &response);
+    XLS_ASSIGN_OR_RETURN(std::string stderr_output,
+                         ReadFromStart(fileno(stderr_file.get())));
+    AppendNetstring(stderr_output, &response);
+    XLS_RETURN_IF_ERROR(WriteAll(responses.get(), response));
+  }
+}
+
 absl::StatusOr<std::pair<std::string, std::string>> SubprocessResultToStrings(
     absl::StatusOr<SubprocessResult> result) {
   if (result.ok()) {
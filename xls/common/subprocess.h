@@ -15,16 +15,22 @@
 #ifndef XLS_COMMON_SUBPROCESS_H_
 #define XLS_COMMON_SUBPROCESS_H_
 
+#include <sys/types.h>
+
 #include <filesystem>  // NOLINT
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "xls/common/file/file_descriptor.h"
 
 namespace xls {
 
@@ -97,5 +103,71 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
     std::optional<std::filesystem::path> cwd = std::nullopt,
     std::optional<absl::Duration> optional_timeout = std::nullopt);
 
+// A long-running subprocess which serves repeated invocations of a tool,
+// avoiding the cost of starting the tool (and loading its dependencies) for
+// each invocation. The subprocess must serve the protocol with
+// RunPersistentWorkerLoop, typically when given a flag asking it to.
+//
+// The protocol runs over the worker's stdin and stdout, which are connected to
+// a socket. Messages are sequences of netstrings ("<length>:<bytes>,"): a
+// request is the argument count followed by the arguments, and a response is
+// the exit status followed by the captured stdout and stderr of the
+// invocation. Output the worker produces outside of invocations goes to the
+// stderr of the client.
+//
+// Not thread-safe; use one worker per concurrent caller.
+class PersistentWorker {
+ public:
+  // Starts the worker `argv` in `cwd` (the current directory if not given).
+  static absl::StatusOr<std::unique_ptr<PersistentWorker>> Create(
+      std::vector<std::string> argv,
+      std::optional<std::filesystem::path> cwd = std::nullopt);
+
+  // Closes the worker's stdin and waits for it to exit.
+  ~PersistentWorker();
+
+  PersistentWorker(const PersistentWorker&) = delete;
+  PersistentWorker& operator=(const PersistentWorker&) = delete;
+
+  // Runs a single invocation with the given arguments in the worker. The
+  // result has the same meaning as for InvokeSubprocess: if the invocation
+  // runs beyond `optional_timeout` the worker is killed and the result has
+  // `timeout_expired` set, and if the worker dies during the invocation the
+  // result carries its wait status. A worker which died is restarted by the
+  // next call.
+  absl::StatusOr<SubprocessResult> Invoke(
+      absl::Span<const std::string> args,
+      std::optional<absl::Duration> optional_timeout = std::nullopt);
+
+ private:
+  PersistentWorker(std::vector<std::string> argv,
+                   std::optional<std::filesystem::path> cwd)
+      : argv_(std::move(argv)), cwd_(std::move(cwd)) {}
+
+  absl::Status Start();
+
+  // Kills the worker (if `kill_worker`) and waits for it to exit. Returns the
+  // wait status.
+  absl::StatusOr<int> Stop(bool kill_worker);
+
+  std::vector<std::string> argv_;
+  std::optional<std::filesystem::path> cwd_;
+  // The pid of the running worker and the client end of its socket, or -1 if
+  // the worker is not running.
+  pid_t pid_ = -1;
+  FileDescriptor socket_;
+  // Data read from the socket which has not been consumed yet.
+  std::string read_buffer_;
+};
+
+// Serves invocations from a PersistentWorker client on stdin/stdout until stdin
+// is closed, returning an error only if the protocol is violated. Each
+// invocation calls `handler` with its arguments; the return value of the
+// handler is the exit status of the invocation, and everything written to
+// file descriptors 1 and 2 while the handler runs (including through std::cout
+// and std::cerr) is captured and returned to the client.
+absl::Status RunPersistentWorkerLoop(
+    const std::function<int(absl::Span<const std::string>)>& handler);
+
 }  // namespace xls
 #endif  // XLS_COMMON_SUBPROCESS_H_
@@ -14,6 +14,8 @@
 
 #include "xls/common/subprocess.h"
 
+#include <filesystem>  // NOLINT
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
@@ -22,7 +24,9 @@
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
 #include "absl/time/time.h"
+#include "xls/common/file/get_runfile_path.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
 
 namespace xls {
 namespace {
@@ -139,6 +143,21 @@ TEST(SubprocessTest, LargeOutputToStderrFirstWorks) {
   EXPECT_THAT(result_or_status->stderr, HasSubstr("\n10000\n"));
 }
 
+TEST(SubprocessTest, RunsInWorkingDirectory) {
+  absl::StatusOr<SubprocessResult> result_or_status =
+      SubprocessErrorAsStatus(InvokeSubprocess(
+          {"/usr/bin/env", "bash", "-c", "pwd"}, std::filesystem::path("/")));
+
+  XLS_ASSERT_OK(result_or_status);
+  EXPECT_EQ(result_or_status->stdout, "/\n");
+}
+
+TEST(SubprocessTest, MissingBinaryFails) {
+  EXPECT_THAT(InvokeSubprocess({"/nonexistent/binary"}),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Failed to spawn /nonexistent/binary")));
+}
+
 TEST(SubprocessTest, ErrorAsStatusWorks) {
   // Translates abnormal termination.
   SubprocessResult bad_exit{.stderr = "word_a", .normal_termination = false};
@@ -182,5 +201,68 @@ TEST(SubprocessTest, ResultsUnpackToStringPair) {
               StatusIs(absl::StatusCode::kInternal, HasSubstr("bad arg")));
 }
 
+absl::StatusOr<std::unique_ptr<PersistentWorker>> CreateTestWorker() {
+  XLS_ASSIGN_OR_RETURN(
+      std::filesystem::path worker_path,
+      GetXlsRunfilePath("xls/common/subprocess_test_worker"));
+  return PersistentWorker::Create({worker_path.string()});
+}
+
+TEST(PersistentWorkerTest, ServesRepeatedInvocations) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PersistentWorker> worker,
+                           CreateTestWorker());
+  XLS_ASSERT_OK_AND_ASSIGN(SubprocessResult pid_result,
+                           worker->Invoke({"pid"}));
+
+  EXPECT_THAT(worker->Invoke({"echo", "hello", "world"}),
+              IsOkAndHolds(FieldsAre(
+                  /*stdout=*/"hello world\n",
+                  /*stderr=*/"echoed 2 arguments\n",
+                  /*exit_status=*/0,
+                  /*normal_termination=*/true,
+                  /*timeout_expired=*/false)));
+  // Arguments are passed through unmodified.
+  EXPECT_THAT(worker->Invoke({"echo", "a,b:c", "", "multi\nline"}),
+              IsOkAndHolds(FieldsAre(
+                  /*stdout=*/"a,b:c  multi\nline\n", _, 0, true, false)));
+  EXPECT_THAT(worker->Invoke({"exit", "3"}),
+              IsOkAndHolds(FieldsAre("", "", 3, true, false)));
+
+  // All invocations were served by the same process.
+  EXPECT_THAT(worker->Invoke({"pid"}),
+              IsOkAndHolds(FieldsAre(pid_result.stdout, _, 0, true, false)));
+}
+
+TEST(PersistentWorkerTest, RestartsAfterCrash) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PersistentWorker> worker,
+                           CreateTestWorker());
+  XLS_ASSERT_OK_AND_ASSIGN(SubprocessResult first_pid, worker->Invoke({"pid"}));
+
+  EXPECT_THAT(worker->Invoke({"crash"}),
+              IsOkAndHolds(FieldsAre("", "", _, /*normal_termination=*/false,
+                                     /*timeout_expired=*/false)));
+
+  XLS_ASSERT_OK_AND_ASSIGN(SubprocessResult second_pid,
+                           worker->Invoke({"pid"}));
+  EXPECT_NE(first_pid.stdout, second_pid.stdout);
+  EXPECT_THAT(worker->Invoke({"echo", "again"}),
+              IsOkAndHolds(FieldsAre("again\n", _, 0, true, false)));
+}
+
+TEST(PersistentWorkerTest, TimeoutKillsWorker) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PersistentWorker> worker,
+                           CreateTestWorker());
+  EXPECT_THAT(worker->Invoke({"sleep"}, absl::Milliseconds(50)),
+              IsOkAndHolds(FieldsAre("", "", _, /*normal_termination=*/false,
+                                     /*timeout_expired=*/true)));
+  EXPECT_THAT(worker->Invoke({"echo", "awake"}),
+              IsOkAndHolds(FieldsAre("awake\n", _, 0, true, false)));
+}
+
+TEST(PersistentWorkerTest, EmptyArgvFails) {
+  EXPECT_THAT(PersistentWorker::Create({}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,69 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Persistent worker used by subprocess_test. The first argument of each
+// invocation selects the behavior of the worker.
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "xls/common/subprocess.h"
+
+namespace {
+
+int HandleInvocation(absl::Span<const std::string> args) {
+  if (args.empty()) {
+    return 2;
+  }
+  if (args[0] == "echo") {
+    std::cout << absl::StrJoin(args.subspan(1), " ") << "\n";
+    std::cerr << "echoed " << args.size() - 1 << " arguments\n";
+    return 0;
+  }
+  if (args[0] == "exit" && args.size() == 2) {
+    int exit_status;
+    return absl::SimpleAtoi(args[1], &exit_status) ? exit_status : 2;
+  }
+  if (args[0] == "pid") {
+    std::cout << getpid();
+    return 0;
+  }
+  if (args[0] == "sleep") {
+    sleep(10);
+    return 0;
+  }
+  if (args[0] == "crash") {
+    abort();
+  }
+  return 2;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  absl::Status status = xls::RunPersistentWorkerLoop(HandleInvocation);
+  if (!status.ok()) {
+    std::cerr << status << "\n";
+    return 1;
+  }
+  return 0;
+}
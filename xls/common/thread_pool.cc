@@ -0,0 +1,209 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "absl/flags/flag.h"
+#include "absl/functional/function_ref.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/thread.h"
+
+ABSL_FLAG(int32_t, xls_threads, 0,
+          "Number of threads used for parallel work within the process, "
+          "including the thread which initiates the work. Zero means the "
+          "number of available CPUs; one runs all parallel work serially.");
+
+namespace xls {
+namespace {
+
+// The pool and queue index of the worker running on the current thread, if
+// any.
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local int64_t current_worker_index = 0;
+
+}  // namespace
+
+ThreadPool::ThreadPool(int64_t worker_count) {
+  XLS_CHECK_GE(worker_count, 0);
+  for (int64_t i = 0; i < worker_count; ++i) {
+    queues_.push_back(std::make_unique<WorkQueue>());
+  }
+  workers_.reserve(worker_count);
+  for (int64_t i = 0; i < worker_count; ++i) {
+    workers_.push_back(
+        std::make_unique<Thread>([this, i]() { WorkerLoop(i); }));
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    absl::MutexLock lock(&mu_);
+    shutdown_ = true;
+  }
+  for (std::unique_ptr<Thread>& worker : workers_) {
+    worker->Join();
+  }
+}
+
+ThreadPool& ThreadPool::Default() {
+  static ThreadPool* pool = [] {
+    int64_t threads = absl::GetFlag(FLAGS_xls_threads);
+    if (threads <= 0) {
+      threads = AvailableCPUs();
+    }
+    return new ThreadPool(std::max<int64_t>(threads - 1, 0));
+  }();
+  return *pool;
+}
+
+void ThreadPool::Schedule(std::function<void()> task) {
+  if (workers_.empty()) {
+    task();
+    return;
+  }
+  int64_t queue_index;
+  if (current_pool == this) {
+    queue_index = current_worker_index;
+  } else {
+    absl::MutexLock lock(&mu_);
+    queue_index = next_queue_;
+    next_queue_ = (next_queue_ + 1) % queues_.size();
+  }
+  {
+    WorkQueue& queue = *queues_[queue_index];
+    absl::MutexLock lock(&queue.mu);
+    queue.tasks.push_back(std::move(task));
+  }
+  // The task is only made visible to other threads once it is in a queue so
+  // a reservation is always backed by a queued task.
+  absl::MutexLock lock(&mu_);
+  ++pending_;
+}
+
+std::function<void()> ThreadPool::TakeReservedTask(
+    std::optional<int64_t> preferred_queue) {
+  if (preferred_queue.has_value()) {
+    WorkQueue& queue = *queues_[*preferred_queue];
+    absl::MutexLock lock(&queue.mu);
+    if (!queue.tasks.empty()) {
+      std::function<void()> task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      return task;
+    }
+  }
+  // Steal the oldest task of another queue. The reservation guarantees that a
+  // task is available, but it may be stolen from under us by a thread holding
+  // another reservation, so keep scanning until one is found.
+  int64_t start = preferred_queue.has_value() ? *preferred_queue + 1 : 0;
+  for (int64_t i = 0;; ++i) {
+    WorkQueue& queue = *queues_[(start + i) % queues_.size()];
+    absl::MutexLock lock(&queue.mu);
+    if (!queue.tasks.empty()) {
+      std::function<void()> task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      return task;
+    }
+  }
+}
+
+void ThreadPool::WorkerLoop(int64_t worker_index) {
+  current_pool = this;
+  current_worker_index = worker_index;
+  while (true) {
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.Await(absl::Condition(
+          +[](ThreadPool* pool) ABSL_EXCLUSIVE_LOCKS_REQUIRED(pool->mu_) {
+            return pool->pending_ > 0 || pool->shutdown_;
+          },
+          this));
+      // Remaining tasks are drained before shutting down.
+      if (pending_ == 0) {
+        return;
+      }
+      --pending_;
+    }
+    TakeReservedTask(worker_index)();
+  }
+}
+
+void TaskGroup::Run(std::function<void()> task) {
+  {
+    absl::MutexLock lock(&pool_.mu_);
+    ++outstanding_;
+  }
+  pool_.Schedule([this, task = std::move(task)]() {
+    task();
+    absl::MutexLock lock(&pool_.mu_);
+    --outstanding_;
+  });
+}
+
+void TaskGroup::Wait() {
+  std::optional<int64_t> preferred_queue;
+  if (current_pool == &pool_) {
+    preferred_queue = current_worker_index;
+  }
+  while (true) {
+    {
+      absl::MutexLock lock(&pool_.mu_);
+      pool_.mu_.Await(absl::Condition(
+          +[](TaskGroup* group) ABSL_EXCLUSIVE_LOCKS_REQUIRED(
+               group->pool_.mu_) {
+            return group->outstanding_ == 0 || group->pool_.pending_ > 0;
+          },
+          this));
+      if (outstanding_ == 0) {
+        return;
+      }
+      --pool_.pending_;
+    }
+    // Help out with whatever work is pending, which is not necessarily a task
+    // of this group.
+    pool_.TakeReservedTask(preferred_queue)();
+  }
+}
+
+void ParallelFor(int64_t begin, int64_t end,
+                 absl::FunctionRef<void(int64_t)> fn, ThreadPool& pool,
+                 std::optional<int64_t> max_parallelism) {
+  if (begin >= end) {
+    return;
+  }
+  int64_t parallelism = std::min(
+      end - begin, max_parallelism.value_or(pool.parallelism()));
+  std::atomic<int64_t> next = begin;
+  auto claim_indices = [&]() {
+    for (int64_t i = next++; i < end; i = next++) {
+      fn(i);
+    }
+  };
+  TaskGroup group(pool);
+  for (int64_t i = 1; i < parallelism; ++i) {
+    group.Run(claim_indices);
+  }
+  claim_indices();
+  group.Wait();
+}
+
+}  // namespace xls
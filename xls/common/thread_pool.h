@@ -0,0 +1,135 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_THREAD_POOL_H_
+#define XLS_COMMON_THREAD_POOL_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/function_ref.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/thread.h"
+
+namespace xls {
+
+// A work-stealing pool of worker threads. Each worker owns a queue of tasks:
+// tasks scheduled from a worker are pushed onto that worker's queue and popped
+// in LIFO order, while idle workers steal the oldest tasks of other queues.
+// Tasks scheduled from outside the pool are distributed over the queues
+// round-robin.
+//
+// Threads blocked in TaskGroup::Wait() (including workers running nested
+// parallel work) execute pending tasks of the pool while they wait, so nested
+// parallelism neither deadlocks nor oversubscribes the machine.
+//
+// Components should generally use the process-wide pool returned by
+// ThreadPool::Default(), whose size is controlled by the `--xls_threads` flag,
+// rather than creating threads or pools of their own.
+class ThreadPool {
+ public:
+  // Creates a pool with `worker_count` worker threads. A pool without workers
+  // runs each task inline when it is scheduled.
+  explicit ThreadPool(int64_t worker_count);
+
+  // Waits for all scheduled tasks to complete and joins the workers.
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Returns the process-wide pool. It is created on first use with
+  // `--xls_threads` - 1 workers (the thread waiting on the work makes up the
+  // remainder) or, if the flag is zero, with AvailableCPUs() - 1 workers.
+  static ThreadPool& Default();
+
+  int64_t worker_count() const { return workers_.size(); }
+
+  // Returns the number of threads which may execute tasks of the pool at
+  // once: the workers plus a thread waiting for a TaskGroup.
+  int64_t parallelism() const { return worker_count() + 1; }
+
+  // Schedules `task` to be run on the pool. Fire-and-forget; use a TaskGroup
+  // to wait for completion.
+  void Schedule(std::function<void()> task);
+
+ private:
+  friend class TaskGroup;
+
+  struct WorkQueue {
+    absl::Mutex mu;
+    std::deque<std::function<void()>> tasks ABSL_GUARDED_BY(mu);
+  };
+
+  void WorkerLoop(int64_t worker_index);
+
+  // Removes a task from the queues, preferring the back of the queue at
+  // `preferred_queue`. The caller must have reserved the task by decrementing
+  // `pending_`.
+  std::function<void()> TakeReservedTask(
+      std::optional<int64_t> preferred_queue);
+
+  std::vector<std::unique_ptr<WorkQueue>> queues_;
+
+  absl::Mutex mu_;
+  // Number of tasks in the queues which have not been reserved by a thread.
+  int64_t pending_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t next_queue_ ABSL_GUARDED_BY(mu_) = 0;
+  bool shutdown_ ABSL_GUARDED_BY(mu_) = false;
+
+  std::vector<std::unique_ptr<Thread>> workers_;
+};
+
+// A set of tasks run on a ThreadPool which can be waited upon as a unit.
+// While waiting, the calling thread helps by running pending tasks of the
+// pool. The destructor waits for all tasks to complete.
+class TaskGroup {
+ public:
+  explicit TaskGroup(ThreadPool& pool = ThreadPool::Default()) : pool_(pool) {}
+  ~TaskGroup() { Wait(); }
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  // Runs `task` on the pool as part of this group. May be called from any
+  // thread, including from tasks of the group.
+  void Run(std::function<void()> task);
+
+  // Blocks until all tasks run as part of this group have completed.
+  void Wait();
+
+ private:
+  ThreadPool& pool_;
+  // Guarded by `pool_.mu_` so waiters wake when either the group completes or
+  // a task they can help with becomes available.
+  int64_t outstanding_ ABSL_GUARDED_BY(pool_.mu_) = 0;
+};
+
+// Calls `fn(i)` for every `i` in [begin, end) on `pool` and returns once all
+// calls have completed. Indices are claimed dynamically, one at a time, by at
+// most `max_parallelism` threads (default: the parallelism of the pool), one
+// of which is the calling thread. `fn` must be thread-safe.
+void ParallelFor(int64_t begin, int64_t end,
+                 absl::FunctionRef<void(int64_t)> fn,
+                 ThreadPool& pool = ThreadPool::Default(),
+                 std::optional<int64_t> max_parallelism = std::nullopt);
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_THREAD_POOL_H_
@@ -0,0 +1,127 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+namespace xls {
+namespace {
+
+TEST(ThreadPoolTest, ScheduledTasksCompleteBeforeDestruction) {
+  std::atomic<int64_t> count = 0;
+  {
+    ThreadPool pool(4);
+    for (int64_t i = 0; i < 100; ++i) {
+      pool.Schedule([&]() { ++count; });
+    }
+  }
+  EXPECT_EQ(count, 100);
+}
+
+TEST(ThreadPoolTest, PoolWithoutWorkersRunsInline) {
+  ThreadPool pool(0);
+  EXPECT_EQ(pool.worker_count(), 0);
+  EXPECT_EQ(pool.parallelism(), 1);
+  int64_t count = 0;
+  pool.Schedule([&]() { ++count; });
+  EXPECT_EQ(count, 1);
+  ParallelFor(0, 10, [&](int64_t i) { count += i; }, pool);
+  EXPECT_EQ(count, 46);
+}
+
+TEST(ThreadPoolTest, TaskGroupWaitsForItsTasks) {
+  ThreadPool pool(3);
+  std::vector<int64_t> values(50, 0);
+  TaskGroup group(pool);
+  for (int64_t i = 0; i < values.size(); ++i) {
+    group.Run([&values, i]() { values[i] = i * i; });
+  }
+  group.Wait();
+  for (int64_t i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(values[i], i * i);
+  }
+}
+
+TEST(ThreadPoolTest, ParallelForVisitsEachIndexOnce) {
+  ThreadPool pool(4);
+  std::vector<std::atomic<int64_t>> visits(1000);
+  ParallelFor(
+      0, visits.size(), [&](int64_t i) { ++visits[i]; }, pool);
+  for (const std::atomic<int64_t>& v : visits) {
+    EXPECT_EQ(v, 1);
+  }
+  // Empty ranges do nothing.
+  ParallelFor(5, 5, [&](int64_t i) { ++visits[i]; }, pool);
+  EXPECT_EQ(visits[5], 1);
+}
+
+TEST(ThreadPoolTest, ParallelForRespectsMaxParallelism) {
+  ThreadPool pool(8);
+  absl::Mutex mu;
+  int64_t running = 0;
+  int64_t max_running = 0;
+  ParallelFor(
+      0, 64,
+      [&](int64_t i) {
+        {
+          absl::MutexLock lock(&mu);
+          max_running = std::max(max_running, ++running);
+        }
+        absl::SleepFor(absl::Milliseconds(1));
+        absl::MutexLock lock(&mu);
+        --running;
+      },
+      pool, /*max_parallelism=*/2);
+  EXPECT_LE(max_running, 2);
+}
+
+TEST(ThreadPoolTest, NestedParallelismDoesNotDeadlock) {
+  // A single worker forces the outer tasks to wait on inner tasks which can
+  // only run if waiting threads help out.
+  ThreadPool pool(1);
+  std::vector<int64_t> sums(16, 0);
+  ParallelFor(
+      0, sums.size(),
+      [&](int64_t i) {
+        std::vector<int64_t> values(32, 0);
+        ParallelFor(
+            0, values.size(), [&](int64_t j) { values[j] = i + j; }, pool);
+        for (int64_t v : values) {
+          sums[i] += v;
+        }
+      },
+      pool);
+  for (int64_t i = 0; i < sums.size(); ++i) {
+    EXPECT_EQ(sums[i], 32 * i + 31 * 32 / 2);
+  }
+}
+
+TEST(ThreadPoolTest, DefaultPoolIsShared) {
+  EXPECT_EQ(&ThreadPool::Default(), &ThreadPool::Default());
+  std::atomic<int64_t> count = 0;
+  ParallelFor(0, 100, [&](int64_t) { ++count; });
+  EXPECT_EQ(count, 100);
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,156 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/tracing.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/const_init.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/stopwatch.h"
+
+namespace xls {
+namespace {
+
+struct TraceSpan {
+  std::string category;
+  std::string name;
+  SteadyTime start;
+  absl::Duration duration;
+  int64_t thread_id;
+};
+
+std::atomic<bool> tracing_enabled{false};
+
+absl::Mutex trace_mutex(absl::kConstInit);
+SteadyTime trace_origin ABSL_GUARDED_BY(trace_mutex);
+std::vector<TraceSpan>* trace_spans ABSL_GUARDED_BY(trace_mutex) = nullptr;
+
+// Returns a small integer identifying the calling thread. Chrome traces lay out
+// spans by thread so this keeps concurrent spans on separate tracks.
+int64_t CurrentThreadId() {
+  static std::atomic<int64_t> next_thread_id{0};
+  thread_local int64_t thread_id = next_thread_id++;
+  return thread_id;
+}
+
+// Returns `s` as a quoted JSON string.
+std::string JsonString(std::string_view s) {
+  std::string out = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      absl::StrAppend(&out, "\\", std::string(1, c));
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      absl::StrAppendFormat(&out, "\\u%04x", static_cast<int>(c));
+    } else {
+      out.push_back(c);
+    }
+  }
+  out.push_back('"');
+  return out;
+}
+
+}  // namespace
+
+void StartTracing() {
+  absl::MutexLock lock(&trace_mutex);
+  if (trace_spans == nullptr) {
+    trace_spans = new std::vector<TraceSpan>();
+  }
+  trace_spans->clear();
+  trace_origin = SteadyTime::Now();
+  tracing_enabled.store(true, std::memory_order_release);
+}
+
+bool IsTracingEnabled() {
+  return tracing_enabled.load(std::memory_order_acquire);
+}
+
+std::string StopTracingAndGetChromeTrace() {
+  absl::MutexLock lock(&trace_mutex);
+  tracing_enabled.store(false, std::memory_order_release);
+  std::vector<std::string> events;
+  if (trace_spans != nullptr) {
+    for (const TraceSpan& span : *trace_spans) {
+      events.push_back(absl::StrFormat(
+          "{\"name\":%s,\"cat\":%s,\"ph\":\"X\",\"ts\":%d,\"dur\":%d,"
+          "\"pid\":0,\"tid\":%d}",
+          JsonString(span.name), JsonString(span.category),
+          absl::ToInt64Microseconds(span.start - trace_origin),
+          absl::ToInt64Microseconds(span.duration), span.thread_id));
+    }
+    trace_spans->clear();
+  }
+  return absl::StrFormat("{\"traceEvents\":[%s],\"displayTimeUnit\":\"ms\"}\n",
+                         absl::StrJoin(events, ",\n"));
+}
+
+ScopedTraceSpan::ScopedTraceSpan(std::string_view category,
+                                 std::string_view name) {
+  if (IsTracingEnabled()) {
+    category_ = category;
+    name_ = name;
+    stopwatch_.emplace();
+  }
+}
+
+ScopedTraceSpan::~ScopedTraceSpan() {
+  if (!stopwatch_.has_value()) {
+    return;
+  }
+  absl::Duration duration = stopwatch_->GetElapsedTime();
+  absl::MutexLock lock(&trace_mutex);
+  // Tracing may have been stopped (and restarted) while the span was open.
+  if (!IsTracingEnabled() || stopwatch_->GetStartTime() < trace_origin) {
+    return;
+  }
+  trace_spans->push_back(TraceSpan{.category = std::move(category_),
+                                   .name = std::move(name_),
+                                   .start = stopwatch_->GetStartTime(),
+                                   .duration = duration,
+                                   .thread_id = CurrentThreadId()});
+}
+
+ScopedTraceOutput::ScopedTraceOutput(std::filesystem::path path)
+    : path_(std::move(path)) {
+  if (!path_.empty()) {
+    StartTracing();
+  }
+}
+
+ScopedTraceOutput::~ScopedTraceOutput() {
+  if (path_.empty()) {
+    return;
+  }
+  absl::Status status = SetFileContents(path_, StopTracingAndGetChromeTrace());
+  if (!status.ok()) {
+    XLS_LOG(ERROR) << "Failed to write trace to " << path_ << ": " << status;
+  }
+}
+
+}  // namespace xls
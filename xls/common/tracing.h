@@ -0,0 +1,81 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_TRACING_H_
+#define XLS_COMMON_TRACING_H_
+
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/status/status.h"
+#include "xls/common/stopwatch.h"
+
+namespace xls {
+
+// Process-wide tracing of the phases of the toolchain (DSLX imports, passes,
+// scheduling, codegen, JIT compilation, ...). Phases are marked with
+// ScopedTraceSpan and the recorded spans are emitted in the Chrome trace event
+// format, which can be loaded into chrome://tracing or Perfetto.
+//
+// Nothing is recorded until StartTracing() is called; until then a
+// ScopedTraceSpan costs a single atomic load.
+
+// Discards any previously recorded spans and starts recording.
+void StartTracing();
+
+// Returns whether spans are currently being recorded.
+bool IsTracingEnabled();
+
+// Stops recording and returns the spans recorded since StartTracing() as a
+// Chrome trace JSON document.
+std::string StopTracingAndGetChromeTrace();
+
+// Records the span of time between construction and destruction under `name`
+// if tracing is enabled at construction. Spans may nest and may be recorded
+// concurrently from any number of threads.
+class ScopedTraceSpan {
+ public:
+  ScopedTraceSpan(std::string_view category, std::string_view name);
+  ~ScopedTraceSpan();
+
+  ScopedTraceSpan(const ScopedTraceSpan&) = delete;
+  ScopedTraceSpan& operator=(const ScopedTraceSpan&) = delete;
+
+ private:
+  std::string category_;
+  std::string name_;
+  // Only engaged if tracing was enabled at construction.
+  std::optional<Stopwatch> stopwatch_;
+};
+
+// Helper for the `--trace_output` flag of the tools: if `path` is non-empty,
+// starts tracing on construction and writes the trace to `path` on
+// destruction. Failure to write the trace is logged rather than being fatal.
+class ScopedTraceOutput {
+ public:
+  explicit ScopedTraceOutput(std::filesystem::path path);
+  ~ScopedTraceOutput();
+
+  ScopedTraceOutput(const ScopedTraceOutput&) = delete;
+  ScopedTraceOutput& operator=(const ScopedTraceOutput&) = delete;
+
+ private:
+  std::filesystem::path path_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_TRACING_H_
@@ -0,0 +1,77 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/tracing.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/thread.h"
+
+namespace xls {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+TEST(TracingTest, NothingRecordedWhenDisabled) {
+  EXPECT_FALSE(IsTracingEnabled());
+  { ScopedTraceSpan span("test", "untraced"); }
+  StartTracing();
+  EXPECT_THAT(StopTracingAndGetChromeTrace(), Not(HasSubstr("untraced")));
+}
+
+TEST(TracingTest, RecordsNestedSpans) {
+  StartTracing();
+  EXPECT_TRUE(IsTracingEnabled());
+  {
+    ScopedTraceSpan outer("test", "outer");
+    { ScopedTraceSpan inner("test", "inner \"quoted\""); }
+  }
+  std::string trace = StopTracingAndGetChromeTrace();
+  EXPECT_FALSE(IsTracingEnabled());
+  EXPECT_THAT(trace, HasSubstr("\"traceEvents\""));
+  EXPECT_THAT(trace, HasSubstr("\"name\":\"outer\",\"cat\":\"test\""));
+  EXPECT_THAT(trace, HasSubstr("\"name\":\"inner \\\"quoted\\\"\""));
+
+  // Spans are discarded once emitted.
+  StartTracing();
+  EXPECT_THAT(StopTracingAndGetChromeTrace(), Not(HasSubstr("outer")));
+}
+
+TEST(TracingTest, RecordsSpansFromMultipleThreads) {
+  StartTracing();
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.push_back(std::make_unique<Thread>(
+        [] { ScopedTraceSpan span("test", "worker"); }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  std::string trace = StopTracingAndGetChromeTrace();
+  int64_t count = 0;
+  for (size_t pos = trace.find("\"worker\""); pos != std::string::npos;
+       pos = trace.find("\"worker\"", pos + 1)) {
+    ++count;
+  }
+  EXPECT_EQ(count, 4);
+}
+
+}  // namespace
+}  // namespace xls
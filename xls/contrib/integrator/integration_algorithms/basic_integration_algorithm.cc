@@ -18,6 +18,8 @@
 #include <optional>
 #include <utility>
 
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "xls/ir/node_iterator.h"
 
 namespace xls {
@@ -30,6 +32,43 @@ void BasicIntegrationAlgorithm::EnqueueNodeIfReady(Node* node) {
   }
 }
 
+absl::StatusOr<int64_t> BasicIntegrationAlgorithm::GetInsertNodeCost(
+    Node* node) {
+  auto it = insert_costs_.find(node);
+  if (it != insert_costs_.end()) {
+    return it->second;
+  }
+  XLS_ASSIGN_OR_RETURN(int64_t cost,
+                       integration_function_->GetInsertNodeCost(node));
+  insert_costs_[node] = cost;
+  return cost;
+}
+
+absl::StatusOr<std::optional<int64_t>>
+BasicIntegrationAlgorithm::GetMergeNodesCost(Node* node, Node* internal_node) {
+  absl::flat_hash_map<Node*, std::optional<int64_t>>& costs =
+      merge_costs_[node];
+  auto it = costs.find(internal_node);
+  if (it != costs.end()) {
+    return it->second;
+  }
+  XLS_ASSIGN_OR_RETURN(
+      std::optional<int64_t> cost,
+      integration_function_->GetMergeNodesCost(node, internal_node));
+  costs[internal_node] = cost;
+  return cost;
+}
+
+void BasicIntegrationAlgorithm::InvalidateCosts(
+    const BasicIntegrationMove& move) {
+  insert_costs_.erase(move.node);
+  if (move.move_type == IntegrationMoveType::kMerge) {
+    merge_costs_.clear();
+  } else {
+    merge_costs_.erase(move.node);
+  }
+}
+
 absl::Status BasicIntegrationAlgorithm::Initialize() {
   // Make integration function.
   XLS_ASSIGN_OR_RETURN(integration_function_, NewIntegrationFunction());
@@ -47,16 +86,25 @@ absl::Status BasicIntegrationAlgorithm::Initialize() {
 
 absl::StatusOr<std::unique_ptr<IntegrationFunction>>
 BasicIntegrationAlgorithm::Run() {
+  std::optional<absl::Time> deadline;
+  if (integration_options_.time_budget().has_value()) {
+    deadline = absl::Now() + integration_options_.time_budget().value();
+  }
+
   while (!ready_nodes_.empty()) {
+    const bool search_merges =
+        !deadline.has_value() || absl::Now() < deadline.value();
     std::optional<BasicIntegrationMove> move;
     for (auto node_itr = ready_nodes_.begin(); node_itr != ready_nodes_.end();
          ++node_itr) {
       // Check insertion cost.
-      XLS_ASSIGN_OR_RETURN(int64_t insert_cost,
-                           integration_function_->GetInsertNodeCost(*node_itr));
+      XLS_ASSIGN_OR_RETURN(int64_t insert_cost, GetInsertNodeCost(*node_itr));
       if (!move.has_value() || insert_cost < move.value().cost) {
         move = MakeInsertMove(node_itr, insert_cost);
       }
+      if (!search_merges) {
+        continue;
+      }
 
       // Check merge cost.
       for (Node* internal_node : integration_function_->function()->nodes()) {
@@ -67,9 +115,8 @@ BasicIntegrationAlgorithm::Run() {
         }
 
         // Check if mergeable
-        XLS_ASSIGN_OR_RETURN(
-            std::optional<int64_t> merge_cost,
-            integration_function_->GetMergeNodesCost(*node_itr, internal_node));
+        XLS_ASSIGN_OR_RETURN(std::optional<int64_t> merge_cost,
+                             GetMergeNodesCost(*node_itr, internal_node));
         if (!merge_cost.has_value()) {
           continue;
         }
@@ -86,6 +133,7 @@ BasicIntegrationAlgorithm::Run() {
     XLS_RET_CHECK(move.has_value());
     XLS_RETURN_IF_ERROR(
         ExecuteMove(integration_function_.get(), move.value()).status());
+    InvalidateCosts(move.value());
 
     // Update ready_nodes_.
     ready_nodes_.erase(move.value().node_itr);
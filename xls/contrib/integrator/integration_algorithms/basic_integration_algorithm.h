@@ -16,9 +16,14 @@
 #ifndef XLS_INTEGRATOR_BASIC_INTEGRATION_ALGORITHM_
 #define XLS_INTEGRATOR_BASIC_INTEGRATION_ALGORITHM_
 
+#include <cstdint>
 #include <list>
 #include <memory>
+#include <optional>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
 #include "xls/contrib/integrator/integration_algorithms/integration_algorithm.h"
 
 namespace xls {
@@ -85,6 +90,16 @@ class BasicIntegrationAlgorithm
   // and node has not already been queued for processing.
   void EnqueueNodeIfReady(Node* node);
 
+  // Returns the cost of inserting / merging 'node' into the
+  // integration_function_, reusing results from earlier steps when they
+  // cannot have changed.
+  absl::StatusOr<int64_t> GetInsertNodeCost(Node* node);
+  absl::StatusOr<std::optional<int64_t>> GetMergeNodesCost(Node* node,
+                                                           Node* internal_node);
+
+  // Updates the cost caches after 'move' has been executed.
+  void InvalidateCosts(const BasicIntegrationMove& move);
+
   // Track nodes for which all operands are already mapped and
   // are ready to be added to the integration_function_
   std::list<Node*> ready_nodes_;
@@ -92,6 +107,15 @@ class BasicIntegrationAlgorithm
   // Track all nodes that have ever been inserted into 'ready_nodes_'.
   absl::flat_hash_set<Node*> queued_nodes_;
 
+  // Costs computed in earlier steps for nodes that are still ready. The
+  // insert cost of a node depends only on the node itself. Merge costs
+  // survive insert moves, which add nodes without touching existing ones, but
+  // a merge replaces its integration node and may change muxes, so it clears
+  // all merge costs.
+  absl::flat_hash_map<Node*, int64_t> insert_costs_;
+  absl::flat_hash_map<Node*, absl::flat_hash_map<Node*, std::optional<int64_t>>>
+      merge_costs_;
+
   // Function combining the source functions.
   std::unique_ptr<IntegrationFunction> integration_function_;
 };
@@ -16,6 +16,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/time/time.h"
 #include "xls/common/status/matchers.h"
 #include "xls/contrib/integrator/integration_builder.h"
 #include "xls/contrib/integrator/ir_integrator.h"
@@ -412,5 +413,33 @@ TEST_F(BasicIntegrationAlgorithmTest, BasicIntegrationLiterals) {
                  m::Literal(UBits(2, 2)))));
 }
 
+TEST_F(BasicIntegrationAlgorithmTest, BasicIntegrationTimeBudgetExhausted) {
+  auto p = CreatePackage();
+  FunctionBuilder fb("func_a", p.get());
+  auto in1 = fb.Param("in1", p->GetBitsType(2));
+  auto in2 = fb.Param("in2", p->GetBitsType(2));
+  fb.Add(in1, in2, SourceInfo(), "add1");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func_a, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func_b, func_a->Clone("func_b"));
+
+  // Without any time to search for merges, the identical adds are inserted
+  // separately.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IntegrationBuilder> builder,
+      IntegrationBuilder::Build(
+          {func_a, func_b},
+          IntegrationOptions()
+              .algorithm(
+                  IntegrationOptions::Algorithm::kBasicIntegrationAlgorithm)
+              .time_budget(absl::ZeroDuration())));
+
+  EXPECT_THAT(
+      builder->integrated_function()->function()->return_value(),
+      m::Tuple(m::Add(m::TupleIndex(m::Param("func_a_ParamTuple"), 0),
+                      m::TupleIndex(m::Param("func_a_ParamTuple"), 1)),
+               m::Add(m::TupleIndex(m::Param("func_b_ParamTuple"), 0),
+                      m::TupleIndex(m::Param("func_b_ParamTuple"), 1))));
+}
+
 }  // namespace
 }  // namespace xls
@@ -17,6 +17,9 @@
 #define XLS_INTEGRATOR_INTEGRATION_OPTIONS_
 
 #include <iostream>
+#include <optional>
+
+#include "absl/time/time.h"
 
 namespace xls {
 
@@ -45,8 +48,18 @@ class IntegrationOptions {
     return unique_select_signal_per_mux_;
   }
 
+  // Wall-clock time the algorithm may spend searching for profitable merges.
+  // Once the budget is spent, the remaining nodes are inserted without
+  // considering merges. Unbounded if not set.
+  IntegrationOptions& time_budget(absl::Duration value) {
+    time_budget_ = value;
+    return *this;
+  }
+  std::optional<absl::Duration> time_budget() const { return time_budget_; }
+
  private:
   bool unique_select_signal_per_mux_ = false;
+  std::optional<absl::Duration> time_budget_;
   Algorithm algorithm_ = Algorithm::kBasicIntegrationAlgorithm;
 };
 
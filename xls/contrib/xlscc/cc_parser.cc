@@ -14,24 +14,38 @@
 
 #include "xls/contrib/xlscc/cc_parser.h"
 
+#include <unistd.h>
+
 #include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT
 #include <fstream>
+#include <initializer_list>
 #include <map>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <system_error>
 #include <utility>
 #include <vector>
 
+#include "absl/crc/crc32c.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "absl/synchronization/blocking_counter.h"
+#include "absl/types/span.h"
 #include "clang/include/clang/AST/Decl.h"
 #include "clang/include/clang/AST/RecursiveASTVisitor.h"
 #include "clang/include/clang/Basic/SourceLocation.h"
 #include "clang/include/clang/Frontend/CompilerInstance.h"
+#include "clang/include/clang/Frontend/FrontendActions.h"
 #include "clang/include/clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/include/clang/Tooling/Tooling.h"
+#include "xls/common/file/filesystem.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/thread.h"
@@ -119,6 +133,126 @@ int64_t Pragma::int_argument() const { return int_argument_; }
 
 std::string_view Pragma::str_argument() const { return str_argument_; }
 
+namespace {
+
+// Declarations made available to all xlscc sources as "/xls_builtin.h".
+constexpr std::string_view kXlsBuiltinHeader = R"(
+#ifndef __XLS_BUILTIN_H
+#define __XLS_BUILTIN_H
+template<int N>
+struct __xls_bits { };
+
+// Should match OpType
+enum __xls_channel_dir {
+  __xls_channel_dir_Unknown=0,    // OpType::kNull
+  __xls_channel_dir_Out=1,        // OpType::kSend
+  __xls_channel_dir_In=2,         // OpType::kRecv
+  __xls_channel_dir_InOut=3       // OpType::kSendRecv
+};
+
+template<typename T, __xls_channel_dir Dir=__xls_channel_dir_Unknown>
+class __xls_channel {
+ public:
+  T read()const {
+    return T();
+  }
+  T write(T val)const {
+    return val;
+  }
+  void read(T& out)const {
+    (void)out;
+  }
+  bool nb_read(T& out)const {
+    (void)out;
+    return true;
+  }
+};
+
+template<typename T, unsigned long long Size>
+class __xls_memory {
+ public:
+  unsigned long long size()const {
+    return Size;
+  };
+
+  T& operator[](long long int addr)const {
+    static T ret;
+    return ret;
+  }
+  void write(long long int addr, const T& value) const {
+    return;
+  }
+  T read(long long int addr) const {
+    return T();
+  }
+};
+
+
+// Bypass no outputs error
+int __xlscc_unimplemented() { return 0; }
+
+void __xlscc_assert(const char*message, bool condition, const char*label=nullptr) { }
+
+// See XLS IR trace op format
+void __xlscc_trace(const char*fmt, ...) { }
+
+bool __xlscc_on_reset = false;
+
+// Returns bits for 32.32 fixed point representation
+__xls_bits<64> __xlscc_fixed_32_32_bits_for_double(double input);
+__xls_bits<64> __xlscc_fixed_32_32_bits_for_float(float input);
+
+// For use with loops
+void __xlscc_pipeline(long long factor) { }
+void __xlscc_unroll(long long factor) { }
+
+// Place at the beginning of the token graph, connected to the end, in parallel
+// to anything else, rather than serializing as by default
+void __xlscc_asap() { }
+
+#endif//__XLS_BUILTIN_H
+          )";
+
+// Virtual source from which precompiled headers are built.
+constexpr std::string_view kPchSourcePath = "/xls_pch.h";
+
+// Returns the clang command line for parsing with `command_line_args`.
+// `leading_args` come first, so they may include the input file and options
+// like "-x" which must precede it.
+std::vector<std::string> ClangArgv(
+    std::initializer_list<std::string_view> leading_args,
+    absl::Span<std::string_view> command_line_args) {
+  std::vector<std::string> argv;
+  argv.emplace_back("binary");
+  for (std::string_view arg : leading_args) {
+    argv.emplace_back(arg);
+  }
+  for (const auto& view : command_line_args) {
+    argv.emplace_back(view);
+  }
+  // For xls_top.cc to include the source file
+  argv.emplace_back("-I.");
+  argv.emplace_back("-std=c++17");
+  argv.emplace_back("-nostdinc");
+  argv.emplace_back("-Wno-unused-label");
+  argv.emplace_back("-Wno-constant-logical-operand");
+  argv.emplace_back("-Wno-unused-but-set-variable");
+  argv.emplace_back("-Wno-c++11-narrowing");
+  return argv;
+}
+
+// Returns the text of the virtual header including the built-ins and then
+// each of `headers`.
+std::string PchSource(absl::Span<const std::string> headers) {
+  std::string source = "#include \"/xls_builtin.h\"\n";
+  for (const std::string& header : headers) {
+    absl::StrAppendFormat(&source, "#include \"%s\"\n", header);
+  }
+  return source;
+}
+
+}  // namespace
+
 CCParser::~CCParser() {
   // Allow parser and its thread to be destroyed
   if (libtool_wait_for_destruct_ != nullptr) {
@@ -145,6 +279,11 @@ absl::Status CCParser::ScanFile(
   // Therefore, ToolInvocation::Run() is executed on another thread,
   //  and the ASTFrontendAction::EndSourceFileAction() blocks it
   //  until ~CCParser(), preserving the AST.
+  if (!pch_headers_.empty()) {
+    XLS_ASSIGN_OR_RETURN(pch_path_,
+                         GetOrGeneratePrecompiledHeader(command_line_args));
+  }
+
   libtool_thread_ = absl::WrapUnique(new LibToolThread(
       source_filename, top_class_name_, command_line_args, *this));
 
@@ -156,6 +295,75 @@ absl::Status CCParser::ScanFile(
   return libtool_visit_status_;
 }
 
+void CCParser::UsePrecompiledHeaders(std::vector<std::string> headers,
+                                     std::string_view cache_dir) {
+  pch_headers_ = std::move(headers);
+  pch_cache_dir_ = cache_dir;
+}
+
+absl::StatusOr<std::string> CCParser::GetOrGeneratePrecompiledHeader(
+    absl::Span<std::string_view> command_line_args) {
+  const std::string pch_source = PchSource(pch_headers_);
+
+  // Key on everything that affects the parse of the headers: the built-ins,
+  // the clang arguments (including defines and include paths), and the
+  // headers themselves. Changes to files the headers include in turn are
+  // caught by clang, which rejects a precompiled header with stale inputs.
+  std::string key_text = absl::StrCat(kXlsBuiltinHeader, "\n", pch_source);
+  for (std::string_view arg : command_line_args) {
+    absl::StrAppend(&key_text, arg, "\n");
+  }
+  for (const std::string& header : pch_headers_) {
+    XLS_ASSIGN_OR_RETURN(std::string contents, xls::GetFileContents(header));
+    absl::StrAppend(&key_text, header, "\n", contents);
+  }
+  const uint32_t key = static_cast<uint32_t>(absl::ComputeCrc32c(key_text));
+  const std::filesystem::path pch_path =
+      std::filesystem::path(pch_cache_dir_) /
+      absl::StrFormat("xlscc_%08x.pch", key);
+  if (xls::FileExists(pch_path).ok()) {
+    XLS_VLOG(1) << "Using precompiled header " << pch_path;
+    return pch_path.string();
+  }
+
+  XLS_RETURN_IF_ERROR(xls::RecursivelyCreateDir(pch_cache_dir_));
+  // Written under a temporary name and then renamed, so that concurrent
+  // xlscc invocations never see a partial file.
+  const std::string temp_path = absl::StrFormat(
+      "%s.%d.tmp", pch_path.string(), static_cast<int64_t>(getpid()));
+  std::vector<std::string> argv = ClangArgv(
+      {"-x", "c++-header", kPchSourcePath, "-o", temp_path},
+      command_line_args);
+
+  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> mem_fs(
+      new llvm::vfs::InMemoryFileSystem);
+  mem_fs->addFile("/xls_builtin.h", 0,
+                  llvm::MemoryBuffer::getMemBuffer(kXlsBuiltinHeader));
+  mem_fs->addFile(kPchSourcePath, 0,
+                  llvm::MemoryBuffer::getMemBufferCopy(pch_source));
+  llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> overlay_fs(
+      new llvm::vfs::OverlayFileSystem(llvm::vfs::getRealFileSystem()));
+  overlay_fs->pushOverlay(mem_fs);
+  llvm::IntrusiveRefCntPtr<clang::FileManager> files(
+      new clang::FileManager(clang::FileSystemOptions(), overlay_fs));
+
+  clang::tooling::ToolInvocation invocation(
+      argv, std::make_unique<clang::GeneratePCHAction>(), files.get());
+  if (!invocation.run() || !xls::FileExists(temp_path).ok()) {
+    return absl::FailedPreconditionError(absl::StrFormat(
+        "Unable to precompile headers %s", absl::StrJoin(pch_headers_, ", ")));
+  }
+  std::error_code ec;
+  std::filesystem::rename(temp_path, pch_path, ec);
+  if (ec) {
+    return absl::InternalError(
+        absl::StrFormat("Unable to rename %s to %s: %s", temp_path,
+                        pch_path.string(), ec.message()));
+  }
+  XLS_VLOG(1) << "Generated precompiled header " << pch_path;
+  return pch_path.string();
+}
+
 void CCParser::AddSourceInfoToMetadata(xlscc_metadata::MetadataOutput& output) {
   for (const auto& [path, number] : file_numbers_) {
     xlscc_metadata::SourceName* source = output.add_sources();
@@ -498,21 +706,12 @@ void LibToolThread::Start() {
 void LibToolThread::Join() { thread_->Join(); }
 
 void LibToolThread::Run() {
-  std::vector<std::string> argv;
-  argv.emplace_back("binary");
-  argv.emplace_back("/xls_top.cc");
-  for (const auto& view : command_line_args_) {
-    argv.emplace_back(view);
+  std::vector<std::string> argv =
+      ClangArgv({"/xls_top.cc", "-fsyntax-only"}, command_line_args_);
+  if (!parser_.pch_path_.empty()) {
+    argv.emplace_back("-include-pch");
+    argv.emplace_back(parser_.pch_path_);
   }
-  // For xls_top.cc to include the source file
-  argv.emplace_back("-I.");
-  argv.emplace_back("-fsyntax-only");
-  argv.emplace_back("-std=c++17");
-  argv.emplace_back("-nostdinc");
-  argv.emplace_back("-Wno-unused-label");
-  argv.emplace_back("-Wno-constant-logical-operand");
-  argv.emplace_back("-Wno-unused-but-set-variable");
-  argv.emplace_back("-Wno-c++11-narrowing");
 
   llvm::IntrusiveRefCntPtr<clang::FileManager> libtool_files;
 
@@ -522,83 +721,13 @@ void LibToolThread::Run() {
   llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> mem_fs(
       new llvm::vfs::InMemoryFileSystem);
   mem_fs->addFile("/xls_builtin.h", 0,
-                  llvm::MemoryBuffer::getMemBuffer(
-                      R"(
-#ifndef __XLS_BUILTIN_H
-#define __XLS_BUILTIN_H
-template<int N>
-struct __xls_bits { };
-
-// Should match OpType
-enum __xls_channel_dir {
-  __xls_channel_dir_Unknown=0,    // OpType::kNull
-  __xls_channel_dir_Out=1,        // OpType::kSend
-  __xls_channel_dir_In=2,         // OpType::kRecv
-  __xls_channel_dir_InOut=3       // OpType::kSendRecv
-};
-
-template<typename T, __xls_channel_dir Dir=__xls_channel_dir_Unknown>
-class __xls_channel {
- public:
-  T read()const {
-    return T();
-  }
-  T write(T val)const {
-    return val;
-  }
-  void read(T& out)const {
-    (void)out;
+                  llvm::MemoryBuffer::getMemBuffer(kXlsBuiltinHeader));
+  if (!parser_.pch_path_.empty()) {
+    // The precompiled header records its inputs, which must still exist.
+    mem_fs->addFile(kPchSourcePath, 0,
+                    llvm::MemoryBuffer::getMemBufferCopy(
+                        PchSource(parser_.pch_headers_)));
   }
-  bool nb_read(T& out)const {
-    (void)out;
-    return true;
-  }
-};
-
-template<typename T, unsigned long long Size>
-class __xls_memory {
- public:
-  unsigned long long size()const {
-    return Size;
-  };
-
-  T& operator[](long long int addr)const {
-    static T ret;
-    return ret;
-  }
-  void write(long long int addr, const T& value) const {
-    return;
-  }
-  T read(long long int addr) const {
-    return T();
-  }
-};
-
-
-// Bypass no outputs error
-int __xlscc_unimplemented() { return 0; }
-
-void __xlscc_assert(const char*message, bool condition, const char*label=nullptr) { }
-
-// See XLS IR trace op format
-void __xlscc_trace(const char*fmt, ...) { }
-
-bool __xlscc_on_reset = false;
-
-// Returns bits for 32.32 fixed point representation
-__xls_bits<64> __xlscc_fixed_32_32_bits_for_double(double input);
-__xls_bits<64> __xlscc_fixed_32_32_bits_for_float(float input);
-
-// For use with loops
-void __xlscc_pipeline(long long factor) { }
-void __xlscc_unroll(long long factor) { }
-
-// Place at the beginning of the token graph, connected to the end, in parallel
-// to anything else, rather than serializing as by default
-void __xlscc_asap() { }
-
-#endif//__XLS_BUILTIN_H
-          )"));
 
   // Inject an instantiation to make Clang parse the constructor bodies
   std::string top_class_inst_injection = top_class_name_.empty()
@@ -20,12 +20,14 @@
 #include <string>
 #include <string_view>
 #include <tuple>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/blocking_counter.h"
+#include "absl/types/span.h"
 #include "clang/include/clang/AST/Decl.h"
 #include "xls/common/thread.h"
 #include "xls/contrib/xlscc/metadata_output.pb.h"
@@ -94,6 +96,7 @@ class CCParser {
   friend class LibToolVisitor;
   friend class DiagnosticInterceptor;
   friend class LibToolFrontendAction;
+  friend class LibToolThread;
 
  public:
   // Deletes the AST
@@ -107,6 +110,17 @@ class CCParser {
   absl::Status SelectTop(std::string_view top_function_name,
                          std::string_view top_class_name = "");
 
+  // Parses the given headers, together with the xlscc built-ins, into a clang
+  // precompiled header the first time and loads it in ScanFile() instead of
+  // parsing them again. Sources should include these headers before anything
+  // else. Precompiled headers are kept in `cache_dir`, named after a hash of
+  // the headers and the clang arguments, so invocations with the same
+  // includes, defines, and clang args share one.
+  //
+  // Must be called before ScanFile().
+  void UsePrecompiledHeaders(std::vector<std::string> headers,
+                             std::string_view cache_dir);
+
   // This function uses Clang to parse a source file and then walks its
   //  AST to discover global constructs. It will also scan the file
   //  and includes, recursively, for #pragma statements.
@@ -163,6 +177,16 @@ class CCParser {
   absl::Status VisitVarDecl(const clang::VarDecl* funcdecl);
   absl::Status ScanFileForPragmas(std::string_view filename);
 
+  // Returns the path of the precompiled header for `pch_headers_` parsed with
+  // `command_line_args`, generating it if it is not already cached.
+  absl::StatusOr<std::string> GetOrGeneratePrecompiledHeader(
+      absl::Span<std::string_view> command_line_args);
+
+  std::vector<std::string> pch_headers_;
+  std::string pch_cache_dir_;
+  // Precompiled header loaded by the parse, or empty if none.
+  std::string pch_path_;
+
   using PragmaLoc = std::tuple<std::string, int>;
   absl::flat_hash_map<PragmaLoc, Pragma> hls_pragmas_;
   absl::flat_hash_set<std::string> files_scanned_for_pragmas_;
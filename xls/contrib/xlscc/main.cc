@@ -16,6 +16,7 @@
 // front-end. It accepts as input a C/C++ file and produces as textual output
 // the equivalent XLS intermediate representation (IR).
 
+#include <cstdint>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
@@ -38,7 +39,10 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/contrib/xlscc/hls_block.pb.h"
 #include "xls/contrib/xlscc/metadata_output.pb.h"
+#include "xls/contrib/xlscc/schedule_feasibility.h"
 #include "xls/contrib/xlscc/translator.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/delay_model/delay_estimators.h"
 
 const char kUsage[] = R"(
 Generates XLS IR from a given C++ file, or generates Verilog in the special
@@ -77,6 +81,15 @@ ABSL_FLAG(std::vector<std::string>, defines, std::vector<std::string>(),
 ABSL_FLAG(std::vector<std::string>, include_dirs, std::vector<std::string>(),
           "Comma separated list of include directories to pass to clang");
 
+ABSL_FLAG(std::vector<std::string>, pch_headers, std::vector<std::string>(),
+          "Comma separated list of headers to parse once into a clang "
+          "precompiled header, cached in --pch_cache_dir. The source should "
+          "include them before anything else.");
+
+ABSL_FLAG(std::string, pch_cache_dir, "/tmp/xlscc_pch",
+          "Directory in which precompiled headers for --pch_headers are "
+          "cached, keyed on the headers and clang arguments.");
+
 ABSL_FLAG(std::string, meta_out, "",
           "Path at which to output metadata protobuf");
 
@@ -104,8 +117,54 @@ ABSL_FLAG(int, z3_rlimit, -1,
 ABSL_FLAG(std::string, io_op_token_ordering, "none",
           "none (default), channel_wise, lexical");
 
+ABSL_FLAG(std::string, feasibility_delay_model, "",
+          "If specified, schedule each generated proc with this delay model "
+          "and --feasibility_clock_period_ps to check early whether its "
+          "requested initiation interval can be met. Infeasible intervals are "
+          "reported along with the best achievable one, and are errors with "
+          "--error_on_init_interval.");
+
+ABSL_FLAG(int64_t, feasibility_clock_period_ps, 0,
+          "Clock period used for --feasibility_delay_model.");
+
+ABSL_FLAG(int64_t, feasibility_max_init_interval, 16,
+          "Largest initiation interval tried when searching for the best "
+          "achievable one for --feasibility_delay_model.");
+
 namespace xlscc {
 
+static absl::Status CheckScheduleFeasibility(xls::Package* package,
+                                             const Translator& translator) {
+  const std::string delay_model = absl::GetFlag(FLAGS_feasibility_delay_model);
+  if (delay_model.empty()) {
+    return absl::OkStatus();
+  }
+  if (absl::GetFlag(FLAGS_feasibility_clock_period_ps) <= 0) {
+    return absl::InvalidArgumentError(
+        "--feasibility_delay_model requires --feasibility_clock_period_ps");
+  }
+  XLS_ASSIGN_OR_RETURN(xls::DelayEstimator * delay_estimator,
+                       xls::GetDelayEstimator(delay_model));
+
+  std::cerr << "Checking schedule feasibility..." << std::endl;
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<InitIntervalFeasibility> results,
+      CheckInitIntervalFeasibility(
+          package, translator.GetRequestedInitIntervals(), *delay_estimator,
+          absl::GetFlag(FLAGS_feasibility_clock_period_ps),
+          absl::GetFlag(FLAGS_feasibility_max_init_interval)));
+  for (const InitIntervalFeasibility& result : results) {
+    if (result.feasible()) {
+      continue;
+    }
+    if (absl::GetFlag(FLAGS_error_on_init_interval)) {
+      return absl::ResourceExhaustedError(result.ToString());
+    }
+    XLS_LOG(WARNING) << result.ToString();
+  }
+  return absl::OkStatus();
+}
+
 static absl::Status Run(std::string_view cpp_path) {
   // Warnings should print by default
   absl::SetFlag(&FLAGS_logtostderr, true);
@@ -183,6 +242,11 @@ static absl::Status Run(std::string_view cpp_path) {
     clang_argv.push_back(i);
   }
 
+  if (!absl::GetFlag(FLAGS_pch_headers).empty()) {
+    translator.UsePrecompiledHeaders(absl::GetFlag(FLAGS_pch_headers),
+                                     absl::GetFlag(FLAGS_pch_cache_dir));
+  }
+
   std::cerr << "Parsing file '" << cpp_path << "' with clang..." << std::endl;
   XLS_RETURN_IF_ERROR(translator.ScanFile(
       cpp_path, clang_argv.empty()
@@ -246,6 +310,7 @@ static absl::Status Run(std::string_view cpp_path) {
     }
 
     XLS_RETURN_IF_ERROR(package.SetTop(proc));
+    XLS_RETURN_IF_ERROR(CheckScheduleFeasibility(&package, translator));
     std::cerr << "Saving Package IR..." << std::endl;
     translator.AddSourceInfoToPackage(package);
     XLS_RETURN_IF_ERROR(write_to_output(absl::StrCat(package.DumpIr(), "\n")));
@@ -0,0 +1,118 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/contrib/xlscc/schedule_feasibility.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/scheduling/run_pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xlscc {
+namespace {
+
+absl::Status TryScheduleAtInitInterval(
+    xls::Proc* proc, const xls::DelayEstimator& delay_estimator,
+    int64_t clock_period_ps, int64_t init_interval) {
+  // RunPipelineSchedule records the interval on the proc; the check should
+  // not change the IR that gets emitted.
+  std::optional<int64_t> original_init_interval =
+      proc->GetInitiationInterval();
+  absl::Status status =
+      xls::RunPipelineSchedule(proc, delay_estimator,
+                               xls::SchedulingOptions()
+                                   .clock_period_ps(clock_period_ps)
+                                   .worst_case_throughput(init_interval))
+          .status();
+  if (original_init_interval.has_value()) {
+    proc->SetInitiationInterval(*original_init_interval);
+  } else {
+    proc->ClearInitiationInterval();
+  }
+  return status;
+}
+
+}  // namespace
+
+std::string InitIntervalFeasibility::ToString() const {
+  if (feasible()) {
+    return absl::StrFormat("%s: initiation interval %d is achievable",
+                           proc->name(), requested_init_interval);
+  }
+  if (achievable_init_interval.has_value()) {
+    return absl::StrFormat(
+        "%s: initiation interval %d is not achievable, best achievable is %d: "
+        "%s",
+        proc->name(), requested_init_interval, *achievable_init_interval,
+        requested_status.message());
+  }
+  return absl::StrFormat(
+      "%s: initiation interval %d is not achievable, nor is any interval up "
+      "to the search limit: %s",
+      proc->name(), requested_init_interval, requested_status.message());
+}
+
+absl::StatusOr<std::vector<InitIntervalFeasibility>>
+CheckInitIntervalFeasibility(
+    xls::Package* package,
+    const absl::flat_hash_map<const xls::Proc*, int64_t>&
+        requested_init_intervals,
+    const xls::DelayEstimator& delay_estimator, int64_t clock_period_ps,
+    int64_t max_init_interval) {
+  XLS_RET_CHECK_GT(clock_period_ps, 0);
+
+  std::vector<InitIntervalFeasibility> results;
+  for (std::unique_ptr<xls::Proc>& proc : package->procs()) {
+    auto it = requested_init_intervals.find(proc.get());
+    if (it == requested_init_intervals.end()) {
+      continue;
+    }
+    InitIntervalFeasibility result{.proc = proc.get(),
+                                   .requested_init_interval = it->second};
+    XLS_RET_CHECK_GT(result.requested_init_interval, 0);
+    result.requested_status =
+        TryScheduleAtInitInterval(proc.get(), delay_estimator, clock_period_ps,
+                                  result.requested_init_interval);
+    if (result.requested_status.ok()) {
+      result.achievable_init_interval = result.requested_init_interval;
+    } else {
+      for (int64_t init_interval = result.requested_init_interval + 1;
+           init_interval <= max_init_interval; ++init_interval) {
+        if (TryScheduleAtInitInterval(proc.get(), delay_estimator,
+                                      clock_period_ps, init_interval)
+                .ok()) {
+          result.achievable_init_interval = init_interval;
+          break;
+        }
+      }
+    }
+    results.push_back(std::move(result));
+  }
+  return results;
+}
+
+}  // namespace xlscc
@@ -0,0 +1,71 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_CONTRIB_XLSCC_SCHEDULE_FEASIBILITY_H_
+#define XLS_CONTRIB_XLSCC_SCHEDULE_FEASIBILITY_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+
+namespace xlscc {
+
+// Outcome of scheduling a generated proc at the initiation interval requested
+// for it in the C++ source.
+struct InitIntervalFeasibility {
+  xls::Proc* proc = nullptr;
+  int64_t requested_init_interval = 1;
+
+  // Smallest initiation interval no less than the requested one at which the
+  // proc schedules, or nullopt if it does not schedule at any interval up to
+  // the search limit.
+  std::optional<int64_t> achievable_init_interval;
+
+  // Why scheduling at the requested initiation interval failed. OK if it
+  // succeeded.
+  absl::Status requested_status;
+
+  bool feasible() const {
+    return achievable_init_interval == requested_init_interval;
+  }
+
+  std::string ToString() const;
+};
+
+// Runs the SDC scheduler with `delay_estimator` and `clock_period_ps` on each
+// proc of `package` that has an entry in `requested_init_intervals`, to find
+// out before codegen whether the requested initiation interval can be met.
+// When it cannot, increasing intervals are tried up to `max_init_interval` to
+// report the best achievable throughput. Results are in package order.
+//
+// The initiation interval attribute of each proc is left as it was found.
+absl::StatusOr<std::vector<InitIntervalFeasibility>>
+CheckInitIntervalFeasibility(
+    xls::Package* package,
+    const absl::flat_hash_map<const xls::Proc*, int64_t>&
+        requested_init_intervals,
+    const xls::DelayEstimator& delay_estimator, int64_t clock_period_ps,
+    int64_t max_init_interval);
+
+}  // namespace xlscc
+
+#endif  // XLS_CONTRIB_XLSCC_SCHEDULE_FEASIBILITY_H_
@@ -331,7 +331,12 @@ absl::StatusOr<xls::Proc*> Translator::GenerateIR_Block(
   }
   XLS_CHECK_EQ(static_next_values.size(), prepared.state_init_count);
 
-  return pb.Build(prepared.token, static_next_values);
+  XLS_ASSIGN_OR_RETURN(xls::Proc * proc,
+                       pb.Build(prepared.token, static_next_values));
+  if (top_level_init_interval > 0) {
+    init_intervals_by_proc_[proc] = top_level_init_interval;
+  }
+  return proc;
 }
 
 absl::StatusOr<xls::Proc*> Translator::GenerateIR_BlockFromClass(
@@ -196,6 +196,12 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
 
   double slowest_iter = 0;
 
+  // Constant folding of the loop condition carries over between iterations,
+  // so loop-carried values computed from constants (e.g., the induction
+  // variable) fold to literals as each iteration is generated, and the exit
+  // is decided without Z3 whenever the condition folds to a constant.
+  ShortCircuitReplacements condition_replacements;
+
   for (int64_t nIters = 0;; ++nIters) {
     const bool first_iter = nIters == 0;
     const bool always_this_iter = always_first_iter && first_iter;
@@ -232,9 +238,10 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
 
     {
       // We use the relative condition so that returns also stop unrolling
-      XLS_ASSIGN_OR_RETURN(bool condition_must_be_false,
-                           BitMustBe(false, context().relative_condition,
-                                     solver, z3_translator_parent->ctx(), loc));
+      XLS_ASSIGN_OR_RETURN(
+          bool condition_must_be_false,
+          BitMustBe(false, context().relative_condition, solver,
+                    z3_translator_parent->ctx(), loc, &condition_replacements));
       if (condition_must_be_false) {
         break;
       }
@@ -937,6 +944,8 @@ absl::StatusOr<PipelinedLoopSubProc> Translator::GenerateIR_PipelinedLoopBody(
       // context_ members are filled in by caller
       .loc = loc,
 
+      .init_interval = init_interval,
+
       .enclosing_func = context().sf,
       .outer_variables = context().variables,
       .context_field_indices = context_field_indices,
@@ -1198,7 +1207,8 @@ absl::Status Translator::GenerateIR_PipelinedLoopProc(
         ret_tup, prepared.return_index_for_static.at(namedecl), loc));
   }
 
-  XLS_RETURN_IF_ERROR(pb.Build(token, next_state_values).status());
+  XLS_ASSIGN_OR_RETURN(xls::Proc * proc, pb.Build(token, next_state_values));
+  init_intervals_by_proc_[proc] = pipelined_loop_proc.init_interval;
 
   return absl::OkStatus();
 }
@@ -1150,6 +1150,34 @@ absl::Status Translator::GenerateIR_Function_Body(
   return absl::OkStatus();
 }
 
+absl::Status Translator::ReuseIdenticalFunction(
+    GeneratedFunction& sf, const clang::FunctionDecl* funcdecl) {
+  if (sf.xls_func == nullptr || sf.this_lvalue != nullptr ||
+      sf.return_lvalue != nullptr || !sf.io_channels.empty() ||
+      !sf.sub_procs.empty() || !sf.lvalues_by_param.empty() ||
+      !sf.io_ops.empty() || !sf.side_effecting_parameters.empty() ||
+      !sf.global_values.empty() || !sf.static_values.empty()) {
+    return absl::OkStatus();
+  }
+  std::string shape =
+      absl::StrFormat("%s %d", sf.xls_func->GetType()->ToString(),
+                      sf.xls_func->node_count());
+  std::vector<xls::Function*>& candidates =
+      shareable_functions_by_shape_[shape];
+  for (xls::Function* candidate : candidates) {
+    if (candidate->IsDefinitelyEqualTo(sf.xls_func)) {
+      XLS_VLOG(2) << "Reusing " << candidate->name() << " for "
+                  << sf.xls_func->name();
+      XLS_RETURN_IF_ERROR(package_->RemoveFunction(sf.xls_func));
+      sf.xls_func = candidate;
+      xls_names_for_functions_generated_[funcdecl] = candidate->name();
+      return absl::OkStatus();
+    }
+  }
+  candidates.push_back(sf.xls_func);
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::shared_ptr<CType>> Translator::InterceptBuiltInStruct(
     const clang::RecordDecl* sd) {
   // "__xls_bits" is a special built-in type: CBitsType
@@ -3371,6 +3399,7 @@ absl::StatusOr<CValue> Translator::GenerateIR_Call(
 
       XLS_RETURN_IF_ERROR(
           GenerateIR_Function_Body(*func, funcdecl, *function_header));
+      XLS_RETURN_IF_ERROR(ReuseIdenticalFunction(*func, funcdecl));
 
       inst_functions_[signature] =
           std::move(function_header->generated_function);
@@ -4531,26 +4560,43 @@ absl::StatusOr<xls::Value> Translator::EvaluateNode(xls::Node* node,
   return result;
 }
 
-absl::Status Translator::ShortCircuitBVal(xls::BValue& bval,
-                                          const xls::SourceInfo& loc) {
-  absl::flat_hash_set<xls::Node*> visited;
-  return ShortCircuitNode(bval.node(), bval, nullptr, visited, loc);
+absl::Status Translator::ShortCircuitBVal(
+    xls::BValue& bval, const xls::SourceInfo& loc,
+    ShortCircuitReplacements* replacements) {
+  ShortCircuitReplacements local_replacements;
+  return ShortCircuitNode(
+      bval.node(), bval, nullptr,
+      replacements != nullptr ? *replacements : local_replacements, loc);
 }
 
 absl::Status Translator::ShortCircuitNode(
     xls::Node* node, xls::BValue& top_bval, xls::Node* parent,
-    absl::flat_hash_set<xls::Node*>& visited, const xls::SourceInfo& loc) {
-  if (visited.contains(node)) {
+    ShortCircuitReplacements& replacements, const xls::SourceInfo& loc) {
+  auto replace_with = [&](xls::Node* replacement) -> absl::Status {
+    replacements[node] = replacement;
+    if (replacement == node) {
+      return absl::OkStatus();
+    }
+    if (parent != nullptr) {
+      XLSCC_CHECK(parent->ReplaceOperand(node, replacement), loc);
+    } else {
+      top_bval = xls::BValue(replacement, context().fb);
+    }
     return absl::OkStatus();
+  };
+
+  if (auto it = replacements.find(node); it != replacements.end()) {
+    return replace_with(it->second);
   }
 
-  visited.insert(node);
+  replacements[node] = node;
 
   // Depth-first to allow multi-step short circuits
   // Index based to avoid modify while iterating
   for (int oi = 0; oi < node->operand_count(); ++oi) {
     xls::Node* op = node->operand(oi);
-    XLS_RETURN_IF_ERROR(ShortCircuitNode(op, top_bval, node, visited, loc));
+    XLS_RETURN_IF_ERROR(
+        ShortCircuitNode(op, top_bval, node, replacements, loc));
   }
 
   // Don't duplicate literals
@@ -4565,13 +4611,7 @@ absl::Status Translator::ShortCircuitNode(
   if (const_result.ok()) {
     xls::BValue literal_bval =
         context().fb->Literal(const_result.value(), node->loc());
-
-    if (parent != nullptr) {
-      XLSCC_CHECK(parent->ReplaceOperand(node, literal_bval.node()), loc);
-    } else {
-      top_bval = literal_bval;
-    }
-    return absl::OkStatus();
+    return replace_with(literal_bval.node());
   }
 
   if (!((node->op() == xls::Op::kAnd) || (node->op() == xls::Op::kOr))) {
@@ -4596,13 +4636,7 @@ absl::Status Translator::ShortCircuitNode(
     }
 
     // Replace the node with its literal operand
-    if (parent != nullptr) {
-      XLSCC_CHECK(parent->ReplaceOperand(node, op), loc);
-    } else {
-      top_bval = xls::BValue(op, context().fb);
-    }
-
-    return absl::OkStatus();
+    return replace_with(op);
   }
 
   return absl::OkStatus();
@@ -5255,9 +5289,9 @@ absl::StatusOr<Z3_lbool> Translator::CheckAssumptions(
   return seh.status();
 }
 
-absl::StatusOr<bool> Translator::BitMustBe(bool assert_value, xls::BValue& bval,
-                                           Z3_solver& solver, Z3_context ctx,
-                                           const xls::SourceInfo& loc) {
+absl::StatusOr<bool> Translator::BitMustBe(
+    bool assert_value, xls::BValue& bval, Z3_solver& solver, Z3_context ctx,
+    const xls::SourceInfo& loc, ShortCircuitReplacements* replacements) {
   // Invalid is interpreted as literal 1
   if (!bval.valid()) {
     return assert_value;
@@ -5266,7 +5300,13 @@ absl::StatusOr<bool> Translator::BitMustBe(bool assert_value, xls::BValue& bval,
   // Simplify break logic in easy ways;
   // Z3 fails to solve some cases without this.
 
-  XLS_RETURN_IF_ERROR(ShortCircuitBVal(bval, loc));
+  XLS_RETURN_IF_ERROR(ShortCircuitBVal(bval, loc, replacements));
+
+  // Known values need no solver call.
+  if (bval.node()->Is<xls::Literal>()) {
+    return bval.node()->As<xls::Literal>()->value().IsAllOnes() ==
+           assert_value;
+  }
 
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<xls::solvers::z3::IrTranslator> z3_translator,
@@ -5712,6 +5752,12 @@ absl::Status Translator::ScanFile(
   return parser_->ScanFile(source_filename, command_line_args);
 }
 
+void Translator::UsePrecompiledHeaders(std::vector<std::string> headers,
+                                       std::string_view cache_dir) {
+  XLS_CHECK_NE(parser_.get(), nullptr);
+  parser_->UsePrecompiledHeaders(std::move(headers), cache_dir);
+}
+
 absl::StatusOr<std::string> Translator::GetEntryFunctionName() const {
   XLS_CHECK_NE(parser_.get(), nullptr);
   return parser_->GetEntryFunctionName();
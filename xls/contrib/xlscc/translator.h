@@ -760,6 +760,8 @@ struct PipelinedLoopSubProc {
 
   xls::SourceInfo loc;
 
+  int64_t init_interval = 0;
+
   GeneratedFunction* enclosing_func = nullptr;
   absl::flat_hash_map<const clang::NamedDecl*, CValue> outer_variables;
 
@@ -1107,6 +1109,10 @@ class Translator {
   absl::Status SelectTop(std::string_view top_function_name,
                          std::string_view top_class_name = "");
 
+  // See CCParser::UsePrecompiledHeaders()
+  void UsePrecompiledHeaders(std::vector<std::string> headers,
+                             std::string_view cache_dir);
+
   // Generates IR as an XLS function, that is, a pure function without
   //  IO / state / side effects.
   // If top_function is 0 or "" then top must be specified via pragma
@@ -1135,6 +1141,13 @@ class Translator {
   //  codegen is done by XLS[cc] for combinational blocks.
   absl::Status InlineAllInvokes(xls::Package* package);
 
+  // Initiation intervals requested for the procs generated so far, from
+  // the top level init interval or from pipelined loop pragmas.
+  const absl::flat_hash_map<const xls::Proc*, int64_t>&
+  GetRequestedInitIntervals() const {
+    return init_intervals_by_proc_;
+  }
+
   // Generate some useful metadata after either GenerateIR_Top_Function() or
   //  GenerateIR_Block() has run.
   absl::StatusOr<xlscc_metadata::MetadataOutput> GenerateMetadata();
@@ -1408,6 +1421,11 @@ class Translator {
   absl::flat_hash_map<const clang::FunctionDecl*, std::string>
       xls_names_for_functions_generated_;
 
+  // Shareable functions generated so far, keyed on their type and node count.
+  // See ReuseIdenticalFunction().
+  absl::flat_hash_map<std::string, std::vector<xls::Function*>>
+      shareable_functions_by_shape_;
+
   int next_asm_number_ = 1;
   int next_for_number_ = 1;
   int next_local_channel_number_ = 1;
@@ -1423,6 +1441,8 @@ class Translator {
   xls::Package* package_ = nullptr;
   int default_init_interval_ = 0;
 
+  absl::flat_hash_map<const xls::Proc*, int64_t> init_intervals_by_proc_;
+
   // Initially contains keys for the channels of the top function,
   // then subroutine parameters are added as their headers are translated.
   absl::btree_multimap<const IOChannel*, ChannelBundle>
@@ -1814,6 +1834,16 @@ class Translator {
                                         const clang::FunctionDecl* funcdecl,
                                         const FunctionInProgress& header);
 
+  // Replaces the freshly generated body of `sf` with an identical XLS function
+  // generated earlier for another declaration, if there is one. Distinct
+  // template instantiations often produce the same IR (e.g., fixed-point
+  // operations differing only in the position of the binary point), so this
+  // keeps one copy of each in the package. Only functions without IO,
+  // statics, or lvalue returns are shared, as those refer to nodes of their
+  // own body.
+  absl::Status ReuseIdenticalFunction(GeneratedFunction& sf,
+                                      const clang::FunctionDecl* funcdecl);
+
   absl::Status GenerateIR_Ctor_Initializers(
       const clang::CXXConstructorDecl* constructor);
 
@@ -1859,11 +1889,20 @@ class Translator {
                                           const xls::SourceInfo& loc,
                                           bool do_check = true);
 
+  // Maps each node visited by ShortCircuitNode() to the node replacing it (a
+  // literal or a short-circuiting operand), or to itself. Values of IR nodes
+  // never change, so a map can be reused across calls as long as all the
+  // nodes belong to the same function builder, avoiding walks over parts of
+  // the graph already simplified; unrolled loops keep one per loop.
+  using ShortCircuitReplacements = absl::flat_hash_map<xls::Node*, xls::Node*>;
+
   absl::Status ShortCircuitNode(xls::Node* node, xls::BValue& top_bval,
                                 xls::Node* parent,
-                                absl::flat_hash_set<xls::Node*>& visited,
+                                ShortCircuitReplacements& replacements,
                                 const xls::SourceInfo& loc);
-  absl::Status ShortCircuitBVal(xls::BValue& bval, const xls::SourceInfo& loc);
+  absl::Status ShortCircuitBVal(
+      xls::BValue& bval, const xls::SourceInfo& loc,
+      ShortCircuitReplacements* replacements = nullptr);
   absl::StatusOr<xls::Value> EvaluateBVal(xls::BValue bval,
                                           const xls::SourceInfo& loc,
                                           bool do_check = true);
@@ -1876,10 +1915,12 @@ class Translator {
       xls::solvers::z3::IrTranslator& z3_translator);
 
   // bval can be invalid, in which case it is interpreted as 1
-  // Short circuits the BValue
-  absl::StatusOr<bool> BitMustBe(bool assert_value, xls::BValue& bval,
-                                 Z3_solver& solver, Z3_context ctx,
-                                 const xls::SourceInfo& loc);
+  // Short circuits the BValue, using and updating `replacements` if given.
+  // Z3 is only consulted if the short-circuited value is not a literal.
+  absl::StatusOr<bool> BitMustBe(
+      bool assert_value, xls::BValue& bval, Z3_solver& solver, Z3_context ctx,
+      const xls::SourceInfo& loc,
+      ShortCircuitReplacements* replacements = nullptr);
 
   absl::StatusOr<ConstValue> TranslateBValToConstVal(const CValue& bvalue,
                                                      const xls::SourceInfo& loc,
@@ -0,0 +1,90 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/contrib/xlscc/schedule_feasibility.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/value.h"
+
+namespace xlscc {
+namespace {
+
+using ::testing::HasSubstr;
+
+class ScheduleFeasibilityTest : public xls::IrTestBase {};
+
+TEST_F(ScheduleFeasibilityTest, ReportsBestAchievableInitInterval) {
+  auto p = CreatePackage();
+
+  // The state backedge is three operations long, so with one operation per
+  // cycle the proc can only accept new state every third cycle.
+  xls::ProcBuilder pb("slow_loop_proc", /*token_name=*/"tkn", p.get());
+  xls::BValue state = pb.StateElement("state", xls::Value(xls::UBits(0, 32)));
+  xls::BValue one = pb.Literal(xls::UBits(1, 32));
+  xls::BValue next = pb.Add(pb.Add(pb.Add(state, one), one), one);
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Proc * slow_proc,
+                           pb.Build(pb.GetTokenParam(), {next}));
+
+  xls::ProcBuilder fast_pb("fast_loop_proc", /*token_name=*/"tkn", p.get());
+  xls::BValue fast_state =
+      fast_pb.StateElement("state", xls::Value(xls::UBits(0, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      xls::Proc * fast_proc,
+      fast_pb.Build(fast_pb.GetTokenParam(),
+                    {fast_pb.Add(fast_state,
+                                 fast_pb.Literal(xls::UBits(1, 32)))}));
+
+  absl::flat_hash_map<const xls::Proc*, int64_t> requested = {
+      {slow_proc, 1}, {fast_proc, 1}};
+  xls::TestDelayEstimator delay_estimator;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<InitIntervalFeasibility> results,
+      CheckInitIntervalFeasibility(p.get(), requested, delay_estimator,
+                                   /*clock_period_ps=*/1,
+                                   /*max_init_interval=*/4));
+
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[0].proc, slow_proc);
+  EXPECT_FALSE(results[0].feasible());
+  EXPECT_FALSE(results[0].requested_status.ok());
+  EXPECT_EQ(results[0].achievable_init_interval, 3);
+  EXPECT_THAT(results[0].ToString(), HasSubstr("best achievable is 3"));
+  EXPECT_EQ(results[1].proc, fast_proc);
+  EXPECT_TRUE(results[1].feasible());
+
+  // The check must not leave scheduling attributes behind in the IR.
+  EXPECT_EQ(slow_proc->GetInitiationInterval(), std::nullopt);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      results, CheckInitIntervalFeasibility(p.get(), {{slow_proc, 1}},
+                                            delay_estimator,
+                                            /*clock_period_ps=*/1,
+                                            /*max_init_interval=*/2));
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_EQ(results[0].achievable_init_interval, std::nullopt);
+}
+
+}  // namespace
+}  // namespace xlscc
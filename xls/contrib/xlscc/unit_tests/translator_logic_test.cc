@@ -3238,6 +3238,28 @@ TEST_F(TranslatorLogicTest, TemplateFunctionBool) {
   Run({{"a", 3}}, 15, absl::StrFormat(content, "false"));
 }
 
+TEST_F(TranslatorLogicTest, TemplateInstantiationsShareFunction) {
+  const std::string content = R"(
+      template<int N>
+      int triple(int a) {
+        return a*3;
+      }
+      int my_package(int a) {
+        return triple<1>(a) + triple<2>(a);
+      })";
+  Run({{"a", 3}}, 18, content);
+
+  // Both instantiations translate to the same IR, so only one is kept.
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir_src, SourceToIr(content));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<xls::Package> package,
+                           ParsePackage(ir_src));
+  int64_t triple_count = 0;
+  for (const std::unique_ptr<xls::Function>& f : package->functions()) {
+    triple_count += absl::StrContains(f->name(), "triple") ? 1 : 0;
+  }
+  EXPECT_EQ(triple_count, 1);
+}
+
 TEST_F(TranslatorLogicTest, FunctionDeclOrder) {
   const std::string content = R"(
       int do_something(int a);
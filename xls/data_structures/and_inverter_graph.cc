@@ -0,0 +1,141 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/and_inverter_graph.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
+
+namespace xls {
+
+AndInverterGraph::AndInverterGraph() {
+  // Node zero is the constant false.
+  nodes_.push_back(AigNode{False(), False()});
+}
+
+AigLiteral AndInverterGraph::AddInput(std::string_view name) {
+  int64_t node = nodes_.size();
+  nodes_.push_back(AigNode{False(), False()});
+  inputs_.push_back(node);
+  input_names_.push_back(std::string(name));
+  return AigLiteral::FromNode(node);
+}
+
+void AndInverterGraph::AddOutput(AigLiteral literal, std::string_view name) {
+  outputs_.push_back(literal);
+  output_names_.push_back(std::string(name));
+}
+
+AigLiteral AndInverterGraph::And(AigLiteral a, AigLiteral b) {
+  if (a == False() || b == False() || a == !b) {
+    return False();
+  }
+  if (a == True() || a == b) {
+    return b;
+  }
+  if (b == True()) {
+    return a;
+  }
+  if (b < a) {
+    std::swap(a, b);
+  }
+  uint64_t key = (uint64_t{a.value()} << 32) | b.value();
+  auto [it, inserted] = strash_.try_emplace(key, nodes_.size());
+  if (inserted) {
+    nodes_.push_back(AigNode{a, b});
+  }
+  return AigLiteral::FromNode(it->second);
+}
+
+AigLiteral AndInverterGraph::Xor(AigLiteral a, AigLiteral b) {
+  return Or(And(a, !b), And(!a, b));
+}
+
+AigLiteral AndInverterGraph::Mux(AigLiteral selector, AigLiteral on_true,
+                                 AigLiteral on_false) {
+  return Or(And(selector, on_true), And(!selector, on_false));
+}
+
+std::vector<int64_t> AndInverterGraph::FanoutCounts() const {
+  std::vector<int64_t> counts(nodes_.size(), 0);
+  for (int64_t node = 0; node < nodes_.size(); ++node) {
+    if (IsAnd(node)) {
+      ++counts[nodes_[node].fanin0.node()];
+      ++counts[nodes_[node].fanin1.node()];
+    }
+  }
+  for (AigLiteral output : outputs_) {
+    ++counts[output.node()];
+  }
+  return counts;
+}
+
+std::vector<int64_t> AndInverterGraph::FanoutFreeCone(
+    int64_t root, absl::Span<const int64_t> fanout_counts) const {
+  XLS_CHECK_EQ(fanout_counts.size(), nodes_.size());
+  if (!IsAnd(root)) {
+    return {};
+  }
+  // A fanin joins the cone once all of its fanouts have joined.
+  std::vector<int64_t> cone = {root};
+  absl::flat_hash_map<int64_t, int64_t> remaining_fanouts;
+  for (int64_t i = 0; i < cone.size(); ++i) {
+    const AigNode& node = nodes_[cone[i]];
+    for (AigLiteral fanin : {node.fanin0, node.fanin1}) {
+      if (!IsAnd(fanin.node())) {
+        continue;
+      }
+      auto [it, inserted] = remaining_fanouts.try_emplace(
+          fanin.node(), fanout_counts[fanin.node()]);
+      if (--it->second == 0) {
+        cone.push_back(fanin.node());
+      }
+    }
+  }
+  return cone;
+}
+
+std::vector<uint64_t> AndInverterGraph::Simulate(
+    absl::Span<const uint64_t> input_values) const {
+  XLS_CHECK_EQ(input_values.size(), inputs_.size());
+  std::vector<uint64_t> values(nodes_.size(), 0);
+  for (int64_t i = 0; i < inputs_.size(); ++i) {
+    values[inputs_[i]] = input_values[i];
+  }
+  auto value_of = [&](AigLiteral literal) {
+    uint64_t value = values[literal.node()];
+    return literal.complemented() ? ~value : value;
+  };
+  for (int64_t node = 0; node < nodes_.size(); ++node) {
+    if (IsAnd(node)) {
+      values[node] =
+          value_of(nodes_[node].fanin0) & value_of(nodes_[node].fanin1);
+    }
+  }
+  std::vector<uint64_t> output_values;
+  output_values.reserve(outputs_.size());
+  for (AigLiteral output : outputs_) {
+    output_values.push_back(value_of(output));
+  }
+  return output_values;
+}
+
+}  // namespace xls
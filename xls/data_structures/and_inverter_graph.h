@@ -0,0 +1,145 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DATA_STRUCTURES_AND_INVERTER_GRAPH_H_
+#define XLS_DATA_STRUCTURES_AND_INVERTER_GRAPH_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+
+namespace xls {
+
+// A possibly-complemented reference to a node of an AndInverterGraph, encoded
+// in 32 bits as (node index << 1) | complement bit. Node zero is the constant
+// false so literal 0 is false and literal 1 is true.
+class AigLiteral {
+ public:
+  constexpr AigLiteral() : value_(0) {}
+
+  static constexpr AigLiteral FromNode(int64_t node,
+                                       bool complemented = false) {
+    return AigLiteral(static_cast<uint32_t>(node << 1) |
+                      (complemented ? 1 : 0));
+  }
+
+  int64_t node() const { return value_ >> 1; }
+  bool complemented() const { return (value_ & 1) != 0; }
+  uint32_t value() const { return value_; }
+
+  AigLiteral operator!() const { return AigLiteral(value_ ^ 1); }
+
+  bool operator==(AigLiteral other) const { return value_ == other.value_; }
+  bool operator!=(AigLiteral other) const { return value_ != other.value_; }
+  bool operator<(AigLiteral other) const { return value_ < other.value_; }
+
+  template <typename H>
+  friend H AbslHashValue(H h, AigLiteral literal) {
+    return H::combine(std::move(h), literal.value_);
+  }
+
+ private:
+  explicit constexpr AigLiteral(uint32_t value) : value_(value) {}
+
+  uint32_t value_;
+};
+
+// A node of an AndInverterGraph: the conjunction of its two fanins. Inputs and
+// the constant node have both fanins set to literal 0 which never occurs for an
+// and node since such an and is folded to false.
+struct AigNode {
+  AigLiteral fanin0;
+  AigLiteral fanin1;
+};
+
+// A compact bit-level representation of combinational logic as a graph of
+// two-input and gates with optionally complemented edges. Each node takes eight
+// bytes. Gates are structurally hashed on construction: the fanins of a gate
+// are ordered, gates with constant, identical or complementary fanins are
+// folded, and a gate with the same fanins as an existing gate is the existing
+// gate.
+// Nodes are created after their fanins so node index order is a topological
+// order.
+class AndInverterGraph {
+ public:
+  AndInverterGraph();
+
+  static AigLiteral False() { return AigLiteral::FromNode(0); }
+  static AigLiteral True() { return !False(); }
+
+  // Adds a primary input and returns its (uncomplemented) literal.
+  AigLiteral AddInput(std::string_view name = "");
+
+  // Adds a primary output driven by `literal`.
+  void AddOutput(AigLiteral literal, std::string_view name = "");
+
+  static AigLiteral Not(AigLiteral a) { return !a; }
+  AigLiteral And(AigLiteral a, AigLiteral b);
+  AigLiteral Or(AigLiteral a, AigLiteral b) { return !And(!a, !b); }
+  AigLiteral Xor(AigLiteral a, AigLiteral b);
+  AigLiteral Mux(AigLiteral selector, AigLiteral on_true, AigLiteral on_false);
+
+  const AigNode& GetNode(int64_t node) const { return nodes_.at(node); }
+  bool IsAnd(int64_t node) const {
+    return nodes_[node].fanin0 != nodes_[node].fanin1;
+  }
+  bool IsInput(int64_t node) const { return node != 0 && !IsAnd(node); }
+
+  // Returns the number of nodes including the constant node and inputs.
+  int64_t node_count() const { return nodes_.size(); }
+  int64_t and_count() const { return nodes_.size() - inputs_.size() - 1; }
+
+  // Returns the node indices of the inputs ordered by creation.
+  absl::Span<const int64_t> inputs() const { return inputs_; }
+  absl::Span<const std::string> input_names() const { return input_names_; }
+  absl::Span<const AigLiteral> outputs() const { return outputs_; }
+  absl::Span<const std::string> output_names() const { return output_names_; }
+
+  // Returns the number of references to each node from and gates or outputs,
+  // indexed by node.
+  std::vector<int64_t> FanoutCounts() const;
+
+  // Returns the maximum fanout-free cone of the and node `root`: the nodes
+  // (including `root`) all of whose fanouts lie in the cone, i.e., the logic
+  // which would become dead if `root` were removed. `fanout_counts` is the
+  // result of FanoutCounts(). The root is the first element. Returns an empty
+  // vector if `root` is not an and node.
+  std::vector<int64_t> FanoutFreeCone(
+      int64_t root, absl::Span<const int64_t> fanout_counts) const;
+
+  // Simulates 64 input patterns in parallel. Bit `j` of `input_values[i]` is
+  // the value of the i-th input in pattern `j`. Returns the values of the
+  // outputs in the same form.
+  std::vector<uint64_t> Simulate(absl::Span<const uint64_t> input_values) const;
+
+ private:
+  std::vector<AigNode> nodes_;
+
+  // Maps the ordered fanin pair of each and gate to its node index.
+  absl::flat_hash_map<uint64_t, int64_t> strash_;
+
+  std::vector<int64_t> inputs_;
+  std::vector<std::string> input_names_;
+  std::vector<AigLiteral> outputs_;
+  std::vector<std::string> output_names_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_DATA_STRUCTURES_AND_INVERTER_GRAPH_H_
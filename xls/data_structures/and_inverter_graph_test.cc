@@ -0,0 +1,87 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/and_inverter_graph.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::UnorderedElementsAre;
+
+TEST(AndInverterGraphTest, StructuralHashing) {
+  AndInverterGraph aig;
+  AigLiteral a = aig.AddInput("a");
+  AigLiteral b = aig.AddInput("b");
+  AigLiteral a_and_b = aig.And(a, b);
+  EXPECT_EQ(aig.And(b, a), a_and_b);
+  EXPECT_EQ(aig.And(a, a), a);
+  EXPECT_EQ(aig.And(a, !a), AndInverterGraph::False());
+  EXPECT_EQ(aig.And(a, AndInverterGraph::True()), a);
+  EXPECT_EQ(aig.And(AndInverterGraph::False(), b), AndInverterGraph::False());
+  EXPECT_EQ(aig.Or(a, !a), AndInverterGraph::True());
+  EXPECT_EQ(aig.Or(b, a), !aig.And(!a, !b));
+  EXPECT_EQ(aig.and_count(), 2);
+  EXPECT_EQ(aig.node_count(), 5);
+  EXPECT_TRUE(aig.IsInput(a.node()));
+  EXPECT_TRUE(aig.IsAnd(a_and_b.node()));
+  EXPECT_FALSE(aig.IsInput(0));
+}
+
+TEST(AndInverterGraphTest, Simulate) {
+  AndInverterGraph aig;
+  AigLiteral a = aig.AddInput("a");
+  AigLiteral b = aig.AddInput("b");
+  AigLiteral c = aig.AddInput("c");
+  aig.AddOutput(aig.Xor(a, b), "xor");
+  aig.AddOutput(aig.Mux(c, a, b), "mux");
+  aig.AddOutput(AndInverterGraph::True(), "one");
+
+  // Each of the eight patterns assigns bit j of the pattern index to input j.
+  std::vector<uint64_t> outputs = aig.Simulate({0xaa, 0xcc, 0xf0});
+  EXPECT_THAT(outputs,
+              ElementsAre(uint64_t{0x66}, uint64_t{0xac}, ~uint64_t{0}));
+}
+
+TEST(AndInverterGraphTest, FanoutFreeCone) {
+  AndInverterGraph aig;
+  AigLiteral a = aig.AddInput("a");
+  AigLiteral b = aig.AddInput("b");
+  AigLiteral c = aig.AddInput("c");
+  AigLiteral ab = aig.And(a, b);
+  AigLiteral bc = aig.And(b, c);
+  AigLiteral root = aig.And(ab, !bc);
+  aig.AddOutput(root);
+  aig.AddOutput(bc);
+
+  std::vector<int64_t> fanout_counts = aig.FanoutCounts();
+  EXPECT_EQ(fanout_counts[b.node()], 2);
+  EXPECT_EQ(fanout_counts[bc.node()], 2);
+
+  // `bc` also drives an output so it is outside the cone of `root`.
+  EXPECT_THAT(aig.FanoutFreeCone(root.node(), fanout_counts),
+              UnorderedElementsAre(root.node(), ab.node()));
+  EXPECT_THAT(aig.FanoutFreeCone(bc.node(), fanout_counts),
+              ElementsAre(bc.node()));
+  EXPECT_TRUE(aig.FanoutFreeCone(a.node(), fanout_counts).empty());
+}
+
+}  // namespace
+}  // namespace xls
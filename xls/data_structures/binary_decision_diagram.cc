@@ -15,11 +15,15 @@
 #include "xls/data_structures/binary_decision_diagram.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 
+#include "absl/hash/hash.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -30,7 +34,25 @@
 
 namespace xls {
 
-BinaryDecisionDiagram::BinaryDecisionDiagram() {
+namespace {
+
+// The initial number of entries in the computed table.
+constexpr int64_t kInitialComputedTableSize = 1024;
+
+int64_t RoundUpToPowerOfTwo(int64_t n) {
+  int64_t result = 1;
+  while (result < n) {
+    result <<= 1;
+  }
+  return result;
+}
+
+}  // namespace
+
+BinaryDecisionDiagram::BinaryDecisionDiagram(int64_t max_computed_table_size)
+    : max_computed_table_size_(RoundUpToPowerOfTwo(max_computed_table_size)) {
+  computed_table_.resize(
+      std::min(kInitialComputedTableSize, max_computed_table_size_));
   // Leaf node 0.
   nodes_.push_back(BddNode(BddVariable(-1), BddNodeIndex(-1), BddNodeIndex(-1),
                            /*p=*/1));
@@ -39,6 +61,44 @@ BinaryDecisionDiagram::BinaryDecisionDiagram() {
                            /*p=*/1));
 }
 
+BinaryDecisionDiagram::ComputedTableEntry&
+BinaryDecisionDiagram::GetComputedTableEntry(BddNodeIndex cond,
+                                             BddNodeIndex if_true,
+                                             BddNodeIndex if_false) {
+  size_t hash = absl::HashOf(cond.value(), if_true.value(), if_false.value());
+  return computed_table_[hash & (computed_table_.size() - 1)];
+}
+
+int64_t BinaryDecisionDiagram::GetMemoryUsageBytes() const {
+  // Swiss tables store one control byte per slot in addition to the slot.
+  return nodes_.capacity() * sizeof(BddNode) +
+         free_nodes_.capacity() * sizeof(BddNodeIndex) +
+         variable_base_nodes_.capacity() * sizeof(BddNodeIndex) +
+         node_map_.capacity() *
+             (sizeof(decltype(node_map_)::value_type) + 1) +
+         computed_table_.capacity() * sizeof(ComputedTableEntry);
+}
+
+MemoryHighWaterMark& BinaryDecisionDiagram::PeakMemoryUsage() {
+  static MemoryHighWaterMark peak_memory_usage;
+  return peak_memory_usage;
+}
+
+void BinaryDecisionDiagram::MaybeGrowComputedTable() {
+  int64_t table_size = computed_table_.size();
+  if (table_size >= max_computed_table_size_ ||
+      table_size >= static_cast<int64_t>(nodes_.size())) {
+    return;
+  }
+  std::vector<ComputedTableEntry> old_table(2 * table_size);
+  std::swap(old_table, computed_table_);
+  for (const ComputedTableEntry& entry : old_table) {
+    if (entry.cond != BddNodeIndex(-1)) {
+      GetComputedTableEntry(entry.cond, entry.if_true, entry.if_false) = entry;
+    }
+  }
+}
+
 BddNodeIndex BinaryDecisionDiagram::GetOrCreateNode(BddVariable var,
                                                     BddNodeIndex high,
                                                     BddNodeIndex low) {
@@ -55,8 +115,20 @@ BddNodeIndex BinaryDecisionDiagram::GetOrCreateNode(BddVariable var,
   int32_t paths = std::min(
       static_cast<int64_t>(GetNode(low).path_count) + GetNode(high).path_count,
       static_cast<int64_t>(std::numeric_limits<int32_t>::max()));
-  nodes_.emplace_back(var, high, low, paths);
-  BddNodeIndex node_index = BddNodeIndex(nodes_.size() - 1);
+  BddNodeIndex node_index;
+  if (free_nodes_.empty()) {
+    bool reallocates = nodes_.size() == nodes_.capacity();
+    nodes_.emplace_back(var, high, low, paths);
+    node_index = BddNodeIndex(nodes_.size() - 1);
+    MaybeGrowComputedTable();
+    if (reallocates) {
+      PeakMemoryUsage().Record(GetMemoryUsageBytes());
+    }
+  } else {
+    node_index = free_nodes_.back();
+    free_nodes_.pop_back();
+    nodes_[node_index.value()] = BddNode(var, high, low, paths);
+  }
   node_map_[key] = node_index;
   return node_index;
 }
@@ -90,10 +162,13 @@ BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
   if (if_true == if_false) {
     return if_true;
   }
-  auto key = std::make_tuple(cond, if_true, if_false);
-  auto it = ite_map_.find(key);
-  if (it != ite_map_.end()) {
-    return it->second;
+  {
+    const ComputedTableEntry& entry =
+        GetComputedTableEntry(cond, if_true, if_false);
+    if (entry.cond == cond && entry.if_true == if_true &&
+        entry.if_false == if_false) {
+      return entry.result;
+    }
   }
 
   // The expression is non-trivial and has not been computed before. Recursively
@@ -123,19 +198,76 @@ BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
                                            Restrict(if_true, min_var, false),
                                            Restrict(if_false, min_var, false));
 
-  if (true_cofactor == false_cofactor) {
-    ite_map_[key] = true_cofactor;
-    return true_cofactor;
-  }
-  BddNodeIndex expr = GetOrCreateNode(min_var, true_cofactor, false_cofactor);
-  ite_map_[key] = expr;
+  BddNodeIndex expr =
+      true_cofactor == false_cofactor
+          ? true_cofactor
+          : GetOrCreateNode(min_var, true_cofactor, false_cofactor);
+  // Look up the slot again as the recursive calls may have grown the table.
+  GetComputedTableEntry(cond, if_true, if_false) =
+      ComputedTableEntry{cond, if_true, if_false, expr};
   return expr;
 }
 
 BddNodeIndex BinaryDecisionDiagram::NewVariable() {
   BddVariable var = next_var_;
   ++next_var_;
-  return GetOrCreateNode(var, one(), zero());
+  BddNodeIndex base_node = GetOrCreateNode(var, one(), zero());
+  variable_base_nodes_.push_back(base_node);
+  return base_node;
+}
+
+int64_t BinaryDecisionDiagram::GarbageCollect(
+    absl::Span<const BddNodeIndex> roots) {
+  // Mark the nodes reachable from the roots and the variable base nodes. The
+  // leaves are always live.
+  std::vector<bool> live(nodes_.size(), false);
+  live[zero().value()] = true;
+  live[one().value()] = true;
+  std::vector<BddNodeIndex> worklist(roots.begin(), roots.end());
+  worklist.insert(worklist.end(), variable_base_nodes_.begin(),
+                  variable_base_nodes_.end());
+  while (!worklist.empty()) {
+    BddNodeIndex index = worklist.back();
+    worklist.pop_back();
+    if (live[index.value()]) {
+      continue;
+    }
+    live[index.value()] = true;
+    const BddNode& node = GetNode(index);
+    worklist.push_back(node.high);
+    worklist.push_back(node.low);
+  }
+
+  // Free the unmarked nodes which are not already free.
+  std::vector<bool> already_free(nodes_.size(), false);
+  for (BddNodeIndex index : free_nodes_) {
+    already_free[index.value()] = true;
+  }
+  int64_t freed_count = 0;
+  for (int64_t i = 0; i < nodes_.size(); ++i) {
+    if (live[i] || already_free[i]) {
+      continue;
+    }
+    BddNode& node = nodes_[i];
+    node_map_.erase(std::make_tuple(node.variable, node.high, node.low));
+    node = BddNode();
+    free_nodes_.push_back(BddNodeIndex(i));
+    ++freed_count;
+  }
+
+  // Drop computed table entries which refer to freed nodes.
+  if (freed_count > 0) {
+    for (ComputedTableEntry& entry : computed_table_) {
+      if (entry.cond != BddNodeIndex(-1) &&
+          (!live[entry.cond.value()] || !live[entry.if_true.value()] ||
+           !live[entry.if_false.value()] || !live[entry.result.value()])) {
+        entry = ComputedTableEntry();
+      }
+    }
+  }
+  XLS_VLOG(3) << absl::StreamFormat("BDD garbage collection freed %d nodes",
+                                    freed_count);
+  return freed_count;
 }
 
 BddNodeIndex BinaryDecisionDiagram::Not(BddNodeIndex expr) {
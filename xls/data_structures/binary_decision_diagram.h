@@ -22,6 +22,8 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/memory_usage.h"
 #include "xls/common/strong_int.h"
 
 namespace xls {
@@ -35,8 +37,8 @@ namespace xls {
 //   "Efficient Implementation of a BDD package"
 //   https://ieeexplore.ieee.org/document/114826
 
-// For efficiency variables and nodes are referred to by indices into vector
-// data members in the BDD.
+// For efficiency variables and nodes are referred to by 32-bit indices into
+// vector data members in the BDD.
 XLS_DEFINE_STRONG_INT_TYPE(BddVariable, int32_t);
 XLS_DEFINE_STRONG_INT_TYPE(BddNodeIndex, int32_t);
 
@@ -60,9 +62,16 @@ struct BddNode {
 
 class BinaryDecisionDiagram {
  public:
+  // The default maximum number of entries in the computed table which caches
+  // the results of if-then-else operations.
+  static constexpr int64_t kDefaultMaxComputedTableSize = int64_t{1} << 20;
+
   // Creates an empty BDD. Initialize the BDD contains only the nodes
-  // corresponding to zero and one.
-  BinaryDecisionDiagram();
+  // corresponding to zero and one. The computed table grows with the number of
+  // nodes up to `max_computed_table_size` entries (rounded up to a power of
+  // two) after which results are evicted on collision.
+  explicit BinaryDecisionDiagram(
+      int64_t max_computed_table_size = kDefaultMaxComputedTableSize);
 
   // Adds a new variable to the BDD and returns the node corresponding the
   // variable's value.
@@ -92,8 +101,28 @@ class BinaryDecisionDiagram {
     return nodes_.at(node_index.value());
   }
 
-  // Returns the number of nodes in the graph.
-  int64_t size() const { return nodes_.size(); }
+  // Returns the number of (live) nodes in the graph.
+  int64_t size() const { return nodes_.size() - free_nodes_.size(); }
+
+  // Returns the approximate number of bytes allocated for the node and cache
+  // tables of the BDD.
+  int64_t GetMemoryUsageBytes() const;
+
+  // The high-water mark of GetMemoryUsageBytes() of any BDD in the process.
+  // Recorded as the tables grow.
+  static MemoryHighWaterMark& PeakMemoryUsage();
+
+  // Returns one more than the largest node index in use. Indices below this
+  // value which are not live (see GarbageCollect) refer to free nodes with a
+  // path count of zero.
+  int64_t node_index_limit() const { return nodes_.size(); }
+
+  // Frees the nodes which are not reachable from `roots` (or from the base
+  // nodes of the variables which are always retained). The indices of the
+  // retained nodes are unchanged and freed indices are reused by subsequently
+  // created nodes so an index not reachable from `roots` is invalid after the
+  // call. Returns the number of nodes freed.
+  int64_t GarbageCollect(absl::Span<const BddNodeIndex> roots);
 
   // Returns the number of variables in the graph.
   int64_t variable_count() const { return next_var_.value(); }
@@ -136,27 +165,52 @@ class BinaryDecisionDiagram {
 
   // Returns the node corresponding to the value of the given variable.
   BddNodeIndex GetVariableBaseNode(BddVariable variable) const {
-    return node_map_.at({variable, one(), zero()});
+    return variable_base_nodes_.at(variable.value());
   }
 
+  // An entry in the computed table. Empty entries have a `cond` of -1.
+  struct ComputedTableEntry {
+    BddNodeIndex cond = BddNodeIndex(-1);
+    BddNodeIndex if_true = BddNodeIndex(-1);
+    BddNodeIndex if_false = BddNodeIndex(-1);
+    BddNodeIndex result = BddNodeIndex(-1);
+  };
+
+  // Returns the slot of the computed table for the given if-then-else
+  // expression.
+  ComputedTableEntry& GetComputedTableEntry(BddNodeIndex cond,
+                                            BddNodeIndex if_true,
+                                            BddNodeIndex if_false);
+
+  // Doubles the size of the computed table if it is smaller than both the
+  // number of nodes and the maximum size.
+  void MaybeGrowComputedTable();
+
   // The numeric id to use for the next created variable. Increments with each
   // call to NewVariable which
   BddVariable next_var_ = BddVariable(0);
 
-  // The vector of all the nodes in the BDD.
+  // The vector of all the nodes in the BDD including free nodes.
   std::vector<BddNode> nodes_;
 
+  // Indices of the free nodes in `nodes_` available for reuse.
+  std::vector<BddNodeIndex> free_nodes_;
+
+  // The base node of each variable indexed by variable.
+  std::vector<BddNodeIndex> variable_base_nodes_;
+
   // A map from BDD node content (variable id, high child, low child) to the
   // index of the respective node. This map is used to ensure that no duplicate
   // nodes are created.
   using NodeKey = std::tuple<BddVariable, BddNodeIndex, BddNodeIndex>;
   absl::flat_hash_map<NodeKey, BddNodeIndex> node_map_;
 
-  // A map from if-then-else expression to the node corresponding to that
-  // expression. The key elements are (condition, if-true, if-false). This map
-  // enables fast lookup for expressions.
-  using IteKey = std::tuple<BddNodeIndex, BddNodeIndex, BddNodeIndex>;
-  absl::flat_hash_map<IteKey, BddNodeIndex> ite_map_;
+  // A lossy direct-mapped cache from if-then-else expression (condition,
+  // if-true, if-false) to the node corresponding to that expression. Unlike a
+  // map the memory used is bounded: colliding expressions overwrite each other
+  // and are recomputed if needed again. The size is a power of two.
+  std::vector<ComputedTableEntry> computed_table_;
+  int64_t max_computed_table_size_;
 };
 
 }  // namespace xls
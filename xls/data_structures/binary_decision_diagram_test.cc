@@ -88,6 +88,48 @@ TEST(BinaryDecisionDiagramTest, BddSize) {
   }
 }
 
+TEST(BinaryDecisionDiagramTest, GarbageCollect) {
+  BinaryDecisionDiagram bdd;
+  BddNodeIndex x0 = bdd.NewVariable();
+  BddNodeIndex x1 = bdd.NewVariable();
+  BddNodeIndex x2 = bdd.NewVariable();
+  BddNodeIndex kept = bdd.And(x0, x1);
+  bdd.Or(bdd.And(x1, x2), x0);
+  int64_t size_before_gc = bdd.size();
+
+  // The variables and 'kept' survive and the rest is freed.
+  EXPECT_GT(bdd.GarbageCollect({kept}), 0);
+  EXPECT_LT(bdd.size(), size_before_gc);
+  EXPECT_EQ(bdd.ToStringDnf(kept), "x0.x1");
+  EXPECT_THAT(bdd.Evaluate(kept, {{x0, true}, {x1, true}}),
+              IsOkAndHolds(true));
+  EXPECT_EQ(bdd.GarbageCollect({kept}), 0);
+
+  // Freed nodes are reused and recomputed expressions are canonical.
+  BddNodeIndex recomputed = bdd.Or(bdd.And(x1, x2), x0);
+  EXPECT_EQ(bdd.size(), size_before_gc);
+  EXPECT_EQ(bdd.Or(x0, bdd.And(x2, x1)), recomputed);
+  EXPECT_EQ(bdd.And(x1, x0), kept);
+}
+
+TEST(BinaryDecisionDiagramTest, SmallComputedTable) {
+  // A tiny computed table evicts results but must not affect canonicity.
+  BinaryDecisionDiagram bdd(/*max_computed_table_size=*/1);
+  std::vector<BddNodeIndex> vars;
+  for (int64_t i = 0; i < 8; ++i) {
+    vars.push_back(bdd.NewVariable());
+  }
+  BddNodeIndex a = bdd.zero();
+  for (BddNodeIndex var : vars) {
+    a = bdd.Or(a, var);
+  }
+  BddNodeIndex b = bdd.zero();
+  for (auto it = vars.rbegin(); it != vars.rend(); ++it) {
+    b = bdd.Or(*it, b);
+  }
+  EXPECT_EQ(a, b);
+}
+
 TEST(BinaryDecisionDiagramTest, ToString) {
   BinaryDecisionDiagram bdd;
   BddNodeIndex x0 = bdd.NewVariable();
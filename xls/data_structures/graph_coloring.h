@@ -15,6 +15,9 @@
 #ifndef XLS_DATA_STRUCTURES_GRAPH_COLORING_H_
 #define XLS_DATA_STRUCTURES_GRAPH_COLORING_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -24,9 +27,11 @@
 #include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/numeric/bits.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/logging/log_message.h"
 #include "xls/common/logging/logging.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "../z3/src/api/c++/z3++.h"
 
 namespace xls {
@@ -128,28 +133,128 @@ absl::flat_hash_set<V> FindMaximalIndependentSet(
 //
 // This algorithm is explained on page 60 of "Guide to Graph Colouring" second
 // edition by R. M. R. Lewis. https://doi.org/10.1007%2F978-3-030-81054-2
+namespace graph_coloring_internal {
+
+// Returns the number of bits set in both `a` and `b`.
+inline int64_t IntersectionPopCount(const InlineBitmap& a,
+                                    const InlineBitmap& b) {
+  int64_t count = 0;
+  for (int64_t i = 0; i < a.word_count(); ++i) {
+    count += absl::popcount(a.GetWord(i) & b.GetWord(i));
+  }
+  return count;
+}
+
+// Calls `f` with the index of each set bit of `bitmap` in increasing order.
+template <typename F>
+void ForEachSetBit(const InlineBitmap& bitmap, F f) {
+  for (int64_t i = 0; i < bitmap.word_count(); ++i) {
+    for (uint64_t word = bitmap.GetWord(i); word != 0; word &= word - 1) {
+      f(i * 64 + absl::countr_zero(word));
+    }
+  }
+}
+
+}  // namespace graph_coloring_internal
+
+// Color the given graph using the Recursive Largest First (RLF) algorithm.
+//
+// `vertices` is the set of vertices of the graph.
+// `neighborhood` is a function that, given a vertex in the graph, returns a set
+// containing its neighbors. This is agnostic to graph representation.
+//
+// This returns a vector of sets of nodes, each of which represents a color
+// in the colored graph.
+//
+// The result is the same as repeatedly applying FindMaximalIndependentSet to
+// the uncolored vertices, but `neighborhood` is called only once per vertex and
+// the graph is held as one adjacency bitmap per vertex so that each step of
+// the search is a few word-parallel operations.
+//
+// This algorithm is explained on page 60 of "Guide to Graph Colouring" second
+// edition by R. M. R. Lewis. https://doi.org/10.1007%2F978-3-030-81054-2
 template <typename V>
 std::vector<absl::flat_hash_set<V>> RecursiveLargestFirstColoring(
     const absl::flat_hash_set<V>& vertices,
     std::function<absl::flat_hash_set<V>(const V&)> neighborhood) {
+  using graph_coloring_internal::ForEachSetBit;
+  using graph_coloring_internal::IntersectionPopCount;
+
+  // Number the vertices in sorted order, which is the order in which
+  // FindMaximalIndependentSet breaks ties.
+  std::vector<V> by_index(vertices.begin(), vertices.end());
+  std::sort(by_index.begin(), by_index.end());
+  const int64_t n = by_index.size();
+  absl::flat_hash_map<V, int64_t> index_of;
+  for (int64_t i = 0; i < n; ++i) {
+    index_of[by_index[i]] = i;
+  }
+  std::vector<InlineBitmap> adjacency(n, InlineBitmap(n));
+  for (int64_t i = 0; i < n; ++i) {
+    for (const V& neighbor : neighborhood(by_index[i])) {
+      auto it = index_of.find(neighbor);
+      if (it != index_of.end()) {
+        adjacency[i].Set(it->second);
+      }
+    }
+  }
+
   std::vector<absl::flat_hash_set<V>> result;
-  absl::flat_hash_set<V> available = vertices;
-  while (!available.empty()) {
+  InlineBitmap available(n, /*fill=*/true);
+  while (!available.IsAllZeroes()) {
     // Find the maximal independent set in the subgraph induced by `available`.
-    absl::flat_hash_set<V> chosen = FindMaximalIndependentSet<V>(
-        available, [&](const V& v) -> absl::flat_hash_set<V> {
-          absl::flat_hash_set<V> result;
-          for (const V& neighbor : neighborhood(v)) {
-            if (available.contains(neighbor)) {
-              result.insert(neighbor);
-            }
-          }
-          return result;
-        });
+    // See FindMaximalIndependentSet for the names.
+    absl::flat_hash_set<V> chosen;  // named S in the book
+    InlineBitmap unchosen = available;  // named X
+    InlineBitmap neighboring_chosen(n);  // named Y
+    auto choose = [&](int64_t v) {
+      chosen.insert(by_index[v]);
+      InlineBitmap neighbors = adjacency[v];
+      neighbors.Intersect(available);
+      neighboring_chosen.Union(neighbors);
+      unchosen.Set(v, false);
+    };
+
+    // Start with the vertex with highest degree.
+    {
+      int64_t largest_neighborhood = 0;
+      int64_t vertex_with_most_neighbors = -1;
+      ForEachSetBit(unchosen, [&](int64_t v) {
+        int64_t neighborhood_size =
+            IntersectionPopCount(adjacency[v], available);
+        if (neighborhood_size >= largest_neighborhood) {
+          largest_neighborhood = neighborhood_size;
+          vertex_with_most_neighbors = v;
+        }
+      });
+      choose(vertex_with_most_neighbors);
+    }
+
+    while (!unchosen.IsAllZeroes()) {
+      std::pair<int64_t, int64_t> measure = {-1, -1};
+      int64_t best = -1;
+      ForEachSetBit(unchosen, [&](int64_t v) {
+        if (neighboring_chosen.Get(v)) {
+          return;
+        }
+        std::pair<int64_t, int64_t> vertex_measure{
+            IntersectionPopCount(adjacency[v], neighboring_chosen),
+            -IntersectionPopCount(adjacency[v], unchosen)};
+        if (vertex_measure > measure) {
+          best = v;
+          measure = vertex_measure;
+        }
+      });
+      if (best < 0) {
+        break;
+      }
+      choose(best);
+    }
+
     for (const V& vertex : chosen) {
-      available.erase(vertex);
+      available.Set(index_of.at(vertex), false);
     }
-    result.push_back(chosen);
+    result.push_back(std::move(chosen));
   }
   return result;
 }
@@ -14,6 +14,8 @@
 
 #include "xls/data_structures/graph_coloring.h"
 
+#include <cstdint>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -144,5 +146,48 @@ TEST(GraphColoringTest, Wheel) {
   EXPECT_TRUE(IsValidColoring(graph, Z3FromMap(graph)));
 }
 
+TEST(GraphColoringTest, MatchesIndependentSetColoring) {
+  std::mt19937_64 gen;
+  std::bernoulli_distribution coin(0.3);
+  absl::flat_hash_set<int64_t> vertices;
+  absl::flat_hash_map<int64_t, absl::flat_hash_set<int64_t>> graph;
+  for (int64_t i = 0; i < 150; ++i) {
+    vertices.insert(i);
+    for (int64_t j = 0; j < i; ++j) {
+      if (coin(gen)) {
+        graph[i].insert(j);
+        graph[j].insert(i);
+      }
+    }
+  }
+  auto neighborhood = [&](int64_t v) -> absl::flat_hash_set<int64_t> {
+    auto it = graph.find(v);
+    return it == graph.end() ? absl::flat_hash_set<int64_t>() : it->second;
+  };
+
+  // Color by repeatedly removing maximal independent sets.
+  std::vector<absl::flat_hash_set<int64_t>> expected;
+  absl::flat_hash_set<int64_t> available = vertices;
+  while (!available.empty()) {
+    absl::flat_hash_set<int64_t> chosen = FindMaximalIndependentSet<int64_t>(
+        available, [&](int64_t v) -> absl::flat_hash_set<int64_t> {
+          absl::flat_hash_set<int64_t> result;
+          for (int64_t neighbor : neighborhood(v)) {
+            if (available.contains(neighbor)) {
+              result.insert(neighbor);
+            }
+          }
+          return result;
+        });
+    for (int64_t v : chosen) {
+      available.erase(v);
+    }
+    expected.push_back(chosen);
+  }
+
+  EXPECT_EQ(RecursiveLargestFirstColoring<int64_t>(vertices, neighborhood),
+            expected);
+}
+
 }  // namespace
 }  // namespace xls
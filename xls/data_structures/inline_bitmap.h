@@ -22,6 +22,7 @@
 
 #include "absl/base/casts.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/numeric/bits.h"
 #include "absl/types/span.h"
 #include "xls/common/bits_util.h"
 #include "xls/common/endian.h"
@@ -31,9 +32,14 @@
 
 namespace xls {
 
-// A bitmap that has 64-bits of inline storage by default.
+// A bitmap that has 128-bits of inline storage by default.
 class InlineBitmap {
  public:
+  // Number of 64-bit words stored inline without a heap allocation. Two words
+  // fit in the space the heap pointer and capacity of the allocated
+  // representation require, so this costs nothing over a single inline word.
+  static constexpr int64_t kInlineWordCount = 2;
+
   // Constructs an InlineBitmap of width `bit_count` using the bits in
   // `word`. If `bit_count` is greater than 64, then all high bits are set to
   // `fill`.
@@ -106,12 +112,10 @@ class InlineBitmap {
     if (bit_count_ != other.bit_count_) {
       return false;
     }
-    for (int64_t wordno = 0; wordno < word_count(); ++wordno) {
-      if (data_[wordno] != other.data_[wordno]) {
-        return false;
-      }
-    }
-    return true;
+    // Bits past the end of the bitmap are always zero so the words can be
+    // compared wholesale.
+    return std::memcmp(data_.data(), other.data_.data(),
+                       word_count() * kWordBytes) == 0;
   }
   bool operator!=(const InlineBitmap& other) const { return !(*this == other); }
 
@@ -160,6 +164,32 @@ class InlineBitmap {
       Set(index, value);
     }
   }
+  // Overwrites the bits in the range [offset, offset + other.bit_count()) with
+  // the bits of `other`. Bit 0 of `other` is written to bit `offset`. The range
+  // must lie within this bitmap.
+  void Overwrite(const InlineBitmap& other, int64_t offset) {
+    XLS_DCHECK_GE(offset, 0);
+    XLS_DCHECK_LE(offset + other.bit_count(), bit_count());
+    int64_t first_wordno = offset / kWordBits;
+    int64_t bit_offset = offset % kWordBits;
+    int64_t remaining = other.bit_count();
+    for (int64_t i = 0; i < other.word_count(); ++i) {
+      // Bits above `width` in `word` are guaranteed to be zero by masking.
+      uint64_t word = other.data_[i];
+      int64_t width = std::min(remaining, kWordBits);
+      uint64_t mask = Mask(width);
+      uint64_t& low = data_[first_wordno + i];
+      low = (low & ~(mask << bit_offset)) | (word << bit_offset);
+      if (bit_offset + width > kWordBits) {
+        // The word straddles a word boundary of this bitmap.
+        int64_t shift = kWordBits - bit_offset;
+        uint64_t& high = data_[first_wordno + i + 1];
+        high = (high & ~(mask >> shift)) | (word >> shift);
+      }
+      remaining -= width;
+    }
+  }
+
   // Sets all the values of the bitmap to false.
   inline void SetAllBitsToFalse() {
     std::fill(data_.begin(), data_.end(), 0ULL);
@@ -261,6 +291,41 @@ class InlineBitmap {
     }
   }
 
+  // Sets this bitmap to the intersection of this bitmap and `other`.
+  void Intersect(const InlineBitmap& other) {
+    XLS_CHECK_EQ(bit_count(), other.bit_count());
+    for (int64_t i = 0; i < data_.size(); ++i) {
+      data_[i] &= other.data_[i];
+    }
+  }
+
+  // Clears the bits of this bitmap which are set in `other`.
+  void Subtract(const InlineBitmap& other) {
+    XLS_CHECK_EQ(bit_count(), other.bit_count());
+    for (int64_t i = 0; i < data_.size(); ++i) {
+      data_[i] &= ~other.data_[i];
+    }
+  }
+
+  // Returns the number of set bits.
+  int64_t PopCount() const {
+    int64_t count = 0;
+    for (uint64_t word : data_) {
+      count += absl::popcount(word);
+    }
+    return count;
+  }
+
+  // Returns the index of the lowest set bit, or bit_count() if no bit is set.
+  int64_t FindFirstSetBit() const {
+    for (int64_t i = 0; i < data_.size(); ++i) {
+      if (data_[i] != 0) {
+        return i * kWordBits + absl::countr_zero(data_[i]);
+      }
+    }
+    return bit_count();
+  }
+
   int64_t byte_count() const { return CeilOfRatio(bit_count_, int64_t{8}); }
   int64_t word_count() const { return data_.size(); }
 
@@ -292,7 +357,7 @@ class InlineBitmap {
   }
 
   int64_t bit_count_;
-  absl::InlinedVector<uint64_t, 1> data_;
+  absl::InlinedVector<uint64_t, kInlineWordCount> data_;
 };
 
 }  // namespace xls
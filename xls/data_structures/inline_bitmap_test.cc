@@ -14,12 +14,16 @@
 
 #include "xls/data_structures/inline_bitmap.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <ios>
 #include <limits>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/str_format.h"
 
 namespace xls {
 namespace {
@@ -415,6 +419,65 @@ TEST(InlineBitmapTest, Union) {
   }
 }
 
+TEST(InlineBitmapTest, SetOperations) {
+  InlineBitmap b = InlineBitmap::FromWord(0b01101100, 8);
+  b.Intersect(InlineBitmap::FromWord(0b11001010, 8));
+  EXPECT_EQ(b.GetWord(0), 0b01001000);
+  b.Subtract(InlineBitmap::FromWord(0b00001001, 8));
+  EXPECT_EQ(b.GetWord(0), 0b01000000);
+  EXPECT_EQ(b.PopCount(), 1);
+  EXPECT_EQ(b.FindFirstSetBit(), 6);
+  b.Subtract(b);
+  EXPECT_TRUE(b.IsAllZeroes());
+  EXPECT_EQ(b.FindFirstSetBit(), 8);
+
+  InlineBitmap wide(130, /*fill=*/true);
+  EXPECT_EQ(wide.PopCount(), 130);
+  InlineBitmap high(130);
+  high.Set(129);
+  high.Set(70);
+  wide.Intersect(high);
+  EXPECT_EQ(wide.PopCount(), 2);
+  EXPECT_EQ(wide.FindFirstSetBit(), 70);
+  EXPECT_EQ(InlineBitmap(0).FindFirstSetBit(), 0);
+  EXPECT_EQ(InlineBitmap(0).PopCount(), 0);
+}
+
+TEST(InlineBitmapTest, Overwrite) {
+  // Reference implementation which overwrites bit-by-bit.
+  auto overwrite_slow = [](InlineBitmap& dst, const InlineBitmap& src,
+                           int64_t offset) {
+    for (int64_t i = 0; i < src.bit_count(); ++i) {
+      dst.Set(offset + i, src.Get(i));
+    }
+  };
+  for (int64_t dst_width : {1, 7, 64, 65, 128, 200}) {
+    for (int64_t src_width = 0; src_width <= dst_width; ++src_width) {
+      for (int64_t offset = 0; offset + src_width <= dst_width;
+           offset += std::max<int64_t>(1, src_width / 3)) {
+        for (bool fill : {false, true}) {
+          InlineBitmap src = InlineBitmap::FromWord(0x5a5a'1234'fedc'a987ULL,
+                                                    src_width, /*fill=*/fill);
+          InlineBitmap expected(dst_width, /*fill=*/!fill);
+          InlineBitmap actual(dst_width, /*fill=*/!fill);
+          overwrite_slow(expected, src, offset);
+          actual.Overwrite(src, offset);
+          EXPECT_EQ(actual, expected) << absl::StreamFormat(
+              "dst_width=%d src_width=%d offset=%d fill=%d", dst_width,
+              src_width, offset, fill);
+        }
+      }
+    }
+  }
+}
+
+TEST(InlineBitmapTest, InlineStorageIsFree) {
+  // Growing the inline storage must not grow the object.
+  using InlineStorage =
+      absl::InlinedVector<uint64_t, InlineBitmap::kInlineWordCount>;
+  EXPECT_EQ(sizeof(InlineStorage), sizeof(absl::InlinedVector<uint64_t, 1>));
+}
+
 }  // namespace
 
 // Note: tests below this point are friended, so cannot live in the anonymous
@@ -0,0 +1,148 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DATA_STRUCTURES_INLINED_SORTED_SET_H_
+#define XLS_DATA_STRUCTURES_INLINED_SORTED_SET_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+
+#include "absl/container/inlined_vector.h"
+
+namespace xls {
+
+// A set of unique elements stored as a vector sorted by `Compare` with inline
+// storage for `kInlineSize` elements. Compared to a btree_set, small sets need
+// no heap allocation, membership tests are binary searches over contiguous
+// memory and iteration is a linear scan, in `Compare` order.
+//
+// Inserting or erasing an element is linear in the size of the set, except
+// that inserting an element greater than all present elements and erasing the
+// greatest element are constant time. Inserting a sorted range merges it in a
+// single pass. Any insertion or removal invalidates iterators.
+template <typename T, typename Compare = std::less<T>, size_t kInlineSize = 2>
+class InlinedSortedSet {
+  using Storage = absl::InlinedVector<T, kInlineSize>;
+
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using reference = const T&;
+  using const_reference = const T&;
+  using iterator = typename Storage::const_iterator;
+  using const_iterator = typename Storage::const_iterator;
+
+  InlinedSortedSet() = default;
+
+  template <typename InputIt>
+  InlinedSortedSet(InputIt first, InputIt last) {
+    insert(first, last);
+  }
+
+  InlinedSortedSet(std::initializer_list<T> init)
+      : InlinedSortedSet(init.begin(), init.end()) {}
+
+  const_iterator begin() const { return elements_.begin(); }
+  const_iterator end() const { return elements_.end(); }
+  const_iterator cbegin() const { return elements_.cbegin(); }
+  const_iterator cend() const { return elements_.cend(); }
+
+  size_type size() const { return elements_.size(); }
+  bool empty() const { return elements_.empty(); }
+
+  const_iterator find(const T& value) const {
+    const_iterator it = LowerBound(value);
+    if (it == end() || Compare()(value, *it)) {
+      return end();
+    }
+    return it;
+  }
+
+  bool contains(const T& value) const { return find(value) != end(); }
+
+  // Inserts `value` if it is not already present. Returns an iterator to the
+  // element equal to `value` and whether the insertion took place.
+  std::pair<const_iterator, bool> insert(const T& value) {
+    if (elements_.empty() || Compare()(elements_.back(), value)) {
+      elements_.push_back(value);
+      return {std::prev(end()), true};
+    }
+    const_iterator it = LowerBound(value);
+    if (!Compare()(value, *it)) {
+      return {it, false};
+    }
+    return {elements_.insert(it, value), true};
+  }
+
+  // Inserts all elements of the range [first, last) which are not already
+  // present.
+  template <typename InputIt>
+  void insert(InputIt first, InputIt last) {
+    size_type old_size = elements_.size();
+    elements_.insert(elements_.end(), first, last);
+    auto middle = elements_.begin() + old_size;
+    if (!std::is_sorted(middle, elements_.end(), Compare())) {
+      std::sort(middle, elements_.end(), Compare());
+    }
+    std::inplace_merge(elements_.begin(), middle, elements_.end(), Compare());
+    elements_.erase(std::unique(elements_.begin(), elements_.end(),
+                                [](const T& a, const T& b) {
+                                  return !Compare()(a, b) && !Compare()(b, a);
+                                }),
+                    elements_.end());
+  }
+
+  // Removes the element equal to `value` if present. Returns the number of
+  // elements removed.
+  size_type erase(const T& value) {
+    if (!elements_.empty() && !Compare()(elements_.back(), value) &&
+        !Compare()(value, elements_.back())) {
+      elements_.pop_back();
+      return 1;
+    }
+    const_iterator it = find(value);
+    if (it == end()) {
+      return 0;
+    }
+    elements_.erase(it);
+    return 1;
+  }
+
+  void clear() { elements_.clear(); }
+
+  friend bool operator==(const InlinedSortedSet& lhs,
+                         const InlinedSortedSet& rhs) {
+    return lhs.elements_ == rhs.elements_;
+  }
+  friend bool operator!=(const InlinedSortedSet& lhs,
+                         const InlinedSortedSet& rhs) {
+    return !(lhs == rhs);
+  }
+
+ private:
+  const_iterator LowerBound(const T& value) const {
+    return std::lower_bound(elements_.begin(), elements_.end(), value,
+                            Compare());
+  }
+
+  Storage elements_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_DATA_STRUCTURES_INLINED_SORTED_SET_H_
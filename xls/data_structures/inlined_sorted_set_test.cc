@@ -0,0 +1,94 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/inlined_sorted_set.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace xls {
+namespace {
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+TEST(InlinedSortedSetTest, InsertAndErase) {
+  InlinedSortedSet<int64_t> set;
+  EXPECT_TRUE(set.empty());
+  EXPECT_TRUE(set.insert(5).second);
+  EXPECT_TRUE(set.insert(1).second);
+  EXPECT_TRUE(set.insert(9).second);
+  EXPECT_FALSE(set.insert(5).second);
+  EXPECT_EQ(*set.insert(3).first, 3);
+  EXPECT_THAT(set, ElementsAre(1, 3, 5, 9));
+  EXPECT_TRUE(set.contains(3));
+  EXPECT_FALSE(set.contains(4));
+  EXPECT_EQ(set.find(4), set.end());
+
+  EXPECT_EQ(set.erase(4), 0);
+  EXPECT_EQ(set.erase(9), 1);
+  EXPECT_EQ(set.erase(1), 1);
+  EXPECT_THAT(set, ElementsAre(3, 5));
+  set.clear();
+  EXPECT_THAT(set, IsEmpty());
+}
+
+TEST(InlinedSortedSetTest, CustomOrder) {
+  InlinedSortedSet<int64_t, std::greater<int64_t>> set;
+  for (int64_t i : {2, 7, 1, 7, 4}) {
+    set.insert(i);
+  }
+  EXPECT_THAT(set, ElementsAre(7, 4, 2, 1));
+}
+
+TEST(InlinedSortedSetTest, InsertRange) {
+  InlinedSortedSet<int64_t> set({4, 1, 4, 8});
+  EXPECT_THAT(set, ElementsAre(1, 4, 8));
+
+  std::vector<int64_t> sorted = {0, 4, 5, 9};
+  set.insert(sorted.begin(), sorted.end());
+  EXPECT_THAT(set, ElementsAre(0, 1, 4, 5, 8, 9));
+
+  std::vector<int64_t> unsorted = {10, 2, 2, -1};
+  set.insert(unsorted.begin(), unsorted.end());
+  EXPECT_THAT(set, ElementsAre(-1, 0, 1, 2, 4, 5, 8, 9, 10));
+  EXPECT_EQ(set, InlinedSortedSet<int64_t>({10, 9, 8, 5, 4, 2, 1, 0, -1}));
+}
+
+TEST(InlinedSortedSetTest, MatchesStdSet) {
+  std::mt19937_64 bit_gen;
+  std::uniform_int_distribution<int64_t> value(0, 63);
+  InlinedSortedSet<int64_t> set;
+  std::set<int64_t> expected;
+  for (int64_t i = 0; i < 2000; ++i) {
+    int64_t v = value(bit_gen);
+    if (i % 3 == 0) {
+      EXPECT_EQ(set.erase(v), expected.erase(v));
+    } else {
+      EXPECT_EQ(set.insert(v).second, expected.insert(v).second);
+    }
+    ASSERT_EQ(set.size(), expected.size());
+    EXPECT_TRUE(std::equal(set.begin(), set.end(), expected.begin()));
+  }
+}
+
+}  // namespace
+}  // namespace xls
@@ -15,7 +15,12 @@
 #ifndef XLS_DATA_STRUCTURES_LEAF_TYPE_TREE_H_
 #define XLS_DATA_STRUCTURES_LEAF_TYPE_TREE_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -29,6 +34,90 @@
 
 namespace xls {
 
+template <typename T>
+class LeafTypeTree;
+
+namespace leaf_type_tree_internal {
+
+inline bool IsLeafType(Type* t) { return t->IsBits() || t->IsToken(); }
+
+// Returns a pair containing the Type and element offset for the given type
+// index.
+inline std::pair<Type*, int64_t> GetSubtypeAndOffset(
+    Type* t, absl::Span<int64_t const> index, int64_t offset = 0) {
+  if (index.empty()) {
+    return {t, offset};
+  }
+  if (t->IsArray()) {
+    XLS_CHECK(!index.empty());
+    XLS_CHECK_LT(index[0], t->AsArrayOrDie()->size());
+    Type* element_type = t->AsArrayOrDie()->element_type();
+    return GetSubtypeAndOffset(element_type, index.subspan(1),
+                               offset + index[0] * element_type->leaf_count());
+  }
+  XLS_CHECK(t->IsTuple());
+  TupleType* tuple_type = t->AsTupleOrDie();
+  XLS_CHECK_LT(index[0], tuple_type->size());
+  int64_t element_offset = 0;
+  for (int64_t i = 0; i < index[0]; ++i) {
+    element_offset += tuple_type->element_type(i)->leaf_count();
+  }
+  return GetSubtypeAndOffset(tuple_type->element_type(index[0]),
+                             index.subspan(1), offset + element_offset);
+}
+
+}  // namespace leaf_type_tree_internal
+
+// A non-owning view of the elements of a LeafTypeTree or of one of its
+// subtrees. `T` may be const-qualified for a read-only view. Views are cheap to
+// copy and taking a view of a subtree copies nothing, so they should be
+// preferred over LeafTypeTree::CopySubtree when the subtree is only read. A
+// view is invalidated by anything which invalidates the elements of the
+// underlying tree (e.g., assigning to or destroying the tree).
+template <typename T>
+class LeafTypeTreeView {
+ public:
+  LeafTypeTreeView(Type* type, absl::Span<T> elements,
+                   absl::Span<Type* const> leaf_types)
+      : type_(type), elements_(elements), leaf_types_(leaf_types) {
+    XLS_DCHECK_EQ(elements_.size(), leaf_types_.size());
+  }
+
+  // A mutable view converts to a read-only view.
+  template <typename U,
+            typename = std::enable_if_t<std::is_same_v<const U, T>>>
+  LeafTypeTreeView(const LeafTypeTreeView<U>& other)  // NOLINT
+      : LeafTypeTreeView(other.type(), other.elements(), other.leaf_types()) {}
+
+  Type* type() const { return type_; }
+  int64_t size() const { return elements_.size(); }
+  absl::Span<T> elements() const { return elements_; }
+  absl::Span<Type* const> leaf_types() const { return leaf_types_; }
+
+  // Returns the element at the given leaf index. See LeafTypeTree::Get.
+  T& Get(absl::Span<int64_t const> index) const {
+    std::pair<Type*, int64_t> type_offset =
+        leaf_type_tree_internal::GetSubtypeAndOffset(type_, index);
+    XLS_CHECK(leaf_type_tree_internal::IsLeafType(type_offset.first));
+    return elements_[type_offset.second];
+  }
+
+  // Returns a view of the subtree rooted at the given type index.
+  LeafTypeTreeView<T> AsView(absl::Span<int64_t const> index) const {
+    std::pair<Type*, int64_t> type_offset =
+        leaf_type_tree_internal::GetSubtypeAndOffset(type_, index);
+    int64_t leaf_count = type_offset.first->leaf_count();
+    return LeafTypeTreeView<T>(
+        type_offset.first, elements_.subspan(type_offset.second, leaf_count),
+        leaf_types_.subspan(type_offset.second, leaf_count));
+  }
+
+ private:
+  Type* type_;
+  absl::Span<T> elements_;
+  absl::Span<Type* const> leaf_types_;
+};
+
 // A container which stores values of an arbitrary type T, one value for each
 // leaf element (Bits value) of a potentially-recursive XLS type. Values are
 // stored in a flat vector which provides fast iteration, but indexing through
@@ -72,31 +161,48 @@ class LeafTypeTree {
     MakeLeafTypes(type);
   }
 
+  // Constructs a tree holding a copy of the elements of `view`.
+  explicit LeafTypeTree(LeafTypeTreeView<const T> view)
+      : type_(view.type()),
+        elements_(view.elements().begin(), view.elements().end()),
+        leaf_types_(view.leaf_types().begin(), view.leaf_types().end()) {}
+
   // Constructor for tuples/arrays where members are provided as a span.
   LeafTypeTree(Type* type, absl::Span<LeafTypeTree<T> const> init_values)
       : type_(type) {
-    // Validate types of given values.
-    if (type->IsArray()) {
-      XLS_CHECK_EQ(type->AsArrayOrDie()->size(), init_values.size());
-      for (auto& init_value : init_values) {
-        XLS_CHECK_EQ(type->AsArrayOrDie()->element_type(), init_value.type());
-      }
-    } else if (type->IsTuple()) {
-      XLS_CHECK_EQ(type->AsTupleOrDie()->size(), init_values.size());
-      for (int64_t i = 0; i < init_values.size(); ++i) {
-        XLS_CHECK_EQ(type->AsTupleOrDie()->element_type(i),
-                     init_values[i].type());
-      }
-    } else {
-      XLS_LOG(FATAL) << "Invalid constructor for bits types";
+    CheckMemberTypes(type, init_values);
+    for (const LeafTypeTree<T>& init_value : init_values) {
+      AppendMember(init_value.AsView());
     }
+  }
 
-    MakeLeafTypes(type);
-    for (int64_t i = 0; i < init_values.size(); ++i) {
-      for (int64_t j = 0; j < init_values[i].size(); ++j) {
-        const T& leaf = init_values[i].elements()[j];
-        elements_.push_back(leaf);
-      }
+  // Constructor for tuples/arrays where members are provided as views, e.g. of
+  // subtrees of other trees.
+  LeafTypeTree(Type* type,
+               absl::Span<LeafTypeTreeView<const T> const> init_values)
+      : type_(type) {
+    CheckMemberTypes(type, init_values);
+    for (const LeafTypeTreeView<const T>& init_value : init_values) {
+      AppendMember(init_value);
+    }
+  }
+
+  // Constructor for tuples/arrays which moves the elements out of the given
+  // members rather than copying them.
+  LeafTypeTree(Type* type, std::vector<LeafTypeTree<T>>&& init_values)
+      : type_(type) {
+    CheckMemberTypes(type, absl::MakeConstSpan(init_values));
+    int64_t leaf_count = 0;
+    for (const LeafTypeTree<T>& init_value : init_values) {
+      leaf_count += init_value.size();
+    }
+    elements_.reserve(leaf_count);
+    leaf_types_.reserve(leaf_count);
+    for (LeafTypeTree<T>& init_value : init_values) {
+      std::move(init_value.elements_.begin(), init_value.elements_.end(),
+                std::back_inserter(elements_));
+      leaf_types_.insert(leaf_types_.end(), init_value.leaf_types_.begin(),
+                         init_value.leaf_types_.end());
     }
   }
 
@@ -169,30 +275,36 @@ class LeafTypeTree {
   // these types corresponds to the order of elements().
   absl::Span<Type* const> leaf_types() const { return leaf_types_; }
 
+  // Returns a non-owning view of the subtree rooted at the given type index
+  // (by default the whole tree).
+  LeafTypeTreeView<const T> AsView(absl::Span<const int64_t> index = {}) const {
+    return LeafTypeTreeView<const T>(type_, absl::MakeConstSpan(elements_),
+                                     leaf_types_)
+        .AsView(index);
+  }
+  LeafTypeTreeView<T> AsMutableView(absl::Span<const int64_t> index = {}) {
+    return LeafTypeTreeView<T>(type_, absl::MakeSpan(elements_), leaf_types_)
+        .AsView(index);
+  }
+
   // Copies and returns the subtree rooted at the given type index as a
-  // LeafTypeTree.
+  // LeafTypeTree. Prefer AsView if the subtree is only read.
   LeafTypeTree<T> CopySubtree(absl::Span<const int64_t> index) const {
-    std::pair<Type*, int64_t> type_offset = GetSubtypeAndOffset(type_, index);
-    // To avoid indexing into an empty vector, handle the empty elements()
-    // case specially.
-    return LeafTypeTree<T>(
-        type_offset.first,
-        type_offset.first->leaf_count() == 0
-            ? absl::Span<const T>()
-            : absl::Span<const T>(&elements_[type_offset.second],
-                                  type_offset.first->leaf_count()));
+    return LeafTypeTree<T>(AsView(index));
   }
 
   // Produce a new `LeafTypeTree` from this one `LeafTypeTree` with a different
   // leaf type by way of a function.
   template <typename R>
   LeafTypeTree<R> Map(std::function<R(const T&)> function) const {
-    absl::InlinedVector<R, 1> new_elements;
-    new_elements.reserve(size());
-    for (int32_t i = 0; i < size(); ++i) {
-      new_elements.push_back(function(elements()[i]));
+    LeafTypeTree<R> result;
+    result.type_ = type_;
+    result.elements_.reserve(size());
+    for (int64_t i = 0; i < size(); ++i) {
+      result.elements_.push_back(function(elements_[i]));
     }
-    return LeafTypeTree<R>(type(), new_elements);
+    result.leaf_types_ = leaf_types_;
+    return result;
   }
 
   // Use the given function to combine each corresponding leaf element in the
@@ -205,13 +317,15 @@ class LeafTypeTree {
     XLS_CHECK(lhs.type()->IsEqualTo(rhs.type()));
     XLS_CHECK_EQ(lhs.size(), rhs.size());
 
-    absl::InlinedVector<T, 1> new_elements;
-    new_elements.reserve(lhs.size());
-    for (int32_t i = 0; i < lhs.size(); ++i) {
-      new_elements.push_back(function(lhs.elements()[i], rhs.elements()[i]));
+    LeafTypeTree<T> result;
+    result.type_ = lhs.type();
+    result.elements_.reserve(lhs.size());
+    for (int64_t i = 0; i < lhs.size(); ++i) {
+      result.elements_.push_back(
+          function(lhs.elements()[i], rhs.elements()[i]));
     }
-
-    return LeafTypeTree<T>(lhs.type(), new_elements);
+    result.leaf_types_.assign(lhs.leaf_types().begin(), lhs.leaf_types().end());
+    return result;
   }
 
   friend bool operator==(const LeafTypeTree<T>& lhs,
@@ -290,7 +404,39 @@ class LeafTypeTree {
   }
 
  private:
-  static bool IsLeafType(Type* t) { return t->IsBits() || t->IsToken(); }
+  template <typename U>
+  friend class LeafTypeTree;
+
+  static bool IsLeafType(Type* t) {
+    return leaf_type_tree_internal::IsLeafType(t);
+  }
+
+  // CHECK-fails unless `members` have the types of the elements of the tuple
+  // or array type `type`.
+  template <typename Member>
+  static void CheckMemberTypes(Type* type, absl::Span<const Member> members) {
+    if (type->IsArray()) {
+      XLS_CHECK_EQ(type->AsArrayOrDie()->size(), members.size());
+      for (const Member& member : members) {
+        XLS_CHECK_EQ(type->AsArrayOrDie()->element_type(), member.type());
+      }
+    } else if (type->IsTuple()) {
+      XLS_CHECK_EQ(type->AsTupleOrDie()->size(), members.size());
+      for (int64_t i = 0; i < members.size(); ++i) {
+        XLS_CHECK_EQ(type->AsTupleOrDie()->element_type(i), members[i].type());
+      }
+    } else {
+      XLS_LOG(FATAL) << "Invalid constructor for bits types";
+    }
+  }
+
+  // Appends the leaves of a tuple or array member.
+  void AppendMember(LeafTypeTreeView<const T> member) {
+    elements_.insert(elements_.end(), member.elements().begin(),
+                     member.elements().end());
+    leaf_types_.insert(leaf_types_.end(), member.leaf_types().begin(),
+                       member.leaf_types().end());
+  }
 
   std::string ToStringHelper(const std::function<std::string(const T&)>& f,
                              Type* subtype, bool multiline, int64_t indent,
@@ -353,31 +499,9 @@ class LeafTypeTree {
     }
   }
 
-  // Returns a pair containing the Type and element offset for the given type
-  // index.
-  std::pair<Type*, int64_t> GetSubtypeAndOffset(Type* t,
-                                                absl::Span<int64_t const> index,
-                                                int64_t offset = 0) const {
-    if (index.empty()) {
-      return {t, offset};
-    }
-    if (t->IsArray()) {
-      XLS_CHECK(!index.empty());
-      XLS_CHECK_LT(index[0], t->AsArrayOrDie()->size());
-      Type* element_type = t->AsArrayOrDie()->element_type();
-      return GetSubtypeAndOffset(
-          element_type, index.subspan(1),
-          offset + index[0] * element_type->leaf_count());
-    }
-    XLS_CHECK(t->IsTuple());
-    TupleType* tuple_type = t->AsTupleOrDie();
-    XLS_CHECK_LT(index[0], tuple_type->size());
-    int64_t element_offset = 0;
-    for (int64_t i = 0; i < index[0]; ++i) {
-      element_offset += tuple_type->element_type(i)->leaf_count();
-    }
-    return GetSubtypeAndOffset(tuple_type->element_type(index[0]),
-                               index.subspan(1), offset + element_offset);
+  std::pair<Type*, int64_t> GetSubtypeAndOffset(
+      Type* t, absl::Span<int64_t const> index) const {
+    return leaf_type_tree_internal::GetSubtypeAndOffset(t, index);
   }
 
   absl::Status ForEachHelper(
@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -231,6 +232,63 @@ TEST_F(LeafTypeTreeTest, NestedTupleType) {
   EXPECT_THAT(subtree.elements(), ElementsAre(42, 0, 0));
 }
 
+TEST_F(LeafTypeTreeTest, SubtreeViews) {
+  LeafTypeTree<int64_t> tree(
+      AsType("(bits[37][3], (bits[22], (bits[1], bits[1][2]), bits[42]))"));
+  for (int64_t i = 0; i < tree.size(); ++i) {
+    tree.elements()[i] = i;
+  }
+
+  LeafTypeTreeView<const int64_t> view = tree.AsView({1, 1});
+  EXPECT_EQ(view.type()->ToString(), "(bits[1], bits[1][2])");
+  EXPECT_THAT(view.elements(), ElementsAre(4, 5, 6));
+  EXPECT_EQ(view.leaf_types().size(), 3);
+  EXPECT_EQ(view.Get({1, 0}), 5);
+  EXPECT_THAT(view.AsView({1}).elements(), ElementsAre(5, 6));
+  // Views share storage with the tree.
+  EXPECT_EQ(view.elements().data(), &tree.Get({1, 1, 0}));
+
+  LeafTypeTreeView<int64_t> mutable_view = tree.AsMutableView({0});
+  mutable_view.Get({2}) = 42;
+  EXPECT_EQ(tree.Get({0, 2}), 42);
+  LeafTypeTreeView<const int64_t> const_view = mutable_view;
+  EXPECT_THAT(const_view.elements(), ElementsAre(0, 1, 42));
+
+  LeafTypeTree<int64_t> copy(view);
+  EXPECT_EQ(copy, tree.CopySubtree({1, 1}));
+  EXPECT_THAT(copy.elements(), ElementsAre(4, 5, 6));
+  EXPECT_EQ(copy.Get({1, 1}), 6);
+
+  EXPECT_THAT(LeafTypeTree<int64_t>(tree.AsView({0, 1})).elements(),
+              ElementsAre(1));
+  EXPECT_THAT(LeafTypeTree<int64_t>(AsType("()")).AsView().elements(),
+              ElementsAre());
+}
+
+TEST_F(LeafTypeTreeTest, ConstructFromMembers) {
+  LeafTypeTree<std::string> a(AsType("(bits[1], bits[2])"));
+  a.Set({0}, "a0");
+  a.Set({1}, "a1");
+  LeafTypeTree<std::string> b(AsType("bits[3]"), "b");
+  Type* tuple_type = AsType("((bits[1], bits[2]), bits[3])");
+
+  std::vector<LeafTypeTreeView<const std::string>> views = {a.AsView(),
+                                                          b.AsView()};
+  LeafTypeTree<std::string> from_views(tuple_type, absl::MakeConstSpan(views));
+  EXPECT_THAT(from_views.elements(), ElementsAre("a0", "a1", "b"));
+
+  LeafTypeTree<std::string> moved(
+      tuple_type, std::vector<LeafTypeTree<std::string>>{a, b});
+  EXPECT_EQ(moved, from_views);
+  EXPECT_EQ(moved.Get({0, 1}), "a1");
+  EXPECT_EQ(moved.leaf_types()[2], b.type());
+
+  Type* array_type = AsType("(bits[1], bits[2])[2]");
+  std::vector<LeafTypeTree<std::string>> members = {moved.CopySubtree({0}), a};
+  LeafTypeTree<std::string> array(array_type, std::move(members));
+  EXPECT_THAT(array.elements(), ElementsAre("a0", "a1", "a0", "a1"));
+}
+
 TEST_F(LeafTypeTreeTest, NestedArrayType) {
   LeafTypeTree<int64_t> tree(AsType("(bits[42], bits[123])[3]"));
 
@@ -15,16 +15,24 @@
 #ifndef XLS_DATA_STRUCTURES_MAXIMUM_CLIQUE_H_
 #define XLS_DATA_STRUCTURES_MAXIMUM_CLIQUE_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <numeric>
 #include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/container/btree_map.h"
 #include "absl/container/btree_set.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/log_message.h"
 #include "xls/common/logging/logging.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "ortools/linear_solver/linear_solver.h"
 
 namespace xls {
@@ -95,6 +103,194 @@ absl::StatusOr<absl::btree_set<V, Compare>> MaximumClique(
   return result;
 }
 
+namespace maximum_clique_internal {
+
+// Branch and bound search for a maximum clique of a graph given as one
+// adjacency bitmap per vertex, following Tomita's MCQ: at each step the
+// candidate vertices are greedily colored and the number of colors bounds the
+// size of any clique among them. Vertices should be numbered in order of
+// decreasing degree for the bounds to be effective.
+class DenseMaximumCliqueSearch {
+ public:
+  DenseMaximumCliqueSearch(absl::Span<const InlineBitmap> adjacency,
+                           std::optional<int64_t> max_branches)
+      : adjacency_(adjacency), max_branches_(max_branches) {}
+
+  void Run() {
+    if (adjacency_.empty()) {
+      return;
+    }
+    Expand(InlineBitmap(adjacency_.size(), /*fill=*/true));
+    if (exhausted_) {
+      // The best clique was only extended among the candidates of its branch
+      // so it may be extensible by vertices excluded by earlier branches.
+      InlineBitmap extensions(adjacency_.size(), /*fill=*/true);
+      for (int64_t v : best_) {
+        extensions.Intersect(adjacency_[v]);
+      }
+      for (int64_t v = extensions.FindFirstSetBit();
+           v < extensions.bit_count(); v = extensions.FindFirstSetBit()) {
+        best_.push_back(v);
+        extensions.Intersect(adjacency_[v]);
+      }
+    }
+  }
+
+  absl::Span<const int64_t> best() const { return best_; }
+
+  // Whether the search was cut short by the branch limit, in which case best()
+  // is a maximal but not necessarily maximum clique.
+  bool exhausted() const { return exhausted_; }
+
+ private:
+  void Expand(const InlineBitmap& candidates) {
+    if (max_branches_.has_value() && branches_ >= *max_branches_) {
+      // Out of budget; greedily complete the current clique instead.
+      exhausted_ = true;
+      InlineBitmap remaining = candidates;
+      std::vector<int64_t> clique = current_;
+      for (int64_t v = remaining.FindFirstSetBit();
+           v < remaining.bit_count(); v = remaining.FindFirstSetBit()) {
+        clique.push_back(v);
+        remaining.Intersect(adjacency_[v]);
+      }
+      if (clique.size() > best_.size()) {
+        best_ = std::move(clique);
+      }
+      return;
+    }
+    ++branches_;
+
+    // Greedy sequential coloring of the candidates; `order` lists the
+    // candidates by nondecreasing color.
+    std::vector<int64_t> order;
+    std::vector<int64_t> colors;
+    {
+      InlineBitmap uncolored = candidates;
+      int64_t color = 0;
+      while (!uncolored.IsAllZeroes()) {
+        ++color;
+        InlineBitmap colorable = uncolored;
+        for (int64_t v = colorable.FindFirstSetBit();
+             v < colorable.bit_count(); v = colorable.FindFirstSetBit()) {
+          colorable.Set(v, false);
+          colorable.Subtract(adjacency_[v]);
+          uncolored.Set(v, false);
+          order.push_back(v);
+          colors.push_back(color);
+        }
+      }
+    }
+
+    InlineBitmap remaining = candidates;
+    for (int64_t i = static_cast<int64_t>(order.size()) - 1; i >= 0; --i) {
+      // Any clique among the remaining candidates has at most colors[i]
+      // vertices.
+      if (current_.size() + colors[i] <= best_.size()) {
+        return;
+      }
+      int64_t v = order[i];
+      current_.push_back(v);
+      InlineBitmap next = remaining;
+      next.Intersect(adjacency_[v]);
+      if (next.IsAllZeroes()) {
+        if (current_.size() > best_.size()) {
+          best_ = current_;
+        }
+      } else {
+        Expand(next);
+      }
+      current_.pop_back();
+      remaining.Set(v, false);
+      if (exhausted_) {
+        return;
+      }
+    }
+  }
+
+  absl::Span<const InlineBitmap> adjacency_;
+  std::optional<int64_t> max_branches_;
+  int64_t branches_ = 0;
+  bool exhausted_ = false;
+  std::vector<int64_t> current_;
+  std::vector<int64_t> best_;
+};
+
+}  // namespace maximum_clique_internal
+
+template <typename V, typename Compare = std::less<V>>
+struct MaximumCliqueResult {
+  absl::btree_set<V, Compare> clique;
+
+  // Whether `clique` is known to be a maximum clique. If false the search was
+  // cut short and `clique` is only maximal.
+  bool optimal;
+};
+
+// Compute a maximum clique of the given graph by a branch and bound search over
+// bitset adjacency with greedy coloring bounds. Unlike MaximumClique this does
+// not need an ILP solver and handles dense graphs of a few hundred vertices.
+// Two vertices are adjacent iff each is in the neighborhood of the other.
+//
+// The search is exponential in the worst case. If `max_branches` is given the
+// search stops after that many branches and returns the largest clique found
+// so far, extended greedily to a maximal clique.
+template <typename V, typename Compare = std::less<V>>
+MaximumCliqueResult<V, Compare> BranchAndBoundMaximumClique(
+    const absl::btree_set<V, Compare>& vertices,
+    std::function<absl::btree_set<V, Compare>(const V&)> neighborhood,
+    std::optional<int64_t> max_branches = std::nullopt) {
+  std::vector<V> by_index(vertices.begin(), vertices.end());
+  const int64_t n = by_index.size();
+  absl::btree_map<V, int64_t, Compare> index_of;
+  for (int64_t i = 0; i < n; ++i) {
+    index_of[by_index[i]] = i;
+  }
+  std::vector<InlineBitmap> out_edges(n, InlineBitmap(n));
+  for (int64_t i = 0; i < n; ++i) {
+    for (const V& neighbor : neighborhood(by_index[i])) {
+      auto it = index_of.find(neighbor);
+      if (it != index_of.end() && it->second != i) {
+        out_edges[i].Set(it->second);
+      }
+    }
+  }
+
+  // Renumber the vertices in order of decreasing degree, which makes the
+  // coloring bounds much tighter.
+  std::vector<InlineBitmap> adjacency(n, InlineBitmap(n));
+  for (int64_t i = 0; i < n; ++i) {
+    for (int64_t j = 0; j < n; ++j) {
+      if (out_edges[i].Get(j) && out_edges[j].Get(i)) {
+        adjacency[i].Set(j);
+      }
+    }
+  }
+  std::vector<int64_t> degree_order(n);
+  std::iota(degree_order.begin(), degree_order.end(), 0);
+  std::stable_sort(degree_order.begin(), degree_order.end(),
+                   [&](int64_t a, int64_t b) {
+                     return adjacency[a].PopCount() > adjacency[b].PopCount();
+                   });
+  std::vector<InlineBitmap> ordered_adjacency(n, InlineBitmap(n));
+  for (int64_t i = 0; i < n; ++i) {
+    for (int64_t j = 0; j < n; ++j) {
+      if (adjacency[degree_order[i]].Get(degree_order[j])) {
+        ordered_adjacency[i].Set(j);
+      }
+    }
+  }
+
+  maximum_clique_internal::DenseMaximumCliqueSearch search(ordered_adjacency,
+                                                           max_branches);
+  search.Run();
+  MaximumCliqueResult<V, Compare> result{.optimal = !search.exhausted()};
+  for (int64_t i : search.best()) {
+    result.clique.insert(by_index[degree_order[i]]);
+  }
+  return result;
+}
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_MAXIMUM_CLIQUE_H_
@@ -14,7 +14,9 @@
 
 #include "xls/data_structures/maximum_clique.h"
 
+#include <cstdint>
 #include <functional>
+#include <optional>
 #include <random>
 #include <string>
 #include <vector>
@@ -23,6 +25,7 @@
 #include "gtest/gtest.h"
 #include "absl/container/btree_map.h"
 #include "absl/container/btree_set.h"
+#include "absl/strings/str_format.h"
 
 namespace xls {
 namespace {
@@ -53,16 +56,38 @@ absl::btree_set<V> VerticesOf(const Graph& neighborhood) {
   return nodes;
 }
 
+MaximumCliqueResult<V> BranchAndBoundCliqueFromMap(
+    const Graph& neighborhood,
+    std::optional<int64_t> max_branches = std::nullopt) {
+  Graph symmetric_neighborhood = Symmetrize(neighborhood);
+  absl::btree_set<V> nodes = VerticesOf(neighborhood);
+
+  return BranchAndBoundMaximumClique<V, std::less<V>>(
+      nodes,
+      [&](const V& node) -> absl::btree_set<V> {
+        return symmetric_neighborhood.at(node);
+      },
+      max_branches);
+}
+
 absl::btree_set<V> CliqueFromMap(const Graph& neighborhood) {
   Graph symmetric_neighborhood = Symmetrize(neighborhood);
   absl::btree_set<V> nodes = VerticesOf(neighborhood);
 
-  return MaximumClique<V, std::less<V>>(
-             nodes,
-             [&](const V& node) -> absl::btree_set<V> {
-               return symmetric_neighborhood.at(node);
-             })
-      .value();
+  absl::btree_set<V> clique =
+      MaximumClique<V, std::less<V>>(
+          nodes,
+          [&](const V& node) -> absl::btree_set<V> {
+            return symmetric_neighborhood.at(node);
+          })
+          .value();
+
+  // The branch and bound search must find a clique of the same size.
+  MaximumCliqueResult<V> bnb = BranchAndBoundCliqueFromMap(neighborhood);
+  EXPECT_TRUE(bnb.optimal);
+  EXPECT_EQ(bnb.clique.size(), clique.size());
+
+  return clique;
 }
 
 bool IsValidClique(const absl::btree_map<V, absl::btree_set<V>>& neighborhood,
@@ -154,6 +179,46 @@ TEST(MaximumCliqueTest, Big) {
   absl::btree_set<V> clique = CliqueFromMap(graph);
   EXPECT_EQ(clique.size(), 17);
   EXPECT_TRUE(IsValidClique(graph, clique));
+
+  MaximumCliqueResult<V> bnb = BranchAndBoundCliqueFromMap(graph);
+  EXPECT_TRUE(IsValidClique(graph, bnb.clique));
+}
+
+TEST(MaximumCliqueTest, BranchLimitReturnsMaximalClique) {
+  std::vector<V> nodes;
+  for (int64_t i = 0; i < 200; ++i) {
+    nodes.push_back(absl::StrFormat("%d", i));
+  }
+
+  absl::btree_map<V, absl::btree_set<V>> graph;
+  std::mt19937_64 gen;
+  std::bernoulli_distribution coin(0.6);
+  for (int64_t i = 0; i < nodes.size(); ++i) {
+    for (int64_t j = i + 1; j < nodes.size(); ++j) {
+      if (coin(gen)) {
+        graph[nodes[i]].insert(nodes[j]);
+      }
+    }
+  }
+
+  MaximumCliqueResult<V> limited =
+      BranchAndBoundCliqueFromMap(graph, /*max_branches=*/10);
+  EXPECT_FALSE(limited.optimal);
+  EXPECT_FALSE(limited.clique.empty());
+  EXPECT_TRUE(IsValidClique(graph, limited.clique));
+
+  // The returned clique cannot be extended.
+  Graph symmetric = Symmetrize(graph);
+  for (const V& node : nodes) {
+    if (limited.clique.contains(node)) {
+      continue;
+    }
+    bool adjacent_to_all = true;
+    for (const V& member : limited.clique) {
+      adjacent_to_all = adjacent_to_all && symmetric[node].contains(member);
+    }
+    EXPECT_FALSE(adjacent_to_all) << node;
+  }
 }
 
 }  // namespace
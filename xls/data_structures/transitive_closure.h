@@ -15,26 +15,93 @@
 #ifndef XLS_DATA_STRUCTURES_TRANSITIVE_CLOSURE_H_
 #define XLS_DATA_STRUCTURES_TRANSITIVE_CLOSURE_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/numeric/bits.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/log_message.h"
 #include "xls/common/logging/logging.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 
 template <typename V>
 using HashRelation = absl::flat_hash_map<V, absl::flat_hash_set<V>>;
 
-// Compute the transitive closure of a relation.
-template <typename V>
-HashRelation<V> TransitiveClosure(const HashRelation<V>& relation) {
-  using Rel = HashRelation<V>;
+// Relations with at most this many distinct elements are closed using a dense
+// bitmap-per-element representation (O(n^2) bits) by TransitiveClosure.
+inline constexpr int64_t kMaxDenseTransitiveClosureSize = int64_t{1} << 14;
 
-  if (relation.empty()) {
-    return Rel();
+// Compute the transitive closure of the relation over the integers [0, n) where
+// `successors[i]` lists the elements related to i. Bit j of row i of the result
+// is set iff j is reachable from i by a non-empty path. If the relation is
+// acyclic the rows are built by OR-ing successor rows in reverse topological
+// order; otherwise a word-parallel Warshall's algorithm is used.
+inline std::vector<InlineBitmap> DenseTransitiveClosure(
+    absl::Span<const std::vector<int64_t>> successors) {
+  const int64_t n = successors.size();
+  std::vector<InlineBitmap> rows(n, InlineBitmap(n));
+
+  // Kahn's algorithm. `order` is a topological order if it includes all
+  // elements.
+  std::vector<int64_t> in_degree(n, 0);
+  for (const std::vector<int64_t>& succs : successors) {
+    for (int64_t j : succs) {
+      ++in_degree[j];
+    }
+  }
+  std::vector<int64_t> order;
+  order.reserve(n);
+  for (int64_t i = 0; i < n; ++i) {
+    if (in_degree[i] == 0) {
+      order.push_back(i);
+    }
+  }
+  for (int64_t k = 0; k < order.size(); ++k) {
+    for (int64_t j : successors[order[k]]) {
+      if (--in_degree[j] == 0) {
+        order.push_back(j);
+      }
+    }
+  }
+
+  if (order.size() == n) {
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+      InlineBitmap& row = rows[*it];
+      for (int64_t j : successors[*it]) {
+        row.Set(j);
+        row.Union(rows[j]);
+      }
+    }
+    return rows;
+  }
+
+  // Warshall's algorithm; https://cs.winona.edu/lin/cs440/ch08-2.pdf
+  for (int64_t i = 0; i < n; ++i) {
+    for (int64_t j : successors[i]) {
+      rows[i].Set(j);
+    }
+  }
+  for (int64_t k = 0; k < n; ++k) {
+    for (int64_t i = 0; i < n; ++i) {
+      if (i != k && rows[i].Get(k)) {
+        rows[i].Union(rows[k]);
+      }
+    }
   }
+  return rows;
+}
 
+namespace transitive_closure_internal {
+
+// Returns the elements of `relation` in sorted order.
+template <typename V>
+std::vector<V> OrderedElements(const HashRelation<V>& relation) {
   absl::flat_hash_set<V> unordered_nodes;
   for (const auto& [node, children] : relation) {
     unordered_nodes.insert(node);
@@ -45,13 +112,70 @@ HashRelation<V> TransitiveClosure(const HashRelation<V>& relation) {
 
   std::vector<V> ordered_nodes(unordered_nodes.begin(), unordered_nodes.end());
   std::sort(ordered_nodes.begin(), ordered_nodes.end());
+  return ordered_nodes;
+}
 
-  const int64_t n = ordered_nodes.size();
+// Returns `relation` as successor lists over the indices of `ordered_nodes`.
+template <typename V>
+std::vector<std::vector<int64_t>> IndexRelation(
+    const HashRelation<V>& relation, absl::Span<const V> ordered_nodes,
+    const absl::flat_hash_map<V, int64_t>& node_to_index) {
+  std::vector<std::vector<int64_t>> successors(ordered_nodes.size());
+  for (const auto& [node, children] : relation) {
+    std::vector<int64_t>& succs = successors[node_to_index.at(node)];
+    for (const auto& child : children) {
+      succs.push_back(node_to_index.at(child));
+    }
+  }
+  return successors;
+}
 
+template <typename V>
+absl::flat_hash_map<V, int64_t> IndexNodes(absl::Span<const V> ordered_nodes) {
   absl::flat_hash_map<V, int64_t> node_to_index;
-  for (int64_t i = 0; i < n; ++i) {
+  node_to_index.reserve(ordered_nodes.size());
+  for (int64_t i = 0; i < ordered_nodes.size(); ++i) {
     node_to_index[ordered_nodes[i]] = i;
   }
+  return node_to_index;
+}
+
+}  // namespace transitive_closure_internal
+
+// Compute the transitive closure of a relation.
+template <typename V>
+HashRelation<V> TransitiveClosure(const HashRelation<V>& relation) {
+  using Rel = HashRelation<V>;
+
+  if (relation.empty()) {
+    return Rel();
+  }
+
+  std::vector<V> ordered_nodes =
+      transitive_closure_internal::OrderedElements(relation);
+  const int64_t n = ordered_nodes.size();
+  absl::flat_hash_map<V, int64_t> node_to_index =
+      transitive_closure_internal::IndexNodes<V>(ordered_nodes);
+
+  if (n <= kMaxDenseTransitiveClosureSize) {
+    std::vector<InlineBitmap> closure =
+        DenseTransitiveClosure(transitive_closure_internal::IndexRelation<V>(
+            relation, ordered_nodes, node_to_index));
+    Rel result;
+    for (int64_t i = 0; i < n; ++i) {
+      if (closure[i].IsAllZeroes()) {
+        continue;
+      }
+      absl::flat_hash_set<V>& children = result[ordered_nodes[i]];
+      for (int64_t w = 0; w < closure[i].word_count(); ++w) {
+        for (uint64_t word = closure[i].GetWord(w); word != 0;
+             word &= word - 1) {
+          children.insert(ordered_nodes[w * 64 + absl::countr_zero(word)]);
+        }
+      }
+    }
+    return result;
+  }
 
   // Warshall's algorithm; https://cs.winona.edu/lin/cs440/ch08-2.pdf
 
@@ -95,6 +219,49 @@ HashRelation<V> TransitiveClosure(const HashRelation<V>& relation) {
   return result;
 }
 
+// A reachability index over the transitive closure of a relation, answering
+// whether one element reaches another with a bit test. Uses O(n^2) bits for a
+// relation with n distinct elements.
+template <typename V>
+class ReachabilityIndex {
+ public:
+  explicit ReachabilityIndex(const HashRelation<V>& relation)
+      : elements_(transitive_closure_internal::OrderedElements(relation)),
+        element_to_index_(
+            transitive_closure_internal::IndexNodes<V>(elements_)),
+        closure_(DenseTransitiveClosure(
+            transitive_closure_internal::IndexRelation<V>(
+                relation, elements_, element_to_index_))) {}
+
+  // The elements of the relation in sorted order. An element's position in
+  // this list is its index.
+  absl::Span<const V> elements() const { return elements_; }
+
+  // Returns the index of `v`, or -1 if `v` is not an element of the relation.
+  int64_t IndexOf(const V& v) const {
+    auto it = element_to_index_.find(v);
+    return it == element_to_index_.end() ? -1 : it->second;
+  }
+
+  // Returns true iff `to` is reachable from `from` by a non-empty path.
+  bool Reaches(const V& from, const V& to) const {
+    int64_t from_index = IndexOf(from);
+    int64_t to_index = IndexOf(to);
+    return from_index >= 0 && to_index >= 0 &&
+           ReachesByIndex(from_index, to_index);
+  }
+
+  // As Reaches but takes the indices of the elements.
+  bool ReachesByIndex(int64_t from, int64_t to) const {
+    return closure_[from].Get(to);
+  }
+
+ private:
+  std::vector<V> elements_;
+  absl::flat_hash_map<V, int64_t> element_to_index_;
+  std::vector<InlineBitmap> closure_;
+};
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_TRANSITIVE_CLOSURE_H_
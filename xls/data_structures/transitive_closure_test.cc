@@ -14,16 +14,20 @@
 
 #include "xls/data_structures/transitive_closure.h"
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::UnorderedElementsAre;
 
 using V = std::string;
@@ -43,5 +47,69 @@ TEST(TransitiveClosureTest, Simple) {
   EXPECT_FALSE(tc.contains("qux"));
 }
 
+TEST(TransitiveClosureTest, Cycle) {
+  HashRelation<V> rel;
+  rel["a"].insert("b");
+  rel["b"].insert("c");
+  rel["c"].insert("a");
+  rel["c"].insert("d");
+  HashRelation<V> tc = TransitiveClosure<V>(rel);
+  EXPECT_THAT(tc.at("a"), UnorderedElementsAre("a", "b", "c", "d"));
+  EXPECT_THAT(tc.at("b"), UnorderedElementsAre("a", "b", "c", "d"));
+  EXPECT_THAT(tc.at("c"), UnorderedElementsAre("a", "b", "c", "d"));
+  EXPECT_FALSE(tc.contains("d"));
+}
+
+TEST(TransitiveClosureTest, DenseClosure) {
+  // Acyclic: 0 -> 1 -> 2, 3 -> 1.
+  std::vector<InlineBitmap> dag =
+      DenseTransitiveClosure({{1}, {2}, {}, {1}});
+  EXPECT_EQ(dag[0], InlineBitmap::FromBits({false, true, true, false}));
+  EXPECT_EQ(dag[1], InlineBitmap::FromBits({false, false, true, false}));
+  EXPECT_TRUE(dag[2].IsAllZeroes());
+  EXPECT_EQ(dag[3], InlineBitmap::FromBits({false, true, true, false}));
+
+  // Self-loop on 1 and cycle 2 <-> 3.
+  std::vector<InlineBitmap> cyclic =
+      DenseTransitiveClosure({{1}, {1, 2}, {3}, {2}});
+  EXPECT_EQ(cyclic[0], InlineBitmap::FromBits({false, true, true, true}));
+  EXPECT_EQ(cyclic[1], InlineBitmap::FromBits({false, true, true, true}));
+  EXPECT_EQ(cyclic[2], InlineBitmap::FromBits({false, false, true, true}));
+  EXPECT_EQ(cyclic[3], InlineBitmap::FromBits({false, false, true, true}));
+}
+
+TEST(TransitiveClosureTest, LongChainCrossesWords) {
+  constexpr int64_t kLength = 200;
+  HashRelation<int64_t> rel;
+  for (int64_t i = 0; i + 1 < kLength; ++i) {
+    rel[i].insert(i + 1);
+  }
+  HashRelation<int64_t> tc = TransitiveClosure<int64_t>(rel);
+  EXPECT_EQ(tc.at(0).size(), kLength - 1);
+  EXPECT_EQ(tc.at(100).size(), kLength - 101);
+  EXPECT_TRUE(tc.at(3).contains(kLength - 1));
+  EXPECT_FALSE(tc.at(3).contains(3));
+
+  ReachabilityIndex<int64_t> index(rel);
+  EXPECT_EQ(index.elements().size(), kLength);
+  EXPECT_TRUE(index.Reaches(0, kLength - 1));
+  EXPECT_FALSE(index.Reaches(kLength - 1, 0));
+  EXPECT_FALSE(index.Reaches(5, 5));
+  EXPECT_FALSE(index.Reaches(0, kLength));
+  EXPECT_EQ(index.IndexOf(kLength), -1);
+}
+
+TEST(TransitiveClosureTest, ReachabilityIndex) {
+  HashRelation<V> rel;
+  rel["foo"].insert("bar");
+  rel["bar"].insert("baz");
+  ReachabilityIndex<V> index(rel);
+  EXPECT_THAT(index.elements(), ElementsAre("bar", "baz", "foo"));
+  EXPECT_TRUE(index.Reaches(V("foo"), V("baz")));
+  EXPECT_FALSE(index.Reaches(V("baz"), V("foo")));
+  EXPECT_FALSE(index.Reaches(V("foo"), V("unknown")));
+  EXPECT_TRUE(index.ReachesByIndex(index.IndexOf("foo"), index.IndexOf("bar")));
+}
+
 }  // namespace
 }  // namespace xls
@@ -66,6 +66,7 @@ def delay_model(
             "//xls/common/logging",
             "@com_google_absl//absl/status:statusor",
             "//xls/delay_model:delay_estimator",
+            "//xls/delay_model:delay_lookup_table",
             "//xls/ir",
         ],
         **kwargs
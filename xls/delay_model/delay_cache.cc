@@ -0,0 +1,192 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/delay_model/delay_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/delay_model/delay_model.pb.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/function.h"
+#include "xls/ir/instantiation.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/register.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+// Returns the op-specific attributes of `node` which are not reflected in its
+// type or operands.
+std::vector<std::string> NodeAttributes(Node* node) {
+  switch (node->op()) {
+    case Op::kBitSlice:
+      return {absl::StrCat("start=", node->As<BitSlice>()->start())};
+    case Op::kOneHot:
+      return {absl::StrCat("lsb_prio=", node->As<OneHot>()->priority() ==
+                                                    LsbOrMsb::kLsb
+                                                ? "true"
+                                                : "false")};
+    case Op::kTupleIndex:
+      return {absl::StrCat("index=", node->As<TupleIndex>()->index())};
+    case Op::kInvoke:
+      return {
+          absl::StrCat("to_apply=", node->As<Invoke>()->to_apply()->name())};
+    case Op::kMap:
+      return {absl::StrCat("to_apply=", node->As<Map>()->to_apply()->name())};
+    case Op::kCountedFor:
+      return {absl::StrCat("body=", node->As<CountedFor>()->body()->name()),
+              absl::StrCat("trip_count=", node->As<CountedFor>()->trip_count()),
+              absl::StrCat("stride=", node->As<CountedFor>()->stride())};
+    case Op::kDynamicCountedFor:
+      return {
+          absl::StrCat("body=", node->As<DynamicCountedFor>()->body()->name())};
+    case Op::kMinDelay:
+      return {absl::StrCat("delay=", node->As<MinDelay>()->delay())};
+    case Op::kReceive:
+      return {absl::StrCat("channel_id=", node->As<Receive>()->channel_id()),
+              absl::StrCat("blocking=",
+                           node->As<Receive>()->is_blocking() ? "true"
+                                                              : "false")};
+    case Op::kSend:
+      return {absl::StrCat("channel_id=", node->As<Send>()->channel_id())};
+    case Op::kRegisterRead:
+      return {absl::StrCat("register=",
+                           node->As<RegisterRead>()->GetRegister()->name())};
+    case Op::kRegisterWrite:
+      return {absl::StrCat("register=",
+                           node->As<RegisterWrite>()->GetRegister()->name())};
+    case Op::kInstantiationInput:
+      return {absl::StrCat(
+          "port=", node->As<InstantiationInput>()->instantiation()->name(), ".",
+          node->As<InstantiationInput>()->port_name())};
+    case Op::kInstantiationOutput:
+      return {absl::StrCat(
+          "port=", node->As<InstantiationOutput>()->instantiation()->name(),
+          ".", node->As<InstantiationOutput>()->port_name())};
+    default:
+      return {};
+  }
+}
+
+}  // namespace
+
+std::string NodeDelaySignature(Node* node) {
+  std::vector<std::string> operands;
+  operands.reserve(node->operand_count());
+  for (int64_t i = 0; i < node->operand_count(); ++i) {
+    Node* operand = node->operand(i);
+    std::string signature = operand->GetType()->ToString();
+    // Delay models specialize on identical and literal operands (see
+    // SpecializationKind in delay_model.proto).
+    auto earlier = std::find(node->operands().begin(),
+                             node->operands().begin() + i, operand);
+    if (earlier != node->operands().begin() + i) {
+      absl::StrAppend(&signature, "=#", earlier - node->operands().begin());
+    }
+    if (operand->Is<Literal>()) {
+      const Value& value = operand->As<Literal>()->value();
+      absl::StrAppend(&signature, "=",
+                      value.IsBits() ? value.ToString(FormatPreference::kHex)
+                                     : "literal");
+    }
+    operands.push_back(std::move(signature));
+  }
+  std::string signature =
+      absl::StrCat(OpToString(node->op()), "(", absl::StrJoin(operands, ", "),
+                   ") -> ", node->GetType()->ToString());
+  std::vector<std::string> attributes = NodeAttributes(node);
+  if (!attributes.empty()) {
+    absl::StrAppend(&signature, " [", absl::StrJoin(attributes, ", "), "]");
+  }
+  return signature;
+}
+
+std::optional<int64_t> DelayCache::Get(std::string_view signature) const {
+  absl::ReaderMutexLock lock(&mutex_);
+  auto it = delays_.find(signature);
+  if (it == delays_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void DelayCache::Add(std::string_view signature, int64_t delay) {
+  absl::WriterMutexLock lock(&mutex_);
+  delays_.emplace(signature, delay);
+}
+
+int64_t DelayCache::size() const {
+  absl::ReaderMutexLock lock(&mutex_);
+  return delays_.size();
+}
+
+delay_model::DelayCacheProto DelayCache::ToProto() const {
+  delay_model::DelayCacheProto proto;
+  proto.set_estimator(estimator_);
+  absl::ReaderMutexLock lock(&mutex_);
+  std::vector<std::pair<std::string, int64_t>> entries(delays_.begin(),
+                                                       delays_.end());
+  // Sort for a deterministic file.
+  std::sort(entries.begin(), entries.end());
+  for (const auto& [signature, delay] : entries) {
+    delay_model::DelayCacheProto::Entry* entry = proto.add_entries();
+    entry->set_signature(signature);
+    entry->set_delay_ps(delay);
+  }
+  return proto;
+}
+
+absl::Status DelayCache::Merge(const delay_model::DelayCacheProto& proto) {
+  if (proto.estimator() != estimator_) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Delay cache was produced by estimator `",
+                     proto.estimator(), "`, expected `", estimator_, "`"));
+  }
+  absl::WriterMutexLock lock(&mutex_);
+  for (const delay_model::DelayCacheProto::Entry& entry : proto.entries()) {
+    delays_.emplace(entry.signature(), entry.delay_ps());
+  }
+  return absl::OkStatus();
+}
+
+absl::Status DelayCache::Load(const std::filesystem::path& path) {
+  if (absl::IsNotFound(FileExists(path))) {
+    return absl::OkStatus();
+  }
+  delay_model::DelayCacheProto proto;
+  XLS_RETURN_IF_ERROR(ParseTextProtoFile(path, &proto));
+  return Merge(proto);
+}
+
+absl::Status DelayCache::Save(const std::filesystem::path& path) const {
+  return SetTextProtoFile(path, ToProto());
+}
+
+}  // namespace xls
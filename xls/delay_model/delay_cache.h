@@ -0,0 +1,80 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DELAY_MODEL_DELAY_CACHE_H_
+#define XLS_DELAY_MODEL_DELAY_CACHE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/delay_model/delay_model.pb.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// Returns a string identifying the properties of `node` which determine its
+// delay: the op, the result and operand types, which operands are literals (and
+// their values) or repeat an earlier operand, and op-specific attributes such
+// as a bit slice's start or an invoked function's name. Two nodes with the
+// same signature have the same delay under any of the XLS delay estimators, so
+// delays can be memoized on it across functions, after cloning, and across
+// processes.
+std::string NodeDelaySignature(Node* node);
+
+// A table of operation delays keyed on NodeDelaySignature, produced by the
+// delay estimator named `estimator`. Used by CachingDelayEstimator; a single
+// cache may be shared by any number of estimators and functions, and may be
+// saved to disk and reloaded so that expensive estimates (e.g., from a
+// synthesis tool) persist across runs. This class is safe for concurrent
+// access.
+class DelayCache {
+ public:
+  explicit DelayCache(std::string estimator)
+      : estimator_(std::move(estimator)) {}
+
+  const std::string& estimator() const { return estimator_; }
+
+  std::optional<int64_t> Get(std::string_view signature) const;
+  void Add(std::string_view signature, int64_t delay);
+  int64_t size() const;
+
+  delay_model::DelayCacheProto ToProto() const;
+
+  // Adds the entries of `proto` to the cache. Returns an error if the delays in
+  // `proto` come from a different estimator.
+  absl::Status Merge(const delay_model::DelayCacheProto& proto);
+
+  // Merges the cache saved at `path`, if the file exists.
+  absl::Status Load(const std::filesystem::path& path);
+
+  // Saves the cache to `path` as a text proto.
+  absl::Status Save(const std::filesystem::path& path) const;
+
+ private:
+  const std::string estimator_;
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, int64_t> delays_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_DELAY_MODEL_DELAY_CACHE_H_
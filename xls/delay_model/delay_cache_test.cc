@@ -0,0 +1,103 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/delay_model/delay_cache.h"
+
+#include <filesystem>  // NOLINT
+#include <optional>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/delay_model/delay_model.pb.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::Eq;
+using ::testing::HasSubstr;
+using ::testing::Not;
+using ::testing::Optional;
+
+class DelayCacheTest : public IrTestBase {};
+
+TEST_F(DelayCacheTest, NodeDelaySignature) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue z = fb.Param("z", p->GetBitsType(16));
+  BValue add_xy = fb.Add(x, y);
+  BValue add_yx = fb.Add(y, x);
+  BValue add_xx = fb.Add(x, x);
+  BValue add_x1 = fb.Add(x, fb.Literal(UBits(1, 8)));
+  BValue add_x2 = fb.Add(x, fb.Literal(UBits(2, 8)));
+  BValue add_zz = fb.Add(z, fb.Param("w", p->GetBitsType(16)));
+  BValue slice_0 = fb.BitSlice(z, 0, 8);
+  BValue slice_8 = fb.BitSlice(z, 8, 8);
+  XLS_ASSERT_OK(fb.Build().status());
+
+  EXPECT_EQ(NodeDelaySignature(add_xy.node()),
+            NodeDelaySignature(add_yx.node()));
+  EXPECT_EQ(NodeDelaySignature(add_xy.node()),
+            "add(bits[8], bits[8]) -> bits[8]");
+  EXPECT_EQ(NodeDelaySignature(add_xx.node()),
+            "add(bits[8], bits[8]=#0) -> bits[8]");
+  EXPECT_NE(NodeDelaySignature(add_x1.node()),
+            NodeDelaySignature(add_x2.node()));
+  EXPECT_NE(NodeDelaySignature(add_x1.node()),
+            NodeDelaySignature(add_xy.node()));
+  EXPECT_NE(NodeDelaySignature(add_zz.node()),
+            NodeDelaySignature(add_xy.node()));
+  EXPECT_NE(NodeDelaySignature(slice_0.node()),
+            NodeDelaySignature(slice_8.node()));
+  EXPECT_THAT(NodeDelaySignature(slice_8.node()), HasSubstr("start=8"));
+}
+
+TEST_F(DelayCacheTest, SaveAndLoad) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "delays.textproto";
+
+  DelayCache cache("unit");
+  // Loading a missing file leaves the cache empty.
+  XLS_ASSERT_OK(cache.Load(path));
+  EXPECT_EQ(cache.size(), 0);
+  cache.Add("add(bits[8], bits[8]) -> bits[8]", 42);
+  cache.Add("not(bits[1]) -> bits[1]", 1);
+  EXPECT_THAT(cache.Get("not(bits[1]) -> bits[1]"), Optional(Eq(1)));
+  EXPECT_EQ(cache.Get("neg(bits[1]) -> bits[1]"), std::nullopt);
+  XLS_ASSERT_OK(cache.Save(path));
+
+  DelayCache loaded("unit");
+  XLS_ASSERT_OK(loaded.Load(path));
+  EXPECT_EQ(loaded.size(), 2);
+  EXPECT_THAT(loaded.Get("add(bits[8], bits[8]) -> bits[8]"),
+              Optional(Eq(42)));
+
+  DelayCache other_estimator("sky130");
+  EXPECT_THAT(other_estimator.Load(path),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("produced by estimator `unit`")));
+  EXPECT_THAT(other_estimator.Get("not(bits[1]) -> bits[1]"),
+              Not(Optional(Eq(1))));
+}
+
+}  // namespace
+}  // namespace xls
@@ -19,17 +19,22 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <numeric>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/delay_model/delay_cache.h"
 #include "xls/ir/node.h"
 #include "xls/ir/op.h"
 #include "xls/netlist/cell_library.h"
@@ -182,6 +187,19 @@ absl::StatusOr<int64_t> DecoratingDelayEstimator::GetOperationDelayInPs(
   return modifier_(node, original);
 }
 
+std::vector<absl::StatusOr<int64_t>>
+DecoratingDelayEstimator::GetOperationDelaysInPs(
+    absl::Span<Node* const> nodes) const {
+  std::vector<absl::StatusOr<int64_t>> results =
+      decorated_.GetOperationDelaysInPs(nodes);
+  for (int64_t i = 0; i < nodes.size(); ++i) {
+    if (results[i].ok()) {
+      results[i] = modifier_(nodes[i], *results[i]);
+    }
+  }
+  return results;
+}
+
 FirstMatchDelayEstimator::FirstMatchDelayEstimator(
     std::string_view name, std::vector<const DelayEstimator*> estimators)
     : DelayEstimator(name), estimators_(std::move(estimators)) {}
@@ -198,12 +216,54 @@ absl::StatusOr<int64_t> FirstMatchDelayEstimator::GetOperationDelayInPs(
   return result;
 }
 
+std::vector<absl::StatusOr<int64_t>>
+FirstMatchDelayEstimator::GetOperationDelaysInPs(
+    absl::Span<Node* const> nodes) const {
+  std::vector<absl::StatusOr<int64_t>> results(nodes.size());
+  // Indices into `nodes` of the nodes not yet estimated.
+  std::vector<int64_t> pending(nodes.size());
+  std::iota(pending.begin(), pending.end(), 0);
+  for (const DelayEstimator* estimator : estimators_) {
+    if (pending.empty()) {
+      break;
+    }
+    std::vector<Node*> batch;
+    batch.reserve(pending.size());
+    for (int64_t i : pending) {
+      batch.push_back(nodes[i]);
+    }
+    std::vector<absl::StatusOr<int64_t>> batch_results =
+        estimator->GetOperationDelaysInPs(batch);
+    std::vector<int64_t> still_pending;
+    for (int64_t j = 0; j < pending.size(); ++j) {
+      if (!batch_results[j].ok()) {
+        still_pending.push_back(pending[j]);
+      }
+      results[pending[j]] = std::move(batch_results[j]);
+    }
+    pending = std::move(still_pending);
+  }
+  return results;
+}
+
 CachingDelayEstimator::CachingDelayEstimator(std::string_view name,
-                                             const DelayEstimator& cached)
-    : DelayEstimator(name), cached_(cached) {}
+                                             const DelayEstimator& cached,
+                                             DelayCache* signature_cache)
+    : DelayEstimator(name),
+      cached_(cached),
+      signature_cache_(signature_cache) {}
 
 absl::StatusOr<int64_t> CachingDelayEstimator::GetOperationDelayInPs(
     Node* node) const {
+  if (signature_cache_ != nullptr) {
+    std::string signature = NodeDelaySignature(node);
+    if (std::optional<int64_t> delay = signature_cache_->Get(signature)) {
+      return *delay;
+    }
+    XLS_ASSIGN_OR_RETURN(int64_t delay, cached_.GetOperationDelayInPs(node));
+    signature_cache_->Add(signature, delay);
+    return delay;
+  }
   if (ContainsNodeDelay(node)) {
     return GetNodeDelay(node);
   }
@@ -213,6 +273,75 @@ absl::StatusOr<int64_t> CachingDelayEstimator::GetOperationDelayInPs(
   return delay;
 }
 
+std::vector<absl::StatusOr<int64_t>>
+CachingDelayEstimator::GetOperationDelaysInPs(
+    absl::Span<Node* const> nodes) const {
+  std::vector<absl::StatusOr<int64_t>> results(nodes.size());
+  // The nodes to pass to the underlying estimator, one per distinct key, and
+  // for each the indices into `nodes` sharing its estimate.
+  std::vector<Node*> misses;
+  std::vector<std::vector<int64_t>> miss_indices;
+  std::vector<std::string> miss_signatures;
+  absl::flat_hash_map<std::string, int64_t> signature_to_miss;
+  absl::flat_hash_map<Node*, int64_t> node_to_miss;
+  for (int64_t i = 0; i < nodes.size(); ++i) {
+    Node* node = nodes[i];
+    int64_t miss_index = misses.size();
+    if (signature_cache_ != nullptr) {
+      std::string signature = NodeDelaySignature(node);
+      if (std::optional<int64_t> delay = signature_cache_->Get(signature)) {
+        results[i] = *delay;
+        continue;
+      }
+      auto [it, added] = signature_to_miss.try_emplace(signature, miss_index);
+      if (added) {
+        miss_signatures.push_back(std::move(signature));
+      }
+      miss_index = it->second;
+    } else {
+      if (ContainsNodeDelay(node)) {
+        results[i] = GetNodeDelay(node);
+        continue;
+      }
+      miss_index = node_to_miss.try_emplace(node, miss_index).first->second;
+    }
+    if (miss_index == misses.size()) {
+      misses.push_back(node);
+      miss_indices.emplace_back();
+    }
+    miss_indices[miss_index].push_back(i);
+  }
+  if (misses.empty()) {
+    return results;
+  }
+
+  std::vector<absl::StatusOr<int64_t>> miss_results =
+      cached_.GetOperationDelaysInPs(misses);
+  for (int64_t m = 0; m < misses.size(); ++m) {
+    if (miss_results[m].ok()) {
+      if (signature_cache_ != nullptr) {
+        signature_cache_->Add(miss_signatures[m], *miss_results[m]);
+      } else {
+        AddNodeDelay(misses[m], *miss_results[m]);
+      }
+    }
+    for (int64_t i : miss_indices[m]) {
+      results[i] = miss_results[m];
+    }
+  }
+  return results;
+}
+
+std::vector<absl::StatusOr<int64_t>> DelayEstimator::GetOperationDelaysInPs(
+    absl::Span<Node* const> nodes) const {
+  std::vector<absl::StatusOr<int64_t>> results;
+  results.reserve(nodes.size());
+  for (Node* node : nodes) {
+    results.push_back(GetOperationDelayInPs(node));
+  }
+  return results;
+}
+
 /* static */ absl::StatusOr<int64_t> DelayEstimator::GetLogicalEffortDelayInPs(
     Node* node, int64_t tau_in_ps) {
   XLS_ASSIGN_OR_RETURN(int64_t delay_in_tau, GetLogicalEffortDelayInTau(node));
@@ -30,6 +30,7 @@
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/test_macros.h"
+#include "xls/delay_model/delay_cache.h"
 #include "xls/ir/node.h"
 
 namespace xls {
@@ -45,6 +46,14 @@ class DelayEstimator {
   // Returns the estimated delay of the given node in picoseconds.
   virtual absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const = 0;
 
+  // Returns the estimated delays of the given nodes in picoseconds, in the
+  // same order, each with its own status. The default implementation calls
+  // GetOperationDelayInPs() once per node; estimators with a high per-call
+  // cost (e.g., ones calling out to an external model) should override this
+  // to answer the whole batch at once.
+  virtual std::vector<absl::StatusOr<int64_t>> GetOperationDelaysInPs(
+      absl::Span<Node* const> nodes) const;
+
   // Compute the delay of the given node using logical effort estimation. Only
   // relatively simple operations (kAnd, kOr, etc) are supported using this
   // method.
@@ -65,6 +74,8 @@ class DecoratingDelayEstimator : public DelayEstimator {
   ~DecoratingDelayEstimator() override = default;
 
   absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override;
+  std::vector<absl::StatusOr<int64_t>> GetOperationDelaysInPs(
+      absl::Span<Node* const> nodes) const override;
 
  private:
   const DelayEstimator& decorated_;
@@ -84,20 +95,37 @@ class FirstMatchDelayEstimator : public DelayEstimator {
   // is returned.
   absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const final;
 
+  // Passes the whole batch to the first estimator, the nodes it could not
+  // estimate to the second, and so on.
+  std::vector<absl::StatusOr<int64_t>> GetOperationDelaysInPs(
+      absl::Span<Node* const> nodes) const final;
+
  private:
   const std::vector<const DelayEstimator*> estimators_;
 };
 
 // Cache the delay of an underlying delay estimator. This class is safe for
 // concurrent access.
+//
+// By default delays are cached per Node*. If a `signature_cache` is given,
+// delays are instead memoized in it keyed on NodeDelaySignature, so estimates
+// are reused across functions, cloned nodes, and every other estimator sharing
+// the cache; the signature cache must outlive this estimator, and is not
+// susceptible to stale entries when nodes are removed from the IR.
 class CachingDelayEstimator : public DelayEstimator {
  public:
-  CachingDelayEstimator(std::string_view name, const DelayEstimator& cached);
+  CachingDelayEstimator(std::string_view name, const DelayEstimator& cached,
+                        DelayCache* signature_cache = nullptr);
 
   ~CachingDelayEstimator() override = default;
 
   absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override;
 
+  // Passes the nodes missing from the cache to the underlying estimator as a
+  // single batch. Nodes with the same signature are only estimated once.
+  std::vector<absl::StatusOr<int64_t>> GetOperationDelaysInPs(
+      absl::Span<Node* const> nodes) const override;
+
  private:
   bool ContainsNodeDelay(Node* node) const {
     absl::ReaderMutexLock lock(&cache_mutex_);
@@ -117,6 +145,7 @@ class CachingDelayEstimator : public DelayEstimator {
   XLS_FRIEND_TEST(DelayEstimatorTest, CachingDelayEstimator);
 
   const DelayEstimator& cached_;
+  DelayCache* const signature_cache_;
   mutable absl::Mutex cache_mutex_;
   mutable absl::flat_hash_map<Node*, int64_t> cache_
       ABSL_GUARDED_BY(cache_mutex_);
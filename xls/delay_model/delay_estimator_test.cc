@@ -23,7 +23,9 @@
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
+#include "xls/delay_model/delay_cache.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
@@ -150,6 +152,116 @@ TEST_F(DelayEstimatorTest, CachingDelayEstimator) {
   EXPECT_THAT(caching.GetNodeDelay(f->return_value()), 1);
 }
 
+// A delay estimator returning the bit count of the node, which counts how many
+// times it was queried.
+class CountingDelayEstimator : public DelayEstimator {
+ public:
+  CountingDelayEstimator() : DelayEstimator("counting") {}
+
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override {
+    ++query_count_;
+    return node->GetType()->GetFlatBitCount();
+  }
+
+  int64_t query_count() const { return query_count_; }
+
+ private:
+  mutable int64_t query_count_ = 0;
+};
+
+TEST_F(DelayEstimatorTest, CachingDelayEstimatorWithSignatureCache) {
+  auto p = CreatePackage();
+  std::vector<Node*> adds;
+  for (std::string_view name : {"f", "g"}) {
+    FunctionBuilder fb(name, p.get());
+    BValue x = fb.Param("x", p->GetBitsType(8));
+    BValue y = fb.Param("y", p->GetBitsType(8));
+    BValue add = fb.Add(x, y);
+    adds.push_back(add.node());
+    adds.push_back(fb.Add(fb.ZeroExtend(x, 16), fb.ZeroExtend(y, 16)).node());
+    XLS_ASSERT_OK(fb.Build().status());
+  }
+  CountingDelayEstimator counting;
+  DelayCache cache("counting");
+  CachingDelayEstimator caching("caching", counting, &cache);
+  for (Node* add : adds) {
+    EXPECT_THAT(caching.GetOperationDelayInPs(add),
+                IsOkAndHolds(add->GetType()->GetFlatBitCount()));
+  }
+  // The adds of the same width in `f` and `g` share an estimate.
+  EXPECT_EQ(counting.query_count(), 2);
+  EXPECT_EQ(cache.size(), 2);
+
+  // A second estimator sharing the cache reuses its estimates.
+  CachingDelayEstimator other("other", counting, &cache);
+  EXPECT_THAT(other.GetOperationDelayInPs(adds[0]), IsOkAndHolds(8));
+  EXPECT_EQ(counting.query_count(), 2);
+}
+
+// A delay estimator handling only additions, returning their bit count, which
+// records the batches it is queried with.
+class BatchRecordingDelayEstimator : public DelayEstimator {
+ public:
+  BatchRecordingDelayEstimator() : DelayEstimator("batch_recording") {}
+
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override {
+    return GetOperationDelaysInPs({node}).front();
+  }
+
+  std::vector<absl::StatusOr<int64_t>> GetOperationDelaysInPs(
+      absl::Span<Node* const> nodes) const override {
+    batch_sizes_.push_back(nodes.size());
+    std::vector<absl::StatusOr<int64_t>> results;
+    for (Node* node : nodes) {
+      if (node->op() == Op::kAdd) {
+        results.push_back(node->GetType()->GetFlatBitCount());
+      } else {
+        results.push_back(absl::UnimplementedError("not an add"));
+      }
+    }
+    return results;
+  }
+
+  const std::vector<int64_t>& batch_sizes() const { return batch_sizes_; }
+
+ private:
+  mutable std::vector<int64_t> batch_sizes_;
+};
+
+TEST_F(DelayEstimatorTest, BatchedCachingAndFirstMatch) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue add0 = fb.Add(x, y);
+  BValue add1 = fb.Add(y, x);
+  BValue add2 = fb.Add(fb.ZeroExtend(x, 16), fb.ZeroExtend(y, 16));
+  XLS_ASSERT_OK(fb.Build().status());
+
+  BatchRecordingDelayEstimator adds;
+  FakeDelayEstimator fallback(1, "fallback");
+  FirstMatchDelayEstimator first_match("first_match", {&adds, &fallback});
+  DelayCache cache("batched");
+  CachingDelayEstimator caching("caching", first_match, &cache);
+
+  std::vector<Node*> nodes = {x.node(), add0.node(), add1.node(),
+                              add2.node()};
+  std::vector<absl::StatusOr<int64_t>> delays =
+      caching.GetOperationDelaysInPs(nodes);
+  ASSERT_EQ(delays.size(), 4);
+  EXPECT_THAT(delays[0], IsOkAndHolds(1));
+  EXPECT_THAT(delays[1], IsOkAndHolds(8));
+  EXPECT_THAT(delays[2], IsOkAndHolds(8));
+  EXPECT_THAT(delays[3], IsOkAndHolds(16));
+  // The two 8-bit adds share a signature, so one batch of three distinct
+  // signatures reaches the estimator.
+  EXPECT_THAT(adds.batch_sizes(), ElementsAre(3));
+
+  // Everything is cached now.
+  caching.GetOperationDelaysInPs(nodes);
+  EXPECT_THAT(adds.batch_sizes(), ElementsAre(3));
+}
+
 // A Delay Estimator that can only handle one kind of operation.
 class TestNodeMatchEstimator : public DelayEstimator {
  public:
@@ -20,12 +20,12 @@
 #include <string>
 #include <vector>
 
-#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/node.h"
+#include "xls/ir/node_map.h"
 
 namespace xls {
 namespace sched {
@@ -211,10 +211,10 @@ class DelayHeap {
   const DelayEstimator& delay_estimator_;
 
   // A map from node in the heap to the longest path length value for the node.
-  absl::flat_hash_map<Node*, PathLength> path_lengths_;
+  NodeMap<PathLength> path_lengths_;
 
   // A cache containing vectors with the users of each node.
-  mutable absl::flat_hash_map<Node*, std::vector<Node*>> users_vectors_;
+  mutable NodeMap<std::vector<Node*>> users_vectors_;
 };
 
 }  // namespace sched
@@ -0,0 +1,55 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DELAY_MODEL_DELAY_LOOKUP_TABLE_H_
+#define XLS_DELAY_MODEL_DELAY_LOOKUP_TABLE_H_
+
+#include <array>
+#include <cstdint>
+
+namespace xls {
+
+// Delays of a delay model formula over a single integral delay factor (e.g.,
+// the result bit count or the number of operands) precomputed for all factor
+// values up to kMaxFactor. Generated delay models use these for regression
+// estimators of one factor so that the common case of a delay query is an array
+// index rather than an evaluation of the fitted curve; factor values beyond the
+// table fall back to the formula.
+class DelayLookupTable {
+ public:
+  static constexpr int64_t kMaxFactor = 1024;
+
+  using Formula = int64_t (*)(int64_t factor);
+
+  explicit DelayLookupTable(Formula formula) : formula_(formula) {
+    for (int64_t i = 0; i <= kMaxFactor; ++i) {
+      table_[i] = formula_(i);
+    }
+  }
+
+  int64_t Lookup(int64_t factor) const {
+    if (factor >= 0 && factor <= kMaxFactor) {
+      return table_[factor];
+    }
+    return formula_(factor);
+  }
+
+ private:
+  Formula formula_;
+  std::array<int64_t, kMaxFactor + 1> table_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_DELAY_MODEL_DELAY_LOOKUP_TABLE_H_
@@ -0,0 +1,55 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/delay_model/delay_lookup_table.h"
+
+#include <cmath>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+namespace xls {
+namespace {
+
+int64_t Formula(int64_t factor) {
+  float x = static_cast<float>(factor);
+  return std::round(3.5 + 1.25 * x + 7.0 * std::log2(x < 1.0 ? 1.0 : x));
+}
+
+TEST(DelayLookupTableTest, MatchesFormula) {
+  DelayLookupTable table(Formula);
+  for (int64_t factor :
+       {int64_t{0}, int64_t{1}, int64_t{2}, int64_t{31}, int64_t{64},
+        DelayLookupTable::kMaxFactor - 1, DelayLookupTable::kMaxFactor,
+        DelayLookupTable::kMaxFactor + 1, int64_t{100000}}) {
+    EXPECT_EQ(table.Lookup(factor), Formula(factor)) << factor;
+  }
+}
+
+TEST(DelayLookupTableTest, FormulaOnlyEvaluatedBeyondTable) {
+  static int64_t evaluations = 0;
+  DelayLookupTable table([](int64_t factor) -> int64_t {
+    ++evaluations;
+    return 2 * factor;
+  });
+  EXPECT_EQ(evaluations, DelayLookupTable::kMaxFactor + 1);
+  EXPECT_EQ(table.Lookup(10), 20);
+  EXPECT_EQ(evaluations, DelayLookupTable::kMaxFactor + 1);
+  EXPECT_EQ(table.Lookup(DelayLookupTable::kMaxFactor + 5),
+            2 * (DelayLookupTable::kMaxFactor + 5));
+  EXPECT_EQ(evaluations, DelayLookupTable::kMaxFactor + 2);
+}
+
+}  // namespace
+}  // namespace xls
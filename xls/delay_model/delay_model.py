@@ -24,7 +24,7 @@ import abc
 import dataclasses
 import random
 
-from typing import Sequence, List, Tuple, Callable
+from typing import Sequence, List, Optional, Tuple, Callable
 
 import numpy as np
 from scipy import optimize as opt
@@ -242,13 +242,18 @@ def _delay_factor_cpp_expression(factor: delay_model_pb2.DelayFactor,
 
 
 def _delay_expression_cpp_expression(
-    expression: delay_model_pb2.DelayExpression, node_identifier: str) -> str:
+    expression: delay_model_pb2.DelayExpression,
+    node_identifier: str,
+    factor_identifier: Optional[str] = None) -> str:
   """Returns a C++ expression which computes a delay expression of an XLS Node*.
 
   Args:
     expression: The delay expression to extract.
     node_identifier: The identifier of the xls::Node* to extract the factor
       from.
+    factor_identifier: If given, the identifier of an int64_t holding the value
+      of the (single) delay factor of the expression. Used in place of
+      extracting the factor from the node.
 
   Returns:
     C++ expression computing the delay expression of a node.
@@ -257,9 +262,11 @@ def _delay_expression_cpp_expression(
     assert expression.HasField('lhs_expression')
     assert expression.HasField('rhs_expression')
     lhs_value = _delay_expression_cpp_expression(expression.lhs_expression,
-                                                 node_identifier)
+                                                 node_identifier,
+                                                 factor_identifier)
     rhs_value = _delay_expression_cpp_expression(expression.rhs_expression,
-                                                 node_identifier)
+                                                 node_identifier,
+                                                 factor_identifier)
     e = delay_model_pb2.DelayExpression.BinaryOperation
     return {
         e.ADD:
@@ -280,6 +287,8 @@ def _delay_expression_cpp_expression(
     }[expression.bin_op]()
 
   if expression.HasField('factor'):
+    if factor_identifier is not None:
+      return 'static_cast<float>({})'.format(factor_identifier)
     return 'static_cast<float>({})'.format(
         _delay_factor_cpp_expression(expression.factor, node_identifier))
 
@@ -287,6 +296,21 @@ def _delay_expression_cpp_expression(
   return 'static_cast<float>({})'.format(expression.constant)
 
 
+def _delay_expression_factors(
+    expression: delay_model_pb2.DelayExpression
+) -> List[delay_model_pb2.DelayFactor]:
+  """Returns the distinct delay factors referenced by a delay expression."""
+  if expression.HasField('bin_op'):
+    factors = _delay_expression_factors(expression.lhs_expression)
+    for factor in _delay_expression_factors(expression.rhs_expression):
+      if factor not in factors:
+        factors.append(factor)
+    return factors
+  if expression.HasField('factor'):
+    return [expression.factor]
+  return []
+
+
 class RegressionEstimator(Estimator):
   """An estimator which uses curve fitting of measured data points.
 
@@ -502,14 +526,56 @@ class RegressionEstimator(Estimator):
     """Returns the delay with delay expressions passed in as floats."""
     return self.delay_function(xargs)
 
-  def cpp_delay_code(self, node_identifier: str) -> str:
+  def _cpp_delay_expression(self,
+                            node_identifier: str,
+                            factor_identifier: Optional[str] = None) -> str:
     terms = [repr(self.params[0])]
     for i, expression in enumerate(self.delay_expressions):
-      e_str = _delay_expression_cpp_expression(expression, node_identifier)
+      e_str = _delay_expression_cpp_expression(expression, node_identifier,
+                                               factor_identifier)
       terms.append('{!r} * {}'.format(self.params[2 * i + 1], e_str))
       terms.append('{w!r} * std::log2({e} < 1.0 ? 1.0 : {e})'.format(
           w=self.params[2 * i + 2], e=e_str))
-    return 'return std::round({});'.format(' + '.join(terms))
+    return 'std::round({})'.format(' + '.join(terms))
+
+  def cpp_delay_code(self, node_identifier: str) -> str:
+    return 'return {};'.format(self._cpp_delay_expression(node_identifier))
+
+  def lookup_factor(self) -> Optional[delay_model_pb2.DelayFactor]:
+    """Returns the delay factor to tabulate the delay over, if any.
+
+    Delays of estimators whose expressions all depend on the same single delay
+    factor can be precomputed by the generated code in a DelayLookupTable
+    indexed by the value of that factor.
+    """
+    factors = []
+    for expression in self.delay_expressions:
+      for factor in _delay_expression_factors(expression):
+        if factor not in factors:
+          factors.append(factor)
+    return factors[0] if len(factors) == 1 else None
+
+  def cpp_lookup_delay_code(self, node_identifier: str) -> str:
+    """Returns C++ statements which compute the delay via a lookup table.
+
+    The table is built on the first query from the fitted curve, which is also
+    used directly for factor values beyond the table.
+
+    Args:
+      node_identifier: The string identifier of the Node* value whose delay is
+        being estimated.
+    """
+    factor = self.lookup_factor()
+    assert factor is not None
+    lines = []
+    lines.append('static const DelayLookupTable* table = new DelayLookupTable(')
+    lines.append('[](int64_t factor) -> int64_t {')
+    lines.append('return {};'.format(
+        self._cpp_delay_expression(node_identifier, 'factor')))
+    lines.append('});')
+    lines.append('return table->Lookup({});'.format(
+        _delay_factor_cpp_expression(factor, node_identifier)))
+    return '\n'.join(lines)
 
 
 class BoundingBoxEstimator(Estimator):
@@ -618,6 +684,15 @@ def _estimator_from_proto(op: str, proto: delay_model_pb2.Estimator,
   return LogicalEffortEstimator(op, proto.logical_effort.tau_in_ps)
 
 
+def _estimator_cpp_delay_code(estimator: Estimator,
+                              node_identifier: str) -> str:
+  """Returns the C++ delay code of an estimator, using a lookup if possible."""
+  if (isinstance(estimator, RegressionEstimator) and
+      estimator.lookup_factor() is not None):
+    return estimator.cpp_lookup_delay_code(node_identifier)
+  return estimator.cpp_delay_code(node_identifier)
+
+
 class OpModel:
   """Delay model for a single XLS op (e.g., kAdd).
 
@@ -663,9 +738,9 @@ class OpModel:
       else:
         raise NotImplementedError
       lines.append('if (%s) {' % cond)
-      lines.append(estimator.cpp_delay_code('node'))
+      lines.append(_estimator_cpp_delay_code(estimator, 'node'))
       lines.append('}')
-    lines.append(self.estimator.cpp_delay_code('node'))
+    lines.append(_estimator_cpp_delay_code(self.estimator, 'node'))
     lines.append('}')
     return '\n'.join(lines)
 
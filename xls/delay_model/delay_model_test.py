@@ -812,16 +812,56 @@ class DelayModelTest(absltest.TestCase):
                 "Unhandled node for delay estimation: " +
                 node->ToStringWithOperandTypes());
             }
-            return std::round(
-                0.0 + 0.0 * static_cast<float>(node->GetType()->GetFlatBitCount()) +
-                0.0 * std::log2(
-                  static_cast<float>(node->GetType()->GetFlatBitCount()) < 1.0 ?
-                   1.0 :
-                  static_cast<float>(node->GetType()->GetFlatBitCount())
-                ));
+            static const DelayLookupTable* table = new DelayLookupTable(
+              [](int64_t factor) -> int64_t {
+                return std::round(
+                  0.0 + 0.0 * static_cast<float>(factor) +
+                  0.0 * std::log2(
+                    static_cast<float>(factor) < 1.0 ?
+                     1.0 : static_cast<float>(factor)));
+              });
+            return table->Lookup(node->GetType()->GetFlatBitCount());
           }
         """)
 
+  def test_regression_op_model_lookup_table(self):
+
+    def gen_data_point(result_bit_count, operand_bit_count, delay):
+      return _parse_data_point(
+          'operation { op: "kFoo" bit_count: %d operands { bit_count: %d } }'
+          ' delay: %d delay_offset: 0' %
+          (result_bit_count, operand_bit_count, delay))
+
+    data_points = [gen_data_point(bc, bc, 10 * bc) for bc in range(1, 10)]
+    # A single factor referenced from several expressions is tabulated.
+    one_factor_model = delay_model.OpModel(
+        text_format.Parse(
+            'op: "kFoo" estimator { regression { '
+            'expressions { factor { source: OPERAND_BIT_COUNT } } '
+            'expressions { bin_op: MULTIPLY '
+            'lhs_expression { factor { source: OPERAND_BIT_COUNT } } '
+            'rhs_expression { factor { source: OPERAND_BIT_COUNT } } } } }',
+            delay_model_pb2.OpModel()),
+        data_points)
+    self.assertIsNotNone(one_factor_model.estimator.lookup_factor())
+    self.assertIn(
+        'return table->Lookup(node->operand(0)->GetType()->GetFlatBitCount());',
+        one_factor_model.cpp_delay_function())
+    self.assertNotIn('node->operand(0)->GetType()->GetFlatBitCount() <',
+                     one_factor_model.cpp_delay_function())
+
+    # Two distinct factors are evaluated directly from the curve.
+    two_factor_model = delay_model.OpModel(
+        text_format.Parse(
+            'op: "kFoo" estimator { regression { '
+            'expressions { factor { source: RESULT_BIT_COUNT } } '
+            'expressions { factor { source: OPERAND_BIT_COUNT } } } }',
+            delay_model_pb2.OpModel()),
+        data_points)
+    self.assertIsNone(two_factor_model.estimator.lookup_factor())
+    self.assertNotIn('DelayLookupTable',
+                     two_factor_model.cpp_delay_function())
+
   def test_regression_estimator_generate_validation_sets(self):
 
     def gen_raw_dp(*a):
@@ -15,23 +15,79 @@
 #include "xls/delay_model/ffi_delay_estimator.h"
 
 #include <cstdint>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/ir/function.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 
 namespace xls {
 absl::StatusOr<int64_t> FfiDelayEstimator::GetOperationDelayInPs(
     Node* node) const {
-  if (node->op() != Op::kInvoke) {
-    return absl::UnimplementedError("FFI delay estimate only for kInvoke");
+  return GetOperationDelaysInPs({node}).front();
+}
+
+std::vector<absl::StatusOr<int64_t>> FfiDelayEstimator::GetOperationDelaysInPs(
+    absl::Span<Node* const> nodes) const {
+  std::vector<absl::StatusOr<int64_t>> results(
+      nodes.size(),
+      absl::UnimplementedError("FFI delay estimate only for kInvoke"));
+  std::vector<int64_t> invoke_indices;
+  for (int64_t i = 0; i < nodes.size(); ++i) {
+    if (nodes[i]->op() == Op::kInvoke) {
+      invoke_indices.push_back(i);
+    }
+  }
+  if (invoke_indices.empty()) {
+    return results;
   }
-  if (!fallback_delay_estimate_.has_value()) {
-    return absl::NotFoundError("No --ffi_fallback_delay_ps provided.");
+
+  if (!batch_estimator_) {
+    absl::StatusOr<int64_t> fallback =
+        absl::NotFoundError("No --ffi_fallback_delay_ps provided.");
+    if (fallback_delay_estimate_.has_value()) {
+      fallback = *fallback_delay_estimate_;
+    }
+    for (int64_t i : invoke_indices) {
+      results[i] = fallback;
+    }
+    return results;
+  }
+
+  std::vector<FfiOpDescriptor> descriptors;
+  descriptors.reserve(invoke_indices.size());
+  for (int64_t i : invoke_indices) {
+    descriptors.push_back(GetOpDescriptor(nodes[i]));
+  }
+  absl::StatusOr<std::vector<int64_t>> delays = batch_estimator_(descriptors);
+  if (delays.ok() && delays->size() != descriptors.size()) {
+    delays = absl::InternalError(absl::StrFormat(
+        "FFI batch delay estimator returned %d delays for %d invocations",
+        delays->size(), descriptors.size()));
+  }
+  for (int64_t j = 0; j < invoke_indices.size(); ++j) {
+    if (delays.ok()) {
+      results[invoke_indices[j]] = (*delays)[j];
+    } else {
+      results[invoke_indices[j]] = delays.status();
+    }
+  }
+  return results;
+}
+
+/* static */ FfiOpDescriptor FfiDelayEstimator::GetOpDescriptor(
+    Node* invoke) {
+  FfiOpDescriptor descriptor;
+  descriptor.function_name = invoke->As<Invoke>()->to_apply()->name();
+  for (Node* operand : invoke->operands()) {
+    descriptor.operand_bit_counts.push_back(
+        operand->GetType()->GetFlatBitCount());
   }
-  // TODO(hzeller): 2023-07-11: Here, extract function name and operands
-  // and read best estimation from a file needs to be provided/generated by the
-  // user.
-  return *fallback_delay_estimate_;
+  descriptor.result_bit_count = invoke->GetType()->GetFlatBitCount();
+  return descriptor;
 }
 }  // namespace xls
@@ -16,14 +16,28 @@
 #define XLS_DELAY_MODEL_FFI_DELAY_ESTIMATOR_H_
 
 #include <cstdint>
+#include <functional>
 #include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/node.h"
 
 namespace xls {
 
+// Description of an Op::kInvoke node handed to an external delay model.
+struct FfiOpDescriptor {
+  // Name of the invoked function.
+  std::string function_name;
+  // Flattened bit counts of the operands and of the result.
+  std::vector<int64_t> operand_bit_counts;
+  int64_t result_bit_count;
+};
+
 // Delay estimator for foreign function calls.
 // This delay estimator _only_ handles Op::kInvoke calls.
 //
@@ -32,16 +46,37 @@ namespace xls {
 // at runtime from some e.g. protobuffer
 class FfiDelayEstimator : public DelayEstimator {
  public:
-  explicit FfiDelayEstimator(std::optional<int64_t> fallback_delay_estimate)
+  // Estimates the delays of a batch of invocations, returning one delay per
+  // descriptor. Calls into an external model are usually dominated by the
+  // cost of crossing into it, so all invocations needing estimates are passed
+  // in one call where possible.
+  using BatchEstimator =
+      std::function<absl::StatusOr<std::vector<int64_t>>(
+          absl::Span<const FfiOpDescriptor>)>;
+
+  // If `batch_estimator` is not given, every invocation is estimated at
+  // `fallback_delay_estimate`.
+  explicit FfiDelayEstimator(std::optional<int64_t> fallback_delay_estimate,
+                             BatchEstimator batch_estimator = nullptr)
       : DelayEstimator("ffi_delay_estimator"),
-        fallback_delay_estimate_(fallback_delay_estimate) {}
+        fallback_delay_estimate_(fallback_delay_estimate),
+        batch_estimator_(std::move(batch_estimator)) {}
 
   // Returns the estimated delay for an Op::kInvoke node, all other nodes
   // are ignored to be handled by a different DelayEstimator.
   absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const final;
 
+  // Estimates all Op::kInvoke nodes of `nodes` with a single call of the
+  // batch estimator.
+  std::vector<absl::StatusOr<int64_t>> GetOperationDelaysInPs(
+      absl::Span<Node* const> nodes) const final;
+
+  // Returns the descriptor passed to the batch estimator for `invoke`.
+  static FfiOpDescriptor GetOpDescriptor(Node* invoke);
+
  private:
   std::optional<int64_t> fallback_delay_estimate_;
+  BatchEstimator batch_estimator_;
 };
 }  // namespace xls
 #endif  // XLS_DELAY_MODEL_FFI_DELAY_ESTIMATOR_H_
@@ -0,0 +1,102 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/delay_model/ffi_delay_estimator.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+
+class FfiDelayEstimatorTest : public IrTestBase {};
+
+TEST_F(FfiDelayEstimatorTest, EstimatesBatchInOneCall) {
+  auto p = CreatePackage();
+  FunctionBuilder callee_fb("callee", p.get());
+  BValue a = callee_fb.Param("a", p->GetBitsType(8));
+  BValue b = callee_fb.Param("b", p->GetBitsType(4));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * callee,
+      callee_fb.BuildWithReturnValue(callee_fb.Concat({a, b})));
+
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(4));
+  BValue invoke0 = fb.Invoke({x, y}, callee);
+  BValue invoke1 = fb.Invoke({x, y}, callee);
+  XLS_ASSERT_OK(fb.BuildWithReturnValue(fb.Add(invoke0, invoke1)).status());
+
+  std::vector<std::vector<FfiOpDescriptor>> calls;
+  FfiDelayEstimator estimator(
+      /*fallback_delay_estimate=*/std::nullopt,
+      [&](absl::Span<const FfiOpDescriptor> descriptors)
+          -> absl::StatusOr<std::vector<int64_t>> {
+        calls.emplace_back(descriptors.begin(), descriptors.end());
+        std::vector<int64_t> delays;
+        for (int64_t i = 0; i < descriptors.size(); ++i) {
+          delays.push_back(100 + i);
+        }
+        return delays;
+      });
+
+  std::vector<absl::StatusOr<int64_t>> delays =
+      estimator.GetOperationDelaysInPs({x.node(), invoke0.node(),
+                                        invoke1.node()});
+  ASSERT_EQ(delays.size(), 3);
+  EXPECT_THAT(delays[0], StatusIs(absl::StatusCode::kUnimplemented));
+  EXPECT_THAT(delays[1], IsOkAndHolds(100));
+  EXPECT_THAT(delays[2], IsOkAndHolds(101));
+
+  ASSERT_EQ(calls.size(), 1);
+  ASSERT_EQ(calls[0].size(), 2);
+  EXPECT_EQ(calls[0][0].function_name, "callee");
+  EXPECT_THAT(calls[0][0].operand_bit_counts, ElementsAre(8, 4));
+  EXPECT_EQ(calls[0][0].result_bit_count, 12);
+}
+
+TEST_F(FfiDelayEstimatorTest, FallbackWithoutBatchEstimator) {
+  auto p = CreatePackage();
+  FunctionBuilder callee_fb("callee", p.get());
+  BValue a = callee_fb.Param("a", p->GetBitsType(8));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * callee,
+                           callee_fb.BuildWithReturnValue(a));
+  FunctionBuilder fb(TestName(), p.get());
+  BValue invoke = fb.Invoke({fb.Param("x", p->GetBitsType(8))}, callee);
+  XLS_ASSERT_OK(fb.Build().status());
+
+  EXPECT_THAT(FfiDelayEstimator(42).GetOperationDelayInPs(invoke.node()),
+              IsOkAndHolds(42));
+  EXPECT_THAT(
+      FfiDelayEstimator(std::nullopt).GetOperationDelayInPs(invoke.node()),
+      StatusIs(absl::StatusCode::kNotFound));
+}
+
+}  // namespace
+}  // namespace xls
@@ -232,6 +232,8 @@ std::string OpToString(Bytecode::Op op) {
       return "eq";
     case Bytecode::Op::kFail:
       return "fail";
+    case Bytecode::Op::kFusedBinop:
+      return "fused_binop";
     case Bytecode::Op::kGe:
       return "ge";
     case Bytecode::Op::kGt:
@@ -439,6 +441,25 @@ std::string Bytecode::MatchArmItem::ToString() const {
   return "<invalid MatchArmItem>";
 }
 
+std::string Bytecode::FusedBinopData::ToString() const {
+  auto operand_to_string = [](const Operand& operand) {
+    if (std::holds_alternative<SlotIndex>(operand)) {
+      return absl::StrCat("load:", std::get<SlotIndex>(operand).value());
+    }
+    return std::get<InterpValue>(operand).ToString();
+  };
+  std::string result =
+      absl::StrFormat("%s(%s, %s)", OpToString(op), operand_to_string(lhs),
+                      operand_to_string(rhs));
+  if (store_slot.has_value()) {
+    absl::StrAppend(&result, " -> store:", store_slot->value());
+  } else if (jump_target.has_value()) {
+    absl::StrAppendFormat(&result, " -> jump_rel_if:%+d",
+                          jump_target->value());
+  }
+  return result;
+}
+
 #define DEF_UNARY_BUILDER(OP_NAME)                           \
   /* static */ Bytecode Bytecode::Make##OP_NAME(Span span) { \
     return Bytecode(std::move(span), Op::k##OP_NAME);        \
@@ -456,6 +477,11 @@ DEF_UNARY_BUILDER(Swap);
 
 #undef DEF_UNARY_BUILDER
 
+/* static */ Bytecode Bytecode::MakeFusedBinop(Span span,
+                                               FusedBinopData data) {
+  return Bytecode(std::move(span), Op::kFusedBinop, std::move(data));
+}
+
 /* static */ Bytecode Bytecode::MakeJumpRelIf(Span span, JumpTarget target) {
   return Bytecode(std::move(span), Op::kJumpRelIf, target);
 }
@@ -498,6 +524,13 @@ DEF_UNARY_BUILDER(Swap);
   return Bytecode(std::move(span), Op::kStore, slot_index);
 }
 
+absl::StatusOr<const Bytecode::FusedBinopData*> Bytecode::fused_binop_data()
+    const {
+  XLS_RET_CHECK(data_.has_value());
+  XLS_RET_CHECK(std::holds_alternative<FusedBinopData>(data_.value()));
+  return &std::get<FusedBinopData>(data_.value());
+}
+
 absl::StatusOr<Bytecode::JumpTarget> Bytecode::jump_target() const {
   XLS_RET_CHECK(data_.has_value());
   XLS_RET_CHECK(std::holds_alternative<JumpTarget>(data_.value()));
@@ -638,6 +671,8 @@ std::string Bytecode::ToString(bool source_locs) const {
       std::string operator()(const SpawnData& spawn_data) {
         return spawn_data.spawn->ToString();
       }
+
+      std::string operator()(const FusedBinopData& v) { return v.ToString(); }
     };
 
     std::string data_string = absl::visit(DataVisitor(), data_.value());
@@ -743,6 +778,11 @@ std::vector<Bytecode> BytecodeFunction::CloneBytecodes() const {
         bytecodes.emplace_back(
             Bytecode(bc.source_span(), bc.op(),
                      std::get<InterpValue>(bc.data().value())));
+      } else if (std::holds_alternative<Bytecode::FusedBinopData>(
+                     bc.data().value())) {
+        bytecodes.emplace_back(
+            Bytecode(bc.source_span(), bc.op(),
+                     std::get<Bytecode::FusedBinopData>(bc.data().value())));
       } else {
         const std::unique_ptr<ConcreteType>& type =
             std::get<std::unique_ptr<ConcreteType>>(bc.data().value());
@@ -757,4 +797,131 @@ std::vector<Bytecode> BytecodeFunction::CloneBytecodes() const {
   return bytecodes;
 }
 
+namespace {
+
+bool IsFusableBinop(Bytecode::Op op) {
+  switch (op) {
+    case Bytecode::Op::kUAdd:
+    case Bytecode::Op::kSAdd:
+    case Bytecode::Op::kUSub:
+    case Bytecode::Op::kSSub:
+    case Bytecode::Op::kAnd:
+    case Bytecode::Op::kOr:
+    case Bytecode::Op::kXor:
+    case Bytecode::Op::kConcat:
+    case Bytecode::Op::kEq:
+    case Bytecode::Op::kNe:
+    case Bytecode::Op::kLt:
+    case Bytecode::Op::kLe:
+    case Bytecode::Op::kGt:
+    case Bytecode::Op::kGe:
+    case Bytecode::Op::kShl:
+    case Bytecode::Op::kShr:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns the fused operand equivalent to pushing the result of `bytecode`, if
+// it is a load or a literal.
+std::optional<Bytecode::FusedBinopData::Operand> GetFusedOperand(
+    const Bytecode& bytecode) {
+  if (!bytecode.has_data()) {
+    return std::nullopt;
+  }
+  if (bytecode.op() == Bytecode::Op::kLoad &&
+      std::holds_alternative<Bytecode::SlotIndex>(bytecode.data().value())) {
+    return std::get<Bytecode::SlotIndex>(bytecode.data().value());
+  }
+  if (bytecode.op() == Bytecode::Op::kLiteral &&
+      std::holds_alternative<InterpValue>(bytecode.data().value())) {
+    return std::get<InterpValue>(bytecode.data().value());
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+absl::StatusOr<std::vector<Bytecode>> FuseSuperinstructions(
+    std::vector<Bytecode> bytecodes) {
+  const int64_t size = bytecodes.size();
+  std::vector<Bytecode> result;
+  result.reserve(size);
+  // Maps each original PC to the PC of the instruction it became, or -1 if it
+  // was folded into a preceding instruction. The extra entry maps the
+  // end-of-function PC.
+  std::vector<int64_t> new_pcs(size + 1, -1);
+  // For each output instruction holding a relative jump, the original PC the
+  // jump was relative to.
+  std::vector<std::pair<int64_t, int64_t>> jumps;
+
+  int64_t pc = 0;
+  while (pc < size) {
+    new_pcs[pc] = result.size();
+    std::optional<Bytecode::FusedBinopData::Operand> lhs;
+    std::optional<Bytecode::FusedBinopData::Operand> rhs;
+    if (pc + 2 < size && IsFusableBinop(bytecodes[pc + 2].op())) {
+      lhs = GetFusedOperand(bytecodes[pc]);
+      rhs = GetFusedOperand(bytecodes[pc + 1]);
+    }
+    if (lhs.has_value() && rhs.has_value()) {
+      Bytecode::FusedBinopData data{.op = bytecodes[pc + 2].op(),
+                                    .lhs = std::move(lhs).value(),
+                                    .rhs = std::move(rhs).value()};
+      Span span = bytecodes[pc + 2].source_span();
+      int64_t length = 3;
+      if (pc + 3 < size && bytecodes[pc + 3].op() == Bytecode::Op::kStore) {
+        XLS_ASSIGN_OR_RETURN(data.store_slot, bytecodes[pc + 3].slot_index());
+        length = 4;
+      } else if (pc + 3 < size &&
+                 bytecodes[pc + 3].op() == Bytecode::Op::kJumpRelIf) {
+        XLS_ASSIGN_OR_RETURN(data.jump_target,
+                             bytecodes[pc + 3].jump_target());
+        jumps.push_back({result.size(), pc + 3});
+        length = 4;
+      }
+      result.push_back(Bytecode::MakeFusedBinop(span, std::move(data)));
+      pc += length;
+      continue;
+    }
+
+    if (bytecodes[pc].op() == Bytecode::Op::kJumpRel ||
+        bytecodes[pc].op() == Bytecode::Op::kJumpRelIf) {
+      jumps.push_back({result.size(), pc});
+    }
+    result.push_back(std::move(bytecodes[pc]));
+    ++pc;
+  }
+  new_pcs[size] = result.size();
+
+  for (const auto& [new_pc, old_pc] : jumps) {
+    Bytecode& jump = result[new_pc];
+    Bytecode::FusedBinopData data;
+    Bytecode::JumpTarget target;
+    if (jump.op() == Bytecode::Op::kFusedBinop) {
+      XLS_ASSIGN_OR_RETURN(const Bytecode::FusedBinopData* fused,
+                           jump.fused_binop_data());
+      data = *fused;
+      target = data.jump_target.value();
+    } else {
+      XLS_ASSIGN_OR_RETURN(target, jump.jump_target());
+    }
+    int64_t old_dest = old_pc + target.value();
+    XLS_RET_CHECK(old_dest >= 0 && old_dest <= size)
+        << "Jump at PC " << old_pc << " leaves the function.";
+    XLS_RET_CHECK_NE(new_pcs[old_dest], -1)
+        << "Jump at PC " << old_pc << " targets a fused instruction.";
+    Bytecode::JumpTarget new_target(new_pcs[old_dest] - new_pc);
+    if (jump.op() == Bytecode::Op::kFusedBinop) {
+      data.jump_target = new_target;
+      jump = Bytecode::MakeFusedBinop(jump.source_span(), std::move(data));
+    } else {
+      jump = Bytecode(jump.source_span(), jump.op(), new_target);
+    }
+  }
+
+  return result;
+}
+
 }  // namespace xls::dslx
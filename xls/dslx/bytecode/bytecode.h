@@ -84,6 +84,11 @@ class Bytecode {
     // Terminates the current program with a failure status. Consumes as many
     // values from the stack as are specified in the `TraceData` data member.
     kFail,
+    // Superinstruction replacing a `load`/`literal` pair followed by a binary
+    // op (and optionally a `store` or `jump_rel_if` of its result); see
+    // `FusedBinopData` and `FuseSuperinstructions()`. Operands are read
+    // directly from their slots or the literal, without touching the stack.
+    kFusedBinop,
     // Compares TOS1 to TOS0, storing true if TOS1 >= TOS0.
     kGe,
     // Compares TOS1 to TOS0, storing true if TOS1 > TOS0.
@@ -324,11 +329,29 @@ class Bytecode {
     std::unique_ptr<ValueFormatDescriptor> value_fmt_desc_;
   };
 
+  // Operands and disposition of a kFusedBinop. Each operand is either a slot
+  // to read or a literal value. The result of `op` is stored into
+  // `store_slot` if present, used as the condition of a relative jump by
+  // `jump_target` if present, or otherwise pushed onto the stack.
+  struct FusedBinopData {
+    using Operand = std::variant<SlotIndex, InterpValue>;
+
+    Op op;
+    Operand lhs;
+    Operand rhs;
+    std::optional<SlotIndex> store_slot;
+    std::optional<JumpTarget> jump_target;
+
+    std::string ToString() const;
+  };
+
   using Data = std::variant<InterpValue, JumpTarget, NumElements, SlotIndex,
                             std::unique_ptr<ConcreteType>, InvocationData,
-                            MatchArmItem, SpawnData, TraceData, ChannelData>;
+                            MatchArmItem, SpawnData, TraceData, ChannelData,
+                            FusedBinopData>;
 
   static Bytecode MakeDup(Span span);
+  static Bytecode MakeFusedBinop(Span span, FusedBinopData data);
   static Bytecode MakeIndex(Span span);
   static Bytecode MakeTupleIndex(Span span);
   static Bytecode MakeInvert(Span span);
@@ -370,6 +393,7 @@ class Bytecode {
 
   bool has_data() const { return data_.has_value(); }
 
+  absl::StatusOr<const FusedBinopData*> fused_binop_data() const;
   absl::StatusOr<InvocationData> invocation_data() const;
   absl::StatusOr<JumpTarget> jump_target() const;
   absl::StatusOr<const MatchArmItem*> match_arm_item() const;
@@ -449,6 +473,19 @@ std::string BytecodesToString(absl::Span<const Bytecode> bytecodes,
 absl::StatusOr<std::vector<Bytecode>> BytecodesFromString(
     std::string_view text);
 
+// Rewrites the operand-load/binop/result-consume sequences the emitter produces
+// for simple arithmetic and loop tests, e.g.
+//
+//   load 2; literal u32:1; uadd; store 2
+//   load 2; literal u32:8; eq; jump_rel_if +5
+//
+// into single kFusedBinop instructions, reducing the number of dispatches and
+// stack copies per source-level operation. Relative jump targets are rewritten
+// to account for the shortened sequence; instructions that may be jumped to
+// (kJumpDest) are never folded.
+absl::StatusOr<std::vector<Bytecode>> FuseSuperinstructions(
+    std::vector<Bytecode> bytecodes);
+
 }  // namespace xls::dslx
 
 #endif  // XLS_DSLX_BYTECODE_BYTECODE_H_
@@ -13,32 +13,120 @@
 // limitations under the License.
 #include "xls/dslx/bytecode/bytecode_cache.h"
 
+#include <algorithm>
+#include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
+#include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/logging/logging.h"
+#include "xls/dslx/bytecode/bytecode.pb.h"
 #include "xls/dslx/bytecode/bytecode_emitter.h"
+#include "xls/dslx/bytecode/bytecode_to_proto.h"
 
 namespace xls::dslx {
 
-BytecodeCache::BytecodeCache(ImportData* import_data)
-    : import_data_(import_data) {}
+BytecodeCache::BytecodeCache(ImportData* import_data,
+                             std::optional<std::filesystem::path> cache_dir)
+    : import_data_(import_data) {
+  if (cache_dir.has_value()) {
+    disk_cache_.emplace(*std::move(cache_dir));
+  }
+}
 
 absl::StatusOr<BytecodeFunction*> BytecodeCache::GetOrCreateBytecodeFunction(
     const Function* f, const TypeInfo* type_info,
     const std::optional<ParametricEnv>& caller_bindings) {
   Key key = std::make_tuple(f, type_info, caller_bindings);
+  absl::MutexLock lock(&mutex_);
   if (!cache_.contains(key)) {
-    XLS_ASSIGN_OR_RETURN(
-        std::unique_ptr<BytecodeFunction> bf,
-        BytecodeEmitter::Emit(import_data_, type_info, f, caller_bindings));
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<BytecodeFunction> bf,
+                         Emit(f, type_info, caller_bindings));
     cache_.emplace(key, std::move(bf));
   }
 
   return cache_.at(key).get();
 }
 
+std::optional<std::string> BytecodeCache::GetDiskKey(
+    const Function* f,
+    const std::optional<ParametricEnv>& caller_bindings) const {
+  // The type information of proc members also depends on the parametrics of
+  // the enclosing proc, which the key below does not capture.
+  if (!disk_cache_.has_value() || f->proc().has_value() ||
+      !f->owner()->fs_path().has_value()) {
+    return std::nullopt;
+  }
+  return absl::StrJoin(
+      {std::string("bytecode"), f->owner()->fs_path()->string(),
+       f->identifier(), f->span().ToString(),
+       caller_bindings.has_value() ? caller_bindings->ToString()
+                                   : std::string("none")},
+      "\n");
+}
+
+absl::StatusOr<std::unique_ptr<BytecodeFunction>> BytecodeCache::Emit(
+    const Function* f, const TypeInfo* type_info,
+    const std::optional<ParametricEnv>& caller_bindings) {
+  std::optional<std::string> disk_key = GetDiskKey(f, caller_bindings);
+  if (disk_key.has_value()) {
+    // Unreadable or stale entries are treated as misses and overwritten below.
+    absl::StatusOr<std::optional<std::string>> entry =
+        disk_cache_->Lookup(*disk_key);
+    BytecodeFunctionProto proto;
+    if (entry.ok() && entry->has_value() &&
+        proto.ParseFromString(**entry)) {
+      absl::StatusOr<std::unique_ptr<BytecodeFunction>> bf =
+          BytecodeFunctionFromProto(proto, *import_data_, f->owner(), f,
+                                    type_info);
+      if (bf.ok()) {
+        ++disk_hits_;
+        return bf;
+      }
+      XLS_VLOG(1) << "Ignoring cached bytecode for " << f->identifier()
+                  << ": " << bf.status();
+    }
+  }
+
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<BytecodeFunction> bf,
+      BytecodeEmitter::Emit(
+          import_data_, type_info, f, caller_bindings,
+          BytecodeEmitterOptions{.fuse_superinstructions = true}));
+
+  if (disk_key.has_value()) {
+    absl::StatusOr<BytecodeFunctionProto> proto = BytecodeFunctionToProto(*bf);
+    if (!proto.ok()) {
+      XLS_VLOG(1) << "Not caching bytecode for " << f->identifier() << ": "
+                  << proto.status();
+      return bf;
+    }
+    // The entry module is not necessarily among the imported module paths.
+    std::vector<std::filesystem::path> dependencies =
+        import_data_->GetModulePaths();
+    const std::filesystem::path& owner_path = *f->owner()->fs_path();
+    if (std::find(dependencies.begin(), dependencies.end(), owner_path) ==
+        dependencies.end()) {
+      dependencies.push_back(owner_path);
+    }
+    if (absl::Status status = disk_cache_->Insert(
+            *disk_key, dependencies, proto->SerializeAsString());
+        !status.ok()) {
+      XLS_LOG(WARNING) << "Failed to cache bytecode for " << f->identifier()
+                       << ": " << status;
+    } else {
+      ++disk_inserts_;
+    }
+  }
+  return bf;
+}
+
 }  // namespace xls::dslx
@@ -14,33 +14,73 @@
 #ifndef XLS_DSLX_BYTECODE_BYTECODE_CACHE_H_
 #define XLS_DSLX_BYTECODE_BYTECODE_CACHE_H_
 
+#include <cstdint>
+#include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
+#include <string>
 #include <tuple>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/dslx/bytecode/bytecode.h"
 #include "xls/dslx/bytecode/bytecode_cache_interface.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/import_data.h"
+#include "xls/dslx/output_cache.h"
+#include "xls/dslx/type_system/parametric_env.h"
 #include "xls/dslx/type_system/type_info.h"
 
 namespace xls::dslx {
 
+// Thread-safe: proc instances running concurrently may share a cache.
 class BytecodeCache : public BytecodeCacheInterface {
  public:
-  explicit BytecodeCache(ImportData* import_data);
+  // If `cache_dir` is given, emitted bytecode is also persisted there (see
+  // OutputCache) and reused by later processes for as long as none of the
+  // modules loaded into `import_data` change. Only functions outside of procs
+  // whose bytecode has a serialized form (see BytecodeFunctionToProto()) are
+  // persisted; everything else is emitted afresh in each process.
+  explicit BytecodeCache(
+      ImportData* import_data,
+      std::optional<std::filesystem::path> cache_dir = std::nullopt);
   absl::StatusOr<BytecodeFunction*> GetOrCreateBytecodeFunction(
       const Function* f, const TypeInfo* type_info,
       const std::optional<ParametricEnv>& caller_bindings) override;
 
+  // Number of functions loaded from / stored to the on-disk cache.
+  int64_t disk_hits() const {
+    absl::MutexLock lock(&mutex_);
+    return disk_hits_;
+  }
+  int64_t disk_inserts() const {
+    absl::MutexLock lock(&mutex_);
+    return disk_inserts_;
+  }
+
  private:
   using Key = std::tuple<const Function*, const TypeInfo*,
                          std::optional<ParametricEnv>>;
 
+  absl::StatusOr<std::unique_ptr<BytecodeFunction>> Emit(
+      const Function* f, const TypeInfo* type_info,
+      const std::optional<ParametricEnv>& caller_bindings)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Returns the key under which the bytecode for `f` is persisted, or
+  // std::nullopt if it is not persisted.
+  std::optional<std::string> GetDiskKey(
+      const Function* f,
+      const std::optional<ParametricEnv>& caller_bindings) const;
+
   ImportData* import_data_;
-  absl::flat_hash_map<Key, std::unique_ptr<BytecodeFunction>> cache_;
+  std::optional<OutputCache> disk_cache_;
+  mutable absl::Mutex mutex_;
+  int64_t disk_hits_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t disk_inserts_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::flat_hash_map<Key, std::unique_ptr<BytecodeFunction>> cache_
+      ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace xls::dslx
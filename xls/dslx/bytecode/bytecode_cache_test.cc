@@ -0,0 +1,104 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/bytecode/bytecode_cache.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/parse_and_typecheck.h"
+
+namespace xls::dslx {
+namespace {
+
+constexpr std::string_view kProgram = R"(
+enum E : u2 { A = 0, B = 1 }
+
+fn id<N: u32>(x: uN[N]) -> uN[N] { x }
+
+fn main(x: u8) -> (u8, E) {
+  let y = for (i, acc): (u8, u8) in u8:0..u8:4 { acc + i }(x);
+  let e = match id(y) {
+    u8:0 | u8:1 => E::A,
+    _ => E::B,
+  };
+  (y, e)
+}
+)";
+
+struct EmitResult {
+  std::string bytecode;
+  int64_t disk_hits;
+  int64_t disk_inserts;
+};
+
+// Emits the bytecode for `main` in `path` with a fresh import set, as a
+// separate process would, and returns its text along with the cache
+// statistics.
+absl::StatusOr<EmitResult> EmitMain(const std::filesystem::path& path,
+                                    const std::filesystem::path& cache_dir) {
+  XLS_ASSIGN_OR_RETURN(std::string text, GetFileContents(path));
+  ImportData import_data(CreateImportDataForTest());
+  XLS_ASSIGN_OR_RETURN(
+      TypecheckedModule tm,
+      ParseAndTypecheck(text, path.string(), "test", &import_data));
+  XLS_ASSIGN_OR_RETURN(Function * f,
+                       tm.module->GetMemberOrError<Function>("main"));
+  BytecodeCache cache(&import_data, cache_dir);
+  XLS_ASSIGN_OR_RETURN(
+      BytecodeFunction * bf,
+      cache.GetOrCreateBytecodeFunction(f, tm.type_info, std::nullopt));
+  return EmitResult{BytecodesToString(bf->bytecodes(), /*source_locs=*/true),
+                    cache.disk_hits(), cache.disk_inserts()};
+}
+
+TEST(BytecodeCacheTest, PersistsBytecodeAcrossImportSets) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "test.x";
+  std::filesystem::path cache_dir = temp_dir.path() / "cache";
+  XLS_ASSERT_OK(SetFileContents(path, kProgram));
+
+  XLS_ASSERT_OK_AND_ASSIGN(EmitResult first, EmitMain(path, cache_dir));
+  EXPECT_EQ(first.disk_hits, 0);
+  EXPECT_EQ(first.disk_inserts, 1);
+
+  XLS_ASSERT_OK_AND_ASSIGN(EmitResult second, EmitMain(path, cache_dir));
+  EXPECT_EQ(second.disk_hits, 1);
+  EXPECT_EQ(second.disk_inserts, 0);
+  EXPECT_EQ(second.bytecode, first.bytecode);
+
+  // Editing the module invalidates the entry.
+  XLS_ASSERT_OK(
+      SetFileContents(path, absl::StrCat("// Changed.\n", kProgram)));
+  XLS_ASSERT_OK_AND_ASSIGN(EmitResult third, EmitMain(path, cache_dir));
+  EXPECT_EQ(third.disk_hits, 0);
+  EXPECT_EQ(third.disk_inserts, 1);
+}
+
+}  // namespace
+}  // namespace xls::dslx
@@ -0,0 +1,141 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/bytecode/bytecode_call_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/hash/hash.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/interp_value.h"
+
+namespace xls::dslx {
+namespace {
+
+bool IsCacheableValue(const InterpValue& value) {
+  if (value.HasBits()) {
+    return true;
+  }
+  if (value.IsTuple() || value.IsArray()) {
+    for (const InterpValue& element : value.GetValuesOrDie()) {
+      if (!IsCacheableValue(element)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+// Hashes a value for which IsCacheableValue holds. Consistent with
+// InterpValue::Eq, which ignores the signedness of bits values.
+size_t HashValue(const InterpValue& value) {
+  if (value.HasBits()) {
+    return absl::HashOf(value.GetBitsOrDie());
+  }
+  size_t hash = absl::HashOf(value.IsTuple());
+  for (const InterpValue& element : value.GetValuesOrDie()) {
+    hash = absl::HashOf(hash, HashValue(element));
+  }
+  return hash;
+}
+
+}  // namespace
+
+/* static */ bool BytecodeCallCache::IsCacheableArgs(
+    absl::Span<const InterpValue> args) {
+  for (const InterpValue& arg : args) {
+    if (!IsCacheableValue(arg)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t BytecodeCallCache::KeyHash::operator()(const Key& key) const {
+  size_t hash = absl::HashOf(key.first);
+  for (const InterpValue& arg : key.second) {
+    hash = absl::HashOf(hash, HashValue(arg));
+  }
+  return hash;
+}
+
+bool BytecodeCallCache::KeyEq::operator()(const Key& a, const Key& b) const {
+  if (a.first != b.first || a.second.size() != b.second.size()) {
+    return false;
+  }
+  for (int64_t i = 0; i < a.second.size(); ++i) {
+    if (!a.second[i].Eq(b.second[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::optional<InterpValue> BytecodeCallCache::Lookup(
+    BytecodeFunction* bf, absl::Span<const InterpValue> args) {
+  auto it = entries_.find(
+      Key(bf, std::vector<InterpValue>(args.begin(), args.end())));
+  if (it == entries_.end()) {
+    ++misses_;
+    return std::nullopt;
+  }
+  ++hits_;
+  return it->second;
+}
+
+void BytecodeCallCache::Insert(BytecodeFunction* bf,
+                               absl::Span<const InterpValue> args,
+                               InterpValue result) {
+  if (max_entries_ <= 0) {
+    return;
+  }
+  Key key(bf, std::vector<InterpValue>(args.begin(), args.end()));
+  if (entries_.contains(key)) {
+    return;
+  }
+  if (entries_.size() >= max_entries_) {
+    entries_.erase(insertion_order_.front());
+    insertion_order_.pop_front();
+    ++evictions_;
+  }
+  entries_.emplace(key, std::move(result));
+  insertion_order_.push_back(std::move(key));
+}
+
+void BytecodeCallCache::Clear() {
+  entries_.clear();
+  insertion_order_.clear();
+  impure_.clear();
+  hits_ = 0;
+  misses_ = 0;
+  evictions_ = 0;
+}
+
+std::string BytecodeCallCache::ToString() const {
+  return absl::StrFormat(
+      "call cache: %d/%d entries, %d hits, %d misses (%.1f%% hit rate), %d "
+      "evictions, %d impure functions",
+      size(), max_entries_, hits_, misses_, 100.0 * hit_rate(), evictions_,
+      impure_.size());
+}
+
+}  // namespace xls::dslx
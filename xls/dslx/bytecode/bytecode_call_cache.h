@@ -0,0 +1,109 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_BYTECODE_BYTECODE_CALL_CACHE_H_
+#define XLS_DSLX_BYTECODE_BYTECODE_CALL_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
+#include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/interp_value.h"
+
+namespace xls::dslx {
+
+// A bounded memo table of the results of DSLX function calls made by the
+// BytecodeInterpreter, keyed on the callee and argument values. Purity is
+// discovered dynamically: a call which executes a side-effecting operation
+// (trace, cover, channel operations, spawn) is not recorded and its callee is
+// never cached again. Only arguments composed of bits, enums, tuples and
+// arrays are cached. When full, the oldest entry is evicted. Not thread-safe.
+//
+// BytecodeFunction pointers are used as keys, so a cache should only be shared
+// between interpreters using the same ImportData.
+class BytecodeCallCache {
+ public:
+  explicit BytecodeCallCache(int64_t max_entries)
+      : max_entries_(max_entries) {}
+
+  BytecodeCallCache(const BytecodeCallCache&) = delete;
+  BytecodeCallCache& operator=(const BytecodeCallCache&) = delete;
+
+  // Returns whether `args` may be used as part of a cache key.
+  static bool IsCacheableArgs(absl::Span<const InterpValue> args);
+
+  // Returns whether calls to `bf` may be cached.
+  bool IsCacheable(BytecodeFunction* bf) const { return !impure_.contains(bf); }
+
+  // Records that `bf` performed a side-effecting operation.
+  void MarkImpure(BytecodeFunction* bf) { impure_.insert(bf); }
+
+  // Returns the cached result of calling `bf` with `args`, if any. Updates the
+  // hit and miss counts.
+  std::optional<InterpValue> Lookup(BytecodeFunction* bf,
+                                    absl::Span<const InterpValue> args);
+
+  // Records the result of calling `bf` with `args`.
+  void Insert(BytecodeFunction* bf, absl::Span<const InterpValue> args,
+              InterpValue result);
+
+  int64_t size() const { return entries_.size(); }
+  int64_t max_entries() const { return max_entries_; }
+  int64_t hits() const { return hits_; }
+  int64_t misses() const { return misses_; }
+  int64_t evictions() const { return evictions_; }
+
+  // Returns the fraction of lookups which hit, or zero if there were none.
+  double hit_rate() const {
+    int64_t lookups = hits_ + misses_;
+    return lookups == 0 ? 0.0 : static_cast<double>(hits_) / lookups;
+  }
+
+  // Removes all entries and resets the statistics and purity information.
+  void Clear();
+
+  // Returns a one-line summary of the cache statistics.
+  std::string ToString() const;
+
+ private:
+  using Key = std::pair<BytecodeFunction*, std::vector<InterpValue>>;
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+  struct KeyEq {
+    bool operator()(const Key& a, const Key& b) const;
+  };
+
+  int64_t max_entries_;
+  absl::flat_hash_map<Key, InterpValue, KeyHash, KeyEq> entries_;
+  // Keys of `entries_` in insertion order for eviction.
+  std::deque<Key> insertion_order_;
+  absl::flat_hash_set<BytecodeFunction*> impure_;
+
+  int64_t hits_ = 0;
+  int64_t misses_ = 0;
+  int64_t evictions_ = 0;
+};
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_BYTECODE_BYTECODE_CALL_CACHE_H_
@@ -152,8 +152,13 @@ BytecodeEmitter::EmitProcNext(
   XLS_RETURN_IF_ERROR(emitter.Init(f));
   XLS_RETURN_IF_ERROR(f->body()->AcceptExpr(&emitter));
 
+  std::vector<Bytecode> bytecodes = std::move(emitter.bytecode_);
+  if (options.fuse_superinstructions) {
+    XLS_ASSIGN_OR_RETURN(bytecodes,
+                         FuseSuperinstructions(std::move(bytecodes)));
+  }
   return BytecodeFunction::Create(f->owner(), f, type_info,
-                                  std::move(emitter.bytecode_));
+                                  std::move(bytecodes));
 }
 
 // Extracts all NameDefs "downstream" of a given AstNode. This
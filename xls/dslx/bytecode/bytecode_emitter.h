@@ -37,6 +37,10 @@ namespace xls::dslx {
 struct BytecodeEmitterOptions {
   // The format preference to use when one is not otherwise specified.
   FormatPreference format_preference;
+
+  // Whether to rewrite common instruction sequences in emitted functions into
+  // superinstructions; see `FuseSuperinstructions()`.
+  bool fuse_superinstructions = false;
 };
 
 // Translates a DSLX expression tree into a linear sequence of bytecodes.
@@ -287,6 +287,42 @@ TEST(BytecodeEmitterTest, BytecodesFromString) {
   EXPECT_EQ(BytecodesToString(bytecodes, /*source_locs=*/false), s);
 }
 
+TEST(BytecodeEmitterTest, FuseSuperinstructions) {
+  // A counted loop as emitted for `for`: the loop test and the induction
+  // variable increment should each become a single instruction, with the jumps
+  // around them retargeted.
+  const Span span = Span::Fake();
+  std::vector<Bytecode> bytecodes;
+  bytecodes.push_back(Bytecode::MakeLiteral(span, InterpValue::MakeU32(0)));
+  bytecodes.push_back(Bytecode::MakeStore(span, Bytecode::SlotIndex(0)));
+  bytecodes.push_back(Bytecode::MakeJumpDest(span));
+  bytecodes.push_back(Bytecode::MakeLoad(span, Bytecode::SlotIndex(0)));
+  bytecodes.push_back(Bytecode::MakeLiteral(span, InterpValue::MakeU32(4)));
+  bytecodes.push_back(Bytecode(span, Bytecode::Op::kEq));
+  bytecodes.push_back(Bytecode::MakeJumpRelIf(span, Bytecode::JumpTarget(9)));
+  bytecodes.push_back(Bytecode::MakeLoad(span, Bytecode::SlotIndex(0)));
+  bytecodes.push_back(Bytecode::MakeLoad(span, Bytecode::SlotIndex(1)));
+  bytecodes.push_back(Bytecode(span, Bytecode::Op::kXor));
+  bytecodes.push_back(Bytecode::MakeLoad(span, Bytecode::SlotIndex(0)));
+  bytecodes.push_back(Bytecode::MakeLiteral(span, InterpValue::MakeU32(1)));
+  bytecodes.push_back(Bytecode(span, Bytecode::Op::kUAdd));
+  bytecodes.push_back(Bytecode::MakeStore(span, Bytecode::SlotIndex(0)));
+  bytecodes.push_back(Bytecode::MakeJumpRel(span, Bytecode::JumpTarget(-12)));
+  bytecodes.push_back(Bytecode::MakeJumpDest(span));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Bytecode> fused,
+                           FuseSuperinstructions(std::move(bytecodes)));
+  EXPECT_EQ(BytecodesToString(fused, /*source_locs=*/false),
+            R"(000 literal u32:0
+001 store 0
+002 jump_dest
+003 fused_binop eq(load:0, u32:4) -> jump_rel_if:+4
+004 fused_binop xor(load:0, load:1)
+005 fused_binop uadd(load:0, u32:1) -> store:0
+006 jump_rel -4
+007 jump_dest)");
+}
+
 // Tests emission of all of the supported binary operators.
 TEST(BytecodeEmitterTest, Binops) {
   constexpr std::string_view kProgram = R"(#[test]
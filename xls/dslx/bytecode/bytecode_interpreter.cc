@@ -27,6 +27,7 @@
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/numeric/int128.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -169,6 +170,11 @@ absl::Status BytecodeInterpreter::Run(bool* progress_made) {
       }
     }
 
+    if (frame->memoize() && !stack_.empty()) {
+      options_.call_cache()->Insert(frame->bf(), frame->initial_args(),
+                                    stack_.PeekOrDie());
+    }
+
     // We've reached the end of a function. Time to load the next frame up!
     frames_.pop_back();
   }
@@ -244,6 +250,15 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
       XLS_RETURN_IF_ERROR(EvalFail(bytecode));
       break;
     }
+    case Bytecode::Op::kFusedBinop: {
+      XLS_ASSIGN_OR_RETURN(std::optional<int64_t> new_pc,
+                           EvalFusedBinop(frame->pc(), bytecode));
+      if (new_pc.has_value()) {
+        frame->set_pc(new_pc.value());
+        return absl::OkStatus();
+      }
+      break;
+    }
     case Bytecode::Op::kGe: {
       XLS_RETURN_IF_ERROR(EvalGe(bytecode));
       break;
@@ -341,14 +356,17 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
       break;
     }
     case Bytecode::Op::kRecv: {
+      MarkFramesImpure();
       XLS_RETURN_IF_ERROR(EvalRecv(bytecode));
       break;
     }
     case Bytecode::Op::kRecvNonBlocking: {
+      MarkFramesImpure();
       XLS_RETURN_IF_ERROR(EvalRecvNonBlocking(bytecode));
       break;
     }
     case Bytecode::Op::kSend: {
+      MarkFramesImpure();
       XLS_RETURN_IF_ERROR(EvalSend(bytecode));
       break;
     }
@@ -365,6 +383,7 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
       break;
     }
     case Bytecode::Op::kSpawn: {
+      MarkFramesImpure();
       XLS_RETURN_IF_ERROR(EvalSpawn(bytecode));
       stack_.Push(InterpValue::MakeUnit());
       break;
@@ -386,6 +405,7 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
       break;
     }
     case Bytecode::Op::kTrace: {
+      MarkFramesImpure();
       XLS_RETURN_IF_ERROR(EvalTrace(bytecode));
       break;
     }
@@ -413,27 +433,91 @@ absl::Status BytecodeInterpreter::EvalBinop(
   return absl::OkStatus();
 }
 
-absl::Status BytecodeInterpreter::EvalAdd(const Bytecode& bytecode,
-                                          bool is_signed) {
-  return EvalBinop([&](const InterpValue& lhs,
-                       const InterpValue& rhs) -> absl::StatusOr<InterpValue> {
-    XLS_ASSIGN_OR_RETURN(InterpValue output, lhs.Add(rhs));
-
-    // Slow path: when rollover warning hook is enabled.
-    if (options_.rollover_hook() != nullptr) {
-      auto make_big_int = [is_signed](const Bits& bits) {
-        return is_signed ? BigInt::MakeSigned(bits)
-                         : BigInt::MakeUnsigned(bits);
-      };
-      bool rollover =
-          make_big_int(lhs.GetBitsOrDie()) + make_big_int(rhs.GetBitsOrDie()) !=
-          make_big_int(output.GetBitsOrDie());
-      if (rollover) {
-        options_.rollover_hook()(bytecode.source_span());
+absl::StatusOr<InterpValue> BytecodeInterpreter::ApplyBinop(
+    Bytecode::Op op, const Span& span, const InterpValue& lhs,
+    const InterpValue& rhs) {
+  switch (op) {
+    case Bytecode::Op::kUAdd:
+    case Bytecode::Op::kSAdd:
+    case Bytecode::Op::kUSub:
+    case Bytecode::Op::kSSub: {
+      bool is_add = op == Bytecode::Op::kUAdd || op == Bytecode::Op::kSAdd;
+      XLS_ASSIGN_OR_RETURN(InterpValue output,
+                           is_add ? lhs.Add(rhs) : lhs.Sub(rhs));
+
+      // Slow path: when rollover warning hook is enabled.
+      if (options_.rollover_hook() != nullptr) {
+        bool is_signed = op == Bytecode::Op::kSAdd || op == Bytecode::Op::kSSub;
+        const Bits& lhs_bits = lhs.GetBitsOrDie();
+        const Bits& rhs_bits = rhs.GetBitsOrDie();
+        bool rolled_over;
+        if (lhs_bits.bit_count() <= 64) {
+          // The exact result of a 64-bit add or subtract fits in 128 bits.
+          auto to_int128 = [is_signed](const Bits& bits) {
+            absl::int128 value = bits.bitmap().GetWord(0);
+            if (is_signed && bits.msb()) {
+              value -= absl::int128(1) << bits.bit_count();
+            }
+            return value;
+          };
+          absl::int128 exact = is_add
+                                   ? to_int128(lhs_bits) + to_int128(rhs_bits)
+                                   : to_int128(lhs_bits) - to_int128(rhs_bits);
+          rolled_over = exact != to_int128(output.GetBitsOrDie());
+        } else {
+          auto make_big_int = [is_signed](const Bits& bits) {
+            return is_signed ? BigInt::MakeSigned(bits)
+                             : BigInt::MakeUnsigned(bits);
+          };
+          BigInt big_lhs = make_big_int(lhs_bits);
+          BigInt big_rhs = make_big_int(rhs_bits);
+          BigInt exact = is_add ? big_lhs + big_rhs : big_lhs - big_rhs;
+          rolled_over = exact != make_big_int(output.GetBitsOrDie());
+        }
+        if (rolled_over) {
+          options_.rollover_hook()(span);
+        }
       }
-    }
+      return output;
+    }
+    case Bytecode::Op::kAnd:
+      return lhs.BitwiseAnd(rhs);
+    case Bytecode::Op::kOr:
+      return lhs.BitwiseOr(rhs);
+    case Bytecode::Op::kXor:
+      return lhs.BitwiseXor(rhs);
+    case Bytecode::Op::kConcat:
+      return lhs.Concat(rhs);
+    case Bytecode::Op::kEq:
+      return InterpValue::MakeBool(lhs.Eq(rhs));
+    case Bytecode::Op::kNe:
+      return InterpValue::MakeBool(lhs.Ne(rhs));
+    case Bytecode::Op::kLt:
+      return lhs.Lt(rhs);
+    case Bytecode::Op::kLe:
+      return lhs.Le(rhs);
+    case Bytecode::Op::kGt:
+      return lhs.Gt(rhs);
+    case Bytecode::Op::kGe:
+      return lhs.Ge(rhs);
+    case Bytecode::Op::kShl:
+      return lhs.Shl(rhs);
+    case Bytecode::Op::kShr:
+      if (lhs.IsSigned()) {
+        return lhs.Shra(rhs);
+      }
+      return lhs.Shrl(rhs);
+    default:
+      return absl::InternalError(
+          absl::StrCat("Not a fusable binary op: ", OpToString(op)));
+  }
+}
 
-    return output;
+absl::Status BytecodeInterpreter::EvalAdd(const Bytecode& bytecode,
+                                          bool is_signed) {
+  return EvalBinop([&](const InterpValue& lhs, const InterpValue& rhs) {
+    return ApplyBinop(is_signed ? Bytecode::Op::kSAdd : Bytecode::Op::kUAdd,
+                      bytecode.source_span(), lhs, rhs);
   });
 }
 
@@ -503,13 +587,36 @@ absl::Status BytecodeInterpreter::EvalCall(const Bytecode& bytecode) {
     args[num_args - i - 1] = arg;
   }
 
+  BytecodeCallCache* call_cache = options_.call_cache();
+  bool memoize = call_cache != nullptr &&
+                 options_.post_fn_eval_hook() == nullptr &&
+                 options_.rollover_hook() == nullptr &&
+                 call_cache->IsCacheable(bf) &&
+                 BytecodeCallCache::IsCacheableArgs(args);
+  if (memoize) {
+    if (std::optional<InterpValue> cached = call_cache->Lookup(bf, args)) {
+      stack_.Push(std::move(cached.value()));
+      return absl::OkStatus();
+    }
+  }
+
   std::vector<InterpValue> args_copy = args;
   frames_.push_back(Frame(bf, std::move(args), bf->type_info(), data.bindings,
                           std::move(args_copy)));
+  frames_.back().set_memoize(memoize);
 
   return absl::OkStatus();
 }
 
+void BytecodeInterpreter::MarkFramesImpure() {
+  for (Frame& frame : frames_) {
+    if (frame.memoize()) {
+      frame.set_memoize(false);
+      options_.call_cache()->MarkImpure(frame.bf());
+    }
+  }
+}
+
 absl::Status BytecodeInterpreter::EvalCast(const Bytecode& bytecode,
                                            bool is_checked) {
   if (!bytecode.data().has_value() ||
@@ -724,6 +831,42 @@ absl::Status BytecodeInterpreter::EvalFail(const Bytecode& bytecode) {
   return FailureErrorStatus(bytecode.source_span(), message);
 }
 
+absl::StatusOr<std::optional<int64_t>> BytecodeInterpreter::EvalFusedBinop(
+    int64_t pc, const Bytecode& bytecode) {
+  XLS_ASSIGN_OR_RETURN(const Bytecode::FusedBinopData* data,
+                       bytecode.fused_binop_data());
+  Frame& frame = frames_.back();
+  auto get_operand = [&](const Bytecode::FusedBinopData::Operand& operand)
+      -> absl::StatusOr<const InterpValue*> {
+    if (std::holds_alternative<InterpValue>(operand)) {
+      return &std::get<InterpValue>(operand);
+    }
+    Bytecode::SlotIndex slot = std::get<Bytecode::SlotIndex>(operand);
+    if (frame.slots().size() <= slot.value()) {
+      return absl::InternalError(absl::StrFormat(
+          "Attempted to access local data in slot %d, which is out of range.",
+          slot.value()));
+    }
+    return &frame.slots()[slot.value()];
+  };
+  XLS_ASSIGN_OR_RETURN(const InterpValue* lhs, get_operand(data->lhs));
+  XLS_ASSIGN_OR_RETURN(const InterpValue* rhs, get_operand(data->rhs));
+  XLS_ASSIGN_OR_RETURN(
+      InterpValue result,
+      ApplyBinop(data->op, bytecode.source_span(), *lhs, *rhs));
+
+  if (data->store_slot.has_value()) {
+    frame.StoreSlot(data->store_slot.value(), std::move(result));
+  } else if (data->jump_target.has_value()) {
+    if (result.IsTrue()) {
+      return pc + data->jump_target->value();
+    }
+  } else {
+    stack_.Push(std::move(result));
+  }
+  return std::nullopt;
+}
+
 absl::Status BytecodeInterpreter::EvalGe(const Bytecode& bytecode) {
   return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
     return lhs.Ge(rhs);
@@ -989,6 +1132,7 @@ absl::Status BytecodeInterpreter::EvalRecvNonBlocking(
 
   XLS_ASSIGN_OR_RETURN(const Bytecode::ChannelData* channel_data,
                        bytecode.channel_data());
+  absl::MutexLockMaybe lock(options_.channel_mutex());
   if (condition.IsTrue() && !channel->empty()) {
     if (options_.trace_channels() && options_.trace_hook() != nullptr) {
       XLS_ASSIGN_OR_RETURN(std::string formatted_data,
@@ -1019,6 +1163,7 @@ absl::Status BytecodeInterpreter::EvalRecv(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(const Bytecode::ChannelData* channel_data,
                        bytecode.channel_data());
   if (condition.IsTrue()) {
+    absl::MutexLockMaybe lock(options_.channel_mutex());
     if (channel->empty()) {
       // Restore the stack!
       stack_.Push(channel_value);
@@ -1067,6 +1212,7 @@ absl::Status BytecodeInterpreter::EvalSend(const Bytecode& bytecode) {
                                             channel_data->channel_name(),
                                             formatted_data));
     }
+    absl::MutexLockMaybe lock(options_.channel_mutex());
     channel->push_back(payload);
   }
   stack_.Push(token);
@@ -1167,25 +1313,9 @@ absl::StatusOr<std::optional<int64_t>> BytecodeInterpreter::EvalJumpRelIf(
 
 absl::Status BytecodeInterpreter::EvalSub(const Bytecode& bytecode,
                                           bool is_signed) {
-  return EvalBinop([&](const InterpValue& lhs,
-                       const InterpValue& rhs) -> absl::StatusOr<InterpValue> {
-    XLS_ASSIGN_OR_RETURN(InterpValue output, lhs.Sub(rhs));
-
-    // Slow path: when rollover warning hook is enabled.
-    if (options_.rollover_hook() != nullptr) {
-      auto make_big_int = [is_signed](const Bits& bits) {
-        return is_signed ? BigInt::MakeSigned(bits)
-                         : BigInt::MakeUnsigned(bits);
-      };
-      bool rollover =
-          make_big_int(lhs.GetBitsOrDie()) - make_big_int(rhs.GetBitsOrDie()) !=
-          make_big_int(output.GetBitsOrDie());
-      if (rollover) {
-        options_.rollover_hook()(bytecode.source_span());
-      }
-    }
-
-    return output;
+  return EvalBinop([&](const InterpValue& lhs, const InterpValue& rhs) {
+    return ApplyBinop(is_signed ? Bytecode::Op::kSSub : Bytecode::Op::kUSub,
+                      bytecode.source_span(), lhs, rhs);
   });
 }
 
@@ -1321,6 +1451,7 @@ absl::Status BytecodeInterpreter::RunBuiltinFn(const Bytecode& bytecode,
     case Builtin::kClz:
       return RunBuiltinClz(bytecode, stack_);
     case Builtin::kCover:
+      MarkFramesImpure();
       return RunBuiltinCover(bytecode, stack_);
     case Builtin::kCtz:
       return RunBuiltinCtz(bytecode, stack_);
@@ -1523,8 +1654,9 @@ absl::Status ProcConfigBytecodeInterpreter::EvalSpawn(
       std::unique_ptr<BytecodeFunction> config_bf,
       BytecodeEmitter::Emit(
           import_data, type_info, proc->config(), caller_bindings,
-          BytecodeEmitterOptions{.format_preference =
-                                     options.format_preference()}));
+          BytecodeEmitterOptions{
+              .format_preference = options.format_preference(),
+              .fuse_superinstructions = true}));
 
   ProcConfigBytecodeInterpreter cbi(import_data, proc_instances, options);
   XLS_RETURN_IF_ERROR(cbi.InitFrame(config_bf.get(), config_args, type_info));
@@ -1572,8 +1704,9 @@ absl::Status ProcConfigBytecodeInterpreter::EvalSpawn(
       std::unique_ptr<BytecodeFunction> next_bf,
       BytecodeEmitter::EmitProcNext(
           import_data, type_info, proc->next(), caller_bindings, member_defs,
-          BytecodeEmitterOptions{.format_preference =
-                                     options.format_preference()}));
+          BytecodeEmitterOptions{
+              .format_preference = options.format_preference(),
+              .fuse_superinstructions = true}));
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<BytecodeInterpreter> next_interpreter,
       CreateUnique(import_data, next_bf.get(), full_next_args, options));
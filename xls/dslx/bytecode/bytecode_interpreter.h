@@ -28,6 +28,7 @@
 #include "absl/types/span.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/bytecode/bytecode_call_cache.h"
 #include "xls/dslx/bytecode/bytecode_interpreter_options.h"
 #include "xls/dslx/bytecode/frame.h"
 #include "xls/dslx/bytecode/interpreter_stack.h"
@@ -108,6 +109,9 @@ class BytecodeInterpreter {
 
   absl::Status EvalAnd(const Bytecode& bytecode);
   absl::Status EvalCall(const Bytecode& bytecode);
+  // Prevents the results of all active calls from being cached because a
+  // side-effecting operation is being executed.
+  void MarkFramesImpure();
   absl::Status EvalCast(const Bytecode& bytecode, bool is_checked = false);
   absl::Status EvalConcat(const Bytecode& bytecode);
   absl::Status EvalCreateArray(const Bytecode& bytecode);
@@ -117,6 +121,9 @@ class BytecodeInterpreter {
   absl::Status EvalEq(const Bytecode& bytecode);
   absl::Status EvalExpandTuple(const Bytecode& bytecode);
   absl::Status EvalFail(const Bytecode& bytecode);
+  // Returns the new PC if the instruction's conditional jump is taken.
+  absl::StatusOr<std::optional<int64_t>> EvalFusedBinop(
+      int64_t pc, const Bytecode& bytecode);
   absl::Status EvalGe(const Bytecode& bytecode);
   absl::Status EvalGt(const Bytecode& bytecode);
   absl::Status EvalIndex(const Bytecode& bytecode);
@@ -158,6 +165,11 @@ class BytecodeInterpreter {
   absl::Status EvalBinop(
       const std::function<absl::StatusOr<InterpValue>(
           const InterpValue& lhs, const InterpValue& rhs)>& op);
+  // Computes `lhs op rhs` for any of the binary ops that may appear in a
+  // kFusedBinop. `span` is the location reported to the rollover hook.
+  absl::StatusOr<InterpValue> ApplyBinop(Bytecode::Op op, const Span& span,
+                                         const InterpValue& lhs,
+                                         const InterpValue& rhs);
   absl::StatusOr<BytecodeFunction*> GetBytecodeFn(
       Function* function, const Invocation* invocation,
       const std::optional<ParametricEnv>& caller_bindings);
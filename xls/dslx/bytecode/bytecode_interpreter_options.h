@@ -22,7 +22,9 @@
 #include <utility>
 
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "xls/dslx/bytecode/bytecode_call_cache.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/interp_value.h"
@@ -96,6 +98,26 @@ class BytecodeInterpreterOptions {
   }
   FormatPreference format_preference() const { return format_preference_; }
 
+  // Cache in which the results of calls to side-effect-free functions are
+  // memoized. Calls are not cached while a post-fn-eval or rollover hook is
+  // set, as a cache hit would skip the hook. If null (the default) no calls are
+  // cached. The cache is not owned and may be shared between interpreters.
+  BytecodeInterpreterOptions& call_cache(BytecodeCallCache* value) {
+    call_cache_ = value;
+    return *this;
+  }
+  BytecodeCallCache* call_cache() const { return call_cache_; }
+
+  // Mutex held while channel queues are accessed by send and receive
+  // operations. Must be set when proc instances sharing channels are run on
+  // different threads; if null (the default) channels are accessed without
+  // synchronization. Not owned.
+  BytecodeInterpreterOptions& channel_mutex(absl::Mutex* value) {
+    channel_mutex_ = value;
+    return *this;
+  }
+  absl::Mutex* channel_mutex() const { return channel_mutex_; }
+
  private:
   PostFnEvalHook post_fn_eval_hook_ = nullptr;
   TraceHook trace_hook_ = nullptr;
@@ -104,6 +126,8 @@ class BytecodeInterpreterOptions {
   std::optional<int64_t> max_ticks_;
   bool validate_final_stack_depth_ = true;
   FormatPreference format_preference_ = FormatPreference::kDefault;
+  BytecodeCallCache* call_cache_ = nullptr;
+  absl::Mutex* channel_mutex_ = nullptr;
 };
 
 }  // namespace xls::dslx
@@ -26,10 +26,12 @@
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "benchmark/benchmark.h"
 #include "xls/common/file/temp_file.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/matchers.h"
 #include "xls/dslx/bytecode/builtins.h"
+#include "xls/dslx/bytecode/bytecode_call_cache.h"
 #include "xls/dslx/bytecode/bytecode_emitter.h"
 #include "xls/dslx/bytecode/bytecode_interpreter_options.h"
 #include "xls/dslx/bytecode/interpreter_stack.h"
@@ -2528,5 +2530,130 @@ fn main(x: s2, y: s2) -> s2 {
   }
 }
 
+TEST(BytecodeInterpreterTest, SuperinstructionsMatchUnfused) {
+  constexpr std::string_view kProgram = R"(
+fn main(x: u8, y: u8) -> (u8, u8, bool, u16) {
+  let sum = for (i, acc) in u8:0..u8:6 {
+    let acc = acc + x;
+    if acc < y { acc - i } else { acc ^ y }
+  }(u8:0);
+  let shifted = sum >> u8:1;
+  (sum, shifted << u8:2, x >= y, x ++ y)
+}
+)";
+  ImportData import_data(CreateImportDataForTest());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheckOrPrintError(kProgram, &import_data));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           tm.module->GetMemberOrError<Function>("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<BytecodeFunction> unfused,
+      BytecodeEmitter::Emit(&import_data, tm.type_info, f, ParametricEnv()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<BytecodeFunction> fused,
+      BytecodeEmitter::Emit(
+          &import_data, tm.type_info, f, ParametricEnv(),
+          BytecodeEmitterOptions{.fuse_superinstructions = true}));
+  EXPECT_LT(fused->bytecodes().size(), unfused->bytecodes().size());
+
+  for (uint64_t x : {0, 1, 7, 100, 255}) {
+    for (uint64_t y : {0, 3, 50, 200}) {
+      std::vector<InterpValue> args = {InterpValue::MakeUBits(8, x),
+                                       InterpValue::MakeUBits(8, y)};
+      int64_t unfused_rollovers = 0;
+      int64_t fused_rollovers = 0;
+      XLS_ASSERT_OK_AND_ASSIGN(
+          InterpValue want,
+          BytecodeInterpreter::Interpret(
+              &import_data, unfused.get(), args,
+              BytecodeInterpreterOptions().rollover_hook(
+                  [&](const Span&) { ++unfused_rollovers; })));
+      XLS_ASSERT_OK_AND_ASSIGN(
+          InterpValue got,
+          BytecodeInterpreter::Interpret(
+              &import_data, fused.get(), args,
+              BytecodeInterpreterOptions().rollover_hook(
+                  [&](const Span&) { ++fused_rollovers; })));
+      EXPECT_EQ(got, want) << "x: " << x << " y: " << y;
+      EXPECT_EQ(fused_rollovers, unfused_rollovers);
+    }
+  }
+}
+
+TEST(BytecodeInterpreterTest, CallCacheMemoizesPureCalls) {
+  constexpr std::string_view kProgram = R"(
+fn square(x: u32) -> u32 { x * x }
+
+fn traced(x: u32) -> u32 {
+  trace!(x);
+  x + u32:1
+}
+
+fn main() -> (u32[4], u32, u32) {
+  let squares = map(u32[4]:[2, 3, 2, 2], square);
+  (squares, traced(u32:1), traced(u32:1))
+}
+)";
+  BytecodeCallCache cache(/*max_entries=*/16);
+  std::vector<std::string> trace_output;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpValue value,
+      Interpret(kProgram, "main", /*args=*/{},
+                BytecodeInterpreterOptions().call_cache(&cache).trace_hook(
+                    [&](std::string_view s) {
+                      trace_output.push_back(std::string{s});
+                    })));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpValue squares,
+      InterpValue::MakeArray(
+          {InterpValue::MakeU32(4), InterpValue::MakeU32(9),
+           InterpValue::MakeU32(4), InterpValue::MakeU32(4)}));
+  EXPECT_EQ(value, InterpValue::MakeTuple({squares, InterpValue::MakeU32(2),
+                                           InterpValue::MakeU32(2)}));
+
+  // The traced function is executed on every call.
+  EXPECT_EQ(trace_output.size(), 2);
+  // Only the two distinct calls of `square` are cached; the second call of
+  // `traced` is not looked up once the first was found to have side effects.
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.hits(), 2);
+  EXPECT_EQ(cache.misses(), 3);
+}
+
+// Runs a loop-heavy function, with superinstructions enabled iff
+// `state.range(0)` is nonzero.
+void BM_InterpretLoop(benchmark::State& state) {
+  constexpr std::string_view kProgram = R"(
+fn main(x: u32) -> u32 {
+  for (i, acc) in u32:0..u32:1000 {
+    let acc = acc + i;
+    if acc > x { acc - x } else { acc ^ i }
+  }(u32:0)
+}
+)";
+  ImportData import_data(CreateImportDataForTest());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheckOrPrintError(kProgram, &import_data));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           tm.module->GetMemberOrError<Function>("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<BytecodeFunction> bf,
+      BytecodeEmitter::Emit(
+          &import_data, tm.type_info, f, ParametricEnv(),
+          BytecodeEmitterOptions{.fuse_superinstructions =
+                                     state.range(0) != 0}));
+  std::vector<InterpValue> args = {InterpValue::MakeU32(12345)};
+  for (auto _ : state) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        InterpValue result,
+        BytecodeInterpreter::Interpret(&import_data, bf.get(), args));
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+BENCHMARK(BM_InterpretLoop)->Arg(0)->Arg(1);
+
 }  // namespace
 }  // namespace xls::dslx
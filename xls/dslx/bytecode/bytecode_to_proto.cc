@@ -0,0 +1,394 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/bytecode/bytecode_to_proto.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/casts.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/bytecode/bytecode.pb.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/frontend/ast_node.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/dslx/type_system/concrete_type.h"
+#include "xls/dslx/type_system/parametric_env.h"
+#include "xls/dslx/type_system/type_info.h"
+#include "xls/dslx/type_system/type_info_to_proto.h"
+
+namespace xls::dslx {
+namespace {
+
+absl::StatusOr<BytecodeValueProto> ToProto(const InterpValue& v) {
+  BytecodeValueProto proto;
+  if (v.IsBits()) {
+    XLS_ASSIGN_OR_RETURN(*proto.mutable_bits(), InterpValueToProto(v));
+  } else if (v.IsTuple() || v.IsArray()) {
+    BytecodeValueProto::Elements* elements =
+        v.IsTuple() ? proto.mutable_tuple() : proto.mutable_array();
+    for (const InterpValue& element : v.GetValuesOrDie()) {
+      XLS_ASSIGN_OR_RETURN(*elements->add_elements(), ToProto(element));
+    }
+  } else if (v.IsEnum()) {
+    InterpValue::EnumData enum_data = v.GetEnumData().value();
+    XLS_ASSIGN_OR_RETURN(
+        *proto.mutable_enum_value()->mutable_bits(),
+        InterpValueToProto(
+            InterpValue::MakeBits(enum_data.is_signed, enum_data.value)));
+    *proto.mutable_enum_value()->mutable_enum_def() =
+        SpanToProto(enum_data.def->span());
+  } else if (v.IsBuiltinFunction()) {
+    proto.set_builtin_function(
+        BuiltinToString(std::get<Builtin>(v.GetFunctionOrDie())));
+  } else if (v.IsFunction()) {
+    const auto& fn_data =
+        std::get<InterpValue::UserFnData>(v.GetFunctionOrDie());
+    *proto.mutable_user_function() = SpanToProto(fn_data.function->span());
+  } else {
+    return absl::UnimplementedError(
+        "Cannot serialize bytecode value: " + v.ToString());
+  }
+  return proto;
+}
+
+absl::StatusOr<InterpValue> FromProto(const BytecodeValueProto& proto,
+                                      const ImportData& import_data) {
+  switch (proto.value_oneof_case()) {
+    case BytecodeValueProto::ValueOneofCase::kBits:
+      return InterpValueFromProto(proto.bits());
+    case BytecodeValueProto::ValueOneofCase::kTuple:
+    case BytecodeValueProto::ValueOneofCase::kArray: {
+      const BytecodeValueProto::Elements& elements =
+          proto.has_tuple() ? proto.tuple() : proto.array();
+      std::vector<InterpValue> values;
+      values.reserve(elements.elements_size());
+      for (const BytecodeValueProto& element : elements.elements()) {
+        XLS_ASSIGN_OR_RETURN(InterpValue value,
+                             FromProto(element, import_data));
+        values.push_back(std::move(value));
+      }
+      if (proto.has_tuple()) {
+        return InterpValue::MakeTuple(std::move(values));
+      }
+      return InterpValue::MakeArray(std::move(values));
+    }
+    case BytecodeValueProto::ValueOneofCase::kEnumValue: {
+      XLS_ASSIGN_OR_RETURN(InterpValue bits,
+                           InterpValueFromProto(proto.enum_value().bits()));
+      XLS_ASSIGN_OR_RETURN(const EnumDef* def,
+                           import_data.FindEnumDef(
+                               SpanFromProto(proto.enum_value().enum_def())));
+      return InterpValue::MakeEnum(bits.GetBitsOrDie(), bits.IsSigned(), def);
+    }
+    case BytecodeValueProto::ValueOneofCase::kBuiltinFunction: {
+      XLS_ASSIGN_OR_RETURN(Builtin builtin,
+                           BuiltinFromString(proto.builtin_function()));
+      return InterpValue::MakeFunction(builtin);
+    }
+    case BytecodeValueProto::ValueOneofCase::kUserFunction: {
+      XLS_ASSIGN_OR_RETURN(
+          const AstNode* node,
+          import_data.FindNode(AstNodeKind::kFunction,
+                               SpanFromProto(proto.user_function())));
+      // Function values refer to the (mutable) AST owned by `import_data`.
+      auto* function = const_cast<Function*>(down_cast<const Function*>(node));
+      return InterpValue::MakeFunction(
+          InterpValue::UserFnData{function->owner(), function});
+    }
+    default:
+      break;
+  }
+  return absl::InvalidArgumentError(
+      "Invalid bytecode value proto: " + proto.ShortDebugString());
+}
+
+absl::StatusOr<ParametricEnvProto> ToProto(const ParametricEnv& env) {
+  ParametricEnvProto proto;
+  for (const ParametricEnvItem& item : env.bindings()) {
+    ParametricEnvProto::Item* item_proto = proto.add_items();
+    item_proto->set_identifier(item.identifier);
+    XLS_ASSIGN_OR_RETURN(*item_proto->mutable_value(), ToProto(item.value));
+  }
+  return proto;
+}
+
+absl::StatusOr<ParametricEnv> FromProto(const ParametricEnvProto& proto,
+                                        const ImportData& import_data) {
+  std::vector<std::pair<std::string, InterpValue>> items;
+  for (const ParametricEnvProto::Item& item : proto.items()) {
+    XLS_ASSIGN_OR_RETURN(InterpValue value,
+                         FromProto(item.value(), import_data));
+    items.push_back({item.identifier(), std::move(value)});
+  }
+  return ParametricEnv(items);
+}
+
+absl::StatusOr<MatchArmItemProto> ToProto(
+    const Bytecode::MatchArmItem& item) {
+  MatchArmItemProto proto;
+  switch (item.kind()) {
+    case Bytecode::MatchArmItem::Kind::kInterpValue: {
+      XLS_ASSIGN_OR_RETURN(InterpValue value, item.interp_value());
+      XLS_ASSIGN_OR_RETURN(*proto.mutable_value(), ToProto(value));
+      break;
+    }
+    case Bytecode::MatchArmItem::Kind::kLoad: {
+      XLS_ASSIGN_OR_RETURN(Bytecode::SlotIndex slot, item.slot_index());
+      proto.set_load(slot.value());
+      break;
+    }
+    case Bytecode::MatchArmItem::Kind::kStore: {
+      XLS_ASSIGN_OR_RETURN(Bytecode::SlotIndex slot, item.slot_index());
+      proto.set_store(slot.value());
+      break;
+    }
+    case Bytecode::MatchArmItem::Kind::kRange: {
+      XLS_ASSIGN_OR_RETURN(Bytecode::MatchArmItem::RangeData range,
+                           item.range());
+      XLS_ASSIGN_OR_RETURN(*proto.mutable_range()->mutable_start(),
+                           ToProto(range.start));
+      XLS_ASSIGN_OR_RETURN(*proto.mutable_range()->mutable_limit(),
+                           ToProto(range.limit));
+      break;
+    }
+    case Bytecode::MatchArmItem::Kind::kTuple: {
+      XLS_ASSIGN_OR_RETURN(std::vector<Bytecode::MatchArmItem> elements,
+                           item.tuple_elements());
+      MatchArmItemProto::Elements* tuple = proto.mutable_tuple();
+      for (const Bytecode::MatchArmItem& element : elements) {
+        XLS_ASSIGN_OR_RETURN(*tuple->add_elements(), ToProto(element));
+      }
+      break;
+    }
+    case Bytecode::MatchArmItem::Kind::kWildcard:
+      proto.set_wildcard(true);
+      break;
+  }
+  return proto;
+}
+
+absl::StatusOr<Bytecode::MatchArmItem> FromProto(
+    const MatchArmItemProto& proto, const ImportData& import_data) {
+  switch (proto.item_oneof_case()) {
+    case MatchArmItemProto::ItemOneofCase::kValue: {
+      XLS_ASSIGN_OR_RETURN(InterpValue value,
+                           FromProto(proto.value(), import_data));
+      return Bytecode::MatchArmItem::MakeInterpValue(value);
+    }
+    case MatchArmItemProto::ItemOneofCase::kLoad:
+      return Bytecode::MatchArmItem::MakeLoad(
+          Bytecode::SlotIndex(proto.load()));
+    case MatchArmItemProto::ItemOneofCase::kStore:
+      return Bytecode::MatchArmItem::MakeStore(
+          Bytecode::SlotIndex(proto.store()));
+    case MatchArmItemProto::ItemOneofCase::kRange: {
+      XLS_ASSIGN_OR_RETURN(InterpValue start,
+                           FromProto(proto.range().start(), import_data));
+      XLS_ASSIGN_OR_RETURN(InterpValue limit,
+                           FromProto(proto.range().limit(), import_data));
+      return Bytecode::MatchArmItem::MakeRange(std::move(start),
+                                               std::move(limit));
+    }
+    case MatchArmItemProto::ItemOneofCase::kTuple: {
+      std::vector<Bytecode::MatchArmItem> elements;
+      for (const MatchArmItemProto& element : proto.tuple().elements()) {
+        XLS_ASSIGN_OR_RETURN(Bytecode::MatchArmItem item,
+                             FromProto(element, import_data));
+        elements.push_back(std::move(item));
+      }
+      return Bytecode::MatchArmItem::MakeTuple(std::move(elements));
+    }
+    case MatchArmItemProto::ItemOneofCase::kWildcard:
+      return Bytecode::MatchArmItem::MakeWildcard();
+    default:
+      break;
+  }
+  return absl::InvalidArgumentError(
+      "Invalid match arm item proto: " + proto.ShortDebugString());
+}
+
+absl::StatusOr<FusedBinopOperandProto> ToProto(
+    const Bytecode::FusedBinopData::Operand& operand) {
+  FusedBinopOperandProto proto;
+  if (std::holds_alternative<Bytecode::SlotIndex>(operand)) {
+    proto.set_slot_index(std::get<Bytecode::SlotIndex>(operand).value());
+  } else {
+    XLS_ASSIGN_OR_RETURN(*proto.mutable_value(),
+                         ToProto(std::get<InterpValue>(operand)));
+  }
+  return proto;
+}
+
+absl::StatusOr<Bytecode::FusedBinopData::Operand> FromProto(
+    const FusedBinopOperandProto& proto, const ImportData& import_data) {
+  if (proto.has_slot_index()) {
+    return Bytecode::SlotIndex(proto.slot_index());
+  }
+  XLS_ASSIGN_OR_RETURN(InterpValue value,
+                       FromProto(proto.value(), import_data));
+  return value;
+}
+
+absl::StatusOr<BytecodeProto> ToProto(const Bytecode& bytecode) {
+  BytecodeProto proto;
+  *proto.mutable_span() = SpanToProto(bytecode.source_span());
+  proto.set_op(static_cast<int32_t>(bytecode.op()));
+  if (!bytecode.has_data()) {
+    return proto;
+  }
+  const Bytecode::Data& data = bytecode.data().value();
+  if (const auto* value = std::get_if<InterpValue>(&data)) {
+    XLS_ASSIGN_OR_RETURN(*proto.mutable_value(), ToProto(*value));
+  } else if (const auto* target = std::get_if<Bytecode::JumpTarget>(&data)) {
+    proto.set_jump_target(target->value());
+  } else if (const auto* count = std::get_if<Bytecode::NumElements>(&data)) {
+    proto.set_num_elements(count->value());
+  } else if (const auto* slot = std::get_if<Bytecode::SlotIndex>(&data)) {
+    proto.set_slot_index(slot->value());
+  } else if (const auto* type =
+                 std::get_if<std::unique_ptr<ConcreteType>>(&data)) {
+    XLS_ASSIGN_OR_RETURN(*proto.mutable_type(), ConcreteTypeToProto(**type));
+  } else if (const auto* invocation =
+                 std::get_if<Bytecode::InvocationData>(&data)) {
+    InvocationDataProto* invocation_proto = proto.mutable_invocation();
+    *invocation_proto->mutable_invocation() =
+        SpanToProto(invocation->invocation->span());
+    if (invocation->bindings.has_value()) {
+      XLS_ASSIGN_OR_RETURN(*invocation_proto->mutable_bindings(),
+                           ToProto(*invocation->bindings));
+    }
+  } else if (const auto* item = std::get_if<Bytecode::MatchArmItem>(&data)) {
+    XLS_ASSIGN_OR_RETURN(*proto.mutable_match_arm_item(), ToProto(*item));
+  } else if (const auto* fused =
+                 std::get_if<Bytecode::FusedBinopData>(&data)) {
+    FusedBinopDataProto* fused_proto = proto.mutable_fused_binop();
+    fused_proto->set_op(static_cast<int32_t>(fused->op));
+    XLS_ASSIGN_OR_RETURN(*fused_proto->mutable_lhs(), ToProto(fused->lhs));
+    XLS_ASSIGN_OR_RETURN(*fused_proto->mutable_rhs(), ToProto(fused->rhs));
+    if (fused->store_slot.has_value()) {
+      fused_proto->set_store_slot(fused->store_slot->value());
+    }
+    if (fused->jump_target.has_value()) {
+      fused_proto->set_jump_target(fused->jump_target->value());
+    }
+  } else {
+    return absl::UnimplementedError(absl::StrFormat(
+        "Cannot serialize data of bytecode: %s", bytecode.ToString()));
+  }
+  return proto;
+}
+
+absl::StatusOr<Bytecode> FromProto(const BytecodeProto& proto,
+                                   const ImportData& import_data) {
+  Span span = SpanFromProto(proto.span());
+  auto op = static_cast<Bytecode::Op>(proto.op());
+  switch (proto.data_oneof_case()) {
+    case BytecodeProto::DataOneofCase::DATA_ONEOF_NOT_SET:
+      return Bytecode(span, op);
+    case BytecodeProto::DataOneofCase::kValue: {
+      XLS_ASSIGN_OR_RETURN(InterpValue value,
+                           FromProto(proto.value(), import_data));
+      return Bytecode(span, op, std::move(value));
+    }
+    case BytecodeProto::DataOneofCase::kJumpTarget:
+      return Bytecode(span, op, Bytecode::JumpTarget(proto.jump_target()));
+    case BytecodeProto::DataOneofCase::kNumElements:
+      return Bytecode(span, op, Bytecode::NumElements(proto.num_elements()));
+    case BytecodeProto::DataOneofCase::kSlotIndex:
+      return Bytecode(span, op, Bytecode::SlotIndex(proto.slot_index()));
+    case BytecodeProto::DataOneofCase::kType: {
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<ConcreteType> type,
+                           ConcreteTypeFromProto(proto.type(), import_data));
+      return Bytecode(span, op, std::move(type));
+    }
+    case BytecodeProto::DataOneofCase::kInvocation: {
+      XLS_ASSIGN_OR_RETURN(
+          const AstNode* node,
+          import_data.FindNode(
+              AstNodeKind::kInvocation,
+              SpanFromProto(proto.invocation().invocation())));
+      Bytecode::InvocationData data{down_cast<const Invocation*>(node),
+                                    std::nullopt};
+      if (proto.invocation().has_bindings()) {
+        XLS_ASSIGN_OR_RETURN(
+            data.bindings,
+            FromProto(proto.invocation().bindings(), import_data));
+      }
+      return Bytecode(span, op, std::move(data));
+    }
+    case BytecodeProto::DataOneofCase::kMatchArmItem: {
+      XLS_ASSIGN_OR_RETURN(Bytecode::MatchArmItem item,
+                           FromProto(proto.match_arm_item(), import_data));
+      return Bytecode(span, op, std::move(item));
+    }
+    case BytecodeProto::DataOneofCase::kFusedBinop: {
+      const FusedBinopDataProto& fused = proto.fused_binop();
+      XLS_ASSIGN_OR_RETURN(Bytecode::FusedBinopData::Operand lhs,
+                           FromProto(fused.lhs(), import_data));
+      XLS_ASSIGN_OR_RETURN(Bytecode::FusedBinopData::Operand rhs,
+                           FromProto(fused.rhs(), import_data));
+      Bytecode::FusedBinopData data{
+          .op = static_cast<Bytecode::Op>(fused.op()),
+          .lhs = std::move(lhs),
+          .rhs = std::move(rhs)};
+      if (fused.has_store_slot()) {
+        data.store_slot = Bytecode::SlotIndex(fused.store_slot());
+      }
+      if (fused.has_jump_target()) {
+        data.jump_target = Bytecode::JumpTarget(fused.jump_target());
+      }
+      return Bytecode(span, op, std::move(data));
+    }
+  }
+  return absl::InvalidArgumentError(
+      "Invalid bytecode proto: " + proto.ShortDebugString());
+}
+
+}  // namespace
+
+absl::StatusOr<BytecodeFunctionProto> BytecodeFunctionToProto(
+    const BytecodeFunction& bf) {
+  BytecodeFunctionProto proto;
+  for (const Bytecode& bytecode : bf.bytecodes()) {
+    XLS_ASSIGN_OR_RETURN(*proto.add_bytecodes(), ToProto(bytecode));
+  }
+  return proto;
+}
+
+absl::StatusOr<std::unique_ptr<BytecodeFunction>> BytecodeFunctionFromProto(
+    const BytecodeFunctionProto& proto, const ImportData& import_data,
+    const Module* owner, const Function* source_fn,
+    const TypeInfo* type_info) {
+  std::vector<Bytecode> bytecodes;
+  bytecodes.reserve(proto.bytecodes_size());
+  for (const BytecodeProto& bytecode : proto.bytecodes()) {
+    XLS_ASSIGN_OR_RETURN(Bytecode b, FromProto(bytecode, import_data));
+    bytecodes.push_back(std::move(b));
+  }
+  return BytecodeFunction::Create(owner, source_fn, type_info,
+                                  std::move(bytecodes));
+}
+
+}  // namespace xls::dslx
@@ -0,0 +1,47 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_BYTECODE_BYTECODE_TO_PROTO_H_
+#define XLS_DSLX_BYTECODE_BYTECODE_TO_PROTO_H_
+
+#include <memory>
+
+#include "absl/status/statusor.h"
+#include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/bytecode/bytecode.pb.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/type_system/type_info.h"
+
+namespace xls::dslx {
+
+// Converts the given bytecode function to protobuf form for serialization.
+//
+// Returns an Unimplemented error for bytecode carrying data with no serialized
+// form yet (spawns, traces, channel operations, token or channel literals);
+// callers persisting bytecode should simply skip such functions.
+absl::StatusOr<BytecodeFunctionProto> BytecodeFunctionToProto(
+    const BytecodeFunction& bf);
+
+// Reconstitutes a bytecode function serialized by BytecodeFunctionToProto().
+// AST nodes referenced by the bytecode are resolved by span against the
+// modules in `import_data`; a NotFound error indicates the bytecode does not
+// match the currently-loaded sources.
+absl::StatusOr<std::unique_ptr<BytecodeFunction>> BytecodeFunctionFromProto(
+    const BytecodeFunctionProto& proto, const ImportData& import_data,
+    const Module* owner, const Function* source_fn, const TypeInfo* type_info);
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_BYTECODE_BYTECODE_TO_PROTO_H_
@@ -56,6 +56,11 @@ class Frame {
 
   void StoreSlot(Bytecode::SlotIndex slot_index, InterpValue value);
 
+  // Whether the result of this frame is recorded in the call cache when it
+  // returns. Cleared if the call executes a side-effecting operation.
+  bool memoize() const { return memoize_; }
+  void set_memoize(bool value) { memoize_ = value; }
+
  private:
   int64_t pc_;
   std::vector<InterpValue> slots_;
@@ -63,6 +68,7 @@ class Frame {
   const TypeInfo* type_info_;
   std::optional<ParametricEnv> bindings_;
   std::vector<InterpValue> initial_args_;
+  bool memoize_ = false;
 
   std::unique_ptr<BytecodeFunction> bf_holder_;
 };
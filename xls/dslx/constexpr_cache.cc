@@ -0,0 +1,49 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/constexpr_cache.h"
+
+#include <utility>
+#include <vector>
+
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/type_system/parametric_env.h"
+#include "xls/dslx/type_system/type_info.h"
+
+namespace xls::dslx {
+
+const ConstexprCache::Result* ConstexprCache::Find(
+    const Expr* expr, const TypeInfo* root_type_info,
+    const ParametricEnv& bindings, const Env& env) {
+  auto it = entries_.find(Key{{expr, root_type_info}, bindings});
+  if (it != entries_.end()) {
+    for (const Entry& entry : it->second) {
+      if (entry.env == env) {
+        ++hits_;
+        return &entry.result;
+      }
+    }
+  }
+  ++misses_;
+  return nullptr;
+}
+
+void ConstexprCache::Insert(const Expr* expr, const TypeInfo* root_type_info,
+                            const ParametricEnv& bindings, Env env,
+                            Result result) {
+  entries_[Key{{expr, root_type_info}, bindings}].push_back(
+      Entry{.env = std::move(env), .result = std::move(result)});
+}
+
+}  // namespace xls::dslx
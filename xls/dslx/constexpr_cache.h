@@ -0,0 +1,83 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_CONSTEXPR_CACHE_H_
+#define XLS_DSLX_CONSTEXPR_CACHE_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/frontend/pos.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/dslx/type_system/parametric_env.h"
+#include "xls/dslx/type_system/type_info.h"
+
+namespace xls::dslx {
+
+// Memoizes the values of expressions that the constexpr evaluator had to run
+// through the bytecode interpreter. Parametric instantiations and proc
+// configs each get their own TypeInfo, so without this the same expression
+// is emitted and interpreted again for every instance, even under identical
+// parametric bindings.
+//
+// Entries are keyed on the expression, the root TypeInfo of its module (which
+// stays unique for the lifetime of the owning ImportData, unlike Expr
+// addresses of modules that may be freed), the parametric bindings and the
+// values of the free variables the expression was evaluated with.
+class ConstexprCache {
+ public:
+  using Env = absl::flat_hash_map<std::string, InterpValue>;
+
+  struct Result {
+    InterpValue value;
+
+    // Spans at which evaluation detected rollover, to be re-reported as
+    // warnings on a cache hit.
+    std::vector<Span> rollovers;
+  };
+
+  // Returns the cached result for `expr` evaluated under `bindings` and `env`
+  // in a TypeInfo descended from `root_type_info`, or nullptr if there is
+  // none. The pointer is invalidated by the next Insert().
+  const Result* Find(const Expr* expr, const TypeInfo* root_type_info,
+                     const ParametricEnv& bindings, const Env& env);
+
+  void Insert(const Expr* expr, const TypeInfo* root_type_info,
+              const ParametricEnv& bindings, Env env, Result result);
+
+  int64_t hits() const { return hits_; }
+  int64_t misses() const { return misses_; }
+
+ private:
+  using Key = std::pair<std::pair<const Expr*, const TypeInfo*>, ParametricEnv>;
+
+  struct Entry {
+    Env env;
+    Result result;
+  };
+
+  // InterpValue is not hashable, so the few entries sharing a key are told
+  // apart by comparing their environments.
+  absl::flat_hash_map<Key, std::vector<Entry>> entries_;
+  int64_t hits_ = 0;
+  int64_t misses_ = 0;
+};
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_CONSTEXPR_CACHE_H_
@@ -31,6 +31,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "absl/types/variant.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -38,6 +39,7 @@
 #include "xls/dslx/bytecode/bytecode_emitter.h"
 #include "xls/dslx/bytecode/bytecode_interpreter.h"
 #include "xls/dslx/bytecode/bytecode_interpreter_options.h"
+#include "xls/dslx/constexpr_cache.h"
 #include "xls/dslx/errors.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/frontend/ast_utils.h"
@@ -628,6 +630,31 @@ absl::Status ConstexprEvaluator::InterpretExpr(const Expr* expr) {
       env, MakeConstexprEnv(import_data_, type_info_, warning_collector_, expr,
                             bindings_));
 
+  auto report_rollovers = [&](absl::Span<const Span> rollovers) {
+    if (warning_collector_ == nullptr) {
+      return;
+    }
+    for (const Span& s : rollovers) {
+      warning_collector_->Add(
+          s, WarningKind::kConstexprEvalRollover,
+          "constexpr evaluation detected rollover in operation");
+    }
+  };
+
+  // Other instantiations may already have interpreted this expression with
+  // the same bindings.
+  ConstexprCache& cache = import_data_->constexpr_cache();
+  XLS_ASSIGN_OR_RETURN(const TypeInfo* root_type_info,
+                       import_data_->type_info_owner().GetRootTypeInfo(
+                           type_info_->module()));
+  if (const ConstexprCache::Result* cached =
+          cache.Find(expr, root_type_info, bindings_, env);
+      cached != nullptr) {
+    report_rollovers(cached->rollovers);
+    type_info_->NoteConstExpr(expr, cached->value);
+    return absl::OkStatus();
+  }
+
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<BytecodeFunction> bf,
                        BytecodeEmitter::EmitExpression(import_data_, type_info_,
                                                        expr, env, bindings_));
@@ -638,14 +665,11 @@ absl::Status ConstexprEvaluator::InterpretExpr(const Expr* expr) {
   XLS_ASSIGN_OR_RETURN(InterpValue constexpr_value,
                        BytecodeInterpreter::Interpret(import_data_, bf.get(),
                                                       /*args=*/{}));
-  if (warning_collector_ != nullptr) {
-    for (const Span& s : rollovers) {
-      warning_collector_->Add(
-          s, WarningKind::kConstexprEvalRollover,
-          "constexpr evaluation detected rollover in operation");
-    }
-  }
+  report_rollovers(rollovers);
   type_info_->NoteConstExpr(expr, constexpr_value);
+  cache.Insert(expr, root_type_info, bindings_, std::move(env),
+               ConstexprCache::Result{.value = constexpr_value,
+                                      .rollovers = std::move(rollovers)});
 
   return absl::OkStatus();
 }
@@ -13,6 +13,7 @@
 // limitations under the License.
 #include "xls/dslx/constexpr_evaluator.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -566,5 +567,38 @@ fn main() -> u32 {
   EXPECT_EQ(value.GetBitValueViaSign().value(), 5);
 }
 
+TEST(ConstexprEvaluatorTest, ReusesInterpretedValueAcrossTypeInfos) {
+  constexpr std::string_view kProgram = R"(
+fn main() -> u32 {
+  u32:3 * u32:4
+}
+)";
+
+  ImportData import_data(CreateImportDataForTest());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheck(kProgram, "test.x", "test", &import_data));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           tm.module->GetMemberOrError<Function>("main"));
+  Expr* body = GetSingleBodyExpr(f);
+
+  // Sibling type infos, as for two instantiations of a parametric function,
+  // each have to determine the value themselves; only the first one runs the
+  // interpreter.
+  const int64_t initial_hits = import_data.constexpr_cache().hits();
+  for (int64_t i = 0; i < 2; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        TypeInfo * type_info,
+        import_data.type_info_owner().New(tm.module, tm.type_info));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        InterpValue value,
+        ConstexprEvaluator::EvaluateToValue(&import_data, type_info,
+                                            /*warning_collector=*/nullptr,
+                                            ParametricEnv(), body));
+    EXPECT_EQ(value.GetBitValueViaSign().value(), 12);
+    EXPECT_EQ(import_data.constexpr_cache().hits(), initial_hits + i);
+  }
+}
+
 }  // namespace
 }  // namespace xls::dslx
@@ -119,6 +119,26 @@ absl::StatusOr<int64_t> ArraySize(const ArrayTypeAnnotation* type_annotation,
   return InterpretInt(type_annotation->dim(), type_info, import_data);
 }
 
+// Returns c++ code which writes the bit-vector `identifier` with `bit_count`
+// bits as the next leaf element of a native layout buffer.
+std::string WriteNativeLeaf(std::string_view identifier, int64_t bit_count) {
+  return absl::StrFormat(
+      "__WriteNativeLeaf(static_cast<uint64_t>(%s), %d, "
+      "elements[(*leaf_index)++], buffer);",
+      identifier, bit_count);
+}
+
+// Returns c++ code which reads the next leaf element of a native layout buffer
+// into `lhs` of c++ type `cpp_type` representing a bit-vector with `bit_count`
+// bits.
+std::string ReadNativeLeaf(std::string_view lhs, std::string_view cpp_type,
+                           int64_t bit_count, bool is_signed) {
+  return absl::StrFormat(
+      "%s = static_cast<%s>(__ReadNativeLeaf%s(%d, elements[(*leaf_index)++], "
+      "buffer));",
+      lhs, cpp_type, is_signed ? "Signed" : "", bit_count);
+}
+
 // An emitter for bit-vector types which are represented using C++ primitive
 // types (bool, int8_t, uint16_t, etc).
 class BitVectorCppEmitter : public CppEmitter {
@@ -223,6 +243,20 @@ class BitVectorCppEmitter : public CppEmitter {
                         ValueAsDslxString(identifier), ";");
   }
 
+  std::optional<std::string> WriteNativeLayout(
+      std::string_view identifier, int64_t nesting) const override {
+    return WriteNativeLeaf(identifier, dslx_bit_count());
+  }
+
+  std::optional<std::string> ReadNativeLayout(std::string_view lhs,
+                                              int64_t nesting) const override {
+    return ReadNativeLeaf(lhs, cpp_type(), dslx_bit_count(), is_signed());
+  }
+
+  std::optional<std::string> NativeLayoutLeafCount() const override {
+    return "1";
+  }
+
   std::optional<int64_t> GetBitCountIfBitVector() const override {
     return dslx_bit_count_;
   }
@@ -256,13 +290,21 @@ class TypeRefCppEmitter : public CppEmitter {
  public:
   // `dslx_bit_count` contains the bit count of the underlying DSLX type if it
   // is a bit-vector or std::nullopt otherwise.
+  //
+  // `aliased_emitter` is the emitter of the aliased type if the type ref refers
+  // to a type alias. It is used for native layout conversions, which are not
+  // emitted as separate functions for type aliases.
   explicit TypeRefCppEmitter(const TypeRefTypeAnnotation* type_annotation,
                              std::string_view cpp_type,
                              std::string_view dslx_type,
-                             std::optional<int64_t> dslx_bit_count)
+                             std::optional<int64_t> dslx_bit_count,
+                             bool is_signed,
+                             std::unique_ptr<CppEmitter> aliased_emitter)
       : CppEmitter(cpp_type, dslx_type),
         typeref_type_annotation_(type_annotation),
-        dslx_bit_count_(dslx_bit_count) {}
+        dslx_bit_count_(dslx_bit_count),
+        is_signed_(is_signed),
+        aliased_emitter_(std::move(aliased_emitter)) {}
   ~TypeRefCppEmitter() override = default;
 
   static absl::StatusOr<std::unique_ptr<TypeRefCppEmitter>> Create(
@@ -278,8 +320,23 @@ class TypeRefCppEmitter : public CppEmitter {
                            GetBitCountFromBitVectorMetadata(
                                *bit_vector_metadata, type_info, import_data));
     }
-    return std::make_unique<TypeRefCppEmitter>(type_annotation, cpp_type,
-                                               dslx_type, dslx_bit_count);
+    std::unique_ptr<CppEmitter> aliased_emitter;
+    if (std::holds_alternative<TypeAlias*>(
+            type_annotation->type_ref()->type_definition())) {
+      const TypeAlias* type_alias =
+          std::get<TypeAlias*>(type_annotation->type_ref()->type_definition());
+      absl::StatusOr<std::unique_ptr<CppEmitter>> emitter =
+          CppEmitter::Create(type_alias->type_annotation(),
+                             type_alias->identifier(), type_info, import_data);
+      // An unsupported aliased type only disables native layout conversion.
+      if (emitter.ok()) {
+        aliased_emitter = std::move(emitter).value();
+      }
+    }
+    return std::make_unique<TypeRefCppEmitter>(
+        type_annotation, cpp_type, dslx_type, dslx_bit_count,
+        bit_vector_metadata.has_value() && bit_vector_metadata->is_signed,
+        std::move(aliased_emitter));
   }
 
   std::string AssignToValue(std::string_view lhs, std::string_view rhs,
@@ -331,6 +388,49 @@ class TypeRefCppEmitter : public CppEmitter {
                               indent_amount));
   }
 
+  std::optional<std::string> WriteNativeLayout(
+      std::string_view identifier, int64_t nesting) const override {
+    if (TypeHasMethods()) {
+      return absl::StrFormat(
+          "%s.WriteNativeLayout(elements, leaf_index, buffer);", identifier);
+    }
+    if (dslx_bit_count_.has_value()) {
+      return WriteNativeLeaf(identifier, *dslx_bit_count_);
+    }
+    if (aliased_emitter_ != nullptr) {
+      return aliased_emitter_->WriteNativeLayout(identifier, nesting);
+    }
+    return std::nullopt;
+  }
+
+  std::optional<std::string> ReadNativeLayout(std::string_view lhs,
+                                              int64_t nesting) const override {
+    if (TypeHasMethods()) {
+      return absl::StrFormat(
+          "%s.ReadNativeLayout(elements, leaf_index, buffer);", lhs);
+    }
+    if (dslx_bit_count_.has_value()) {
+      return ReadNativeLeaf(lhs, cpp_type(), *dslx_bit_count_, is_signed_);
+    }
+    if (aliased_emitter_ != nullptr) {
+      return aliased_emitter_->ReadNativeLayout(lhs, nesting);
+    }
+    return std::nullopt;
+  }
+
+  std::optional<std::string> NativeLayoutLeafCount() const override {
+    if (TypeHasMethods()) {
+      return absl::StrCat(cpp_type(), "::kNativeLayoutLeafCount");
+    }
+    if (dslx_bit_count_.has_value()) {
+      return "1";
+    }
+    if (aliased_emitter_ != nullptr) {
+      return aliased_emitter_->NativeLayoutLeafCount();
+    }
+    return std::nullopt;
+  }
+
   bool TypeHasMethods() const {
     return std::holds_alternative<StructDef*>(
         typeref_type_annotation_->type_ref()->type_definition());
@@ -342,8 +442,10 @@ class TypeRefCppEmitter : public CppEmitter {
 
  protected:
   const TypeRefTypeAnnotation* typeref_type_annotation_;
-  // Bit-count of the underlying DSLX type if it is a bitvector.
+  // Bit-count and signedness of the underlying DSLX type if it is a bitvector.
   std::optional<int64_t> dslx_bit_count_;
+  bool is_signed_;
+  std::unique_ptr<CppEmitter> aliased_emitter_;
 };
 
 // An emitter for DSLX array types which are represented in C++ using
@@ -465,9 +567,50 @@ class ArrayCppEmitter : public CppEmitter {
                         });
   }
 
+  std::optional<std::string> WriteNativeLayout(
+      std::string_view identifier, int64_t nesting) const override {
+    std::string ind_var = absl::StrCat("i", nesting);
+    std::optional<std::string> element_write =
+        element_emitter_->WriteNativeLayout(
+            absl::StrFormat("%s[%s]", identifier, ind_var), nesting + 1);
+    if (!element_write.has_value()) {
+      return std::nullopt;
+    }
+    return EmitLoop(*element_write, nesting);
+  }
+
+  std::optional<std::string> ReadNativeLayout(std::string_view lhs,
+                                              int64_t nesting) const override {
+    std::string ind_var = absl::StrCat("i", nesting);
+    std::optional<std::string> element_read =
+        element_emitter_->ReadNativeLayout(
+            absl::StrFormat("%s[%s]", lhs, ind_var), nesting + 1);
+    if (!element_read.has_value()) {
+      return std::nullopt;
+    }
+    return EmitLoop(*element_read, nesting);
+  }
+
+  std::optional<std::string> NativeLayoutLeafCount() const override {
+    std::optional<std::string> element_count =
+        element_emitter_->NativeLayoutLeafCount();
+    if (!element_count.has_value()) {
+      return std::nullopt;
+    }
+    return absl::StrFormat("%d * (%s)", array_size(), *element_count);
+  }
+
   int64_t array_size() const { return array_size_; }
 
  protected:
+  // Emits a loop over the array indices with the given body.
+  std::string EmitLoop(std::string_view body, int64_t nesting) const {
+    std::string ind_var = absl::StrCat("i", nesting);
+    return absl::StrFormat("for (int64_t %s = 0; %s < %d; ++%s) {\n%s\n}",
+                           ind_var, ind_var, array_size(), ind_var,
+                           Indent(body, 2));
+  }
+
   // Emits the C++ code for printing the array using the specified emitter
   // function.
   std::string EmitToString(
@@ -618,6 +761,53 @@ class TupleCppEmitter : public CppEmitter {
     return absl::StrJoin(pieces, "\n");
   }
 
+  std::optional<std::string> WriteNativeLayout(
+      std::string_view identifier, int64_t nesting) const override {
+    std::vector<std::string> pieces;
+    for (int64_t i = 0; i < size(); ++i) {
+      std::optional<std::string> element_write =
+          element_emitters_[i]->WriteNativeLayout(
+              absl::StrFormat("std::get<%d>(%s)", i, identifier), nesting + 1);
+      if (!element_write.has_value()) {
+        return std::nullopt;
+      }
+      pieces.push_back(*element_write);
+    }
+    return absl::StrJoin(pieces, "\n");
+  }
+
+  std::optional<std::string> ReadNativeLayout(std::string_view lhs,
+                                              int64_t nesting) const override {
+    std::vector<std::string> pieces;
+    for (int64_t i = 0; i < size(); ++i) {
+      std::optional<std::string> element_read =
+          element_emitters_[i]->ReadNativeLayout(
+              absl::StrFormat("std::get<%d>(%s)", i, lhs), nesting + 1);
+      if (!element_read.has_value()) {
+        return std::nullopt;
+      }
+      pieces.push_back(*element_read);
+    }
+    return absl::StrJoin(pieces, "\n");
+  }
+
+  std::optional<std::string> NativeLayoutLeafCount() const override {
+    std::vector<std::string> element_counts;
+    for (const std::unique_ptr<CppEmitter>& element_emitter :
+         element_emitters_) {
+      std::optional<std::string> element_count =
+          element_emitter->NativeLayoutLeafCount();
+      if (!element_count.has_value()) {
+        return std::nullopt;
+      }
+      element_counts.push_back(*element_count);
+    }
+    if (element_counts.empty()) {
+      return "0";
+    }
+    return absl::StrFormat("(%s)", absl::StrJoin(element_counts, " + "));
+  }
+
   int64_t size() const { return element_emitters_.size(); }
 
  protected:
@@ -104,6 +104,27 @@ class CppEmitter {
                                    std::string_view identifier,
                                    int64_t nesting) const = 0;
 
+  // Emits and returns c++ code which writes `identifier` of type `cpp_type()`
+  // to the uint8_t buffer `buffer` in the native data layout used by the JIT
+  // (see xls/jit/type_layout.h). The leaves of the value are written using the
+  // element layouts `elements[*leaf_index]` onwards, where `elements` is an
+  // absl::Span<const ::xls::ElementLayout> and `leaf_index` an int64_t*, and
+  // `*leaf_index` is advanced past them. The value must already be verified.
+  // Returns std::nullopt if the type does not support conversion to the native
+  // layout.
+  virtual std::optional<std::string> WriteNativeLayout(
+      std::string_view identifier, int64_t nesting) const = 0;
+
+  // Emits and returns c++ code which reads `lhs` of type `cpp_type()` from the
+  // native layout in `buffer`. See WriteNativeLayout.
+  virtual std::optional<std::string> ReadNativeLayout(
+      std::string_view lhs, int64_t nesting) const = 0;
+
+  // Returns a c++ constant expression giving the number of leaf elements of the
+  // type in the native layout, or std::nullopt if the type does not support
+  // conversion to the native layout.
+  virtual std::optional<std::string> NativeLayoutLeafCount() const = 0;
+
   // If the underlying DSLX type is a bit vector then return its bit
   // count. Otherwise return std::nullopt.
   virtual std::optional<int64_t> GetBitCountIfBitVector() const {
@@ -48,6 +48,8 @@ absl::StatusOr<CppSource> TranspileToCpp(Module* module,
 #include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/jit/type_layout.h"
 #include "xls/public/value.h"
 
 $2$1$3
@@ -67,6 +69,7 @@ $2$1$3
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "xls/jit/type_layout.h"
 #include "xls/public/status_macros.h"
 #include "xls/public/value.h"
 
@@ -93,6 +96,49 @@ static std::string __indent(int64_t amount) {
   return std::string(amount * 2, ' ');
 }
 
+// Writes `value`, a bit-vector with `bit_count` bits, to the leaf element of
+// the native (JIT) layout described by `element`. Bytes past the value are
+// zeroed.
+static void __WriteNativeLeaf(uint64_t value, int64_t bit_count,
+                              const ::xls::ElementLayout& element,
+                              uint8_t* buffer) {
+  if (bit_count < 64) {
+    value &= (uint64_t{1} << bit_count) - 1;
+  }
+  for (int64_t i = 0; i < element.padded_size; ++i) {
+    buffer[element.offset + i] =
+        i < element.data_size && i < 8 ? static_cast<uint8_t>(value >> (8 * i))
+                                       : 0;
+  }
+}
+
+// Reads the bit-vector with `bit_count` bits stored in the leaf element of the
+// native (JIT) layout described by `element`.
+static uint64_t __ReadNativeLeaf(int64_t bit_count,
+                                 const ::xls::ElementLayout& element,
+                                 const uint8_t* buffer) {
+  uint64_t value = 0;
+  for (int64_t i = 0; i < element.data_size && i < 8; ++i) {
+    value |= uint64_t{buffer[element.offset + i]} << (8 * i);
+  }
+  if (bit_count < 64) {
+    value &= (uint64_t{1} << bit_count) - 1;
+  }
+  return value;
+}
+
+// As __ReadNativeLeaf but sign-extends the value.
+static int64_t __ReadNativeLeafSigned(int64_t bit_count,
+                                      const ::xls::ElementLayout& element,
+                                      const uint8_t* buffer) {
+  uint64_t value = __ReadNativeLeaf(bit_count, element, buffer);
+  if (bit_count == 0 || bit_count >= 64) {
+    return static_cast<int64_t>(value);
+  }
+  uint64_t sign = uint64_t{1} << (bit_count - 1);
+  return static_cast<int64_t>((value ^ sign) - sign);
+}
+
 %s%s%s
 )";
   XLS_ASSIGN_OR_RETURN(TypeInfo * type_info,
@@ -454,6 +454,7 @@ class StructCppTypeGenerator : public CppTypeGenerator {
 
     CppSource from_value_method = FromValueMethod();
     CppSource to_value_method = ToValueMethod();
+    std::optional<NativeLayoutSource> native_layout = NativeLayoutMethods();
     CppSource to_string_method = ToStringMethod();
     CppSource to_dslx_string_method = ToDslxStringMethod();
     CppSource verify_method = VerifyMethod();
@@ -469,8 +470,15 @@ class StructCppTypeGenerator : public CppTypeGenerator {
                         scalar_widths.end());
       hdr_pieces.push_back("");
     }
+    if (native_layout.has_value()) {
+      hdr_pieces.push_back(native_layout->leaf_count);
+      hdr_pieces.push_back("");
+    }
     hdr_pieces.push_back(from_value_method.header);
     hdr_pieces.push_back(to_value_method.header);
+    if (native_layout.has_value()) {
+      hdr_pieces.push_back(native_layout->methods.header);
+    }
     hdr_pieces.push_back(to_string_method.header);
     hdr_pieces.push_back(to_dslx_string_method.header);
     hdr_pieces.push_back(verify_method.header);
@@ -484,16 +492,119 @@ class StructCppTypeGenerator : public CppTypeGenerator {
 
     std::string header =
         absl::StrFormat("struct %s {\n%s\n};", cpp_type(), Indent(members, 2));
-    std::string source =
-        absl::StrJoin({from_value_method.source, to_value_method.source,
-                       to_string_method.source, to_dslx_string_method.source,
-                       verify_method.source, operator_eq_method.source,
-                       operator_stream_method.source},
-                      "\n\n");
+    std::vector<std::string> src_pieces = {from_value_method.source,
+                                           to_value_method.source};
+    if (native_layout.has_value()) {
+      src_pieces.push_back(native_layout->methods.source);
+    }
+    src_pieces.insert(
+        src_pieces.end(),
+        {to_string_method.source, to_dslx_string_method.source,
+         verify_method.source, operator_eq_method.source,
+         operator_stream_method.source});
+    std::string source = absl::StrJoin(src_pieces, "\n\n");
     return CppSource{.header = header, .source = source};
   }
 
  protected:
+  struct NativeLayoutSource {
+    // Declaration of the constant holding the number of leaf elements.
+    std::string leaf_count;
+    CppSource methods;
+  };
+
+  // Returns the methods converting the struct to and from the native data
+  // layout used by the JIT (see xls/jit/type_layout.h), or std::nullopt if a
+  // member type does not support the conversion. The public methods take the
+  // TypeLayout of the struct; the Read/WriteNativeLayout methods are used by
+  // the conversions of types containing the struct.
+  std::optional<NativeLayoutSource> NativeLayoutMethods() const {
+    std::vector<std::string> leaf_counts;
+    std::vector<std::string> writes;
+    std::vector<std::string> reads;
+    for (int i = 0; i < struct_def_->members().size(); i++) {
+      const std::string& member_name = struct_def_->GetMemberName(i);
+      std::optional<std::string> leaf_count =
+          member_emitters_[i]->NativeLayoutLeafCount();
+      std::optional<std::string> write =
+          member_emitters_[i]->WriteNativeLayout(member_name, /*nesting=*/0);
+      std::optional<std::string> read =
+          member_emitters_[i]->ReadNativeLayout(member_name, /*nesting=*/0);
+      if (!leaf_count.has_value() || !write.has_value() || !read.has_value()) {
+        return std::nullopt;
+      }
+      leaf_counts.push_back(*leaf_count);
+      writes.push_back(*write);
+      reads.push_back(*read);
+    }
+    if (leaf_counts.empty()) {
+      leaf_counts.push_back("0");
+      writes.push_back("// Empty struct.");
+      reads.push_back("// Empty struct.");
+    }
+
+    std::string check_layout =
+        "if (layout.elements().size() != kNativeLayoutLeafCount) {\n"
+        "  return absl::InvalidArgumentError(absl::StrFormat(\n"
+        "      \"Layout has %d elements, expected %d.\", "
+        "layout.elements().size(),\n"
+        "      kNativeLayoutLeafCount));\n"
+        "}";
+
+    std::vector<std::string> from_pieces;
+    from_pieces.push_back(check_layout);
+    from_pieces.push_back(absl::StrFormat("%s result;", cpp_type()));
+    from_pieces.push_back("int64_t leaf_index = 0;");
+    from_pieces.push_back(
+        "result.ReadNativeLayout(layout.elements(), &leaf_index, buffer);");
+    from_pieces.push_back("XLS_RETURN_IF_ERROR(result.Verify());");
+    from_pieces.push_back("return result;");
+
+    std::vector<std::string> to_pieces;
+    to_pieces.push_back(check_layout);
+    to_pieces.push_back("XLS_RETURN_IF_ERROR(Verify());");
+    to_pieces.push_back("int64_t leaf_index = 0;");
+    to_pieces.push_back("WriteNativeLayout(layout.elements(), &leaf_index, "
+                        "buffer);");
+    to_pieces.push_back("return absl::OkStatus();");
+
+    constexpr std::string_view kElementsParam =
+        "absl::Span<const ::xls::ElementLayout> elements, int64_t* leaf_index";
+    std::vector<std::string> headers = {
+        absl::StrFormat("static absl::StatusOr<%s> FromNativeLayout(const "
+                        "::xls::TypeLayout& layout, const uint8_t* buffer);",
+                        cpp_type()),
+        "absl::Status ToNativeLayout(const ::xls::TypeLayout& layout, uint8_t* "
+        "buffer) const;",
+        absl::StrFormat("void ReadNativeLayout(%s, const uint8_t* buffer);",
+                        kElementsParam),
+        absl::StrFormat("void WriteNativeLayout(%s, uint8_t* buffer) const;",
+                        kElementsParam)};
+    std::vector<std::string> sources = {
+        absl::StrFormat("absl::StatusOr<%s> %s::FromNativeLayout(const "
+                        "::xls::TypeLayout& layout, const uint8_t* buffer) "
+                        "{\n%s\n}",
+                        cpp_type(), cpp_type(),
+                        Indent(absl::StrJoin(from_pieces, "\n"), 2)),
+        absl::StrFormat("absl::Status %s::ToNativeLayout(const "
+                        "::xls::TypeLayout& layout, uint8_t* buffer) const "
+                        "{\n%s\n}",
+                        cpp_type(), Indent(absl::StrJoin(to_pieces, "\n"), 2)),
+        absl::StrFormat(
+            "void %s::ReadNativeLayout(%s, const uint8_t* buffer) {\n%s\n}",
+            cpp_type(), kElementsParam, Indent(absl::StrJoin(reads, "\n"), 2)),
+        absl::StrFormat(
+            "void %s::WriteNativeLayout(%s, uint8_t* buffer) const {\n%s\n}",
+            cpp_type(), kElementsParam,
+            Indent(absl::StrJoin(writes, "\n"), 2))};
+    return NativeLayoutSource{
+        .leaf_count = absl::StrFormat(
+            "static constexpr int64_t kNativeLayoutLeafCount = %s;",
+            absl::StrJoin(leaf_counts, " + ")),
+        .methods = CppSource{.header = absl::StrJoin(headers, "\n"),
+                             .source = absl::StrJoin(sources, "\n\n")}};
+  }
+
   CppSource FromValueMethod() const {
     std::vector<std::string> pieces;
     pieces.push_back(absl::StrFormat(
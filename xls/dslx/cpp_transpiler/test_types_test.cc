@@ -12,13 +12,22 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "xls/common/status/matchers.h"
 #include "xls/dslx/cpp_transpiler/test_types_lib.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 namespace {
@@ -27,6 +36,14 @@ using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
 using testing::HasSubstr;
 
+// Returns the native layout used by the JIT for `type`.
+TypeLayout CreateTypeLayout(Type* type) {
+  std::unique_ptr<OrcJit> orc_jit = OrcJit::Create().value();
+  LlvmTypeConverter type_converter(orc_jit->GetContext(),
+                                   orc_jit->CreateDataLayout().value());
+  return type_converter.CreateTypeLayout(type);
+}
+
 TEST(TestTypesTest, EnumToString) {
   EXPECT_EQ(MyEnumToString(test::MyEnum::kA), "MyEnum::kA");
   EXPECT_EQ(MyEnumToString(test::MyEnum::kB), "MyEnum::kB");
@@ -601,6 +618,58 @@ TEST(TestTypesTest, VerifyDoublyNestedStruct) {
           HasSubstr("InnerStruct.x value does not fit in 17 bits: 0x12d687")));
 }
 
+TEST(TestTypesTest, NestedStructNativeLayout) {
+  test::InnerStruct a{.x = 42, .y = test::MyEnum::kB};
+  test::InnerStruct b{.x = 123, .y = test::MyEnum::kC};
+  test::OuterStruct o{.a = a, .b = b, .c = 0xdead, .v = test::MyEnum::kA};
+  test::OuterOuterStruct s{
+      .q = test::EmptyStruct(), .some_array = {1, 2, 3}, .s = o};
+  XLS_ASSERT_OK_AND_ASSIGN(Value value, s.ToValue());
+  Package package("test");
+  TypeLayout layout = CreateTypeLayout(package.GetTypeForValue(value));
+
+  // The struct is written exactly as the JIT lays out the equivalent Value.
+  std::vector<uint8_t> expected(layout.size(), 0xff);
+  layout.ValueToNativeLayout(value, expected.data());
+  std::vector<uint8_t> buffer(layout.size(), 0xff);
+  XLS_ASSERT_OK(s.ToNativeLayout(layout, buffer.data()));
+  EXPECT_EQ(buffer, expected);
+  EXPECT_THAT(test::OuterOuterStruct::FromNativeLayout(layout, buffer.data()),
+              IsOkAndHolds(s));
+
+  // Values are verified before being written.
+  s.s.a.x = 1234567;
+  EXPECT_THAT(s.ToNativeLayout(layout, buffer.data()),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("InnerStruct.x value does not fit")));
+
+  // The layout must be of the struct's type.
+  XLS_ASSERT_OK_AND_ASSIGN(Value inner_value, a.ToValue());
+  TypeLayout inner_layout =
+      CreateTypeLayout(package.GetTypeForValue(inner_value));
+  EXPECT_THAT(test::OuterOuterStruct::FromNativeLayout(inner_layout,
+                                                       buffer.data()),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Layout has 2 elements, expected 9")));
+}
+
+TEST(TestTypesTest, SignedTupleNativeLayout) {
+  test::StructWithTuple s{.t = {1, -3, 5, -100000},
+                          .t2 = {2, 7, 6, 1000},
+                          .t3 = {0x7ffffffff, -8, 7, -1}};
+  XLS_ASSERT_OK_AND_ASSIGN(Value value, s.ToValue());
+  Package package("test");
+  TypeLayout layout = CreateTypeLayout(package.GetTypeForValue(value));
+
+  std::vector<uint8_t> expected(layout.size(), 0);
+  layout.ValueToNativeLayout(value, expected.data());
+  std::vector<uint8_t> buffer(layout.size(), 0);
+  XLS_ASSERT_OK(s.ToNativeLayout(layout, buffer.data()));
+  EXPECT_EQ(buffer, expected);
+  EXPECT_THAT(test::StructWithTuple::FromNativeLayout(layout, buffer.data()),
+              IsOkAndHolds(s));
+}
+
 TEST(TestTypesTest, SnakeCaseToString) {
   test::SnakeCaseStructT s{.some_field = 0x42,
                            .some_other_field = test::SnakeCaseEnumT::kA};
@@ -818,10 +818,10 @@ Module::~Module() {
 }
 
 const AstNode* Module::FindNode(AstNodeKind kind, const Span& target) const {
-  for (const auto& node : nodes_) {
+  for (const AstNode* node : nodes_.nodes()) {
     if (node->kind() == kind && node->GetSpan().has_value() &&
         node->GetSpan().value() == target) {
-      return node.get();
+      return node;
     }
   }
   return nullptr;
@@ -829,9 +829,9 @@ const AstNode* Module::FindNode(AstNodeKind kind, const Span& target) const {
 
 std::vector<const AstNode*> Module::FindIntercepting(const Pos& target) const {
   std::vector<const AstNode*> found;
-  for (const auto& node : nodes_) {
+  for (const AstNode* node : nodes_.nodes()) {
     if (node->GetSpan().has_value() && node->GetSpan()->Contains(target)) {
-      found.push_back(node.get());
+      found.push_back(node);
     }
   }
   return found;
@@ -47,6 +47,7 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/dslx/channel_direction.h"
 #include "xls/dslx/frontend/ast_node.h"  // IWYU pragma: export
+#include "xls/dslx/frontend/ast_node_arena.h"
 #include "xls/dslx/frontend/pos.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/foreign_function_data.pb.h"
@@ -3204,11 +3205,8 @@ class Module : public AstNode {
  private:
   template <typename T, typename... Args>
   T* MakeInternal(Args&&... args) {
-    std::unique_ptr<T> node =
-        std::make_unique<T>(this, std::forward<Args>(args)...);
-    T* ptr = node.get();
+    T* ptr = nodes_.Create<T>(this, std::forward<Args>(args)...);
     ptr->SetParentage();
-    nodes_.push_back(std::move(node));
     return ptr;
   }
 
@@ -3245,7 +3243,7 @@ class Module : public AstNode {
   const std::optional<std::filesystem::path> fs_path_;
 
   std::vector<ModuleMember> top_;  // Top-level members of this module.
-  std::vector<std::unique_ptr<AstNode>> nodes_;  // Lifetime-owned AST nodes.
+  AstNodeArena nodes_;  // Lifetime-owned AST nodes.
 
   // Map of top-level module member name to the member itself.
   absl::flat_hash_map<std::string, ModuleMember> top_by_name_;
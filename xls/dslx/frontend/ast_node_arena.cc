@@ -0,0 +1,50 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/frontend/ast_node_arena.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+
+#include "xls/dslx/frontend/ast_node.h"
+
+namespace xls::dslx {
+
+AstNodeArena::~AstNodeArena() {
+  // Node destructors do not touch other nodes; tear down newest first as a
+  // stack of individually owned nodes would.
+  for (auto it = nodes_.rbegin(); it != nodes_.rend(); ++it) {
+    (*it)->~AstNode();
+  }
+}
+
+void* AstNodeArena::Allocate(size_t size, size_t alignment) {
+  void* ptr = next_;
+  if (next_ == nullptr ||
+      std::align(alignment, size, ptr, remaining_) == nullptr) {
+    // Operator new[] storage is aligned for any fundamental type, so a fresh
+    // block needs no adjustment.
+    size_t block_size = std::max(size, kMinBlockSize);
+    blocks_.push_back(std::unique_ptr<std::byte[]>(new std::byte[block_size]));
+    bytes_reserved_ += block_size;
+    ptr = blocks_.back().get();
+    remaining_ = block_size;
+  }
+  next_ = static_cast<std::byte*>(ptr) + size;
+  remaining_ -= size;
+  return ptr;
+}
+
+}  // namespace xls::dslx
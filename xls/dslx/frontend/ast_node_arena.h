@@ -0,0 +1,77 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_FRONTEND_AST_NODE_ARENA_H_
+#define XLS_DSLX_FRONTEND_AST_NODE_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "xls/dslx/frontend/ast_node.h"
+
+namespace xls::dslx {
+
+// Owns AST nodes placed in large contiguous blocks instead of individual heap
+// allocations. Creating a node is a pointer bump in the common case, and all
+// nodes are destroyed together (in reverse creation order) when the arena is.
+//
+// Nodes cannot be freed individually; they live as long as the arena.
+class AstNodeArena {
+ public:
+  AstNodeArena() = default;
+  ~AstNodeArena();
+
+  AstNodeArena(const AstNodeArena&) = delete;
+  AstNodeArena& operator=(const AstNodeArena&) = delete;
+
+  template <typename T, typename... Args>
+  T* Create(Args&&... args) {
+    static_assert(std::is_base_of_v<AstNode, T>);
+    static_assert(alignof(T) <= alignof(std::max_align_t));
+    T* node = new (Allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+    nodes_.push_back(node);
+    return node;
+  }
+
+  // All nodes created in this arena, in creation order.
+  absl::Span<AstNode* const> nodes() const { return nodes_; }
+
+  // Number of bytes reserved from the heap for node storage.
+  int64_t bytes_reserved() const { return bytes_reserved_; }
+
+ private:
+  // Smallest block requested from the heap; larger nodes get a block of their
+  // own.
+  static constexpr size_t kMinBlockSize = 16 * 1024;
+
+  void* Allocate(size_t size, size_t alignment);
+
+  std::vector<std::unique_ptr<std::byte[]>> blocks_;
+  std::byte* next_ = nullptr;
+  size_t remaining_ = 0;
+  int64_t bytes_reserved_ = 0;
+
+  std::vector<AstNode*> nodes_;
+};
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_FRONTEND_AST_NODE_ARENA_H_
@@ -0,0 +1,98 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/frontend/ast_node_arena.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/dslx/frontend/ast_node.h"
+#include "xls/dslx/frontend/pos.h"
+
+namespace xls::dslx {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Minimal node that records its destruction.
+class TestNode : public AstNode {
+ public:
+  TestNode(int64_t id, std::vector<int64_t>* destroyed,
+           int64_t payload_size = 0)
+      : AstNode(nullptr),
+        id_(id),
+        destroyed_(destroyed),
+        payload_(payload_size) {}
+  ~TestNode() override { destroyed_->push_back(id_); }
+
+  AstNodeKind kind() const override { return AstNodeKind::kModule; }
+  std::string_view GetNodeTypeName() const override { return "TestNode"; }
+  std::string ToString() const override { return "test"; }
+  std::optional<Span> GetSpan() const override { return std::nullopt; }
+  std::vector<AstNode*> GetChildren(bool want_types) const override {
+    return {};
+  }
+  absl::Status Accept(AstNodeVisitor* v) const override {
+    return absl::OkStatus();
+  }
+
+  int64_t id() const { return id_; }
+
+ private:
+  int64_t id_;
+  std::vector<int64_t>* destroyed_;
+  std::vector<int64_t> payload_;  // Owns heap memory to release.
+};
+
+TEST(AstNodeArenaTest, DestroysNodesInReverseCreationOrder) {
+  std::vector<int64_t> destroyed;
+  {
+    AstNodeArena arena;
+    TestNode* a = arena.Create<TestNode>(0, &destroyed);
+    TestNode* b = arena.Create<TestNode>(1, &destroyed);
+    TestNode* c = arena.Create<TestNode>(2, &destroyed);
+    EXPECT_THAT(arena.nodes(), ElementsAre(a, b, c));
+    EXPECT_EQ(b->id(), 1);
+    EXPECT_TRUE(destroyed.empty());
+  }
+  EXPECT_THAT(destroyed, ElementsAre(2, 1, 0));
+}
+
+TEST(AstNodeArenaTest, SpillsIntoNewBlocks) {
+  std::vector<int64_t> destroyed;
+  constexpr int64_t kNodeCount = 10000;
+  {
+    AstNodeArena arena;
+    std::vector<TestNode*> nodes;
+    for (int64_t i = 0; i < kNodeCount; ++i) {
+      nodes.push_back(
+          arena.Create<TestNode>(i, &destroyed, /*payload_size=*/1));
+    }
+    EXPECT_GT(arena.bytes_reserved(), kNodeCount * sizeof(TestNode));
+    for (int64_t i = 0; i < kNodeCount; ++i) {
+      EXPECT_EQ(nodes[i]->id(), i);
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(nodes[i]) % alignof(TestNode), 0);
+    }
+  }
+  EXPECT_EQ(destroyed.size(), kNodeCount);
+}
+
+}  // namespace
+}  // namespace xls::dslx
@@ -0,0 +1,98 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "include/benchmark/benchmark.h"
+#include "xls/common/logging/logging.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/frontend/parser.h"
+#include "xls/dslx/frontend/scanner.h"
+#include "xls/dslx/frontend/token.h"
+
+namespace xls::dslx {
+namespace {
+
+// Returns the text of a DSLX module with `item_count` constants, each of which
+// is a `element_count`-element array literal, plus a struct definition and
+// function instantiating it. This is representative of generated inputs
+// (e.g. lookup tables) which dominate frontend time for large designs.
+std::string MakeModuleText(int64_t item_count, int64_t element_count) {
+  std::string text = R"(// Generated for benchmarking.
+struct Point {
+  x: u32,
+  y: u32,
+}
+
+)";
+  std::vector<std::string> elements;
+  elements.reserve(element_count);
+  for (int64_t i = 0; i < item_count; ++i) {
+    elements.clear();
+    for (int64_t j = 0; j < element_count; ++j) {
+      elements.push_back(absl::StrFormat("u32:0x%x", (i * 7919 + j) & 0xffff));
+    }
+    absl::StrAppendFormat(&text, "pub const TABLE_%d = u32[%d]:[%s];\n", i,
+                          element_count, absl::StrJoin(elements, ", "));
+    absl::StrAppendFormat(&text,
+                          "fn make_point_%d(a: u32) -> Point {\n"
+                          "  Point { x: a + TABLE_%d[u32:0], y: a - u32:%d }\n"
+                          "}\n",
+                          i, i, i);
+  }
+  return text;
+}
+
+// Arguments are the number of top-level constants and the number of elements
+// in each constant's array literal.
+void ModuleShapes(benchmark::internal::Benchmark* b) {
+  b->Args({64, 16});
+  b->Args({256, 64});
+  b->Args({16, 4096});
+}
+
+void BM_Scan(benchmark::State& state) {
+  std::string text = MakeModuleText(state.range(0), state.range(1));
+  for (auto _ : state) {
+    Scanner scanner("bench.x", text);
+    absl::StatusOr<std::vector<Token>> tokens = scanner.PopAll();
+    XLS_CHECK_OK(tokens.status());
+    benchmark::DoNotOptimize(tokens);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_Scan)->Apply(ModuleShapes);
+
+void BM_Parse(benchmark::State& state) {
+  std::string text = MakeModuleText(state.range(0), state.range(1));
+  for (auto _ : state) {
+    Scanner scanner("bench.x", text);
+    Parser parser("bench", &scanner);
+    absl::StatusOr<std::unique_ptr<Module>> module = parser.ParseModule();
+    XLS_CHECK_OK(module.status());
+    benchmark::DoNotOptimize(module);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_Parse)->Apply(ModuleShapes);
+
+}  // namespace
+}  // namespace xls::dslx
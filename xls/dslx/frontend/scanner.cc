@@ -14,7 +14,9 @@
 
 #include "xls/dslx/frontend/scanner.h"
 
+#include <algorithm>
 #include <cctype>
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <string>
@@ -70,14 +72,20 @@ bool Scanner::TryDropChar(char target) {
 }
 
 Token Scanner::PopComment(const Pos& start_pos) {
+  // Comments run through the end of the line (inclusive of the newline), so
+  // we can find the extent directly instead of popping character-wise.
+  std::string_view rest = std::string_view(text_).substr(index_);
+  size_t newline = rest.find('\n');
   std::string chars;
-  while (!AtCharEof()) {
-    char c = PopChar();
-    chars.append(1, c);
-    if (c == '\n') {
-      break;
-    }
+  if (newline == std::string_view::npos) {
+    chars = std::string(rest);
+    colno_ += rest.size();
+  } else {
+    chars = std::string(rest.substr(0, newline + 1));
+    lineno_ += 1;
+    colno_ = 0;
   }
+  index_ += chars.size();
   return Token(TokenKind::kComment, Span(start_pos, GetPos()), chars);
 }
 
@@ -268,11 +276,23 @@ absl::StatusOr<std::string> Scanner::ScanUntilDoubleQuote() {
 }
 
 /* static */ std::optional<Keyword> Scanner::GetKeyword(std::string_view s) {
-  static const auto* mapping = new absl::flat_hash_map<std::string, Keyword>{
+  static const auto* mapping =
+      new absl::flat_hash_map<std::string_view, Keyword>{
 #define MAKE_ITEM(__enum, unused, __str, ...) {__str, Keyword::__enum},
-      XLS_DSLX_KEYWORDS(MAKE_ITEM)
+          XLS_DSLX_KEYWORDS(MAKE_ITEM)
 #undef MAKE_ITEM
-  };
+      };
+  static const size_t max_keyword_size = [] {
+    size_t result = 0;
+    for (const auto& [text, _] : *mapping) {
+      result = std::max(result, text.size());
+    }
+    return result;
+  }();
+  // Most identifiers are longer than any keyword, so avoid hashing them.
+  if (s.size() > max_keyword_size) {
+    return std::nullopt;
+  }
   auto it = mapping->find(s);
   if (it == mapping->end()) {
     return std::nullopt;
@@ -287,12 +307,15 @@ absl::StatusOr<Token> Scanner::ScanIdentifierOrKeyword(char startc,
     return std::isalpha(c) != 0 || std::isdigit(c) != 0 || c == '_' ||
            c == '!' || c == '\'';
   };
-  std::string s = ScanWhile(startc, is_trailing_identifier_char);
+  const int64_t start_index = index_ - 1;
+  XLS_CHECK_EQ(text_[start_index], startc);
+  DropWhile(is_trailing_identifier_char);
+  std::string_view s = TextFrom(start_index);
   Span span(start_pos, GetPos());
   if (std::optional<Keyword> keyword = GetKeyword(s)) {
     return Token(span, *keyword);
   }
-  return Token(TokenKind::kIdentifier, span, std::move(s));
+  return Token(TokenKind::kIdentifier, span, std::string(s));
 }
 
 std::optional<CommentData> Scanner::TryPopComment() {
@@ -324,25 +347,28 @@ absl::StatusOr<std::optional<Token>> Scanner::TryPopWhitespaceOrComment() {
 }
 
 absl::StatusOr<Token> Scanner::ScanNumber(char startc, const Pos& start_pos) {
+  // The token text (including any leading minus sign and radix prefix) is
+  // contiguous in the input, so we slice it out once scanning is done.
+  const int64_t start_index = index_ - 1;
+  XLS_CHECK_EQ(text_[start_index], startc);
   bool negative = startc == '-';
   if (negative) {
     startc = PopChar();
   }
+  const int64_t digits_index = index_ - 1;
 
-  std::string s;
   if (startc == '0' && TryDropChar('x')) {  // Hex radix.
-    s = ScanWhile("0x", [](char c) {
+    DropWhile([](char c) {
       return ('0' <= c && c <= '9') || ('a' <= c && c <= 'f') ||
              ('A' <= c && c <= 'F') || c == '_';
     });
-    if (s == "0x") {
+    if (TextFrom(digits_index) == "0x") {
       return ScanErrorStatus(Span(GetPos(), GetPos()),
                              "Expected hex characters following 0x prefix.");
     }
   } else if (startc == '0' && TryDropChar('b')) {  // Bin prefix.
-    s = ScanWhile("0b",
-                  [](char c) { return ('0' <= c && c <= '1') || c == '_'; });
-    if (s == "0b") {
+    DropWhile([](char c) { return ('0' <= c && c <= '1') || c == '_'; });
+    if (TextFrom(digits_index) == "0b") {
       return ScanErrorStatus(Span(GetPos(), GetPos()),
                              "Expected binary characters following 0b prefix");
     }
@@ -352,7 +378,8 @@ absl::StatusOr<Token> Scanner::ScanNumber(char startc, const Pos& start_pos) {
           absl::StrFormat("Invalid digit for binary number: '%c'", PeekChar()));
     }
   } else {
-    s = ScanWhile(startc, [](char c) { return std::isdigit(c) != 0; });
+    DropWhile([](char c) { return std::isdigit(c) != 0; });
+    std::string_view s = TextFrom(digits_index);
     if (absl::StartsWith(s, "0") && s.size() != 1) {
       return ScanErrorStatus(
           Span(GetPos(), GetPos()),
@@ -361,10 +388,8 @@ absl::StatusOr<Token> Scanner::ScanNumber(char startc, const Pos& start_pos) {
     XLS_CHECK(!s.empty())
         << "Must have seen numerical digits to attempt to scan a number.";
   }
-  if (negative) {
-    s = "-" + s;
-  }
-  return Token(TokenKind::kNumber, Span(start_pos, GetPos()), s);
+  return Token(TokenKind::kNumber, Span(start_pos, GetPos()),
+               std::string(TextFrom(start_index)));
 }
 
 bool Scanner::AtWhitespace() const {
@@ -381,12 +406,24 @@ bool Scanner::AtWhitespace() const {
 }
 
 void Scanner::DropLeadingWhitespace() {
-  while (!AtCharEof()) {
-    if (AtWhitespace()) {
-      DropChar();
-    } else {
-      break;
+  // Hot loop: avoid the checked PopChar() for every whitespace character.
+  const int64_t size = text_.size();
+  while (index_ < size) {
+    switch (text_[index_]) {
+      case '\n':
+        lineno_ += 1;
+        colno_ = 0;
+        break;
+      case ' ':
+      case '\r':
+      case '\t':
+      case '\xa0':
+        colno_ += 1;
+        break;
+      default:
+        return;
     }
+    index_ += 1;
   }
 }
 
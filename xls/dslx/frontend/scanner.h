@@ -16,7 +16,6 @@
 #define XLS_DSLX_FRONTEND_CPP_SCANNER_H_
 
 #include <cstdint>
-#include <functional>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -80,7 +79,7 @@ class Scanner {
     std::vector<Token> tokens;
     while (!AtEof()) {
       XLS_ASSIGN_OR_RETURN(Token tok, Pop());
-      tokens.push_back(tok);
+      tokens.push_back(std::move(tok));
     }
     return tokens;
   }
@@ -124,20 +123,25 @@ class Scanner {
   // Precondition: The character stream must be positioned at an open quote.
   absl::StatusOr<Token> ScanChar(const Pos& start_pos);
 
-  // Scans from the current position until ftake returns false or EOF is
-  // reached.
-  std::string ScanWhile(std::string s, const std::function<bool(char)>& ftake) {
-    while (!AtCharEof()) {
-      char peek = PeekChar();
-      if (!ftake(peek)) {
-        break;
-      }
-      s.append(1, PopChar());
+  // Drops characters from the current position until `ftake` returns false or
+  // EOF is reached.
+  //
+  // Precondition: `ftake` must not accept newline characters, since only the
+  // column number is advanced.
+  template <typename F>
+  void DropWhile(F ftake) {
+    int64_t i = index_;
+    const int64_t size = text_.size();
+    while (i < size && ftake(text_[i])) {
+      ++i;
     }
-    return s;
+    colno_ += i - index_;
+    index_ = i;
   }
-  std::string ScanWhile(char c, const std::function<bool(char)>& ftake) {
-    return ScanWhile(std::string(1, c), ftake);
+
+  // Returns a view of the text scanned since `start_index`.
+  std::string_view TextFrom(int64_t start_index) const {
+    return std::string_view(text_).substr(start_index, index_ - start_index);
   }
 
   // Scans the identifier-looping entity beginning with startc.
@@ -97,9 +97,15 @@ absl::StatusOr<Token> TokenParser::PopTokenOrError(TokenKind target,
 absl::Status TokenParser::DropTokenOrError(TokenKind target, const Token* start,
                                            std::string_view context,
                                            Pos* limit_pos) {
-  XLS_ASSIGN_OR_RETURN(Token token,
-                       PopTokenOrError(target, start, context, limit_pos));
-  return absl::OkStatus();
+  XLS_ASSIGN_OR_RETURN(const Token* tok, PeekToken());
+  if (tok->kind() != target) {
+    // Slow path: produces the appropriate error message.
+    return PopTokenOrError(target, start, context, limit_pos).status();
+  }
+  if (limit_pos != nullptr) {
+    *limit_pos = tok->span().limit();
+  }
+  return DropToken();
 }
 
 absl::StatusOr<Token> TokenParser::PopKeywordOrError(Keyword keyword,
@@ -19,6 +19,7 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
@@ -132,7 +133,7 @@ class TokenParser {
   absl::StatusOr<const Token*> PeekToken() {
     if (index_ >= tokens_.size()) {
       XLS_ASSIGN_OR_RETURN(Token token, scanner_->Pop());
-      tokens_.push_back(token);
+      tokens_.push_back(std::move(token));
     }
     return &tokens_[index_];
   }
@@ -159,8 +160,13 @@ class TokenParser {
     return PopToken().value();
   }
 
-  // Wraps PopToken() to signify popping a token without needing the value.
-  absl::Status DropToken() { return PopToken().status(); }
+  // Pops a token without needing the value (and so without copying it out of
+  // the lookahead buffer).
+  absl::Status DropToken() {
+    XLS_RETURN_IF_ERROR(PeekToken().status());
+    index_ += 1;
+    return absl::OkStatus();
+  }
 
   void DropTokenOrDie() { XLS_CHECK_OK(DropToken()); }
 
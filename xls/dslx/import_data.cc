@@ -14,6 +14,7 @@
 
 #include "xls/dslx/import_data.h"
 
+#include <algorithm>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <string>
@@ -63,6 +64,34 @@ absl::StatusOr<ModuleInfo*> ImportData::Put(
   return pmodule_info;
 }
 
+std::vector<std::filesystem::path> ImportData::GetModulePaths() const {
+  std::vector<std::filesystem::path> paths;
+  paths.reserve(path_to_module_info_.size());
+  for (const auto& [path, module_info] : path_to_module_info_) {
+    paths.push_back(path);
+  }
+  std::sort(paths.begin(), paths.end());
+  return paths;
+}
+
+void ImportData::AddParsedModule(const ImportTokens& subject,
+                                 std::filesystem::path path,
+                                 std::unique_ptr<Module> module) {
+  parsed_modules_.insert_or_assign(
+      subject, std::make_pair(std::move(path), std::move(module)));
+}
+
+std::unique_ptr<Module> ImportData::TakeParsedModule(
+    const ImportTokens& subject, const std::filesystem::path& path) {
+  auto it = parsed_modules_.find(subject);
+  if (it == parsed_modules_.end() || it->second.first != path) {
+    return nullptr;
+  }
+  std::unique_ptr<Module> module = std::move(it->second.second);
+  parsed_modules_.erase(it);
+  return module;
+}
+
 absl::StatusOr<TypeInfo*> ImportData::GetRootTypeInfoForNode(
     const AstNode* node) {
   XLS_RET_CHECK(node != nullptr);
@@ -29,6 +29,7 @@
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "xls/dslx/bytecode/bytecode_cache_interface.h"
+#include "xls/dslx/constexpr_cache.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/import_record.h"
 #include "xls/dslx/interp_bindings.h"
@@ -130,6 +131,25 @@ class ImportData {
   absl::StatusOr<ModuleInfo*> Put(const ImportTokens& subject,
                                   std::unique_ptr<ModuleInfo> module_info);
 
+  // Returns the paths from which the modules managed by this object were
+  // loaded, in sorted order.
+  std::vector<std::filesystem::path> GetModulePaths() const;
+
+  // Notes a module parsed from `path` ahead of its import (see
+  // PrefetchImports()) so that DoImport() only has to typecheck it.
+  void AddParsedModule(const ImportTokens& subject, std::filesystem::path path,
+                       std::unique_ptr<Module> module);
+
+  bool HasParsedModule(const ImportTokens& subject) const {
+    return parsed_modules_.contains(subject);
+  }
+
+  // Returns the module noted via AddParsedModule() for `subject` and forgets
+  // it, or returns nullptr if there is none or it was parsed from a path other
+  // than `path`.
+  std::unique_ptr<Module> TakeParsedModule(const ImportTokens& subject,
+                                           const std::filesystem::path& path);
+
   TypeInfoOwner& type_info_owner() { return type_info_owner_; }
 
   // Helper that gets the "root" type information for the module of the given
@@ -184,6 +204,10 @@ class ImportData {
   void SetBytecodeCache(std::unique_ptr<BytecodeCacheInterface> bytecode_cache);
   BytecodeCacheInterface* bytecode_cache();
 
+  // Values of constexpr expressions that required running the bytecode
+  // interpreter, shared across all type information in this import set.
+  ConstexprCache& constexpr_cache() { return constexpr_cache_; }
+
   // Helpers for finding nodes in the cluster of modules managed by this object.
   //
   // These return a NotFound error if _either_ the module (implicitly
@@ -222,6 +246,9 @@ class ImportData {
   absl::StatusOr<const Module*> FindModule(const Span& span) const;
 
   absl::flat_hash_map<ImportTokens, std::unique_ptr<ModuleInfo>> modules_;
+  absl::flat_hash_map<ImportTokens,
+                      std::pair<std::filesystem::path, std::unique_ptr<Module>>>
+      parsed_modules_;
   absl::flat_hash_map<std::string, ModuleInfo*> path_to_module_info_;
   absl::flat_hash_map<Module*, std::unique_ptr<InterpBindings>>
       top_level_bindings_;
@@ -232,6 +259,7 @@ class ImportData {
   absl::Span<const std::filesystem::path> additional_search_paths_;
   WarningKindSet enabled_warnings_;
   std::unique_ptr<BytecodeCacheInterface> bytecode_cache_;
+  ConstexprCache constexpr_cache_;
 
   // See comment on AddToImporterStack() above.
   std::vector<ImportRecord> importer_stack_;
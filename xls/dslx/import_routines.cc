@@ -14,12 +14,17 @@
 
 #include "xls/dslx/import_routines.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <deque>
 #include <filesystem>  // NOLINT
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "absl/cleanup/cleanup.h"
@@ -29,17 +34,23 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/config/xls_config.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/common/thread.h"
+#include "xls/common/tracing.h"
 #include "xls/dslx/frontend/parser.h"
 #include "xls/dslx/frontend/scanner.h"
 #include "xls/dslx/import_data.h"
 
 namespace xls::dslx {
 
+// Upper bound on the number of threads used to parse imports concurrently.
+static constexpr int64_t kMaxPrefetchThreads = 8;
+
 static absl::StatusOr<std::filesystem::path> FindExistingPath(
     const ImportTokens& subject, const std::filesystem::path& stdlib_path,
     absl::Span<const std::filesystem::path> additional_search_paths,
@@ -136,6 +147,19 @@ static absl::StatusOr<std::filesystem::path> FindExistingPath(
                       GetCurrentDirectory().value(), stdlib_path));
 }
 
+static absl::StatusOr<std::unique_ptr<Module>> ParseImportedModule(
+    const ImportTokens& subject, const std::filesystem::path& path) {
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+
+  absl::Span<std::string const> pieces = subject.pieces();
+  std::string fully_qualified_name = absl::StrJoin(pieces, ".");
+  XLS_VLOG(3) << "Parsing " << fully_qualified_name << " from " << path;
+
+  Scanner scanner(path, contents);
+  Parser parser(/*module_name=*/fully_qualified_name, &scanner);
+  return parser.ParseModule();
+}
+
 absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
                                      const ImportTokens& subject,
                                      ImportData* import_data,
@@ -147,6 +171,7 @@ absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
   }
 
   XLS_VLOG(3) << "DoImport (uncached) subject: " << subject.ToString();
+  ScopedTraceSpan trace_span("dslx_import", subject.ToString());
 
   XLS_ASSIGN_OR_RETURN(
       std::filesystem::path found_path,
@@ -157,20 +182,119 @@ absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
   auto clenaup = absl::MakeCleanup(
       [&] { XLS_CHECK_OK(import_data->PopFromImporterStack(import_span)); });
 
-  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(found_path));
-
-  absl::Span<std::string const> pieces = subject.pieces();
-  std::string fully_qualified_name = absl::StrJoin(pieces, ".");
-  XLS_VLOG(3) << "Parsing and typechecking " << fully_qualified_name
-              << ": start";
-
-  Scanner scanner(found_path, contents);
-  Parser parser(/*module_name=*/fully_qualified_name, &scanner);
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Module> module, parser.ParseModule());
+  std::unique_ptr<Module> module =
+      import_data->TakeParsedModule(subject, found_path);
+  if (module == nullptr) {
+    XLS_ASSIGN_OR_RETURN(module, ParseImportedModule(subject, found_path));
+  } else {
+    XLS_VLOG(3) << "DoImport (prefetched) subject: " << subject.ToString();
+  }
   XLS_ASSIGN_OR_RETURN(TypeInfo * type_info, ftypecheck(module.get()));
   return import_data->Put(
       subject, std::make_unique<ModuleInfo>(std::move(module), type_info,
                                             std::move(found_path)));
 }
 
+void PrefetchImports(const Module& module, ImportData* import_data) {
+  struct PendingImport {
+    ImportTokens subject;
+    Span span;
+  };
+  struct ParsedImport {
+    ImportTokens subject;
+    std::filesystem::path path;
+    std::unique_ptr<Module> module;
+  };
+
+  const int64_t max_threads =
+      std::min<int64_t>(kMaxPrefetchThreads, AvailableCPUs());
+
+  // All of the following are guarded by `mu`. `import_data` is only read
+  // while prefetching; modules are added to it once all workers are done.
+  absl::Mutex mu;
+  absl::CondVar cv;
+  std::deque<PendingImport> pending;
+  absl::flat_hash_set<ImportTokens> seen;
+  std::vector<ParsedImport> parsed;
+  int64_t busy = 0;
+  std::vector<std::unique_ptr<Thread>> threads;
+
+  std::function<void()> worker;
+  // Queues the imports of `m` which have not been loaded or queued yet, adding
+  // a worker thread when there are more pending imports than idle workers.
+  auto enqueue_imports = [&](const Module& m) {
+    for (const ModuleMember& member : m.top()) {
+      if (!std::holds_alternative<Import*>(member)) {
+        continue;
+      }
+      const Import* import = std::get<Import*>(member);
+      ImportTokens subject(import->subject());
+      if (import_data->Contains(subject) ||
+          import_data->HasParsedModule(subject) ||
+          !seen.insert(subject).second) {
+        continue;
+      }
+      pending.push_back(PendingImport{std::move(subject), import->span()});
+      int64_t workers = threads.size() + 1;
+      if (workers < max_threads &&
+          busy + static_cast<int64_t>(pending.size()) > workers) {
+        threads.push_back(std::make_unique<Thread>([&worker] { worker(); }));
+      }
+    }
+    cv.SignalAll();
+  };
+
+  worker = [&] {
+    mu.Lock();
+    while (true) {
+      while (pending.empty() && busy > 0) {
+        cv.Wait(&mu);
+      }
+      if (pending.empty()) {
+        break;
+      }
+      PendingImport import = std::move(pending.front());
+      pending.pop_front();
+      ++busy;
+      mu.Unlock();
+
+      // Failures are dropped here: DoImport() retries the import when it is
+      // typechecked and reports the error in the usual order.
+      absl::StatusOr<std::filesystem::path> path =
+          FindExistingPath(import.subject, import_data->stdlib_path(),
+                           import_data->additional_search_paths(), import.span);
+      absl::StatusOr<std::unique_ptr<Module>> parsed_module =
+          path.ok() ? ParseImportedModule(import.subject, *path)
+                    : path.status();
+
+      mu.Lock();
+      --busy;
+      if (parsed_module.ok()) {
+        enqueue_imports(**parsed_module);
+        parsed.push_back(ParsedImport{std::move(import.subject),
+                                      *std::move(path),
+                                      *std::move(parsed_module)});
+      }
+      cv.SignalAll();
+    }
+    mu.Unlock();
+  };
+
+  mu.Lock();
+  enqueue_imports(module);
+  mu.Unlock();
+  worker();
+
+  mu.Lock();
+  std::vector<std::unique_ptr<Thread>> to_join = std::move(threads);
+  mu.Unlock();
+  for (std::unique_ptr<Thread>& thread : to_join) {
+    thread->Join();
+  }
+  for (ParsedImport& import : parsed) {
+    import_data->AddParsedModule(import.subject, std::move(import.path),
+                                 std::move(import.module));
+  }
+}
+
 }  // namespace xls::dslx
@@ -49,6 +49,18 @@ absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
                                      ImportData* import_data,
                                      const Span& import_span);
 
+// Locates and parses the modules transitively imported by `module` which are
+// not yet present in `import_data`, using several threads so that independent
+// imports are parsed concurrently. The parsed modules are noted in
+// `import_data` (see ImportData::AddParsedModule()) so that the DoImport()
+// calls made while typechecking `module` only have to typecheck them.
+//
+// Typechecking itself is still performed sequentially, in import order, by
+// DoImport(); this only moves file reading and parsing off the critical path.
+// Imports which cannot be found or parsed are skipped, and are reported when
+// DoImport() encounters them.
+void PrefetchImports(const Module& module, ImportData* import_data);
+
 }  // namespace xls::dslx
 
 #endif  // XLS_DSLX_IMPORT_ROUTINES_H_
@@ -0,0 +1,104 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/import_routines.h"
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/warning_kind.h"
+
+namespace xls::dslx {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+constexpr int kLeafCount = 16;
+
+// Writes a module importing `kLeafCount` independent leaf modules (each of
+// which imports std) into `dir`, returning the entry module's text.
+std::string WriteWideImportGraph(const std::filesystem::path& dir) {
+  std::string entry = "import std;\n";
+  std::string sum = "u32:0";
+  for (int i = 0; i < kLeafCount; ++i) {
+    XLS_CHECK_OK(SetFileContents(
+        dir / absl::StrFormat("leaf_%d.x", i),
+        absl::StrFormat("import std;\n"
+                        "pub fn f() -> u32 { std::umax(u32:%d, u32:0) }\n",
+                        i)));
+    absl::StrAppendFormat(&entry, "import leaf_%d;\n", i);
+    sum = absl::StrFormat("leaf_%d::f() + %s", i, sum);
+  }
+  absl::StrAppendFormat(&entry, "fn main() -> u32 { %s }\n", sum);
+  return entry;
+}
+
+TEST(ImportRoutinesTest, PrefetchParsesTransitiveImports) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::string entry = WriteWideImportGraph(temp_dir.path());
+  std::vector<std::filesystem::path> dslx_paths = {temp_dir.path()};
+  ImportData import_data(
+      CreateImportData(kDefaultDslxStdlibPath, dslx_paths, kAllWarningsSet));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Module> module,
+                           ParseModule(entry, "entry.x", "entry"));
+  PrefetchImports(*module, &import_data);
+  EXPECT_TRUE(import_data.HasParsedModule(ImportTokens({"std"})));
+  for (int i = 0; i < kLeafCount; ++i) {
+    EXPECT_TRUE(import_data.HasParsedModule(
+        ImportTokens({absl::StrFormat("leaf_%d", i)})));
+  }
+
+  // Typechecking consumes the prefetched modules.
+  XLS_ASSERT_OK(
+      TypecheckModule(std::move(module), "entry.x", &import_data).status());
+  EXPECT_FALSE(import_data.HasParsedModule(ImportTokens({"std"})));
+  EXPECT_EQ(import_data.GetModulePaths().size(), kLeafCount + 2);
+}
+
+TEST(ImportRoutinesTest, PrefetchDefersErrorsToImport) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::string entry = WriteWideImportGraph(temp_dir.path());
+  XLS_ASSERT_OK(SetFileContents(temp_dir.path() / "leaf_3.x",
+                                "pub fn f() -> u32 { u32:3 "));
+  std::vector<std::filesystem::path> dslx_paths = {temp_dir.path()};
+  ImportData import_data(
+      CreateImportData(kDefaultDslxStdlibPath, dslx_paths, kAllWarningsSet));
+
+  // The parse error is reported when the malformed leaf is imported, just as
+  // without prefetching.
+  EXPECT_THAT(
+      ParseAndTypecheck(entry, "entry.x", "entry", &import_data).status(),
+      StatusIs(absl::StatusCode::kInvalidArgument, HasSubstr("leaf_3.x")));
+}
+
+}  // namespace
+}  // namespace xls::dslx
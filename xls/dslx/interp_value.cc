@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -33,6 +34,7 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/format_preference.h"
@@ -87,6 +89,13 @@ std::string TagToString(InterpValueTag tag) {
 
 /* static */ InterpValue InterpValue::MakeTuple(
     std::vector<InterpValue> members) {
+  if (members.empty()) {
+    // Unit values are created for every statement-like expression, so they all
+    // share one (immutable) empty element vector rather than allocating.
+    static const SharedValues* kNoMembers =
+        new SharedValues(std::make_shared<const std::vector<InterpValue>>());
+    return InterpValue{InterpValueTag::kTuple, *kNoMembers};
+  }
   return InterpValue{InterpValueTag::kTuple, std::move(members)};
 }
 
@@ -361,6 +370,9 @@ bool InterpValue::Eq(const InterpValue& other) const {
   auto values_equal = [&] {
     const std::vector<InterpValue>& lhs = GetValuesOrDie();
     const std::vector<InterpValue>& rhs = other.GetValuesOrDie();
+    if (&lhs == &rhs) {
+      return true;
+    }
     if (lhs.size() != rhs.size()) {
       return false;
     }
@@ -416,6 +428,71 @@ bool InterpValue::Eq(const InterpValue& other) const {
 
 bool InterpValue::operator==(const InterpValue& rhs) const { return Eq(rhs); }
 
+// Bits values of at most this many bits are operated on directly as machine
+// words rather than through the generic bits_ops routines. (Their payload is
+// already stored inline, see InlineBitmap, so no separate representation is
+// needed.)
+static constexpr int64_t kMaxWordBitCount = 64;
+
+static uint64_t ToWord(const Bits& bits) { return bits.bitmap().GetWord(0); }
+
+static int64_t ToSignedWord(const Bits& bits) {
+  if (bits.bit_count() == 0) {
+    return 0;
+  }
+  int64_t shift = kMaxWordBitCount - bits.bit_count();
+  return static_cast<int64_t>(ToWord(bits) << shift) >> shift;
+}
+
+// Returns the low `bit_count` bits of `word` as a Bits value.
+static Bits FromWord(uint64_t word, int64_t bit_count) {
+  return Bits::FromBitmap(InlineBitmap::FromWord(word, bit_count));
+}
+
+struct WordOperands {
+  const Bits& lhs;
+  const Bits& rhs;
+};
+
+// Returns the bits of `lhs` and `rhs` if both are narrow enough for the word
+// fast path and, if `same_width`, are of the same width.
+static std::optional<WordOperands> GetWordOperands(const InterpValue& lhs,
+                                                   const InterpValue& rhs,
+                                                   bool same_width = true) {
+  if (!lhs.HasBits() || !rhs.HasBits()) {
+    return std::nullopt;
+  }
+  const Bits& lhs_bits = lhs.GetBitsOrDie();
+  const Bits& rhs_bits = rhs.GetBitsOrDie();
+  if (lhs_bits.bit_count() > kMaxWordBitCount ||
+      rhs_bits.bit_count() > kMaxWordBitCount ||
+      (same_width && lhs_bits.bit_count() != rhs_bits.bit_count())) {
+    return std::nullopt;
+  }
+  return WordOperands{lhs_bits, rhs_bits};
+}
+
+// Word fast path of InterpValue::Compare(); returns std::nullopt if the
+// operands are not both narrow bits values of the same signedness.
+template <typename CmpT>
+static std::optional<InterpValue> CompareWords(const InterpValue& lhs,
+                                               const InterpValue& rhs,
+                                               CmpT cmp) {
+  if (lhs.tag() != rhs.tag() || !lhs.IsBits()) {
+    return std::nullopt;
+  }
+  std::optional<WordOperands> ops =
+      GetWordOperands(lhs, rhs, /*same_width=*/false);
+  if (!ops.has_value()) {
+    return std::nullopt;
+  }
+  if (lhs.IsSBits()) {
+    return InterpValue::MakeBool(
+        cmp(ToSignedWord(ops->lhs), ToSignedWord(ops->rhs)));
+  }
+  return InterpValue::MakeBool(cmp(ToWord(ops->lhs), ToWord(ops->rhs)));
+}
+
 /* static */ absl::StatusOr<InterpValue> InterpValue::Compare(
     const InterpValue& lhs, const InterpValue& rhs, CompareF ucmp,
     CompareF scmp) {
@@ -436,31 +513,55 @@ bool InterpValue::operator==(const InterpValue& rhs) const { return Eq(rhs); }
 }
 
 absl::StatusOr<InterpValue> InterpValue::Gt(const InterpValue& other) const {
+  if (std::optional<InterpValue> result =
+          CompareWords(*this, other, std::greater<>())) {
+    return *std::move(result);
+  }
   return Compare(*this, other, &bits_ops::UGreaterThan,
                  &bits_ops::SGreaterThan);
 }
 
 absl::StatusOr<InterpValue> InterpValue::Ge(const InterpValue& other) const {
+  if (std::optional<InterpValue> result =
+          CompareWords(*this, other, std::greater_equal<>())) {
+    return *std::move(result);
+  }
   return Compare(*this, other, &bits_ops::UGreaterThanOrEqual,
                  &bits_ops::SGreaterThanOrEqual);
 }
 
 absl::StatusOr<InterpValue> InterpValue::Le(const InterpValue& other) const {
+  if (std::optional<InterpValue> result =
+          CompareWords(*this, other, std::less_equal<>())) {
+    return *std::move(result);
+  }
   return Compare(*this, other, &bits_ops::ULessThanOrEqual,
                  &bits_ops::SLessThanOrEqual);
 }
 
 absl::StatusOr<InterpValue> InterpValue::Lt(const InterpValue& other) const {
+  if (std::optional<InterpValue> result =
+          CompareWords(*this, other, std::less<>())) {
+    return *std::move(result);
+  }
   return Compare(*this, other, &bits_ops::ULessThan, &bits_ops::SLessThan);
 }
 
 absl::StatusOr<InterpValue> InterpValue::BitwiseNegate() const {
+  if (HasBits() && GetBitsOrDie().bit_count() <= kMaxWordBitCount) {
+    const Bits& bits = GetBitsOrDie();
+    return InterpValue(tag_, FromWord(~ToWord(bits), bits.bit_count()));
+  }
   XLS_ASSIGN_OR_RETURN(Bits b, GetBits());
   return InterpValue(tag_, bits_ops::Not(b));
 }
 
 absl::StatusOr<InterpValue> InterpValue::BitwiseXor(
     const InterpValue& other) const {
+  if (std::optional<WordOperands> ops = GetWordOperands(*this, other)) {
+    uint64_t result = ToWord(ops->lhs) ^ ToWord(ops->rhs);
+    return InterpValue(tag_, FromWord(result, ops->lhs.bit_count()));
+  }
   XLS_ASSIGN_OR_RETURN(Bits lhs, GetBits());
   XLS_ASSIGN_OR_RETURN(Bits rhs, other.GetBits());
   return InterpValue(tag_, bits_ops::Xor(lhs, rhs));
@@ -468,6 +569,10 @@ absl::StatusOr<InterpValue> InterpValue::BitwiseXor(
 
 absl::StatusOr<InterpValue> InterpValue::BitwiseOr(
     const InterpValue& other) const {
+  if (std::optional<WordOperands> ops = GetWordOperands(*this, other)) {
+    uint64_t result = ToWord(ops->lhs) | ToWord(ops->rhs);
+    return InterpValue(tag_, FromWord(result, ops->lhs.bit_count()));
+  }
   XLS_ASSIGN_OR_RETURN(Bits lhs, GetBits());
   XLS_ASSIGN_OR_RETURN(Bits rhs, other.GetBits());
   return InterpValue(tag_, bits_ops::Or(lhs, rhs));
@@ -476,12 +581,20 @@ absl::StatusOr<InterpValue> InterpValue::BitwiseOr(
 absl::StatusOr<InterpValue> InterpValue::BitwiseAnd(
     const InterpValue& other) const {
   XLS_RET_CHECK_EQ(tag(), other.tag());
+  if (std::optional<WordOperands> ops = GetWordOperands(*this, other)) {
+    uint64_t result = ToWord(ops->lhs) & ToWord(ops->rhs);
+    return InterpValue(tag_, FromWord(result, ops->lhs.bit_count()));
+  }
   XLS_ASSIGN_OR_RETURN(Bits lhs, GetBits());
   XLS_ASSIGN_OR_RETURN(Bits rhs, other.GetBits());
   return InterpValue(tag_, bits_ops::And(lhs, rhs));
 }
 
 absl::StatusOr<InterpValue> InterpValue::Sub(const InterpValue& other) const {
+  if (std::optional<WordOperands> ops = GetWordOperands(*this, other)) {
+    uint64_t result = ToWord(ops->lhs) - ToWord(ops->rhs);
+    return InterpValue(tag_, FromWord(result, ops->lhs.bit_count()));
+  }
   XLS_ASSIGN_OR_RETURN(Bits lhs, GetBits());
   XLS_ASSIGN_OR_RETURN(Bits rhs, other.GetBits());
   if (lhs.bit_count() != rhs.bit_count()) {
@@ -497,6 +610,10 @@ absl::StatusOr<InterpValue> InterpValue::Add(const InterpValue& other) const {
   XLS_RET_CHECK(IsBits() && other.IsBits());
   XLS_RET_CHECK_EQ(tag(), other.tag());
   XLS_RET_CHECK_EQ(GetBitCount().value(), other.GetBitCount().value());
+  if (std::optional<WordOperands> ops = GetWordOperands(*this, other)) {
+    uint64_t result = ToWord(ops->lhs) + ToWord(ops->rhs);
+    return InterpValue(tag_, FromWord(result, ops->lhs.bit_count()));
+  }
   XLS_ASSIGN_OR_RETURN(Bits lhs, GetBits());
   XLS_ASSIGN_OR_RETURN(Bits rhs, other.GetBits());
   return InterpValue(tag_, bits_ops::Add(lhs, rhs));
@@ -525,6 +642,10 @@ absl::StatusOr<InterpValue> InterpValue::SCmp(const InterpValue& other,
 }
 
 absl::StatusOr<InterpValue> InterpValue::Mul(const InterpValue& other) const {
+  if (std::optional<WordOperands> ops = GetWordOperands(*this, other)) {
+    uint64_t result = ToWord(ops->lhs) * ToWord(ops->rhs);
+    return InterpValue(tag_, FromWord(result, ops->lhs.bit_count()));
+  }
   XLS_ASSIGN_OR_RETURN(Bits lhs, GetBits());
   XLS_ASSIGN_OR_RETURN(Bits rhs, other.GetBits());
   if (lhs.bit_count() != rhs.bit_count()) {
@@ -600,7 +721,7 @@ absl::StatusOr<InterpValue> InterpValue::Slice(
       result.push_back(subject[offset_int]);
     }
   }
-  return InterpValue(InterpValueTag::kArray, result);
+  return InterpValue(InterpValueTag::kArray, std::move(result));
 }
 
 absl::StatusOr<InterpValue> InterpValue::Index(int64_t index) const {
@@ -683,6 +804,14 @@ static int64_t ClampedUnsignedValue(const Bits& bits, int64_t limit) {
 }
 
 absl::StatusOr<InterpValue> InterpValue::Shl(const InterpValue& other) const {
+  if (std::optional<WordOperands> ops =
+          GetWordOperands(*this, other, /*same_width=*/false)) {
+    int64_t bit_count = ops->lhs.bit_count();
+    auto amount = static_cast<int64_t>(
+        std::min(ToWord(ops->rhs), static_cast<uint64_t>(bit_count)));
+    uint64_t result = amount >= bit_count ? 0 : ToWord(ops->lhs) << amount;
+    return InterpValue(tag_, FromWord(result, bit_count));
+  }
   XLS_ASSIGN_OR_RETURN(Bits lhs, GetBits());
   XLS_ASSIGN_OR_RETURN(Bits rhs, other.GetBits());
   int64_t amount64 = ClampedUnsignedValue(rhs, lhs.bit_count());
@@ -690,6 +819,14 @@ absl::StatusOr<InterpValue> InterpValue::Shl(const InterpValue& other) const {
 }
 
 absl::StatusOr<InterpValue> InterpValue::Shrl(const InterpValue& other) const {
+  if (std::optional<WordOperands> ops =
+          GetWordOperands(*this, other, /*same_width=*/false)) {
+    int64_t bit_count = ops->lhs.bit_count();
+    auto amount = static_cast<int64_t>(
+        std::min(ToWord(ops->rhs), static_cast<uint64_t>(bit_count)));
+    uint64_t result = amount >= bit_count ? 0 : ToWord(ops->lhs) >> amount;
+    return InterpValue(tag_, FromWord(result, bit_count));
+  }
   XLS_ASSIGN_OR_RETURN(Bits lhs, GetBits());
   XLS_ASSIGN_OR_RETURN(Bits rhs, other.GetBits());
   int64_t amount64 = ClampedUnsignedValue(rhs, lhs.bit_count());
@@ -697,6 +834,16 @@ absl::StatusOr<InterpValue> InterpValue::Shrl(const InterpValue& other) const {
 }
 
 absl::StatusOr<InterpValue> InterpValue::Shra(const InterpValue& other) const {
+  if (std::optional<WordOperands> ops =
+          GetWordOperands(*this, other, /*same_width=*/false)) {
+    int64_t bit_count = ops->lhs.bit_count();
+    auto amount = static_cast<int64_t>(
+        std::min(ToWord(ops->rhs), static_cast<uint64_t>(bit_count)));
+    int64_t result = ToSignedWord(ops->lhs) >>
+                     std::min(amount, kMaxWordBitCount - 1);
+    return InterpValue(tag_,
+                       FromWord(static_cast<uint64_t>(result), bit_count));
+  }
   XLS_ASSIGN_OR_RETURN(Bits lhs, GetBits());
   XLS_ASSIGN_OR_RETURN(Bits rhs, other.GetBits());
   int64_t amount64 = ClampedUnsignedValue(rhs, lhs.bit_count());
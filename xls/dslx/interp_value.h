@@ -353,13 +353,13 @@ class InterpValue {
   InterpValueTag tag() const { return tag_; }
 
   absl::StatusOr<const std::vector<InterpValue>*> GetValues() const {
-    if (!std::holds_alternative<std::vector<InterpValue>>(payload_)) {
+    if (!std::holds_alternative<SharedValues>(payload_)) {
       return absl::InvalidArgumentError("Value does not hold element values");
     }
-    return &std::get<std::vector<InterpValue>>(payload_);
+    return std::get<SharedValues>(payload_).get();
   }
   const std::vector<InterpValue>& GetValuesOrDie() const {
-    return std::get<std::vector<InterpValue>>(payload_);
+    return *std::get<SharedValues>(payload_);
   }
   absl::StatusOr<const FnData*> GetFunction() const {
     if (!std::holds_alternative<FnData>(payload_)) {
@@ -401,7 +401,7 @@ class InterpValue {
   }
 
   bool HasValues() const {
-    return std::holds_alternative<std::vector<InterpValue>>(payload_);
+    return std::holds_alternative<SharedValues>(payload_);
   }
 
   bool IsToken() const { return tag_ == InterpValueTag::kToken; }
@@ -459,12 +459,23 @@ class InterpValue {
   //
   // TODO(leary): 2020-02-10 When all Python bindings are eliminated we can more
   // easily make an interpreter scoped lifetime that InterpValues can live in.
-  using Payload =
-      std::variant<Bits, EnumData, std::vector<InterpValue>, FnData,
-                   std::shared_ptr<TokenData>, std::shared_ptr<Channel>>;
+  //
+  // Tuple and array elements are immutable once constructed, so they are held
+  // by shared_ptr: copying an aggregate (e.g. loading it from a slot, passing
+  // it as an argument, or indexing out a nested aggregate) is O(1) rather than
+  // a deep copy. Operations that produce a modified aggregate (e.g. Update())
+  // build a new element vector and leave the original untouched.
+  using SharedValues = std::shared_ptr<const std::vector<InterpValue>>;
+  using Payload = std::variant<Bits, EnumData, SharedValues, FnData,
+                               std::shared_ptr<TokenData>,
+                               std::shared_ptr<Channel>>;
 
   InterpValue(InterpValueTag tag, Payload payload)
       : tag_(tag), payload_(std::move(payload)) {}
+  InterpValue(InterpValueTag tag, std::vector<InterpValue> values)
+      : tag_(tag),
+        payload_(std::make_shared<const std::vector<InterpValue>>(
+            std::move(values))) {}
 
   using CompareF = bool (*)(const Bits& lhs, const Bits& rhs);
 
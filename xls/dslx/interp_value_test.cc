@@ -14,6 +14,8 @@
 
 #include "xls/dslx/interp_value.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
@@ -22,7 +24,10 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "xls/common/bits_util.h"
 #include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
 
 namespace xls::dslx {
 namespace {
@@ -70,6 +75,26 @@ TEST(InterpValueTest, FlattenArrayOfBits) {
   EXPECT_THAT(o->GetBitValueUnsigned(), IsOkAndHolds(0xf00ba5));
 }
 
+TEST(InterpValueTest, AggregateCopiesShareElements) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpValue array,
+      InterpValue::MakeArray({InterpValue::MakeU32(1), InterpValue::MakeU32(2),
+                              InterpValue::MakeU32(3)}));
+  InterpValue copy = array;
+  EXPECT_EQ(&copy.GetValuesOrDie(), &array.GetValuesOrDie());
+
+  // Updating produces a new aggregate and leaves all existing copies intact.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpValue updated,
+      copy.Update(InterpValue::MakeU32(1), InterpValue::MakeU32(42)));
+  EXPECT_NE(&updated.GetValuesOrDie(), &array.GetValuesOrDie());
+  EXPECT_THAT(updated.Index(1), IsOkAndHolds(InterpValue::MakeU32(42)));
+  EXPECT_THAT(array.Index(1), IsOkAndHolds(InterpValue::MakeU32(2)));
+  EXPECT_THAT(copy.Index(1), IsOkAndHolds(InterpValue::MakeU32(2)));
+  EXPECT_NE(updated, array);
+  EXPECT_EQ(copy, array);
+}
+
 TEST(InterpValueTest, BitwiseNegateAllBitsSet) {
   auto v = InterpValue::MakeUBits(/*bit_count=*/3, 0x7);
   auto expected = InterpValue::MakeUBits(/*bit_count=*/3, 0);
@@ -110,6 +135,71 @@ TEST(InterpValueTest, LessThan) {
   EXPECT_THAT(sf.Lt(szero), IsOkAndHolds(true_value));
 }
 
+// Values of at most 64 bits take a machine-word fast path; check it against the
+// generic bits_ops implementations at the interesting widths.
+TEST(InterpValueTest, WordFastPathMatchesBitsOps) {
+  for (int64_t bit_count : {0, 1, 7, 63, 64}) {
+    std::vector<Bits> values = {Bits(bit_count), Bits::AllOnes(bit_count)};
+    if (bit_count > 0) {
+      values.push_back(UBits(1, bit_count));
+      values.push_back(Bits::PowerOfTwo(bit_count - 1, bit_count));
+      values.push_back(
+          UBits(0x5a5a5a5a5a5a5a5aULL & Mask(bit_count), bit_count));
+    }
+    for (bool is_signed : {false, true}) {
+      for (const Bits& l : values) {
+        for (const Bits& r : values) {
+          InterpValue lhs = InterpValue::MakeBits(is_signed, l);
+          InterpValue rhs = InterpValue::MakeBits(is_signed, r);
+          auto make = [&](const Bits& b) {
+            return InterpValue::MakeBits(is_signed, b);
+          };
+          EXPECT_THAT(lhs.Add(rhs), IsOkAndHolds(make(bits_ops::Add(l, r))));
+          EXPECT_THAT(lhs.Sub(rhs), IsOkAndHolds(make(bits_ops::Sub(l, r))));
+          Bits product = bits_ops::UMul(l, r).Slice(0, bit_count);
+          EXPECT_THAT(lhs.Mul(rhs), IsOkAndHolds(make(product)));
+          EXPECT_THAT(lhs.BitwiseAnd(rhs),
+                      IsOkAndHolds(make(bits_ops::And(l, r))));
+          EXPECT_THAT(lhs.BitwiseOr(rhs),
+                      IsOkAndHolds(make(bits_ops::Or(l, r))));
+          EXPECT_THAT(lhs.BitwiseXor(rhs),
+                      IsOkAndHolds(make(bits_ops::Xor(l, r))));
+          EXPECT_THAT(lhs.BitwiseNegate(),
+                      IsOkAndHolds(make(bits_ops::Not(l))));
+          bool lt = is_signed ? bits_ops::SLessThan(l, r)
+                              : bits_ops::ULessThan(l, r);
+          bool gt = is_signed ? bits_ops::SGreaterThan(l, r)
+                              : bits_ops::UGreaterThan(l, r);
+          EXPECT_THAT(lhs.Lt(rhs), IsOkAndHolds(InterpValue::MakeBool(lt)));
+          EXPECT_THAT(lhs.Ge(rhs), IsOkAndHolds(InterpValue::MakeBool(!lt)));
+          EXPECT_THAT(lhs.Gt(rhs), IsOkAndHolds(InterpValue::MakeBool(gt)));
+          EXPECT_THAT(lhs.Le(rhs), IsOkAndHolds(InterpValue::MakeBool(!gt)));
+        }
+        for (int64_t amount : {int64_t{0}, int64_t{1}, bit_count - 1, bit_count,
+                               bit_count + 1, int64_t{255}}) {
+          if (amount < 0) {
+            continue;
+          }
+          InterpValue lhs = InterpValue::MakeBits(is_signed, l);
+          InterpValue rhs = InterpValue::MakeUBits(8, amount);
+          EXPECT_THAT(lhs.Shl(rhs),
+                      IsOkAndHolds(InterpValue::MakeBits(
+                          is_signed, bits_ops::ShiftLeftLogical(
+                                         l, std::min(amount, bit_count)))));
+          EXPECT_THAT(lhs.Shrl(rhs),
+                      IsOkAndHolds(InterpValue::MakeBits(
+                          is_signed, bits_ops::ShiftRightLogical(
+                                         l, std::min(amount, bit_count)))));
+          EXPECT_THAT(lhs.Shra(rhs),
+                      IsOkAndHolds(InterpValue::MakeBits(
+                          is_signed, bits_ops::ShiftRightArith(
+                                         l, std::min(amount, bit_count)))));
+        }
+      }
+    }
+  }
+}
+
 TEST(InterpValueTest, Negate) {
   auto uone = InterpValue::MakeUBits(/*bit_count=*/4, 1);
   auto uf = InterpValue::MakeUBits(/*bit_count=*/4, 0xf);
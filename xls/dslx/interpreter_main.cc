@@ -32,6 +32,7 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/tracing.h"
 #include "xls/dslx/command_line_utils.h"
 #include "xls/dslx/run_comparator.h"
 #include "xls/dslx/run_routines.h"
@@ -69,8 +70,32 @@ ABSL_FLAG(bool, trace_channels, false,
 ABSL_FLAG(int64_t, max_ticks, 100000,
           "If non-zero, the maximum number of ticks to execute on any proc. If "
           "exceeded an error is returned.");
+ABSL_FLAG(int64_t, quickcheck_threads, 1,
+          "Number of threads over which the samples of each quickcheck are "
+          "evaluated. Each thread uses its own JIT/IR interpreter instance; "
+          "results (including the falsifying example reported for a given "
+          "seed) do not depend on the number of threads.");
+ABSL_FLAG(int64_t, test_threads, 1,
+          "Number of threads over which the unit tests of the module are run. "
+          "Test results are reported in the order the tests are declared, but "
+          "trace output of concurrently running tests is interleaved.");
 // LINT.ThenChange(//xls/build_rules/xls_dslx_rules.bzl)
 
+ABSL_FLAG(std::string, trace_output, "",
+          "If non-empty, writes a Chrome trace of the phases of this "
+          "invocation (loadable in chrome://tracing or Perfetto) to this "
+          "path.");
+
+ABSL_FLAG(std::string, bytecode_cache_dir, "",
+          "If given, directory in which emitted bytecode is cached across "
+          "invocations. Cached bytecode is reused as long as none of the "
+          "modules in the import graph have changed.");
+ABSL_FLAG(int64_t, proc_threads, 1,
+          "Number of threads over which the proc instances of test procs are "
+          "run. Channel operations block until data is available and "
+          "deadlocks are reported as with a single thread, but the order in "
+          "which procs interleave is nondeterministic.");
+
 namespace xls::dslx {
 namespace {
 
@@ -90,7 +115,8 @@ absl::StatusOr<TestResult> RealMain(std::string_view entry_module_path,
                       FormatPreference format_preference,
                       CompareFlag compare_flag, bool execute,
                       bool warnings_as_errors, std::optional<int64_t> seed,
-                      bool trace_channels, std::optional<int64_t> max_ticks) {
+                      bool trace_channels, std::optional<int64_t> max_ticks,
+                      int64_t quickcheck_threads) {
   XLS_ASSIGN_OR_RETURN(
       WarningKindSet warnings,
       WarningKindSetFromDisabledString(absl::GetFlag(FLAGS_disable_warnings)));
@@ -119,7 +145,14 @@ absl::StatusOr<TestResult> RealMain(std::string_view entry_module_path,
                                  .warnings_as_errors = warnings_as_errors,
                                  .warnings = warnings,
                                  .trace_channels = trace_channels,
-                                 .max_ticks = max_ticks};
+                                 .max_ticks = max_ticks,
+                                 .quickcheck_threads = quickcheck_threads};
+  if (std::string cache_dir = absl::GetFlag(FLAGS_bytecode_cache_dir);
+      !cache_dir.empty()) {
+    options.bytecode_cache_dir = cache_dir;
+  }
+  options.proc_threads = absl::GetFlag(FLAGS_proc_threads);
+  options.test_threads = absl::GetFlag(FLAGS_test_threads);
   XLS_ASSIGN_OR_RETURN(
       TestResult test_result,
       ParseAndTest(program, module_name, entry_module_path, options));
@@ -132,6 +165,7 @@ absl::StatusOr<TestResult> RealMain(std::string_view entry_module_path,
 int main(int argc, char* argv[]) {
   std::vector<std::string_view> args =
       xls::InitXls(xls::dslx::kUsage, argc, argv);
+  xls::ScopedTraceOutput trace_output(absl::GetFlag(FLAGS_trace_output));
   if (args.empty()) {
     XLS_LOG(QFATAL) << "Wrong number of command-line arguments; got "
                     << args.size() << ": `" << absl::StrJoin(args, " ")
@@ -190,9 +224,17 @@ int main(int argc, char* argv[]) {
     preference = flag_preference.value();
   }
 
+  XLS_QCHECK_GE(absl::GetFlag(FLAGS_quickcheck_threads), 1)
+      << "-quickcheck_threads must be positive";
+  XLS_QCHECK_GE(absl::GetFlag(FLAGS_proc_threads), 1)
+      << "-proc_threads must be positive";
+  XLS_QCHECK_GE(absl::GetFlag(FLAGS_test_threads), 1)
+      << "-test_threads must be positive";
+
   absl::StatusOr<xls::dslx::TestResult> test_result = xls::dslx::RealMain(
       args[0], dslx_paths, test_filter, preference, compare_flag, execute,
-      warnings_as_errors, seed, trace_channels, max_ticks);
+      warnings_as_errors, seed, trace_channels, max_ticks,
+      absl::GetFlag(FLAGS_quickcheck_threads));
   if (!test_result.ok()) {
     return xls::ExitStatus(test_result.status());
   }
@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <optional>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -646,28 +647,21 @@ static absl::StatusOr<std::vector<Proc*>> GetTopLevelProcs(
 // inferred function (e.g. derived from a proc spawn/invocation or a parametric
 // function). The 'ready' input list is modified and cannot be nullptr.
 static void RemoveFunctionDuplicates(std::vector<ConversionRecord>* ready) {
-  for (auto iter_func = ready->begin(); iter_func != ready->end();
-       iter_func++) {
-    const ConversionRecord& function_cr = *iter_func;
-    for (auto iter_subject = iter_func + 1; iter_subject != ready->end();) {
-      const ConversionRecord& subject_cr = *iter_subject;
-
-      bool same_fns = function_cr.f() == subject_cr.f();
-      bool either_is_proc_instance_fn =
-          function_cr.f()->tag() == Function::Tag::kProcConfig ||
-          function_cr.f()->tag() == Function::Tag::kProcNext ||
-          subject_cr.f()->tag() == Function::Tag::kProcConfig ||
-          subject_cr.f()->tag() == Function::Tag::kProcNext;
-      bool either_is_parametric =
-          function_cr.f()->IsParametric() || subject_cr.f()->IsParametric();
-
-      if (same_fns && !either_is_proc_instance_fn && !either_is_parametric) {
-        iter_subject = ready->erase(iter_subject);
-        continue;
-      }
-      iter_subject++;
+  // Only the first record for each such function is kept; this is done in a
+  // single pass since the list has an entry per converted function.
+  absl::flat_hash_set<const Function*> seen;
+  std::vector<ConversionRecord> result;
+  result.reserve(ready->size());
+  for (ConversionRecord& cr : *ready) {
+    const Function* f = cr.f();
+    bool is_proc_instance_fn = f->tag() == Function::Tag::kProcConfig ||
+                               f->tag() == Function::Tag::kProcNext;
+    if (!is_proc_instance_fn && !f->IsParametric() && !seen.insert(f).second) {
+      continue;
     }
+    result.push_back(std::move(cr));
   }
+  *ready = std::move(result);
 }
 
 // Traverses the definition of a node to find callees.
@@ -692,26 +686,38 @@ static absl::StatusOr<std::vector<Callee>> GetCallees(
   return std::move(visitor.callees());
 }
 
+namespace {
+
+// The conversion order being built, along with an index of the non-proc
+// (function, module, bindings) instantiations it already contains so that
+// IsReady() doesn't have to rescan the whole order for every callee.
+struct ReadyList {
+  using Key = std::tuple<const Function*, const Module*, ParametricEnv>;
+
+  void Add(ConversionRecord record) {
+    if (!record.proc_id().has_value()) {
+      non_proc_instances.insert(
+          Key{record.f(), record.module(), record.parametric_env()});
+    }
+    records.push_back(std::move(record));
+  }
+
+  std::vector<ConversionRecord> records;
+  absl::flat_hash_set<Key> non_proc_instances;
+};
+
+}  // namespace
+
 static bool IsReady(std::variant<Function*, TestFunction*> f, Module* m,
-                    const ParametricEnv& bindings,
-                    const std::vector<ConversionRecord>* ready) {
+                    const ParametricEnv& bindings, const ReadyList* ready) {
   // Test functions are always the root and non-parametric, so they're always
   // ready.
   if (std::holds_alternative<TestFunction*>(f)) {
     return true;
   }
 
-  auto matches_fn = [&](const ConversionRecord& cr, Function* f) {
-    return cr.f() == f && cr.module() == m && cr.parametric_env() == bindings &&
-           !cr.proc_id().has_value();
-  };
-
-  for (const ConversionRecord& cr : *ready) {
-    if (matches_fn(cr, std::get<Function*>(f))) {
-      return true;
-    }
-  }
-  return false;
+  return ready->non_proc_instances.contains(
+      ReadyList::Key{std::get<Function*>(f), m, bindings});
 }
 
 // Forward decl.
@@ -719,12 +725,11 @@ static absl::Status AddToReady(std::variant<Function*, TestFunction*> f,
                                const Invocation* invocation, Module* m,
                                TypeInfo* type_info,
                                const ParametricEnv& bindings,
-                               std::vector<ConversionRecord>* ready,
-                               std::optional<ProcId> proc_id,
+                               ReadyList* ready, std::optional<ProcId> proc_id,
                                bool is_top = false);
 
 static absl::Status ProcessCallees(absl::Span<const Callee> orig_callees,
-                                   std::vector<ConversionRecord>* ready) {
+                                   ReadyList* ready) {
   // Knock out all callees that are already in the (ready) order.
   std::vector<Callee> non_ready;
   {
@@ -751,7 +756,7 @@ static absl::Status AddToReady(std::variant<Function*, TestFunction*> f,
                                const Invocation* invocation, Module* m,
                                TypeInfo* type_info,
                                const ParametricEnv& bindings,
-                               std::vector<ConversionRecord>* ready,
+                               ReadyList* ready,
                                const std::optional<ProcId> proc_id,
                                bool is_top) {
   XLS_CHECK_EQ(type_info->module(), m);
@@ -780,13 +785,13 @@ static absl::Status AddToReady(std::variant<Function*, TestFunction*> f,
       ConversionRecord cr,
       ConversionRecord::Make(fn, invocation, m, type_info, bindings,
                              orig_callees, proc_id, is_top));
-  ready->push_back(std::move(cr));
+  ready->Add(std::move(cr));
   return absl::OkStatus();
 }
 
 static absl::StatusOr<std::vector<ConversionRecord>> GetOrderForProc(
     std::variant<Proc*, TestProc*> entry, TypeInfo* type_info, bool is_top) {
-  std::vector<ConversionRecord> ready;
+  ReadyList ready;
   Proc* p;
   if (std::holds_alternative<TestProc*>(entry)) {
     p = std::get<TestProc*>(entry)->proc();
@@ -811,7 +816,7 @@ static absl::StatusOr<std::vector<ConversionRecord>> GetOrderForProc(
   std::vector<ConversionRecord> final_order;
   std::vector<ConversionRecord> config_fns;
   std::vector<ConversionRecord> next_fns;
-  for (const auto& record : ready) {
+  for (const auto& record : ready.records) {
     if (record.f()->tag() == Function::Tag::kProcConfig) {
       config_fns.push_back(record);
     } else if (record.f()->tag() == Function::Tag::kProcNext) {
@@ -831,7 +836,7 @@ static absl::StatusOr<std::vector<ConversionRecord>> GetOrderForProc(
 absl::StatusOr<std::vector<ConversionRecord>> GetOrder(Module* module,
                                                        TypeInfo* type_info) {
   XLS_CHECK_EQ(type_info->module(), module);
-  std::vector<ConversionRecord> ready;
+  ReadyList ready_list;
 
   for (ModuleMember member : module->top()) {
     if (std::holds_alternative<QuickCheck*>(member)) {
@@ -840,7 +845,8 @@ absl::StatusOr<std::vector<ConversionRecord>> GetOrder(Module* module,
       XLS_RET_CHECK(!function->IsParametric()) << function->ToString();
 
       XLS_RETURN_IF_ERROR(AddToReady(function, /*invocation=*/nullptr, module,
-                                     type_info, ParametricEnv(), &ready, {}));
+                                     type_info, ParametricEnv(), &ready_list,
+                                     {}));
     } else if (std::holds_alternative<Function*>(member)) {
       // Proc creation is driven by Spawn instantiations - the required constant
       // args are only specified there, so we can't convert Procs as encountered
@@ -851,16 +857,19 @@ absl::StatusOr<std::vector<ConversionRecord>> GetOrder(Module* module,
       }
 
       XLS_RETURN_IF_ERROR(AddToReady(f, /*invocation=*/nullptr, module,
-                                     type_info, ParametricEnv(), &ready, {}));
+                                     type_info, ParametricEnv(), &ready_list,
+                                     {}));
     } else if (std::holds_alternative<ConstantDef*>(member)) {
       auto* constant_def = std::get<ConstantDef*>(member);
       XLS_ASSIGN_OR_RETURN(const std::vector<Callee> callees,
                            GetCallees(constant_def->value(), module, type_info,
                                       ParametricEnv(), {}));
-      XLS_RETURN_IF_ERROR(ProcessCallees(callees, &ready));
+      XLS_RETURN_IF_ERROR(ProcessCallees(callees, &ready_list));
     }
   }
 
+  std::vector<ConversionRecord> ready = std::move(ready_list.records);
+
   // Collect the top level procs.
   XLS_ASSIGN_OR_RETURN(std::vector<Proc*> top_level_procs,
                        GetTopLevelProcs(module, type_info));
@@ -887,17 +896,18 @@ absl::StatusOr<std::vector<ConversionRecord>> GetOrder(Module* module,
 
 absl::StatusOr<std::vector<ConversionRecord>> GetOrderForEntry(
     std::variant<Function*, Proc*> entry, TypeInfo* type_info) {
-  std::vector<ConversionRecord> ready;
   if (std::holds_alternative<Function*>(entry)) {
     Function* f = std::get<Function*>(entry);
     if (f->proc().has_value()) {
       XLS_ASSIGN_OR_RETURN(
           type_info, type_info->GetTopLevelProcTypeInfo(f->proc().value()));
     }
+    ReadyList ready_list;
     XLS_RETURN_IF_ERROR(AddToReady(f,
                                    /*invocation=*/nullptr, f->owner(),
-                                   type_info, ParametricEnv(), &ready, {},
+                                   type_info, ParametricEnv(), &ready_list, {},
                                    /*is_top=*/true));
+    std::vector<ConversionRecord> ready = std::move(ready_list.records);
     RemoveFunctionDuplicates(&ready);
     return ready;
   }
@@ -905,7 +915,8 @@ absl::StatusOr<std::vector<ConversionRecord>> GetOrderForEntry(
   Proc* p = std::get<Proc*>(entry);
   XLS_ASSIGN_OR_RETURN(TypeInfo * new_ti,
                        type_info->GetTopLevelProcTypeInfo(p));
-  XLS_ASSIGN_OR_RETURN(ready, GetOrderForProc(p, new_ti, /*is_top=*/true));
+  XLS_ASSIGN_OR_RETURN(std::vector<ConversionRecord> ready,
+                       GetOrderForProc(p, new_ti, /*is_top=*/true));
   RemoveFunctionDuplicates(&ready);
   return ready;
 }
@@ -137,6 +137,36 @@ fn main() -> u32 { f() }
   EXPECT_TRUE(order[1].IsTop());
 }
 
+TEST(ExtractConversionOrderTest, GetOrderForEntryOnlyVisitsReachableOnce) {
+  constexpr std::string_view kProgram = R"(
+fn unused() -> u32 { u32:7 }
+fn p<N: u32>(x: bits[N]) -> u32 { N }
+fn leaf() -> u32 { p(u2:0) + p(u3:0) }
+fn left() -> u32 { leaf() + p(u2:1) }
+fn right() -> u32 { leaf() + p(u3:1) }
+fn main() -> u32 { left() + right() }
+)";
+  auto import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheck(kProgram, "test.x", "test", &import_data));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           tm.module->GetMemberOrError<Function>("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<ConversionRecord> order,
+                           GetOrderForEntry(f, tm.type_info));
+  // Each of the two instantiations of `p` and the shared `leaf` appear once;
+  // `unused` isn't reachable from the entry so it doesn't appear at all.
+  ASSERT_EQ(6, order.size());
+  EXPECT_EQ(order[0].f()->identifier(), "p");
+  EXPECT_EQ(order[1].f()->identifier(), "p");
+  EXPECT_NE(order[0].parametric_env(), order[1].parametric_env());
+  EXPECT_EQ(order[2].f()->identifier(), "leaf");
+  EXPECT_EQ(order[3].f()->identifier(), "left");
+  EXPECT_EQ(order[4].f()->identifier(), "right");
+  EXPECT_EQ(order[5].f()->identifier(), "main");
+  EXPECT_TRUE(order[5].IsTop());
+}
+
 TEST(ExtractConversionOrderTest, GetOrderForEntryFunctionWithConst) {
   constexpr std::string_view kProgram = R"(
 fn id(x: u32) -> u32 { x }
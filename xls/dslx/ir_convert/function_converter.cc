@@ -72,6 +72,23 @@
 #include "xls/ir/verifier.h"
 
 namespace xls::dslx {
+
+std::optional<xls::Function*> PackageData::FindFunction(std::string_view name) {
+  absl::Span<const std::unique_ptr<xls::Function>> functions =
+      package->functions();
+  // Index the functions added to the package since the last lookup. The first
+  // function with a given name wins, as in Package::GetFunction().
+  for (; indexed_function_count < functions.size();
+       ++indexed_function_count) {
+    xls::Function* f = functions[indexed_function_count].get();
+    functions_by_name.emplace(f->name(), f);
+  }
+  auto it = functions_by_name.find(name);
+  if (it == functions_by_name.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
 namespace {
 
 constexpr WarningCollector* kNoWarningCollector = nullptr;
@@ -1413,7 +1430,8 @@ absl::StatusOr<BValue> FunctionConverter::DefMapWithBuiltin(
   XLS_VLOG(5) << "Mapping with builtin; arg: "
               << arg_value.GetType()->ToString();
   auto* array_type = arg_value.GetType()->AsArrayOrDie();
-  if (!package()->HasFunctionWithName(mangled_name)) {
+  std::optional<xls::Function*> f = package_data_.FindFunction(mangled_name);
+  if (!f.has_value()) {
     FunctionBuilder fb(mangled_name, package());
     BValue param = fb.Param("arg", array_type->element_type());
     const std::string& builtin_name = node->identifier();
@@ -1426,12 +1444,11 @@ absl::StatusOr<BValue> FunctionConverter::DefMapWithBuiltin(
       return absl::InternalError("Invalid builtin name for map: " +
                                  builtin_name);
     }
-    XLS_RETURN_IF_ERROR(fb.Build().status());
+    XLS_ASSIGN_OR_RETURN(f, fb.Build());
   }
 
-  XLS_ASSIGN_OR_RETURN(xls::Function * f, package()->GetFunction(mangled_name));
   return Def(parent_node, [&](const SourceInfo& loc) {
-    return function_builder_->Map(arg_value, f);
+    return function_builder_->Map(arg_value, *f);
   });
 }
 
@@ -1477,9 +1494,13 @@ absl::StatusOr<BValue> FunctionConverter::HandleMap(const Invocation* node) {
                      free_set, node_parametric_env.value()));
   XLS_VLOG(5) << "Getting function with mangled name: " << mangled_name
               << " from package: " << package()->name();
-  XLS_ASSIGN_OR_RETURN(xls::Function * f, package()->GetFunction(mangled_name));
+  std::optional<xls::Function*> f = package_data_.FindFunction(mangled_name);
+  if (!f.has_value()) {
+    return absl::NotFoundError(absl::StrFormat(
+        "Package does not have a function with name: \"%s\"", mangled_name));
+  }
   return Def(node, [&](const SourceInfo& loc) -> BValue {
-    return function_builder_->Map(arg, f, loc);
+    return function_builder_->Map(arg, *f, loc);
   });
 }
 
@@ -1731,11 +1752,10 @@ absl::Status FunctionConverter::HandleInvocation(const Invocation* node) {
     return values;
   };
 
-  if (package()->HasFunctionWithName(called_name)) {
-    XLS_ASSIGN_OR_RETURN(xls::Function * f,
-                         package()->GetFunction(called_name));
+  if (std::optional<xls::Function*> f = package_data_.FindFunction(called_name);
+      f.has_value()) {
     XLS_ASSIGN_OR_RETURN(std::vector<BValue> args, accept_args());
-    return HandleUdfInvocation(node, f, std::move(args));
+    return HandleUdfInvocation(node, *f, std::move(args));
   }
 
   // A few builtins are handled specially.
@@ -82,6 +82,20 @@ struct PackageData {
   Package* package;
   absl::flat_hash_map<xls::FunctionBase*, dslx::Function*> ir_to_dslx;
   absl::flat_hash_set<xls::Function*> wrappers;
+
+  // Returns the function in `package` with the given name, if any.
+  //
+  // Conversion looks up the callee of every invocation by name, and
+  // Package::GetFunction() is a linear scan, which made converting packages
+  // with thousands of functions quadratic. Instead functions are indexed by
+  // name as they are added to the package. (Conversion only ever adds
+  // functions to the package, so the index never goes stale.)
+  std::optional<xls::Function*> FindFunction(std::string_view name);
+
+  // Index used by FindFunction(), covering the first `indexed_function_count`
+  // functions of `package`.
+  absl::flat_hash_map<std::string, xls::Function*> functions_by_name;
+  int64_t indexed_function_count = 0;
 };
 
 // A function that creates/returns a predicate value -- since this is used
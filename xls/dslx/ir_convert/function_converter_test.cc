@@ -14,10 +14,14 @@
 
 #include "xls/dslx/ir_convert/function_converter.h"
 
+#include <optional>
+
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/parse_and_typecheck.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/package.h"
 
 namespace xls::dslx {
@@ -88,5 +92,17 @@ fn f() -> u32 { u32:42 }
             "extern_foobar {fn} (.out({return}));");
 }
 
+TEST(FunctionConverterTest, FindFunctionSeesFunctionsAddedAfterLookup) {
+  xls::Package package("test_package");
+  PackageData package_data{&package};
+  EXPECT_EQ(package_data.FindFunction("f"), std::nullopt);
+
+  FunctionBuilder fb("f", &package);
+  fb.Literal(UBits(1, 32));
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * f, fb.Build());
+  EXPECT_EQ(package_data.FindFunction("f"), f);
+  EXPECT_EQ(package_data.FindFunction("g"), std::nullopt);
+}
+
 }  // namespace
 }  // namespace xls::dslx
@@ -26,6 +26,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <functional>
 #include <memory>
 #include <optional>
@@ -461,7 +462,8 @@ absl::StatusOr<std::unique_ptr<Package>> ConvertFilesToPackage(
     absl::Span<const std::string_view> paths, const std::string& stdlib_path,
     absl::Span<const std::filesystem::path> dslx_paths,
     const ConvertOptions& convert_options, std::optional<std::string_view> top,
-    std::optional<std::string_view> package_name, bool* printed_error) {
+    std::optional<std::string_view> package_name, bool* printed_error,
+    std::vector<std::filesystem::path>* dependencies) {
   std::string resolved_package_name;
   if (package_name.has_value()) {
     resolved_package_name = package_name.value();
@@ -482,6 +484,7 @@ absl::StatusOr<std::unique_ptr<Package>> ConvertFilesToPackage(
         "Top cannot be supplied with multiple input paths (need a single input "
         "path to know where to resolve the entry function");
   }
+  std::vector<std::filesystem::path> read_paths;
   for (std::string_view path : paths) {
     ImportData import_data(CreateImportData(stdlib_path, dslx_paths,
                                             convert_options.enabled_warnings));
@@ -490,6 +493,18 @@ absl::StatusOr<std::unique_ptr<Package>> ConvertFilesToPackage(
     XLS_RETURN_IF_ERROR(AddContentsToPackage(
         text, module_name, /*path=*/path, /*entry=*/top, convert_options,
         &import_data, package.get(), printed_error));
+    if (dependencies != nullptr) {
+      read_paths.push_back(std::filesystem::path(path));
+      for (std::filesystem::path& module_path : import_data.GetModulePaths()) {
+        read_paths.push_back(std::move(module_path));
+      }
+    }
+  }
+  if (dependencies != nullptr) {
+    std::sort(read_paths.begin(), read_paths.end());
+    read_paths.erase(std::unique(read_paths.begin(), read_paths.end()),
+                     read_paths.end());
+    *dependencies = std::move(read_paths);
   }
 
   return package;
@@ -15,10 +15,12 @@
 #ifndef XLS_DSLX_IR_CONVERT_IR_CONVERTER_H_
 #define XLS_DSLX_IR_CONVERT_IR_CONVERTER_H_
 
+#include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -102,13 +104,17 @@ absl::Status ConvertOneFunctionIntoPackage(Module* module,
 //   package_name: Optionally, the name of the package.
 //   printed_error: If a non-null pointer is passes, sets the contents to a
 //     boolean value indicating if an error was printed during conversion.
+//   dependencies: If non-null, set to the sorted paths of every file the
+//     conversion read: `paths` and all the modules they (transitively)
+//     import. Suitable for OutputCache::Insert.
 absl::StatusOr<std::unique_ptr<Package>> ConvertFilesToPackage(
     absl::Span<const std::string_view> paths, const std::string& stdlib_path,
     absl::Span<const std::filesystem::path> dslx_paths,
     const ConvertOptions& convert_options,
     std::optional<std::string_view> top = std::nullopt,
     std::optional<std::string_view> package_name = std::nullopt,
-    bool* printed_error = nullptr);
+    bool* printed_error = nullptr,
+    std::vector<std::filesystem::path>* dependencies = nullptr);
 
 }  // namespace xls::dslx
 
@@ -21,16 +21,22 @@
 #include <string_view>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/types/span.h"
 #include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/tracing.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
 #include "xls/dslx/ir_convert/ir_converter.h"
+#include "xls/dslx/output_cache.h"
 #include "xls/dslx/warning_kind.h"
 #include "xls/ir/package.h"
 
@@ -61,6 +67,16 @@ ABSL_FLAG(bool, warnings_as_errors, true,
           "Whether to fail early, as an error, if warnings are detected");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
 
+ABSL_FLAG(std::string, trace_output, "",
+          "If non-empty, writes a Chrome trace of the phases of this "
+          "invocation (loadable in chrome://tracing or Perfetto) to this "
+          "path.");
+ABSL_FLAG(std::string, cache_dir, "",
+          "If given, directory in which the output is cached across "
+          "invocations; when neither the flags nor any file in the import "
+          "graph have changed, the cached IR is emitted without parsing, "
+          "typechecking or converting.");
+
 namespace xls::dslx {
 namespace {
 
@@ -85,7 +101,9 @@ absl::Status RealMain(absl::Span<const std::string_view> paths,
                       const std::string& stdlib_path,
                       absl::Span<const std::filesystem::path> dslx_paths,
                       bool emit_fail_as_assert, bool verify_ir,
-                      bool warnings_as_errors, bool* printed_error) {
+                      bool warnings_as_errors,
+                      std::optional<std::filesystem::path> cache_dir,
+                      bool* printed_error) {
   XLS_ASSIGN_OR_RETURN(
       WarningKindSet enabled_warnings,
       WarningKindSetFromDisabledString(absl::GetFlag(FLAGS_disable_warnings)));
@@ -110,12 +128,46 @@ absl::Status RealMain(absl::Span<const std::string_view> paths,
            "input path to know where to resolve the entry function)";
   }
 
+  // Reading the input to validate a cache entry would consume stdin.
+  std::optional<OutputCache> cache;
+  std::string cache_key;
+  if (cache_dir.has_value() && !absl::c_linear_search(paths, "/dev/stdin")) {
+    cache.emplace(*cache_dir);
+    XLS_ASSIGN_OR_RETURN(std::filesystem::path cwd, GetCurrentDirectory());
+    cache_key = absl::StrJoin(
+        {std::string("ir_converter_main"), cwd.string(),
+         absl::StrJoin(paths, ":"), std::string(top.value_or("")),
+         std::string(package_name.value_or("")), stdlib_path,
+         absl::StrJoin(dslx_paths, ":",
+                       [](std::string* out, const std::filesystem::path& p) {
+                         absl::StrAppend(out, p.string());
+                       }),
+         absl::StrCat(emit_fail_as_assert, verify_ir, warnings_as_errors),
+         absl::GetFlag(FLAGS_disable_warnings)},
+        "\n");
+    XLS_ASSIGN_OR_RETURN(std::optional<std::string> output,
+                         cache->Lookup(cache_key));
+    if (output.has_value()) {
+      std::cout << *output;
+      return absl::OkStatus();
+    }
+  }
+
+  std::vector<std::filesystem::path> dependencies;
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<xls::Package> package,
       ConvertFilesToPackage(paths, stdlib_path, dslx_paths, convert_options,
                             /*top=*/top,
-                            /*package_name=*/package_name, printed_error));
-  std::cout << package->DumpIr();
+                            /*package_name=*/package_name, printed_error,
+                            &dependencies));
+  std::string output = package->DumpIr();
+  if (cache.has_value()) {
+    if (absl::Status status = cache->Insert(cache_key, dependencies, output);
+        !status.ok()) {
+      XLS_LOG(WARNING) << "Failed to cache IR conversion output: " << status;
+    }
+  }
+  std::cout << output;
 
   return absl::OkStatus();
 }
@@ -126,6 +178,7 @@ absl::Status RealMain(absl::Span<const std::string_view> paths,
 int main(int argc, char* argv[]) {
   std::vector<std::string_view> args =
       xls::InitXls(xls::dslx::kUsage, argc, argv);
+  xls::ScopedTraceOutput trace_output(absl::GetFlag(FLAGS_trace_output));
   if (args.empty()) {
     XLS_LOG(QFATAL) << "Wrong number of command-line arguments; got "
                     << args.size() << ": `" << absl::StrJoin(args, " ")
@@ -162,10 +215,14 @@ int main(int argc, char* argv[]) {
   bool emit_fail_as_assert = absl::GetFlag(FLAGS_emit_fail_as_assert);
   bool verify_ir = absl::GetFlag(FLAGS_verify);
   bool warnings_as_errors = absl::GetFlag(FLAGS_warnings_as_errors);
+  std::optional<std::filesystem::path> cache_dir;
+  if (std::string flag = absl::GetFlag(FLAGS_cache_dir); !flag.empty()) {
+    cache_dir = flag;
+  }
   bool printed_error = false;
   absl::Status status = xls::dslx::RealMain(
       args, top, package_name, stdlib_path, dslx_paths, emit_fail_as_assert,
-      verify_ir, warnings_as_errors, &printed_error);
+      verify_ir, warnings_as_errors, cache_dir, &printed_error);
   if (printed_error) {
     return EXIT_FAILURE;
   }
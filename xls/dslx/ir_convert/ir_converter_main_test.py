@@ -101,6 +101,33 @@ class IrConverterMainTest(test_base.TestCase):
         ),
     )
 
+  def test_cache_dir(self) -> None:
+    tempdir = self.create_tempdir()
+    cache_dir = self.create_tempdir()
+    tempdir.create_file('a.x', 'import b;\nfn f() -> u32 { b::f() }')
+    b_dot_x = tempdir.create_file('b.x', self.B_DOT_X)
+    cmd = [
+        self.IR_CONVERTER_MAIN_PATH,
+        'a.x',
+        '--cache_dir=' + cache_dir.full_path,
+    ]
+
+    def run() -> str:
+      return subprocess.check_output(
+          cmd, encoding='utf-8', cwd=tempdir.full_path
+      )
+
+    first = run()
+    self.assertIn('value=64', first)
+    self.assertNotEmpty(os.listdir(cache_dir.full_path))
+    self.assertEqual(run(), first)
+
+    # Editing an imported module invalidates the cached output.
+    b_dot_x.write_text('fn f() -> u32 { u32:65 }')
+    second = run()
+    self.assertIn('value=65', second)
+    self.assertNotIn('value=64', second)
+
 
 if __name__ == '__main__':
   test_base.main()
@@ -0,0 +1,165 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/output_cache.h"
+
+#include <unistd.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/types/span.h"
+#include "openssl/sha.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls::dslx {
+namespace {
+
+// First line of every entry; bump the version when the format changes.
+constexpr std::string_view kEntryHeader = "xls-dslx-output-cache-v1";
+
+std::string HexDigest(std::string_view data) {
+  std::array<char, SHA256_DIGEST_LENGTH> digest;
+  SHA256(reinterpret_cast<const uint8_t*>(data.data()), data.size(),
+         reinterpret_cast<uint8_t*>(digest.data()));
+  return absl::BytesToHexString({digest.data(), digest.size()});
+}
+
+// Returns a string identifying the build of the running executable, or the
+// empty string if it cannot be determined.
+std::string ExecutableIdentity() {
+  std::error_code ec;
+  std::filesystem::path exe =
+      std::filesystem::read_symlink("/proc/self/exe", ec);
+  if (ec) {
+    return "";
+  }
+  std::uintmax_t size = std::filesystem::file_size(exe, ec);
+  if (ec) {
+    return "";
+  }
+  auto mtime = std::filesystem::last_write_time(exe, ec);
+  if (ec) {
+    return "";
+  }
+  return absl::StrFormat("%s:%d:%d", exe.string(), size,
+                         mtime.time_since_epoch().count());
+}
+
+}  // namespace
+
+std::filesystem::path OutputCache::GetEntryPath(std::string_view key) const {
+  static const std::string* kExecutableIdentity =
+      new std::string(ExecutableIdentity());
+  return cache_dir_ /
+         HexDigest(absl::StrCat(kEntryHeader, "\n", *kExecutableIdentity, "\n",
+                                key));
+}
+
+absl::StatusOr<std::optional<std::string>> OutputCache::Lookup(
+    std::string_view key) const {
+  absl::StatusOr<std::string> entry = GetFileContents(GetEntryPath(key));
+  if (absl::IsNotFound(entry.status())) {
+    return std::nullopt;
+  }
+  XLS_RETURN_IF_ERROR(entry.status());
+
+  // Entries without the expected header (e.g. truncated ones) are treated as
+  // misses; they are overwritten on the next Insert().
+  std::string_view rest = *entry;
+  auto next_line = [&]() -> std::optional<std::string_view> {
+    size_t newline = rest.find('\n');
+    if (newline == std::string_view::npos) {
+      return std::nullopt;
+    }
+    std::string_view line = rest.substr(0, newline);
+    rest.remove_prefix(newline + 1);
+    return line;
+  };
+  std::optional<std::string_view> header = next_line();
+  std::optional<std::string_view> count_line = next_line();
+  int64_t dependency_count;
+  if (!header.has_value() || *header != kEntryHeader ||
+      !count_line.has_value() ||
+      !absl::SimpleAtoi(*count_line, &dependency_count)) {
+    return std::nullopt;
+  }
+  for (int64_t i = 0; i < dependency_count; ++i) {
+    std::optional<std::string_view> line = next_line();
+    if (!line.has_value()) {
+      return std::nullopt;
+    }
+    std::vector<std::string_view> pieces =
+        absl::StrSplit(*line, absl::MaxSplits(' ', 1));
+    if (pieces.size() != 2) {
+      return std::nullopt;
+    }
+    absl::StatusOr<std::string> contents = GetFileContents(pieces[1]);
+    if (!contents.ok() || HexDigest(*contents) != pieces[0]) {
+      return std::nullopt;
+    }
+  }
+  return std::string(rest);
+}
+
+absl::Status OutputCache::Insert(
+    std::string_view key, absl::Span<const std::filesystem::path> dependencies,
+    std::string_view output) const {
+  std::string entry =
+      absl::StrCat(kEntryHeader, "\n", dependencies.size(), "\n");
+  for (const std::filesystem::path& dependency : dependencies) {
+    if (dependency.string().find('\n') != std::string::npos) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Cannot cache output depending on path with a newline: %s",
+          dependency.string()));
+    }
+    XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(dependency));
+    absl::StrAppend(&entry, HexDigest(contents), " ", dependency.string(),
+                    "\n");
+  }
+  absl::StrAppend(&entry, output);
+
+  // Write to a temporary file and rename it into place so that concurrent
+  // invocations never observe a partially-written entry.
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(cache_dir_));
+  std::filesystem::path entry_path = GetEntryPath(key);
+  std::filesystem::path temp_path = entry_path;
+  temp_path += absl::StrFormat(".tmp%d", getpid());
+  XLS_RETURN_IF_ERROR(SetFileContents(temp_path, entry));
+  std::error_code ec;
+  std::filesystem::rename(temp_path, entry_path, ec);
+  if (ec) {
+    return absl::InternalError(absl::StrFormat(
+        "Failed to rename %s to %s: %s", temp_path.string(),
+        entry_path.string(), ec.message()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace xls::dslx
@@ -0,0 +1,69 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_OUTPUT_CACHE_H_
+#define XLS_DSLX_OUTPUT_CACHE_H_
+
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+
+namespace xls::dslx {
+
+// On-disk cache of the outputs of DSLX tool invocations, persisted across
+// processes, so that re-running a tool on an unchanged import graph does not
+// re-parse and re-typecheck every module.
+//
+// Parsed modules and their type information are not cached directly: TypeInfo
+// refers into the AST by pointer and cannot be reconstituted without running
+// the frontend again. Instead each entry records the output the tool computed
+// from them, together with the paths and content digests of every module that
+// was loaded to produce it. A lookup only hits if all of those files still have
+// the same contents, so edits anywhere in the import graph (including the
+// standard library) invalidate the entry.
+//
+// Entries are keyed by a caller-provided string, which should capture
+// everything besides the loaded files that affects the output (flags, search
+// paths, etc.), combined with the identity of the running executable so that
+// rebuilt tools do not see stale outputs.
+class OutputCache {
+ public:
+  explicit OutputCache(std::filesystem::path cache_dir)
+      : cache_dir_(std::move(cache_dir)) {}
+
+  // Returns the output cached for `key`, or std::nullopt if there is no entry
+  // or one of the files it depends on has changed since it was inserted.
+  absl::StatusOr<std::optional<std::string>> Lookup(std::string_view key) const;
+
+  // Caches `output` for `key` as depending on the current contents of the
+  // files at `dependencies` (typically ImportData::GetModulePaths()).
+  absl::Status Insert(std::string_view key,
+                      absl::Span<const std::filesystem::path> dependencies,
+                      std::string_view output) const;
+
+ private:
+  std::filesystem::path GetEntryPath(std::string_view key) const;
+
+  std::filesystem::path cache_dir_;
+};
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_OUTPUT_CACHE_H_
@@ -0,0 +1,69 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/output_cache.h"
+
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls::dslx {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::Eq;
+
+TEST(OutputCacheTest, HitsOnlyWhileDependenciesAreUnchanged) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path a = temp_dir.path() / "a.x";
+  std::filesystem::path b = temp_dir.path() / "b.x";
+  XLS_ASSERT_OK(SetFileContents(a, "import b;"));
+  XLS_ASSERT_OK(SetFileContents(b, "pub const X = u32:42;"));
+  std::vector<std::filesystem::path> dependencies = {a, b};
+
+  OutputCache cache(temp_dir.path() / "cache");
+  EXPECT_THAT(cache.Lookup("key"), IsOkAndHolds(Eq(std::nullopt)));
+  XLS_ASSERT_OK(cache.Insert("key", dependencies, "output\nwith lines\n"));
+  EXPECT_THAT(cache.Lookup("key"),
+              IsOkAndHolds(Eq(std::string("output\nwith lines\n"))));
+  EXPECT_THAT(cache.Lookup("other key"), IsOkAndHolds(Eq(std::nullopt)));
+
+  // A new cache object over the same directory (e.g. in a later process) sees
+  // the entry.
+  OutputCache reopened(temp_dir.path() / "cache");
+  EXPECT_THAT(reopened.Lookup("key"),
+              IsOkAndHolds(Eq(std::string("output\nwith lines\n"))));
+
+  // Changing a transitively-loaded file invalidates the entry.
+  XLS_ASSERT_OK(SetFileContents(b, "pub const X = u32:43;"));
+  EXPECT_THAT(cache.Lookup("key"), IsOkAndHolds(Eq(std::nullopt)));
+
+  XLS_ASSERT_OK(cache.Insert("key", dependencies, "new output"));
+  EXPECT_THAT(cache.Lookup("key"),
+              IsOkAndHolds(Eq(std::string("new output"))));
+
+  // As does removing it.
+  std::filesystem::remove(a);
+  EXPECT_THAT(cache.Lookup("key"), IsOkAndHolds(Eq(std::nullopt)));
+}
+
+}  // namespace
+}  // namespace xls::dslx
@@ -28,6 +28,7 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/dslx/frontend/parser.h"
 #include "xls/dslx/frontend/scanner.h"
+#include "xls/dslx/import_routines.h"
 #include "xls/dslx/type_system/typecheck.h"
 #include "xls/dslx/warning_collector.h"
 
@@ -76,6 +77,10 @@ absl::StatusOr<TypecheckedModule> TypecheckModule(
 
   std::string_view module_name = module->name();
 
+  // Parse the (transitive) imports concurrently up front; typechecking then
+  // visits them in order.
+  PrefetchImports(*module, import_data);
+
   WarningCollector warnings(import_data->enabled_warnings());
   XLS_ASSIGN_OR_RETURN(TypeInfo * type_info,
                        CheckModule(module.get(), import_data, &warnings));
@@ -14,11 +14,24 @@
 
 #include "xls/dslx/run_comparator.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <string_view>
 #include <utility>
-
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/dslx/mangle.h"
 #include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/value_helpers.h"
 
 namespace xls::dslx {
 
@@ -43,28 +56,51 @@ absl::Status RunComparator::RunComparison(Package* ir_package,
                                           const InterpValue& got) {
   XLS_RET_CHECK(ir_package != nullptr);
 
-  XLS_ASSIGN_OR_RETURN(
-      std::string ir_name,
-      MangleDslxName(f->owner()->name(), f->identifier(),
-                     requires_implicit_token ? CallingConvention::kImplicitToken
-                                             : CallingConvention::kTypical,
-                     f->GetFreeParametricKeySet(), parametric_env));
-
-  auto get_result = ir_package->GetFunction(ir_name);
+  // Resolved functions are only valid for the package they were found in.
+  if (ir_package != ir_package_) {
+    XLS_RET_CHECK(pending_batches_.empty())
+        << "Comparisons must be flushed before switching IR packages";
+    batches_.clear();
+    ir_package_ = ir_package;
+  }
 
-  // The (converted) IR package does not include specializations of parametric
-  // functions that are only called from test code, so not finding the function
-  // may be benign.
-  //
-  // TODO(amfv): 2021-03-18 Extend IR conversion to include those functions.
-  if (!get_result.ok()) {
-    XLS_LOG(WARNING) << "Could not find " << ir_name
-                     << " function for JIT comparison";
+  InstantiationKey key(
+      f, requires_implicit_token,
+      parametric_env == nullptr ? ParametricEnv() : *parametric_env);
+  auto it = batches_.find(key);
+  if (it == batches_.end()) {
+    XLS_ASSIGN_OR_RETURN(
+        std::string ir_name,
+        MangleDslxName(f->owner()->name(), f->identifier(),
+                       requires_implicit_token
+                           ? CallingConvention::kImplicitToken
+                           : CallingConvention::kTypical,
+                       f->GetFreeParametricKeySet(), parametric_env));
+
+    // The (converted) IR package does not include specializations of
+    // parametric functions that are only called from test code, so not finding
+    // the function may be benign.
+    //
+    // TODO(amfv): 2021-03-18 Extend IR conversion to include those functions.
+    xls::Function* ir_function = nullptr;
+    auto get_result = ir_package->GetFunction(ir_name);
+    if (get_result.ok()) {
+      ir_function = get_result.value();
+    } else {
+      XLS_LOG(WARNING) << "Could not find " << ir_name
+                       << " function for JIT comparison";
+    }
+    auto batch = std::make_unique<ComparisonBatch>(ComparisonBatch{
+        .ir_name = std::move(ir_name),
+        .ir_function = ir_function,
+        .requires_implicit_token = requires_implicit_token});
+    it = batches_.emplace(std::move(key), std::move(batch)).first;
+  }
+  ComparisonBatch& batch = *it->second;
+  if (batch.ir_function == nullptr) {
     return absl::OkStatus();
   }
 
-  xls::Function* ir_function = get_result.value();
-
   XLS_ASSIGN_OR_RETURN(std::vector<Value> ir_args,
                        InterpValue::ConvertValuesToIr(args));
 
@@ -75,47 +111,90 @@ absl::Status RunComparator::RunComparison(Package* ir_package,
     ir_args.insert(ir_args.begin(), Value::Token());
   }
 
+  // Convert the interpreter value to an IR value so we can compare it.
+  //
+  // Note this conversion is lossy, but that's ok because we're just looking for
+  // mismatches.
+  XLS_ASSIGN_OR_RETURN(Value interp_ir_value, got.ConvertToIr());
+
+  if (batch.ir_arg_sets.empty()) {
+    pending_batches_.push_back(&batch);
+  }
+  batch.ir_arg_sets.push_back(std::move(ir_args));
+  batch.expected.push_back(std::move(interp_ir_value));
+  if (batch.ir_arg_sets.size() < kMaxBatchSize) {
+    return absl::OkStatus();
+  }
+  pending_batches_.erase(
+      std::find(pending_batches_.begin(), pending_batches_.end(), &batch));
+  return RunBatch(batch);
+}
+
+absl::Status RunComparator::FlushComparisons() {
+  std::vector<ComparisonBatch*> pending_batches = std::move(pending_batches_);
+  pending_batches_.clear();
+  absl::Status status;
+  for (ComparisonBatch* batch : pending_batches) {
+    status.Update(RunBatch(*batch));
+  }
+  return status;
+}
+
+absl::Status RunComparator::RunBatch(ComparisonBatch& batch) {
+  std::vector<std::vector<Value>> ir_arg_sets = std::move(batch.ir_arg_sets);
+  std::vector<Value> expected = std::move(batch.expected);
+  batch.ir_arg_sets.clear();
+  batch.expected.clear();
+
   const char* mode_str = nullptr;
-  Value ir_result;
+  std::vector<Value> ir_results;
   switch (mode_) {
     case CompareMode::kJit: {  // Compare to IR JIT.
       // TODO(https://github.com/google/xls/issues/506): Also compare events
       // once the DSLX interpreter supports them (and the JIT supports traces).
-      XLS_ASSIGN_OR_RETURN(FunctionJit * jit,
-                           GetOrCompileJitFunction(ir_name, ir_function));
-      XLS_ASSIGN_OR_RETURN(ir_result, DropInterpreterEvents(jit->Run(ir_args)));
+      XLS_ASSIGN_OR_RETURN(
+          FunctionJit * jit,
+          GetOrCompileJitFunction(batch.ir_name, batch.ir_function));
+      XLS_ASSIGN_OR_RETURN(ir_results,
+                           DropInterpreterEvents(jit->RunBatched(ir_arg_sets)));
       mode_str = "JIT";
       break;
     }
     case CompareMode::kInterpreter: {  // Compare to IR interpreter.
-      XLS_ASSIGN_OR_RETURN(ir_result, DropInterpreterEvents(InterpretFunction(
-                                          ir_function, ir_args)));
+      ir_results.reserve(ir_arg_sets.size());
+      for (const std::vector<Value>& ir_args : ir_arg_sets) {
+        XLS_ASSIGN_OR_RETURN(Value ir_result,
+                             DropInterpreterEvents(InterpretFunction(
+                                 batch.ir_function, ir_args)));
+        ir_results.push_back(std::move(ir_result));
+      }
       mode_str = "interpreter";
       break;
     }
   }
+  XLS_RET_CHECK_EQ(ir_results.size(), expected.size());
+
+  for (int64_t i = 0; i < ir_results.size(); ++i) {
+    Value ir_result = std::move(ir_results[i]);
+    if (batch.requires_implicit_token) {
+      // Slice off the first value.
+      XLS_RET_CHECK(ir_result.element(0).IsToken());
+      XLS_RET_CHECK_EQ(ir_result.size(), 2);
+      Value real_ir_result = ir_result.element(1);
+      ir_result = std::move(real_ir_result);
+    }
 
-  if (requires_implicit_token) {
-    // Slice off the first value.
-    XLS_RET_CHECK(ir_result.element(0).IsToken());
-    XLS_RET_CHECK_EQ(ir_result.size(), 2);
-    Value real_ir_result = ir_result.element(1);
-    ir_result = std::move(real_ir_result);
-  }
-
-  // Convert the interpreter value to an IR value so we can compare it.
-  //
-  // Note this conversion is lossy, but that's ok because we're just looking for
-  // mismatches.
-  XLS_ASSIGN_OR_RETURN(Value interp_ir_value, got.ConvertToIr());
-
-  if (interp_ir_value != ir_result) {
-    return absl::InternalError(
-        absl::StrFormat("IR %s produced a different value from the DSL "
-                        "interpreter for %s; IR %s: %s "
-                        "DSL interpreter: %s",
-                        mode_str, ir_function->name(), mode_str,
-                        ir_result.ToString(), interp_ir_value.ToString()));
+    // Comparisons are evaluated after the call, so the arguments are included
+    // to identify the mismatching one.
+    if (expected[i] != ir_result) {
+      return absl::InternalError(absl::StrFormat(
+          "IR %s produced a different value from the DSL "
+          "interpreter for %s(%s); IR %s: %s "
+          "DSL interpreter: %s",
+          mode_str, batch.ir_function->name(),
+          absl::StrJoin(ir_arg_sets[i], ", ", ValueFormatter), mode_str,
+          ir_result.ToString(), expected[i].ToString()));
+    }
   }
   return absl::OkStatus();
 }
@@ -128,4 +207,13 @@ absl::StatusOr<InterpreterResult<xls::Value>> RunComparator::RunIrFunction(
   return jit->Run(ir_args);
 }
 
+absl::StatusOr<InterpreterResult<std::vector<xls::Value>>>
+RunComparator::RunIrFunctionBatched(
+    std::string_view ir_name, xls::Function* ir_function,
+    absl::Span<const std::vector<xls::Value>> ir_arg_sets) {
+  XLS_ASSIGN_OR_RETURN(FunctionJit * jit,
+                       GetOrCompileJitFunction(ir_name, ir_function));
+  return jit->RunBatched(ir_arg_sets);
+}
+
 }  // namespace xls::dslx
@@ -15,12 +15,24 @@
 #ifndef XLS_DSLX_RUN_COMPARATOR_H_
 #define XLS_DSLX_RUN_COMPARATOR_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <tuple>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/test_macros.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/interp_value.h"
 #include "xls/dslx/run_routines.h"
+#include "xls/dslx/type_system/parametric_env.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
 #include "xls/jit/function_jit.h"
 
 namespace xls::dslx {
@@ -36,6 +48,13 @@ enum class CompareMode {
 // comparing interpreter results to results computed by the JIT to check that
 // they're equivalent.
 //
+// Comparisons are deferred: the arguments and interpreter result of each call
+// are queued per IR function and the IR function is evaluated on the whole
+// queue at once (through the JIT's batched entry point) when it fills up or
+// when FlushComparisons() is called. The IR function (and JIT) each DSLX
+// function instantiation resolves to is cached, so a call costs little more
+// than converting its values to IR.
+//
 // Implementation note: slightly simpler to keep in object form so we can
 // inspect cache state more easily than closing over it, e.g. for testing.
 class RunComparator : public AbstractRunComparator {
@@ -48,10 +67,27 @@ class RunComparator : public AbstractRunComparator {
                              const ParametricEnv* parametric_env,
                              const InterpValue& got) override;
 
+  // Evaluates all queued comparisons. Returns an error describing the first
+  // mismatch, if any.
+  absl::Status FlushComparisons() override;
+
   absl::StatusOr<InterpreterResult<xls::Value>> RunIrFunction(
       std::string_view ir_name, xls::Function* ir_function,
       absl::Span<const xls::Value> ir_args) override;
 
+  // Runs all the argument sets through the JIT's batched entry point in a
+  // single call.
+  absl::StatusOr<InterpreterResult<std::vector<xls::Value>>>
+  RunIrFunctionBatched(
+      std::string_view ir_name, xls::Function* ir_function,
+      absl::Span<const std::vector<xls::Value>> ir_arg_sets) override;
+
+  // Returns a comparator in the same mode with its own jit function cache and
+  // comparison queues.
+  std::unique_ptr<AbstractRunComparator> CreateWorker() override {
+    return std::make_unique<RunComparator>(mode_);
+  }
+
   // Returns the cached or newly-compiled jit function for ir_name.  ir_name has
   // already been mangled (see MangleDslxName) so it should be unique in the
   // program and is used as the cache key.
@@ -65,9 +101,40 @@ class RunComparator : public AbstractRunComparator {
   XLS_FRIEND_TEST(RunRoutinesTest, TestInvokedFunctionDoesJit);
   XLS_FRIEND_TEST(RunRoutinesTest, QuickcheckInvokedFunctionDoesJit);
   XLS_FRIEND_TEST(RunRoutinesTest, NoSeedStillQuickChecks);
+  XLS_FRIEND_TEST(RunRoutinesTest, ManyComparisonsAreBatched);
+
+  // Number of comparisons queued for an IR function before they are
+  // evaluated.
+  static constexpr int64_t kMaxBatchSize = 256;
+
+  // The IR function a DSLX function instantiation converts to, along with the
+  // comparisons against it which have not been evaluated yet. `ir_function` is
+  // nullptr if the package does not contain the function.
+  struct ComparisonBatch {
+    std::string ir_name;
+    xls::Function* ir_function;
+    bool requires_implicit_token;
+    std::vector<std::vector<Value>> ir_arg_sets;
+    // The DSLX interpreter results, converted to IR, in the same order.
+    std::vector<Value> expected;
+  };
+
+  // Identifies a DSLX function instantiation: the function, whether it takes an
+  // implicit token and its parametric bindings.
+  using InstantiationKey = std::tuple<const Function*, bool, ParametricEnv>;
+
+  // Evaluates the queued comparisons of `batch` and empties its queue.
+  absl::Status RunBatch(ComparisonBatch& batch);
 
   absl::flat_hash_map<std::string, std::unique_ptr<FunctionJit>> jit_cache_;
   CompareMode mode_;
+
+  // The package the entries of `batches_` refer to.
+  Package* ir_package_ = nullptr;
+  absl::flat_hash_map<InstantiationKey, std::unique_ptr<ComparisonBatch>>
+      batches_;
+  // Batches with queued comparisons, in the order of their first comparison.
+  std::vector<ComparisonBatch*> pending_batches_;
 };
 
 }  // namespace xls::dslx
@@ -16,10 +16,14 @@
 
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <ctime>
+#include <filesystem>  // NOLINT
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <random>
@@ -29,12 +33,16 @@
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/bytecode/bytecode_cache.h"
 #include "xls/dslx/bytecode/bytecode_emitter.h"
 #include "xls/dslx/bytecode/bytecode_interpreter.h"
@@ -56,39 +64,190 @@ namespace {
 constexpr int kUnitSpaces = 7;
 constexpr int kQuickcheckSpaces = 15;
 
+// Number of quickcheck samples generated and handed to the run comparator at
+// a time.
+constexpr int64_t kQuickCheckBatchSize = 1024;
+
 absl::Status RunTestFunction(ImportData* import_data, TypeInfo* type_info,
                              Module* module, TestFunction* tf,
                              const BytecodeInterpreterOptions& options) {
-  auto cache = std::make_unique<BytecodeCache>(import_data);
-  import_data->SetBytecodeCache(std::move(cache));
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<BytecodeFunction> bf,
       BytecodeEmitter::Emit(
           import_data, type_info, tf->fn(), std::nullopt,
-          BytecodeEmitterOptions{.format_preference =
-                                     options.format_preference()}));
+          BytecodeEmitterOptions{
+              .format_preference = options.format_preference(),
+              .fuse_superinstructions = true}));
   return BytecodeInterpreter::Interpret(import_data, bf.get(), /*params=*/{},
                                         options)
       .status();
 }
 
+// Runs `proc_instances` on `num_threads` threads until a value is sent on
+// `terminator`. Each thread owns a fixed subset of the instances and ticks them
+// round-robin. The network is deadlocked once every thread has completed a
+// round without any instance making progress and without any other thread
+// having made progress in the meantime. `max_ticks` bounds the number of
+// rounds each thread executes.
+absl::Status RunProcNetworkConcurrently(
+    absl::Span<ProcInstance> proc_instances,
+    const InterpValue::Channel& terminator, absl::Mutex* channel_mutex,
+    std::optional<int64_t> max_ticks, int64_t num_threads) {
+  num_threads = std::min<int64_t>(num_threads, proc_instances.size());
+
+  absl::Mutex mu;
+  // The following are guarded by `mu`. `epoch` is incremented whenever any
+  // thread makes progress and `idle_threads` counts the threads which found
+  // nothing to do in the current epoch. `blocked_channels` holds the channels
+  // each thread was blocked on in its last round.
+  int64_t epoch = 0;
+  int64_t idle_threads = 0;
+  bool done = false;
+  absl::Status status;
+  std::vector<std::vector<std::string>> blocked_channels(num_threads);
+
+  auto worker = [&](int64_t thread_index) {
+    int64_t tick_count = 0;
+    while (true) {
+      int64_t start_epoch;
+      {
+        absl::MutexLock lock(&mu);
+        if (done) {
+          return;
+        }
+        start_epoch = epoch;
+      }
+
+      absl::Status round_status;
+      bool progress_made = false;
+      std::vector<std::string> round_blocked_channels;
+      for (int64_t i = thread_index; i < proc_instances.size();
+           i += num_threads) {
+        absl::StatusOr<ProcRunResult> run_result = proc_instances[i].Run();
+        if (!run_result.ok()) {
+          round_status = run_result.status();
+          break;
+        }
+        if (run_result->execution_state ==
+            ProcExecutionState::kBlockedOnReceive) {
+          if (!run_result->blocked_channel_name.has_value()) {
+            round_status = absl::InternalError(
+                "Blocked proc did not report a blocked channel.");
+            break;
+          }
+          round_blocked_channels.push_back(
+              run_result->blocked_channel_name.value());
+        }
+        progress_made |= run_result->progress_made;
+      }
+      bool terminated;
+      {
+        absl::MutexLock lock(channel_mutex);
+        terminated = !terminator.empty();
+      }
+
+      absl::MutexLock lock(&mu);
+      if (done) {
+        return;
+      }
+      blocked_channels[thread_index] = std::move(round_blocked_channels);
+      if (!round_status.ok() || terminated) {
+        status = round_status;
+        done = true;
+        return;
+      }
+      if (progress_made) {
+        ++tick_count;
+        if (max_ticks.has_value() && tick_count > max_ticks.value()) {
+          status = absl::DeadlineExceededError(absl::StrFormat(
+              "Exceeded limit of %d proc ticks before terminating",
+              max_ticks.value()));
+          done = true;
+          return;
+        }
+        ++epoch;
+        idle_threads = 0;
+        continue;
+      }
+      if (epoch != start_epoch) {
+        // Another thread made progress during this round; retry.
+        continue;
+      }
+      if (++idle_threads == num_threads) {
+        std::vector<std::string> all_blocked_channels;
+        for (const std::vector<std::string>& channels : blocked_channels) {
+          absl::c_copy(channels, std::back_inserter(all_blocked_channels));
+        }
+        status = absl::DeadlineExceededError(
+            absl::StrFormat("Procs are deadlocked. Blocked channels: %s",
+                            absl::StrJoin(all_blocked_channels, ", ")));
+        done = true;
+        return;
+      }
+      auto woken = [&]() { return done || epoch != start_epoch; };
+      mu.Await(absl::Condition(&woken));
+    }
+  };
+
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < num_threads; ++i) {
+    threads.push_back(std::make_unique<Thread>([&worker, i]() { worker(i); }));
+  }
+  worker(0);
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
+  absl::MutexLock lock(&mu);
+  return status;
+}
+
 absl::Status RunTestProc(ImportData* import_data, TypeInfo* type_info,
                          Module* module, TestProc* tp,
-                         const BytecodeInterpreterOptions& options) {
-  auto cache = std::make_unique<BytecodeCache>(import_data);
-  import_data->SetBytecodeCache(std::move(cache));
-
+                         const BytecodeInterpreterOptions& options,
+                         int64_t proc_threads) {
   XLS_ASSIGN_OR_RETURN(TypeInfo * ti,
                        type_info->GetTopLevelProcTypeInfo(tp->proc()));
 
+  // When running concurrently, channel accesses and the (not necessarily
+  // thread-safe) hooks are serialized.
+  absl::Mutex channel_mutex;
+  absl::Mutex hook_mutex;
+  BytecodeInterpreterOptions instance_options = options;
+  if (proc_threads > 1) {
+    instance_options.channel_mutex(&channel_mutex);
+    if (options.post_fn_eval_hook() != nullptr) {
+      instance_options.post_fn_eval_hook(
+          [&hook_mutex, hook = options.post_fn_eval_hook()](
+              const Function* f, absl::Span<const InterpValue> args,
+              const ParametricEnv* parametric_env, const InterpValue& got) {
+            absl::MutexLock lock(&hook_mutex);
+            return hook(f, args, parametric_env, got);
+          });
+    }
+    if (options.trace_hook() != nullptr) {
+      instance_options.trace_hook(
+          [&hook_mutex, hook = options.trace_hook()](std::string_view entry) {
+            absl::MutexLock lock(&hook_mutex);
+            hook(entry);
+          });
+    }
+  }
+
   std::vector<ProcInstance> proc_instances;
   XLS_ASSIGN_OR_RETURN(InterpValue terminator,
                        ti->GetConstExpr(tp->proc()->config()->params()[0]));
   XLS_RETURN_IF_ERROR(ProcConfigBytecodeInterpreter::InitializeProcNetwork(
-      import_data, ti, tp->proc(), terminator, &proc_instances, options));
+      import_data, ti, tp->proc(), terminator, &proc_instances,
+      instance_options));
 
   std::shared_ptr<InterpValue::Channel> term_chan =
       terminator.GetChannelOrDie();
+  if (proc_threads > 1) {
+    XLS_RETURN_IF_ERROR(RunProcNetworkConcurrently(
+        absl::MakeSpan(proc_instances), *term_chan, &channel_mutex,
+        options.max_ticks(), proc_threads));
+  }
   int64_t tick_count = 0;
   while (term_chan->empty()) {
     bool progress_made = false;
@@ -126,8 +285,173 @@ absl::Status RunTestProc(ImportData* import_data, TypeInfo* type_info,
   return absl::OkStatus();
 }
 
+// Returns the random samples for batch `batch_index` of a quickcheck of
+// `xls_function`. Every batch draws from its own generator seeded from
+// `(seed, batch_index)` so the samples do not depend on which worker evaluates
+// the batch or in which order.
+std::vector<std::vector<Value>> QuickCheckBatchArguments(
+    xls::Function* xls_function, int64_t seed, int64_t batch_index,
+    int64_t batch_size) {
+  std::seed_seq seed_seq = {static_cast<uint32_t>(seed),
+                            static_cast<uint32_t>(seed >> 32),
+                            static_cast<uint32_t>(batch_index),
+                            static_cast<uint32_t>(batch_index >> 32)};
+  std::minstd_rand rng_engine(seed_seq);
+  std::vector<std::vector<Value>> arg_sets;
+  arg_sets.reserve(batch_size);
+  for (int64_t i = 0; i < batch_size; ++i) {
+    arg_sets.push_back(RandomFunctionArguments(xls_function, &rng_engine));
+  }
+  return arg_sets;
+}
+
+// The evaluated samples of one quickcheck batch.
+struct QuickCheckBatch {
+  std::vector<std::vector<Value>> arg_sets;
+  std::vector<Value> results;
+  // Whether the last sample in the batch falsified the predicate.
+  bool falsified = false;
+};
+
+absl::StatusOr<QuickCheckBatch> RunQuickCheckBatch(
+    xls::Function* xls_function, std::string_view ir_name,
+    AbstractRunComparator* run_comparator, int64_t seed, int64_t batch_index,
+    int64_t batch_size) {
+  QuickCheckBatch batch;
+  batch.arg_sets =
+      QuickCheckBatchArguments(xls_function, seed, batch_index, batch_size);
+  // TODO(https://github.com/google/xls/issues/506): 2021-10-15
+  // Assertion failures should work out, but we should consciously decide
+  // if/how we want to dump traces when running QuickChecks (always, for
+  // failures, flag-controlled, ...).
+  XLS_ASSIGN_OR_RETURN(
+      batch.results,
+      DropInterpreterEvents(run_comparator->RunIrFunctionBatched(
+          ir_name, xls_function, batch.arg_sets)));
+  XLS_RET_CHECK_EQ(batch.results.size(), batch_size);
+  auto falsified = absl::c_find_if(
+      batch.results, [](const Value& v) { return v.IsAllZeros(); });
+  if (falsified != batch.results.end()) {
+    // We were able to falsify the xls_function (predicate); only the samples
+    // up to and including the falsifying one are of interest.
+    int64_t count = std::distance(batch.results.begin(), falsified) + 1;
+    batch.arg_sets.resize(count);
+    batch.results.resize(count);
+    batch.falsified = true;
+  }
+  return batch;
+}
+
+// Evaluates up to `num_tests` random samples of the quickcheck predicate
+// `xls_function` in batches, invoking `on_batch(arg_sets, results)` on the
+// samples of each batch in order. When a sample falsifies the predicate,
+// `on_batch` is called with the batch truncated just after that sample and the
+// search stops.
+//
+// Batches are distributed over up to `num_threads` workers, each with its own
+// comparator from AbstractRunComparator::CreateWorker(). Since every batch is
+// seeded independently and batches are reported in order, the outcome is the
+// same for any number of threads.
+absl::Status RunQuickCheckBatches(
+    xls::Function* xls_function, std::string_view ir_name,
+    AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests,
+    int64_t num_threads,
+    const std::function<void(std::vector<std::vector<Value>> arg_sets,
+                             std::vector<Value> results)>& on_batch) {
+  const int64_t num_batches =
+      (num_tests + kQuickCheckBatchSize - 1) / kQuickCheckBatchSize;
+
+  std::atomic<int64_t> next_batch = 0;
+  std::atomic<bool> done = false;
+  absl::Mutex mu;
+  // The following are guarded by `mu`. `pending` holds batches which have been
+  // evaluated but not yet reported because an earlier batch is still being
+  // evaluated.
+  absl::flat_hash_map<int64_t, absl::StatusOr<QuickCheckBatch>> pending;
+  int64_t next_to_report = 0;
+  absl::Status status;
+
+  auto worker = [&](AbstractRunComparator* comparator) {
+    while (!done) {
+      int64_t batch_index = next_batch++;
+      if (batch_index >= num_batches) {
+        return;
+      }
+      int64_t batch_size = std::min(
+          kQuickCheckBatchSize, num_tests - batch_index * kQuickCheckBatchSize);
+      absl::StatusOr<QuickCheckBatch> batch =
+          RunQuickCheckBatch(xls_function, ir_name, comparator, seed,
+                             batch_index, batch_size);
+
+      absl::MutexLock lock(&mu);
+      if (done) {
+        return;
+      }
+      pending.emplace(batch_index, std::move(batch));
+      for (auto it = pending.find(next_to_report); it != pending.end();
+           it = pending.find(next_to_report)) {
+        absl::StatusOr<QuickCheckBatch> ready = std::move(it->second);
+        pending.erase(it);
+        ++next_to_report;
+        if (!ready.ok()) {
+          status = ready.status();
+          done = true;
+          return;
+        }
+        bool falsified = ready->falsified;
+        on_batch(std::move(ready->arg_sets), std::move(ready->results));
+        if (falsified) {
+          done = true;
+          return;
+        }
+      }
+    }
+  };
+
+  std::vector<std::unique_ptr<AbstractRunComparator>> worker_comparators;
+  for (int64_t i = 1; i < std::min(num_threads, num_batches); ++i) {
+    std::unique_ptr<AbstractRunComparator> comparator =
+        run_comparator->CreateWorker();
+    if (comparator == nullptr) {
+      break;
+    }
+    worker_comparators.push_back(std::move(comparator));
+  }
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (std::unique_ptr<AbstractRunComparator>& comparator :
+       worker_comparators) {
+    threads.push_back(std::make_unique<Thread>(
+        [&worker, comparator = comparator.get()]() { worker(comparator); }));
+  }
+  worker(run_comparator);
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
+  absl::MutexLock lock(&mu);
+  return status;
+}
+
 }  // namespace
 
+absl::StatusOr<InterpreterResult<std::vector<xls::Value>>>
+AbstractRunComparator::RunIrFunctionBatched(
+    std::string_view ir_name, xls::Function* ir_function,
+    absl::Span<const std::vector<xls::Value>> ir_arg_sets) {
+  InterpreterResult<std::vector<xls::Value>> result;
+  result.value.reserve(ir_arg_sets.size());
+  for (const std::vector<xls::Value>& ir_args : ir_arg_sets) {
+    XLS_ASSIGN_OR_RETURN(InterpreterResult<xls::Value> sample_result,
+                         RunIrFunction(ir_name, ir_function, ir_args));
+    result.value.push_back(std::move(sample_result.value));
+    absl::c_move(sample_result.events.trace_msgs,
+                 std::back_inserter(result.events.trace_msgs));
+    absl::c_move(sample_result.events.assert_msgs,
+                 std::back_inserter(result.events.assert_msgs));
+  }
+  return result;
+}
+
 static bool TestMatchesFilter(std::string_view test_name,
                               std::optional<std::string_view> test_filter) {
   if (!test_filter.has_value()) {
@@ -139,34 +463,23 @@ static bool TestMatchesFilter(std::string_view test_name,
 
 absl::StatusOr<QuickCheckResults> DoQuickCheck(
     xls::Function* xls_function, std::string_view ir_name,
-    AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests) {
+    AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests,
+    int64_t num_threads) {
   QuickCheckResults results;
-  std::minstd_rand rng_engine(seed);
-
-  for (int i = 0; i < num_tests; i++) {
-    results.arg_sets.push_back(
-        RandomFunctionArguments(xls_function, &rng_engine));
-    // TODO(https://github.com/google/xls/issues/506): 2021-10-15
-    // Assertion failures should work out, but we should consciously decide
-    // if/how we want to dump traces when running QuickChecks (always, for
-    // failures, flag-controlled, ...).
-    XLS_ASSIGN_OR_RETURN(xls::Value result,
-                         DropInterpreterEvents(run_comparator->RunIrFunction(
-                             ir_name, xls_function, results.arg_sets.back())));
-    results.results.push_back(result);
-    if (result.IsAllZeros()) {
-      // We were able to falsify the xls_function (predicate), bail out early
-      // and present this evidence.
-      break;
-    }
-  }
-
+  XLS_RETURN_IF_ERROR(RunQuickCheckBatches(
+      xls_function, ir_name, run_comparator, seed, num_tests, num_threads,
+      [&](std::vector<std::vector<Value>> arg_sets,
+          std::vector<Value> batch_results) {
+        absl::c_move(arg_sets, std::back_inserter(results.arg_sets));
+        absl::c_move(batch_results, std::back_inserter(results.results));
+      }));
   return results;
 }
 
 static absl::Status RunQuickCheck(AbstractRunComparator* run_comparator,
                                   Package* ir_package, QuickCheck* quickcheck,
-                                  TypeInfo* type_info, int64_t seed) {
+                                  TypeInfo* type_info, int64_t seed,
+                                  int64_t num_threads) {
   Function* fn = quickcheck->f();
   XLS_ASSIGN_OR_RETURN(std::string ir_name,
                        MangleDslxName(fn->owner()->name(), fn->identifier(),
@@ -175,18 +488,26 @@ static absl::Status RunQuickCheck(AbstractRunComparator* run_comparator,
   XLS_ASSIGN_OR_RETURN(xls::Function * ir_function,
                        ir_package->GetFunction(ir_name));
 
-  XLS_ASSIGN_OR_RETURN(
-      QuickCheckResults qc_results,
-      DoQuickCheck(ir_function, std::move(ir_name), run_comparator, seed,
-                   quickcheck->test_count()));
-  const auto& [arg_sets, results] = qc_results;
-  XLS_ASSIGN_OR_RETURN(Bits last_result, results.back().GetBitsWithStatus());
-  if (!last_result.IsZero()) {
+  // Only the falsifying example (if any) is of interest, so rather than
+  // accumulating every sample as DoQuickCheck() does we just count them; this
+  // keeps memory use constant for very large sample counts.
+  int64_t tests_run = 0;
+  std::optional<std::vector<Value>> falsifying_argset;
+  XLS_RETURN_IF_ERROR(RunQuickCheckBatches(
+      ir_function, ir_name, run_comparator, seed, quickcheck->test_count(),
+      num_threads,
+      [&](std::vector<std::vector<Value>> arg_sets,
+          std::vector<Value> results) {
+        tests_run += results.size();
+        if (!results.empty() && results.back().IsAllZeros()) {
+          falsifying_argset = std::move(arg_sets.back());
+        }
+      }));
+  if (!falsifying_argset.has_value()) {
     // Did not find a falsifying example.
     return absl::OkStatus();
   }
 
-  const std::vector<Value>& last_argset = arg_sets.back();
   XLS_ASSIGN_OR_RETURN(FunctionType * fn_type,
                        type_info->GetItemAs<FunctionType>(fn));
   const std::vector<std::unique_ptr<ConcreteType>>& params = fn_type->params();
@@ -194,7 +515,7 @@ static absl::Status RunQuickCheck(AbstractRunComparator* run_comparator,
   std::vector<InterpValue> dslx_argset;
   for (int64_t i = 0; i < params.size(); ++i) {
     const ConcreteType& arg_type = *params[i];
-    const Value& value = last_argset[i];
+    const Value& value = (*falsifying_argset)[i];
     XLS_ASSIGN_OR_RETURN(InterpValue interp_value,
                          ValueToInterpValue(value, &arg_type));
     dslx_argset.push_back(interp_value);
@@ -206,7 +527,7 @@ static absl::Status RunQuickCheck(AbstractRunComparator* run_comparator,
   return FailureErrorStatus(
       fn->span(),
       absl::StrFormat("Found falsifying example after %d tests: [%s]",
-                      results.size(), dslx_argset_str));
+                      tests_run, dslx_argset_str));
 }
 
 using HandleError = const std::function<void(
@@ -215,7 +536,8 @@ using HandleError = const std::function<void(
 static absl::Status RunQuickChecksIfJitEnabled(
     Module* entry_module, TypeInfo* type_info,
     AbstractRunComparator* run_comparator, Package* ir_package,
-    std::optional<int64_t> seed, const HandleError& handle_error) {
+    std::optional<int64_t> seed, int64_t num_threads,
+    const HandleError& handle_error) {
   if (run_comparator == nullptr) {
     std::cerr << "[ SKIPPING QUICKCHECKS  ] (JIT is disabled)"
               << "\n";
@@ -233,8 +555,8 @@ static absl::Status RunQuickChecksIfJitEnabled(
     const std::string& test_name = quickcheck->identifier();
     std::cerr << "[ RUN QUICKCHECK        ] " << test_name
               << " count: " << quickcheck->test_count() << "\n";
-    absl::Status status =
-        RunQuickCheck(run_comparator, ir_package, quickcheck, type_info, *seed);
+    absl::Status status = RunQuickCheck(run_comparator, ir_package, quickcheck,
+                                        type_info, *seed, num_threads);
     if (!status.ok()) {
       handle_error(status, test_name, /*is_quickcheck=*/true);
     } else {
@@ -315,7 +637,6 @@ absl::StatusOr<TestResult> ParseAndTest(std::string_view program,
   // If JIT comparisons are "on", we register a post-evaluation hook to compare
   // with the interpreter.
   std::unique_ptr<Package> ir_package;
-  PostFnEvalHook post_fn_eval_hook;
   if (options.run_comparator != nullptr) {
     absl::StatusOr<std::unique_ptr<Package>> ir_package_or =
         ConvertModuleToPackage(entry_module, &import_data,
@@ -327,54 +648,153 @@ absl::StatusOr<TestResult> ParseAndTest(std::string_view program,
       return ir_package_or.status();
     }
     ir_package = std::move(ir_package_or).value();
-    post_fn_eval_hook = [&ir_package, &import_data, &options](
-                            const Function* f,
-                            absl::Span<const InterpValue> args,
-                            const ParametricEnv* parametric_env,
-                            const InterpValue& got) -> absl::Status {
+  }
+
+  // Returns a hook comparing results against `comparator`. If
+  // `comparator_mutex` is non-null, calls to the comparator are serialized by
+  // it.
+  auto make_comparison_hook = [&ir_package, &import_data](
+                                  AbstractRunComparator* comparator,
+                                  absl::Mutex* comparator_mutex) {
+    return [&ir_package, &import_data, comparator, comparator_mutex](
+               const Function* f, absl::Span<const InterpValue> args,
+               const ParametricEnv* parametric_env,
+               const InterpValue& got) -> absl::Status {
       std::optional<bool> requires_implicit_token =
           import_data.GetRootTypeInfoForNode(f)
               .value()
               ->GetRequiresImplicitToken(f);
       XLS_RET_CHECK(requires_implicit_token.has_value());
-      return options.run_comparator->RunComparison(ir_package.get(),
-                                                   *requires_implicit_token, f,
-                                                   args, parametric_env, got);
+      absl::MutexLockMaybe lock(comparator_mutex);
+      return comparator->RunComparison(ir_package.get(),
+                                       *requires_implicit_token, f, args,
+                                       parametric_env, got);
     };
-  }
+  };
 
-  // Run unit tests.
+  // The bytecode cache is thread-safe so all tests share one.
+  import_data.SetBytecodeCache(std::make_unique<BytecodeCache>(
+      &import_data, options.bytecode_cache_dir));
+
+  std::vector<std::string> test_names;
   for (const std::string& test_name : entry_module->GetTestNames()) {
     if (!TestMatchesFilter(test_name, options.test_filter)) {
       skipped += 1;
       continue;
     }
+    test_names.push_back(test_name);
+  }
 
-    ran += 1;
-    std::cerr << "[ RUN UNITTEST  ] " << test_name << std::endl;
-    absl::Status status;
+  // Runs a single unit test, comparing its function results against
+  // `comparator` (if non-null, see `make_comparison_hook`). Tests only read the
+  // module, its type information and the import data, so different tests may
+  // run concurrently.
+  auto run_test = [&](const std::string& test_name,
+                      AbstractRunComparator* comparator,
+                      absl::Mutex* comparator_mutex) -> absl::Status {
     ModuleMember* member = entry_module->FindMemberWithName(test_name).value();
     BytecodeInterpreterOptions interpreter_options;
-    interpreter_options.post_fn_eval_hook(post_fn_eval_hook)
-        .trace_hook(InfoLoggingTraceHook)
+    if (comparator != nullptr) {
+      interpreter_options.post_fn_eval_hook(
+          make_comparison_hook(comparator, comparator_mutex));
+    }
+    interpreter_options.trace_hook(InfoLoggingTraceHook)
         .trace_channels(options.trace_channels)
         .max_ticks(options.max_ticks)
         .format_preference(options.format_preference);
+    absl::Status status;
     if (std::holds_alternative<TestFunction*>(*member)) {
       XLS_ASSIGN_OR_RETURN(TestFunction * tf, entry_module->GetTest(test_name));
       status = RunTestFunction(&import_data, tm_or.value().type_info,
                                entry_module, tf, interpreter_options);
     } else {
-      XLS_ASSIGN_OR_RETURN(TestProc * tp, entry_module->GetTestProc(test_name));
-      status = RunTestProc(&import_data, tm_or.value().type_info, entry_module,
-                           tp, interpreter_options);
+      XLS_ASSIGN_OR_RETURN(TestProc * tp,
+                           entry_module->GetTestProc(test_name));
+      status =
+          RunTestProc(&import_data, tm_or.value().type_info, entry_module, tp,
+                      interpreter_options, options.proc_threads);
     }
-
+    // Complete the comparisons the comparator deferred so that mismatches are
+    // attributed to this test.
+    if (comparator != nullptr) {
+      absl::MutexLockMaybe lock(comparator_mutex);
+      absl::Status comparison_status = comparator->FlushComparisons();
+      if (status.ok()) {
+        status = comparison_status;
+      }
+    }
+    return status;
+  };
+  auto report_test = [&](const std::string& test_name,
+                         const absl::Status& status) {
+    ran += 1;
     if (status.ok()) {
       std::cerr << "[            OK ]" << std::endl;
     } else {
       handle_error(status, test_name, /*is_quickcheck=*/false);
     }
+  };
+
+  // Run unit tests.
+  int64_t num_threads =
+      std::min<int64_t>(options.test_threads, test_names.size());
+  if (num_threads <= 1) {
+    for (const std::string& test_name : test_names) {
+      std::cerr << "[ RUN UNITTEST  ] " << test_name << std::endl;
+      report_test(test_name, run_test(test_name, options.run_comparator,
+                                      /*comparator_mutex=*/nullptr));
+    }
+  } else {
+    // Tests are run by a pool of workers and reported in declaration order as
+    // their results become available.
+    std::atomic<int64_t> next_test = 0;
+    absl::Mutex results_mutex;
+    std::vector<std::optional<absl::Status>> results(test_names.size());
+    // Serializes the shared comparator if it cannot be replicated. In that case
+    // mismatches deferred by one test may be reported by a concurrent one.
+    absl::Mutex comparator_mutex;
+    auto worker = [&]() {
+      // Each worker compares against its own replica of the comparator (with
+      // its own JIT cache), which keeps deferred comparisons with their test.
+      std::unique_ptr<AbstractRunComparator> worker_comparator;
+      AbstractRunComparator* comparator = options.run_comparator;
+      absl::Mutex* worker_comparator_mutex = nullptr;
+      if (comparator != nullptr) {
+        worker_comparator = comparator->CreateWorker();
+        if (worker_comparator != nullptr) {
+          comparator = worker_comparator.get();
+        } else {
+          worker_comparator_mutex = &comparator_mutex;
+        }
+      }
+      for (int64_t i = next_test++; i < test_names.size(); i = next_test++) {
+        absl::Status status =
+            run_test(test_names[i], comparator, worker_comparator_mutex);
+        absl::MutexLock lock(&results_mutex);
+        results[i] = std::move(status);
+      }
+    };
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t i = 0; i < num_threads; ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    for (int64_t i = 0; i < test_names.size(); ++i) {
+      absl::Status status;
+      {
+        absl::MutexLock lock(&results_mutex);
+        results_mutex.Await(absl::Condition(
+            +[](std::optional<absl::Status>* result) {
+              return result->has_value();
+            },
+            &results[i]));
+        status = *results[i];
+      }
+      std::cerr << "[ RUN UNITTEST  ] " << test_names[i] << std::endl;
+      report_test(test_names[i], status);
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
   }
 
   std::cerr << absl::StreamFormat(
@@ -386,7 +806,8 @@ absl::StatusOr<TestResult> ParseAndTest(std::string_view program,
   if (!entry_module->GetQuickChecks().empty()) {
     XLS_RETURN_IF_ERROR(RunQuickChecksIfJitEnabled(
         entry_module, tm_or.value().type_info, options.run_comparator,
-        ir_package.get(), options.seed, handle_error));
+        ir_package.get(), options.seed, options.quickcheck_threads,
+        handle_error));
   }
 
   return failed == 0 ? TestResult::kAllPassed : TestResult::kSomeFailed;
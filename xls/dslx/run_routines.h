@@ -20,6 +20,7 @@
 
 #include <cstdint>
 #include <filesystem>  // NOLINT
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -49,6 +50,10 @@ class AbstractRunComparator {
 
   // Runs a comparison of the DSLX_interpreter-determined value against the
   // otherwise-determined value (e.g. IR interpreter or IR JIT).
+  //
+  // Implementations may defer the comparison (e.g. to evaluate many of them at
+  // once) until FlushComparisons() is called, in which case a mismatch is
+  // reported by a later call. `ir_package` must outlive the deferral.
   virtual absl::Status RunComparison(Package* ir_package,
                                      bool requires_implicit_token,
                                      const Function* f,
@@ -56,6 +61,10 @@ class AbstractRunComparator {
                                      const ParametricEnv* parametric_env,
                                      const InterpValue& got) = 0;
 
+  // Completes all comparisons deferred by RunComparison(), returning an error
+  // if any of them mismatched.
+  virtual absl::Status FlushComparisons() { return absl::OkStatus(); }
+
   // Helper for abstracting over the running of IR functions. i.e. we implement
   // this in subclasses to either execute JIT'd computations or interpreted
   // ones.
@@ -67,6 +76,22 @@ class AbstractRunComparator {
   virtual absl::StatusOr<InterpreterResult<xls::Value>> RunIrFunction(
       std::string_view ir_name, xls::Function* ir_function,
       absl::Span<const xls::Value> ir_args) = 0;
+
+  // As above, but runs the IR function once for each of the given argument
+  // sets, returning the results in order. Implementations backed by the JIT
+  // can override this to amortize per-invocation overhead over the batch; the
+  // default implementation simply calls RunIrFunction() for each set.
+  virtual absl::StatusOr<InterpreterResult<std::vector<xls::Value>>>
+  RunIrFunctionBatched(std::string_view ir_name, xls::Function* ir_function,
+                       absl::Span<const std::vector<xls::Value>> ir_arg_sets);
+
+  // Returns a new comparator, with state independent of this one, which can be
+  // used to run IR functions concurrently with this comparator on another
+  // thread. Returns nullptr if the comparator cannot be replicated, in which
+  // case quickcheck samples are evaluated on the calling thread only.
+  virtual std::unique_ptr<AbstractRunComparator> CreateWorker() {
+    return nullptr;
+  }
 };
 
 // Optional arguments to ParseAndTest (that have sensible defaults).
@@ -82,6 +107,14 @@ class AbstractRunComparator {
 //   warnings_as_errors: Whether warnings should be reported as errors (i.e.
 //    cause the run routine to report failure when a warning is encountered).
 //   warnings: Set of warnings to enable for reporting.
+//   quickcheck_threads: Number of threads over which the samples of each
+//    quickcheck are distributed. Results do not depend on this value.
+//   proc_threads: Number of threads over which the proc instances of each test
+//    proc are run. With more than one thread the interleaving of the procs
+//    (and hence of their trace output) is nondeterministic.
+//   test_threads: Number of threads over which the unit tests (test functions
+//    and test procs) are run. Results are reported in declaration order
+//    regardless, but the trace output of concurrent tests is interleaved.
 struct ParseAndTestOptions {
   std::string stdlib_path = xls::kDefaultDslxStdlibPath;
   absl::Span<const std::filesystem::path> dslx_paths = {};
@@ -95,6 +128,12 @@ struct ParseAndTestOptions {
   WarningKindSet warnings = kAllWarningsSet;
   bool trace_channels = false;
   std::optional<int64_t> max_ticks;
+  int64_t quickcheck_threads = 1;
+  int64_t proc_threads = 1;
+  int64_t test_threads = 1;
+  // If given, bytecode emitted for the functions called by tests is persisted
+  // in (and reused from) this directory; see BytecodeCache.
+  std::optional<std::filesystem::path> bytecode_cache_dir;
 };
 
 enum class TestResult : uint8_t {
@@ -132,9 +171,17 @@ struct QuickCheckResults {
 // xls_function is a predicate we're trying to find evidence to falsify, so if
 // this finds an example that falsifies the predicate, we early-return (i.e. the
 // length of the returned vectors may be < 1000).
+//
+// Samples are evaluated in batches via
+// AbstractRunComparator::RunIrFunctionBatched(); the returned vectors are the
+// same as if each sample had been evaluated one at a time. Batches are
+// distributed over up to `num_threads` threads, each using a comparator from
+// AbstractRunComparator::CreateWorker(); each batch is seeded from `seed` and
+// its index, so the returned vectors are also independent of `num_threads`.
 absl::StatusOr<QuickCheckResults> DoQuickCheck(
     xls::Function* xls_function, std::string_view ir_name,
-    AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests);
+    AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests,
+    int64_t num_threads = 1);
 
 }  // namespace xls::dslx
 
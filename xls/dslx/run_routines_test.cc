@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <filesystem>  // NOLINT
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -24,6 +25,8 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
 #include "xls/dslx/run_comparator.h"
@@ -139,6 +142,113 @@ proc doomed {
               status_testing::IsOkAndHolds(TestResult::kParseOrTypecheckError));
 }
 
+TEST(RunRoutinesTest, ParallelTests) {
+  constexpr std::string_view kPassingTests = R"(
+fn square(x: u32) -> u32 { x * x }
+
+#[test]
+fn test_square_0() { assert_eq(square(u32:0), u32:0) }
+
+#[test]
+fn test_square_3() { assert_eq(square(u32:3), u32:9) }
+
+#[test]
+fn test_square_16() { assert_eq(square(u32:16), u32:256) }
+)";
+  std::string failing_tests = absl::StrCat(kPassingTests, R"(
+#[test]
+fn test_square_wrong() { assert_eq(square(u32:4), u32:15) }
+)");
+  for (int64_t test_threads : {1, 2, 8}) {
+    ParseAndTestOptions options;
+    options.test_threads = test_threads;
+    absl::StatusOr<TestResult> result =
+        ParseAndTest(kPassingTests, "test_module", "test.x", options);
+    EXPECT_THAT(result, status_testing::IsOkAndHolds(TestResult::kAllPassed))
+        << "test_threads: " << test_threads << " " << result.status();
+
+    result = ParseAndTest(failing_tests, "test_module", "test.x", options);
+    EXPECT_THAT(result, status_testing::IsOkAndHolds(TestResult::kSomeFailed))
+        << "test_threads: " << test_threads << " " << result.status();
+  }
+}
+
+TEST(RunRoutinesTest, ManyComparisonsAreBatched) {
+  constexpr const char* kProgram = R"(
+fn add_one(x: u32) -> u32 { x + u32:1 }
+
+#[test]
+fn test_many_calls() {
+  let sum = for (i, sum): (u32, u32) in u32:0..u32:1000 {
+    sum + add_one(i)
+  }(u32:0);
+  assert_eq(sum, u32:500500)
+}
+)";
+  for (CompareMode mode : {CompareMode::kJit, CompareMode::kInterpreter}) {
+    RunComparator comparator(mode);
+    ParseAndTestOptions options;
+    options.run_comparator = &comparator;
+    absl::StatusOr<TestResult> result =
+        ParseAndTest(kProgram, "test", "test.x", options);
+    EXPECT_THAT(result, status_testing::IsOkAndHolds(TestResult::kAllPassed));
+
+    // All calls of `add_one` resolved to the same IR function and the
+    // comparisons were all evaluated by the end of the test.
+    EXPECT_TRUE(comparator.pending_batches_.empty());
+    ASSERT_EQ(comparator.batches_.size(), 1);
+    EXPECT_EQ(comparator.batches_.begin()->second->ir_name, "__test__add_one");
+    if (mode == CompareMode::kJit) {
+      ASSERT_EQ(comparator.jit_cache_.size(), 1);
+      EXPECT_EQ(comparator.jit_cache_.begin()->first, "__test__add_one");
+    } else {
+      EXPECT_TRUE(comparator.jit_cache_.empty());
+    }
+  }
+}
+
+// Comparator which reports a wrong interpreter result for `add_one`.
+class MismatchingRunComparator : public RunComparator {
+ public:
+  MismatchingRunComparator() : RunComparator(CompareMode::kJit) {}
+
+  absl::Status RunComparison(Package* ir_package, bool requires_implicit_token,
+                             const Function* f,
+                             absl::Span<InterpValue const> args,
+                             const ParametricEnv* parametric_env,
+                             const InterpValue& got) override {
+    return RunComparator::RunComparison(
+        ir_package, requires_implicit_token, f, args, parametric_env,
+        f->identifier() == "add_one" ? InterpValue::MakeU32(0) : got);
+  }
+
+  std::unique_ptr<AbstractRunComparator> CreateWorker() override {
+    return std::make_unique<MismatchingRunComparator>();
+  }
+};
+
+TEST(RunRoutinesTest, DeferredMismatchFailsTest) {
+  constexpr const char* kProgram = R"(
+fn add_one(x: u32) -> u32 { x + u32:1 }
+
+#[test]
+fn test_add_one() { assert_eq(add_one(u32:41), u32:42) }
+
+#[test]
+fn test_other() { assert_eq(u32:1, u32:1) }
+)";
+  for (int64_t test_threads : {1, 2}) {
+    MismatchingRunComparator comparator;
+    ParseAndTestOptions options;
+    options.run_comparator = &comparator;
+    options.test_threads = test_threads;
+    absl::StatusOr<TestResult> result =
+        ParseAndTest(kProgram, "test", "test.x", options);
+    EXPECT_THAT(result, status_testing::IsOkAndHolds(TestResult::kSomeFailed))
+        << "test_threads: " << test_threads;
+  }
+}
+
 // Verifies that the QuickCheck mechanism can find counter-examples for a simple
 // erroneous function.
 TEST(QuickcheckTest, QuickCheckBits) {
@@ -260,6 +370,80 @@ TEST(QuickcheckTest, Seeding) {
   EXPECT_EQ(results1, results2);
 }
 
+// Evaluates quickcheck samples one at a time rather than through the JIT's
+// batched entry point.
+class UnbatchedRunComparator : public RunComparator {
+ public:
+  UnbatchedRunComparator() : RunComparator(CompareMode::kJit) {}
+
+  absl::StatusOr<InterpreterResult<std::vector<xls::Value>>>
+  RunIrFunctionBatched(
+      std::string_view ir_name, xls::Function* ir_function,
+      absl::Span<const std::vector<xls::Value>> ir_arg_sets) override {
+    return AbstractRunComparator::RunIrFunctionBatched(ir_name, ir_function,
+                                                       ir_arg_sets);
+  }
+};
+
+// Batched evaluation must see the same samples, and stop at the same
+// falsifying example, as evaluating the samples one at a time.
+TEST(QuickcheckTest, BatchedMatchesUnbatched) {
+  Package package("rarely_false");
+  std::string ir_text = R"(
+  fn not_near_max(x: bits[24]) -> bits[1] {
+    literal.2: bits[24] = literal(value=0xfff000)
+    ret ult.3: bits[1] = ult(x, literal.2)
+  }
+  )";
+  int64_t seed = 42;
+  int64_t num_tests = 100000;
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  RunComparator batched_comparator(CompareMode::kJit);
+  UnbatchedRunComparator unbatched_comparator;
+  XLS_ASSERT_OK_AND_ASSIGN(QuickCheckResults batched,
+                           DoQuickCheck(function, kFakeIrName,
+                                        &batched_comparator, seed, num_tests));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      QuickCheckResults unbatched,
+      DoQuickCheck(function, kFakeIrName, &unbatched_comparator, seed,
+                   num_tests));
+
+  EXPECT_EQ(batched.arg_sets, unbatched.arg_sets);
+  EXPECT_EQ(batched.results, unbatched.results);
+  EXPECT_EQ(batched.arg_sets.size(), batched.results.size());
+}
+
+// Distributing the batches over several threads must report the same samples,
+// and stop at the same falsifying example, as evaluating them on one thread.
+TEST(QuickcheckTest, ParallelMatchesSequential) {
+  Package package("rarely_false");
+  std::string ir_text = R"(
+  fn not_near_max(x: bits[24]) -> bits[1] {
+    literal.2: bits[24] = literal(value=0xfff000)
+    ret ult.3: bits[1] = ult(x, literal.2)
+  }
+  )";
+  int64_t seed = 42;
+  int64_t num_tests = 100000;
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  RunComparator jit_comparator(CompareMode::kJit);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      QuickCheckResults sequential,
+      DoQuickCheck(function, kFakeIrName, &jit_comparator, seed, num_tests,
+                   /*num_threads=*/1));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      QuickCheckResults parallel,
+      DoQuickCheck(function, kFakeIrName, &jit_comparator, seed, num_tests,
+                   /*num_threads=*/8));
+
+  ASSERT_FALSE(sequential.results.empty());
+  EXPECT_EQ(sequential.results.back(), Value(UBits(0, 1)));
+  EXPECT_EQ(parallel.arg_sets, sequential.arg_sets);
+  EXPECT_EQ(parallel.results, sequential.results);
+}
+
 TEST(BytecodeInterpreterTest, DeadlockedProc) {
   // Test proc never sends to the subproc, so network is deadlocked.
   constexpr std::string_view kProgram = R"(
@@ -356,4 +540,110 @@ proc tester_proc {
       << result.status();
 }
 
+constexpr std::string_view kPipelineProgram = R"(
+proc incrementer {
+  in_ch: chan<u32> in;
+  out_ch: chan<u32> out;
+
+  init { () }
+
+  config(in_ch: chan<u32> in,
+         out_ch: chan<u32> out) {
+    (in_ch, out_ch)
+  }
+  next(tok: token, _: ()) {
+    let (tok, i) = recv(tok, in_ch);
+    let tok = send(tok, out_ch, i + u32:1);
+  }
+}
+
+#[test_proc]
+proc tester_proc {
+  data_out: chan<u32> out;
+  data_in: chan<u32> in;
+  terminator: chan<bool> out;
+
+  init { u32:0 }
+
+  config(terminator: chan<bool> out) {
+    let (input_out, input_in) = chan<u32>;
+    let (middle_out, middle_in) = chan<u32>;
+    let (output_out, output_in) = chan<u32>;
+    spawn incrementer(input_in, middle_out);
+    spawn incrementer(middle_in, output_out);
+    (input_out, output_in, terminator)
+  }
+
+  next(tok: token, i: u32) {
+    let tok = send(tok, data_out, i);
+    let (tok, result) = recv(tok, data_in);
+    assert_eq(result, i + u32:2);
+    let tok = send_if(tok, terminator, i == u32:31, true);
+    i + u32:1
+  }
+})";
+
+TEST(BytecodeInterpreterTest, ConcurrentProcNetwork) {
+  for (int64_t proc_threads : {1, 2, 4}) {
+    ParseAndTestOptions options;
+    options.max_ticks = 1000;
+    options.proc_threads = proc_threads;
+    absl::StatusOr<TestResult> result =
+        ParseAndTest(kPipelineProgram, "test_module", "test.x", options);
+    EXPECT_THAT(result, status_testing::IsOkAndHolds(TestResult::kAllPassed))
+        << "proc_threads: " << proc_threads << " " << result.status();
+  }
+}
+
+TEST(BytecodeInterpreterTest, ConcurrentDeadlockedProc) {
+  // The first incrementer's input is never sent to.
+  constexpr std::string_view kProgram = R"(
+proc incrementer {
+  in_ch: chan<u32> in;
+  out_ch: chan<u32> out;
+
+  init { () }
+
+  config(in_ch: chan<u32> in,
+         out_ch: chan<u32> out) {
+    (in_ch, out_ch)
+  }
+  next(tok: token, _: ()) {
+    let (tok, i) = recv(tok, in_ch);
+    let tok = send(tok, out_ch, i + u32:1);
+  }
+}
+
+#[test_proc]
+proc tester_proc {
+  data_out: chan<u32> out;
+  data_in: chan<u32> in;
+  terminator: chan<bool> out;
+
+  init { () }
+
+  config(terminator: chan<bool> out) {
+    let (input_out, input_in) = chan<u32>;
+    let (middle_out, middle_in) = chan<u32>;
+    let (output_out, output_in) = chan<u32>;
+    spawn incrementer(input_in, middle_out);
+    spawn incrementer(middle_in, output_out);
+    (input_out, output_in, terminator)
+  }
+
+  next(tok: token, state: ()) {
+    let tok = send_if(tok, data_out, false, u32:42);
+    let (tok, _result) = recv(tok, data_in);
+    let tok = send(tok, terminator, true);
+ }
+})";
+  ParseAndTestOptions options;
+  options.max_ticks = 100;
+  options.proc_threads = 3;
+  absl::StatusOr<TestResult> result =
+      ParseAndTest(kProgram, "test_module", "test.x", options);
+  EXPECT_THAT(result, status_testing::IsOkAndHolds(TestResult::kSomeFailed))
+      << result.status();
+}
+
 }  // namespace xls::dslx
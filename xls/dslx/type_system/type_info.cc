@@ -280,6 +280,25 @@ void TypeInfo::SetInvocationTypeInfo(const Invocation* invocation,
   data.instantiations[caller] = type_info;
 }
 
+void TypeInfo::NoteInstantiationTypeInfo(const Function* f,
+                                         const ParametricEnv& env,
+                                         TypeInfo* type_info) {
+  XLS_CHECK_EQ(f->owner(), module_);
+  GetRoot()->function_instantiations_.insert_or_assign(std::make_pair(f, env),
+                                                       type_info);
+}
+
+std::optional<TypeInfo*> TypeInfo::GetInstantiationTypeInfo(
+    const Function* f, const ParametricEnv& env) const {
+  XLS_CHECK_EQ(f->owner(), module_);
+  const TypeInfo* root = GetRoot();
+  auto it = root->function_instantiations_.find(std::make_pair(f, env));
+  if (it == root->function_instantiations_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
 absl::Status TypeInfo::SetTopLevelProcTypeInfo(const Proc* p, TypeInfo* ti) {
   if (parent_ != nullptr) {
     return absl::InvalidArgumentError(
@@ -21,6 +21,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -157,6 +158,19 @@ class TypeInfo {
   absl::StatusOr<TypeInfo*> GetInvocationTypeInfoOrError(
       const Invocation* invocation, const ParametricEnv& caller) const;
 
+  // Notes the type information derived by deducing the body of parametric
+  // function `f` under the parametric bindings `env`. The body only depends on
+  // those bindings, so later invocations of `f` with the same bindings -- from
+  // any call site, in any importing module -- can reuse it instead of deducing
+  // the body again. Recorded on the root type information of `f`'s module.
+  void NoteInstantiationTypeInfo(const Function* f, const ParametricEnv& env,
+                                 TypeInfo* type_info);
+
+  // Returns the type information noted via NoteInstantiationTypeInfo() for `f`
+  // under `env`, if any.
+  std::optional<TypeInfo*> GetInstantiationTypeInfo(
+      const Function* f, const ParametricEnv& env) const;
+
   // Sets the type info for the given proc when typechecked at top-level (i.e.,
   // not via an instantiation). Can only be called on the module root TypeInfo.
   absl::Status SetTopLevelProcTypeInfo(const Proc* p, TypeInfo* ti);
@@ -290,6 +304,8 @@ class TypeInfo {
   absl::flat_hash_map<Slice*, SliceData> slices_;
   absl::flat_hash_map<const AstNode*, std::optional<InterpValue>> const_exprs_;
   absl::flat_hash_map<const Function*, bool> requires_implicit_token_;
+  absl::flat_hash_map<std::pair<const Function*, ParametricEnv>, TypeInfo*>
+      function_instantiations_;
 
   // Maps a Proc to the TypeInfo used for its top-level typechecking.
   absl::flat_hash_map<const Proc*, TypeInfo*> top_level_proc_type_info_;
@@ -754,6 +754,29 @@ absl::StatusOr<TypeInfoProto> TypeInfoToProto(const TypeInfo& type_info) {
   return tip;
 }
 
+SpanProto SpanToProto(const Span& span) { return ToProto(span); }
+
+Span SpanFromProto(const SpanProto& proto) { return FromProto(proto); }
+
+absl::StatusOr<InterpValueProto> InterpValueToProto(const InterpValue& v) {
+  return ToProto(v);
+}
+
+absl::StatusOr<InterpValue> InterpValueFromProto(
+    const InterpValueProto& proto) {
+  return FromProto(proto);
+}
+
+absl::StatusOr<ConcreteTypeProto> ConcreteTypeToProto(
+    const ConcreteType& concrete_type) {
+  return ToProto(concrete_type);
+}
+
+absl::StatusOr<std::unique_ptr<ConcreteType>> ConcreteTypeFromProto(
+    const ConcreteTypeProto& proto, const ImportData& import_data) {
+  return FromProto(proto, import_data);
+}
+
 absl::StatusOr<std::string> ToHumanString(const TypeInfoProto& tip,
                                           const ImportData& import_data) {
   std::vector<std::string> lines;
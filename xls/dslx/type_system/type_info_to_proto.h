@@ -15,10 +15,14 @@
 #ifndef XLS_DSLX_TYPE_INFO_TO_PROTO_H_
 #define XLS_DSLX_TYPE_INFO_TO_PROTO_H_
 
+#include <memory>
 #include <string>
 
 #include "absl/status/statusor.h"
+#include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/import_data.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/dslx/type_system/concrete_type.h"
 #include "xls/dslx/type_system/type_info.h"
 #include "xls/dslx/type_system/type_info.pb.h"
 
@@ -28,6 +32,19 @@ namespace xls::dslx {
 // serialization.
 absl::StatusOr<TypeInfoProto> TypeInfoToProto(const TypeInfo& type_info);
 
+// Conversions for the pieces of type information that other serialized
+// artifacts (e.g. persisted bytecode) embed. Values and types referring to
+// struct or enum definitions are resolved against `import_data` on the way
+// back in.
+SpanProto SpanToProto(const Span& span);
+Span SpanFromProto(const SpanProto& proto);
+absl::StatusOr<InterpValueProto> InterpValueToProto(const InterpValue& v);
+absl::StatusOr<InterpValue> InterpValueFromProto(const InterpValueProto& proto);
+absl::StatusOr<ConcreteTypeProto> ConcreteTypeToProto(
+    const ConcreteType& concrete_type);
+absl::StatusOr<std::unique_ptr<ConcreteType>> ConcreteTypeFromProto(
+    const ConcreteTypeProto& proto, const ImportData& import_data);
+
 // Converts the given protobuf representation of an AST node in module "m" into
 // a human readable string suitable for debugging and convenient testing.
 absl::StatusOr<std::string> ToHumanString(const AstNodeTypeInfoProto& antip,
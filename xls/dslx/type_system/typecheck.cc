@@ -1072,9 +1072,30 @@ absl::StatusOr<TypeAndParametricEnv> CheckInvocation(
   parent_ctx->type_info()->SetItem(invocation->callee(), instantiated_ft);
   ctx->type_info()->SetItem(callee_fn->name_def(), instantiated_ft);
 
+  TypeInfo* original_ti = parent_ctx->type_info();
+
+  // The body of a (non-proc) parametric function only depends on its
+  // parametric bindings, so if it has already been deduced under these
+  // bindings we reuse the derived type information. Procs are excluded since
+  // every instantiation needs its own constexpr values for proc members.
+  const bool memoizable =
+      !callee_fn->proc().has_value() && constexpr_env.empty();
+  if (memoizable) {
+    if (std::optional<TypeInfo*> instantiation_ti =
+            ctx->type_info()->GetInstantiationTypeInfo(
+                callee_fn, callee_tab.parametric_env);
+        instantiation_ti.has_value()) {
+      XLS_VLOG(5) << "Reusing type info for instantiation of `"
+                  << callee_fn->identifier()
+                  << "` with: " << callee_tab.parametric_env;
+      original_ti->SetInvocationTypeInfo(invocation, callee_tab.parametric_env,
+                                         *instantiation_ti);
+      return callee_tab;
+    }
+  }
+
   // We need to deduce fn body, so we're going to call Deduce, which means we'll
   // need a new stack entry w/the new symbolic bindings.
-  TypeInfo* original_ti = parent_ctx->type_info();
   ctx->AddFnStackEntry(FnStackEntry::Make(
       callee_fn, callee_tab.parametric_env, invocation,
       callee_fn->proc().has_value() ? WithinProc::kYes : WithinProc::kNo));
@@ -1166,6 +1187,10 @@ absl::StatusOr<TypeAndParametricEnv> CheckInvocation(
 
   original_ti->SetInvocationTypeInfo(invocation, callee_tab.parametric_env,
                                      ctx->type_info());
+  if (memoizable) {
+    ctx->type_info()->NoteInstantiationTypeInfo(
+        callee_fn, callee_tab.parametric_env, ctx->type_info());
+  }
 
   XLS_RETURN_IF_ERROR(ctx->PopDerivedTypeInfo());
   ctx->PopFnStackEntry();
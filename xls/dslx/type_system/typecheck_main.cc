@@ -23,16 +23,20 @@
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/dslx/command_line_utils.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
 #include "xls/dslx/import_data.h"
+#include "xls/dslx/output_cache.h"
 #include "xls/dslx/parse_and_typecheck.h"
 #include "xls/dslx/type_system/type_info_to_proto.h"
 #include "xls/dslx/warning_kind.h"
@@ -44,6 +48,11 @@ ABSL_FLAG(std::string, dslx_stdlib_path, xls::kDefaultDslxStdlibPath,
 ABSL_FLAG(std::string, output_path, "",
           "Path to dump the type information to as a protobin -- if not "
           "provided textual proto is given on stdout.");
+ABSL_FLAG(std::string, cache_dir, "",
+          "If given, directory in which the output is cached across "
+          "invocations; when neither the flags nor any file in the import "
+          "graph have changed, the cached output is emitted without parsing "
+          "or typechecking.");
 
 namespace xls::dslx {
 namespace {
@@ -53,10 +62,14 @@ Parses and typechecks the specified module and emits the type information that
 was deduced.
 )";
 
-absl::Status RealMain(absl::Span<const std::filesystem::path> dslx_paths,
-                      const std::filesystem::path& dslx_stdlib_path,
-                      const std::filesystem::path& input_path,
-                      std::optional<std::filesystem::path> output_path) {
+// Returns the output of typechecking the module at `input_path`: the
+// serialized TypeInfoProto if `binary` is true, or its human-readable form.
+// `dependencies` is populated with the paths of all the loaded modules.
+absl::StatusOr<std::string> Typecheck(
+    absl::Span<const std::filesystem::path> dslx_paths,
+    const std::filesystem::path& dslx_stdlib_path,
+    const std::filesystem::path& input_path, bool binary,
+    std::vector<std::filesystem::path>* dependencies) {
   ImportData import_data(CreateImportData(
       dslx_stdlib_path,
       /*additional_search_paths=*/dslx_paths, kAllWarningsSet));
@@ -71,14 +84,54 @@ absl::Status RealMain(absl::Span<const std::filesystem::path> dslx_paths,
     }
     return tm_or.status();
   }
+  *dependencies = import_data.GetModulePaths();
   XLS_ASSIGN_OR_RETURN(TypeInfoProto tip, TypeInfoToProto(*tm_or->type_info));
-  if (output_path.has_value()) {
+  if (binary) {
     std::string output;
     XLS_QCHECK(tip.SerializeToString(&output));
-    return SetFileContents(output_path->c_str(), output);
+    return output;
+  }
+  return ToHumanString(tip, import_data);
+}
+
+absl::Status RealMain(absl::Span<const std::filesystem::path> dslx_paths,
+                      const std::filesystem::path& dslx_stdlib_path,
+                      const std::filesystem::path& input_path,
+                      std::optional<std::filesystem::path> output_path,
+                      std::optional<std::filesystem::path> cache_dir) {
+  bool binary = output_path.has_value();
+  std::optional<OutputCache> cache;
+  std::string cache_key;
+  std::optional<std::string> output;
+  if (cache_dir.has_value()) {
+    cache.emplace(*cache_dir);
+    XLS_ASSIGN_OR_RETURN(std::filesystem::path cwd, GetCurrentDirectory());
+    cache_key = absl::StrJoin(
+        {std::string("typecheck_main"), cwd.string(), input_path.string(),
+         dslx_stdlib_path.string(),
+         absl::StrJoin(dslx_paths, ":",
+                       [](std::string* out, const std::filesystem::path& p) {
+                         absl::StrAppend(out, p.string());
+                       }),
+         std::string(binary ? "binary" : "text")},
+        "\n");
+    XLS_ASSIGN_OR_RETURN(output, cache->Lookup(cache_key));
+  }
+  if (!output.has_value()) {
+    std::vector<std::filesystem::path> dependencies;
+    XLS_ASSIGN_OR_RETURN(output, Typecheck(dslx_paths, dslx_stdlib_path,
+                                           input_path, binary, &dependencies));
+    if (cache.has_value()) {
+      if (absl::Status status = cache->Insert(cache_key, dependencies, *output);
+          !status.ok()) {
+        XLS_LOG(WARNING) << "Failed to cache typecheck output: " << status;
+      }
+    }
   }
-  XLS_ASSIGN_OR_RETURN(std::string humanized, ToHumanString(tip, import_data));
-  std::cout << humanized << std::endl;
+  if (binary) {
+    return SetFileContents(output_path->c_str(), *output);
+  }
+  std::cout << *output << std::endl;
   return absl::OkStatus();
 }
 
@@ -110,6 +163,11 @@ int main(int argc, char* argv[]) {
 
   std::filesystem::path dslx_stdlib_path(absl::GetFlag(FLAGS_dslx_stdlib_path));
 
-  return xls::ExitStatus(xls::dslx::RealMain(dslx_paths, dslx_stdlib_path,
-                                             input_path, output_path));
+  std::optional<std::filesystem::path> cache_dir;
+  if (std::string flag = absl::GetFlag(FLAGS_cache_dir); !flag.empty()) {
+    cache_dir = flag;
+  }
+
+  return xls::ExitStatus(xls::dslx::RealMain(
+      dslx_paths, dslx_stdlib_path, input_path, output_path, cache_dir));
 }
@@ -23,6 +23,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/matchers.h"
@@ -31,7 +32,9 @@
 #include "xls/dslx/error_test_utils.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/frontend/pos.h"
+#include "xls/dslx/import_data.h"
 #include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/type_system/type_info.h"
 #include "xls/dslx/type_system/typecheck_test_helpers.h"
 
 namespace xls::dslx {
@@ -1395,6 +1398,63 @@ fn main() {
   EXPECT_TRUE(visitor.all_numbers_constexpr());
 }
 
+// Returns the distinct derived type infos recorded for the invocations in
+// `type_info`.
+static absl::flat_hash_set<TypeInfo*> GetInstantiationTypeInfos(
+    const TypeInfo& type_info) {
+  absl::flat_hash_set<TypeInfo*> result;
+  for (const auto& [invocation, data] : type_info.invocations()) {
+    for (const auto& [env, ti] : data.instantiations) {
+      result.insert(ti);
+    }
+  }
+  return result;
+}
+
+TEST(TypecheckTest, ParametricInstantiationsAreReused) {
+  constexpr std::string_view kProgram = R"(
+fn id<N: u32>(x: uN[N]) -> uN[N] { x }
+
+fn main() -> u8 {
+  let a = id(u8:1);
+  let b = id(u8:2);
+  let c = id(u16:3);
+  a + b + c as u8
+}
+)";
+  ImportData import_data(CreateImportDataForTest());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheck(kProgram, "fake.x", "fake", &import_data));
+  // The two `N=8` invocations share their type info.
+  EXPECT_EQ(GetInstantiationTypeInfos(*tm.type_info).size(), 2);
+}
+
+TEST(TypecheckTest, ParametricInstantiationsAreReusedAcrossImporters) {
+  constexpr std::string_view kImported = R"(
+pub fn id<N: u32>(x: uN[N]) -> uN[N] { x }
+)";
+  constexpr std::string_view kImporter = R"(
+import imported
+
+fn main() -> u8 { imported::id(u8:1) }
+)";
+  ImportData import_data(CreateImportDataForTest());
+  XLS_ASSERT_OK(
+      ParseAndTypecheck(kImported, "imported.x", "imported", &import_data)
+          .status());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule first,
+      ParseAndTypecheck(kImporter, "first.x", "first", &import_data));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule second,
+      ParseAndTypecheck(kImporter, "second.x", "second", &import_data));
+  absl::flat_hash_set<TypeInfo*> first_tis =
+      GetInstantiationTypeInfos(*first.type_info);
+  ASSERT_EQ(first_tis.size(), 1);
+  EXPECT_EQ(GetInstantiationTypeInfos(*second.type_info), first_tis);
+}
+
 TEST(TypecheckTest, BasicTupleIndex) {
   XLS_EXPECT_OK(Typecheck(R"(
 fn main() -> u18 {
@@ -17,6 +17,8 @@
 #include <algorithm>
 #include <cstdint>
 #include <iterator>
+#include <limits>
+#include <memory>
 #include <random>
 #include <tuple>
 #include <vector>
@@ -26,9 +28,11 @@
 #include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
@@ -37,31 +41,83 @@
 #include "xls/scheduling/scheduling_options.h"
 
 namespace xls {
+namespace {
+
+// The minimum number of rows or columns of the delay matrix handled by each
+// thread in PropagateDelays; smaller functions are not worth splitting.
+constexpr int64_t kMinIndicesPerThread = 256;
+
+// Splits [0, count) into contiguous chunks and runs "fn(begin, end)" on one
+// thread per chunk, using at most "thread_count" threads.
+void ParallelForChunks(int64_t count, int64_t thread_count,
+                       absl::FunctionRef<void(int64_t, int64_t)> fn) {
+  int64_t chunk_count = std::clamp<int64_t>(count / kMinIndicesPerThread, 1,
+                                            std::max<int64_t>(thread_count, 1));
+  if (chunk_count == 1) {
+    fn(0, count);
+    return;
+  }
+  int64_t chunk_size = (count + chunk_count - 1) / chunk_count;
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(chunk_count);
+  for (int64_t begin = 0; begin < count; begin += chunk_size) {
+    int64_t end = std::min(begin + chunk_size, count);
+    threads.push_back(
+        std::make_unique<Thread>([fn, begin, end]() { fn(begin, end); }));
+  }
+  for (std::unique_ptr<Thread> &thread : threads) {
+    thread->Join();
+  }
+}
+
+}  // namespace
 
 DelayManager::DelayManager(FunctionBase *function,
-                           const DelayEstimator &delay_estimator)
+                           const DelayEstimator &delay_estimator,
+                           int64_t thread_count)
     : function_(function),
-      index_to_node_(function_->node_count()),
-      indices_to_delay_(function_->node_count(),
-                        std::vector<int64_t>(function_->node_count(), -1)),
-      indices_to_critical_operand_(
-          function_->node_count(),
-          std::vector<Node *>(function_->node_count(), nullptr)),
+      node_count_(function_->node_count()),
+      thread_count_(thread_count > 0 ? thread_count
+                                     : std::max(AvailableCPUs(), 1)),
+      index_to_node_(node_count_),
+      indices_to_delay_(node_count_ * node_count_, -1),
+      indices_to_critical_operand_(node_count_ * node_count_, -1),
+      changed_(node_count_ * node_count_, 0),
+      row_changed_(node_count_, 0),
+      column_changed_(node_count_, 0),
+      node_delay_changed_(node_count_, 0),
+      operand_indices_(node_count_),
+      user_indices_(node_count_),
       name_(delay_estimator.name()) {
+  XLS_CHECK_LE(node_count_, std::numeric_limits<int32_t>::max());
   // Get the mapping between function node and their index. Also, estimate the
   // delay of each node.
-  node_to_index_.reserve(function_->node_count());
+  node_to_index_.reserve(node_count_);
   int32_t index = 0;
   for (Node *node : function_->nodes()) {
     node_to_index_[node] = index;
     index_to_node_[index] = node;
-    absl::StatusOr<int64_t> maybe_delay =
-        delay_estimator.GetOperationDelayInPs(node);
-    XLS_CHECK_OK(maybe_delay.status());
-    indices_to_delay_[index][index] = maybe_delay.value();
     index++;
   }
-  PropagateDelays();
+  std::vector<absl::StatusOr<int64_t>> delays =
+      delay_estimator.GetOperationDelaysInPs(index_to_node_);
+  for (index = 0; index < node_count_; ++index) {
+    XLS_CHECK_OK(delays[index].status());
+    Delay(index, index) = delays[index].value();
+  }
+  topo_sorted_indices_.reserve(node_count_);
+  for (Node *node : TopoSort(function_)) {
+    topo_sorted_indices_.push_back(node_to_index_.at(node));
+  }
+  for (index = 0; index < node_count_; ++index) {
+    for (Node *operand : index_to_node_[index]->operands()) {
+      operand_indices_[index].push_back(node_to_index_.at(operand));
+    }
+    for (Node *user : index_to_node_[index]->users()) {
+      user_indices_[index].push_back(node_to_index_.at(user));
+    }
+  }
+  PropagateAllDelays();
 }
 
 absl::StatusOr<int64_t> DelayManager::GetNodeDelay(Node *node) const {
@@ -69,7 +125,7 @@ absl::StatusOr<int64_t> DelayManager::GetNodeDelay(Node *node) const {
     return absl::InvalidArgumentError("invalid node");
   }
   int64_t node_index = node_to_index_.at(node);
-  return indices_to_delay_[node_index][node_index];
+  return Delay(node_index, node_index);
 }
 
 absl::StatusOr<int64_t> DelayManager::GetCriticalPathDelay(Node *from,
@@ -79,7 +135,7 @@ absl::StatusOr<int64_t> DelayManager::GetCriticalPathDelay(Node *from,
   }
   int64_t from_index = node_to_index_.at(from);
   int64_t to_index = node_to_index_.at(to);
-  return indices_to_delay_[from_index][to_index];
+  return Delay(from_index, to_index);
 }
 
 absl::Status DelayManager::SetCriticalPathDelay(Node *from, Node *to,
@@ -90,10 +146,14 @@ absl::Status DelayManager::SetCriticalPathDelay(Node *from, Node *to,
   }
   int64_t from_index = node_to_index_.at(from);
   int64_t to_index = node_to_index_.at(to);
-  int64_t &current_delay = indices_to_delay_[from_index][to_index];
+  int64_t &current_delay = Delay(from_index, to_index);
   if (!if_shorter || current_delay > delay) {
-    if (!if_exist || current_delay != -1) {
+    if ((!if_exist || current_delay != -1) && current_delay != delay) {
       current_delay = delay;
+      MarkChanged(from_index, to_index);
+      if (from_index == to_index) {
+        node_delay_changed_[from_index] = 1;
+      }
     }
   }
   return absl::OkStatus();
@@ -103,90 +163,246 @@ absl::StatusOr<std::vector<Node *>> DelayManager::GetFullCriticalPath(
     Node *from, Node *to) const {
   int64_t from_index = node_to_index_.at(from);
   int64_t to_index = node_to_index_.at(to);
+  const int32_t *critical_operands =
+      &indices_to_critical_operand_[from_index * node_count_];
   std::vector<Node *> critical_path;
 
-  Node *critical_operand = indices_to_critical_operand_[from_index][to_index];
+  int64_t critical_operand_index = critical_operands[to_index];
   critical_path.push_back(to);
-  while (critical_operand != nullptr && critical_operand != from) {
-    critical_path.push_back(critical_operand);
-    int64_t critical_operand_index = node_to_index_.at(critical_operand);
-    critical_operand =
-        indices_to_critical_operand_[from_index][critical_operand_index];
+  while (critical_operand_index != -1 && critical_operand_index != from_index) {
+    critical_path.push_back(index_to_node_[critical_operand_index]);
+    critical_operand_index = critical_operands[critical_operand_index];
   }
-  XLS_RET_CHECK(critical_operand == from);
+  XLS_RET_CHECK(critical_operand_index == from_index);
   critical_path.push_back(from);
   std::reverse(critical_path.begin(), critical_path.end());
   return critical_path;
 }
 
-void DelayManager::PropagateDelays() {
-  // Traverse the function in a reversed topological order.
-  for (Node *node : ReverseTopoSort(function_)) {
-    int64_t node_index = node_to_index_[node];
-    int64_t node_delay = indices_to_delay_[node_index][node_index];
-    std::vector<int64_t> new_delays(function_->node_count(), -1);
-
-    // Compute the critical-path distance from `a` to `node` for all nodes `a`
-    // from the delays of `a` to each operand of `node`.
-    for (Node *user : node->users()) {
-      int64_t user_index = node_to_index_[user];
-      for (int64_t i = 0; i < function_->node_count(); ++i) {
-        int64_t from_user_delay = indices_to_delay_[user_index][i];
-        if (from_user_delay != -1) {
-          // Always pick the critical path.
-          if (new_delays[i] < from_user_delay + node_delay) {
-            new_delays[i] = from_user_delay + node_delay;
+void DelayManager::PropagateDelays() { PropagateDelaysInternal(/*all=*/false); }
+
+void DelayManager::PropagateAllDelays() {
+  PropagateDelaysInternal(/*all=*/true);
+}
+
+void DelayManager::MarkChanged(int64_t from_index, int64_t to_index) {
+  changed_[from_index * node_count_ + to_index] =
+      kChangedSinceTargetPass | kChangedSinceSourcePass;
+  column_changed_[to_index] = 1;
+  row_changed_[from_index] = 1;
+}
+
+void DelayManager::PropagateDelaysInternal(bool all) {
+  // A changed node delay affects the delays to every node in its fanout cone
+  // in the reversed pass, and the delays from every node in its fanin cone in
+  // the topological pass.
+  bool any_node_delay_changed =
+      std::any_of(node_delay_changed_.begin(), node_delay_changed_.end(),
+                  [](uint8_t c) { return c != 0; });
+  if (any_node_delay_changed && !all) {
+    std::vector<uint8_t> in_fanout(node_count_, 0);
+    for (int64_t node_index : topo_sorted_indices_) {
+      in_fanout[node_index] = node_delay_changed_[node_index];
+      for (int64_t operand_index : operand_indices_[node_index]) {
+        in_fanout[node_index] |= in_fanout[operand_index];
+      }
+      column_changed_[node_index] |= in_fanout[node_index];
+    }
+    std::vector<uint8_t> in_fanin(node_count_, 0);
+    for (auto it = topo_sorted_indices_.rbegin();
+         it != topo_sorted_indices_.rend(); ++it) {
+      int64_t node_index = *it;
+      in_fanin[node_index] = node_delay_changed_[node_index];
+      for (int64_t user_index : user_indices_[node_index]) {
+        in_fanin[node_index] |= in_fanin[user_index];
+      }
+      row_changed_[node_index] |= in_fanin[node_index];
+    }
+  }
+
+  // The delay of a node itself is not changed by propagation, so it can be
+  // read up front by every thread.
+  std::vector<int64_t> node_delays(node_count_);
+  for (int64_t i = 0; i < node_count_; ++i) {
+    node_delays[i] = Delay(i, i);
+  }
+
+  // Rows and columns containing entries changed by one pass, to be revisited
+  // by the next pass. Collected per thread and merged under `mu`.
+  absl::Mutex mu;
+
+  // Traverse the function in a reversed topological order. Each thread owns a
+  // range of the columns which need to be revisited and processes contiguous
+  // runs of them at a time.
+  std::vector<int64_t> columns;
+  for (int64_t i = 0; i < node_count_; ++i) {
+    if (all || column_changed_[i] != 0) {
+      columns.push_back(i);
+    }
+  }
+  auto propagate_to_targets = [&](int64_t column_begin, int64_t column_end) {
+    std::vector<int64_t> changed_rows;
+    std::vector<int64_t> new_delays;
+    int64_t run_start = column_begin;
+    while (run_start < column_end) {
+      int64_t run_end = run_start + 1;
+      while (run_end < column_end &&
+             columns[run_end] == columns[run_end - 1] + 1) {
+        ++run_end;
+      }
+      int64_t begin = columns[run_start];
+      int64_t end = columns[run_end - 1] + 1;
+      run_start = run_end;
+
+      new_delays.resize(end - begin);
+      for (auto it = topo_sorted_indices_.rbegin();
+           it != topo_sorted_indices_.rend(); ++it) {
+        int64_t node_index = *it;
+        // The delays from `node` only need to be recomputed if its own delay
+        // or the delay from one of its users changed.
+        bool inputs_changed = all || node_delay_changed_[node_index] != 0;
+        for (int64_t user_index : user_indices_[node_index]) {
+          if (inputs_changed) {
+            break;
           }
+          const uint8_t *user_changed = &changed_[user_index * node_count_];
+          inputs_changed = std::any_of(
+              user_changed + begin, user_changed + end,
+              [](uint8_t c) { return (c & kChangedSinceTargetPass) != 0; });
+        }
+        if (!inputs_changed) {
+          continue;
+        }
+
+        int64_t node_delay = node_delays[node_index];
+        std::fill(new_delays.begin(), new_delays.end(), -1);
+
+        // Compute the critical-path distance from `node` to `a` for all nodes
+        // `a` from the delays of each user of `node` to `a`.
+        for (int64_t user_index : user_indices_[node_index]) {
+          const int64_t *from_user_delays = &Delay(user_index, begin);
+          for (int64_t i = 0; i < end - begin; ++i) {
+            int64_t from_user_delay = from_user_delays[i];
+            // Always pick the critical path.
+            if (from_user_delay != -1 &&
+                new_delays[i] < from_user_delay + node_delay) {
+              new_delays[i] = from_user_delay + node_delay;
+            }
+          }
+        }
+
+        // Update the original delay if the newly calculated delay is smaller.
+        int64_t *current_delays = &Delay(node_index, begin);
+        uint8_t *current_changed = &changed_[node_index * node_count_ + begin];
+        bool row_changed = false;
+        for (int64_t i = 0; i < end - begin; ++i) {
+          if (new_delays[i] != -1) {
+            int64_t &current_delay = current_delays[i];
+            if (current_delay > new_delays[i] || current_delay == -1) {
+              current_delay = new_delays[i];
+              current_changed[i] =
+                  kChangedSinceTargetPass | kChangedSinceSourcePass;
+              row_changed = true;
+            }
+          }
+        }
+        if (row_changed) {
+          changed_rows.push_back(node_index);
         }
       }
-    }
 
-    // Update the original delay if the newly calculated delay is smaller.
-    for (int64_t i = 0; i < function_->node_count(); ++i) {
-      if (new_delays[i] != -1) {
-        int64_t &current_delay = indices_to_delay_[node_index][i];
-        if (current_delay >= new_delays[i] || current_delay == -1) {
-          current_delay = new_delays[i];
+      // Every entry changed since the last reversed pass is in one of the
+      // revisited columns.
+      for (int64_t row = 0; row < node_count_; ++row) {
+        uint8_t *row_changed = &changed_[row * node_count_];
+        for (int64_t i = begin; i < end; ++i) {
+          row_changed[i] &= ~kChangedSinceTargetPass;
         }
       }
     }
+    absl::MutexLock lock(&mu);
+    for (int64_t row : changed_rows) {
+      row_changed_[row] = 1;
+    }
+  };
+  ParallelForChunks(columns.size(), thread_count_, propagate_to_targets);
+  for (int64_t column : columns) {
+    column_changed_[column] = 0;
   }
 
-  // Traverse the function in a topological order.
-  for (Node *node : TopoSort(function_)) {
-    int64_t node_index = node_to_index_[node];
-    int64_t node_delay = indices_to_delay_[node_index][node_index];
-    std::vector<int64_t> new_delays(function_->node_count(), -1);
-    std::vector<Node *> new_critical_operands(function_->node_count(), nullptr);
-
-    // Compute the critical-path distance from `a` to `node` for all nodes `a`
-    // from the delays of `a` to each operand of `node`.
-    for (Node *operand : node->operands()) {
-      int64_t operand_index = node_to_index_[operand];
-      for (int64_t i = 0; i < function_->node_count(); ++i) {
-        int64_t to_operand_delay = indices_to_delay_[i][operand_index];
-        if (to_operand_delay != -1) {
+  // Traverse the function in a topological order. Each thread owns a range of
+  // the rows which need to be revisited, which it updates one row at a time.
+  std::vector<int64_t> rows;
+  for (int64_t i = 0; i < node_count_; ++i) {
+    if (all || row_changed_[i] != 0) {
+      rows.push_back(i);
+    }
+  }
+  auto propagate_from_sources = [&](int64_t row_begin, int64_t row_end) {
+    std::vector<uint8_t> changed_columns(node_count_, 0);
+    for (int64_t r = row_begin; r < row_end; ++r) {
+      int64_t from_index = rows[r];
+      int64_t *delays = &Delay(from_index, 0);
+      uint8_t *changed = &changed_[from_index * node_count_];
+      int32_t *critical_operands =
+          &indices_to_critical_operand_[from_index * node_count_];
+      for (int64_t node_index : topo_sorted_indices_) {
+        // The delay to `node` only needs to be recomputed if its own delay or
+        // the delay to one of its operands changed.
+        bool inputs_changed = all || node_delay_changed_[node_index] != 0;
+        for (int64_t operand_index : operand_indices_[node_index]) {
+          inputs_changed = inputs_changed ||
+                           (changed[operand_index] & kChangedSinceSourcePass);
+        }
+        if (!inputs_changed) {
+          continue;
+        }
+
+        int64_t node_delay = node_delays[node_index];
+        int64_t new_delay = -1;
+        int64_t new_critical_operand = -1;
+
+        // Compute the critical-path distance from `from` to `node` from the
+        // delays of `from` to each operand of `node`.
+        for (int64_t operand_index : operand_indices_[node_index]) {
+          int64_t to_operand_delay = delays[operand_index];
           // Always pick the critical path.
-          if (new_delays[i] < to_operand_delay + node_delay) {
-            new_delays[i] = to_operand_delay + node_delay;
-            new_critical_operands[i] = operand;
+          if (to_operand_delay != -1 &&
+              new_delay < to_operand_delay + node_delay) {
+            new_delay = to_operand_delay + node_delay;
+            new_critical_operand = operand_index;
           }
         }
-      }
-    }
 
-    // Update the original delay if the newly calculated delay is smaller.
-    for (int64_t i = 0; i < function_->node_count(); ++i) {
-      if (new_delays[i] != -1) {
-        int64_t &current_delay = indices_to_delay_[i][node_index];
-        if (current_delay >= new_delays[i] || current_delay == -1) {
-          current_delay = new_delays[i];
-          indices_to_critical_operand_[i][node_index] =
-              new_critical_operands[i];
+        // Update the original delay if the newly calculated delay is smaller.
+        if (new_delay != -1) {
+          int64_t &current_delay = delays[node_index];
+          if (current_delay >= new_delay || current_delay == -1) {
+            if (current_delay != new_delay) {
+              changed[node_index] =
+                  kChangedSinceTargetPass | kChangedSinceSourcePass;
+              changed_columns[node_index] = 1;
+            }
+            current_delay = new_delay;
+            critical_operands[node_index] =
+                static_cast<int32_t>(new_critical_operand);
+          }
         }
       }
+      for (int64_t i = 0; i < node_count_; ++i) {
+        changed[i] &= ~kChangedSinceSourcePass;
+      }
+    }
+    absl::MutexLock lock(&mu);
+    for (int64_t i = 0; i < node_count_; ++i) {
+      column_changed_[i] |= changed_columns[i];
     }
+  };
+  ParallelForChunks(rows.size(), thread_count_, propagate_from_sources);
+  for (int64_t row : rows) {
+    row_changed_[row] = 0;
   }
+  std::fill(node_delay_changed_.begin(), node_delay_changed_.end(), 0);
 }
 
 absl::flat_hash_map<Node *, std::vector<Node *>>
@@ -195,11 +411,11 @@ DelayManager::GetPathsOverDelayThreshold(int64_t delay_threshold) const {
   if (delay_threshold < 0) {
     return paths;
   }
-  for (int64_t i = 0; i < function_->node_count(); ++i) {
+  for (int64_t i = 0; i < node_count_; ++i) {
     Node *from = index_to_node_[i];
-    for (int64_t j = 0; j < function_->node_count(); ++j) {
+    for (int64_t j = 0; j < node_count_; ++j) {
       Node *to = index_to_node_[j];
-      if (indices_to_delay_[i][j] > delay_threshold) {
+      if (Delay(i, j) > delay_threshold) {
         paths[from].push_back(to);
       }
     }
@@ -219,11 +435,11 @@ absl::StatusOr<std::vector<PathInfo>> DelayManager::GetTopNPaths(
   // Traverse all nodes in the function and construct a worklist with score of
   // each path.
   std::vector<std::tuple<float, int64_t, Node *, Node *>> worklist;
-  for (int64_t i = 0; i < function_->node_count(); ++i) {
+  for (int64_t i = 0; i < node_count_; ++i) {
     Node *from = index_to_node_[i];
-    for (int64_t j = 0; j < function_->node_count(); ++j) {
+    for (int64_t j = 0; j < node_count_; ++j) {
       Node *to = index_to_node_[j];
-      int64_t delay = indices_to_delay_[i][j];
+      int64_t delay = Delay(i, j);
 
       if (delay < 0) {
         continue;
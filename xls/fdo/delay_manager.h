@@ -73,8 +73,12 @@ struct PathExtractOptions {
 // than a threshold, extract top-N longest paths, etc.
 class DelayManager {
  public:
+  // Delay propagation is split across up to "thread_count" threads; zero uses
+  // one thread per available CPU. The results do not depend on the number of
+  // threads.
   explicit DelayManager(FunctionBase *function,
-                        const DelayEstimator &delay_estimator);
+                        const DelayEstimator &delay_estimator,
+                        int64_t thread_count = 0);
 
   absl::StatusOr<int64_t> GetNodeDelay(Node *node) const;
 
@@ -100,8 +104,23 @@ class DelayManager {
   // topological order once. Note that this method is not optimal - it cannot
   // find the best combination of partial paths as Floyd–Warshall but it's
   // complexity is in O(n^2).
+  //
+  // The critical-path delays to each target are independent across sources in
+  // the topological pass, and the delays from each source are independent
+  // across targets in the reversed pass, so each pass is split across threads
+  // by rows or columns of the delay matrix respectively.
+  //
+  // Only the delays whose inputs changed since the previous propagation are
+  // recomputed: a delay changed by SetCriticalPathDelay is propagated to the
+  // fanin cone of its source in the reversed pass and to the fanout cone of
+  // its target in the topological pass, so updating the delays of a small
+  // subgraph (e.g., after synthesizing it) costs far less than recomputing the
+  // whole matrix. The result is the same as that of PropagateAllDelays.
   void PropagateDelays();
 
+  // Same as PropagateDelays, but recomputes every delay. Exposed for testing.
+  void PropagateAllDelays();
+
   // Get all the paths whose delay is longer than the given delay threshold.
   absl::flat_hash_map<Node *, std::vector<Node *>> GetPathsOverDelayThreshold(
       int64_t delay_threshold) const;
@@ -129,10 +148,29 @@ class DelayManager {
       absl::FunctionRef<bool(Node *, Node *)> except = GetFalse) const;
 
  private:
+  // Flags in `changed_`: whether the delay changed since the last reversed or
+  // topological pass of PropagateDelays read it, respectively.
+  static constexpr uint8_t kChangedSinceTargetPass = 1;
+  static constexpr uint8_t kChangedSinceSourcePass = 2;
+
   static float GetZeroScore(Node *from, Node *to) { return 0.0; }
   static bool GetFalse(Node *from, Node *to) { return false; }
 
+  void PropagateDelaysInternal(bool all);
+
+  // Records that the delay from `from_index` to `to_index` changed.
+  void MarkChanged(int64_t from_index, int64_t to_index);
+
+  int64_t &Delay(int64_t from_index, int64_t to_index) {
+    return indices_to_delay_[from_index * node_count_ + to_index];
+  }
+  int64_t Delay(int64_t from_index, int64_t to_index) const {
+    return indices_to_delay_[from_index * node_count_ + to_index];
+  }
+
   FunctionBase *function_;
+  int64_t node_count_;
+  int64_t thread_count_;
 
   // A mapping from a node to its index in the function.
   absl::flat_hash_map<Node *, int64_t> node_to_index_;
@@ -140,14 +178,35 @@ class DelayManager {
   // A mapping from a node index to the corresponding node.
   std::vector<Node *> index_to_node_;
 
-  // An all-to-all delay mapping. The self-to-self delay of a node is defined as
-  // the delay of itself. If there is no valid path exists, the delay is defined
-  // as -1. Both the source and target node delays are counted.
-  std::vector<std::vector<int64_t>> indices_to_delay_;
+  // The node indices in a topological order.
+  std::vector<int64_t> topo_sorted_indices_;
+
+  // An all-to-all delay mapping, stored row-major by source node index. The
+  // self-to-self delay of a node is defined as the delay of itself. If there
+  // is no valid path exists, the delay is defined as -1. Both the source and
+  // target node delays are counted.
+  std::vector<int64_t> indices_to_delay_;
+
+  // A all-to-all mapping from the source and target node indices to the index
+  // of the critical operand of the target node, or -1 if there is none. Uses
+  // the same layout as indices_to_delay_.
+  std::vector<int32_t> indices_to_critical_operand_;
+
+  // Change flags of each delay, using the same layout as indices_to_delay_.
+  std::vector<uint8_t> changed_;
+
+  // Whether any delay in each row (source) or column (target) of the delay
+  // matrix changed since that row or column was last revisited.
+  std::vector<uint8_t> row_changed_;
+  std::vector<uint8_t> column_changed_;
+
+  // Whether the delay of each node itself changed since the last propagation.
+  std::vector<uint8_t> node_delay_changed_;
 
-  // A all-to-all mapping from the source and target node indices to the
-  // critical operand of the target node.
-  std::vector<std::vector<Node *>> indices_to_critical_operand_;
+  // The operand and user indices of each node, in the order of the node's
+  // operands and users.
+  std::vector<std::vector<int64_t>> operand_indices_;
+  std::vector<std::vector<int64_t>> user_indices_;
 
   // Name of the delay estimator.
   const std::string name_;
@@ -16,13 +16,18 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <random>
 #include <string>
 #include <vector>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/random/distributions.h"
+#include "absl/random/random.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/node.h"
@@ -31,6 +36,8 @@
 namespace xls {
 namespace {
 
+using status_testing::IsOkAndHolds;
+
 class DelayManagerTest : public IrTestBase {};
 
 // Smoke test.
@@ -176,5 +183,86 @@ fn main(i0: bits[3], i1: bits[3]) -> bits[3] {
   EXPECT_EQ(new_udiv3_i0_delay, -1);
 }
 
+TEST_F(DelayManagerTest, ParallelPropagationMatchesSerial) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  std::vector<BValue> values = {fb.Param("x", p->GetBitsType(8)),
+                                fb.Param("y", p->GetBitsType(8))};
+  // Enough nodes that propagation is split across threads, with reconvergent
+  // paths of different lengths.
+  for (int64_t i = 0; i < 600; ++i) {
+    BValue lhs = values[values.size() - 1];
+    BValue rhs = values[(i * 7) % values.size()];
+    values.push_back(i % 3 == 0 ? fb.UDiv(lhs, rhs) : fb.Add(lhs, rhs));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+
+  DelayManager serial(function, TestDelayEstimator(), /*thread_count=*/1);
+  DelayManager parallel(function, TestDelayEstimator(), /*thread_count=*/4);
+  for (Node *from : function->nodes()) {
+    for (Node *to : function->nodes()) {
+      XLS_ASSERT_OK_AND_ASSIGN(int64_t serial_delay,
+                               serial.GetCriticalPathDelay(from, to));
+      EXPECT_THAT(parallel.GetCriticalPathDelay(from, to),
+                  IsOkAndHolds(serial_delay));
+    }
+  }
+  Node *source = values.front().node();
+  Node *target = values.back().node();
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Node *> serial_path,
+                           serial.GetFullCriticalPath(source, target));
+  EXPECT_THAT(parallel.GetFullCriticalPath(source, target),
+              IsOkAndHolds(serial_path));
+}
+
+
+TEST_F(DelayManagerTest, IncrementalPropagationMatchesFull) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  std::vector<BValue> values = {fb.Param("x", p->GetBitsType(8)),
+                                fb.Param("y", p->GetBitsType(8))};
+  for (int64_t i = 0; i < 100; ++i) {
+    BValue lhs = values[values.size() - 1];
+    BValue rhs = values[(i * 7) % values.size()];
+    values.push_back(i % 3 == 0 ? fb.UDiv(lhs, rhs) : fb.Add(lhs, rhs));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  std::vector<Node *> nodes(function->nodes().begin(),
+                            function->nodes().end());
+
+  DelayManager incremental(function, TestDelayEstimator());
+  DelayManager full(function, TestDelayEstimator());
+  std::mt19937_64 bit_gen(42);
+  for (int64_t round = 0; round < 5; ++round) {
+    // Shorten a few paths and node delays, as after synthesizing subgraphs.
+    for (int64_t i = 0; i < 10; ++i) {
+      Node *from = nodes[absl::Uniform<size_t>(bit_gen, 0, nodes.size())];
+      Node *to = absl::Bernoulli(bit_gen, 0.3)
+                     ? from
+                     : nodes[absl::Uniform<size_t>(bit_gen, 0, nodes.size())];
+      int64_t delay = absl::Uniform<int64_t>(bit_gen, 0, 20);
+      XLS_ASSERT_OK(incremental.SetCriticalPathDelay(from, to, delay));
+      XLS_ASSERT_OK(full.SetCriticalPathDelay(from, to, delay));
+    }
+    incremental.PropagateDelays();
+    full.PropagateAllDelays();
+
+    for (Node *from : nodes) {
+      for (Node *to : nodes) {
+        XLS_ASSERT_OK_AND_ASSIGN(int64_t full_delay,
+                                 full.GetCriticalPathDelay(from, to));
+        EXPECT_THAT(incremental.GetCriticalPathDelay(from, to),
+                    IsOkAndHolds(full_delay));
+      }
+    }
+    Node *source = values.front().node();
+    Node *target = values.back().node();
+    XLS_ASSERT_OK_AND_ASSIGN(std::vector<Node *> full_path,
+                             full.GetFullCriticalPath(source, target));
+    EXPECT_THAT(incremental.GetFullCriticalPath(source, target),
+                IsOkAndHolds(full_path));
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -15,6 +15,7 @@
 #include "xls/fdo/extract_nodes.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -23,12 +24,15 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "xls/codegen/block_conversion.h"
 #include "xls/codegen/block_generator.h"
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/codegen_pass.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/delay_model/delay_cache.h"
 #include "xls/ir/function.h"
 #include "xls/ir/node.h"
 #include "xls/ir/node_iterator.h"
@@ -40,16 +44,10 @@
 #include "xls/scheduling/scheduling_options.h"
 
 namespace xls {
+namespace {
 
-absl::StatusOr<std::string> ExtractNodesAndGetVerilog(
-    const absl::flat_hash_set<Node*>& nodes, std::string_view top_module_name,
-    bool flop_inputs_outputs, bool return_all_liveouts) {
-  XLS_RET_CHECK(!nodes.empty());
-  FunctionBase* f = (*nodes.begin())->function_base();
-  XLS_RET_CHECK(std::all_of(nodes.begin(), nodes.end(), [&](Node* node) {
-    return node->function_base() == f;
-  }));
-
+// Returns the nodes of "nodes" in topological order.
+std::vector<Node*> TopoSortNodes(const absl::flat_hash_set<Node*>& nodes) {
   std::vector<Node*> topo_sorted_nodes;
   topo_sorted_nodes.reserve(nodes.size());
   if (nodes.size() == 1) {
@@ -57,12 +55,65 @@ absl::StatusOr<std::string> ExtractNodesAndGetVerilog(
     topo_sorted_nodes.emplace_back(*nodes.begin());
   } else {
     // Otherwise, topo sort the given set of nodes.
-    for (Node* node : TopoSort(f)) {
+    for (Node* node : TopoSort((*nodes.begin())->function_base())) {
       if (nodes.contains(node)) {
         topo_sorted_nodes.emplace_back(node);
       }
     }
   }
+  return topo_sorted_nodes;
+}
+
+// Returns true if every user of "node" is outside of "nodes" or is a send, in
+// which case "node" is returned by the extracted module.
+bool HasOnlyExternalUsers(Node* node, const absl::flat_hash_set<Node*>& nodes) {
+  return std::all_of(node->users().begin(), node->users().end(), [&](Node* u) {
+    return !nodes.contains(u) || u->Is<Send>();
+  });
+}
+
+}  // namespace
+
+std::string ExtractedNodesSignature(const absl::flat_hash_set<Node*>& nodes) {
+  absl::flat_hash_map<Node*, std::string> operand_names;
+  int64_t input_count = 0;
+  std::vector<std::string> lines;
+  for (Node* node : TopoSortNodes(nodes)) {
+    std::vector<std::string> operands;
+    for (Node* operand : node->operands()) {
+      auto [it, inserted] = operand_names.try_emplace(operand);
+      if (inserted) {
+        it->second = absl::StrCat("in", input_count++);
+      }
+      operands.push_back(it->second);
+    }
+    std::string line = absl::StrCat(NodeDelaySignature(node), " {",
+                                     absl::StrJoin(operands, ", "), "}");
+    if (node->Is<Literal>()) {
+      absl::StrAppend(&line,
+                      " value=", node->As<Literal>()->value().ToString());
+    }
+    if (node->function_base()->HasImplicitUse(node)) {
+      absl::StrAppend(&line, " ret");
+    } else if (HasOnlyExternalUsers(node, nodes)) {
+      absl::StrAppend(&line, " out");
+    }
+    operand_names[node] = absl::StrCat("%", lines.size());
+    lines.push_back(std::move(line));
+  }
+  return absl::StrJoin(lines, "\n");
+}
+
+absl::StatusOr<std::string> ExtractNodesAndGetVerilog(
+    const absl::flat_hash_set<Node*>& nodes, std::string_view top_module_name,
+    bool flop_inputs_outputs, bool return_all_liveouts) {
+  XLS_RET_CHECK(!nodes.empty());
+  FunctionBase* f = (*nodes.begin())->function_base();
+  XLS_RET_CHECK(std::all_of(nodes.begin(), nodes.end(), [&](Node* node) {
+    return node->function_base() == f;
+  }));
+
+  std::vector<Node*> topo_sorted_nodes = TopoSortNodes(nodes);
 
   // Here, we create a temporary package for holding the temporary function. The
   // rationale is, in many cases, we want to run this method concurrently for
@@ -116,9 +167,7 @@ absl::StatusOr<std::string> ExtractNodesAndGetVerilog(
     } else {
       // Return live-outs that only have external users if return_all_liveouts
       // is not set.
-      if (std::all_of(node->users().begin(), node->users().end(), [&](Node* u) {
-            return !nodes.contains(u) || u->Is<Send>();
-          })) {
+      if (HasOnlyExternalUsers(node, nodes)) {
         live_out.push_back(new_node);
       }
     }
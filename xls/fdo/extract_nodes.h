@@ -30,6 +30,15 @@ absl::StatusOr<std::string> ExtractNodesAndGetVerilog(
     const absl::flat_hash_set<Node*>& nodes, std::string_view top_module_name,
     bool flop_inputs_outputs = false, bool return_all_liveouts = false);
 
+// Returns a string identifying the module ExtractNodesAndGetVerilog (with
+// return_all_liveouts unset) builds from the given set of nodes, independent
+// of node names and ids: each node in topological order is described by its
+// NodeDelaySignature, literal value, operands (either earlier nodes of the set
+// or inputs of the module, numbered in order of first use) and whether it is
+// a live-out. Two sets with the same signature synthesize to the same
+// circuit, so their delays can be memoized on it, including across processes.
+std::string ExtractedNodesSignature(const absl::flat_hash_set<Node*>& nodes);
+
 }  // namespace xls
 
 #endif  // XLS_SCHEDULING_EXTRACT_NODES_H_
@@ -169,5 +169,53 @@ endmodule
   EXPECT_EQ(all_liveouts_verilog_text, expected_all_liveouts_verilog_text);
 }
 
+TEST_F(ExtractNodesTest, SignatureIgnoresNamesAndIds) {
+  std::string ir_text = R"(
+package p
+
+fn f0(a: bits[3], b: bits[3]) -> bits[3] {
+  add.1: bits[3] = add(a, b)
+  ret sub.2: bits[3] = sub(add.1, b)
+}
+
+fn f1(x: bits[3], y: bits[3]) -> bits[3] {
+  literal.10: bits[3] = literal(value=1)
+  add.11: bits[3] = add(x, y)
+  sub.12: bits[3] = sub(add.11, y)
+  ret and.13: bits[3] = and(sub.12, literal.10)
+}
+
+fn f2(x: bits[3], y: bits[3]) -> bits[3] {
+  add.21: bits[3] = add(x, y)
+  ret sub.22: bits[3] = sub(add.21, x)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f0, package->GetFunction("f0"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f1, package->GetFunction("f1"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f2, package->GetFunction("f2"));
+
+  std::string f0_signature = ExtractedNodesSignature(
+      {FindNode("add.1", f0), FindNode("sub.2", f0)});
+  std::string f1_signature = ExtractedNodesSignature(
+      {FindNode("add.11", f1), FindNode("sub.12", f1)});
+  std::string f2_signature = ExtractedNodesSignature(
+      {FindNode("add.21", f2), FindNode("sub.22", f2)});
+
+  // f0 and f1 extract the same circuit, but f0's sub is the return value and
+  // f1's is used outside of the set.
+  EXPECT_NE(f0_signature, f1_signature);
+  EXPECT_EQ(f0_signature, ExtractedNodesSignature({FindNode("add.1", f0),
+                                                   FindNode("sub.2", f0)}));
+  // f2 subtracts the other input.
+  EXPECT_NE(f0_signature, f2_signature);
+
+  EXPECT_EQ(ExtractedNodesSignature({FindNode("add.1", f0)}),
+            ExtractedNodesSignature({FindNode("add.11", f1)}));
+  EXPECT_EQ(ExtractedNodesSignature({FindNode("sub.2", f0)}),
+            ExtractedNodesSignature({FindNode("sub.22", f2)}));
+}
+
 }  // namespace
 }  // namespace xls
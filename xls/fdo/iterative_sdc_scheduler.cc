@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -48,7 +49,7 @@ namespace xls {
 namespace {
 
 using DelayMap = absl::flat_hash_map<Node *, int64_t>;
-using NodeSet = absl::flat_hash_set<Node *>;
+using NodeHashSet = absl::flat_hash_set<Node *>;
 
 namespace math_opt = ::operations_research::math_opt;
 
@@ -78,12 +79,12 @@ NodeCut GetPathCut(const std::vector<Node *> &full_path) {
 // target nodes in PathInfo.
 absl::Status GetFullPaths(const std::vector<PathInfo> &paths,
                           const DelayManager &delay_manager,
-                          std::vector<NodeSet> &full_paths,
+                          std::vector<NodeHashSet> &full_paths,
                           absl::flat_hash_set<NodeCut> &evaluated_cuts) {
   for (auto [delay, source, target] : paths) {
     XLS_ASSIGN_OR_RETURN(std::vector<Node *> full_path,
                          delay_manager.GetFullCriticalPath(source, target));
-    full_paths.emplace_back(NodeSet(full_path.begin(), full_path.end()));
+    full_paths.emplace_back(NodeHashSet(full_path.begin(), full_path.end()));
     evaluated_cuts.emplace(GetPathCut(full_path));
   }
   return absl::OkStatus();
@@ -93,12 +94,12 @@ absl::Status GetFullPaths(const std::vector<PathInfo> &paths,
 // root node to maximum cuts must have already been stored in "max_cut_map".
 absl::Status GetMaxCones(const std::vector<PathInfo> &paths,
                          const NodeCutMap &max_cut_map,
-                         std::vector<NodeSet> &max_cones,
+                         std::vector<NodeHashSet> &max_cones,
                          absl::flat_hash_set<NodeCut> &evaluated_cuts) {
   for (auto [delay, source, target] : paths) {
     XLS_RET_CHECK(max_cut_map.contains(target));
     const NodeCut &cut = max_cut_map.at(target);
-    const NodeSet &cone = cut.GetNodeCone();
+    const NodeHashSet &cone = cut.GetNodeCone();
     XLS_RET_CHECK(cone.contains(source));
     max_cones.emplace_back(cone);
     evaluated_cuts.emplace(cut);
@@ -114,20 +115,20 @@ absl::Status GetMaxCones(const std::vector<PathInfo> &paths,
 // exist cone/window (or vice versa), they are merged into a new window.
 absl::Status GetMergedWindows(const std::vector<PathInfo> &paths,
                               const NodeCutMap &max_cut_map,
-                              std::vector<NodeSet> &merged_windows,
+                              std::vector<NodeHashSet> &merged_windows,
                               absl::flat_hash_set<NodeCut> &evaluated_cuts) {
-  std::vector<NodeSet> leaves_list;
+  std::vector<NodeHashSet> leaves_list;
   for (auto [delay, source, target] : paths) {
     XLS_RET_CHECK(max_cut_map.contains(target));
     const NodeCut &cut = max_cut_map.at(target);
-    const NodeSet &cone = cut.GetNodeCone();
+    const NodeHashSet &cone = cut.GetNodeCone();
     XLS_RET_CHECK(cone.contains(source));
     evaluated_cuts.emplace(cut);
 
     bool merge_flag = false;
     for (int64_t i = 0; i < merged_windows.size(); ++i) {
-      NodeSet &exist_leaves = leaves_list[i];
-      NodeSet &exist_window = merged_windows[i];
+      NodeHashSet &exist_leaves = leaves_list[i];
+      NodeHashSet &exist_window = merged_windows[i];
 
       // Merge the cone into the window if one of them is a subset of
       // another.
@@ -223,7 +224,7 @@ absl::Status RefineDelayEstimations(
   }
 
   // Extract nodes from paths with given strategy.
-  std::vector<NodeSet> nodes_list;
+  std::vector<NodeHashSet> nodes_list;
   if (options.path_evaluate_strategy == PathEvaluateStrategy::PATH) {
     XLS_RET_CHECK_OK(GetFullPaths(targeted_paths, delay_manager, nodes_list,
                                   evaluated_cuts));
@@ -241,7 +242,7 @@ absl::Status RefineDelayEstimations(
 
   XLS_VLOG(1) << "Number of modules generated is " << nodes_list.size();
   for (int64_t j = 0; j < delay_list.size(); ++j) {
-    const NodeSet &nodes = nodes_list[j];
+    const NodeHashSet &nodes = nodes_list[j];
     int64_t delay = delay_list[j];
     XLS_LOG(INFO) << "(Updated delay: " << delay << "ps) Nodes: "
                 << absl::StrJoin(nodes, ", ", [](std::string *out, Node *n) {
@@ -263,6 +264,7 @@ absl::Status RefineDelayEstimations(
 }
 
 absl::Status BuildError(IterativeSDCSchedulingModel &model,
+                        math_opt::IncrementalSolver &solver,
                         const math_opt::SolveResult &result,
                         bool explain_infeasibility) {
   XLS_CHECK_NE(result.termination.reason,
@@ -273,9 +275,8 @@ absl::Status BuildError(IterativeSDCSchedulingModel &model,
        result.termination.reason ==
            math_opt::TerminationReason::kInfeasibleOrUnbounded)) {
     XLS_RETURN_IF_ERROR(model.AddSlackVariables());
-    XLS_ASSIGN_OR_RETURN(
-        math_opt::SolveResult result_with_slack,
-        math_opt::Solve(model.UnderlyingModel(), math_opt::SolverType::kGlop));
+    XLS_ASSIGN_OR_RETURN(math_opt::SolveResult result_with_slack,
+                         solver.Solve());
     if (result_with_slack.termination.reason ==
             math_opt::TerminationReason::kOptimal ||
         result_with_slack.termination.reason ==
@@ -299,21 +300,11 @@ absl::Status BuildError(IterativeSDCSchedulingModel &model,
 
 absl::Status IterativeSDCSchedulingModel::AddTimingConstraints(
     int64_t clock_period_ps) {
-  absl::flat_hash_map<Node *, std::vector<Node *>> delay_constraints =
-      delay_manager_.GetPathsOverDelayThreshold(clock_period_ps);
-
-  int64_t number_constraints = 0;
-  for (const auto &p : delay_constraints) {
-    Node *source = p.first;
-    for (Node *target : p.second) {
-      number_constraints++;
-      DiffAtLeastConstraint(target, source, 1, "timing");
-      XLS_VLOG(2) << "Setting timing constraint: "
-                  << absl::StrFormat("1 ≤ %s - %s", target->GetName(),
-                                     source->GetName());
-    }
-  }
-  XLS_VLOG(2) << "Number of timing constraints added: " << number_constraints;
+  // The paths over the clock period change as delay estimations are refined,
+  // so replace the timing constraints from the previous iteration rather than
+  // accumulating them.
+  SetTimingConstraints(
+      delay_manager_.GetPathsOverDelayThreshold(clock_period_ps));
   return absl::OkStatus();
 }
 
@@ -394,38 +385,46 @@ absl::StatusOr<ScheduleCycleMap> ScheduleByIterativeSDC(
     return absl::InvalidArgumentError("synthesizer is not ready");
   }
 
-  ScheduleCycleMap cycle_map;
-  absl::flat_hash_set<NodeCut> evaluated_cuts;
-  for (int64_t i = 0; i < options.iteration_number; ++i) {
-    IterativeSDCSchedulingModel model(f, delay_manager);
+  // The model (and the solver tracking it) persist across iterations; only the
+  // timing constraints are updated as delay estimations are refined, letting
+  // Glop warm-start from the previous iteration's basis.
+  IterativeSDCSchedulingModel model(f, delay_manager);
 
-    for (const SchedulingConstraint &constraint : constraints) {
-      XLS_RETURN_IF_ERROR(model.AddSchedulingConstraint(constraint));
-    }
+  for (const SchedulingConstraint &constraint : constraints) {
+    XLS_RETURN_IF_ERROR(model.AddSchedulingConstraint(constraint));
+  }
 
-    for (Node *node : f->nodes()) {
-      for (Node *user : node->users()) {
-        XLS_RETURN_IF_ERROR(model.AddDefUseConstraints(node, user));
-      }
-      if (f->IsFunction() && f->HasImplicitUse(node)) {
-        XLS_RETURN_IF_ERROR(model.AddDefUseConstraints(node, std::nullopt));
-      }
+  for (Node *node : f->nodes()) {
+    for (Node *user : node->users()) {
+      XLS_RETURN_IF_ERROR(model.AddDefUseConstraints(node, user));
+    }
+    if (f->IsFunction() && f->HasImplicitUse(node)) {
+      XLS_RETURN_IF_ERROR(model.AddDefUseConstraints(node, std::nullopt));
     }
+  }
 
-    if (f->IsProc()) {
-      Proc *proc = f->AsProcOrDie();
-      for (int64_t index = 0; index < proc->GetStateElementCount(); ++index) {
-        Param *const state_access = proc->GetStateParam(index);
-        Node *const next_state_element = proc->GetNextStateElement(index);
-
-        // The next-state element always has lifetime extended to the state
-        // param node, since we can't store the new value in the state register
-        // until the old value's been used.
-        XLS_RETURN_IF_ERROR(
-            model.AddLifetimeConstraint(next_state_element, state_access));
-      }
+  if (f->IsProc()) {
+    Proc *proc = f->AsProcOrDie();
+    for (int64_t index = 0; index < proc->GetStateElementCount(); ++index) {
+      Param *const state_access = proc->GetStateParam(index);
+      Node *const next_state_element = proc->GetNextStateElement(index);
+
+      // The next-state element always has lifetime extended to the state param
+      // node, since we can't store the new value in the state register until
+      // the old value's been used.
+      XLS_RETURN_IF_ERROR(
+          model.AddLifetimeConstraint(next_state_element, state_access));
     }
+  }
 
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<math_opt::IncrementalSolver> solver,
+      math_opt::IncrementalSolver::New(&model.UnderlyingModel(),
+                                       math_opt::SolverType::kGlop));
+
+  ScheduleCycleMap cycle_map;
+  absl::flat_hash_set<NodeCut> evaluated_cuts;
+  for (int64_t i = 0; i < options.iteration_number; ++i) {
     XLS_RETURN_IF_ERROR(model.AddTimingConstraints(clock_period_ps));
 
     int64_t min_pipeline_length = 1;
@@ -437,11 +436,11 @@ absl::StatusOr<ScheduleCycleMap> ScheduleByIterativeSDC(
       model.MinimizePipelineLength();
       XLS_ASSIGN_OR_RETURN(
           const math_opt::SolveResult result_with_minimized_pipeline_length,
-          math_opt::Solve(model.UnderlyingModel(),
-                          math_opt::SolverType::kGlop));
+          solver->Solve());
       if (result_with_minimized_pipeline_length.termination.reason !=
           math_opt::TerminationReason::kOptimal) {
-        return BuildError(model, result_with_minimized_pipeline_length,
+        return BuildError(model, *solver,
+                          result_with_minimized_pipeline_length,
                           explain_infeasibility);
       }
       XLS_ASSIGN_OR_RETURN(
@@ -453,12 +452,10 @@ absl::StatusOr<ScheduleCycleMap> ScheduleByIterativeSDC(
 
     model.SetObjective();
 
-    XLS_ASSIGN_OR_RETURN(
-        math_opt::SolveResult result,
-        math_opt::Solve(model.UnderlyingModel(), math_opt::SolverType::kGlop));
+    XLS_ASSIGN_OR_RETURN(math_opt::SolveResult result, solver->Solve());
 
     if (result.termination.reason != math_opt::TerminationReason::kOptimal) {
-      return BuildError(model, result, explain_infeasibility);
+      return BuildError(model, *solver, result, explain_infeasibility);
     }
 
     // Extract scheduling results to the cycle map.
@@ -15,16 +15,20 @@
 #include "xls/fdo/node_cut.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <iterator>
+#include <memory>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/node.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/op.h"
@@ -108,9 +112,73 @@ absl::StatusOr<NodeCutMap> EnumerateMaxCutInSchedule(
   return cut_map;
 }
 
+// Enumerates the cuts of the nodes of one pipeline cycle, given in topological
+// order, into "cuts_map". As we have topologically sorted the nodes, for each
+// node, we can enumerate and merge every combination of its operands' cuts.
+// For the input nodes, a.k.a. a node with only live-in operands of the current
+// pipeline cycle or no operand, the cuts should only contain the trivial cut.
+static absl::Status EnumerateCutsInCycle(
+    absl::Span<Node *const> sorted_nodes, int64_t cycle,
+    const ScheduleCycleMap &cycle_map, bool input_leaves_only,
+    NodeCutsMap &cuts_map) {
+  for (Node *node : sorted_nodes) {
+    // Param operation is considered as a primary input (PI).
+    if (node->Is<Param>()) {
+      continue;
+    }
+
+    // Holds the cuts owned by the current node.
+    std::vector<NodeCut> cuts;
+
+    // If we only allow PI to be cut leaves, we will not add the trivial cut
+    // of any internal node.
+    if (!input_leaves_only) {
+      XLS_RET_CHECK_OK(AddCut(NodeCut::GetTrivialCut(node), cuts));
+    }
+
+    // Enumerate and merge every combination of operands' cuts. We adapt a
+    // worklist algorithm for the enumeration.
+    std::vector<std::pair<NodeCut, Node *const *>> worklist(
+        {std::make_pair(NodeCut(node), node->operands().begin())});
+
+    while (!worklist.empty()) {
+      NodeCut current_cut = worklist.back().first;
+      Node *const *operand = worklist.back().second;
+      worklist.pop_back();
+
+      // Continue if we already finished the merging.
+      if (operand == node->operands().end()) {
+        XLS_RET_CHECK_OK(AddCut(current_cut, cuts));
+        continue;
+      }
+
+      // The operand cycle should not be larger than the current cycle.
+      int64_t operand_cycle = cycle_map.at(*operand);
+      XLS_RET_CHECK_LE(operand_cycle, cycle);
+      if (operand_cycle < cycle || (*operand)->Is<Param>()) {
+        // If the operand cycle is smaller than the current cycle, the operand
+        // is considered as a PI.
+        worklist.emplace_back(std::make_pair(
+            NodeCut::GetMergedCut(node, current_cut,
+                                  NodeCut::GetTrivialCut(*operand)),
+            std::next(operand)));
+      } else {
+        // Otherwise, the operand is internal node whose cuts are merged.
+        for (const NodeCut &cut : cuts_map.at(*operand)) {
+          worklist.emplace_back(
+              std::make_pair(NodeCut::GetMergedCut(node, current_cut, cut),
+                             std::next(operand)));
+        }
+      }
+    }
+    cuts_map.emplace(node, cuts);
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<NodeCutsMap> EnumerateCutsInSchedule(
     FunctionBase *f, int64_t pipeline_length, const ScheduleCycleMap &cycle_map,
-    bool input_leaves_only) {
+    bool input_leaves_only, int64_t thread_count) {
   // First, we topologically sort the nodes in every cycle of the schedule.
   std::vector<std::vector<Node *>> cycle_to_sorted_nodes;
   cycle_to_sorted_nodes.resize(pipeline_length);
@@ -119,66 +187,39 @@ absl::StatusOr<NodeCutsMap> EnumerateCutsInSchedule(
   }
 
   // Then, we traverse the nodes in every cycle to enumerate the cuts of every
-  // node. As we have topologically sorted the nodes, for each node, we can
-  // enumerate and merge every combination of its operands' cuts. For the input
-  // nodes, a.k.a. a node with only live-in operands of the current pipeline
-  // cycle or no operand, the cuts should only contain the trivial cut.
-  int64_t cycle = 0;
-  NodeCutsMap cuts_map;
-  for (const std::vector<Node *> &sorted_nodes : cycle_to_sorted_nodes) {
-    for (Node *node : sorted_nodes) {
-      // Param operation is considered as a primary input (PI).
-      if (node->Is<Param>()) {
-        continue;
-      }
-
-      // Holds the cuts owned by the current node.
-      std::vector<NodeCut> cuts;
-
-      // If we only allow PI to be cut leaves, we will not add the trivial cut
-      // of any internal node.
-      if (!input_leaves_only) {
-        XLS_RET_CHECK_OK(AddCut(NodeCut::GetTrivialCut(node), cuts));
-      }
-
-      // Enumerate and merge every combination of operands' cuts. We adapt a
-      // worklist algorithm for the enumeration.
-      std::vector<std::pair<NodeCut, Node *const *>> worklist(
-          {std::make_pair(NodeCut(node), node->operands().begin())});
-
-      while (!worklist.empty()) {
-        NodeCut current_cut = worklist.back().first;
-        Node *const *operand = worklist.back().second;
-        worklist.pop_back();
-
-        // Continue if we already finished the merging.
-        if (operand == node->operands().end()) {
-          XLS_RET_CHECK_OK(AddCut(current_cut, cuts));
-          continue;
-        }
-
-        // The operand cycle should not be larger than the current cycle.
-        int64_t operand_cycle = cycle_map.at(*operand);
-        XLS_RET_CHECK_LE(operand_cycle, cycle);
-        if (operand_cycle < cycle || (*operand)->Is<Param>()) {
-          // If the operand cycle is smaller than the current cycle, the operand
-          // is considered as a PI.
-          worklist.emplace_back(std::make_pair(
-              NodeCut::GetMergedCut(node, current_cut,
-                                    NodeCut::GetTrivialCut(*operand)),
-              std::next(operand)));
-        } else {
-          // Otherwise, the operand is internal node whose cuts are merged.
-          for (const NodeCut &cut : cuts_map.at(*operand)) {
-            worklist.emplace_back(
-                std::make_pair(NodeCut::GetMergedCut(node, current_cut, cut),
-                               std::next(operand)));
-          }
-        }
-      }
-      cuts_map.emplace(node, cuts);
+  // node. Cuts never cross pipeline cycles, so every cycle is enumerated
+  // independently by whichever worker claims it next.
+  std::vector<NodeCutsMap> cycle_to_cuts_map(pipeline_length);
+  std::vector<absl::Status> cycle_to_status(pipeline_length);
+  std::atomic<int64_t> next_cycle = 0;
+  auto worker = [&]() {
+    for (int64_t cycle = next_cycle++; cycle < pipeline_length;
+         cycle = next_cycle++) {
+      cycle_to_status[cycle] = EnumerateCutsInCycle(
+          cycle_to_sorted_nodes[cycle], cycle, cycle_map, input_leaves_only,
+          cycle_to_cuts_map[cycle]);
+    }
+  };
+  int64_t worker_count = std::min<int64_t>(
+      thread_count > 0 ? thread_count : std::max(AvailableCPUs(), 1),
+      pipeline_length);
+  if (worker_count <= 1) {
+    worker();
+  } else {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(worker_count);
+    for (int64_t i = 0; i < worker_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
     }
-    cycle++;
+    for (std::unique_ptr<Thread> &thread : threads) {
+      thread->Join();
+    }
+  }
+
+  NodeCutsMap cuts_map;
+  for (int64_t cycle = 0; cycle < pipeline_length; ++cycle) {
+    XLS_RETURN_IF_ERROR(cycle_to_status[cycle]);
+    cuts_map.merge(cycle_to_cuts_map[cycle]);
   }
   return cuts_map;
 }
@@ -106,12 +106,14 @@ absl::StatusOr<NodeCutMap> EnumerateMaxCutInSchedule(
 // Cuts enumeration is used to construct a cuts map. Note that the enumeration
 // will be applied to each pipeline cycle separately. As a result, there will be
 // no cut crossing different pipeline cycles. All cuts will have primary input
-// (PI) or pipeline register as leaves if input_leaves_only is set true.
+// (PI) or pipeline register as leaves if input_leaves_only is set true. Since
+// the cycles are independent, they are enumerated concurrently on up to
+// "thread_count" threads; zero uses one thread per available CPU.
 // TODO(hanchenye): 2023-08-14 We should add an optional argument to constrain
 // the maximum number of leaves.
 absl::StatusOr<NodeCutsMap> EnumerateCutsInSchedule(
     FunctionBase *f, int64_t pipeline_length, const ScheduleCycleMap &cycle_map,
-    bool input_leaves_only = true);
+    bool input_leaves_only = true, int64_t thread_count = 0);
 
 }  // namespace xls
 
@@ -14,6 +14,7 @@
 
 #include "xls/fdo/node_cut.h"
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -21,6 +22,7 @@
 #include "absl/container/flat_hash_set.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/node.h"
@@ -124,5 +126,42 @@ fn main(i0: bits[3], i1: bits[3]) -> bits[3] {
   }
 }
 
+TEST_F(NodeCutTest, ParallelEnumerationMatchesSerial) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  ScheduleCycleMap cycle_map;
+  cycle_map[x.node()] = 0;
+  cycle_map[y.node()] = 0;
+  constexpr int64_t kPipelineLength = 6;
+  BValue a = x;
+  BValue b = y;
+  for (int64_t cycle = 0; cycle < kPipelineLength; ++cycle) {
+    for (int64_t i = 0; i < 4; ++i) {
+      BValue sum = fb.Add(a, b);
+      BValue diff = fb.Subtract(sum, a);
+      cycle_map[sum.node()] = cycle;
+      cycle_map[diff.node()] = cycle;
+      a = sum;
+      b = diff;
+    }
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+
+  for (bool input_leaves_only : {false, true}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        NodeCutsMap serial,
+        EnumerateCutsInSchedule(function, kPipelineLength, cycle_map,
+                                input_leaves_only, /*thread_count=*/1));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        NodeCutsMap parallel,
+        EnumerateCutsInSchedule(function, kPipelineLength, cycle_map,
+                                input_leaves_only, /*thread_count=*/4));
+    EXPECT_EQ(serial.size(), function->node_count() - 2);
+    EXPECT_TRUE(serial == parallel);
+  }
+}
+
 }  // namespace
 }  // namespace xls
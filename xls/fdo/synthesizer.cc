@@ -14,17 +14,22 @@
 
 #include "xls/fdo/synthesizer.h"
 
+#include <algorithm>
 #include <cstdint>
-#include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
-#include "xls/common/thread.h"
+#include "xls/common/thread_pool.h"
 #include "xls/fdo/extract_nodes.h"
 #include "xls/ir/node.h"
 #include "xls/synthesis/synthesis.pb.h"
@@ -32,36 +37,76 @@
 namespace xls {
 namespace synthesis {
 
+Synthesizer::Synthesizer(std::string_view name)
+    : name_(name),
+      max_concurrent_jobs_(std::max<int64_t>(
+          1, static_cast<int64_t>(std::thread::hardware_concurrency()))) {}
+
 absl::StatusOr<std::vector<int64_t>>
 Synthesizer::SynthesizeNodesConcurrentlyAndGetDelays(
     absl::Span<const absl::flat_hash_set<Node *>> nodes_list) const {
-  // Launches multi-threading delay estimation.
-  std::vector<absl::StatusOr<int64_t>> results;
-  std::vector<std::unique_ptr<Thread>> threads;
-  results.reserve(nodes_list.size());
-  absl::StatusOr<int64_t> init_val = 0;
+  // Groups the node sets by the module they extract to, so that each distinct
+  // module is looked up in the cache and synthesized at most once.
+  std::vector<std::string> signatures;
+  std::vector<int64_t> job_index_of_set;
+  std::vector<const absl::flat_hash_set<Node *> *> jobs;
+  absl::flat_hash_map<std::string, int64_t> job_index_of_signature;
+  signatures.reserve(nodes_list.size());
+  job_index_of_set.reserve(nodes_list.size());
   for (const absl::flat_hash_set<Node *> &nodes : nodes_list) {
-    results.push_back(init_val);
-    absl::StatusOr<int64_t> &dest = results.back();
-    // TODO(hanchenye): 2023-08-14 Use a thread pool structure that we can
-    // schedule on.
-    threads.push_back(std::make_unique<Thread>(
-        [&]() { dest = SynthesizeNodesAndGetDelay(nodes); }));
+    std::string signature = ExtractedNodesSignature(nodes);
+    auto [it, inserted] =
+        job_index_of_signature.try_emplace(signature, jobs.size());
+    if (inserted) {
+      jobs.push_back(&nodes);
+      signatures.push_back(std::move(signature));
+    }
+    job_index_of_set.push_back(it->second);
+  }
+
+  std::vector<absl::StatusOr<int64_t>> results(jobs.size(), 0);
+  std::vector<int64_t> misses;
+  for (int64_t i = 0; i < jobs.size(); ++i) {
+    std::optional<int64_t> cached;
+    if (delay_cache_ != nullptr) {
+      cached = delay_cache_->Get(signatures[i]);
+    }
+    if (cached.has_value()) {
+      results[i] = *cached;
+    } else {
+      misses.push_back(i);
+    }
   }
 
+  // Synthesizes the remaining modules on the shared thread pool, running at
+  // most max_concurrent_jobs() syntheses at once.
+  ParallelFor(
+      0, misses.size(),
+      [&](int64_t i) {
+        results[misses[i]] = SynthesizeNodesAndGetDelay(*jobs[misses[i]]);
+      },
+      ThreadPool::Default(),
+      /*max_parallelism=*/std::max<int64_t>(max_concurrent_jobs_, 1));
+
   // Records the estimated delays.
-  for (auto &t : threads) {
-    t->Join();
+  for (int64_t i : misses) {
+    XLS_RETURN_IF_ERROR(results[i].status());
+    if (delay_cache_ != nullptr) {
+      delay_cache_->Add(signatures[i], results[i].value());
+    }
   }
   std::vector<int64_t> delay_list;
-  delay_list.reserve(results.size());
-  for (absl::StatusOr<int64_t> result : results) {
-    XLS_RETURN_IF_ERROR(result.status());
-    delay_list.push_back(result.value());
+  delay_list.reserve(nodes_list.size());
+  for (int64_t job_index : job_index_of_set) {
+    delay_list.push_back(results[job_index].value());
   }
   return delay_list;
 }
 
+std::string YosysSynthesizer::GetDelayCacheKey() const {
+  return absl::StrCat(name(), ",synthesis_libraries=", synthesis_libraries_);
+}
+
 absl::StatusOr<int64_t> YosysSynthesizer::SynthesizeVerilogAndGetDelay(
     std::string_view verilog_text, std::string_view top_module_name) const {
   synthesis::CompileRequest request;
@@ -23,6 +23,7 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/delay_model/delay_cache.h"
 #include "xls/ir/node.h"
 #include "xls/synthesis/yosys/yosys_synthesis_service.h"
 
@@ -32,11 +33,31 @@ namespace synthesis {
 // An abstract class of a synthesis service.
 class Synthesizer {
  public:
-  explicit Synthesizer(std::string_view name) : name_(name) {}
+  explicit Synthesizer(std::string_view name);
   virtual ~Synthesizer() = default;
 
   const std::string &name() const { return name_; }
 
+  // Returns a string identifying the configuration of this synthesizer which
+  // determines the delays it reports, e.g., its name and target libraries.
+  // Used as the estimator name of the delay cache.
+  virtual std::string GetDelayCacheKey() const { return name_; }
+
+  // Memoizes the delays computed by SynthesizeNodesConcurrentlyAndGetDelays in
+  // "cache", keyed on ExtractedNodesSignature. The cache must outlive this
+  // synthesizer and its estimator should be GetDelayCacheKey(). A null cache
+  // disables memoization across calls.
+  void SetDelayCache(DelayCache *cache) { delay_cache_ = cache; }
+  DelayCache *delay_cache() const { return delay_cache_; }
+
+  // Sets the maximum number of synthesis jobs which
+  // SynthesizeNodesConcurrentlyAndGetDelays runs at once. Defaults to the
+  // number of hardware threads.
+  void SetMaxConcurrentJobs(int64_t max_concurrent_jobs) {
+    max_concurrent_jobs_ = max_concurrent_jobs;
+  }
+  int64_t max_concurrent_jobs() const { return max_concurrent_jobs_; }
+
   // Synthesizes the given Verilog module with a synthesis tool and return its
   // overall delay.
   virtual absl::StatusOr<int64_t> SynthesizeVerilogAndGetDelay(
@@ -51,7 +72,10 @@ class Synthesizer {
       const absl::flat_hash_set<Node *> &nodes) const = 0;
 
   // Launches "SynthesizeNodesAndGetDelay" concurrently for each set of nodes
-  // listed in "nodes_list" and get their delays.
+  // listed in "nodes_list" and get their delays. Node sets which extract to the
+  // same module are synthesized only once, sets found in the delay cache are
+  // not synthesized at all, and at most max_concurrent_jobs() syntheses run at
+  // a time.
   absl::StatusOr<std::vector<int64_t>> SynthesizeNodesConcurrentlyAndGetDelays(
       absl::Span<const absl::flat_hash_set<Node *>> nodes_list) const;
 
@@ -59,6 +83,9 @@ class Synthesizer {
   // Records the name of the concreate synthesizer, e.g., yosys, for management
   // and debugging purpose.
   std::string name_;
+
+  DelayCache *delay_cache_ = nullptr;
+  int64_t max_concurrent_jobs_;
 };
 
 // A derived Synthesizer class for Yosys-OpenSTA-based synthesis and static
@@ -75,7 +102,10 @@ class YosysSynthesizer : public Synthesizer {
         service_(yosys_path, /*nextpnr_path=*/"", /*synthesis_target=*/"",
                  sta_path, synthesis_libraries, synthesis_libraries,
                  /*save_temps=*/false, /*return_netlist=*/false,
-                 /*synthesis_only=*/false) {}
+                 /*synthesis_only=*/false),
+        synthesis_libraries_(synthesis_libraries) {}
+
+  std::string GetDelayCacheKey() const override;
 
   absl::StatusOr<int64_t> SynthesizeVerilogAndGetDelay(
       std::string_view verilog_text,
@@ -86,6 +116,7 @@ class YosysSynthesizer : public Synthesizer {
 
  private:
   YosysSynthesisServiceImpl service_;
+  std::string synthesis_libraries_;
 };
 
 }  // namespace synthesis
@@ -0,0 +1,141 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fdo/synthesizer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/common/status/matchers.h"
+#include "xls/delay_model/delay_cache.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+namespace synthesis {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::ElementsAre;
+
+// Reports the number of nodes in the set as its delay and counts how many
+// syntheses run, and how many run at once.
+class FakeSynthesizer : public Synthesizer {
+ public:
+  FakeSynthesizer() : Synthesizer("fake") {}
+
+  absl::StatusOr<int64_t> SynthesizeVerilogAndGetDelay(
+      std::string_view verilog_text,
+      std::string_view top_module_name) const override {
+    return 0;
+  }
+
+  absl::StatusOr<int64_t> SynthesizeNodesAndGetDelay(
+      const absl::flat_hash_set<Node *> &nodes) const override {
+    ++synthesis_count_;
+    int64_t running = ++running_count_;
+    int64_t max_running = max_running_count_;
+    while (running > max_running &&
+           !max_running_count_.compare_exchange_weak(max_running, running)) {
+    }
+    absl::SleepFor(absl::Milliseconds(10));
+    --running_count_;
+    return nodes.size();
+  }
+
+  int64_t synthesis_count() const { return synthesis_count_; }
+  int64_t max_running_count() const { return max_running_count_; }
+
+ private:
+  mutable std::atomic<int64_t> synthesis_count_ = 0;
+  mutable std::atomic<int64_t> running_count_ = 0;
+  mutable std::atomic<int64_t> max_running_count_ = 0;
+};
+
+class SynthesizerTest : public IrTestBase {};
+
+TEST_F(SynthesizerTest, DeduplicatesAndCachesNodeSets) {
+  std::string ir_text = R"(
+package p
+
+fn main(a: bits[3], b: bits[3], c: bits[3]) -> bits[3] {
+  add.1: bits[3] = add(a, b)
+  add.2: bits[3] = add(b, c)
+  sub.3: bits[3] = sub(add.1, add.2)
+  ret umul.4: bits[3] = umul(sub.3, c)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetFunction("main"));
+  std::vector<absl::flat_hash_set<Node *>> nodes_list = {
+      {FindNode("add.1", f)},
+      {FindNode("add.2", f)},
+      {FindNode("add.1", f), FindNode("sub.3", f)},
+  };
+
+  FakeSynthesizer synthesizer;
+  DelayCache cache(synthesizer.GetDelayCacheKey());
+  synthesizer.SetDelayCache(&cache);
+
+  // The two single adds extract to the same module.
+  EXPECT_THAT(synthesizer.SynthesizeNodesConcurrentlyAndGetDelays(nodes_list),
+              IsOkAndHolds(ElementsAre(1, 1, 2)));
+  EXPECT_EQ(synthesizer.synthesis_count(), 2);
+  EXPECT_EQ(cache.size(), 2);
+
+  // Only the new node set is synthesized.
+  nodes_list.push_back({FindNode("umul.4", f)});
+  EXPECT_THAT(synthesizer.SynthesizeNodesConcurrentlyAndGetDelays(nodes_list),
+              IsOkAndHolds(ElementsAre(1, 1, 2, 1)));
+  EXPECT_EQ(synthesizer.synthesis_count(), 3);
+  EXPECT_EQ(cache.size(), 3);
+}
+
+TEST_F(SynthesizerTest, BoundsConcurrentJobs) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  std::vector<absl::flat_hash_set<Node *>> nodes_list;
+  BValue v = x;
+  for (int64_t i = 0; i < 8; ++i) {
+    // Each shift amount yields a distinct module.
+    v = fb.Shll(v, fb.Literal(UBits(i, 32)));
+    nodes_list.push_back({v.node()});
+  }
+  XLS_ASSERT_OK(fb.Build().status());
+
+  FakeSynthesizer synthesizer;
+  synthesizer.SetMaxConcurrentJobs(2);
+  EXPECT_THAT(synthesizer.SynthesizeNodesConcurrentlyAndGetDelays(nodes_list),
+              IsOkAndHolds(ElementsAre(1, 1, 1, 1, 1, 1, 1, 1)));
+  EXPECT_EQ(synthesizer.synthesis_count(), 8);
+  EXPECT_LE(synthesizer.max_running_count(), 2);
+}
+
+}  // namespace
+}  // namespace synthesis
+}  // namespace xls
@@ -12,13 +12,20 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
@@ -26,6 +33,8 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
@@ -37,7 +46,9 @@
 const char kUsage[] = R"(
 Runs an IR function with a set of inputs through both the JIT and the
 interpreter. Prints the first input which results in a mismatch between the JIT
-and the interpreter. Returns a non-zer error code otherwise. Usage:
+and the interpreter. Returns a non-zer error code otherwise. Inputs are
+evaluated in parallel, but the input printed is always the first mismatching
+one in file order. Usage:
 
     find_failing_input_main --input-file=INPUT_FILE IR_FILE
 )";
@@ -50,6 +61,11 @@ ABSL_FLAG(
     std::string, test_only_inject_jit_result, "",
     "Test-only flag for injecting the result produced by the JIT. Used to "
     "force mismatches between JIT and interpreter for testing purposed.");
+ABSL_FLAG(int64_t, threads, 0,
+          "Number of threads evaluating inputs. If 0, uses the number of "
+          "available CPUs.");
+ABSL_FLAG(int64_t, batch_size, 64,
+          "Number of consecutive inputs a thread claims at a time.");
 
 namespace xls {
 namespace {
@@ -74,27 +90,104 @@ absl::Status RealMain(std::string_view ir_path,
     inputs.push_back(args);
   }
 
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
-                       FunctionJit::Create(f));
-  for (const std::vector<Value>& args : inputs) {
+  std::optional<Value> injected_jit_result;
+  if (!absl::GetFlag(FLAGS_test_only_inject_jit_result).empty()) {
+    XLS_ASSIGN_OR_RETURN(injected_jit_result,
+                         Parser::ParseTypedValue(absl::GetFlag(
+                             FLAGS_test_only_inject_jit_result)));
+  }
+
+  int64_t thread_count = absl::GetFlag(FLAGS_threads);
+  if (thread_count <= 0) {
+    thread_count = AvailableCPUs();
+  }
+  int64_t input_count = inputs.size();
+  thread_count = std::clamp<int64_t>(thread_count, 1,
+                                     std::max<int64_t>(input_count, 1));
+  int64_t batch_size = std::max<int64_t>(absl::GetFlag(FLAGS_batch_size), 1);
+
+  // The FunctionJit is not thread-safe so each thread gets its own.
+  std::vector<std::unique_ptr<FunctionJit>> jits;
+  for (int64_t i = 0; i < thread_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(jits.emplace_back(), FunctionJit::Create(f));
+  }
+
+  // Threads claim batches of inputs in file order. A thread stops once every
+  // remaining input comes after the earliest mismatch (or evaluation error)
+  // found so far, so all inputs before the reported one are always evaluated
+  // and the result does not depend on the thread count or timing.
+  std::atomic<int64_t> next_input = 0;
+  std::atomic<int64_t> first_stop = input_count;
+  // The input index and error of any failed evaluation, per thread.
+  std::vector<std::pair<int64_t, absl::Status>> errors(
+      thread_count, {input_count, absl::OkStatus()});
+  auto record_stop = [&](int64_t index) {
+    int64_t current = first_stop.load();
+    while (index < current &&
+           !first_stop.compare_exchange_weak(current, index)) {
+    }
+  };
+  auto evaluate = [&](FunctionJit* jit,
+                      const std::vector<Value>& args) -> absl::StatusOr<bool> {
     InterpreterResult<Value> jit_result;
-    if (absl::GetFlag(FLAGS_test_only_inject_jit_result).empty()) {
-      XLS_ASSIGN_OR_RETURN(jit_result, jit->Run(args));
+    if (injected_jit_result.has_value()) {
+      jit_result.value = injected_jit_result.value();
     } else {
-      XLS_ASSIGN_OR_RETURN(jit_result.value,
-                           Parser::ParseTypedValue(absl::GetFlag(
-                               FLAGS_test_only_inject_jit_result)));
+      XLS_ASSIGN_OR_RETURN(jit_result, jit->Run(args));
     }
     // TODO(https://github.com/google/xls/issues/506): 2021-10-12 Also compare
     // events once the JIT fully supports events (and we have decided how to
     // handle event mismatches).
     XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> interpreter_result,
                          InterpretFunction(f, args));
-    if (jit_result.value != interpreter_result.value) {
-      std::cout << absl::StrJoin(args, "; ", ValueFormatterHex);
-      return absl::OkStatus();
+    return jit_result.value != interpreter_result.value;
+  };
+  auto run_thread = [&](int64_t thread_index) {
+    while (true) {
+      int64_t batch_start = next_input.fetch_add(batch_size);
+      int64_t batch_end = std::min(batch_start + batch_size, input_count);
+      for (int64_t i = batch_start; i < batch_end; ++i) {
+        if (i >= first_stop.load()) {
+          return;
+        }
+        absl::StatusOr<bool> mismatch =
+            evaluate(jits[thread_index].get(), inputs[i]);
+        if (!mismatch.ok()) {
+          errors[thread_index] = {i, mismatch.status()};
+          record_stop(i);
+          return;
+        }
+        if (mismatch.value()) {
+          record_stop(i);
+          return;
+        }
+      }
+      if (batch_end >= input_count) {
+        return;
+      }
+    }
+  };
+
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t i = 0; i < thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>([&, i]() { run_thread(i); }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
     }
   }
+
+  for (const auto& [index, status] : errors) {
+    if (!status.ok() && index == first_stop.load()) {
+      return status;
+    }
+  }
+  if (first_stop.load() < input_count) {
+    std::cout << absl::StrJoin(inputs[first_stop.load()], "; ",
+                               ValueFormatterHex);
+    return absl::OkStatus();
+  }
   return absl::InvalidArgumentError(
       "No input found which results in a mismatch between the JIT and "
       "interpreter.");
@@ -73,6 +73,21 @@ class EvalMainTest(test_base.TestCase):
                                      stderr=subprocess.PIPE)
     self.assertEqual(result.decode('utf-8'), 'bits[32]:0x42; bits[32]:0x123')
 
+  def test_parallel_search_finds_first_failure(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    lines = ['bits[32]:0x0; bits[32]:0x0'] * 100
+    lines[37] = 'bits[32]:0x1; bits[32]:0x2'
+    lines[38] = 'bits[32]:0x3; bits[32]:0x4'
+    lines[90] = 'bits[32]:0x5; bits[32]:0x6'
+    input_file = self.create_tempfile(content='\n'.join(lines))
+    result = subprocess.check_output([
+        FIND_FAILING_INPUT_MAIN, '--input_file=' + input_file.full_path,
+        '--threads=4', '--batch_size=3',
+        '--test_only_inject_jit_result=bits[32]:0x0', ir_file.full_path
+    ],
+                                     stderr=subprocess.PIPE)
+    self.assertEqual(result.decode('utf-8'), 'bits[32]:0x1; bits[32]:0x2')
+
 
 if __name__ == '__main__':
   test_base.main()
@@ -0,0 +1,213 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/in_process_commands.h"
+
+#include <algorithm>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "absl/types/span.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/ir_convert/convert_options.h"
+#include "xls/dslx/ir_convert/ir_converter.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_runner.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/events.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/public/runtime_build_actions.h"
+#include "xls/tools/opt.h"
+
+namespace xls {
+namespace {
+
+// The command-line arguments of a tool invocation, split into `--name=value`
+// flags (with `--name` and `--noname` mapped to "true" and "false") and
+// positional arguments.
+struct ToolArgs {
+  absl::flat_hash_map<std::string, std::string> flags;
+  std::vector<std::string> positional;
+};
+
+ToolArgs ParseToolArgs(const std::vector<std::string>& args) {
+  ToolArgs result;
+  for (std::string_view arg : args) {
+    if (!absl::ConsumePrefix(&arg, "--")) {
+      result.positional.push_back(std::string(arg));
+      continue;
+    }
+    std::vector<std::string_view> pieces =
+        absl::StrSplit(arg, absl::MaxSplits('=', 1));
+    if (pieces.size() == 2) {
+      result.flags[pieces[0]] = std::string(pieces[1]);
+    } else if (absl::ConsumePrefix(&arg, "no")) {
+      result.flags[arg] = "false";
+    } else {
+      result.flags[arg] = "true";
+    }
+  }
+  return result;
+}
+
+// Returns an error if `args` has flags other than `supported` or does not have
+// exactly one positional argument.
+absl::Status CheckToolArgs(std::string_view tool, const ToolArgs& args,
+                           absl::Span<const std::string_view> supported) {
+  for (const auto& [name, _] : args.flags) {
+    if (std::find(supported.begin(), supported.end(), name) ==
+        supported.end()) {
+      return absl::UnimplementedError(absl::StrCat(
+          "Flag --", name, " is not supported by in-process ", tool));
+    }
+  }
+  if (args.positional.size() != 1) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Expected exactly one positional argument to in-process ", tool));
+  }
+  return absl::OkStatus();
+}
+
+std::filesystem::path ResolvePath(const std::filesystem::path& run_dir,
+                                  std::string_view path) {
+  std::filesystem::path result(path);
+  return result.is_absolute() ? result : run_dir / result;
+}
+
+absl::StatusOr<std::string> ConvertDslxToIrInProcess(
+    const std::vector<std::string>& argv, const std::filesystem::path& run_dir,
+    const SampleOptions& options) {
+  ToolArgs args = ParseToolArgs(argv);
+  XLS_RETURN_IF_ERROR(CheckToolArgs("ir_converter_main", args,
+                                    {"top", "warnings_as_errors"}));
+  std::optional<std::string_view> top;
+  if (auto it = args.flags.find("top"); it != args.flags.end()) {
+    top = it->second;
+  }
+  dslx::ConvertOptions convert_options;
+  convert_options.warnings_as_errors =
+      !args.flags.contains("warnings_as_errors") ||
+      args.flags.at("warnings_as_errors") == "true";
+  std::string path = ResolvePath(run_dir, args.positional[0]).string();
+  std::vector<std::string_view> paths = {path};
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<Package> package,
+      dslx::ConvertFilesToPackage(paths,
+                                  std::string(GetDefaultDslxStdlibPath()),
+                                  /*dslx_paths=*/{}, convert_options, top));
+  return package->DumpIr();
+}
+
+absl::StatusOr<std::string> OptimizeIrInProcess(
+    const std::vector<std::string>& argv, const std::filesystem::path& run_dir,
+    const SampleOptions& options) {
+  ToolArgs args = ParseToolArgs(argv);
+  XLS_RETURN_IF_ERROR(CheckToolArgs("opt_main", args, {"pass_trace_path"}));
+  XLS_ASSIGN_OR_RETURN(
+      std::string ir_text,
+      GetFileContents(ResolvePath(run_dir, args.positional[0])));
+  tools::OptOptions opt_options;
+  if (auto it = args.flags.find("pass_trace_path"); it != args.flags.end()) {
+    opt_options.pass_trace_path = ResolvePath(run_dir, it->second).string();
+  }
+  return tools::OptimizeIrForTop(ir_text, opt_options);
+}
+
+absl::StatusOr<std::string> EvaluateIrInProcess(
+    const std::vector<std::string>& argv, const std::filesystem::path& run_dir,
+    const SampleOptions& options) {
+  ToolArgs args = ParseToolArgs(argv);
+  XLS_RETURN_IF_ERROR(
+      CheckToolArgs("eval_ir_main", args, {"input_file", "use_llvm_jit"}));
+  XLS_RET_CHECK(args.flags.contains("input_file"));
+  bool use_jit = !args.flags.contains("use_llvm_jit") ||
+                 args.flags.at("use_llvm_jit") == "true";
+
+  XLS_ASSIGN_OR_RETURN(
+      std::string ir_text,
+      GetFileContents(ResolvePath(run_dir, args.positional[0])));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text));
+  XLS_ASSIGN_OR_RETURN(Function * f, package->GetTopAsFunction());
+  std::unique_ptr<FunctionJit> jit;
+  if (use_jit) {
+    XLS_ASSIGN_OR_RETURN(jit, FunctionJit::Create(f));
+  }
+
+  XLS_ASSIGN_OR_RETURN(
+      std::string args_text,
+      GetFileContents(ResolvePath(run_dir, args.flags.at("input_file"))));
+  std::vector<std::vector<Value>> arg_batches;
+  for (std::string_view line :
+       absl::StrSplit(args_text, '\n', absl::SkipWhitespace())) {
+    std::vector<Value> arg_values;
+    for (std::string_view value_text : absl::StrSplit(line, ';')) {
+      XLS_ASSIGN_OR_RETURN(Value value,
+                           Parser::ParseTypedValue(value_text));
+      arg_values.push_back(std::move(value));
+    }
+    arg_batches.push_back(std::move(arg_values));
+  }
+
+  // The JIT evaluates all argument sets in a single call: arguments are packed
+  // once into per-parameter native-layout buffers rather than being marshaled
+  // for each sample.
+  std::vector<Value> result_values;
+  if (use_jit) {
+    XLS_ASSIGN_OR_RETURN(result_values,
+                         DropInterpreterEvents(jit->RunBatched(arg_batches)));
+  } else {
+    for (const std::vector<Value>& arg_values : arg_batches) {
+      XLS_ASSIGN_OR_RETURN(
+          Value result,
+          DropInterpreterEvents(InterpretFunction(f, arg_values)));
+      result_values.push_back(std::move(result));
+    }
+  }
+  std::string results;
+  for (const Value& result : result_values) {
+    absl::StrAppend(&results, result.ToString(FormatPreference::kHex), "\n");
+  }
+  return results;
+}
+
+}  // namespace
+
+SampleRunner::Commands InProcessCommands() {
+  SampleRunner::Commands commands;
+  commands.ir_converter_main = ConvertDslxToIrInProcess;
+  commands.ir_opt_main = OptimizeIrInProcess;
+  commands.eval_ir_main = EvaluateIrInProcess;
+  return commands;
+}
+
+}  // namespace xls
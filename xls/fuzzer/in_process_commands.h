@@ -0,0 +1,41 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_IN_PROCESS_COMMANDS_H_
+#define XLS_FUZZER_IN_PROCESS_COMMANDS_H_
+
+#include "xls/fuzzer/sample_runner.h"
+
+namespace xls {
+
+// Returns SampleRunner commands which perform DSLX-to-IR conversion, IR
+// optimization and IR function evaluation by calling the XLS libraries
+// directly in the current process rather than spawning the ir_converter_main,
+// opt_main and eval_ir_main binaries. This avoids the process startup, LLVM
+// initialization and flag parsing costs of each tool invocation, which
+// dominate the run time of small fuzz samples.
+//
+// The commands accept only the arguments the SampleRunner passes to these
+// tools and return an error for anything else. Commands not covered here
+// (codegen, simulation and proc evaluation) still run as subprocesses.
+//
+// Note that in-process commands cannot enforce SampleOptions::timeout_seconds
+// and that a crash in the compiler takes down the calling process; crashers
+// should be reproduced with the subprocess-based runner (e.g., via the run.sh
+// script written alongside each sample).
+SampleRunner::Commands InProcessCommands();
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_IN_PROCESS_COMMANDS_H_
@@ -0,0 +1,102 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/in_process_commands.h"
+
+#include <filesystem>  // NOLINT
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_split.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/dslx/interp_value_helpers.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_runner.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+std::vector<std::string_view> ResultLines(const std::string& text) {
+  return absl::StrSplit(absl::StripAsciiWhitespace(text), '\n',
+                        absl::SkipEmpty());
+}
+
+TEST(InProcessCommandsTest, ConvertOptimizeAndEvaluate) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  SampleRunner runner(temp_dir.path(), InProcessCommands());
+  constexpr std::string_view dslx_text =
+      "fn main(x: u8, y: u8) -> u8 { x + y }";
+  SampleOptions options;
+  options.set_input_is_dslx(true);
+  options.set_ir_converter_args({"--top=main"});
+  for (bool use_jit : {false, true}) {
+    options.set_use_jit(use_jit);
+    std::vector<std::vector<dslx::InterpValue>> args_batch;
+    for (std::string_view args : {"bits[8]:42; bits[8]:100",
+                                  "bits[8]:1; bits[8]:2"}) {
+      std::vector<dslx::InterpValue>& entry = args_batch.emplace_back();
+      for (std::string_view arg : absl::StrSplit(args, "; ")) {
+        XLS_ASSERT_OK_AND_ASSIGN(Value value, Parser::ParseTypedValue(arg));
+        XLS_ASSERT_OK_AND_ASSIGN(dslx::InterpValue interp_value,
+                                 dslx::ValueToInterpValue(value));
+        entry.push_back(interp_value);
+      }
+    }
+    XLS_ASSERT_OK(
+        runner.Run(Sample(std::string(dslx_text), options, args_batch)));
+
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::string opt_ir, GetFileContents(temp_dir.path() / "sample.opt.ir"));
+    EXPECT_THAT(opt_ir, HasSubstr("package sample"));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::string pass_trace,
+        GetFileContents(temp_dir.path() /
+                        SampleRunner::kOptPassTraceFilename));
+    EXPECT_THAT(pass_trace, HasSubstr("\"traceEvents\""));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::string results,
+        GetFileContents(temp_dir.path() / "sample.opt.ir.results"));
+    EXPECT_THAT(ResultLines(results),
+                ElementsAre("bits[8]:0x8e", "bits[8]:0x3"));
+  }
+}
+
+TEST(InProcessCommandsTest, UnsupportedFlag) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  SampleRunner::Commands commands = InProcessCommands();
+  ASSERT_TRUE(commands.ir_opt_main.has_value());
+  EXPECT_THAT(std::get<SampleRunner::Commands::Callable>(*commands.ir_opt_main)(
+                  {"--opt_level=1", "sample.ir"}, temp_dir.path(),
+                  SampleOptions()),
+              StatusIs(absl::StatusCode::kUnimplemented,
+                       HasSubstr("--opt_level")));
+}
+
+}  // namespace
+}  // namespace xls
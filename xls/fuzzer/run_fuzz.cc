@@ -47,6 +47,8 @@
 #include "xls/fuzzer/sample_generator.h"
 #include "xls/fuzzer/sample_runner.h"
 #include "xls/fuzzer/sample_summary.pb.h"
+#include "xls/fuzzer/shared_fuzz_directory.h"
+#include "xls/fuzzer/validated_ir_cache.h"
 #include "xls/fuzzer/value_generator.h"
 
 namespace xls {
@@ -172,7 +174,9 @@ absl::StatusOr<std::filesystem::path> SaveCrasher(
 
 absl::Status RunSample(const Sample& smp, const std::filesystem::path& run_dir,
                        const std::optional<std::filesystem::path>& summary_file,
-                       std::optional<absl::Duration> generate_sample_elapsed) {
+                       std::optional<absl::Duration> generate_sample_elapsed,
+                       const SampleRunner::Commands& commands,
+                       ValidatedIrCache* validated_ir_cache) {
   XLS_ASSIGN_OR_RETURN(std::filesystem::path sample_runner_main_path,
                        GetXlsRunfilePath(kSampleRunnerMainPath));
 
@@ -222,7 +226,7 @@ absl::Status RunSample(const Sample& smp, const std::filesystem::path& run_dir,
 
   XLS_VLOG(1) << "Starting to run sample";
   XLS_VLOG(2) << smp.input_text();
-  SampleRunner runner(run_dir);
+  SampleRunner runner(run_dir, commands, validated_ir_cache);
   XLS_RETURN_IF_ERROR(runner.RunFromFiles(sample_file_name, options_file_name,
                                           args_file_name,
                                           ir_channel_names_file_name));
@@ -248,36 +252,43 @@ absl::Status RunSample(const Sample& smp, const std::filesystem::path& run_dir,
   return absl::OkStatus();
 }
 
-absl::StatusOr<Sample> GenerateSampleAndRun(
-    ValueGenerator* rng, const dslx::AstGeneratorOptions& ast_generator_options,
-    const SampleOptions& sample_options, const std::filesystem::path& run_dir,
+absl::Status RunSampleAndSaveCrasher(
+    const Sample& smp, const std::filesystem::path& run_dir,
     const std::optional<std::filesystem::path>& crasher_dir,
     const std::optional<std::filesystem::path>& summary_file,
-    bool force_failure) {
-  Stopwatch stopwatch;
-  XLS_ASSIGN_OR_RETURN(
-      Sample smp, GenerateSample(ast_generator_options, sample_options, rng));
-  absl::Duration generate_sample_elapsed = stopwatch.GetElapsedTime();
-
-  absl::Status status =
-      RunSample(smp, run_dir, summary_file, generate_sample_elapsed);
+    std::optional<absl::Duration> generate_sample_elapsed, bool force_failure,
+    const SampleRunner::Commands& commands, SharedFuzzDirectory* shared_dir,
+    ValidatedIrCache* validated_ir_cache) {
+  absl::Status status = RunSample(smp, run_dir, summary_file,
+                                  generate_sample_elapsed, commands,
+                                  validated_ir_cache);
   if (force_failure) {
     status = absl::InternalError("Forced sample failure.");
   }
   if (status.ok()) {
-    return smp;
+    return absl::OkStatus();
   }
 
   XLS_LOG(ERROR) << "Sample failed: " << status;
+  if (crasher_dir.has_value() && shared_dir != nullptr) {
+    std::string signature = FailureSignature(status);
+    XLS_ASSIGN_OR_RETURN(bool claimed,
+                         shared_dir->ClaimFailureSignature(signature));
+    if (!claimed) {
+      XLS_LOG(INFO) << "Not saving crasher; a crasher with failure signature "
+                    << signature << " has already been saved.";
+      return status;
+    }
+  }
   if (crasher_dir.has_value()) {
     XLS_ASSIGN_OR_RETURN(std::filesystem::path sample_crasher_dir,
                          SaveCrasher(run_dir, smp, status, *crasher_dir));
     if (!absl::IsDeadlineExceeded(status)) {
       XLS_LOG(INFO) << "Attempting to minimize IR...";
       std::optional<absl::Duration> timeout =
-          sample_options.timeout_seconds().has_value()
+          smp.options().timeout_seconds().has_value()
               ? std::optional<absl::Duration>(
-                    absl::Seconds(*sample_options.timeout_seconds()))
+                    absl::Seconds(*smp.options().timeout_seconds()))
               : std::nullopt;
       XLS_ASSIGN_OR_RETURN(
           std::optional<std::filesystem::path> minimized_path,
@@ -294,4 +305,22 @@ absl::StatusOr<Sample> GenerateSampleAndRun(
   return status;
 }
 
+absl::StatusOr<Sample> GenerateSampleAndRun(
+    ValueGenerator* rng, const dslx::AstGeneratorOptions& ast_generator_options,
+    const SampleOptions& sample_options, const std::filesystem::path& run_dir,
+    const std::optional<std::filesystem::path>& crasher_dir,
+    const std::optional<std::filesystem::path>& summary_file,
+    bool force_failure, const SampleRunner::Commands& commands) {
+  Stopwatch stopwatch;
+  XLS_ASSIGN_OR_RETURN(
+      Sample smp, GenerateSample(ast_generator_options, sample_options, rng));
+  absl::Duration generate_sample_elapsed = stopwatch.GetElapsedTime();
+
+  XLS_RETURN_IF_ERROR(RunSampleAndSaveCrasher(smp, run_dir, crasher_dir,
+                                              summary_file,
+                                              generate_sample_elapsed,
+                                              force_failure, commands));
+  return smp;
+}
+
 }  // namespace xls
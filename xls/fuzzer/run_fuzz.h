@@ -19,9 +19,14 @@
 #include <optional>
 #include <string_view>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "xls/fuzzer/ast_generator.h"
 #include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_runner.h"
+#include "xls/fuzzer/shared_fuzz_directory.h"
+#include "xls/fuzzer/validated_ir_cache.h"
 #include "xls/fuzzer/value_generator.h"
 
 namespace xls {
@@ -30,18 +35,40 @@ namespace xls {
 // summary will be appended to this file; if `generate_sample_elapsed` is also
 // given, it will be recorded in the timings in the sample summary.
 //
-// `run_dir` must be an empty directory.
+// `run_dir` must be an empty directory. The sample runner invokes the XLS tools
+// through `commands` (see SampleRunner::Commands); by default each tool is run
+// as a subprocess. If `validated_ir_cache` is given, codegen and simulation
+// are skipped for previously validated optimized IR (see SampleRunner).
 absl::Status RunSample(
     const Sample& smp, const std::filesystem::path& run_dir,
     const std::optional<std::filesystem::path>& summary_file = std::nullopt,
-    std::optional<absl::Duration> generate_sample_elapsed = std::nullopt);
+    std::optional<absl::Duration> generate_sample_elapsed = std::nullopt,
+    const SampleRunner::Commands& commands = {},
+    ValidatedIrCache* validated_ir_cache = nullptr);
 
+// Runs the given sample in `run_dir` as RunSample does. If the sample fails
+// (or `force_failure` is true) and `crasher_dir` is given, the sample is saved
+// as a crasher there and its IR is minimized. Returns the sample's status.
+//
+// If `shared_dir` is given, the crasher is only saved if no fuzzer sharing the
+// directory has saved one with the same FailureSignature before.
+absl::Status RunSampleAndSaveCrasher(
+    const Sample& smp, const std::filesystem::path& run_dir,
+    const std::optional<std::filesystem::path>& crasher_dir = std::nullopt,
+    const std::optional<std::filesystem::path>& summary_file = std::nullopt,
+    std::optional<absl::Duration> generate_sample_elapsed = std::nullopt,
+    bool force_failure = false, const SampleRunner::Commands& commands = {},
+    SharedFuzzDirectory* shared_dir = nullptr,
+    ValidatedIrCache* validated_ir_cache = nullptr);
+
+// Generates a sample with `ast_generator_options` and `sample_options` and
+// runs it with RunSampleAndSaveCrasher; returns the sample if it passed.
 absl::StatusOr<Sample> GenerateSampleAndRun(
     ValueGenerator* rng, const dslx::AstGeneratorOptions& ast_generator_options,
     const SampleOptions& sample_options, const std::filesystem::path& run_dir,
     const std::optional<std::filesystem::path>& crasher_dir = std::nullopt,
     const std::optional<std::filesystem::path>& summary_file = std::nullopt,
-    bool force_failure = false);
+    bool force_failure = false, const SampleRunner::Commands& commands = {});
 
 }  // namespace xls
 
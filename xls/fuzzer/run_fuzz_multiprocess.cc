@@ -15,12 +15,14 @@
 #include "xls/fuzzer/run_fuzz_multiprocess.h"
 
 #include <cstdint>
+#include <deque>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <random>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
@@ -36,8 +38,14 @@
 #include "xls/common/stopwatch.h"
 #include "xls/common/thread.h"
 #include "xls/fuzzer/ast_generator.h"
+#include "xls/fuzzer/in_process_commands.h"
 #include "xls/fuzzer/run_fuzz.h"
 #include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_coverage.h"
+#include "xls/fuzzer/sample_generator.h"
+#include "xls/fuzzer/sample_runner.h"
+#include "xls/fuzzer/shared_fuzz_directory.h"
+#include "xls/fuzzer/validated_ir_cache.h"
 #include "xls/fuzzer/value_generator.h"
 
 namespace xls {
@@ -47,6 +55,15 @@ static constexpr std::string_view kBlueText = "\033[34m";
 static constexpr std::string_view kRedText = "\033[31m";
 static constexpr std::string_view kDefaultColor = "\033[0m";
 
+// The probability with which a coverage-guided worker mutates a sample from
+// its corpus rather than generating a new one.
+static constexpr double kMutationProbability = 0.5;
+
+// How often (in samples) a coverage-guided worker with no pending shared
+// samples polls the shared corpus, and how many samples it takes at a time.
+static constexpr int64_t kSharedCorpusPollInterval = 16;
+static constexpr int64_t kSharedCorpusFetchLimit = 16;
+
 absl::Status GenerateAndRunSamples(
     int64_t worker_number,
     const dslx::AstGeneratorOptions& ast_generator_options,
@@ -55,7 +72,9 @@ absl::Status GenerateAndRunSamples(
     const std::optional<std::filesystem::path>& crasher_dir,
     const std::optional<std::filesystem::path>& summary_dir,
     std::optional<int64_t> sample_count,
-    const std::optional<absl::Duration>& duration, bool force_failure) {
+    const std::optional<absl::Duration>& duration, bool force_failure,
+    bool in_process, CoverageTracker* coverage,
+    SharedFuzzDirectory* shared_dir, ValidatedIrCache* validated_ir_cache) {
   int64_t crashers = 0;
   XLS_LOG(INFO) << "--- Started worker " << worker_number;
   Stopwatch stopwatch;
@@ -80,6 +99,11 @@ absl::Status GenerateAndRunSamples(
                   << absl::StreamFormat("0x%16X", rng_seed) << kDefaultColor;
   }
   ValueGenerator rng{std::mt19937_64(rng_seed)};
+  SampleRunner::Commands commands =
+      in_process ? InProcessCommands() : SampleRunner::Commands();
+  SampleCorpus corpus;
+  // Samples published to the shared corpus by other fuzzers, still to be run.
+  std::deque<Sample> shared_samples;
 
   int64_t sample = 0;
   while (true) {
@@ -94,10 +118,61 @@ absl::Status GenerateAndRunSamples(
       run_dir = temp_run_dir->path();
     }
 
-    absl::Status sample_status =
-        GenerateSampleAndRun(&rng, ast_generator_options, sample_options,
-                             run_dir, crasher_dir, summary_file, force_failure)
-            .status();
+    Stopwatch generate_stopwatch;
+    absl::StatusOr<Sample> smp = absl::UnknownError("no sample generated");
+    if (coverage != nullptr && shared_dir != nullptr) {
+      if (shared_samples.empty() && sample % kSharedCorpusPollInterval == 0) {
+        absl::StatusOr<std::vector<Sample>> fetched =
+            shared_dir->FetchNewSamples(kSharedCorpusFetchLimit);
+        if (fetched.ok()) {
+          shared_samples.insert(shared_samples.end(),
+                                std::make_move_iterator(fetched->begin()),
+                                std::make_move_iterator(fetched->end()));
+        } else {
+          XLS_LOG(WARNING) << "Failed to fetch shared samples: "
+                           << fetched.status();
+        }
+      }
+      if (!shared_samples.empty()) {
+        smp = std::move(shared_samples.front());
+        shared_samples.pop_front();
+      }
+    }
+    if (coverage != nullptr && !smp.ok() && !corpus.empty() &&
+        rng.RandomDouble() < kMutationProbability) {
+      smp = MutateSample(*corpus.Choose(*coverage, &rng), &rng);
+      if (!smp.ok()) {
+        XLS_VLOG(1) << "Mutation failed, generating a new sample: "
+                    << smp.status();
+      }
+    }
+    if (!smp.ok()) {
+      smp = GenerateSample(ast_generator_options, sample_options, &rng);
+    }
+    absl::Status sample_status = smp.status();
+    if (smp.ok()) {
+      sample_status = RunSampleAndSaveCrasher(
+          *smp, run_dir, crasher_dir, summary_file,
+          generate_stopwatch.GetElapsedTime(), force_failure, commands,
+          shared_dir, validated_ir_cache);
+    }
+    if (coverage != nullptr && smp.ok()) {
+      // A crasher's outputs may not parse, so collection is best-effort.
+      std::optional<RecordedCoverage> recorded =
+          RecordSampleCoverage(run_dir, smp->options(), *coverage);
+      // Only passing samples are mutated further; failing ones are already
+      // saved as crashers.
+      if (recorded.has_value() && recorded->new_feature_count > 0 &&
+          sample_status.ok()) {
+        if (shared_dir != nullptr) {
+          if (absl::Status status = shared_dir->PublishSample(*smp);
+              !status.ok()) {
+            XLS_LOG(WARNING) << "Failed to publish sample: " << status;
+          }
+        }
+        corpus.Add(*std::move(smp), std::move(recorded->features), *coverage);
+      }
+    }
     if (!sample_status.ok()) {
       XLS_LOG(INFO)
           << kRedText
@@ -111,7 +186,7 @@ absl::Status GenerateAndRunSamples(
     absl::Duration elapsed = stopwatch.GetElapsedTime();
     if (sample > 0 && sample % 16 == 0) {
       std::vector<std::string> metrics;
-      metrics.reserve(3);
+      metrics.reserve(4);
       if (sample_count.has_value()) {
         metrics.push_back(
             absl::StrFormat("%d/%d samples", sample, *sample_count));
@@ -129,6 +204,11 @@ absl::Status GenerateAndRunSamples(
         metrics.push_back(
             absl::StrFormat("running for %s", absl::FormatDuration(elapsed)));
       }
+      if (coverage != nullptr) {
+        metrics.push_back(
+            absl::StrFormat("%d features, %d samples in corpus",
+                            coverage->feature_count(), corpus.size()));
+      }
       XLS_LOG(INFO) << absl::StreamFormat("--- Worker #%d: %s", worker_number,
                                           absl::StrJoin(metrics, ", "));
     }
@@ -167,7 +247,25 @@ absl::Status ParallelGenerateAndRunSamples(
     const std::optional<std::filesystem::path>& crasher_dir,
     const std::optional<std::filesystem::path>& summary_dir,
     std::optional<int64_t> sample_count, std::optional<absl::Duration> duration,
-    bool force_failure) {
+    bool force_failure, bool in_process, bool coverage_guided,
+    const std::optional<std::filesystem::path>& shared_dir,
+    int64_t validated_ir_cache_size) {
+  std::optional<CoverageTracker> coverage;
+  if (coverage_guided) {
+    coverage.emplace();
+  }
+  std::optional<ValidatedIrCache> validated_ir_cache;
+  if (validated_ir_cache_size > 0) {
+    validated_ir_cache.emplace(validated_ir_cache_size);
+  }
+  std::unique_ptr<SharedFuzzDirectory> shared;
+  std::optional<std::filesystem::path> worker_crasher_dir = crasher_dir;
+  if (shared_dir.has_value()) {
+    XLS_ASSIGN_OR_RETURN(shared, SharedFuzzDirectory::Create(*shared_dir));
+    if (!worker_crasher_dir.has_value()) {
+      worker_crasher_dir = shared->crasher_dir();
+    }
+  }
   std::vector<std::unique_ptr<Thread>> workers;
   workers.resize(worker_count);
   std::vector<absl::Status> worker_status;
@@ -182,8 +280,14 @@ absl::Status ParallelGenerateAndRunSamples(
                                            status = &worker_status[i]] {
       *status =
           GenerateAndRunSamples(i, ast_generator_options, sample_options, seed,
-                                top_run_dir, crasher_dir, summary_dir,
-                                worker_sample_count, duration, force_failure);
+                                top_run_dir, worker_crasher_dir, summary_dir,
+                                worker_sample_count, duration, force_failure,
+                                in_process,
+                                coverage.has_value() ? &*coverage : nullptr,
+                                shared.get(),
+                                validated_ir_cache.has_value()
+                                    ? &*validated_ir_cache
+                                    : nullptr);
     });
   }
   for (int64_t i = 0; i < workers.size(); ++i) {
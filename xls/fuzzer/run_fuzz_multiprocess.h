@@ -37,6 +37,29 @@ namespace xls {
 //
 // If `force_failure` is true, every sample run will be considered a failure.
 // This is useful for testing failure paths.
+//
+// If `in_process` is true, DSLX conversion, optimization and IR evaluation run
+// inside the worker threads (see InProcessCommands) instead of as a subprocess
+// per tool invocation; failing samples are still minimized using subprocesses.
+//
+// If `coverage_guided` is true, the features each sample exercised (IR ops,
+// optimization passes which changed the IR, and codegen arguments; see
+// CollectSampleFeatures) are tracked across all workers, and each worker keeps
+// a corpus of the passing samples which exercised new features. Half of the
+// samples are then mutations of corpus samples chosen by the rarity of their
+// features, steering the fuzzer towards rarely-exercised paths.
+//
+// If `shared_dir` is given, it is used as a SharedFuzzDirectory through which
+// fuzzers running in other processes or on other machines cooperate: crashers
+// are saved to its crasher directory unless `crasher_dir` is given, and only
+// the first crasher for each failure signature is saved. When coverage-guided,
+// the corpus samples found by each fuzzer are published there, and the samples
+// published by other fuzzers are periodically pulled in and run.
+//
+// If `validated_ir_cache_size` is positive, the workers share a
+// ValidatedIrCache of that many entries, and codegen and simulation are only
+// run for samples whose optimized IR differs from that of recently passing
+// samples.
 absl::Status ParallelGenerateAndRunSamples(
     int64_t worker_count,
     const dslx::AstGeneratorOptions& ast_generator_options,
@@ -47,7 +70,10 @@ absl::Status ParallelGenerateAndRunSamples(
     const std::optional<std::filesystem::path>& summary_dir = std::nullopt,
     std::optional<int64_t> sample_count = std::nullopt,
     std::optional<absl::Duration> duration = std::nullopt,
-    bool force_failure = false);
+    bool force_failure = false, bool in_process = false,
+    bool coverage_guided = false,
+    const std::optional<std::filesystem::path>& shared_dir = std::nullopt,
+    int64_t validated_ir_cache_size = 0);
 
 }  // namespace xls
 
@@ -41,11 +41,20 @@ ABSL_FLAG(int64_t, calls_per_sample, 128, "Arguments to generate per sample.");
 ABSL_FLAG(std::optional<std::string>, crash_path, std::nullopt,
           "Path at which to place crash data.");
 ABSL_FLAG(bool, codegen, false, "Run code generation.");
+ABSL_FLAG(bool, coverage_guided, false,
+          "Track the IR ops, optimization passes and codegen options each "
+          "sample exercises, and mutate samples which exercised rare ones "
+          "rather than always generating new samples.");
 ABSL_FLAG(bool, emit_loops, true, "Emit loops in generator.");
 ABSL_FLAG(
     bool, force_failure, false,
     "Forces the samples to fail. Can be used to test failure code paths.");
 ABSL_FLAG(bool, generate_proc, false, "Generate a proc sample.");
+ABSL_FLAG(bool, in_process, false,
+          "Run DSLX conversion, IR optimization and IR evaluation in-process "
+          "rather than spawning a tool subprocess for each step. Much faster "
+          "for small samples, but a compiler crash takes down the fuzzer and "
+          "--timeout_seconds is not enforced for these steps.");
 ABSL_FLAG(int64_t, max_width_aggregate_types, 1024,
           "The maximum width of aggregate types (tuples and arrays) in the "
           "generated samples.");
@@ -62,6 +71,13 @@ ABSL_FLAG(std::optional<std::string>, save_temps_path, std::nullopt,
 ABSL_FLAG(std::optional<int64_t>, seed, std::nullopt,
           "Seed value for generation. By default, a nondetermistic seed is "
           "used; if a seed is provided, it is used for determinism");
+ABSL_FLAG(std::optional<std::string>, shared_dir, std::nullopt,
+          "Directory shared with fuzzers running on other machines (e.g. on a "
+          "network file system). Crashers are saved there (unless --crash_path "
+          "is given) and deduplicated by failure signature across all the "
+          "fuzzers; with --coverage_guided, the fuzzers also exchange the "
+          "samples which exercised new features. Omit --seed so that each "
+          "machine generates different samples.");
 ABSL_FLAG(bool, simulate, false, "Run Verilog simulation.");
 ABSL_FLAG(std::optional<std::string>, simulator, std::nullopt,
           "Verilog simulator to use.");
@@ -79,6 +95,11 @@ ABSL_FLAG(bool, use_llvm_jit, true,
 ABSL_FLAG(
     bool, use_system_verilog, true,
     "If true, emit SystemVerilog during codegen; otherwise emit Verilog.");
+ABSL_FLAG(int64_t, validated_ir_cache_size, 4096,
+          "Number of recently passing optimized IR graphs (with their codegen "
+          "and simulation options) to remember. Codegen and simulation are "
+          "skipped for samples which optimize to a remembered graph. Zero "
+          "disables the cache.");
 ABSL_FLAG(std::optional<int64_t>, worker_count, std::nullopt,
           "Number of workers to use for execution; defaults to number of "
           "physical cores detected.");
@@ -91,21 +112,25 @@ struct Options {
   int64_t calls_per_sample;
   std::optional<std::filesystem::path> crash_path;
   bool codegen;
+  bool coverage_guided;
   bool emit_loops;
   bool force_failure;
   bool generate_proc;
+  bool in_process;
   int64_t max_width_aggregate_types;
   int64_t max_width_bits_types;
   int64_t proc_ticks;
   std::optional<int64_t> sample_count;
   std::optional<std::filesystem::path> save_temps_path;
   std::optional<int64_t> seed;
+  std::optional<std::filesystem::path> shared_dir;
   bool simulate;
   std::optional<std::string> simulator;
   std::optional<std::filesystem::path> summary_path;
   std::optional<int64_t> timeout_seconds;
   bool use_llvm_jit;
   bool use_system_verilog;
+  int64_t validated_ir_cache_size;
   std::optional<int64_t> worker_count;
 };
 
@@ -167,7 +192,9 @@ absl::Status RealMain(const Options& options) {
       worker_count, ast_generator_options, sample_options, options.seed,
       /*top_run_dir=*/options.save_temps_path,
       /*crasher_dir=*/options.crash_path, /*summary_dir=*/options.summary_path,
-      options.sample_count, options.duration, options.force_failure);
+      options.sample_count, options.duration, options.force_failure,
+      options.in_process, options.coverage_guided, options.shared_dir,
+      options.validated_ir_cache_size);
 }
 
 }  // namespace
@@ -193,9 +220,11 @@ int main(int argc, char** argv) {
       .calls_per_sample = absl::GetFlag(FLAGS_calls_per_sample),
       .crash_path = absl::GetFlag(FLAGS_crash_path),
       .codegen = absl::GetFlag(FLAGS_codegen),
+      .coverage_guided = absl::GetFlag(FLAGS_coverage_guided),
       .emit_loops = absl::GetFlag(FLAGS_emit_loops),
       .force_failure = absl::GetFlag(FLAGS_force_failure),
       .generate_proc = absl::GetFlag(FLAGS_generate_proc),
+      .in_process = absl::GetFlag(FLAGS_in_process),
       .max_width_aggregate_types =
           absl::GetFlag(FLAGS_max_width_aggregate_types),
       .max_width_bits_types = absl::GetFlag(FLAGS_max_width_bits_types),
@@ -203,12 +232,14 @@ int main(int argc, char** argv) {
       .sample_count = absl::GetFlag(FLAGS_sample_count),
       .save_temps_path = absl::GetFlag(FLAGS_save_temps_path),
       .seed = absl::GetFlag(FLAGS_seed),
+      .shared_dir = absl::GetFlag(FLAGS_shared_dir),
       .simulate = absl::GetFlag(FLAGS_simulate),
       .simulator = absl::GetFlag(FLAGS_simulator),
       .summary_path = absl::GetFlag(FLAGS_summary_path),
       .timeout_seconds = absl::GetFlag(FLAGS_timeout_seconds),
       .use_llvm_jit = absl::GetFlag(FLAGS_use_llvm_jit),
       .use_system_verilog = absl::GetFlag(FLAGS_use_system_verilog),
+      .validated_ir_cache_size = absl::GetFlag(FLAGS_validated_ir_cache_size),
       .worker_count = absl::GetFlag(FLAGS_worker_count),
   }));
 }
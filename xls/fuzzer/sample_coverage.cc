@@ -0,0 +1,213 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/sample_coverage.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/fuzzer/dslx_mutator.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_generator.h"
+#include "xls/fuzzer/sample_runner.h"
+#include "xls/fuzzer/value_generator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "re2/re2.h"
+
+namespace xls {
+namespace {
+
+// Returns the type kind and log2 width bucket of the node's type, e.g. "bits5"
+// for a bits[17] through bits[32].
+std::string TypeBucket(Node* node) {
+  int64_t bit_count = node->GetType()->GetFlatBitCount();
+  return absl::StrCat(TypeKindToString(node->GetType()->kind()),
+                      bit_count <= 1 ? 0 : CeilOfLog2(bit_count));
+}
+
+absl::Status CollectIrFeatures(const std::filesystem::path& ir_path,
+                               std::string_view prefix,
+                               SampleFeatures* features) {
+  if (!FileExists(ir_path).ok()) {
+    return absl::OkStatus();
+  }
+  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text));
+  for (FunctionBase* f : package->GetFunctionBases()) {
+    for (Node* node : f->nodes()) {
+      features->insert(absl::StrCat(prefix, ":", OpToString(node->op()), ":",
+                                    TypeBucket(node)));
+      for (Node* operand : node->operands()) {
+        features->insert(absl::StrCat(prefix, ":", OpToString(node->op()),
+                                      "<-", OpToString(operand->op())));
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Adds a feature for each pass which changed the IR. The trace is written by
+// PassResultsToChromeTrace with one event per line.
+absl::Status CollectPassFeatures(const std::filesystem::path& trace_path,
+                                 SampleFeatures* features) {
+  if (!FileExists(trace_path).ok()) {
+    return absl::OkStatus();
+  }
+  XLS_ASSIGN_OR_RETURN(std::string trace, GetFileContents(trace_path));
+  static const LazyRE2 kChangedPassEvent = {
+      R"re("name":"([^"]+)","cat":"pass".*"changed":true)re"};
+  for (std::string_view line : absl::StrSplit(trace, '\n')) {
+    std::string pass_name;
+    if (RE2::PartialMatch(line, *kChangedPassEvent, &pass_name)) {
+      features->insert(absl::StrCat("pass:", pass_name));
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<SampleFeatures> CollectSampleFeatures(
+    const std::filesystem::path& run_dir, const SampleOptions& options) {
+  SampleFeatures features;
+  XLS_RETURN_IF_ERROR(
+      CollectIrFeatures(run_dir / "sample.ir", "ir", &features));
+  XLS_RETURN_IF_ERROR(
+      CollectIrFeatures(run_dir / "sample.opt.ir", "opt", &features));
+  XLS_RETURN_IF_ERROR(CollectPassFeatures(
+      run_dir / SampleRunner::kOptPassTraceFilename, &features));
+  if (options.codegen()) {
+    for (const std::string& arg : options.codegen_args()) {
+      features.insert(absl::StrCat("codegen:", arg));
+    }
+  }
+  return features;
+}
+
+std::optional<RecordedCoverage> RecordSampleCoverage(
+    const std::filesystem::path& run_dir, const SampleOptions& options,
+    CoverageTracker& coverage) {
+  absl::StatusOr<SampleFeatures> features =
+      CollectSampleFeatures(run_dir, options);
+  if (!features.ok()) {
+    XLS_LOG(WARNING) << "Failed to collect coverage features of the sample in "
+                     << run_dir << ": " << features.status();
+    return std::nullopt;
+  }
+  int64_t new_feature_count = coverage.Record(*features);
+  return RecordedCoverage{.features = *std::move(features),
+                          .new_feature_count = new_feature_count};
+}
+
+int64_t CoverageTracker::Record(const SampleFeatures& features) {
+  absl::MutexLock lock(&mutex_);
+  int64_t new_features = 0;
+  for (const std::string& feature : features) {
+    if (++counts_[feature] == 1) {
+      ++new_features;
+    }
+  }
+  return new_features;
+}
+
+double CoverageTracker::Rarity(const SampleFeatures& features) const {
+  absl::MutexLock lock(&mutex_);
+  double rarity = 0.0;
+  for (const std::string& feature : features) {
+    auto it = counts_.find(feature);
+    rarity += it == counts_.end() ? 1.0 : 1.0 / static_cast<double>(it->second);
+  }
+  return rarity;
+}
+
+int64_t CoverageTracker::feature_count() const {
+  absl::MutexLock lock(&mutex_);
+  return counts_.size();
+}
+
+void SampleCorpus::Add(Sample sample, SampleFeatures features,
+                       const CoverageTracker& tracker) {
+  if (entries_.size() >= max_size_) {
+    auto least_rare = std::min_element(
+        entries_.begin(), entries_.end(), [&](const Entry& a, const Entry& b) {
+          return tracker.Rarity(a.features) < tracker.Rarity(b.features);
+        });
+    entries_.erase(least_rare);
+  }
+  entries_.push_back(
+      Entry{.sample = std::move(sample), .features = std::move(features)});
+}
+
+const Sample* SampleCorpus::Choose(const CoverageTracker& tracker,
+                                   ValueGenerator* rng) const {
+  if (entries_.empty()) {
+    return nullptr;
+  }
+  std::vector<double> weights;
+  weights.reserve(entries_.size());
+  double total = 0.0;
+  for (const Entry& entry : entries_) {
+    total += tracker.Rarity(entry.features);
+    weights.push_back(total);
+  }
+  double target = rng->RandomDouble() * total;
+  int64_t index =
+      std::upper_bound(weights.begin(), weights.end(), target) -
+      weights.begin();
+  return &entries_[std::min<int64_t>(index, entries_.size() - 1)].sample;
+}
+
+absl::StatusOr<Sample> MutateSample(const Sample& parent, ValueGenerator* rng,
+                                    int64_t max_attempts) {
+  XLS_RET_CHECK(parent.options().input_is_dslx());
+  absl::Status status = absl::InvalidArgumentError("No mutation attempted");
+  for (int64_t attempt = 0; attempt < max_attempts; ++attempt) {
+    XLS_ASSIGN_OR_RETURN(
+        std::string dslx_text,
+        dslx::RemoveDslxToken(parent.input_text(), rng->rng()));
+    absl::StatusOr<Sample> mutated =
+        GenerateSampleForDslx(dslx_text, parent.options(), rng);
+    if (mutated.ok()) {
+      return mutated;
+    }
+    status = mutated.status();
+  }
+  return absl::FailedPreconditionError(
+      absl::StrCat("No valid mutation found in ", max_attempts,
+                   " attempts; last error: ", status.message()));
+}
+
+}  // namespace xls
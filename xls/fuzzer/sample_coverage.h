@@ -0,0 +1,128 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_SAMPLE_COVERAGE_H_
+#define XLS_FUZZER_SAMPLE_COVERAGE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/value_generator.h"
+
+namespace xls {
+
+// The set of coverage features a sample exercised. Each feature is a string
+// naming one thing a sample run did, e.g.:
+//
+//   "ir:concat:bits6"        a concat of width in (32, 64] in the input IR
+//   "opt:add<-sign_ext"      an add fed by a sign_ext in the optimized IR
+//   "pass:bdd_cse"           the bdd_cse pass changed the IR
+//   "codegen:--generator=pipeline"
+using SampleFeatures = absl::flat_hash_set<std::string>;
+
+// Returns the features exercised by the sample which was run with `options` in
+// `run_dir` (see SampleRunner): the ops (bucketed by type and width) and
+// operand/user op pairs of the unoptimized and optimized IR, the optimization
+// passes which changed the IR according to the pass trace, and the codegen
+// arguments. Outputs missing from `run_dir`, e.g., because the sample was not
+// optimized, contribute no features.
+absl::StatusOr<SampleFeatures> CollectSampleFeatures(
+    const std::filesystem::path& run_dir, const SampleOptions& options);
+
+// Counts how many samples exercised each feature. Thread-safe, so a single
+// tracker can be shared by all fuzzing workers.
+class CoverageTracker {
+ public:
+  // Records that a sample exercised `features`. Returns the number of features
+  // which no previously recorded sample exercised.
+  int64_t Record(const SampleFeatures& features);
+
+  // Returns how rare `features` are: the sum over the features of the inverse
+  // of the number of samples which exercised them. Unseen features count as
+  // having been exercised once.
+  double Rarity(const SampleFeatures& features) const;
+
+  // Returns the number of distinct features exercised by any sample.
+  int64_t feature_count() const;
+
+ private:
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, int64_t> counts_ ABSL_GUARDED_BY(mutex_);
+};
+
+// The features of a sample which were recorded in a CoverageTracker.
+struct RecordedCoverage {
+  SampleFeatures features;
+  // The number of `features` which no previously recorded sample exercised.
+  int64_t new_feature_count;
+};
+
+// Collects the features of the sample run in `run_dir` (see
+// CollectSampleFeatures) and records them in `coverage`. Collection is
+// best-effort: the outputs of a failing sample may be malformed (e.g.,
+// optimized IR which does not parse or verify), in which case a warning is
+// logged, nothing is recorded and std::nullopt is returned.
+std::optional<RecordedCoverage> RecordSampleCoverage(
+    const std::filesystem::path& run_dir, const SampleOptions& options,
+    CoverageTracker& coverage);
+
+// A bounded set of samples which exercised new features, from which samples
+// are chosen for mutation with probability proportional to their current
+// rarity. When full, adding a sample evicts the least rare one. Not
+// thread-safe; each fuzzing worker keeps its own corpus.
+class SampleCorpus {
+ public:
+  explicit SampleCorpus(int64_t max_size = 256) : max_size_(max_size) {}
+
+  void Add(Sample sample, SampleFeatures features,
+           const CoverageTracker& tracker);
+
+  // Returns a sample chosen by rarity according to `tracker`, or nullptr if
+  // the corpus is empty.
+  const Sample* Choose(const CoverageTracker& tracker,
+                       ValueGenerator* rng) const;
+
+  int64_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+
+ private:
+  struct Entry {
+    Sample sample;
+    SampleFeatures features;
+  };
+
+  int64_t max_size_;
+  std::vector<Entry> entries_;
+};
+
+// Returns a mutation of `parent` with one DSLX token removed (see
+// RemoveDslxToken) and freshly generated arguments; the parent's options,
+// including its codegen arguments, are kept. Mutations which do not typecheck
+// are retried up to `max_attempts` times, after which an error is returned.
+// `parent` must be a DSLX sample.
+absl::StatusOr<Sample> MutateSample(const Sample& parent, ValueGenerator* rng,
+                                    int64_t max_attempts = 16);
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_SAMPLE_COVERAGE_H_
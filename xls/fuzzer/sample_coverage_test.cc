@@ -0,0 +1,135 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/sample_coverage.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_runner.h"
+#include "xls/fuzzer/value_generator.h"
+
+namespace xls {
+namespace {
+
+using ::testing::Contains;
+using ::testing::Not;
+
+TEST(SampleCoverageTest, CollectSampleFeatures) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK(SetFileContents(temp_dir.path() / "sample.ir", R"(
+package sample
+
+top fn main(x: bits[8], y: bits[40]) -> bits[48] {
+  ret concat.1: bits[48] = concat(x, y)
+}
+)"));
+  XLS_ASSERT_OK(SetFileContents(
+      temp_dir.path() / SampleRunner::kOptPassTraceFilename,
+      "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+      "{\"name\":\"dce\",\"cat\":\"pass\",\"ph\":\"X\",\"ts\":0,\"dur\":1,"
+      "\"pid\":0,\"tid\":0,\"args\":{\"changed\":true,\"nodes_added\":0,"
+      "\"nodes_removed\":2}},\n"
+      "{\"name\":\"cse\",\"cat\":\"pass\",\"ph\":\"X\",\"ts\":1,\"dur\":1,"
+      "\"pid\":0,\"tid\":0,\"args\":{\"changed\":false,\"nodes_added\":0,"
+      "\"nodes_removed\":0}}\n"
+      "]}\n"));
+  SampleOptions options;
+  options.set_codegen(true);
+  options.set_codegen_args({"--generator=pipeline", "--pipeline_stages=2"});
+
+  XLS_ASSERT_OK_AND_ASSIGN(SampleFeatures features,
+                           CollectSampleFeatures(temp_dir.path(), options));
+  EXPECT_THAT(features, Contains("ir:concat:bits6"));
+  EXPECT_THAT(features, Contains("ir:param:bits3"));
+  EXPECT_THAT(features, Contains("ir:concat<-param"));
+  EXPECT_THAT(features, Contains("pass:dce"));
+  EXPECT_THAT(features, Not(Contains("pass:cse")));
+  EXPECT_THAT(features, Contains("codegen:--generator=pipeline"));
+  // The sample was not optimized.
+  for (const std::string& feature : features) {
+    EXPECT_FALSE(feature.starts_with("opt:")) << feature;
+  }
+}
+
+TEST(SampleCoverageTest, UnparseableOptimizedIrIsNotRecorded) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK(SetFileContents(temp_dir.path() / "sample.ir", R"(
+package sample
+
+top fn main(x: bits[8]) -> bits[8] {
+  ret neg.1: bits[8] = neg(x)
+}
+)"));
+  XLS_ASSERT_OK(SetFileContents(temp_dir.path() / "sample.opt.ir",
+                                "package sample\n\ntop fn main(x: bits[8]"));
+  SampleOptions options;
+
+  EXPECT_FALSE(CollectSampleFeatures(temp_dir.path(), options).ok());
+  CoverageTracker tracker;
+  EXPECT_FALSE(
+      RecordSampleCoverage(temp_dir.path(), options, tracker).has_value());
+  EXPECT_EQ(tracker.feature_count(), 0);
+}
+
+TEST(SampleCoverageTest, TrackerAndCorpus) {
+  CoverageTracker tracker;
+  EXPECT_EQ(tracker.Record({"a", "b"}), 2);
+  EXPECT_EQ(tracker.Record({"a", "c"}), 1);
+  EXPECT_EQ(tracker.feature_count(), 3);
+  EXPECT_DOUBLE_EQ(tracker.Rarity({"a", "b"}), 1.5);
+  EXPECT_DOUBLE_EQ(tracker.Rarity({"d"}), 1.0);
+
+  SampleOptions options;
+  options.set_input_is_dslx(true);
+  SampleCorpus corpus(/*max_size=*/2);
+  ValueGenerator rng(std::mt19937_64{});
+  EXPECT_EQ(corpus.Choose(tracker, &rng), nullptr);
+  corpus.Add(Sample("common", options, {}), {"a"}, tracker);
+  corpus.Add(Sample("rare", options, {}), {"b"}, tracker);
+  // Adding a third sample evicts the least rare one.
+  corpus.Add(Sample("rarer", options, {}), {"c", "d"}, tracker);
+  EXPECT_EQ(corpus.size(), 2);
+  for (int i = 0; i < 16; ++i) {
+    const Sample* chosen = corpus.Choose(tracker, &rng);
+    ASSERT_NE(chosen, nullptr);
+    EXPECT_NE(chosen->input_text(), "common");
+  }
+}
+
+TEST(SampleCoverageTest, MutateSample) {
+  SampleOptions options;
+  options.set_input_is_dslx(true);
+  options.set_sample_type(fuzzer::SAMPLE_TYPE_FUNCTION);
+  options.set_calls_per_sample(2);
+  Sample parent("fn main(x: u8, y: u8) -> u8 { -x + -y + !x }", options,
+                {});
+  ValueGenerator rng(std::mt19937_64{});
+  XLS_ASSERT_OK_AND_ASSIGN(Sample mutated,
+                           MutateSample(parent, &rng, /*max_attempts=*/1000));
+  EXPECT_NE(mutated.input_text(), parent.input_text());
+  EXPECT_EQ(mutated.options(), parent.options());
+  EXPECT_EQ(mutated.args_batch().size(), 2);
+}
+
+}  // namespace
+}  // namespace xls
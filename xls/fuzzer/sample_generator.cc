@@ -336,7 +336,6 @@ static absl::StatusOr<Sample> GenerateProcSample(
 absl::StatusOr<Sample> GenerateSample(
     const AstGeneratorOptions& generator_options,
     const SampleOptions& sample_options, ValueGenerator* value_gen) {
-  constexpr std::string_view top_name = "main";
   if (generator_options.generate_proc) {
     XLS_CHECK_EQ(sample_options.calls_per_sample(), 0)
         << "calls per sample must be zero when generating a proc sample.";
@@ -379,6 +378,18 @@ absl::StatusOr<Sample> GenerateSample(
                             min_stages, has_nb_recv, value_gen));
   }
 
+  sample_options_copy.set_sample_type(generator_options.generate_proc
+                                          ? fuzzer::SAMPLE_TYPE_PROC
+                                          : fuzzer::SAMPLE_TYPE_FUNCTION);
+  return GenerateSampleForDslx(dslx_text, sample_options_copy, value_gen);
+}
+
+absl::StatusOr<Sample> GenerateSampleForDslx(
+    std::string_view dslx_text, const SampleOptions& sample_options,
+    ValueGenerator* value_gen) {
+  constexpr std::string_view top_name = "main";
+  XLS_RET_CHECK(sample_options.input_is_dslx());
+
   // Parse and type check the DSLX input to retrieve the top entity. The top
   // member must be a proc or a function.
   ImportData import_data(
@@ -390,19 +401,28 @@ absl::StatusOr<Sample> GenerateSample(
       ParseAndTypecheck(dslx_text, "sample.x", "sample", &import_data));
   std::optional<ModuleMember*> module_member =
       tm.module->FindMemberWithName(top_name);
-  XLS_CHECK(module_member.has_value());
+  if (!module_member.has_value()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Sample has no top member named `", top_name, "`"));
+  }
   ModuleMember* member = module_member.value();
 
-  if (generator_options.generate_proc) {
-    XLS_CHECK(std::holds_alternative<dslx::Proc*>(*member));
-    sample_options_copy.set_sample_type(fuzzer::SAMPLE_TYPE_PROC);
+  if (sample_options.IsProcSample()) {
+    if (!std::holds_alternative<dslx::Proc*>(*member)) {
+      return absl::InvalidArgumentError(
+          "Top member of proc sample is not a proc");
+    }
     return GenerateProcSample(std::get<dslx::Proc*>(*member), tm,
-                              sample_options_copy, value_gen, dslx_text);
+                              sample_options, value_gen,
+                              std::string(dslx_text));
+  }
+  if (!std::holds_alternative<dslx::Function*>(*member)) {
+    return absl::InvalidArgumentError(
+        "Top member of function sample is not a function");
   }
-  XLS_CHECK(std::holds_alternative<dslx::Function*>(*member));
-  sample_options_copy.set_sample_type(fuzzer::SAMPLE_TYPE_FUNCTION);
   return GenerateFunctionSample(std::get<dslx::Function*>(*member), tm,
-                                sample_options_copy, value_gen, dslx_text);
+                                sample_options, value_gen,
+                                std::string(dslx_text));
 }
 
 }  // namespace xls
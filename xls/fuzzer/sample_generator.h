@@ -16,7 +16,9 @@
 #define XLS_FUZZER_SAMPLE_GENERATOR_H_
 
 #include <random>
+#include <string_view>
 
+#include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/dslx/type_system/concrete_type.h"
 #include "xls/fuzzer/ast_generator.h"
@@ -30,6 +32,16 @@ absl::StatusOr<Sample> GenerateSample(
     const dslx::AstGeneratorOptions& generator_options,
     const SampleOptions& sample_options, ValueGenerator* value_gen);
 
+// Returns a Sample running the given DSLX text with `sample_options`, with
+// freshly generated arguments (or channel inputs, for proc samples) for its
+// `main` entity. `sample_options` are used as given, including any codegen
+// arguments. Returns an error if the DSLX does not parse and typecheck or its
+// `main` entity does not match the sample type; this is used to validate
+// mutated samples before running them.
+absl::StatusOr<Sample> GenerateSampleForDslx(
+    std::string_view dslx_text, const SampleOptions& sample_options,
+    ValueGenerator* value_gen);
+
 }  // namespace xls
 
 #endif  // XLS_FUZZER_SAMPLE_GENERATOR_H_
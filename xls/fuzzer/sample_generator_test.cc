@@ -104,5 +104,33 @@ TEST(SampleGeneratorTest, GenerateBasicProcSample) {
   EXPECT_THAT(sample.input_text(), testing::HasSubstr("proc main"));
 }
 
+TEST(SampleGeneratorTest, GenerateSampleForDslx) {
+  ValueGenerator value_gen(std::mt19937_64{});
+  SampleOptions sample_options;
+  sample_options.set_input_is_dslx(true);
+  sample_options.set_sample_type(fuzzer::SAMPLE_TYPE_FUNCTION);
+  sample_options.set_calls_per_sample(4);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Sample sample,
+      GenerateSampleForDslx("fn main(x: u8, y: s3) -> u8 { x }",
+                            sample_options, &value_gen));
+  ASSERT_EQ(sample.args_batch().size(), 4);
+  for (const std::vector<dslx::InterpValue>& args : sample.args_batch()) {
+    ASSERT_EQ(args.size(), 2);
+    EXPECT_TRUE(args[0].IsUBits());
+    EXPECT_TRUE(args[1].IsSBits());
+  }
+
+  // Text which does not typecheck, or whose `main` is of the wrong kind, is
+  // rejected.
+  EXPECT_FALSE(GenerateSampleForDslx("fn main(x: u8) -> u8 { y }",
+                                     sample_options, &value_gen)
+                   .ok());
+  sample_options.set_sample_type(fuzzer::SAMPLE_TYPE_PROC);
+  EXPECT_FALSE(GenerateSampleForDslx("fn main(x: u8) -> u8 { x }",
+                                     sample_options, &value_gen)
+                   .ok());
+}
+
 }  // namespace
 }  // namespace xls
@@ -67,6 +67,7 @@
 #include "xls/fuzzer/cpp_sample_runner.h"
 #include "xls/fuzzer/sample.h"
 #include "xls/fuzzer/sample.pb.h"
+#include "xls/fuzzer/validated_ir_cache.h"
 #include "xls/ir/format_preference.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/value.h"
@@ -353,9 +354,15 @@ absl::StatusOr<std::filesystem::path> OptimizeIr(
     XLS_ASSIGN_OR_RETURN(command, GetXlsRunfilePath(kIrOptMainPath));
   }
 
+  // The pass trace records which passes changed the IR; it is read back by
+  // coverage-guided fuzzing (see sample_coverage.h).
   XLS_ASSIGN_OR_RETURN(
       std::string opt_ir_text,
-      RunCommand("Optimizing IR", *command, {ir_path}, run_dir, options));
+      RunCommand("Optimizing IR", *command,
+                 {absl::StrCat("--pass_trace_path=",
+                               SampleRunner::kOptPassTraceFilename),
+                  ir_path},
+                 run_dir, options));
   XLS_VLOG(3) << "Optimized IR:\n" << opt_ir_text;
   std::filesystem::path opt_ir_path = run_dir / "sample.opt.ir";
   XLS_RETURN_IF_ERROR(SetFileContents(opt_ir_path, opt_ir_text));
@@ -905,6 +912,9 @@ absl::Status SampleRunner::RunFunction(
     }
   }
 
+  // Key of the optimized IR in the validated IR cache, set if the backends are
+  // run and the cache is to be updated should the sample pass.
+  std::optional<std::string> validated_ir_key;
   if (options.optimize_ir()) {
     Stopwatch t;
     XLS_ASSIGN_OR_RETURN(std::filesystem::path opt_ir_path,
@@ -929,6 +939,14 @@ absl::Status SampleRunner::RunFunction(
     }
 
     if (options.codegen()) {
+      validated_ir_key = GetValidatedIrKey(opt_ir_path, options);
+    }
+    if (validated_ir_key.has_value() &&
+        validated_ir_cache_->Contains(*validated_ir_key)) {
+      XLS_VLOG(1) << "Optimized IR was validated before; skipping codegen and "
+                     "simulation.";
+      validated_ir_key.reset();
+    } else if (options.codegen()) {
       t.Reset();
       XLS_ASSIGN_OR_RETURN(std::filesystem::path verilog_path,
                            Codegen(opt_ir_path, options.codegen_args(), options,
@@ -949,8 +967,12 @@ absl::Status SampleRunner::RunFunction(
 
   absl::flat_hash_map<std::string, absl::Span<const dslx::InterpValue>>
       results_spans(results.begin(), results.end());
-  return CompareResultsFunction(
-      results_spans, args_batch.has_value() ? &*args_batch : nullptr);
+  XLS_RETURN_IF_ERROR(CompareResultsFunction(
+      results_spans, args_batch.has_value() ? &*args_batch : nullptr));
+  if (validated_ir_key.has_value()) {
+    validated_ir_cache_->Insert(*validated_ir_key);
+  }
+  return absl::OkStatus();
 }
 
 absl::Status SampleRunner::RunProc(
@@ -1071,6 +1093,9 @@ absl::Status SampleRunner::RunProc(
   }
 
   std::optional<std::filesystem::path> opt_ir_path = std::nullopt;
+  // Key of the optimized IR in the validated IR cache, set if the backends are
+  // run and the cache is to be updated should the sample pass.
+  std::optional<std::string> validated_ir_key;
   if (options.optimize_ir()) {
     Stopwatch t;
     XLS_ASSIGN_OR_RETURN(opt_ir_path,
@@ -1097,6 +1122,14 @@ absl::Status SampleRunner::RunProc(
           absl::ToInt64Nanoseconds(t.GetElapsedTime()));
 
       if (options.codegen()) {
+        validated_ir_key = GetValidatedIrKey(*opt_ir_path, options);
+      }
+      if (validated_ir_key.has_value() &&
+          validated_ir_cache_->Contains(*validated_ir_key)) {
+        XLS_VLOG(1) << "Optimized IR was validated before; skipping codegen "
+                       "and simulation.";
+        validated_ir_key.reset();
+      } else if (options.codegen()) {
         t.Reset();
         XLS_ASSIGN_OR_RETURN(std::filesystem::path verilog_path,
                              Codegen(*opt_ir_path, options.codegen_args(),
@@ -1121,7 +1154,32 @@ absl::Status SampleRunner::RunProc(
     }
   }
 
-  return CompareResultsProc(results);
+  XLS_RETURN_IF_ERROR(CompareResultsProc(results));
+  if (validated_ir_key.has_value()) {
+    validated_ir_cache_->Insert(*validated_ir_key);
+  }
+  return absl::OkStatus();
+}
+
+std::optional<std::string> SampleRunner::GetValidatedIrKey(
+    const std::filesystem::path& opt_ir_path, const SampleOptions& options) {
+  if (validated_ir_cache_ == nullptr) {
+    return std::nullopt;
+  }
+  absl::StatusOr<std::string> opt_ir_text = GetFileContents(opt_ir_path);
+  if (!opt_ir_text.ok()) {
+    XLS_LOG(WARNING) << "Failed to read optimized IR: "
+                     << opt_ir_text.status();
+    return std::nullopt;
+  }
+  absl::StatusOr<std::string> key =
+      ValidatedIrCache::GetKey(*opt_ir_text, options);
+  if (!key.ok()) {
+    XLS_LOG(WARNING) << "Failed to compute validated IR key: "
+                     << key.status();
+    return std::nullopt;
+  }
+  return *std::move(key);
 }
 
 }  // namespace xls
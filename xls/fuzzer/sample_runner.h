@@ -19,6 +19,7 @@
 #include <functional>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -27,6 +28,7 @@
 #include "absl/status/statusor.h"
 #include "xls/fuzzer/sample.h"
 #include "xls/fuzzer/sample_summary.pb.h"
+#include "xls/fuzzer/validated_ir_cache.h"
 
 namespace xls {
 
@@ -68,10 +70,22 @@ class SampleRunner {
     std::optional<Command> simulate_module_main;
   };
 
+  // The file in `run_dir` to which the IR optimizer writes its pass trace (in
+  // the format of PassResultsToChromeTrace).
+  static constexpr std::string_view kOptPassTraceFilename =
+      "sample.opt.ir.trace.json";
+
+  // If `validated_ir_cache` is given, code generation and simulation are
+  // skipped for samples whose optimized IR (and codegen and simulation
+  // options) are in the cache, and samples which pass after running them are
+  // added to it.
   explicit SampleRunner(std::filesystem::path run_dir)
       : run_dir_(std::move(run_dir)) {}
-  SampleRunner(std::filesystem::path run_dir, Commands commands)
-      : run_dir_(std::move(run_dir)), commands_(std::move(commands)) {}
+  SampleRunner(std::filesystem::path run_dir, Commands commands,
+               ValidatedIrCache* validated_ir_cache = nullptr)
+      : run_dir_(std::move(run_dir)),
+        commands_(std::move(commands)),
+        validated_ir_cache_(validated_ir_cache) {}
 
   // Runs the provided sample, writing out files under the SampleRunner's
   // `run_dir` as appropriate.
@@ -98,8 +112,14 @@ class SampleRunner {
       const std::optional<std::filesystem::path>& args_path,
       const std::optional<std::filesystem::path>& ir_channel_names_path);
 
+  // Returns the key of the optimized IR at `opt_ir_path` in the validated IR
+  // cache, or std::nullopt if there is no cache or no key can be computed.
+  std::optional<std::string> GetValidatedIrKey(
+      const std::filesystem::path& opt_ir_path, const SampleOptions& options);
+
   const std::filesystem::path run_dir_;
   const Commands commands_;
+  ValidatedIrCache* validated_ir_cache_ = nullptr;
   fuzzer::SampleTimingProto timing_;
 };
 
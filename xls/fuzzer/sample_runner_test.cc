@@ -41,6 +41,7 @@
 #include "xls/fuzzer/cpp_sample_runner.h"
 #include "xls/fuzzer/sample.h"
 #include "xls/fuzzer/sample.pb.h"
+#include "xls/fuzzer/validated_ir_cache.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/value.h"
@@ -603,6 +604,42 @@ TEST_F(SampleRunnerTest, CodegenCombinational) {
               ElementsAre("bits[8]:0x8e"));
 }
 
+TEST_F(SampleRunnerTest, CodegenSkippedForValidatedIr) {
+  ValidatedIrCache cache;
+  SampleOptions options;
+  options.set_input_is_dslx(true);
+  options.set_ir_converter_args({"--top=main"});
+  options.set_optimize_ir(true);
+  options.set_codegen(true);
+  options.set_codegen_args({"--generator=combinational"});
+  options.set_use_system_verilog(false);
+  options.set_simulate(true);
+  XLS_ASSERT_OK_AND_ASSIGN(ArgsBatch args_batch, ToArgsBatch({
+                                                     {
+                                                         "bits[8]:42",
+                                                         "bits[8]:100",
+                                                     },
+                                                 }));
+  std::filesystem::path first_dir = GetTempPath() / "first";
+  XLS_ASSERT_OK(RecursivelyCreateDir(first_dir));
+  XLS_ASSERT_OK(SampleRunner(first_dir, {}, &cache)
+                    .Run(Sample("fn main(x: u8, y: u8) -> u8 { x + y }",
+                                options, args_batch)));
+  XLS_EXPECT_OK(FileExists(first_dir / "sample.v"));
+  EXPECT_EQ(cache.size(), 1);
+
+  // Optimizes to the same IR up to node names and ids.
+  std::filesystem::path second_dir = GetTempPath() / "second";
+  XLS_ASSERT_OK(RecursivelyCreateDir(second_dir));
+  XLS_ASSERT_OK(
+      SampleRunner(second_dir, {}, &cache)
+          .Run(Sample("fn main(x: u8, y: u8) -> u8 { let z = x + y; z | z }",
+                      options, args_batch)));
+  EXPECT_THAT(FileExists(second_dir / "sample.v"),
+              StatusIs(absl::StatusCode::kNotFound));
+  EXPECT_EQ(cache.size(), 1);
+}
+
 TEST_F(SampleRunnerTest, CodegenCombinationalWrongResults) {
   SampleRunner runner(
       GetTempPath(),
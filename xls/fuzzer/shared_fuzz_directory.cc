@@ -0,0 +1,158 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/shared_fuzz_directory.h"
+
+#include <unistd.h>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "openssl/sha.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/fuzzer/sample.h"
+#include "re2/re2.h"
+
+namespace xls {
+namespace {
+
+// Returns the first `bytes` bytes of the SHA-256 digest of `data` in hex.
+std::string HexDigest(std::string_view data, int64_t bytes) {
+  std::array<char, SHA256_DIGEST_LENGTH> digest;
+  SHA256(reinterpret_cast<const uint8_t*>(data.data()), data.size(),
+         reinterpret_cast<uint8_t*>(digest.data()));
+  return absl::BytesToHexString({digest.data(), static_cast<size_t>(bytes)});
+}
+
+}  // namespace
+
+std::string FailureSignature(const absl::Status& error) {
+  std::string message(error.message());
+  // Order matters: paths may contain numbers, and hex values start with a
+  // digit.
+  RE2::GlobalReplace(&message, R"((/[^\s:'"`/]+)+/?)", "<path>");
+  RE2::GlobalReplace(&message, R"(\b0x[0-9a-fA-F_]+\b)", "<hex>");
+  RE2::GlobalReplace(&message, R"([0-9]+)", "<n>");
+  return HexDigest(
+      absl::StrCat(absl::StatusCodeToString(error.code()), ":", message), 8);
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<SharedFuzzDirectory>>
+SharedFuzzDirectory::Create(const std::filesystem::path& root) {
+  auto shared_dir = absl::WrapUnique(new SharedFuzzDirectory(root));
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(shared_dir->crasher_dir()));
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(root / "signatures"));
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(root / "corpus"));
+  return shared_dir;
+}
+
+absl::StatusOr<bool> SharedFuzzDirectory::ClaimFailureSignature(
+    std::string_view signature) {
+  // Directory creation is atomic and fails if the directory exists, so exactly
+  // one fuzzer claims each signature.
+  std::error_code ec;
+  bool created = std::filesystem::create_directory(
+      root_ / "signatures" / signature, ec);
+  if (ec) {
+    return absl::InternalError(
+        absl::StrFormat("Failed to claim failure signature %s: %s", signature,
+                        ec.message()));
+  }
+  return created;
+}
+
+absl::Status SharedFuzzDirectory::PublishSample(const Sample& sample) {
+  std::string serialized = sample.Serialize();
+  std::string name = absl::StrCat(HexDigest(serialized, 16), ".x");
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!seen_corpus_entries_.insert(name).second) {
+      return absl::OkStatus();
+    }
+  }
+  std::filesystem::path entry_path = root_ / "corpus" / name;
+  if (FileExists(entry_path).ok()) {
+    return absl::OkStatus();
+  }
+
+  // Write to a temporary file and rename it into place so that other fuzzers
+  // never observe a partially-written entry. Temporary files start with a dot
+  // and are ignored by FetchNewSamples.
+  std::filesystem::path temp_path =
+      root_ / "corpus" / absl::StrFormat(".%s.tmp%d", name, getpid());
+  XLS_RETURN_IF_ERROR(SetFileContents(temp_path, serialized));
+  std::error_code ec;
+  std::filesystem::rename(temp_path, entry_path, ec);
+  if (ec) {
+    return absl::InternalError(absl::StrFormat(
+        "Failed to rename %s to %s: %s", temp_path.string(),
+        entry_path.string(), ec.message()));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<Sample>> SharedFuzzDirectory::FetchNewSamples(
+    int64_t max_count) {
+  XLS_ASSIGN_OR_RETURN(std::vector<std::filesystem::path> entries,
+                       GetDirectoryEntries(root_ / "corpus"));
+  std::vector<Sample> samples;
+  for (const std::filesystem::path& entry : entries) {
+    if (samples.size() >= max_count) {
+      break;
+    }
+    std::string name = entry.filename().string();
+    if (absl::StartsWith(name, ".") || !absl::EndsWith(name, ".x")) {
+      continue;
+    }
+    {
+      absl::MutexLock lock(&mutex_);
+      if (!seen_corpus_entries_.insert(name).second) {
+        continue;
+      }
+    }
+    absl::StatusOr<std::string> contents = GetFileContents(entry);
+    if (!contents.ok()) {
+      XLS_LOG(WARNING) << "Failed to read shared sample " << entry << ": "
+                       << contents.status();
+      continue;
+    }
+    absl::StatusOr<Sample> sample = Sample::Deserialize(*contents);
+    if (!sample.ok()) {
+      XLS_VLOG(1) << "Ignoring shared sample " << entry << ": "
+                  << sample.status();
+      continue;
+    }
+    samples.push_back(*std::move(sample));
+  }
+  return samples;
+}
+
+}  // namespace xls
@@ -0,0 +1,89 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_SHARED_FUZZ_DIRECTORY_H_
+#define XLS_FUZZER_SHARED_FUZZ_DIRECTORY_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/fuzzer/sample.h"
+
+namespace xls {
+
+// Returns a signature identifying the kind of failure described by `error`:
+// a hash of the status code and the message with numbers, hexadecimal values
+// and paths elided, so failures which differ only in e.g. the values or widths
+// of the sample involved, or the directory it ran in, share a signature.
+std::string FailureSignature(const absl::Status& error);
+
+// A directory shared by fuzzers running in any number of processes, possibly
+// on different machines (e.g. on a network file system), through which they
+// exchange interesting samples and deduplicate crashers. It contains:
+//
+//   crashers/     crashers saved by any fuzzer (see RunSampleAndSaveCrasher).
+//   signatures/   one entry per failure signature for which a crasher has been
+//                 saved.
+//   corpus/       serialized samples which exercised new coverage features in
+//                 some fuzzer.
+//
+// All updates are made with atomic file system operations (directory creation
+// and renames), so no locking between processes is needed. Thread-safe.
+class SharedFuzzDirectory {
+ public:
+  // Opens the shared directory at `root`, creating it and its subdirectories if
+  // needed.
+  static absl::StatusOr<std::unique_ptr<SharedFuzzDirectory>> Create(
+      const std::filesystem::path& root);
+
+  std::filesystem::path crasher_dir() const { return root_ / "crashers"; }
+
+  // Claims the failure signature `signature` (see FailureSignature). Returns
+  // true if no fuzzer had claimed it before, i.e., if the caller should save
+  // the failing sample as a new crasher.
+  absl::StatusOr<bool> ClaimFailureSignature(std::string_view signature);
+
+  // Adds `sample` to the shared corpus. Publishing a sample which is already in
+  // the corpus has no effect.
+  absl::Status PublishSample(const Sample& sample);
+
+  // Returns up to `max_count` samples published (by any fuzzer) since the last
+  // call. Each published sample is returned at most once per process; samples
+  // this process published itself are not returned. Unreadable entries, e.g.
+  // ones published by an incompatible version of the fuzzer, are skipped.
+  absl::StatusOr<std::vector<Sample>> FetchNewSamples(int64_t max_count);
+
+ private:
+  explicit SharedFuzzDirectory(std::filesystem::path root)
+      : root_(std::move(root)) {}
+
+  std::filesystem::path root_;
+
+  absl::Mutex mutex_;
+  // Names of the corpus entries this process published or fetched.
+  absl::flat_hash_set<std::string> seen_corpus_entries_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_SHARED_FUZZ_DIRECTORY_H_
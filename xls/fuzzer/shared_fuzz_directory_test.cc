@@ -0,0 +1,83 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/shared_fuzz_directory.h"
+
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/fuzzer/sample.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Property;
+
+TEST(SharedFuzzDirectoryTest, FailureSignatureIgnoresValuesAndPaths) {
+  EXPECT_EQ(FailureSignature(absl::InternalError(
+                "Miscompare for sample 3 in /tmp/run1/sample.ir: 0x1f != 7")),
+            FailureSignature(absl::InternalError(
+                "Miscompare for sample 12 in /tmp/run42/sample.ir: 0x0 != 3")));
+  EXPECT_NE(FailureSignature(absl::InternalError("Result miscompare")),
+            FailureSignature(absl::InternalError("Codegen failed")));
+  EXPECT_NE(FailureSignature(absl::InternalError("Failed")),
+            FailureSignature(absl::DeadlineExceededError("Failed")));
+}
+
+TEST(SharedFuzzDirectoryTest, ClaimFailureSignature) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SharedFuzzDirectory> a,
+                           SharedFuzzDirectory::Create(temp_dir.path()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SharedFuzzDirectory> b,
+                           SharedFuzzDirectory::Create(temp_dir.path()));
+  EXPECT_THAT(a->ClaimFailureSignature("abcd"), IsOkAndHolds(true));
+  EXPECT_THAT(b->ClaimFailureSignature("abcd"), IsOkAndHolds(false));
+  EXPECT_THAT(a->ClaimFailureSignature("abcd"), IsOkAndHolds(false));
+  EXPECT_THAT(b->ClaimFailureSignature("ef01"), IsOkAndHolds(true));
+}
+
+TEST(SharedFuzzDirectoryTest, ExchangesSamples) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SharedFuzzDirectory> a,
+                           SharedFuzzDirectory::Create(temp_dir.path()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SharedFuzzDirectory> b,
+                           SharedFuzzDirectory::Create(temp_dir.path()));
+  SampleOptions options;
+  options.set_input_is_dslx(true);
+  Sample sample("fn main(x: u8) -> u8 { x + u8:1 }", options, {});
+  XLS_ASSERT_OK(a->PublishSample(sample));
+  XLS_ASSERT_OK(a->PublishSample(sample));
+
+  // Samples are not returned to the process which published them, and are
+  // returned only once to every other process.
+  EXPECT_THAT(a->FetchNewSamples(10), IsOkAndHolds(IsEmpty()));
+  EXPECT_THAT(b->FetchNewSamples(10), IsOkAndHolds(ElementsAre(Property(
+                  &Sample::input_text, sample.input_text()))));
+  EXPECT_THAT(b->FetchNewSamples(10), IsOkAndHolds(IsEmpty()));
+
+  // Republishing a fetched sample does not make it new to anyone.
+  XLS_ASSERT_OK(b->PublishSample(sample));
+  EXPECT_THAT(a->FetchNewSamples(10), IsOkAndHolds(IsEmpty()));
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,148 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/validated_ir_cache.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+#include "openssl/sha.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "re2/re2.h"
+
+namespace xls {
+namespace {
+
+bool IsIdentifierChar(char c) {
+  return absl::ascii_isalnum(static_cast<unsigned char>(c)) || c == '_' ||
+         c == '.';
+}
+
+// Replaces every identifier in `line` which is a key of `names` with its
+// value.
+std::string RenameIdentifiers(
+    std::string_view line,
+    const absl::flat_hash_map<std::string, std::string>& names) {
+  std::string result;
+  result.reserve(line.size());
+  size_t i = 0;
+  while (i < line.size()) {
+    if (!IsIdentifierChar(line[i])) {
+      result.push_back(line[i++]);
+      continue;
+    }
+    size_t end = i;
+    while (end < line.size() && IsIdentifierChar(line[end])) {
+      ++end;
+    }
+    std::string_view token = line.substr(i, end - i);
+    auto it = names.find(token);
+    absl::StrAppend(&result, it == names.end() ? token : it->second);
+    i = end;
+  }
+  return result;
+}
+
+}  // namespace
+
+absl::StatusOr<std::string> CanonicalizeIr(std::string_view ir_text) {
+  // Round-trip through the parser so formatting differences disappear.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text));
+  std::string dumped = package->DumpIr();
+
+  static const LazyRE2 kNodeDefinition = {
+      R"(^\s*(?:ret\s+)?([A-Za-z_][A-Za-z0-9_.]*): .*? = ([a-z_]+)\()"};
+  std::vector<std::string_view> lines;
+  absl::flat_hash_map<std::string, std::string> names;
+  for (std::string_view line : absl::StrSplit(dumped, '\n')) {
+    // File numbers name the (run directory specific) source files.
+    if (absl::StartsWith(line, "file_number ")) {
+      continue;
+    }
+    lines.push_back(line);
+    std::string name;
+    std::string op;
+    if (RE2::PartialMatch(line, *kNodeDefinition, &name, &op) &&
+        op != "param") {
+      names.emplace(name, absl::StrCat("n", names.size()));
+    }
+  }
+
+  std::string canonical;
+  for (std::string_view line : lines) {
+    std::string renamed = RenameIdentifiers(line, names);
+    // Source locations follow the ids, so strip them first.
+    RE2::GlobalReplace(&renamed, R"(, pos=\[[^\]]*\])", "");
+    RE2::GlobalReplace(&renamed, R"(\(id=[0-9]+\))", "()");
+    RE2::GlobalReplace(&renamed, R"(\(id=[0-9]+, )", "(");
+    RE2::GlobalReplace(&renamed, R"((, | )id=[0-9]+)", "");
+    absl::StrAppend(&canonical, renamed, "\n");
+  }
+  return canonical;
+}
+
+/* static */ absl::StatusOr<std::string> ValidatedIrCache::GetKey(
+    std::string_view opt_ir_text, const SampleOptions& options) {
+  XLS_ASSIGN_OR_RETURN(std::string canonical, CanonicalizeIr(opt_ir_text));
+  std::string key_text = absl::StrCat(
+      canonical, "\ncodegen_args: ", absl::StrJoin(options.codegen_args(), " "),
+      "\nuse_system_verilog: ", options.use_system_verilog(),
+      "\nsimulate: ", options.simulate(), "\nsimulator: ", options.simulator());
+  std::array<char, SHA256_DIGEST_LENGTH> digest;
+  SHA256(reinterpret_cast<const uint8_t*>(key_text.data()), key_text.size(),
+         reinterpret_cast<uint8_t*>(digest.data()));
+  return absl::BytesToHexString({digest.data(), digest.size()});
+}
+
+bool ValidatedIrCache::Contains(std::string_view key) const {
+  absl::MutexLock lock(&mutex_);
+  return keys_.contains(key);
+}
+
+void ValidatedIrCache::Insert(std::string_view key) {
+  absl::MutexLock lock(&mutex_);
+  if (max_size_ <= 0 || !keys_.emplace(key).second) {
+    return;
+  }
+  order_.emplace_back(key);
+  if (order_.size() > max_size_) {
+    keys_.erase(order_.front());
+    order_.pop_front();
+  }
+}
+
+int64_t ValidatedIrCache::size() const {
+  absl::MutexLock lock(&mutex_);
+  return keys_.size();
+}
+
+}  // namespace xls
@@ -0,0 +1,68 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_VALIDATED_IR_CACHE_H_
+#define XLS_FUZZER_VALIDATED_IR_CACHE_H_
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/fuzzer/sample.h"
+
+namespace xls {
+
+// Returns a canonical form of the IR package `ir_text` in which node names,
+// node ids and source locations are replaced or removed, so IR which differs
+// only in those (e.g. the optimized IR of different samples which optimized to
+// the same graph) has the same canonical form. Parameter, function and channel
+// names are kept as they determine the interface of the generated Verilog.
+absl::StatusOr<std::string> CanonicalizeIr(std::string_view ir_text);
+
+// A bounded set of (optimized IR, codegen/simulation options) combinations for
+// which code generation and Verilog simulation have already been run and
+// agreed with the other evaluations of a sample. The sample runner skips the
+// expensive backends for samples whose optimized IR is already in the set.
+// When full, inserting evicts the oldest entry. Thread-safe, so a single cache
+// can be shared by all fuzzing workers.
+class ValidatedIrCache {
+ public:
+  explicit ValidatedIrCache(int64_t max_size = 4096) : max_size_(max_size) {}
+
+  // Returns the key identifying the backend run of the optimized IR
+  // `opt_ir_text` with the codegen and simulation settings of `options`.
+  static absl::StatusOr<std::string> GetKey(std::string_view opt_ir_text,
+                                            const SampleOptions& options);
+
+  bool Contains(std::string_view key) const;
+  void Insert(std::string_view key);
+
+  int64_t size() const;
+
+ private:
+  int64_t max_size_;
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_set<std::string> keys_ ABSL_GUARDED_BY(mutex_);
+  // Keys in insertion order, for eviction.
+  std::deque<std::string> order_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_VALIDATED_IR_CACHE_H_
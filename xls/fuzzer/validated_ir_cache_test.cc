@@ -0,0 +1,105 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/validated_ir_cache.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/fuzzer/sample.h"
+
+namespace xls {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+constexpr std::string_view kIr = R"(package sample
+
+file_number 0 "/tmp/run1/sample.x"
+
+top fn __sample__main(x: bits[8] id=1, y: bits[8] id=2) -> bits[8] {
+  add.3: bits[8] = add(x, y, id=3, pos=[(0,0,30)])
+  literal.4: bits[8] = literal(value=1, id=4)
+  ret sub.5: bits[8] = sub(add.3, literal.4, id=5)
+}
+)";
+
+// As kIr, but with different node names and ids.
+constexpr std::string_view kRenamedIr = R"(package sample
+
+file_number 0 "/tmp/run2/sample.x"
+
+top fn __sample__main(x: bits[8] id=7, y: bits[8] id=8) -> bits[8] {
+  sum: bits[8] = add(x, y, id=10, pos=[(0,0,12)])
+  one: bits[8] = literal(value=1, id=11)
+  ret result: bits[8] = sub(sum, one, id=42)
+}
+)";
+
+// As kIr, but the operands of the add are swapped.
+constexpr std::string_view kDifferentIr = R"(package sample
+
+top fn __sample__main(x: bits[8] id=1, y: bits[8] id=2) -> bits[8] {
+  add.3: bits[8] = add(y, x, id=3)
+  literal.4: bits[8] = literal(value=1, id=4)
+  ret sub.5: bits[8] = sub(add.3, literal.4, id=5)
+}
+)";
+
+TEST(ValidatedIrCacheTest, CanonicalizeIr) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::string canonical, CanonicalizeIr(kIr));
+  EXPECT_THAT(canonical, HasSubstr("n0: bits[8] = add(x, y)"));
+  EXPECT_THAT(canonical, Not(HasSubstr("id=")));
+  EXPECT_THAT(canonical, Not(HasSubstr("pos=")));
+  EXPECT_THAT(canonical, Not(HasSubstr("/tmp")));
+  EXPECT_THAT(CanonicalizeIr(kRenamedIr),
+              status_testing::IsOkAndHolds(canonical));
+  EXPECT_THAT(CanonicalizeIr(kDifferentIr),
+              status_testing::IsOkAndHolds(Not(canonical)));
+}
+
+TEST(ValidatedIrCacheTest, KeyDependsOnCodegenOptions) {
+  SampleOptions options;
+  options.set_codegen(true);
+  options.set_codegen_args({"--generator=combinational"});
+  XLS_ASSERT_OK_AND_ASSIGN(std::string key,
+                           ValidatedIrCache::GetKey(kIr, options));
+  EXPECT_THAT(ValidatedIrCache::GetKey(kRenamedIr, options),
+              status_testing::IsOkAndHolds(key));
+
+  SampleOptions pipelined = options;
+  pipelined.set_codegen_args({"--generator=pipeline", "--pipeline_stages=2"});
+  EXPECT_THAT(ValidatedIrCache::GetKey(kIr, pipelined),
+              status_testing::IsOkAndHolds(Not(key)));
+}
+
+TEST(ValidatedIrCacheTest, EvictsOldestEntry) {
+  ValidatedIrCache cache(/*max_size=*/2);
+  cache.Insert("a");
+  cache.Insert("b");
+  cache.Insert("a");
+  EXPECT_TRUE(cache.Contains("a"));
+  EXPECT_TRUE(cache.Contains("b"));
+  cache.Insert("c");
+  EXPECT_FALSE(cache.Contains("a"));
+  EXPECT_TRUE(cache.Contains("b"));
+  EXPECT_TRUE(cache.Contains("c"));
+  EXPECT_EQ(cache.size(), 2);
+}
+
+}  // namespace
+}  // namespace xls
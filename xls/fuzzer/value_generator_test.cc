@@ -24,6 +24,7 @@
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dslx/frontend/ast.h"
+#include "xls/ir/bits.h"
 
 namespace xls {
 namespace {
@@ -177,6 +178,24 @@ TEST(SampleGeneratorTest, RngRandomDouble) {
   }
 }
 
+TEST(SampleGeneratorTest, GenerateWideBitsCoversAllWords) {
+  // Random bit patterns are filled a word at a time; make sure every word,
+  // including the partial top word, receives set bits and that no bits are set
+  // beyond the requested width.
+  constexpr int64_t kBitCount = 150;
+  ValueGenerator value_gen(std::mt19937_64{42});
+  std::vector<bool> bit_seen(kBitCount);
+  for (int64_t i = 0; i < kIterations; ++i) {
+    Bits bits = value_gen.GenerateBits(kBitCount);
+    ASSERT_EQ(bits.bit_count(), kBitCount);
+    for (int64_t j = 0; j < kBitCount; ++j) {
+      bit_seen[j] = bit_seen[j] || bits.Get(j);
+    }
+  }
+  EXPECT_TRUE(std::all_of(bit_seen.begin(), bit_seen.end(),
+                          [](bool seen) { return seen; }));
+}
+
 TEST(SampleGeneratorTest, GenerateEmptyValues) {
   ValueGenerator value_gen(std::mt19937_64{});
 
@@ -15,10 +15,12 @@
 #ifndef XLS_INTERPRETER_BLOCK_INTERPRETER_H_
 #define XLS_INTERPRETER_BLOCK_INTERPRETER_H_
 
+#include <cstdint>
 #include <optional>
 #include <random>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -29,6 +31,7 @@
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/ir/block.h"
 #include "xls/ir/events.h"
+#include "xls/ir/type.h"
 #include "xls/ir/value.h"
 
 namespace xls {
@@ -73,6 +76,23 @@ InterpretSequentialBlock(
     Block* block,
     absl::Span<const absl::flat_hash_map<std::string, uint64_t>> inputs);
 
+// Returns the position of the input (output) port named `name` in
+// Block::GetInputPorts() (Block::GetOutputPorts()). These are the indices used
+// by the columnar interfaces below.
+absl::StatusOr<int64_t> GetInputPortIndex(Block* block, std::string_view name);
+absl::StatusOr<int64_t> GetOutputPortIndex(Block* block, std::string_view name);
+
+// Columnar variant of InterpretSequentialBlock. `inputs` holds one column per
+// input port, in Block::GetInputPorts() order, and each column holds the value
+// of that port for each of the `cycle_count` cycles. The returned vector holds
+// one column per output port, in Block::GetOutputPorts() order. Ports are
+// resolved once rather than looked up by name every cycle, which makes this
+// the preferred interface for long simulations.
+absl::StatusOr<std::vector<std::vector<Value>>>
+InterpretSequentialBlockColumnar(Block* block,
+                                 absl::Span<const std::vector<Value>> inputs,
+                                 int64_t cycle_count);
+
 // Drives input channel simulation for testing blocks.
 //
 // For each successive input, new data is driven after a randomized delay.
@@ -124,6 +144,16 @@ class ChannelSource {
       int64_t this_cycle,
       const absl::flat_hash_map<std::string, Value>& outputs);
 
+  // Variants of SetBlockInputs() and GetBlockOutputs() which take the port
+  // values of a single cycle indexed by port position (see
+  // GetInputPortIndex() and GetOutputPortIndex()). reset_asserted indicates
+  // whether the block's reset is asserted during this_cycle.
+  absl::Status SetBlockInputs(int64_t this_cycle, absl::Span<Value> inputs,
+                              std::minstd_rand& random_engine,
+                              bool reset_asserted);
+  absl::Status GetBlockOutputs(int64_t this_cycle,
+                               absl::Span<const Value> outputs);
+
   // Source has transferred all data to the block.
   bool AllDataSent() const { return !HasMoreData() && !is_valid_; }
 
@@ -133,6 +163,13 @@ class ChannelSource {
     return current_index_ + 1 < data_sequence_.size();
   }
 
+  // Returns the values to drive on the data and valid ports this cycle.
+  absl::StatusOr<std::pair<Value, Value>> NextDataAndValid(
+      std::minstd_rand& random_engine, bool reset_asserted);
+
+  // Resolves the port indices used by the index-based interface.
+  absl::Status ResolvePortIndices();
+
   std::string data_name_;
   std::string valid_name_;
   std::string ready_name_;
@@ -143,6 +180,15 @@ class ChannelSource {
 
   BehaviorDuringReset reset_behavior_;
 
+  // Type of the data port, resolved on first use.
+  Type* data_type_ = nullptr;
+
+  // Port positions, resolved on first use of the index-based interface.
+  bool port_indices_resolved_ = false;
+  int64_t data_index_ = -1;
+  int64_t valid_index_ = -1;
+  int64_t ready_index_ = -1;
+
   // Data sequence to be sent.
   // Only one of data_sequence_ and data_sequence_as_uint64_ is used,
   // depending on which constructor was called.
@@ -196,6 +242,14 @@ class ChannelSink {
       int64_t this_cycle,
       const absl::flat_hash_map<std::string, Value>& outputs);
 
+  // Index-based variants of SetBlockInputs() and GetBlockOutputs(); see
+  // ChannelSource.
+  absl::Status SetBlockInputs(int64_t this_cycle, absl::Span<Value> inputs,
+                              std::minstd_rand& random_engine,
+                              bool reset_asserted);
+  absl::Status GetBlockOutputs(int64_t this_cycle,
+                               absl::Span<const Value> outputs);
+
   // Returns the sequence of values read from the block.
   absl::StatusOr<std::vector<uint64_t>> GetOutputSequenceAsUint64() const;
   absl::Span<const Value> GetOutputSequence() const { return data_sequence_; }
@@ -208,6 +262,15 @@ class ChannelSink {
   }
 
  private:
+  // Updates is_ready_ given the ready value driven this cycle.
+  void UpdateReady(bool signalled_ready, bool reset_asserted);
+
+  // Records the data received this cycle, if any.
+  void RecordOutput(bool valid, const Value* data);
+
+  // Resolves the port indices used by the index-based interface.
+  absl::Status ResolvePortIndices();
+
   std::string data_name_;
   std::string valid_name_;
   std::string ready_name_;
@@ -217,6 +280,12 @@ class ChannelSink {
 
   BehaviorDuringReset reset_behavior_;
 
+  // Port positions, resolved on first use of the index-based interface.
+  bool port_indices_resolved_ = false;
+  int64_t data_index_ = -1;
+  int64_t valid_index_ = -1;
+  int64_t ready_index_ = -1;
+
   bool is_ready_ = false;             // Ready is asserted.
   std::vector<Value> data_sequence_;  // Data sequence received.
   std::vector<std::optional<Value>>
@@ -233,6 +302,17 @@ struct BlockIOResultsAsUint64 {
   std::vector<absl::flat_hash_map<std::string, uint64_t>> outputs;
 };
 
+// Columnar form of BlockIOResults. inputs[i][c] (outputs[i][c]) is the value of
+// the i-th input (output) port of the block at cycle c.
+struct BlockColumnarIOResults {
+  std::vector<std::vector<Value>> inputs;
+  std::vector<std::vector<Value>> outputs;
+
+  // Number of cycles whose outputs were reused rather than evaluated because
+  // the block was idle (see InterpretChannelizedSequentialBlockColumnar).
+  int64_t idle_cycles_skipped = 0;
+};
+
 // Runs the interpreter on a block.  Each input port in the block
 // should be given a sequence of data values to drive the block.
 //
@@ -251,6 +331,25 @@ absl::StatusOr<BlockIOResults> InterpretChannelizedSequentialBlock(
     absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
     std::optional<verilog::ResetProto> reset = std::nullopt, int64_t seed = 0);
 
+// Columnar variant of InterpretChannelizedSequentialBlock which runs the block
+// for `cycle_count` cycles. `inputs` holds one column per input port, in
+// Block::GetInputPorts() order. Columns of ports driven by a channel source or
+// sink are left empty; every other column must hold `cycle_count` values.
+// Produces the same results as InterpretChannelizedSequentialBlock given the
+// same seed.
+//
+// Idle cycles are not evaluated: once a cycle leaves every register
+// unchanged, the outputs for its input values are remembered, and following
+// cycles with the same register state and input values reuse them. The channel
+// sources and sinks still run every cycle so results are unaffected. This
+// makes long simulations with sparse stimulus (low source lambda) cheap.
+absl::StatusOr<BlockColumnarIOResults>
+InterpretChannelizedSequentialBlockColumnar(
+    Block* block, absl::Span<ChannelSource> channel_sources,
+    absl::Span<ChannelSink> channel_sinks,
+    std::vector<std::vector<Value>> inputs, int64_t cycle_count,
+    std::optional<verilog::ResetProto> reset = std::nullopt, int64_t seed = 0);
+
 // Variant which accepts and returns uint64_t values instead of xls::Values.
 absl::StatusOr<BlockIOResultsAsUint64>
 InterpretChannelizedSequentialBlockWithUint64(
@@ -15,6 +15,7 @@
 #include "xls/interpreter/channel_queue.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string_view>
@@ -23,6 +24,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value_helpers.h"
@@ -31,7 +33,7 @@ namespace xls {
 
 absl::Status ChannelQueue::AttachGenerator(GeneratorFn generator) {
   absl::MutexLock lock(&mutex_);
-  if (generator_.has_value()) {
+  if (generator_.has_value() || batch_generator_.has_value()) {
     return absl::InternalError("ChannelQueue already has a generator attached");
   }
   if (channel_->kind() == ChannelKind::kSingleValue) {
@@ -44,19 +46,57 @@ absl::Status ChannelQueue::AttachGenerator(GeneratorFn generator) {
   return absl::OkStatus();
 }
 
-absl::Status ChannelQueue::Write(const Value& value) {
-  XLS_VLOG(4) << absl::StreamFormat("Writing value to channel %s: { %s }",
-                                    channel_->name(), value.ToString());
+absl::Status ChannelQueue::AttachBatchGenerator(BatchGeneratorFn generator,
+                                                int64_t batch_size) {
+  XLS_RET_CHECK_GT(batch_size, 0);
   absl::MutexLock lock(&mutex_);
-  if (generator_.has_value()) {
+  if (generator_.has_value() || batch_generator_.has_value()) {
+    return absl::InternalError("ChannelQueue already has a generator attached");
+  }
+  if (channel_->kind() == ChannelKind::kSingleValue) {
     return absl::InternalError(
-        "Cannot write to ChannelQueue because it has a generator function.");
+        absl::StrFormat("ChannelQueues for single-value channels cannot have a "
+                        "generator. Channel: %s",
+                        channel()->name()));
+  }
+  batch_generator_ = std::move(generator);
+  batch_size_ = batch_size;
+  return absl::OkStatus();
+}
+
+void ChannelQueue::CallGenerator() {
+  if (generator_.has_value()) {
+    std::optional<Value> generated_value = (*generator_)();
+    if (generated_value.has_value()) {
+      WriteInternal(generated_value.value());
+    }
+    return;
+  }
+  if (batch_generator_.has_value() && GetSizeInternal() == 0) {
+    for (const Value& value : (*batch_generator_)(batch_size_)) {
+      WriteInternal(value);
+    }
   }
+}
+
+absl::Status ChannelQueue::CheckValueType(const Value& value) const {
   if (!ValueConformsToType(value, channel_->type())) {
     return absl::InvalidArgumentError(absl::StrFormat(
         "Channel %s expects values to have type %s, got: %s", channel_->name(),
         channel_->type()->ToString(), value.ToString()));
   }
+  return absl::OkStatus();
+}
+
+absl::Status ChannelQueue::Write(const Value& value) {
+  XLS_VLOG(4) << absl::StreamFormat("Writing value to channel %s: { %s }",
+                                    channel_->name(), value.ToString());
+  absl::MutexLock lock(&mutex_);
+  if (generator_.has_value() || batch_generator_.has_value()) {
+    return absl::InternalError(
+        "Cannot write to ChannelQueue because it has a generator function.");
+  }
+  XLS_RETURN_IF_ERROR(CheckValueType(value));
 
   WriteInternal(value);
   XLS_VLOG(4) << absl::StreamFormat("Channel now has %d elements",
@@ -64,6 +104,23 @@ absl::Status ChannelQueue::Write(const Value& value) {
   return absl::OkStatus();
 }
 
+absl::Status ChannelQueue::WriteBatch(absl::Span<const Value> values) {
+  XLS_VLOG(4) << absl::StreamFormat("Writing %d values to channel %s",
+                                    values.size(), channel_->name());
+  absl::MutexLock lock(&mutex_);
+  if (generator_.has_value() || batch_generator_.has_value()) {
+    return absl::InternalError(
+        "Cannot write to ChannelQueue because it has a generator function.");
+  }
+  for (const Value& value : values) {
+    XLS_RETURN_IF_ERROR(CheckValueType(value));
+  }
+  for (const Value& value : values) {
+    WriteInternal(value);
+  }
+  return absl::OkStatus();
+}
+
 void ChannelQueue::WriteInternal(const Value& value) {
   if (channel()->kind() == ChannelKind::kSingleValue) {
     if (queue_.empty()) {
@@ -80,14 +137,9 @@ void ChannelQueue::WriteInternal(const Value& value) {
 
 std::optional<Value> ChannelQueue::Read() {
   absl::MutexLock lock(&mutex_);
-  if (generator_.has_value()) {
-    // Write/ReadInternal are virtual and may have other side-effects so rather
-    // than directly returning the generated value, write then read it.
-    std::optional<Value> generated_value = (*generator_)();
-    if (generated_value.has_value()) {
-      WriteInternal(generated_value.value());
-    }
-  }
+  // Write/ReadInternal are virtual and may have other side-effects so rather
+  // than directly returning the generated value, write then read it.
+  CallGenerator();
   std::optional<Value> value = ReadInternal();
   XLS_VLOG(4) << absl::StreamFormat(
       "Reading data from channel %s: %s", channel_->name(),
@@ -97,6 +149,25 @@ std::optional<Value> ChannelQueue::Read() {
   return value;
 }
 
+std::vector<Value> ChannelQueue::ReadAll() {
+  absl::MutexLock lock(&mutex_);
+  std::vector<Value> values;
+  if (channel()->kind() == ChannelKind::kSingleValue) {
+    std::optional<Value> value = ReadInternal();
+    if (value.has_value()) {
+      values.push_back(std::move(value).value());
+    }
+    return values;
+  }
+  values.reserve(GetSizeInternal());
+  while (std::optional<Value> value = ReadInternal()) {
+    values.push_back(std::move(value).value());
+  }
+  XLS_VLOG(4) << absl::StreamFormat("Read %d values from channel %s",
+                                    values.size(), channel_->name());
+  return values;
+}
+
 int64_t ChannelQueue::GetSizeInternal() const { return queue_.size(); }
 
 std::optional<Value> ChannelQueue::ReadInternal() {
@@ -174,6 +245,21 @@ ChannelQueueManager::ChannelQueueManager(
             });
 }
 
+absl::Status ChannelQueueManager::BoundQueuesToFifoDepth() {
+  for (ChannelQueue* queue : queue_vec_) {
+    StreamingChannel* channel =
+        dynamic_cast<StreamingChannel*>(queue->channel());
+    if (channel == nullptr ||
+        channel->supported_ops() != ChannelOps::kSendReceive ||
+        !channel->GetFifoDepth().has_value()) {
+      continue;
+    }
+    XLS_RETURN_IF_ERROR(queue->SetCapacity(
+        std::max(channel->GetFifoDepth().value(), int64_t{1})));
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<ChannelQueue*> ChannelQueueManager::GetQueueById(
     int64_t channel_id) {
   XLS_ASSIGN_OR_RETURN(Channel * channel, package_->GetChannel(channel_id));
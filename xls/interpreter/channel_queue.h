@@ -15,6 +15,8 @@
 #ifndef XLS_INTERPRETER_CHANNEL_QUEUE_H_
 #define XLS_INTERPRETER_CHANNEL_QUEUE_H_
 
+#include <algorithm>
+#include <cstdint>
 #include <deque>
 #include <functional>
 #include <memory>
@@ -25,6 +27,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
@@ -58,19 +61,68 @@ class ChannelQueue {
   // Returns whether the channel queue is empty.
   bool IsEmpty() const { return GetSize() == 0; }
 
+  // Returns the maximum number of elements procs may send on the channel
+  // before their sends block, or std::nullopt if the queue is unbounded (the
+  // default). Writes from outside the proc network via `Write` are not
+  // limited by the capacity. Only the proc interpreter blocks sends on a full
+  // queue, so queues read and written by JIT-compiled procs return an error
+  // when bounded.
+  std::optional<int64_t> capacity() const {
+    absl::MutexLock lock(&mutex_);
+    return capacity_;
+  }
+  virtual absl::Status SetCapacity(std::optional<int64_t> capacity) {
+    absl::MutexLock lock(&mutex_);
+    capacity_ = capacity;
+    return absl::OkStatus();
+  }
+
+  // Returns whether the queue is bounded and holds at least `capacity()`
+  // elements, i.e., whether a send on the channel must block.
+  bool IsFull() const {
+    absl::MutexLock lock(&mutex_);
+    return capacity_.has_value() && GetSizeInternal() >= *capacity_;
+  }
+
   // Writes the given value on to the channel.
   absl::Status Write(const Value& value);
 
+  // Writes the given values on to the channel in order while holding the queue
+  // lock once. No value is written if any of them does not match the channel
+  // type.
+  absl::Status WriteBatch(absl::Span<const Value> values);
+
   // Reads and returns a value from the channel. Returns an std::nullopt if
   // the channel is empty.
   std::optional<Value> Read();
 
+  // Reads and returns all values currently in the channel, oldest first, while
+  // holding the queue lock once. Generators are not invoked. As with `Read`,
+  // the value of a single-value channel is returned but not consumed.
+  std::vector<Value> ReadAll();
+
   // Attaches a function which generates values for the channel. The generator
   // is called when a value is needed for reading. If a generator is attached
   // then calling `Write` returns an error.
   using GeneratorFn = std::function<std::optional<Value>()>;
   absl::Status AttachGenerator(GeneratorFn generator);
 
+  // Attaches a function which generates values for the channel in batches.
+  // When a value is needed for reading and the queue is empty, the generator
+  // is called with `batch_size` and returns up to that many values which are
+  // all added to the queue. Returning no values indicates that the generator
+  // has no data at present. This amortizes the cost of calling the generator
+  // over many reads. Otherwise behaves as `AttachGenerator`.
+  using BatchGeneratorFn = std::function<std::vector<Value>(int64_t)>;
+  absl::Status AttachBatchGenerator(BatchGeneratorFn generator,
+                                    int64_t batch_size);
+
+  // Returns whether a generator is attached to the queue.
+  bool HasGenerator() const {
+    absl::MutexLock lock(&mutex_);
+    return generator_.has_value() || batch_generator_.has_value();
+  }
+
  protected:
   mutable absl::Mutex mutex_;
 
@@ -79,17 +131,30 @@ class ChannelQueue {
       ABSL_SHARED_LOCKS_REQUIRED(mutex_);
   virtual std::optional<Value> ReadInternal()
       ABSL_SHARED_LOCKS_REQUIRED(mutex_);
+
+  // Calls the attached generator, if any, to supply the value for the next
+  // read. Queues which are not thread-safe call this without holding the lock.
+  void CallGenerator() ABSL_SHARED_LOCKS_REQUIRED(mutex_);
+
+  // Returns an error if `value` does not conform to the channel type.
+  absl::Status CheckValueType(const Value& value) const;
+
   Channel* channel_;
 
   std::deque<Value> queue_ ABSL_GUARDED_BY(mutex_);
+  std::optional<int64_t> capacity_ ABSL_GUARDED_BY(mutex_);
   // The ThreadUnsafeJitChannelQueue reads this value without a lock.
   // TODO(meheff): 2022/09/27 Fix this, potentially by obviating the need for
   // the thread-unsafe version of the queue.
   std::optional<GeneratorFn> generator_ ABSL_GUARDED_BY_FIXME(mutex_);
+  std::optional<BatchGeneratorFn> batch_generator_
+      ABSL_GUARDED_BY_FIXME(mutex_);
+  int64_t batch_size_ ABSL_GUARDED_BY_FIXME(mutex_) = 0;
 };
 
 // A functor which returns a sequence of Values when called. Maybe be attached
-// to a ChannelQueue as a generator.
+// to a ChannelQueue as a generator or, through the overload taking a count, as
+// a batch generator.
 class FixedValueGenerator {
  public:
   explicit FixedValueGenerator(absl::Span<const Value> values)
@@ -104,6 +169,13 @@ class FixedValueGenerator {
     return std::move(value);
   }
 
+  std::vector<Value> operator()(int64_t max_count) {
+    int64_t count = std::min(max_count, static_cast<int64_t>(values_.size()));
+    std::vector<Value> values(values_.begin(), values_.begin() + count);
+    values_.erase(values_.begin(), values_.begin() + count);
+    return values;
+  }
+
  private:
   std::deque<Value> values_;
 };
@@ -133,6 +205,14 @@ class ChannelQueueManager {
   absl::StatusOr<ChannelQueue*> GetQueueById(int64_t channel_id);
   absl::StatusOr<ChannelQueue*> GetQueueByName(std::string_view name);
 
+  // Bounds the queue of each channel which is both sent and received within
+  // the package to the FIFO depth of the channel, so that sends block (and the
+  // sending proc yields) when the FIFO is full as they would in hardware. A
+  // FIFO depth of zero (a direct connection) is modeled with a capacity of
+  // one. Channels without a FIFO depth stay unbounded. Returns an error if a
+  // queue can't be bounded (see ChannelQueue::SetCapacity).
+  absl::Status BoundQueuesToFifoDepth();
+
  protected:
   ChannelQueueManager(Package* package,
                       std::vector<std::unique_ptr<ChannelQueue>>&& queues);
@@ -14,6 +14,9 @@
 
 #include "xls/interpreter/channel_queue_test_base.h"
 
+#include <cstdint>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
@@ -26,7 +29,9 @@ namespace xls {
 namespace {
 
 using status_testing::StatusIs;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
+using ::testing::IsEmpty;
 using ::testing::Optional;
 
 TEST_P(ChannelQueueTestBase, FifoChannelQueueTest) {
@@ -159,6 +164,70 @@ TEST_P(ChannelQueueTestBase, EmptyGenerator) {
   EXPECT_EQ(queue->Read(), std::nullopt);
 }
 
+TEST_P(ChannelQueueTestBase, BatchGenerator) {
+  Package package(TestName());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kReceiveOnly,
+                                     package.GetBitsType(32)));
+  auto queue = GetParam().CreateQueue(channel);
+  int64_t call_count = 0;
+  int64_t counter = 0;
+  XLS_ASSERT_OK(queue->AttachBatchGenerator(
+      [&](int64_t max_count) {
+        ++call_count;
+        std::vector<Value> values;
+        for (int64_t i = 0; i < max_count && counter < 5; ++i) {
+          values.push_back(Value(UBits(counter++, 32)));
+        }
+        return values;
+      },
+      /*batch_size=*/3));
+  EXPECT_TRUE(queue->HasGenerator());
+  EXPECT_THAT(queue->AttachGenerator(
+                  []() -> std::optional<Value> { return std::nullopt; }),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("already has a generator")));
+
+  for (int64_t i = 0; i < 5; ++i) {
+    EXPECT_THAT(queue->Read(), Optional(Value(UBits(i, 32))));
+  }
+  // The five values were produced by two calls of the generator.
+  EXPECT_EQ(call_count, 2);
+  EXPECT_EQ(queue->Read(), std::nullopt);
+  EXPECT_EQ(call_count, 3);
+
+  EXPECT_THAT(queue->WriteBatch({Value(UBits(22, 32))}),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Cannot write to ChannelQueue because it has "
+                                 "a generator function")));
+}
+
+TEST_P(ChannelQueueTestBase, WriteBatchAndReadAll) {
+  Package package(TestName());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  auto queue = GetParam().CreateQueue(channel);
+  EXPECT_THAT(queue->ReadAll(), IsEmpty());
+
+  XLS_ASSERT_OK(queue->WriteBatch(
+      {Value(UBits(1, 32)), Value(UBits(2, 32)), Value(UBits(3, 32))}));
+  EXPECT_EQ(queue->GetSize(), 3);
+  XLS_ASSERT_OK(queue->Write(Value(UBits(4, 32))));
+  EXPECT_THAT(queue->ReadAll(),
+              ElementsAre(Value(UBits(1, 32)), Value(UBits(2, 32)),
+                          Value(UBits(3, 32)), Value(UBits(4, 32))));
+  EXPECT_TRUE(queue->IsEmpty());
+
+  // A batch containing a value of the wrong type is rejected as a whole.
+  EXPECT_THAT(queue->WriteBatch({Value(UBits(5, 32)), Value(UBits(6, 16))}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("expects values to have type bits[32]")));
+  EXPECT_TRUE(queue->IsEmpty());
+}
+
 TEST_P(ChannelQueueTestBase, ChannelWithEmptyTuple) {
   Package package(TestName());
   XLS_ASSERT_OK_AND_ASSIGN(
@@ -21,6 +21,7 @@
 #include "absl/status/status.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/keyword_args.h"
+#include "xls/ir/node_iterator.h"
 
 namespace xls {
 namespace {
@@ -28,8 +29,11 @@ namespace {
 // An interpreter for XLS functions.
 class FunctionInterpreter : public IrInterpreter {
  public:
-  explicit FunctionInterpreter(absl::Span<const Value> args)
-      : args_(args.begin(), args.end()) {}
+  // `args` must outlive the interpreter.
+  explicit FunctionInterpreter(absl::Span<const Value> args) : args_(args) {}
+  FunctionInterpreter(absl::Span<const Value> args, const NodeSlots* slots,
+                      NodeValueFrame* frame)
+      : IrInterpreter(slots, frame), args_(args) {}
 
   absl::Status HandleParam(Param* param) override {
     XLS_ASSIGN_OR_RETURN(int64_t index,
@@ -43,15 +47,12 @@ class FunctionInterpreter : public IrInterpreter {
   }
 
  private:
-  // The arguments to the Function being evaluated indexed by parameter name.
-  std::vector<Value> args_;
+  // The arguments to the Function being evaluated indexed by parameter number.
+  absl::Span<const Value> args_;
 };
 
-}  // namespace
-
-absl::StatusOr<InterpreterResult<Value>> InterpretFunction(
-    Function* function, absl::Span<const Value> args) {
-  XLS_VLOG(3) << "Interpreting function " << function->name();
+// Returns an error if `args` are not valid arguments of `function`.
+absl::Status VerifyArgs(Function* function, absl::Span<const Value> args) {
   if (args.size() != function->params().size()) {
     return absl::InvalidArgumentError(absl::StrFormat(
         "Function %s wants %d arguments, got %d.", function->name(),
@@ -68,7 +69,18 @@ absl::StatusOr<InterpreterResult<Value>> InterpretFunction(
           value.ToString(), argno, param_type->ToString()));
     }
   }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<InterpreterResult<Value>> InterpretFunction(
+    Function* function, absl::Span<const Value> args,
+    InvocationCache* invocation_cache) {
+  XLS_VLOG(3) << "Interpreting function " << function->name();
+  XLS_RETURN_IF_ERROR(VerifyArgs(function, args));
   FunctionInterpreter visitor(args);
+  visitor.SetInvocationCache(invocation_cache);
   XLS_RETURN_IF_ERROR(function->Accept(&visitor));
   Value result = visitor.ResolveAsValue(function->return_value());
   XLS_VLOG(2) << "Result = " << result;
@@ -86,4 +98,24 @@ absl::StatusOr<InterpreterResult<Value>> InterpretFunctionKwargs(
   return InterpretFunction(function, positional_args);
 }
 
+FunctionInterpreterPlan::FunctionInterpreterPlan(Function* function)
+    : function_(function),
+      execution_order_(TopoSort(function).AsVector()),
+      slots_(execution_order_),
+      frame_(slots_.size()) {}
+
+absl::StatusOr<InterpreterResult<Value>> FunctionInterpreterPlan::Run(
+    absl::Span<const Value> args) {
+  XLS_RETURN_IF_ERROR(VerifyArgs(function_, args));
+  frame_.Clear();
+  FunctionInterpreter visitor(args, &slots_, &frame_);
+  for (Node* node : execution_order_) {
+    XLS_RETURN_IF_ERROR(node->VisitSingleNode(&visitor));
+  }
+  Value result = visitor.ResolveAsValue(function_->return_value());
+  XLS_VLOG(2) << "Result = " << result;
+  return InterpreterResult<Value>{std::move(result),
+                                  std::move(visitor.GetInterpreterEvents())};
+}
+
 }  // namespace xls
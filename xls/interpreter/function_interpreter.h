@@ -16,28 +16,60 @@
 #define XLS_INTERPRETER_FUNCTION_INTERPRETER_H_
 
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/interpreter/invocation_cache.h"
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/ir/function.h"
+#include "xls/ir/node.h"
 #include "xls/ir/value.h"
 
 namespace xls {
 
 // Runs the interpreter on the given function. 'args' are the argument values
 // indexed by parameter name. Returns both the value and any events that
-// happened while running.
+// happened while running. If `invocation_cache` is non-null, the results of
+// side-effect-free functions called through invoke and map nodes are memoized
+// in it.
 absl::StatusOr<InterpreterResult<Value>> InterpretFunction(
-    Function* function, absl::Span<const Value> args);
+    Function* function, absl::Span<const Value> args,
+    InvocationCache* invocation_cache = nullptr);
 
 // Runs the interpreter on the function where the arguments are given by name.
 // Returns both the result alue and any events that happened while running.
 absl::StatusOr<InterpreterResult<Value>> InterpretFunctionKwargs(
     Function* function, const absl::flat_hash_map<std::string, Value>& args);
 
+// An interpreter for repeated evaluation of a single function. The nodes of
+// the function are topologically sorted and assigned value slots once at
+// construction; each call to Run then evaluates the nodes in order over a
+// reused value frame, avoiding the hash map lookups and traversal of
+// InterpretFunction. The function must not be modified while the plan is in
+// use. Not thread-safe.
+class FunctionInterpreterPlan {
+ public:
+  explicit FunctionInterpreterPlan(Function* function);
+
+  FunctionInterpreterPlan(const FunctionInterpreterPlan&) = delete;
+  FunctionInterpreterPlan& operator=(const FunctionInterpreterPlan&) = delete;
+
+  Function* function() const { return function_; }
+
+  // Evaluates the function on the given arguments. Equivalent to
+  // InterpretFunction(function(), args).
+  absl::StatusOr<InterpreterResult<Value>> Run(absl::Span<const Value> args);
+
+ private:
+  Function* function_;
+  std::vector<Node*> execution_order_;
+  NodeSlots slots_;
+  NodeValueFrame frame_;
+};
+
 }  // namespace xls
 
 #endif  // XLS_INTERPRETER_FUNCTION_INTERPRETER_H_
@@ -27,17 +27,21 @@
 namespace xls {
 
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
-CreateInterpreterSerialProcRuntime(Package* package) {
+CreateInterpreterSerialProcRuntime(Package* package, bool activity_profile,
+                                   bool bounded_queues) {
   // Create a queue manager for the queues. This factory verifies that there an
   // receive only queue for every receive only channel.
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<ChannelQueueManager> queue_manager,
                        ChannelQueueManager::Create(package));
+  if (bounded_queues) {
+    XLS_RETURN_IF_ERROR(queue_manager->BoundQueuesToFifoDepth());
+  }
 
   // Create a ProcInterpreter for each Proc.
   std::vector<std::unique_ptr<ProcEvaluator>> proc_interpreters;
   for (auto& proc : package->procs()) {
-    proc_interpreters.push_back(
-        std::make_unique<ProcInterpreter>(proc.get(), queue_manager.get()));
+    proc_interpreters.push_back(std::make_unique<ProcInterpreter>(
+        proc.get(), queue_manager.get(), activity_profile));
   }
 
   // Create a runtime.
@@ -57,4 +61,38 @@ CreateInterpreterSerialProcRuntime(Package* package) {
   return std::move(proc_runtime);
 }
 
+absl::StatusOr<std::unique_ptr<ThreadedProcRuntime>>
+CreateInterpreterThreadedProcRuntime(Package* package,
+                                     std::optional<int64_t> thread_count,
+                                     bool bounded_queues) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<ChannelQueueManager> queue_manager,
+                       ChannelQueueManager::Create(package));
+  if (bounded_queues) {
+    XLS_RETURN_IF_ERROR(queue_manager->BoundQueuesToFifoDepth());
+  }
+
+  // Create a ProcInterpreter for each Proc.
+  std::vector<std::unique_ptr<ProcEvaluator>> proc_interpreters;
+  for (auto& proc : package->procs()) {
+    proc_interpreters.push_back(
+        std::make_unique<ProcInterpreter>(proc.get(), queue_manager.get()));
+  }
+
+  // Create a runtime.
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<ThreadedProcRuntime> proc_runtime,
+      ThreadedProcRuntime::Create(package, std::move(proc_interpreters),
+                                  std::move(queue_manager), thread_count));
+
+  // Inject initial values into channels.
+  for (Channel* channel : package->channels()) {
+    ChannelQueue& queue = proc_runtime->queue_manager().GetQueue(channel);
+    for (const Value& value : channel->initial_values()) {
+      XLS_RETURN_IF_ERROR(queue.Write(value));
+    }
+  }
+
+  return std::move(proc_runtime);
+}
+
 }  // namespace xls
@@ -16,15 +16,31 @@
 #define XLS_INTERPRETER_INTERPRETER_PROC_RUNTIME_H_
 
 #include <memory>
+#include <optional>
 
 #include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/interpreter/threaded_proc_runtime.h"
 #include "xls/ir/package.h"
 
 namespace xls {
 
-// Create a SerialProcRuntime composed of ProcInterpreters.
+// Create a SerialProcRuntime composed of ProcInterpreters. If
+// `activity_profile` is true the interpreters record per-node activity counters
+// (see ProcRuntime::GetActivityProfile). If `bounded_queues` is true the
+// queues of internal channels are bounded by the channel FIFO depth and sends
+// on a full queue block (see ChannelQueueManager::BoundQueuesToFifoDepth).
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
-CreateInterpreterSerialProcRuntime(Package* package);
+CreateInterpreterSerialProcRuntime(Package* package,
+                                   bool activity_profile = false,
+                                   bool bounded_queues = false);
+
+// Create a ThreadedProcRuntime composed of ProcInterpreters. `thread_count` is
+// the number of worker threads (defaults to the number of available CPUs).
+// `bounded_queues` is as for CreateInterpreterSerialProcRuntime.
+absl::StatusOr<std::unique_ptr<ThreadedProcRuntime>>
+CreateInterpreterThreadedProcRuntime(
+    Package* package, std::optional<int64_t> thread_count = std::nullopt,
+    bool bounded_queues = false);
 
 }  // namespace xls
 
@@ -0,0 +1,114 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/invocation_cache.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/ir/function.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+bool InvocationCache::IsCacheable(Function* function) {
+  auto it = cacheable_.find(function);
+  if (it != cacheable_.end()) {
+    return it->second;
+  }
+  bool cacheable = true;
+  for (Node* node : function->nodes()) {
+    switch (node->op()) {
+      case Op::kAssert:
+      case Op::kCover:
+      case Op::kTrace:
+        cacheable = false;
+        break;
+      case Op::kInvoke:
+        cacheable = IsCacheable(node->As<Invoke>()->to_apply());
+        break;
+      case Op::kMap:
+        cacheable = IsCacheable(node->As<Map>()->to_apply());
+        break;
+      case Op::kCountedFor:
+        cacheable = IsCacheable(node->As<CountedFor>()->body());
+        break;
+      case Op::kDynamicCountedFor:
+        cacheable = IsCacheable(node->As<DynamicCountedFor>()->body());
+        break;
+      default:
+        break;
+    }
+    if (!cacheable) {
+      break;
+    }
+  }
+  cacheable_[function] = cacheable;
+  return cacheable;
+}
+
+std::optional<Value> InvocationCache::Lookup(Function* function,
+                                             absl::Span<const Value> args) {
+  auto it = entries_.find(
+      Key(function, std::vector<Value>(args.begin(), args.end())));
+  if (it == entries_.end()) {
+    ++misses_;
+    return std::nullopt;
+  }
+  ++hits_;
+  return it->second;
+}
+
+void InvocationCache::Insert(Function* function, absl::Span<const Value> args,
+                             Value result) {
+  if (max_entries_ <= 0) {
+    return;
+  }
+  Key key(function, std::vector<Value>(args.begin(), args.end()));
+  if (entries_.contains(key)) {
+    return;
+  }
+  if (entries_.size() >= max_entries_) {
+    entries_.erase(insertion_order_.front());
+    insertion_order_.pop_front();
+    ++evictions_;
+  }
+  entries_.emplace(key, std::move(result));
+  insertion_order_.push_back(std::move(key));
+}
+
+void InvocationCache::Clear() {
+  entries_.clear();
+  insertion_order_.clear();
+  hits_ = 0;
+  misses_ = 0;
+  evictions_ = 0;
+}
+
+std::string InvocationCache::ToString() const {
+  return absl::StrFormat(
+      "invocation cache: %d/%d entries, %d hits, %d misses (%.1f%% hit rate), "
+      "%d evictions",
+      size(), max_entries_, hits_, misses_, 100.0 * hit_rate(), evictions_);
+}
+
+}  // namespace xls
@@ -0,0 +1,89 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_INVOCATION_CACHE_H_
+#define XLS_INTERPRETER_INVOCATION_CACHE_H_
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "xls/ir/function.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// A bounded memo table of the results of functions called through invoke and
+// map nodes, keyed on the callee and argument values. Only functions which
+// cannot produce interpreter events (no assert, cover or trace nodes, directly
+// or in any callee) are cached so a hit is indistinguishable from evaluating
+// the call. When full, the oldest entry is evicted. Not thread-safe.
+class InvocationCache {
+ public:
+  explicit InvocationCache(int64_t max_entries) : max_entries_(max_entries) {}
+
+  InvocationCache(const InvocationCache&) = delete;
+  InvocationCache& operator=(const InvocationCache&) = delete;
+
+  // Returns whether calls to `function` may be cached.
+  bool IsCacheable(Function* function);
+
+  // Returns the cached result of calling `function` with `args`, if any.
+  // Updates the hit and miss counts.
+  std::optional<Value> Lookup(Function* function,
+                              absl::Span<const Value> args);
+
+  // Records the result of calling the cacheable `function` with `args`.
+  void Insert(Function* function, absl::Span<const Value> args, Value result);
+
+  int64_t size() const { return entries_.size(); }
+  int64_t max_entries() const { return max_entries_; }
+  int64_t hits() const { return hits_; }
+  int64_t misses() const { return misses_; }
+  int64_t evictions() const { return evictions_; }
+
+  // Returns the fraction of lookups which hit, or zero if there were none.
+  double hit_rate() const {
+    int64_t lookups = hits_ + misses_;
+    return lookups == 0 ? 0.0 : static_cast<double>(hits_) / lookups;
+  }
+
+  // Removes all entries and resets the statistics.
+  void Clear();
+
+  // Returns a one-line summary of the cache statistics.
+  std::string ToString() const;
+
+ private:
+  using Key = std::pair<Function*, std::vector<Value>>;
+
+  int64_t max_entries_;
+  absl::flat_hash_map<Key, Value> entries_;
+  // Keys of `entries_` in insertion order for eviction.
+  std::deque<Key> insertion_order_;
+  absl::flat_hash_map<Function*, bool> cacheable_;
+
+  int64_t hits_ = 0;
+  int64_t misses_ = 0;
+  int64_t evictions_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_INVOCATION_CACHE_H_
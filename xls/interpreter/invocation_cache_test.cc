@@ -0,0 +1,110 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/invocation_cache.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+
+class InvocationCacheTest : public IrTestBase {};
+
+TEST_F(InvocationCacheTest, MemoizesMapLanes) {
+  const std::string pkg_text = R"(
+package test
+
+fn square(x: bits[8]) -> bits[8] {
+  ret umul.1: bits[8] = umul(x, x)
+}
+
+fn traced_square(x: bits[8]) -> bits[8] {
+  after_all.2: token = after_all()
+  literal.3: bits[1] = literal(value=1)
+  trace.4: token = trace(after_all.2, literal.3, format="x is {}", data_operands=[x])
+  ret umul.5: bits[8] = umul(x, x)
+}
+
+fn squares(a: bits[8][4]) -> (bits[8][4], bits[8][4]) {
+  map.6: bits[8][4] = map(a, to_apply=square)
+  map.7: bits[8][4] = map(a, to_apply=traced_square)
+  ret tuple.8: (bits[8][4], bits[8][4]) = tuple(map.6, map.7)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(pkg_text));
+  Function* squares = FindFunction("squares", package.get());
+  XLS_ASSERT_OK_AND_ASSIGN(Value input,
+                           Value::UBitsArray({2, 3, 2, 2}, /*bit_count=*/8));
+  XLS_ASSERT_OK_AND_ASSIGN(Value expected,
+                           Value::UBitsArray({4, 9, 4, 4}, /*bit_count=*/8));
+
+  InvocationCache cache(/*max_entries=*/16);
+  EXPECT_TRUE(cache.IsCacheable(FindFunction("square", package.get())));
+  EXPECT_FALSE(
+      cache.IsCacheable(FindFunction("traced_square", package.get())));
+
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result,
+                           InterpretFunction(squares, {input}, &cache));
+  EXPECT_EQ(result.value, Value::Tuple({expected, expected}));
+  // Events of the uncached callee are still recorded for every lane.
+  EXPECT_THAT(result.events.trace_msgs,
+              ElementsAre("x is 2", "x is 3", "x is 2", "x is 2"));
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.hits(), 2);
+  EXPECT_EQ(cache.misses(), 2);
+  EXPECT_DOUBLE_EQ(cache.hit_rate(), 0.5);
+
+  XLS_ASSERT_OK_AND_ASSIGN(result, InterpretFunction(squares, {input}, &cache));
+  EXPECT_EQ(result.value, Value::Tuple({expected, expected}));
+  EXPECT_EQ(cache.hits(), 6);
+  EXPECT_EQ(cache.misses(), 2);
+}
+
+TEST_F(InvocationCacheTest, EvictsOldestEntry) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Param("x", p->GetBitsType(8));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  InvocationCache cache(/*max_entries=*/2);
+  for (int64_t i = 0; i < 3; ++i) {
+    cache.Insert(f, {Value(UBits(i, 8))}, Value(UBits(i, 8)));
+  }
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.evictions(), 1);
+  EXPECT_EQ(cache.Lookup(f, {Value(UBits(0, 8))}), std::nullopt);
+  EXPECT_EQ(cache.Lookup(f, {Value(UBits(2, 8))}), Value(UBits(2, 8)));
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_EQ(cache.misses(), 1);
+
+  cache.Clear();
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_EQ(cache.hits(), 0);
+}
+
+}  // namespace
+}  // namespace xls
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <utility>
 #include <variant>
@@ -29,6 +30,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/invocation_cache.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/dfs_visitor.h"
@@ -54,8 +56,32 @@ uint64_t BitsToBoundedUint64(const Bits& bits, uint64_t upper_limit) {
   return bits.ToUint64().value();
 }
 
+// Returns an array value which takes ownership of the given elements. Element
+// types are guaranteed to match by the IR verifier so, unlike Value::Array,
+// the elements are moved rather than copied.
+absl::StatusOr<Value> ArrayFromElements(std::vector<Value>&& elements) {
+  if (elements.empty()) {
+    return Value::Array(elements);
+  }
+  return Value::ArrayOwned(std::move(elements));
+}
+
 }  // namespace
 
+NodeSlots::NodeSlots(absl::Span<Node* const> nodes) : size_(nodes.size()) {
+  if (nodes.empty()) {
+    return;
+  }
+  auto [min_it, max_it] = std::minmax_element(
+      nodes.begin(), nodes.end(),
+      [](Node* a, Node* b) { return a->id() < b->id(); });
+  min_id_ = (*min_it)->id();
+  slots_.resize((*max_it)->id() - min_id_ + 1, -1);
+  for (int64_t i = 0; i < nodes.size(); ++i) {
+    slots_[nodes[i]->id() - min_id_] = i;
+  }
+}
+
 absl::StatusOr<Value> InterpretNode(Node* node,
                                     absl::Span<const Value> operand_values) {
   // Gate nodes do not require side effects when interpreted.
@@ -179,8 +205,9 @@ absl::Status IrInterpreter::HandleArray(Array* array) {
   for (Node* operand : array->operands()) {
     operand_values.push_back(ResolveAsValue(operand));
   }
-  XLS_ASSIGN_OR_RETURN(Value result, Value::Array(operand_values));
-  return SetValueResult(array, result);
+  XLS_ASSIGN_OR_RETURN(Value result,
+                       ArrayFromElements(std::move(operand_values)));
+  return SetValueResult(array, std::move(result));
 }
 
 absl::Status IrInterpreter::HandleInputPort(InputPort* input_port) {
@@ -194,6 +221,9 @@ absl::Status IrInterpreter::HandleOutputPort(OutputPort* output_port) {
 
 absl::Status IrInterpreter::HandleGate(Gate* gate) {
   const Bits& condition = ResolveAsBits(gate->condition());
+  if (activity_profile_ != nullptr) {
+    activity_profile_->RecordCondition(gate, condition.IsOne());
+  }
   if (condition.IsOne()) {
     return SetValueResult(gate, ResolveAsValue(gate->data()));
   }
@@ -270,8 +300,9 @@ absl::Status IrInterpreter::HandleCountedFor(CountedFor* counted_for) {
     for (const auto& value : invariant_args) {
       args_for_body.push_back(value);
     }
-    XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> loop_result,
-                         InterpretFunction(body, args_for_body));
+    XLS_ASSIGN_OR_RETURN(
+        InterpreterResult<Value> loop_result,
+        InterpretFunction(body, args_for_body, invocation_cache_));
     XLS_RETURN_IF_ERROR(AddInterpreterEvents(loop_result.events));
     loop_state = loop_result.value;
   }
@@ -322,8 +353,9 @@ absl::Status IrInterpreter::HandleDynamicCountedFor(
     for (const auto& value : invariant_args) {
       args_for_body.push_back(value);
     }
-    XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> loop_result,
-                         InterpretFunction(body, args_for_body));
+    XLS_ASSIGN_OR_RETURN(
+        InterpreterResult<Value> loop_result,
+        InterpretFunction(body, args_for_body, invocation_cache_));
     XLS_RETURN_IF_ERROR(AddInterpreterEvents(loop_result.events));
     loop_state = loop_result.value;
     index = bits_ops::Add(index, extended_stride);
@@ -424,8 +456,9 @@ static absl::Status SetArrayElement(absl::Span<const Bits> indices,
   XLS_RETURN_IF_ERROR(SetArrayElement(indices.subspan(1), value, &subelements));
   // Reconstruct the affected element as an array and assign it to the indexed
   // slot.
-  XLS_ASSIGN_OR_RETURN(Value array_element, Value::Array(subelements));
-  (*elements)[index] = array_element;
+  XLS_ASSIGN_OR_RETURN(Value array_element,
+                       ArrayFromElements(std::move(subelements)));
+  (*elements)[index] = std::move(array_element);
   return absl::OkStatus();
 }
 
@@ -434,6 +467,10 @@ absl::Status IrInterpreter::HandleArrayIndex(ArrayIndex* index) {
   for (Node* index_operand : index->indices()) {
     uint64_t idx =
         BitsToBoundedUint64(ResolveAsBits(index_operand), array->size() - 1);
+    if (array->IsPackedArray()) {
+      // The elements of packed arrays are bits so this is the last index.
+      return SetValueResult(index, Value(array->GetPackedElement(idx)));
+    }
     array = &array->element(idx);
   }
   return SetValueResult(index, *array);
@@ -451,8 +488,8 @@ absl::Status IrInterpreter::HandleArraySlice(ArraySlice* slice) {
       sliced.push_back(array.elements()[i]);
     }
   }
-  XLS_ASSIGN_OR_RETURN(Value result, Value::Array(sliced));
-  return SetValueResult(slice, result);
+  XLS_ASSIGN_OR_RETURN(Value result, ArrayFromElements(std::move(sliced)));
+  return SetValueResult(slice, std::move(result));
 }
 
 absl::Status IrInterpreter::HandleArrayUpdate(ArrayUpdate* update) {
@@ -464,6 +501,25 @@ absl::Status IrInterpreter::HandleArrayUpdate(ArrayUpdate* update) {
     return SetValueResult(update, update_value);
   }
 
+  if (input_array.IsPackedArray() && update->indices().size() == 1) {
+    // Splice the new element into the packed bits rather than unpacking.
+    const Bits& index_bits = ResolveAsBits(update->indices().front());
+    if (bits_ops::UGreaterThanOrEqual(index_bits, input_array.size())) {
+      // Out-of-bounds updates have no effect.
+      return SetValueResult(update, input_array);
+    }
+    int64_t width = input_array.packed_element_bit_count();
+    int64_t offset =
+        (input_array.size() - 1 - index_bits.ToUint64().value()) * width;
+    XLS_ASSIGN_OR_RETURN(
+        Value result,
+        Value::PackedArray(input_array.size(), width,
+                           bits_ops::BitSliceUpdate(input_array.packed_bits(),
+                                                    offset,
+                                                    update_value.bits())));
+    return SetValueResult(update, std::move(result));
+  }
+
   XLS_ASSIGN_OR_RETURN(std::vector<Value> array_elements,
                        input_array.GetElements());
   std::vector<Bits> index_vector;
@@ -472,8 +528,9 @@ absl::Status IrInterpreter::HandleArrayUpdate(ArrayUpdate* update) {
   }
   XLS_RETURN_IF_ERROR(
       SetArrayElement(index_vector, update_value, &array_elements));
-  XLS_ASSIGN_OR_RETURN(Value result, Value::Array(array_elements));
-  return SetValueResult(update, result);
+  XLS_ASSIGN_OR_RETURN(Value result,
+                       ArrayFromElements(std::move(array_elements)));
+  return SetValueResult(update, std::move(result));
 }
 
 absl::Status IrInterpreter::HandleArrayConcat(ArrayConcat* concat) {
@@ -487,13 +544,18 @@ absl::Status IrInterpreter::HandleArrayConcat(ArrayConcat* concat) {
                           elements.end());
   }
 
-  XLS_ASSIGN_OR_RETURN(Value result, Value::Array(array_elements));
-  return SetValueResult(concat, result);
+  XLS_ASSIGN_OR_RETURN(Value result,
+                       ArrayFromElements(std::move(array_elements)));
+  return SetValueResult(concat, std::move(result));
 }
 
 absl::Status IrInterpreter::HandleAssert(Assert* assert_op) {
   XLS_VLOG(2) << "Checking assert " << assert_op->ToString();
   XLS_VLOG(2) << "Condition is " << ResolveAsBool(assert_op->condition());
+  if (activity_profile_ != nullptr) {
+    activity_profile_->RecordCondition(assert_op,
+                                       ResolveAsBool(assert_op->condition()));
+  }
   if (!ResolveAsBool(assert_op->condition())) {
     GetInterpreterEvents().assert_msgs.push_back(assert_op->message());
   }
@@ -501,6 +563,10 @@ absl::Status IrInterpreter::HandleAssert(Assert* assert_op) {
 }
 
 absl::Status IrInterpreter::HandleTrace(Trace* trace_op) {
+  if (activity_profile_ != nullptr) {
+    activity_profile_->RecordCondition(trace_op,
+                                       ResolveAsBool(trace_op->condition()));
+  }
   if (ResolveAsBool(trace_op->condition())) {
     absl::Span<Node* const> arg_nodes = trace_op->args();
     auto arg_node = arg_nodes.begin();
@@ -544,6 +610,10 @@ absl::Status IrInterpreter::HandleTrace(Trace* trace_op) {
 }
 
 absl::Status IrInterpreter::HandleCover(Cover* cover) {
+  if (activity_profile_ != nullptr) {
+    activity_profile_->RecordCondition(cover,
+                                       ResolveAsBool(cover->condition()));
+  }
   // TODO(rspringer): 2021-05-25: Implement.
   return absl::OkStatus();
 }
@@ -554,10 +624,27 @@ absl::Status IrInterpreter::HandleInvoke(Invoke* invoke) {
   for (int64_t i = 0; i < to_apply->params().size(); ++i) {
     args.push_back(ResolveAsValue(invoke->operand(i)));
   }
+  XLS_ASSIGN_OR_RETURN(Value result, InvokeFunction(to_apply, args));
+  return SetValueResult(invoke, std::move(result));
+}
+
+absl::StatusOr<Value> IrInterpreter::InvokeFunction(
+    Function* function, absl::Span<const Value> args) {
+  bool cacheable = invocation_cache_ != nullptr &&
+                   invocation_cache_->IsCacheable(function);
+  if (cacheable) {
+    if (std::optional<Value> cached =
+            invocation_cache_->Lookup(function, args)) {
+      return std::move(cached.value());
+    }
+  }
   XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> result,
-                       InterpretFunction(to_apply, args));
+                       InterpretFunction(function, args, invocation_cache_));
   XLS_RETURN_IF_ERROR(AddInterpreterEvents(result.events));
-  return SetValueResult(invoke, result.value);
+  if (cacheable) {
+    invocation_cache_->Insert(function, args, result.value);
+  }
+  return std::move(result.value);
 }
 
 absl::Status IrInterpreter::HandleInstantiationInput(
@@ -605,13 +692,13 @@ absl::Status IrInterpreter::HandleMap(Map* map) {
   std::vector<Value> results;
   for (const Value& operand_element :
        ResolveAsValue(map->operand(0)).elements()) {
-    XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> result,
-                         InterpretFunction(to_apply, {operand_element}));
-    XLS_RETURN_IF_ERROR(AddInterpreterEvents(result.events));
-    results.push_back(result.value);
+    XLS_ASSIGN_OR_RETURN(Value result,
+                         InvokeFunction(to_apply, {operand_element}));
+    results.push_back(std::move(result));
   }
-  XLS_ASSIGN_OR_RETURN(Value result_array, Value::Array(results));
-  return SetValueResult(map, result_array);
+  XLS_ASSIGN_OR_RETURN(Value result_array,
+                       ArrayFromElements(std::move(results)));
+  return SetValueResult(map, std::move(result_array));
 }
 
 absl::Status IrInterpreter::HandleSMul(ArithOp* mul) {
@@ -707,6 +794,9 @@ absl::Status IrInterpreter::HandleOneHot(OneHot* one_hot) {
 
 absl::Status IrInterpreter::HandleOneHotSel(OneHotSelect* sel) {
   const Bits& selector = ResolveAsBits(sel->selector());
+  if (activity_profile_ != nullptr) {
+    activity_profile_->RecordSelector(sel, selector);
+  }
   std::vector<const Value*> activated_inputs;
   for (int64_t i = 0; i < selector.bit_count(); ++i) {
     if (selector.Get(i)) {
@@ -719,6 +809,9 @@ absl::Status IrInterpreter::HandleOneHotSel(OneHotSelect* sel) {
 
 absl::Status IrInterpreter::HandlePrioritySel(PrioritySelect* sel) {
   const Bits& selector = ResolveAsBits(sel->selector());
+  if (activity_profile_ != nullptr) {
+    activity_profile_->RecordSelector(sel, selector);
+  }
   for (int64_t i = 0; i < selector.bit_count(); ++i) {
     if (selector.Get(i)) {
       return SetValueResult(sel, ResolveAsValue(sel->get_case(i)));
@@ -738,6 +831,9 @@ absl::Status IrInterpreter::HandleReverse(UnOp* reverse) {
 
 absl::Status IrInterpreter::HandleSel(Select* sel) {
   Bits selector = ResolveAsBits(sel->selector());
+  if (activity_profile_ != nullptr) {
+    activity_profile_->RecordSelector(sel, selector);
+  }
   if (bits_ops::UGreaterThan(
           selector, UBits(sel->cases().size() - 1, selector.bit_count()))) {
     XLS_RET_CHECK(sel->default_value().has_value());
@@ -784,7 +880,7 @@ absl::Status IrInterpreter::HandleTuple(Tuple* tuple) {
   for (Node* operand : tuple->operands()) {
     tuple_values.push_back(ResolveAsValue(operand));
   }
-  return SetValueResult(tuple, Value::Tuple(tuple_values));
+  return SetValueResult(tuple, Value::TupleOwned(std::move(tuple_values)));
 }
 
 absl::Status IrInterpreter::HandleTupleIndex(TupleIndex* index) {
@@ -818,11 +914,11 @@ absl::Status IrInterpreter::VerifyAllBitsTypes(Node* node) {
 }
 
 const Bits& IrInterpreter::ResolveAsBits(Node* node) {
-  return NodeValuesMap().at(node).bits();
+  return ResolveAsValue(node).bits();
 }
 
 bool IrInterpreter::ResolveAsBool(Node* node) {
-  const Bits& bits = NodeValuesMap().at(node).bits();
+  const Bits& bits = ResolveAsValue(node).bits();
   XLS_CHECK_EQ(bits.bit_count(), 1);
   return bits.IsAllOnes();
 }
@@ -856,7 +952,7 @@ absl::Status IrInterpreter::SetBitsResult(Node* node, const Bits& result) {
 absl::Status IrInterpreter::SetValueResult(Node* node, Value result) {
   if (XLS_VLOG_IS_ON(4) &&
       std::all_of(node->operands().begin(), node->operands().end(),
-                  [this](Node* o) { return NodeValuesMap().contains(o); })) {
+                  [this](Node* o) { return HasResult(o); })) {
     XLS_VLOG(4) << absl::StreamFormat("%s operands:", node->GetName());
     for (int64_t i = 0; i < node->operand_count(); ++i) {
       XLS_VLOG(4) << absl::StreamFormat(
@@ -867,12 +963,17 @@ absl::Status IrInterpreter::SetValueResult(Node* node, Value result) {
   XLS_VLOG(3) << absl::StreamFormat("Result of %s: %s", node->ToString(),
                                     result.ToString());
 
-  XLS_RET_CHECK(!NodeValuesMap().contains(node));
+  XLS_RET_CHECK(!HasResult(node));
   if (!ValueConformsToType(result, node->GetType())) {
     return absl::InternalError(absl::StrFormat(
         "Expected value %s to match type %s of node %s", result.ToString(),
         node->GetType()->ToString(), node->GetName()));
   }
+  if (frame_ != nullptr) {
+    XLS_RET_CHECK(slots_->Contains(node)) << node->GetName();
+    frame_->Set(slots_->Get(node), std::move(result));
+    return absl::OkStatus();
+  }
   NodeValuesMap()[node] = std::move(result);
   return absl::OkStatus();
 }
@@ -901,9 +1002,9 @@ absl::StatusOr<Value> IrInterpreter::DeepOr(
     for (int64_t i = 0; i < input_type->AsArrayOrDie()->size(); ++i) {
       XLS_ASSIGN_OR_RETURN(Value element,
                            DeepOr(element_type, input_elements(i)));
-      elements.push_back(element);
+      elements.push_back(std::move(element));
     }
-    return Value::Array(elements);
+    return ArrayFromElements(std::move(elements));
   }
 
   XLS_RET_CHECK(input_type->IsTuple());
@@ -912,9 +1013,9 @@ absl::StatusOr<Value> IrInterpreter::DeepOr(
     XLS_ASSIGN_OR_RETURN(
         Value element,
         DeepOr(input_type->AsTupleOrDie()->element_type(i), input_elements(i)));
-    elements.push_back(element);
+    elements.push_back(std::move(element));
   }
-  return Value::Tuple(elements);
+  return Value::TupleOwned(std::move(elements));
 }
 
 }  // namespace xls
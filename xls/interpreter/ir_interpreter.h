@@ -15,15 +15,22 @@
 #ifndef XLS_INTERPRETER_IR_INTERPRETER_H_
 #define XLS_INTERPRETER_IR_INTERPRETER_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/interpreter/invocation_cache.h"
+#include "xls/ir/activity_profile.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/events.h"
+#include "xls/ir/function.h"
 #include "xls/ir/node.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 
@@ -32,6 +39,55 @@ namespace xls {
 absl::StatusOr<Value> InterpretNode(Node* node,
                                     absl::Span<const Value> operand_values);
 
+// Dense slot indices for a set of nodes of a FunctionBase. Used to hold node
+// values in a flat vector rather than a hash map when the same FunctionBase is
+// interpreted many times.
+class NodeSlots {
+ public:
+  // Assigns slot `i` to `nodes[i]`.
+  explicit NodeSlots(absl::Span<Node* const> nodes);
+
+  int64_t size() const { return size_; }
+
+  bool Contains(Node* node) const {
+    int64_t index = node->id() - min_id_;
+    return index >= 0 && index < slots_.size() && slots_[index] >= 0;
+  }
+
+  // Returns the slot of `node` which must be contained in the slot set.
+  int64_t Get(Node* node) const { return slots_[node->id() - min_id_]; }
+
+ private:
+  int64_t size_;
+  int64_t min_id_ = 0;
+  // Slot indices indexed by node id minus `min_id_`. -1 for ids without a
+  // slot.
+  std::vector<int64_t> slots_;
+};
+
+// The values of nodes during interpretation, indexed by the slots of a
+// NodeSlots. A frame may be reused across evaluations after calling Clear.
+class NodeValueFrame {
+ public:
+  explicit NodeValueFrame(int64_t size)
+      : values_(size), has_value_(size, false) {}
+
+  bool HasValue(int64_t slot) const { return has_value_[slot]; }
+  const Value& Get(int64_t slot) const { return values_[slot]; }
+  void Set(int64_t slot, Value value) {
+    values_[slot] = std::move(value);
+    has_value_[slot] = true;
+  }
+
+  // Marks all slots as empty. Previously held values are released lazily as
+  // their slots are overwritten.
+  void Clear() { std::fill(has_value_.begin(), has_value_.end(), false); }
+
+ private:
+  std::vector<Value> values_;
+  std::vector<bool> has_value_;
+};
+
 // A visitor for traversing and evaluating XLS IR.
 class IrInterpreter : public DfsVisitor {
  public:
@@ -44,6 +100,14 @@ class IrInterpreter : public DfsVisitor {
                 InterpreterEvents* events)
       : node_values_ptr_(node_values), events_ptr_(events) {}
 
+  // Constructor which holds node values in `frame` at the slots given by
+  // `slots` instead of in a hash map. Every node evaluated must have a slot.
+  IrInterpreter(const NodeSlots* slots, NodeValueFrame* frame)
+      : node_values_ptr_(nullptr),
+        events_ptr_(nullptr),
+        slots_(slots),
+        frame_(frame) {}
+
   // Sets the evaluated value for 'node' to the given Value. 'value' must be
   // passed in by value (ha!) because a use case is passing in a previously
   // evaluated value and inserting a into flat_hash_map (done below) invalidates
@@ -52,6 +116,9 @@ class IrInterpreter : public DfsVisitor {
 
   // Returns the previously evaluated value of 'node' as a Value.
   const Value& ResolveAsValue(Node* node) const {
+    if (frame_ != nullptr) {
+      return frame_->Get(slots_->Get(node));
+    }
     return NodeValuesMap().at(node);
   }
 
@@ -64,8 +131,26 @@ class IrInterpreter : public DfsVisitor {
 
   absl::Status AddInterpreterEvents(const InterpreterEvents& events);
 
+  // Sets the profile in which the activity of the interpreted nodes (select
+  // arms, predicates, etc) is recorded. Nodes not belonging to the profiled
+  // FunctionBase are not recorded. If null (the default) no activity is
+  // recorded.
+  void SetActivityProfile(ActivityProfile* profile) {
+    activity_profile_ = profile;
+  }
+
+  // Sets the cache in which the results of side-effect-free functions called
+  // through invoke and map nodes are memoized, including calls made while
+  // interpreting those functions. If null (the default) calls are not cached.
+  void SetInvocationCache(InvocationCache* cache) { invocation_cache_ = cache; }
+
   // Returns true if a value has been set for the result of the given node.
-  bool HasResult(Node* node) const { return NodeValuesMap().contains(node); }
+  bool HasResult(Node* node) const {
+    if (frame_ != nullptr) {
+      return slots_->Contains(node) && frame_->HasValue(slots_->Get(node));
+    }
+    return NodeValuesMap().contains(node);
+  }
 
   absl::Status HandleAdd(BinOp* add) override;
   absl::Status HandleAfterAll(AfterAll* after_all) override;
@@ -178,6 +263,11 @@ class IrInterpreter : public DfsVisitor {
   // Performs a logical OR of the given inputs. If 'inputs' is a not a Bits type
   // (ie, tuple or array) the element a recursively traversed and the Bits-typed
   // leaves are OR-ed.
+  // Interprets `function` on `args`, consulting the invocation cache if
+  // set, and adds any events produced to this interpreter's events.
+  absl::StatusOr<Value> InvokeFunction(Function* function,
+                                       absl::Span<const Value> args);
+
   absl::StatusOr<Value> DeepOr(Type* input_type,
                                absl::Span<const Value* const> inputs);
 
@@ -202,6 +292,13 @@ class IrInterpreter : public DfsVisitor {
   // used (`events_ptr` is null).
   InterpreterEvents* events_ptr_;
   InterpreterEvents events_;
+
+  ActivityProfile* activity_profile_ = nullptr;
+  InvocationCache* invocation_cache_ = nullptr;
+
+  // If non-null, node values are held in `frame_` rather than the map.
+  const NodeSlots* slots_ = nullptr;
+  NodeValueFrame* frame_ = nullptr;
 };
 
 }  // namespace xls
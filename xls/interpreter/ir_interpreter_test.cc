@@ -25,6 +25,7 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/keyword_args.h"
 #include "xls/ir/package.h"
 #include "xls/ir/verifier.h"
 
@@ -49,6 +50,20 @@ INSTANTIATE_TEST_SUITE_P(
           return InterpretFunctionKwargs(function, kwargs);
         })));
 
+INSTANTIATE_TEST_SUITE_P(
+    IrInterpreterPlanTest, IrEvaluatorTestBase,
+    testing::Values(IrEvaluatorTestParam(
+        [](Function* function, absl::Span<const Value> args) {
+          return FunctionInterpreterPlan(function).Run(args);
+        },
+        [](Function* function,
+           const absl::flat_hash_map<std::string, Value>& kwargs)
+            -> absl::StatusOr<InterpreterResult<Value>> {
+          XLS_ASSIGN_OR_RETURN(std::vector<Value> args,
+                               KeywordArgsToPositional(*function, kwargs));
+          return FunctionInterpreterPlan(function).Run(args);
+        })));
+
 // Fixture for IrInterpreter-only tests (i.e., those that aren't common to all
 // IR evaluators).
 class IrInterpreterOnlyTest : public IrTestBase {};
@@ -77,6 +92,31 @@ TEST_F(IrInterpreterOnlyTest, EvaluateNode) {
               IsOkAndHolds(Value(UBits(6, 4))));
 }
 
+TEST_F(IrInterpreterOnlyTest, PlanReusedAcrossRuns) {
+  Package package("my_package");
+  std::string fn_text = R"(
+    fn f(x: bits[8], y: bits[8]) -> (bits[8], bits[8]) {
+      add.1: bits[8] = add(x, y)
+      umul.2: bits[8] = umul(add.1, x)
+      ret tuple.3: (bits[8], bits[8]) = tuple(add.1, umul.2)
+    }
+    )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(fn_text, &package));
+
+  FunctionInterpreterPlan plan(function);
+  for (int64_t i = 0; i < 10; ++i) {
+    std::vector<Value> args = {Value(UBits(i, 8)), Value(UBits(3 * i, 8))};
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result, plan.Run(args));
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected,
+                             InterpretFunction(function, args));
+    EXPECT_EQ(result.value, expected.value);
+  }
+  EXPECT_THAT(plan.Run({Value(UBits(1, 8))}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("wants 2 arguments, got 1")));
+}
+
 TEST_F(IrInterpreterOnlyTest, SideEffectingNodes) {
   Package package("my_package");
   const std::string fn_text = R"(
@@ -46,6 +46,8 @@ std::string ToString(TickExecutionState state) {
       return "kBlockedOnReceive";
     case TickExecutionState::kSentOnChannel:
       return "kSentOnChannel";
+    case TickExecutionState::kBlockedOnSend:
+      return "kBlockedOnSend";
   }
   XLS_CHECK(false) << "Internal Error";
 }
@@ -21,7 +21,10 @@
 #include <string>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "xls/interpreter/proc_checkpoint.pb.h"
+#include "xls/ir/activity_profile.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/events.h"
 #include "xls/ir/proc.h"
@@ -49,6 +52,16 @@ class ProcContinuation {
   // of a tick, rather than, for example, blocked on a receive in the middle of
   // a tick execution.
   virtual bool AtStartOfTick() const = 0;
+
+  // Serializes the control and data state of the continuation. Recorded events
+  // are not included.
+  virtual absl::StatusOr<ProcContinuationProto> ToProto() const = 0;
+
+  // Overwrites the control and data state of the continuation with a
+  // checkpoint produced by ToProto on a continuation of the same kind for the
+  // same proc.
+  virtual absl::Status RestoreFromProto(
+      const ProcContinuationProto& proto) = 0;
 };
 
 // The execution state that a proc may be left in after callin Tick.
@@ -60,6 +73,9 @@ enum class TickExecutionState {
   // The proc tick exited early because it sent data a channel. The proc is not
   // blocked and execution can resume.
   kSentOnChannel,
+  // The proc tick was blocked on a send because the channel queue is full (see
+  // ChannelQueue::capacity). Execution resumes at the send.
+  kBlockedOnSend,
 };
 
 std::string ToString(TickExecutionState state);
@@ -68,8 +84,8 @@ std::string ToString(TickExecutionState state);
 struct TickResult {
   TickExecutionState execution_state;
 
-  // If tick state is kBlockedOnReceive or kSentOnChannel then this field holds
-  // the respective channel.
+  // If tick state is kBlockedOnReceive, kSentOnChannel or kBlockedOnSend then
+  // this field holds the respective channel.
   std::optional<Channel*> channel;
 
   // Whether any progress was made (at least one instruction was executed).
@@ -108,9 +124,24 @@ class ProcEvaluator {
   // Returns true if the proc has any send or receive nodes.
   bool ProcHasIoOperations() const { return has_io_operations_; }
 
+  // Returns the activity counters accumulated over all ticks of the proc, or
+  // nullptr if the evaluator was created without activity profiling.
+  const ActivityProfile* activity_profile() const {
+    return activity_profile_.get();
+  }
+
+ protected:
+  // Enables activity profiling. Must be called by derived classes before any
+  // evaluation.
+  ActivityProfile* EnableActivityProfile() {
+    activity_profile_ = std::make_unique<ActivityProfile>(proc_);
+    return activity_profile_.get();
+  }
+
  private:
   Proc* proc_;
   bool has_io_operations_;
+  std::unique_ptr<ActivityProfile> activity_profile_;
 };
 
 }  // namespace xls
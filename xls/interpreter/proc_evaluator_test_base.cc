@@ -20,6 +20,7 @@
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/matchers.h"
+#include "xls/ir/activity_profile.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/function_builder.h"
@@ -856,5 +857,60 @@ TEST_P(ProcEvaluatorTestBase, NonBlockingReceives) {
   EXPECT_THAT(out0_queue.Read(), Optional(Value(UBits(43, 32))));
 }
 
+TEST_P(ProcEvaluatorTestBase, ActivityProfile) {
+  if (!GetParam().SupportsActivityProfile()) {
+    GTEST_SKIP() << "Evaluator does not support activity profiling";
+  }
+  // Create a proc with a blocking receive_if which is enabled every other
+  // tick and a select between the received value and a literal.
+  Package package(TestName());
+  ProcBuilder pb("activity", /*token_name=*/"tok", &package);
+  BValue st = pb.StateElement("st", Value(UBits(1, 1)));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * ch_in, package.CreateStreamingChannel(
+                                                "in", ChannelOps::kReceiveOnly,
+                                                package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * ch_out, package.CreateStreamingChannel(
+                                                 "out", ChannelOps::kSendOnly,
+                                                 package.GetBitsType(32)));
+  BValue receive_if = pb.ReceiveIf(ch_in, pb.GetTokenParam(), /*pred=*/st);
+  BValue sel = pb.Select(
+      st, {pb.TupleIndex(receive_if, 1), pb.Literal(UBits(7, 32))});
+  BValue send = pb.Send(ch_out, pb.TupleIndex(receive_if, 0), sel);
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build(send, {pb.Not(st)}));
+
+  std::unique_ptr<ChannelQueueManager> queue_manager =
+      GetParam().CreateQueueManager(&package);
+  std::unique_ptr<ProcEvaluator> evaluator =
+      GetParam().CreateProfilingEvaluator(proc, queue_manager.get());
+  ASSERT_NE(evaluator->activity_profile(), nullptr);
+  ChannelQueue& input_queue = queue_manager->GetQueue(ch_in);
+
+  // Ticks the proc until it completes a tick or blocks.
+  std::unique_ptr<ProcContinuation> continuation = evaluator->NewContinuation();
+  auto run_tick = [&]() -> absl::StatusOr<TickExecutionState> {
+    while (true) {
+      XLS_ASSIGN_OR_RETURN(TickResult result, evaluator->Tick(*continuation));
+      if (result.execution_state != TickExecutionState::kSentOnChannel) {
+        return result.execution_state;
+      }
+    }
+  };
+
+  // The receive fires, is then disabled, and then blocks on an empty queue
+  // before firing again.
+  XLS_ASSERT_OK(input_queue.Write(Value(UBits(42, 32))));
+  EXPECT_THAT(run_tick(), IsOkAndHolds(TickExecutionState::kCompleted));
+  EXPECT_THAT(run_tick(), IsOkAndHolds(TickExecutionState::kCompleted));
+  EXPECT_THAT(run_tick(),
+              IsOkAndHolds(TickExecutionState::kBlockedOnReceive));
+  XLS_ASSERT_OK(input_queue.Write(Value(UBits(5, 32))));
+  EXPECT_THAT(run_tick(), IsOkAndHolds(TickExecutionState::kCompleted));
+
+  const ActivityProfile& profile = *evaluator->activity_profile();
+  EXPECT_THAT(profile.GetCounters(receive_if.node()), ElementsAre(2, 1, 1));
+  EXPECT_THAT(profile.GetCounters(sel.node()), ElementsAre(1, 2));
+  EXPECT_THAT(profile.GetCounters(send.node()), ElementsAre(3, 0));
+}
+
 }  // namespace
 }  // namespace xls
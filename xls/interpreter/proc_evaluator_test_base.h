@@ -33,9 +33,12 @@ class ProcEvaluatorTestParam {
       std::function<std::unique_ptr<ProcEvaluator>(Proc*, ChannelQueueManager*)>
           evaluator_factory,
       std::function<std::unique_ptr<ChannelQueueManager>(Package*)>
-          queue_manager_factory)
+          queue_manager_factory,
+      std::function<std::unique_ptr<ProcEvaluator>(Proc*, ChannelQueueManager*)>
+          profiling_evaluator_factory = nullptr)
       : evaluator_factory_(evaluator_factory),
-        queue_manager_factory_(queue_manager_factory) {}
+        queue_manager_factory_(queue_manager_factory),
+        profiling_evaluator_factory_(profiling_evaluator_factory) {}
   ProcEvaluatorTestParam() = default;
 
   std::unique_ptr<ChannelQueueManager> CreateQueueManager(
@@ -48,11 +51,24 @@ class ProcEvaluatorTestParam {
     return evaluator_factory_(proc, queue_manager);
   }
 
+  // Returns true if the evaluator supports activity profiling.
+  bool SupportsActivityProfile() const {
+    return profiling_evaluator_factory_ != nullptr;
+  }
+
+  // Creates an evaluator with activity profiling enabled.
+  std::unique_ptr<ProcEvaluator> CreateProfilingEvaluator(
+      Proc* proc, ChannelQueueManager* queue_manager) const {
+    return profiling_evaluator_factory_(proc, queue_manager);
+  }
+
  private:
   std::function<std::unique_ptr<ProcEvaluator>(Proc*, ChannelQueueManager*)>
       evaluator_factory_;
   std::function<std::unique_ptr<ChannelQueueManager>(Package*)>
       queue_manager_factory_;
+  std::function<std::unique_ptr<ProcEvaluator>(Proc*, ChannelQueueManager*)>
+      profiling_evaluator_factory_;
 };
 
 // A suite of test which can be run against arbitrary ProcEvaluator
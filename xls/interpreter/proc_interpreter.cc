@@ -14,14 +14,20 @@
 
 #include "xls/interpreter/proc_interpreter.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "xls/interpreter/ir_interpreter.h"
+#include "xls/ir/activity_profile.h"
+#include "xls/ir/ir_parser.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/value_helpers.h"
 
@@ -54,6 +60,7 @@ class ProcIrInterpreter : public IrInterpreter {
     if (receive->predicate().has_value()) {
       const Bits& pred = ResolveAsBits(receive->predicate().value());
       if (pred.IsZero()) {
+        RecordActivity(receive, ActivityProfile::kChannelOpPredicateFalse);
         // If the predicate is false, nothing is read from the channel.
         // Rather the result of the receive is the zero values of the
         // respective type.
@@ -62,6 +69,9 @@ class ProcIrInterpreter : public IrInterpreter {
     }
 
     std::optional<Value> value = queue->Read();
+    RecordActivity(receive, value.has_value()
+                                ? ActivityProfile::kChannelOpFired
+                                : ActivityProfile::kChannelOpNoData);
     if (!value.has_value()) {
       if (receive->is_blocking()) {
         // Record the channel this receive instruction is blocked on and exit.
@@ -87,9 +97,17 @@ class ProcIrInterpreter : public IrInterpreter {
     if (send->predicate().has_value()) {
       const Bits& pred = ResolveAsBits(send->predicate().value());
       if (pred.IsZero()) {
+        RecordActivity(send, ActivityProfile::kChannelOpPredicateFalse);
         return SetValueResult(send, Value::Token());
       }
     }
+    if (queue->IsFull()) {
+      // The bounded queue has no room. Record the channel this send is blocked
+      // on and exit without sending.
+      blocked_send_channel_ = queue->channel();
+      return absl::OkStatus();
+    }
+    RecordActivity(send, ActivityProfile::kChannelOpFired);
     // Indicate that data is sent on this channel.
     sent_channel_ = queue->channel();
 
@@ -110,21 +128,31 @@ class ProcIrInterpreter : public IrInterpreter {
   }
 
   // Executes a single node and return whether the node is blocked on a channel
-  // (for receive nodes) or whether data was sent on a channel (for send nodes).
+  // (for receive nodes and sends on full queues) or whether data was sent on a
+  // channel (for send nodes).
   struct NodeResult {
     std::optional<Channel*> blocked_channel;
     std::optional<Channel*> sent_channel;
+    std::optional<Channel*> blocked_send_channel;
   };
   absl::StatusOr<NodeResult> ExecuteNode(Node* node) {
     // Send/Receive handlers might set these values so clear them before hand.
     blocked_channel_ = std::nullopt;
     sent_channel_ = std::nullopt;
+    blocked_send_channel_ = std::nullopt;
     XLS_RETURN_IF_ERROR(node->VisitSingleNode(this));
     return NodeResult{.blocked_channel = blocked_channel_,
-                      .sent_channel = sent_channel_};
+                      .sent_channel = sent_channel_,
+                      .blocked_send_channel = blocked_send_channel_};
   }
 
  private:
+  void RecordActivity(Node* node, int64_t counter) {
+    if (activity_profile_ != nullptr) {
+      activity_profile_->Increment(node, counter);
+    }
+  }
+
   std::vector<Value> state_;
   ChannelQueueManager* queue_manager_;
 
@@ -132,14 +160,73 @@ class ProcIrInterpreter : public IrInterpreter {
   // execution is blocked on or the channel on which data was sent.
   std::optional<Channel*> blocked_channel_;
   std::optional<Channel*> sent_channel_;
+  std::optional<Channel*> blocked_send_channel_;
 };
 
 }  // namespace
 
-ProcInterpreter::ProcInterpreter(Proc* proc, ChannelQueueManager* queue_manager)
+absl::StatusOr<ProcContinuationProto> ProcInterpreterContinuation::ToProto()
+    const {
+  ProcContinuationProto proto;
+  proto.set_proc_name(proc_->name());
+  ProcInterpreterContinuationProto* interpreter = proto.mutable_interpreter();
+  interpreter->set_node_execution_index(node_index_);
+  for (const Value& value : state_) {
+    interpreter->add_state(value.ToString());
+  }
+  for (const auto& [node, value] : node_values_) {
+    (*interpreter->mutable_node_values())[node->id()] = value.ToString();
+  }
+  return proto;
+}
+
+absl::Status ProcInterpreterContinuation::RestoreFromProto(
+    const ProcContinuationProto& proto) {
+  if (!proto.has_interpreter()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Checkpoint of proc `%s` is not an interpreter continuation",
+        proc_->name()));
+  }
+  const ProcInterpreterContinuationProto& interpreter = proto.interpreter();
+  XLS_RET_CHECK_EQ(interpreter.state_size(), proc_->GetStateElementCount());
+  std::vector<Value> state;
+  for (int64_t i = 0; i < interpreter.state_size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(Value value,
+                         Parser::ParseTypedValue(interpreter.state(i)));
+    XLS_RET_CHECK(ValueConformsToType(value, proc_->GetStateElementType(i)));
+    state.push_back(std::move(value));
+  }
+  absl::flat_hash_map<int64_t, Node*> nodes_by_id;
+  for (Node* node : proc_->nodes()) {
+    nodes_by_id[node->id()] = node;
+  }
+  absl::flat_hash_map<Node*, Value> node_values;
+  for (const auto& [id, value_string] : interpreter.node_values()) {
+    auto it = nodes_by_id.find(id);
+    if (it == nodes_by_id.end()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Checkpoint refers to node id %d which does not exist in proc `%s`",
+          id, proc_->name()));
+    }
+    XLS_ASSIGN_OR_RETURN(Value value, Parser::ParseTypedValue(value_string));
+    XLS_RET_CHECK(ValueConformsToType(value, it->second->GetType()));
+    node_values[it->second] = std::move(value);
+  }
+  node_index_ = interpreter.node_execution_index();
+  state_ = std::move(state);
+  node_values_ = std::move(node_values);
+  return absl::OkStatus();
+}
+
+ProcInterpreter::ProcInterpreter(Proc* proc, ChannelQueueManager* queue_manager,
+                                 bool activity_profile)
     : ProcEvaluator(proc),
       queue_manager_(queue_manager),
-      execution_order_(TopoSort(proc).AsVector()) {}
+      execution_order_(TopoSort(proc).AsVector()) {
+  if (activity_profile) {
+    activity_profile_ = EnableActivityProfile();
+  }
+}
 
 std::unique_ptr<ProcContinuation> ProcInterpreter::NewContinuation() const {
   return std::make_unique<ProcInterpreterContinuation>(proc());
@@ -155,6 +242,7 @@ absl::StatusOr<TickResult> ProcInterpreter::Tick(
 
   ProcIrInterpreter ir_interpreter(cont->GetState(), &cont->GetNodeValues(),
                                    &cont->GetEvents(), queue_manager_);
+  ir_interpreter.SetActivityProfile(activity_profile_);
 
   // Resume execution at the node indicated in the continuation
   // (NodeExecutionIndex).
@@ -187,6 +275,16 @@ absl::StatusOr<TickResult> ProcInterpreter::Tick(
           .channel = result.blocked_channel.value(),
           .progress_made = cont->GetNodeExecutionIndex() != starting_index};
     }
+    if (result.blocked_send_channel.has_value()) {
+      // Early exit: proc is blocked at a send node because the channel queue
+      // is full. Execution should resume at the send.
+      cont->SetNodeExecutionIndex(i);
+      XLS_RETURN_IF_ERROR(InterpreterEventsToStatus(cont->GetEvents()));
+      return TickResult{
+          .execution_state = TickExecutionState::kBlockedOnSend,
+          .channel = result.blocked_send_channel.value(),
+          .progress_made = cont->GetNodeExecutionIndex() != starting_index};
+    }
   }
 
   // Proc completed execution of the Tick. Set the next proc state in the
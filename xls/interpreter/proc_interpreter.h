@@ -26,6 +26,7 @@
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/proc_evaluator.h"
 #include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/activity_profile.h"
 #include "xls/ir/events.h"
 #include "xls/ir/proc.h"
 #include "xls/ir/value.h"
@@ -38,7 +39,8 @@ class ProcInterpreterContinuation : public ProcContinuation {
   // Construct a new continuation. Execution the proc begins with the state set
   // to its initial values with no proc nodes yet executed.
   explicit ProcInterpreterContinuation(Proc* proc)
-      : node_index_(0),
+      : proc_(proc),
+        node_index_(0),
         state_(proc->InitValues().begin(), proc->InitValues().end()) {}
 
   ~ProcInterpreterContinuation() override = default;
@@ -49,6 +51,9 @@ class ProcInterpreterContinuation : public ProcContinuation {
   void ClearEvents() override { events_.Clear(); }
   bool AtStartOfTick() const override { return node_index_ == 0; }
 
+  absl::StatusOr<ProcContinuationProto> ToProto() const override;
+  absl::Status RestoreFromProto(const ProcContinuationProto& proto) override;
+
   // Resets the continuation so it will start executing at the beginning of the
   // proc with the given state values.
   void NextTick(std::vector<Value>&& next_state) {
@@ -69,6 +74,7 @@ class ProcInterpreterContinuation : public ProcContinuation {
   }
 
  private:
+  Proc* proc_;
   int64_t node_index_;
   std::vector<Value> state_;
 
@@ -78,10 +84,14 @@ class ProcInterpreterContinuation : public ProcContinuation {
 
 // A interpreter for an individual proc. Incrementally executes Procs a single
 // tick at a time. Data is fed to the proc via ChannelQueues.  ProcInterpreters
-// are thread-safe if called with different continuations.
+// are thread-safe if called with different continuations, unless created with
+// activity profiling enabled.
 class ProcInterpreter : public ProcEvaluator {
  public:
-  ProcInterpreter(Proc* proc, ChannelQueueManager* queue_manager);
+  // If `activity_profile` is true, the activity of the proc's nodes is
+  // recorded across ticks and is available through activity_profile().
+  ProcInterpreter(Proc* proc, ChannelQueueManager* queue_manager,
+                  bool activity_profile = false);
   ProcInterpreter(const ProcInterpreter&) = delete;
   ProcInterpreter operator=(const ProcInterpreter&) = delete;
 
@@ -93,6 +103,7 @@ class ProcInterpreter : public ProcEvaluator {
 
  private:
   ChannelQueueManager* queue_manager_;
+  ActivityProfile* activity_profile_ = nullptr;
 
   // A topological sort of the nodes of the proc which determines the execution
   // order of the proc.
@@ -35,6 +35,11 @@ INSTANTIATE_TEST_SUITE_P(
         },
         [](Package* package) -> std::unique_ptr<ChannelQueueManager> {
           return ChannelQueueManager::Create(package).value();
+        },
+        [](Proc* proc, ChannelQueueManager* queue_manager)
+            -> std::unique_ptr<ProcEvaluator> {
+          return std::make_unique<ProcInterpreter>(proc, queue_manager,
+                                                   /*activity_profile=*/true);
         })));
 
 }  // namespace
@@ -18,11 +18,19 @@
 #include <deque>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 
@@ -50,6 +58,7 @@ absl::Status ProcRuntime::Tick() {
         absl::StrFormat("Proc network is deadlocked. Blocked channels: %s",
                         absl::StrJoin(result.blocked_channels, ", ")));
   }
+  ++tick_count_;
   return absl::OkStatus();
 }
 
@@ -89,13 +98,17 @@ absl::StatusOr<int64_t> ProcRuntime::TickUntilOutput(
     }
   }
   int64_t ticks = 0;
+  // Output queues are only written while ticking so once a channel has
+  // produced enough values it need not be checked again.
   auto needs_more_output = [&]() {
-    for (Channel* ch : output_channels) {
-      if (queue_manager().GetQueue(ch).GetSize() < output_counts.at(ch)) {
-        return true;
-      }
-    }
-    return false;
+    output_channels.erase(
+        std::remove_if(output_channels.begin(), output_channels.end(),
+                       [&](Channel* ch) {
+                         return queue_manager().GetQueue(ch).GetSize() >=
+                                output_counts.at(ch);
+                       }),
+        output_channels.end());
+    return !output_channels.empty();
   };
   while (needs_more_output()) {
     if (max_ticks.has_value() && ticks >= max_ticks.value()) {
@@ -117,6 +130,7 @@ absl::StatusOr<int64_t> ProcRuntime::TickUntilBlocked(
   int64_t ticks = 0;
   while (!max_ticks.has_value() || ticks < max_ticks.value()) {
     XLS_ASSIGN_OR_RETURN(NetworkTickResult result, TickInternal());
+    ++tick_count_;
     if (!result.progress_made_on_io_procs) {
       return ticks;
     }
@@ -132,6 +146,161 @@ void ProcRuntime::ResetState() {
     EvaluatorContext& context = evaluator_contexts_[proc.get()];
     context.continuation = context.evaluator->NewContinuation();
   }
+  parked_procs_.clear();
+  tick_count_ = 0;
+}
+
+std::vector<Proc*> ProcRuntime::GetRunnableProcs(
+    absl::flat_hash_map<Channel*, Proc*>* blocked_procs,
+    absl::flat_hash_map<Channel*, Proc*>* blocked_senders) const {
+  std::vector<Proc*> runnable;
+  runnable.reserve(package_->procs().size());
+  for (const std::unique_ptr<Proc>& proc : package_->procs()) {
+    auto it = parked_procs_.find(proc.get());
+    if (it != parked_procs_.end()) {
+      Channel* channel = it->second.channel;
+      ChannelQueue& queue = queue_manager_->GetQueue(channel);
+      if (it->second.blocked_on_send) {
+        if (queue.IsFull()) {
+          XLS_VLOG(3) << absl::StreamFormat(
+              "Proc `%s` remains parked on send to channel `%s`",
+              proc->name(), channel->name());
+          (*blocked_senders)[channel] = proc.get();
+          continue;
+        }
+        runnable.push_back(proc.get());
+        continue;
+      }
+      // A generator may produce a value on demand so the proc must be ticked
+      // to find out.
+      if (queue.IsEmpty() && !queue.HasGenerator()) {
+        XLS_VLOG(3) << absl::StreamFormat(
+            "Proc `%s` remains parked on channel `%s`", proc->name(),
+            channel->name());
+        (*blocked_procs)[channel] = proc.get();
+        continue;
+      }
+    }
+    runnable.push_back(proc.get());
+  }
+  return runnable;
+}
+
+void ProcRuntime::ParkBlockedProcs(
+    const absl::flat_hash_map<Channel*, Proc*>& blocked,
+    const absl::flat_hash_map<Channel*, Proc*>& blocked_senders) {
+  parked_procs_.clear();
+  for (auto [channel, proc] : blocked) {
+    parked_procs_[proc] = ParkedProc{.channel = channel,
+                                     .blocked_on_send = false};
+  }
+  for (auto [channel, proc] : blocked_senders) {
+    parked_procs_[proc] = ParkedProc{.channel = channel,
+                                     .blocked_on_send = true};
+  }
+}
+
+void ProcRuntime::WakeBlockedSenders(
+    absl::flat_hash_map<Channel*, Proc*>* blocked_senders,
+    std::deque<Proc*>* ready_procs) const {
+  for (auto it = blocked_senders->begin(); it != blocked_senders->end();) {
+    if (queue_manager_->GetQueue(it->first).IsFull()) {
+      ++it;
+      continue;
+    }
+    XLS_VLOG(3) << absl::StreamFormat(
+        "Unblocking proc `%s` sending on channel `%s`", it->second->name(),
+        it->first->name());
+    ready_procs->push_back(it->second);
+    blocked_senders->erase(it++);
+  }
+}
+
+absl::StatusOr<ProcNetworkCheckpointProto> ProcRuntime::Checkpoint() {
+  ProcNetworkCheckpointProto checkpoint;
+  checkpoint.set_package_name(package_->name());
+  checkpoint.set_tick_count(tick_count_);
+  for (const std::unique_ptr<Proc>& proc : package_->procs()) {
+    XLS_ASSIGN_OR_RETURN(
+        *checkpoint.add_procs(),
+        evaluator_contexts_.at(proc.get()).continuation->ToProto());
+  }
+  for (ChannelQueue* queue : queue_manager_->queues()) {
+    if (queue->HasGenerator()) {
+      return absl::FailedPreconditionError(absl::StrFormat(
+          "Cannot checkpoint channel `%s` which has an attached generator",
+          queue->channel()->name()));
+    }
+    ChannelQueueCheckpointProto* channel = checkpoint.add_channels();
+    channel->set_channel_name(queue->channel()->name());
+    if (queue->channel()->kind() == ChannelKind::kSingleValue) {
+      // Reading a single-value channel does not consume the value.
+      std::optional<Value> value = queue->Read();
+      if (value.has_value()) {
+        channel->add_values(value->ToString());
+      }
+      continue;
+    }
+    // Drain the queue and write the values back in the same order.
+    std::vector<Value> values;
+    while (std::optional<Value> value = queue->Read()) {
+      values.push_back(std::move(value.value()));
+    }
+    for (const Value& value : values) {
+      channel->add_values(value.ToString());
+      XLS_RETURN_IF_ERROR(queue->Write(value));
+    }
+  }
+  return checkpoint;
+}
+
+absl::Status ProcRuntime::Restore(
+    const ProcNetworkCheckpointProto& checkpoint) {
+  if (checkpoint.package_name() != package_->name()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Checkpoint of package `%s` cannot be restored into package `%s`",
+        checkpoint.package_name(), package_->name()));
+  }
+  if (checkpoint.procs_size() != package_->procs().size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Checkpoint has %d procs, package `%s` has %d",
+        checkpoint.procs_size(), package_->name(), package_->procs().size()));
+  }
+  parked_procs_.clear();
+  for (const ProcContinuationProto& proc_checkpoint : checkpoint.procs()) {
+    XLS_ASSIGN_OR_RETURN(Proc * proc,
+                         package_->GetProc(proc_checkpoint.proc_name()));
+    XLS_RETURN_IF_ERROR(
+        evaluator_contexts_.at(proc).continuation->RestoreFromProto(
+            proc_checkpoint));
+  }
+  for (const ChannelQueueCheckpointProto& channel_checkpoint :
+       checkpoint.channels()) {
+    XLS_ASSIGN_OR_RETURN(
+        ChannelQueue * queue,
+        queue_manager_->GetQueueByName(channel_checkpoint.channel_name()));
+    if (queue->channel()->kind() != ChannelKind::kSingleValue) {
+      while (queue->Read().has_value()) {
+      }
+    }
+    for (const std::string& value_string : channel_checkpoint.values()) {
+      XLS_ASSIGN_OR_RETURN(Value value, Parser::ParseTypedValue(value_string));
+      XLS_RETURN_IF_ERROR(queue->Write(value));
+    }
+  }
+  tick_count_ = checkpoint.tick_count();
+  return absl::OkStatus();
+}
+
+absl::Status ProcRuntime::SaveCheckpoint(const std::filesystem::path& path) {
+  XLS_ASSIGN_OR_RETURN(ProcNetworkCheckpointProto checkpoint, Checkpoint());
+  return SetProtobinFile(path, checkpoint);
+}
+
+absl::Status ProcRuntime::LoadCheckpoint(const std::filesystem::path& path) {
+  ProcNetworkCheckpointProto checkpoint;
+  XLS_RETURN_IF_ERROR(ParseProtobinFile(path, &checkpoint));
+  return Restore(checkpoint);
 }
 
 absl::StatusOr<JitChannelQueueManager*>
@@ -15,13 +15,19 @@
 #ifndef XLS_INTERPRETER_PROC_RUNTIME_H_
 #define XLS_INTERPRETER_PROC_RUNTIME_H_
 
+#include <cstdint>
+#include <deque>
+#include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_checkpoint.pb.h"
 #include "xls/interpreter/proc_evaluator.h"
+#include "xls/ir/activity_profile.h"
 #include "xls/ir/events.h"
 #include "xls/ir/package.h"
 #include "xls/jit/jit_channel_queue.h"
@@ -59,9 +65,10 @@ class ProcRuntime {
       std::optional<int64_t> max_ticks = std::nullopt);
 
   // Tick until all procs with IO (send or receive nodes) are blocked on receive
-  // operations. `max_ticks` is the maximum number of ticks of the proc network
-  // before returning an error. Note: some proc networks are not guaranteed to
-  // block even if given no inputs. `max_ticks` is the maximum number of ticks
+  // operations (or on sends to full bounded queues). `max_ticks` is the
+  // maximum number of ticks of the proc network before returning an error.
+  // Note: some proc networks are not guaranteed to block even if given no
+  // inputs. `max_ticks` is the maximum number of ticks
   // of the proc network before returning an error.
   absl::StatusOr<int64_t> TickUntilBlocked(
       std::optional<int64_t> max_ticks = std::nullopt);
@@ -80,14 +87,45 @@ class ProcRuntime {
     return evaluator_contexts_.at(proc).continuation->GetState();
   }
 
-  // Reset the state of all of the procs to their initial state.
+  // Reset the state of all of the procs to their initial state and the tick
+  // count to zero. Channel queue contents are not affected.
   void ResetState();
 
+  // Returns the number of ticks of the proc network executed since
+  // construction or the last call to ResetState, including ticks executed by
+  // TickUntilOutput and TickUntilBlocked.
+  int64_t tick_count() const { return tick_count_; }
+
+  // Returns a checkpoint of the entire network: the continuation of every
+  // proc, the contents of every channel queue, and the tick count. Checkpoints
+  // may be taken between any two calls which tick the network including when
+  // procs are blocked mid-tick. Returns an error if a generator is attached to
+  // any channel queue as its pending values cannot be captured. JIT
+  // continuations are captured in their native layout (see
+  // ProcJitContinuation::ToProto).
+  absl::StatusOr<ProcNetworkCheckpointProto> Checkpoint();
+
+  // Restores the network to the state captured by `checkpoint`, which must
+  // have been taken from a runtime of the same kind for the same package.
+  // Existing channel queue contents are discarded.
+  absl::Status Restore(const ProcNetworkCheckpointProto& checkpoint);
+
+  // Writes a checkpoint of the network to `path` as a binary proto, or
+  // restores the network from such a file.
+  absl::Status SaveCheckpoint(const std::filesystem::path& path);
+  absl::Status LoadCheckpoint(const std::filesystem::path& path);
+
   // Returns the events for each proc in the network.
   const InterpreterEvents& GetInterpreterEvents(Proc* proc) const {
     return evaluator_contexts_.at(proc).continuation->GetEvents();
   }
 
+  // Returns the activity counters of the given proc, or nullptr if its
+  // evaluator was created without activity profiling.
+  const ActivityProfile* GetActivityProfile(Proc* proc) const {
+    return evaluator_contexts_.at(proc).evaluator->activity_profile();
+  }
+
   void ClearInterpreterEvents() const {
     for (const auto& [proc, context] : evaluator_contexts_) {
       context.continuation->ClearEvents();
@@ -107,6 +145,29 @@ class ProcRuntime {
   };
   virtual absl::StatusOr<NetworkTickResult> TickInternal() = 0;
 
+  // Returns the procs to tick at the start of a network tick in package order.
+  // Procs parked at the end of the previous tick whose channel is still empty
+  // are not returned. Instead they are added to `blocked_procs` so that a send
+  // on the channel during the tick resumes them. Likewise procs parked on a
+  // send to a channel whose queue is still full are added to
+  // `blocked_senders`. Ticking a parked proc could not make progress so
+  // skipping it does not change the result of the tick.
+  std::vector<Proc*> GetRunnableProcs(
+      absl::flat_hash_map<Channel*, Proc*>* blocked_procs,
+      absl::flat_hash_map<Channel*, Proc*>* blocked_senders) const;
+
+  // Records the procs blocked at the end of a successful network tick so the
+  // next tick does not needlessly re-tick them.
+  void ParkBlockedProcs(
+      const absl::flat_hash_map<Channel*, Proc*>& blocked,
+      const absl::flat_hash_map<Channel*, Proc*>& blocked_senders);
+
+  // Moves the procs of `blocked_senders` whose channel queue is no longer full
+  // to the end of `ready_procs`. Receives do not report the channel they read
+  // from so this is called after every proc tick.
+  void WakeBlockedSenders(absl::flat_hash_map<Channel*, Proc*>* blocked_senders,
+                          std::deque<Proc*>* ready_procs) const;
+
   Package* package_;
   std::unique_ptr<ChannelQueueManager> queue_manager_;
   struct EvaluatorContext {
@@ -114,6 +175,17 @@ class ProcRuntime {
     std::unique_ptr<ProcContinuation> continuation;
   };
   absl::flat_hash_map<Proc*, EvaluatorContext> evaluator_contexts_;
+  int64_t tick_count_ = 0;
+
+  // Procs which were blocked on a receive (or on a send to a full bounded
+  // queue) when the last network tick completed and the channel each one is
+  // blocked on. Cleared whenever the continuations are replaced or a tick
+  // fails.
+  struct ParkedProc {
+    Channel* channel;
+    bool blocked_on_send;
+  };
+  absl::flat_hash_map<Proc*, ParkedProc> parked_procs_;
 };
 
 }  // namespace xls
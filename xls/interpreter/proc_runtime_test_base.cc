@@ -14,7 +14,9 @@
 
 #include "xls/interpreter/proc_runtime_test_base.h"
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -22,6 +24,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/function_builder.h"
@@ -740,6 +743,113 @@ TEST_P(ProcRuntimeTestBase, StateReset) {
   EXPECT_THAT(output_queue.Read(), Optional(Value(SBits(14, 32))));
 }
 
+TEST_P(ProcRuntimeTestBase, CheckpointAndRestore) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * in, package->CreateStreamingChannel(
+                                             "in", ChannelOps::kReceiveOnly,
+                                             package->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * out, package->CreateStreamingChannel(
+                                              "out", ChannelOps::kSendOnly,
+                                              package->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * accum, CreateAccumProc("accum", in, out, package.get()));
+
+  std::unique_ptr<ProcRuntime> runtime =
+      GetParam().CreateRuntime(package.get());
+  ChannelQueue& in_queue = runtime->queue_manager().GetQueue(in);
+  ChannelQueue& out_queue = runtime->queue_manager().GetQueue(out);
+  for (int64_t i = 1; i <= 3; ++i) {
+    XLS_ASSERT_OK(in_queue.Write(Value(UBits(i, 32))));
+  }
+  XLS_ASSERT_OK(runtime->TickUntilOutput({{out, 1}}).status());
+  int64_t checkpoint_ticks = runtime->tick_count();
+  EXPECT_GT(checkpoint_ticks, 0);
+  std::vector<Value> checkpoint_state = runtime->ResolveState(accum);
+
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile checkpoint_file, TempFile::Create(".pb"));
+  XLS_ASSERT_OK(runtime->SaveCheckpoint(checkpoint_file.path()));
+
+  // Run to completion, restore the checkpoint, and run to completion again.
+  // Both runs must produce every output.
+  auto run_to_completion = [](ProcRuntime& rt, Channel* channel) {
+    XLS_EXPECT_OK(rt.TickUntilBlocked(/*max_ticks=*/100).status());
+    std::vector<Value> outputs;
+    while (std::optional<Value> value = rt.queue_manager()
+                                            .GetQueue(channel)
+                                            .Read()) {
+      outputs.push_back(std::move(value.value()));
+    }
+    return outputs;
+  };
+  std::vector<Value> expected = {Value(UBits(1, 32)), Value(UBits(3, 32)),
+                                 Value(UBits(6, 32))};
+  EXPECT_EQ(run_to_completion(*runtime, out), expected);
+  EXPECT_TRUE(in_queue.IsEmpty());
+
+  XLS_ASSERT_OK(runtime->LoadCheckpoint(checkpoint_file.path()));
+  EXPECT_EQ(runtime->tick_count(), checkpoint_ticks);
+  EXPECT_EQ(runtime->ResolveState(accum), checkpoint_state);
+  EXPECT_EQ(run_to_completion(*runtime, out), expected);
+
+  // The checkpoint can also be restored into a fresh runtime.
+  std::unique_ptr<ProcRuntime> new_runtime =
+      GetParam().CreateRuntime(package.get());
+  XLS_ASSERT_OK(new_runtime->LoadCheckpoint(checkpoint_file.path()));
+  EXPECT_EQ(new_runtime->tick_count(), checkpoint_ticks);
+  EXPECT_EQ(run_to_completion(*new_runtime, out), expected);
+}
+
+TEST_P(ProcRuntimeTestBase, CheckpointFailsWithGenerator) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * in, package->CreateStreamingChannel(
+                                             "in", ChannelOps::kReceiveOnly,
+                                             package->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * out, package->CreateStreamingChannel(
+                                              "out", ChannelOps::kSendOnly,
+                                              package->GetBitsType(32)));
+  XLS_ASSERT_OK(
+      CreatePassThroughProc("pass", in, out, package.get()).status());
+
+  std::unique_ptr<ProcRuntime> runtime =
+      GetParam().CreateRuntime(package.get());
+  XLS_ASSERT_OK(runtime->queue_manager().GetQueue(in).AttachGenerator(
+      FixedValueGenerator({Value(UBits(1, 32))})));
+  EXPECT_THAT(runtime->Checkpoint(),
+              StatusIs(absl::StatusCode::kFailedPrecondition,
+                       HasSubstr("attached generator")));
+}
+
+TEST_P(ProcRuntimeTestBase, ParkedProcResumesAfterExternalWrite) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * in, package->CreateStreamingChannel(
+                                             "in", ChannelOps::kReceiveOnly,
+                                             package->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * out, package->CreateStreamingChannel(
+                                              "out", ChannelOps::kSendOnly,
+                                              package->GetBitsType(32)));
+  XLS_ASSERT_OK(
+      CreatePassThroughProc("pass", in, out, package.get()).status());
+
+  std::unique_ptr<ProcRuntime> runtime =
+      GetParam().CreateRuntime(package.get());
+  XLS_ASSERT_OK(runtime->TickUntilBlocked().status());
+
+  // The proc is parked on the empty input channel so the network cannot make
+  // progress.
+  EXPECT_THAT(runtime->Tick(), StatusIs(absl::StatusCode::kInternal,
+                                        HasSubstr("deadlocked")));
+
+  // Writing to the input channel from outside the network makes the proc
+  // runnable again.
+  ChannelQueue& in_queue = runtime->queue_manager().GetQueue(in);
+  ChannelQueue& out_queue = runtime->queue_manager().GetQueue(out);
+  for (int64_t i = 0; i < 3; ++i) {
+    XLS_ASSERT_OK(in_queue.Write(Value(UBits(i, 32))));
+    XLS_ASSERT_OK(runtime->TickUntilOutput({{out, 1}}).status());
+    EXPECT_THAT(out_queue.Read(), Optional(Value(UBits(i, 32))));
+  }
+}
+
 TEST_P(ProcRuntimeTestBase, NonBlockingReceivesProc) {
   auto package = CreatePackage();
   XLS_ASSERT_OK_AND_ASSIGN(Channel * in0, package->CreateStreamingChannel(
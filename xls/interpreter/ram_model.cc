@@ -0,0 +1,404 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/ram_model.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_helpers.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/type_layout.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/ram_rewrite_pass.h"
+
+namespace xls {
+namespace {
+
+// Returns the little-endian unsigned value of the leaf `element` of `buffer`,
+// truncated to 64 bits.
+uint64_t LeafToUint64(const uint8_t* buffer, const ElementLayout& element) {
+  uint64_t result = 0;
+  int64_t size = std::min<int64_t>(element.data_size, sizeof(uint64_t));
+  for (int64_t i = size - 1; i >= 0; --i) {
+    result = (result << 8) | buffer[element.offset + i];
+  }
+  return result;
+}
+
+// Copies bits [`lo`, `hi`) from `src` to `dst`, both little-endian.
+void CopyBitRange(const uint8_t* src, uint8_t* dst, int64_t lo, int64_t hi) {
+  int64_t bit = lo;
+  while (bit < hi) {
+    if (bit % 8 == 0 && bit + 8 <= hi) {
+      dst[bit / 8] = src[bit / 8];
+      bit += 8;
+      continue;
+    }
+    uint8_t mask = uint8_t{1} << (bit % 8);
+    dst[bit / 8] = (dst[bit / 8] & ~mask) | (src[bit / 8] & mask);
+    ++bit;
+  }
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<RamModel>> RamModel::Create(
+    const RamConfig& config,
+    const absl::flat_hash_map<std::string, std::string>& logical_to_physical,
+    ChannelQueueManager* queue_manager, int64_t latency) {
+  XLS_RET_CHECK_GE(latency, 0);
+  XLS_RET_CHECK_GT(config.depth, 0);
+
+  absl::flat_hash_map<RamLogicalChannel, ChannelQueue*> queues;
+  for (const auto& [logical_name, physical_name] : logical_to_physical) {
+    XLS_ASSIGN_OR_RETURN(RamLogicalChannel logical_channel,
+                         RamLogicalChannelFromName(logical_name));
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * queue,
+                         queue_manager->GetQueueByName(physical_name));
+    if (queue->channel()->kind() != ChannelKind::kStreaming) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "RAM channel `%s` must be a streaming channel", physical_name));
+    }
+    queues[logical_channel] = queue;
+  }
+  auto get_queue =
+      [&](RamLogicalChannel logical_channel) -> absl::StatusOr<ChannelQueue*> {
+    auto it = queues.find(logical_channel);
+    if (it == queues.end()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "No channel given for logical channel `%s` of %s RAM",
+          RamLogicalChannelName(logical_channel),
+          RamKindToString(config.kind)));
+    }
+    return it->second;
+  };
+
+  // The data type is the single element of the read response.
+  RamLogicalChannel resp_channel;
+  switch (config.kind) {
+    case RamKind::kAbstract:
+      resp_channel = RamLogicalChannel::kAbstractReadResp;
+      break;
+    case RamKind::k1RW:
+      resp_channel = RamLogicalChannel::k1RWResp;
+      break;
+    case RamKind::k1R1W:
+      resp_channel = RamLogicalChannel::k1R1WReadResp;
+      break;
+    default:
+      return absl::UnimplementedError(
+          absl::StrFormat("RAM models are not supported for kind %s",
+                          RamKindToString(config.kind)));
+  }
+  XLS_ASSIGN_OR_RETURN(ChannelQueue * resp_queue, get_queue(resp_channel));
+  Type* resp_type = resp_queue->channel()->type();
+  XLS_RET_CHECK(resp_type->IsTuple() &&
+                resp_type->AsTupleOrDie()->size() == 1)
+      << "Unexpected RAM response type " << resp_type->ToString();
+  Type* data_type = resp_type->AsTupleOrDie()->element_type(0);
+  if (config.word_partition_size.has_value() && !data_type->IsBits()) {
+    return absl::UnimplementedError(absl::StrFormat(
+        "Masked RAM models require a bits data type, got %s",
+        data_type->ToString()));
+  }
+
+  // Use the native layouts of the JIT queues if the runtime has them.
+  auto* jit_manager = dynamic_cast<JitChannelQueueManager*>(queue_manager);
+  std::unique_ptr<JitRuntime> owned_jit_runtime;
+  JitRuntime* jit_runtime;
+  if (jit_manager != nullptr) {
+    jit_runtime = &jit_manager->runtime();
+  } else {
+    XLS_ASSIGN_OR_RETURN(owned_jit_runtime, JitRuntime::Create());
+    jit_runtime = owned_jit_runtime.get();
+  }
+
+  auto model = absl::WrapUnique(new RamModel(
+      config, latency, std::move(owned_jit_runtime), jit_runtime, data_type));
+  auto make_port = [&](RamLogicalChannel logical_channel,
+                       std::optional<Port>& port) -> absl::Status {
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * queue, get_queue(logical_channel));
+    port.emplace(model->MakePort(queue, jit_manager));
+    return absl::OkStatus();
+  };
+  switch (config.kind) {
+    case RamKind::kAbstract:
+      XLS_RETURN_IF_ERROR(
+          make_port(RamLogicalChannel::kAbstractReadReq, model->read_req_));
+      XLS_RETURN_IF_ERROR(
+          make_port(RamLogicalChannel::kAbstractReadResp, model->read_resp_));
+      XLS_RETURN_IF_ERROR(
+          make_port(RamLogicalChannel::kAbstractWriteReq, model->write_req_));
+      break;
+    case RamKind::k1RW:
+      XLS_RETURN_IF_ERROR(make_port(RamLogicalChannel::k1RWReq, model->req_));
+      XLS_RETURN_IF_ERROR(
+          make_port(RamLogicalChannel::k1RWResp, model->resp_));
+      break;
+    case RamKind::k1R1W:
+      XLS_RETURN_IF_ERROR(
+          make_port(RamLogicalChannel::k1R1WReadReq, model->read_req_));
+      XLS_RETURN_IF_ERROR(
+          make_port(RamLogicalChannel::k1R1WReadResp, model->read_resp_));
+      XLS_RETURN_IF_ERROR(
+          make_port(RamLogicalChannel::k1R1WWriteReq, model->write_req_));
+      break;
+    default:
+      break;
+  }
+  XLS_RETURN_IF_ERROR(make_port(RamLogicalChannel::kWriteCompletion,
+                                model->write_completion_));
+
+  if (config.initial_value.has_value()) {
+    XLS_RET_CHECK_LE(config.initial_value->size(), config.depth);
+    for (int64_t i = 0; i < config.initial_value->size(); ++i) {
+      XLS_RETURN_IF_ERROR(model->WriteWord(i, config.initial_value->at(i)));
+    }
+  }
+  return std::move(model);
+}
+
+RamModel::RamModel(const RamConfig& config, int64_t latency,
+                   std::unique_ptr<JitRuntime> owned_jit_runtime,
+                   JitRuntime* jit_runtime, Type* data_type)
+    : config_(config),
+      latency_(latency),
+      owned_jit_runtime_(std::move(owned_jit_runtime)),
+      jit_runtime_(jit_runtime),
+      word_layout_(jit_runtime->CreateTypeLayout(data_type)),
+      storage_(config.depth * word_layout_.size(), 0) {
+  // The initial values are applied by Create; don't keep a second copy.
+  config_.initial_value = std::nullopt;
+}
+
+RamModel::Port RamModel::MakePort(ChannelQueue* queue,
+                                  JitChannelQueueManager* jit_manager) {
+  JitChannelQueue* jit_queue = nullptr;
+  if (jit_manager != nullptr) {
+    jit_queue = &jit_manager->GetJitQueue(queue->channel());
+  }
+  TypeLayout layout =
+      jit_queue != nullptr ? jit_queue->type_layout()
+                           : jit_runtime_->CreateTypeLayout(
+                                 queue->channel()->type());
+  std::vector<uint8_t> buffer(layout.size(), 0);
+  return Port{.queue = queue,
+              .jit_queue = jit_queue,
+              .layout = std::move(layout),
+              .buffer = std::move(buffer)};
+}
+
+bool RamModel::ReadRequest(Port& port) {
+  if (port.jit_queue != nullptr) {
+    return port.jit_queue->ReadRaw(port.buffer.data());
+  }
+  std::optional<Value> value = port.queue->Read();
+  if (!value.has_value()) {
+    return false;
+  }
+  port.layout.ValueToNativeLayout(*value, port.buffer.data());
+  return true;
+}
+
+absl::Status RamModel::WriteResponse(Port& port, const uint8_t* data) {
+  if (port.jit_queue != nullptr) {
+    port.jit_queue->WriteRaw(data);
+    return absl::OkStatus();
+  }
+  return port.queue->Write(port.layout.NativeLayoutToValue(data));
+}
+
+void RamModel::Respond(Port& port, std::vector<uint8_t> data) {
+  pending_.push_back(PendingResponse{.due_tick = tick_count_ + latency_,
+                                     .port = &port,
+                                     .data = std::move(data)});
+}
+
+absl::StatusOr<int64_t> RamModel::GetAddress(
+    const Port& request, const ElementLayout& element) const {
+  uint64_t address = LeafToUint64(request.buffer.data(), element);
+  if (address >= static_cast<uint64_t>(config_.depth)) {
+    return absl::OutOfRangeError(absl::StrFormat(
+        "Address %d out of range for RAM of depth %d on channel `%s`", address,
+        config_.depth, request.queue->channel()->name()));
+  }
+  return static_cast<int64_t>(address);
+}
+
+std::vector<uint8_t> RamModel::ReadResponse(const Port& response,
+                                            int64_t address) const {
+  // The response is a one-element tuple so its leaves are exactly the leaves
+  // of the data word.
+  std::vector<uint8_t> data(response.layout.size(), 0);
+  const uint8_t* word = storage_.data() + address * word_layout_.size();
+  for (int64_t i = 0; i < word_layout_.elements().size(); ++i) {
+    const ElementLayout& from = word_layout_.elements()[i];
+    const ElementLayout& to = response.layout.elements()[i];
+    std::memcpy(data.data() + to.offset, word + from.offset, from.data_size);
+  }
+  return data;
+}
+
+void RamModel::WriteFromRequest(const Port& request, int64_t data_leaf,
+                                int64_t mask_leaf, int64_t address) {
+  uint8_t* word = storage_.data() + address * word_layout_.size();
+  absl::Span<const ElementLayout> elements = request.layout.elements();
+  if (!config_.word_partition_size.has_value()) {
+    for (int64_t i = 0; i < word_layout_.elements().size(); ++i) {
+      const ElementLayout& from = elements[data_leaf + i];
+      const ElementLayout& to = word_layout_.elements()[i];
+      std::memcpy(word + to.offset, request.buffer.data() + from.offset,
+                  to.data_size);
+    }
+    return;
+  }
+
+  // Masked RAMs have a bits-typed word: copy each enabled partition.
+  int64_t width = word_layout_.type()->GetFlatBitCount();
+  int64_t partition_size = config_.word_partition_size.value();
+  const uint8_t* data = request.buffer.data() + elements[data_leaf].offset;
+  const uint8_t* mask = request.buffer.data() + elements[mask_leaf].offset;
+  for (int64_t i = 0; i * partition_size < width; ++i) {
+    if ((mask[i / 8] >> (i % 8)) & 1) {
+      CopyBitRange(data, word + word_layout_.elements()[0].offset,
+                   i * partition_size,
+                   std::min(width, (i + 1) * partition_size));
+    }
+  }
+}
+
+absl::Status RamModel::HandleReadRequest(Port& request, Port& response) {
+  if (!ReadRequest(request)) {
+    return absl::OkStatus();
+  }
+  // Read request: (addr, mask). The read mask does not affect the model.
+  XLS_ASSIGN_OR_RETURN(int64_t address,
+                       GetAddress(request, request.layout.elements()[0]));
+  Respond(response, ReadResponse(response, address));
+  ++read_count_;
+  return absl::OkStatus();
+}
+
+absl::Status RamModel::HandleWriteRequest(Port& request) {
+  if (!ReadRequest(request)) {
+    return absl::OkStatus();
+  }
+  // Write request: (addr, data, mask).
+  XLS_ASSIGN_OR_RETURN(int64_t address,
+                       GetAddress(request, request.layout.elements()[0]));
+  int64_t data_leaf = 1;
+  WriteFromRequest(request, data_leaf,
+                   /*mask_leaf=*/data_leaf + word_layout_.elements().size(),
+                   address);
+  Respond(*write_completion_, {});
+  ++write_count_;
+  return absl::OkStatus();
+}
+
+absl::Status RamModel::Handle1RWRequest(Port& request) {
+  if (!ReadRequest(request)) {
+    return absl::OkStatus();
+  }
+  // Request: (addr, wr_data, wr_mask, rd_mask, we, re). Masks are empty tuples
+  // with no leaves if the RAM is not masked.
+  absl::Span<const ElementLayout> elements = request.layout.elements();
+  int64_t data_leaf = 1;
+  int64_t mask_leaf = data_leaf + word_layout_.elements().size();
+  int64_t mask_leaf_count = config_.word_partition_size.has_value() ? 1 : 0;
+  int64_t we_leaf = mask_leaf + 2 * mask_leaf_count;
+  int64_t re_leaf = we_leaf + 1;
+  XLS_RET_CHECK_EQ(re_leaf + 1, elements.size());
+  bool write_enable = LeafToUint64(request.buffer.data(), elements[we_leaf]);
+  bool read_enable = LeafToUint64(request.buffer.data(), elements[re_leaf]);
+  if (!write_enable && !read_enable) {
+    return absl::OkStatus();
+  }
+  XLS_ASSIGN_OR_RETURN(int64_t address, GetAddress(request, elements[0]));
+  if (read_enable) {
+    Respond(*resp_, ReadResponse(*resp_, address));
+    ++read_count_;
+  }
+  if (write_enable) {
+    WriteFromRequest(request, data_leaf, mask_leaf, address);
+    Respond(*write_completion_, {});
+    ++write_count_;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RamModel::Tick() {
+  // Reads are performed before writes accepted in the same tick.
+  if (req_.has_value()) {
+    XLS_RETURN_IF_ERROR(Handle1RWRequest(*req_));
+  } else {
+    XLS_RETURN_IF_ERROR(HandleReadRequest(*read_req_, *read_resp_));
+    XLS_RETURN_IF_ERROR(HandleWriteRequest(*write_req_));
+  }
+
+  while (!pending_.empty() && pending_.front().due_tick <= tick_count_) {
+    PendingResponse& response = pending_.front();
+    XLS_RETURN_IF_ERROR(WriteResponse(*response.port, response.data.data()));
+    pending_.pop_front();
+  }
+  ++tick_count_;
+  return absl::OkStatus();
+}
+
+absl::StatusOr<Value> RamModel::ReadWord(int64_t address) const {
+  if (address < 0 || address >= config_.depth) {
+    return absl::OutOfRangeError(absl::StrFormat(
+        "Address %d out of range for RAM of depth %d", address,
+        config_.depth));
+  }
+  return word_layout_.NativeLayoutToValue(storage_.data() +
+                                          address * word_layout_.size());
+}
+
+absl::Status RamModel::WriteWord(int64_t address, const Value& value) {
+  if (address < 0 || address >= config_.depth) {
+    return absl::OutOfRangeError(absl::StrFormat(
+        "Address %d out of range for RAM of depth %d", address,
+        config_.depth));
+  }
+  if (!ValueConformsToType(value, word_layout_.type())) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Value %s does not match RAM data type %s",
+                        value.ToString(), word_layout_.type()->ToString()));
+  }
+  word_layout_.ValueToNativeLayout(
+      value, storage_.data() + address * word_layout_.size());
+  return absl::OkStatus();
+}
+
+}  // namespace xls
@@ -0,0 +1,172 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_RAM_MODEL_H_
+#define XLS_INTERPRETER_RAM_MODEL_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/type_layout.h"
+#include "xls/passes/optimization_pass.h"
+
+namespace xls {
+
+// A native model of a RAM attached to the request/response channels created by
+// RamRewritePass. The contents of the RAM are held in a flat byte array, one
+// word per address in the native (JIT) layout of the data type. Requests and
+// responses are exchanged through the channel queues of a proc runtime:
+// queues of a JitChannelQueueManager are accessed directly in native layout and
+// other queues through Values, converted once at the port.
+//
+// The model is driven explicitly, typically once per network tick:
+//
+//   while (...) {
+//     XLS_RETURN_IF_ERROR(runtime->Tick());
+//     XLS_RETURN_IF_ERROR(ram->Tick());
+//   }
+//
+// Each tick every request port accepts at most one request. The response to a
+// request accepted in tick `t` (read data or write completion) is written to
+// its channel at the end of tick `t + latency`; with a latency of zero
+// responses are written in the tick the request is accepted.
+//
+// Supported RAM kinds are kAbstract and k1R1W (ports read_req, read_resp,
+// write_req and write_completion) and k1RW (ports req, resp and
+// write_completion). A 1RW request with both the read and write enables set
+// returns the data stored before the write. Write masks are supported for
+// RAMs with a bits-typed data word.
+class RamModel {
+ public:
+  // Creates a model of a RAM with configuration `config` whose channels are
+  // given by `logical_to_physical`, a map from logical channel names (e.g.
+  // "abstract_read_req", see RamLogicalChannelName) to channel names in the
+  // package of `queue_manager`.
+  static absl::StatusOr<std::unique_ptr<RamModel>> Create(
+      const RamConfig& config,
+      const absl::flat_hash_map<std::string, std::string>& logical_to_physical,
+      ChannelQueueManager* queue_manager, int64_t latency = 1);
+
+  RamModel(const RamModel&) = delete;
+  RamModel& operator=(const RamModel&) = delete;
+
+  // Accepts at most one request on every request port and writes the
+  // responses which are due.
+  absl::Status Tick();
+
+  // Direct access to the contents of the RAM, e.g. for initialization or
+  // checking results. Does not go through the channels.
+  absl::StatusOr<Value> ReadWord(int64_t address) const;
+  absl::Status WriteWord(int64_t address, const Value& value);
+
+  int64_t depth() const { return config_.depth; }
+  int64_t latency() const { return latency_; }
+  int64_t tick_count() const { return tick_count_; }
+  int64_t read_count() const { return read_count_; }
+  int64_t write_count() const { return write_count_; }
+
+  // Number of responses which have been computed but not yet written.
+  int64_t pending_response_count() const { return pending_.size(); }
+
+ private:
+  // One channel of the RAM, as seen from the model: requests are read from
+  // it and responses written to it.
+  struct Port {
+    ChannelQueue* queue = nullptr;
+    // Non-null if `queue` can be accessed in native layout.
+    JitChannelQueue* jit_queue = nullptr;
+    TypeLayout layout;
+    std::vector<uint8_t> buffer;
+  };
+
+  struct PendingResponse {
+    int64_t due_tick;
+    Port* port;
+    std::vector<uint8_t> data;
+  };
+
+  RamModel(const RamConfig& config, int64_t latency,
+           std::unique_ptr<JitRuntime> owned_jit_runtime,
+           JitRuntime* jit_runtime, Type* data_type);
+
+  // Returns a port for the channel of `queue`. `jit_manager` is null if the
+  // queues are not JitChannelQueues.
+  Port MakePort(ChannelQueue* queue, JitChannelQueueManager* jit_manager);
+
+  // Reads a request from `port` into `port.buffer`. Returns false if there is
+  // none.
+  bool ReadRequest(Port& port);
+  absl::Status WriteResponse(Port& port, const uint8_t* data);
+
+  // Schedules the response `data` on `port` `latency_` ticks from now.
+  void Respond(Port& port, std::vector<uint8_t> data);
+
+  // Returns the address held in the leaf `element` of `request`.
+  absl::StatusOr<int64_t> GetAddress(const Port& request,
+                                     const ElementLayout& element) const;
+
+  // Returns the read response for the word at `address` laid out in
+  // `response`.
+  std::vector<uint8_t> ReadResponse(const Port& response,
+                                    int64_t address) const;
+
+  // Writes the data word starting at leaf `data_leaf` of `request` to
+  // `address`, applying the mask in leaf `mask_leaf` if the RAM is masked.
+  void WriteFromRequest(const Port& request, int64_t data_leaf,
+                        int64_t mask_leaf, int64_t address);
+
+  absl::Status HandleReadRequest(Port& request, Port& response);
+  absl::Status HandleWriteRequest(Port& request);
+  absl::Status Handle1RWRequest(Port& request);
+
+  RamConfig config_;
+  int64_t latency_;
+  // Owned runtime providing the native layouts if the queues are not
+  // JitChannelQueues. Null otherwise.
+  std::unique_ptr<JitRuntime> owned_jit_runtime_;
+  JitRuntime* jit_runtime_;
+
+  // Layout of a single data word and the flat storage of all words.
+  TypeLayout word_layout_;
+  std::vector<uint8_t> storage_;
+
+  std::optional<Port> read_req_;
+  std::optional<Port> read_resp_;
+  std::optional<Port> write_req_;
+  std::optional<Port> req_;
+  std::optional<Port> resp_;
+  std::optional<Port> write_completion_;
+
+  // Responses in the order they are due.
+  std::deque<PendingResponse> pending_;
+
+  int64_t tick_count_ = 0;
+  int64_t read_count_ = 0;
+  int64_t write_count_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_RAM_MODEL_H_
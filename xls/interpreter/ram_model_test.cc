@@ -0,0 +1,244 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/ram_model.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/passes/optimization_pass.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+using ::testing::Optional;
+
+// Whether the model is attached to plain ChannelQueues (as used by the IR
+// interpreter) or to JitChannelQueues.
+class RamModelTest : public IrTestBase,
+                     public testing::WithParamInterface<bool> {
+ protected:
+  bool UseJitQueues() const { return GetParam(); }
+
+  absl::StatusOr<std::unique_ptr<ChannelQueueManager>> CreateQueueManager(
+      Package* package) {
+    if (UseJitQueues()) {
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitChannelQueueManager> manager,
+                           JitChannelQueueManager::CreateThreadUnsafe(package));
+      return manager;
+    }
+    return ChannelQueueManager::Create(package);
+  }
+
+  // Creates the channels of an abstract RAM with a bits[`data_width`] word
+  // named as RamRewritePass would with a prefix of "ram". Returns the logical
+  // to physical channel mapping.
+  absl::flat_hash_map<std::string, std::string> CreateAbstractRamChannels(
+      Package* p, int64_t addr_width, int64_t data_width) {
+    Type* addr_type = p->GetBitsType(addr_width);
+    Type* data_type = p->GetBitsType(data_width);
+    Type* mask_type = p->GetTupleType({});
+    XLS_CHECK_OK(p->CreateStreamingChannel(
+                      "ram_read_req", ChannelOps::kSendOnly,
+                      p->GetTupleType({addr_type, mask_type}))
+                     .status());
+    XLS_CHECK_OK(p->CreateStreamingChannel("ram_read_resp",
+                                           ChannelOps::kReceiveOnly,
+                                           p->GetTupleType({data_type}))
+                     .status());
+    XLS_CHECK_OK(p->CreateStreamingChannel(
+                      "ram_write_req", ChannelOps::kSendOnly,
+                      p->GetTupleType({addr_type, data_type, mask_type}))
+                     .status());
+    XLS_CHECK_OK(p->CreateStreamingChannel("ram_write_completion",
+                                           ChannelOps::kReceiveOnly,
+                                           p->GetTupleType({}))
+                     .status());
+    return {{"abstract_read_req", "ram_read_req"},
+            {"abstract_read_resp", "ram_read_resp"},
+            {"abstract_write_req", "ram_write_req"},
+            {"write_completion", "ram_write_completion"}};
+  }
+};
+
+TEST_P(RamModelTest, AbstractRamWithLatency) {
+  auto p = CreatePackage();
+  absl::flat_hash_map<std::string, std::string> channels =
+      CreateAbstractRamChannels(p.get(), /*addr_width=*/4, /*data_width=*/32);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelQueueManager> manager,
+                           CreateQueueManager(p.get()));
+  RamConfig config{.kind = RamKind::kAbstract, .depth = 16};
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<RamModel> ram,
+      RamModel::Create(config, channels, manager.get(), /*latency=*/2));
+
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * read_req,
+                           manager->GetQueueByName("ram_read_req"));
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * read_resp,
+                           manager->GetQueueByName("ram_read_resp"));
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * write_req,
+                           manager->GetQueueByName("ram_write_req"));
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * write_completion,
+                           manager->GetQueueByName("ram_write_completion"));
+
+  XLS_ASSERT_OK(write_req->Write(Value::Tuple(
+      {Value(UBits(3, 4)), Value(UBits(42, 32)), Value::Tuple({})})));
+  XLS_ASSERT_OK(ram->Tick());
+  XLS_ASSERT_OK(ram->Tick());
+  EXPECT_TRUE(write_completion->IsEmpty());
+  XLS_ASSERT_OK(ram->Tick());
+  EXPECT_THAT(write_completion->Read(), Optional(Value::Tuple({})));
+  EXPECT_EQ(ram->write_count(), 1);
+  EXPECT_THAT(ram->ReadWord(3), IsOkAndHolds(Value(UBits(42, 32))));
+
+  // Reads are performed before writes accepted in the same tick.
+  XLS_ASSERT_OK(
+      read_req->Write(Value::Tuple({Value(UBits(3, 4)), Value::Tuple({})})));
+  XLS_ASSERT_OK(write_req->Write(Value::Tuple(
+      {Value(UBits(3, 4)), Value(UBits(7, 32)), Value::Tuple({})})));
+  XLS_ASSERT_OK(
+      read_req->Write(Value::Tuple({Value(UBits(3, 4)), Value::Tuple({})})));
+  for (int64_t i = 0; i < 3; ++i) {
+    XLS_ASSERT_OK(ram->Tick());
+  }
+  EXPECT_THAT(read_resp->Read(),
+              Optional(Value::Tuple({Value(UBits(42, 32))})));
+  EXPECT_TRUE(read_resp->IsEmpty());
+  EXPECT_EQ(ram->pending_response_count(), 1);
+  XLS_ASSERT_OK(ram->Tick());
+  EXPECT_THAT(read_resp->Read(),
+              Optional(Value::Tuple({Value(UBits(7, 32))})));
+  EXPECT_EQ(ram->pending_response_count(), 0);
+}
+
+TEST_P(RamModelTest, Masked1RWRam) {
+  auto p = CreatePackage();
+  Type* addr_type = p->GetBitsType(2);
+  Type* data_type = p->GetBitsType(24);
+  Type* mask_type = p->GetBitsType(3);
+  Type* bool_type = p->GetBitsType(1);
+  XLS_ASSERT_OK(p->CreateStreamingChannel(
+                     "ram_req", ChannelOps::kSendOnly,
+                     p->GetTupleType({addr_type, data_type, mask_type,
+                                      mask_type, bool_type, bool_type}))
+                    .status());
+  XLS_ASSERT_OK(p->CreateStreamingChannel("ram_resp", ChannelOps::kReceiveOnly,
+                                          p->GetTupleType({data_type}))
+                    .status());
+  XLS_ASSERT_OK(p->CreateStreamingChannel("ram_write_completion",
+                                          ChannelOps::kReceiveOnly,
+                                          p->GetTupleType({}))
+                    .status());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelQueueManager> manager,
+                           CreateQueueManager(p.get()));
+  RamConfig config{.kind = RamKind::k1RW,
+                   .depth = 4,
+                   .word_partition_size = 8,
+                   .initial_value = std::vector<Value>(
+                       4, Value(UBits(0xaabbcc, 24)))};
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<RamModel> ram,
+      RamModel::Create(config,
+                       {{"1rw_req", "ram_req"},
+                        {"1rw_resp", "ram_resp"},
+                        {"write_completion", "ram_write_completion"}},
+                       manager.get(), /*latency=*/0));
+
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * req,
+                           manager->GetQueueByName("ram_req"));
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * resp,
+                           manager->GetQueueByName("ram_resp"));
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * write_completion,
+                           manager->GetQueueByName("ram_write_completion"));
+
+  // Read and write the first and last bytes of the word at address 1 in the
+  // same request: the read returns the old data.
+  XLS_ASSERT_OK(req->Write(Value::Tuple(
+      {Value(UBits(1, 2)), Value(UBits(0x112233, 24)), Value(UBits(0b101, 3)),
+       Value(UBits(0, 3)), Value(UBits(1, 1)), Value(UBits(1, 1))})));
+  XLS_ASSERT_OK(ram->Tick());
+  EXPECT_THAT(resp->Read(),
+              Optional(Value::Tuple({Value(UBits(0xaabbcc, 24))})));
+  EXPECT_THAT(write_completion->Read(), Optional(Value::Tuple({})));
+  EXPECT_THAT(ram->ReadWord(1), IsOkAndHolds(Value(UBits(0x11bb33, 24))));
+  EXPECT_THAT(ram->ReadWord(0), IsOkAndHolds(Value(UBits(0xaabbcc, 24))));
+
+  // Requests with neither enable set are ignored.
+  XLS_ASSERT_OK(req->Write(Value::Tuple(
+      {Value(UBits(1, 2)), Value(UBits(0, 24)), Value(UBits(0b111, 3)),
+       Value(UBits(0, 3)), Value(UBits(0, 1)), Value(UBits(0, 1))})));
+  XLS_ASSERT_OK(ram->Tick());
+  EXPECT_TRUE(resp->IsEmpty());
+  EXPECT_TRUE(write_completion->IsEmpty());
+  EXPECT_EQ(ram->read_count(), 1);
+  EXPECT_EQ(ram->write_count(), 1);
+}
+
+TEST_P(RamModelTest, AddressOutOfRange) {
+  auto p = CreatePackage();
+  absl::flat_hash_map<std::string, std::string> channels =
+      CreateAbstractRamChannels(p.get(), /*addr_width=*/4, /*data_width=*/8);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelQueueManager> manager,
+                           CreateQueueManager(p.get()));
+  RamConfig config{.kind = RamKind::kAbstract, .depth = 10};
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<RamModel> ram,
+                           RamModel::Create(config, channels, manager.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * read_req,
+                           manager->GetQueueByName("ram_read_req"));
+  XLS_ASSERT_OK(
+      read_req->Write(Value::Tuple({Value(UBits(12, 4)), Value::Tuple({})})));
+  EXPECT_THAT(ram->Tick(), StatusIs(absl::StatusCode::kOutOfRange,
+                                    HasSubstr("out of range")));
+}
+
+TEST_P(RamModelTest, MissingChannel) {
+  auto p = CreatePackage();
+  absl::flat_hash_map<std::string, std::string> channels =
+      CreateAbstractRamChannels(p.get(), /*addr_width=*/4, /*data_width=*/8);
+  channels.erase("write_completion");
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelQueueManager> manager,
+                           CreateQueueManager(p.get()));
+  RamConfig config{.kind = RamKind::kAbstract, .depth = 16};
+  EXPECT_THAT(RamModel::Create(config, channels, manager.get()).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("write_completion")));
+}
+
+INSTANTIATE_TEST_SUITE_P(RamModelTestInstantiation, RamModelTest,
+                         testing::Bool(),
+                         [](const testing::TestParamInfo<bool>& info) {
+                           return info.param ? "Jit" : "Interpreter";
+                         });
+
+}  // namespace
+}  // namespace xls
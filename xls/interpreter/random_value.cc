@@ -14,13 +14,55 @@
 
 #include "xls/interpreter/random_value.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <random>
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
 #include "xls/interpreter/function_interpreter.h"
 
 namespace xls {
+namespace {
+
+// Fills `words` with consecutive outputs of the SplitMix64 generator, advancing
+// `state` past them. Each output depends only on its index so the loop
+// vectorizes.
+void FillRandomWords(uint64_t* state, absl::Span<uint64_t> words) {
+  constexpr uint64_t kGamma = 0x9e3779b97f4a7c15;
+  uint64_t base = *state;
+  for (int64_t i = 0; i < words.size(); ++i) {
+    uint64_t z = base + (i + 1) * kGamma;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    words[i] = z ^ (z >> 31);
+  }
+  *state = base + words.size() * kGamma;
+}
+
+// Appends the bit counts of the leaves of `type` (zero for tokens) to
+// `bit_counts` in the order of the leaf elements of its TypeLayout.
+void AppendLeafBitCounts(Type* type, std::vector<int64_t>* bit_counts) {
+  if (type->IsTuple()) {
+    for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+      AppendLeafBitCounts(element_type, bit_counts);
+    }
+    return;
+  }
+  if (type->IsArray()) {
+    ArrayType* array_type = type->AsArrayOrDie();
+    for (int64_t i = 0; i < array_type->size(); ++i) {
+      AppendLeafBitCounts(array_type->element_type(), bit_counts);
+    }
+    return;
+  }
+  bit_counts->push_back(type->IsBits() ? type->AsBitsOrDie()->bit_count() : 0);
+}
+
+}  // namespace
 
 Value RandomValue(Type* type, std::minstd_rand* engine) {
   if (type->IsTuple()) {
@@ -52,6 +94,40 @@ Value RandomValue(Type* type, std::minstd_rand* engine) {
   return Value(Bits::FromBytes(bytes, bit_count));
 }
 
+void RandomNativeValues(const TypeLayout& layout, int64_t count,
+                        std::minstd_rand* engine, absl::Span<uint8_t> buffer) {
+  int64_t total_size = count * layout.size();
+  XLS_CHECK_GE(buffer.size(), total_size);
+
+  // Mask of the bits of a single value which hold data.
+  std::vector<int64_t> bit_counts;
+  AppendLeafBitCounts(layout.type(), &bit_counts);
+  XLS_CHECK_EQ(bit_counts.size(), layout.elements().size());
+  std::vector<uint8_t> mask(layout.size(), 0);
+  for (int64_t i = 0; i < bit_counts.size(); ++i) {
+    uint8_t* element_mask = mask.data() + layout.elements()[i].offset;
+    std::memset(element_mask, 0xff, bit_counts[i] / 8);
+    if (bit_counts[i] % 8 != 0) {
+      element_mask[bit_counts[i] / 8] =
+          static_cast<uint8_t>((1 << (bit_counts[i] % 8)) - 1);
+    }
+  }
+
+  uint64_t state = (uint64_t{(*engine)()} << 32) ^ (*engine)();
+  uint64_t words[64];
+  for (int64_t offset = 0; offset < total_size; offset += sizeof(words)) {
+    FillRandomWords(&state, absl::MakeSpan(words));
+    std::memcpy(buffer.data() + offset, words,
+                std::min<int64_t>(sizeof(words), total_size - offset));
+  }
+  for (int64_t i = 0; i < count; ++i) {
+    uint8_t* value_buffer = buffer.data() + i * layout.size();
+    for (int64_t j = 0; j < mask.size(); ++j) {
+      value_buffer[j] &= mask[j];
+    }
+  }
+}
+
 std::vector<Value> RandomFunctionArguments(Function* f,
                                            std::minstd_rand* engine) {
   std::vector<Value> inputs;
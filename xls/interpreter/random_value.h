@@ -15,12 +15,15 @@
 #ifndef XLS_INTERPRETER_RANDOM_VALUE_H_
 #define XLS_INTERPRETER_RANDOM_VALUE_H_
 
+#include <cstdint>
 #include <random>
 #include <vector>
 
+#include "absl/types/span.h"
 #include "xls/ir/function.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -28,6 +31,15 @@ namespace xls {
 // engine.
 Value RandomValue(Type* type, std::minstd_rand* engine);
 
+// Fills `buffer` with `count` consecutive values of type `layout.type()`, each
+// `layout.size()` bytes in the native layout described by `layout` (as used by
+// the JIT), with random uniformly distributed bits. Padding bits and bytes are
+// zero. No Values are constructed; instead whole buffers of random words are
+// produced by a counter-based generator seeded from `engine` and masked to the
+// layout, so this is much faster than calling RandomValue per sample.
+void RandomNativeValues(const TypeLayout& layout, int64_t count,
+                        std::minstd_rand* engine, absl::Span<uint8_t> buffer);
+
 // Returns a set of argument values for the given function with random uniformly
 // distributed bits using the given engine.
 std::vector<Value> RandomFunctionArguments(Function* f,
@@ -14,15 +14,19 @@
 
 #include "xls/interpreter/random_value.h"
 
+#include <cstdint>
 #include <random>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 namespace {
@@ -112,5 +116,42 @@ TEST(RandomValueTest, RandomOtherTypes) {
   }
 }
 
+TEST(RandomValueTest, RandomNativeValues) {
+  Package p("test_package");
+  // The second element is aligned, leaving a padding byte after the first.
+  Type* type = p.GetTupleType({p.GetBitsType(4), p.GetBitsType(16)});
+  TypeLayout layout(
+      type, 4,
+      {ElementLayout{.offset = 0, .data_size = 1, .padded_size = 1},
+       ElementLayout{.offset = 2, .data_size = 2, .padded_size = 2}});
+
+  const int64_t kSampleCount = 1000;
+  std::minstd_rand rng_engine0;
+  std::vector<uint8_t> buffer(kSampleCount * layout.size(), 0xff);
+  RandomNativeValues(layout, kSampleCount, &rng_engine0,
+                     absl::MakeSpan(buffer));
+
+  absl::flat_hash_set<Value> samples;
+  uint8_t low_nibble_or = 0;
+  for (int64_t i = 0; i < kSampleCount; ++i) {
+    const uint8_t* sample = buffer.data() + i * layout.size();
+    // Padding bits and bytes are zero.
+    EXPECT_EQ(sample[0] & 0xf0, 0);
+    EXPECT_EQ(sample[1], 0);
+    low_nibble_or |= sample[0];
+    samples.insert(layout.NativeLayoutToValue(sample));
+  }
+  EXPECT_EQ(low_nibble_or, 0xf);
+  // With overwhelming probability nearly all of the 20-bit samples are
+  // distinct.
+  EXPECT_GT(samples.size(), kSampleCount * 9 / 10);
+
+  std::minstd_rand rng_engine1;
+  std::vector<uint8_t> buffer1(buffer.size());
+  RandomNativeValues(layout, kSampleCount, &rng_engine1,
+                     absl::MakeSpan(buffer1));
+  EXPECT_EQ(buffer, buffer1);
+}
+
 }  // namespace
 }  // namespace xls
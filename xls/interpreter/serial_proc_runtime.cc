@@ -54,14 +54,16 @@ SerialProcRuntime::TickInternal() {
                                     package_->name());
   // Map containing any blocked procs and the channels they are blocked on.
   absl::flat_hash_map<Channel*, Proc*> blocked_procs;
+  // Procs blocked on a send because the (bounded) channel queue is full.
+  absl::flat_hash_map<Channel*, Proc*> blocked_senders;
 
+  // Put all runnable procs on the ready list. Procs still parked on an empty
+  // (or full) channel since the previous tick start out blocked.
   std::deque<Proc*> ready_procs;
-
-  // Put all procs on the ready list.
-  for (const std::unique_ptr<Proc>& proc : package_->procs()) {
+  for (Proc* proc : GetRunnableProcs(&blocked_procs, &blocked_senders)) {
     XLS_VLOG(3) << absl::StreamFormat("Proc `%s` added to ready list",
                                       proc->name());
-    ready_procs.push_back(proc.get());
+    ready_procs.push_back(proc);
   }
 
   bool progress_made = false;
@@ -72,8 +74,13 @@ SerialProcRuntime::TickInternal() {
     ready_procs.pop_front();
 
     XLS_VLOG(3) << absl::StreamFormat("Ticking proc `%s`", proc->name());
-    XLS_ASSIGN_OR_RETURN(TickResult tick_result,
-                         context.evaluator->Tick(*context.continuation));
+    absl::StatusOr<TickResult> tick_status =
+        context.evaluator->Tick(*context.continuation);
+    if (!tick_status.ok()) {
+      parked_procs_.clear();
+      return tick_status.status();
+    }
+    TickResult tick_result = std::move(tick_status).value();
     XLS_VLOG(3) << "Tick result: " << tick_result;
 
     progress_made |= tick_result.progress_made;
@@ -97,13 +104,28 @@ SerialProcRuntime::TickInternal() {
           "Proc `%s` is now blocked on channel `%s`", proc->name(),
           channel->ToString());
       blocked_procs[channel] = proc;
+    } else if (tick_result.execution_state ==
+               TickExecutionState::kBlockedOnSend) {
+      Channel* channel = tick_result.channel.value();
+      XLS_VLOG(3) << absl::StreamFormat(
+          "Proc `%s` is now blocked on send to full channel `%s`",
+          proc->name(), channel->ToString());
+      blocked_senders[channel] = proc;
+    }
+    // The tick may have received from a channel a proc is blocked sending on.
+    if (!blocked_senders.empty()) {
+      WakeBlockedSenders(&blocked_senders, &ready_procs);
     }
   }
+  ParkBlockedProcs(blocked_procs, blocked_senders);
   auto get_blocked_channels = [&]() {
     std::vector<Channel*> channels;
     for (auto [channel, proc] : blocked_procs) {
       channels.push_back(channel);
     }
+    for (auto [channel, proc] : blocked_senders) {
+      channels.push_back(channel);
+    }
     std::sort(channels.begin(), channels.end(),
               [](Channel* a, Channel* b) { return a->id() < b->id(); });
     return channels;
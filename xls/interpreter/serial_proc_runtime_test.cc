@@ -14,12 +14,20 @@
 
 #include "xls/interpreter/serial_proc_runtime.h"
 
+#include <memory>
+#include <string_view>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/interpreter_proc_runtime.h"
 #include "xls/interpreter/proc_interpreter.h"
 #include "xls/interpreter/proc_runtime_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
+#include "xls/ir/value.h"
 #include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/jit_proc_runtime.h"
 #include "xls/jit/proc_jit.h"
@@ -27,6 +35,8 @@
 namespace xls {
 namespace {
 
+using ::testing::Optional;
+
 // Create a SerialProcRuntime composed of a mix of ProcInterpreters and
 // ProcJits.
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateMixedSerialProcRuntime(
@@ -86,14 +96,86 @@ INSTANTIATE_TEST_SUITE_P(
             [](Package* package) -> std::unique_ptr<ProcRuntime> {
               return CreateJitSerialProcRuntime(package).value();
             }),
+        ProcRuntimeTestParam(
+            "tiered",
+            [](Package* package) -> std::unique_ptr<ProcRuntime> {
+              return CreateTieredSerialProcRuntime(package).value();
+            }),
         ProcRuntimeTestParam(
             "mixed",
             [](Package* package) -> std::unique_ptr<ProcRuntime> {
               return CreateMixedSerialProcRuntime(package).value();
+            }),
+        ProcRuntimeTestParam(
+            "fused",
+            [](Package* package) -> std::unique_ptr<ProcRuntime> {
+              return CreateFusedJitProcRuntime(package).value();
             })),
     [](const testing::TestParamInfo<ProcRuntimeTestBase::ParamType>& info) {
       return info.param.name();
     });
 
+TEST(SerialProcRuntimeTest, BoundedQueueBlocksSends) {
+  // `producer` sends an incrementing count every tick. `consumer` forwards one
+  // value from the FIFO of depth 2 to the output for each value on `go`.
+  constexpr std::string_view kIrText = R"(
+package test
+
+chan go(bits[1], id=0, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="")
+chan fifo(bits[32], id=1, kind=streaming, ops=send_receive, flow_control=ready_valid, fifo_depth=2, metadata="")
+chan out(bits[32], id=2, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="")
+
+proc producer(tkn: token, count: bits[32], init={0}) {
+  one: bits[32] = literal(value=1)
+  send.1: token = send(tkn, count, channel_id=1)
+  next_count: bits[32] = add(count, one)
+  next (send.1, next_count)
+}
+
+proc consumer(tkn: token, state: (), init={()}) {
+  receive.2: (token, bits[1]) = receive(tkn, channel_id=0)
+  tuple_index.3: token = tuple_index(receive.2, index=0)
+  receive.4: (token, bits[32]) = receive(tuple_index.3, channel_id=1)
+  tuple_index.5: token = tuple_index(receive.4, index=0)
+  tuple_index.6: bits[32] = tuple_index(receive.4, index=1)
+  send.7: token = send(tuple_index.5, tuple_index.6, channel_id=2)
+  next (send.7, state)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kIrText));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<SerialProcRuntime> runtime,
+      CreateInterpreterSerialProcRuntime(package.get(),
+                                         /*activity_profile=*/false,
+                                         /*bounded_queues=*/true));
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * go,
+                           runtime->queue_manager().GetQueueByName("go"));
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * fifo,
+                           runtime->queue_manager().GetQueueByName("fifo"));
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * out,
+                           runtime->queue_manager().GetQueueByName("out"));
+  EXPECT_EQ(fifo->capacity(), 2);
+
+  // Without any `go` inputs the producer fills the FIFO and then blocks.
+  XLS_ASSERT_OK(runtime->TickUntilBlocked(/*max_ticks=*/100).status());
+  EXPECT_EQ(fifo->GetSize(), 2);
+  EXPECT_TRUE(fifo->IsFull());
+
+  // Draining one value lets the blocked send complete.
+  XLS_ASSERT_OK(go->Write(Value(UBits(1, 1))));
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_EQ(fifo->GetSize(), 2);
+  EXPECT_THAT(out->Read(), Optional(Value(UBits(0, 32))));
+  EXPECT_TRUE(out->IsEmpty());
+
+  XLS_ASSERT_OK(go->Write(Value(UBits(1, 1))));
+  XLS_ASSERT_OK(go->Write(Value(UBits(1, 1))));
+  XLS_ASSERT_OK(runtime->TickUntilBlocked(/*max_ticks=*/100).status());
+  EXPECT_THAT(out->Read(), Optional(Value(UBits(1, 32))));
+  EXPECT_THAT(out->Read(), Optional(Value(UBits(2, 32))));
+  EXPECT_EQ(fifo->GetSize(), 2);
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,224 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/threaded_proc_runtime.h"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+
+namespace xls {
+
+/* static */
+absl::StatusOr<std::unique_ptr<ThreadedProcRuntime>>
+ThreadedProcRuntime::Create(
+    Package* package, std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+    std::unique_ptr<ChannelQueueManager>&& queue_manager,
+    std::optional<int64_t> thread_count) {
+  // Verify there exists exactly one evaluator per proc in the package.
+  absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>> evaluator_map;
+  for (std::unique_ptr<ProcEvaluator>& evaluator : evaluators) {
+    Proc* proc = evaluator->proc();
+    auto [it, inserted] = evaluator_map.insert({proc, std::move(evaluator)});
+    XLS_RET_CHECK(inserted) << absl::StreamFormat(
+        "More than one evaluator given for proc `%s`", proc->name());
+  }
+  for (const std::unique_ptr<Proc>& proc : package->procs()) {
+    XLS_RET_CHECK(evaluator_map.contains(proc.get()))
+        << absl::StreamFormat("No evaluator given for proc `%s`", proc->name());
+  }
+  XLS_RET_CHECK_EQ(evaluator_map.size(), package->procs().size())
+      << "More evaluators than procs given.";
+
+  int64_t worker_count = thread_count.value_or(std::max(AvailableCPUs(), 1));
+  XLS_RET_CHECK_GT(worker_count, 0);
+  // There is no benefit to more workers than procs.
+  worker_count = std::min<int64_t>(
+      worker_count, std::max<int64_t>(package->procs().size(), 1));
+
+  auto runtime = absl::WrapUnique(new ThreadedProcRuntime(
+      package, std::move(evaluator_map), std::move(queue_manager)));
+  for (int64_t i = 0; i < worker_count; ++i) {
+    runtime->workers_.push_back(std::make_unique<Thread>(
+        [runtime = runtime.get()]() { runtime->WorkerLoop(); }));
+  }
+  return std::move(runtime);
+}
+
+ThreadedProcRuntime::~ThreadedProcRuntime() {
+  {
+    absl::MutexLock lock(&mutex_);
+    shutdown_ = true;
+  }
+  for (std::unique_ptr<Thread>& worker : workers_) {
+    worker->Join();
+  }
+}
+
+void ThreadedProcRuntime::WorkerLoop() {
+  absl::MutexLock lock(&mutex_);
+  while (true) {
+    mutex_.Await(absl::Condition(
+        +[](ThreadedProcRuntime* runtime) ABSL_EXCLUSIVE_LOCKS_REQUIRED(
+             runtime->mutex_) {
+          return runtime->shutdown_ || !runtime->ready_procs_.empty();
+        },
+        this));
+    if (shutdown_) {
+      return;
+    }
+    Proc* proc = ready_procs_.front();
+    ready_procs_.pop_front();
+    ++active_count_;
+
+    // Tick the proc without holding the lock so other procs may run
+    // concurrently. The evaluator context of a proc is only touched by the
+    // worker which took the proc off the ready list.
+    EvaluatorContext& context = evaluator_contexts_.at(proc);
+    mutex_.Unlock();
+    XLS_VLOG(3) << absl::StreamFormat("Ticking proc `%s`", proc->name());
+    absl::StatusOr<TickResult> tick_result =
+        context.evaluator->Tick(*context.continuation);
+    mutex_.Lock();
+
+    --active_count_;
+    if (!tick_result.ok()) {
+      if (status_.ok()) {
+        status_ = tick_result.status();
+      }
+      // Drain the ready list so the network tick terminates promptly.
+      ready_procs_.clear();
+      continue;
+    }
+    XLS_VLOG(3) << "Tick result: " << tick_result.value();
+    progress_made_ |= tick_result->progress_made;
+    progress_made_on_io_procs_ |= (tick_result->progress_made &&
+                                   context.evaluator->ProcHasIoOperations());
+    if (status_.ok()) {
+      HandleTickResult(proc, tick_result.value());
+    }
+  }
+}
+
+void ThreadedProcRuntime::HandleTickResult(Proc* proc,
+                                           const TickResult& tick_result) {
+  // The tick may have received from a channel a proc is blocked sending on.
+  if (!blocked_senders_.empty()) {
+    WakeBlockedSenders(&blocked_senders_, &ready_procs_);
+  }
+  if (tick_result.execution_state == TickExecutionState::kSentOnChannel) {
+    Channel* channel = tick_result.channel.value();
+    auto it = blocked_procs_.find(channel);
+    if (it != blocked_procs_.end()) {
+      XLS_VLOG(3) << absl::StreamFormat(
+          "Unblocking proc `%s` and adding to ready list",
+          it->second->name());
+      ready_procs_.push_back(it->second);
+      blocked_procs_.erase(it);
+    }
+    // This proc can go back on the ready queue.
+    ready_procs_.push_back(proc);
+  } else if (tick_result.execution_state ==
+             TickExecutionState::kBlockedOnReceive) {
+    Channel* channel = tick_result.channel.value();
+    // Another proc may have sent on the channel after this proc found it empty
+    // but before this result was handled. In that case the send did not see
+    // this proc as blocked so retry the receive immediately.
+    if (!queue_manager_->GetQueue(channel).IsEmpty()) {
+      ready_procs_.push_back(proc);
+      return;
+    }
+    XLS_VLOG(3) << absl::StreamFormat(
+        "Proc `%s` is now blocked on channel `%s`", proc->name(),
+        channel->ToString());
+    blocked_procs_[channel] = proc;
+  } else if (tick_result.execution_state ==
+             TickExecutionState::kBlockedOnSend) {
+    Channel* channel = tick_result.channel.value();
+    // As above, a receive may have made room in the queue after the send found
+    // it full.
+    if (!queue_manager_->GetQueue(channel).IsFull()) {
+      ready_procs_.push_back(proc);
+      return;
+    }
+    XLS_VLOG(3) << absl::StreamFormat(
+        "Proc `%s` is now blocked on send to full channel `%s`", proc->name(),
+        channel->ToString());
+    blocked_senders_[channel] = proc;
+  }
+}
+
+absl::StatusOr<ThreadedProcRuntime::NetworkTickResult>
+ThreadedProcRuntime::TickInternal() {
+  XLS_VLOG(3) << absl::StreamFormat("TickInternal on package %s",
+                                    package_->name());
+  absl::MutexLock lock(&mutex_);
+  XLS_RET_CHECK(ready_procs_.empty());
+  XLS_RET_CHECK_EQ(active_count_, 0);
+  blocked_procs_.clear();
+  blocked_senders_.clear();
+  progress_made_ = false;
+  progress_made_on_io_procs_ = false;
+  status_ = absl::OkStatus();
+
+  // Put all runnable procs on the ready list and wake the workers. Procs
+  // still parked on an empty (or full) channel since the previous tick start
+  // out blocked.
+  for (Proc* proc : GetRunnableProcs(&blocked_procs_, &blocked_senders_)) {
+    XLS_VLOG(3) << absl::StreamFormat("Proc `%s` added to ready list",
+                                      proc->name());
+    ready_procs_.push_back(proc);
+  }
+
+  // Wait for quiescence: no proc is running and none is ready to run. Any proc
+  // still blocked at this point can only be unblocked by a value written from
+  // outside the network.
+  mutex_.Await(absl::Condition(
+      +[](ThreadedProcRuntime* runtime)
+           ABSL_EXCLUSIVE_LOCKS_REQUIRED(runtime->mutex_) {
+             return runtime->ready_procs_.empty() &&
+                    runtime->active_count_ == 0;
+           },
+      this));
+  if (!status_.ok()) {
+    parked_procs_.clear();
+    return status_;
+  }
+  ParkBlockedProcs(blocked_procs_, blocked_senders_);
+
+  std::vector<Channel*> blocked_channels;
+  for (auto [channel, proc] : blocked_procs_) {
+    blocked_channels.push_back(channel);
+  }
+  for (auto [channel, proc] : blocked_senders_) {
+    blocked_channels.push_back(channel);
+  }
+  std::sort(blocked_channels.begin(), blocked_channels.end(),
+            [](Channel* a, Channel* b) { return a->id() < b->id(); });
+  return NetworkTickResult{
+      .progress_made = progress_made_,
+      .progress_made_on_io_procs = progress_made_on_io_procs_,
+      .blocked_channels = std::move(blocked_channels),
+  };
+}
+
+}  // namespace xls
@@ -0,0 +1,105 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_THREADED_PROC_RUNTIME_H_
+#define XLS_INTERPRETER_THREADED_PROC_RUNTIME_H_
+
+#include <deque>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// Class for interpreting a network of procs using a pool of worker threads.
+// The semantics of a network tick are identical to SerialProcRuntime: each
+// proc executes (up to) one iteration, procs blocked on a receive are resumed
+// when a value is sent on the channel, and the tick completes when the network
+// is quiescent (no proc is running and no proc is ready to run). Unlike
+// SerialProcRuntime, independent procs execute concurrently so the channel
+// queues in the queue manager must be thread-safe. A single proc is never
+// ticked by more than one thread at a time.
+class ThreadedProcRuntime : public ProcRuntime {
+ public:
+  // Creates and returns a threaded proc network interpreter for the given
+  // package. `thread_count` is the number of worker threads. If not specified
+  // the number of available CPUs is used.
+  static absl::StatusOr<std::unique_ptr<ThreadedProcRuntime>> Create(
+      Package* package,
+      std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+      std::unique_ptr<ChannelQueueManager>&& queue_manager,
+      std::optional<int64_t> thread_count = std::nullopt);
+
+  ~ThreadedProcRuntime() override;
+
+  int64_t thread_count() const { return workers_.size(); }
+
+ private:
+  ThreadedProcRuntime(
+      Package* package,
+      absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>>&& evaluators,
+      std::unique_ptr<ChannelQueueManager>&& queue_manager)
+      : ProcRuntime(package, std::move(evaluators), std::move(queue_manager)) {}
+
+  absl::StatusOr<NetworkTickResult> TickInternal() override;
+
+  // Main loop of each worker thread. Repeatedly takes a proc off the ready
+  // list and ticks it until the runtime is destroyed.
+  void WorkerLoop();
+
+  // Updates the scheduling state after `proc` was ticked with the given
+  // result.
+  void HandleTickResult(Proc* proc, const TickResult& tick_result)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  absl::Mutex mutex_;
+
+  // Procs which may be ticked.
+  std::deque<Proc*> ready_procs_ ABSL_GUARDED_BY(mutex_);
+
+  // Procs blocked on a receive indexed by the channel they are blocked on.
+  absl::flat_hash_map<Channel*, Proc*> blocked_procs_ ABSL_GUARDED_BY(mutex_);
+
+  // Procs blocked on a send to a full bounded queue indexed by the channel.
+  absl::flat_hash_map<Channel*, Proc*> blocked_senders_
+      ABSL_GUARDED_BY(mutex_);
+
+  // Number of procs currently being ticked by a worker.
+  int64_t active_count_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  // Accumulated results of the current network tick.
+  bool progress_made_ ABSL_GUARDED_BY(mutex_) = false;
+  bool progress_made_on_io_procs_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+
+  // Set when the runtime is destroyed to terminate the workers.
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+
+  std::vector<std::unique_ptr<Thread>> workers_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_THREADED_PROC_RUNTIME_H_
@@ -0,0 +1,188 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/activity_profile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+
+namespace xls {
+namespace {
+
+// Returns the names of the counters of `node` in index order.
+std::vector<std::string> CounterNames(Node* node) {
+  std::vector<std::string> names;
+  auto add_cases = [&](int64_t case_count) {
+    for (int64_t i = 0; i < case_count; ++i) {
+      names.push_back(absl::StrCat("case ", i));
+    }
+  };
+  switch (node->op()) {
+    case Op::kSel:
+      add_cases(node->As<Select>()->cases().size());
+      if (node->As<Select>()->default_value().has_value()) {
+        names.push_back("default");
+      }
+      break;
+    case Op::kPrioritySel:
+      add_cases(node->As<PrioritySelect>()->cases().size());
+      names.push_back("none");
+      break;
+    case Op::kOneHotSel:
+      add_cases(node->As<OneHotSelect>()->cases().size());
+      names.push_back("none");
+      break;
+    case Op::kSend:
+      names = {"fired", "predicate false"};
+      break;
+    case Op::kReceive:
+      names = {"fired", "predicate false",
+               node->As<Receive>()->is_blocking() ? "blocked" : "no data"};
+      break;
+    case Op::kAssert:
+    case Op::kCover:
+    case Op::kGate:
+    case Op::kTrace:
+      names = {"true", "false"};
+      break;
+    default:
+      break;
+  }
+  return names;
+}
+
+}  // namespace
+
+ActivityProfile::ActivityProfile(FunctionBase* function_base)
+    : function_base_(function_base) {
+  int64_t counter_count = 0;
+  for (Node* node : function_base->nodes()) {
+    int64_t node_counters = CounterCount(node);
+    if (node_counters > 0) {
+      offsets_[node] = counter_count;
+      counter_count += node_counters;
+    }
+  }
+  counters_.resize(counter_count, 0);
+}
+
+int64_t ActivityProfile::CounterCount(Node* node) {
+  switch (node->op()) {
+    case Op::kSel:
+      return node->As<Select>()->cases().size() +
+             (node->As<Select>()->default_value().has_value() ? 1 : 0);
+    case Op::kPrioritySel:
+      return node->As<PrioritySelect>()->cases().size() + 1;
+    case Op::kOneHotSel:
+      return node->As<OneHotSelect>()->cases().size() + 1;
+    case Op::kSend:
+      return 2;
+    case Op::kReceive:
+      return 3;
+    case Op::kAssert:
+    case Op::kCover:
+    case Op::kGate:
+    case Op::kTrace:
+      return 2;
+    default:
+      return 0;
+  }
+}
+
+absl::Span<int64_t> ActivityProfile::GetCounters(Node* node) {
+  auto it = offsets_.find(node);
+  if (it == offsets_.end()) {
+    return {};
+  }
+  return absl::MakeSpan(counters_).subspan(it->second, CounterCount(node));
+}
+
+absl::Span<const int64_t> ActivityProfile::GetCounters(Node* node) const {
+  auto it = offsets_.find(node);
+  if (it == offsets_.end()) {
+    return {};
+  }
+  return absl::MakeConstSpan(counters_).subspan(it->second,
+                                                CounterCount(node));
+}
+
+void ActivityProfile::RecordSelector(Node* node, const Bits& selector) {
+  absl::Span<int64_t> counters = GetCounters(node);
+  if (counters.empty()) {
+    return;
+  }
+  int64_t case_count = counters.size() - 1;
+  switch (node->op()) {
+    case Op::kSel: {
+      // Without a default value every selector value picks a case.
+      if (!node->As<Select>()->default_value().has_value()) {
+        case_count = counters.size();
+      }
+      if (bits_ops::ULessThan(selector, case_count)) {
+        ++counters[selector.ToUint64().value()];
+      } else {
+        ++counters[case_count];
+      }
+      break;
+    }
+    case Op::kPrioritySel:
+      ++counters[std::min(selector.CountTrailingZeros(), case_count)];
+      break;
+    case Op::kOneHotSel:
+      for (int64_t i = 0; i < case_count; ++i) {
+        counters[i] += selector.Get(i) ? 1 : 0;
+      }
+      counters[case_count] += selector.IsZero() ? 1 : 0;
+      break;
+    default:
+      break;
+  }
+}
+
+void ActivityProfile::Clear() {
+  std::fill(counters_.begin(), counters_.end(), 0);
+}
+
+std::string ActivityProfile::ToString() const {
+  std::string out = absl::StrFormat("Activity profile of %s:\n",
+                                    function_base_->name());
+  for (Node* node : function_base_->nodes()) {
+    absl::Span<const int64_t> counters = GetCounters(node);
+    if (counters.empty()) {
+      continue;
+    }
+    std::vector<std::string> names = CounterNames(node);
+    std::vector<std::string> entries;
+    for (int64_t i = 0; i < counters.size(); ++i) {
+      entries.push_back(absl::StrFormat("%s: %d", names[i], counters[i]));
+    }
+    absl::StrAppendFormat(&out, "  %s: %s\n", node->GetName(),
+                          absl::StrJoin(entries, ", "));
+  }
+  return out;
+}
+
+}  // namespace xls
@@ -0,0 +1,113 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_ACTIVITY_PROFILE_H_
+#define XLS_IR_ACTIVITY_PROFILE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// Counters recording the data-dependent behavior of the nodes of a single
+// FunctionBase over any number of evaluations: which arms of selects are
+// chosen, how often the conditions of predicated operations hold, and how often
+// channel operations fire or find no data. Counters are filled in by
+// evaluators (IR interpreter or JIT) created with activity profiling enabled.
+//
+// Each instrumented node owns a contiguous run of counters:
+//
+//   sel:             one counter per case, plus one for the default value if
+//                    present.
+//   priority_sel:    one counter per case, plus one for the selector being
+//                    zero.
+//   one_hot_sel:     one counter per selector bit counting how often the bit
+//                    is set, plus one for the selector being zero.
+//   send, receive:   indexed by kChannelOpFired, kChannelOpPredicateFalse and
+//                    (receives only) kChannelOpNoData. A blocking receive
+//                    counts as no data each time it is attempted while its
+//                    queue is empty.
+//   assert, cover,
+//   gate, trace:     indexed by kConditionTrue and kConditionFalse.
+//
+// The counter storage is allocated once at construction so its address is
+// stable; the JIT embeds counter addresses directly in the generated code.
+// Counters are not updated atomically.
+class ActivityProfile {
+ public:
+  static constexpr int64_t kChannelOpFired = 0;
+  static constexpr int64_t kChannelOpPredicateFalse = 1;
+  static constexpr int64_t kChannelOpNoData = 2;
+
+  static constexpr int64_t kConditionTrue = 0;
+  static constexpr int64_t kConditionFalse = 1;
+
+  explicit ActivityProfile(FunctionBase* function_base);
+
+  ActivityProfile(const ActivityProfile&) = delete;
+  ActivityProfile& operator=(const ActivityProfile&) = delete;
+
+  // Returns the number of counters allocated for `node`. Returns zero if the
+  // node is not instrumented.
+  static int64_t CounterCount(Node* node);
+
+  FunctionBase* function_base() const { return function_base_; }
+
+  // Returns the counters for `node`. Returns an empty span if `node` is not
+  // instrumented or does not belong to the profiled FunctionBase.
+  absl::Span<int64_t> GetCounters(Node* node);
+  absl::Span<const int64_t> GetCounters(Node* node) const;
+
+  // Increments the `index`-th counter of `node`. Does nothing if `node` has no
+  // counters.
+  void Increment(Node* node, int64_t index) {
+    auto it = offsets_.find(node);
+    if (it != offsets_.end()) {
+      ++counters_[it->second + index];
+    }
+  }
+
+  // Records the value of the selector of the select-like node `node`.
+  void RecordSelector(Node* node, const Bits& selector);
+
+  // Records whether the condition (or predicate) of `node` held.
+  void RecordCondition(Node* node, bool condition) {
+    Increment(node, condition ? kConditionTrue : kConditionFalse);
+  }
+
+  // Sets all counters to zero.
+  void Clear();
+
+  // Returns a human-readable dump of the counters, one instrumented node per
+  // line.
+  std::string ToString() const;
+
+ private:
+  FunctionBase* function_base_;
+
+  // Index of the first counter of each instrumented node in `counters_`.
+  absl::flat_hash_map<Node*, int64_t> offsets_;
+  std::vector<int64_t> counters_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_ACTIVITY_PROFILE_H_
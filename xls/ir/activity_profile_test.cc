@@ -0,0 +1,69 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/activity_profile.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+
+class ActivityProfileTest : public IrTestBase {};
+
+TEST_F(ActivityProfileTest, RecordsSelectors) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue s = fb.Param("s", p->GetBitsType(2));
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue sel = fb.Select(s, {x, y}, /*default_value=*/x);
+  BValue priority_sel = fb.PrioritySelect(s, {x, y});
+  BValue one_hot_sel = fb.OneHotSelect(s, {x, y});
+  BValue gate = fb.Gate(fb.BitSlice(s, 0, 1), x);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * f,
+      fb.BuildWithReturnValue(
+          fb.Tuple({sel, priority_sel, one_hot_sel, gate})));
+
+  ActivityProfile profile(f);
+  EXPECT_THAT(profile.GetCounters(x.node()), IsEmpty());
+  for (int64_t selector : {0, 1, 2, 3, 3}) {
+    profile.RecordSelector(sel.node(), UBits(selector, 2));
+    profile.RecordSelector(priority_sel.node(), UBits(selector, 2));
+    profile.RecordSelector(one_hot_sel.node(), UBits(selector, 2));
+    profile.RecordCondition(gate.node(), (selector & 1) != 0);
+  }
+
+  EXPECT_THAT(profile.GetCounters(sel.node()), ElementsAre(1, 1, 3));
+  EXPECT_THAT(profile.GetCounters(priority_sel.node()), ElementsAre(3, 1, 1));
+  EXPECT_THAT(profile.GetCounters(one_hot_sel.node()), ElementsAre(3, 3, 1));
+  EXPECT_THAT(profile.GetCounters(gate.node()), ElementsAre(3, 2));
+  EXPECT_THAT(profile.ToString(),
+              HasSubstr("case 0: 1, case 1: 1, default: 3"));
+
+  profile.Clear();
+  EXPECT_THAT(profile.GetCounters(sel.node()), ElementsAre(0, 0, 0));
+}
+
+}  // namespace
+}  // namespace xls
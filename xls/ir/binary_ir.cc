@@ -0,0 +1,1293 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/binary_ir.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/casts.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel.pb.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/foreign_function_data.pb.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/format_strings.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/instantiation.h"
+#include "xls/ir/lsb_or_msb.h"
+#include "xls/ir/node.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/register.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/verifier.h"
+
+namespace xls {
+namespace {
+
+// The leading NUL byte guarantees binary IR is never mistaken for IR text.
+constexpr std::string_view kMagic("\0xlsir", 6);
+
+enum class FunctionBaseKind : uint8_t { kFunction, kProc, kBlock };
+
+// Appends primitive values to a byte buffer. Unsigned integers are LEB128
+// varints, signed integers are zigzag encoded varints, and strings are
+// length-prefixed.
+class Writer {
+ public:
+  void Byte(uint8_t value) { data_.push_back(static_cast<char>(value)); }
+  void Bool(bool value) { Byte(value ? 1 : 0); }
+  void Varint(uint64_t value) {
+    while (value >= 0x80) {
+      Byte(static_cast<uint8_t>(value) | 0x80);
+      value >>= 7;
+    }
+    Byte(static_cast<uint8_t>(value));
+  }
+  void Signed(int64_t value) {
+    Varint((static_cast<uint64_t>(value) << 1) ^
+           static_cast<uint64_t>(value >> 63));
+  }
+  void String(std::string_view value) {
+    Varint(value.size());
+    data_.append(value);
+  }
+  void OptionalString(const std::optional<std::string>& value) {
+    Bool(value.has_value());
+    if (value.has_value()) {
+      String(*value);
+    }
+  }
+
+  const std::string& data() const { return data_; }
+
+ private:
+  std::string data_;
+};
+
+// Reads the primitive values written by Writer. Every read is bounds checked
+// so truncated or corrupt input produces an error rather than a crash.
+class Reader {
+ public:
+  explicit Reader(std::string_view data) : data_(data) {}
+
+  absl::StatusOr<uint8_t> Byte() {
+    if (data_.empty()) {
+      return absl::InvalidArgumentError("Binary IR is truncated");
+    }
+    uint8_t value = static_cast<uint8_t>(data_.front());
+    data_.remove_prefix(1);
+    return value;
+  }
+  absl::StatusOr<bool> Bool() {
+    XLS_ASSIGN_OR_RETURN(uint8_t value, Byte());
+    if (value > 1) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid boolean in binary IR: %d", value));
+    }
+    return value == 1;
+  }
+  absl::StatusOr<uint64_t> Varint() {
+    uint64_t value = 0;
+    for (int64_t shift = 0; shift < 64; shift += 7) {
+      XLS_ASSIGN_OR_RETURN(uint8_t byte, Byte());
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+    return absl::InvalidArgumentError("Invalid varint in binary IR");
+  }
+  // Reads a varint which is used as a count, size, or index and so must fit
+  // in an int64_t.
+  absl::StatusOr<int64_t> Count() {
+    XLS_ASSIGN_OR_RETURN(uint64_t value, Varint());
+    if (value > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+      return absl::InvalidArgumentError("Count out of range in binary IR");
+    }
+    return static_cast<int64_t>(value);
+  }
+  absl::StatusOr<int64_t> Signed() {
+    XLS_ASSIGN_OR_RETURN(uint64_t value, Varint());
+    return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+  }
+  absl::StatusOr<std::string_view> Bytes(int64_t size) {
+    if (size > data_.size()) {
+      return absl::InvalidArgumentError("Binary IR is truncated");
+    }
+    std::string_view value = data_.substr(0, size);
+    data_.remove_prefix(size);
+    return value;
+  }
+  absl::StatusOr<std::string> String() {
+    XLS_ASSIGN_OR_RETURN(int64_t size, Count());
+    XLS_ASSIGN_OR_RETURN(std::string_view value, Bytes(size));
+    return std::string(value);
+  }
+  absl::StatusOr<std::optional<std::string>> OptionalString() {
+    XLS_ASSIGN_OR_RETURN(bool present, Bool());
+    if (!present) {
+      return std::nullopt;
+    }
+    return String();
+  }
+
+  bool AtEnd() const { return data_.empty(); }
+
+ private:
+  std::string_view data_;
+};
+
+// Returns the value read by `reader` as an enum of type `EnumT` whose
+// enumerators are numbered contiguously from zero up to `last`.
+template <typename EnumT>
+absl::StatusOr<EnumT> ReadEnum(Reader& reader, EnumT last) {
+  XLS_ASSIGN_OR_RETURN(uint64_t value, reader.Varint());
+  if (value > static_cast<uint64_t>(last)) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid enumerator in binary IR: %d", value));
+  }
+  return static_cast<EnumT>(value);
+}
+
+class BinaryIrWriter {
+ public:
+  explicit BinaryIrWriter(const Package* package) : package_(package) {}
+
+  absl::StatusOr<std::string> Write() {
+    std::vector<std::pair<Fileno, std::string>> filenos(
+        package_->fileno_to_name().begin(), package_->fileno_to_name().end());
+    std::sort(filenos.begin(), filenos.end());
+    body_.Varint(filenos.size());
+    for (const auto& [fileno, filename] : filenos) {
+      body_.Signed(fileno.value());
+      body_.String(filename);
+    }
+
+    body_.Varint(package_->channels().size());
+    for (Channel* channel : package_->channels()) {
+      WriteChannel(channel);
+    }
+
+    // All function bases are declared before any is defined so that nodes and
+    // instantiations can refer to function bases by index regardless of the
+    // order in which they appear in the package.
+    std::vector<FunctionBase*> function_bases = package_->GetFunctionBases();
+    for (int64_t i = 0; i < function_bases.size(); ++i) {
+      function_base_indices_[function_bases[i]] = i;
+    }
+    std::optional<FunctionBase*> top = package_->GetTop();
+    body_.Varint(function_bases.size());
+    for (FunctionBase* fb : function_bases) {
+      if (fb->IsFunction()) {
+        body_.Byte(static_cast<uint8_t>(FunctionBaseKind::kFunction));
+      } else if (fb->IsProc()) {
+        body_.Byte(static_cast<uint8_t>(FunctionBaseKind::kProc));
+      } else {
+        body_.Byte(static_cast<uint8_t>(FunctionBaseKind::kBlock));
+      }
+      body_.String(fb->name());
+      if (fb->IsProc()) {
+        body_.String(fb->AsProcOrDie()->TokenParam()->GetName());
+      }
+      body_.Bool(top.has_value() && top.value() == fb);
+    }
+    for (FunctionBase* fb : function_bases) {
+      XLS_RETURN_IF_ERROR(WriteFunctionBase(fb));
+    }
+
+    Writer header;
+    header.Varint(kBinaryIrVersion);
+    header.String(package_->name());
+    header.Varint(type_count_);
+    return absl::StrCat(kMagic, header.data(), types_.data(), body_.data());
+  }
+
+ private:
+  // Returns the index of `type` in the type table, adding it (and any
+  // element types) to the table if necessary.
+  int64_t TypeIndex(Type* type) {
+    auto it = type_indices_.find(type);
+    if (it != type_indices_.end()) {
+      return it->second;
+    }
+    std::vector<int64_t> element_indices;
+    if (type->IsTuple()) {
+      for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+        element_indices.push_back(TypeIndex(element_type));
+      }
+    } else if (type->IsArray()) {
+      element_indices.push_back(
+          TypeIndex(type->AsArrayOrDie()->element_type()));
+    }
+    types_.Byte(static_cast<uint8_t>(type->kind()));
+    switch (type->kind()) {
+      case TypeKind::kBits:
+        types_.Varint(type->AsBitsOrDie()->bit_count());
+        break;
+      case TypeKind::kTuple:
+        types_.Varint(element_indices.size());
+        for (int64_t index : element_indices) {
+          types_.Varint(index);
+        }
+        break;
+      case TypeKind::kArray:
+        types_.Varint(type->AsArrayOrDie()->size());
+        types_.Varint(element_indices.front());
+        break;
+      case TypeKind::kToken:
+        break;
+    }
+    int64_t index = type_count_++;
+    type_indices_[type] = index;
+    return index;
+  }
+
+  // Values are written without their type, which the reader always knows
+  // from context (e.g., the type of the literal node).
+  void WriteValue(const Value& value) {
+    if (value.IsBits()) {
+      const Bits& bits = value.bits();
+      if (bits.bit_count() <= 64) {
+        body_.Varint(bits.ToUint64().value());
+      } else {
+        std::vector<uint8_t> bytes = bits.ToBytes();
+        body_.String(std::string_view(reinterpret_cast<const char*>(
+                                          bytes.data()),
+                                      bytes.size()));
+      }
+    } else if (value.IsTuple() || value.IsArray()) {
+      for (const Value& element : value.elements()) {
+        WriteValue(element);
+      }
+    }
+  }
+
+  void WriteSourceInfo(const SourceInfo& loc) {
+    body_.Varint(loc.locations.size());
+    for (const SourceLocation& location : loc.locations) {
+      body_.Signed(location.fileno().value());
+      body_.Signed(location.lineno().value());
+      body_.Signed(location.colno().value());
+    }
+  }
+
+  void WriteChannel(Channel* channel) {
+    body_.String(channel->name());
+    body_.Varint(channel->id());
+    body_.Byte(static_cast<uint8_t>(channel->kind()));
+    body_.Byte(static_cast<uint8_t>(channel->supported_ops()));
+    body_.Varint(TypeIndex(channel->type()));
+    if (channel->kind() == ChannelKind::kStreaming) {
+      StreamingChannel* streaming = down_cast<StreamingChannel*>(channel);
+      body_.Varint(channel->initial_values().size());
+      for (const Value& value : channel->initial_values()) {
+        WriteValue(value);
+      }
+      body_.Bool(streaming->GetFifoDepth().has_value());
+      if (streaming->GetFifoDepth().has_value()) {
+        body_.Varint(*streaming->GetFifoDepth());
+      }
+      body_.Byte(static_cast<uint8_t>(streaming->GetFlowControl()));
+      body_.Byte(static_cast<uint8_t>(streaming->GetStrictness()));
+    }
+    body_.String(channel->metadata().SerializeAsString());
+  }
+
+  void WriteNodeReference(Node* node) {
+    body_.Varint(node_indices_.at(node));
+  }
+
+  void WriteFunctionBaseReference(FunctionBase* fb) {
+    body_.Varint(function_base_indices_.at(fb));
+  }
+
+  absl::Status WriteFunctionBase(FunctionBase* fb) {
+    body_.Bool(fb->GetInitiationInterval().has_value());
+    if (fb->GetInitiationInterval().has_value()) {
+      body_.Varint(*fb->GetInitiationInterval());
+    }
+    body_.Bool(fb->ForeignFunctionData().has_value());
+    if (fb->ForeignFunctionData().has_value()) {
+      body_.String(fb->ForeignFunctionData()->SerializeAsString());
+    }
+
+    node_indices_.clear();
+    if (fb->IsFunction()) {
+      body_.Varint(fb->params().size());
+      for (Param* param : fb->params()) {
+        WriteParam(param);
+      }
+    } else if (fb->IsProc()) {
+      Proc* proc = fb->AsProcOrDie();
+      WriteParam(proc->TokenParam());
+      body_.Varint(proc->GetStateElementCount());
+      for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
+        WriteParam(proc->GetStateParam(i));
+        WriteValue(proc->GetInitValueElement(i));
+      }
+    } else {
+      Block* block = fb->AsBlockOrDie();
+      body_.Varint(block->GetRegisters().size());
+      for (Register* reg : block->GetRegisters()) {
+        body_.String(reg->name());
+        body_.Varint(TypeIndex(reg->type()));
+        body_.Bool(reg->reset().has_value());
+        if (reg->reset().has_value()) {
+          WriteValue(reg->reset()->reset_value);
+          body_.Bool(reg->reset()->asynchronous);
+          body_.Bool(reg->reset()->active_low);
+        }
+      }
+      body_.Varint(block->GetInstantiations().size());
+      for (Instantiation* instantiation : block->GetInstantiations()) {
+        body_.String(instantiation->name());
+        body_.Byte(static_cast<uint8_t>(instantiation->kind()));
+        if (instantiation->kind() == InstantiationKind::kBlock) {
+          WriteFunctionBaseReference(
+              down_cast<BlockInstantiation*>(instantiation)
+                  ->instantiated_block());
+        } else {
+          return absl::UnimplementedError(absl::StrFormat(
+              "Binary IR does not support %s instantiation `%s`",
+              InstantiationKindToString(instantiation->kind()),
+              instantiation->name()));
+        }
+      }
+    }
+
+    body_.Varint(fb->node_count() - fb->params().size());
+    for (Node* node : TopoSort(fb)) {
+      if (!node->Is<Param>()) {
+        XLS_RETURN_IF_ERROR(WriteNode(node));
+      }
+    }
+
+    if (fb->IsFunction()) {
+      Node* return_value = fb->AsFunctionOrDie()->return_value();
+      body_.Varint(
+          return_value == nullptr ? 0 : node_indices_.at(return_value) + 1);
+    } else if (fb->IsProc()) {
+      Proc* proc = fb->AsProcOrDie();
+      WriteNodeReference(proc->NextToken());
+      for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
+        WriteNodeReference(proc->GetNextStateElement(i));
+      }
+    } else {
+      Block* block = fb->AsBlockOrDie();
+      body_.OptionalString(
+          block->GetClockPort().has_value()
+              ? std::make_optional(block->GetClockPort()->name)
+              : std::nullopt);
+      body_.Varint(block->GetPorts().size());
+      for (const Block::Port& port : block->GetPorts()) {
+        body_.String(Block::PortName(port));
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  void WriteParam(Param* param) {
+    node_indices_[param] = node_indices_.size();
+    body_.Varint(param->id());
+    body_.String(param->GetName());
+    body_.Varint(TypeIndex(param->GetType()));
+    WriteSourceInfo(param->loc());
+  }
+
+  absl::Status WriteNode(Node* node) {
+    node_indices_[node] = node_indices_.size();
+    body_.Varint(static_cast<uint64_t>(node->op()));
+    body_.Varint(node->id());
+    body_.String(node->HasAssignedName() ? node->GetName() : "");
+    body_.Varint(TypeIndex(node->GetType()));
+    WriteSourceInfo(node->loc());
+    body_.Varint(node->operand_count());
+    for (Node* operand : node->operands()) {
+      WriteNodeReference(operand);
+    }
+
+    if (node->Is<MinDelay>()) {
+      body_.Varint(node->As<MinDelay>()->delay());
+    } else if (node->Is<Array>()) {
+      body_.Varint(TypeIndex(node->As<Array>()->element_type()));
+    } else if (node->Is<ArraySlice>()) {
+      body_.Varint(node->As<ArraySlice>()->width());
+    } else if (node->Is<ArithOp>()) {
+      body_.Varint(node->As<ArithOp>()->width());
+    } else if (node->Is<PartialProductOp>()) {
+      body_.Varint(node->As<PartialProductOp>()->width());
+    } else if (node->Is<Assert>()) {
+      body_.String(node->As<Assert>()->message());
+      body_.OptionalString(node->As<Assert>()->label());
+      body_.OptionalString(node->As<Assert>()->original_label());
+    } else if (node->Is<Trace>()) {
+      absl::Span<const FormatStep> format = node->As<Trace>()->format();
+      body_.Varint(format.size());
+      for (const FormatStep& step : format) {
+        if (std::holds_alternative<std::string>(step)) {
+          body_.Byte(0);
+          body_.String(std::get<std::string>(step));
+        } else {
+          body_.Byte(1);
+          body_.Byte(static_cast<uint8_t>(std::get<FormatPreference>(step)));
+        }
+      }
+    } else if (node->Is<Cover>()) {
+      body_.String(node->As<Cover>()->label());
+      body_.OptionalString(node->As<Cover>()->original_label());
+    } else if (node->Is<Receive>()) {
+      body_.Varint(node->As<Receive>()->channel_id());
+      body_.Bool(node->As<Receive>()->is_blocking());
+    } else if (node->Is<Send>()) {
+      body_.Varint(node->As<Send>()->channel_id());
+    } else if (node->Is<BitSlice>()) {
+      body_.Varint(node->As<BitSlice>()->start());
+      body_.Varint(node->As<BitSlice>()->width());
+    } else if (node->Is<DynamicBitSlice>()) {
+      body_.Varint(node->As<DynamicBitSlice>()->width());
+    } else if (node->Is<CountedFor>()) {
+      body_.Varint(node->As<CountedFor>()->trip_count());
+      body_.Varint(node->As<CountedFor>()->stride());
+      WriteFunctionBaseReference(node->As<CountedFor>()->body());
+    } else if (node->Is<DynamicCountedFor>()) {
+      WriteFunctionBaseReference(node->As<DynamicCountedFor>()->body());
+    } else if (node->Is<ExtendOp>()) {
+      body_.Varint(node->As<ExtendOp>()->new_bit_count());
+    } else if (node->Is<Invoke>()) {
+      WriteFunctionBaseReference(node->As<Invoke>()->to_apply());
+    } else if (node->Is<Map>()) {
+      WriteFunctionBaseReference(node->As<Map>()->to_apply());
+    } else if (node->Is<Literal>()) {
+      WriteValue(node->As<Literal>()->value());
+    } else if (node->Is<OneHot>()) {
+      body_.Byte(static_cast<uint8_t>(node->As<OneHot>()->priority()));
+    } else if (node->Is<Select>()) {
+      body_.Bool(node->As<Select>()->default_value().has_value());
+    } else if (node->Is<TupleIndex>()) {
+      body_.Varint(node->As<TupleIndex>()->index());
+    } else if (node->Is<Decode>()) {
+      body_.Varint(node->As<Decode>()->width());
+    } else if (node->Is<RegisterRead>()) {
+      body_.String(node->As<RegisterRead>()->GetRegister()->name());
+    } else if (node->Is<RegisterWrite>()) {
+      RegisterWrite* reg_write = node->As<RegisterWrite>();
+      body_.String(reg_write->GetRegister()->name());
+      body_.Bool(reg_write->load_enable().has_value());
+      body_.Bool(reg_write->reset().has_value());
+    } else if (node->Is<InstantiationInput>()) {
+      body_.String(node->As<InstantiationInput>()->instantiation()->name());
+      body_.String(node->As<InstantiationInput>()->port_name());
+    } else if (node->Is<InstantiationOutput>()) {
+      body_.String(node->As<InstantiationOutput>()->instantiation()->name());
+      body_.String(node->As<InstantiationOutput>()->port_name());
+    }
+    return absl::OkStatus();
+  }
+
+  const Package* package_;
+  Writer types_;
+  Writer body_;
+  int64_t type_count_ = 0;
+  absl::flat_hash_map<Type*, int64_t> type_indices_;
+  absl::flat_hash_map<FunctionBase*, int64_t> function_base_indices_;
+  absl::flat_hash_map<Node*, int64_t> node_indices_;
+};
+
+class BinaryIrReader {
+ public:
+  explicit BinaryIrReader(std::string_view data) : reader_(data) {}
+
+  absl::StatusOr<std::unique_ptr<Package>> Read() {
+    XLS_ASSIGN_OR_RETURN(std::string_view magic, reader_.Bytes(kMagic.size()));
+    if (magic != kMagic) {
+      return absl::InvalidArgumentError("Data is not binary IR");
+    }
+    XLS_ASSIGN_OR_RETURN(uint64_t version, reader_.Varint());
+    if (version != kBinaryIrVersion) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Unsupported binary IR version %d; expected version %d", version,
+          kBinaryIrVersion));
+    }
+
+    XLS_ASSIGN_OR_RETURN(std::string name, reader_.String());
+    package_ = std::make_unique<Package>(name);
+    XLS_ASSIGN_OR_RETURN(int64_t type_count, reader_.Count());
+    for (int64_t i = 0; i < type_count; ++i) {
+      XLS_RETURN_IF_ERROR(ReadType());
+    }
+
+    XLS_ASSIGN_OR_RETURN(int64_t fileno_count, reader_.Count());
+    for (int64_t i = 0; i < fileno_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(int64_t fileno, reader_.Signed());
+      XLS_ASSIGN_OR_RETURN(std::string filename, reader_.String());
+      package_->SetFileno(Fileno(fileno), filename);
+    }
+
+    XLS_ASSIGN_OR_RETURN(int64_t channel_count, reader_.Count());
+    for (int64_t i = 0; i < channel_count; ++i) {
+      XLS_RETURN_IF_ERROR(ReadChannel());
+    }
+
+    XLS_ASSIGN_OR_RETURN(int64_t function_base_count, reader_.Count());
+    std::optional<FunctionBase*> top;
+    for (int64_t i = 0; i < function_base_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(FunctionBaseKind kind,
+                           ReadEnum(reader_, FunctionBaseKind::kBlock));
+      XLS_ASSIGN_OR_RETURN(std::string fb_name, reader_.String());
+      FunctionBase* fb;
+      if (kind == FunctionBaseKind::kFunction) {
+        fb = package_->AddFunction(
+            std::make_unique<Function>(fb_name, package_.get()));
+      } else if (kind == FunctionBaseKind::kProc) {
+        XLS_ASSIGN_OR_RETURN(std::string token_name, reader_.String());
+        fb = package_->AddProc(
+            std::make_unique<Proc>(fb_name, token_name, package_.get()));
+      } else {
+        fb = package_->AddBlock(
+            std::make_unique<Block>(fb_name, package_.get()));
+      }
+      function_bases_.push_back(fb);
+      XLS_ASSIGN_OR_RETURN(bool is_top, reader_.Bool());
+      if (is_top) {
+        top = fb;
+      }
+    }
+    for (FunctionBase* fb : function_bases_) {
+      XLS_RETURN_IF_ERROR(ReadFunctionBase(fb));
+    }
+    if (!reader_.AtEnd()) {
+      return absl::InvalidArgumentError("Trailing data after binary IR");
+    }
+    if (top.has_value()) {
+      XLS_RETURN_IF_ERROR(package_->SetTop(top));
+    }
+    XLS_RETURN_IF_ERROR(VerifyPackage(package_.get()));
+    return std::move(package_);
+  }
+
+ private:
+  absl::Status ReadType() {
+    XLS_ASSIGN_OR_RETURN(TypeKind kind, ReadEnum(reader_, TypeKind::kToken));
+    switch (kind) {
+      case TypeKind::kBits: {
+        XLS_ASSIGN_OR_RETURN(int64_t bit_count, reader_.Count());
+        types_.push_back(package_->GetBitsType(bit_count));
+        break;
+      }
+      case TypeKind::kTuple: {
+        XLS_ASSIGN_OR_RETURN(int64_t size, reader_.Count());
+        std::vector<Type*> element_types;
+        for (int64_t i = 0; i < size; ++i) {
+          XLS_ASSIGN_OR_RETURN(Type * element_type, ReadTypeReference());
+          element_types.push_back(element_type);
+        }
+        types_.push_back(package_->GetTupleType(element_types));
+        break;
+      }
+      case TypeKind::kArray: {
+        XLS_ASSIGN_OR_RETURN(int64_t size, reader_.Count());
+        XLS_ASSIGN_OR_RETURN(Type * element_type, ReadTypeReference());
+        types_.push_back(package_->GetArrayType(size, element_type));
+        break;
+      }
+      case TypeKind::kToken:
+        types_.push_back(package_->GetTokenType());
+        break;
+    }
+    return absl::OkStatus();
+  }
+
+  absl::StatusOr<Type*> ReadTypeReference() {
+    XLS_ASSIGN_OR_RETURN(int64_t index, reader_.Count());
+    if (index >= types_.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid type index in binary IR: %d", index));
+    }
+    return types_[index];
+  }
+
+  absl::StatusOr<Value> ReadValue(Type* type) {
+    switch (type->kind()) {
+      case TypeKind::kBits: {
+        int64_t bit_count = type->AsBitsOrDie()->bit_count();
+        if (bit_count <= 64) {
+          XLS_ASSIGN_OR_RETURN(uint64_t value, reader_.Varint());
+          if (bit_count < 64 && (value >> bit_count) != 0) {
+            return absl::InvalidArgumentError(absl::StrFormat(
+                "Value %d does not fit in %d bits", value, bit_count));
+          }
+          return Value(UBits(value, bit_count));
+        }
+        XLS_ASSIGN_OR_RETURN(std::string bytes, reader_.String());
+        if (bytes.size() != CeilOfRatio(bit_count, int64_t{8})) {
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Expected %d bytes for a %d-bit value, got %d",
+              CeilOfRatio(bit_count, int64_t{8}), bit_count, bytes.size()));
+        }
+        return Value(Bits::FromBytes(
+            absl::MakeConstSpan(reinterpret_cast<const uint8_t*>(bytes.data()),
+                                bytes.size()),
+            bit_count));
+      }
+      case TypeKind::kTuple: {
+        std::vector<Value> elements;
+        for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+          XLS_ASSIGN_OR_RETURN(Value element, ReadValue(element_type));
+          elements.push_back(std::move(element));
+        }
+        return Value::TupleOwned(std::move(elements));
+      }
+      case TypeKind::kArray: {
+        std::vector<Value> elements;
+        for (int64_t i = 0; i < type->AsArrayOrDie()->size(); ++i) {
+          XLS_ASSIGN_OR_RETURN(Value element,
+                               ReadValue(type->AsArrayOrDie()->element_type()));
+          elements.push_back(std::move(element));
+        }
+        return Value::ArrayOwned(std::move(elements));
+      }
+      case TypeKind::kToken:
+        return Value::Token();
+    }
+    XLS_LOG(FATAL) << "Invalid type kind: " << type->kind();
+  }
+
+  absl::StatusOr<SourceInfo> ReadSourceInfo() {
+    XLS_ASSIGN_OR_RETURN(int64_t count, reader_.Count());
+    SourceInfo loc;
+    for (int64_t i = 0; i < count; ++i) {
+      XLS_ASSIGN_OR_RETURN(int64_t fileno, reader_.Signed());
+      XLS_ASSIGN_OR_RETURN(int64_t lineno, reader_.Signed());
+      XLS_ASSIGN_OR_RETURN(int64_t colno, reader_.Signed());
+      loc.locations.push_back(
+          SourceLocation(Fileno(fileno), Lineno(lineno), Colno(colno)));
+    }
+    return loc;
+  }
+
+  absl::Status ReadChannel() {
+    XLS_ASSIGN_OR_RETURN(std::string name, reader_.String());
+    XLS_ASSIGN_OR_RETURN(int64_t id, reader_.Count());
+    XLS_ASSIGN_OR_RETURN(ChannelKind kind,
+                         ReadEnum(reader_, ChannelKind::kSingleValue));
+    XLS_ASSIGN_OR_RETURN(ChannelOps ops,
+                         ReadEnum(reader_, ChannelOps::kSendReceive));
+    XLS_ASSIGN_OR_RETURN(Type * type, ReadTypeReference());
+    if (kind == ChannelKind::kSingleValue) {
+      XLS_ASSIGN_OR_RETURN(ChannelMetadataProto metadata, ReadMetadata());
+      return package_->CreateSingleValueChannel(name, ops, type, metadata, id)
+          .status();
+    }
+    XLS_ASSIGN_OR_RETURN(int64_t initial_value_count, reader_.Count());
+    std::vector<Value> initial_values;
+    for (int64_t i = 0; i < initial_value_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(Value value, ReadValue(type));
+      initial_values.push_back(std::move(value));
+    }
+    std::optional<int64_t> fifo_depth;
+    XLS_ASSIGN_OR_RETURN(bool has_fifo_depth, reader_.Bool());
+    if (has_fifo_depth) {
+      XLS_ASSIGN_OR_RETURN(fifo_depth, reader_.Count());
+    }
+    XLS_ASSIGN_OR_RETURN(FlowControl flow_control,
+                         ReadEnum(reader_, FlowControl::kReadyValid));
+    XLS_ASSIGN_OR_RETURN(
+        ChannelStrictness strictness,
+        ReadEnum(reader_, ChannelStrictness::kArbitraryStaticOrder));
+    XLS_ASSIGN_OR_RETURN(ChannelMetadataProto metadata, ReadMetadata());
+    return package_
+        ->CreateStreamingChannel(name, ops, type, initial_values, fifo_depth,
+                                 flow_control, strictness, metadata, id)
+        .status();
+  }
+
+  absl::StatusOr<ChannelMetadataProto> ReadMetadata() {
+    XLS_ASSIGN_OR_RETURN(std::string serialized, reader_.String());
+    ChannelMetadataProto metadata;
+    if (!metadata.ParseFromString(serialized)) {
+      return absl::InvalidArgumentError(
+          "Invalid channel metadata in binary IR");
+    }
+    return metadata;
+  }
+
+  absl::StatusOr<FunctionBase*> ReadFunctionBaseReference() {
+    XLS_ASSIGN_OR_RETURN(int64_t index, reader_.Count());
+    if (index >= function_bases_.size()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Invalid function base reference in binary IR: %d", index));
+    }
+    return function_bases_[index];
+  }
+  absl::StatusOr<Function*> ReadFunctionReference() {
+    XLS_ASSIGN_OR_RETURN(FunctionBase * fb, ReadFunctionBaseReference());
+    if (!fb->IsFunction()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Expected `%s` to be a function", fb->name()));
+    }
+    return fb->AsFunctionOrDie();
+  }
+  absl::StatusOr<Block*> ReadBlockReference() {
+    XLS_ASSIGN_OR_RETURN(FunctionBase * fb, ReadFunctionBaseReference());
+    if (!fb->IsBlock()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Expected `%s` to be a block", fb->name()));
+    }
+    return fb->AsBlockOrDie();
+  }
+
+  absl::StatusOr<Node*> ReadNodeReference() {
+    XLS_ASSIGN_OR_RETURN(int64_t index, reader_.Count());
+    if (index >= nodes_.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid node reference in binary IR: %d", index));
+    }
+    return nodes_[index];
+  }
+
+  // The id, name, type and location of a parameter.
+  struct ParamHeader {
+    int64_t id;
+    std::string name;
+    Type* type;
+    SourceInfo loc;
+  };
+  absl::StatusOr<ParamHeader> ReadParamHeader() {
+    ParamHeader header;
+    XLS_ASSIGN_OR_RETURN(header.id, reader_.Count());
+    XLS_ASSIGN_OR_RETURN(header.name, reader_.String());
+    XLS_ASSIGN_OR_RETURN(header.type, ReadTypeReference());
+    XLS_ASSIGN_OR_RETURN(header.loc, ReadSourceInfo());
+    return header;
+  }
+
+  absl::Status ReadFunctionBase(FunctionBase* fb) {
+    XLS_ASSIGN_OR_RETURN(bool has_initiation_interval, reader_.Bool());
+    if (has_initiation_interval) {
+      XLS_ASSIGN_OR_RETURN(int64_t initiation_interval, reader_.Count());
+      fb->SetInitiationInterval(initiation_interval);
+    }
+    XLS_ASSIGN_OR_RETURN(bool has_ffi, reader_.Bool());
+    if (has_ffi) {
+      XLS_ASSIGN_OR_RETURN(std::string serialized, reader_.String());
+      ForeignFunctionData ffi;
+      if (!ffi.ParseFromString(serialized)) {
+        return absl::InvalidArgumentError(
+            "Invalid foreign function data in binary IR");
+      }
+      fb->SetForeignFunctionData(ffi);
+    }
+
+    nodes_.clear();
+    if (fb->IsFunction()) {
+      XLS_ASSIGN_OR_RETURN(int64_t param_count, reader_.Count());
+      for (int64_t i = 0; i < param_count; ++i) {
+        XLS_ASSIGN_OR_RETURN(ParamHeader header, ReadParamHeader());
+        XLS_ASSIGN_OR_RETURN(
+            Param * param,
+            fb->MakeNodeWithName<Param>(header.loc, header.name, header.type));
+        param->SetId(header.id);
+        nodes_.push_back(param);
+      }
+    } else if (fb->IsProc()) {
+      Proc* proc = fb->AsProcOrDie();
+      XLS_ASSIGN_OR_RETURN(ParamHeader token, ReadParamHeader());
+      proc->TokenParam()->SetId(token.id);
+      proc->TokenParam()->SetLoc(token.loc);
+      nodes_.push_back(proc->TokenParam());
+      XLS_ASSIGN_OR_RETURN(int64_t state_count, reader_.Count());
+      for (int64_t i = 0; i < state_count; ++i) {
+        XLS_ASSIGN_OR_RETURN(ParamHeader header, ReadParamHeader());
+        XLS_ASSIGN_OR_RETURN(Value init, ReadValue(header.type));
+        XLS_ASSIGN_OR_RETURN(Param * param,
+                             proc->AppendStateElement(header.name, init));
+        param->SetId(header.id);
+        param->SetLoc(header.loc);
+        nodes_.push_back(param);
+      }
+    } else {
+      Block* block = fb->AsBlockOrDie();
+      XLS_ASSIGN_OR_RETURN(int64_t register_count, reader_.Count());
+      for (int64_t i = 0; i < register_count; ++i) {
+        XLS_ASSIGN_OR_RETURN(std::string name, reader_.String());
+        XLS_ASSIGN_OR_RETURN(Type * type, ReadTypeReference());
+        std::optional<Reset> reset;
+        XLS_ASSIGN_OR_RETURN(bool has_reset, reader_.Bool());
+        if (has_reset) {
+          XLS_ASSIGN_OR_RETURN(Value reset_value, ReadValue(type));
+          XLS_ASSIGN_OR_RETURN(bool asynchronous, reader_.Bool());
+          XLS_ASSIGN_OR_RETURN(bool active_low, reader_.Bool());
+          reset = Reset{.reset_value = std::move(reset_value),
+                        .asynchronous = asynchronous,
+                        .active_low = active_low};
+        }
+        XLS_RETURN_IF_ERROR(block->AddRegister(name, type, reset).status());
+      }
+      XLS_ASSIGN_OR_RETURN(int64_t instantiation_count, reader_.Count());
+      for (int64_t i = 0; i < instantiation_count; ++i) {
+        XLS_ASSIGN_OR_RETURN(std::string name, reader_.String());
+        XLS_ASSIGN_OR_RETURN(InstantiationKind kind,
+                             ReadEnum(reader_, InstantiationKind::kExtern));
+        if (kind != InstantiationKind::kBlock) {
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Unsupported %s instantiation in binary IR",
+              InstantiationKindToString(kind)));
+        }
+        XLS_ASSIGN_OR_RETURN(Block * instantiated_block,
+                             ReadBlockReference());
+        XLS_RETURN_IF_ERROR(
+            block->AddBlockInstantiation(name, instantiated_block).status());
+      }
+    }
+
+    XLS_ASSIGN_OR_RETURN(int64_t node_count, reader_.Count());
+    for (int64_t i = 0; i < node_count; ++i) {
+      XLS_RETURN_IF_ERROR(ReadNode(fb));
+    }
+
+    if (fb->IsFunction()) {
+      XLS_ASSIGN_OR_RETURN(int64_t return_value, reader_.Count());
+      if (return_value > nodes_.size()) {
+        return absl::InvalidArgumentError(
+            "Invalid return value in binary IR");
+      }
+      if (return_value != 0) {
+        XLS_RETURN_IF_ERROR(fb->AsFunctionOrDie()->set_return_value(
+            nodes_[return_value - 1]));
+      }
+    } else if (fb->IsProc()) {
+      Proc* proc = fb->AsProcOrDie();
+      XLS_ASSIGN_OR_RETURN(Node * next_token, ReadNodeReference());
+      XLS_RETURN_IF_ERROR(proc->SetNextToken(next_token));
+      for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
+        XLS_ASSIGN_OR_RETURN(Node * next_state, ReadNodeReference());
+        XLS_RETURN_IF_ERROR(proc->SetNextStateElement(i, next_state));
+      }
+    } else {
+      Block* block = fb->AsBlockOrDie();
+      XLS_ASSIGN_OR_RETURN(std::optional<std::string> clock_name,
+                           reader_.OptionalString());
+      if (clock_name.has_value()) {
+        XLS_RETURN_IF_ERROR(block->AddClockPort(*clock_name));
+      }
+      XLS_ASSIGN_OR_RETURN(int64_t port_count, reader_.Count());
+      std::vector<std::string> port_names;
+      for (int64_t i = 0; i < port_count; ++i) {
+        XLS_ASSIGN_OR_RETURN(std::string port_name, reader_.String());
+        port_names.push_back(std::move(port_name));
+      }
+      XLS_RETURN_IF_ERROR(block->ReorderPorts(port_names));
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status ReadNode(FunctionBase* fb) {
+    XLS_ASSIGN_OR_RETURN(uint64_t op_value, reader_.Varint());
+    if (op_value >= kOpLimit) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid op in binary IR: %d", op_value));
+    }
+    Op op = static_cast<Op>(op_value);
+    XLS_ASSIGN_OR_RETURN(int64_t id, reader_.Count());
+    XLS_ASSIGN_OR_RETURN(std::string name, reader_.String());
+    XLS_ASSIGN_OR_RETURN(Type * type, ReadTypeReference());
+    XLS_ASSIGN_OR_RETURN(SourceInfo loc, ReadSourceInfo());
+    XLS_ASSIGN_OR_RETURN(int64_t operand_count, reader_.Count());
+    std::vector<Node*> operands;
+    for (int64_t i = 0; i < operand_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(Node * operand, ReadNodeReference());
+      operands.push_back(operand);
+    }
+
+    XLS_ASSIGN_OR_RETURN(Node * node,
+                         MakeNode(fb, op, name, type, loc, operands));
+    node->SetId(id);
+    if (node->GetType() != type) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Node %s has type %s in binary IR but type %s was inferred",
+          node->GetName(), type->ToString(), node->GetType()->ToString()));
+    }
+    nodes_.push_back(node);
+    return absl::OkStatus();
+  }
+
+  // Creates a node with the given attributes in `fb`, reading any op-specific
+  // data from the input.
+  absl::StatusOr<Node*> MakeNode(FunctionBase* fb, Op op,
+                                 std::string_view name, Type* type,
+                                 const SourceInfo& loc,
+                                 absl::Span<Node* const> operands) {
+    auto expect_operands = [&](int64_t min_count,
+                               std::optional<int64_t> max_count =
+                                   std::nullopt) -> absl::Status {
+      if (operands.size() < min_count ||
+          operands.size() > max_count.value_or(min_count)) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Invalid operand count %d for %s in binary IR",
+                            operands.size(), OpToString(op)));
+      }
+      return absl::OkStatus();
+    };
+    constexpr int64_t kVariadic = std::numeric_limits<int64_t>::max();
+
+    if (IsOpClass<AfterAll>(op)) {
+      return fb->MakeNodeWithName<AfterAll>(loc, operands, name);
+    }
+    if (IsOpClass<MinDelay>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(1));
+      XLS_ASSIGN_OR_RETURN(int64_t delay, reader_.Count());
+      return fb->MakeNodeWithName<MinDelay>(loc, operands[0], delay, name);
+    }
+    if (IsOpClass<Array>(op)) {
+      XLS_ASSIGN_OR_RETURN(Type * element_type, ReadTypeReference());
+      return fb->MakeNodeWithName<Array>(loc, operands, element_type, name);
+    }
+    if (IsOpClass<ArrayIndex>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(1, kVariadic));
+      return fb->MakeNodeWithName<ArrayIndex>(loc, operands[0],
+                                              operands.subspan(1), name);
+    }
+    if (IsOpClass<ArraySlice>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(2));
+      XLS_ASSIGN_OR_RETURN(int64_t width, reader_.Count());
+      return fb->MakeNodeWithName<ArraySlice>(loc, operands[0], operands[1],
+                                              width, name);
+    }
+    if (IsOpClass<ArrayUpdate>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(2, kVariadic));
+      return fb->MakeNodeWithName<ArrayUpdate>(
+          loc, operands[0], operands[1], operands.subspan(2), name);
+    }
+    if (IsOpClass<ArrayConcat>(op)) {
+      return fb->MakeNodeWithName<ArrayConcat>(loc, operands, name);
+    }
+    if (IsOpClass<BinOp>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(2));
+      return fb->MakeNodeWithName<BinOp>(loc, operands[0], operands[1], op,
+                                         name);
+    }
+    if (IsOpClass<ArithOp>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(2));
+      XLS_ASSIGN_OR_RETURN(int64_t width, reader_.Count());
+      return fb->MakeNodeWithName<ArithOp>(loc, operands[0], operands[1],
+                                           width, op, name);
+    }
+    if (IsOpClass<PartialProductOp>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(2));
+      XLS_ASSIGN_OR_RETURN(int64_t width, reader_.Count());
+      return fb->MakeNodeWithName<PartialProductOp>(loc, operands[0],
+                                                    operands[1], width, op,
+                                                    name);
+    }
+    if (IsOpClass<Assert>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(2));
+      XLS_ASSIGN_OR_RETURN(std::string message, reader_.String());
+      XLS_ASSIGN_OR_RETURN(std::optional<std::string> label,
+                           reader_.OptionalString());
+      XLS_ASSIGN_OR_RETURN(std::optional<std::string> original_label,
+                           reader_.OptionalString());
+      return fb->MakeNodeWithName<Assert>(loc, operands[0], operands[1],
+                                          message, label, original_label,
+                                          name);
+    }
+    if (IsOpClass<Trace>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(2, kVariadic));
+      XLS_ASSIGN_OR_RETURN(int64_t step_count, reader_.Count());
+      std::vector<FormatStep> format;
+      for (int64_t i = 0; i < step_count; ++i) {
+        XLS_ASSIGN_OR_RETURN(bool is_preference, reader_.Bool());
+        if (is_preference) {
+          XLS_ASSIGN_OR_RETURN(
+              FormatPreference preference,
+              ReadEnum(reader_, FormatPreference::kPlainHex));
+          format.push_back(preference);
+        } else {
+          XLS_ASSIGN_OR_RETURN(std::string text, reader_.String());
+          format.push_back(std::move(text));
+        }
+      }
+      return fb->MakeNodeWithName<Trace>(loc, operands[0], operands[1],
+                                         operands.subspan(2), format, name);
+    }
+    if (IsOpClass<Cover>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(2));
+      XLS_ASSIGN_OR_RETURN(std::string label, reader_.String());
+      XLS_ASSIGN_OR_RETURN(std::optional<std::string> original_label,
+                           reader_.OptionalString());
+      return fb->MakeNodeWithName<Cover>(loc, operands[0], operands[1], label,
+                                         original_label, name);
+    }
+    if (IsOpClass<BitwiseReductionOp>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(1));
+      return fb->MakeNodeWithName<BitwiseReductionOp>(loc, operands[0], op,
+                                                      name);
+    }
+    if (IsOpClass<Receive>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(1, 2));
+      XLS_ASSIGN_OR_RETURN(int64_t channel_id, reader_.Count());
+      XLS_ASSIGN_OR_RETURN(bool is_blocking, reader_.Bool());
+      std::optional<Node*> predicate;
+      if (operands.size() == 2) {
+        predicate = operands[1];
+      }
+      return fb->MakeNodeWithName<Receive>(loc, operands[0], predicate,
+                                           channel_id, is_blocking, name);
+    }
+    if (IsOpClass<Send>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(2, 3));
+      XLS_ASSIGN_OR_RETURN(int64_t channel_id, reader_.Count());
+      std::optional<Node*> predicate;
+      if (operands.size() == 3) {
+        predicate = operands[2];
+      }
+      return fb->MakeNodeWithName<Send>(loc, operands[0], operands[1],
+                                        predicate, channel_id, name);
+    }
+    if (IsOpClass<NaryOp>(op)) {
+      return fb->MakeNodeWithName<NaryOp>(loc, operands, op, name);
+    }
+    if (IsOpClass<BitSlice>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(1));
+      XLS_ASSIGN_OR_RETURN(int64_t start, reader_.Count());
+      XLS_ASSIGN_OR_RETURN(int64_t width, reader_.Count());
+      return fb->MakeNodeWithName<BitSlice>(loc, operands[0], start, width,
+                                            name);
+    }
+    if (IsOpClass<DynamicBitSlice>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(2));
+      XLS_ASSIGN_OR_RETURN(int64_t width, reader_.Count());
+      return fb->MakeNodeWithName<DynamicBitSlice>(loc, operands[0],
+                                                   operands[1], width, name);
+    }
+    if (IsOpClass<BitSliceUpdate>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(3));
+      return fb->MakeNodeWithName<BitSliceUpdate>(loc, operands[0], operands[1],
+                                                  operands[2], name);
+    }
+    if (IsOpClass<CompareOp>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(2));
+      return fb->MakeNodeWithName<CompareOp>(loc, operands[0], operands[1], op,
+                                             name);
+    }
+    if (IsOpClass<Concat>(op)) {
+      return fb->MakeNodeWithName<Concat>(loc, operands, name);
+    }
+    if (IsOpClass<CountedFor>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(1, kVariadic));
+      XLS_ASSIGN_OR_RETURN(int64_t trip_count, reader_.Count());
+      XLS_ASSIGN_OR_RETURN(int64_t stride, reader_.Count());
+      XLS_ASSIGN_OR_RETURN(Function * body,
+                           ReadFunctionReference());
+      return fb->MakeNodeWithName<CountedFor>(loc, operands[0],
+                                              operands.subspan(1), trip_count,
+                                              stride, body, name);
+    }
+    if (IsOpClass<DynamicCountedFor>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(3, kVariadic));
+      XLS_ASSIGN_OR_RETURN(Function * body,
+                           ReadFunctionReference());
+      return fb->MakeNodeWithName<DynamicCountedFor>(
+          loc, operands[0], operands[1], operands[2], operands.subspan(3),
+          body, name);
+    }
+    if (IsOpClass<ExtendOp>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(1));
+      XLS_ASSIGN_OR_RETURN(int64_t new_bit_count, reader_.Count());
+      return fb->MakeNodeWithName<ExtendOp>(loc, operands[0], new_bit_count,
+                                            op, name);
+    }
+    if (IsOpClass<Invoke>(op)) {
+      XLS_ASSIGN_OR_RETURN(Function * to_apply,
+                           ReadFunctionReference());
+      return fb->MakeNodeWithName<Invoke>(loc, operands, to_apply, name);
+    }
+    if (IsOpClass<Literal>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(0));
+      XLS_ASSIGN_OR_RETURN(Value value, ReadValue(type));
+      return fb->MakeNodeWithName<Literal>(loc, std::move(value), name);
+    }
+    if (IsOpClass<Map>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(1));
+      XLS_ASSIGN_OR_RETURN(Function * to_apply,
+                           ReadFunctionReference());
+      return fb->MakeNodeWithName<Map>(loc, operands[0], to_apply, name);
+    }
+    if (IsOpClass<OneHot>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(1));
+      XLS_ASSIGN_OR_RETURN(LsbOrMsb priority,
+                           ReadEnum(reader_, LsbOrMsb::kMsb));
+      return fb->MakeNodeWithName<OneHot>(loc, operands[0], priority, name);
+    }
+    if (IsOpClass<OneHotSelect>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(1, kVariadic));
+      return fb->MakeNodeWithName<OneHotSelect>(loc, operands[0],
+                                                operands.subspan(1), name);
+    }
+    if (IsOpClass<PrioritySelect>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(1, kVariadic));
+      return fb->MakeNodeWithName<PrioritySelect>(loc, operands[0],
+                                                  operands.subspan(1), name);
+    }
+    if (IsOpClass<Select>(op)) {
+      XLS_ASSIGN_OR_RETURN(bool has_default, reader_.Bool());
+      XLS_RETURN_IF_ERROR(expect_operands(has_default ? 2 : 1, kVariadic));
+      std::optional<Node*> default_value;
+      absl::Span<Node* const> cases = operands.subspan(1);
+      if (has_default) {
+        default_value = cases.back();
+        cases.remove_suffix(1);
+      }
+      return fb->MakeNodeWithName<Select>(loc, operands[0], cases,
+                                          default_value, name);
+    }
+    if (IsOpClass<Tuple>(op)) {
+      return fb->MakeNodeWithName<Tuple>(loc, operands, name);
+    }
+    if (IsOpClass<TupleIndex>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(1));
+      XLS_ASSIGN_OR_RETURN(int64_t index, reader_.Count());
+      return fb->MakeNodeWithName<TupleIndex>(loc, operands[0], index, name);
+    }
+    if (IsOpClass<UnOp>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(1));
+      return fb->MakeNodeWithName<UnOp>(loc, operands[0], op, name);
+    }
+    if (IsOpClass<Decode>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(1));
+      XLS_ASSIGN_OR_RETURN(int64_t width, reader_.Count());
+      return fb->MakeNodeWithName<Decode>(loc, operands[0], width, name);
+    }
+    if (IsOpClass<Encode>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(1));
+      return fb->MakeNodeWithName<Encode>(loc, operands[0], name);
+    }
+    if (IsOpClass<Gate>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(2));
+      return fb->MakeNodeWithName<Gate>(loc, operands[0], operands[1], name);
+    }
+
+    if (!fb->IsBlock()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Op %s is not supported in %s in binary IR", OpToString(op),
+          fb->name()));
+    }
+    Block* block = fb->AsBlockOrDie();
+    if (IsOpClass<InputPort>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(0));
+      return block->AddInputPort(name, type, loc);
+    }
+    if (IsOpClass<OutputPort>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(1));
+      return block->AddOutputPort(name, operands[0], loc);
+    }
+    if (IsOpClass<RegisterRead>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(0));
+      XLS_ASSIGN_OR_RETURN(std::string register_name, reader_.String());
+      XLS_ASSIGN_OR_RETURN(Register * reg, block->GetRegister(register_name));
+      return block->MakeNodeWithName<RegisterRead>(loc, reg, name);
+    }
+    if (IsOpClass<RegisterWrite>(op)) {
+      XLS_ASSIGN_OR_RETURN(std::string register_name, reader_.String());
+      XLS_ASSIGN_OR_RETURN(bool has_load_enable, reader_.Bool());
+      XLS_ASSIGN_OR_RETURN(bool has_reset, reader_.Bool());
+      XLS_RETURN_IF_ERROR(expect_operands(
+          1 + (has_load_enable ? 1 : 0) + (has_reset ? 1 : 0)));
+      XLS_ASSIGN_OR_RETURN(Register * reg, block->GetRegister(register_name));
+      std::optional<Node*> load_enable;
+      std::optional<Node*> reset;
+      int64_t next_operand = 1;
+      if (has_load_enable) {
+        load_enable = operands[next_operand++];
+      }
+      if (has_reset) {
+        reset = operands[next_operand++];
+      }
+      return block->MakeNodeWithName<RegisterWrite>(loc, operands[0],
+                                                    load_enable, reset, reg,
+                                                    name);
+    }
+    if (IsOpClass<InstantiationInput>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(1));
+      XLS_ASSIGN_OR_RETURN(std::string instantiation_name, reader_.String());
+      XLS_ASSIGN_OR_RETURN(std::string port_name, reader_.String());
+      XLS_ASSIGN_OR_RETURN(Instantiation * instantiation,
+                           block->GetInstantiation(instantiation_name));
+      return block->MakeNodeWithName<InstantiationInput>(
+          loc, operands[0], instantiation, port_name, name);
+    }
+    if (IsOpClass<InstantiationOutput>(op)) {
+      XLS_RETURN_IF_ERROR(expect_operands(0));
+      XLS_ASSIGN_OR_RETURN(std::string instantiation_name, reader_.String());
+      XLS_ASSIGN_OR_RETURN(std::string port_name, reader_.String());
+      XLS_ASSIGN_OR_RETURN(Instantiation * instantiation,
+                           block->GetInstantiation(instantiation_name));
+      return block->MakeNodeWithName<InstantiationOutput>(
+          loc, instantiation, port_name, name);
+    }
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Op %s is not supported in binary IR", OpToString(op)));
+  }
+
+  Reader reader_;
+  std::unique_ptr<Package> package_;
+  std::vector<Type*> types_;
+  std::vector<FunctionBase*> function_bases_;
+  // The nodes of the function base currently being read in the order they
+  // were written.
+  std::vector<Node*> nodes_;
+};
+
+}  // namespace
+
+bool IsBinaryIr(std::string_view data) {
+  return data.substr(0, kMagic.size()) == kMagic;
+}
+
+absl::StatusOr<std::string> PackageToBinaryIr(const Package* package) {
+  return BinaryIrWriter(package).Write();
+}
+
+absl::StatusOr<std::unique_ptr<Package>> PackageFromBinaryIr(
+    std::string_view data) {
+  return BinaryIrReader(data).Read();
+}
+
+}  // namespace xls
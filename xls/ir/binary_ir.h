@@ -0,0 +1,53 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_BINARY_IR_H_
+#define XLS_IR_BINARY_IR_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// A compact binary serialization of IR packages which is much faster to load
+// and store than the text format. Packages are stored as a table of interned
+// types followed by the channels and function bases of the package. The nodes
+// of each function base are stored in topological order and refer to their
+// operands by dense index. Integers and small literals are varint encoded.
+//
+// The format is versioned. Binary IR written by a different version of XLS is
+// rejected; the text format remains the interchange format.
+inline constexpr int64_t kBinaryIrVersion = 1;
+
+// Returns true if `data` starts with the binary IR magic number. IR text never
+// does.
+bool IsBinaryIr(std::string_view data);
+
+// Serializes the given package into the binary IR format. Foreign and FIFO
+// instantiations are not supported.
+absl::StatusOr<std::string> PackageToBinaryIr(const Package* package);
+
+// Builds a package from binary IR produced by PackageToBinaryIr. The package
+// is verified.
+absl::StatusOr<std::unique_ptr<Package>> PackageFromBinaryIr(
+    std::string_view data);
+
+}  // namespace xls
+
+#endif  // XLS_IR_BINARY_IR_H_
@@ -0,0 +1,168 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/binary_ir.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+// Parses `ir_text`, round trips it through binary IR and checks that the
+// result is identical to the original package.
+void RoundTrip(std::string_view ir_text) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary,
+                           PackageToBinaryIr(package.get()));
+  EXPECT_TRUE(IsBinaryIr(binary));
+  EXPECT_LT(binary.size(), ir_text.size());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> result,
+                           PackageFromBinaryIr(binary));
+  EXPECT_EQ(result->DumpIr(), package->DumpIr());
+
+  // The text parser entry points accept binary IR too.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> parsed,
+                           Parser::ParsePackage(binary));
+  EXPECT_EQ(parsed->DumpIr(), package->DumpIr());
+}
+
+TEST(BinaryIrTest, Functions) {
+  RoundTrip(R"(package test
+
+file_number 0 "foo/bar.x"
+file_number 3 "baz.x"
+
+fn body(i: bits[32], acc: bits[128], k: bits[8]) -> bits[128] {
+  zero_ext.4: bits[128] = zero_ext(i, new_bit_count=128, id=4)
+  add.5: bits[128] = add(acc, zero_ext.4, id=5, pos=[(0,1,2), (3,4,5)])
+  sign_ext.6: bits[128] = sign_ext(k, new_bit_count=128, id=6)
+  ret add.7: bits[128] = add(add.5, sign_ext.6, id=7)
+}
+
+fn double(x: bits[8]) -> bits[8] {
+  ret umul.8: bits[8] = umul(x, x, id=8)
+}
+
+top fn main(a: bits[128], b: bits[8][4], s: bits[2], k: bits[8]) -> (bits[128], bits[8][4], bits[8], bits[3]) {
+  literal.10: bits[128] = literal(value=0x1234_5678_9abc_def0_1234_5678_9abc_def0, id=10)
+  counted_for.11: bits[128] = counted_for(literal.10, trip_count=4, stride=2, body=body, invariant_args=[k], id=11)
+  map.12: bits[8][4] = map(b, to_apply=double, id=12)
+  array_index.13: bits[8] = array_index(map.12, indices=[s], id=13)
+  bit_slice.14: bits[3] = bit_slice(array_index.13, start=2, width=3, id=14)
+  literal.15: bits[8] = literal(value=255, id=15)
+  sel: bits[8] = sel(s, cases=[array_index.13, literal.15], default=k, id=16)
+  one_hot.17: bits[3] = one_hot(s, lsb_prio=false, id=17)
+  ret tuple.18: (bits[128], bits[8][4], bits[8], bits[3]) = tuple(counted_for.11, map.12, sel, bit_slice.14, id=18)
+}
+)");
+}
+
+TEST(BinaryIrTest, Proc) {
+  RoundTrip(R"(package test
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=ready_valid, strictness=proven_mutually_exclusive, fifo_depth=3, metadata="""""")
+chan out(bits[32], id=1, kind=single_value, ops=send_only, metadata="""""")
+
+proc my_proc(tkn: token, count: bits[32], pair: (bits[1], bits[64]), init={7, (1, 0xffff_ffff_ffff_ffff)}) {
+  receive.1: (token, bits[32]) = receive(tkn, channel_id=0, id=1)
+  tuple_index.2: token = tuple_index(receive.1, index=0, id=2)
+  tuple_index.3: bits[32] = tuple_index(receive.1, index=1, id=3)
+  add.4: bits[32] = add(count, tuple_index.3, id=4)
+  literal.5: bits[1] = literal(value=1, id=5)
+  send.6: token = send(tuple_index.2, add.4, predicate=literal.5, channel_id=1, id=6)
+  trace.7: token = trace(send.6, literal.5, format="count: {:x}", data_operands=[add.4], id=7)
+  assert.8: token = assert(trace.7, literal.5, message="boom", label="my_label", id=8)
+  next (assert.8, add.4, pair)
+}
+)");
+}
+
+TEST(BinaryIrTest, Blocks) {
+  RoundTrip(R"(package test
+
+block sub_block(in: bits[8], out: bits[8]) {
+  in: bits[8] = input_port(name=in, id=1)
+  out: () = output_port(in, name=out, id=2)
+}
+
+block my_block(clk: clock, rst: bits[1], x: bits[8], le: bits[1], y: bits[8]) {
+  reg foo(bits[8], reset_value=42, asynchronous=false, active_low=true)
+  instantiation inst(block=sub_block, kind=block)
+  rst: bits[1] = input_port(name=rst, id=3)
+  x: bits[8] = input_port(name=x, id=4)
+  le: bits[1] = input_port(name=le, id=5)
+  foo_d: () = register_write(x, register=foo, load_enable=le, reset=rst, id=6)
+  foo_q: bits[8] = register_read(register=foo, id=7)
+  inst_in: () = instantiation_input(foo_q, instantiation=inst, port_name=in, id=8)
+  inst_out: bits[8] = instantiation_output(instantiation=inst, port_name=out, id=9)
+  y: () = output_port(inst_out, name=y, id=10)
+}
+)");
+}
+
+TEST(BinaryIrTest, ParsePackageWithEntry) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(package test
+
+fn f(x: bits[4]) -> bits[4] {
+  ret not.2: bits[4] = not(x, id=2)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary,
+                           PackageToBinaryIr(package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> result,
+                           Parser::ParsePackageWithEntry(binary, "f"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * top, result->GetTopAsFunction());
+  EXPECT_EQ(top->name(), "f");
+  EXPECT_THAT(Parser::ParsePackageWithEntry(binary, "g").status(),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(BinaryIrTest, MalformedInput) {
+  EXPECT_FALSE(IsBinaryIr("package test\n"));
+  EXPECT_THAT(PackageFromBinaryIr("package test\n").status(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("not binary IR")));
+
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary, PackageToBinaryIr(&package));
+  XLS_EXPECT_OK(PackageFromBinaryIr(binary).status());
+
+  std::string bad_version = binary;
+  bad_version[6] = kBinaryIrVersion + 1;
+  EXPECT_THAT(PackageFromBinaryIr(bad_version).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Unsupported binary IR version")));
+  EXPECT_THAT(PackageFromBinaryIr(binary.substr(0, binary.size() - 1)).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("truncated")));
+  EXPECT_THAT(PackageFromBinaryIr(binary + "x").status(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Trailing data")));
+}
+
+}  // namespace
+}  // namespace xls
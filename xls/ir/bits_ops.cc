@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "absl/container/inlined_vector.h"
+#include "absl/numeric/int128.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
@@ -50,6 +51,91 @@ Bits TruncateOrSignExtend(const Bits& bits, int64_t bit_count) {
   return bits.Slice(0, bit_count);
 }
 
+// Widest value handled by the 128-bit integer fast paths below.
+constexpr int64_t kMaxWideIntBits = 128;
+
+// Returns the given bits value zero-extended to 128 bits. The width of `bits`
+// must be at most 128.
+absl::uint128 ToUint128(const Bits& bits) {
+  XLS_DCHECK_LE(bits.bit_count(), kMaxWideIntBits);
+  const InlineBitmap& bitmap = bits.bitmap();
+  uint64_t high = bitmap.word_count() > 1 ? bitmap.GetWord(1) : 0;
+  return absl::MakeUint128(high, bitmap.GetWord(0));
+}
+
+// Returns the given bits value sign-extended to 128 bits. The width of `bits`
+// must be at most 128.
+absl::uint128 ToSignExtendedUint128(const Bits& bits) {
+  absl::uint128 value = ToUint128(bits);
+  if (bits.bit_count() > 0 && bits.bit_count() < kMaxWideIntBits &&
+      bits.msb()) {
+    value |= ~absl::uint128{0} << bits.bit_count();
+  }
+  return value;
+}
+
+// Returns a bits value of the given width (at most 128) holding the low bits of
+// `value`.
+Bits FromUint128(absl::uint128 value, int64_t bit_count) {
+  XLS_DCHECK_LE(bit_count, kMaxWideIntBits);
+  InlineBitmap bitmap(bit_count);
+  if (bitmap.word_count() > 0) {
+    bitmap.SetWord(0, absl::Uint128Low64(value));
+  }
+  if (bitmap.word_count() > 1) {
+    bitmap.SetWord(1, absl::Uint128High64(value));
+  }
+  return Bits::FromBitmap(std::move(bitmap));
+}
+
+// Returns `bits` shifted left by `shift_amount` (which must be less than the
+// bit count) filling the vacated low bits with zeroes.
+InlineBitmap ShiftLeftWords(const InlineBitmap& bitmap, int64_t shift_amount) {
+  InlineBitmap result(bitmap.bit_count());
+  const int64_t word_shift = shift_amount / 64;
+  const int64_t bit_shift = shift_amount % 64;
+  for (int64_t i = result.word_count() - 1; i >= word_shift; --i) {
+    uint64_t word = bitmap.GetWord(i - word_shift) << bit_shift;
+    if (bit_shift != 0 && i - word_shift - 1 >= 0) {
+      word |= bitmap.GetWord(i - word_shift - 1) >> (64 - bit_shift);
+    }
+    result.SetWord(i, word);
+  }
+  return result;
+}
+
+// Returns `bits` shifted right by `shift_amount` (which must be less than the
+// bit count) filling the vacated high bits with `fill`.
+InlineBitmap ShiftRightWords(const InlineBitmap& bitmap, int64_t shift_amount,
+                             bool fill) {
+  const int64_t word_count = bitmap.word_count();
+  const uint64_t fill_word = fill ? ~uint64_t{0} : 0;
+  // Returns the given word of the source, extended past its end with the fill
+  // value.
+  auto source_word = [&](int64_t wordno) -> uint64_t {
+    if (wordno >= word_count) {
+      return fill_word;
+    }
+    uint64_t word = bitmap.GetWord(wordno);
+    int64_t valid_bits = bitmap.bit_count() - wordno * 64;
+    if (fill && valid_bits < 64) {
+      word |= ~uint64_t{0} << valid_bits;
+    }
+    return word;
+  };
+  InlineBitmap result(bitmap.bit_count());
+  const int64_t word_shift = shift_amount / 64;
+  const int64_t bit_shift = shift_amount % 64;
+  for (int64_t i = 0; i < word_count; ++i) {
+    uint64_t word = source_word(i + word_shift) >> bit_shift;
+    if (bit_shift != 0) {
+      word |= source_word(i + word_shift + 1) << (64 - bit_shift);
+    }
+    result.SetWord(i, word);
+  }
+  return result;
+}
+
 }  // namespace
 
 Bits And(const Bits& lhs, const Bits& rhs) {
@@ -257,6 +343,13 @@ Bits SMul(const Bits& lhs, const Bits& rhs) {
     return SBits(result, result_width);
   }
 
+  if (result_width <= kMaxWideIntBits) {
+    // Multiplication of the sign-extended operands modulo 2^128 yields the low
+    // 128 bits of the signed product, which holds the entire result.
+    return FromUint128(ToSignExtendedUint128(lhs) * ToSignExtendedUint128(rhs),
+                       result_width);
+  }
+
   BigInt product =
       BigInt::Mul(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs));
   return product.ToSignedBitsWithBitCount(result_width).value();
@@ -271,6 +364,10 @@ Bits UMul(const Bits& lhs, const Bits& rhs) {
     return UBits(result, result_width);
   }
 
+  if (result_width <= kMaxWideIntBits) {
+    return FromUint128(ToUint128(lhs) * ToUint128(rhs), result_width);
+  }
+
   BigInt product =
       BigInt::Mul(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
   return product.ToUnsignedBitsWithBitCount(result_width).value();
@@ -280,6 +377,14 @@ Bits UDiv(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits::AllOnes(lhs.bit_count());
   }
+  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
+    return UBits(lhs.ToUint64().value() / rhs.ToUint64().value(),
+                 lhs.bit_count());
+  }
+  if (lhs.bit_count() <= kMaxWideIntBits &&
+      rhs.bit_count() <= kMaxWideIntBits) {
+    return FromUint128(ToUint128(lhs) / ToUint128(rhs), lhs.bit_count());
+  }
   BigInt quotient =
       BigInt::Div(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
   return ZeroExtend(quotient.ToUnsignedBits(), lhs.bit_count());
@@ -289,6 +394,14 @@ Bits UMod(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits(rhs.bit_count());
   }
+  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
+    return UBits(lhs.ToUint64().value() % rhs.ToUint64().value(),
+                 rhs.bit_count());
+  }
+  if (lhs.bit_count() <= kMaxWideIntBits &&
+      rhs.bit_count() <= kMaxWideIntBits) {
+    return FromUint128(ToUint128(lhs) % ToUint128(rhs), rhs.bit_count());
+  }
   BigInt modulo =
       BigInt::Mod(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
   return ZeroExtend(modulo.ToUnsignedBits(), rhs.bit_count());
@@ -436,6 +549,16 @@ Bits Concat(absl::Span<const Bits> inputs) {
   for (const Bits& bits : inputs) {
     new_bit_count += bits.bit_count();
   }
+  if (new_bit_count <= 64) {
+    uint64_t result = 0;
+    for (const Bits& bits : inputs) {
+      // A 64-bit input is the entire result (and shifting by 64 is undefined).
+      result = bits.bit_count() == 64
+                   ? bits.bitmap().GetWord(0)
+                   : (result << bits.bit_count()) | bits.bitmap().GetWord(0);
+    }
+    return UBits(result, new_bit_count);
+  }
   // Iterate in reverse order because the first input becomes the
   // most-significant bits.
   BitsRope rope(new_bit_count);
@@ -460,24 +583,36 @@ Bits Abs(const Bits& bits) {
 
 Bits ShiftLeftLogical(const Bits& bits, int64_t shift_amount) {
   XLS_CHECK_GE(shift_amount, 0);
-  shift_amount = std::min(shift_amount, bits.bit_count());
-  return Concat(
-      {bits.Slice(0, bits.bit_count() - shift_amount), UBits(0, shift_amount)});
+  if (shift_amount >= bits.bit_count()) {
+    return Bits(bits.bit_count());
+  }
+  if (bits.bit_count() <= 64) {
+    return UBits((bits.ToUint64().value() << shift_amount) &
+                     Mask(bits.bit_count()),
+                 bits.bit_count());
+  }
+  return Bits::FromBitmap(ShiftLeftWords(bits.bitmap(), shift_amount));
 }
 
 Bits ShiftRightLogical(const Bits& bits, int64_t shift_amount) {
   XLS_CHECK_GE(shift_amount, 0);
-  shift_amount = std::min(shift_amount, bits.bit_count());
-  return Concat({UBits(0, shift_amount),
-                 bits.Slice(shift_amount, bits.bit_count() - shift_amount)});
+  if (shift_amount >= bits.bit_count()) {
+    return Bits(bits.bit_count());
+  }
+  if (bits.bit_count() <= 64) {
+    return UBits(bits.ToUint64().value() >> shift_amount, bits.bit_count());
+  }
+  return Bits::FromBitmap(
+      ShiftRightWords(bits.bitmap(), shift_amount, /*fill=*/false));
 }
 
 Bits ShiftRightArith(const Bits& bits, int64_t shift_amount) {
   XLS_CHECK_GE(shift_amount, 0);
-  shift_amount = std::min(shift_amount, bits.bit_count());
-  return Concat(
-      {bits.msb() ? Bits::AllOnes(shift_amount) : UBits(0, shift_amount),
-       bits.Slice(shift_amount, bits.bit_count() - shift_amount)});
+  const bool fill = bits.bit_count() > 0 && bits.msb();
+  if (shift_amount >= bits.bit_count()) {
+    return fill ? Bits::AllOnes(bits.bit_count()) : Bits(bits.bit_count());
+  }
+  return Bits::FromBitmap(ShiftRightWords(bits.bitmap(), shift_amount, fill));
 }
 
 Bits OneHotLsbToMsb(const Bits& bits) {
@@ -0,0 +1,119 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "include/benchmark/benchmark.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+
+namespace xls {
+namespace {
+
+// Returns a Bits value of the given width with random contents.
+Bits RandomBits(int64_t bit_count, std::minstd_rand& bitgen) {
+  std::vector<uint8_t> bytes((bit_count + 7) / 8);
+  std::uniform_int_distribution<int> byte_dist(0, 255);
+  for (uint8_t& byte : bytes) {
+    byte = byte_dist(bitgen);
+  }
+  return Bits::FromBytes(bytes, bit_count);
+}
+
+// Widths covering the single-word, double-word and BigInt paths.
+void BitWidths(benchmark::internal::Benchmark* b) {
+  for (int64_t width : {8, 32, 64, 100, 128, 256, 1024}) {
+    b->Arg(width);
+  }
+}
+
+void BM_UMul(benchmark::State& state) {
+  std::minstd_rand bitgen;
+  Bits lhs = RandomBits(state.range(0) / 2, bitgen);
+  Bits rhs = RandomBits(state.range(0) - state.range(0) / 2, bitgen);
+  for (auto _ : state) {
+    Bits v = bits_ops::UMul(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_UMul)->Apply(BitWidths);
+
+void BM_SMul(benchmark::State& state) {
+  std::minstd_rand bitgen;
+  Bits lhs = RandomBits(state.range(0) / 2, bitgen);
+  Bits rhs = RandomBits(state.range(0) - state.range(0) / 2, bitgen);
+  for (auto _ : state) {
+    Bits v = bits_ops::SMul(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_SMul)->Apply(BitWidths);
+
+void BM_UDiv(benchmark::State& state) {
+  std::minstd_rand bitgen;
+  Bits lhs = RandomBits(state.range(0), bitgen);
+  Bits rhs = bits_ops::ShiftRightLogical(RandomBits(state.range(0), bitgen),
+                                         state.range(0) / 2);
+  if (rhs.IsZero()) {
+    rhs = UBits(3, state.range(0));
+  }
+  for (auto _ : state) {
+    Bits v = bits_ops::UDiv(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_UDiv)->Apply(BitWidths);
+
+void BM_ShiftLeftLogical(benchmark::State& state) {
+  std::minstd_rand bitgen;
+  Bits value = RandomBits(state.range(0), bitgen);
+  int64_t amount = state.range(0) / 3;
+  for (auto _ : state) {
+    Bits v = bits_ops::ShiftLeftLogical(value, amount);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_ShiftLeftLogical)->Apply(BitWidths);
+
+void BM_ShiftRightArith(benchmark::State& state) {
+  std::minstd_rand bitgen;
+  Bits value = RandomBits(state.range(0), bitgen);
+  int64_t amount = state.range(0) / 3;
+  for (auto _ : state) {
+    Bits v = bits_ops::ShiftRightArith(value, amount);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_ShiftRightArith)->Apply(BitWidths);
+
+void BM_Concat(benchmark::State& state) {
+  // Concatenate four operands whose widths sum to the benchmark width.
+  std::minstd_rand bitgen;
+  int64_t width = state.range(0);
+  std::vector<Bits> inputs;
+  for (int64_t i = 0; i < 3; ++i) {
+    inputs.push_back(RandomBits(width / 4, bitgen));
+  }
+  inputs.push_back(RandomBits(width - 3 * (width / 4), bitgen));
+  for (auto _ : state) {
+    Bits v = bits_ops::Concat(inputs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_Concat)->Apply(BitWidths);
+
+}  // namespace
+}  // namespace xls
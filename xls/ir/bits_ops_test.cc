@@ -14,6 +14,7 @@
 
 #include "xls/ir/bits_ops.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <limits>
@@ -29,6 +30,7 @@
 #include "rapidcheck.h"
 #include "xls/common/status/matchers.h"
 #include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/big_int.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_test_helpers.h"
 #include "xls/ir/format_preference.h"
@@ -1082,6 +1084,100 @@ TEST(BitsOpsTest, ToRawDigitsValue0x55U17) {
             "00055");
 }
 
+// Returns a Bits value built from the given bytes with `excess_bits` (mod 8)
+// high bits dropped.
+Bits BitsFromRandomBytes(const std::vector<uint8_t>& bytes,
+                         uint8_t excess_bits) {
+  if (bytes.empty()) {
+    return Bits();
+  }
+  excess_bits %= 8;
+  return Bits::FromBytes(bytes,
+                         static_cast<int64_t>(bytes.size()) * 8 - excess_bits);
+}
+
+// The following properties check the word-parallel fast paths in bits_ops
+// against straightforward reference implementations.
+RC_GTEST_PROP(BitsOpsRapidcheck, UMulMatchesBigInt,
+              (const std::vector<uint8_t>& lhs_bytes, uint8_t lhs_excess,
+               const std::vector<uint8_t>& rhs_bytes, uint8_t rhs_excess)) {
+  Bits lhs = BitsFromRandomBytes(lhs_bytes, lhs_excess);
+  Bits rhs = BitsFromRandomBytes(rhs_bytes, rhs_excess);
+  RC_ASSERT(bits_ops::UMul(lhs, rhs) ==
+            BigInt::Mul(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs))
+                .ToUnsignedBitsWithBitCount(lhs.bit_count() + rhs.bit_count())
+                .value());
+}
+
+RC_GTEST_PROP(BitsOpsRapidcheck, SMulMatchesBigInt,
+              (const std::vector<uint8_t>& lhs_bytes, uint8_t lhs_excess,
+               const std::vector<uint8_t>& rhs_bytes, uint8_t rhs_excess)) {
+  Bits lhs = BitsFromRandomBytes(lhs_bytes, lhs_excess);
+  Bits rhs = BitsFromRandomBytes(rhs_bytes, rhs_excess);
+  RC_PRE(lhs.bit_count() > 0 && rhs.bit_count() > 0);
+  RC_ASSERT(bits_ops::SMul(lhs, rhs) ==
+            BigInt::Mul(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
+                .ToSignedBitsWithBitCount(lhs.bit_count() + rhs.bit_count())
+                .value());
+}
+
+RC_GTEST_PROP(BitsOpsRapidcheck, UDivAndUModMatchBigInt,
+              (const std::vector<uint8_t>& lhs_bytes, uint8_t lhs_excess,
+               const std::vector<uint8_t>& rhs_bytes, uint8_t rhs_excess)) {
+  Bits lhs = BitsFromRandomBytes(lhs_bytes, lhs_excess);
+  Bits rhs = BitsFromRandomBytes(rhs_bytes, rhs_excess);
+  RC_PRE(!rhs.IsZero());
+  BigInt big_lhs = BigInt::MakeUnsigned(lhs);
+  BigInt big_rhs = BigInt::MakeUnsigned(rhs);
+  RC_ASSERT(bits_ops::UDiv(lhs, rhs) ==
+            bits_ops::ZeroExtend(BigInt::Div(big_lhs, big_rhs).ToUnsignedBits(),
+                                 lhs.bit_count()));
+  RC_ASSERT(bits_ops::UMod(lhs, rhs) ==
+            bits_ops::ZeroExtend(BigInt::Mod(big_lhs, big_rhs).ToUnsignedBits(),
+                                 rhs.bit_count()));
+}
+
+RC_GTEST_PROP(BitsOpsRapidcheck, ShiftsMatchSliceAndConcat,
+              (const std::vector<uint8_t>& bytes, uint8_t excess_bits,
+               uint16_t raw_amount)) {
+  Bits value = BitsFromRandomBytes(bytes, excess_bits);
+  const int64_t bit_count = value.bit_count();
+  // Include shift amounts greater than the width.
+  const int64_t amount = raw_amount % (bit_count + 2);
+  const int64_t shift = std::min(amount, bit_count);
+  Bits low = value.Slice(0, bit_count - shift);
+  Bits high = value.Slice(shift, bit_count - shift);
+  RC_ASSERT(bits_ops::ShiftLeftLogical(value, amount) ==
+            bits_ops::Concat({low, Bits(shift)}));
+  RC_ASSERT(bits_ops::ShiftRightLogical(value, amount) ==
+            bits_ops::Concat({Bits(shift), high}));
+  Bits fill =
+      bit_count > 0 && value.msb() ? Bits::AllOnes(shift) : Bits(shift);
+  RC_ASSERT(bits_ops::ShiftRightArith(value, amount) ==
+            bits_ops::Concat({fill, high}));
+}
+
+RC_GTEST_PROP(BitsOpsRapidcheck, ConcatMatchesBitByBit,
+              (const std::vector<std::vector<uint8_t>>& inputs_bytes)) {
+  std::vector<Bits> inputs;
+  std::vector<bool> expected_lsb_first;
+  for (const std::vector<uint8_t>& bytes : inputs_bytes) {
+    uint8_t excess_bits = bytes.empty() ? 0 : bytes[0];
+    inputs.push_back(BitsFromRandomBytes(bytes, excess_bits));
+  }
+  for (auto it = inputs.rbegin(); it != inputs.rend(); ++it) {
+    for (int64_t i = 0; i < it->bit_count(); ++i) {
+      expected_lsb_first.push_back(it->Get(i));
+    }
+  }
+  Bits result = bits_ops::Concat(inputs);
+  RC_ASSERT(result.bit_count() ==
+            static_cast<int64_t>(expected_lsb_first.size()));
+  for (int64_t i = 0; i < result.bit_count(); ++i) {
+    RC_ASSERT(result.Get(i) == expected_lsb_first[i]);
+  }
+}
+
 void BM_Increment(benchmark::State& state) {
   Bits f = Bits::AllOnes(state.range(0));
   for (auto _ : state) {
@@ -587,6 +587,27 @@ absl::StatusOr<BlockInstantiation*> Block::AddBlockInstantiation(
   return down_cast<BlockInstantiation*>(instantiation.value());
 }
 
+absl::StatusOr<FifoInstantiation*> Block::AddFifoInstantiation(
+    std::string_view name, const FifoConfig& fifo_config, Type* data_type) {
+  if (fifo_config.depth < 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "FIFO `%s` has negative depth %d", name, fifo_config.depth));
+  }
+  if (fifo_config.depth == 0 &&
+      (!fifo_config.bypass || fifo_config.register_push_outputs)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "FIFO `%s` of depth zero must be a bypass FIFO without registered "
+        "push outputs",
+        name));
+  }
+  XLS_RET_CHECK(package()->IsOwnedType(data_type));
+  XLS_ASSIGN_OR_RETURN(
+      Instantiation * instantiation,
+      AddInstantiation(name, std::make_unique<FifoInstantiation>(
+                                 name, fifo_config, data_type, package())));
+  return down_cast<FifoInstantiation*>(instantiation);
+}
+
 absl::StatusOr<Instantiation*> Block::AddInstantiation(
     std::string_view name, std::unique_ptr<Instantiation> instantiation) {
   if (instantiations_.contains(name)) {
@@ -687,6 +708,16 @@ absl::StatusOr<Block*> Block::Clone(std::string_view new_name,
           instantiation_map[inst],
           cloned_block->AddBlockInstantiation(
               block_inst->name(), block_inst->instantiated_block()));
+    } else if (inst->kind() == InstantiationKind::kFifo) {
+      auto fifo_inst = dynamic_cast<FifoInstantiation*>(inst);
+      XLS_CHECK(fifo_inst != nullptr);
+      XLS_ASSIGN_OR_RETURN(
+          Type * mapped_type,
+          target_package->MapTypeFromOtherPackage(fifo_inst->data_type()));
+      XLS_ASSIGN_OR_RETURN(
+          instantiation_map[inst],
+          cloned_block->AddFifoInstantiation(
+              fifo_inst->name(), fifo_inst->fifo_config(), mapped_type));
     } else {
       XLS_LOG(FATAL) << "InstantiationKind not yet supported: " << inst->kind();
     }
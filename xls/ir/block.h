@@ -133,6 +133,11 @@ class Block : public FunctionBase {
   absl::StatusOr<BlockInstantiation*> AddBlockInstantiation(
       std::string_view name, Block* instantiated_block);
 
+  // Add an instantiation of a FIFO holding values of type `data_type` with the
+  // given configuration to this block.
+  absl::StatusOr<FifoInstantiation*> AddFifoInstantiation(
+      std::string_view name, const FifoConfig& fifo_config, Type* data_type);
+
   absl::StatusOr<Instantiation*> AddInstantiation(
       std::string_view name, std::unique_ptr<Instantiation> instantiation);
 
@@ -14,20 +14,19 @@
 
 #include "xls/ir/call_graph.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <optional>
 #include <string_view>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/op.h"
 
 namespace xls {
 
-namespace {
-// Returns the function called directly by the given node. Nodes which call
-// functions include: map, invoke, etc. If the node does not call a function
-// std::nullopt is returned.
 std::optional<Function*> CalledFunction(Node* node) {
   switch (node->op()) {
     case Op::kCountedFor:
@@ -43,19 +42,10 @@ std::optional<Function*> CalledFunction(Node* node) {
   }
 }
 
+namespace {
 // Returns the functions called directly by the nodes of the given FunctionBase.
 std::vector<Function*> CalledFunctions(FunctionBase* function_base) {
-  absl::flat_hash_set<Function*> called_set;
-  std::vector<Function*> called;
-  for (Node* node : function_base->nodes()) {
-    if (std::optional<Function*> callee = CalledFunction(node)) {
-      auto [_, inserted] = called_set.insert(callee.value());
-      if (inserted) {
-        called.push_back(callee.value());
-      }
-    }
-  }
-  return called;
+  return function_base->package()->GetCalledFunctions(function_base);
 }
 }  // namespace
 
@@ -115,6 +105,26 @@ std::vector<FunctionBase*> FunctionsInPostOrder(Package* p) {
   return post_order;
 }
 
+std::vector<std::vector<FunctionBase*>> FunctionsByCallGraphLevel(Package* p) {
+  // Callees precede callers in the post order so the level of every callee is
+  // known by the time its callers are visited.
+  absl::flat_hash_map<FunctionBase*, int64_t> levels;
+  int64_t level_count = 0;
+  for (FunctionBase* f : FunctionsInPostOrder(p)) {
+    int64_t level = 0;
+    for (FunctionBase* callee : CalledFunctions(f)) {
+      level = std::max(level, levels.at(callee) + 1);
+    }
+    levels[f] = level;
+    level_count = std::max(level_count, level + 1);
+  }
+  std::vector<std::vector<FunctionBase*>> result(level_count);
+  for (FunctionBase* f : p->GetFunctionBases()) {
+    result[levels.at(f)].push_back(f);
+  }
+  return result;
+}
+
 absl::StatusOr<Function*> CloneFunctionAndItsDependencies(
     Function* to_clone, std::string_view new_name, Package* target_package,
     absl::flat_hash_map<const Function*, Function*> call_remapping) {
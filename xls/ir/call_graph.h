@@ -15,6 +15,7 @@
 #ifndef XLS_IR_CALL_GRAPH_H_
 #define XLS_IR_CALL_GRAPH_H_
 
+#include <optional>
 #include <string_view>
 #include <vector>
 
@@ -24,6 +25,11 @@
 
 namespace xls {
 
+// Returns the function called directly by the given node. Nodes which call
+// functions include: map, invoke, etc. If the node does not call a function
+// std::nullopt is returned.
+std::optional<Function*> CalledFunction(Node* node);
+
 // Returns the functions called transitively by the given FunctionBase. Called
 // functions are returned before callee FunctionBases in the returned order. The
 // final element in the returned vector is `function_base`.
@@ -40,6 +46,13 @@ absl::StatusOr<Function*> CloneFunctionAndItsDependencies(
 // returned before callee FunctionBases in the returned order.
 std::vector<FunctionBase*> FunctionsInPostOrder(Package* p);
 
+// Partitions the FunctionBases in package 'p' into levels of the call graph.
+// Level zero contains the FunctionBases which call no functions and every
+// other FunctionBase is placed one level above its deepest callee, so no
+// FunctionBase calls another FunctionBase in the same level. Within a level
+// FunctionBases appear in the order of Package::GetFunctionBases.
+std::vector<std::vector<FunctionBase*>> FunctionsByCallGraphLevel(Package* p);
+
 }  // namespace xls
 
 #endif  // XLS_IR_CALL_GRAPH_H_
@@ -14,17 +14,23 @@
 
 #include "xls/ir/call_graph.h"
 
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
 
 namespace xls {
 namespace {
 
 using ::testing::ElementsAre;
+using ::testing::IsEmpty;
 using ::testing::Optional;
 using ::testing::UnorderedElementsAre;
 
@@ -109,6 +115,9 @@ TEST_F(CallGraphTest, CallGraphDiamond) {
   EXPECT_EQ(FunctionsInPostOrder(p.get()).front(), a);
   EXPECT_EQ(FunctionsInPostOrder(p.get()).back(), d);
   EXPECT_THAT(FunctionsInPostOrder(p.get()), UnorderedElementsAre(a, b, c, d));
+
+  EXPECT_THAT(FunctionsByCallGraphLevel(p.get()),
+              ElementsAre(ElementsAre(a), ElementsAre(b, c), ElementsAre(d)));
 }
 
 TEST_F(CallGraphTest, SeveralFunctions) {
@@ -183,5 +192,40 @@ TEST_F(CallGraphTest, CloneFunctionAndItsDependencies) {
   EXPECT_THAT(p_clone->functions().size(), 3);
 }
 
+TEST_F(CallGraphTest, CachedCalleesTrackIrChanges) {
+  auto p = CreatePackage();
+  Type* u32 = p->GetBitsType(32);
+
+  Function* a;
+  {
+    FunctionBuilder fb("a", p.get());
+    fb.Param("x", u32);
+    XLS_ASSERT_OK_AND_ASSIGN(a, fb.Build());
+  }
+  Function* b;
+  {
+    FunctionBuilder fb("b", p.get());
+    BValue x = fb.Param("x", u32);
+    XLS_ASSERT_OK_AND_ASSIGN(b, fb.BuildWithReturnValue(x));
+  }
+  EXPECT_THAT(p->GetCalledFunctions(b), IsEmpty());
+  EXPECT_THAT(FunctionsInPostOrder(p.get()), ElementsAre(a, b));
+
+  // Adding an invoke is reflected in the next query.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * invoke, b->MakeNode<Invoke>(SourceInfo(),
+                                         std::vector<Node*>{b->param(0)}, a));
+  EXPECT_THAT(p->GetCalledFunctions(b), ElementsAre(a));
+  EXPECT_THAT(GetDependentFunctions(b), ElementsAre(a, b));
+
+  // As is removing it.
+  XLS_ASSERT_OK(b->RemoveNode(invoke));
+  EXPECT_THAT(p->GetCalledFunctions(b), IsEmpty());
+  EXPECT_THAT(GetDependentFunctions(b), ElementsAre(b));
+
+  XLS_ASSERT_OK(p->RemoveFunction(a));
+  EXPECT_THAT(FunctionsInPostOrder(p.get()), ElementsAre(b));
+}
+
 }  // namespace
 }  // namespace xls
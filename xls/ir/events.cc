@@ -14,8 +14,51 @@
 
 #include "xls/ir/events.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <variant>
+
+#include "absl/strings/str_cat.h"
+#include "xls/common/math_util.h"
+
 namespace xls {
 
+uint8_t* InterpreterEvents::AddDeferredTraceOperand(
+    Value (*decode)(const void*, const uint8_t*), const void* layout,
+    int64_t size) {
+  int64_t offset = RoundUpToNearest<int64_t>(deferred_trace_bytes.size(),
+                                             alignof(std::max_align_t));
+  deferred_trace_bytes.resize(offset + size);
+  deferred_trace_operands.push_back(DeferredTraceOperand{
+      .decode = decode, .layout = layout, .offset = offset});
+  return deferred_trace_bytes.data() + offset;
+}
+
+void InterpreterEvents::RenderDeferredTraces() {
+  for (const DeferredTrace& trace : deferred_traces) {
+    int64_t operand_index = trace.first_operand;
+    std::string msg;
+    for (const FormatStep& step : trace.format) {
+      if (std::holds_alternative<std::string>(step)) {
+        absl::StrAppend(&msg, std::get<std::string>(step));
+        continue;
+      }
+      const DeferredTraceOperand& operand =
+          deferred_trace_operands[operand_index++];
+      Value value = operand.decode(
+          operand.layout, deferred_trace_bytes.data() + operand.offset);
+      absl::StrAppend(&msg,
+                      value.ToHumanString(std::get<FormatPreference>(step)));
+    }
+    trace_msgs.push_back(std::move(msg));
+  }
+  deferred_traces.clear();
+  deferred_trace_operands.clear();
+  deferred_trace_bytes.clear();
+}
+
 absl::Status InterpreterEventsToStatus(const InterpreterEvents& events) {
   if (events.assert_msgs.empty()) {
     return absl::OkStatus();
@@ -15,25 +15,92 @@
 #ifndef XLS_IR_EVENTS_H_
 #define XLS_IR_EVENTS_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/format_strings.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 
+// How evaluation of IR records the messages of trace operations.
+enum class TraceRecording {
+  // Each message is formatted when the trace operation executes and added to
+  // `InterpreterEvents::trace_msgs`.
+  kEager,
+  // The format and raw operand bytes of each message are recorded in
+  // `InterpreterEvents::deferred_traces`. Messages are only formatted, and
+  // added to `trace_msgs`, by InterpreterEvents::RenderDeferredTraces.
+  kDeferred,
+  // Trace operations record nothing.
+  kDisabled,
+};
+
+// An operand of a deferred trace message held as raw bytes (e.g., in the
+// native layout of the JIT).
+struct DeferredTraceOperand {
+  // Converts the raw bytes of the operand to a Value. `layout` describes the
+  // layout of the bytes and must outlive the events.
+  Value (*decode)(const void* layout, const uint8_t* bytes);
+  const void* layout;
+  // Offset of the operand in `InterpreterEvents::deferred_trace_bytes`.
+  int64_t offset;
+};
+
+// A trace message whose formatting has been deferred.
+struct DeferredTrace {
+  // Format of the message, owned by the trace operation which produced it.
+  absl::Span<const FormatStep> format;
+  // Index in `InterpreterEvents::deferred_trace_operands` of the first operand
+  // of the message.
+  int64_t first_operand;
+};
+
 // Common structure capturing events that can be produced by any XLS interpreter
 // (DSLX, IR, JIT, etc.)
 struct InterpreterEvents {
   std::vector<std::string> trace_msgs;
   std::vector<std::string> assert_msgs;
 
+  // Trace messages recorded with TraceRecording::kDeferred, and the storage of
+  // their operands. Deferred messages always follow those in `trace_msgs`.
+  std::vector<DeferredTrace> deferred_traces;
+  std::vector<DeferredTraceOperand> deferred_trace_operands;
+  std::vector<uint8_t> deferred_trace_bytes;
+
+  // Records a deferred trace message with the given format. Its operands must
+  // be added with AddDeferredTraceOperand before another message is recorded.
+  void AddDeferredTrace(absl::Span<const FormatStep> format) {
+    deferred_traces.push_back(DeferredTrace{
+        .format = format,
+        .first_operand = static_cast<int64_t>(deferred_trace_operands.size())});
+  }
+
+  // Adds the next operand of the last deferred trace message and returns the
+  // (suitably aligned) buffer of `size` bytes into which the caller must copy
+  // the operand. The buffer is invalidated by the next call.
+  uint8_t* AddDeferredTraceOperand(Value (*decode)(const void*, const uint8_t*),
+                                   const void* layout, int64_t size);
+
+  // Formats the deferred trace messages, appends them to `trace_msgs` and
+  // clears the deferred messages.
+  void RenderDeferredTraces();
+
   void Clear() {
     trace_msgs.clear();
     assert_msgs.clear();
+    deferred_traces.clear();
+    deferred_trace_operands.clear();
+    deferred_trace_bytes.clear();
   }
 
+  // Note that deferred trace messages are not compared; they should be
+  // rendered first.
+
   bool operator==(const InterpreterEvents& other) const {
     return trace_msgs == other.trace_msgs && assert_msgs == other.assert_msgs;
   }
@@ -0,0 +1,341 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/fast_value_parser.h"
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/optimization.h"
+#include "absl/numeric/bits.h"
+#include "absl/status/statusor.h"
+#include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+// Returns the value of the given hexadecimal digit or -1 if `c` is not one.
+int HexDigitValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+bool IsLiteralChar(char c) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+         (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+// Recursive descent parser over the characters of a value. Each method returns
+// std::nullopt if the input is not in a form handled by the fast path, in
+// which case the caller falls back to the general parser.
+class FastValueParser {
+ public:
+  explicit FastValueParser(std::string_view input) : input_(input) {}
+
+  // Parses the whole input as a value of type `type`, or as a typed value if
+  // `type` is null.
+  std::optional<Value> ParseAll(Type* type) {
+    std::optional<Value> value =
+        type == nullptr ? ParseTypedValue() : ParseValue(type);
+    SkipWhitespace();
+    if (!value.has_value() || pos_ != input_.size()) {
+      return std::nullopt;
+    }
+    return value;
+  }
+
+ private:
+  void SkipWhitespace() {
+    while (pos_ < input_.size() &&
+           (input_[pos_] == ' ' || input_[pos_] == '\t' ||
+            input_[pos_] == '\n' || input_[pos_] == '\r')) {
+      ++pos_;
+    }
+  }
+
+  bool TryConsume(char c) {
+    SkipWhitespace();
+    if (pos_ < input_.size() && input_[pos_] == c) {
+      ++pos_;
+      return true;
+    }
+    return false;
+  }
+
+  bool TryConsume(std::string_view s) {
+    SkipWhitespace();
+    if (input_.substr(pos_, s.size()) == s) {
+      pos_ += s.size();
+      return true;
+    }
+    return false;
+  }
+
+  // Returns the characters of the literal starting at the current position
+  // and advances past it.
+  std::string_view ConsumeLiteral() {
+    SkipWhitespace();
+    int64_t start = pos_;
+    while (pos_ < input_.size() && IsLiteralChar(input_[pos_])) {
+      ++pos_;
+    }
+    return input_.substr(start, pos_ - start);
+  }
+
+  // Parses a non-negative decimal integer such as a bit count.
+  std::optional<int64_t> ParseSmallInteger() {
+    std::string_view digits = ConsumeLiteral();
+    if (digits.empty() || digits.size() > 18) {
+      return std::nullopt;
+    }
+    int64_t result = 0;
+    for (char c : digits) {
+      if (c < '0' || c > '9') {
+        return std::nullopt;
+      }
+      result = result * 10 + (c - '0');
+    }
+    return result;
+  }
+
+  // Parses an unsigned literal of the given width.
+  std::optional<Value> ParseBitsLiteral(int64_t bit_count) {
+    std::string_view literal = ConsumeLiteral();
+    if (literal.size() >= 2 && literal[0] == '0' &&
+        (literal[1] == 'x' || literal[1] == 'b')) {
+      int64_t digit_bits = literal[1] == 'x' ? 4 : 1;
+      return ParsePowerOfTwoDigits(literal.substr(2), digit_bits, bit_count);
+    }
+    return ParseDecimal(literal, bit_count);
+  }
+
+  // Parses hexadecimal (`digit_bits` == 4) or binary (`digit_bits` == 1)
+  // digits, least significant first, directly into the words of the result.
+  std::optional<Value> ParsePowerOfTwoDigits(std::string_view digits,
+                                             int64_t digit_bits,
+                                             int64_t bit_count) {
+    InlineBitmap bitmap(bit_count);
+    int64_t bit = 0;
+    int64_t wordno = 0;
+    uint64_t word = 0;
+    bool any_digit = false;
+    for (auto it = digits.rbegin(); it != digits.rend(); ++it) {
+      if (*it == '_') {
+        continue;
+      }
+      int digit = HexDigitValue(*it);
+      if (digit < 0 || digit >= (1 << digit_bits)) {
+        return std::nullopt;
+      }
+      any_digit = true;
+      if (digit != 0) {
+        // Digits never straddle a word boundary as the word size is a
+        // multiple of the digit size.
+        int64_t digit_width = absl::bit_width(static_cast<unsigned>(digit));
+        if (bit + digit_width > bit_count) {
+          return std::nullopt;
+        }
+        word |= static_cast<uint64_t>(digit) << (bit % 64);
+      }
+      bit += digit_bits;
+      if (bit % 64 == 0) {
+        if (word != 0) {
+          bitmap.SetWord(wordno, word);
+        }
+        ++wordno;
+        word = 0;
+      }
+    }
+    if (!any_digit) {
+      return std::nullopt;
+    }
+    if (word != 0) {
+      bitmap.SetWord(wordno, word);
+    }
+    return Value(Bits::FromBitmap(std::move(bitmap)));
+  }
+
+  std::optional<Value> ParseDecimal(std::string_view digits,
+                                    int64_t bit_count) {
+    // Leading zeros are an error in the general parser (e.g., `01`).
+    if (digits.empty() || (digits.size() > 1 && digits[0] == '0')) {
+      return std::nullopt;
+    }
+    uint64_t result = 0;
+    for (char c : digits) {
+      if (c == '_') {
+        continue;
+      }
+      if (c < '0' || c > '9') {
+        return std::nullopt;
+      }
+      uint64_t digit = c - '0';
+      if (result > (UINT64_MAX - digit) / 10) {
+        return std::nullopt;
+      }
+      result = result * 10 + digit;
+    }
+    if (bit_count < 64 && (result >> bit_count) != 0) {
+      return std::nullopt;
+    }
+    if (bit_count <= 64) {
+      return Value(UBits(result, bit_count));
+    }
+    InlineBitmap bitmap(bit_count);
+    bitmap.SetWord(0, result);
+    return Value(Bits::FromBitmap(std::move(bitmap)));
+  }
+
+  std::optional<Value> ParseValue(Type* type) {
+    switch (type->kind()) {
+      case TypeKind::kBits:
+        return ParseBitsLiteral(type->AsBitsOrDie()->bit_count());
+      case TypeKind::kTuple: {
+        TupleType* tuple_type = type->AsTupleOrDie();
+        if (!TryConsume('(')) {
+          return std::nullopt;
+        }
+        std::vector<Value> elements;
+        elements.reserve(tuple_type->size());
+        for (int64_t i = 0; i < tuple_type->size(); ++i) {
+          if (i > 0 && !TryConsume(',')) {
+            return std::nullopt;
+          }
+          std::optional<Value> element =
+              ParseValue(tuple_type->element_type(i));
+          if (!element.has_value()) {
+            return std::nullopt;
+          }
+          elements.push_back(std::move(element).value());
+        }
+        if (!TryConsume(')')) {
+          return std::nullopt;
+        }
+        return Value::TupleOwned(std::move(elements));
+      }
+      case TypeKind::kArray: {
+        ArrayType* array_type = type->AsArrayOrDie();
+        if (!TryConsume('[')) {
+          return std::nullopt;
+        }
+        std::vector<Value> elements;
+        elements.reserve(array_type->size());
+        for (int64_t i = 0; i < array_type->size(); ++i) {
+          if (i > 0 && !TryConsume(',')) {
+            return std::nullopt;
+          }
+          std::optional<Value> element =
+              ParseValue(array_type->element_type());
+          if (!element.has_value()) {
+            return std::nullopt;
+          }
+          elements.push_back(std::move(element).value());
+        }
+        if (elements.empty() || !TryConsume(']')) {
+          return std::nullopt;
+        }
+        return Value::ArrayOwned(std::move(elements));
+      }
+      case TypeKind::kToken:
+        if (!TryConsume("token")) {
+          return std::nullopt;
+        }
+        return Value::Token();
+    }
+    return std::nullopt;
+  }
+
+  std::optional<Value> ParseTypedValue() {
+    if (TryConsume("bits")) {
+      if (!TryConsume('[')) {
+        return std::nullopt;
+      }
+      std::optional<int64_t> bit_count = ParseSmallInteger();
+      if (!bit_count.has_value() || !TryConsume(']') || !TryConsume(':')) {
+        return std::nullopt;
+      }
+      return ParseBitsLiteral(bit_count.value());
+    }
+    if (TryConsume("token")) {
+      return Value::Token();
+    }
+    bool is_tuple = TryConsume('(');
+    if (!is_tuple && !TryConsume('[')) {
+      return std::nullopt;
+    }
+    char close = is_tuple ? ')' : ']';
+    std::vector<Value> elements;
+    while (!TryConsume(close)) {
+      if (!elements.empty() && !TryConsume(',')) {
+        return std::nullopt;
+      }
+      std::optional<Value> element = ParseTypedValue();
+      if (!element.has_value()) {
+        return std::nullopt;
+      }
+      // Array elements must all have the same type.
+      if (!is_tuple && !elements.empty() &&
+          !elements.front().SameTypeAs(element.value())) {
+        return std::nullopt;
+      }
+      elements.push_back(std::move(element).value());
+    }
+    if (is_tuple) {
+      return Value::TupleOwned(std::move(elements));
+    }
+    if (elements.empty()) {
+      return std::nullopt;
+    }
+    return Value::ArrayOwned(std::move(elements));
+  }
+
+  std::string_view input_;
+  int64_t pos_ = 0;
+};
+
+}  // namespace
+
+absl::StatusOr<Value> ParseValueFast(std::string_view input, Type* type) {
+  std::optional<Value> value = FastValueParser(input).ParseAll(type);
+  if (ABSL_PREDICT_TRUE(value.has_value())) {
+    return std::move(value).value();
+  }
+  return Parser::ParseValue(input, type);
+}
+
+absl::StatusOr<Value> ParseTypedValueFast(std::string_view input) {
+  std::optional<Value> value =
+      FastValueParser(input).ParseAll(/*type=*/nullptr);
+  if (ABSL_PREDICT_TRUE(value.has_value())) {
+    return std::move(value).value();
+  }
+  return Parser::ParseTypedValue(input);
+}
+
+}  // namespace xls
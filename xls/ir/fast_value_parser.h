@@ -0,0 +1,44 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_FAST_VALUE_PARSER_H_
+#define XLS_IR_FAST_VALUE_PARSER_H_
+
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// Drop-in replacements for Parser::ParseValue and Parser::ParseTypedValue
+// intended for parsing large numbers of values, e.g., the input files of the
+// evaluation tools. The common forms (unsigned hexadecimal, binary and decimal
+// literals, tuples, arrays and tokens) are parsed directly from the
+// characters of the input without creating a scanner or tokens, and literals
+// of up to 64 bits are accumulated in a single word. Literals are written
+// straight into the bitmap of the result.
+//
+// Inputs the fast path does not handle, such as negative literals, decimal
+// literals wider than 64 bits, values which do not fit their type and
+// malformed inputs, are handed to the general IR parser. The results
+// (including error messages) are therefore identical to those of the Parser
+// methods.
+absl::StatusOr<Value> ParseValueFast(std::string_view input, Type* type);
+absl::StatusOr<Value> ParseTypedValueFast(std::string_view input);
+
+}  // namespace xls
+
+#endif  // XLS_IR_FAST_VALUE_PARSER_H_
@@ -0,0 +1,87 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "include/benchmark/benchmark.h"
+#include "xls/common/logging/logging.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/fast_value_parser.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+// Returns a tuple of `element_count` random bits values of the given width in
+// typed string form, as found in the input files of the evaluation tools.
+std::string RandomTypedValue(int64_t bit_count, int64_t element_count,
+                             std::minstd_rand& bitgen) {
+  std::uniform_int_distribution<int> byte_dist(0, 255);
+  std::vector<Value> elements;
+  for (int64_t i = 0; i < element_count; ++i) {
+    std::vector<uint8_t> bytes((bit_count + 7) / 8);
+    for (uint8_t& byte : bytes) {
+      byte = byte_dist(bitgen);
+    }
+    elements.push_back(Value(Bits::FromBytes(bytes, bit_count)));
+  }
+  if (element_count == 1) {
+    return elements.front().ToString(FormatPreference::kHex);
+  }
+  return Value::Tuple(elements).ToString(FormatPreference::kHex);
+}
+
+// Arguments are the bit width and the number of tuple elements (one for a
+// plain bits value).
+void ValueShapes(benchmark::internal::Benchmark* b) {
+  for (int64_t width : {8, 32, 64, 256}) {
+    b->Args({width, 1});
+  }
+  b->Args({32, 4});
+  b->Args({64, 16});
+}
+
+void BM_ParseTypedValue(benchmark::State& state) {
+  std::minstd_rand bitgen;
+  std::string input =
+      RandomTypedValue(state.range(0), state.range(1), bitgen);
+  for (auto _ : state) {
+    absl::StatusOr<Value> v = Parser::ParseTypedValue(input);
+    XLS_CHECK_OK(v.status());
+    benchmark::DoNotOptimize(v);
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_ParseTypedValue)->Apply(ValueShapes);
+
+void BM_ParseTypedValueFast(benchmark::State& state) {
+  std::minstd_rand bitgen;
+  std::string input =
+      RandomTypedValue(state.range(0), state.range(1), bitgen);
+  for (auto _ : state) {
+    absl::StatusOr<Value> v = ParseTypedValueFast(input);
+    XLS_CHECK_OK(v.status());
+    benchmark::DoNotOptimize(v);
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_ParseTypedValueFast)->Apply(ValueShapes);
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,102 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/fast_value_parser.h"
+
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+
+// Expects the fast parser to produce exactly the result (value or error) of
+// the general parser.
+void ExpectSameAsParser(std::string_view input, Type* type = nullptr) {
+  absl::StatusOr<Value> expected = type == nullptr
+                                       ? Parser::ParseTypedValue(input)
+                                       : Parser::ParseValue(input, type);
+  absl::StatusOr<Value> actual = type == nullptr
+                                     ? ParseTypedValueFast(input)
+                                     : ParseValueFast(input, type);
+  EXPECT_EQ(actual.status(), expected.status()) << input;
+  if (expected.ok() && actual.ok()) {
+    EXPECT_EQ(actual.value(), expected.value()) << input;
+  }
+}
+
+TEST(FastValueParserTest, TypedBits) {
+  EXPECT_THAT(ParseTypedValueFast("bits[32]:0x42"),
+              IsOkAndHolds(Value(UBits(0x42, 32))));
+  EXPECT_THAT(ParseTypedValueFast("  bits[ 8 ] : 0b1010_1010 "),
+              IsOkAndHolds(Value(UBits(0xaa, 8))));
+  EXPECT_THAT(ParseTypedValueFast("bits[64]:18446744073709551615"),
+              IsOkAndHolds(Value(UBits(UINT64_MAX, 64))));
+  for (std::string_view input :
+       {"bits[0]:0", "bits[1]:1", "bits[4]:0x000f",
+        "bits[65]:0x1_0000_0000_0000_0000",
+        "bits[200]:0xdead_beef_cafe_f00d_0123_4567_89ab_cdef_fedc",
+        "bits[128]:12345678901234567890", "bits[3]:7", "bits[13]:0"}) {
+    ExpectSameAsParser(input);
+  }
+}
+
+TEST(FastValueParserTest, TypedAggregates) {
+  for (std::string_view input :
+       {"(bits[8]:1, bits[32]:0x123)", "()", "token", "(token, bits[1]:0)",
+        "[bits[4]:1, bits[4]:2, bits[4]:3]",
+        "[(bits[2]:1, [bits[3]:7]), (bits[2]:0, [bits[3]:0])]",
+        "((), ((bits[1]:1)))"}) {
+    ExpectSameAsParser(input);
+  }
+}
+
+TEST(FastValueParserTest, FallsBackToGeneralParser) {
+  // Negative literals, over-wide values, wide decimals and malformed inputs
+  // are handled by (and produce the same errors as) the general parser.
+  for (std::string_view input :
+       {"bits[8]:-1", "bits[8]:0x100", "bits[4]:16", "bits[4]:0b10000",
+        "bits[100]:123456789012345678901234567890", "bits[8]:012", "bits[8]:",
+        "bits[8]:0xg", "bits[8]", "(bits[8]:1", "[bits[8]:1, bits[4]:1]",
+        "[]", "bits[8]:1 bits[8]:2", "0x42", ""}) {
+    ExpectSameAsParser(input);
+  }
+}
+
+TEST(FastValueParserTest, UntypedWithType) {
+  Package p("test");
+  Type* u32 = p.GetBitsType(32);
+  Type* tuple = p.GetTupleType({p.GetBitsType(8), p.GetArrayType(2, u32)});
+  EXPECT_THAT(ParseValueFast("0xabcd", u32),
+              IsOkAndHolds(Value(UBits(0xabcd, 32))));
+  ExpectSameAsParser("(0x1, [2, 0b11])", tuple);
+  ExpectSameAsParser("(0x1, [2])", tuple);
+  ExpectSameAsParser("(0x100, [2, 3])", tuple);
+  ExpectSameAsParser("-5", u32);
+  ExpectSameAsParser("token", p.GetTokenType());
+}
+
+}  // namespace
+}  // namespace xls
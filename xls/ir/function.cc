@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -87,27 +88,33 @@ absl::StatusOr<Function*> Function::Clone(
     std::string_view new_name, Package* target_package,
     const absl::flat_hash_map<const Function*, Function*>& call_remapping)
     const {
-  absl::flat_hash_map<Node*, Node*> original_to_clone;
   if (target_package == nullptr) {
     target_package = package();
   }
   Function* cloned_function = target_package->AddFunction(
       std::make_unique<Function>(new_name, target_package));
   cloned_function->SetForeignFunctionData(foreign_function_);
+  cloned_function->ReserveNodes(node_count());
+
+  // Map from node index of an original node to its clone.
+  std::vector<Node*> original_to_clone(node_index_limit(), nullptr);
+  auto clone_of = [&](Node* node) -> Node*& {
+    return original_to_clone[node->node_index()];
+  };
 
   // Clone parameters over first to maintain order.
   for (Param* param : (const_cast<Function*>(this))->params()) {
-    XLS_ASSIGN_OR_RETURN(
-            original_to_clone[param],
-            param->CloneInNewFunction({}, cloned_function));
+    XLS_ASSIGN_OR_RETURN(clone_of(param),
+                         param->CloneInNewFunction({}, cloned_function));
   }
-  for (Node* node : TopoSort(const_cast<Function*>(this))) {
+  std::vector<Node*> cloned_operands;
+  for (Node* node : NodesInOperandOrder()) {
     if (node->Is<Param>()) {  // Params were already copied.
       continue;
     }
-    std::vector<Node*> cloned_operands;
+    cloned_operands.clear();
     for (Node* operand : node->operands()) {
-      cloned_operands.push_back(original_to_clone.at(operand));
+      cloned_operands.push_back(clone_of(operand));
     }
 
     switch (node->op()) {
@@ -118,7 +125,7 @@ absl::StatusOr<Function*> Function::Clone(
                              ? call_remapping.at(src->body())
                              : src->body();
         XLS_ASSIGN_OR_RETURN(
-            original_to_clone[node],
+            clone_of(node),
             cloned_function->MakeNodeWithName<CountedFor>(
                 src->loc(), cloned_operands[0],
                 absl::Span<Node*>(cloned_operands).subspan(1),
@@ -132,7 +139,7 @@ absl::StatusOr<Function*> Function::Clone(
                                  ? call_remapping.at(src->to_apply())
                                  : src->to_apply();
         XLS_ASSIGN_OR_RETURN(
-            original_to_clone[node],
+            clone_of(node),
             cloned_function->MakeNodeWithName<Map>(
                 src->loc(), cloned_operands[0], to_apply, src->GetName()));
         break;
@@ -144,22 +151,27 @@ absl::StatusOr<Function*> Function::Clone(
                                  ? call_remapping.at(src->to_apply())
                                  : src->to_apply();
         XLS_ASSIGN_OR_RETURN(
-            original_to_clone[node],
+            clone_of(node),
             cloned_function->MakeNodeWithName<Invoke>(
                 src->loc(), cloned_operands, to_apply, src->GetName()));
         break;
       }
-      // Default clone.
+      // Default clone. Within a package the clone is an exact copy of the
+      // original node so verifying it would only re-check the original.
       default: {
+        std::optional<ScopedSkipNodeVerification> skip_verification;
+        if (target_package == package()) {
+          skip_verification.emplace(cloned_function);
+        }
         XLS_ASSIGN_OR_RETURN(
-            original_to_clone[node],
+            clone_of(node),
             node->CloneInNewFunction(cloned_operands, cloned_function));
         break;
       }
     }
   }
   XLS_RETURN_IF_ERROR(
-      cloned_function->set_return_value(original_to_clone.at(return_value())));
+      cloned_function->set_return_value(clone_of(return_value())));
   return cloned_function;
 }
 
@@ -40,9 +40,6 @@
 namespace xls {
 
 class Function : public FunctionBase {
- private:
-  using NodeList = std::list<std::unique_ptr<Node>>;
-
  public:
   Function(std::string_view name, Package* package)
       : FunctionBase(name, package) {}
@@ -56,7 +53,11 @@ class Function : public FunctionBase {
     XLS_RET_CHECK_EQ(n->function_base(), this) << absl::StreamFormat(
         "Return value node %s is not in this function %s (is in function %s)",
         n->GetName(), name(), n->function_base()->name());
+    if (return_value_ != nullptr) {
+      return_value_->MarkChanged();
+    }
     return_value_ = n;
+    n->MarkChanged();
     return absl::OkStatus();
   }
 
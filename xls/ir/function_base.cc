@@ -35,10 +35,12 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/block.h"
+#include "xls/ir/call_graph.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_scanner.h"
 #include "xls/ir/node.h"
+#include "xls/ir/node_iterator.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc.h"
@@ -129,10 +131,16 @@ absl::Status FunctionBase::RemoveNode(Node* node) {
     params_.erase(std::remove(params_.begin(), params_.end(), node),
                   params_.end());
   }
-  auto node_it = node_iterators_.find(node);
-  XLS_RET_CHECK(node_it != node_iterators_.end());
-  nodes_.erase(node_it->second);
-  node_iterators_.erase(node_it);
+  XLS_RET_CHECK(node->node_index() >= 0 &&
+                node->node_index() < nodes_.size() &&
+                nodes_[node->node_index()].get() == node)
+      << node->GetName();
+  if (CalledFunction(node).has_value()) {
+    package()->InvalidateCallGraph();
+  }
+  nodes_[node->node_index()].reset();
+  --node_count_;
+  InvalidateNodeOrder();
   return absl::OkStatus();
 }
 
@@ -198,10 +206,52 @@ Node* FunctionBase::AddNodeInternal(std::unique_ptr<Node> node) {
     params_.push_back(node->As<Param>());
   }
   Node* ptr = node.get();
-  node_iterators_[ptr] = nodes_.insert(nodes_.end(), std::move(node));
+  ptr->node_index_ = next_node_index_++;
+  nodes_.push_back(std::move(node));
+  ++node_count_;
+  InvalidateNodeOrder();
+  if (CalledFunction(ptr).has_value()) {
+    package()->InvalidateCallGraph();
+  }
   return ptr;
 }
 
+bool FunctionBase::CompactNodeIndices() {
+  if (node_count_ == next_node_index_) {
+    return false;
+  }
+  int64_t next_index = 0;
+  for (int64_t i = 0; i < nodes_.size(); ++i) {
+    if (nodes_[i] == nullptr) {
+      continue;
+    }
+    nodes_[i]->node_index_ = next_index;
+    if (i != next_index) {
+      nodes_[next_index] = std::move(nodes_[i]);
+    }
+    ++next_index;
+  }
+  XLS_CHECK_EQ(next_index, node_count_);
+  nodes_.resize(next_index);
+  nodes_.shrink_to_fit();
+  next_node_index_ = next_index;
+  return true;
+}
+
+std::vector<Node*> FunctionBase::NodesInOperandOrder() const {
+  std::vector<Node*> nodes;
+  nodes.reserve(node_count());
+  for (Node* node : this->nodes()) {
+    for (Node* operand : node->operands()) {
+      if (operand->node_index() >= node->node_index()) {
+        return TopoSort(const_cast<FunctionBase*>(this)).AsVector();
+      }
+    }
+    nodes.push_back(node);
+  }
+  return nodes;
+}
+
 /*static*/ std::vector<std::string> FunctionBase::GetIrReservedWords() {
   std::vector<std::string> words(Token::GetKeywords().begin(),
                                  Token::GetKeywords().end());
@@ -15,7 +15,11 @@
 #ifndef XLS_IR_FUNCTION_BASE_H_
 #define XLS_IR_FUNCTION_BASE_H_
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
+#include <limits>
 #include <list>
 #include <memory>
 #include <optional>
@@ -24,10 +28,12 @@
 #include <string_view>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/iterator_range.h"
 #include "xls/common/status/status_macros.h"
@@ -35,6 +41,7 @@
 #include "xls/ir/foreign_function_data.pb.h"
 #include "xls/ir/name_uniquer.h"
 #include "xls/ir/node.h"
+#include "xls/ir/node_arena.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/ir/unwrapping_iterator.h"
@@ -48,9 +55,64 @@ class Proc;
 // Base class for Functions and Procs. A holder of a set of nodes.
 class FunctionBase {
  protected:
-  using NodeList = std::list<std::unique_ptr<Node>>;
+  // Nodes indexed by Node::node_index. Slots of removed nodes are null.
+  using NodeSlots = std::vector<std::unique_ptr<Node>>;
 
  public:
+  // Iterates over the nodes of a function base in the order they were added.
+  // The iterator holds a node index rather than a pointer into the node
+  // storage, so nodes may be added or removed while iterating: removed nodes
+  // are skipped and nodes added during the iteration are visited. Removing the
+  // node the iterator currently points to is also safe.
+  class NodeSlotIterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Node*;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Node**;
+    using reference = Node*;
+
+    NodeSlotIterator() = default;
+    NodeSlotIterator(const NodeSlots* slots, int64_t index)
+        : slots_(slots), index_(index) {
+      SkipRemoved();
+    }
+
+    Node* operator*() const { return (*slots_)[index_].get(); }
+    Node* operator->() const { return (*slots_)[index_].get(); }
+    NodeSlotIterator& operator++() {
+      ++index_;
+      SkipRemoved();
+      return *this;
+    }
+    NodeSlotIterator operator++(int) {
+      NodeSlotIterator result = *this;
+      ++*this;
+      return result;
+    }
+    // All iterators past the last node compare equal, so an end iterator
+    // obtained before nodes were added still terminates iteration correctly.
+    friend bool operator==(const NodeSlotIterator& a,
+                           const NodeSlotIterator& b) {
+      return a.AtEnd() ? b.AtEnd() : !b.AtEnd() && a.index_ == b.index_;
+    }
+    friend bool operator!=(const NodeSlotIterator& a,
+                           const NodeSlotIterator& b) {
+      return !(a == b);
+    }
+
+   private:
+    bool AtEnd() const { return slots_ == nullptr || index_ >= slots_->size(); }
+    void SkipRemoved() {
+      while (!AtEnd() && (*slots_)[index_] == nullptr) {
+        ++index_;
+      }
+    }
+
+    const NodeSlots* slots_ = nullptr;
+    int64_t index_ = 0;
+  };
+
   FunctionBase(std::string_view name, Package* package)
       : name_(name), package_(package) {}
   FunctionBase(const FunctionBase& other) = delete;
@@ -93,18 +155,27 @@ class FunctionBase {
   // Moves the given param to the given index in the parameter list.
   absl::Status MoveParamToIndex(Param* param, int64_t index);
 
-  int64_t node_count() const { return nodes_.size(); }
+  int64_t node_count() const { return node_count_; }
+
+  // Returns one more than the largest index assigned to a node of this
+  // function base (see Node::node_index). Side tables indexed by node index
+  // need at most this many entries.
+  int64_t node_index_limit() const { return next_node_index_; }
+
+  // Renumbers the nodes densely, preserving their order, so that
+  // node_index_limit() equals node_count() and the slots of removed nodes are
+  // released. Every side table indexed by node index (NodeMap, NodeSet) built
+  // before the call is invalid afterwards, so this is only done at pass
+  // boundaries (see OptimizationFunctionBasePass). Returns true if any index
+  // changed.
+  bool CompactNodeIndices();
 
   // Expose Nodes, so that transformation passes can operate
   // on this function.
-  xabsl::iterator_range<UnwrappingIterator<NodeList::iterator>> nodes() {
-    return xabsl::make_range(MakeUnwrappingIterator(nodes_.begin()),
-                             MakeUnwrappingIterator(nodes_.end()));
-  }
-  xabsl::iterator_range<UnwrappingIterator<NodeList::const_iterator>> nodes()
-      const {
-    return xabsl::make_range(MakeUnwrappingIterator(nodes_.begin()),
-                             MakeUnwrappingIterator(nodes_.end()));
+  xabsl::iterator_range<NodeSlotIterator> nodes() const {
+    return xabsl::make_range(
+        NodeSlotIterator(&nodes_, 0),
+        NodeSlotIterator(&nodes_, std::numeric_limits<int64_t>::max()));
   }
 
   // Adds a node to the set owned by this function.
@@ -122,17 +193,21 @@ class FunctionBase {
   // to the newly constructed node.
   template <typename NodeT, typename... Args>
   absl::StatusOr<NodeT*> MakeNode(Args&&... args) {
-    NodeT* new_node = AddNode(std::make_unique<NodeT>(
-        std::forward<Args>(args)..., /*name=*/"", this));
-    XLS_RETURN_IF_ERROR(VerifyNode(new_node));
+    NodeT* new_node = AddNode(std::unique_ptr<NodeT>(new (node_arena_) NodeT(
+        std::forward<Args>(args)..., /*name=*/"", this)));
+    if (verify_new_nodes_) {
+      XLS_RETURN_IF_ERROR(VerifyNode(new_node));
+    }
     return new_node;
   }
 
   template <typename NodeT, typename... Args>
   absl::StatusOr<NodeT*> MakeNodeWithName(Args&&... args) {
-    NodeT* new_node =
-        AddNode(std::make_unique<NodeT>(std::forward<Args>(args)..., this));
-    XLS_RETURN_IF_ERROR(VerifyNode(new_node));
+    NodeT* new_node = AddNode(std::unique_ptr<NodeT>(
+        new (node_arena_) NodeT(std::forward<Args>(args)..., this)));
+    if (verify_new_nodes_) {
+      XLS_RETURN_IF_ERROR(VerifyNode(new_node));
+    }
     return new_node;
   }
 
@@ -186,22 +261,62 @@ class FunctionBase {
   }
 
  protected:
+  // Disables verification of the nodes created by MakeNode and
+  // MakeNodeWithName in the given function base while in scope. Used when
+  // making exact copies of nodes which are already known to be well formed.
+  class ScopedSkipNodeVerification {
+   public:
+    explicit ScopedSkipNodeVerification(FunctionBase* f)
+        : f_(f), previous_(f->verify_new_nodes_) {
+      f_->verify_new_nodes_ = false;
+    }
+    ~ScopedSkipNodeVerification() { f_->verify_new_nodes_ = previous_; }
+
+   private:
+    FunctionBase* f_;
+    bool previous_;
+  };
+
   // Internal virtual helper for adding a node. Returns a pointer to the newly
   // added node.
   virtual Node* AddNodeInternal(std::unique_ptr<Node> node);
 
+  // Reserves storage for `count` more nodes.
+  void ReserveNodes(int64_t count) { nodes_.reserve(nodes_.size() + count); }
+
+  // Returns the nodes in an order in which every node follows its operands.
+  // If the order in which the nodes were added already has this property, as
+  // is typical, that order is returned, which is much cheaper to compute than
+  // TopoSort. Otherwise the TopoSort order is returned.
+  std::vector<Node*> NodesInOperandOrder() const;
+
   // Returns a vector containing the reserved words in the IR.
   static std::vector<std::string> GetIrReservedWords();
 
+  // Discards the cached node order. Called whenever a node is added or removed
+  // or the operands, users or implicit uses of a node change.
+  void InvalidateNodeOrder() {
+    node_order_valid_.store(false, std::memory_order_relaxed);
+  }
+
   std::string name_;
   Package* package_;
   std::optional<int64_t> initiation_interval_;
 
-  // Store Nodes in std::list as they can be added and removed arbitrarily and
-  // we want a stable iteration order. Keep a map from instruction pointer to
-  // location in the list for fast lookup.
-  NodeList nodes_;
-  absl::flat_hash_map<const Node*, NodeList::iterator> node_iterators_;
+  // Storage of the nodes created by MakeNode. Declared before `nodes_` so it
+  // outlives them.
+  NodeArena node_arena_;
+
+  // Nodes are stored in a vector indexed by node index. Nodes can be added and
+  // removed arbitrarily; removal leaves a null slot so that iteration order
+  // (the order of addition) and node indices are stable until the slots are
+  // reclaimed by CompactNodeIndices. Compared to a linked list plus a
+  // node-to-position map this needs no per-node allocation other than the node
+  // itself and locates a node for removal without hashing.
+  NodeSlots nodes_;
+  int64_t node_count_ = 0;
+  int64_t next_node_index_ = 0;
+  bool verify_new_nodes_ = true;
 
   std::vector<Param*> params_;
 
@@ -209,6 +324,19 @@ class FunctionBase {
       NameUniquer(/*separator=*/"__", GetIrReservedWords());
 
   std::optional<xls::ForeignFunctionData> foreign_function_;
+
+  // Reverse topological order of the nodes as computed by NodeIterator. The
+  // order is computed by the first TopoSort/ReverseTopoSort call and shared by
+  // later calls until the graph changes, so passes which do not modify the
+  // function do not pay for re-sorting it. The mutex only serializes readers
+  // filling the cache; as for any other FunctionBase state, mutating the
+  // function concurrently with reading it is not supported.
+  friend class Node;
+  friend class NodeIterator;
+  mutable absl::Mutex node_order_mutex_;
+  mutable std::vector<Node*> reverse_node_order_
+      ABSL_GUARDED_BY(node_order_mutex_);
+  mutable std::atomic<bool> node_order_valid_ = false;
 };
 
 std::ostream& operator<<(std::ostream& os, const FunctionBase& function);
@@ -14,13 +14,23 @@
 
 #include "xls/ir/function.h"
 
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/base/config.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/function_builder.h"
+#include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/node_util.h"
+#include "xls/ir/nodes.h"
+
+namespace m = ::xls::op_matchers;
 
 namespace xls {
 namespace {
@@ -109,6 +119,88 @@ fn add(x: bits[32], y: bits[32]) -> bits[32] {
   EXPECT_EQ(func_clone->node_count(), 7);
 }
 
+TEST_F(FunctionTest, CloneFunctionWithNodesOutOfOperandOrder) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue not_x = fb.Not(x);
+  BValue neg_x = fb.Negate(x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.BuildWithReturnValue(not_x));
+  // Make not_x use a node added after it so the order in which the nodes were
+  // added is no longer a valid order for cloning.
+  XLS_ASSERT_OK(not_x.node()->ReplaceOperandNumber(0, neg_x.node()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func_clone, func->Clone("cloned"));
+  EXPECT_EQ(func_clone->node_count(), 3);
+  EXPECT_TRUE(func->IsDefinitelyEqualTo(func_clone));
+  EXPECT_THAT(func_clone->return_value(), m::Not(m::Neg(m::Param("x"))));
+}
+
+TEST_F(FunctionTest, NodeIterationWhileAddingAndRemovingNodes) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, ParseFunction(R"(
+fn f(x: bits[32], y: bits[32]) -> bits[32] {
+  add.1: bits[32] = add(x, y)
+  sub.2: bits[32] = sub(x, y)
+  ret neg.3: bits[32] = neg(add.1)
+}
+)",
+                                                          p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * sub, func->GetNode("sub.2"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * neg, func->GetNode("neg.3"));
+
+  // Removing the current node and adding nodes during iteration are both
+  // allowed. Added nodes are visited after the existing ones.
+  std::vector<std::string> visited;
+  for (Node* node : func->nodes()) {
+    visited.push_back(node->GetName());
+    if (node == sub) {
+      XLS_ASSERT_OK(func->RemoveNode(sub));
+    }
+    if (node == neg) {
+      XLS_ASSERT_OK(func->MakeNodeWithName<UnOp>(SourceInfo(), neg, Op::kNot,
+                                                 "not_neg")
+                        .status());
+    }
+  }
+  EXPECT_THAT(visited,
+              ElementsAre("x", "y", "add.1", "sub.2", "neg.3", "not_neg"));
+  EXPECT_EQ(func->node_count(), 5);
+  EXPECT_EQ(std::distance(func->nodes().begin(), func->nodes().end()), 5);
+}
+
+TEST_F(FunctionTest, NodeStorageIsRecycled) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, ParseFunction(R"(
+fn f(x: bits[32], y: bits[32]) -> bits[32] {
+  add.1: bits[32] = add(x, y)
+  sub.2: bits[32] = sub(x, y)
+  ret neg.3: bits[32] = neg(add.1)
+}
+)",
+                                                          p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * sub, func->GetNode("sub.2"));
+  Node* x = func->params()[0];
+  Node* y = func->params()[1];
+
+  // The storage of a removed node is reused by the next node of the same type
+  // created by MakeNode (except under ASan, see NodeArena).
+  Node* old_sub = sub;
+  XLS_ASSERT_OK(func->RemoveNode(sub));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * new_sub, func->MakeNode<BinOp>(SourceInfo(), x, y, Op::kSub));
+#ifndef ABSL_HAVE_ADDRESS_SANITIZER
+  EXPECT_EQ(new_sub, old_sub);
+#endif
+
+  // Heap-allocated nodes may be added and removed too.
+  Node* heap_node = func->AddNode(std::make_unique<BinOp>(
+      SourceInfo(), x, y, Op::kAdd, /*name=*/"", func));
+  XLS_ASSERT_OK(func->RemoveNode(heap_node));
+  XLS_ASSERT_OK(func->RemoveNode(new_sub));
+  EXPECT_EQ(func->node_count(), 4);
+}
+
 TEST_F(FunctionTest, IsDefinitelyEqualTo) {
   XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
 package function_is_equal
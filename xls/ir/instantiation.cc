@@ -26,6 +26,7 @@
 #include "xls/ir/block.h"
 #include "xls/ir/function.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
 #include "xls/ir/type.h"
 #include "re2/re2.h"
 
@@ -141,4 +142,41 @@ std::string ExternInstantiation::ToString() const {
                          name(), function_->name());
 }
 
+std::string FifoConfig::ToString() const {
+  return absl::StrFormat("depth=%d, bypass=%s, register_push_outputs=%s",
+                         depth, bypass ? "true" : "false",
+                         register_push_outputs ? "true" : "false");
+}
+
+absl::StatusOr<InstantiationPort> FifoInstantiation::GetInputPort(
+    std::string_view name) {
+  if (name == kPushDataPortName) {
+    return InstantiationPort{std::string{name}, data_type()};
+  }
+  if (name == kPushValidPortName || name == kPopReadyPortName ||
+      name == kResetPortName) {
+    return InstantiationPort{std::string{name}, package_->GetBitsType(1)};
+  }
+  return absl::NotFoundError(absl::StrFormat(
+      "No such input port `%s` on FIFO `%s`", name, this->name()));
+}
+
+absl::StatusOr<InstantiationPort> FifoInstantiation::GetOutputPort(
+    std::string_view name) {
+  if (name == kPopDataPortName) {
+    return InstantiationPort{std::string{name}, data_type()};
+  }
+  if (name == kPopValidPortName || name == kPushReadyPortName) {
+    return InstantiationPort{std::string{name}, package_->GetBitsType(1)};
+  }
+  return absl::NotFoundError(absl::StrFormat(
+      "No such output port `%s` on FIFO `%s`", name, this->name()));
+}
+
+std::string FifoInstantiation::ToString() const {
+  return absl::StrFormat("instantiation %s(data_type=%s, %s, kind=fifo)",
+                         name(), data_type()->ToString(),
+                         fifo_config().ToString());
+}
+
 }  // namespace xls
@@ -15,6 +15,7 @@
 #ifndef XLS_IR_INSTANTIATION_H_
 #define XLS_IR_INSTANTIATION_H_
 
+#include <cstdint>
 #include <ostream>
 #include <string>
 #include <string_view>
@@ -26,6 +27,7 @@ namespace xls {
 
 class Block;
 class Function;
+class Package;
 
 enum class InstantiationKind {
   // Instantiation of an IR block in the same package.
@@ -50,8 +52,8 @@ struct InstantiationPort {
 
 // Base class for an instantiation which is a block-scoped construct that
 // represents a module instantiation at the Verilog level. The instantiated
-// object can be another block, a FIFO (not yet supported), or a externally
-// defined Verilog module (not yet supported).
+// object can be another block, a FIFO, or a externally defined Verilog
+// module.
 class Instantiation {
  public:
   Instantiation(std::string_view name, InstantiationKind kind)
@@ -110,6 +112,65 @@ class ExternInstantiation : public Instantiation {
   Function* function_;
 };
 
+// Configuration of a FIFO instantiation.
+struct FifoConfig {
+  // Number of entries the FIFO can hold. A depth of zero is only valid for a
+  // bypass FIFO, in which case the FIFO is a pass-through wire.
+  int64_t depth;
+
+  // If true, data pushed into an empty FIFO is presented at the pop side in
+  // the same cycle. Otherwise pushed data appears at the pop side no earlier
+  // than the following cycle.
+  bool bypass;
+
+  // If true, `push_ready` depends only on the FIFO state and not
+  // combinationally on `pop_ready`. This breaks the combinational ready path
+  // through the FIFO at the cost of not accepting a push into a full FIFO in a
+  // cycle in which an entry is popped.
+  bool register_push_outputs;
+
+  std::string ToString() const;
+};
+
+// Abstraction representing the instantiation of a FIFO with ready/valid
+// handshaking on both sides. The FIFO has the following ports:
+//
+//   push_data (input), push_valid (input), push_ready (output)
+//   pop_data (output), pop_valid (output), pop_ready (input)
+//   rst (input, active-high synchronous reset)
+//
+// The clock of the instantiating block is connected implicitly.
+class FifoInstantiation : public Instantiation {
+ public:
+  static constexpr std::string_view kPushDataPortName = "push_data";
+  static constexpr std::string_view kPushValidPortName = "push_valid";
+  static constexpr std::string_view kPushReadyPortName = "push_ready";
+  static constexpr std::string_view kPopDataPortName = "pop_data";
+  static constexpr std::string_view kPopValidPortName = "pop_valid";
+  static constexpr std::string_view kPopReadyPortName = "pop_ready";
+  static constexpr std::string_view kResetPortName = "rst";
+
+  FifoInstantiation(std::string_view name, const FifoConfig& fifo_config,
+                    Type* data_type, Package* package)
+      : Instantiation(name, InstantiationKind::kFifo),
+        fifo_config_(fifo_config),
+        data_type_(data_type),
+        package_(package) {}
+
+  const FifoConfig& fifo_config() const { return fifo_config_; }
+  Type* data_type() const { return data_type_; }
+
+  absl::StatusOr<InstantiationPort> GetInputPort(std::string_view name) final;
+  absl::StatusOr<InstantiationPort> GetOutputPort(std::string_view name) final;
+
+  std::string ToString() const final;
+
+ private:
+  FifoConfig fifo_config_;
+  Type* data_type_;
+  Package* package_;
+};
+
 }  // namespace xls
 
 #endif  // XLS_IR_INSTANTIATION_H_
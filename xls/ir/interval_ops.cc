@@ -14,9 +14,13 @@
 
 #include "xls/ir/interval_ops.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <optional>
+#include <utility>
+#include <vector>
 
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/interval.h"
@@ -49,4 +53,113 @@ KnownBits ExtractKnownBits(const IntervalSet& intervals,
       .known_bit_values = bits_ops::Concat({lcp, remainder}),
   };
 }
+
+namespace {
+
+struct MergeInterval {
+  int64_t start;
+  int64_t end;
+};
+
+struct BitsWithIndex {
+  Bits bits;
+  int64_t index;
+
+  friend bool operator<(const BitsWithIndex& lhs, const BitsWithIndex& rhs) {
+    int64_t cmp = bits_ops::UCmp(lhs.bits, rhs.bits);
+    if (cmp != 0) {
+      return cmp < 0;
+    }
+    return lhs.index < rhs.index;
+  }
+};
+
+// Given a set of `Bits` (all the same bit-width) and a desired size for that
+// set, reduce the number of elements in the set to the desired size by
+// computing a way to merge together small elements of the set. Returns a list
+// of ranges in the input vector that should be merged (i.e.: each range should
+// be compacted down to a single point by whatever processes the output of
+// this function).
+std::vector<MergeInterval> ReduceByMerging(absl::Span<Bits const> elements,
+                                           int64_t desired_size) {
+  if (elements.size() <= desired_size) {
+    return {};
+  }
+
+  std::vector<BitsWithIndex> elements_with_index;
+  elements_with_index.reserve(elements.size());
+  for (int64_t i = 0; i < elements.size(); ++i) {
+    elements_with_index.push_back(BitsWithIndex{elements[i], i});
+  }
+
+  // Only the set of the smallest elements is needed, not their order.
+  const int64_t merge_count = elements.size() - desired_size;
+  std::nth_element(elements_with_index.begin(),
+                   elements_with_index.begin() + (merge_count - 1),
+                   elements_with_index.end());
+
+  std::vector<int64_t> indexes_to_merge;
+  indexes_to_merge.reserve(merge_count);
+  for (int64_t i = 0; i < merge_count; ++i) {
+    indexes_to_merge.push_back(elements_with_index[i].index);
+  }
+  std::sort(indexes_to_merge.begin(), indexes_to_merge.end());
+
+  // Merge contiguous runs of indices into intervals
+  std::vector<MergeInterval> result;
+  for (int64_t i = 0; i < indexes_to_merge.size(); ++i) {
+    int64_t range_start = indexes_to_merge[i];
+    while (((i + 1) < indexes_to_merge.size()) &&
+           ((indexes_to_merge[i] + 1) == indexes_to_merge[i + 1])) {
+      ++i;
+    }
+    int64_t range_end = indexes_to_merge[i];
+    result.push_back({range_start, range_end});
+  }
+
+  return result;
+}
+
+}  // namespace
+
+IntervalSet MinimizeIntervals(IntervalSet intervals, int64_t size) {
+  intervals.Normalize();
+
+  size = std::max<int64_t>(size, 1);
+  if (intervals.NumberOfIntervals() <= size) {
+    return intervals;
+  }
+
+  std::vector<Bits> gap_vector;
+  gap_vector.reserve(intervals.NumberOfIntervals() - 1);
+  for (int64_t i = 0; i < intervals.NumberOfIntervals() - 1; ++i) {
+    const Bits& x = intervals.Intervals()[i].UpperBound();
+    const Bits& y = intervals.Intervals()[i + 1].LowerBound();
+    gap_vector.push_back(bits_ops::Sub(y, x));
+  }
+
+  std::vector<MergeInterval> merges = ReduceByMerging(gap_vector, size - 1);
+
+  IntervalSet result = intervals;
+
+  for (const auto& m : merges) {
+    // The intervals are sorted so the hull of the run is bounded by its ends.
+    result.AddInterval(Interval(intervals.Intervals()[m.start].LowerBound(),
+                                intervals.Intervals()[m.end + 1].UpperBound()));
+  }
+
+  result.Normalize();
+
+  return result;
+}
+
+IntervalSet CombineBounded(const IntervalSet& lhs, const IntervalSet& rhs,
+                           int64_t max_interval_count) {
+  IntervalSet result = IntervalSet::Combine(lhs, rhs);
+  if (result.NumberOfIntervals() > max_interval_count) {
+    return MinimizeIntervals(std::move(result), max_interval_count);
+  }
+  return result;
+}
+
 }  // namespace xls::interval_ops
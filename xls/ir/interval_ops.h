@@ -15,6 +15,7 @@
 #ifndef XLS_IR_INTERVAL_OPS_H_
 #define XLS_IR_INTERVAL_OPS_H_
 
+#include <cstdint>
 #include <optional>
 
 #include "xls/ir/bits.h"
@@ -39,6 +40,21 @@ struct KnownBits {
 KnownBits ExtractKnownBits(const IntervalSet& intervals,
                            std::optional<Node*> source = std::nullopt);
 
+// Reduce the size of the given `IntervalSet` to the given size.
+// This is used to prevent analyses from using too much memory and CPU.
+//
+// This works by choosing pairs of neighboring intervals that have small gaps
+// and merging them by taking their convex hull, until only `size` intervals
+// remain.
+IntervalSet MinimizeIntervals(IntervalSet intervals, int64_t size = 16);
+
+// Returns the union of `lhs` and `rhs`. If the union has more than
+// `max_interval_count` intervals it is over-approximated by
+// `MinimizeIntervals` to `max_interval_count` intervals. Accumulating a union
+// of many sets with this function keeps the cost of each step bounded.
+IntervalSet CombineBounded(const IntervalSet& lhs, const IntervalSet& rhs,
+                           int64_t max_interval_count);
+
 }  // namespace xls::interval_ops
 
 #endif  // XLS_IR_INTERVAL_OPS_H_
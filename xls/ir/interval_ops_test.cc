@@ -14,6 +14,7 @@
 
 #include "xls/ir/interval_ops.h"
 
+#include <cstdint>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -86,5 +87,34 @@ TEST(IntervalOpsTest, MiddleOutTernary) {
   EXPECT_EQ(known, expected);
 }
 
+TEST(IntervalOpsTest, MinimizeIntervalsMergesSmallestGaps) {
+  IntervalSet is = SetOf({Interval::Precise(UBits(0, 8)),
+                          Interval::Precise(UBits(2, 8)),
+                          Interval::Precise(UBits(10, 8)),
+                          Interval::Precise(UBits(100, 8))});
+  EXPECT_EQ(MinimizeIntervals(is, 2),
+            SetOf({Interval(UBits(0, 8), UBits(10, 8)),
+                   Interval::Precise(UBits(100, 8))}));
+  EXPECT_EQ(MinimizeIntervals(is, 4), is);
+}
+
+TEST(IntervalOpsTest, CombineBounded) {
+  std::vector<Interval> evens;
+  std::vector<Interval> odds;
+  for (int64_t i = 0; i < 64; i += 4) {
+    evens.push_back(Interval::Precise(UBits(i, 8)));
+    odds.push_back(Interval::Precise(UBits(i + 2, 8)));
+  }
+  IntervalSet lhs = SetOf(evens);
+  IntervalSet rhs = SetOf(odds);
+  EXPECT_EQ(CombineBounded(lhs, rhs, 64), IntervalSet::Combine(lhs, rhs));
+
+  IntervalSet bounded = CombineBounded(lhs, rhs, 5);
+  EXPECT_LE(bounded.NumberOfIntervals(), 5);
+  for (int64_t i = 0; i < 64; i += 2) {
+    EXPECT_TRUE(bounded.Covers(UBits(i, 8))) << i;
+  }
+}
+
 }  // namespace
 }  // namespace xls::interval_ops
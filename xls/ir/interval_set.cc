@@ -17,10 +17,12 @@
 #include <algorithm>
 #include <cstdint>
 #include <functional>
+#include <iterator>
 #include <list>
 #include <optional>
 #include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/str_format.h"
@@ -73,30 +75,53 @@ void IntervalSet::Normalize() {
     return;
   }
 
-  Bits zero(BitCount());
-  Bits max = Bits::AllOnes(BitCount());
-  std::vector<Interval> expand_improper;
-  for (const Interval& interval : intervals_) {
-    if (interval.IsImproper()) {
-      expand_improper.push_back(Interval(zero, interval.UpperBound()));
-      expand_improper.push_back(Interval(interval.LowerBound(), max));
-    } else {
-      expand_improper.push_back(interval);
+  if (std::any_of(intervals_.begin(), intervals_.end(),
+                  [](const Interval& i) { return i.IsImproper(); })) {
+    Bits zero(BitCount());
+    Bits max = Bits::AllOnes(BitCount());
+    std::vector<Interval> expand_improper;
+    expand_improper.reserve(intervals_.size() + 1);
+    for (Interval& interval : intervals_) {
+      if (interval.IsImproper()) {
+        expand_improper.push_back(Interval(zero, interval.UpperBound()));
+        expand_improper.push_back(Interval(interval.LowerBound(), max));
+      } else {
+        expand_improper.push_back(std::move(interval));
+      }
     }
+    intervals_ = std::move(expand_improper);
   }
 
-  std::sort(expand_improper.begin(), expand_improper.end());
+  // Sets built from already normalized sets (e.g. by `Combine`) are sorted.
+  if (!std::is_sorted(intervals_.begin(), intervals_.end())) {
+    std::sort(intervals_.begin(), intervals_.end());
+  }
 
-  intervals_.clear();
-  for (int32_t i = 0; i < expand_improper.size();) {
-    Interval interval = expand_improper[i++];
-    while ((i < expand_improper.size()) &&
-           (Interval::Overlaps(interval, expand_improper[i]) ||
-            Interval::Abuts(interval, expand_improper[i]))) {
-      interval = Interval::ConvexHull(interval, expand_improper[i]);
-      ++i;
+  // Merge overlapping and abutting intervals in place. Since the intervals are
+  // sorted by lower bound, `next` overlaps `current` iff it starts no later
+  // than `current` ends.
+  auto merges_with = [](const Interval& current, const Interval& next) {
+    return bits_ops::ULessThanOrEqual(next.LowerBound(),
+                                      current.UpperBound()) ||
+           Interval::Abuts(current, next);
+  };
+  int64_t last = 0;
+  for (int64_t i = 1; i < intervals_.size(); ++i) {
+    if (merges_with(intervals_[last], intervals_[i])) {
+      if (bits_ops::UGreaterThan(intervals_[i].UpperBound(),
+                                 intervals_[last].UpperBound())) {
+        intervals_[last] = Interval(intervals_[last].LowerBound(),
+                                    intervals_[i].UpperBound());
+      }
+    } else {
+      ++last;
+      if (last != i) {
+        intervals_[last] = std::move(intervals_[i]);
+      }
     }
-    intervals_.push_back(interval);
+  }
+  if (!intervals_.empty()) {
+    intervals_.resize(last + 1);
   }
 
   is_normalized_ = true;
@@ -181,12 +206,19 @@ IntervalSet IntervalSet::Combine(const IntervalSet& lhs,
                                  const IntervalSet& rhs) {
   XLS_CHECK_EQ(lhs.BitCount(), rhs.BitCount());
   IntervalSet combined(lhs.BitCount());
-  for (const Interval& interval : lhs.intervals_) {
-    combined.AddInterval(interval);
-  }
-  for (const Interval& interval : rhs.intervals_) {
-    combined.AddInterval(interval);
+  combined.intervals_.reserve(lhs.intervals_.size() + rhs.intervals_.size());
+  if (lhs.is_normalized_ && rhs.is_normalized_) {
+    // Merging the sorted inputs lets `Normalize` skip the sort.
+    std::merge(lhs.intervals_.begin(), lhs.intervals_.end(),
+               rhs.intervals_.begin(), rhs.intervals_.end(),
+               std::back_inserter(combined.intervals_));
+  } else {
+    combined.intervals_.insert(combined.intervals_.end(),
+                               lhs.intervals_.begin(), lhs.intervals_.end());
+    combined.intervals_.insert(combined.intervals_.end(),
+                               rhs.intervals_.begin(), rhs.intervals_.end());
   }
+  combined.is_normalized_ = false;
   combined.Normalize();
   return combined;
 }
@@ -41,6 +41,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/visitor.h"
+#include "xls/ir/binary_ir.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/channel.h"
@@ -1329,6 +1330,8 @@ absl::StatusOr<Instantiation*> Parser::ParseInstantiation(Block* block) {
   // A instantiation declaration has the following forms:
   //
   //   instantiation foo(kind=block, block=bar)
+  //   instantiation foo(data_type=bits[32], depth=2, bypass=true,
+  //                     register_push_outputs=false, kind=fifo)
   XLS_ASSIGN_OR_RETURN(
       Token instantiation_name,
       scanner_.PopTokenOrError(LexicalTokenType::kIdent, "instantiation name"));
@@ -1366,11 +1369,50 @@ absl::StatusOr<Instantiation*> Parser::ParseInstantiation(Block* block) {
     return absl::OkStatus();
   };
 
+  std::optional<Type*> data_type;
+  handlers["data_type"] = [&]() -> absl::Status {
+    XLS_ASSIGN_OR_RETURN(data_type, ParseType(block->package()));
+    return absl::OkStatus();
+  };
+  std::optional<int64_t> depth;
+  handlers["depth"] = [&]() -> absl::Status {
+    XLS_ASSIGN_OR_RETURN(Token token,
+                         scanner_.PopTokenOrError(LexicalTokenType::kLiteral));
+    XLS_ASSIGN_OR_RETURN(depth, token.GetValueInt64());
+    return absl::OkStatus();
+  };
+  std::optional<bool> bypass;
+  handlers["bypass"] = [&]() -> absl::Status {
+    XLS_ASSIGN_OR_RETURN(bypass, ParseBool());
+    return absl::OkStatus();
+  };
+  std::optional<bool> register_push_outputs;
+  handlers["register_push_outputs"] = [&]() -> absl::Status {
+    XLS_ASSIGN_OR_RETURN(register_push_outputs, ParseBool());
+    return absl::OkStatus();
+  };
+
   XLS_RETURN_IF_ERROR(ParseKeywordArguments(handlers,
                                             /*mandatory_keywords=*/{"kind"}));
 
   XLS_RETURN_IF_ERROR(scanner_.DropTokenOrError(LexicalTokenType::kParenClose));
 
+  if (kind.value() == InstantiationKind::kFifo) {
+    if (!data_type.has_value() || !depth.has_value() || !bypass.has_value() ||
+        !register_push_outputs.has_value()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "FIFO instantiation requires data_type, depth, bypass and "
+          "register_push_outputs @ %s",
+          instantiation_name.pos().ToHumanString()));
+    }
+    return block->AddFifoInstantiation(
+        instantiation_name.value(),
+        FifoConfig{.depth = depth.value(),
+                   .bypass = bypass.value(),
+                   .register_push_outputs = register_push_outputs.value()},
+        data_type.value());
+  }
+
   if (kind.value() == InstantiationKind::kBlock) {
     if (!instantiated_block.has_value()) {
       return absl::InvalidArgumentError(
@@ -2130,6 +2172,73 @@ absl::StatusOr<DeclAttributes> Parser::MaybeParseAttributes() {
   return p.ParseType(package);
 }
 
+absl::Status Parser::ParseTopLevelDeclaration(
+    Package* package, std::string_view filename,
+    std::optional<Token>* previous_top_token) {
+  XLS_ASSIGN_OR_RETURN(DeclAttributes attributes, MaybeParseAttributes());
+
+  XLS_ASSIGN_OR_RETURN(Token peek, scanner_.PeekToken());
+
+  bool is_top = false;
+  // The fn, proc or block is a top entity.
+  if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "top") {
+    is_top = true;
+    XLS_RETURN_IF_ERROR(scanner_.DropKeywordOrError("top"));
+    XLS_ASSIGN_OR_RETURN(peek, scanner_.PeekToken());
+    if (package->HasTop() && previous_top_token->has_value()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Top declared more than once, previous declaration @ %s",
+          previous_top_token->value().pos().ToHumanString()));
+    }
+    *previous_top_token = peek;
+  }
+  if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "fn") {
+    XLS_ASSIGN_OR_RETURN(Function * fn, ParseFunction(package, attributes),
+                         _ << "@ " << filename);
+    if (is_top) {
+      XLS_RETURN_IF_ERROR(package->SetTop(fn));
+    }
+    return absl::OkStatus();
+  }
+  if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "proc") {
+    XLS_ASSIGN_OR_RETURN(Proc * proc, ParseProc(package, attributes),
+                         _ << "@ " << filename);
+    if (is_top) {
+      XLS_RETURN_IF_ERROR(package->SetTop(proc));
+    }
+    return absl::OkStatus();
+  }
+  if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "block") {
+    XLS_ASSIGN_OR_RETURN(Block * block, ParseBlock(package, attributes),
+                         _ << "@ " << filename);
+    if (is_top) {
+      XLS_RETURN_IF_ERROR(package->SetTop(block));
+    }
+    return absl::OkStatus();
+  }
+  if (is_top) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Expected fn, proc or block definition, got %s @ %s",
+                        peek.value(), peek.pos().ToHumanString()));
+  }
+  if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "chan") {
+    XLS_RETURN_IF_ERROR(ParseChannel(package, attributes).status())
+        << "@ " << filename;
+    return absl::OkStatus();
+  }
+  if (peek.type() == LexicalTokenType::kKeyword &&
+      peek.value() == "file_number") {
+    XLS_RETURN_IF_ERROR(ParseFileNumber(package, attributes))
+        << "@ " << filename;
+    return absl::OkStatus();
+  }
+  return absl::InvalidArgumentError(
+      absl::StrFormat("Expected attribute or declaration "
+                      "(`fn`, `proc`, `block`, `chan`, `file_number`), "
+                      "got %s @ %s",
+                      peek.value(), peek.pos().ToHumanString()));
+}
+
 // Verifies the given package. Replaces InternalError status codes with
 // InvalidArgument status code which is more appropriate for the parser.
 static absl::Status VerifyAndSwapError(Package* package) {
@@ -2200,6 +2309,9 @@ absl::StatusOr<Channel*> Parser::ParseChannel(
 /* static */
 absl::StatusOr<std::unique_ptr<Package>> Parser::ParsePackage(
     std::string_view input_string, std::optional<std::string_view> filename) {
+  if (IsBinaryIr(input_string)) {
+    return PackageFromBinaryIr(input_string);
+  }
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
                        ParsePackageNoVerify(input_string, filename));
   XLS_RETURN_IF_ERROR(VerifyAndSwapError(package.get()));
@@ -2210,12 +2322,123 @@ absl::StatusOr<std::unique_ptr<Package>> Parser::ParsePackage(
 absl::StatusOr<std::unique_ptr<Package>> Parser::ParsePackageWithEntry(
     std::string_view input_string, std::string_view entry,
     std::optional<std::string_view> filename) {
+  if (IsBinaryIr(input_string)) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                         PackageFromBinaryIr(input_string));
+    XLS_RETURN_IF_ERROR(package->SetTopByName(entry));
+    XLS_RETURN_IF_ERROR(package->GetFunction(entry).status());
+    return package;
+  }
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
                        ParsePackageNoVerify(input_string, filename, entry));
   XLS_RETURN_IF_ERROR(VerifyPackage(package.get()));
   return package;
 }
 
+/* static */
+absl::StatusOr<std::unique_ptr<Package>> Parser::ParsePackageSubset(
+    std::string_view input_string, absl::Span<const std::string> roots,
+    std::optional<std::string_view> filename) {
+  // Binary IR is cheap to load in its entirety.
+  if (IsBinaryIr(input_string)) {
+    return PackageFromBinaryIr(input_string);
+  }
+  XLS_ASSIGN_OR_RETURN(std::vector<DeclarationSpan> decls,
+                       ScanDeclarations(input_string));
+  std::string filename_str =
+      (filename.has_value() ? std::string(filename.value()) : "<unknown file>");
+
+  // The first declaration is the package name; a malformed header is diagnosed
+  // by the parser.
+  XLS_ASSIGN_OR_RETURN(
+      Scanner header_scanner,
+      Scanner::Create(decls.empty() ? input_string : decls.front().text));
+  Parser header_parser(std::move(header_scanner));
+  XLS_ASSIGN_OR_RETURN(std::string package_name,
+                       header_parser.ParsePackageName());
+  auto package = std::make_unique<Package>(package_name);
+  std::optional<Token> previous_top_token;
+  while (!header_parser.AtEof()) {
+    XLS_RETURN_IF_ERROR(header_parser.ParseTopLevelDeclaration(
+        package.get(), filename_str, &previous_top_token));
+  }
+
+  // Index the functions, procs and blocks by name. Functions and blocks are
+  // indexed separately as codegen produces blocks named after functions.
+  absl::flat_hash_map<std::string_view, std::vector<int64_t>> functions;
+  absl::flat_hash_map<std::string_view, std::vector<int64_t>> blocks;
+  absl::flat_hash_map<std::string_view, std::vector<int64_t>> entities;
+  std::vector<int64_t> worklist;
+  for (int64_t i = 1; i < decls.size(); ++i) {
+    const DeclarationSpan& decl = decls[i];
+    if (decl.keyword == "fn") {
+      functions[decl.name].push_back(i);
+    } else if (decl.keyword == "block") {
+      blocks[decl.name].push_back(i);
+    } else if (decl.keyword != "proc") {
+      continue;
+    }
+    entities[decl.name].push_back(i);
+    if (roots.empty() && decl.is_top) {
+      worklist.push_back(i);
+    }
+  }
+  for (const std::string& root : roots) {
+    auto it = entities.find(root);
+    if (it == entities.end()) {
+      return absl::NotFoundError(absl::StrFormat(
+          "No function, proc or block named `%s` in %s", root, filename_str));
+    }
+    worklist.insert(worklist.end(), it->second.begin(), it->second.end());
+  }
+  if (worklist.empty()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "No entities to parse; %s has no top entity", filename_str));
+  }
+
+  // Collect the transitive closure of referenced functions and blocks.
+  // References to undefined entities are reported by the parser.
+  absl::flat_hash_set<int64_t> needed;
+  while (!worklist.empty()) {
+    int64_t index = worklist.back();
+    worklist.pop_back();
+    if (!needed.insert(index).second) {
+      continue;
+    }
+    for (std::string_view name : decls[index].function_references) {
+      auto it = functions.find(name);
+      if (it != functions.end()) {
+        worklist.insert(worklist.end(), it->second.begin(), it->second.end());
+      }
+    }
+    for (std::string_view name : decls[index].block_references) {
+      auto it = blocks.find(name);
+      if (it != blocks.end()) {
+        worklist.insert(worklist.end(), it->second.begin(), it->second.end());
+      }
+    }
+  }
+
+  // Parse the needed declarations in their original order, which defines
+  // callees before their callers. Channels and file numbers are cheap and
+  // are always parsed.
+  for (int64_t i = 1; i < decls.size(); ++i) {
+    const DeclarationSpan& decl = decls[i];
+    if (decl.keyword != "chan" && decl.keyword != "file_number" &&
+        !needed.contains(i)) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(Scanner scanner, Scanner::Create(decl.text, decl.pos));
+    Parser parser(std::move(scanner));
+    while (!parser.AtEof()) {
+      XLS_RETURN_IF_ERROR(parser.ParseTopLevelDeclaration(
+          package.get(), filename_str, &previous_top_token));
+    }
+  }
+  XLS_RETURN_IF_ERROR(VerifyAndSwapError(package.get()));
+  return package;
+}
+
 /* static */
 absl::StatusOr<std::unique_ptr<Package>> Parser::ParsePackageNoVerify(
     std::string_view input_string, std::optional<std::string_view> filename,
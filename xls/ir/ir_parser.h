@@ -33,6 +33,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/block.h"
 #include "xls/ir/channel.h"
@@ -55,7 +56,8 @@ using DeclAttributes = absl::flat_hash_map<std::string, Token>;
 
 class Parser {
  public:
-  // Parses the given input string as a package.
+  // Parses the given input string as a package. Binary IR (see binary_ir.h) is
+  // also accepted by this and the other ParsePackage* methods.
   static absl::StatusOr<std::unique_ptr<Package>> ParsePackage(
       std::string_view input_string,
       std::optional<std::string_view> filename = std::nullopt);
@@ -66,6 +68,18 @@ class Parser {
       std::string_view input_string, std::string_view entry,
       std::optional<std::string_view> filename = std::nullopt);
 
+  // Parses only the parts of the given package text needed to define the
+  // functions, procs and blocks named in `roots` and the functions and blocks
+  // they transitively reference. If `roots` is empty the `top` entity is used.
+  // Channel and file number declarations are always parsed. The text is first
+  // split into declarations without tokenizing it (see ScanDeclarations), so
+  // this is much cheaper than ParsePackage when only a small part of a large
+  // package is needed. Errors in declarations which are not needed are not
+  // reported. The package has a top only if the `top` entity was parsed.
+  static absl::StatusOr<std::unique_ptr<Package>> ParsePackageSubset(
+      std::string_view input_string, absl::Span<const std::string> roots,
+      std::optional<std::string_view> filename = std::nullopt);
+
   // Parse the input_string as a function into the given package.
   // If verify_function_only is true, then only this new function is verified,
   // otherwise the whole package is verified by default.
@@ -308,6 +322,14 @@ class Parser {
   // #[<ident>(<literal>)]
   absl::StatusOr<DeclAttributes> MaybeParseAttributes();
 
+  // Parses a single top-level declaration (function, proc, block, channel or
+  // file number) and any preceding attributes into `package`.
+  // `previous_top_token` holds the position of the package's `top`
+  // declaration, if one has been parsed.
+  absl::Status ParseTopLevelDeclaration(
+      Package* package, std::string_view filename,
+      std::optional<Token>* previous_top_token);
+
   bool AtEof() const { return scanner_.AtEof(); }
 
   Scanner scanner_;
@@ -328,73 +350,8 @@ absl::StatusOr<std::unique_ptr<PackageT>> Parser::ParseDerivedPackageNoVerify(
   std::string filename_str =
       (filename.has_value() ? std::string(filename.value()) : "<unknown file>");
   while (!parser.AtEof()) {
-    XLS_ASSIGN_OR_RETURN(DeclAttributes attributes,
-                         parser.MaybeParseAttributes());
-
-    XLS_ASSIGN_OR_RETURN(Token peek, parser.scanner_.PeekToken());
-
-    bool is_top = false;
-    // The fn, proc or block is a top entity.
-    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "top") {
-      is_top = true;
-      XLS_RETURN_IF_ERROR(parser.scanner_.DropKeywordOrError("top"));
-      XLS_ASSIGN_OR_RETURN(peek, parser.scanner_.PeekToken());
-      if (package.get()->HasTop() && previous_top_token.has_value()) {
-        return absl::InvalidArgumentError(absl::StrFormat(
-            "Top declared more than once, previous declaration @ %s",
-            previous_top_token.value().pos().ToHumanString()));
-      }
-      previous_top_token = peek;
-    }
-    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "fn") {
-      XLS_ASSIGN_OR_RETURN(Function * fn,
-                           parser.ParseFunction(package.get(), attributes),
-                           _ << "@ " << filename_str);
-      if (is_top) {
-        XLS_RETURN_IF_ERROR(package->SetTop(fn));
-      }
-      continue;
-    }
-    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "proc") {
-      XLS_ASSIGN_OR_RETURN(Proc * proc,
-                           parser.ParseProc(package.get(), attributes),
-                           _ << "@ " << filename_str);
-      if (is_top) {
-        XLS_RETURN_IF_ERROR(package->SetTop(proc));
-      }
-      continue;
-    }
-    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "block") {
-      XLS_ASSIGN_OR_RETURN(Block * block,
-                           parser.ParseBlock(package.get(), attributes),
-                           _ << "@ " << filename_str);
-      if (is_top) {
-        XLS_RETURN_IF_ERROR(package->SetTop(block));
-      }
-      continue;
-    }
-    if (is_top) {
-      return absl::InvalidArgumentError(
-          absl::StrFormat("Expected fn, proc or block definition, got %s @ %s",
-                          peek.value(), peek.pos().ToHumanString()));
-    }
-    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "chan") {
-      XLS_RETURN_IF_ERROR(
-          parser.ParseChannel(package.get(), attributes).status())
-          << "@ " << filename_str;
-      continue;
-    }
-    if (peek.type() == LexicalTokenType::kKeyword &&
-        peek.value() == "file_number") {
-      XLS_RETURN_IF_ERROR(parser.ParseFileNumber(package.get(), attributes))
-          << "@ " << filename_str;
-      continue;
-    }
-    return absl::InvalidArgumentError(
-        absl::StrFormat("Expected attribute or declaration "
-                        "(`fn`, `proc`, `block`, `chan`, `file_number`), "
-                        "got %s @ %s",
-                        peek.value(), peek.pos().ToHumanString()));
+    XLS_RETURN_IF_ERROR(parser.ParseTopLevelDeclaration(
+        package.get(), filename_str, &previous_top_token));
   }
 
   // Verify the given entry function exists in the package.
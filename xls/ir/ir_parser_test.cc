@@ -1351,6 +1351,30 @@ block my_block(x: bits[8], y: bits[32]) {
   ParsePackageAndCheckDump(input);
 }
 
+TEST(IrParserTest, ParseBlockWithFifoInstantiation) {
+  const std::string input = R"(package test
+
+block my_block(clk: clock, rst: bits[1], x: bits[32], x_vld: bits[1], y_rdy: bits[1], y: bits[32], y_vld: bits[1], x_rdy: bits[1]) {
+  instantiation fifo(data_type=bits[32], depth=2, bypass=true, register_push_outputs=false, kind=fifo)
+  rst: bits[1] = input_port(name=rst, id=1)
+  x: bits[32] = input_port(name=x, id=2)
+  x_vld: bits[1] = input_port(name=x_vld, id=3)
+  y_rdy: bits[1] = input_port(name=y_rdy, id=4)
+  fifo_rst: () = instantiation_input(rst, instantiation=fifo, port_name=rst, id=5)
+  fifo_push_data: () = instantiation_input(x, instantiation=fifo, port_name=push_data, id=6)
+  fifo_push_valid: () = instantiation_input(x_vld, instantiation=fifo, port_name=push_valid, id=7)
+  fifo_pop_ready: () = instantiation_input(y_rdy, instantiation=fifo, port_name=pop_ready, id=8)
+  fifo_pop_data: bits[32] = instantiation_output(instantiation=fifo, port_name=pop_data, id=9)
+  fifo_pop_valid: bits[1] = instantiation_output(instantiation=fifo, port_name=pop_valid, id=10)
+  fifo_push_ready: bits[1] = instantiation_output(instantiation=fifo, port_name=push_ready, id=11)
+  y: () = output_port(fifo_pop_data, name=y, id=12)
+  y_vld: () = output_port(fifo_pop_valid, name=y_vld, id=13)
+  x_rdy: () = output_port(fifo_push_ready, name=x_rdy, id=14)
+}
+)";
+  ParsePackageAndCheckDump(input);
+}
+
 TEST(IrParserTest, ParseInstantiationOfDegenerateBlock) {
   const std::string input = R"(package test
 
@@ -3201,4 +3225,85 @@ file_number 0 "fake_file.x"
               "Attributes are not supported on file number declarations.")));
 }
 
+TEST(IrParserTest, ParsePackageSubset) {
+  const std::string input = R"(package test
+
+chan ch(bits[32], id=0, kind=streaming, ops=send_receive, flow_control=none, strictness=proven_mutually_exclusive, metadata="""""")
+
+fn callee(x: bits[32]) -> bits[32] {
+  ret identity.1: bits[32] = identity(x, id=1)
+}
+
+fn unrelated(x: bits[32]) -> bits[32] {
+  ret neg.3: bits[32] = neg(x, id=3)
+  this is not valid IR
+}
+
+fn caller(x: bits[32]) -> bits[32] {
+  ret invoke.5: bits[32] = invoke(x, to_apply=callee, id=5)
+}
+
+top fn main(x: bits[32]) -> bits[32] {
+  ret identity.6: bits[32] = identity(x, id=6)
+}
+
+block sub_block(in: bits[38], out: bits[32]) {
+  in: bits[38] = input_port(name=in, id=7)
+  zero: bits[32] = literal(value=0, id=8)
+  out: () = output_port(zero, name=out, id=9)
+}
+
+block caller(x: bits[8], y: bits[32]) {
+  instantiation foo(block=sub_block, kind=block)
+  x: bits[8] = input_port(name=x, id=10)
+  foo_in: () = instantiation_input(x, instantiation=foo, port_name=in, id=11)
+  foo_out: bits[32] = instantiation_output(instantiation=foo, port_name=out, id=12)
+  y: () = output_port(foo_out, name=y, id=13)
+}
+)";
+  // The malformed function is never parsed.
+  EXPECT_THAT(Parser::ParsePackage(input).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  // Both the function and the block named `caller` are parsed along with the
+  // function and block they reference.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackageSubset(input, {"caller"}));
+  EXPECT_EQ(package->name(), "test");
+  EXPECT_EQ(package->functions().size(), 2);
+  XLS_EXPECT_OK(package->GetFunction("callee").status());
+  XLS_EXPECT_OK(package->GetFunction("caller").status());
+  EXPECT_EQ(package->blocks().size(), 2);
+  XLS_EXPECT_OK(package->GetBlock("sub_block").status());
+  EXPECT_EQ(package->channels().size(), 1);
+  EXPECT_FALSE(package->HasTop());
+
+  // Without roots the top entity is parsed.
+  XLS_ASSERT_OK_AND_ASSIGN(package, Parser::ParsePackageSubset(input, {}));
+  EXPECT_EQ(package->functions().size(), 1);
+  XLS_ASSERT_OK_AND_ASSIGN(FunctionBase * top, package->GetTopAsFunction());
+  EXPECT_EQ(top->name(), "main");
+
+  EXPECT_THAT(Parser::ParsePackageSubset(input, {"unrelated"}).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(Parser::ParsePackageSubset(input, {"missing"}).status(),
+              StatusIs(absl::StatusCode::kNotFound,
+                       HasSubstr("named `missing`")));
+}
+
+TEST(IrParserTest, ParsePackageSubsetReportsPositionsInFile) {
+  const std::string input = R"(package test
+
+fn f(x: bits[32]) -> bits[32] {
+  ret identity.1: bits[32] = identity(x, id=1)
+}
+
+fn g(x: bits[32]) -> bits[32] {
+  ret neg.2: bits[32] neg(x, id=2)
+}
+)";
+  EXPECT_THAT(Parser::ParsePackageSubset(input, {"g"}).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument, HasSubstr("@ 8:")));
+}
+
 }  // namespace xls
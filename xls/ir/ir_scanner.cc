@@ -14,6 +14,7 @@
 
 #include "xls/ir/ir_scanner.h"
 
+#include <cstdint>
 #include <functional>
 #include <optional>
 #include <string>
@@ -21,6 +22,8 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_format.h"
@@ -128,11 +131,18 @@ class Tokenizer {
  public:
   // Tokenizes the given string and returns the vector of Tokens.
   static absl::StatusOr<std::vector<Token>> TokenizeString(
-      std::string_view str) {
-    Tokenizer tokenizer(str);
+      std::string_view str, TokenPos start) {
+    Tokenizer tokenizer(str, start);
     return tokenizer.Tokenize();
   }
 
+  // Splits the given string into top-level declarations.
+  static absl::StatusOr<std::vector<DeclarationSpan>> ScanDeclarations(
+      std::string_view str) {
+    Tokenizer tokenizer(str, TokenPos{0, 0});
+    return tokenizer.ScanTopLevel();
+  }
+
  private:
   // Drops all whitespace starting at current index. Returns true if any
   // whitespace was dropped.
@@ -355,6 +365,110 @@ class Tokenizer {
     return tokens;
   }
 
+  // Scans the internal string for top-level declarations. Only identifiers,
+  // brackets, comments and quoted strings are recognized.
+  absl::StatusOr<std::vector<DeclarationSpan>> ScanTopLevel() {
+    static const auto* kDeclarationKeywords =
+        new absl::flat_hash_set<std::string_view>{
+            "package", "file_number", "chan", "fn", "proc", "block"};
+    std::vector<DeclarationSpan> decls;
+    std::vector<int64_t> starts;
+    // Start of the attributes or `top` keyword preceding the next declaration.
+    std::optional<std::pair<int64_t, TokenPos>> pending_start;
+    bool pending_top = false;
+    // Whether the next identifier is the name of the last declaration.
+    bool expect_name = false;
+    // Tracks `<key>=<name>` sequences which reference another entity.
+    std::string_view reference_key;
+    bool saw_reference_equals = false;
+    int64_t depth = 0;
+    while (!EndOfString()) {
+      if (DropWhiteSpace() || DropEndOfLineComment()) {
+        continue;
+      }
+      const int64_t start_index = index();
+      const TokenPos start_pos{lineno(), colno()};
+      if (isalpha(current()) != 0 || current() == '_' ||
+          isdigit(current()) != 0) {
+        std::string_view word = CaptureWhile([](char c) {
+          return isalpha(c) != 0 || c == '_' || c == '.' || isdigit(c) != 0;
+        });
+        if (depth > 0) {
+          if (saw_reference_equals && !decls.empty()) {
+            if (reference_key == "block") {
+              decls.back().block_references.push_back(word);
+            } else {
+              decls.back().function_references.push_back(word);
+            }
+          }
+          saw_reference_equals = false;
+          reference_key = (word == "to_apply" || word == "body" ||
+                           word == "block")
+                              ? word
+                              : std::string_view();
+          continue;
+        }
+        if (word == "top") {
+          pending_start = pending_start.value_or(
+              std::make_pair(start_index, start_pos));
+          pending_top = true;
+        } else if (kDeclarationKeywords->contains(word)) {
+          auto [decl_index, decl_pos] = pending_start.value_or(
+              std::make_pair(start_index, start_pos));
+          if (decls.empty()) {
+            decl_index = 0;
+            decl_pos = TokenPos{0, 0};
+          }
+          decls.push_back(DeclarationSpan{.keyword = word,
+                                          .pos = decl_pos,
+                                          .is_top = pending_top});
+          starts.push_back(decl_index);
+          expect_name = word != "file_number";
+          pending_start.reset();
+          pending_top = false;
+        } else if (expect_name) {
+          decls.back().name = word;
+          expect_name = false;
+        }
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(std::optional<std::string_view> content,
+                           MatchQuotedString("\"\"\"",
+                                             /*allow_multiline=*/true));
+      if (!content.has_value()) {
+        XLS_ASSIGN_OR_RETURN(
+            content, MatchQuotedString("\"", /*allow_multiline=*/false));
+      }
+      if (content.has_value()) {
+        reference_key = std::string_view();
+        saw_reference_equals = false;
+        continue;
+      }
+      char c = current();
+      saw_reference_equals = c == '=' && !reference_key.empty();
+      reference_key = std::string_view();
+      if (c == '(' || c == '[' || c == '{') {
+        ++depth;
+      } else if (c == ')' || c == ']' || c == '}') {
+        if (depth == 0) {
+          return absl::InvalidArgumentError(
+              absl::StrFormat("Unmatched '%c' in IR text @ %s", c,
+                              start_pos.ToHumanString()));
+        }
+        --depth;
+      } else if (c == '#' && depth == 0) {
+        pending_start =
+            pending_start.value_or(std::make_pair(start_index, start_pos));
+      }
+      Advance();
+    }
+    for (int64_t i = 0; i < decls.size(); ++i) {
+      int64_t end = i + 1 < decls.size() ? starts[i + 1] : str_.size();
+      decls[i].text = str_.substr(starts[i], end - starts[i]);
+    }
+    return decls;
+  }
+
   // Returns the character at the current index.
   char current() const { return str_.at(index_); }
 
@@ -375,7 +489,8 @@ class Tokenizer {
   int64_t colno() const { return colno_; }
 
  private:
-  explicit Tokenizer(std::string_view str) : str_(str) {}
+  Tokenizer(std::string_view str, TokenPos start)
+      : str_(str), lineno_(start.lineno), colno_(start.colno) {}
 
   // The string being tokenized.
   std::string_view str_;
@@ -390,12 +505,19 @@ class Tokenizer {
 
 }  // namespace
 
-absl::StatusOr<std::vector<Token>> TokenizeString(std::string_view str) {
-  return Tokenizer::TokenizeString(str);
+absl::StatusOr<std::vector<Token>> TokenizeString(std::string_view str,
+                                                  TokenPos start) {
+  return Tokenizer::TokenizeString(str, start);
+}
+
+absl::StatusOr<std::vector<DeclarationSpan>> ScanDeclarations(
+    std::string_view text) {
+  return Tokenizer::ScanDeclarations(text);
 }
 
-absl::StatusOr<Scanner> Scanner::Create(std::string_view text) {
-  XLS_ASSIGN_OR_RETURN(auto tokens, TokenizeString(text));
+absl::StatusOr<Scanner> Scanner::Create(std::string_view text,
+                                        TokenPos start) {
+  XLS_ASSIGN_OR_RETURN(auto tokens, TokenizeString(text, start));
   return Scanner(std::move(tokens));
 }
 
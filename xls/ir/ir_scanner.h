@@ -129,14 +129,46 @@ inline std::ostream& operator<<(std::ostream& os, const Token& token) {
 }
 
 // Tokenizes the given string and returns the tokens. It maintains precise
-// source location information.  Right now this is a eager implementation - it
-// tokenizes the whole input. This can be easily changed later to a more demand
-// driven tokenization.
-absl::StatusOr<std::vector<Token>> TokenizeString(std::string_view str);
+// source location information. Token positions are offset by `start`, which
+// allows a slice of a larger text to be tokenized with positions relative to
+// the whole text. Right now this is a eager implementation - it tokenizes the
+// whole input. This can be easily changed later to a more demand driven
+// tokenization.
+absl::StatusOr<std::vector<Token>> TokenizeString(
+    std::string_view str, TokenPos start = TokenPos{0, 0});
+
+// A top-level declaration (package, file number, channel, function, proc or
+// block) in IR text.
+struct DeclarationSpan {
+  // The keyword introducing the declaration, e.g. "fn" or "chan".
+  std::string_view keyword;
+  // The name of the declared entity. Empty for file_number declarations.
+  std::string_view name;
+  // The text of the declaration including any preceding attributes.
+  std::string_view text;
+  // The position of the start of `text`.
+  TokenPos pos;
+  // Whether the declaration is marked `top`.
+  bool is_top = false;
+  // Names of the functions (`to_apply=` and `body=` arguments) and blocks
+  // (`block=` arguments) referenced within the declaration.
+  std::vector<std::string_view> function_references;
+  std::vector<std::string_view> block_references;
+};
+
+// Splits `text` into its top-level declarations. This is a lightweight pass
+// which matches brackets, comments and quoted strings but does not tokenize
+// the text, so the declarations can be located and selectively parsed in
+// large IR files. The spans are returned in order and cover `text`; any text
+// before the first declaration is included in the first span. Syntax errors
+// within a declaration are only reported when the declaration is parsed.
+absl::StatusOr<std::vector<DeclarationSpan>> ScanDeclarations(
+    std::string_view text);
 
 class Scanner {
  public:
-  static absl::StatusOr<Scanner> Create(std::string_view text);
+  static absl::StatusOr<Scanner> Create(std::string_view text,
+                                        TokenPos start = TokenPos{0, 0});
 
   // Peeks at the next token in the token stream, or returns an error if we're
   // at EOF and no more tokens are available.
@@ -16,11 +16,13 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/memory/memory.h"
+#include "absl/status/status.h"
 #include "xls/common/status/matchers.h"
 
 namespace xls {
@@ -178,5 +180,79 @@ TEST(IrScannerTest, UnterminatedTripleQuotedStrings) {
                HasSubstr("Unterminated quoted string starting at 1:1")));
 }
 
+TEST(IrScannerTest, TokenizeWithStartPosition) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Token> tokens,
+                           TokenizeString("foo\n  bar", TokenPos{10, 4}));
+  ASSERT_EQ(tokens.size(), 2);
+  EXPECT_EQ(tokens[0].pos().lineno, 10);
+  EXPECT_EQ(tokens[0].pos().colno, 4);
+  EXPECT_EQ(tokens[1].pos().lineno, 11);
+  EXPECT_EQ(tokens[1].pos().colno, 2);
+}
+
+TEST(IrScannerTest, ScanDeclarations) {
+  std::string_view text = R"(// leading comment with fn
+package test
+
+file_number 0 "a/b{.x"
+chan ch(bits[32], id=0, kind=streaming, metadata="""fn { block""")
+
+fn callee(x: bits[32]) -> bits[32] {
+  ret x: bits[32] = param(name=x)
+}
+
+#[initiation_interval(2)]
+top fn caller(x: bits[32]) -> (bits[32], bits[32]) {
+  invoke.1: bits[32] = invoke(x, to_apply=callee, id=1)
+  ret tuple.2: (bits[32], bits[32]) = tuple(invoke.1, invoke.1, id=2)
+}
+
+proc p(tok: token, st: bits[32], init={42}) {
+  next (tok, st)
+}
+
+block b() {
+  instantiation foo(block=sub, kind=block)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<DeclarationSpan> decls,
+                           ScanDeclarations(text));
+  std::vector<std::string_view> keywords;
+  std::vector<std::string_view> names;
+  for (const DeclarationSpan& decl : decls) {
+    keywords.push_back(decl.keyword);
+    names.push_back(decl.name);
+  }
+  EXPECT_THAT(keywords, ElementsAre("package", "file_number", "chan", "fn",
+                                    "fn", "proc", "block"));
+  EXPECT_THAT(names, ElementsAre("test", "", "ch", "callee", "caller", "p",
+                                 "b"));
+
+  // The spans cover the text and the first includes the leading comment.
+  std::string joined;
+  for (const DeclarationSpan& decl : decls) {
+    joined.append(decl.text);
+  }
+  EXPECT_EQ(joined, text);
+  EXPECT_EQ(decls[0].pos.lineno, 0);
+
+  // Attributes and `top` belong to the following declaration.
+  EXPECT_TRUE(decls[4].text.starts_with("#[initiation_interval(2)]"));
+  EXPECT_EQ(decls[4].pos.lineno, 10);
+  EXPECT_TRUE(decls[4].is_top);
+  EXPECT_FALSE(decls[3].is_top);
+
+  EXPECT_THAT(decls[4].function_references, ElementsAre("callee"));
+  EXPECT_TRUE(decls[4].block_references.empty());
+  EXPECT_THAT(decls[6].block_references, ElementsAre("sub"));
+  EXPECT_TRUE(decls[6].function_references.empty());
+}
+
+TEST(IrScannerTest, ScanDeclarationsUnmatchedBracket) {
+  EXPECT_THAT(ScanDeclarations("package p\nfn f() -> bits[1] { } }"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Unmatched '}' in IR text @ 2:23")));
+}
+
 }  // namespace
 }  // namespace xls
@@ -15,14 +15,18 @@
 #include "xls/ir/node.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <new>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/base/attributes.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/escaping.h"
@@ -49,14 +53,59 @@
 #include "xls/ir/verifier.h"
 
 namespace xls {
+namespace {
+
+// Precedes every node allocation. Its size keeps the node itself aligned to
+// alignof(std::max_align_t).
+struct alignas(std::max_align_t) NodeAllocationHeader {
+  // The arena the allocation came from, or nullptr for the heap.
+  NodeArena* arena;
+};
+
+}  // namespace
+
+void* Node::operator new(size_t size) {
+  auto* header = static_cast<NodeAllocationHeader*>(
+      ::operator new(sizeof(NodeAllocationHeader) + size));
+  header->arena = nullptr;
+  return header + 1;
+}
+
+void* Node::operator new(size_t size, NodeArena& arena) {
+  auto* header = static_cast<NodeAllocationHeader*>(
+      arena.Allocate(sizeof(NodeAllocationHeader) + size));
+  header->arena = &arena;
+  return header + 1;
+}
+
+void Node::operator delete(void* ptr, size_t size) {
+  NodeAllocationHeader* header = static_cast<NodeAllocationHeader*>(ptr) - 1;
+  if (header->arena == nullptr) {
+    ::operator delete(header);
+  } else {
+    header->arena->Free(header, sizeof(NodeAllocationHeader) + size);
+  }
+}
+namespace {
+
+// Source of Node change stamps. Atomic because passes may run concurrently on
+// different FunctionBases.
+ABSL_CONST_INIT std::atomic<int64_t> last_change_stamp = 0;
+
+int64_t NextChangeStamp() {
+  return last_change_stamp.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+}  // namespace
 
 Node::Node(Op op, Type* type, const SourceInfo& loc, std::string_view name,
            FunctionBase* function_base)
     : function_base_(function_base),
       id_(function_base_->package()->GetNextNodeId()),
+      change_stamp_(NextChangeStamp()),
       op_(op),
       type_(type),
-      loc_(loc),
+      loc_(function_base_->package()->InternSourceInfo(loc)),
       name_(name.empty() ? "" : function_base_->UniquifyNodeName(name)) {}
 
 void Node::AddOperand(Node* operand) {
@@ -87,10 +136,26 @@ absl::Status Node::AddNodeToFunctionAndReplace(
   return ReplaceUsesWith(replacement_ptr);
 }
 
-void Node::AddUser(Node* user) { users_.insert(user); }
+void Node::AddUser(Node* user) {
+  if (users_.insert(user).second) {
+    MarkChanged();
+    user->MarkChanged();
+  }
+}
 
 void Node::RemoveUser(Node* user) {
   XLS_CHECK_EQ(users_.erase(user), 1) << GetName();
+  MarkChanged();
+  user->MarkChanged();
+}
+
+void Node::MarkChanged() {
+  change_stamp_ = NextChangeStamp();
+  function_base_->InvalidateNodeOrder();
+}
+
+int64_t Node::CurrentChangeStamp() {
+  return last_change_stamp.load(std::memory_order_relaxed);
 }
 
 absl::Status Node::VisitSingleNode(DfsVisitor* visitor) {
@@ -420,7 +485,9 @@ void Node::ClearName() {
   name_ = "";
 }
 
-void Node::SetLoc(const SourceInfo& loc) { loc_ = loc; }
+void Node::SetLoc(const SourceInfo& loc) {
+  loc_ = package()->InternSourceInfo(loc);
+}
 
 std::string Node::ToStringInternal(bool include_operand_types) const {
   std::string ret = absl::StrCat(GetName(), ": ", GetType()->ToString(), " = ",
@@ -675,9 +742,9 @@ int64_t Node::OperandInstanceCount(const Node* target) const {
 }
 
 void Node::SetId(int64_t id) {
-  // The data structure (btree) containing the users of each node is sorted by
-  // node id. To avoid violating invariants of the data structure, remove this
-  // node from all users lists, change id, then read to users list.
+  // The data structure (a sorted vector) containing the users of each node is
+  // sorted by node id. To avoid violating invariants of the data structure,
+  // remove this node from all users lists, change id, then read to users list.
   for (Node* operand : operands()) {
     operand->users_.erase(this);
   }
@@ -729,6 +796,8 @@ absl::Status Node::ReplaceOperandNumber(int64_t operand_no, Node* new_operand,
   // node in another operand slot, it is safe to call.
   new_operand->AddUser(this);
   operands_[operand_no] = new_operand;
+  // The operand sequence changed even if the user sets did not.
+  MarkChanged();
 
   for (Node* operand : operands()) {
     if (operand == old_operand) {
@@ -745,9 +814,34 @@ absl::Status Node::ReplaceUsesWith(Node* replacement) {
   XLS_RET_CHECK(GetType() == replacement->GetType())
       << "type was: " << GetType()->ToString()
       << " replacement: " << replacement->GetType()->ToString();
-  std::vector<Node*> orig_users(users().begin(), users().end());
-  for (Node* user : orig_users) {
-    XLS_RET_CHECK(user->ReplaceOperand(this, replacement));
+  // Rewrite the operands of the users directly and then move the users over in
+  // bulk. Calling ReplaceOperand for each user would erase the users from the
+  // front of `users_` one at a time, which is quadratic in the fan-out.
+  // `replacement` itself may be a user of this node, in which case it keeps
+  // using this node (replacing its use would create a cycle).
+  std::vector<Node*> moved_users;
+  moved_users.reserve(users_.size());
+  for (Node* user : users_) {
+    if (user == replacement) {
+      continue;
+    }
+    for (Node*& operand : user->operands_) {
+      if (operand == this) {
+        operand = replacement;
+      }
+    }
+    user->MarkChanged();
+    moved_users.push_back(user);
+  }
+  if (!moved_users.empty()) {
+    bool replacement_uses_this = users_.contains(replacement);
+    users_.clear();
+    if (replacement_uses_this) {
+      users_.insert(replacement);
+    }
+    replacement->users_.insert(moved_users.begin(), moved_users.end());
+    MarkChanged();
+    replacement->MarkChanged();
   }
 
   // Handle replacement of nodes which have special positions within the
@@ -15,6 +15,7 @@
 #ifndef XLS_IR_NODE_H_
 #define XLS_IR_NODE_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -24,13 +25,15 @@
 #include <utility>
 #include <vector>
 
-#include "absl/container/btree_set.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/common/casts.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/data_structures/inlined_sorted_set.h"
+#include "xls/ir/node_arena.h"
 #include "xls/ir/op.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
@@ -52,6 +55,18 @@ class Node {
  public:
   virtual ~Node() = default;
 
+  // Nodes are allocated either from the heap (e.g., std::make_unique) or, by
+  // FunctionBase::MakeNode, from the NodeArena of their function base, as in
+  // `new (arena) Add(...)`. Either way a node is owned and deleted through a
+  // std::unique_ptr<Node>: each allocation is preceded by a header recording
+  // the arena it came from, if any, so deletion returns the storage to it.
+  static void* operator new(size_t size);
+  static void* operator new(size_t size, NodeArena& arena);
+  static void operator delete(void* ptr, size_t size);
+  // Only called if a constructor throws; the storage is reclaimed with the
+  // arena.
+  static void operator delete(void* ptr, NodeArena& arena) {}
+
   // Accepts the visitor, instructing it to visit this node.
   //
   // The visitor is instructed to visit this node with:
@@ -76,7 +91,7 @@ class Node {
   Op op() const { return op_; }
   FunctionBase* function_base() const { return function_base_; }
   Package* package() const;
-  const SourceInfo& loc() const { return loc_; }
+  const SourceInfo& loc() const { return *loc_; }
 
   // Returns the sequence of operands used by this node.
   //
@@ -124,6 +139,7 @@ class Node {
   void SwapOperands(int64_t a, int64_t b) {
     // Operand/user chains already set up properly.
     std::swap(operands_[a], operands_[b]);
+    MarkChanged();
   }
 
   // Returns true if analysis indicates that this node always produces the
@@ -200,8 +216,12 @@ class Node {
     }
   };
 
+  // Set of unique nodes sorted by id. Nodes typically have very few users, so
+  // the set is a sorted vector with inline storage for two users.
+  using UserSet = InlinedSortedSet<Node*, NodeIdLessThan, 2>;
+
   // Returns the unique set of users of this node sorted by id.
-  const absl::btree_set<Node*, NodeIdLessThan>& users() const { return users_; }
+  const UserSet& users() const { return users_; }
 
   // Helper for querying whether "target" is a user of this node.
   bool HasUser(const Node* target) const;
@@ -228,6 +248,26 @@ class Node {
 
   int64_t id() const { return id_; }
 
+  // Returns the change stamp of the node. Change stamps are drawn from a
+  // process-wide monotonically increasing counter and the stamp of a node is
+  // refreshed when the node is created, when its operands or users change, and
+  // when it gains or loses an implicit use (e.g., becomes the function return
+  // value). A node whose stamp is no greater than a previously observed
+  // CurrentChangeStamp() value has not been modified since that observation.
+  int64_t change_stamp() const { return change_stamp_; }
+
+  // Returns the index of the node within its function base. Indices are
+  // assigned consecutively as nodes are added to the function base and are
+  // never reused, so they are dense and stable and may be used to index side
+  // tables such as NodeMap. See FunctionBase::node_index_limit.
+  int64_t node_index() const { return node_index_; }
+
+  // Refreshes the change stamp of the node.
+  void MarkChanged();
+
+  // Returns the most recently issued change stamp.
+  static int64_t CurrentChangeStamp();
+
   // Sets the id of the node. Mutates the user sets of the operands of the node
   // because user sets are sorted by id.  Note: this should only be used by the
   // parser and ideally not even there.
@@ -287,15 +327,20 @@ class Node {
 
   FunctionBase* function_base_;
   int64_t id_;
+  int64_t change_stamp_;
+  int64_t node_index_ = -1;
   Op op_;
   Type* type_;
-  SourceInfo loc_;
+  // The location is interned in the package (see Package::InternSourceInfo) so
+  // that the many nodes sharing a location do not each own a copy.
+  const SourceInfo* loc_;
   std::string name_;
 
-  std::vector<Node*> operands_;
+  // Most nodes have at most two operands, which are stored inline.
+  absl::InlinedVector<Node*, 2> operands_;
 
   // Set of users sorted by node_id for stability.
-  absl::btree_set<Node*, NodeIdLessThan> users_;
+  UserSet users_;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const Node& node) {
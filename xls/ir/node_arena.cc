@@ -0,0 +1,80 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/node_arena.h"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+#include "absl/base/config.h"
+
+namespace xls {
+namespace {
+
+constexpr size_t RoundUpTo(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+char* NodeArena::NewSlab(size_t size) {
+  // Default-initialized so the slab is not zeroed.
+  slabs_.push_back(std::unique_ptr<std::max_align_t[]>(
+      new std::max_align_t[size / kAlignment]));
+  slab_bytes_ += size;
+  return reinterpret_cast<char*>(slabs_.back().get());
+}
+
+void* NodeArena::Allocate(size_t size) {
+#ifdef ABSL_HAVE_ADDRESS_SANITIZER
+  // Recycling storage would hide uses of removed nodes from the sanitizer.
+  return ::operator new(size);
+#endif
+  size = RoundUpTo(size == 0 ? 1 : size, kAlignment);
+  size_t size_class = size / kAlignment;
+  if (size_class < free_lists_.size() && free_lists_[size_class] != nullptr) {
+    FreeBlock* block = free_lists_[size_class];
+    free_lists_[size_class] = block->next;
+    return block;
+  }
+  if (size > kSlabSize) {
+    // Oversized requests get a slab of their own.
+    return NewSlab(size);
+  }
+  if (end_ - next_ < static_cast<ptrdiff_t>(size)) {
+    next_ = NewSlab(kSlabSize);
+    end_ = next_ + kSlabSize;
+  }
+  void* result = next_;
+  next_ += size;
+  return result;
+}
+
+void NodeArena::Free(void* ptr, size_t size) {
+#ifdef ABSL_HAVE_ADDRESS_SANITIZER
+  ::operator delete(ptr);
+  return;
+#endif
+  size = RoundUpTo(size == 0 ? 1 : size, kAlignment);
+  size_t size_class = size / kAlignment;
+  if (size_class >= free_lists_.size()) {
+    free_lists_.resize(size_class + 1, nullptr);
+  }
+  FreeBlock* block = static_cast<FreeBlock*>(ptr);
+  block->next = free_lists_[size_class];
+  free_lists_[size_class] = block;
+}
+
+}  // namespace xls
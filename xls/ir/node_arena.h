@@ -0,0 +1,74 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_NODE_ARENA_H_
+#define XLS_IR_NODE_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace xls {
+
+// A slab allocator for the nodes of a FunctionBase. Storage is carved out of
+// large slabs rather than requested from the system allocator node by node,
+// so nodes created together are adjacent in memory, and storage released by
+// removed nodes is recycled through per-size free lists so functions which are
+// rewritten repeatedly do not grow the arena. All storage is returned to the
+// system when the arena is destroyed. Under AddressSanitizer the arena
+// forwards to the system allocator so uses of removed nodes are still caught.
+//
+// Not thread-safe; like the rest of a FunctionBase, an arena is only modified
+// by one thread at a time.
+class NodeArena {
+ public:
+  NodeArena() = default;
+
+  NodeArena(const NodeArena&) = delete;
+  NodeArena& operator=(const NodeArena&) = delete;
+
+  // Returns storage for `size` bytes aligned to alignof(std::max_align_t).
+  void* Allocate(size_t size);
+
+  // Returns storage obtained from Allocate(size) to the arena for reuse.
+  void Free(void* ptr, size_t size);
+
+  // Returns the number of bytes of slab storage held by the arena.
+  size_t slab_bytes() const { return slab_bytes_; }
+
+ private:
+  static constexpr size_t kAlignment = alignof(std::max_align_t);
+  static constexpr size_t kSlabSize = size_t{64} * 1024;
+
+  // A block on a free list. Blocks are at least kAlignment bytes so the link
+  // always fits.
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  // Allocates a slab of `size` bytes, a multiple of kAlignment.
+  char* NewSlab(size_t size);
+
+  std::vector<std::unique_ptr<std::max_align_t[]>> slabs_;
+  size_t slab_bytes_ = 0;
+  // The unallocated tail of the most recent slab.
+  char* next_ = nullptr;
+  char* end_ = nullptr;
+  // Free lists indexed by block size in units of kAlignment.
+  std::vector<FreeBlock*> free_lists_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_NODE_ARENA_H_
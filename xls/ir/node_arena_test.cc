@@ -0,0 +1,77 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/node_arena.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/base/config.h"
+
+namespace xls {
+namespace {
+
+TEST(NodeArenaTest, AllocationsAreAlignedAndDisjoint) {
+  NodeArena arena;
+  std::vector<char*> blocks;
+  for (size_t size = 1; size < 200; ++size) {
+    char* block = static_cast<char*>(arena.Allocate(size));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(block) % alignof(std::max_align_t),
+              0);
+    memset(block, static_cast<int>(size), size);
+    blocks.push_back(block);
+  }
+  for (size_t size = 1; size < 200; ++size) {
+    for (size_t i = 0; i < size; ++i) {
+      EXPECT_EQ(blocks[size - 1][i], static_cast<char>(size));
+    }
+  }
+}
+
+TEST(NodeArenaTest, FreedBlocksAreReused) {
+#ifdef ABSL_HAVE_ADDRESS_SANITIZER
+  GTEST_SKIP() << "The arena forwards to the system allocator under ASan";
+#endif
+  NodeArena arena;
+  void* a = arena.Allocate(48);
+  void* b = arena.Allocate(100);
+  arena.Free(a, 48);
+  arena.Free(b, 100);
+  size_t slab_bytes = arena.slab_bytes();
+  EXPECT_EQ(arena.Allocate(100), b);
+  EXPECT_EQ(arena.Allocate(48), a);
+  EXPECT_NE(arena.Allocate(48), a);
+  EXPECT_EQ(arena.slab_bytes(), slab_bytes);
+}
+
+TEST(NodeArenaTest, OversizedAllocation) {
+#ifdef ABSL_HAVE_ADDRESS_SANITIZER
+  GTEST_SKIP() << "The arena forwards to the system allocator under ASan";
+#endif
+  NodeArena arena;
+  void* small = arena.Allocate(16);
+  size_t large_size = size_t{1} << 20;
+  char* large = static_cast<char*>(arena.Allocate(large_size));
+  memset(large, 0xab, large_size);
+  EXPECT_GE(arena.slab_bytes(), large_size);
+  // The slab of the small allocation is still used for later small ones.
+  EXPECT_EQ(static_cast<char*>(arena.Allocate(16)),
+            static_cast<char*>(small) + alignof(std::max_align_t));
+}
+
+}  // namespace
+}  // namespace xls
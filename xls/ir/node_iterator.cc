@@ -14,6 +14,7 @@
 
 #include "xls/ir/node_iterator.h"
 
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <vector>
@@ -21,6 +22,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/logging/logging.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
@@ -28,6 +30,18 @@
 namespace xls {
 
 void NodeIterator::Initialize() {
+  absl::MutexLock lock(&f_->node_order_mutex_);
+  if (f_->node_order_valid_.load(std::memory_order_relaxed)) {
+    XLS_DCHECK_EQ(f_->reverse_node_order_.size(), f_->node_count());
+    ordered_ = std::make_unique<std::vector<Node*>>(f_->reverse_node_order_);
+    return;
+  }
+  ComputeOrder();
+  f_->reverse_node_order_ = *ordered_;
+  f_->node_order_valid_.store(true, std::memory_order_relaxed);
+}
+
+void NodeIterator::ComputeOrder() {
   // For topological traversal we only add nodes to the order when all of its
   // users have been scheduled.
   //
@@ -52,8 +52,14 @@ class NodeIterator {
  private:
   explicit NodeIterator(FunctionBase* f) : f_(f) {}
 
+  // Sets `ordered_` to the reverse topological order of the nodes of `f_`,
+  // reusing the order cached in `f_` if the function has not changed since it
+  // was computed.
   void Initialize();
 
+  // Computes the reverse topological order into `ordered_`.
+  void ComputeOrder();
+
   // The vector of nodes is wrapped in a unique_ptr so that the
   // NodeIterator may be movable but the iterators returned to the
   // caller of begin()/end() are not invalidated by those moves.
@@ -71,7 +77,9 @@ class NodeIterator {
 // satisfied).
 //
 // Note that the ordering for all nodes is computed up front, *not*
-// incrementally as iteration proceeds.
+// incrementally as iteration proceeds. The ordering is cached in the function
+// and reused by later calls until a node is added, removed or rewired, so
+// repeated calls on an unchanged function only copy the cached order.
 inline NodeIterator TopoSort(FunctionBase* f) {
   return NodeIterator::Create(f);
 }
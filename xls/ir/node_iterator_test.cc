@@ -23,6 +23,7 @@
 
 #include "benchmark/benchmark.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/matchers.h"
@@ -281,6 +282,71 @@ TEST(NodeIteratorTest, RpoVsTopo) {
   EXPECT_EQ(rni.end(), it);
 }
 
+// Checks that TopoSort(f) contains every node of `f` exactly once and after all
+// of its operands, and that ReverseTopoSort(f) is its reverse.
+void ExpectValidTopoSort(Function* f) {
+  NodeIterator order = TopoSort(f);
+  EXPECT_EQ(order.AsVector().size(), f->node_count());
+  absl::flat_hash_set<Node*> seen;
+  for (Node* node : order) {
+    for (Node* operand : node->operands()) {
+      EXPECT_TRUE(seen.contains(operand))
+          << operand->GetName() << " does not precede " << node->GetName();
+    }
+    EXPECT_TRUE(seen.insert(node).second) << node->GetName();
+  }
+  if (f->return_value()->users().empty()) {
+    EXPECT_EQ(order.AsVector().back(), f->return_value());
+  }
+
+  std::vector<Node*> reversed = ReverseTopoSort(f).AsVector();
+  std::reverse(reversed.begin(), reversed.end());
+  EXPECT_EQ(reversed, order.AsVector());
+}
+
+TEST(NodeIteratorTest, CachedOrderTracksChanges) {
+  std::string program = R"(
+  fn computation(a: bits[32]) -> bits[32] {
+    b: bits[32] = neg(a)
+    c: bits[32] = neg(b)
+    ret d: bits[32] = add(c, a)
+  })";
+
+  Package p("p");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, Parser::ParseFunction(program, &p));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * a, f->GetNode("a"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * c, f->GetNode("c"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * d, f->GetNode("d"));
+
+  // An unchanged function yields the same order every time.
+  std::vector<Node*> order = TopoSort(f).AsVector();
+  EXPECT_EQ(TopoSort(f).AsVector(), order);
+  ExpectValidTopoSort(f);
+
+  // Each kind of modification must be reflected by the next sort.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * e, f->MakeNodeWithName<UnOp>(SourceInfo(), d, Op::kNot, "e"));
+  ExpectValidTopoSort(f);
+
+  XLS_ASSERT_OK(f->set_return_value(e));
+  ExpectValidTopoSort(f);
+
+  // Turn c = neg(b), d = add(c, a) into d = add(a, a), c = neg(e).
+  ASSERT_TRUE(d->ReplaceOperand(c, a));
+  XLS_ASSERT_OK(c->ReplaceOperandNumber(0, e));
+  ExpectValidTopoSort(f);
+
+  XLS_ASSERT_OK(f->set_return_value(c));
+  ExpectValidTopoSort(f);
+
+  d->SwapOperands(0, 1);
+  ExpectValidTopoSort(f);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Node * b, f->GetNode("b"));
+  XLS_ASSERT_OK(f->RemoveNode(b));
+  ExpectValidTopoSort(f);
+}
+
 void BM_TopoSortBinaryTree(benchmark::State& state) {
   std::unique_ptr<VerifiedPackage> p =
       std::make_unique<VerifiedPackage>("balanced_tree_pkg");
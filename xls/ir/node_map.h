@@ -0,0 +1,329 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_NODE_MAP_H_
+#define XLS_IR_NODE_MAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "xls/common/logging/logging.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// A map from the nodes of a single function base to values of type T. Entries
+// are stored in a vector indexed by Node::node_index so lookups do not hash
+// and iteration visits the nodes in the order they were added to the function
+// base, which is deterministic. Memory use is proportional to the largest
+// node index in the map rather than to the size of the map, so this is best
+// suited to analyses which track most of the nodes of a function base. A map
+// must not be used across FunctionBase::CompactNodeIndices, which renumbers
+// the nodes.
+//
+// The interface follows absl::flat_hash_map where possible. Unlike
+// flat_hash_map, inserting and erasing elements invalidates no iterators
+// other than those to erased elements, and references to values are stable
+// only until an insertion of a node with a larger index than any in the map.
+template <typename T>
+class NodeMap {
+ public:
+  using key_type = Node*;
+  using mapped_type = T;
+  using value_type = std::pair<Node*, T>;
+
+  template <bool kIsConst>
+  class Iterator {
+   public:
+    using MapT = std::conditional_t<kIsConst, const NodeMap, NodeMap>;
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = NodeMap::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference =
+        std::conditional_t<kIsConst, const value_type&, value_type&>;
+    using pointer =
+        std::conditional_t<kIsConst, const value_type*, value_type*>;
+
+    Iterator(MapT* map, int64_t index) : map_(map), index_(index) {
+      SkipEmpty();
+    }
+    // Allow conversion from a mutable to a const iterator.
+    template <bool kOtherIsConst,
+              typename = std::enable_if_t<kIsConst && !kOtherIsConst>>
+    Iterator(const Iterator<kOtherIsConst>& other)  // NOLINT
+        : map_(other.map_), index_(other.index_) {}
+
+    reference operator*() const { return *map_->slots_[index_]; }
+    pointer operator->() const { return &*map_->slots_[index_]; }
+    Iterator& operator++() {
+      ++index_;
+      SkipEmpty();
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator result = *this;
+      ++*this;
+      return result;
+    }
+    friend bool operator==(const Iterator& a, const Iterator& b) {
+      return a.map_ == b.map_ && a.index_ == b.index_;
+    }
+    friend bool operator!=(const Iterator& a, const Iterator& b) {
+      return !(a == b);
+    }
+
+   private:
+    friend class NodeMap;
+    template <bool>
+    friend class Iterator;
+
+    void SkipEmpty() {
+      while (index_ < map_->slots_.size() &&
+             !map_->slots_[index_].has_value()) {
+        ++index_;
+      }
+    }
+
+    MapT* map_;
+    int64_t index_;
+  };
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  NodeMap() = default;
+  // Creates an empty map with space reserved for every node of `f`.
+  explicit NodeMap(const FunctionBase* f) {
+    slots_.reserve(f->node_index_limit());
+  }
+
+  bool empty() const { return size_ == 0; }
+  int64_t size() const { return size_; }
+
+  bool contains(const Node* node) const { return Find(node) != nullptr; }
+  int64_t count(const Node* node) const { return contains(node) ? 1 : 0; }
+
+  T& at(const Node* node) {
+    value_type* entry = Find(node);
+    XLS_CHECK(entry != nullptr) << "Node not in map: " << node->GetName();
+    return entry->second;
+  }
+  const T& at(const Node* node) const {
+    const value_type* entry = Find(node);
+    XLS_CHECK(entry != nullptr) << "Node not in map: " << node->GetName();
+    return entry->second;
+  }
+  T& operator[](Node* node) { return try_emplace(node).first->second; }
+
+  iterator find(const Node* node) {
+    return Find(node) == nullptr ? end() : iterator(this, node->node_index());
+  }
+  const_iterator find(const Node* node) const {
+    return Find(node) == nullptr ? end()
+                                 : const_iterator(this, node->node_index());
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(Node* node, Args&&... args) {
+    int64_t index = node->node_index();
+    XLS_CHECK_GE(index, 0) << "Node is not in a function base";
+    if (index >= slots_.size()) {
+      slots_.resize(index + 1);
+    }
+    std::optional<value_type>& slot = slots_[index];
+    if (slot.has_value()) {
+      XLS_CHECK_EQ(slot->first, node)
+          << "NodeMap holds nodes of different function bases";
+      return {iterator(this, index), false};
+    }
+    slot.emplace(std::piecewise_construct, std::forward_as_tuple(node),
+                 std::forward_as_tuple(std::forward<Args>(args)...));
+    ++size_;
+    return {iterator(this, index), true};
+  }
+  std::pair<iterator, bool> insert(value_type value) {
+    return try_emplace(value.first, std::move(value.second));
+  }
+  template <typename V>
+  std::pair<iterator, bool> insert_or_assign(Node* node, V&& value) {
+    auto [it, inserted] = try_emplace(node, std::forward<V>(value));
+    if (!inserted) {
+      it->second = std::forward<V>(value);
+    }
+    return {it, inserted};
+  }
+
+  int64_t erase(const Node* node) {
+    if (Find(node) == nullptr) {
+      return 0;
+    }
+    slots_[node->node_index()].reset();
+    --size_;
+    return 1;
+  }
+  void erase(iterator it) {
+    slots_[it.index_].reset();
+    --size_;
+  }
+  // Erases all elements for which `pred(const value_type&)` is true. Returns
+  // the number of erased elements.
+  template <typename Predicate>
+  int64_t erase_if(Predicate pred) {
+    int64_t erased = 0;
+    for (std::optional<value_type>& slot : slots_) {
+      if (slot.has_value() && pred(std::as_const(*slot))) {
+        slot.reset();
+        ++erased;
+      }
+    }
+    size_ -= erased;
+    return erased;
+  }
+  void clear() {
+    slots_.clear();
+    size_ = 0;
+  }
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, slots_.size()); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, slots_.size()); }
+
+ private:
+  value_type* Find(const Node* node) {
+    int64_t index = node->node_index();
+    if (index < 0 || index >= slots_.size() || !slots_[index].has_value() ||
+        slots_[index]->first != node) {
+      return nullptr;
+    }
+    return &*slots_[index];
+  }
+  const value_type* Find(const Node* node) const {
+    return const_cast<NodeMap*>(this)->Find(node);
+  }
+
+  std::vector<std::optional<value_type>> slots_;
+  int64_t size_ = 0;
+};
+
+// A set of nodes of a single function base stored as a vector indexed by
+// Node::node_index. See NodeMap.
+class NodeSet {
+ public:
+  using value_type = Node*;
+
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Node*;
+    using difference_type = std::ptrdiff_t;
+    using reference = Node* const&;
+    using pointer = Node* const*;
+
+    const_iterator(const NodeSet* set, int64_t index)
+        : set_(set), index_(index) {
+      SkipEmpty();
+    }
+
+    reference operator*() const { return set_->slots_[index_]; }
+    const_iterator& operator++() {
+      ++index_;
+      SkipEmpty();
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator result = *this;
+      ++*this;
+      return result;
+    }
+    friend bool operator==(const const_iterator& a, const const_iterator& b) {
+      return a.set_ == b.set_ && a.index_ == b.index_;
+    }
+    friend bool operator!=(const const_iterator& a, const const_iterator& b) {
+      return !(a == b);
+    }
+
+   private:
+    void SkipEmpty() {
+      while (index_ < set_->slots_.size() && set_->slots_[index_] == nullptr) {
+        ++index_;
+      }
+    }
+
+    const NodeSet* set_;
+    int64_t index_;
+  };
+  using iterator = const_iterator;
+
+  NodeSet() = default;
+  // Creates an empty set with space reserved for every node of `f`.
+  explicit NodeSet(const FunctionBase* f) {
+    slots_.reserve(f->node_index_limit());
+  }
+
+  bool empty() const { return size_ == 0; }
+  int64_t size() const { return size_; }
+
+  bool contains(const Node* node) const {
+    int64_t index = node->node_index();
+    return index >= 0 && index < slots_.size() && slots_[index] == node;
+  }
+  int64_t count(const Node* node) const { return contains(node) ? 1 : 0; }
+
+  std::pair<const_iterator, bool> insert(Node* node) {
+    int64_t index = node->node_index();
+    XLS_CHECK_GE(index, 0) << "Node is not in a function base";
+    if (index >= slots_.size()) {
+      slots_.resize(index + 1, nullptr);
+    }
+    if (slots_[index] != nullptr) {
+      XLS_CHECK_EQ(slots_[index], node)
+          << "NodeSet holds nodes of different function bases";
+      return {const_iterator(this, index), false};
+    }
+    slots_[index] = node;
+    ++size_;
+    return {const_iterator(this, index), true};
+  }
+
+  int64_t erase(const Node* node) {
+    if (!contains(node)) {
+      return 0;
+    }
+    slots_[node->node_index()] = nullptr;
+    --size_;
+    return 1;
+  }
+  void clear() {
+    slots_.clear();
+    size_ = 0;
+  }
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, slots_.size()); }
+
+ private:
+  std::vector<Node*> slots_;
+  int64_t size_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_NODE_MAP_H_
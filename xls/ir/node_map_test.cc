@@ -0,0 +1,154 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/node_map.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+class NodeMapTest : public IrTestBase {};
+
+TEST_F(NodeMapTest, NodeIndicesAreDenseAndStable) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue add = fb.Add(x, y);
+  BValue neg = fb.Negate(add);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(add));
+
+  EXPECT_EQ(x.node()->node_index(), 0);
+  EXPECT_EQ(y.node()->node_index(), 1);
+  EXPECT_EQ(add.node()->node_index(), 2);
+  EXPECT_EQ(neg.node()->node_index(), 3);
+  EXPECT_EQ(f->node_index_limit(), 4);
+
+  // Indices of removed nodes are not reused.
+  XLS_ASSERT_OK(f->RemoveNode(neg.node()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * sub, f->MakeNode<BinOp>(SourceInfo(), x.node(), y.node(),
+                                     Op::kSub));
+  EXPECT_EQ(sub->node_index(), 4);
+  EXPECT_EQ(add.node()->node_index(), 2);
+  EXPECT_EQ(f->node_index_limit(), 5);
+}
+
+TEST_F(NodeMapTest, CompactNodeIndices) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue neg = fb.Negate(x);
+  BValue add = fb.Add(x, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(add));
+  EXPECT_FALSE(f->CompactNodeIndices());
+
+  XLS_ASSERT_OK(f->RemoveNode(neg.node()));
+  EXPECT_EQ(f->node_index_limit(), 4);
+  EXPECT_TRUE(f->CompactNodeIndices());
+  EXPECT_EQ(f->node_index_limit(), 3);
+  EXPECT_EQ(x.node()->node_index(), 0);
+  EXPECT_EQ(y.node()->node_index(), 1);
+  EXPECT_EQ(add.node()->node_index(), 2);
+  EXPECT_THAT(f->nodes(), ElementsAre(x.node(), y.node(), add.node()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * sub, f->MakeNode<BinOp>(SourceInfo(), x.node(), y.node(),
+                                     Op::kSub));
+  EXPECT_EQ(sub->node_index(), 3);
+}
+
+TEST_F(NodeMapTest, MapOperations) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue add = fb.Add(x, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(add));
+
+  NodeMap<int64_t> map(f);
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.contains(x.node()));
+  EXPECT_EQ(map.find(x.node()), map.end());
+
+  map[add.node()] = 3;
+  EXPECT_TRUE(map.insert({x.node(), 1}).second);
+  EXPECT_FALSE(map.insert({x.node(), 5}).second);
+  EXPECT_EQ(map.at(x.node()), 1);
+  EXPECT_FALSE(map.insert_or_assign(x.node(), 2).second);
+  EXPECT_EQ(map.at(x.node()), 2);
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_EQ(map.count(y.node()), 0);
+
+  // Iteration is in node index order regardless of insertion order.
+  std::vector<std::pair<Node*, int64_t>> elements(map.begin(), map.end());
+  EXPECT_THAT(elements, ElementsAre(Pair(x.node(), 2), Pair(add.node(), 3)));
+
+  EXPECT_EQ(map.erase(y.node()), 0);
+  EXPECT_EQ(map.erase(x.node()), 1);
+  EXPECT_FALSE(map.contains(x.node()));
+  EXPECT_EQ(map.size(), 1);
+
+  map[y.node()] = 10;
+  EXPECT_EQ(map.erase_if([](const auto& kv) { return kv.second > 5; }), 1);
+  elements.assign(map.begin(), map.end());
+  EXPECT_THAT(elements, ElementsAre(Pair(add.node(), 3)));
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.begin(), map.end());
+}
+
+TEST_F(NodeMapTest, SetOperations) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue add = fb.Add(x, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(add));
+
+  NodeSet set(f);
+  EXPECT_TRUE(set.insert(add.node()).second);
+  EXPECT_TRUE(set.insert(x.node()).second);
+  EXPECT_FALSE(set.insert(x.node()).second);
+  EXPECT_EQ(set.size(), 2);
+  EXPECT_TRUE(set.contains(add.node()));
+  EXPECT_FALSE(set.contains(y.node()));
+  EXPECT_THAT(std::vector<Node*>(set.begin(), set.end()),
+              ElementsAre(x.node(), add.node()));
+
+  EXPECT_EQ(set.erase(add.node()), 1);
+  EXPECT_EQ(set.erase(add.node()), 0);
+  EXPECT_THAT(std::vector<Node*>(set.begin(), set.end()),
+              ElementsAre(x.node()));
+}
+
+}  // namespace
+}  // namespace xls
@@ -18,10 +18,12 @@
 #include <string_view>
 #include <vector>
 
+#include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "xls/common/status/matchers.h"
+#include "xls/ir/benchmark_support.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/function.h"
@@ -37,6 +39,7 @@ namespace xls {
 namespace {
 
 using status_testing::StatusIs;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 using ::testing::UnorderedElementsAre;
 
@@ -163,6 +166,34 @@ TEST_F(NodeTest, ReplaceOperand) {
   EXPECT_TRUE(literal1.node()->HasUser(add.node()));
 }
 
+TEST_F(NodeTest, ChangeStamps) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue neg_x = fb.Negate(x);
+  BValue neg_y = fb.Negate(y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(neg_x));
+  int64_t stamp = Node::CurrentChangeStamp();
+  for (Node* node : f->nodes()) {
+    EXPECT_LE(node->change_stamp(), stamp);
+  }
+
+  // Retargeting neg(x) changes neg(x) and both its old and new operand but not
+  // the unrelated neg(y).
+  EXPECT_TRUE(neg_x.node()->ReplaceOperand(x.node(), y.node()));
+  EXPECT_GT(neg_x.node()->change_stamp(), stamp);
+  EXPECT_GT(x.node()->change_stamp(), stamp);
+  EXPECT_GT(y.node()->change_stamp(), stamp);
+  EXPECT_LE(neg_y.node()->change_stamp(), stamp);
+
+  // Gaining an implicit use is a change as is losing one.
+  stamp = Node::CurrentChangeStamp();
+  XLS_ASSERT_OK(f->set_return_value(neg_y.node()));
+  EXPECT_GT(neg_x.node()->change_stamp(), stamp);
+  EXPECT_GT(neg_y.node()->change_stamp(), stamp);
+}
+
 TEST_F(NodeTest, ReplaceOperandNumberButStillAUser) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
@@ -457,6 +488,33 @@ fn ReplaceUses(x: bits[8], y: bits[8]) -> bits[8] {
   EXPECT_TRUE(FindNode("and.1", f)->users().empty());
 }
 
+TEST_F(NodeTest, ReplaceUsesWithUserOfNode) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn ReplaceUses(x: bits[8], y: bits[8]) -> bits[8] {
+  and.1: bits[8] = and(x, y)
+  neg.2: bits[8] = neg(and.1)
+  add.3: bits[8] = add(and.1, and.1)
+  ret or.4: bits[8] = or(add.3, and.1)
+}
+)",
+                                                       p.get()));
+  Node* and_1 = FindNode("and.1", f);
+  Node* neg_2 = FindNode("neg.2", f);
+  Node* add_3 = FindNode("add.3", f);
+  Node* or_4 = FindNode("or.4", f);
+
+  // The replacement keeps using the replaced node; all other uses, including
+  // repeated ones, are moved to the replacement.
+  XLS_ASSERT_OK(and_1->ReplaceUsesWith(neg_2));
+  EXPECT_THAT(and_1->users(), ElementsAre(neg_2));
+  EXPECT_THAT(neg_2->users(), ElementsAre(add_3, or_4));
+  EXPECT_THAT(neg_2->operands(), ElementsAre(and_1));
+  EXPECT_THAT(add_3->operands(), ElementsAre(neg_2, neg_2));
+  EXPECT_THAT(or_4->operands(), ElementsAre(add_3, neg_2));
+  XLS_EXPECT_OK(VerifyFunction(f));
+}
+
 TEST_F(NodeTest, ReplaceUsesReturnValue) {
   auto p = CreatePackage();
   XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
@@ -592,5 +650,55 @@ TEST_F(NodeTest, IncorrectOpClass) {
       HasSubstr("Op `assert` is not a valid op for Node class `UnOp`"));
 }
 
+// Measures moving all uses of a node with `state.range(0)` users back and forth
+// between two nodes.
+void BM_ReplaceUsesWithFanout(benchmark::State& state) {
+  Package p("fanout_pkg");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * f,
+      benchmark_support::GenerateChain(
+          &p, /*depth=*/state.range(0), /*num_children=*/2,
+          benchmark_support::strategy::BinaryAdd(),
+          benchmark_support::strategy::SharedLiteral(UBits(42, 8))));
+  Node* shared = nullptr;
+  for (Node* node : f->nodes()) {
+    if (node->Is<Literal>() && node->users().size() > 1) {
+      shared = node;
+    }
+  }
+  ASSERT_NE(shared, nullptr);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * other, f->MakeNode<Literal>(SourceInfo(), Value(UBits(42, 8))));
+  for (auto _ : state) {
+    XLS_ASSERT_OK(shared->ReplaceUsesWith(other));
+    XLS_ASSERT_OK(other->ReplaceUsesWith(shared));
+  }
+}
+
+// Measures the common rewrite pattern of inserting a node after every node of
+// a graph and then bypassing and removing it again.
+void BM_InsertAndBypass(benchmark::State& state) {
+  Package p("balanced_tree_pkg");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * f, benchmark_support::GenerateBalancedTree(
+                        &p, /*depth=*/state.range(0),
+                        /*fan_out=*/2, benchmark_support::strategy::BinaryAdd(),
+                        benchmark_support::strategy::DistinctLiteral()));
+  std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
+  for (auto _ : state) {
+    for (Node* node : nodes) {
+      XLS_ASSERT_OK_AND_ASSIGN(
+          Node * identity,
+          f->MakeNode<UnOp>(SourceInfo(), node, Op::kIdentity));
+      XLS_ASSERT_OK(node->ReplaceUsesWith(identity));
+      XLS_ASSERT_OK(identity->ReplaceUsesWith(node));
+      XLS_ASSERT_OK(f->RemoveNode(identity));
+    }
+  }
+}
+
+BENCHMARK(BM_ReplaceUsesWithFanout)->Range(2, 4096);
+BENCHMARK(BM_InsertAndBypass)->DenseRange(2, 12, 2);
+
 }  // namespace
 }  // namespace xls
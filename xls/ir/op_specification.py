@@ -181,9 +181,12 @@ class FunctionAttribute(Attribute):
 
 class ValueAttribute(Attribute):
 
-  def __init__(self, name):
+  def __init__(self, name, init_args=None):
     super(ValueAttribute, self).__init__(
-        name, cpp_type='Value', return_cpp_type='const Value&')
+        name,
+        cpp_type='Value',
+        return_cpp_type='const Value&',
+        init_args=init_args)
 
 
 class StringAttribute(Attribute):
@@ -779,7 +782,11 @@ OpClass.kinds['LITERAL'] = OpClass(
     op='Op::kLiteral',
     operands=[],
     xls_type_expression='function->package()->GetTypeForValue(value)',
-    attributes=[ValueAttribute('value')],
+    attributes=[
+        ValueAttribute(
+            'value',
+            init_args=['Value::MaybePack(value, Value::kMinPackedLiteralSize)'])
+    ],
     extra_methods=[Method('IsZero', 'bool',
                           'value().IsBits() && value().bits().IsZero()')],
 )
@@ -27,13 +27,17 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/container/node_hash_set.h"
+#include "absl/hash/hash.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/block.h"
@@ -57,11 +61,31 @@
 namespace xls {
 
 Package::Package(std::string_view name) : name_(name) {
+  absl::MutexLock lock(&types_mutex_);
   owned_types_.insert(&token_type_);
 }
 
 Package::~Package() = default;
 
+const SourceInfo* Package::InternSourceInfo(const SourceInfo& loc) {
+  // Most nodes have no location; share one empty list without locking.
+  static const SourceInfo* const kEmpty = new SourceInfo();
+  if (loc.Empty()) {
+    return kEmpty;
+  }
+  SourceInfoShard& shard =
+      source_info_shards_[absl::HashOf(loc) % kSourceInfoShardCount];
+  {
+    absl::ReaderMutexLock lock(&shard.mutex);
+    auto it = shard.source_infos.find(loc);
+    if (it != shard.source_infos.end()) {
+      return &*it;
+    }
+  }
+  absl::MutexLock lock(&shard.mutex);
+  return &*shard.source_infos.insert(loc).first;
+}
+
 std::optional<FunctionBase*> Package::GetTop() const { return top_; }
 
 absl::Status Package::SetTop(std::optional<FunctionBase*> top) {
@@ -147,20 +171,57 @@ absl::StatusOr<FunctionBase*> Package::GetFunctionBaseByName(
 }
 
 Function* Package::AddFunction(std::unique_ptr<Function> f) {
+  InvalidateCallGraph();
   functions_.push_back(std::move(f));
   return functions_.back().get();
 }
 
 Proc* Package::AddProc(std::unique_ptr<Proc> proc) {
+  InvalidateCallGraph();
   procs_.push_back(std::move(proc));
   return procs_.back().get();
 }
 
 Block* Package::AddBlock(std::unique_ptr<Block> block) {
+  InvalidateCallGraph();
   blocks_.push_back(std::move(block));
   return blocks_.back().get();
 }
 
+std::vector<Function*> Package::GetCalledFunctions(
+    FunctionBase* function_base) const {
+  absl::MutexLock lock(&call_graph_mutex_);
+  if (!call_graph_valid_.load(std::memory_order_acquire)) {
+    callees_.clear();
+    auto add_callees = [&](FunctionBase* caller) {
+      absl::flat_hash_set<Function*> called_set;
+      std::vector<Function*> called;
+      for (Node* node : caller->nodes()) {
+        if (std::optional<Function*> callee = CalledFunction(node)) {
+          if (called_set.insert(callee.value()).second) {
+            called.push_back(callee.value());
+          }
+        }
+      }
+      if (!called.empty()) {
+        callees_[caller] = std::move(called);
+      }
+    };
+    for (const std::unique_ptr<Function>& f : functions_) {
+      add_callees(f.get());
+    }
+    for (const std::unique_ptr<Proc>& proc : procs_) {
+      add_callees(proc.get());
+    }
+    call_graph_valid_.store(true, std::memory_order_release);
+  }
+  auto it = callees_.find(function_base);
+  if (it == callees_.end()) {
+    return {};
+  }
+  return it->second;
+}
+
 // Private helpers for Package::AddPackage().
 namespace {
 // Helper class that tracks names in a package and resolves name collisions.
@@ -402,6 +463,7 @@ absl::Status Package::RemoveFunction(Function* function) {
         "`%s` is not a function in package `%s`", function->name(), name()));
   }
   functions_.erase(it, functions_.end());
+  InvalidateCallGraph();
   return absl::OkStatus();
 }
 
@@ -418,6 +480,7 @@ absl::Status Package::RemoveProc(Proc* proc) {
         "`%s` is not a proc in package `%s`", proc->name(), name()));
   }
   procs_.erase(it, procs_.end());
+  InvalidateCallGraph();
   return absl::OkStatus();
 }
 
@@ -488,8 +551,10 @@ absl::StatusOr<Type*> Package::MapTypeFromOtherPackage(
 }
 
 BitsType* Package::GetBitsType(int64_t bit_count) {
-  if (bit_count_to_type_.find(bit_count) != bit_count_to_type_.end()) {
-    return &bit_count_to_type_.at(bit_count);
+  absl::MutexLock lock(&types_mutex_);
+  if (auto it = bit_count_to_type_.find(bit_count);
+      it != bit_count_to_type_.end()) {
+    return &it->second;
   }
   auto it = bit_count_to_type_.emplace(bit_count, BitsType(bit_count));
   BitsType* new_type = &(it.first->second);
@@ -499,10 +564,11 @@ BitsType* Package::GetBitsType(int64_t bit_count) {
 
 ArrayType* Package::GetArrayType(int64_t size, Type* element_type) {
   ArrayKey key{size, element_type};
-  if (array_types_.find(key) != array_types_.end()) {
-    return &array_types_.at(key);
+  absl::MutexLock lock(&types_mutex_);
+  if (auto it = array_types_.find(key); it != array_types_.end()) {
+    return &it->second;
   }
-  XLS_CHECK(IsOwnedType(element_type))
+  XLS_CHECK(owned_types_.contains(element_type))
       << "Type is not owned by package: " << *element_type;
   auto it = array_types_.emplace(key, ArrayType(size, element_type));
   ArrayType* new_type = &(it.first->second);
@@ -512,11 +578,12 @@ ArrayType* Package::GetArrayType(int64_t size, Type* element_type) {
 
 TupleType* Package::GetTupleType(absl::Span<Type* const> element_types) {
   TypeVec key(element_types.begin(), element_types.end());
-  if (tuple_types_.find(key) != tuple_types_.end()) {
-    return &tuple_types_.at(key);
+  absl::MutexLock lock(&types_mutex_);
+  if (auto it = tuple_types_.find(key); it != tuple_types_.end()) {
+    return &it->second;
   }
   for (const Type* element_type : element_types) {
-    XLS_CHECK(IsOwnedType(element_type))
+    XLS_CHECK(owned_types_.contains(element_type))
         << "Type is not owned by package: " << *element_type;
   }
   auto it = tuple_types_.emplace(key, TupleType(element_types));
@@ -529,12 +596,14 @@ TokenType* Package::GetTokenType() { return &token_type_; }
 
 FunctionType* Package::GetFunctionType(absl::Span<Type* const> args_types,
                                        Type* return_type) {
-  std::string key = FunctionType(args_types, return_type).ToString();
-  if (function_types_.find(key) != function_types_.end()) {
-    return &function_types_.at(key);
+  FunctionTypeKey key{TypeVec(args_types.begin(), args_types.end()),
+                      return_type};
+  absl::MutexLock lock(&types_mutex_);
+  if (auto it = function_types_.find(key); it != function_types_.end()) {
+    return &it->second;
   }
   for (Type* t : args_types) {
-    XLS_CHECK(IsOwnedType(t))
+    XLS_CHECK(owned_types_.contains(t))
         << "Parameter type is not owned by package: " << t->ToString();
   }
   auto it = function_types_.emplace(key, FunctionType(args_types, return_type));
@@ -614,6 +683,10 @@ Type* Package::GetTypeForValue(const Value& value) {
       // TODO(google/xls#917): Remove this check when empty arrays are
       // supported.
       XLS_CHECK(!value.empty());
+      if (value.IsPackedArray()) {
+        return GetArrayType(value.size(),
+                            GetBitsType(value.packed_element_bit_count()));
+      }
       return GetArrayType(value.size(), GetTypeForValue(value.elements()[0]));
     }
     case ValueKind::kToken:
@@ -686,6 +759,22 @@ int64_t Package::GetNodeCount() const {
   return GetFunctionNodeCount() + GetProcNodeCount() + GetBlockNodeCount();
 }
 
+int64_t Package::GetApproximateIrByteSize() const {
+  int64_t bytes = 0;
+  for (FunctionBase* function_base : GetFunctionBases()) {
+    for (Node* node : function_base->nodes()) {
+      // Operations have few enough fields beyond those of Node that the size of
+      // the Node base is a reasonable estimate of the size of each object.
+      bytes += sizeof(Node) + node->operand_count() * sizeof(Node*) +
+               node->users().size() * sizeof(Node*);
+      if (node->Is<Literal>()) {
+        bytes += CeilOfRatio(node->GetType()->GetFlatBitCount(), int64_t{8});
+      }
+    }
+  }
+  return bytes;
+}
+
 bool Package::IsDefinitelyEqualTo(const Package* other) const {
   auto entry_function_status = GetTopAsFunction();
   if (!entry_function_status.ok()) {
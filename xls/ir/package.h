@@ -15,6 +15,8 @@
 #ifndef XLS_IR_PACKAGE_H_
 #define XLS_IR_PACKAGE_H_
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -24,12 +26,15 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/container/node_hash_map.h"
+#include "absl/container/node_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel.pb.h"
@@ -81,13 +86,18 @@ class Package {
 
   // Returns whether the given type is one of the types owned by this package.
   bool IsOwnedType(const Type* type) const {
+    absl::ReaderMutexLock lock(&types_mutex_);
     return owned_types_.find(type) != owned_types_.end();
   }
   bool IsOwnedFunctionType(const FunctionType* function_type) const {
+    absl::ReaderMutexLock lock(&types_mutex_);
     return owned_function_types_.find(function_type) !=
            owned_function_types_.end();
   }
 
+  // Returns the owned type of the given shape, creating it if necessary. These
+  // methods (and the node id counter) may be called concurrently from passes
+  // operating on different FunctionBases of the package.
   BitsType* GetBitsType(int64_t bit_count);
   ArrayType* GetArrayType(int64_t size, Type* element_type);
   TupleType* GetTupleType(absl::Span<Type* const> element_types);
@@ -139,6 +149,21 @@ class Package {
   absl::Status RemoveProc(Proc* proc);
   absl::Status RemoveBlock(Block* block);
 
+  // Returns the functions called directly by `function_base` through invoke,
+  // map, counted_for and dynamic_counted_for nodes, without duplicates and in
+  // the order of the first calling node. The call graph of the whole package
+  // is computed on the first query and cached until a calling node or a
+  // function base is added or removed, so queries cost only the size of the
+  // answer. Safe to call concurrently from passes running on different
+  // function bases.
+  std::vector<Function*> GetCalledFunctions(FunctionBase* function_base) const;
+
+  // Discards the cached call graph. Called whenever the call graph may have
+  // changed.
+  void InvalidateCallGraph() {
+    call_graph_valid_.store(false, std::memory_order_release);
+  }
+
   // Returns a new SourceLocation object containing a Fileno and Lineno pair.
   // SourceLocation objects are added to XLS IR nodes and used for debug
   // tracing.
@@ -164,9 +189,19 @@ class Package {
   // of the form: "<source_file_path>:<line_number>".
   std::string SourceLocationToString(const SourceLocation& loc);
 
+  // Returns a copy of `loc` owned by the package. Interning an equal location
+  // list more than once returns the same copy. Nodes refer to their source
+  // locations through this table, so the many nodes created from the same
+  // source (e.g., by unrolling or cloning) share a single location list
+  // instead of each owning a vector. Interned entries live as long as the
+  // package.
+  const SourceInfo* InternSourceInfo(const SourceInfo& loc);
+
   // Retrieves the next node ID to assign to a node in the package and
   // increments the next node counter. For use in node construction.
-  int64_t GetNextNodeId() { return next_node_id_++; }
+  int64_t GetNextNodeId() {
+    return next_node_id_.fetch_add(1, std::memory_order_relaxed);
+  }
 
   // Adds a file to the file-number table and returns its corresponding number.
   // If it already exists, returns the existing file-number entry.
@@ -179,9 +214,18 @@ class Package {
   // Get the filename corresponding to the given `Fileno`.
   std::optional<std::string> GetFilename(Fileno file_number) const;
 
+  // Returns the file-number table of the package.
+  const absl::flat_hash_map<Fileno, std::string>& fileno_to_name() const {
+    return fileno_to_filename_;
+  }
+
   // Returns the total number of nodes in the graph. Traverses the functions,
   // procs and blocks and sums the node counts.
   int64_t GetNodeCount() const;
+  // Returns an approximation of the number of bytes of memory used by the
+  // nodes of the package: the node objects, their operand and user lists,
+  // and the values of literals. Traverses all nodes of the package.
+  int64_t GetApproximateIrByteSize() const;
   // Returns the total number of nodes in the blocks in the graph. Traverses the
   // blocks and sums the node counts.
   int64_t GetBlockNodeCount() const;
@@ -230,10 +274,14 @@ class Package {
   // Returns whether this package contains a function with the "target" name.
   bool HasFunctionWithName(std::string_view target) const;
 
-  int64_t next_node_id() const { return next_node_id_; }
+  int64_t next_node_id() const {
+    return next_node_id_.load(std::memory_order_relaxed);
+  }
 
   // Intended for use by the parser when node ids are suggested by the IR text.
-  void set_next_node_id(int64_t value) { next_node_id_ = value; }
+  void set_next_node_id(int64_t value) {
+    next_node_id_.store(value, std::memory_order_relaxed);
+  }
 
   // Create a channel. Channels are used with send/receive nodes in communicate
   // between procs or between procs and external (to XLS) components. If no
@@ -360,39 +408,69 @@ class Package {
   std::string name_;
 
   // Ordinal to assign to the next node created in this package.
-  int64_t next_node_id_ = 1;
+  std::atomic<int64_t> next_node_id_ = 1;
+
+  // Table of interned source locations, split into shards by hash. Nodes of
+  // different function bases may be created concurrently by parallel passes;
+  // sharding keeps them from contending on one lock, and lookups of existing
+  // entries only take a reader lock. Declared before the function bases so the
+  // entries outlive the nodes referring to them.
+  struct SourceInfoShard {
+    absl::Mutex mutex;
+    absl::node_hash_set<SourceInfo> source_infos ABSL_GUARDED_BY(mutex);
+  };
+  static constexpr int64_t kSourceInfoShardCount = 16;
+  std::array<SourceInfoShard, kSourceInfoShardCount> source_info_shards_;
 
   std::vector<std::unique_ptr<Function>> functions_;
   std::vector<std::unique_ptr<Proc>> procs_;
   std::vector<std::unique_ptr<Block>> blocks_;
 
+  // Direct callees of every function base which calls any function, computed
+  // lazily by GetCalledFunctions. The mutex only serializes readers filling
+  // the cache.
+  mutable absl::Mutex call_graph_mutex_;
+  mutable absl::flat_hash_map<const FunctionBase*, std::vector<Function*>>
+      callees_ ABSL_GUARDED_BY(call_graph_mutex_);
+  mutable std::atomic<bool> call_graph_valid_ = false;
+
+  // Guards the type tables below.
+  mutable absl::Mutex types_mutex_;
+
   // Set of owned types in this package.
-  absl::flat_hash_set<const Type*> owned_types_;
+  absl::flat_hash_set<const Type*> owned_types_ ABSL_GUARDED_BY(types_mutex_);
 
   // Set of owned function types in this package.
-  absl::flat_hash_set<const FunctionType*> owned_function_types_;
+  absl::flat_hash_set<const FunctionType*> owned_function_types_
+      ABSL_GUARDED_BY(types_mutex_);
 
   // Mapping from bit count to the owned "bits" type with that many bits. Use
   // node_hash_map for pointer stability.
-  absl::node_hash_map<int64_t, BitsType> bit_count_to_type_;
+  absl::node_hash_map<int64_t, BitsType> bit_count_to_type_
+      ABSL_GUARDED_BY(types_mutex_);
 
   // Mapping from the size and element type of an array type to the owned
   // ArrayType. Use node_hash_map for pointer stability.
   using ArrayKey = std::pair<int64_t, const Type*>;
-  absl::node_hash_map<ArrayKey, ArrayType> array_types_;
+  absl::node_hash_map<ArrayKey, ArrayType> array_types_
+      ABSL_GUARDED_BY(types_mutex_);
 
   // Mapping from elements to the owned tuple type.
   //
   // Uses node_hash_map for pointer stability.
   using TypeVec = absl::InlinedVector<const Type*, 4>;
-  absl::node_hash_map<TypeVec, TupleType> tuple_types_;
+  absl::node_hash_map<TypeVec, TupleType> tuple_types_
+      ABSL_GUARDED_BY(types_mutex_);
 
   // Owned token type.
   TokenType token_type_;
 
-  // Mapping from Type:ToString to the owned function type. Use
-  // node_hash_map for pointer stability.
-  absl::node_hash_map<std::string, FunctionType> function_types_;
+  // Mapping from the parameter and return types to the owned function type.
+  // Types are interned so they are keyed by pointer. Use node_hash_map for
+  // pointer stability.
+  using FunctionTypeKey = std::pair<TypeVec, const Type*>;
+  absl::node_hash_map<FunctionTypeKey, FunctionType> function_types_
+      ABSL_GUARDED_BY(types_mutex_);
 
   // The largest `Fileno` used in this `Package`.
   std::optional<Fileno> maximum_fileno_;
@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <optional>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -32,6 +33,7 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/xls_type.pb.h"
@@ -133,6 +135,32 @@ TEST_F(PackageTest, GetTokenType) {
   EXPECT_EQ("token", my_token_type->ToString());
 }
 
+TEST_F(PackageTest, InternSourceInfos) {
+  Package p(TestName());
+  SourceInfo loc(
+      SourceLocation(p.GetOrCreateFileno("a.x"), Lineno(1), Colno(2)));
+  const SourceInfo* interned = p.InternSourceInfo(loc);
+  EXPECT_EQ(*interned, loc);
+  EXPECT_EQ(p.InternSourceInfo(SourceInfo(loc.locations)), interned);
+  EXPECT_NE(p.InternSourceInfo(SourceInfo()), interned);
+  EXPECT_TRUE(p.InternSourceInfo(SourceInfo())->Empty());
+}
+
+TEST_F(PackageTest, ClonedNodesShareSourceInfos) {
+  Package p(TestName());
+  SourceInfo loc(
+      SourceLocation(p.GetOrCreateFileno("a.x"), Lineno(3), Colno(4)));
+  FunctionBuilder fb("f", &p);
+  fb.Negate(fb.Param("x", p.GetBitsType(32)), loc, "neg");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(Function * clone, f->Clone("g"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Node * neg, f->GetNode("neg"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * cloned_neg, clone->GetNode("neg"));
+  EXPECT_EQ(cloned_neg->loc(), loc);
+  EXPECT_EQ(&cloned_neg->loc(), &neg->loc());
+}
+
 TEST_F(PackageTest, MapTypeFromOtherPackageBitsTypes) {
   Package p(TestName());
   Package other_package("other_package");
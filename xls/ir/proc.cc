@@ -102,7 +102,9 @@ absl::Status Proc::SetNextToken(Node* next) {
         "Cannot set next token to \"%s\", expected token type but has type %s",
         next->GetName(), next->GetType()->ToString()));
   }
+  next_token_->MarkChanged();
   next_token_ = next;
+  next->MarkChanged();
   return absl::OkStatus();
 }
 
@@ -137,8 +139,10 @@ absl::Status Proc::SetNextStateElement(int64_t index, Node* next) {
         GetStateElementType(index)->ToString()));
   }
   next_state_indices_[next_state_[index]].erase(index);
+  next_state_[index]->MarkChanged();
   next_state_[index] = next;
   next_state_indices_[next].insert(index);
+  next->MarkChanged();
   return absl::OkStatus();
 }
 
@@ -200,6 +204,7 @@ absl::StatusOr<Param*> Proc::ReplaceStateElement(
                         index, name(), old_param->GetName()));
   }
   next_state_indices_[next_state_[index]].erase(index);
+  next_state_[index]->MarkChanged();
   next_state_[index] = nullptr;
   XLS_RETURN_IF_ERROR(RemoveNode(old_param));
 
@@ -240,6 +245,7 @@ absl::Status Proc::RemoveStateElement(int64_t index) {
     }
   }
   next_state_indices_[next_state_[index]].erase(index);
+  next_state_[index]->MarkChanged();
   next_state_.erase(next_state_.begin() + index);
   Param* old_param = GetStateParam(index);
   if (!old_param->users().empty()) {
@@ -313,23 +319,30 @@ absl::StatusOr<Proc*> Proc::Clone(
     absl::flat_hash_map<int64_t, int64_t> channel_remapping,
     absl::flat_hash_map<const FunctionBase*, FunctionBase*> call_remapping)
     const {
-  absl::flat_hash_map<Node*, Node*> original_to_clone;
   if (target_package == nullptr) {
     target_package = package();
   }
   Proc* cloned_proc = target_package->AddProc(std::make_unique<Proc>(
       new_name, TokenParam()->GetName(), target_package));
-  original_to_clone[TokenParam()] = cloned_proc->TokenParam();
+  cloned_proc->ReserveNodes(node_count());
+
+  // Map from node index of an original node to its clone.
+  std::vector<Node*> original_to_clone(node_index_limit(), nullptr);
+  auto clone_of = [&](Node* node) -> Node*& {
+    return original_to_clone[node->node_index()];
+  };
+  clone_of(TokenParam()) = cloned_proc->TokenParam();
   for (int64_t i = 0; i < GetStateElementCount(); ++i) {
     XLS_ASSIGN_OR_RETURN(Param * cloned_param, cloned_proc->AppendStateElement(
                                                    GetStateParam(i)->GetName(),
                                                    GetInitValueElement(i)));
-    original_to_clone[GetStateParam(i)] = cloned_param;
+    clone_of(GetStateParam(i)) = cloned_param;
   }
-  for (Node* node : TopoSort(const_cast<Proc*>(this))) {
-    std::vector<Node*> cloned_operands;
+  std::vector<Node*> cloned_operands;
+  for (Node* node : NodesInOperandOrder()) {
+    cloned_operands.clear();
     for (Node* operand : node->operands()) {
-      cloned_operands.push_back(original_to_clone.at(operand));
+      cloned_operands.push_back(clone_of(operand));
     }
 
     switch (node->op()) {
@@ -342,7 +355,7 @@ absl::StatusOr<Proc*> Proc::Clone(
                                  ? channel_remapping.at(src->channel_id())
                                  : src->channel_id();
         XLS_ASSIGN_OR_RETURN(
-            original_to_clone[node],
+            clone_of(node),
             cloned_proc->MakeNodeWithName<Receive>(
                 src->loc(), cloned_operands[0],
                 cloned_operands.size() == 2
@@ -357,7 +370,7 @@ absl::StatusOr<Proc*> Proc::Clone(
                                  ? channel_remapping.at(src->channel_id())
                                  : src->channel_id();
         XLS_ASSIGN_OR_RETURN(
-            original_to_clone[node],
+            clone_of(node),
             cloned_proc->MakeNodeWithName<Send>(
                 src->loc(), cloned_operands[0], cloned_operands[1],
                 cloned_operands.size() == 3
@@ -381,7 +394,7 @@ absl::StatusOr<Proc*> Proc::Clone(
               "CountedFor target was not mapped to a function."));
         }
         XLS_ASSIGN_OR_RETURN(
-            original_to_clone[node],
+            clone_of(node),
             cloned_proc->MakeNodeWithName<CountedFor>(
                 src->loc(), cloned_operands[0],
                 absl::Span<Node*>(cloned_operands).subspan(1),
@@ -402,7 +415,7 @@ absl::StatusOr<Proc*> Proc::Clone(
               absl::StrFormat("Map target was not mapped to a function."));
         }
         XLS_ASSIGN_OR_RETURN(
-            original_to_clone[node],
+            clone_of(node),
             cloned_proc->MakeNodeWithName<Map>(src->loc(), cloned_operands[0],
                                                to_apply, src->GetName()));
         break;
@@ -421,26 +434,31 @@ absl::StatusOr<Proc*> Proc::Clone(
               absl::StrFormat("Invoke target was not mapped to a function."));
         }
         XLS_ASSIGN_OR_RETURN(
-            original_to_clone[node],
+            clone_of(node),
             cloned_proc->MakeNodeWithName<Invoke>(src->loc(), cloned_operands,
                                                   to_apply, src->GetName()));
         break;
       }
-      // Default clone.
+      // Default clone. Within a package the clone is an exact copy of the
+      // original node so verifying it would only re-check the original.
       default: {
+        std::optional<ScopedSkipNodeVerification> skip_verification;
+        if (target_package == package()) {
+          skip_verification.emplace(cloned_proc);
+        }
         XLS_ASSIGN_OR_RETURN(
-            original_to_clone[node],
+            clone_of(node),
             node->CloneInNewFunction(cloned_operands, cloned_proc));
         break;
       }
     }
   }
   XLS_RETURN_IF_ERROR(
-      cloned_proc->SetNextToken(original_to_clone.at(NextToken())));
+      cloned_proc->SetNextToken(clone_of(NextToken())));
 
   for (int64_t i = 0; i < GetStateElementCount(); ++i) {
     XLS_RETURN_IF_ERROR(cloned_proc->SetNextStateElement(
-        i, original_to_clone.at(GetNextStateElement(i))));
+        i, clone_of(GetNextStateElement(i))));
   }
   return cloned_proc;
 }
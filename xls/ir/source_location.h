@@ -16,6 +16,7 @@
 #define XLS_IR_SOURCE_LOCATION_H_
 
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/str_format.h"
@@ -43,6 +44,19 @@ class SourceLocation {
                            colno_.value());
   }
 
+  friend bool operator==(const SourceLocation& lhs, const SourceLocation& rhs) {
+    return lhs.fileno_ == rhs.fileno_ && lhs.lineno_ == rhs.lineno_ &&
+           lhs.colno_ == rhs.colno_;
+  }
+  friend bool operator!=(const SourceLocation& lhs, const SourceLocation& rhs) {
+    return !(lhs == rhs);
+  }
+
+  template <typename H>
+  friend H AbslHashValue(H h, const SourceLocation& loc) {
+    return H::combine(std::move(h), loc.fileno_, loc.lineno_, loc.colno_);
+  }
+
  private:
   Fileno fileno_;
   Lineno lineno_;
@@ -67,6 +81,18 @@ struct SourceInfo {
     }
     return absl::StrFormat("[%s]", absl::StrJoin(strings, ", "));
   }
+
+  friend bool operator==(const SourceInfo& lhs, const SourceInfo& rhs) {
+    return lhs.locations == rhs.locations;
+  }
+  friend bool operator!=(const SourceInfo& lhs, const SourceInfo& rhs) {
+    return !(lhs == rhs);
+  }
+
+  template <typename H>
+  friend H AbslHashValue(H h, const SourceInfo& info) {
+    return H::combine(std::move(h), info.locations);
+  }
 };
 
 }  // namespace xls
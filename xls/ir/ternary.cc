@@ -15,8 +15,10 @@
 #include "xls/ir/ternary.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <string>
 #include <string_view>
+#include <utility>
 
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -108,6 +110,124 @@ Bits ToKnownBitsValues(const TernaryVector& ternary_vector) {
   return Bits(bits);
 }
 
+PackedTernaryVector Pack(const TernaryVector& ternary_vector) {
+  const int64_t size = ternary_vector.size();
+  PackedTernaryVector result(size);
+  for (int64_t word = 0; word < result.known.word_count(); ++word) {
+    uint64_t known = 0;
+    uint64_t value = 0;
+    const int64_t base = word * 64;
+    const int64_t limit = std::min<int64_t>(64, size - base);
+    for (int64_t i = 0; i < limit; ++i) {
+      TernaryValue t = ternary_vector[base + i];
+      known |= uint64_t{t != TernaryValue::kUnknown} << i;
+      value |= uint64_t{t == TernaryValue::kKnownOne} << i;
+    }
+    result.known.SetWord(word, known);
+    result.value.SetWord(word, value);
+  }
+  return result;
+}
+
+TernaryVector Unpack(const PackedTernaryVector& packed) {
+  TernaryVector result(packed.bit_count());
+  for (int64_t i = 0; i < result.size(); ++i) {
+    result[i] = packed.known.Get(i) ? static_cast<TernaryValue>(
+                                          packed.value.Get(i))
+                                    : TernaryValue::kUnknown;
+  }
+  return result;
+}
+
+namespace {
+
+// Applies `f(known_a, value_a, known_b, value_b)` -> {known, value} to each
+// word of `a` and `b`.
+template <typename F>
+PackedTernaryVector MapWords(const PackedTernaryVector& a,
+                             const PackedTernaryVector& b, F f) {
+  XLS_CHECK_EQ(a.bit_count(), b.bit_count());
+  PackedTernaryVector result(a.bit_count());
+  for (int64_t i = 0; i < a.known.word_count(); ++i) {
+    auto [known, value] = f(a.known.GetWord(i), a.value.GetWord(i),
+                            b.known.GetWord(i), b.value.GetWord(i));
+    result.known.SetWord(i, known);
+    result.value.SetWord(i, value & known);
+  }
+  return result;
+}
+
+// Returns `a + b + carry` and sets `carry` to the carry out.
+uint64_t AddWithCarry(uint64_t a, uint64_t b, uint64_t& carry) {
+  uint64_t sum = a + b;
+  uint64_t carry_out = sum < a ? 1 : 0;
+  uint64_t result = sum + carry;
+  carry_out |= result < sum ? 1 : 0;
+  carry = carry_out;
+  return result;
+}
+
+}  // namespace
+
+PackedTernaryVector Not(const PackedTernaryVector& a) {
+  PackedTernaryVector result(a.bit_count());
+  for (int64_t i = 0; i < a.known.word_count(); ++i) {
+    uint64_t known = a.known.GetWord(i);
+    result.known.SetWord(i, known);
+    result.value.SetWord(i, ~a.value.GetWord(i) & known);
+  }
+  return result;
+}
+
+PackedTernaryVector And(const PackedTernaryVector& a,
+                        const PackedTernaryVector& b) {
+  return MapWords(a, b, [](uint64_t ka, uint64_t va, uint64_t kb, uint64_t vb) {
+    // Known if either side is a known zero or both sides are known.
+    return std::pair((ka & ~va) | (kb & ~vb) | (ka & kb), va & vb);
+  });
+}
+
+PackedTernaryVector Or(const PackedTernaryVector& a,
+                       const PackedTernaryVector& b) {
+  return MapWords(a, b, [](uint64_t ka, uint64_t va, uint64_t kb, uint64_t vb) {
+    // Known if either side is a known one or both sides are known.
+    return std::pair(va | vb | (ka & kb), va | vb);
+  });
+}
+
+PackedTernaryVector Xor(const PackedTernaryVector& a,
+                        const PackedTernaryVector& b) {
+  return MapWords(a, b, [](uint64_t ka, uint64_t va, uint64_t kb, uint64_t vb) {
+    return std::pair(ka & kb, va ^ vb);
+  });
+}
+
+PackedTernaryVector Add(const PackedTernaryVector& a,
+                        const PackedTernaryVector& b) {
+  XLS_CHECK_EQ(a.bit_count(), b.bit_count());
+  // The carry into each position is a monotone function of the operands, so
+  // it is known iff it is the same for the smallest (unknowns zero) and
+  // largest (unknowns one) possible operands. A position of the sum is known
+  // iff both operand positions and the carry into it are known.
+  PackedTernaryVector result(a.bit_count());
+  uint64_t min_carry = 0;
+  uint64_t max_carry = 0;
+  for (int64_t i = 0; i < a.known.word_count(); ++i) {
+    uint64_t ka = a.known.GetWord(i);
+    uint64_t va = a.value.GetWord(i);
+    uint64_t kb = b.known.GetWord(i);
+    uint64_t vb = b.value.GetWord(i);
+    uint64_t min_sum = AddWithCarry(va, vb, min_carry);
+    uint64_t max_sum = AddWithCarry(va | ~ka, vb | ~kb, max_carry);
+    uint64_t carry_known_one = min_sum ^ va ^ vb;
+    uint64_t carry_known_zero = ~(max_sum ^ (ka & ~va) ^ (kb & ~vb));
+    uint64_t known = ka & kb & (carry_known_one | carry_known_zero);
+    result.known.SetWord(i, known);
+    result.value.SetWord(i, min_sum & known);
+  }
+  return result;
+}
+
 }  // namespace ternary_ops
 
 }  // namespace xls
@@ -21,11 +21,13 @@
 #include <ostream>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/algorithm/container.h"
 #include "absl/status/statusor.h"
 #include "xls/common/logging/logging.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "xls/ir/bits.h"
 
 namespace xls {
@@ -41,6 +43,33 @@ enum class TernaryValue : int8_t {
 // A vector of ternary values. Analogous to the Bits object for concrete values.
 using TernaryVector = std::vector<TernaryValue>;
 
+// A ternary vector packed into two bitmaps. Bit i of `known` is set if
+// position i is known, in which case bit i of `value` holds its value. Bits of
+// `value` at unknown positions are zero. Operations on packed vectors process
+// 64 positions at a time which makes them much faster than the equivalent
+// operations on TernaryVectors for wide values.
+struct PackedTernaryVector {
+  // Creates a vector with all `bit_count` positions unknown.
+  explicit PackedTernaryVector(int64_t bit_count)
+      : known(bit_count), value(bit_count) {}
+  PackedTernaryVector(InlineBitmap known, InlineBitmap value)
+      : known(std::move(known)), value(std::move(value)) {
+    XLS_CHECK_EQ(this->known.bit_count(), this->value.bit_count());
+  }
+
+  int64_t bit_count() const { return known.bit_count(); }
+
+  bool operator==(const PackedTernaryVector& other) const {
+    return known == other.known && value == other.value;
+  }
+  bool operator!=(const PackedTernaryVector& other) const {
+    return !(*this == other);
+  }
+
+  InlineBitmap known;
+  InlineBitmap value;
+};
+
 // Format of the ternary vector is, for example: 0b10XX1
 std::string ToString(const TernaryVector& value);
 std::string ToString(const TernaryValue& value);
@@ -225,6 +254,35 @@ inline TernaryVector BitsToTernary(const Bits& bits) {
   return result;
 }
 
+// Conversions between TernaryVectors and PackedTernaryVectors.
+PackedTernaryVector Pack(const TernaryVector& ternary_vector);
+TernaryVector Unpack(const PackedTernaryVector& packed);
+inline PackedTernaryVector PackKnownBits(const Bits& known_bits,
+                                         const Bits& known_bits_values) {
+  XLS_CHECK_EQ(known_bits.bit_count(), known_bits_values.bit_count());
+  PackedTernaryVector result(known_bits.bitmap(), known_bits_values.bitmap());
+  for (int64_t i = 0; i < result.value.word_count(); ++i) {
+    result.value.SetWord(i, result.value.GetWord(i) & result.known.GetWord(i));
+  }
+  return result;
+}
+
+// Word-parallel ternary operations on packed vectors. The operands must have
+// the same width. Each operation gives exactly the result of applying the
+// corresponding TernaryValue operation position by position. `Add` is the most
+// precise ternary approximation of addition modulo 2^bit_count: a position of
+// the sum is known iff it has the same value for every assignment of the
+// unknown positions of the operands.
+PackedTernaryVector Not(const PackedTernaryVector& a);
+PackedTernaryVector And(const PackedTernaryVector& a,
+                        const PackedTernaryVector& b);
+PackedTernaryVector Or(const PackedTernaryVector& a,
+                       const PackedTernaryVector& b);
+PackedTernaryVector Xor(const PackedTernaryVector& a,
+                        const PackedTernaryVector& b);
+PackedTernaryVector Add(const PackedTernaryVector& a,
+                        const PackedTernaryVector& b);
+
 inline bool IsKnownOne(const TernaryVector& ternary) {
   return absl::c_all_of(
       ternary, [](TernaryValue v) { return v == TernaryValue::kKnownOne; });
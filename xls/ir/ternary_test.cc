@@ -55,5 +55,53 @@ TEST(Ternary, NumberOfKnownBits) {
   EXPECT_EQ(ternary_ops::NumberOfKnownBits(TernaryVector()), 0);
 }
 
+TEST(Ternary, PackRoundTrip) {
+  TernaryVector vector;
+  for (int64_t i = 0; i < 150; ++i) {
+    vector.push_back(static_cast<TernaryValue>(i % 3));
+  }
+  PackedTernaryVector packed = ternary_ops::Pack(vector);
+  EXPECT_EQ(packed.bit_count(), 150);
+  EXPECT_EQ(ternary_ops::Unpack(packed), vector);
+  EXPECT_EQ(ternary_ops::Unpack(ternary_ops::Pack(TernaryVector())),
+            TernaryVector());
+  EXPECT_EQ(ternary_ops::PackKnownBits(ternary_ops::ToKnownBits(vector),
+                                       ternary_ops::ToKnownBitsValues(vector)),
+            packed);
+}
+
+TEST(Ternary, PackedBitwiseOps) {
+  // Every combination of two ternary values, repeated to span several words.
+  TernaryVector a;
+  TernaryVector b;
+  for (int64_t i = 0; i < 100; ++i) {
+    a.push_back(static_cast<TernaryValue>(i % 3));
+    b.push_back(static_cast<TernaryValue>((i / 3) % 3));
+  }
+  PackedTernaryVector packed_a = ternary_ops::Pack(a);
+  PackedTernaryVector packed_b = ternary_ops::Pack(b);
+  TernaryVector and_result =
+      ternary_ops::Unpack(ternary_ops::And(packed_a, packed_b));
+  TernaryVector or_result =
+      ternary_ops::Unpack(ternary_ops::Or(packed_a, packed_b));
+  TernaryVector xor_result =
+      ternary_ops::Unpack(ternary_ops::Xor(packed_a, packed_b));
+  TernaryVector not_result = ternary_ops::Unpack(ternary_ops::Not(packed_a));
+  for (int64_t i = 0; i < a.size(); ++i) {
+    EXPECT_EQ(and_result[i], ternary_ops::And(a[i], b[i])) << i;
+    EXPECT_EQ(or_result[i], ternary_ops::Or(a[i], b[i])) << i;
+    EXPECT_EQ(xor_result[i],
+              ternary_ops::IsKnown(a[i]) && ternary_ops::IsKnown(b[i])
+                  ? static_cast<TernaryValue>(a[i] != b[i])
+                  : TernaryValue::kUnknown)
+        << i;
+    EXPECT_EQ(not_result[i], ternary_ops::IsKnown(a[i])
+                                 ? static_cast<TernaryValue>(
+                                       a[i] == TernaryValue::kKnownZero)
+                                 : TernaryValue::kUnknown)
+        << i;
+  }
+}
+
 }  // namespace
 }  // namespace xls
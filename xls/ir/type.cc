@@ -14,6 +14,7 @@
 
 #include "xls/ir/type.h"
 
+#include <cstdint>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -22,6 +23,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 
 namespace xls {
 
@@ -65,11 +67,8 @@ TypeProto BitsType::ToProto() const {
   return proto;
 }
 
-bool BitsType::IsEqualTo(const Type* other) const {
-  if (this == other) {
-    return true;
-  }
-  return other->IsBits() && bit_count() == other->AsBitsOrDie()->bit_count();
+bool BitsType::IsStructurallyEqualTo(const Type* other) const {
+  return bit_count() == other->AsBitsOrDie()->bit_count();
 }
 
 TypeProto TupleType::ToProto() const {
@@ -81,13 +80,31 @@ TypeProto TupleType::ToProto() const {
   return proto;
 }
 
-bool TupleType::IsEqualTo(const Type* other) const {
-  if (this == other) {
-    return true;
+int64_t TupleType::FlatBitCount(absl::Span<Type* const> members) {
+  int64_t total = 0;
+  for (const Type* type : members) {
+    total += type->GetFlatBitCount();
   }
-  if (!other->IsTuple()) {
-    return false;
+  return total;
+}
+
+int64_t TupleType::LeafCount(absl::Span<Type* const> members) {
+  int64_t total = 0;
+  for (const Type* type : members) {
+    total += type->leaf_count();
+  }
+  return total;
+}
+
+uint64_t TupleType::Hash(absl::Span<Type* const> members) {
+  uint64_t hash = HashCombine(KindHash(TypeKind::kTuple), members.size());
+  for (const Type* type : members) {
+    hash = HashCombine(hash, type->hash());
   }
+  return hash;
+}
+
+bool TupleType::IsStructurallyEqualTo(const Type* other) const {
   const TupleType* other_tuple = other->AsTupleOrDie();
   if (size() != other_tuple->size()) {
     return false;
@@ -108,13 +125,7 @@ TypeProto ArrayType::ToProto() const {
   return proto;
 }
 
-bool ArrayType::IsEqualTo(const Type* other) const {
-  if (this == other) {
-    return true;
-  }
-  if (!other->IsArray()) {
-    return false;
-  }
+bool ArrayType::IsStructurallyEqualTo(const Type* other) const {
   const ArrayType* other_array = other->AsArrayOrDie();
   return size() == other_array->size() &&
          element_type()->IsEqualTo(other_array->element_type());
@@ -126,11 +137,8 @@ TypeProto TokenType::ToProto() const {
   return proto;
 }
 
-bool TokenType::IsEqualTo(const Type* other) const {
-  if (this == other) {
-    return true;
-  }
-  return other->IsToken();
+bool TokenType::IsStructurallyEqualTo(const Type* other) const {
+  return true;
 }
 
 std::ostream& operator<<(std::ostream& os, const Type& type) {
@@ -148,7 +156,9 @@ std::string TupleType::ToString() const {
 }
 
 BitsType::BitsType(int64_t bit_count)
-    : Type(TypeKind::kBits), bit_count_(bit_count) {
+    : Type(TypeKind::kBits, bit_count, /*leaf_count=*/1,
+           HashCombine(KindHash(TypeKind::kBits), bit_count)),
+      bit_count_(bit_count) {
   XLS_CHECK_GE(bit_count_, 0);
 }
 
@@ -44,6 +44,11 @@ std::ostream& operator<<(std::ostream& os, TypeKind type_kind);
 //
 // The abstract type base can be checked-downconverted via the As*() methods
 // below.
+//
+// Types are interned by their owning package (see Package::GetBitsType etc),
+// so two types owned by the same package are equal if and only if they are the
+// same object. The flat bit count, leaf count and a structural hash are
+// computed on construction so none of them requires walking the type.
 class Type {
  public:
   virtual ~Type() = default;
@@ -53,8 +58,16 @@ class Type {
 
   TypeKind kind() const { return kind_; }
 
-  // Returns true if this type and 'other' represent the same type.
-  virtual bool IsEqualTo(const Type* other) const = 0;
+  // Returns true if this type and 'other' represent the same type. This is a
+  // pointer comparison for types owned by the same package; a structural
+  // comparison is only required for types owned by different packages with
+  // equal hashes.
+  bool IsEqualTo(const Type* other) const;
+
+  // Returns a hash of the structure of the type. Structurally equal types have
+  // equal hashes, even if they are owned by different packages. The hash does
+  // not depend on the process so it may be persisted.
+  uint64_t hash() const { return hash_; }
 
   bool IsBits() const { return kind_ == TypeKind::kBits; }
   BitsType* AsBitsOrDie();
@@ -77,10 +90,10 @@ class Type {
   // Returns the count of bits required to represent the underlying type; e.g.
   // for tuples this will be the sum of the bit count from all its members, for
   // a "bits" type it will be the count of bits.
-  virtual int64_t GetFlatBitCount() const = 0;
+  int64_t GetFlatBitCount() const { return flat_bit_count_; }
 
   // Returns the number of leaf Bits types in this object.
-  virtual int64_t leaf_count() const = 0;
+  int64_t leaf_count() const { return leaf_count_; }
 
   virtual std::string ToString() const = 0;
 
@@ -90,10 +103,30 @@ class Type {
   }
 
  protected:
-  explicit Type(TypeKind kind) : kind_(kind) {}
+  Type(TypeKind kind, int64_t flat_bit_count, int64_t leaf_count,
+       uint64_t hash)
+      : kind_(kind),
+        flat_bit_count_(flat_bit_count),
+        leaf_count_(leaf_count),
+        hash_(hash) {}
+
+  // Returns the given hash combined with `value`.
+  static uint64_t HashCombine(uint64_t seed, uint64_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+  }
+  static uint64_t KindHash(TypeKind kind) {
+    return HashCombine(0, static_cast<uint64_t>(kind));
+  }
+
+  // Returns true if `other`, which has the same kind, flat bit count and hash
+  // as this type, has the same structure.
+  virtual bool IsStructurallyEqualTo(const Type* other) const = 0;
 
  private:
   TypeKind kind_;
+  int64_t flat_bit_count_;
+  int64_t leaf_count_;
+  uint64_t hash_;
 };
 
 std::ostream& operator<<(std::ostream& os, const Type& type);
@@ -107,14 +140,13 @@ class BitsType : public Type {
   int64_t bit_count() const { return bit_count_; }
 
   TypeProto ToProto() const override;
-  bool IsEqualTo(const Type* other) const override;
-  int64_t GetFlatBitCount() const override { return bit_count(); }
-
-  int64_t leaf_count() const override { return 1; }
 
   // Returns a string like "bits[32]".
   std::string ToString() const override;
 
+ protected:
+  bool IsStructurallyEqualTo(const Type* other) const override;
+
  private:
   int64_t bit_count_;
 };
@@ -126,17 +158,13 @@ class BitsType : public Type {
 class TupleType : public Type {
  public:
   explicit TupleType(absl::Span<Type* const> members)
-      : Type(TypeKind::kTuple), members_(members.begin(), members.end()) {
-    leaf_count_ = 0;
-    for (Type* t : members) {
-      leaf_count_ += t->leaf_count();
-    }
-  }
+      : Type(TypeKind::kTuple, FlatBitCount(members), LeafCount(members),
+             Hash(members)),
+        members_(members.begin(), members.end()) {}
   ~TupleType() override = default;
   std::string ToString() const override;
 
   TypeProto ToProto() const override;
-  bool IsEqualTo(const Type* other) const override;
 
   // Returns the number of elements of the tuple.
   int64_t size() const { return members_.size(); }
@@ -147,18 +175,14 @@ class TupleType : public Type {
   // Returns the element types of the tuple.
   absl::Span<Type* const> element_types() const { return members_; }
 
-  int64_t leaf_count() const override { return leaf_count_; }
-
-  int64_t GetFlatBitCount() const override {
-    int64_t total = 0;
-    for (const Type* type : members_) {
-      total += type->GetFlatBitCount();
-    }
-    return total;
-  }
+ protected:
+  bool IsStructurallyEqualTo(const Type* other) const override;
 
  private:
-  int64_t leaf_count_;
+  static int64_t FlatBitCount(absl::Span<Type* const> members);
+  static int64_t LeafCount(absl::Span<Type* const> members);
+  static uint64_t Hash(absl::Span<Type* const> members);
+
   std::vector<Type*> members_;
 };
 
@@ -168,23 +192,22 @@ class TupleType : public Type {
 class ArrayType : public Type {
  public:
   explicit ArrayType(int64_t size, Type* element_type)
-      : Type(TypeKind::kArray), size_(size), element_type_(element_type) {}
+      : Type(TypeKind::kArray, element_type->GetFlatBitCount() * size,
+             element_type->leaf_count() * size,
+             HashCombine(HashCombine(KindHash(TypeKind::kArray), size),
+                         element_type->hash())),
+        size_(size),
+        element_type_(element_type) {}
   ~ArrayType() override = default;
   std::string ToString() const override;
 
   TypeProto ToProto() const override;
-  bool IsEqualTo(const Type* other) const override;
 
   Type* element_type() const { return element_type_; }
   int64_t size() const { return size_; }
 
-  int64_t GetFlatBitCount() const override {
-    return element_type_->GetFlatBitCount() * size_;
-  }
-
-  int64_t leaf_count() const override {
-    return size_ * element_type()->leaf_count();
-  }
+ protected:
+  bool IsStructurallyEqualTo(const Type* other) const override;
 
  private:
   int64_t size_;
@@ -194,16 +217,17 @@ class ArrayType : public Type {
 // Represents a token type used for ordering channel accesses.
 class TokenType : public Type {
  public:
-  explicit TokenType() : Type(TypeKind::kToken) {}
+  // Tokens contain no bits.
+  explicit TokenType()
+      : Type(TypeKind::kToken, /*flat_bit_count=*/0, /*leaf_count=*/1,
+             KindHash(TypeKind::kToken)) {}
   ~TokenType() override = default;
   std::string ToString() const override;
 
   TypeProto ToProto() const override;
-  bool IsEqualTo(const Type* other) const override;
 
-  // Tokens contain no bits.
-  int64_t GetFlatBitCount() const override { return 0; }
-  int64_t leaf_count() const override { return 1; }
+ protected:
+  bool IsStructurallyEqualTo(const Type* other) const override;
 };
 
 // Represents a type that is a function with parameters and return type.
@@ -230,6 +254,17 @@ class FunctionType {
 
 // -- Inlines
 
+inline bool Type::IsEqualTo(const Type* other) const {
+  if (this == other) {
+    return true;
+  }
+  if (kind_ != other->kind_ || hash_ != other->hash_ ||
+      flat_bit_count_ != other->flat_bit_count_) {
+    return false;
+  }
+  return IsStructurallyEqualTo(other);
+}
+
 inline const BitsType* Type::AsBitsOrDie() const {
   XLS_CHECK_EQ(kind(), TypeKind::kBits) << ToString();
   return down_cast<const BitsType*>(this);
@@ -19,6 +19,7 @@
 #include "xls/common/status/matchers.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
+#include "xls/ir/package.h"
 
 namespace xls {
 namespace {
@@ -168,5 +169,48 @@ TEST(TypeTest, ArrayDimensionAndIndex) {
   EXPECT_THAT(GetIndexedElementType(&a_3d, 3), IsOkAndHolds(&b32));
 }
 
+TEST(TypeTest, HashAndFlatBitCount) {
+  BitsType b8(8);
+  BitsType b8_2(8);
+  BitsType b16(16);
+  TokenType token;
+  ArrayType a(3, &b8);
+  ArrayType a_2(3, &b8_2);
+  TupleType t({&a, &b16, &token});
+  TupleType t_2({&a_2, &b16, &token});
+  TupleType swapped({&b16, &a, &token});
+
+  EXPECT_EQ(b8.hash(), b8_2.hash());
+  EXPECT_NE(b8.hash(), b16.hash());
+  EXPECT_EQ(a.hash(), a_2.hash());
+  EXPECT_EQ(t.hash(), t_2.hash());
+  EXPECT_NE(t.hash(), swapped.hash());
+  EXPECT_TRUE(t.IsEqualTo(&t_2));
+  EXPECT_FALSE(t.IsEqualTo(&swapped));
+
+  EXPECT_EQ(a.GetFlatBitCount(), 24);
+  EXPECT_EQ(t.GetFlatBitCount(), 40);
+  EXPECT_EQ(swapped.GetFlatBitCount(), 40);
+  EXPECT_EQ(t.leaf_count(), 5);
+}
+
+TEST(TypeTest, PackageTypesArePointerCanonical) {
+  Package p("p");
+  Package other("other");
+  Type* tuple = p.GetTupleType(
+      {p.GetArrayType(4, p.GetBitsType(3)), p.GetTokenType()});
+  EXPECT_EQ(tuple, p.GetTupleType({p.GetArrayType(4, p.GetBitsType(3)),
+                                   p.GetTokenType()}));
+  Type* other_tuple = other.GetTupleType(
+      {other.GetArrayType(4, other.GetBitsType(3)), other.GetTokenType()});
+  EXPECT_NE(tuple, other_tuple);
+  EXPECT_EQ(tuple->hash(), other_tuple->hash());
+  EXPECT_TRUE(tuple->IsEqualTo(other_tuple));
+
+  FunctionType* f_type = p.GetFunctionType({tuple}, p.GetBitsType(3));
+  EXPECT_EQ(f_type, p.GetFunctionType({tuple}, p.GetBitsType(3)));
+  EXPECT_NE(f_type, p.GetFunctionType({tuple}, p.GetBitsType(4)));
+}
+
 }  // namespace
 }  // namespace xls
@@ -14,11 +14,18 @@
 
 #include "xls/ir/value.h"
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/base/call_once.h"
+#include "absl/hash/hash.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
@@ -30,6 +37,140 @@
 
 namespace xls {
 
+struct Value::PackedElements {
+  int64_t size;
+  int64_t element_bit_count;
+  // The flattened array; element 0 occupies the most significant bits.
+  Bits bits;
+
+  // The elements as individual values, materialized on demand by
+  // `Value::elements()`.
+  mutable absl::once_flag unpack_once;
+  mutable std::vector<Value> unpacked;
+
+  // Hash of the elements computed on first use; zero if not yet computed.
+  mutable std::atomic<size_t> hash{0};
+};
+
+namespace {
+
+// Hashes the elements of a tuple or array. The elements of packed arrays are
+// combined exactly as the equivalent bits Values would be so that packed and
+// unpacked arrays hash the same.
+struct ElementsHashView {
+  const Value& value;
+
+  template <typename H>
+  friend H AbslHashValue(H h, const ElementsHashView& view) {
+    if (view.value.IsPackedArray()) {
+      for (int64_t i = 0; i < view.value.size(); ++i) {
+        h = H::combine(std::move(h), ValueKind::kBits,
+                       view.value.GetPackedElement(i));
+      }
+    } else {
+      for (const Value& element : view.value.elements()) {
+        h = H::combine(std::move(h), element);
+      }
+    }
+    return H::combine(std::move(h), view.value.size());
+  }
+};
+
+}  // namespace
+
+/* static */ absl::StatusOr<Value> Value::PackedArray(int64_t size,
+                                                     int64_t element_bit_count,
+                                                     Bits flat_bits) {
+  if (size == 0) {
+    return absl::UnimplementedError("Empty array Values are not supported.");
+  }
+  XLS_RET_CHECK_GT(size, 0);
+  XLS_RET_CHECK_GE(element_bit_count, 0);
+  XLS_RET_CHECK_EQ(flat_bits.bit_count(), size * element_bit_count);
+  auto packed = std::make_shared<PackedElements>();
+  packed->size = size;
+  packed->element_bit_count = element_bit_count;
+  packed->bits = std::move(flat_bits);
+  return Value(PackedPtr(std::move(packed)));
+}
+
+/* static */ absl::StatusOr<Value> Value::PackedArrayFill(const Bits& element,
+                                                         int64_t size) {
+  XLS_RET_CHECK_GE(size, 0);
+  BitsRope rope(size * element.bit_count());
+  for (int64_t i = 0; i < size; ++i) {
+    rope.push_back(element);
+  }
+  return PackedArray(size, element.bit_count(), rope.Build());
+}
+
+/* static */ Value Value::MaybePack(const Value& value, int64_t min_size) {
+  if (!value.IsArray() || value.IsPackedArray() || value.empty() ||
+      value.size() < min_size || !value.element(0).IsBits()) {
+    return value;
+  }
+  int64_t element_bit_count = value.element(0).bits().bit_count();
+  BitsRope rope(value.size() * element_bit_count);
+  // The last element occupies the least significant bits.
+  for (int64_t i = value.size() - 1; i >= 0; --i) {
+    rope.push_back(value.element(i).bits());
+  }
+  return PackedArray(value.size(), element_bit_count, rope.Build()).value();
+}
+
+int64_t Value::size() const {
+  if (const PackedPtr* packed = std::get_if<PackedPtr>(&payload_)) {
+    return (*packed)->size;
+  }
+  return std::get<ElementsPtr>(payload_)->values.size();
+}
+
+size_t Value::ElementsHash() const {
+  std::atomic<size_t>& cache =
+      IsPackedArray() ? std::get<PackedPtr>(payload_)->hash
+                      : std::get<ElementsPtr>(payload_)->hash;
+  size_t hash = cache.load(std::memory_order_relaxed);
+  if (hash == 0) {
+    // Racing computations store the same value so relaxed ordering suffices.
+    hash = absl::HashOf(ElementsHashView{*this});
+    cache.store(hash, std::memory_order_relaxed);
+  }
+  return hash;
+}
+
+size_t Value::CachedElementsHash() const {
+  if (const PackedPtr* packed = std::get_if<PackedPtr>(&payload_)) {
+    return (*packed)->hash.load(std::memory_order_relaxed);
+  }
+  return std::get<ElementsPtr>(payload_)->hash.load(std::memory_order_relaxed);
+}
+
+Bits Value::GetPackedElement(int64_t i) const {
+  const PackedElements& packed = *std::get<PackedPtr>(payload_);
+  XLS_CHECK(i >= 0 && i < packed.size) << "Index out of bounds: " << i;
+  return packed.bits.Slice((packed.size - 1 - i) * packed.element_bit_count,
+                           packed.element_bit_count);
+}
+
+int64_t Value::packed_element_bit_count() const {
+  return std::get<PackedPtr>(payload_)->element_bit_count;
+}
+
+const Bits& Value::packed_bits() const {
+  return std::get<PackedPtr>(payload_)->bits;
+}
+
+absl::Span<const Value> Value::UnpackedElements() const {
+  const PackedElements& packed = *std::get<PackedPtr>(payload_);
+  absl::call_once(packed.unpack_once, [&]() {
+    packed.unpacked.reserve(packed.size);
+    for (int64_t i = 0; i < packed.size; ++i) {
+      packed.unpacked.push_back(Value(GetPackedElement(i)));
+    }
+  });
+  return packed.unpacked;
+}
+
 /* static */ absl::StatusOr<Value> Value::Array(
     absl::Span<const Value> elements) {
   if (elements.empty()) {
@@ -143,6 +284,9 @@ int64_t Value::GetFlatBitCount() const {
   if (kind() == ValueKind::kBits) {
     return bits().bit_count();
   }
+  if (IsPackedArray()) {
+    return packed_bits().bit_count();
+  }
   if (kind() == ValueKind::kToken) {
     return 0;
   }
@@ -166,6 +310,9 @@ bool Value::IsAllZeros() const {
   if (kind() == ValueKind::kBits) {
     return bits().IsZero();
   }
+  if (IsPackedArray()) {
+    return packed_bits().IsZero();
+  }
   if (kind() == ValueKind::kTuple || kind() == ValueKind::kArray) {
     for (const Value& e : elements()) {
       if (!e.IsAllZeros()) {
@@ -182,6 +329,9 @@ bool Value::IsAllOnes() const {
   if (kind() == ValueKind::kBits) {
     return bits().IsAllOnes();
   }
+  if (IsPackedArray()) {
+    return packed_bits().IsAllOnes();
+  }
   if (kind() == ValueKind::kTuple || kind() == ValueKind::kArray) {
     for (const Value& e : elements()) {
       if (!e.IsAllOnes()) {
@@ -210,6 +360,14 @@ std::string Value::ToString(FormatPreference preference) const {
                         }),
           ")");
     case ValueKind::kArray:
+      if (IsPackedArray()) {
+        std::string result = "[";
+        for (int64_t i = 0; i < size(); ++i) {
+          absl::StrAppend(&result, i == 0 ? "" : ", ",
+                          Value(GetPackedElement(i)).ToString(preference));
+        }
+        return absl::StrCat(result, "]");
+      }
       return absl::StrCat(
           "[",
           absl::StrJoin(elements(), ", ",
@@ -230,6 +388,10 @@ void Value::FlattenTo(BitPushBuffer* buffer) const {
       return;
     case ValueKind::kTuple:
     case ValueKind::kArray:
+      if (IsPackedArray()) {
+        packed_bits().FlattenTo(buffer);
+        return;
+      }
       for (const Value& element : elements()) {
         element.FlattenTo(buffer);
       }
@@ -241,8 +403,23 @@ void Value::FlattenTo(BitPushBuffer* buffer) const {
   XLS_LOG(FATAL) << "Invalid value kind: " << ValueKindToString(kind_);
 }
 
+/* static */ const Value::ElementsPtr& Value::EmptyElements() {
+  static const ElementsPtr* kEmpty =
+      new ElementsPtr(std::make_shared<const SharedElements>(
+          std::vector<Value>()));
+  return *kEmpty;
+}
+
 absl::StatusOr<std::vector<Value>> Value::GetElements() const {
-  if (!std::holds_alternative<std::vector<Value>>(payload_)) {
+  if (IsPackedArray()) {
+    std::vector<Value> elements;
+    elements.reserve(size());
+    for (int64_t i = 0; i < size(); ++i) {
+      elements.push_back(Value(GetPackedElement(i)));
+    }
+    return elements;
+  }
+  if (!std::holds_alternative<ElementsPtr>(payload_)) {
     return absl::InvalidArgumentError("Value does not hold elements.");
   }
   return std::vector<Value>(elements().begin(), elements().end());
@@ -263,6 +440,14 @@ std::string Value::ToHumanString(FormatPreference preference) const {
     case ValueKind::kBits:
       return BitsToString(bits(), preference);
     case ValueKind::kArray:
+      if (IsPackedArray()) {
+        std::string result = "[";
+        for (int64_t i = 0; i < size(); ++i) {
+          absl::StrAppend(&result, i == 0 ? "" : ", ",
+                          BitsToString(GetPackedElement(i), preference));
+        }
+        return absl::StrCat(result, "]");
+      }
       return absl::StrCat("[",
                           absl::StrJoin(elements(), ", ",
                                         [&](std::string* out, const Value& v) {
@@ -302,7 +487,22 @@ bool Value::SameTypeAs(const Value& other) const {
       }
       return true;
     case ValueKind::kArray: {
-      return size() == other.size() && element(0).SameTypeAs(other.element(0));
+      if (size() != other.size()) {
+        return false;
+      }
+      if (other.IsPackedArray() && !IsPackedArray()) {
+        return other.SameTypeAs(*this);
+      }
+      if (IsPackedArray()) {
+        if (other.IsPackedArray()) {
+          return packed_element_bit_count() ==
+                 other.packed_element_bit_count();
+        }
+        return other.element(0).IsBits() &&
+               other.element(0).bits().bit_count() ==
+                   packed_element_bit_count();
+      }
+      return element(0).SameTypeAs(other.element(0));
     }
     case ValueKind::kToken:
       return true;
@@ -326,12 +526,18 @@ absl::StatusOr<TypeProto> Value::TypeAsProto() const {
       }
       break;
     case ValueKind::kArray: {
-      if (elements().empty()) {
+      if (empty()) {
         return absl::InternalError(
             "Cannot determine type of empty array value");
       }
       proto.set_type_enum(TypeProto::ARRAY);
       proto.set_array_size(size());
+      if (IsPackedArray()) {
+        proto.mutable_array_element()->set_type_enum(TypeProto::BITS);
+        proto.mutable_array_element()->set_bit_count(
+            packed_element_bit_count());
+        break;
+      }
       XLS_ASSIGN_OR_RETURN(*proto.mutable_array_element(),
                            elements().front().TypeAsProto());
       break;
@@ -351,10 +557,42 @@ bool Value::operator==(const Value& other) const {
   }
 
   if (IsBits()) {
-    return bits() == other.bits();
+    // Copies of the same wide value share their bits.
+    return &bits() == &other.bits() || bits() == other.bits();
+  }
+
+  // Aggregates with different cached hashes cannot be equal.
+  size_t hash = CachedElementsHash();
+  size_t other_hash = other.CachedElementsHash();
+  if (hash != 0 && other_hash != 0 && hash != other_hash) {
+    return false;
+  }
+
+  if (IsPackedArray() || other.IsPackedArray()) {
+    if (size() != other.size()) {
+      return false;
+    }
+    if (IsPackedArray() && other.IsPackedArray()) {
+      return packed_bits() == other.packed_bits();
+    }
+    // Compare element-wise without unpacking the packed operand.
+    const Value& packed = IsPackedArray() ? *this : other;
+    const Value& unpacked = IsPackedArray() ? other : *this;
+    for (int64_t i = 0; i < size(); ++i) {
+      const Value& element = unpacked.element(i);
+      if (!element.IsBits() || element.bits() != packed.GetPackedElement(i)) {
+        return false;
+      }
+    }
+    return true;
   }
 
   // All non-Bits types are container types -- should have a size attribute.
+  // Copies of the same value share their elements.
+  const ElementsPtr& elements_ptr = std::get<ElementsPtr>(payload_);
+  if (elements_ptr == std::get<ElementsPtr>(other.payload_)) {
+    return true;
+  }
   if (size() != other.size()) {
     return false;
   }
@@ -15,7 +15,10 @@
 #ifndef XLS_IR_VALUE_H_
 #define XLS_IR_VALUE_H_
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -40,8 +43,8 @@ enum class ValueKind {
   kTuple,
 
   // Arrays must be homogeneous in their elements, and may choose to use a
-  // more efficient storage mechanism as a result. For now we always used the
-  // boxed Value type, though.
+  // more efficient storage mechanism as a result: arrays of bits may be held
+  // packed into a single Bits object (see Value::PackedArray).
   kArray,
 
   kToken
@@ -58,6 +61,21 @@ inline std::ostream& operator<<(std::ostream& os, ValueKind kind) {
 // values, or arrays or values. Arrays are represented similarly to tuples, but
 // are monomorphic and potentially multi-dimensional.
 //
+// Values are immutable. The elements of tuples and arrays are held in a
+// reference-counted buffer which is shared between copies of the value, so
+// copying an aggregate (or extracting an aggregate element of one) does not
+// copy its elements. Likewise bits values too wide to be stored inline in a
+// Bits object (more than kMaxInlineBitCount bits) are held in a shared buffer,
+// so copying any value costs at most a reference count increment.
+//
+// Arrays of bits may instead be held packed: the flattened bits of all the
+// elements in one shared Bits object rather than one Value (and one Bits
+// allocation) per element. Packed arrays compare equal to, hash the same as,
+// and print the same as their unpacked equivalents. The size, type, flattened
+// bits and individual elements (via GetPackedElement) of a packed array are
+// available directly; `elements()` unpacks the array on first use and caches
+// the result, so users which care about memory should avoid it.
+//
 // TODO(leary): 2019-04-04 Arrays are not currently multi-dimensional, we had
 // some discussion around this, maybe they should be?
 class Value {
@@ -66,7 +84,7 @@ class Value {
     return Value(ValueKind::kTuple, elements);
   }
   static Value TupleOwned(std::vector<Value>&& elements) {
-    return Value(ValueKind::kTuple, elements);
+    return Value(ValueKind::kTuple, std::move(elements));
   }
 
   // All members of "elements" must be of the same type, or an error status will
@@ -100,17 +118,38 @@ class Value {
     return Value(ValueKind::kArray, std::move(elements));
   }
 
-  static Value Token() {
-    return Value(ValueKind::kToken, std::vector<Value>({}));
-  }
+  // Returns an array of `size` elements of type bits[element_bit_count] held in
+  // packed form. `flat_bits` is the flattened array as produced by
+  // `FlattenTo`, i.e. element 0 occupies the most significant bits.
+  static absl::StatusOr<Value> PackedArray(int64_t size,
+                                           int64_t element_bit_count,
+                                           Bits flat_bits);
+
+  // Returns a packed array of `size` copies of `element`.
+  static absl::StatusOr<Value> PackedArrayFill(const Bits& element,
+                                               int64_t size);
+
+  // Returns `value` in packed form if it is a non-empty array of bits with at
+  // least `min_size` elements, and `value` otherwise.
+  static Value MaybePack(const Value& value, int64_t min_size = 0);
+
+  // Array literals in the IR with at least this many elements are held packed.
+  static constexpr int64_t kMinPackedLiteralSize = 64;
+
+  static Value Token() { return Value(ValueKind::kToken, EmptyElements()); }
   static Value Bool(bool enabled) {
     return Value(UBits(/*value=*/enabled, /*bit_count=*/1));
   }
 
+  // Bits values of at most this many bits are stored inline; wider values are
+  // reference counted.
+  static constexpr int64_t kMaxInlineBitCount =
+      InlineBitmap::kInlineWordCount * 64;
+
   Value() : kind_(ValueKind::kInvalid), payload_(nullptr) {}
 
   explicit Value(Bits bits)
-      : kind_(ValueKind::kBits), payload_(std::move(bits)) {}
+      : kind_(ValueKind::kBits), payload_(BitsPayload(std::move(bits))) {}
 
   // Serializes the contents of this value as bits in the buffer.
   void FlattenTo(BitPushBuffer* buffer) const;
@@ -118,19 +157,41 @@ class Value {
   ValueKind kind() const { return kind_; }
   bool IsTuple() const { return kind_ == ValueKind::kTuple; }
   bool IsArray() const { return kind_ == ValueKind::kArray; }
-  bool IsBits() const { return std::holds_alternative<Bits>(payload_); }
+  bool IsBits() const { return kind_ == ValueKind::kBits; }
   bool IsToken() const { return kind_ == ValueKind::kToken; }
-  const Bits& bits() const { return std::get<Bits>(payload_); }
+  const Bits& bits() const {
+    if (const Bits* bits = std::get_if<Bits>(&payload_)) {
+      return *bits;
+    }
+    return *std::get<BitsPtr>(payload_);
+  }
   absl::StatusOr<Bits> GetBitsWithStatus() const;
 
   absl::StatusOr<std::vector<Value>> GetElements() const;
 
   absl::Span<const Value> elements() const {
-    return std::get<std::vector<Value>>(payload_);
+    if (const ElementsPtr* elements = std::get_if<ElementsPtr>(&payload_)) {
+      return (*elements)->values;
+    }
+    return UnpackedElements();
   }
   const Value& element(int64_t i) const { return elements().at(i); }
-  int64_t size() const { return elements().size(); }
-  bool empty() const { return elements().empty(); }
+  int64_t size() const;
+  bool empty() const { return size() == 0; }
+
+  // Returns whether this is an array held in packed form.
+  bool IsPackedArray() const {
+    return std::holds_alternative<PackedPtr>(payload_);
+  }
+
+  // Returns the bits of the `i`-th element of the packed array without
+  // unpacking the array. Precondition: IsPackedArray().
+  Bits GetPackedElement(int64_t i) const;
+
+  // Returns the element bit count and flattened bits of the packed array.
+  // Precondition: IsPackedArray().
+  int64_t packed_element_bit_count() const;
+  const Bits& packed_bits() const;
 
   // Returns the total number of bits in this value.
   int64_t GetFlatBitCount() const;
@@ -163,16 +224,85 @@ class Value {
   bool operator==(const Value& other) const;
   bool operator!=(const Value& other) const { return !(*this == other); }
 
+  template <typename H>
+  friend H AbslHashValue(H h, const Value& value) {
+    h = H::combine(std::move(h), value.kind_);
+    if (value.IsBits()) {
+      return H::combine(std::move(h), value.bits());
+    }
+    if (value.IsTuple() || value.IsArray()) {
+      return H::combine(std::move(h), value.ElementsHash());
+    }
+    return h;
+  }
+
  private:
+  // Shared, immutable storage for the elements of a tuple or array.
+  struct SharedElements {
+    explicit SharedElements(std::vector<Value> values)
+        : values(std::move(values)) {}
+
+    std::vector<Value> values;
+
+    // Hash of `values` computed on first use; zero if not yet computed.
+    mutable std::atomic<size_t> hash{0};
+  };
+  using ElementsPtr = std::shared_ptr<const SharedElements>;
+
+  // Shared, immutable storage for a packed array of bits.
+  struct PackedElements;
+  using PackedPtr = std::shared_ptr<const PackedElements>;
+
+  // Shared, immutable storage for wide bits values.
+  using BitsPtr = std::shared_ptr<const Bits>;
+
+  using Payload =
+      std::variant<std::nullptr_t, ElementsPtr, Bits, PackedPtr, BitsPtr>;
+
+  static Payload BitsPayload(Bits bits) {
+    if (bits.bit_count() > kMaxInlineBitCount) {
+      return std::make_shared<const Bits>(std::move(bits));
+    }
+    return std::move(bits);
+  }
+
+  // Returns the hash of the elements of a tuple or array. The hash is computed
+  // once and cached in the storage shared by copies of the value; packed
+  // arrays hash the same as their unpacked equivalents.
+  size_t ElementsHash() const;
+
+  // Returns the cached hash of the elements of a tuple or array, or zero if it
+  // has not been computed.
+  size_t CachedElementsHash() const;
+
+  // Returns the elements of a packed array, unpacking them on first use.
+  absl::Span<const Value> UnpackedElements() const;
+
+  // Returns the storage shared by all element-less values.
+  static const ElementsPtr& EmptyElements();
+
   Value(ValueKind kind, absl::Span<const Value> elements)
       : kind_(kind),
-        payload_(std::vector<Value>(elements.begin(), elements.end())) {}
+        payload_(elements.empty()
+                     ? EmptyElements()
+                     : std::make_shared<const SharedElements>(
+                           std::vector<Value>(elements.begin(),
+                                              elements.end()))) {}
 
   Value(ValueKind kind, std::vector<Value>&& elements)
+      : kind_(kind),
+        payload_(elements.empty() ? EmptyElements()
+                                  : std::make_shared<const SharedElements>(
+                                        std::move(elements))) {}
+
+  Value(ValueKind kind, ElementsPtr elements)
       : kind_(kind), payload_(std::move(elements)) {}
 
+  explicit Value(PackedPtr packed)
+      : kind_(ValueKind::kArray), payload_(std::move(packed)) {}
+
   ValueKind kind_;
-  std::variant<std::nullptr_t, std::vector<Value>, Bits> payload_;
+  Payload payload_;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const Value& value) {
@@ -109,29 +109,40 @@ absl::StatusOr<float> TupleToF32(const Value& v) {
   return absl::bit_cast<float>(x);
 }
 
-absl::StatusOr<Value> LeafTypeTreeToValue(const LeafTypeTree<Value>& tree) {
+namespace {
+
+absl::StatusOr<Value> LeafTypeTreeViewToValue(
+    LeafTypeTreeView<const Value> tree) {
   Type* type = tree.type();
   if (type->IsTuple()) {
     std::vector<Value> values;
+    values.reserve(type->AsTupleOrDie()->size());
     for (int64_t i = 0; i < type->AsTupleOrDie()->size(); ++i) {
       XLS_ASSIGN_OR_RETURN(Value value,
-                           LeafTypeTreeToValue(tree.CopySubtree({i})));
-      values.push_back(value);
+                           LeafTypeTreeViewToValue(tree.AsView({i})));
+      values.push_back(std::move(value));
     }
     return Value::TupleOwned(std::move(values));
   }
   if (type->IsArray()) {
     std::vector<Value> values;
+    values.reserve(type->AsArrayOrDie()->size());
     for (int64_t i = 0; i < type->AsArrayOrDie()->size(); ++i) {
       XLS_ASSIGN_OR_RETURN(Value value,
-                           LeafTypeTreeToValue(tree.CopySubtree({i})));
-      values.push_back(value);
+                           LeafTypeTreeViewToValue(tree.AsView({i})));
+      values.push_back(std::move(value));
     }
     return Value::ArrayOrDie(values);
   }
   return tree.Get({});
 }
 
+}  // namespace
+
+absl::StatusOr<Value> LeafTypeTreeToValue(const LeafTypeTree<Value>& tree) {
+  return LeafTypeTreeViewToValue(tree.AsView());
+}
+
 absl::StatusOr<LeafTypeTree<Value>> ValueToLeafTypeTree(const Value& value,
                                                         Type* type) {
   XLS_RET_CHECK(ValueConformsToType(value, type));
@@ -16,6 +16,8 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/hash/hash.h"
+#include "absl/hash/hash_testing.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/package.h"
@@ -69,6 +71,20 @@ TEST(ValueTest, ToString) {
   EXPECT_EQ(token_value.ToHumanString(), "token");
 }
 
+TEST(ValueTest, Hash) {
+  XLS_ASSERT_OK_AND_ASSIGN(Value array,
+                           Value::UBitsArray({1, 2}, /*bit_count=*/8));
+  EXPECT_TRUE(absl::VerifyTypeImplementsAbslHashCorrectly({
+      Value(UBits(0, 8)),
+      Value(UBits(1, 8)),
+      Value(UBits(1, 16)),
+      Value::Tuple({}),
+      Value::Tuple({Value(UBits(1, 8)), Value(UBits(2, 8))}),
+      array,
+      Value::Token(),
+  }));
+}
+
 TEST(ValueTest, SameTypeAs) {
   Value b1(UBits(42, 33));
   Value b2(UBits(42, 10));
@@ -330,4 +346,125 @@ TEST(ValueTest, XBitsArrayWrongSizes) {
               HasSubstr("elements of arrays should have consistent size."));
 }
 
+TEST(ValueTest, CopiesShareElements) {
+  Value inner = Value::Tuple({Value(UBits(1, 8)), Value(UBits(2, 16))});
+  Value array = Value::ArrayOrDie({inner, inner, inner});
+
+  Value copy = array;
+  EXPECT_EQ(copy, array);
+  EXPECT_EQ(copy.elements().data(), array.elements().data());
+
+  // Extracting an aggregate element does not copy the element's elements.
+  Value element = array.element(1);
+  EXPECT_EQ(element, inner);
+  EXPECT_EQ(element.elements().data(), array.element(1).elements().data());
+
+  // Structurally equal values built independently compare equal.
+  Value other = Value::ArrayOrDie(
+      {Value::Tuple({Value(UBits(1, 8)), Value(UBits(2, 16))}), inner, inner});
+  EXPECT_NE(other.elements().data(), array.elements().data());
+  EXPECT_EQ(other, array);
+  EXPECT_NE(other, Value::ArrayOrDie({inner, inner}));
+}
+
+TEST(ValueTest, CopiesShareWideBits) {
+  Value narrow(UBits(42, Value::kMaxInlineBitCount));
+  Value narrow_copy = narrow;
+  EXPECT_NE(&narrow_copy.bits(), &narrow.bits());
+  EXPECT_EQ(narrow_copy, narrow);
+
+  Value wide(Bits::AllOnes(Value::kMaxInlineBitCount + 1));
+  Value wide_copy = wide;
+  EXPECT_EQ(&wide_copy.bits(), &wide.bits());
+  EXPECT_EQ(wide_copy, wide);
+  EXPECT_TRUE(wide_copy.IsBits());
+  EXPECT_EQ(wide, Value(Bits::AllOnes(Value::kMaxInlineBitCount + 1)));
+  EXPECT_NE(wide, Value(Bits(Value::kMaxInlineBitCount + 1)));
+  EXPECT_TRUE(absl::VerifyTypeImplementsAbslHashCorrectly(
+      {narrow, wide, Value(Bits(Value::kMaxInlineBitCount + 1))}));
+}
+
+TEST(ValueTest, HashIsCachedAndConsistentWithEquality) {
+  Value a = Value::Tuple(
+      {Value(UBits(1, 8)), Value::UBitsArray({1, 2}, 4).value()});
+  Value b = Value::Tuple(
+      {Value(UBits(1, 8)), Value::UBitsArray({1, 2}, 4).value()});
+  Value c = Value::Tuple(
+      {Value(UBits(1, 8)), Value::UBitsArray({1, 3}, 4).value()});
+
+  // Hashing is stable across repeated (cached) computations.
+  size_t a_hash = absl::HashOf(a);
+  EXPECT_EQ(absl::HashOf(a), a_hash);
+  EXPECT_EQ(absl::HashOf(Value(a)), a_hash);
+  EXPECT_EQ(absl::HashOf(b), a_hash);
+  EXPECT_NE(absl::HashOf(c), a_hash);
+
+  // Equality gives the same answers once hashes are cached.
+  EXPECT_EQ(a, b);
+  EXPECT_NE(a, c);
+  EXPECT_NE(c, b);
+}
+
+TEST(ValueTest, OwnedConstructors) {
+  std::vector<Value> elements = {Value(UBits(3, 4)), Value(UBits(5, 4))};
+  const Value* data = elements.data();
+  Value tuple = Value::TupleOwned(std::move(elements));
+  EXPECT_EQ(tuple.elements().data(), data);
+  EXPECT_EQ(tuple, Value::Tuple({Value(UBits(3, 4)), Value(UBits(5, 4))}));
+
+  EXPECT_EQ(Value::TupleOwned({}), Value::Tuple({}));
+  EXPECT_TRUE(Value::Token().empty());
+  EXPECT_EQ(Value::Token(), Value::Token());
+  EXPECT_NE(Value::Token(), Value::Tuple({}));
+}
+
+TEST(ValueTest, PackedArray) {
+  Value unpacked = Value::UBitsArray({1, 2, 3}, 8).value();
+  XLS_ASSERT_OK_AND_ASSIGN(Value packed,
+                           Value::PackedArray(3, 8, UBits(0x010203, 24)));
+  EXPECT_TRUE(packed.IsPackedArray());
+  EXPECT_FALSE(unpacked.IsPackedArray());
+  EXPECT_TRUE(packed.IsArray());
+  EXPECT_EQ(packed.size(), 3);
+  EXPECT_EQ(packed.GetPackedElement(0), UBits(1, 8));
+  EXPECT_EQ(packed.GetPackedElement(2), UBits(3, 8));
+  EXPECT_EQ(packed.GetFlatBitCount(), 24);
+
+  EXPECT_EQ(packed, unpacked);
+  EXPECT_EQ(unpacked, packed);
+  EXPECT_TRUE(packed.SameTypeAs(unpacked));
+  EXPECT_TRUE(unpacked.SameTypeAs(packed));
+  EXPECT_EQ(packed.ToString(), unpacked.ToString());
+  EXPECT_EQ(packed.ToHumanString(), unpacked.ToHumanString());
+  EXPECT_NE(packed, Value::UBitsArray({1, 2, 4}, 8).value());
+  EXPECT_FALSE(packed.SameTypeAs(Value::UBitsArray({1, 2, 3}, 9).value()));
+
+  // Unpacking yields the same elements.
+  EXPECT_EQ(packed.element(1), Value(UBits(2, 8)));
+  EXPECT_EQ(packed.elements().size(), 3);
+  EXPECT_EQ(Value::MaybePack(unpacked), packed);
+  EXPECT_TRUE(Value::MaybePack(unpacked).IsPackedArray());
+  EXPECT_FALSE(Value::MaybePack(unpacked, /*min_size=*/4).IsPackedArray());
+
+  EXPECT_TRUE(absl::VerifyTypeImplementsAbslHashCorrectly(
+      {packed, unpacked, Value::UBitsArray({1, 2, 4}, 8).value(),
+       Value::MaybePack(Value::UBitsArray({1, 2, 4}, 8).value())}));
+
+  EXPECT_FALSE(Value::PackedArray(3, 8, UBits(0, 16)).ok());
+}
+
+TEST(ValueTest, PackedArrayFill) {
+  XLS_ASSERT_OK_AND_ASSIGN(Value filled,
+                           Value::PackedArrayFill(UBits(0xab, 8), 1000));
+  EXPECT_TRUE(filled.IsPackedArray());
+  EXPECT_EQ(filled.size(), 1000);
+  EXPECT_EQ(filled.GetPackedElement(999), UBits(0xab, 8));
+  EXPECT_FALSE(filled.IsAllZeros());
+
+  XLS_ASSERT_OK_AND_ASSIGN(Value zeros,
+                           Value::PackedArrayFill(UBits(0, 4), 16));
+  EXPECT_TRUE(zeros.IsAllZeros());
+  EXPECT_EQ(zeros, Value::UBitsArray(std::vector<uint64_t>(16, 0), 4).value());
+}
+
 }  // namespace xls
@@ -15,14 +15,17 @@
 #include "xls/ir/verifier.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <deque>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
@@ -35,6 +38,7 @@
 #include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/block.h"
 #include "xls/ir/caret.h"
 #include "xls/ir/channel.h"
@@ -1434,8 +1438,38 @@ absl::Status VerifyNodeIdUnique(Node* node, absl::flat_hash_set<int64_t>* ids) {
   return absl::OkStatus();
 }
 
-// Verify common invariants to function-level constucts.
-absl::Status VerifyFunctionBase(FunctionBase* function) {
+// Returns true if the per-node checks of `node` must be run when only
+// rechecking nodes modified after the change stamp `changed_since`. Besides
+// modified nodes this includes nodes whose validity depends on objects outside
+// of the node graph which do not carry change stamps.
+bool NeedsNodeCheck(Node* node, std::optional<int64_t> changed_since) {
+  if (!changed_since.has_value() || node->change_stamp() > *changed_since) {
+    return true;
+  }
+  switch (node->op()) {
+    case Op::kCountedFor:
+    case Op::kDynamicCountedFor:
+    case Op::kInstantiationInput:
+    case Op::kInstantiationOutput:
+    case Op::kInvoke:
+    case Op::kMap:
+    case Op::kReceive:
+    case Op::kRegisterRead:
+    case Op::kRegisterWrite:
+    case Op::kSend:
+      return true;
+    default:
+      break;
+  }
+  return absl::c_any_of(node->operands(), [&](Node* operand) {
+    return operand->change_stamp() > *changed_since;
+  });
+}
+
+// Verify common invariants to function-level constucts. If `changed_since` is
+// set only the nodes selected by NeedsNodeCheck are verified individually.
+absl::Status VerifyFunctionBase(FunctionBase* function,
+                                std::optional<int64_t> changed_since) {
   XLS_VLOG(2) << absl::StreamFormat("Verifying function %s:", function->name());
   XLS_VLOG_LINES(4, function->DumpIr());
 
@@ -1463,7 +1497,9 @@ absl::Status VerifyFunctionBase(FunctionBase* function) {
 
   // Verify consistency of node::users() and node::operands().
   for (Node* node : function->nodes()) {
-    XLS_RETURN_IF_ERROR(VerifyNode(node));
+    if (NeedsNodeCheck(node, changed_since)) {
+      XLS_RETURN_IF_ERROR(VerifyNode(node));
+    }
   }
 
   // Verify the set of parameter nodes is exactly Function::params(), and that
@@ -1699,22 +1735,76 @@ absl::Status VerifyChannels(Package* package, bool codegen) {
   return absl::OkStatus();
 }
 
+// Minimum number of nodes in the package per thread used to verify the
+// package. Smaller packages are not worth the cost of starting threads.
+constexpr int64_t kMinNodesPerVerifierThread = 4096;
+
 }  // namespace
 
+static absl::Status VerifyFunctionInternal(
+    Function* function, bool codegen, std::optional<int64_t> changed_since);
+static absl::Status VerifyProcInternal(Proc* proc, bool codegen,
+                                       std::optional<int64_t> changed_since);
+static absl::Status VerifyBlockInternal(Block* block, bool codegen,
+                                        std::optional<int64_t> changed_since);
+
 absl::Status VerifyPackage(Package* package, bool codegen) {
+  return VerifyPackage(package, VerifierOptions{.codegen = codegen});
+}
+
+absl::Status VerifyPackage(Package* package, const VerifierOptions& options) {
   XLS_VLOG(4) << absl::StreamFormat("Verifying package %s:\n", package->name());
   XLS_VLOG_LINES(4, package->DumpIr());
 
-  for (auto& function : package->functions()) {
-    XLS_RETURN_IF_ERROR(VerifyFunction(function.get(), codegen));
-  }
-
-  for (auto& proc : package->procs()) {
-    XLS_RETURN_IF_ERROR(VerifyProc(proc.get(), codegen));
-  }
-
-  for (auto& block : package->blocks()) {
-    XLS_RETURN_IF_ERROR(VerifyBlock(block.get(), codegen));
+  // Functions, procs and blocks are verified independently so they are
+  // distributed over the threads. Each status is kept so the reported error is
+  // that of the first failing function base in package order.
+  std::vector<FunctionBase*> package_function_bases =
+      package->GetFunctionBases();
+  auto verify_function_base = [&](FunctionBase* function_base) {
+    if (function_base->IsFunction()) {
+      return VerifyFunctionInternal(function_base->AsFunctionOrDie(),
+                                    options.codegen, options.changed_since);
+    }
+    if (function_base->IsProc()) {
+      return VerifyProcInternal(function_base->AsProcOrDie(), options.codegen,
+                                options.changed_since);
+    }
+    return VerifyBlockInternal(function_base->AsBlockOrDie(), options.codegen,
+                               options.changed_since);
+  };
+  int64_t thread_count = std::max(
+      int64_t{1},
+      std::min({options.thread_count,
+                package->GetNodeCount() / kMinNodesPerVerifierThread,
+                static_cast<int64_t>(package_function_bases.size())}));
+  if (thread_count == 1) {
+    for (FunctionBase* function_base : package_function_bases) {
+      XLS_RETURN_IF_ERROR(verify_function_base(function_base));
+    }
+  } else {
+    std::vector<absl::Status> statuses(package_function_bases.size());
+    std::atomic<int64_t> next_index = 0;
+    auto run = [&]() {
+      for (int64_t i = next_index++;
+           i < static_cast<int64_t>(package_function_bases.size());
+           i = next_index++) {
+        statuses[i] = verify_function_base(package_function_bases[i]);
+      }
+    };
+    {
+      std::vector<std::unique_ptr<Thread>> threads;
+      for (int64_t i = 1; i < thread_count; ++i) {
+        threads.push_back(std::make_unique<Thread>(run));
+      }
+      run();
+      for (std::unique_ptr<Thread>& thread : threads) {
+        thread->Join();
+      }
+    }
+    for (const absl::Status& status : statuses) {
+      XLS_RETURN_IF_ERROR(status);
+    }
   }
 
   // Verify node IDs are unique within the package and uplinks point to this
@@ -1763,7 +1853,7 @@ absl::Status VerifyPackage(Package* package, bool codegen) {
     function_bases.insert(function_base);
   }
 
-  XLS_RETURN_IF_ERROR(VerifyChannels(package, codegen));
+  XLS_RETURN_IF_ERROR(VerifyChannels(package, options.codegen));
 
   // TODO(meheff): Verify main entry point is one of the functions.
   // TODO(meheff): Verify functions called by any node are in the set of
@@ -1774,10 +1864,16 @@ absl::Status VerifyPackage(Package* package, bool codegen) {
 }
 
 absl::Status VerifyFunction(Function* function, bool codegen) {
+  return VerifyFunctionInternal(function, codegen,
+                                /*changed_since=*/std::nullopt);
+}
+
+static absl::Status VerifyFunctionInternal(
+    Function* function, bool codegen, std::optional<int64_t> changed_since) {
   XLS_VLOG(4) << "Verifying function:\n";
   XLS_VLOG_LINES(4, function->DumpIr());
 
-  XLS_RETURN_IF_ERROR(VerifyFunctionBase(function));
+  XLS_RETURN_IF_ERROR(VerifyFunctionBase(function, changed_since));
 
   for (Node* node : function->nodes()) {
     if (node->Is<Send>() || node->Is<Receive>()) {
@@ -1791,10 +1887,15 @@ absl::Status VerifyFunction(Function* function, bool codegen) {
 }
 
 absl::Status VerifyProc(Proc* proc, bool codegen) {
+  return VerifyProcInternal(proc, codegen, /*changed_since=*/std::nullopt);
+}
+
+static absl::Status VerifyProcInternal(Proc* proc, bool codegen,
+                                       std::optional<int64_t> changed_since) {
   XLS_VLOG(4) << "Verifying proc:\n";
   XLS_VLOG_LINES(4, proc->DumpIr());
 
-  XLS_RETURN_IF_ERROR(VerifyFunctionBase(proc));
+  XLS_RETURN_IF_ERROR(VerifyFunctionBase(proc, changed_since));
 
   // A Proc has a single token parameter and zero or more state paramers.
   XLS_RET_CHECK_EQ(proc->params().size(), proc->GetStateElementCount() + 1);
@@ -2001,11 +2102,65 @@ static absl::Status VerifyExternInstantiation(
   return VerifyForeignFunctionTemplate(fun);
 }
 
+// Verifies invariants of the given FIFO instantiation: every input port of the
+// FIFO is driven exactly once, and no port is connected more than once or with
+// a mismatched type.
+static absl::Status VerifyFifoInstantiation(FifoInstantiation* instantiation,
+                                            Block* instantiating_block) {
+  absl::flat_hash_set<std::string> input_names;
+  for (InstantiationInput* input :
+       instantiating_block->GetInstantiationInputs(instantiation)) {
+    XLS_ASSIGN_OR_RETURN(InstantiationPort port,
+                         instantiation->GetInputPort(input->port_name()));
+    if (!input_names.insert(input->port_name()).second) {
+      return absl::InternalError(absl::StrFormat(
+          "Duplicate instantiation input nodes for port `%s` of FIFO `%s`",
+          input->port_name(), instantiation->name()));
+    }
+    if (input->operand(0)->GetType() != port.type) {
+      return absl::InternalError(absl::StrFormat(
+          "Instantiation input `%s` of FIFO `%s` has type %s, expected %s",
+          input->GetName(), instantiation->name(),
+          input->operand(0)->GetType()->ToString(), port.type->ToString()));
+    }
+  }
+  for (std::string_view name :
+       {FifoInstantiation::kPushDataPortName,
+        FifoInstantiation::kPushValidPortName,
+        FifoInstantiation::kPopReadyPortName,
+        FifoInstantiation::kResetPortName}) {
+    if (!input_names.contains(name)) {
+      return absl::InternalError(absl::StrFormat(
+          "FIFO instantiation `%s` is missing instantiation input for port "
+          "`%s`",
+          instantiation->name(), name));
+    }
+  }
+  absl::flat_hash_set<std::string> output_names;
+  for (InstantiationOutput* output :
+       instantiating_block->GetInstantiationOutputs(instantiation)) {
+    XLS_ASSIGN_OR_RETURN(InstantiationPort port,
+                         instantiation->GetOutputPort(output->port_name()));
+    if (!output_names.insert(output->port_name()).second) {
+      return absl::InternalError(absl::StrFormat(
+          "Duplicate instantiation output nodes for port `%s` of FIFO `%s`",
+          output->port_name(), instantiation->name()));
+    }
+    XLS_RET_CHECK_EQ(output->GetType(), port.type);
+  }
+  return absl::OkStatus();
+}
+
 absl::Status VerifyBlock(Block* block, bool codegen) {
+  return VerifyBlockInternal(block, codegen, /*changed_since=*/std::nullopt);
+}
+
+static absl::Status VerifyBlockInternal(Block* block, bool codegen,
+                                        std::optional<int64_t> changed_since) {
   XLS_VLOG(4) << "Verifying block:\n";
   XLS_VLOG_LINES(4, block->DumpIr());
 
-  XLS_RETURN_IF_ERROR(VerifyFunctionBase(block));
+  XLS_RETURN_IF_ERROR(VerifyFunctionBase(block, changed_since));
 
   // Verify the nodes returned by Block::Get*Port methods are consistent.
   absl::flat_hash_set<Node*> all_data_ports;
@@ -2111,9 +2266,13 @@ absl::Status VerifyBlock(Block* block, bool codegen) {
         XLS_RETURN_IF_ERROR(VerifyExternInstantiation(
             down_cast<ExternInstantiation*>(instantiation)));
         break;
+      case InstantiationKind::kFifo:
+        XLS_RETURN_IF_ERROR(VerifyFifoInstantiation(
+            down_cast<FifoInstantiation*>(instantiation), block));
+        break;
       default:
         XLS_RET_CHECK_FAIL()
-            << "Only block or ffi instantiations are supported: "
+            << "Only block, FIFO or ffi instantiations are supported: "
             << instantiation->ToString();
     }
   }
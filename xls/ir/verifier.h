@@ -15,6 +15,9 @@
 #ifndef XLS_IR_VERIFIER_H_
 #define XLS_IR_VERIFIER_H_
 
+#include <cstdint>
+#include <optional>
+
 #include "absl/status/status.h"
 
 namespace xls {
@@ -25,9 +28,30 @@ class Proc;
 class Block;
 class Package;
 
+// Options controlling package verification.
+struct VerifierOptions {
+  // Whether to verify invariants required by codegen.
+  bool codegen = false;
+
+  // Maximum number of threads used to verify the functions, procs and blocks
+  // of the package. Small packages are verified on the calling thread. Errors
+  // are reported in package order regardless of the number of threads.
+  int64_t thread_count = 1;
+
+  // If set, the per-node checks are only run on nodes which were modified
+  // after this change stamp (see Node::change_stamp) or have a modified
+  // operand, and on nodes which refer to objects outside of the node graph
+  // (called functions, channels, registers and instantiations). The checks of
+  // the functions, procs and blocks as a whole and of the package are always
+  // run. Only meaningful if the package passed verification when the stamp
+  // was taken (obtained from Node::CurrentChangeStamp).
+  std::optional<int64_t> changed_since;
+};
+
 // Verifies numerous invariants of the IR for the given IR construct. Returns a
 // error status if a violation is found.
 absl::Status VerifyPackage(Package* package, bool codegen = false);
+absl::Status VerifyPackage(Package* package, const VerifierOptions& options);
 absl::Status VerifyFunction(Function* function, bool codegen = false);
 absl::Status VerifyProc(Proc* Proc, bool codegen = false);
 absl::Status VerifyBlock(Block* Block, bool codegen = false);
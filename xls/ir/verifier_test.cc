@@ -14,13 +14,18 @@
 
 #include "xls/ir/verifier.h"
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
 #include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
 
 namespace xls {
 namespace {
@@ -535,6 +540,63 @@ fn main(invariant_1: bits[48], invariant_2: bits[64], stride: bits[33], trip_cou
                    "the number of bits of the function body index parameter")));
 }
 
+TEST_F(VerifierTest, IncrementalVerificationSkipsUnchangedNodes) {
+  std::string input = R"(
+package IncrementalVerification
+
+fn graph(p: bits[2], q: bits[42], r: bits[42]) -> bits[42] {
+  ret and.1: bits[42] = and(q, r)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackageNoVerify(input));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("graph"));
+  Node* and_node = FindNode("and.1", f);
+  // Replace lhs of the 'and' with a different bit-width value.
+  and_node->ReplaceOperand(FindNode("q", f), FindNode("p", f));
+  int64_t stamp = Node::CurrentChangeStamp();
+
+  // The malformed node was not modified after the stamp so it is not
+  // rechecked by an incremental verification.
+  XLS_EXPECT_OK(
+      VerifyPackage(p.get(), VerifierOptions{.changed_since = stamp}));
+  EXPECT_THAT(VerifyPackage(p.get()),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Expected operand 0 of and.1")));
+
+  and_node->MarkChanged();
+  EXPECT_THAT(VerifyPackage(p.get(), VerifierOptions{.changed_since = stamp}),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Expected operand 0 of and.1")));
+}
+
+TEST_F(VerifierTest, ParallelVerificationReportsFirstError) {
+  auto p = CreatePackage();
+  std::vector<Function*> functions;
+  for (int64_t i = 0; i < 4; ++i) {
+    FunctionBuilder fb(absl::StrCat("f", i), p.get());
+    BValue narrow = fb.Param("narrow", p->GetBitsType(2));
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    BValue value = x;
+    for (int64_t j = 0; j < 5000; ++j) {
+      value = fb.Not(value);
+    }
+    fb.And(x, value, SourceInfo(), absl::StrCat("and_", i));
+    fb.Tuple({narrow, value});
+    XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+    functions.push_back(f);
+  }
+  XLS_ASSERT_OK(VerifyPackage(p.get(), VerifierOptions{.thread_count = 4}));
+
+  for (int64_t i : {1, 3}) {
+    Function* f = functions[i];
+    FindNode(absl::StrCat("and_", i), f)
+        ->ReplaceOperand(FindNode("x", f), FindNode("narrow", f));
+  }
+  EXPECT_THAT(VerifyPackage(p.get(), VerifierOptions{.thread_count = 4}),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Expected operand 0 of and_1")));
+}
+
 TEST_F(VerifierTest, SimpleBlock) {
   std::string input = R"(
 package test_package
@@ -62,6 +62,13 @@ ABSL_FLAG(
     "is copied verbatim into an #include directive in the generated source "
     "file (the .cc file specified with --output_source). This flag is "
     "required.");
+ABSL_FLAG(std::string, target_cpu, "",
+          "LLVM name of the CPU for which to generate code, e.g. "
+          "\"skylake-avx512\" or \"generic\". If empty, code is generated for "
+          "the host CPU and all of its features.");
+ABSL_FLAG(std::string, target_features, "",
+          "Comma-separated LLVM target features to enable or disable on top of "
+          "those of the target CPU, e.g. \"+avx2,-avx512f\".");
 
 namespace xls {
 namespace {
@@ -97,11 +104,27 @@ absl::StatusOr<std::string> GenerateHeader(
     Package* p, Function* f, const std::vector<std::string>& namespaces) {
   constexpr std::string_view kTemplate =
       R"(// AUTO-GENERATED FILE! DO NOT EDIT!
+#include <cstdint>
+
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/ir/value.h"
+#include "xls/jit/aot_runtime.h"
 
 {{open_ns}}
 absl::StatusOr<xls::Value> {{wrapper_fn_name}}({{wrapper_params}});
+
+// Evaluates `batch_size` samples of {{wrapper_fn_name}} in one call.
+// `inputs[i]` points to `batch_size` consecutive values of parameter i and
+// `output` to space for `batch_size` results, all in the native data layout
+// (see {{wrapper_fn_name}}_batched_function() for their sizes). Samples are
+// split across up to `thread_count` threads.
+absl::Status {{wrapper_fn_name}}_batch(absl::Span<const uint8_t* const> inputs,
+    uint8_t* output, int64_t batch_size, int64_t thread_count = 1);
+
+// Returns the batched entry point of {{wrapper_fn_name}} and its buffer sizes.
+const ::xls::aot_compile::BatchedFunction& {{wrapper_fn_name}}_batched_function();
 {{close_ns}})";
 
   absl::flat_hash_map<std::string, std::string> substitution_map;
@@ -156,12 +179,20 @@ absl::StatusOr<std::string> GenerateWrapperSource(
 #include "xls/jit/aot_runtime.h"
 
 extern "C" {
-void {{extern_fn}}(const uint8_t* const* inputs,
-                   uint8_t* const* outputs,
-                   uint8_t* temp_buffer,
-                   ::xls::InterpreterEvents* events,
-                   void* unused,
-                   int64_t continuation_point);
+int64_t {{extern_fn}}(const uint8_t* const* inputs,
+                      uint8_t* const* outputs,
+                      void* temp_buffer,
+                      ::xls::InterpreterEvents* events,
+                      void* user_data,
+                      void* jit_runtime,
+                      int64_t continuation_point);
+int64_t {{extern_batched_fn}}(const uint8_t* const* inputs,
+                              uint8_t* const* outputs,
+                              void* temp_buffer,
+                              ::xls::InterpreterEvents* events,
+                              void* user_data,
+                              void* jit_runtime,
+                              int64_t batch_size);
 }
 {{open_ns}}
 
@@ -189,11 +220,29 @@ absl::StatusOr<::xls::Value> {{wrapper_fn_name}}({{wrapper_params}}) {
   std::vector<uint8_t> temp_buffers({{temp_buffer_size}});
   ::xls::InterpreterEvents events;
   {{extern_fn}}(arg_buffers, output_buffers, temp_buffers.data(),
-                &events, /*unused=*/nullptr, /*continuation_point=*/0);
+                &events, /*user_data=*/nullptr, /*jit_runtime=*/nullptr,
+                /*continuation_point=*/0);
 
   return GetFunctionTypeLayout().NativeLayoutResultToValue(result_buffer);
 }
 
+const ::xls::aot_compile::BatchedFunction& {{wrapper_fn_name}}_batched_function() {
+  static const ::xls::aot_compile::BatchedFunction* function =
+      new ::xls::aot_compile::BatchedFunction{
+          .function = {{extern_batched_fn}},
+          .arg_sizes = { {{arg_sizes}} },
+          .result_size = {{result_size}},
+          .temp_buffer_size = {{temp_buffer_size}},
+      };
+  return *function;
+}
+
+absl::Status {{wrapper_fn_name}}_batch(absl::Span<const uint8_t* const> inputs,
+    uint8_t* output, int64_t batch_size, int64_t thread_count) {
+  return ::xls::aot_compile::RunBatch({{wrapper_fn_name}}_batched_function(),
+                                      inputs, output, batch_size, thread_count);
+}
+
 {{close_ns}}
 )~";
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit, OrcJit::Create());
@@ -204,6 +253,9 @@ absl::StatusOr<::xls::Value> {{wrapper_fn_name}}({{wrapper_params}}) {
   absl::flat_hash_map<std::string, std::string> substitution_map;
   substitution_map["{{header_path}}"] = header_path;
   substitution_map["{{extern_fn}}"] = object_code.function_name;
+  substitution_map["{{extern_batched_fn}}"] = object_code.batched_function_name;
+  substitution_map["{{arg_sizes}}"] =
+      absl::StrJoin(object_code.parameter_buffer_sizes, ", ");
   substitution_map["{{arg_layouts_proto}}"] =
       ArgLayoutsSerialization(f, type_converter);
   substitution_map["{{result_layout_proto}}"] =
@@ -260,7 +312,8 @@ absl::Status RealMain(const std::string& input_ir_path, std::string top,
                       const std::string& output_header_path,
                       const std::string& output_source_path,
                       const std::string& header_include_path,
-                      const std::vector<std::string>& namespaces) {
+                      const std::vector<std::string>& namespaces,
+                      const JitTargetOptions& target_options) {
   XLS_ASSIGN_OR_RETURN(std::string input_ir, GetFileContents(input_ir_path));
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
                        Parser::ParsePackage(input_ir, input_ir_path));
@@ -273,7 +326,8 @@ absl::Status RealMain(const std::string& input_ir_path, std::string top,
     XLS_ASSIGN_OR_RETURN(f, package->GetFunction(top));
   }
   XLS_ASSIGN_OR_RETURN(JitObjectCode object_code,
-                       FunctionJit::CreateObjectCode(f));
+                       FunctionJit::CreateObjectCode(f, /*opt_level=*/3,
+                                                     target_options));
   XLS_RETURN_IF_ERROR(SetFileContents(
       output_object_path, std::string(object_code.object_code.begin(),
                                       object_code.object_code.end())));
@@ -317,9 +371,13 @@ int main(int argc, char** argv) {
   if (!namespaces_string.empty()) {
     namespaces = absl::StrSplit(namespaces_string, ',');
   }
-  absl::Status status =
-      xls::RealMain(input_ir_path, top, output_object_path, output_header_path,
-                    output_source_path, header_include_path, namespaces);
+  xls::JitTargetOptions target_options{
+      .cpu = absl::GetFlag(FLAGS_target_cpu),
+      .features = absl::GetFlag(FLAGS_target_features),
+  };
+  absl::Status status = xls::RealMain(
+      input_ir_path, top, output_object_path, output_header_path,
+      output_source_path, header_include_path, namespaces, target_options);
   if (!status.ok()) {
     std::cout << status.message();
     return 1;
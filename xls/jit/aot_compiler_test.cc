@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
@@ -71,6 +74,53 @@ TEST(AotCompileTest, CompoundType) {
   EXPECT_EQ(result, Value::Tuple({b, Value(UBits(43, 32)), c}));
 }
 
+// Native data layout of a (bits[1], bits[8], bits[23]) tuple.
+struct NativeF32 {
+  uint8_t sign;
+  uint8_t exp;
+  uint32_t frac;
+};
+
+TEST(AotCompileTest, BatchedUsage) {
+  const xls::aot_compile::BatchedFunction& batched =
+      xls::fp::add_batched_function();
+  constexpr int64_t kNativeF32Size = sizeof(NativeF32);
+  EXPECT_THAT(batched.arg_sizes,
+              testing::ElementsAre(kNativeF32Size, kNativeF32Size));
+  EXPECT_EQ(batched.result_size, kNativeF32Size);
+
+  constexpr int64_t kBatchSize = 1000;
+  std::vector<NativeF32> lhs;
+  std::vector<NativeF32> rhs;
+  for (int64_t i = 0; i < kBatchSize; ++i) {
+    lhs.push_back(
+        NativeF32{.sign = 0,
+                  .exp = static_cast<uint8_t>(0x70 + i % 16),
+                  .frac = static_cast<uint32_t>(i * 4099 % 0x800000)});
+    rhs.push_back(NativeF32{.sign = static_cast<uint8_t>(i % 2),
+                            .exp = static_cast<uint8_t>(0x78 + i % 8),
+                            .frac = static_cast<uint32_t>(i * 31 % 0x800000)});
+  }
+  const uint8_t* inputs[] = {reinterpret_cast<const uint8_t*>(lhs.data()),
+                             reinterpret_cast<const uint8_t*>(rhs.data())};
+
+  for (int64_t thread_count : {1, 4}) {
+    std::vector<NativeF32> results(kBatchSize);
+    XLS_ASSERT_OK(xls::fp::add_batch(inputs,
+                                     reinterpret_cast<uint8_t*>(results.data()),
+                                     kBatchSize, thread_count));
+    for (int64_t i = 0; i < kBatchSize; ++i) {
+      XLS_ASSERT_OK_AND_ASSIGN(
+          Value expected,
+          xls::fp::add(F32Value(lhs[i].sign, lhs[i].exp, lhs[i].frac),
+                       F32Value(rhs[i].sign, rhs[i].exp, rhs[i].frac)));
+      EXPECT_EQ(F32Value(results[i].sign, results[i].exp, results[i].frac),
+                expected)
+          << "sample " << i << " with " << thread_count << " threads";
+    }
+  }
+}
+
 #ifndef NDEBUG
 // In non-opt mode, argument values are type-checked using DCHECK.
 TEST(AotCompileTest, InvalidTypes) {
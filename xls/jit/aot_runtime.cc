@@ -13,6 +13,8 @@
 // limitations under the License.
 #include "xls/jit/aot_runtime.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -20,7 +22,9 @@
 #include <vector>
 
 #include "google/protobuf/text_format.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 
 namespace xls::aot_compile {
 
@@ -56,4 +60,47 @@ FunctionTypeLayout::Create(std::string_view serialized_arg_layouts,
                                                  std::move(result_layout)));
 }
 
+absl::Status RunBatch(const BatchedFunction& function,
+                      absl::Span<const uint8_t* const> inputs, uint8_t* output,
+                      int64_t batch_size, int64_t thread_count) {
+  XLS_RET_CHECK_EQ(inputs.size(), function.arg_sizes.size());
+  XLS_RET_CHECK_GE(batch_size, 0);
+  XLS_RET_CHECK_GE(thread_count, 1);
+  if (batch_size == 0) {
+    return absl::OkStatus();
+  }
+
+  int64_t chunk_count = std::min(thread_count, batch_size);
+  std::vector<InterpreterEvents> events(chunk_count);
+  auto run_chunk = [&](int64_t chunk) {
+    int64_t start = batch_size * chunk / chunk_count;
+    int64_t end = batch_size * (chunk + 1) / chunk_count;
+    std::vector<const uint8_t*> chunk_inputs(inputs.size());
+    for (int64_t i = 0; i < inputs.size(); ++i) {
+      chunk_inputs[i] = inputs[i] + start * function.arg_sizes[i];
+    }
+    uint8_t* chunk_outputs[1] = {output + start * function.result_size};
+    std::vector<uint8_t> temp_buffer(function.temp_buffer_size);
+    function.function(chunk_inputs.data(), chunk_outputs, temp_buffer.data(),
+                      &events[chunk], /*user_data=*/nullptr,
+                      /*jit_runtime=*/nullptr, /*batch_size=*/end - start);
+  };
+
+  // The calling thread evaluates the first range.
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t chunk = 1; chunk < chunk_count; ++chunk) {
+    threads.push_back(
+        std::make_unique<Thread>([&run_chunk, chunk]() { run_chunk(chunk); }));
+  }
+  run_chunk(0);
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
+  for (const InterpreterEvents& chunk_events : events) {
+    XLS_RETURN_IF_ERROR(InterpreterEventsToStatus(chunk_events));
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace xls::aot_compile
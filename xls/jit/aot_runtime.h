@@ -18,13 +18,16 @@
 #ifndef XLS_JIT_AOT_RUNTIME_H_
 #define XLS_JIT_AOT_RUNTIME_H_
 
+#include <cstdint>
 #include <memory>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/ir/events.h"
 #include "xls/ir/package.h"
 #include "xls/jit/type_layout.h"
 #include "xls/jit/type_layout.pb.h"
@@ -74,6 +77,37 @@ class FunctionTypeLayout {
   TypeLayout result_layout_;
 };
 
+// Signature of the entry points of AOT-compiled functions. This matches
+// JitFunctionType except that the runtime is opaque. For the batched entry
+// point the final argument is the number of samples in the batch rather than a
+// continuation point.
+using AotEntryPoint = int64_t (*)(const uint8_t* const* inputs,
+                                  uint8_t* const* outputs, void* temp_buffer,
+                                  InterpreterEvents* events, void* user_data,
+                                  void* jit_runtime,
+                                  int64_t continuation_point);
+
+// The batched entry point of an AOT-compiled function along with the sizes of
+// its buffers in the native data layout.
+struct BatchedFunction {
+  AotEntryPoint function;
+  // Size in bytes of a single sample of each argument and of the result.
+  std::vector<int64_t> arg_sizes;
+  int64_t result_size;
+  // Size of the temporary buffer needed by each concurrent invocation.
+  int64_t temp_buffer_size;
+};
+
+// Evaluates `batch_size` samples of `function` stored structure-of-arrays in
+// the native data layout: `inputs[i]` points to `batch_size` consecutive values
+// of argument i, and `batch_size` consecutive results are written to `output`.
+// The batch is split into up to `thread_count` contiguous ranges which are
+// evaluated concurrently, each with its own temporary buffer. Returns an error
+// if an assertion fails for any sample.
+absl::Status RunBatch(const BatchedFunction& function,
+                      absl::Span<const uint8_t* const> inputs, uint8_t* output,
+                      int64_t batch_size, int64_t thread_count = 1);
+
 }  // namespace xls::aot_compile
 
 #endif  // XLS_JIT_AOT_RUNTIME_H_
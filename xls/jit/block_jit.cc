@@ -0,0 +1,251 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/block_jit.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/block_interpreter.h"
+#include "xls/ir/block.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/register.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_helpers.h"
+#include "xls/jit/function_base_jit.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/orc_jit.h"
+
+namespace xls {
+
+BlockJitContinuation::BlockJitContinuation(Block* block,
+                                           const JittedFunctionBase& function,
+                                           JitRuntime* jit_runtime)
+    : block_(block), jit_runtime_(jit_runtime) {
+  // Buffers are zero-initialized so all registers start at zero.
+  for (int64_t size : function.input_buffer_sizes) {
+    input_buffers_.push_back(std::vector<uint8_t>(size));
+    input_ptrs_.push_back(input_buffers_.back().data());
+  }
+  for (int64_t size : function.output_buffer_sizes) {
+    output_buffers_.push_back(std::vector<uint8_t>(size));
+    output_ptrs_.push_back(output_buffers_.back().data());
+  }
+  temp_buffer_.resize(function.temp_buffer_size);
+}
+
+absl::Status BlockJitContinuation::SetInputPorts(
+    absl::Span<const Value> values) {
+  absl::Span<InputPort* const> ports = block_->GetInputPorts();
+  XLS_RET_CHECK_EQ(values.size(), ports.size());
+  for (int64_t i = 0; i < ports.size(); ++i) {
+    if (!ValueConformsToType(values[i], ports[i]->GetType())) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Value %s for input port '%s' does not match port type %s",
+          values[i].ToString(), ports[i]->GetName(),
+          ports[i]->GetType()->ToString()));
+    }
+    jit_runtime_->BlitValueToBuffer(values[i], ports[i]->GetType(),
+                                    absl::MakeSpan(input_buffers_[i]));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status BlockJitContinuation::SetInputPorts(
+    const absl::flat_hash_map<std::string, Value>& inputs) {
+  std::vector<Value> values;
+  for (InputPort* port : block_->GetInputPorts()) {
+    auto it = inputs.find(port->GetName());
+    if (it == inputs.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Missing input for port '%s'", port->GetName()));
+    }
+    values.push_back(it->second);
+  }
+  return SetInputPorts(values);
+}
+
+absl::Status BlockJitContinuation::SetRegisters(
+    const absl::flat_hash_map<std::string, Value>& regs) {
+  int64_t index = block_->GetInputPorts().size();
+  for (Register* reg : block_->GetRegisters()) {
+    auto it = regs.find(reg->name());
+    if (it == regs.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Missing value for register '%s'", reg->name()));
+    }
+    if (!ValueConformsToType(it->second, reg->type())) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Value %s for register '%s' does not match register type %s",
+          it->second.ToString(), reg->name(), reg->type()->ToString()));
+    }
+    jit_runtime_->BlitValueToBuffer(it->second, reg->type(),
+                                    absl::MakeSpan(input_buffers_[index]));
+    ++index;
+  }
+  return absl::OkStatus();
+}
+
+std::vector<Value> BlockJitContinuation::GetOutputPorts() const {
+  std::vector<Value> outputs;
+  absl::Span<OutputPort* const> ports = block_->GetOutputPorts();
+  for (int64_t i = 0; i < ports.size(); ++i) {
+    outputs.push_back(jit_runtime_->UnpackBuffer(
+        output_ptrs_[i], ports[i]->operand(0)->GetType(), /*unpoison=*/true));
+  }
+  return outputs;
+}
+
+absl::flat_hash_map<std::string, Value>
+BlockJitContinuation::GetOutputPortsMap() const {
+  absl::flat_hash_map<std::string, Value> outputs;
+  std::vector<Value> values = GetOutputPorts();
+  absl::Span<OutputPort* const> ports = block_->GetOutputPorts();
+  for (int64_t i = 0; i < ports.size(); ++i) {
+    outputs[ports[i]->GetName()] = std::move(values[i]);
+  }
+  return outputs;
+}
+
+absl::flat_hash_map<std::string, Value> BlockJitContinuation::GetRegistersMap()
+    const {
+  absl::flat_hash_map<std::string, Value> regs;
+  int64_t index = block_->GetInputPorts().size();
+  for (Register* reg : block_->GetRegisters()) {
+    regs[reg->name()] = jit_runtime_->UnpackBuffer(
+        input_ptrs_[index], reg->type(), /*unpoison=*/true);
+    ++index;
+  }
+  return regs;
+}
+
+absl::StatusOr<std::unique_ptr<BlockJit>> BlockJit::Create(Block* block) {
+  auto jit = absl::WrapUnique(new BlockJit(block));
+  XLS_ASSIGN_OR_RETURN(jit->orc_jit_, OrcJit::Create());
+  XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout,
+                       OrcJit::CreateDataLayout());
+  jit->jit_runtime_ = std::make_unique<JitRuntime>(data_layout);
+  XLS_ASSIGN_OR_RETURN(jit->jitted_function_base_,
+                       BuildBlockFunction(block, *jit->orc_jit_));
+
+  // Record where the register values and register write operands live among
+  // the inputs and outputs of the jitted function. See BuildBlockFunction for
+  // the layout.
+  int64_t input_index = block->GetInputPorts().size();
+  int64_t output_index = block->GetOutputPorts().size();
+  for (Register* reg : block->GetRegisters()) {
+    XLS_ASSIGN_OR_RETURN(RegisterWrite * reg_write,
+                         block->GetRegisterWrite(reg));
+    RegisterInfo info{.size = jit->jit_runtime_->GetTypeByteSize(reg->type()),
+                      .input_index = input_index++,
+                      .data_index = output_index++};
+    if (reg_write->load_enable().has_value()) {
+      info.load_enable_index = output_index++;
+    }
+    if (reg_write->reset().has_value()) {
+      XLS_RET_CHECK(reg->reset().has_value()) << reg->name();
+      info.reset_index = output_index++;
+      info.reset_active_low = reg->reset()->active_low;
+      info.reset_value.resize(info.size);
+      jit->jit_runtime_->BlitValueToBuffer(reg->reset()->reset_value,
+                                           reg->type(),
+                                           absl::MakeSpan(info.reset_value));
+    }
+    jit->registers_.push_back(std::move(info));
+  }
+  XLS_RET_CHECK_EQ(input_index,
+                   jit->jitted_function_base_.input_buffer_sizes.size());
+  XLS_RET_CHECK_EQ(output_index,
+                   jit->jitted_function_base_.output_buffer_sizes.size());
+  return jit;
+}
+
+std::unique_ptr<BlockJitContinuation> BlockJit::NewContinuation() const {
+  return absl::WrapUnique(new BlockJitContinuation(
+      block_, jitted_function_base_, jit_runtime_.get()));
+}
+
+absl::Status BlockJit::RunOneCycle(BlockJitContinuation& continuation) const {
+  XLS_RET_CHECK_EQ(continuation.block_, block_);
+  // Blocks contain no blocking operations so the function always runs to
+  // completion.
+  int64_t continuation_point = jitted_function_base_.function(
+      continuation.input_ptrs_.data(), continuation.output_ptrs_.data(),
+      continuation.temp_buffer_.data(), &continuation.events_,
+      /*user_data=*/nullptr, runtime(), /*continuation_point=*/0);
+  XLS_RET_CHECK_EQ(continuation_point, 0);
+
+  // Clock the registers. Single-bit values occupy one byte in native layout.
+  for (const RegisterInfo& reg : registers_) {
+    if (reg.reset_index.has_value()) {
+      bool reset_signal =
+          (continuation.output_ptrs_[*reg.reset_index][0] & 1) != 0;
+      if (reset_signal != reg.reset_active_low) {
+        std::memcpy(continuation.input_ptrs_[reg.input_index],
+                    reg.reset_value.data(), reg.size);
+        continue;
+      }
+    }
+    if (reg.load_enable_index.has_value() &&
+        (continuation.output_ptrs_[*reg.load_enable_index][0] & 1) == 0) {
+      // Load enable is not asserted; the register keeps its value.
+      continue;
+    }
+    std::memcpy(continuation.input_ptrs_[reg.input_index],
+                continuation.output_ptrs_[reg.data_index], reg.size);
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<BlockRunResult> JitBlockRun(
+    const absl::flat_hash_map<std::string, Value>& inputs,
+    const absl::flat_hash_map<std::string, Value>& reg_state,
+    const BlockJit& jit) {
+  std::unique_ptr<BlockJitContinuation> continuation = jit.NewContinuation();
+  XLS_RETURN_IF_ERROR(continuation->SetInputPorts(inputs));
+  XLS_RETURN_IF_ERROR(continuation->SetRegisters(reg_state));
+  XLS_RETURN_IF_ERROR(jit.RunOneCycle(*continuation));
+  return BlockRunResult{
+      .outputs = continuation->GetOutputPortsMap(),
+      .reg_state = continuation->GetRegistersMap(),
+      .interpreter_events = std::move(continuation->GetEvents())};
+}
+
+absl::StatusOr<std::vector<absl::flat_hash_map<std::string, Value>>>
+JitSequentialBlock(
+    const BlockJit& jit,
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs) {
+  std::unique_ptr<BlockJitContinuation> continuation = jit.NewContinuation();
+  std::vector<absl::flat_hash_map<std::string, Value>> outputs;
+  for (const absl::flat_hash_map<std::string, Value>& input_set : inputs) {
+    XLS_RETURN_IF_ERROR(continuation->SetInputPorts(input_set));
+    XLS_RETURN_IF_ERROR(jit.RunOneCycle(*continuation));
+    outputs.push_back(continuation->GetOutputPortsMap());
+  }
+  return outputs;
+}
+
+}  // namespace xls
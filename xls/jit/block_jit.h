@@ -0,0 +1,150 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_BLOCK_JIT_H_
+#define XLS_JIT_BLOCK_JIT_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/interpreter/block_interpreter.h"
+#include "xls/ir/block.h"
+#include "xls/ir/events.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_base_jit.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/orc_jit.h"
+
+namespace xls {
+
+class BlockJit;
+
+// The state of a block evaluated by the BlockJit: the values driven on the
+// input ports, the current register values, and the output port values
+// computed in the most recent cycle. All values are held in native layout so
+// consecutive cycles require no conversion to or from xls::Values.
+class BlockJitContinuation {
+ public:
+  // Sets the values driven on the input ports, either in the order of
+  // Block::GetInputPorts or by port name. Inputs persist across cycles until
+  // overwritten.
+  absl::Status SetInputPorts(absl::Span<const Value> values);
+  absl::Status SetInputPorts(
+      const absl::flat_hash_map<std::string, Value>& inputs);
+
+  // Overwrites the register values. `regs` must contain a value for every
+  // register in the block.
+  absl::Status SetRegisters(
+      const absl::flat_hash_map<std::string, Value>& regs);
+
+  // Returns the output port values computed in the most recent cycle, either in
+  // the order of Block::GetOutputPorts or keyed by port name.
+  std::vector<Value> GetOutputPorts() const;
+  absl::flat_hash_map<std::string, Value> GetOutputPortsMap() const;
+
+  // Returns the current register values keyed by register name.
+  absl::flat_hash_map<std::string, Value> GetRegistersMap() const;
+
+  const InterpreterEvents& GetEvents() const { return events_; }
+  InterpreterEvents& GetEvents() { return events_; }
+  void ClearEvents() { events_.Clear(); }
+
+ private:
+  friend class BlockJit;
+
+  // Registers are initialized to zero.
+  BlockJitContinuation(Block* block, const JittedFunctionBase& function,
+                       JitRuntime* jit_runtime);
+
+  Block* block_;
+  JitRuntime* jit_runtime_;
+  InterpreterEvents events_;
+
+  // Buffers holding the inputs (input ports then registers), outputs (output
+  // ports then register write operands) and temporary values of the jitted
+  // function.
+  std::vector<std::vector<uint8_t>> input_buffers_;
+  std::vector<std::vector<uint8_t>> output_buffers_;
+  std::vector<uint8_t*> input_ptrs_;
+  std::vector<uint8_t*> output_ptrs_;
+  std::vector<uint8_t> temp_buffer_;
+};
+
+// This class provides a facility to evaluate XLS blocks cycle by cycle (on the
+// host) by compiling the combinational logic of the block into a native
+// function. Each call to RunOneCycle evaluates the block's logic from the
+// current input port and register values and then clocks the registers.
+// Blocks with instantiations are not supported.
+class BlockJit {
+ public:
+  static absl::StatusOr<std::unique_ptr<BlockJit>> Create(Block* block);
+
+  // Returns a new continuation with all registers set to zero.
+  std::unique_ptr<BlockJitContinuation> NewContinuation() const;
+
+  // Evaluates one clock cycle of the block: computes the output port values
+  // and next register values, then updates the registers.
+  absl::Status RunOneCycle(BlockJitContinuation& continuation) const;
+
+  Block* block() const { return block_; }
+  JitRuntime* runtime() const { return jit_runtime_.get(); }
+
+ private:
+  // Indices of the jitted function inputs/outputs associated with a register.
+  struct RegisterInfo {
+    int64_t size;
+    int64_t input_index;
+    int64_t data_index;
+    std::optional<int64_t> load_enable_index;
+    std::optional<int64_t> reset_index;
+    bool reset_active_low = false;
+    // The reset value in native layout.
+    std::vector<uint8_t> reset_value;
+  };
+
+  explicit BlockJit(Block* block) : block_(block) {}
+
+  Block* block_;
+  std::unique_ptr<OrcJit> orc_jit_;
+  std::unique_ptr<JitRuntime> jit_runtime_;
+  JittedFunctionBase jitted_function_base_;
+  std::vector<RegisterInfo> registers_;
+};
+
+// Runs a single cycle of the jitted block with the given register values and
+// input values. Equivalent to BlockRun.
+absl::StatusOr<BlockRunResult> JitBlockRun(
+    const absl::flat_hash_map<std::string, Value>& inputs,
+    const absl::flat_hash_map<std::string, Value>& reg_state,
+    const BlockJit& jit);
+
+// Runs the jitted block on a sequence of input values, returning the output
+// port values for each cycle. Registers are clocked between each set of inputs
+// and are initially zero. Equivalent to InterpretSequentialBlock.
+absl::StatusOr<std::vector<absl::flat_hash_map<std::string, Value>>>
+JitSequentialBlock(
+    const BlockJit& jit,
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs);
+
+}  // namespace xls
+
+#endif  // XLS_JIT_BLOCK_JIT_H_
@@ -0,0 +1,194 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/block_jit.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/block_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using testing::HasSubstr;
+using testing::Pair;
+using testing::UnorderedElementsAre;
+
+class BlockJitTest : public IrTestBase {
+ protected:
+  // Runs `block` over `inputs` with both the JIT and the interpreter and
+  // checks that the outputs agree.
+  void ExpectJitMatchesInterpreter(
+      Block* block,
+      absl::Span<const absl::flat_hash_map<std::string, Value>> inputs) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                             BlockJit::Create(block));
+    XLS_ASSERT_OK_AND_ASSIGN(auto jit_outputs,
+                             JitSequentialBlock(*jit, inputs));
+    XLS_ASSERT_OK_AND_ASSIGN(auto interpreter_outputs,
+                             InterpretSequentialBlock(block, inputs));
+    EXPECT_EQ(jit_outputs, interpreter_outputs);
+  }
+};
+
+TEST_F(BlockJitTest, PipelinedAdder) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue y = b.InputPort("y", package->GetBitsType(32));
+  BValue x_d = b.InsertRegister("x_d", x);
+  BValue y_d = b.InsertRegister("y_d", y);
+  BValue x_plus_y_d = b.InsertRegister("x_plus_y_d", b.Add(x_d, y_d));
+  b.OutputPort("out", x_plus_y_d);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  std::vector<absl::flat_hash_map<std::string, Value>> inputs;
+  for (int64_t i = 0; i < 8; ++i) {
+    inputs.push_back(
+        {{"x", Value(UBits(i, 32))}, {"y", Value(UBits(100 * i, 32))}});
+  }
+  ExpectJitMatchesInterpreter(block, inputs);
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  XLS_ASSERT_OK_AND_ASSIGN(auto outputs, JitSequentialBlock(*jit, inputs));
+  ASSERT_EQ(outputs.size(), 8);
+  EXPECT_THAT(outputs.at(0),
+              UnorderedElementsAre(Pair("out", Value(UBits(0, 32)))));
+  EXPECT_THAT(outputs.at(3),
+              UnorderedElementsAre(Pair("out", Value(UBits(101, 32)))));
+}
+
+TEST_F(BlockJitTest, RegisterWithReset) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue rst = b.InputPort("rst", package->GetBitsType(1));
+  BValue x_d =
+      b.InsertRegister("x_d", x, rst,
+                       Reset{Value(UBits(42, 32)), /*asynchronous=*/false,
+                             /*active_low=*/false});
+  BValue rst_n = b.InputPort("rst_n", package->GetBitsType(1));
+  BValue y_d =
+      b.InsertRegister("y_d", x, rst_n,
+                       Reset{Value(UBits(7, 32)), /*asynchronous=*/false,
+                             /*active_low=*/true});
+  b.OutputPort("out", x_d);
+  b.OutputPort("out_n", y_d);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  std::vector<absl::flat_hash_map<std::string, Value>> inputs;
+  for (int64_t i = 0; i < 6; ++i) {
+    inputs.push_back({{"x", Value(UBits(i + 1, 32))},
+                      {"rst", Value(UBits(i == 1 || i == 2, 1))},
+                      {"rst_n", Value(UBits(i != 3, 1))}});
+  }
+  ExpectJitMatchesInterpreter(block, inputs);
+}
+
+TEST_F(BlockJitTest, RegisterWithLoadEnable) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue le = b.InputPort("le", package->GetBitsType(1));
+  BValue x_d = b.InsertRegister("x_d", x, le);
+  b.OutputPort("out", x_d);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  std::vector<absl::flat_hash_map<std::string, Value>> inputs;
+  for (int64_t i = 0; i < 6; ++i) {
+    inputs.push_back(
+        {{"x", Value(UBits(i + 1, 32))}, {"le", Value(UBits(i % 2, 1))}});
+  }
+  ExpectJitMatchesInterpreter(block, inputs);
+}
+
+TEST_F(BlockJitTest, SingleCycleRun) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+
+  BValue x = b.InputPort("x", package->GetBitsType(8));
+  BValue acc = b.InsertRegister("acc", x);
+  b.OutputPort("out", b.Add(acc, x));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  absl::flat_hash_map<std::string, Value> inputs = {{"x", Value(UBits(3, 8))}};
+  absl::flat_hash_map<std::string, Value> regs = {
+      {"acc", Value(UBits(10, 8))}};
+  XLS_ASSERT_OK_AND_ASSIGN(BlockRunResult result,
+                           JitBlockRun(inputs, regs, *jit));
+  XLS_ASSERT_OK_AND_ASSIGN(BlockRunResult expected,
+                           BlockRun(inputs, regs, block));
+  EXPECT_EQ(result.outputs, expected.outputs);
+  EXPECT_EQ(result.reg_state, expected.reg_state);
+  EXPECT_THAT(result.outputs,
+              UnorderedElementsAre(Pair("out", Value(UBits(13, 8)))));
+  EXPECT_THAT(result.reg_state,
+              UnorderedElementsAre(Pair("acc", Value(UBits(3, 8)))));
+}
+
+TEST_F(BlockJitTest, MissingInputPort) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  b.OutputPort("out", b.InputPort("x", package->GetBitsType(8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  std::unique_ptr<BlockJitContinuation> continuation = jit->NewContinuation();
+  EXPECT_THAT(continuation->SetInputPorts(
+                  absl::flat_hash_map<std::string, Value>()),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Missing input for port 'x'")));
+}
+
+TEST_F(BlockJitTest, InstantiationsUnsupported) {
+  auto package = CreatePackage();
+  BlockBuilder sub_builder("sub", package.get());
+  XLS_ASSERT_OK_AND_ASSIGN(Block * sub, sub_builder.Build());
+
+  BlockBuilder b(TestName(), package.get());
+  b.OutputPort("out", b.InputPort("x", package->GetBitsType(8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+  XLS_ASSERT_OK(block->AddBlockInstantiation("inst", sub).status());
+
+  EXPECT_THAT(BlockJit::Create(block),
+              StatusIs(absl::StatusCode::kUnimplemented));
+}
+
+}  // namespace
+}  // namespace xls
@@ -14,6 +14,8 @@
 #include "xls/jit/function_base_jit.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <memory>
 #include <optional>
@@ -22,7 +24,10 @@
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
 #include "llvm/include/llvm/IR/Constants.h"
 #include "llvm/include/llvm/IR/DerivedTypes.h"
 #include "llvm/include/llvm/IR/Function.h"
@@ -30,10 +35,14 @@
 #include "llvm/include/llvm/IR/Type.h"
 #include "llvm/include/llvm/IR/Value.h"
 #include "xls/common/logging/logging.h"
+#include "xls/ir/block.h"
 #include "xls/ir/call_graph.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/register.h"
 #include "xls/jit/ir_builder_visitor.h"
 #include "xls/jit/llvm_type_converter.h"
 
@@ -651,6 +660,17 @@ absl::Status AllocateBuffers(absl::Span<const Partition> partitions,
 // Returns the nodes which comprise the inputs to a jitted function implementing
 // `function_base`. These nodes are passed in via the `inputs` argument.
 std::vector<Node*> GetJittedFunctionInputs(FunctionBase* function_base) {
+  if (function_base->IsBlock()) {
+    // The inputs of a block are its input ports followed by the current values
+    // of its registers.
+    Block* block = function_base->AsBlockOrDie();
+    std::vector<Node*> inputs(block->GetInputPorts().begin(),
+                              block->GetInputPorts().end());
+    for (Register* reg : block->GetRegisters()) {
+      inputs.push_back(block->GetRegisterRead(reg).value());
+    }
+    return inputs;
+  }
   std::vector<Node*> inputs(function_base->params().begin(),
                             function_base->params().end());
   return inputs;
@@ -664,6 +684,28 @@ std::vector<Node*> GetJittedFunctionOutputs(FunctionBase* function_base) {
     Function* f = function_base->AsFunctionOrDie();
     return {f->return_value()};
   }
+  if (function_base->IsBlock()) {
+    // The outputs of a block are the values driven on its output ports followed
+    // by, for each register, the data, load enable (if any), and reset (if
+    // any) operands of the register write. The register update itself is
+    // performed by the caller.
+    Block* block = function_base->AsBlockOrDie();
+    std::vector<Node*> outputs;
+    for (OutputPort* output_port : block->GetOutputPorts()) {
+      outputs.push_back(output_port->operand(0));
+    }
+    for (Register* reg : block->GetRegisters()) {
+      RegisterWrite* reg_write = block->GetRegisterWrite(reg).value();
+      outputs.push_back(reg_write->data());
+      if (reg_write->load_enable().has_value()) {
+        outputs.push_back(reg_write->load_enable().value());
+      }
+      if (reg_write->reset().has_value()) {
+        outputs.push_back(reg_write->reset().value());
+      }
+    }
+    return outputs;
+  }
   XLS_CHECK(function_base->IsProc());
   // The outputs of a proc are the next state values.
   Proc* proc = function_base->AsProcOrDie();
@@ -1144,11 +1186,163 @@ absl::StatusOr<llvm::Function*> BuildPackedWrapper(
   return wrapper.function();
 }
 
+// Builds a wrapper around the jitted function `callee` which evaluates the
+// function over a batch of samples in a single call. Each pointer in the
+// `inputs` (`outputs`) array points to a contiguous array of samples of the
+// corresponding input (output) in native LLVM data layout (i.e., the batch is
+// stored structure-of-arrays with one array per input). The extra argument is
+// the number of samples in the batch. The loop over samples is emitted in LLVM
+// so the callee may be inlined into the loop body and optimized across
+// iterations.
+//
+// If `lane_temp_buffer_size` is set, each sample is an independent instance
+// (lane) of a proc which may be interrupted mid-tick: the temporary buffer
+// holds a `lane_temp_buffer_size` byte buffer for each lane, and the user data
+// argument points to an array of ProcLaneContext. The lane's queue table is
+// passed to the callee as its user data and the lane's continuation point is
+// updated with the point at which the lane's execution stopped.
+absl::StatusOr<llvm::Function*> BuildBatchedWrapper(
+    FunctionBase* xls_function, llvm::Function* callee,
+    JitBuilderContext& jit_context,
+    std::optional<int64_t> lane_temp_buffer_size = std::nullopt) {
+  llvm::LLVMContext* context = &jit_context.context();
+  llvm::Type* i64 = llvm::Type::getInt64Ty(*context);
+  llvm::Type* ptr_type = llvm::PointerType::get(*context, 0);
+  std::vector<Node*> inputs = GetJittedFunctionInputs(xls_function);
+  std::vector<Node*> outputs = GetJittedFunctionOutputs(xls_function);
+  LlvmFunctionWrapper wrapper = LlvmFunctionWrapper::Create(
+      absl::StrFormat("%s_batched", xls_function->name()), inputs, outputs,
+      i64, jit_context,
+      LlvmFunctionWrapper::FunctionArg{.name = "batch_size", .type = i64});
+  llvm::IRBuilder<>& entry_builder = wrapper.entry_builder();
+
+  // Arrays of pointers to the individual sample buffers passed to the callee
+  // on each iteration of the loop.
+  llvm::Value* input_arg_array =
+      entry_builder.CreateAlloca(llvm::ArrayType::get(ptr_type, inputs.size()));
+  llvm::Value* output_arg_array = entry_builder.CreateAlloca(
+      llvm::ArrayType::get(ptr_type, outputs.size()));
+
+  // The base pointers of the sample arrays are loop invariant so load them
+  // once in the entry block.
+  std::vector<llvm::Value*> input_bases;
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    input_bases.push_back(
+        LoadPointerFromPointerArray(i, wrapper.GetInputsArg(), &entry_builder));
+  }
+  std::vector<llvm::Value*> output_bases;
+  for (int64_t i = 0; i < outputs.size(); ++i) {
+    output_bases.push_back(LoadPointerFromPointerArray(
+        i, wrapper.GetOutputsArg(), &entry_builder));
+  }
+
+  // Loop structure:
+  //
+  //   preheader:
+  //     index = phi(0, next_index)
+  //     cond = eq(index, batch_size)
+  //     br(cond, exit, loop)
+  //   loop:
+  //     <call callee on sample `index`>
+  //     next_index = index + 1
+  //     br(preheader)
+  //   exit:
+  //     ret 0
+  llvm::Function* function = wrapper.function();
+  llvm::BasicBlock* entry_block = entry_builder.GetInsertBlock();
+  llvm::BasicBlock* preheader_block =
+      llvm::BasicBlock::Create(*context, "preheader", function);
+  llvm::BasicBlock* loop_block =
+      llvm::BasicBlock::Create(*context, "loop", function);
+  llvm::BasicBlock* exit_block =
+      llvm::BasicBlock::Create(*context, "exit", function);
+  entry_builder.CreateBr(preheader_block);
+
+  llvm::IRBuilder<> preheader_builder(preheader_block);
+  llvm::PHINode* index = preheader_builder.CreatePHI(i64, 2);
+  index->setName("index");
+  index->addIncoming(preheader_builder.getInt64(0), entry_block);
+  llvm::Value* loop_done =
+      preheader_builder.CreateICmpEQ(index, wrapper.GetExtraArg().value());
+  loop_done->setName("loop_done");
+  preheader_builder.CreateCondBr(loop_done, exit_block, loop_block);
+
+  llvm::IRBuilder<> loop_builder(loop_block);
+  llvm::Type* pointer_array_type =
+      llvm::ArrayType::get(llvm::Type::getInt8PtrTy(*context), 0);
+  auto store_sample_pointers = [&](absl::Span<Node* const> nodes,
+                                   absl::Span<llvm::Value* const> bases,
+                                   llvm::Value* pointer_array) {
+    for (int64_t i = 0; i < nodes.size(); ++i) {
+      int64_t stride =
+          jit_context.type_converter().GetTypeByteSize(nodes[i]->GetType());
+      llvm::Value* sample_buffer = loop_builder.CreateGEP(
+          llvm::Type::getInt8Ty(*context), bases[i],
+          loop_builder.CreateMul(index, loop_builder.getInt64(stride)));
+      llvm::Value* gep = loop_builder.CreateGEP(
+          pointer_array_type, pointer_array,
+          {
+              llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), 0),
+              llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), i),
+          });
+      loop_builder.CreateStore(sample_buffer, gep);
+    }
+  };
+  store_sample_pointers(inputs, input_bases, input_arg_array);
+  store_sample_pointers(outputs, output_bases, output_arg_array);
+
+  std::vector<llvm::Value*> args;
+  args.push_back(input_arg_array);
+  args.push_back(output_arg_array);
+  if (lane_temp_buffer_size.has_value()) {
+    llvm::Value* lane_temp_buffer = loop_builder.CreateGEP(
+        llvm::Type::getInt8Ty(*context), wrapper.GetTempBufferArg(),
+        loop_builder.CreateMul(index,
+                               loop_builder.getInt64(*lane_temp_buffer_size)));
+    llvm::Value* lane_context = loop_builder.CreateGEP(
+        llvm::Type::getInt8Ty(*context), wrapper.GetUserDataArg(),
+        loop_builder.CreateMul(
+            index, loop_builder.getInt64(sizeof(ProcLaneContext))));
+    llvm::Value* continuation_point_ptr = loop_builder.CreateGEP(
+        llvm::Type::getInt8Ty(*context), lane_context,
+        loop_builder.getInt64(offsetof(ProcLaneContext, continuation_point)));
+    llvm::Value* queues_ptr = loop_builder.CreateGEP(
+        llvm::Type::getInt8Ty(*context), lane_context,
+        loop_builder.getInt64(offsetof(ProcLaneContext, queues)));
+    llvm::Value* queues = loop_builder.CreateLoad(ptr_type, queues_ptr);
+    args.push_back(lane_temp_buffer);
+    args.push_back(wrapper.GetInterpreterEventsArg());
+    args.push_back(queues);
+    args.push_back(wrapper.GetJitRuntimeArg());
+    args.push_back(loop_builder.CreateLoad(i64, continuation_point_ptr));
+    loop_builder.CreateStore(loop_builder.CreateCall(callee, args),
+                             continuation_point_ptr);
+  } else {
+    args.push_back(wrapper.GetTempBufferArg());
+    args.push_back(wrapper.GetInterpreterEventsArg());
+    args.push_back(wrapper.GetUserDataArg());
+    args.push_back(wrapper.GetJitRuntimeArg());
+    args.push_back(/*continuation_point=*/loop_builder.getInt64(0));
+    loop_builder.CreateCall(callee, args);
+  }
+
+  llvm::Value* next_index =
+      loop_builder.CreateAdd(index, loop_builder.getInt64(1));
+  next_index->setName("next_index");
+  loop_builder.CreateBr(preheader_block);
+  index->addIncoming(next_index, loop_block);
+
+  llvm::IRBuilder<> exit_builder(exit_block);
+  exit_builder.CreateRet(exit_builder.getInt64(0));
+
+  return wrapper.function();
+}
+
 // Jits a function implementing `xls_function`. Also jits all transitively
 // dependent xls::Functions which may be called by `xls_function`.
 absl::StatusOr<JittedFunctionBase> BuildFunctionAndDependencies(
     FunctionBase* xls_function, JitBuilderContext& jit_context,
-    bool build_packed_wrapper) {
+    bool build_packed_wrapper, bool build_batched_wrapper) {
   std::vector<FunctionBase*> functions = GetDependentFunctions(xls_function);
   BufferAllocator allocator(&jit_context.type_converter());
   llvm::Function* top_function = nullptr;
@@ -1174,6 +1368,17 @@ absl::StatusOr<JittedFunctionBase> BuildFunctionAndDependencies(
         BuildPackedWrapper(xls_function, top_function, jit_context));
     packed_wrapper_name = packed_wrapper_function->getName().str();
   }
+  std::string batched_wrapper_name;
+  if (build_batched_wrapper) {
+    // The samples of a proc are lanes each with their own temporary buffer.
+    XLS_ASSIGN_OR_RETURN(
+        llvm::Function * batched_wrapper_function,
+        BuildBatchedWrapper(xls_function, top_function, jit_context,
+                            xls_function->IsProc()
+                                ? std::make_optional(allocator.size())
+                                : std::nullopt));
+    batched_wrapper_name = batched_wrapper_function->getName().str();
+  }
 
   XLS_RETURN_IF_ERROR(
       jit_context.orc_jit().CompileModule(jit_context.ConsumeModule()));
@@ -1193,6 +1398,15 @@ absl::StatusOr<JittedFunctionBase> BuildFunctionAndDependencies(
         absl::bit_cast<JitFunctionType>(packed_fn_address);
   }
 
+  if (build_batched_wrapper) {
+    jitted_function.batched_function_name = batched_wrapper_name;
+    XLS_ASSIGN_OR_RETURN(
+        auto batched_fn_address,
+        jit_context.orc_jit().LoadSymbol(batched_wrapper_name));
+    jitted_function.batched_function =
+        absl::bit_cast<JitFunctionType>(batched_fn_address);
+  }
+
   for (const Node* input : GetJittedFunctionInputs(xls_function)) {
     jitted_function.input_buffer_sizes.push_back(
         jit_context.type_converter().GetTypeByteSize(input->GetType()));
@@ -1219,20 +1433,82 @@ absl::StatusOr<JittedFunctionBase> BuildFunctionAndDependencies(
   return std::move(jitted_function);
 }
 
+// Finds the state elements of `proc` whose next value can be computed in place
+// in the buffer holding the current value and marks the corresponding array
+// updates in `jit_context`. This is the case when the next state value is an
+// array update of the element's own state param and the update is the only
+// user of the param: no other node observes the old value, so the update need
+// not copy the (possibly large) array. Returns the indices of the params
+// (within Proc::params) of these state elements.
+std::vector<int64_t> SetUpInPlaceStateUpdates(Proc* proc,
+                                              JitBuilderContext& jit_context) {
+  std::vector<int64_t> in_place_params;
+  for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
+    Param* param = proc->GetStateParam(i);
+    Node* next = proc->GetNextStateElement(i);
+    if (!next->Is<ArrayUpdate>() ||
+        next->As<ArrayUpdate>()->array_to_update() != param ||
+        param->users().size() != 1 ||
+        absl::c_count(next->operands(), param) != 1) {
+      continue;
+    }
+    // The param must not be the next value of another state element (which
+    // would read its old value) and the update must supply only this state
+    // element (which would require a second output buffer).
+    if (absl::c_count(proc->NextState(), param) != 0 ||
+        absl::c_count(proc->NextState(), next) != 1) {
+      continue;
+    }
+    XLS_VLOG(3) << absl::StreamFormat(
+        "Computing next value of state element `%s` in place",
+        param->GetName());
+    jit_context.SetComputedInPlace(next);
+    in_place_params.push_back(proc->GetParamIndex(param).value());
+  }
+  return in_place_params;
+}
+
 }  // namespace
 
-absl::StatusOr<JittedFunctionBase> BuildFunction(Function* xls_function,
-                                                 OrcJit& orc_jit) {
-  JitBuilderContext jit_context(orc_jit);
+absl::StatusOr<JittedFunctionBase> BuildFunction(
+    Function* xls_function, OrcJit& orc_jit,
+    ActivityProfile* activity_profile) {
+  JitBuilderContext jit_context(orc_jit, /*queue_mgr=*/std::nullopt,
+                                activity_profile);
   return BuildFunctionAndDependencies(xls_function, jit_context,
-                                      /*build_packed_wrapper=*/true);
+                                      /*build_packed_wrapper=*/true,
+                                      /*build_batched_wrapper=*/true);
 }
 
 absl::StatusOr<JittedFunctionBase> BuildProcFunction(
-    Proc* proc, JitChannelQueueManager* queue_mgr, OrcJit& orc_jit) {
-  JitBuilderContext jit_context(orc_jit, queue_mgr);
-  return BuildFunctionAndDependencies(proc, jit_context,
-                                      /*build_packed_wrapper=*/false);
+    Proc* proc, JitChannelQueueManager* queue_mgr, OrcJit& orc_jit,
+    ActivityProfile* activity_profile, bool build_lanes_wrapper) {
+  JitBuilderContext jit_context(orc_jit, queue_mgr, activity_profile);
+  // Each lane has its own queues so their addresses can't be embedded.
+  jit_context.set_queues_from_user_data(build_lanes_wrapper);
+  std::vector<int64_t> in_place_params =
+      SetUpInPlaceStateUpdates(proc, jit_context);
+  XLS_ASSIGN_OR_RETURN(
+      JittedFunctionBase jitted_function,
+      BuildFunctionAndDependencies(proc, jit_context,
+                                   /*build_packed_wrapper=*/false,
+                                   build_lanes_wrapper));
+  jitted_function.in_place_params = std::move(in_place_params);
+  return std::move(jitted_function);
+}
+
+absl::StatusOr<JittedFunctionBase> BuildBlockFunction(Block* block,
+                                                      OrcJit& orc_jit) {
+  if (!block->GetInstantiations().empty()) {
+    return absl::UnimplementedError(
+        absl::StrFormat("Jitting of blocks with instantiations is not "
+                        "supported: %s",
+                        block->name()));
+  }
+  JitBuilderContext jit_context(orc_jit);
+  return BuildFunctionAndDependencies(block, jit_context,
+                                      /*build_packed_wrapper=*/false,
+                                      /*build_batched_wrapper=*/false);
 }
 
 }  // namespace xls
@@ -14,11 +14,14 @@
 #ifndef XLS_JIT_FUNCTION_BASE_JIT_H_
 #define XLS_JIT_FUNCTION_BASE_JIT_H_
 
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "xls/ir/activity_profile.h"
+#include "xls/ir/block.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
 #include "xls/ir/proc.h"
@@ -71,6 +74,19 @@ struct JittedFunctionBase {
   std::optional<std::string> packed_function_name;
   std::optional<JitFunctionType> packed_function;
 
+  // Name and function pointer for the jitted function which evaluates a batch
+  // of samples in a single call. Each input/output pointer refers to a
+  // contiguous array of samples in LLVM native format, and the final argument
+  // is the number of samples in the batch rather than a continuation point.
+  //
+  // For procs (only built on request, see BuildProcFunction) each sample is an
+  // independent instance of the proc, a lane, with its own state, channel
+  // queues and continuation point: `temp_buffer` holds `temp_buffer_size`
+  // bytes for each lane and `user_data` points to an array holding a
+  // ProcLaneContext for each lane.
+  std::optional<std::string> batched_function_name;
+  std::optional<JitFunctionType> batched_function;
+
   // Sizes of the inputs/outputs in native LLVM format for `function_base`.
   std::vector<int64_t> input_buffer_sizes;
   std::vector<int64_t> output_buffer_sizes;
@@ -85,17 +101,53 @@ struct JittedFunctionBase {
   // Map from the continuation point return value to the corresponding node at
   // which execution was interrupted.
   absl::flat_hash_map<int64_t, Node*> continuation_points;
+
+  // Indices (within Proc::params) of the proc state elements whose next value
+  // is computed in place. Each is an array update of the state element's own
+  // param so the caller must pass the same buffer as both the input for the
+  // param and the output for its next state value; a tick then writes only
+  // the updated array element. Only set for procs.
+  std::vector<int64_t> in_place_params;
+};
+
+// The per-lane argument of the batched function of a proc. The continuation
+// point is overwritten with the value returned by the proc function for the
+// lane. `queues` is the table of the lane's channel queues, indexed by
+// QueueTableIndex, which the proc function receives as its user data.
+struct ProcLaneContext {
+  int64_t continuation_point;
+  JitChannelQueue* const* queues;
 };
 
 // Builds and returns an LLVM IR function implementing the given XLS
-// function.
-absl::StatusOr<JittedFunctionBase> BuildFunction(Function* xls_function,
-                                                 OrcJit& orc_jit);
+// function. If `activity_profile` is non-null the generated code increments
+// its counters; the profile must outlive the generated code.
+absl::StatusOr<JittedFunctionBase> BuildFunction(
+    Function* xls_function, OrcJit& orc_jit,
+    ActivityProfile* activity_profile = nullptr);
 
 // Builds and returns an LLVM IR function implementing the given XLS
-// proc.
+// proc. `activity_profile` is as in BuildFunction. If `build_lanes_wrapper` is
+// true, also builds the batched function which ticks many lanes of the proc in
+// one call (see JittedFunctionBase::batched_function). The generated code then
+// loads the addresses of the channel queues from a table passed as its user
+// data argument (see JitBuilderContext::set_queues_from_user_data) rather than
+// using the queues of `queue_mgr`.
 absl::StatusOr<JittedFunctionBase> BuildProcFunction(
-    Proc* proc, JitChannelQueueManager* queue_mgr, OrcJit& orc_jit);
+    Proc* proc, JitChannelQueueManager* queue_mgr, OrcJit& orc_jit,
+    ActivityProfile* activity_profile = nullptr,
+    bool build_lanes_wrapper = false);
+
+// Builds and returns an LLVM IR function implementing one clock cycle of the
+// given XLS block. The inputs of the function are the block's input ports (in
+// the order of Block::GetInputPorts) followed by the current register values
+// (in the order of Block::GetRegisters). The outputs are the values driven on
+// the output ports (in the order of Block::GetOutputPorts) followed by, for
+// each register, the data, load enable (if present) and reset (if present)
+// operands of its register write. Blocks with instantiations are not
+// supported.
+absl::StatusOr<JittedFunctionBase> BuildBlockFunction(Block* block,
+                                                      OrcJit& orc_jit);
 
 }  // namespace xls
 
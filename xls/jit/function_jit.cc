@@ -19,13 +19,17 @@
 #include <utility>
 #include <vector>
 
+#include "absl/cleanup/cleanup.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/activity_profile.h"
 #include "xls/ir/format_preference.h"
 #include "xls/ir/keyword_args.h"
 #include "xls/ir/type.h"
@@ -36,17 +40,29 @@
 namespace xls {
 
 absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::Create(
-    Function* xls_function, int64_t opt_level) {
-  return CreateInternal(xls_function, opt_level, /*emit_object_code=*/false);
+    Function* xls_function, int64_t opt_level,
+    const JitTargetOptions& target_options) {
+  return CreateInternal(xls_function, opt_level, /*emit_object_code=*/false,
+                        target_options);
+}
+
+absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::CreateInSession(
+    Function* xls_function, std::shared_ptr<JitSession> session) {
+  return CreateWithOrcJit(xls_function,
+                          OrcJit::CreateInSession(std::move(session)));
 }
 
 absl::StatusOr<JitObjectCode> FunctionJit::CreateObjectCode(
-    Function* xls_function, int64_t opt_level) {
-  XLS_ASSIGN_OR_RETURN(
-      std::unique_ptr<FunctionJit> jit,
-      CreateInternal(xls_function, opt_level, /*emit_object_code=*/true));
+    Function* xls_function, int64_t opt_level,
+    const JitTargetOptions& target_options) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
+                       CreateInternal(xls_function, opt_level,
+                                      /*emit_object_code=*/true,
+                                      target_options));
   return JitObjectCode{
       .function_name = std::string{jit->GetJittedFunctionName()},
+      .batched_function_name =
+          jit->jitted_function_base_.batched_function_name.value(),
       .object_code = jit->orc_jit_->GetObjectCode(),
       .parameter_buffer_sizes = jit->jitted_function_base_.input_buffer_sizes,
       .return_buffer_size = jit->jitted_function_base_.output_buffer_sizes[0],
@@ -55,27 +71,63 @@ absl::StatusOr<JitObjectCode> FunctionJit::CreateObjectCode(
 }
 
 absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::CreateInternal(
-    Function* xls_function, int64_t opt_level, bool emit_object_code) {
+    Function* xls_function, int64_t opt_level, bool emit_object_code,
+    const JitTargetOptions& target_options) {
+  if (emit_object_code && target_options.activity_profile) {
+    return absl::InvalidArgumentError(
+        "Activity profiling is not supported when emitting object code");
+  }
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<OrcJit> orc_jit,
+      OrcJit::Create(opt_level, emit_object_code, target_options));
+  return CreateWithOrcJit(xls_function, std::move(orc_jit));
+}
+
+absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::CreateWithOrcJit(
+    Function* xls_function, std::unique_ptr<OrcJit> orc_jit) {
   auto jit = absl::WrapUnique(new FunctionJit(xls_function));
-  XLS_ASSIGN_OR_RETURN(jit->orc_jit_,
-                       OrcJit::Create(opt_level, emit_object_code));
-  XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout,
-                       OrcJit::CreateDataLayout());
-  jit->jit_runtime_ = std::make_unique<JitRuntime>(data_layout);
+  jit->orc_jit_ = std::move(orc_jit);
+  jit->jit_runtime_ =
+      std::make_unique<JitRuntime>(jit->orc_jit_->data_layout());
+  if (jit->orc_jit_->target_options().activity_profile) {
+    jit->activity_profile_ = std::make_unique<ActivityProfile>(xls_function);
+  }
   XLS_ASSIGN_OR_RETURN(jit->jitted_function_base_,
-                       BuildFunction(xls_function, *jit->orc_jit_));
+                       BuildFunction(xls_function, *jit->orc_jit_,
+                                     jit->activity_profile_.get()));
 
-  // Pre-allocate argument, result, and temporary buffers.
-  for (int64_t i = 0; i < xls_function->params().size(); ++i) {
-    jit->arg_buffers_.push_back(std::vector<uint8_t>(jit->GetArgTypeSize(i)));
-    jit->arg_buffer_ptrs_.push_back(jit->arg_buffers_.back().data());
-  }
-  jit->result_buffer_.resize(jit->GetReturnTypeSize());
-  jit->temp_buffer_.resize(jit->GetTempBufferSize());
+  // Pre-allocate argument, result, and temporary buffers for the first
+  // invocation.
+  jit->ReleaseBuffers(jit->AcquireBuffers());
 
   return jit;
 }
 
+std::unique_ptr<FunctionJit::InvocationBuffers> FunctionJit::AcquireBuffers() {
+  {
+    absl::MutexLock lock(&buffers_mutex_);
+    if (!free_buffers_.empty()) {
+      std::unique_ptr<InvocationBuffers> buffers =
+          std::move(free_buffers_.back());
+      free_buffers_.pop_back();
+      return buffers;
+    }
+  }
+  auto buffers = std::make_unique<InvocationBuffers>();
+  for (int64_t i = 0; i < xls_function_->params().size(); ++i) {
+    buffers->arg_buffers.push_back(std::vector<uint8_t>(GetArgTypeSize(i)));
+    buffers->arg_buffer_ptrs.push_back(buffers->arg_buffers.back().data());
+  }
+  buffers->result_buffer.resize(GetReturnTypeSize());
+  buffers->temp_buffer.resize(GetTempBufferSize());
+  return buffers;
+}
+
+void FunctionJit::ReleaseBuffers(std::unique_ptr<InvocationBuffers> buffers) {
+  absl::MutexLock lock(&buffers_mutex_);
+  free_buffers_.push_back(std::move(buffers));
+}
+
 absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
     absl::Span<const Value> args) {
   absl::Span<Param* const> params = xls_function_->params();
@@ -98,14 +150,23 @@ absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
     param_types.push_back(param->GetType());
   }
 
-  // Allocate argument buffers and copy in arg Values.
-  XLS_RETURN_IF_ERROR(jit_runtime_->PackArgs(args, param_types,
-                                             absl::MakeSpan(arg_buffer_ptrs_)));
+  std::unique_ptr<InvocationBuffers> buffers = AcquireBuffers();
+  absl::Cleanup release_buffers = [&]() {
+    ReleaseBuffers(std::move(buffers));
+  };
+
+  // Copy the arg Values into the argument buffers.
+  XLS_RETURN_IF_ERROR(jit_runtime_->PackArgs(
+      args, param_types, absl::MakeSpan(buffers->arg_buffer_ptrs)));
 
   InterpreterEvents events;
-  InvokeJitFunction(arg_buffer_ptrs_, result_buffer_.data(), &events);
+  uint8_t* output_buffers[1] = {buffers->result_buffer.data()};
+  jitted_function_base_.function(
+      buffers->arg_buffer_ptrs.data(), output_buffers,
+      buffers->temp_buffer.data(), &events,
+      /*user_data=*/nullptr, runtime(), /*continuation_point=*/0);
   Value result = jit_runtime_->UnpackBuffer(
-      result_buffer_.data(), xls_function_->return_value()->GetType());
+      buffers->result_buffer.data(), xls_function_->return_value()->GetType());
 
   return InterpreterResult<Value>{std::move(result), std::move(events)};
 }
@@ -137,13 +198,100 @@ absl::Status FunctionJit::RunWithViews(absl::Span<uint8_t* const> args,
   return absl::OkStatus();
 }
 
+absl::Status FunctionJit::RunBatchedWithViews(absl::Span<uint8_t* const> args,
+                                              absl::Span<uint8_t> result_buffer,
+                                              int64_t batch_size,
+                                              InterpreterEvents* events) {
+  XLS_RET_CHECK(jitted_function_base_.batched_function.has_value());
+  absl::Span<Param* const> params = xls_function_->params();
+  if (args.size() != params.size()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Arg list has the wrong size: %d vs expected %d.",
+                        args.size(), xls_function_->params().size()));
+  }
+  if (batch_size < 0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Batch size must be non-negative, is %d", batch_size));
+  }
+  if (result_buffer.size() < GetReturnTypeSize() * batch_size) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Result buffer too small - must be at least %d bytes!",
+        GetReturnTypeSize() * batch_size));
+  }
+
+  uint8_t* output_buffers[1] = {result_buffer.data()};
+  std::unique_ptr<InvocationBuffers> buffers = AcquireBuffers();
+  jitted_function_base_.batched_function.value()(
+      args.data(), output_buffers, buffers->temp_buffer.data(), events,
+      /*user_data=*/nullptr, runtime(), batch_size);
+  ReleaseBuffers(std::move(buffers));
+  return absl::OkStatus();
+}
+
+absl::StatusOr<InterpreterResult<std::vector<Value>>> FunctionJit::RunBatched(
+    absl::Span<const std::vector<Value>> arg_batches) {
+  absl::Span<Param* const> params = xls_function_->params();
+  std::vector<Type*> param_types;
+  for (const Param* param : params) {
+    param_types.push_back(param->GetType());
+  }
+
+  // Lay out the arguments structure-of-arrays: one contiguous buffer per
+  // parameter holding the value of that parameter for every sample.
+  int64_t batch_size = arg_batches.size();
+  std::vector<std::vector<uint8_t>> batch_buffers;
+  std::vector<uint8_t*> batch_buffer_ptrs;
+  for (int64_t i = 0; i < params.size(); ++i) {
+    batch_buffers.push_back(
+        std::vector<uint8_t>(GetArgTypeSize(i) * batch_size));
+    batch_buffer_ptrs.push_back(batch_buffers.back().data());
+  }
+  std::vector<uint8_t*> sample_ptrs(params.size());
+  for (int64_t sample = 0; sample < batch_size; ++sample) {
+    absl::Span<const Value> args = arg_batches[sample];
+    if (args.size() != params.size()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Arg list %d to '%s' has the wrong size: %d vs expected %d.", sample,
+          xls_function_->name(), args.size(), params.size()));
+    }
+    for (int64_t i = 0; i < params.size(); ++i) {
+      if (!ValueConformsToType(args[i], param_types[i])) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Got argument %s for parameter %d of sample %d which is not of "
+            "type %s",
+            args[i].ToString(), i, sample, param_types[i]->ToString()));
+      }
+      sample_ptrs[i] = batch_buffer_ptrs[i] + sample * GetArgTypeSize(i);
+    }
+    XLS_RETURN_IF_ERROR(jit_runtime_->PackArgs(args, param_types,
+                                               absl::MakeSpan(sample_ptrs)));
+  }
+
+  std::vector<uint8_t> result_batch(GetReturnTypeSize() * batch_size);
+  InterpreterEvents events;
+  XLS_RETURN_IF_ERROR(RunBatchedWithViews(
+      batch_buffer_ptrs, absl::MakeSpan(result_batch), batch_size, &events));
+
+  std::vector<Value> results;
+  results.reserve(batch_size);
+  Type* return_type = xls_function_->return_value()->GetType();
+  for (int64_t sample = 0; sample < batch_size; ++sample) {
+    results.push_back(jit_runtime_->UnpackBuffer(
+        result_batch.data() + sample * GetReturnTypeSize(), return_type));
+  }
+  return InterpreterResult<std::vector<Value>>{std::move(results),
+                                               std::move(events)};
+}
+
 void FunctionJit::InvokeJitFunction(
     absl::Span<const uint8_t* const> arg_buffers, uint8_t* output_buffer,
     InterpreterEvents* events) {
   uint8_t* output_buffers[1] = {output_buffer};
+  std::unique_ptr<InvocationBuffers> buffers = AcquireBuffers();
   jitted_function_base_.function(
-      arg_buffers.data(), output_buffers, temp_buffer_.data(), events,
+      arg_buffers.data(), output_buffers, buffers->temp_buffer.data(), events,
       /*user_data=*/nullptr, runtime(), /*continuation_point=*/0);
+  ReleaseBuffers(std::move(buffers));
 }
 
 }  // namespace xls
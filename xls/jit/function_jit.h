@@ -20,9 +20,12 @@
 #include <string_view>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "xls/ir/activity_profile.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
 #include "xls/ir/value.h"
@@ -37,6 +40,9 @@ namespace xls {
 struct JitObjectCode {
   // Name of the top-level jitted function in the object code.
   std::string function_name;
+  // Name of the function in the object code which evaluates a batch of
+  // samples in one call (see JittedFunctionBase::batched_function).
+  std::string batched_function_name;
   std::vector<uint8_t> object_code;
 
   // Size of the buffers for the parameters and result.
@@ -48,19 +54,33 @@ struct JitObjectCode {
 };
 
 // This class provides a facility to execute XLS functions (on the host) by
-// converting it to LLVM IR, compiling it, and finally executing it. Not
-// thread-safe due to sharing of result and temporary buffers between
-// invocations of Run.
+// converting it to LLVM IR, compiling it, and finally executing it.
+// The Run methods may be called concurrently from multiple threads. Each
+// concurrent invocation uses its own argument, result and temporary buffers,
+// which are returned to a pool and reused by later invocations. Activity
+// counters (see JitTargetOptions::activity_profile) are not updated
+// atomically, however, so concurrent runs of a profiled JIT may lose counts.
 class FunctionJit {
  public:
   // Returns an object containing a host-compiled version of the specified XLS
   // function.
   static absl::StatusOr<std::unique_ptr<FunctionJit>> Create(
-      Function* xls_function, int64_t opt_level = 3);
+      Function* xls_function, int64_t opt_level = 3,
+      const JitTargetOptions& target_options = JitTargetOptions());
+
+  // As above, but compiles the function into the given session (with the
+  // session's opt level and target options). This avoids the cost of setting
+  // up a JIT for each of many functions. The compiled code is unloaded when the
+  // returned object is destroyed.
+  static absl::StatusOr<std::unique_ptr<FunctionJit>> CreateInSession(
+      Function* xls_function, std::shared_ptr<JitSession> session);
 
   // Returns the bytes of an object file containing the compiled XLS function.
-  static absl::StatusOr<JitObjectCode> CreateObjectCode(Function* xls_function,
-                                                        int64_t opt_level = 3);
+  // The object code is specialized for the CPU given in `target_options` (by
+  // default the host CPU).
+  static absl::StatusOr<JitObjectCode> CreateObjectCode(
+      Function* xls_function, int64_t opt_level = 3,
+      const JitTargetOptions& target_options = JitTargetOptions());
 
   // Executes the compiled function with the specified arguments.
   absl::StatusOr<InterpreterResult<Value>> Run(absl::Span<const Value> args);
@@ -85,6 +105,24 @@ class FunctionJit {
                             absl::Span<uint8_t> result_buffer,
                             InterpreterEvents* events);
 
+  // Executes the compiled function over a batch of `batch_size` argument sets
+  // in a single call. Arguments and results are laid out structure-of-arrays:
+  // `args[i]` points to `batch_size` consecutive values of the i-th parameter,
+  // each GetArgTypeSize(i) bytes in the native LLVM data layout, and
+  // `result_buffer` receives `batch_size` consecutive results, each
+  // GetReturnTypeSize() bytes. The loop over samples is part of the jitted code
+  // so the wrapper dispatch cost is paid once per batch rather than once per
+  // sample. Events from all samples are accumulated in `events`.
+  absl::Status RunBatchedWithViews(absl::Span<uint8_t* const> args,
+                                   absl::Span<uint8_t> result_buffer,
+                                   int64_t batch_size,
+                                   InterpreterEvents* events);
+
+  // As above, but with each argument set given as a vector of Values. Returns
+  // the result of each argument set in order.
+  absl::StatusOr<InterpreterResult<std::vector<Value>>> RunBatched(
+      absl::Span<const std::vector<Value>> arg_batches);
+
   // Similar to RunWithViews(), except the arguments here are _packed_views_ -
   // views whose data elements are tightly packed, with no padding bits or bytes
   // between them. The function return value is specified as the last arg - its
@@ -114,9 +152,11 @@ class FunctionJit {
 
     InterpreterEvents events;
     uint8_t* output_buffers[1] = {result_buffer};
+    std::unique_ptr<InvocationBuffers> buffers = AcquireBuffers();
     jitted_function_base_.packed_function.value()(
-        arg_buffers, output_buffers, temp_buffer_.data(), &events,
+        arg_buffers, output_buffers, buffers->temp_buffer.data(), &events,
         /*user_data=*/nullptr, runtime(), /*continuation_point=*/0);
+    ReleaseBuffers(std::move(buffers));
 
     return InterpreterEventsToStatus(events);
   }
@@ -170,11 +210,21 @@ class FunctionJit {
 
   JitRuntime* runtime() const { return jit_runtime_.get(); }
 
+  // Returns the activity counters accumulated over all runs, or nullptr if the
+  // JIT was created without `JitTargetOptions::activity_profile`.
+  const ActivityProfile* activity_profile() const {
+    return activity_profile_.get();
+  }
+  ActivityProfile* activity_profile() { return activity_profile_.get(); }
+
  private:
   explicit FunctionJit(Function* xls_function) : xls_function_(xls_function) {}
 
   static absl::StatusOr<std::unique_ptr<FunctionJit>> CreateInternal(
-      Function* xls_function, int64_t opt_level, bool emit_object_code);
+      Function* xls_function, int64_t opt_level, bool emit_object_code,
+      const JitTargetOptions& target_options);
+  static absl::StatusOr<std::unique_ptr<FunctionJit>> CreateWithOrcJit(
+      Function* xls_function, std::unique_ptr<OrcJit> orc_jit);
 
   // Builds a function which wraps the natively compiled XLS function `callee`
   // (as built by xls::BuildFunction) with another function which accepts the
@@ -213,6 +263,22 @@ class FunctionJit {
     *result_buffer = front.mutable_buffer();
   }
 
+  // Buffers to hold the arguments, result and temporary storage of a single
+  // invocation of the jitted function.
+  struct InvocationBuffers {
+    std::vector<std::vector<uint8_t>> arg_buffers;
+    // Raw pointers to the buffers held in `arg_buffers`.
+    std::vector<uint8_t*> arg_buffer_ptrs;
+    std::vector<uint8_t> result_buffer;
+    std::vector<uint8_t> temp_buffer;
+  };
+
+  // Returns buffers which are not in use by any other invocation, reusing
+  // previously released buffers if possible. The buffers should be returned
+  // with ReleaseBuffers once the invocation completes.
+  std::unique_ptr<InvocationBuffers> AcquireBuffers();
+  void ReleaseBuffers(std::unique_ptr<InvocationBuffers> buffers);
+
   // Invokes the jitted function with the given argument and outputs.
   void InvokeJitFunction(absl::Span<const uint8_t* const> arg_buffers,
                          uint8_t* output_buffer, InterpreterEvents* events);
@@ -221,17 +287,14 @@ class FunctionJit {
 
   Function* xls_function_;
 
-  // Buffers to hold the arguments, result, temporary storage. This is allocated
-  // once and then re-used with each invocation of Run. Not thread-safe.
-  std::vector<std::vector<uint8_t>> arg_buffers_;
-  std::vector<uint8_t> result_buffer_;
-  std::vector<uint8_t> temp_buffer_;
-
-  // Raw pointers to the buffers held in `arg_buffers_`.
-  std::vector<uint8_t*> arg_buffer_ptrs_;
+  // Buffers released by completed invocations.
+  absl::Mutex buffers_mutex_;
+  std::vector<std::unique_ptr<InvocationBuffers>> free_buffers_
+      ABSL_GUARDED_BY(buffers_mutex_);
 
   JittedFunctionBase jitted_function_base_;
   std::unique_ptr<JitRuntime> jit_runtime_;
+  std::unique_ptr<ActivityProfile> activity_profile_;
 };
 
 }  // namespace xls
@@ -14,6 +14,7 @@
 
 #include "xls/jit/function_jit.h"
 
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <ios>
@@ -29,10 +30,14 @@
 #include "absl/strings/substitute.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/ir_evaluator_test_base.h"
 #include "xls/interpreter/random_value.h"
+#include "xls/ir/activity_profile.h"
+#include "xls/ir/bits_ops.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/value_view.h"
+#include "xls/jit/orc_jit.h"
 
 namespace xls {
 namespace {
@@ -168,6 +173,98 @@ TEST(FunctionJitTest, TraceFmtBigArgTest) {
             "00000000000000000000000000000000000000000000000000000000000000");
 }
 
+TEST(FunctionJitTest, DeferredTraceRecording) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn trace_deferred(tkn: token, pred: bits[1], x: bits[128]) -> token {
+    trace.1: token = trace(tkn, pred, format="x is {:x}", data_operands=[x])
+    ret trace.2: token = trace(trace.1, pred, format="pred is {}", data_operands=[pred])
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto jit,
+      FunctionJit::Create(
+          function, /*opt_level=*/3,
+          JitTargetOptions{.trace_recording = TraceRecording::kDeferred}));
+  std::vector<Value> args = {Value::Token(), Value(UBits(1, 1)),
+                             Value(bits_ops::ShiftLeftLogical(
+                                 UBits(0xab, 128), 100))};
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result, jit->Run(args));
+  EXPECT_TRUE(result.events.trace_msgs.empty());
+  result.events.RenderDeferredTraces();
+  EXPECT_THAT(result.events.trace_msgs,
+              testing::ElementsAre("x is ab" + std::string(25, '0'),
+                                   "pred is 1"));
+
+  // Traces whose condition is false are not recorded.
+  args[1] = Value(UBits(0, 1));
+  XLS_ASSERT_OK_AND_ASSIGN(result, jit->Run(args));
+  result.events.RenderDeferredTraces();
+  EXPECT_TRUE(result.events.trace_msgs.empty());
+}
+
+TEST(FunctionJitTest, DisabledTraceRecording) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn trace_disabled(tkn: token, pred: bits[1]) -> token {
+    ret trace.1: token = trace(tkn, pred, format="pred is {}", data_operands=[pred])
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto jit,
+      FunctionJit::Create(
+          function, /*opt_level=*/3,
+          JitTargetOptions{.trace_recording = TraceRecording::kDisabled}));
+  std::vector<Value> args = {Value::Token(), Value(UBits(1, 1))};
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result, jit->Run(args));
+  result.events.RenderDeferredTraces();
+  EXPECT_TRUE(result.events.trace_msgs.empty());
+}
+
+TEST(FunctionJitTest, ActivityProfile) {
+  Package package("my_package");
+  FunctionBuilder fb("activity", &package);
+  BValue s = fb.Param("s", package.GetBitsType(2));
+  BValue x = fb.Param("x", package.GetBitsType(8));
+  BValue y = fb.Param("y", package.GetBitsType(8));
+  BValue sel = fb.Select(s, {x, y}, /*default_value=*/x);
+  BValue priority_sel = fb.PrioritySelect(s, {x, y});
+  BValue one_hot_sel = fb.OneHotSelect(s, {x, y});
+  BValue gate = fb.Gate(fb.BitSlice(s, 0, 1), x);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * function,
+      fb.BuildWithReturnValue(
+          fb.Tuple({sel, priority_sel, one_hot_sel, gate})));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto jit,
+      FunctionJit::Create(function, /*opt_level=*/3,
+                          JitTargetOptions{.activity_profile = true}));
+  for (int64_t selector : {0, 1, 2, 3, 3}) {
+    XLS_ASSERT_OK(jit->Run({Value(UBits(selector, 2)), Value(UBits(1, 8)),
+                            Value(UBits(2, 8))})
+                      .status());
+  }
+  const ActivityProfile& profile = *jit->activity_profile();
+  EXPECT_THAT(profile.GetCounters(sel.node()), testing::ElementsAre(1, 1, 3));
+  EXPECT_THAT(profile.GetCounters(priority_sel.node()),
+              testing::ElementsAre(3, 1, 1));
+  EXPECT_THAT(profile.GetCounters(one_hot_sel.node()),
+              testing::ElementsAre(3, 3, 1));
+  EXPECT_THAT(profile.GetCounters(gate.node()), testing::ElementsAre(3, 2));
+
+  EXPECT_THAT(
+      FunctionJit::CreateObjectCode(function, /*opt_level=*/3,
+                                    JitTargetOptions{.activity_profile = true}),
+      StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 // This test verifies that a compiled JIT function can be re-used.
 TEST(FunctionJitTest, ReuseTest) {
   Package package("my_package");
@@ -188,6 +285,266 @@ TEST(FunctionJitTest, ReuseTest) {
               IsOkAndHolds(Value(UBits(7, 8))));
 }
 
+// Functions of the same name from different packages can be compiled into one
+// session, and unloading one leaves the other runnable.
+TEST(FunctionJitTest, SharedSession) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::shared_ptr<JitSession> session,
+                           JitSession::Create());
+  std::string add_one_text = R"(
+  fn f(x: bits[8]) -> bits[8] {
+    literal.1: bits[8] = literal(value=1)
+    ret add.2: bits[8] = add(x, literal.1)
+  }
+  )";
+  std::string add_two_text = R"(
+  fn f(x: bits[8]) -> bits[8] {
+    literal.1: bits[8] = literal(value=2)
+    ret add.2: bits[8] = add(x, literal.1)
+  }
+  )";
+  Package package_a("package_a");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * add_one,
+                           Parser::ParseFunction(add_one_text, &package_a));
+  Package package_b("package_b");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * add_two,
+                           Parser::ParseFunction(add_two_text, &package_b));
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit_a,
+                           FunctionJit::CreateInSession(add_one, session));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit_b,
+                           FunctionJit::CreateInSession(add_two, session));
+  EXPECT_THAT(RunJitNoEvents(jit_a.get(), {Value(UBits(5, 8))}),
+              IsOkAndHolds(Value(UBits(6, 8))));
+  EXPECT_THAT(RunJitNoEvents(jit_b.get(), {Value(UBits(5, 8))}),
+              IsOkAndHolds(Value(UBits(7, 8))));
+
+  jit_a.reset();
+  EXPECT_THAT(RunJitNoEvents(jit_b.get(), {Value(UBits(9, 8))}),
+              IsOkAndHolds(Value(UBits(11, 8))));
+  XLS_ASSERT_OK_AND_ASSIGN(jit_a,
+                           FunctionJit::CreateInSession(add_one, session));
+  EXPECT_THAT(RunJitNoEvents(jit_a.get(), {Value(UBits(9, 8))}),
+              IsOkAndHolds(Value(UBits(10, 8))));
+}
+
+TEST(FunctionJitTest, ConcurrentRuns) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn mul_add(x: bits[32], y: bits[32]) -> bits[32] {
+    umul.1: bits[32] = umul(x, y)
+    ret add.2: bits[32] = add(umul.1, x)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  // Each thread checks its own results so any interference between the
+  // invocations shows up as a mismatch.
+  std::vector<std::unique_ptr<Thread>> threads;
+  std::vector<int64_t> mismatches(8, 0);
+  for (int64_t t = 0; t < mismatches.size(); ++t) {
+    threads.push_back(std::make_unique<Thread>([&jit, &mismatches, t] {
+      for (uint64_t i = 0; i < 1000; ++i) {
+        uint64_t x = t * 1000 + i;
+        uint64_t y = i + 3;
+        absl::StatusOr<Value> result = RunJitNoEvents(
+            jit.get(), {Value(UBits(x, 32)), Value(UBits(y, 32))});
+        if (!result.ok() ||
+            *result != Value(UBits((x * y + x) & 0xffffffff, 32))) {
+          ++mismatches[t];
+        }
+      }
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  EXPECT_THAT(mismatches, testing::Each(0));
+}
+
+TEST(FunctionJitTest, TargetOptions) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn wide_xor(x: bits[512], y: bits[512]) -> bits[512] {
+    and.1: bits[512] = and(x, y)
+    ret xor.2: bits[512] = xor(and.1, y)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  Value x = Value(bits_ops::Concat({UBits(0xf0f0, 256), UBits(0xff, 256)}));
+  Value y = Value(bits_ops::Concat({UBits(0xffff, 256), UBits(0x0f, 256)}));
+  Value expected =
+      Value(bits_ops::Concat({UBits(0x0f0f, 256), UBits(0x00, 256)}));
+
+  // Portable code, host code with a preferred vector width, and a module
+  // optimized with the reduced pipeline for large modules all agree.
+  for (const JitTargetOptions& options :
+       {JitTargetOptions{.cpu = "generic"},
+        JitTargetOptions{.prefer_vector_width = 512},
+        JitTargetOptions{.large_module_instruction_count = 1}}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        auto jit, FunctionJit::Create(function, /*opt_level=*/3, options));
+    EXPECT_THAT(RunJitNoEvents(jit.get(), {x, y}), IsOkAndHolds(expected));
+  }
+
+  EXPECT_THAT(FunctionJit::Create(function, /*opt_level=*/3,
+                                  JitTargetOptions{.cpu = "not-a-real-cpu"}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       testing::HasSubstr("Unknown CPU")));
+}
+
+TEST(FunctionJitTest, LazyCompilation) {
+  std::string ir_text = R"(
+  package my_package
+
+  fn double(x: bits[8]) -> bits[8] {
+    ret add.1: bits[8] = add(x, x)
+  }
+
+  fn negate(x: bits[8]) -> bits[8] {
+    ret neg.2: bits[8] = neg(x)
+  }
+
+  fn inc(x: bits[8]) -> bits[8] {
+    literal.3: bits[8] = literal(value=1)
+    ret add.4: bits[8] = add(x, literal.3)
+  }
+
+  top fn main(p: bits[1], x: bits[8][2]) -> bits[8] {
+    literal.6: bits[1] = literal(value=0)
+    array_index.12: bits[8] = array_index(x, indices=[literal.6])
+    invoke.5: bits[8] = invoke(array_index.12, to_apply=negate)
+    map.7: bits[8][2] = map(x, to_apply=double)
+    invoke.8: bits[8] = invoke(array_index.12, to_apply=inc)
+    array_index.9: bits[8] = array_index(map.7, indices=[literal.6])
+    add.10: bits[8] = add(array_index.9, invoke.8)
+    ret sel.11: bits[8] = sel(p, cases=[add.10, invoke.5])
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, p->GetTopAsFunction());
+
+  // Callees are compiled on their first call and give the same results as
+  // when the whole package is compiled up front.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<JitSession> session,
+      JitSession::Create(/*opt_level=*/3, /*emit_object_code=*/false,
+                         JitTargetOptions{.lazy_compilation = true}));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit,
+                           FunctionJit::CreateInSession(function, session));
+  EXPECT_FALSE(session->IsMaterialized("negate"));
+  Value x = Value::UBitsArray({5, 7}, 8).value();
+  EXPECT_THAT(RunJitNoEvents(jit.get(), {Value(UBits(0, 1)), x}),
+              IsOkAndHolds(Value(UBits(16, 8))));
+  EXPECT_TRUE(session->IsMaterialized("negate"));
+  EXPECT_THAT(RunJitNoEvents(jit.get(), {Value(UBits(0, 1)), x}),
+              IsOkAndHolds(Value(UBits(16, 8))));
+  EXPECT_THAT(RunJitNoEvents(jit.get(), {Value(UBits(1, 1)), x}),
+              IsOkAndHolds(Value(UBits(251, 8))));
+}
+
+TEST(FunctionJitTest, ConcurrentCompilation) {
+  // A function large enough for its module to be split into several parts
+  // which are compiled concurrently.
+  Package package("my_package");
+  FunctionBuilder fb("big", &package);
+  BValue x = fb.Param("x", package.GetBitsType(64));
+  BValue y = fb.Param("y", package.GetBitsType(64));
+  BValue acc = x;
+  for (int64_t i = 0; i < 10000; ++i) {
+    acc = fb.Xor(fb.Add(acc, y), fb.Shrl(acc, fb.Literal(UBits(i % 7, 64))));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto serial_jit,
+                           FunctionJit::Create(function, /*opt_level=*/1));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto concurrent_jit,
+      FunctionJit::Create(function, /*opt_level=*/1,
+                          JitTargetOptions{.compile_threads = 4}));
+  for (uint64_t i = 0; i < 4; ++i) {
+    std::vector<Value> args = {Value(UBits(0x1234567 * i, 64)),
+                               Value(UBits(0xabcdef + i, 64))};
+    XLS_ASSERT_OK_AND_ASSIGN(Value expected,
+                             RunJitNoEvents(serial_jit.get(), args));
+    EXPECT_THAT(RunJitNoEvents(concurrent_jit.get(), args),
+                IsOkAndHolds(expected));
+  }
+}
+
+TEST(FunctionJitTest, RunBatched) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn f(x: bits[8], y: (bits[1], bits[16])) -> bits[16] {
+    tuple_index.1: bits[16] = tuple_index(y, index=1)
+    zero_ext.2: bits[16] = zero_ext(x, new_bit_count=16)
+    ret add.3: bits[16] = add(zero_ext.2, tuple_index.1)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  std::vector<std::vector<Value>> arg_batches;
+  std::vector<Value> expected;
+  for (int64_t i = 0; i < 100; ++i) {
+    arg_batches.push_back(
+        {Value(UBits(i, 8)),
+         Value::Tuple({Value(UBits(i % 2, 1)), Value(UBits(1000 * i, 16))})});
+    expected.push_back(Value(UBits((1001 * i) & 0xffff, 16)));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<std::vector<Value>> result,
+                           jit->RunBatched(arg_batches));
+  EXPECT_THAT(result.value, testing::ElementsAreArray(expected));
+
+  // An empty batch is a no-op.
+  XLS_ASSERT_OK_AND_ASSIGN(result, jit->RunBatched({}));
+  EXPECT_TRUE(result.value.empty());
+}
+
+TEST(FunctionJitTest, RunBatchedWithViews) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn f(x: bits[32], y: bits[32]) -> bits[32] {
+    ret umul.1: bits[32] = umul(x, y)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  constexpr int64_t kBatchSize = 37;
+  std::vector<uint32_t> x(kBatchSize);
+  std::vector<uint32_t> y(kBatchSize);
+  std::vector<uint32_t> result(kBatchSize);
+  for (int64_t i = 0; i < kBatchSize; ++i) {
+    x[i] = i;
+    y[i] = 3 * i + 1;
+  }
+  std::vector<uint8_t*> args{reinterpret_cast<uint8_t*>(x.data()),
+                             reinterpret_cast<uint8_t*>(y.data())};
+  InterpreterEvents events;
+  XLS_ASSERT_OK(jit->RunBatchedWithViews(
+      args,
+      absl::MakeSpan(reinterpret_cast<uint8_t*>(result.data()),
+                     kBatchSize * sizeof(uint32_t)),
+      kBatchSize, &events));
+  for (int64_t i = 0; i < kBatchSize; ++i) {
+    EXPECT_EQ(result[i], x[i] * y[i]);
+  }
+
+  // Result buffer too small for the batch.
+  EXPECT_THAT(jit->RunBatchedWithViews(
+                  args,
+                  absl::MakeSpan(reinterpret_cast<uint8_t*>(result.data()),
+                                 sizeof(uint32_t)),
+                  kBatchSize, &events),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 TEST(FunctionJitTest, OneHotZeroBit) {
   Package package("my_package");
   std::string ir_text = R"(
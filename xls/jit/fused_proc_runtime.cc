@@ -0,0 +1,269 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/fused_proc_runtime.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/casts.h"
+#include "absl/memory/memory.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "llvm/include/llvm/IR/BasicBlock.h"
+#include "llvm/include/llvm/IR/DerivedTypes.h"
+#include "llvm/include/llvm/IR/Function.h"
+#include "llvm/include/llvm/IR/IRBuilder.h"
+#include "llvm/include/llvm/IR/Module.h"
+#include "llvm/include/llvm/IR/Type.h"
+#include "llvm/include/llvm/IR/Value.h"
+#include "xls/common/casts.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/nodes.h"
+#include "xls/jit/function_base_jit.h"
+
+namespace xls {
+namespace {
+
+using ProcFrame = FusedJitProcRuntime::ProcFrame;
+
+static_assert(sizeof(ProcFrame) == 8 * sizeof(int64_t),
+              "ProcFrame must match the frame type of the network function");
+
+// Indices of the fields of ProcFrame.
+enum FrameField : unsigned {
+  kFrameInputs = 0,
+  kFrameOutputs = 1,
+  kFrameTempBuffer = 2,
+  kFrameEvents = 3,
+  kFrameJitRuntime = 4,
+  kFrameContinuationPoint = 5,
+  kFrameCompleted = 6,
+  kFrameProgressMade = 7,
+};
+
+constexpr std::string_view kNetworkFunctionName = "__proc_network";
+
+// Builds the function which executes one tick of the network:
+//
+//   void __proc_network(ProcFrame* frames) {
+//     bool round_progress;
+//     do {
+//       round_progress = false;
+//       for (int64_t i = 0; i < proc_functions.size(); ++i) {  // Unrolled.
+//         ProcFrame& f = frames[i];
+//         if (f.completed) continue;
+//         int64_t next =
+//             proc_functions[i](f.inputs, ..., f.continuation_point);
+//         bool progress = next != f.continuation_point || next == 0;
+//         f.continuation_point = next;
+//         f.completed = next == 0;
+//         f.progress_made |= progress;
+//         round_progress |= progress;
+//       }
+//     } while (round_progress);
+//   }
+//
+// A proc which does not complete returns the continuation point it was called
+// with only if it is still blocked on the same receive, so the loop ends once
+// every proc is completed or blocked.
+void BuildNetworkFunction(absl::Span<const JitFunctionType> proc_functions,
+                          llvm::Module* module) {
+  llvm::LLVMContext& ctx = module->getContext();
+  llvm::Type* ptr_type = llvm::PointerType::get(ctx, 0);
+  llvm::Type* i64 = llvm::Type::getInt64Ty(ctx);
+  llvm::StructType* frame_type = llvm::StructType::get(
+      ctx, {ptr_type, ptr_type, ptr_type, ptr_type, ptr_type, i64, i64, i64});
+  // The type of JitFunctionType.
+  llvm::FunctionType* proc_function_type = llvm::FunctionType::get(
+      i64, {ptr_type, ptr_type, ptr_type, ptr_type, ptr_type, ptr_type, i64},
+      /*isVarArg=*/false);
+
+  llvm::Function* function = llvm::Function::Create(
+      llvm::FunctionType::get(llvm::Type::getVoidTy(ctx), {ptr_type},
+                              /*isVarArg=*/false),
+      llvm::Function::ExternalLinkage, kNetworkFunctionName, module);
+  llvm::Value* frames = function->getArg(0);
+  frames->setName("frames");
+
+  llvm::BasicBlock* entry_block =
+      llvm::BasicBlock::Create(ctx, "entry", function);
+  llvm::BasicBlock* round_block =
+      llvm::BasicBlock::Create(ctx, "round", function);
+  llvm::IRBuilder<> entry_builder(entry_block);
+  llvm::Value* round_progress = entry_builder.CreateAlloca(
+      entry_builder.getInt1Ty(), nullptr, "round_progress");
+  entry_builder.CreateBr(round_block);
+
+  llvm::IRBuilder<> b(round_block);
+  b.CreateStore(b.getFalse(), round_progress);
+  for (int64_t i = 0; i < proc_functions.size(); ++i) {
+    auto field = [&](FrameField f) {
+      return b.CreateGEP(frame_type, frames,
+                         {b.getInt64(i), b.getInt32(f)});
+    };
+    llvm::BasicBlock* call_block =
+        llvm::BasicBlock::Create(ctx, absl::StrCat("call_", i), function);
+    llvm::BasicBlock* next_block =
+        llvm::BasicBlock::Create(ctx, absl::StrCat("next_", i), function);
+    llvm::Value* completed = b.CreateLoad(i64, field(kFrameCompleted));
+    b.CreateCondBr(b.CreateICmpNE(completed, b.getInt64(0)), next_block,
+                   call_block);
+
+    b.SetInsertPoint(call_block);
+    llvm::Value* continuation_point =
+        b.CreateLoad(i64, field(kFrameContinuationPoint));
+    std::vector<llvm::Value*> args = {
+        b.CreateLoad(ptr_type, field(kFrameInputs)),
+        b.CreateLoad(ptr_type, field(kFrameOutputs)),
+        b.CreateLoad(ptr_type, field(kFrameTempBuffer)),
+        b.CreateLoad(ptr_type, field(kFrameEvents)),
+        /*user_data=*/llvm::ConstantPointerNull::get(
+            llvm::PointerType::get(ctx, 0)),
+        b.CreateLoad(ptr_type, field(kFrameJitRuntime)),
+        continuation_point};
+    llvm::Value* fn_ptr = b.CreateIntToPtr(
+        b.getInt64(absl::bit_cast<uint64_t>(proc_functions[i])), ptr_type);
+    llvm::Value* next = b.CreateCall(proc_function_type, fn_ptr, args);
+    // Completing the tick is progress even if the proc started at the top.
+    llvm::Value* now_completed = b.CreateICmpEQ(next, b.getInt64(0));
+    llvm::Value* progress =
+        b.CreateOr(b.CreateICmpNE(next, continuation_point), now_completed);
+    b.CreateStore(next, field(kFrameContinuationPoint));
+    b.CreateStore(b.CreateZExt(now_completed, i64), field(kFrameCompleted));
+    llvm::Value* progress_made_ptr = field(kFrameProgressMade);
+    b.CreateStore(b.CreateOr(b.CreateLoad(i64, progress_made_ptr),
+                             b.CreateZExt(progress, i64)),
+                  progress_made_ptr);
+    b.CreateStore(
+        b.CreateOr(b.CreateLoad(b.getInt1Ty(), round_progress), progress),
+        round_progress);
+    b.CreateBr(next_block);
+    b.SetInsertPoint(next_block);
+  }
+  llvm::BasicBlock* exit_block =
+      llvm::BasicBlock::Create(ctx, "exit", function);
+  b.CreateCondBr(b.CreateLoad(b.getInt1Ty(), round_progress), round_block,
+                 exit_block);
+  b.SetInsertPoint(exit_block);
+  b.CreateRetVoid();
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<FusedJitProcRuntime>>
+FusedJitProcRuntime::Create(
+    Package* package, std::vector<std::unique_ptr<ProcJit>>&& proc_jits,
+    std::unique_ptr<JitChannelQueueManager>&& queue_manager) {
+  absl::flat_hash_map<Proc*, std::unique_ptr<ProcJit>> jit_map;
+  for (std::unique_ptr<ProcJit>& proc_jit : proc_jits) {
+    Proc* proc = proc_jit->proc();
+    auto [it, inserted] = jit_map.insert({proc, std::move(proc_jit)});
+    XLS_RET_CHECK(inserted) << absl::StreamFormat(
+        "More than one ProcJit given for proc `%s`", proc->name());
+  }
+  XLS_RET_CHECK_EQ(jit_map.size(), package->procs().size())
+      << "Expected one ProcJit per proc";
+
+  // Order the procs as in the package.
+  std::vector<ProcJit*> ordered_jits;
+  std::vector<JitFunctionType> proc_functions;
+  absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>> evaluators;
+  for (const std::unique_ptr<Proc>& proc : package->procs()) {
+    auto it = jit_map.find(proc.get());
+    XLS_RET_CHECK(it != jit_map.end())
+        << absl::StreamFormat("No ProcJit given for proc `%s`", proc->name());
+    ordered_jits.push_back(it->second.get());
+    proc_functions.push_back(it->second->jitted_function_base().function);
+    evaluators[proc.get()] = std::move(it->second);
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit,
+                       OrcJit::Create(/*opt_level=*/3,
+                                      /*emit_object_code=*/false));
+  std::unique_ptr<llvm::Module> module =
+      orc_jit->NewModule("__proc_network_module");
+  BuildNetworkFunction(proc_functions, module.get());
+  XLS_RETURN_IF_ERROR(orc_jit->CompileModule(std::move(module)));
+  XLS_ASSIGN_OR_RETURN(auto fn_address,
+                       orc_jit->LoadSymbol(kNetworkFunctionName));
+
+  auto runtime = absl::WrapUnique(new FusedJitProcRuntime(
+      package, std::move(evaluators), std::move(queue_manager),
+      std::move(ordered_jits)));
+  runtime->orc_jit_ = std::move(orc_jit);
+  runtime->network_function_ =
+      absl::bit_cast<NetworkFunctionType>(fn_address);
+  return std::move(runtime);
+}
+
+absl::StatusOr<ProcRuntime::NetworkTickResult>
+FusedJitProcRuntime::TickInternal() {
+  for (int64_t i = 0; i < proc_jits_.size(); ++i) {
+    ProcJitContinuation* continuation = down_cast<ProcJitContinuation*>(
+        evaluator_contexts_.at(proc_jits_[i]->proc()).continuation.get());
+    frames_[i] = ProcFrame{
+        .inputs = continuation->GetInputBuffers().data(),
+        .outputs = continuation->GetOutputBuffers().data(),
+        .temp_buffer = continuation->GetTempBuffer().data(),
+        .events = &continuation->GetEvents(),
+        .jit_runtime = proc_jits_[i]->runtime(),
+        .continuation_point = continuation->GetContinuationPoint(),
+        .completed = 0,
+        .progress_made = 0};
+  }
+
+  network_function_(frames_.data());
+
+  NetworkTickResult result{.progress_made = false,
+                           .progress_made_on_io_procs = false};
+  for (int64_t i = 0; i < proc_jits_.size(); ++i) {
+    ProcJit* proc_jit = proc_jits_[i];
+    const ProcFrame& frame = frames_[i];
+    ProcJitContinuation* continuation = down_cast<ProcJitContinuation*>(
+        evaluator_contexts_.at(proc_jit->proc()).continuation.get());
+    bool progress_made = frame.progress_made != 0;
+    result.progress_made |= progress_made;
+    result.progress_made_on_io_procs |=
+        progress_made && proc_jit->ProcHasIoOperations();
+    if (frame.completed != 0) {
+      continuation->NextTick();
+      continue;
+    }
+    continuation->SetContinuationPoint(frame.continuation_point);
+    auto it = proc_jit->jitted_function_base().continuation_points.find(
+        frame.continuation_point);
+    XLS_RET_CHECK(it != proc_jit->jitted_function_base()
+                            .continuation_points.end() &&
+                  it->second->Is<Receive>());
+    XLS_ASSIGN_OR_RETURN(Channel * channel,
+                         package_->GetChannel(
+                             it->second->As<Receive>()->channel_id()));
+    result.blocked_channels.push_back(channel);
+  }
+  std::sort(result.blocked_channels.begin(), result.blocked_channels.end(),
+            [](Channel* a, Channel* b) { return a->id() < b->id(); });
+  return result;
+}
+
+}  // namespace xls
@@ -0,0 +1,96 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_FUSED_PROC_RUNTIME_H_
+#define XLS_JIT_FUSED_PROC_RUNTIME_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/ir/events.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/orc_jit.h"
+#include "xls/jit/proc_jit.h"
+
+namespace xls {
+
+// A single-threaded runtime for a network of ProcJits which executes each
+// network tick with a single call to a jitted function. The function ticks the
+// procs in package order, in rounds, by calling the jitted proc functions
+// directly until every proc has completed its tick or is blocked on a receive.
+// Scheduling the procs thus never returns to C++ and, with the queues of a
+// JitChannelQueueManager::CreateInline manager, neither do sends and receives
+// on channels between procs of the network (except to grow a queue).
+//
+// As with SerialProcRuntime each proc completes at most one tick per network
+// tick and the results are deterministic; only the interleaving of values
+// sent to one channel by several procs may differ from SerialProcRuntime.
+class FusedJitProcRuntime : public ProcRuntime {
+ public:
+  // Creates a runtime from one ProcJit for each proc of `package`. The
+  // ProcJits must send and receive through `queue_manager`.
+  static absl::StatusOr<std::unique_ptr<FusedJitProcRuntime>> Create(
+      Package* package, std::vector<std::unique_ptr<ProcJit>>&& proc_jits,
+      std::unique_ptr<JitChannelQueueManager>&& queue_manager);
+
+  // The per-proc arguments and results of the network function. The layout
+  // matches the LLVM struct type used by the generated code.
+  struct ProcFrame {
+    const uint8_t* const* inputs;
+    uint8_t* const* outputs;
+    void* temp_buffer;
+    InterpreterEvents* events;
+    JitRuntime* jit_runtime;
+    // The continuation point at which the proc resumes. Updated by the call.
+    int64_t continuation_point;
+    // Set to 1 by the call if the proc completed its tick.
+    int64_t completed;
+    // Set to 1 by the call if any node of the proc executed.
+    int64_t progress_made;
+  };
+  using NetworkFunctionType = void (*)(ProcFrame* frames);
+
+ private:
+  FusedJitProcRuntime(
+      Package* package,
+      absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>>&& evaluators,
+      std::unique_ptr<ChannelQueueManager>&& queue_manager,
+      std::vector<ProcJit*> proc_jits)
+      : ProcRuntime(package, std::move(evaluators), std::move(queue_manager)),
+        proc_jits_(std::move(proc_jits)),
+        frames_(proc_jits_.size()) {}
+
+  absl::StatusOr<NetworkTickResult> TickInternal() override;
+
+  // The ProcJits (owned by `evaluator_contexts_`) in package order.
+  std::vector<ProcJit*> proc_jits_;
+  std::vector<ProcFrame> frames_;
+
+  std::unique_ptr<OrcJit> orc_jit_;
+  NetworkFunctionType network_function_ = nullptr;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_FUSED_PROC_RUNTIME_H_
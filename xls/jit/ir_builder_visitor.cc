@@ -15,6 +15,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -38,10 +39,12 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/activity_profile.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/events.h"
+#include "xls/ir/format_strings.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
@@ -53,6 +56,7 @@
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/llvm_type_converter.h"
 #include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -540,6 +544,51 @@ absl::Status InvokeRecordTraceCallback(llvm::IRBuilder<>* builder,
   return absl::OkStatus();
 }
 
+// Builds the LLVM IR to call the native function at `fn_address` which
+// takes `args` and returns nothing.
+void InvokeVoidCallback(llvm::IRBuilder<>* builder, uint64_t fn_address,
+                        absl::Span<llvm::Value* const> args) {
+  std::vector<llvm::Type*> params;
+  for (llvm::Value* arg : args) {
+    params.push_back(arg->getType());
+  }
+  llvm::FunctionType* fn_type =
+      llvm::FunctionType::get(llvm::Type::getVoidTy(builder->getContext()),
+                              params, /*isVarArg=*/false);
+  llvm::ConstantInt* fn_addr = llvm::ConstantInt::get(
+      llvm::Type::getInt64Ty(builder->getContext()), fn_address);
+  llvm::Value* fn_ptr =
+      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
+  builder->CreateCall(fn_type, fn_ptr, std::vector<llvm::Value*>(
+                                           args.begin(), args.end()));
+}
+
+// Converts the bytes of a deferred trace operand in the native layout
+// described by the TypeLayout `layout` to a Value.
+Value DecodeDeferredTraceOperand(const void* layout, const uint8_t* bytes) {
+  return static_cast<const TypeLayout*>(layout)->NativeLayoutToValue(bytes);
+}
+
+// This is a shim to let JIT code record a trace message without formatting
+// it.
+void RecordDeferredTrace(const FormatStep* format, int64_t format_size,
+                         xls::InterpreterEvents* events) {
+  events->AddDeferredTrace(absl::MakeConstSpan(format, format_size));
+}
+
+// This is a shim to let JIT code record the raw bytes of an operand of the
+// trace message last recorded by RecordDeferredTrace.
+void RecordDeferredTraceOperand(JitRuntime* runtime, const xls::Type* type,
+                                const uint8_t* value,
+                                xls::InterpreterEvents* events) {
+  // Layouts are owned by the runtime so they remain valid until the messages
+  // are rendered.
+  const TypeLayout& layout = runtime->GetTypeLayout(type);
+  uint8_t* buffer = events->AddDeferredTraceOperand(
+      &DecodeDeferredTraceOperand, &layout, layout.size());
+  memcpy(buffer, value, layout.size());
+}
+
 // This is a shim to let JIT code create a buffer for accumulating trace
 // fragments.
 std::string* CreateTraceBuffer() { return new std::string(); }
@@ -947,8 +996,10 @@ class IrBuilderVisitor : public DfsVisitorWithDefault {
   absl::Status HandleOneHot(OneHot* one_hot) override;
   absl::Status HandleOneHotSel(OneHotSelect* sel) override;
   absl::Status HandleOrReduce(BitwiseReductionOp* op) override;
+  absl::Status HandleOutputPort(OutputPort* output_port) override;
   absl::Status HandlePrioritySel(PrioritySelect* sel) override;
   absl::Status HandleReceive(Receive* recv) override;
+  absl::Status HandleRegisterWrite(RegisterWrite* reg_write) override;
   absl::Status HandleReverse(UnOp* reverse) override;
   absl::Status HandleSDiv(BinOp* binop) override;
   absl::Status HandleSGe(CompareOp* ge) override;
@@ -1062,6 +1113,51 @@ class IrBuilderVisitor : public DfsVisitorWithDefault {
                            Send* send, llvm::Value* send_data_ptr,
                            llvm::Value* user_data);
 
+  // Returns a pointer to `queue`, the queue of the channel with id
+  // `channel_id`. The address is either embedded in the code or loaded from
+  // the queue table passed as `user_data` (see
+  // JitBuilderContext::set_queues_from_user_data).
+  absl::StatusOr<llvm::Value*> QueuePointer(llvm::IRBuilder<>* builder,
+                                            JitChannelQueue* queue,
+                                            Package* package,
+                                            int64_t channel_id,
+                                            llvm::Value* user_data);
+
+  // Returns `queue` as an InlineJitChannelQueue whose ring buffer may be
+  // accessed directly by the generated code, or nullptr if it may not.
+  InlineJitChannelQueue* AsInlineQueue(JitChannelQueue* queue) const {
+    if (jit_context_.queues_from_user_data()) {
+      return nullptr;
+    }
+    return dynamic_cast<InlineJitChannelQueue*>(queue);
+  }
+
+  // Returns true if the activity of `node` is recorded in the activity
+  // profile of the JIT.
+  bool ProfilesActivity(Node* node) const {
+    return jit_context_.activity_profile() != nullptr &&
+           !jit_context_.activity_profile()->GetCounters(node).empty();
+  }
+
+  // Builds code which adds `amount` (an i64 value, 1 if not specified) to the
+  // activity counter of `node` with the given index. `index` may be of any
+  // integer type. Does nothing if the activity of `node` is not profiled.
+  void IncrementActivityCounter(Node* node, llvm::Value* index,
+                                llvm::IRBuilder<>& builder,
+                                llvm::Value* amount = nullptr);
+
+  // Builds code which increments the ActivityProfile::kConditionTrue or
+  // kConditionFalse counter of `node` depending on the i1 value `condition`.
+  void IncrementConditionCounter(Node* node, llvm::Value* condition,
+                                 llvm::IRBuilder<>& builder) {
+    IncrementActivityCounter(
+        node,
+        builder.CreateSelect(
+            condition, builder.getInt64(ActivityProfile::kConditionTrue),
+            builder.getInt64(ActivityProfile::kConditionFalse)),
+        builder);
+  }
+
   int64_t output_arg_count_;
   JitBuilderContext& jit_context_;
   std::optional<NodeIrContext> node_context_;
@@ -1072,6 +1168,29 @@ absl::Status IrBuilderVisitor::DefaultHandler(Node* node) {
       absl::StrCat("Unhandled node: ", node->ToString()));
 }
 
+void IrBuilderVisitor::IncrementActivityCounter(Node* node, llvm::Value* index,
+                                                llvm::IRBuilder<>& builder,
+                                                llvm::Value* amount) {
+  if (!ProfilesActivity(node)) {
+    return;
+  }
+  // The counters are allocated before code generation and outlive the
+  // generated code so their address can be embedded as a constant.
+  absl::Span<int64_t> counters =
+      jit_context_.activity_profile()->GetCounters(node);
+  llvm::Type* i64 = builder.getInt64Ty();
+  llvm::Value* counters_ptr = builder.CreateIntToPtr(
+      builder.getInt64(absl::bit_cast<uint64_t>(counters.data())),
+      llvm::PointerType::get(ctx(), 0));
+  llvm::Value* counter_ptr = builder.CreateGEP(
+      i64, counters_ptr, builder.CreateZExtOrTrunc(index, i64));
+  llvm::Value* count = builder.CreateLoad(i64, counter_ptr);
+  builder.CreateStore(
+      builder.CreateAdd(count,
+                        amount == nullptr ? builder.getInt64(1) : amount),
+      counter_ptr);
+}
+
 absl::Status IrBuilderVisitor::HandleAdd(BinOp* binop) {
   return HandleBinaryOp(
       binop, [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
@@ -1106,6 +1225,36 @@ absl::Status IrBuilderVisitor::HandleMinDelay(MinDelay* min_delay) {
                        });
 }
 
+absl::Status IrBuilderVisitor::HandleOutputPort(OutputPort* output_port) {
+  // Output ports have empty tuple types. The value driven on the port is that
+  // of its operand which is an output of the jitted block function.
+  XLS_ASSIGN_OR_RETURN(NodeIrContext node_context,
+                       NewNodeIrContext(output_port, {"operand"}));
+  return FinalizeNodeIrContextWithValue(
+      std::move(node_context),
+      LlvmTypeConverter::ZeroOfType(
+          type_converter()->ConvertToLlvmType(output_port->GetType())));
+}
+
+absl::Status IrBuilderVisitor::HandleRegisterWrite(RegisterWrite* reg_write) {
+  // Register writes have empty tuple types. Their operands are outputs of the
+  // jitted block function and the register update is performed by the caller
+  // once the cycle's combinational logic has been evaluated.
+  std::vector<std::string> operand_names = {"data"};
+  if (reg_write->load_enable().has_value()) {
+    operand_names.push_back("load_enable");
+  }
+  if (reg_write->reset().has_value()) {
+    operand_names.push_back("reset");
+  }
+  XLS_ASSIGN_OR_RETURN(NodeIrContext node_context,
+                       NewNodeIrContext(reg_write, operand_names));
+  return FinalizeNodeIrContextWithValue(
+      std::move(node_context),
+      LlvmTypeConverter::ZeroOfType(
+          type_converter()->ConvertToLlvmType(reg_write->GetType())));
+}
+
 absl::Status IrBuilderVisitor::HandleAssert(Assert* assert_op) {
   XLS_ASSIGN_OR_RETURN(NodeIrContext node_context,
                        NewNodeIrContext(assert_op, {"tkn", "condition"},
@@ -1135,7 +1284,9 @@ absl::Status IrBuilderVisitor::HandleAssert(Assert* assert_op) {
 
   fail_builder.CreateBr(after_block);
 
-  b.CreateCondBr(node_context.LoadOperand(1), ok_block, fail_block);
+  llvm::Value* condition = node_context.LoadOperand(1);
+  IncrementConditionCounter(assert_op, condition, b);
+  b.CreateCondBr(condition, ok_block, fail_block);
 
   auto after_builder = std::make_unique<llvm::IRBuilder<>>(after_block);
   llvm::Value* token = type_converter()->GetToken();
@@ -1179,6 +1330,18 @@ absl::Status IrBuilderVisitor::HandleTrace(Trace* trace_op) {
                         NumberedStrings("arg", trace_op->args().size())),
           /*include_wrapper_args=*/true));
 
+  if (ProfilesActivity(trace_op)) {
+    IncrementConditionCounter(trace_op, node_context.LoadOperand(1),
+                              node_context.entry_builder());
+  }
+
+  TraceRecording trace_recording =
+      jit_context_.orc_jit().target_options().trace_recording;
+  if (trace_recording == TraceRecording::kDisabled) {
+    return FinalizeNodeIrContextWithValue(std::move(node_context),
+                                          type_converter()->GetToken());
+  }
+
   llvm::IRBuilder<>& b = node_context.entry_builder();
   llvm::Value* condition = node_context.LoadOperand(1);
   llvm::Value* events_ptr = node_context.GetInterpreterEventsArg();
@@ -1200,15 +1363,44 @@ absl::Status IrBuilderVisitor::HandleTrace(Trace* trace_op) {
       ctx(), absl::StrCat(trace_name, "_print"), node_context.llvm_function());
   llvm::IRBuilder<> print_builder(print_block);
 
-  XLS_ASSIGN_OR_RETURN(llvm::Value * buffer_ptr,
-                       InvokeCreateBufferCallback(&print_builder));
-
   // Operands are: (tok, pred, ..data_operands..)
   XLS_RET_CHECK_EQ(trace_op->operand(0)->GetType(),
                    trace_op->package()->GetTokenType());
   XLS_RET_CHECK_EQ(trace_op->operand(1)->GetType(),
                    trace_op->package()->GetBitsType(1));
 
+  if (trace_recording == TraceRecording::kDeferred) {
+    // Record the format, which lives as long as the trace node (and so as long
+    // as the JIT code), and copies of the operand bytes.
+    llvm::Type* i64 = llvm::Type::getInt64Ty(ctx());
+    InvokeVoidCallback(
+        &print_builder, absl::bit_cast<uint64_t>(&RecordDeferredTrace),
+        {llvm::ConstantInt::get(
+             i64, absl::bit_cast<uint64_t>(trace_op->format().data())),
+         llvm::ConstantInt::get(i64, trace_op->format().size()), events_ptr});
+    for (int64_t i = 2; i < trace_op->operand_count(); ++i) {
+      llvm::Value* operand = node_context.LoadOperand(i);
+      llvm::AllocaInst* alloca = print_builder.CreateAlloca(operand->getType());
+      print_builder.CreateStore(operand, alloca);
+      InvokeVoidCallback(
+          &print_builder,
+          absl::bit_cast<uint64_t>(&RecordDeferredTraceOperand),
+          {jit_runtime_ptr,
+           llvm::ConstantInt::get(
+               i64, absl::bit_cast<uint64_t>(trace_op->operand(i)->GetType())),
+           alloca, events_ptr});
+    }
+    print_builder.CreateBr(after_block);
+    b.CreateCondBr(condition, print_block, skip_block);
+    auto after_builder = std::make_unique<llvm::IRBuilder<>>(after_block);
+    return FinalizeNodeIrContextWithValue(std::move(node_context),
+                                          type_converter()->GetToken(),
+                                          after_builder.get());
+  }
+
+  XLS_ASSIGN_OR_RETURN(llvm::Value * buffer_ptr,
+                       InvokeCreateBufferCallback(&print_builder));
+
   size_t operand_index = 2;
   for (const FormatStep& step : trace_op->format()) {
     if (std::holds_alternative<std::string>(step)) {
@@ -1345,9 +1537,12 @@ absl::Status IrBuilderVisitor::HandleArrayUpdate(ArrayUpdate* update) {
   llvm::IRBuilder<>& b = node_context.entry_builder();
 
   // First, copy the entire array to update (operand 0) to the output buffer.
+  // An update computed in place already shares its buffer with operand 0.
   llvm::Value* output_buffer = node_context.GetOutputPtr(0);
-  LlvmMemcpy(output_buffer, node_context.GetOperandPtr(0),
-             type_converter()->GetTypeByteSize(update->GetType()), b);
+  if (!jit_context_.IsComputedInPlace(update)) {
+    LlvmMemcpy(output_buffer, node_context.GetOperandPtr(0),
+               type_converter()->GetTypeByteSize(update->GetType()), b);
+  }
 
   // Determine whether the indices are all inbounds. If any are out of bounds
   // then the array update operation is a NOP. Also, gather the GEP indices for
@@ -1664,6 +1859,10 @@ absl::Status IrBuilderVisitor::HandleCover(Cover* cover) {
   // support to the JIT.
   XLS_ASSIGN_OR_RETURN(NodeIrContext node_context,
                        NewNodeIrContext(cover, {"tkn", "condition"}));
+  if (ProfilesActivity(cover)) {
+    IncrementConditionCounter(cover, node_context.LoadOperand(1),
+                              node_context.entry_builder());
+  }
   llvm::Value* token = type_converter()->GetToken();
   return FinalizeNodeIrContextWithValue(std::move(node_context), token);
 }
@@ -1896,6 +2095,7 @@ absl::Status IrBuilderVisitor::HandleGate(Gate* gate) {
   llvm::IRBuilder<>& b = node_context.entry_builder();
   llvm::Value* condition = node_context.LoadOperand(0);
   llvm::Value* data = node_context.LoadOperand(1);
+  IncrementConditionCounter(gate, condition, b);
 
   // TODO(meheff): 2022/09/09 Replace with a if/then/else block which does a
   // memcpy or writing zero to the output buffer.
@@ -2324,6 +2524,21 @@ absl::Status IrBuilderVisitor::HandleOneHotSel(OneHotSelect* sel) {
   builder->CreateStore(LlvmTypeConverter::ZeroOfType(
                            type_converter()->ConvertToLlvmType(sel->GetType())),
                        output_buffer);
+  if (ProfilesActivity(sel)) {
+    // Each set selector bit counts as an activation of its case.
+    for (int64_t i = 0; i < sel->cases().size(); ++i) {
+      llvm::Value* select_bit = builder->CreateTrunc(
+          builder->CreateLShr(selector, i), builder->getInt1Ty());
+      IncrementActivityCounter(
+          sel, builder->getInt64(i), *builder,
+          builder->CreateZExt(select_bit, builder->getInt64Ty()));
+    }
+    llvm::Value* selector_is_zero = builder->CreateICmpEQ(
+        selector, llvm::ConstantInt::get(selector->getType(), 0));
+    IncrementActivityCounter(
+        sel, builder->getInt64(sel->cases().size()), *builder,
+        builder->CreateZExt(selector_is_zero, builder->getInt64Ty()));
+  }
   for (int64_t i = 0; i < sel->cases().size(); ++i) {
     // Create a if-then construct where the `then` block is executed if the case
     // is selected. This `then` block ORs in the case value.
@@ -2369,6 +2584,17 @@ absl::Status IrBuilderVisitor::HandlePrioritySel(PrioritySelect* sel) {
   llvm::Function* cttz = llvm::Intrinsic::getDeclaration(
       module(), llvm::Intrinsic::cttz, {selector->getType()});
   llvm::Value* selected_index = b.CreateCall(cttz, {selector, llvm_false});
+  if (ProfilesActivity(sel)) {
+    // A zero selector yields an index of at least the number of cases which
+    // maps to the last ("none") counter.
+    llvm::Value* case_count =
+        llvm::ConstantInt::get(selector->getType(), sel->cases().size());
+    IncrementActivityCounter(
+        sel,
+        b.CreateSelect(b.CreateICmpULT(selected_index, case_count),
+                       selected_index, case_count),
+        b);
+  }
 
   // Sel is implemented by a cascading series of select ops, e.g.,
   // selector == 0 ? cases[0] : selector == 1 ? cases[1] : selector == 2 ? ...
@@ -2444,6 +2670,21 @@ absl::Status IrBuilderVisitor::HandleSel(Select* sel) {
   // Sel is implemented by a cascading series of select ops, e.g.,
   // selector == 0 ? cases[0] : selector == 1 ? cases[1] : selector == 2 ? ...
   llvm::Value* selector = node_context.LoadOperand(0);
+  if (ProfilesActivity(sel)) {
+    if (sel->default_value().has_value()) {
+      // Selector values past the last case select the default value which
+      // is counted after the cases.
+      llvm::Value* case_count =
+          llvm::ConstantInt::get(selector->getType(), sel->cases().size());
+      IncrementActivityCounter(
+          sel,
+          b.CreateSelect(b.CreateICmpULT(selector, case_count), selector,
+                         case_count),
+          b);
+    } else {
+      IncrementActivityCounter(sel, selector, b);
+    }
+  }
   llvm::Value* llvm_sel =
       sel->default_value()
           ? node_context.GetOperandPtr(sel->operand_count() - 1)
@@ -2795,12 +3036,97 @@ bool QueueReceiveWrapper(JitChannelQueue* queue, uint8_t* buffer) {
   return queue->ReadRaw(buffer);
 }
 
+// Indices of the fields of JitRingBuffer.
+enum RingBufferField : unsigned {
+  kRingData = 0,
+  kRingCapacity = 1,
+  kRingReadIndex = 2,
+  kRingSize = 3,
+};
+
+// Returns a pointer to the given field of the ring buffer of `queue`.
+llvm::Value* RingBufferFieldPtr(InlineJitChannelQueue* queue,
+                                RingBufferField field,
+                                llvm::IRBuilder<>* builder) {
+  llvm::Type* i64 = builder->getInt64Ty();
+  llvm::Type* ptr_type = llvm::PointerType::get(builder->getContext(), 0);
+  llvm::StructType* ring_type =
+      llvm::StructType::get(builder->getContext(), {ptr_type, i64, i64, i64});
+  llvm::Value* ring = builder->CreateIntToPtr(
+      builder->getInt64(absl::bit_cast<uint64_t>(queue->ring())), ptr_type);
+  return builder->CreateStructGEP(ring_type, ring, field);
+}
+
+absl::StatusOr<llvm::Value*> IrBuilderVisitor::QueuePointer(
+    llvm::IRBuilder<>* builder, JitChannelQueue* queue, Package* package,
+    int64_t channel_id, llvm::Value* user_data) {
+  llvm::Type* ptr_type = llvm::PointerType::get(ctx(), 0);
+  if (!jit_context_.queues_from_user_data()) {
+    llvm::Value* queue_address = llvm::ConstantInt::get(
+        llvm::Type::getInt64Ty(ctx()), absl::bit_cast<uint64_t>(queue));
+    return builder->CreateIntToPtr(queue_address, ptr_type);
+  }
+  XLS_ASSIGN_OR_RETURN(int64_t index, QueueTableIndex(package, channel_id));
+  llvm::Value* entry =
+      builder->CreateGEP(ptr_type, user_data, builder->getInt64(index));
+  return builder->CreateLoad(ptr_type, entry);
+}
+
 absl::StatusOr<llvm::Value*> IrBuilderVisitor::ReceiveFromQueue(
     llvm::IRBuilder<>* builder, JitChannelQueue* queue, Receive* receive,
     llvm::Value* output_ptr, llvm::Value* user_data) {
   llvm::Type* bool_type = llvm::Type::getInt1Ty(ctx());
   llvm::Type* ptr_type = llvm::PointerType::get(ctx(), 0);
 
+  // Values on an inline queue are read directly from its ring buffer. Only if
+  // the ring buffer is empty is the queue called (which may run a generator).
+  InlineJitChannelQueue* inline_queue = AsInlineQueue(queue);
+  llvm::BasicBlock* ring_block = nullptr;
+  llvm::BasicBlock* done_block = nullptr;
+  if (inline_queue != nullptr) {
+    llvm::Function* function = builder->GetInsertBlock()->getParent();
+    ring_block = llvm::BasicBlock::Create(ctx(), "ring_read", function);
+    llvm::BasicBlock* queue_block =
+        llvm::BasicBlock::Create(ctx(), "queue_read", function);
+    done_block = llvm::BasicBlock::Create(ctx(), "read_done", function);
+    llvm::Value* size = builder->CreateLoad(
+        builder->getInt64Ty(),
+        RingBufferFieldPtr(inline_queue, kRingSize, builder));
+    builder->CreateCondBr(builder->CreateICmpNE(size, builder->getInt64(0)),
+                          ring_block, queue_block);
+
+    llvm::IRBuilder<> ring_builder(ring_block);
+    llvm::Type* i64 = ring_builder.getInt64Ty();
+    llvm::Value* data = ring_builder.CreateLoad(
+        ptr_type, RingBufferFieldPtr(inline_queue, kRingData, &ring_builder));
+    llvm::Value* capacity = ring_builder.CreateLoad(
+        i64, RingBufferFieldPtr(inline_queue, kRingCapacity, &ring_builder));
+    llvm::Value* read_index_ptr =
+        RingBufferFieldPtr(inline_queue, kRingReadIndex, &ring_builder);
+    llvm::Value* read_index = ring_builder.CreateLoad(i64, read_index_ptr);
+    llvm::Value* element = ring_builder.CreateGEP(
+        ring_builder.getInt8Ty(), data,
+        ring_builder.CreateMul(read_index,
+                               ring_builder.getInt64(inline_queue->stride())));
+    LlvmMemcpy(output_ptr, element,
+               type_converter()->GetTypeByteSize(receive->GetPayloadType()),
+               ring_builder);
+    ring_builder.CreateStore(
+        ring_builder.CreateAnd(
+            ring_builder.CreateAdd(read_index, ring_builder.getInt64(1)),
+            ring_builder.CreateSub(capacity, ring_builder.getInt64(1))),
+        read_index_ptr);
+    llvm::Value* size_ptr =
+        RingBufferFieldPtr(inline_queue, kRingSize, &ring_builder);
+    ring_builder.CreateStore(
+        ring_builder.CreateSub(ring_builder.CreateLoad(i64, size_ptr),
+                               ring_builder.getInt64(1)),
+        size_ptr);
+    ring_builder.CreateBr(done_block);
+
+    builder->SetInsertPoint(queue_block);
+  }
+
   // Call the user-provided function of type ProcJit::RecvFnT to receive the
   // value.
   std::vector<llvm::Type*> params = {ptr_type, ptr_type};
@@ -2808,10 +3134,11 @@ absl::StatusOr<llvm::Value*> IrBuilderVisitor::ReceiveFromQueue(
       llvm::FunctionType::get(bool_type, params, /*isVarArg=*/false);
 
   // Call the wrapper to JitChannelQueue::Recv.
-  llvm::Value* queue_address = llvm::ConstantInt::get(
-      llvm::Type::getInt64Ty(ctx()), absl::bit_cast<uint64_t>(queue));
-  std::vector<llvm::Value*> args = {
-      builder->CreateIntToPtr(queue_address, ptr_type), output_ptr};
+  XLS_ASSIGN_OR_RETURN(
+      llvm::Value * queue_ptr,
+      QueuePointer(builder, queue, receive->package(), receive->channel_id(),
+                   user_data));
+  std::vector<llvm::Value*> args = {queue_ptr, output_ptr};
 
   llvm::ConstantInt* fn_addr =
       llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx()),
@@ -2819,6 +3146,15 @@ absl::StatusOr<llvm::Value*> IrBuilderVisitor::ReceiveFromQueue(
   llvm::Value* fn_ptr =
       builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
   llvm::Value* receive_fired = builder->CreateCall(fn_type, fn_ptr, args);
+  if (inline_queue != nullptr) {
+    llvm::BasicBlock* queue_end_block = builder->GetInsertBlock();
+    builder->CreateBr(done_block);
+    builder->SetInsertPoint(done_block);
+    llvm::PHINode* fired = builder->CreatePHI(bool_type, 2);
+    fired->addIncoming(builder->getTrue(), ring_block);
+    fired->addIncoming(receive_fired, queue_end_block);
+    return fired;
+  }
   return receive_fired;
 }
 
@@ -2887,9 +3223,23 @@ absl::Status IrBuilderVisitor::HandleReceive(Receive* recv) {
 
     llvm::PHINode* receive_fired = join_builder.CreatePHI(
         llvm::Type::getInt1Ty(ctx()), /*NumReservedValues=*/2);
-    receive_fired->addIncoming(true_receive_fired, true_block);
+    // Receiving may have added blocks after `true_block`.
+    receive_fired->addIncoming(true_receive_fired,
+                               true_builder.GetInsertBlock());
     receive_fired->addIncoming(llvm::ConstantInt::getFalse(ctx()), false_block);
     receive_fired->setName("receive_fired");
+    if (ProfilesActivity(recv)) {
+      IncrementActivityCounter(
+          recv,
+          join_builder.CreateSelect(
+              predicate,
+              join_builder.CreateSelect(
+                  receive_fired,
+                  join_builder.getInt64(ActivityProfile::kChannelOpFired),
+                  join_builder.getInt64(ActivityProfile::kChannelOpNoData)),
+              join_builder.getInt64(ActivityProfile::kChannelOpPredicateFalse)),
+          join_builder);
+    }
     if (!recv->is_blocking()) {
       // If the receive is non-blocking, the output of the receive has an
       // additional element (index 2) which indicates whether the receive fired.
@@ -2911,6 +3261,15 @@ absl::Status IrBuilderVisitor::HandleReceive(Receive* recv) {
                        ReceiveFromQueue(&node_context.entry_builder(), &queue,
                                         recv, data_buffer, user_data));
   receive_fired->setName("receive_fired");
+  if (ProfilesActivity(recv)) {
+    llvm::IRBuilder<>& b = node_context.entry_builder();
+    IncrementActivityCounter(
+        recv,
+        b.CreateSelect(receive_fired,
+                       b.getInt64(ActivityProfile::kChannelOpFired),
+                       b.getInt64(ActivityProfile::kChannelOpNoData)),
+        b);
+  }
   if (!recv->is_blocking()) {
     // If the receive is non-blocking, the output of the receive has an
     // additional element (index 2) which indicates whether the receive fired.
@@ -2941,16 +3300,59 @@ absl::Status IrBuilderVisitor::SendToQueue(llvm::IRBuilder<>* builder,
   llvm::Type* void_type = llvm::Type::getVoidTy(ctx());
   llvm::Type* ptr_type = llvm::PointerType::get(ctx(), 0);
 
+  // Values on an inline queue are written directly to its ring buffer. Only if
+  // the ring buffer is full is the queue called to grow it.
+  InlineJitChannelQueue* inline_queue = AsInlineQueue(queue);
+  llvm::BasicBlock* done_block = nullptr;
+  if (inline_queue != nullptr) {
+    llvm::Function* function = builder->GetInsertBlock()->getParent();
+    llvm::BasicBlock* ring_block =
+        llvm::BasicBlock::Create(ctx(), "ring_write", function);
+    llvm::BasicBlock* queue_block =
+        llvm::BasicBlock::Create(ctx(), "queue_write", function);
+    done_block = llvm::BasicBlock::Create(ctx(), "write_done", function);
+    llvm::Type* i64 = builder->getInt64Ty();
+    llvm::Value* size = builder->CreateLoad(
+        i64, RingBufferFieldPtr(inline_queue, kRingSize, builder));
+    llvm::Value* capacity = builder->CreateLoad(
+        i64, RingBufferFieldPtr(inline_queue, kRingCapacity, builder));
+    builder->CreateCondBr(builder->CreateICmpULT(size, capacity), ring_block,
+                          queue_block);
+
+    llvm::IRBuilder<> ring_builder(ring_block);
+    llvm::Value* data = ring_builder.CreateLoad(
+        ptr_type, RingBufferFieldPtr(inline_queue, kRingData, &ring_builder));
+    llvm::Value* read_index = ring_builder.CreateLoad(
+        i64, RingBufferFieldPtr(inline_queue, kRingReadIndex, &ring_builder));
+    llvm::Value* slot = ring_builder.CreateAnd(
+        ring_builder.CreateAdd(read_index, size),
+        ring_builder.CreateSub(capacity, ring_builder.getInt64(1)));
+    llvm::Value* element = ring_builder.CreateGEP(
+        ring_builder.getInt8Ty(), data,
+        ring_builder.CreateMul(slot,
+                               ring_builder.getInt64(inline_queue->stride())));
+    LlvmMemcpy(element, send_data_ptr,
+               type_converter()->GetTypeByteSize(send->data()->GetType()),
+               ring_builder);
+    ring_builder.CreateStore(
+        ring_builder.CreateAdd(size, ring_builder.getInt64(1)),
+        RingBufferFieldPtr(inline_queue, kRingSize, &ring_builder));
+    ring_builder.CreateBr(done_block);
+
+    builder->SetInsertPoint(queue_block);
+  }
+
   // We do the same for sending/writing as we do for receiving/reading
   // above (set up and call an external function).
   std::vector<llvm::Type*> params = {ptr_type, ptr_type};
   llvm::FunctionType* fn_type =
       llvm::FunctionType::get(void_type, params, /*isVarArg=*/false);
 
-  llvm::Value* queue_address = llvm::ConstantInt::get(
-      llvm::Type::getInt64Ty(ctx()), absl::bit_cast<uint64_t>(queue));
-  std::vector<llvm::Value*> args = {
-      builder->CreateIntToPtr(queue_address, ptr_type), send_data_ptr};
+  XLS_ASSIGN_OR_RETURN(
+      llvm::Value * queue_ptr,
+      QueuePointer(builder, queue, send->package(), send->channel_id(),
+                   user_data));
+  std::vector<llvm::Value*> args = {queue_ptr, send_data_ptr};
 
   llvm::ConstantInt* fn_addr =
       llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx()),
@@ -2958,6 +3360,10 @@ absl::Status IrBuilderVisitor::SendToQueue(llvm::IRBuilder<>* builder,
   llvm::Value* fn_ptr =
       builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
   builder->CreateCall(fn_type, fn_ptr, args);
+  if (inline_queue != nullptr) {
+    builder->CreateBr(done_block);
+    builder->SetInsertPoint(done_block);
+  }
   return absl::OkStatus();
 }
 
@@ -3000,6 +3406,14 @@ absl::Status IrBuilderVisitor::HandleSend(Send* send) {
     llvm::IRBuilder<> false_builder(false_block);
     false_builder.CreateBr(join_block);
 
+    if (ProfilesActivity(send)) {
+      IncrementActivityCounter(
+          send,
+          b.CreateSelect(predicate,
+                         b.getInt64(ActivityProfile::kChannelOpFired),
+                         b.getInt64(ActivityProfile::kChannelOpPredicateFalse)),
+          b);
+    }
     b.CreateCondBr(predicate, true_block, false_block);
 
     auto exit_builder = std::make_unique<llvm::IRBuilder<>>(join_block);
@@ -3012,6 +3426,8 @@ absl::Status IrBuilderVisitor::HandleSend(Send* send) {
                                           /*return_value=*/predicate);
   }
   // Unconditional send.
+  IncrementActivityCounter(
+      send, b.getInt64(ActivityProfile::kChannelOpFired), b);
   XLS_RETURN_IF_ERROR(SendToQueue(&b, &queue, send, data_ptr, user_data));
 
   // The node function should return true if data was sent. This will trigger
@@ -3024,6 +3440,18 @@ absl::Status IrBuilderVisitor::HandleSend(Send* send) {
 
 }  // namespace
 
+absl::StatusOr<int64_t> QueueTableIndex(Package* package,
+                                        int64_t channel_id) {
+  absl::Span<Channel* const> channels = package->channels();
+  for (int64_t i = 0; i < channels.size(); ++i) {
+    if (channels[i]->id() == channel_id) {
+      return i;
+    }
+  }
+  return absl::NotFoundError(absl::StrFormat(
+      "No channel with id %d in package %s", channel_id, package->name()));
+}
+
 llvm::Value* LlvmMemcpy(llvm::Value* tgt, llvm::Value* src, int64_t size,
                         llvm::IRBuilder<>& builder) {
   return builder.CreateMemCpy(tgt, llvm::MaybeAlign(1), src,
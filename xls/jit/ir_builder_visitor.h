@@ -14,14 +14,18 @@
 #ifndef XLS_JIT_IR_BUILDER_VISITOR_H_
 #define XLS_JIT_IR_BUILDER_VISITOR_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "llvm/include/llvm/IR/Function.h"
+#include "xls/ir/activity_profile.h"
 #include "xls/ir/node.h"
+#include "xls/ir/package.h"
 #include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/orc_jit.h"
 
@@ -38,12 +42,13 @@ class JitBuilderContext {
  public:
   explicit JitBuilderContext(
       OrcJit& orc_jit,
-      std::optional<JitChannelQueueManager*> queue_mgr = std::nullopt)
+      std::optional<JitChannelQueueManager*> queue_mgr = std::nullopt,
+      ActivityProfile* activity_profile = nullptr)
       : module_(orc_jit.NewModule("__module")),
         orc_jit_(orc_jit),
-        type_converter_(orc_jit.GetContext(),
-                        orc_jit.CreateDataLayout().value()),
-        queue_manager_(queue_mgr) {}
+        type_converter_(orc_jit.GetContext(), orc_jit.data_layout()),
+        queue_manager_(queue_mgr),
+        activity_profile_(activity_profile) {}
 
   llvm::Module* module() const { return module_.get(); }
   llvm::LLVMContext& context() const { return module_->getContext(); }
@@ -68,11 +73,34 @@ class JitBuilderContext {
     return queue_manager_;
   }
 
+  // If set, the generated code does not embed the addresses of the channel
+  // queues. Instead it loads them from a table of JitChannelQueue pointers
+  // passed as the user data argument and indexed by QueueTableIndex, so the
+  // same compiled proc can run against different sets of queues. The ring
+  // buffers of inline queues are then not accessed directly.
+  void set_queues_from_user_data(bool value) { queues_from_user_data_ = value; }
+  bool queues_from_user_data() const { return queues_from_user_data_; }
+
+  // Returns the profile whose counters the generated code increments, or
+  // nullptr if activity is not profiled.
+  ActivityProfile* activity_profile() const { return activity_profile_; }
+
+  // Marks `node` (an array update) as being computed in place: the buffer
+  // passed as its output is the same buffer as that of the array operand, so
+  // only the updated element is written.
+  void SetComputedInPlace(Node* node) { in_place_nodes_.insert(node); }
+  bool IsComputedInPlace(Node* node) const {
+    return in_place_nodes_.contains(node);
+  }
+
  private:
   std::unique_ptr<llvm::Module> module_;
   OrcJit& orc_jit_;
   LlvmTypeConverter type_converter_;
   std::optional<JitChannelQueueManager*> queue_manager_;
+  ActivityProfile* activity_profile_;
+  bool queues_from_user_data_ = false;
+  absl::flat_hash_set<Node*> in_place_nodes_;
 
   // Map from FunctionBase to the associated JITed llvm::Function.
   absl::flat_hash_map<FunctionBase*, llvm::Function*> llvm_functions_;
@@ -124,6 +152,13 @@ absl::StatusOr<NodeFunction> CreateNodeFunction(Node* node,
                                                 int64_t output_arg_count,
                                                 JitBuilderContext& jit_context);
 
+// Returns the index of the queue of the channel with id `channel_id` in the
+// queue table which the generated code reads when the queues are passed
+// through the user data argument (see
+// JitBuilderContext::set_queues_from_user_data). This is the position of the
+// channel in Package::channels().
+absl::StatusOr<int64_t> QueueTableIndex(Package* package, int64_t channel_id);
+
 // Constructs a call to memcpy from `src` to `tgt` of `size` bytes.
 llvm::Value* LlvmMemcpy(llvm::Value* tgt, llvm::Value* src, int64_t size,
                         llvm::IRBuilder<>& builder);
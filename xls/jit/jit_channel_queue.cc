@@ -20,27 +20,55 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/casts.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/proc.h"
 
 namespace xls {
 namespace {
 
-void WriteValueOnQueue(const Value& value, Type* type, JitRuntime& runtime,
-                       ByteQueue& queue) {
-  absl::InlinedVector<uint8_t, ByteQueue::kInitBufferSize> buffer(
-      queue.element_size());
-  runtime.BlitValueToBuffer(value, type, absl::MakeSpan(buffer));
-  queue.Write(buffer.data());
+// Returns the segment capacity to use for the SpscByteQueue backing `channel`.
+// The FIFO depth of the channel, if specified, bounds the steady-state
+// occupancy of the queue, so segments one element larger than the depth are
+// always recycled rather than allocated (see SpscByteQueue).
+int64_t GetSegmentCapacity(Channel* channel) {
+  if (channel->kind() == ChannelKind::kStreaming) {
+    std::optional<int64_t> fifo_depth =
+        down_cast<StreamingChannel*>(channel)->GetFifoDepth();
+    if (fifo_depth.has_value() && fifo_depth.value() > 0) {
+      return fifo_depth.value() + 1;
+    }
+  }
+  return SpscJitChannelQueue::kDefaultSegmentCapacity;
 }
 
-std::optional<Value> ReadValueFromQueue(Type* type, JitRuntime& runtime,
-                                        ByteQueue& queue) {
-  std::vector<uint8_t> buffer(queue.element_size());
-  if (!queue.Read(buffer.data())) {
-    return std::nullopt;
+// Returns the procs sending and receiving on each channel of `package`, keyed
+// by channel ID.
+struct ChannelEndpoints {
+  absl::flat_hash_map<int64_t, absl::flat_hash_set<Proc*>> senders;
+  absl::flat_hash_map<int64_t, absl::flat_hash_set<Proc*>> receivers;
+};
+ChannelEndpoints GetChannelEndpoints(Package* package) {
+  ChannelEndpoints endpoints;
+  for (const std::unique_ptr<Proc>& proc : package->procs()) {
+    for (Node* node : proc->nodes()) {
+      if (node->Is<Send>()) {
+        endpoints.senders[node->As<Send>()->channel_id()].insert(proc.get());
+      } else if (node->Is<Receive>()) {
+        endpoints.receivers[node->As<Receive>()->channel_id()].insert(
+            proc.get());
+      }
+    }
   }
-  return runtime.UnpackBuffer(buffer.data(), type, /*unpoision=*/true);
+  return endpoints;
 }
 
 }  // namespace
@@ -89,16 +117,95 @@ void ByteQueue::Resize() {
   }
 }
 
+SpscByteQueue::SpscByteQueue(int64_t channel_element_size,
+                             int64_t segment_capacity)
+    : channel_element_size_(channel_element_size),
+      allocated_element_size_(
+          RoundUpToNearest(channel_element_size,
+                           static_cast<int64_t>(alignof(std::max_align_t)))),
+      segment_capacity_(int64_t{1}
+                        << CeilOfLog2(std::max(segment_capacity, int64_t{1}))) {
+  XLS_CHECK_GE(channel_element_size, 0);
+  tail_ = NewSegment();
+  head_ = tail_;
+}
+
+SpscByteQueue::~SpscByteQueue() {
+  Segment* segment = head_;
+  while (segment != nullptr) {
+    Segment* next = segment->next.load(std::memory_order_acquire);
+    delete segment;
+    segment = next;
+  }
+  delete spare_.load(std::memory_order_acquire);
+}
+
+absl::Status JitChannelQueue::SetCapacity(std::optional<int64_t> capacity) {
+  if (capacity.has_value()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Channel queue `%s` can't be bounded: JIT-compiled procs do not block "
+        "sends on a full queue",
+        channel()->name()));
+  }
+  return ChannelQueue::SetCapacity(capacity);
+}
+
+void JitChannelQueue::WriteRawBatch(const uint8_t* data, int64_t count) {
+  int64_t element_size = type_layout_.size();
+  for (int64_t i = 0; i < count; ++i) {
+    WriteRaw(data + i * element_size);
+  }
+}
+
+int64_t JitChannelQueue::ReadRawBatch(uint8_t* buffer, int64_t max_count) {
+  if (channel()->kind() == ChannelKind::kSingleValue) {
+    max_count = std::min(max_count, int64_t{1});
+  }
+  int64_t element_size = type_layout_.size();
+  int64_t count = 0;
+  while (count < max_count && ReadRaw(buffer + count * element_size)) {
+    ++count;
+  }
+  return count;
+}
+
+void ThreadSafeJitChannelQueue::WriteRawBatch(const uint8_t* data,
+                                              int64_t count) {
+  int64_t element_size = type_layout_.size();
+  absl::MutexLock lock(&mutex_);
+  for (int64_t i = 0; i < count; ++i) {
+    byte_queue_.Write(data + i * element_size);
+  }
+}
+
+int64_t ThreadSafeJitChannelQueue::ReadRawBatch(uint8_t* buffer,
+                                                int64_t max_count) {
+  if (channel()->kind() == ChannelKind::kSingleValue) {
+    max_count = std::min(max_count, int64_t{1});
+  }
+  int64_t element_size = type_layout_.size();
+  absl::MutexLock lock(&mutex_);
+  int64_t count = 0;
+  while (count < max_count) {
+    CallGenerator();
+    if (!byte_queue_.Read(buffer + count * element_size)) {
+      break;
+    }
+    ++count;
+  }
+  return count;
+}
+
 int64_t ThreadSafeJitChannelQueue::GetSizeInternal() const {
   return byte_queue_.size();
 }
 
 void ThreadSafeJitChannelQueue::WriteInternal(const Value& value) {
-  WriteValueOnQueue(value, channel()->type(), *jit_runtime_, byte_queue_);
+  WriteValueOnByteQueue(value, byte_queue_);
 }
 
 std::optional<Value> ThreadSafeJitChannelQueue::ReadInternal() {
-  return ReadValueFromQueue(channel()->type(), *jit_runtime_, byte_queue_);
+  return ReadValueFromByteQueue(byte_queue_);
 }
 
 int64_t ThreadUnsafeJitChannelQueue::GetSizeInternal() const {
@@ -106,11 +213,110 @@ int64_t ThreadUnsafeJitChannelQueue::GetSizeInternal() const {
 }
 
 void ThreadUnsafeJitChannelQueue::WriteInternal(const Value& value) {
-  WriteValueOnQueue(value, channel()->type(), *jit_runtime_, byte_queue_);
+  WriteValueOnByteQueue(value, byte_queue_);
 }
 
 std::optional<Value> ThreadUnsafeJitChannelQueue::ReadInternal() {
-  return ReadValueFromQueue(channel()->type(), *jit_runtime_, byte_queue_);
+  return ReadValueFromByteQueue(byte_queue_);
+}
+
+SpscJitChannelQueue::SpscJitChannelQueue(Channel* channel,
+                                         JitRuntime* jit_runtime)
+    : JitChannelQueue(channel, jit_runtime),
+      byte_queue_(jit_runtime->GetTypeByteSize(channel->type()),
+                  GetSegmentCapacity(channel)) {
+  XLS_CHECK_EQ(channel->kind(), ChannelKind::kStreaming)
+      << "SpscJitChannelQueue only supports streaming channels: "
+      << channel->name();
+}
+
+int64_t SpscJitChannelQueue::GetSizeInternal() const {
+  return byte_queue_.size();
+}
+
+void SpscJitChannelQueue::WriteInternal(const Value& value) {
+  WriteValueOnByteQueue(value, byte_queue_);
+}
+
+std::optional<Value> SpscJitChannelQueue::ReadInternal() {
+  return ReadValueFromByteQueue(byte_queue_);
+}
+
+InlineJitChannelQueue::InlineJitChannelQueue(Channel* channel,
+                                             JitRuntime* jit_runtime)
+    : JitChannelQueue(channel, jit_runtime),
+      element_size_(jit_runtime->GetTypeByteSize(channel->type())),
+      stride_(std::max(
+          RoundUpToNearest(element_size_,
+                           static_cast<int64_t>(alignof(std::max_align_t))),
+          int64_t{1})) {
+  XLS_CHECK_EQ(channel->kind(), ChannelKind::kStreaming)
+      << "InlineJitChannelQueue only supports streaming channels: "
+      << channel->name();
+  std::optional<int64_t> fifo_depth =
+      down_cast<StreamingChannel*>(channel)->GetFifoDepth();
+  int64_t capacity = fifo_depth.has_value() && fifo_depth.value() > 0
+                         ? fifo_depth.value()
+                         : kDefaultCapacity;
+  capacity = int64_t{1} << CeilOfLog2(capacity);
+  storage_.resize(capacity * stride_);
+  ring_ = JitRingBuffer{
+      .data = storage_.data(), .capacity = capacity, .read_index = 0,
+      .size = 0};
+}
+
+void InlineJitChannelQueue::Grow() {
+  std::vector<uint8_t> storage(storage_.size() * 2);
+  for (int64_t i = 0; i < ring_.size; ++i) {
+    int64_t slot = (ring_.read_index + i) & (ring_.capacity - 1);
+    std::copy_n(storage_.begin() + slot * stride_, stride_,
+                storage.begin() + i * stride_);
+  }
+  storage_ = std::move(storage);
+  ring_.data = storage_.data();
+  ring_.capacity *= 2;
+  ring_.read_index = 0;
+}
+
+void InlineJitChannelQueue::WriteRaw(const uint8_t* data) {
+#ifdef ABSL_HAVE_MEMORY_SANITIZER
+  __msan_unpoison(data, element_size_);
+#endif
+  if (ring_.size == ring_.capacity) {
+    Grow();
+  }
+  int64_t slot = (ring_.read_index + ring_.size) & (ring_.capacity - 1);
+  std::copy_n(data, element_size_, ring_.data + slot * stride_);
+  ++ring_.size;
+}
+
+bool InlineJitChannelQueue::ReadRaw(uint8_t* buffer) {
+  CallGenerator();
+  return ReadFromRing(buffer);
+}
+
+bool InlineJitChannelQueue::ReadFromRing(uint8_t* buffer) {
+  if (ring_.size == 0) {
+    return false;
+  }
+  std::copy_n(ring_.data + ring_.read_index * stride_, element_size_, buffer);
+  ring_.read_index = (ring_.read_index + 1) & (ring_.capacity - 1);
+  --ring_.size;
+  return true;
+}
+
+int64_t InlineJitChannelQueue::GetSizeInternal() const { return ring_.size; }
+
+void InlineJitChannelQueue::WriteInternal(const Value& value) {
+  type_layout_.ValueToNativeLayout(value, write_buffer_.data());
+  WriteRaw(write_buffer_.data());
+}
+
+std::optional<Value> InlineJitChannelQueue::ReadInternal() {
+  if (!ReadFromRing(read_buffer_.data())) {
+    return std::nullopt;
+  }
+  return type_layout_.NativeLayoutToValue(read_buffer_.data());
 }
 
 /* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
@@ -139,6 +345,52 @@ JitChannelQueueManager::CreateThreadUnsafe(Package* package) {
                                                      std::move(runtime)));
 }
 
+/* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
+JitChannelQueueManager::CreateLockFree(Package* package) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitRuntime> runtime,
+                       JitRuntime::Create());
+
+  // Count the procs sending and receiving on each channel.
+  ChannelEndpoints endpoints = GetChannelEndpoints(package);
+
+  std::vector<std::unique_ptr<ChannelQueue>> queues;
+  for (Channel* channel : package->channels()) {
+    if (channel->kind() == ChannelKind::kStreaming &&
+        endpoints.senders[channel->id()].size() <= 1 &&
+        endpoints.receivers[channel->id()].size() <= 1) {
+      queues.push_back(
+          std::make_unique<SpscJitChannelQueue>(channel, runtime.get()));
+    } else {
+      queues.push_back(
+          std::make_unique<ThreadSafeJitChannelQueue>(channel, runtime.get()));
+    }
+  }
+  return absl::WrapUnique(new JitChannelQueueManager(package, std::move(queues),
+                                                     std::move(runtime)));
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
+JitChannelQueueManager::CreateInline(Package* package) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitRuntime> runtime,
+                       JitRuntime::Create());
+  ChannelEndpoints endpoints = GetChannelEndpoints(package);
+
+  std::vector<std::unique_ptr<ChannelQueue>> queues;
+  for (Channel* channel : package->channels()) {
+    if (channel->kind() == ChannelKind::kStreaming &&
+        !endpoints.senders[channel->id()].empty() &&
+        !endpoints.receivers[channel->id()].empty()) {
+      queues.push_back(
+          std::make_unique<InlineJitChannelQueue>(channel, runtime.get()));
+    } else {
+      queues.push_back(std::make_unique<ThreadUnsafeJitChannelQueue>(
+          channel, runtime.get()));
+    }
+  }
+  return absl::WrapUnique(new JitChannelQueueManager(package, std::move(queues),
+                                                     std::move(runtime)));
+}
+
 JitChannelQueue& JitChannelQueueManager::GetJitQueue(Channel* channel) {
   JitChannelQueue* queue = dynamic_cast<JitChannelQueue*>(&GetQueue(channel));
   XLS_CHECK_NE(queue, nullptr);
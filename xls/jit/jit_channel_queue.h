@@ -15,6 +15,7 @@
 #define XLS_JIT_JIT_CHANNEL_QUEUE_H_
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -36,6 +37,7 @@
 #include "xls/ir/package.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -117,20 +119,182 @@ class ByteQueue {
   bool is_single_value_;
 };
 
+// A lock-free queue of raw bytes for the case of a single producer thread and a
+// single consumer thread (SPSC). Only FIFO semantics are supported. Elements
+// are stored in a linked list of fixed-capacity segments: the producer appends
+// a segment when the current one is full and the consumer releases segments it
+// has drained, so the queue is unbounded like ByteQueue but neither side ever
+// takes a lock. A drained segment is handed back to the producer through a
+// single-slot free list rather than freed. While the queue holds fewer
+// elements than the segment capacity (e.g., the FIFO depth of the channel plus
+// one) the producer always finds the recycled segment there, so no allocation
+// occurs once the second segment has been allocated. Only a consumer which
+// falls further behind causes segments to be allocated (and later freed).
+class SpscByteQueue {
+ public:
+  // `channel_element_size` is the number of bytes in each element.
+  // `segment_capacity` is the number of elements held in each segment.
+  SpscByteQueue(int64_t channel_element_size, int64_t segment_capacity);
+  ~SpscByteQueue();
+
+  int64_t element_size() const { return channel_element_size_; }
+
+  // Must only be called from the producer thread.
+  void Write(const uint8_t* data) {
+#ifdef ABSL_HAVE_MEMORY_SANITIZER
+    __msan_unpoison(data, channel_element_size_);
+#endif
+    int64_t write_index = write_index_.load(std::memory_order_relaxed);
+    int64_t slot = write_index & (segment_capacity_ - 1);
+    if (slot == 0 && write_index != 0) {
+      // The tail segment is full. Publish a recycled or fresh segment to the
+      // consumer.
+      Segment* segment = spare_.exchange(nullptr, std::memory_order_acquire);
+      if (segment == nullptr) {
+        segment = NewSegment();
+      } else {
+        segment->next.store(nullptr, std::memory_order_relaxed);
+      }
+      tail_->next.store(segment, std::memory_order_release);
+      tail_ = segment;
+    }
+    memcpy(tail_->data.data() + slot * allocated_element_size_, data,
+           channel_element_size_);
+    write_index_.store(write_index + 1, std::memory_order_release);
+  }
+
+  // Must only be called from the consumer thread. Returns false if the queue
+  // is empty.
+  bool Read(uint8_t* buffer) {
+    int64_t read_index = read_index_.load(std::memory_order_relaxed);
+    if (read_index == write_index_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    int64_t slot = read_index & (segment_capacity_ - 1);
+    if (slot == 0 && read_index != 0) {
+      // The head segment has been drained and the producer has necessarily
+      // moved on to the next segment. Hand the drained segment back to the
+      // producer, freeing the previous spare if the producer has not taken it.
+      Segment* next = head_->next.load(std::memory_order_acquire);
+      delete spare_.exchange(head_, std::memory_order_acq_rel);
+      head_ = next;
+    }
+    memcpy(buffer, head_->data.data() + slot * allocated_element_size_,
+           channel_element_size_);
+    read_index_.store(read_index + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Returns the number of elements in the queue. The value is exact only when
+  // called while neither the producer nor the consumer is active.
+  int64_t size() const {
+    return write_index_.load(std::memory_order_acquire) -
+           read_index_.load(std::memory_order_acquire);
+  }
+
+ private:
+  struct Segment {
+    explicit Segment(int64_t byte_count) : data(byte_count) {}
+
+    std::vector<uint8_t> data;
+    std::atomic<Segment*> next = nullptr;
+  };
+
+  Segment* NewSegment() const {
+    return new Segment(segment_capacity_ * allocated_element_size_);
+  }
+
+  // Size of an element in the channel in units of bytes.
+  int64_t channel_element_size_;
+  // Allocated size of an element in a segment in units of bytes. The elements
+  // are aligned to the largest scalar type.
+  int64_t allocated_element_size_;
+  // Number of elements per segment. Always a power of two.
+  int64_t segment_capacity_;
+
+  // Total number of elements ever written and read. The indices are on
+  // separate cache lines to avoid false sharing between the producer and the
+  // consumer.
+  alignas(64) std::atomic<int64_t> write_index_ = 0;
+  // Segment currently written by the producer. Only touched by the producer.
+  Segment* tail_;
+  alignas(64) std::atomic<int64_t> read_index_ = 0;
+  // Segment currently read by the consumer. Only touched by the consumer.
+  Segment* head_;
+  // A drained segment released by the consumer for reuse by the producer, or
+  // nullptr.
+  std::atomic<Segment*> spare_ = nullptr;
+};
+
 // Abstract base class for channel queues which may be used by the JIT. These
 // queues support reading and writing raw bytes to the queue rather the just
 // xls::Values.
+//
+// Values are stored in the queue in the native layout of the JIT so jitted
+// sends and receives are plain copies of bytes between procs. Conversion
+// to/from xls::Value only happens when the queue is accessed through the
+// Value-based ChannelQueue interface (e.g., by a host-side reader or writer).
 class JitChannelQueue : public ChannelQueue {
  public:
   JitChannelQueue(Channel* channel, JitRuntime* jit_runtime)
-      : ChannelQueue(channel), jit_runtime_(jit_runtime) {}
+      : ChannelQueue(channel),
+        jit_runtime_(jit_runtime),
+        type_layout_(jit_runtime->CreateTypeLayout(channel->type())),
+        write_buffer_(type_layout_.size()),
+        read_buffer_(type_layout_.size()) {}
   ~JitChannelQueue() override = default;
 
+  // Writes (reads) raw bytes representing a value in the native layout
+  // described by `type_layout()`.
   virtual void WriteRaw(const uint8_t* data) = 0;
   virtual bool ReadRaw(uint8_t* buffer) = 0;
 
+  // Writes `count` values stored back to back in the native layout, each
+  // `type_layout().size()` bytes, starting at `data`.
+  virtual void WriteRawBatch(const uint8_t* data, int64_t count);
+
+  // Reads up to `max_count` values into `buffer` back to back in the native
+  // layout and returns the number of values read. Reading stops when the
+  // queue (after consulting the generator) is empty. At most one value is
+  // read from a single-value channel.
+  virtual int64_t ReadRawBatch(uint8_t* buffer, int64_t max_count);
+
+  // Returns the native layout of the values in the queue.
+  const TypeLayout& type_layout() const { return type_layout_; }
+
+  // JIT-compiled sends never block, so a bounded capacity is rejected with an
+  // InvalidArgumentError rather than silently ignored.
+  absl::Status SetCapacity(std::optional<int64_t> capacity) override;
+
  protected:
+  // Write/read a Value to/from the given byte queue converting to/from the
+  // native layout.
+  template <typename ByteQueueT>
+  void WriteValueOnByteQueue(const Value& value, ByteQueueT& queue) {
+    // Bytes of the buffer not covered by any leaf element (e.g., padding
+    // between tuple elements) are never written so they remain zero.
+    type_layout_.ValueToNativeLayout(value, write_buffer_.data());
+    queue.Write(write_buffer_.data());
+  }
+  template <typename ByteQueueT>
+  std::optional<Value> ReadValueFromByteQueue(ByteQueueT& queue) {
+    if (!queue.Read(read_buffer_.data())) {
+      return std::nullopt;
+    }
+#ifdef ABSL_HAVE_MEMORY_SANITIZER
+    __msan_unpoison(read_buffer_.data(), read_buffer_.size());
+#endif
+    return type_layout_.NativeLayoutToValue(read_buffer_.data());
+  }
+
   JitRuntime* jit_runtime_;
+  TypeLayout type_layout_;
+
+  // Scratch buffers used for converting values to and from the native layout.
+  // Separate buffers are used for writing and reading so the producer and
+  // consumer sides do not share state.
+  std::vector<uint8_t> write_buffer_;
+  std::vector<uint8_t> read_buffer_;
 };
 
 // A thread-safe version of the JIT channel queue. All accesses are guarded by a
@@ -153,15 +317,14 @@ class ThreadSafeJitChannelQueue : public JitChannelQueue {
   // true if queue was not empty and data was read.
   bool ReadRaw(uint8_t* buffer) override {
     absl::MutexLock lock(&mutex_);
-    if (generator_.has_value()) {
-      std::optional<Value> generated_value = (*generator_)();
-      if (generated_value.has_value()) {
-        WriteInternal(generated_value.value());
-      }
-    }
+    CallGenerator();
     return byte_queue_.Read(buffer);
   }
 
+  // Batched variants which acquire the lock once for all values.
+  void WriteRawBatch(const uint8_t* data, int64_t count) override;
+  int64_t ReadRawBatch(uint8_t* buffer, int64_t max_count) override;
+
  protected:
   int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
   void WriteInternal(const Value& value)
@@ -183,12 +346,7 @@ class ThreadUnsafeJitChannelQueue : public JitChannelQueue {
 
   void WriteRaw(const uint8_t* data) override { byte_queue_.Write(data); }
   bool ReadRaw(uint8_t* buffer) override {
-    if (generator_.has_value()) {
-      std::optional<Value> generated_value = (*generator_)();
-      if (generated_value.has_value()) {
-        WriteInternal(generated_value.value());
-      }
-    }
+    CallGenerator();
     return byte_queue_.Read(buffer);
   }
 
@@ -200,6 +358,88 @@ class ThreadUnsafeJitChannelQueue : public JitChannelQueue {
   ByteQueue byte_queue_;
 };
 
+// A JIT channel queue for streaming channels with a single producer and a
+// single consumer. Raw reads and writes are lock-free and may be performed
+// concurrently by one producer thread and one consumer thread.
+class SpscJitChannelQueue : public JitChannelQueue {
+ public:
+  SpscJitChannelQueue(Channel* channel, JitRuntime* jit_runtime);
+  ~SpscJitChannelQueue() override = default;
+
+  void WriteRaw(const uint8_t* data) override { byte_queue_.Write(data); }
+  bool ReadRaw(uint8_t* buffer) override {
+    CallGenerator();
+    return byte_queue_.Read(buffer);
+  }
+
+  // Default number of elements per segment of the underlying queue when the
+  // channel does not specify a FIFO depth.
+  static constexpr int64_t kDefaultSegmentCapacity = 64;
+
+ protected:
+  int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  void WriteInternal(const Value& value) override;
+  std::optional<Value> ReadInternal() override;
+
+  SpscByteQueue byte_queue_;
+};
+
+// The storage of an InlineJitChannelQueue. Jitted sends and receives on the
+// queue access these fields directly (see IrBuilderVisitor) so the layout must
+// be kept in sync with the generated code.
+struct JitRingBuffer {
+  // Storage for `capacity` elements of `InlineJitChannelQueue::stride()` bytes.
+  uint8_t* data;
+  // Number of element slots in `data`. Always a power of two.
+  int64_t capacity;
+  // Slot holding the oldest element in the queue.
+  int64_t read_index;
+  // Number of elements in the queue.
+  int64_t size;
+};
+
+// A JIT channel queue for streaming channels whose storage is a ring buffer
+// with a layout known to the JIT. Jitted sends and receives on the channel
+// copy elements to and from the ring buffer with inline code rather than
+// calling into the queue. Only a send to a full ring (which grows the ring) or
+// a receive from an empty ring (which may call the generator) falls back to
+// WriteRaw/ReadRaw. The initial capacity is the FIFO depth of the channel, if
+// specified. Not thread-safe: jitted accesses are not synchronized.
+class InlineJitChannelQueue : public JitChannelQueue {
+ public:
+  InlineJitChannelQueue(Channel* channel, JitRuntime* jit_runtime);
+  ~InlineJitChannelQueue() override = default;
+
+  void WriteRaw(const uint8_t* data) override;
+  bool ReadRaw(uint8_t* buffer) override;
+
+  JitRingBuffer* ring() { return &ring_; }
+
+  // Number of bytes between consecutive elements in the ring buffer.
+  int64_t stride() const { return stride_; }
+
+  // Default capacity when the channel does not specify a FIFO depth.
+  static constexpr int64_t kDefaultCapacity = 64;
+
+ protected:
+  int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  void WriteInternal(const Value& value) override;
+  std::optional<Value> ReadInternal() override;
+
+ private:
+  // Doubles the capacity of the ring buffer preserving its contents.
+  void Grow();
+
+  // Reads the oldest element into `buffer` without consulting the generator.
+  // Returns false if the ring buffer is empty.
+  bool ReadFromRing(uint8_t* buffer);
+
+  int64_t element_size_;
+  int64_t stride_;
+  std::vector<uint8_t> storage_;
+  JitRingBuffer ring_;
+};
+
 // A Channel manager which holds exclusively JitChannelQueues.
 class JitChannelQueueManager : public ChannelQueueManager {
  public:
@@ -212,6 +452,20 @@ class JitChannelQueueManager : public ChannelQueueManager {
   static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
   CreateThreadUnsafe(Package* package);
 
+  // Factory which creates a queue manager with thread-safe queues, using
+  // lock-free SpscJitChannelQueues for every streaming channel which is used
+  // by at most one sending proc and at most one receiving proc and
+  // ThreadSafeJitChannelQueues for all other channels.
+  static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
+  CreateLockFree(Package* package);
+
+  // Factory which creates a queue manager for single-threaded runtimes using
+  // InlineJitChannelQueues for every streaming channel which is both sent on
+  // and received on by procs in the package and ThreadUnsafeJitChannelQueues
+  // for all other channels.
+  static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>> CreateInline(
+      Package* package);
+
   JitChannelQueue& GetJitQueue(Channel* channel);
 
   JitRuntime& runtime() { return *runtime_; }
@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <thread>  // NOLINT(build/c++11)
 #include <vector>
 
 #include "include/benchmark/benchmark.h"
@@ -82,6 +83,63 @@ BENCHMARK(BM_QueueWriteThenRead<ThreadUnsafeJitChannelQueue>)
     ->ArgPair(2048, 1)
     ->ArgPair(2048, 128);
 
+BENCHMARK(BM_QueueWriteThenRead<SpscJitChannelQueue>)
+    ->ArgPair(1, 1)
+    ->ArgPair(1, 128)
+    ->ArgPair(8, 1)
+    ->ArgPair(8, 128)
+    ->ArgPair(32, 1)
+    ->ArgPair(32, 128)
+    ->ArgPair(2048, 1)
+    ->ArgPair(2048, 128);
+
+// Benchmark evaluating a producer thread writing to the channel concurrently
+// with a consumer thread reading from the channel.
+template <typename QueueT,
+          typename std::enable_if<std::is_base_of_v<JitChannelQueue, QueueT>,
+                                  QueueT>::type* = nullptr>
+static void BM_QueueConcurrentWriteAndRead(benchmark::State& state) {
+  int64_t element_size_bytes = state.range(0);
+
+  Package package("benchmark");
+  std::unique_ptr<JitRuntime> jit_runtime = JitRuntime::Create().value();
+  Channel* channel =
+      package
+          .CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                  package.GetBitsType(8 * element_size_bytes))
+          .value();
+  QueueT queue(channel, jit_runtime.get());
+
+  int64_t send_count = state.range(1);
+  std::vector<uint8_t> send_buffer(element_size_bytes);
+  std::vector<uint8_t> recv_buffer(element_size_bytes);
+  std::fill(send_buffer.begin(), send_buffer.end(), 42);
+  for (auto _ : state) {
+    std::thread producer([&]() {
+      for (int64_t i = 0; i < send_count; ++i) {
+        queue.WriteRaw(send_buffer.data());
+      }
+    });
+    int64_t recv_count = 0;
+    while (recv_count < send_count) {
+      if (queue.ReadRaw(recv_buffer.data())) {
+        ++recv_count;
+      }
+    }
+    producer.join();
+  }
+}
+
+BENCHMARK(BM_QueueConcurrentWriteAndRead<ThreadSafeJitChannelQueue>)
+    ->ArgPair(8, 1024)
+    ->ArgPair(32, 1024)
+    ->ArgPair(2048, 1024);
+
+BENCHMARK(BM_QueueConcurrentWriteAndRead<SpscJitChannelQueue>)
+    ->ArgPair(8, 1024)
+    ->ArgPair(32, 1024)
+    ->ArgPair(2048, 1024);
+
 }  // namespace
 }  // namespace xls
 
@@ -14,7 +14,10 @@
 
 #include "xls/jit/jit_channel_queue.h"
 
+#include <cstring>
 #include <memory>
+#include <optional>
+#include <thread>  // NOLINT(build/c++11)
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -22,14 +25,19 @@
 #include "xls/common/status/matchers.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/channel_queue_test_base.h"
+#include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 namespace {
 
 using status_testing::StatusIs;
 using ::testing::HasSubstr;
+using ::testing::Optional;
 
 JitRuntime* GetJitRuntime() {
   static auto jit_runtime =
@@ -55,7 +63,8 @@ template <typename QueueT>
 class JitChannelQueueTest : public ::testing::Test {};
 
 using QueueTypes =
-    ::testing::Types<ThreadSafeJitChannelQueue, ThreadUnsafeJitChannelQueue>;
+    ::testing::Types<ThreadSafeJitChannelQueue, ThreadUnsafeJitChannelQueue,
+                     SpscJitChannelQueue, InlineJitChannelQueue>;
 TYPED_TEST_SUITE(JitChannelQueueTest, QueueTypes);
 
 // An empty tuple represents a zero width.
@@ -125,6 +134,43 @@ TYPED_TEST(JitChannelQueueTest, BasicAccess) {
   EXPECT_TRUE(queue.IsEmpty());
 }
 
+// Values written through the Value interface are stored in native layout and
+// may be read back raw, and vice versa.
+TYPED_TEST(JitChannelQueueTest, MixedValueAndRawAccess) {
+  Package package("test");
+  Type* type = package.GetTupleType(
+      {package.GetBitsType(3), package.GetArrayType(2, package.GetBitsType(17)),
+       package.GetBitsType(64)});
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     type));
+  TypeParam queue(channel, GetJitRuntime());
+  const TypeLayout& layout = queue.type_layout();
+  EXPECT_EQ(layout.size(), GetJitRuntime()->GetTypeByteSize(type));
+
+  Value value = Value::Tuple(
+      {Value(UBits(5, 3)),
+       Value::ArrayOrDie({Value(UBits(1234, 17)), Value(UBits(99999, 17))}),
+       Value(UBits(0xdeadbeefcafe, 64))});
+  std::vector<uint8_t> expected(layout.size());
+  layout.ValueToNativeLayout(value, expected.data());
+
+  XLS_ASSERT_OK(queue.Write(value));
+  std::vector<uint8_t> raw(layout.size());
+  EXPECT_TRUE(queue.ReadRaw(raw.data()));
+  EXPECT_EQ(layout.NativeLayoutToValue(raw.data()), value);
+  for (const ElementLayout& element : layout.elements()) {
+    for (int64_t i = 0; i < element.data_size; ++i) {
+      EXPECT_EQ(raw[element.offset + i], expected[element.offset + i]);
+    }
+  }
+
+  queue.WriteRaw(expected.data());
+  EXPECT_EQ(queue.Read(), value);
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
 TYPED_TEST(JitChannelQueueTest, IotaGeneratorWithRawApi) {
   Package package("test");
   XLS_ASSERT_OK_AND_ASSIGN(
@@ -156,5 +202,221 @@ TYPED_TEST(JitChannelQueueTest, IotaGeneratorWithRawApi) {
                                  "a generator function")));
 }
 
+TYPED_TEST(JitChannelQueueTest, RawBatchAccess) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  TypeParam queue(channel, GetJitRuntime());
+  ASSERT_EQ(queue.type_layout().size(), 4);
+
+  std::vector<uint32_t> send_values = {1, 2, 3, 4, 5};
+  queue.WriteRawBatch(reinterpret_cast<const uint8_t*>(send_values.data()),
+                      send_values.size());
+  EXPECT_EQ(queue.GetSize(), 5);
+
+  std::vector<uint32_t> recv_values(8);
+  EXPECT_EQ(
+      queue.ReadRawBatch(reinterpret_cast<uint8_t*>(recv_values.data()), 3),
+      3);
+  EXPECT_EQ(queue.ReadRawBatch(
+                reinterpret_cast<uint8_t*>(recv_values.data() + 3), 5),
+            2);
+  recv_values.resize(5);
+  EXPECT_EQ(recv_values, send_values);
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TYPED_TEST(JitChannelQueueTest, BatchGeneratorWithRawApi) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  TypeParam queue(channel, GetJitRuntime());
+
+  int64_t counter = 0;
+  XLS_ASSERT_OK(queue.AttachBatchGenerator(
+      [&](int64_t max_count) {
+        std::vector<Value> values;
+        for (int64_t i = 0; i < max_count && counter < 10; ++i) {
+          values.push_back(Value(UBits(counter++, 32)));
+        }
+        return values;
+      },
+      /*batch_size=*/4));
+
+  std::vector<uint32_t> recv_values(16);
+  EXPECT_EQ(
+      queue.ReadRawBatch(reinterpret_cast<uint8_t*>(recv_values.data()), 16),
+      10);
+  for (int64_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(recv_values[i], i);
+  }
+  EXPECT_FALSE(queue.ReadRaw(reinterpret_cast<uint8_t*>(recv_values.data())));
+}
+
+TEST(SpscJitChannelQueueTest, ManySegments) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32),
+                                     /*initial_values=*/{},
+                                     /*fifo_depth=*/3));
+  SpscJitChannelQueue queue(channel, GetJitRuntime());
+
+  // Interleave writes and reads such that the queue spans several segments.
+  uint32_t next_write = 0;
+  uint32_t next_read = 0;
+  for (int64_t round = 0; round < 20; ++round) {
+    for (int64_t i = 0; i < round; ++i) {
+      queue.WriteRaw(reinterpret_cast<uint8_t*>(&next_write));
+      ++next_write;
+    }
+    EXPECT_EQ(queue.GetSize(), next_write - next_read);
+    for (int64_t i = 0; i < round / 2; ++i) {
+      uint32_t value;
+      EXPECT_TRUE(queue.ReadRaw(reinterpret_cast<uint8_t*>(&value)));
+      EXPECT_EQ(value, next_read);
+      ++next_read;
+    }
+  }
+  while (next_read < next_write) {
+    uint32_t value;
+    EXPECT_TRUE(queue.ReadRaw(reinterpret_cast<uint8_t*>(&value)));
+    EXPECT_EQ(value, next_read);
+    ++next_read;
+  }
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(SpscJitChannelQueueTest, ConcurrentProducerAndConsumer) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(64)));
+  SpscJitChannelQueue queue(channel, GetJitRuntime());
+
+  constexpr uint64_t kCount = 100000;
+  std::thread producer([&]() {
+    for (uint64_t i = 0; i < kCount; ++i) {
+      queue.WriteRaw(reinterpret_cast<uint8_t*>(&i));
+    }
+  });
+  uint64_t expected = 0;
+  while (expected < kCount) {
+    uint64_t value;
+    if (queue.ReadRaw(reinterpret_cast<uint8_t*>(&value))) {
+      ASSERT_EQ(value, expected);
+      ++expected;
+    }
+  }
+  producer.join();
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(InlineJitChannelQueueTest, RingGrowsAndWraps) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32),
+                                     /*initial_values=*/{},
+                                     /*fifo_depth=*/3));
+  InlineJitChannelQueue queue(channel, GetJitRuntime());
+  EXPECT_EQ(queue.ring()->capacity, 4);
+
+  // Interleave writes and reads such that the ring wraps around and grows
+  // while holding elements.
+  uint32_t next_write = 0;
+  uint32_t next_read = 0;
+  for (int64_t round = 0; round < 20; ++round) {
+    for (int64_t i = 0; i < round; ++i) {
+      queue.WriteRaw(reinterpret_cast<uint8_t*>(&next_write));
+      ++next_write;
+    }
+    EXPECT_EQ(queue.GetSize(), next_write - next_read);
+    for (int64_t i = 0; i < round / 2; ++i) {
+      uint32_t value;
+      EXPECT_TRUE(queue.ReadRaw(reinterpret_cast<uint8_t*>(&value)));
+      EXPECT_EQ(value, next_read);
+      ++next_read;
+    }
+  }
+  EXPECT_GT(queue.ring()->capacity, 4);
+  while (next_read < next_write) {
+    EXPECT_THAT(queue.Read(), Optional(Value(UBits(next_read, 32))));
+    ++next_read;
+  }
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(JitChannelQueueManagerTest, CreateInline) {
+  auto package = std::make_unique<Package>("test");
+  Type* u32 = package->GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * internal,
+      package->CreateStreamingChannel("internal", ChannelOps::kSendReceive,
+                                      u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * output,
+      package->CreateStreamingChannel("output", ChannelOps::kSendOnly, u32));
+  ProcBuilder pb("forward", /*token_name=*/"tok", package.get());
+  BValue receive = pb.Receive(internal, pb.GetTokenParam());
+  BValue send = pb.Send(output, pb.TupleIndex(receive, 0),
+                        pb.TupleIndex(receive, 1));
+  BValue last = pb.Send(internal, send, pb.TupleIndex(receive, 1));
+  XLS_ASSERT_OK(pb.Build(last, {}).status());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> manager,
+      JitChannelQueueManager::CreateInline(package.get()));
+  EXPECT_NE(
+      dynamic_cast<InlineJitChannelQueue*>(&manager->GetQueue(internal)),
+      nullptr);
+  EXPECT_NE(
+      dynamic_cast<ThreadUnsafeJitChannelQueue*>(&manager->GetQueue(output)),
+      nullptr);
+}
+
+TEST(JitChannelQueueManagerTest, CreateLockFree) {
+  Package package("test");
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * streaming,
+      package.CreateStreamingChannel("streaming", ChannelOps::kSendReceive,
+                                     u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * single_value,
+      package.CreateSingleValueChannel("single_value",
+                                       ChannelOps::kSendReceive, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitChannelQueueManager> manager,
+                           JitChannelQueueManager::CreateLockFree(&package));
+  EXPECT_NE(dynamic_cast<SpscJitChannelQueue*>(&manager->GetQueue(streaming)),
+            nullptr);
+  EXPECT_NE(dynamic_cast<ThreadSafeJitChannelQueue*>(
+                &manager->GetQueue(single_value)),
+            nullptr);
+}
+
+TEST(JitChannelQueueManagerTest, BoundedQueuesRejected) {
+  Package package("test");
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * fifo,
+      package.CreateStreamingChannel("fifo", ChannelOps::kSendReceive, u32,
+                                     /*initial_values=*/{}, /*fifo_depth=*/2));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitChannelQueueManager> manager,
+                           JitChannelQueueManager::CreateThreadSafe(&package));
+  EXPECT_THAT(manager->BoundQueuesToFifoDepth(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("JIT-compiled procs do not block")));
+  EXPECT_EQ(manager->GetQueue(fifo).capacity(), std::nullopt);
+  XLS_EXPECT_OK(manager->GetQueue(fifo).SetCapacity(std::nullopt));
+}
+
 }  // namespace
 }  // namespace xls
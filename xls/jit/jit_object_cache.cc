@@ -0,0 +1,111 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_object_cache.h"
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+#include <thread>  // NOLINT(build/c++11)
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "llvm/include/llvm/ADT/StringExtras.h"
+#include "llvm/include/llvm/Config/llvm-config.h"
+#include "llvm/include/llvm/Support/SHA1.h"
+#include "llvm/include/llvm/Support/raw_ostream.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls {
+
+/* static */ std::string JitObjectCache::ComputeKey(
+    const llvm::Module& module, int64_t opt_level,
+    const llvm::TargetMachine& target_machine) {
+  llvm::SHA1 hasher;
+  hasher.update(absl::StrFormat(
+      "llvm=%s;opt_level=%d;triple=%s;cpu=%s;features=%s;", LLVM_VERSION_STRING,
+      opt_level, target_machine.getTargetTriple().normalize(),
+      target_machine.getTargetCPU().str(),
+      target_machine.getTargetFeatureString().str()));
+  std::string module_text;
+  llvm::raw_string_ostream ostream(module_text);
+  module.print(ostream, nullptr);
+  ostream.flush();
+  hasher.update(module_text);
+  return absl::StrCat(kKeyPrefix, llvm::toHex(hasher.final(),
+                                              /*LowerCase=*/true));
+}
+
+std::filesystem::path JitObjectCache::GetPath(std::string_view key) const {
+  return directory_ / absl::StrCat(key, ".o");
+}
+
+absl::StatusOr<std::optional<std::string>> JitObjectCache::Lookup(
+    std::string_view key) const {
+  std::filesystem::path path = GetPath(key);
+  absl::Status exists = FileExists(path);
+  if (absl::IsNotFound(exists)) {
+    XLS_VLOG(2) << "JIT object cache miss: " << path;
+    return std::nullopt;
+  }
+  XLS_RETURN_IF_ERROR(exists);
+  XLS_VLOG(2) << "JIT object cache hit: " << path;
+  XLS_ASSIGN_OR_RETURN(std::string object, GetFileContents(path));
+  return object;
+}
+
+absl::Status JitObjectCache::Insert(std::string_view key,
+                                    std::string_view object) const {
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(directory_));
+  std::filesystem::path path = GetPath(key);
+  // Write to a uniquely named temporary file then rename so readers never
+  // observe a partially written object.
+  std::filesystem::path temp_path = absl::StrFormat(
+      "%s.tmp.%d.%d", path.string(), getpid(),
+      std::hash<std::thread::id>()(std::this_thread::get_id()));
+  XLS_RETURN_IF_ERROR(SetFileContents(temp_path, object));
+  std::error_code ec;
+  std::filesystem::rename(temp_path, path, ec);
+  if (ec) {
+    return absl::InternalError(absl::StrFormat(
+        "Unable to rename %s to %s: %s", temp_path, path, ec.message()));
+  }
+  return absl::OkStatus();
+}
+
+void JitObjectCache::notifyObjectCompiled(const llvm::Module* module,
+                                          llvm::MemoryBufferRef object) {
+  std::string key = module->getModuleIdentifier();
+  if (!absl::StartsWith(key, kKeyPrefix)) {
+    return;
+  }
+  absl::Status status = Insert(
+      key, std::string_view(object.getBufferStart(), object.getBufferSize()));
+  if (!status.ok()) {
+    // Failing to populate the cache is not fatal.
+    XLS_LOG(WARNING) << "Unable to write JIT object cache entry: " << status;
+  }
+}
+
+}  // namespace xls
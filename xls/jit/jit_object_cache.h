@@ -0,0 +1,86 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_JIT_OBJECT_CACHE_H_
+#define XLS_JIT_JIT_OBJECT_CACHE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "llvm/include/llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/include/llvm/IR/Module.h"
+#include "llvm/include/llvm/Support/MemoryBuffer.h"
+#include "llvm/include/llvm/Target/TargetMachine.h"
+
+namespace xls {
+
+// A persistent, content-addressed cache of object code emitted by the JIT.
+// Objects are stored as files in a directory named by a key which is a hash of
+// the unoptimized LLVM IR of the module, the optimization level, the target
+// (triple, CPU and features), and the LLVM version. Repeated compilation of the
+// same XLS IR can then skip LLVM optimization and codegen entirely.
+//
+// Usage: the key is computed with ComputeKey and looked up with Lookup prior to
+// compilation. On a miss the module identifier is set to the key and the
+// module is compiled by a compiler with this object as its llvm::ObjectCache.
+// The emitted object is then written to the cache under the module
+// identifier.
+//
+// Writes are atomic (write to a temporary file then rename) so a cache
+// directory may be shared by concurrent processes.
+class JitObjectCache : public llvm::ObjectCache {
+ public:
+  explicit JitObjectCache(std::filesystem::path directory)
+      : directory_(std::move(directory)) {}
+  ~JitObjectCache() override = default;
+
+  // Returns the cache key for the given (unoptimized) module.
+  static std::string ComputeKey(const llvm::Module& module, int64_t opt_level,
+                                const llvm::TargetMachine& target_machine);
+
+  // Returns the cached object with the given key or std::nullopt if no such
+  // object exists.
+  absl::StatusOr<std::optional<std::string>> Lookup(std::string_view key) const;
+
+  // Writes the object for the given key to the cache.
+  absl::Status Insert(std::string_view key, std::string_view object) const;
+
+  // llvm::ObjectCache interface. Objects compiled for modules whose identifier
+  // is a cache key are written to the cache. getObject always returns nullptr
+  // as lookups are performed prior to optimization via Lookup.
+  void notifyObjectCompiled(const llvm::Module* module,
+                            llvm::MemoryBufferRef object) override;
+  std::unique_ptr<llvm::MemoryBuffer> getObject(
+      const llvm::Module* module) override {
+    return nullptr;
+  }
+
+  const std::filesystem::path& directory() const { return directory_; }
+
+  // Prefix of all cache keys.
+  static constexpr std::string_view kKeyPrefix = "xls_jit_";
+
+ private:
+  std::filesystem::path GetPath(std::string_view key) const;
+
+  std::filesystem::path directory_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_OBJECT_CACHE_H_
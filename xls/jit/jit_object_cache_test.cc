@@ -0,0 +1,105 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_object_cache.h"
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/flags/declare.h"
+#include "absl/flags/flag.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+
+ABSL_DECLARE_FLAG(std::string, jit_cache_dir);
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+
+// Returns the cache entries in the given directory.
+std::vector<std::filesystem::path> GetCacheEntries(
+    const std::filesystem::path& directory) {
+  std::vector<std::filesystem::path> entries;
+  for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+    entries.push_back(entry.path());
+  }
+  return entries;
+}
+
+TEST(JitObjectCacheTest, LookupAndInsert) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  JitObjectCache cache(temp_dir.path() / "cache");
+  EXPECT_THAT(cache.Lookup("xls_jit_foo"), IsOkAndHolds(std::nullopt));
+  XLS_ASSERT_OK(cache.Insert("xls_jit_foo", "some object code"));
+  EXPECT_THAT(cache.Lookup("xls_jit_foo"),
+              IsOkAndHolds(std::optional<std::string>("some object code")));
+  EXPECT_THAT(cache.Lookup("xls_jit_bar"), IsOkAndHolds(std::nullopt));
+}
+
+TEST(JitObjectCacheTest, FunctionJitReusesCachedObject) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  absl::SetFlag(&FLAGS_jit_cache_dir, temp_dir.path().string());
+
+  const std::string ir_text = R"(
+package test
+
+top fn f(x: bits[32], y: bits[32]) -> bits[32] {
+  ret add.1: bits[32] = add(x, y)
+}
+)";
+  for (int64_t i = 0; i < 3; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                             Parser::ParsePackage(ir_text));
+    XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetTopAsFunction());
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                             FunctionJit::Create(f));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        InterpreterResult<Value> result,
+        jit->Run(std::vector<Value>{Value(UBits(i, 32)), Value(UBits(40, 32))}));
+    EXPECT_EQ(result.value, Value(UBits(40 + i, 32)));
+    // Only the first compilation populates the cache.
+    EXPECT_EQ(GetCacheEntries(temp_dir.path()).size(), 1);
+  }
+
+  // A different optimization level produces a different entry.
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                             Parser::ParsePackage(ir_text));
+    XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetTopAsFunction());
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                             FunctionJit::Create(f, /*opt_level=*/1));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        InterpreterResult<Value> result,
+        jit->Run(std::vector<Value>{Value(UBits(1, 32)), Value(UBits(2, 32))}));
+    EXPECT_EQ(result.value, Value(UBits(3, 32)));
+    EXPECT_EQ(GetCacheEntries(temp_dir.path()).size(), 2);
+  }
+
+  absl::SetFlag(&FLAGS_jit_cache_dir, "");
+}
+
+}  // namespace
+}  // namespace xls
@@ -27,22 +27,25 @@
 #include "xls/ir/value.h"
 #include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/proc_jit.h"
+#include "xls/jit/tiered_evaluator.h"
 
 namespace xls {
 
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
-    Package* package) {
+    Package* package, const JitTargetOptions& target_options) {
   // Create a queue manager for the queues. This factory verifies that there an
-  // receive only queue for every receive only channel.
+  // receive only queue for every receive only channel. Channels with a single
+  // sender and a single receiver are backed by lock-free queues.
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitChannelQueueManager> queue_manager,
-                       JitChannelQueueManager::CreateThreadSafe(package));
+                       JitChannelQueueManager::CreateLockFree(package));
 
   // Create a ProcJit for each Proc.
   std::vector<std::unique_ptr<ProcEvaluator>> proc_jits;
   for (auto& proc : package->procs()) {
-    XLS_ASSIGN_OR_RETURN(std::unique_ptr<ProcJit> proc_jit,
-                         ProcJit::Create(proc.get(), &queue_manager->runtime(),
-                                         queue_manager.get()));
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<ProcJit> proc_jit,
+        ProcJit::Create(proc.get(), &queue_manager->runtime(),
+                        queue_manager.get(), target_options));
     proc_jits.push_back(std::move(proc_jit));
   }
 
@@ -62,4 +65,103 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
   return std::move(proc_runtime);
 }
 
+absl::StatusOr<std::unique_ptr<FusedJitProcRuntime>> CreateFusedJitProcRuntime(
+    Package* package, const JitTargetOptions& target_options) {
+  // The queues must exist before the procs are compiled so the jitted code can
+  // refer to the ring buffers of the inline queues.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitChannelQueueManager> queue_manager,
+                       JitChannelQueueManager::CreateInline(package));
+
+  std::vector<std::unique_ptr<ProcJit>> proc_jits;
+  for (auto& proc : package->procs()) {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<ProcJit> proc_jit,
+        ProcJit::Create(proc.get(), &queue_manager->runtime(),
+                        queue_manager.get(), target_options));
+    proc_jits.push_back(std::move(proc_jit));
+  }
+
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<FusedJitProcRuntime> proc_runtime,
+      FusedJitProcRuntime::Create(package, std::move(proc_jits),
+                                  std::move(queue_manager)));
+
+  // Inject initial values into channels.
+  for (Channel* channel : package->channels()) {
+    ChannelQueue& queue = proc_runtime->queue_manager().GetQueue(channel);
+    for (const Value& value : channel->initial_values()) {
+      XLS_RETURN_IF_ERROR(queue.Write(value));
+    }
+  }
+
+  return std::move(proc_runtime);
+}
+
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
+CreateTieredSerialProcRuntime(Package* package) {
+  // The interpreter and the JIT share the same queues so a proc may switch
+  // tiers without draining its channels.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitChannelQueueManager> queue_manager,
+                       JitChannelQueueManager::CreateLockFree(package));
+
+  // Create a TieredProcEvaluator for each Proc. This starts compilation of
+  // each proc in the background.
+  std::vector<std::unique_ptr<ProcEvaluator>> evaluators;
+  for (auto& proc : package->procs()) {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<TieredProcEvaluator> evaluator,
+        TieredProcEvaluator::Create(proc.get(), queue_manager.get()));
+    evaluators.push_back(std::move(evaluator));
+  }
+
+  // Create a runtime.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> proc_runtime,
+                       SerialProcRuntime::Create(package, std::move(evaluators),
+                                                 std::move(queue_manager)));
+
+  // Inject initial values into channels.
+  for (Channel* channel : package->channels()) {
+    ChannelQueue& queue = proc_runtime->queue_manager().GetQueue(channel);
+    for (const Value& value : channel->initial_values()) {
+      XLS_RETURN_IF_ERROR(queue.Write(value));
+    }
+  }
+
+  return std::move(proc_runtime);
+}
+
+absl::StatusOr<std::unique_ptr<ThreadedProcRuntime>>
+CreateJitThreadedProcRuntime(Package* package,
+                             std::optional<int64_t> thread_count) {
+  // Each proc is ticked by at most one worker at a time, so channels with a
+  // single sender and a single receiver may use lock-free queues.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitChannelQueueManager> queue_manager,
+                       JitChannelQueueManager::CreateLockFree(package));
+
+  // Create a ProcJit for each Proc.
+  std::vector<std::unique_ptr<ProcEvaluator>> proc_jits;
+  for (auto& proc : package->procs()) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<ProcJit> proc_jit,
+                         ProcJit::Create(proc.get(), &queue_manager->runtime(),
+                                         queue_manager.get()));
+    proc_jits.push_back(std::move(proc_jit));
+  }
+
+  // Create a runtime.
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<ThreadedProcRuntime> proc_runtime,
+      ThreadedProcRuntime::Create(package, std::move(proc_jits),
+                                  std::move(queue_manager), thread_count));
+
+  // Inject initial values into channels.
+  for (Channel* channel : package->channels()) {
+    ChannelQueue& queue = proc_runtime->queue_manager().GetQueue(channel);
+    for (const Value& value : channel->initial_values()) {
+      XLS_RETURN_IF_ERROR(queue.Write(value));
+    }
+  }
+
+  return std::move(proc_runtime);
+}
+
 }  // namespace xls
@@ -16,16 +16,41 @@
 #define XLS_JIT_JIT_PROC_RUNTIME_H_
 
 #include <memory>
+#include <optional>
 
 #include "absl/status/statusor.h"
 #include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/interpreter/threaded_proc_runtime.h"
 #include "xls/ir/package.h"
+#include "xls/jit/fused_proc_runtime.h"
+#include "xls/jit/orc_jit.h"
 
 namespace xls {
 
-// Create a SerialProcRuntime composed of ProcJits.
+// Create a SerialProcRuntime composed of ProcJits compiled with the given
+// options.
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
-    Package* package);
+    Package* package,
+    const JitTargetOptions& target_options = JitTargetOptions());
+
+// Create a FusedJitProcRuntime composed of ProcJits compiled with the given
+// options. Channels between procs of the package are backed by
+// InlineJitChannelQueues which the jitted code accesses directly.
+absl::StatusOr<std::unique_ptr<FusedJitProcRuntime>> CreateFusedJitProcRuntime(
+    Package* package,
+    const JitTargetOptions& target_options = JitTargetOptions());
+
+// Create a SerialProcRuntime composed of TieredProcEvaluators. Procs begin
+// executing in the interpreter immediately and switch to the JIT at a tick
+// boundary once background compilation of each proc finishes.
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
+CreateTieredSerialProcRuntime(Package* package);
+
+// Create a ThreadedProcRuntime composed of ProcJits. `thread_count` is the
+// number of worker threads (defaults to the number of available CPUs).
+absl::StatusOr<std::unique_ptr<ThreadedProcRuntime>>
+CreateJitThreadedProcRuntime(
+    Package* package, std::optional<int64_t> thread_count = std::nullopt);
 
 }  // namespace xls
 
@@ -20,6 +20,7 @@
 
 #include "absl/strings/str_format.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
+#include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
@@ -33,7 +34,8 @@ JitRuntime::JitRuntime(llvm::DataLayout data_layout)
     : data_layout_(data_layout),
       context_(std::make_unique<llvm::LLVMContext>()),
       type_converter_(
-          std::make_unique<LlvmTypeConverter>(context_.get(), data_layout_)) {}
+          std::make_unique<LlvmTypeConverter>(context_.get(), data_layout_)),
+      type_pool_(std::make_unique<Package>("jit_runtime")) {}
 
 /* static */ absl::StatusOr<std::unique_ptr<JitRuntime>> JitRuntime::Create() {
   XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout,
@@ -62,133 +64,63 @@ absl::Status JitRuntime::PackArgs(absl::Span<const Value> args,
 
 Value JitRuntime::UnpackBuffer(const uint8_t* buffer, const Type* result_type,
                                bool unpoison) {
-  absl::MutexLock lock(&mutex_);
-  return UnpackBufferInternal(buffer, result_type, unpoison);
-}
-
-Value JitRuntime::UnpackBufferInternal(const uint8_t* buffer,
-                                       const Type* result_type, bool unpoison) {
-  switch (result_type->kind()) {
-    case TypeKind::kBits: {
-      const BitsType* bits_type = result_type->AsBitsOrDie();
-      int64_t bit_count = bits_type->bit_count();
-      int64_t byte_count = CeilOfRatio(bit_count, kCharBit);
-#ifdef ABSL_HAVE_MEMORY_SANITIZER
-      if (unpoison) {
-        __msan_unpoison(buffer, byte_count);
-      }
-#endif  // ABSL_HAVE_MEMORY_SANITIZER
-      return Value(
-          Bits::FromBytes(absl::MakeSpan(buffer, byte_count), bit_count));
-    }
-    case TypeKind::kTuple: {
-      // Just as with arg packing, we need the DataLayout to tell us where each
-      // arg is placed in the output buffer.
-      const TupleType* tuple_type = result_type->AsTupleOrDie();
-      llvm::Type* llvm_type = type_converter_->ConvertToLlvmType(tuple_type);
-      const llvm::StructLayout* layout =
-          data_layout_.getStructLayout(llvm::cast<llvm::StructType>(llvm_type));
-
-      std::vector<Value> values;
-      values.reserve(tuple_type->size());
-      for (int i = 0; i < tuple_type->size(); ++i) {
-        Value value =
-            UnpackBufferInternal(buffer + layout->getElementOffset(i),
-                                 tuple_type->element_type(i), unpoison);
-        values.push_back(value);
-      }
-      return Value::TupleOwned(std::move(values));
-    }
-    case TypeKind::kArray: {
-      const ArrayType* array_type = result_type->AsArrayOrDie();
-      if (array_type->size() == 0) {
-        return Value::ArrayOrDie({});
-      }
-
-      const Type* element_type = array_type->element_type();
-      llvm::Type* llvm_element_type =
-          type_converter_->ConvertToLlvmType(array_type->element_type());
-      std::vector<Value> values;
-      values.reserve(array_type->size());
-      // This BitsType is only used inside the ToLlvmConstantCall() (and isn't
-      // stored), so it's safe for it to live on the stack.
-      BitsType bits_type(64);
-      for (int i = 0; i < array_type->size(); ++i) {
-        llvm::Constant* index =
-            type_converter_->ToLlvmConstant(&bits_type, Value(UBits(i, 64)))
-                .value();
-        int64_t offset =
-            data_layout_.getIndexedOffsetInType(llvm_element_type, index);
-        Value value =
-            UnpackBufferInternal(buffer + offset, element_type, unpoison);
-        values.push_back(value);
-      }
-
-      return Value::ArrayOrDie(values);
-    }
-    case TypeKind::kToken:
-      return Value::Token();
-    default:
-      XLS_LOG(FATAL) << "Unsupported XLS Value kind: " << result_type->kind();
-  }
+  const TypeLayout& layout = GetTypeLayout(result_type);
+  // NativeLayoutToValue unpoisons the buffer when built with MSAN so
+  // `unpoison` need not be handled here.
+  (void)unpoison;
+  return layout.NativeLayoutToValue(buffer);
 }
 
 void JitRuntime::BlitValueToBuffer(const Value& value, const Type* type,
                                    absl::Span<uint8_t> buffer) {
-  absl::MutexLock lock(&mutex_);
-  // Zero the buffer before filling in values. This ensures all padding bytes
-  // are cleared.
-  memset(buffer.data(), 0, type_converter_->GetTypeByteSize(type));
-  BlitValueToBufferInternal(value, type, buffer);
+  const TypeLayout& layout = GetTypeLayout(type);
+  // Zero the buffer before filling in values if the elements leave gaps. This
+  // ensures all padding bytes, including those between tuple elements, are
+  // cleared.
+  if (!layout.IsDense()) {
+    memset(buffer.data(), 0, layout.size());
+  }
+  layout.ValueToNativeLayout(value, buffer.data());
 }
 
-void JitRuntime::BlitValueToBufferInternal(const Value& value, const Type* type,
-                                           absl::Span<uint8_t> buffer) {
-  if (value.IsBits()) {
-    const Bits& bits = value.bits();
-    int64_t byte_count = CeilOfRatio(bits.bit_count(), kCharBit);
-    // Underlying Bits object relies on little-endianness.
-    XLS_CHECK(data_layout_.isLittleEndian());
-    bits.ToBytes(absl::MakeSpan(buffer.data(), byte_count));
+namespace {
 
-    // Zero out any padding bits. Bits type are stored in the JIT as the next
-    // power of two size.  LLVM requires all padding bits to be zero for safe
-    // operation, e.g., for a 42 bit type (which is padded out to a 64-bit word
-    // in the jit) bits 42 through 64 must be zero. The entire buffer is zeroed
-    // prior to calling this function so we only need to handle the remainder
-    // bits in the most-significant byte of value data here.
-    int remainder_bits = bits.bit_count() % kCharBit;
-    if (remainder_bits != 0) {
-      buffer[byte_count - 1] &= static_cast<uint8_t>(Mask(remainder_bits));
-    }
-  } else if (value.IsArray()) {
-    const ArrayType* array_type = type->AsArrayOrDie();
-    int64_t element_size =
-        type_converter_->GetTypeByteSize(array_type->element_type());
-    for (int i = 0; i < value.size(); ++i) {
-      BlitValueToBufferInternal(value.element(i), array_type->element_type(),
-                                buffer);
-      buffer = buffer.subspan(element_size);
-    }
-  } else if (value.IsTuple()) {
-    // Due to per-target data packing (esp. as realized by the LLVM IR
-    // load/store instructions), we need to make sure we blit args into LLVM
-    // space as the underlying runtime expects, which means we need the
-    // DataLayout to tell us where each constituent element should be placed.
-    llvm::Type* llvm_type = type_converter_->ConvertToLlvmType(type);
-    const llvm::StructLayout* layout =
-        data_layout_.getStructLayout(llvm::cast<llvm::StructType>(llvm_type));
+// Returns whether the front map entry `layout` may be used for `type`, i.e.,
+// the type at the address has not been replaced by a different one.
+bool LayoutMatches(const TypeLayout* layout, const Type* type) {
+  return layout->type()->kind() == type->kind() &&
+         layout->type()->hash() == type->hash() &&
+         layout->type()->GetFlatBitCount() == type->GetFlatBitCount();
+}
+
+}  // namespace
 
-    const TupleType* tuple_type = type->AsTupleOrDie();
-    for (int i = 0; i < value.size(); ++i) {
-      BlitValueToBufferInternal(value.element(i), tuple_type->element_type(i),
-                                buffer.subspan(layout->getElementOffset(i)));
+const TypeLayout& JitRuntime::GetTypeLayout(const Type* xls_type) {
+  {
+    absl::ReaderMutexLock lock(&mutex_);
+    auto it = layouts_by_address_.find(xls_type);
+    if (it != layouts_by_address_.end() &&
+        LayoutMatches(it->second, xls_type)) {
+      return *it->second;
     }
-  } else if (value.IsToken()) {
-    // Tokens contain no data.
-  } else {
-    XLS_LOG(FATAL) << "Unsupported XLS Value kind: " << value.kind();
   }
+  absl::MutexLock lock(&mutex_);
+  auto it = type_layouts_.find(xls_type);
+  if (it != type_layouts_.end()) {
+    layouts_by_address_[xls_type] = it->second.get();
+    return *it->second;
+  }
+  // Package takes non-const types but does not modify them. Mapping only fails
+  // for function types, which have no layout.
+  absl::StatusOr<Type*> pool_type =
+      type_pool_->MapTypeFromOtherPackage(const_cast<Type*>(xls_type));
+  XLS_CHECK_OK(pool_type.status());
+  auto layout = std::make_unique<const TypeLayout>(
+      type_converter_->CreateTypeLayout(*pool_type));
+  const TypeLayout& result = *layout;
+  type_layouts_.emplace(*pool_type, std::move(layout));
+  layouts_by_address_[xls_type] = &result;
+  return result;
 }
 
 extern "C" {
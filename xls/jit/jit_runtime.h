@@ -17,13 +17,18 @@
 
 #include <cstdint>
 #include <memory>
+#include <utility>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
+#include "xls/ir/package.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -58,22 +63,52 @@ class JitRuntime {
   const llvm::DataLayout& data_layout() { return data_layout_; }
 
   int64_t GetTypeByteSize(Type* xls_type) {
-    absl::MutexLock lock(&mutex_);
-    return type_converter_->GetTypeByteSize(xls_type);
+    return GetTypeLayout(xls_type).size();
+  }
+
+  // Returns the native layout of the given type. The layout of each type
+  // structure is computed once, using the LLVM type converter, and cached for
+  // the lifetime of the runtime; the type of the returned layout is a
+  // structurally equal copy owned by the runtime. After the first call for a
+  // type, conversions (including UnpackBuffer and BlitValueToBuffer) only take
+  // a shared lock and probe a map keyed on the address of `xls_type` to find
+  // the cached layout, and conversions using the returned TypeLayout require
+  // no synchronization at all.
+  const TypeLayout& GetTypeLayout(const Type* xls_type);
+
+  // Returns a copy of the native layout of the given type which refers to
+  // `xls_type` itself.
+  TypeLayout CreateTypeLayout(Type* xls_type) {
+    const TypeLayout& layout = GetTypeLayout(xls_type);
+    return TypeLayout(xls_type, layout.size(), layout.elements());
   }
 
  private:
-  Value UnpackBufferInternal(const uint8_t* buffer, const Type* result_type,
-                             bool unpoison) ABSL_SHARED_LOCKS_REQUIRED(mutex_);
-  void BlitValueToBufferInternal(const Value& value, const Type* type,
-                                 absl::Span<uint8_t> buffer)
-      ABSL_SHARED_LOCKS_REQUIRED(mutex_);
+  const llvm::DataLayout data_layout_;
 
+  // Guards the LLVM context and type converter, which are only used to compute
+  // layouts, and the layout cache.
   mutable absl::Mutex mutex_;
-
-  const llvm::DataLayout data_layout_;
   std::unique_ptr<llvm::LLVMContext> context_ ABSL_GUARDED_BY(mutex_);
   std::unique_ptr<LlvmTypeConverter> type_converter_ ABSL_GUARDED_BY(mutex_);
+  // Owns the types of the cached layouts.
+  std::unique_ptr<Package> type_pool_ ABSL_GUARDED_BY(mutex_);
+
+  // Cached layouts looked up by type structure. Each is keyed on the type of
+  // the layout, which is owned by `type_pool_`, so the runtime may be passed
+  // types which do not outlive it. Layouts are heap allocated so references to
+  // them are stable.
+  absl::flat_hash_map<const Type*, std::unique_ptr<const TypeLayout>,
+                      TypeStructureHash, TypeStructureEq>
+      type_layouts_ ABSL_GUARDED_BY(mutex_);
+
+  // Front map from the address of a type passed to GetTypeLayout to its cached
+  // layout, so the common lookup is a pointer hash probe rather than a
+  // structural comparison. The caller's type may since have been freed and its
+  // address reused, so an entry is only trusted if the kind, hash and flat bit
+  // count of the type still match those of the layout's type.
+  absl::flat_hash_map<const Type*, const TypeLayout*> layouts_by_address_
+      ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace xls
@@ -13,6 +13,7 @@
 // limitations under the License.
 #include "xls/jit/jit_wrapper_generator.h"
 
+#include <algorithm>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -376,6 +377,220 @@ std::string CreateImplSpecialization(const Function& function,
                          absl::StrJoin(param_names, ", "));
 }
 
+// Returns true if values of the given type can be held in native C++ objects
+// whose layout matches the native layout used by the JIT (see TypeLayout):
+// bits types of at most 64 bits (as the enclosing unsigned integer type) and
+// non-empty arrays (std::array) and tuples (structs) of such types. Empty
+// aggregates are excluded as they occupy no storage in the JIT but one byte in
+// C++.
+bool IsNativelyRepresentable(const Type& type) {
+  if (type.IsBits()) {
+    return type.GetFlatBitCount() <= 64;
+  }
+  if (type.IsArray()) {
+    const ArrayType* array_type = type.AsArrayOrDie();
+    return array_type->size() > 0 &&
+           IsNativelyRepresentable(*array_type->element_type());
+  }
+  if (type.IsTuple()) {
+    const TupleType* tuple_type = type.AsTupleOrDie();
+    return tuple_type->size() > 0 &&
+           std::all_of(
+               tuple_type->element_types().begin(),
+               tuple_type->element_types().end(),
+               [](const Type* t) { return IsNativelyRepresentable(*t); });
+  }
+  return false;
+}
+
+// Native overloads are generated for functions which take at least one
+// argument (a zero-argument overload would only differ from the Value one by
+// its return type), are not already covered by the packed specialization
+// above, and whose signature is natively representable.
+bool HasNativeOverload(const Function& function) {
+  auto [params, return_type] = GetSignature(function);
+  return !params.empty() && !IsSpecializable(function) &&
+         std::all_of(params.begin(), params.end(),
+                     [](const Param* p) {
+                       return IsNativelyRepresentable(*p->GetType());
+                     }) &&
+         IsNativelyRepresentable(*return_type);
+}
+
+// Appends the tuple types reachable from `type` to `tuple_types` in post order,
+// i.e., so each tuple appears after the types of its elements.
+void CollectTupleTypes(const Type* type,
+                       std::vector<const TupleType*>* tuple_types) {
+  if (type->IsArray()) {
+    CollectTupleTypes(type->AsArrayOrDie()->element_type(), tuple_types);
+  } else if (type->IsTuple()) {
+    const TupleType* tuple_type = type->AsTupleOrDie();
+    for (const Type* element_type : tuple_type->element_types()) {
+      CollectTupleTypes(element_type, tuple_types);
+    }
+    if (std::find(tuple_types->begin(), tuple_types->end(), tuple_type) ==
+        tuple_types->end()) {
+      tuple_types->push_back(tuple_type);
+    }
+  }
+}
+
+// The native C++ types used by the native overload of a function: a struct
+// named "Tuple<N>" is generated (as a member of the wrapper class) for each
+// distinct tuple type in the signature.
+class NativeTypes {
+ public:
+  explicit NativeTypes(const Function& function) {
+    auto [params, return_type] = GetSignature(function);
+    for (const Param* param : params) {
+      CollectTupleTypes(param->GetType(), &tuple_types_);
+    }
+    CollectTupleTypes(return_type, &tuple_types_);
+  }
+
+  // Returns the C++ type holding values of `type`; struct names are qualified
+  // with `scope` (e.g., "MyClass::").
+  std::string TypeString(const Type& type, std::string_view scope = "") const {
+    std::string uint_type;
+    if (MatchUint(type, &uint_type)) {
+      return uint_type;
+    }
+    if (type.IsArray()) {
+      const ArrayType* array_type = type.AsArrayOrDie();
+      return absl::StrFormat("std::array<%s, %d>",
+                             TypeString(*array_type->element_type(), scope),
+                             array_type->size());
+    }
+    XLS_CHECK(type.IsTuple()) << type.ToString();
+    int64_t index = std::find(tuple_types_.begin(), tuple_types_.end(),
+                              type.AsTupleOrDie()) -
+                    tuple_types_.begin();
+    XLS_CHECK_LT(index, tuple_types_.size()) << type.ToString();
+    return absl::StrCat(scope, "Tuple", index);
+  }
+
+  // Returns the definitions of the generated structs, each indented to be
+  // nested in a class definition.
+  std::string StructDefinitions() const {
+    std::string result;
+    for (const TupleType* tuple_type : tuple_types_) {
+      absl::StrAppendFormat(&result,
+                            "  // Native layout of %s.\n  struct %s {\n",
+                            tuple_type->ToString(), TypeString(*tuple_type));
+      for (int64_t i = 0; i < tuple_type->size(); ++i) {
+        absl::StrAppendFormat(&result, "    %s e%d;\n",
+                              TypeString(*tuple_type->element_type(i)), i);
+      }
+      absl::StrAppend(&result, "  };\n");
+    }
+    return result;
+  }
+
+ private:
+  std::vector<const TupleType*> tuple_types_;
+};
+
+// Returns the C++ parameter declaration of `param` in the native overload.
+std::string NativeParamString(const Param& param, const NativeTypes& types,
+                              std::string_view scope = "") {
+  std::string type_string = types.TypeString(*param.GetType(), scope);
+  if (param.GetType()->IsBits()) {
+    return absl::StrCat(type_string, " ", param.name());
+  }
+  return absl::StrCat("const ", type_string, "& ", param.name());
+}
+
+// Returns the declaration of the native overload of the given function, or an
+// empty string if it has none. Arguments and results are C++ objects laid out
+// as the JIT expects, so the call requires no conversion or allocation.
+std::string CreateNativeDecl(const Function& function) {
+  if (!HasNativeOverload(function)) {
+    return "";
+  }
+  NativeTypes types(function);
+  auto [params, return_type] = GetSignature(function);
+  std::vector<std::string> param_strs;
+  for (const Param* param : params) {
+    param_strs.push_back(NativeParamString(*param, types));
+  }
+  return absl::StrFormat(
+      "// Runs the function on native values. Bits set in arguments above the\n"
+      "  // width of the corresponding IR type give undefined results.\n"
+      "  absl::StatusOr<%s> Run(%s);",
+      types.TypeString(*return_type), absl::StrJoin(param_strs, ", "));
+}
+
+std::string CreateNativeImpl(const Function& function,
+                             std::string_view class_name) {
+  if (!HasNativeOverload(function)) {
+    return "";
+  }
+  NativeTypes types(function);
+  std::string scope = absl::StrCat(class_name, "::");
+  bool implicit_token_convention = false;
+  auto [params, return_type] =
+      GetSignature(function, &implicit_token_convention);
+  std::string return_type_string = types.TypeString(*return_type, scope);
+
+  std::vector<std::string> param_strs;
+  std::vector<std::string> arg_buffers;
+  std::string locals;
+  if (implicit_token_convention) {
+    locals = "  uint8_t _token = 0;\n  uint8_t _activated = 1;\n";
+    arg_buffers.push_back("&_token");
+    arg_buffers.push_back("&_activated");
+  }
+  for (const Param* param : params) {
+    param_strs.push_back(NativeParamString(*param, types, scope));
+    arg_buffers.push_back(
+        absl::StrFormat("absl::bit_cast<uint8_t*>(&%s)", param->name()));
+  }
+  // With the implicit token convention the JIT returns a (token, value) tuple.
+  // The token occupies no storage so the value is at offset zero and the
+  // result can be written directly into the returned object.
+  return absl::StrFormat(R"(absl::StatusOr<%s> %s::Run(%s) {
+%s  uint8_t* _args[] = {%s};
+  %s _result;
+  xls::InterpreterEvents _events;
+  XLS_RETURN_IF_ERROR(jit_->RunWithViews(
+      _args,
+      absl::MakeSpan(absl::bit_cast<uint8_t*>(&_result), sizeof(_result)),
+      &_events));
+  XLS_RETURN_IF_ERROR(xls::InterpreterEventsToStatus(_events));
+  return _result;
+})",
+                         return_type_string, class_name,
+                         absl::StrJoin(param_strs, ", "), locals,
+                         absl::StrJoin(arg_buffers, ", "), return_type_string);
+}
+
+// Returns checks, run at wrapper creation, that the native types of the
+// function agree in size with the JIT's native layout.
+std::string CreateNativeLayoutChecks(const Function& function,
+                                     std::string_view class_name) {
+  if (!HasNativeOverload(function)) {
+    return "";
+  }
+  NativeTypes types(function);
+  std::string scope = absl::StrCat(class_name, "::");
+  bool implicit_token_convention = false;
+  auto [params, return_type] =
+      GetSignature(function, &implicit_token_convention);
+  int64_t first_param = implicit_token_convention ? 2 : 0;
+  std::string checks;
+  for (int64_t i = 0; i < params.size(); ++i) {
+    absl::StrAppendFormat(
+        &checks,
+        "  XLS_RET_CHECK_EQ(jit->GetArgTypeSize(%d), int64_t{sizeof(%s)});\n",
+        first_param + i, types.TypeString(*params[i]->GetType(), scope));
+  }
+  absl::StrAppendFormat(
+      &checks,
+      "  XLS_RET_CHECK_EQ(jit->GetReturnTypeSize(), int64_t{sizeof(%s)});\n",
+      types.TypeString(*return_type, scope));
+  return checks;
+}
+
 }  // namespace
 
 static std::string GenerateWrapperHeader(
@@ -391,11 +606,15 @@ static std::string GenerateWrapperHeader(
   //  {{specialization}} : Any interfaces for specially-matched types, e.g., an
   //       interface that takes a float for a
   //       PackedTupleView<PackedBitsView<1>,...>.
+  //  {{native_types}} : Structs for the tuple types of the native overload.
+  //  {{native_run}} : Native overload, if any.
   //  {{header_guard}} : Header guard.
   constexpr const char kHeaderTemplate[] =
       R"(// Automatically-generated file! DO NOT EDIT!
 #ifndef {{header_guard}}
 #define {{header_guard}}
+#include <array>
+#include <cstdint>
 #include <memory>
 
 #include "absl/status/status.h"
@@ -408,13 +627,14 @@ namespace {{namespace}} {
 // JIT execution wrapper for the {{function_name}} XLS IR module.
 class {{class_name}} {
  public:
-  static absl::StatusOr<std::unique_ptr<{{class_name}}>> Create();
+{{native_types}}  static absl::StatusOr<std::unique_ptr<{{class_name}}>> Create();
   xls::FunctionJit* jit() { return jit_.get(); }
 
   absl::StatusOr<xls::Value> Run({{params}});
   absl::Status Run({{packed_params}});
   absl::Status Run({{unpacked_params}});
   {{specialization}}
+  {{native_run}}
 
  private:
   {{class_name}}(std::unique_ptr<xls::Package> package,
@@ -466,6 +686,10 @@ class {{class_name}} {
   substitution_map["{{unpacked_params}}"] =
       absl::StrJoin(unpacked_param_strs, ", ");
   substitution_map["{{specialization}}"] = CreateDeclSpecialization(function);
+  substitution_map["{{native_types}}"] =
+      HasNativeOverload(function) ? NativeTypes(function).StructDefinitions()
+                                  : "";
+  substitution_map["{{native_run}}"] = CreateNativeDecl(function);
   substitution_map["{{header_guard}}"] = header_guard;
   return absl::StrReplaceAll(kHeaderTemplate, substitution_map);
 }
@@ -487,6 +711,8 @@ static std::string GenerateWrapperSource(
   //  {{run_unpacked_params}} : Unpacked Run() params
   //  {{run_with_views_args}} : Packed RunWithPackedViews() arguments
   //  {{specialization}} : Specially-matched type implementations (if any)
+  //  {{native_layout_checks}} : Checks of the native overload's type sizes.
+  //  {{native_run}} : Native overload implementation (if any).
   //  {{value_locals}}: "Value" routine locals.
   //  {{value_postprocessing}}: "Value" routine postprocessing.
   //  {{packed_locals}}: "Packed" routine locals.
@@ -494,6 +720,7 @@ static std::string GenerateWrapperSource(
   constexpr const char kSourceTemplate[] =
       R"-(// Automatically-generated file! DO NOT EDIT!
 #include "{{header_path}}"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/public/ir_parser.h"
 
@@ -507,7 +734,7 @@ absl::StatusOr<std::unique_ptr<{{class_name}}>> {{class_name}}::Create() {
   XLS_ASSIGN_OR_RETURN(xls::Function* function,
                        package->GetFunction("{{function_name}}"));
   XLS_ASSIGN_OR_RETURN(auto jit, xls::FunctionJit::Create(function));
-  return absl::WrapUnique(new {{class_name}}(std::move(package), std::move(jit)));
+{{native_layout_checks}}  return absl::WrapUnique(new {{class_name}}(std::move(package), std::move(jit)));
 }
 
 {{class_name}}::{{class_name}}(std::unique_ptr<xls::Package> package,
@@ -536,6 +763,8 @@ absl::Status {{class_name}}::Run({{run_unpacked_params}}) {
 
 {{specialization}}
 
+{{native_run}}
+
 }  // namespace {{wrapper_namespace}}
 )-";
   std::vector<std::string> param_list;
@@ -606,6 +835,9 @@ absl::Status {{class_name}}::Run({{run_unpacked_params}}) {
   substitution_map["{{run_unpacked_params}}"] = unpacked_params_str;
   substitution_map["{{run_with_views_args}}"] = run_with_views_args;
   substitution_map["{{specialization}}"] = specialization;
+  substitution_map["{{native_layout_checks}}"] =
+      CreateNativeLayoutChecks(function, class_name);
+  substitution_map["{{native_run}}"] = CreateNativeImpl(function, class_name);
   substitution_map["{{value_locals}}"] = value_locals;
   substitution_map["{{value_postprocessing}}"] = retval_handling;
   substitution_map["{{packed_locals}}"] = packed_locals;
@@ -28,6 +28,7 @@ namespace xls {
 namespace {
 
 using ::testing::HasSubstr;
+using ::testing::Not;
 
 TEST(JitWrapperGeneratorTest, GeneratesHeaderGuards) {
   constexpr const char kClassName[] = "MyClass";
@@ -198,5 +199,95 @@ fn main(t: token, activated: bits[1], x: bits[32]) -> (token, bits[32]) {
               HasSubstr("absl::StatusOr<xls::Value> Run(xls::Value x)"));
 }
 
+TEST(JitWrapperGeneratorTest, GeneratesNativeAggregates) {
+  constexpr const char kClassName[] = "MyClass";
+  const std::filesystem::path kHeaderPath =
+      "some/silly/genfiles/path/this_is_myclass.h";
+  constexpr const char kNamespace[] = "my_namespace";
+
+  const std::string program = R"(package p
+
+fn main(x: bits[32], y: (bits[8], bits[13][2])) -> (bits[32], (bits[8], bits[13][2])) {
+  ret r: (bits[32], (bits[8], bits[13][2])) = tuple(x, y)
+}
+
+fn wide(x: bits[65][2]) -> bits[65][2] {
+  ret identity.4: bits[65][2] = identity(x)
+}
+
+fn empty(x: bits[32], y: ()) -> bits[32] {
+  ret identity.7: bits[32] = identity(x)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(program));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("main"));
+  GeneratedJitWrapper generated = GenerateJitWrapper(
+      *f, kClassName, kNamespace, kHeaderPath, "some/silly/genfiles/path");
+  EXPECT_THAT(generated.header, HasSubstr(R"(  struct Tuple0 {
+    uint8_t e0;
+    std::array<uint16_t, 2> e1;
+  };)"));
+  EXPECT_THAT(generated.header, HasSubstr(R"(  struct Tuple1 {
+    uint32_t e0;
+    Tuple0 e1;
+  };)"));
+  EXPECT_THAT(generated.header,
+              HasSubstr("absl::StatusOr<Tuple1> Run(uint32_t x, const Tuple0& "
+                        "y);"));
+  EXPECT_THAT(generated.source,
+              HasSubstr("absl::StatusOr<MyClass::Tuple1> MyClass::Run(uint32_t "
+                        "x, const MyClass::Tuple0& y) {"));
+  EXPECT_THAT(generated.source,
+              HasSubstr("XLS_RET_CHECK_EQ(jit->GetArgTypeSize(1), "
+                        "int64_t{sizeof(MyClass::Tuple0)});"));
+  EXPECT_THAT(generated.source,
+              HasSubstr("XLS_RET_CHECK_EQ(jit->GetReturnTypeSize(), "
+                        "int64_t{sizeof(MyClass::Tuple1)});"));
+
+  // Types which have no native equivalent get no native overload.
+  XLS_ASSERT_OK_AND_ASSIGN(f, p->GetFunction("wide"));
+  generated = GenerateJitWrapper(*f, kClassName, kNamespace, kHeaderPath,
+                                 "some/silly/genfiles/path");
+  EXPECT_THAT(generated.header, Not(HasSubstr("std::array")));
+  EXPECT_THAT(generated.source, Not(HasSubstr("RunWithViews")));
+
+  XLS_ASSERT_OK_AND_ASSIGN(f, p->GetFunction("empty"));
+  generated = GenerateJitWrapper(*f, kClassName, kNamespace, kHeaderPath,
+                                 "some/silly/genfiles/path");
+  EXPECT_THAT(generated.header, Not(HasSubstr("struct Tuple0")));
+  EXPECT_THAT(generated.source, Not(HasSubstr("RunWithViews")));
+}
+
+TEST(JitWrapperGeneratorTest, GeneratesNativeTokenActivatedFunction) {
+  constexpr const char kClassName[] = "MyClass";
+  const std::filesystem::path kHeaderPath =
+      "some/silly/genfiles/path/this_is_myclass.h";
+  constexpr const char kNamespace[] = "my_namespace";
+
+  const std::string program = R"(package p
+
+fn main(t: token, activated: bits[1], x: bits[32][4]) -> (token, bits[32][4]) {
+  ret r: (token, bits[32][4]) = tuple(t, x)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(program));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("main"));
+  GeneratedJitWrapper generated = GenerateJitWrapper(
+      *f, kClassName, kNamespace, kHeaderPath, "some/silly/genfiles/path");
+  EXPECT_THAT(generated.header,
+              HasSubstr("absl::StatusOr<std::array<uint32_t, 4>> Run(const "
+                        "std::array<uint32_t, 4>& x);"));
+  EXPECT_THAT(generated.source,
+              HasSubstr("uint8_t* _args[] = {&_token, &_activated, "
+                        "absl::bit_cast<uint8_t*>(&x)};"));
+  EXPECT_THAT(generated.source,
+              HasSubstr("XLS_RET_CHECK_EQ(jit->GetArgTypeSize(2), "
+                        "int64_t{sizeof(std::array<uint32_t, 4>)});"));
+}
+
 }  // namespace
 }  // namespace xls
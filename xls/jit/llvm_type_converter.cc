@@ -15,7 +15,9 @@
 #include "xls/jit/llvm_type_converter.h"
 
 #include <algorithm>
+#include <memory>
 #include <optional>
+#include <utility>
 #include <vector>
 
 #include "absl/status/statusor.h"
@@ -27,7 +29,25 @@ namespace xls {
 
 LlvmTypeConverter::LlvmTypeConverter(llvm::LLVMContext* context,
                                      const llvm::DataLayout& data_layout)
-    : context_(*context), data_layout_(data_layout) {}
+    : context_(*context),
+      data_layout_(data_layout),
+      type_pool_(std::make_unique<Package>("llvm_type_converter")) {}
+
+Type* LlvmTypeConverter::GetPoolType(const Type* type) const {
+  auto it = pool_types_.find(type);
+  if (it != pool_types_.end() && it->second->kind() == type->kind() &&
+      it->second->hash() == type->hash() &&
+      it->second->GetFlatBitCount() == type->GetFlatBitCount()) {
+    return it->second;
+  }
+  // Mapping a type only fails for kinds which have no LLVM representation
+  // (e.g., function types), which are never converted.
+  absl::StatusOr<Type*> pool_type =
+      type_pool_->MapTypeFromOtherPackage(const_cast<Type*>(type));
+  XLS_CHECK_OK(pool_type.status());
+  pool_types_[type] = *pool_type;
+  return *pool_type;
+}
 
 int64_t LlvmTypeConverter::GetLlvmBitCount(int64_t xls_bit_count) const {
   // LLVM does not accept 0-bit types, and we want to be able to JIT-compile
@@ -43,6 +63,18 @@ int64_t LlvmTypeConverter::GetLlvmBitCount(int64_t xls_bit_count) const {
 }
 
 llvm::Type* LlvmTypeConverter::ConvertToLlvmType(const Type* xls_type) const {
+  Type* pool_type = GetPoolType(xls_type);
+  auto it = type_cache_.find(pool_type);
+  if (it != type_cache_.end()) {
+    return it->second;
+  }
+  llvm::Type* llvm_type = ConvertToLlvmTypeUncached(pool_type);
+  type_cache_.emplace(pool_type, llvm_type);
+  return llvm_type;
+}
+
+llvm::Type* LlvmTypeConverter::ConvertToLlvmTypeUncached(
+    const Type* xls_type) const {
   llvm::Type* llvm_type;
   if (xls_type->IsBits()) {
     llvm_type = llvm::IntegerType::get(
@@ -111,6 +143,18 @@ absl::StatusOr<llvm::Constant*> LlvmTypeConverter::ToLlvmConstant(
   if (type->isArrayTy()) {
     std::vector<llvm::Constant*> elements;
     llvm::Type* element_type = type->getArrayElementType();
+    if (value.IsPackedArray()) {
+      // Build the elements of packed arrays without unpacking them.
+      for (int64_t i = 0; i < value.size(); ++i) {
+        XLS_ASSIGN_OR_RETURN(
+            llvm::Constant * llvm_element,
+            ToLlvmConstant(element_type, Value(value.GetPackedElement(i))));
+        elements.push_back(llvm_element);
+      }
+      return llvm::ConstantArray::get(
+          llvm::ArrayType::get(element_type, type->getArrayNumElements()),
+          elements);
+    }
     for (const Value& element : value.elements()) {
       XLS_ASSIGN_OR_RETURN(llvm::Constant * llvm_element,
                            ToLlvmConstant(element_type, element));
@@ -272,9 +316,18 @@ void LlvmTypeConverter::ComputeElementLayouts(
 }
 
 TypeLayout LlvmTypeConverter::CreateTypeLayout(Type* xls_type) {
+  // The returned layout refers to `xls_type` rather than to the cached copy of
+  // the type because it may outlive the converter.
+  Type* pool_type = GetPoolType(xls_type);
+  auto it = type_layout_cache_.find(pool_type);
+  if (it != type_layout_cache_.end()) {
+    return TypeLayout(xls_type, it->second.size(), it->second.elements());
+  }
   std::vector<ElementLayout> element_layouts;
-  ComputeElementLayouts(xls_type, &element_layouts, /*offset=*/0);
-  return TypeLayout(xls_type, GetTypeByteSize(xls_type), element_layouts);
+  ComputeElementLayouts(pool_type, &element_layouts, /*offset=*/0);
+  TypeLayout layout(pool_type, GetTypeByteSize(pool_type), element_layouts);
+  it = type_layout_cache_.emplace(pool_type, std::move(layout)).first;
+  return TypeLayout(xls_type, it->second.size(), it->second.elements());
 }
 
 }  // namespace xls
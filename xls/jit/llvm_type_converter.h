@@ -16,22 +16,39 @@
 #define XLS_JIT_LLVM_TYPE_CONVERTER_H_
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "llvm/include/llvm/IR/IRBuilder.h"
+#include "xls/ir/package.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/jit/type_layout.h"
 
 namespace xls {
 
+// Hash and equality functors which identify a type by its structure rather
+// than by its address, so structurally equal types from any package share an
+// entry in a hash container. Equality compares the structure in full; the hash
+// only narrows the candidates.
+struct TypeStructureHash {
+  size_t operator()(const Type* type) const { return type->hash(); }
+};
+struct TypeStructureEq {
+  bool operator()(const Type* a, const Type* b) const {
+    return a->IsEqualTo(b);
+  }
+};
+
 // LlvmTypeConverter handles the work of translating from XLS types and values
 // into the corresponding LLVM elements.
 //
-// This class must live as long as its constructor argument module.
+// This class must live as long as its constructor argument module. None of its
+// methods, including the const ones, are thread-safe: they create types in the
+// LLVM context and populate the conversion caches.
 class LlvmTypeConverter {
  public:
   LlvmTypeConverter(llvm::LLVMContext* context,
@@ -131,7 +148,20 @@ class LlvmTypeConverter {
   TypeLayout CreateTypeLayout(Type* xls_type);
 
  private:
-  using TypeCache = absl::flat_hash_map<const Type*, llvm::Type*>;
+  // Caches of conversions. Entries are looked up by type structure and keyed
+  // on copies of the types owned by `type_pool_`, so the converter may be
+  // passed types which do not outlive it (including temporary types) and
+  // holds one entry per distinct structure rather than per type address.
+  template <typename T>
+  using TypeCache =
+      absl::flat_hash_map<const Type*, T, TypeStructureHash, TypeStructureEq>;
+
+  // Returns the copy of `type` owned by `type_pool_`. Keys of the caches above
+  // are pool types, so looking one up matches on the first pointer comparison
+  // in IsEqualTo rather than walking the structure.
+  Type* GetPoolType(const Type* type) const;
+
+  llvm::Type* ConvertToLlvmTypeUncached(const Type* type) const;
 
   // Handles the special (and base) case of converting Bits types to LLVM.
   absl::StatusOr<llvm::Constant*> ToIntegralConstant(llvm::Type* type,
@@ -145,6 +175,16 @@ class LlvmTypeConverter {
 
   llvm::LLVMContext& context_;
   llvm::DataLayout data_layout_;
+  // Owns the keys of the caches below.
+  std::unique_ptr<Package> type_pool_;
+  // Front map from the address of a type passed by a caller to its copy in
+  // `type_pool_`, so a repeated lookup of the same type is a pointer hash
+  // probe. The caller's type may since have been freed and its address reused,
+  // so an entry is only trusted if its kind, hash and flat bit count still
+  // match the pool type.
+  mutable absl::flat_hash_map<const Type*, Type*> pool_types_;
+  mutable TypeCache<llvm::Type*> type_cache_;
+  TypeCache<TypeLayout> type_layout_cache_;
 };
 
 }  // namespace xls
@@ -14,6 +14,7 @@
 
 #include "xls/jit/orc_jit.h"
 
+#include <algorithm>
 #include <cerrno>
 #include <cstddef>
 #include <cstdint>
@@ -22,32 +23,52 @@
 #include <string_view>
 #include <system_error>  // NOLINT
 #include <utility>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/flags/flag.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm-c/Target.h"
 #include "llvm/include/llvm/ADT/StringExtras.h"
 #include "llvm/include/llvm/Analysis/CGSCCPassManager.h"
 #include "llvm/include/llvm/Analysis/LoopAnalysisManager.h"
+#include "llvm/include/llvm/Bitcode/BitcodeReader.h"
+#include "llvm/include/llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/CompileUtils.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ExecutionUtils.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ExecutorProcessControl.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/Mangling.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/TaskDispatch.h"
 #include "llvm/include/llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/include/llvm/IR/Function.h"
 #include "llvm/include/llvm/IR/LegacyPassManager.h"
 #include "llvm/include/llvm/IR/PassManager.h"
+#include "llvm/include/llvm/MC/MCSubtargetInfo.h"
 #include "llvm/include/llvm/Passes/OptimizationLevel.h"
 #include "llvm/include/llvm/Passes/PassBuilder.h"
 #include "llvm/include/llvm/Support/CodeGen.h"
+#include "llvm/include/llvm/Support/MemoryBuffer.h"
+#include "llvm/include/llvm/Transforms/Utils/SplitModule.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/logging/vlog_is_on.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/tracing.h"
+
+ABSL_FLAG(std::string, jit_cache_dir, "",
+          "If non-empty, directory in which to cache object code emitted by "
+          "the JIT. Subsequent compilations of identical IR with the same "
+          "optimization level and target reuse the cached object and skip "
+          "LLVM optimization and code generation.");
 
 namespace xls {
 namespace {
@@ -88,30 +109,103 @@ class BadOptLevelError : public llvm::ErrorInfo<BadOptLevelError> {
 
 char BadOptLevelError::ID;
 
+// Modules are only split for concurrent compilation into parts of at least
+// this many LLVM instructions, below which splitting costs more than it saves.
+constexpr int64_t kMinSplitModuleInstructionCount = 20000;
+
+// Returns the executor process control of the JIT's execution session. With
+// more than one compile thread, materialization tasks are dispatched to a
+// thread pool so that independent modules are compiled concurrently.
+std::unique_ptr<llvm::orc::ExecutorProcessControl> CreateExecutorProcessControl(
+    int64_t compile_threads) {
+  if (compile_threads <= 1) {
+    return std::make_unique<llvm::orc::UnsupportedExecutorProcessControl>();
+  }
+  return std::make_unique<llvm::orc::UnsupportedExecutorProcessControl>(
+      /*SSP=*/nullptr,
+      std::make_unique<llvm::orc::DynamicThreadPoolTaskDispatcher>());
+}
+
+absl::StatusOr<llvm::orc::JITTargetMachineBuilder> CreateTargetMachineBuilder(
+    const JitTargetOptions& target_options) {
+  auto error_or_target_builder =
+      llvm::orc::JITTargetMachineBuilder::detectHost();
+  if (!error_or_target_builder) {
+    return absl::InternalError(
+        absl::StrCat("Unable to detect host: ",
+                     llvm::toString(error_or_target_builder.takeError())));
+  }
+
+  // detectHost() selects the host CPU and enables all of its features. An
+  // explicitly specified CPU brings its own feature set instead.
+  if (!target_options.cpu.empty()) {
+    error_or_target_builder->setCPU(target_options.cpu);
+    error_or_target_builder->getFeatures() = llvm::SubtargetFeatures();
+  }
+  if (!target_options.features.empty()) {
+    error_or_target_builder->addFeatures(
+        absl::StrSplit(target_options.features, ',', absl::SkipEmpty()));
+  }
+
+  error_or_target_builder->setRelocationModel(llvm::Reloc::Model::PIC_);
+  return std::move(error_or_target_builder.get());
+}
+
+absl::StatusOr<std::unique_ptr<llvm::TargetMachine>> CreateTargetMachine(
+    const JitTargetOptions& target_options) {
+  XLS_ASSIGN_OR_RETURN(llvm::orc::JITTargetMachineBuilder target_builder,
+                       CreateTargetMachineBuilder(target_options));
+  auto error_or_target_machine = target_builder.createTargetMachine();
+  if (!error_or_target_machine) {
+    return absl::InternalError(
+        absl::StrCat("Unable to create target machine: ",
+                     llvm::toString(error_or_target_machine.takeError())));
+  }
+  std::unique_ptr<llvm::TargetMachine> target_machine =
+      std::move(error_or_target_machine.get());
+  if (!target_options.cpu.empty() &&
+      !target_machine->getMCSubtargetInfo()->isCPUStringValid(
+          target_options.cpu)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Unknown CPU `%s` for target %s", target_options.cpu,
+        target_machine->getTargetTriple().normalize()));
+  }
+  return target_machine;
+}
+
 }  // namespace
 
-OrcJit::OrcJit(int64_t opt_level, bool emit_object_code)
+JitSession::JitSession(int64_t opt_level, bool emit_object_code,
+                       const JitTargetOptions& target_options)
     : context_(std::make_unique<llvm::LLVMContext>()),
       execution_session_(
-          std::make_unique<llvm::orc::UnsupportedExecutorProcessControl>()),
+          CreateExecutorProcessControl(target_options.compile_threads)),
       object_layer_(
           execution_session_,
           []() { return std::make_unique<llvm::SectionMemoryManager>(); }),
-      dylib_(execution_session_.createBareJITDylib("main")),
       opt_level_(opt_level),
       emit_object_code_(emit_object_code),
+      target_options_(target_options),
       data_layout_("") {}
 
-OrcJit::~OrcJit() {
+JitSession::~JitSession() {
   if (auto err = execution_session_.endSession()) {
     execution_session_.reportError(std::move(err));
   }
 }
 
-llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
+llvm::Expected<llvm::orc::ThreadSafeModule> JitSession::Optimizer(
     llvm::orc::ThreadSafeModule module,
     const llvm::orc::MaterializationResponsibility& responsibility) {
   llvm::Module* bare_module = module.getModuleUnlocked();
+  {
+    absl::MutexLock lock(&materialized_functions_mutex_);
+    for (const llvm::Function& function : *bare_module) {
+      if (!function.isDeclaration()) {
+        materialized_functions_.insert(function.getName().str());
+      }
+    }
+  }
 
   XLS_VLOG(2) << "Unoptimized module IR:";
   XLS_VLOG_LINES(2, DumpLlvmModuleToString(bare_module));
@@ -128,8 +222,22 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
   pass_builder.registerLoopAnalyses(lam);
   pass_builder.crossRegisterProxies(lam, fam, cgam, mam);
 
+  if (target_options_.prefer_vector_width > 0) {
+    std::string width = absl::StrCat(target_options_.prefer_vector_width);
+    for (llvm::Function& function : *bare_module) {
+      function.addFnAttr("prefer-vector-width", width);
+    }
+  }
+
+  int64_t opt_level = GetModuleOptLevel(*bare_module);
+  if (opt_level != opt_level_) {
+    XLS_VLOG(1) << absl::StreamFormat(
+        "Optimizing module `%s` with %d instructions at opt level %d",
+        bare_module->getName().str(), bare_module->getInstructionCount(),
+        opt_level);
+  }
   llvm::OptimizationLevel llvm_opt_level;
-  switch (opt_level_) {
+  switch (opt_level) {
     case 0:
       llvm_opt_level = llvm::OptimizationLevel::O0;
       break;
@@ -144,7 +252,7 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
       break;
     default:
       return llvm::Expected<llvm::orc::ThreadSafeModule>(
-          llvm::Error(std::make_unique<BadOptLevelError>(opt_level_)));
+          llvm::Error(std::make_unique<BadOptLevelError>(opt_level)));
   }
   llvm::ModulePassManager mpm;
   if (llvm_opt_level == llvm::OptimizationLevel::O0) {
@@ -166,6 +274,7 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
     llvm::SmallVector<char, 0> stream_buffer;
     llvm::raw_svector_ostream ostream(stream_buffer);
     llvm::legacy::PassManager mpm;
+    absl::MutexLock lock(&target_machine_mutex_);
     if (target_machine_->addPassesToEmitFile(
             mpm, ostream, nullptr, llvm::CodeGenFileType::AssemblyFile)) {
       XLS_VLOG(3) << "Could not create ASM generation pass!";
@@ -178,44 +287,91 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
   return module;
 }
 
-absl::StatusOr<std::unique_ptr<OrcJit>> OrcJit::Create(int64_t opt_level,
-                                                       bool emit_object_code) {
+bool JitSession::IsMaterialized(std::string_view function_name) {
+  absl::MutexLock lock(&materialized_functions_mutex_);
+  return materialized_functions_.contains(function_name);
+}
+
+absl::StatusOr<std::shared_ptr<JitSession>> JitSession::Create(
+    int64_t opt_level, bool emit_object_code,
+    const JitTargetOptions& target_options) {
   absl::call_once(once, OnceInit);
-  std::unique_ptr<OrcJit> jit =
-      absl::WrapUnique(new OrcJit(opt_level, emit_object_code));
-  XLS_RETURN_IF_ERROR(jit->Init());
-  return std::move(jit);
+  std::shared_ptr<JitSession> session = absl::WrapUnique(
+      new JitSession(opt_level, emit_object_code, target_options));
+  XLS_RETURN_IF_ERROR(session->Init());
+  return session;
+}
+
+absl::StatusOr<std::unique_ptr<OrcJit>> OrcJit::Create(
+    int64_t opt_level, bool emit_object_code,
+    const JitTargetOptions& target_options) {
+  XLS_ASSIGN_OR_RETURN(
+      std::shared_ptr<JitSession> session,
+      JitSession::Create(opt_level, emit_object_code, target_options));
+  return CreateInSession(std::move(session));
+}
+
+std::unique_ptr<OrcJit> OrcJit::CreateInSession(
+    std::shared_ptr<JitSession> session) {
+  llvm::orc::JITDylib& dylib = session->CreateDylib();
+  return absl::WrapUnique(new OrcJit(std::move(session), dylib));
+}
+
+OrcJit::~OrcJit() {
+  absl::Status status = session_->RemoveDylib(dylib_);
+  if (!status.ok()) {
+    XLS_LOG(ERROR) << "Unable to unload jitted code: " << status;
+  }
 }
 
 /* static */ absl::StatusOr<llvm::DataLayout> OrcJit::CreateDataLayout() {
   absl::call_once(once, OnceInit);
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<llvm::TargetMachine> target_machine,
-                       CreateTargetMachine());
+                       CreateTargetMachine(JitTargetOptions()));
   return target_machine->createDataLayout();
 }
 
-/* static */ absl::StatusOr<std::unique_ptr<llvm::TargetMachine>>
-OrcJit::CreateTargetMachine() {
-  auto error_or_target_builder =
-      llvm::orc::JITTargetMachineBuilder::detectHost();
-  if (!error_or_target_builder) {
-    return absl::InternalError(
-        absl::StrCat("Unable to detect host: ",
-                     llvm::toString(error_or_target_builder.takeError())));
+int64_t JitSession::GetModuleOptLevel(const llvm::Module& module) const {
+  if (opt_level_ > 1 && target_options_.large_module_instruction_count > 0 &&
+      module.getInstructionCount() >
+          target_options_.large_module_instruction_count) {
+    return 1;
   }
+  return opt_level_;
+}
 
-  error_or_target_builder->setRelocationModel(llvm::Reloc::Model::PIC_);
-  auto error_or_target_machine = error_or_target_builder->createTargetMachine();
-  if (!error_or_target_machine) {
-    return absl::InternalError(
-        absl::StrCat("Unable to create target machine: ",
-                     llvm::toString(error_or_target_machine.takeError())));
-  }
-  return std::move(error_or_target_machine.get());
+namespace {
+
+// The most recent error reported by any execution session. For a failed lazy
+// compilation this names the function which could not be compiled.
+ABSL_CONST_INIT absl::Mutex last_session_error_mutex(absl::kConstInit);
+std::string& LastSessionError()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(last_session_error_mutex) {
+  static std::string* error = new std::string();
+  return *error;
+}
+
+void ReportSessionError(llvm::Error error) {
+  std::string message = llvm::toString(std::move(error));
+  XLS_LOG(ERROR) << "JIT session error: " << message;
+  absl::MutexLock lock(&last_session_error_mutex);
+  LastSessionError() = message;
+}
+
+// Called in place of a lazily compiled function which could not be compiled
+// (after the failure has been reported to the session). The arguments of the
+// call are ignored.
+void LazyCompilationFailed() {
+  absl::MutexLock lock(&last_session_error_mutex);
+  XLS_LOG(FATAL) << "Called a JIT function whose lazy compilation failed: "
+                 << LastSessionError();
 }
 
-absl::Status OrcJit::Init() {
-  XLS_ASSIGN_OR_RETURN(target_machine_, CreateTargetMachine());
+}  // namespace
+
+absl::Status JitSession::Init() {
+  execution_session_.setErrorReporter(ReportSessionError);
+  XLS_ASSIGN_OR_RETURN(target_machine_, CreateTargetMachine(target_options_));
   if (XLS_VLOG_IS_ON(1)) {
     std::string triple = target_machine_->getTargetTriple().normalize();
     std::string cpu = target_machine_->getTargetCPU().str();
@@ -232,13 +388,26 @@ absl::Status OrcJit::Init() {
   }
   data_layout_ = target_machine_->createDataLayout();
 
-  execution_session_.runSessionLocked([this]() {
-    dylib_.addGenerator(
-        cantFail(llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
-            data_layout_.getGlobalPrefix())));
-  });
-
-  auto compiler = std::make_unique<llvm::orc::SimpleCompiler>(*target_machine_);
+  bool lazy_compilation =
+      target_options_.lazy_compilation && !emit_object_code_;
+  std::string cache_dir = absl::GetFlag(FLAGS_jit_cache_dir);
+  // Cached objects are compiled from whole modules, not from the per-function
+  // parts materialized by lazy compilation.
+  if (!cache_dir.empty() && !lazy_compilation) {
+    object_cache_ = std::make_unique<JitObjectCache>(cache_dir);
+  }
+  std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler> compiler;
+  if (target_options_.compile_threads > 1) {
+    // SimpleCompiler shares a single target machine, which is unsafe when
+    // modules are compiled concurrently.
+    XLS_ASSIGN_OR_RETURN(llvm::orc::JITTargetMachineBuilder target_builder,
+                         CreateTargetMachineBuilder(target_options_));
+    compiler = std::make_unique<llvm::orc::ConcurrentIRCompiler>(
+        std::move(target_builder), object_cache_.get());
+  } else {
+    compiler = std::make_unique<llvm::orc::SimpleCompiler>(
+        *target_machine_, object_cache_.get());
+  }
   compile_layer_ = std::make_unique<llvm::orc::IRCompileLayer>(
       execution_session_, object_layer_, std::move(compiler));
 
@@ -273,16 +442,55 @@ absl::Status OrcJit::Init() {
         return Optimizer(std::move(module), responsibility);
       });
 
+  if (lazy_compilation) {
+    const llvm::Triple& triple = target_machine_->getTargetTriple();
+    llvm::Expected<std::unique_ptr<llvm::orc::LazyCallThroughManager>>
+        call_through_manager = llvm::orc::createLocalLazyCallThroughManager(
+            triple, execution_session_,
+            llvm::orc::ExecutorAddr::fromPtr(&LazyCompilationFailed));
+    if (!call_through_manager) {
+      return absl::InternalError(absl::StrFormat(
+          "Unable to create lazy call-through manager: %s",
+          llvm::toString(call_through_manager.takeError())));
+    }
+    lazy_call_through_manager_ = std::move(*call_through_manager);
+    compile_on_demand_layer_ =
+        std::make_unique<llvm::orc::CompileOnDemandLayer>(
+            execution_session_, *transform_layer_, *lazy_call_through_manager_,
+            llvm::orc::createLocalIndirectStubsManagerBuilder(triple));
+    // Compile only the called function rather than its whole module.
+    compile_on_demand_layer_->setPartitionFunction(
+        llvm::orc::CompileOnDemandLayer::compileRequested);
+  }
+
   return absl::OkStatus();
 }
 
-std::unique_ptr<llvm::Module> OrcJit::NewModule(std::string_view name) {
+std::unique_ptr<llvm::Module> JitSession::NewModule(std::string_view name) {
   llvm::LLVMContext* bare_context = context_.getContext();
   auto module = std::make_unique<llvm::Module>(name, *bare_context);
   module->setDataLayout(data_layout_);
   return module;
 }
 
+llvm::orc::JITDylib& JitSession::CreateDylib() {
+  llvm::orc::JITDylib& dylib = execution_session_.createBareJITDylib(
+      absl::StrCat("dylib.", next_dylib_id_++));
+  dylib.addGenerator(
+      cantFail(llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+          data_layout_.getGlobalPrefix())));
+  return dylib;
+}
+
+absl::Status JitSession::RemoveDylib(llvm::orc::JITDylib& dylib) {
+  if (llvm::Error error = execution_session_.removeJITDylib(dylib)) {
+    return absl::InternalError(
+        absl::StrFormat("Unable to remove JITDylib: %s",
+                        llvm::toString(std::move(error))));
+  }
+  return absl::OkStatus();
+}
+
 namespace {
 
 // Check that every operand of every instruction is in the same function as the
@@ -325,10 +533,113 @@ absl::Status VerifyModule(const llvm::Module& module) {
 
 }  // namespace
 
-absl::Status OrcJit::CompileModule(std::unique_ptr<llvm::Module>&& module) {
+absl::Status JitSession::CompileModule(std::unique_ptr<llvm::Module>&& module,
+                                       llvm::orc::JITDylib& dylib) {
+  ScopedTraceSpan trace_span("jit", "llvm_compile");
   XLS_RETURN_IF_ERROR(VerifyModule(*module));
-  llvm::Error error = transform_layer_->add(
-      dylib_, llvm::orc::ThreadSafeModule(std::move(module), context_));
+  if (target_options_.compile_threads > 1 && !emit_object_code_ &&
+      compile_on_demand_layer_ == nullptr &&
+      module->getInstructionCount() >= 2 * kMinSplitModuleInstructionCount) {
+    return CompileModuleConcurrently(std::move(module), dylib);
+  }
+  return AddModule(llvm::orc::ThreadSafeModule(std::move(module), context_),
+                   dylib);
+}
+
+absl::Status JitSession::CompileModuleConcurrently(
+    std::unique_ptr<llvm::Module> module, llvm::orc::JITDylib& dylib) {
+  int64_t part_count = std::min(
+      target_options_.compile_threads,
+      static_cast<int64_t>(module->getInstructionCount()) /
+          kMinSplitModuleInstructionCount);
+  XLS_VLOG(1) << absl::StreamFormat(
+      "Splitting module `%s` with %d instructions into %d parts",
+      module->getName().str(), module->getInstructionCount(), part_count);
+
+  // Modules sharing an LLVM context cannot be compiled concurrently, so each
+  // part is moved into its own context through bitcode.
+  std::vector<std::string> part_bitcode;
+  llvm::SplitModule(
+      *module, part_count,
+      [&](std::unique_ptr<llvm::Module> part) {
+        llvm::raw_string_ostream ostream(part_bitcode.emplace_back());
+        llvm::WriteBitcodeToFile(*part, ostream);
+        ostream.flush();
+      },
+      /*PreserveLocals=*/false);
+
+  llvm::orc::MangleAndInterner mangle(execution_session_, data_layout_);
+  llvm::orc::SymbolLookupSet symbols;
+  for (int64_t i = 0; i < part_bitcode.size(); ++i) {
+    std::string part_name =
+        absl::StrFormat("%s.%d", module->getName().str(), i);
+    auto part_context = std::make_unique<llvm::LLVMContext>();
+    llvm::Expected<std::unique_ptr<llvm::Module>> part = llvm::parseBitcodeFile(
+        llvm::MemoryBufferRef(part_bitcode[i], part_name), *part_context);
+    if (!part) {
+      return absl::InternalError(
+          absl::StrFormat("Unable to load module part %s: %s", part_name,
+                          llvm::toString(part.takeError())));
+    }
+    (*part)->setModuleIdentifier(part_name);
+    for (const llvm::Function& function : **part) {
+      if (!function.isDeclaration() && !function.hasLocalLinkage()) {
+        symbols.add(mangle(function.getName()));
+      }
+    }
+    XLS_RETURN_IF_ERROR(AddModule(llvm::orc::ThreadSafeModule(
+        std::move(*part),
+        llvm::orc::ThreadSafeContext(std::move(part_context))),
+        dylib));
+  }
+
+  // Look up the definitions of all parts at once so that the execution session
+  // materializes (optimizes and compiles) the parts concurrently rather than
+  // one at a time as their symbols are first referenced.
+  llvm::Expected<llvm::orc::SymbolMap> addresses = execution_session_.lookup(
+      llvm::orc::makeJITDylibSearchOrder(&dylib), std::move(symbols));
+  if (!addresses) {
+    return absl::UnknownError(
+        absl::StrFormat("Error compiling converted IR: %s",
+                        llvm::toString(addresses.takeError())));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status JitSession::AddModule(
+    llvm::orc::ThreadSafeModule thread_safe_module,
+    llvm::orc::JITDylib& dylib) {
+  llvm::Module* module = thread_safe_module.getModuleUnlocked();
+  if (object_cache_ != nullptr) {
+    std::string key =
+        JitObjectCache::ComputeKey(*module, GetModuleOptLevel(*module),
+                                   *target_machine_);
+    XLS_ASSIGN_OR_RETURN(std::optional<std::string> object,
+                         object_cache_->Lookup(key));
+    if (object.has_value()) {
+      // Bypass optimization and compilation and link the cached object
+      // directly.
+      if (emit_object_code_) {
+        object_code_ = std::vector<uint8_t>(object->begin(), object->end());
+      }
+      llvm::Error error = object_layer_.add(
+          dylib, llvm::MemoryBuffer::getMemBufferCopy(*object, key));
+      if (error) {
+        return absl::UnknownError(
+            absl::StrFormat("Error loading cached object %s: %s", key,
+                            llvm::toString(std::move(error))));
+      }
+      return absl::OkStatus();
+    }
+    // The compiler notifies the cache of the emitted object under the module
+    // identifier.
+    module->setModuleIdentifier(key);
+  }
+  llvm::orc::IRLayer& layer =
+      compile_on_demand_layer_ != nullptr
+          ? static_cast<llvm::orc::IRLayer&>(*compile_on_demand_layer_)
+          : static_cast<llvm::orc::IRLayer&>(*transform_layer_);
+  llvm::Error error = layer.add(dylib, std::move(thread_safe_module));
   if (error) {
     return absl::UnknownError(absl::StrFormat(
         "Error compiling converted IR: %s", llvm::toString(std::move(error))));
@@ -336,15 +647,18 @@ absl::Status OrcJit::CompileModule(std::unique_ptr<llvm::Module>&& module) {
   return absl::OkStatus();
 }
 
-absl::StatusOr<llvm::orc::ExecutorAddr> OrcJit::LoadSymbol(
-    std::string_view function_name) {
+absl::StatusOr<llvm::orc::ExecutorAddr> JitSession::LoadSymbol(
+    std::string_view function_name, llvm::orc::JITDylib& dylib) {
 #ifdef __APPLE__
   // On Apple systems, symbols are still prepended with an underscore.
   std::string function_name_with_underscore = absl::StrCat("_", function_name);
   function_name = function_name_with_underscore;
 #endif /* __APPLE__ */
+  // Modules are optimized and compiled lazily, when their symbols are first
+  // looked up.
+  ScopedTraceSpan trace_span("jit", "llvm_materialize");
   llvm::Expected<llvm::orc::ExecutorSymbolDef> symbol =
-      execution_session_.lookup(&dylib_, function_name);
+      execution_session_.lookup(&dylib, function_name);
   if (!symbol) {
     return absl::InternalError(
         absl::StrFormat("Could not find start symbol \"%s\": %s", function_name,
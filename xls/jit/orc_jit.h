@@ -15,60 +15,159 @@
 #ifndef XLS_JIT_ORC_JIT_H_
 #define XLS_JIT_ORC_JIT_H_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Core.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRCompileLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRTransformLayer.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/LazyReexports.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
 #include "llvm/include/llvm/Target/TargetMachine.h"
+#include "xls/ir/events.h"
+#include "xls/jit/jit_object_cache.h"
 
 namespace xls {
 
-// A wrapper around ORC JIT which hides some of the internals of the LLVM
-// interface.
-class OrcJit {
+// Options selecting the machine the JIT generates code for, the LLVM
+// optimization pipeline applied to each compiled module and how the generated
+// code records events.
+struct JitTargetOptions {
+  // LLVM name of the CPU to generate code for, e.g. "skylake-avx512",
+  // "neoverse-n1" or "generic". If empty, code is generated for the host CPU
+  // with all of its detected features (e.g. AVX2, AVX-512 or NEON) enabled.
+  std::string cpu;
+
+  // Comma-separated LLVM target features to enable or disable on top of those
+  // of the CPU, e.g. "+avx2,-avx512f".
+  std::string features;
+
+  // If positive, the preferred width in bits of vectors formed by the loop and
+  // SLP vectorizers. LLVM otherwise limits some AVX-512 capable CPUs to 256-bit
+  // vectors.
+  int64_t prefer_vector_width = 0;
+
+  // If positive, modules with more LLVM instructions than this are optimized
+  // with the O1 pipeline instead of the requested opt level. The O2 and O3
+  // pipelines scale poorly with function size and dominate the compile time of
+  // very large functions.
+  int64_t large_module_instruction_count = 0;
+
+  // Number of threads used to compile each module. If greater than one, large
+  // modules are split into up to this many parts which are optimized and
+  // compiled concurrently. Calls between the parts are not inlined, trading
+  // some code quality for compile time. Not used if object code is emitted.
+  int64_t compile_threads = 1;
+
+  // If true, each function in a module is compiled the first time it is
+  // called rather than when the module is added; calls into functions which
+  // have not been compiled yet go through stubs which trigger their
+  // compilation. Startup time is then proportional to the code actually
+  // executed, at the cost of no inlining across functions (e.g., of invoked
+  // callees). Not used if object code is emitted. Disables --jit_cache_dir and
+  // concurrent compilation, which require whole modules.
+  bool lazy_compilation = false;
+
+  // How the generated code records trace messages. With kDeferred, rendering
+  // the messages requires the JitRuntime the code ran with to still exist. With
+  // kDisabled no code is generated for trace operations.
+  TraceRecording trace_recording = TraceRecording::kEager;
+
+  // If true, the generated code counts select arms, predicated operations and
+  // channel operations in an ActivityProfile owned by the JIT object (e.g.,
+  // FunctionJit or ProcJit). The counters are addressed directly by the
+  // generated code so this cannot be combined with emitting object code.
+  bool activity_profile = false;
+};
+
+// The state shared by all JITs compiling into a single LLVM ORC execution
+// session: the LLVM context, the target machine, the optimization and
+// compilation layers and the object cache. Creating these dominates the cost
+// of jitting small functions, so clients jitting many functions (e.g.,
+// fuzzers or simulators evaluating many small packages) should create one
+// session and compile each function into it with `OrcJit::CreateInSession`.
+//
+// Each OrcJit compiling into the session resolves symbols in its own JITDylib,
+// so symbol names need only be unique within a single OrcJit, and the code of
+// an OrcJit is unloaded when it is destroyed. Modules share the session's LLVM
+// context so OrcJits of the same session must not build or compile modules
+// concurrently.
+class JitSession {
  public:
-  ~OrcJit();
-  // Create an LLVM ORC JIT instance which compiles at the given optimization
-  // level. If `emit_object_code` is true then `GetObjectCode` can be called
-  // after compilation to get the object code.
-  static absl::StatusOr<std::unique_ptr<OrcJit>> Create(
-      int64_t opt_level = 3, bool emit_object_code = false);
+  ~JitSession();
+
+  // Creates a session which compiles at the given optimization level. If
+  // `emit_object_code` is true then `GetObjectCode` can be called after
+  // compilation to get the object code. If the `--jit_cache_dir` flag is set,
+  // compiled objects are cached in (and reused from) that directory.
+  static absl::StatusOr<std::shared_ptr<JitSession>> Create(
+      int64_t opt_level = 3, bool emit_object_code = false,
+      const JitTargetOptions& target_options = JitTargetOptions());
 
   // Creates and returns a new LLVM module of the given name.
   std::unique_ptr<llvm::Module> NewModule(std::string_view name);
 
-  // Compiles the given LLVM module into the JIT's execution session.
-  absl::Status CompileModule(std::unique_ptr<llvm::Module>&& module);
+  // Creates a new, empty JITDylib in which process symbols (e.g., those of the
+  // JIT runtime) are also resolved.
+  llvm::orc::JITDylib& CreateDylib();
 
-  // Returns the address of the given JIT'ed function.
+  // Removes the given JITDylib, unloading all code compiled into it.
+  absl::Status RemoveDylib(llvm::orc::JITDylib& dylib);
+
+  // Compiles the given LLVM module into `dylib`.
+  absl::Status CompileModule(std::unique_ptr<llvm::Module>&& module,
+                             llvm::orc::JITDylib& dylib);
+
+  // Returns the address of the given JIT'ed function in `dylib`.
   absl::StatusOr<llvm::orc::ExecutorAddr> LoadSymbol(
-      std::string_view function_name);
+      std::string_view function_name, llvm::orc::JITDylib& dylib);
 
   // Return the underlying LLVM context.
   llvm::LLVMContext* GetContext() { return context_.getContext(); }
 
+  const JitTargetOptions& target_options() const { return target_options_; }
+  const llvm::DataLayout& data_layout() const { return data_layout_; }
+
+  // Returns whether a definition of the LLVM function `function_name` has been
+  // optimized and compiled, in any JITDylib of the session. With lazy
+  // compilation this only happens on the first call of the function.
+  bool IsMaterialized(std::string_view function_name);
+
   // Returns the object code which was created in the previous CompileModule
   // call (if `emit_object_code` is true).
   const std::vector<uint8_t>& GetObjectCode() { return object_code_; }
 
-  // Creates and returns a data layout object.
-  static absl::StatusOr<llvm::DataLayout> CreateDataLayout();
-
  private:
-  OrcJit(int64_t opt_level, bool emit_object_code);
+  JitSession(int64_t opt_level, bool emit_object_code,
+             const JitTargetOptions& target_options);
   absl::Status Init();
 
-  static absl::StatusOr<std::unique_ptr<llvm::TargetMachine>>
-  CreateTargetMachine();
+  // Adds the given verified module to `dylib`, or the cached object compiled
+  // from an identical module if there is one.
+  absl::Status AddModule(llvm::orc::ThreadSafeModule module,
+                         llvm::orc::JITDylib& dylib);
+
+  // Splits the given verified module into parts, each in its own LLVM context,
+  // and compiles them concurrently into `dylib`.
+  absl::Status CompileModuleConcurrently(std::unique_ptr<llvm::Module> module,
+                                         llvm::orc::JITDylib& dylib);
+
+  // Returns the opt level at which the given (unoptimized) module is compiled.
+  int64_t GetModuleOptLevel(const llvm::Module& module) const;
 
   // Method which optimizes the given module. Used within the JIT to form an IR
   // transform layer.
@@ -79,24 +178,104 @@ class OrcJit {
   llvm::orc::ThreadSafeContext context_;
   llvm::orc::ExecutionSession execution_session_;
   llvm::orc::RTDyldObjectLinkingLayer object_layer_;
-  llvm::orc::JITDylib& dylib_;
+
+  // Used to give each JITDylib a unique name.
+  std::atomic<int64_t> next_dylib_id_ = 0;
 
   int64_t opt_level_;
   bool emit_object_code_;
+  JitTargetOptions target_options_;
 
   std::unique_ptr<llvm::TargetMachine> target_machine_;
+  // Guards the use of `target_machine_` to dump assembly from the optimizer,
+  // which may run concurrently on several modules.
+  absl::Mutex target_machine_mutex_;
   llvm::DataLayout data_layout_;
 
   std::unique_ptr<llvm::orc::IRCompileLayer> compile_layer_;
   std::unique_ptr<llvm::orc::IRTransformLayer> transform_layer_;
   // If set, this contains the logic to emit object code.
   std::unique_ptr<llvm::orc::IRTransformLayer> object_code_layer_;
+  // Only set with `JitTargetOptions::lazy_compilation`. Modules are added to
+  // `compile_on_demand_layer_` which compiles each function (through
+  // `transform_layer_`) on its first call.
+  std::unique_ptr<llvm::orc::LazyCallThroughManager> lazy_call_through_manager_;
+  std::unique_ptr<llvm::orc::CompileOnDemandLayer> compile_on_demand_layer_;
+
+  // Names of the functions defined in the modules passed to the optimizer.
+  absl::Mutex materialized_functions_mutex_;
+  absl::flat_hash_set<std::string> materialized_functions_
+      ABSL_GUARDED_BY(materialized_functions_mutex_);
+
+  // Persistent object cache. Only set if `--jit_cache_dir` is specified.
+  std::unique_ptr<JitObjectCache> object_cache_;
 
   // When `CompileModule` is called and `emit_object_code` is true, this vector
   // will be allocated and filled with the object code of the compiled module.
   std::vector<uint8_t> object_code_;
 };
 
+// A wrapper around ORC JIT which hides some of the internals of the LLVM
+// interface. Compiles into its own JITDylib of a (possibly shared) JitSession.
+class OrcJit {
+ public:
+  // Unloads the code compiled by this JIT.
+  ~OrcJit();
+  // Create an LLVM ORC JIT instance with its own session which compiles at the
+  // given optimization level. See `JitSession::Create`.
+  static absl::StatusOr<std::unique_ptr<OrcJit>> Create(
+      int64_t opt_level = 3, bool emit_object_code = false,
+      const JitTargetOptions& target_options = JitTargetOptions());
+
+  // Creates an LLVM ORC JIT instance which compiles into the given session.
+  static std::unique_ptr<OrcJit> CreateInSession(
+      std::shared_ptr<JitSession> session);
+
+  // Creates and returns a new LLVM module of the given name.
+  std::unique_ptr<llvm::Module> NewModule(std::string_view name) {
+    return session_->NewModule(name);
+  }
+
+  // Compiles the given LLVM module into the JIT's execution session.
+  absl::Status CompileModule(std::unique_ptr<llvm::Module>&& module) {
+    return session_->CompileModule(std::move(module), dylib_);
+  }
+
+  // Returns the address of the given JIT'ed function.
+  absl::StatusOr<llvm::orc::ExecutorAddr> LoadSymbol(
+      std::string_view function_name) {
+    return session_->LoadSymbol(function_name, dylib_);
+  }
+
+  // Return the underlying LLVM context.
+  llvm::LLVMContext* GetContext() { return session_->GetContext(); }
+
+  const JitTargetOptions& target_options() const {
+    return session_->target_options();
+  }
+  const llvm::DataLayout& data_layout() const {
+    return session_->data_layout();
+  }
+
+  // Returns the object code which was created in the previous CompileModule
+  // call of the session (if `emit_object_code` is true).
+  const std::vector<uint8_t>& GetObjectCode() {
+    return session_->GetObjectCode();
+  }
+
+  JitSession& session() { return *session_; }
+
+  // Creates and returns a data layout object.
+  static absl::StatusOr<llvm::DataLayout> CreateDataLayout();
+
+ private:
+  OrcJit(std::shared_ptr<JitSession> session, llvm::orc::JITDylib& dylib)
+      : session_(std::move(session)), dylib_(dylib) {}
+
+  std::shared_ptr<JitSession> session_;
+  llvm::orc::JITDylib& dylib_;
+};
+
 // Calls the dump method on the given LLVM object and returns the string.
 template <typename T>
 std::string DumpLlvmObjectToString(const T& llvm_object) {
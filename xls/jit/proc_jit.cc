@@ -14,8 +14,10 @@
 
 #include "xls/jit/proc_jit.h"
 
+#include <algorithm>
 #include <memory>
 #include <optional>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -25,33 +27,50 @@
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/interpreter/proc_checkpoint.pb.h"
 #include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/activity_profile.h"
+#include "xls/ir/channel.h"
 #include "xls/ir/proc.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/ir/value_helpers.h"
 #include "xls/jit/jit_runtime.h"
 
 namespace xls {
 
-ProcJitContinuation::ProcJitContinuation(Proc* proc, int64_t temp_buffer_size,
-                                         JitRuntime* jit_runtime)
-    : proc_(proc), continuation_point_(0), jit_runtime_(jit_runtime) {
-  // Pre-allocate input, output, and temporary buffers.
-  for (Param* param : proc->params()) {
-    int64_t param_size = jit_runtime_->GetTypeByteSize(param->GetType());
+ProcJitContinuation::ProcJitContinuation(
+    Proc* proc, int64_t temp_buffer_size, JitRuntime* jit_runtime,
+    absl::Span<const int64_t> in_place_params)
+    : proc_(proc),
+      continuation_point_(0),
+      jit_runtime_(jit_runtime),
+      in_place_(proc->params().size(), false) {
+  for (int64_t param_index : in_place_params) {
+    in_place_[param_index] = true;
+  }
+  // Pre-allocate input, output, and temporary buffers. Params updated in place
+  // need no separate output buffer.
+  for (int64_t i = 0; i < proc->params().size(); ++i) {
+    const TypeLayout& layout =
+        jit_runtime_->GetTypeLayout(proc->param(i)->GetType());
+    param_layouts_.push_back(&layout);
+    int64_t param_size = layout.size();
     input_buffers_.push_back(std::vector<uint8_t>(param_size));
-    output_buffers_.push_back(std::vector<uint8_t>(param_size));
+    output_buffers_.push_back(
+        std::vector<uint8_t>(in_place_[i] ? 0 : param_size));
     input_ptrs_.push_back(input_buffers_.back().data());
-    output_ptrs_.push_back(output_buffers_.back().data());
+    output_ptrs_.push_back(in_place_[i] ? input_ptrs_.back()
+                                        : output_buffers_.back().data());
   }
 
   // Write initial state value to the input_buffer.
   for (Param* state_param : proc->StateParams()) {
     int64_t param_index = proc->GetParamIndex(state_param).value();
     int64_t state_index = proc->GetStateParamIndex(state_param).value();
-    jit_runtime->BlitValueToBuffer(proc->GetInitValueElement(state_index),
-                                   state_param->GetType(),
-                                   absl::MakeSpan(input_buffers_[param_index]));
+    param_layouts_[param_index]->ValueToNativeLayout(
+        proc->GetInitValueElement(state_index),
+        input_buffers_[param_index].data());
   }
 
   temp_buffer_.resize(temp_buffer_size);
@@ -61,35 +80,213 @@ std::vector<Value> ProcJitContinuation::GetState() const {
   std::vector<Value> state;
   for (Param* state_param : proc()->StateParams()) {
     int64_t param_index = proc()->GetParamIndex(state_param).value();
-    state.push_back(jit_runtime_->UnpackBuffer(input_ptrs_[param_index],
-                                               state_param->GetType(),
-                                               /*unpoison=*/true));
+    state.push_back(param_layouts_[param_index]->NativeLayoutToValue(
+        input_ptrs_[param_index]));
   }
   return state;
 }
 
+absl::StatusOr<ProcContinuationProto> ProcJitContinuation::ToProto() const {
+  ProcContinuationProto proto;
+  proto.set_proc_name(proc()->name());
+  ProcJitContinuationProto* jit = proto.mutable_jit();
+  jit->set_continuation_point(continuation_point_);
+  for (const std::vector<uint8_t>& buffer : input_buffers_) {
+    jit->add_input_buffers(buffer.data(), buffer.size());
+  }
+  for (const std::vector<uint8_t>& buffer : output_buffers_) {
+    jit->add_output_buffers(buffer.data(), buffer.size());
+  }
+  jit->set_temp_buffer(temp_buffer_.data(), temp_buffer_.size());
+  return proto;
+}
+
+namespace {
+
+// Copies `bytes` into `buffer` which must be exactly the same size.
+absl::Status CopyCheckpointBuffer(std::string_view bytes,
+                                  std::vector<uint8_t>& buffer,
+                                  std::string_view proc_name) {
+  if (bytes.size() != buffer.size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Checkpoint buffer of %d bytes does not match the %d byte buffer of "
+        "the JIT continuation of proc `%s`",
+        bytes.size(), buffer.size(), proc_name));
+  }
+  std::copy(bytes.begin(), bytes.end(), buffer.begin());
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status ProcJitContinuation::RestoreFromProto(
+    const ProcContinuationProto& proto) {
+  if (!proto.has_jit()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Checkpoint of proc `%s` is not a JIT continuation", proc()->name()));
+  }
+  const ProcJitContinuationProto& jit = proto.jit();
+  XLS_RET_CHECK_EQ(jit.input_buffers_size(), input_buffers_.size());
+  XLS_RET_CHECK_EQ(jit.output_buffers_size(), output_buffers_.size());
+  for (int64_t i = 0; i < input_buffers_.size(); ++i) {
+    XLS_RETURN_IF_ERROR(CopyCheckpointBuffer(
+        jit.input_buffers(i), input_buffers_[i], proc()->name()));
+    XLS_RETURN_IF_ERROR(CopyCheckpointBuffer(
+        jit.output_buffers(i), output_buffers_[i], proc()->name()));
+  }
+  XLS_RETURN_IF_ERROR(
+      CopyCheckpointBuffer(jit.temp_buffer(), temp_buffer_, proc()->name()));
+  continuation_point_ = jit.continuation_point();
+  return absl::OkStatus();
+}
+
+absl::Status ProcJitContinuation::SetState(absl::Span<const Value> state) {
+  XLS_RET_CHECK(AtStartOfTick());
+  XLS_RET_CHECK_EQ(state.size(), proc()->GetStateElementCount());
+  for (Param* state_param : proc()->StateParams()) {
+    int64_t param_index = proc()->GetParamIndex(state_param).value();
+    int64_t state_index = proc()->GetStateParamIndex(state_param).value();
+    XLS_RET_CHECK(ValueConformsToType(state[state_index],
+                                      state_param->GetType()));
+    std::fill(input_buffers_[param_index].begin(),
+              input_buffers_[param_index].end(), 0);
+    param_layouts_[param_index]->ValueToNativeLayout(
+        state[state_index], input_buffers_[param_index].data());
+  }
+  return absl::OkStatus();
+}
+
 void ProcJitContinuation::NextTick() {
   continuation_point_ = 0;
-  {
-    using std::swap;
-    swap(input_buffers_, output_buffers_);
-    swap(input_ptrs_, output_ptrs_);
+  // The next values of params updated in place are already in their input
+  // buffers.
+  using std::swap;
+  for (int64_t i = 0; i < input_buffers_.size(); ++i) {
+    if (!in_place_[i]) {
+      swap(input_buffers_[i], output_buffers_[i]);
+      swap(input_ptrs_[i], output_ptrs_[i]);
+    }
   }
 }
 
 absl::StatusOr<std::unique_ptr<ProcJit>> ProcJit::Create(
-    Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr) {
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit, OrcJit::Create());
+    Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr,
+    const JitTargetOptions& target_options, bool enable_lanes) {
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<OrcJit> orc_jit,
+      OrcJit::Create(/*opt_level=*/3, /*emit_object_code=*/false,
+                     target_options));
   auto jit =
       absl::WrapUnique(new ProcJit(proc, jit_runtime, std::move(orc_jit)));
+  ActivityProfile* activity_profile = target_options.activity_profile
+                                          ? jit->EnableActivityProfile()
+                                          : nullptr;
   XLS_ASSIGN_OR_RETURN(jit->jitted_function_base_,
-                       BuildProcFunction(proc, queue_mgr, jit->GetOrcJit()));
+                       BuildProcFunction(proc, queue_mgr, jit->GetOrcJit(),
+                                         activity_profile,
+                                         /*build_lanes_wrapper=*/enable_lanes));
+  if (enable_lanes) {
+    jit->queue_table_ = QueueTable(proc, queue_mgr);
+  }
   return jit;
 }
 
+std::vector<JitChannelQueue*> ProcJit::QueueTable(
+    Proc* proc, JitChannelQueueManager* queue_mgr) {
+  std::vector<JitChannelQueue*> table;
+  for (Channel* channel : proc->package()->channels()) {
+    table.push_back(&queue_mgr->GetJitQueue(channel));
+  }
+  return table;
+}
+
+ProcJitLanes::ProcJitLanes(
+    Proc* proc, std::vector<std::vector<JitChannelQueue*>> queue_tables,
+    const JittedFunctionBase& jitted_function_base, JitRuntime* jit_runtime)
+    : proc_(proc),
+      lane_count_(queue_tables.size()),
+      input_sizes_(jitted_function_base.input_buffer_sizes),
+      output_sizes_(jitted_function_base.output_buffer_sizes),
+      queue_tables_(std::move(queue_tables)),
+      in_place_(proc->params().size(), false) {
+  for (const std::vector<JitChannelQueue*>& queue_table : queue_tables_) {
+    lane_contexts_.push_back(ProcLaneContext{.continuation_point = 0,
+                                             .queues = queue_table.data()});
+  }
+  for (int64_t param_index : jitted_function_base.in_place_params) {
+    in_place_[param_index] = true;
+  }
+  for (int64_t i = 0; i < proc->params().size(); ++i) {
+    param_layouts_.push_back(
+        &jit_runtime->GetTypeLayout(proc->param(i)->GetType()));
+    input_buffers_.push_back(
+        std::vector<uint8_t>(input_sizes_[i] * lane_count_));
+    output_buffers_.push_back(
+        std::vector<uint8_t>(in_place_[i] ? 0
+                                          : output_sizes_[i] * lane_count_));
+    input_ptrs_.push_back(input_buffers_.back().data());
+    output_ptrs_.push_back(in_place_[i] ? input_ptrs_.back()
+                                        : output_buffers_.back().data());
+  }
+
+  // Write the initial state value to the input buffers of every lane.
+  for (Param* state_param : proc->StateParams()) {
+    int64_t param_index = proc->GetParamIndex(state_param).value();
+    int64_t state_index = proc->GetStateParamIndex(state_param).value();
+    for (int64_t lane = 0; lane < lane_count_; ++lane) {
+      param_layouts_[param_index]->ValueToNativeLayout(
+          proc->GetInitValueElement(state_index),
+          LaneInput(param_index, lane));
+    }
+  }
+
+  temp_buffer_.resize(jitted_function_base.temp_buffer_size * lane_count_);
+}
+
+std::vector<Value> ProcJitLanes::GetState(int64_t lane) const {
+  std::vector<Value> state;
+  for (Param* state_param : proc()->StateParams()) {
+    int64_t param_index = proc()->GetParamIndex(state_param).value();
+    state.push_back(param_layouts_[param_index]->NativeLayoutToValue(
+        LaneInput(param_index, lane)));
+  }
+  return state;
+}
+
+absl::Status ProcJitLanes::SetState(int64_t lane,
+                                    absl::Span<const Value> state) {
+  XLS_RET_CHECK(lane >= 0 && lane < lane_count_);
+  XLS_RET_CHECK(AtStartOfTick(lane));
+  XLS_RET_CHECK_EQ(state.size(), proc()->GetStateElementCount());
+  for (Param* state_param : proc()->StateParams()) {
+    int64_t param_index = proc()->GetParamIndex(state_param).value();
+    int64_t state_index = proc()->GetStateParamIndex(state_param).value();
+    XLS_RET_CHECK(ValueConformsToType(state[state_index],
+                                      state_param->GetType()));
+    uint8_t* buffer = LaneInput(param_index, lane);
+    std::fill(buffer, buffer + input_sizes_[param_index], 0);
+    param_layouts_[param_index]->ValueToNativeLayout(state[state_index],
+                                                     buffer);
+  }
+  return absl::OkStatus();
+}
+
+void ProcJitLanes::NextTick(int64_t lane) {
+  lane_contexts_[lane].continuation_point = 0;
+  // The lanes share their buffers so the next state is copied rather than
+  // swapped into place. Params updated in place already hold their next value.
+  for (int64_t i = 0; i < input_buffers_.size(); ++i) {
+    if (!in_place_[i]) {
+      std::copy_n(output_ptrs_[i] + lane * output_sizes_[i], input_sizes_[i],
+                  LaneInput(i, lane));
+    }
+  }
+}
+
 std::unique_ptr<ProcContinuation> ProcJit::NewContinuation() const {
   return std::make_unique<ProcJitContinuation>(
-      proc(), jitted_function_base_.temp_buffer_size, jit_runtime_);
+      proc(), jitted_function_base_.temp_buffer_size, jit_runtime_,
+      jitted_function_base_.in_place_params);
 }
 
 absl::StatusOr<TickResult> ProcJit::Tick(ProcContinuation& continuation) const {
@@ -103,18 +300,27 @@ absl::StatusOr<TickResult> ProcJit::Tick(ProcContinuation& continuation) const {
   int64_t next_continuation_point = jitted_function_base_.function(
       cont->GetInputBuffers().data(), cont->GetOutputBuffers().data(),
       cont->GetTempBuffer().data(), &cont->GetEvents(),
-      /*user_data=*/nullptr, runtime(), cont->GetContinuationPoint());
+      /*user_data=*/queue_table_.empty() ? nullptr : queue_table_.data(),
+      runtime(), cont->GetContinuationPoint());
 
   if (next_continuation_point == 0) {
     // The proc successfully completed its tick.
     cont->NextTick();
+  } else {
+    cont->SetContinuationPoint(next_continuation_point);
+  }
+  return GetTickResult(start_continuation_point, next_continuation_point);
+}
+
+absl::StatusOr<TickResult> ProcJit::GetTickResult(
+    int64_t start_continuation_point, int64_t next_continuation_point) const {
+  if (next_continuation_point == 0) {
     return TickResult{.execution_state = TickExecutionState::kCompleted,
                       .channel = std::nullopt,
                       .progress_made = true};
   }
   // The proc did not complete the tick. Determine at which node execution was
   // interrupted.
-  cont->SetContinuationPoint(next_continuation_point);
   XLS_RET_CHECK(jitted_function_base_.continuation_points.contains(
       next_continuation_point));
   Node* early_exit_node =
@@ -140,4 +346,51 @@ absl::StatusOr<TickResult> ProcJit::Tick(ProcContinuation& continuation) const {
       .progress_made = next_continuation_point != start_continuation_point};
 }
 
+absl::StatusOr<std::unique_ptr<ProcJitLanes>> ProcJit::NewLanes(
+    absl::Span<JitChannelQueueManager* const> queue_mgrs) const {
+  if (!jitted_function_base_.batched_function.has_value()) {
+    return absl::FailedPreconditionError(absl::StrFormat(
+        "JIT of proc `%s` was not created with lanes enabled", proc()->name()));
+  }
+  XLS_RET_CHECK(!queue_mgrs.empty());
+  std::vector<std::vector<JitChannelQueue*>> queue_tables;
+  for (JitChannelQueueManager* queue_mgr : queue_mgrs) {
+    queue_tables.push_back(QueueTable(proc(), queue_mgr));
+  }
+  return std::make_unique<ProcJitLanes>(proc(), std::move(queue_tables),
+                                        jitted_function_base_, jit_runtime_);
+}
+
+absl::StatusOr<std::vector<TickResult>> ProcJit::TickLanes(
+    ProcJitLanes& lanes) const {
+  XLS_RET_CHECK(jitted_function_base_.batched_function.has_value());
+  XLS_RET_CHECK_EQ(lanes.proc(), proc());
+  std::vector<int64_t> start_continuation_points;
+  for (const ProcLaneContext& lane_context : lanes.lane_contexts_) {
+    start_continuation_points.push_back(lane_context.continuation_point);
+  }
+
+  // The jitted function overwrites the continuation point of each lane with the
+  // early exit point at which the lane halted, or zero if its tick completed.
+  jitted_function_base_.batched_function.value()(
+      lanes.input_ptrs_.data(), lanes.output_ptrs_.data(),
+      lanes.temp_buffer_.data(), &lanes.events_,
+      /*user_data=*/lanes.lane_contexts_.data(), runtime(),
+      lanes.lane_count());
+
+  std::vector<TickResult> results;
+  results.reserve(lanes.lane_count());
+  for (int64_t lane = 0; lane < lanes.lane_count(); ++lane) {
+    XLS_ASSIGN_OR_RETURN(
+        TickResult result,
+        GetTickResult(start_continuation_points[lane],
+                      lanes.lane_contexts_[lane].continuation_point));
+    if (result.execution_state == TickExecutionState::kCompleted) {
+      lanes.NextTick(lane);
+    }
+    results.push_back(result);
+  }
+  return results;
+}
+
 }  // namespace xls
@@ -15,13 +15,16 @@
 #ifndef XLS_JIT_PROC_JIT_H_
 #define XLS_JIT_PROC_JIT_H_
 
+#include <cstdint>
 #include <memory>
 #include <utility>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/interpreter/proc_checkpoint.pb.h"
 #include "xls/interpreter/proc_evaluator.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/events.h"
@@ -31,6 +34,7 @@
 #include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -42,9 +46,12 @@ class ProcJitContinuation : public ProcContinuation {
   // to its initial values with no proc nodes yet executed. `temp_buffer_size`
   // specifies the size of a flat buffer used to hold temporary xls::Node values
   // during execution of the JITed function. The size of the buffer is
-  // determined at JIT compile time and known by the ProcJit.
+  // determined at JIT compile time and known by the ProcJit. The params at
+  // `in_place_params` (indices within Proc::params) share a single buffer for
+  // their current and next value (see JittedFunctionBase::in_place_params).
   explicit ProcJitContinuation(Proc* proc, int64_t temp_buffer_size,
-                               JitRuntime* jit_runtime);
+                               JitRuntime* jit_runtime,
+                               absl::Span<const int64_t> in_place_params = {});
 
   ~ProcJitContinuation() override = default;
 
@@ -55,6 +62,12 @@ class ProcJitContinuation : public ProcContinuation {
 
   bool AtStartOfTick() const override { return continuation_point_ == 0; }
 
+  // The checkpoint holds the raw native-layout buffers, so it may only be
+  // restored into a continuation of a ProcJit compiled from the same proc for
+  // the same host.
+  absl::StatusOr<ProcContinuationProto> ToProto() const override;
+  absl::Status RestoreFromProto(const ProcContinuationProto& proto) override;
+
   // Get/Set the point at which execution will resume in the proc in the next
   // call to Tick.
   int64_t GetContinuationPoint() const { return continuation_point_; }
@@ -72,6 +85,10 @@ class ProcJitContinuation : public ProcContinuation {
   // state to the "next" value computed in the previous tick.
   void NextTick();
 
+  // Overwrites the proc state with the given values. Must be called at the
+  // start of a tick.
+  absl::Status SetState(absl::Span<const Value> state);
+
   Proc* proc() const { return proc_; }
 
  private:
@@ -79,6 +96,10 @@ class ProcJitContinuation : public ProcContinuation {
   int64_t continuation_point_;
   JitRuntime* jit_runtime_;
 
+  // Native layouts of the proc parameters, owned by `jit_runtime_`. Converting
+  // state values with these requires no synchronization with the runtime.
+  std::vector<const TypeLayout*> param_layouts_;
+
   InterpreterEvents events_;
 
   // Buffers to hold inputs, outputs, and temporary storage. This is allocated
@@ -87,8 +108,87 @@ class ProcJitContinuation : public ProcContinuation {
   std::vector<std::vector<uint8_t>> output_buffers_;
 
   // Raw pointers to the buffers held in `input_buffers_` and `output_buffers_`.
+  // For params updated in place both pointers refer to the input buffer and
+  // the output buffer is empty.
+  std::vector<uint8_t*> input_ptrs_;
+  std::vector<uint8_t*> output_ptrs_;
+  std::vector<bool> in_place_;
+  std::vector<uint8_t> temp_buffer_;
+};
+
+// A group of independent instances (lanes) of a proc which are ticked together
+// with a single native call by ProcJit::TickLanes. Each lane has its own state,
+// continuation point and channel queues. The buffers of the lanes are laid out
+// structure-of-arrays: the values of each proc param for all lanes are
+// contiguous, as are the temporary buffers, so the compiled loop over lanes
+// reads and writes consecutive memory and may be vectorized by LLVM.
+//
+// The channel queues of lane `i` are those of the `i`-th queue manager passed
+// to ProcJit::NewLanes, so ticking the lanes is equivalent to ticking a
+// continuation for each lane against its own queue manager. Events of all
+// lanes are accumulated in a single InterpreterEvents.
+class ProcJitLanes {
+ public:
+  // `queue_tables` holds the queue table (see ProcJit::QueueTable) of each
+  // lane.
+  ProcJitLanes(Proc* proc,
+               std::vector<std::vector<JitChannelQueue*>> queue_tables,
+               const JittedFunctionBase& jitted_function_base,
+               JitRuntime* jit_runtime);
+
+  Proc* proc() const { return proc_; }
+  int64_t lane_count() const { return lane_count_; }
+
+  std::vector<Value> GetState(int64_t lane) const;
+
+  // Overwrites the state of `lane` with the given values. The lane must be at
+  // the start of a tick.
+  absl::Status SetState(int64_t lane, absl::Span<const Value> state);
+
+  bool AtStartOfTick(int64_t lane) const {
+    return lane_contexts_[lane].continuation_point == 0;
+  }
+
+  const InterpreterEvents& GetEvents() const { return events_; }
+  InterpreterEvents& GetEvents() { return events_; }
+  void ClearEvents() { events_.Clear(); }
+
+ private:
+  friend class ProcJit;
+
+  // Returns the buffer of `lane` within the given structure-of-arrays buffer.
+  uint8_t* LaneInput(int64_t param_index, int64_t lane) const {
+    return input_ptrs_[param_index] + lane * input_sizes_[param_index];
+  }
+
+  // Completes the tick of `lane`: moves the next state computed by the tick
+  // into the input buffers and resets the continuation point.
+  void NextTick(int64_t lane);
+
+  Proc* proc_;
+  int64_t lane_count_;
+
+  // Native layouts of the proc parameters, owned by the JitRuntime.
+  std::vector<const TypeLayout*> param_layouts_;
+
+  // The size of the value of each param (output) of a single lane.
+  std::vector<int64_t> input_sizes_;
+  std::vector<int64_t> output_sizes_;
+
+  // The queue table of each lane and the context of each lane passed to the
+  // batched function, which points into `queue_tables_`.
+  std::vector<std::vector<JitChannelQueue*>> queue_tables_;
+  std::vector<ProcLaneContext> lane_contexts_;
+  InterpreterEvents events_;
+
+  std::vector<std::vector<uint8_t>> input_buffers_;
+  std::vector<std::vector<uint8_t>> output_buffers_;
+
+  // Raw pointers to the buffers held in `input_buffers_` and `output_buffers_`.
+  // For params updated in place both pointers refer to the input buffer.
   std::vector<uint8_t*> input_ptrs_;
   std::vector<uint8_t*> output_ptrs_;
+  std::vector<bool> in_place_;
   std::vector<uint8_t> temp_buffer_;
 };
 
@@ -97,9 +197,12 @@ class ProcJitContinuation : public ProcContinuation {
 class ProcJit : public ProcEvaluator {
  public:
   // Returns an object containing a host-compiled version of the specified XLS
-  // proc.
+  // proc. If `enable_lanes` is true the proc is also compiled for ticking many
+  // lanes at once with TickLanes.
   static absl::StatusOr<std::unique_ptr<ProcJit>> Create(
-      Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr);
+      Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr,
+      const JitTargetOptions& target_options = JitTargetOptions(),
+      bool enable_lanes = false);
 
   ~ProcJit() override = default;
 
@@ -107,10 +210,30 @@ class ProcJit : public ProcEvaluator {
   absl::StatusOr<TickResult> Tick(
       ProcContinuation& continuation) const override;
 
+  // Returns a lane of the proc for each of `queue_mgrs`, each starting from the
+  // initial state and using the channel queues of its queue manager. Requires
+  // the JIT to have been created with `enable_lanes`.
+  absl::StatusOr<std::unique_ptr<ProcJitLanes>> NewLanes(
+      absl::Span<JitChannelQueueManager* const> queue_mgrs) const;
+
+  // Runs every lane until its tick completes or it blocks, in a single native
+  // call. Returns the result for each lane as Tick would.
+  absl::StatusOr<std::vector<TickResult>> TickLanes(ProcJitLanes& lanes) const;
+
   JitRuntime* runtime() const { return jit_runtime_; }
 
+  // Returns the table of the queues of `queue_mgr` read by a proc compiled with
+  // lanes enabled: the queue of each channel of the package, in the order of
+  // Package::channels().
+  static std::vector<JitChannelQueue*> QueueTable(
+      Proc* proc, JitChannelQueueManager* queue_mgr);
+
   OrcJit& GetOrcJit() { return *orc_jit_; }
 
+  const JittedFunctionBase& jitted_function_base() const {
+    return jitted_function_base_;
+  }
+
  private:
   explicit ProcJit(Proc* proc, JitRuntime* jit_runtime,
                    std::unique_ptr<OrcJit> orc_jit)
@@ -118,9 +241,18 @@ class ProcJit : public ProcEvaluator {
         jit_runtime_(jit_runtime),
         orc_jit_(std::move(orc_jit)) {}
 
+  // Returns the result of a tick which started at continuation point
+  // `start_continuation_point` and stopped at `next_continuation_point`.
+  absl::StatusOr<TickResult> GetTickResult(
+      int64_t start_continuation_point, int64_t next_continuation_point) const;
+
   JitRuntime* jit_runtime_;
   std::unique_ptr<OrcJit> orc_jit_;
   JittedFunctionBase jitted_function_base_;
+
+  // The queue table of the queue manager passed to Create, used by Tick. Only
+  // set if lanes are enabled.
+  std::vector<JitChannelQueue*> queue_table_;
 };
 
 }  // namespace xls
@@ -14,7 +14,10 @@
 
 #include "xls/jit/proc_jit.h"
 
+#include <cstdint>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -22,7 +25,12 @@
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/proc_evaluator.h"
 #include "xls/interpreter/proc_evaluator_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
 #include "xls/ir/proc.h"
+#include "xls/ir/value.h"
 #include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/orc_jit.h"
@@ -30,6 +38,8 @@
 namespace xls {
 namespace {
 
+using ::testing::ElementsAre;
+
 JitRuntime* GetJitRuntime() {
   static auto jit_runtime =
       std::make_unique<JitRuntime>(OrcJit::CreateDataLayout().value());
@@ -50,7 +60,181 @@ INSTANTIATE_TEST_SUITE_P(
         },
         [](Package* package) -> std::unique_ptr<ChannelQueueManager> {
           return JitChannelQueueManager::CreateThreadSafe(package).value();
+        },
+        [](Proc* proc, ChannelQueueManager* queue_manager)
+            -> std::unique_ptr<ProcEvaluator> {
+          JitChannelQueueManager* jit_queue_manager =
+              dynamic_cast<JitChannelQueueManager*>(queue_manager);
+          XLS_CHECK(jit_queue_manager != nullptr);
+          return ProcJit::Create(proc, GetJitRuntime(), jit_queue_manager,
+                                 JitTargetOptions{.activity_profile = true})
+              .value();
         })));
 
+class ProcJitInPlaceTest : public IrTestBase {
+ protected:
+  // Builds a proc with an index state element and a memory state element. Each
+  // tick writes the received value to the memory at the index and increments
+  // the index. If `send_read` is true the proc also sends the old memory
+  // element at the index which prevents updating the memory in place.
+  absl::StatusOr<Proc*> BuildMemoryProc(Package* package, bool send_read) {
+    XLS_ASSIGN_OR_RETURN(
+        Channel * in, package->CreateStreamingChannel(
+                          "in", ChannelOps::kReceiveOnly,
+                          package->GetBitsType(32)));
+    XLS_ASSIGN_OR_RETURN(
+        Channel * out, package->CreateStreamingChannel(
+                           "out", ChannelOps::kSendOnly,
+                           package->GetBitsType(32)));
+    ProcBuilder pb("memory", /*token_name=*/"tok", package);
+    BValue index = pb.StateElement("index", Value(UBits(0, 2)));
+    BValue memory = pb.StateElement("memory", ZeroMemory());
+    BValue receive = pb.Receive(in, pb.GetTokenParam());
+    BValue token = pb.TupleIndex(receive, 0);
+    if (send_read) {
+      token = pb.Send(out, token, pb.ArrayIndex(memory, {index}));
+    }
+    return pb.Build(token, {pb.Add(index, pb.Literal(UBits(1, 2))),
+                            pb.ArrayUpdate(memory, pb.TupleIndex(receive, 1),
+                                           {index})});
+  }
+
+  static Value ZeroMemory() {
+    return Value::UBitsArray({0, 0, 0, 0}, 32).value();
+  }
+};
+
+TEST_F(ProcJitInPlaceTest, MemoryUpdatedInPlace) {
+  for (bool send_read : {false, true}) {
+    auto package = CreatePackage();
+    XLS_ASSERT_OK_AND_ASSIGN(Proc * proc,
+                             BuildMemoryProc(package.get(), send_read));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<JitChannelQueueManager> queue_manager,
+        JitChannelQueueManager::CreateThreadSafe(package.get()));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<ProcJit> jit,
+        ProcJit::Create(proc, GetJitRuntime(), queue_manager.get()));
+    std::unique_ptr<ProcContinuation> continuation = jit->NewContinuation();
+    ProcJitContinuation* jit_continuation =
+        dynamic_cast<ProcJitContinuation*>(continuation.get());
+    ASSERT_NE(jit_continuation, nullptr);
+    // Param 2 is the memory; it shares its input and output buffers only when
+    // the update is the sole reader of the old memory.
+    EXPECT_EQ(jit_continuation->GetInputBuffers()[2] ==
+                  jit_continuation->GetOutputBuffers()[2],
+              !send_read);
+
+    ChannelQueue& in_queue =
+        queue_manager->GetQueue(package->GetChannel("in").value());
+    for (int64_t i = 0; i < 6; ++i) {
+      XLS_ASSERT_OK(in_queue.Write(Value(UBits(10 + i, 32))));
+    }
+    for (int64_t i = 0; i < 6; ++i) {
+      XLS_ASSERT_OK_AND_ASSIGN(TickResult result, jit->Tick(*continuation));
+      if (result.execution_state == TickExecutionState::kSentOnChannel) {
+        XLS_ASSERT_OK_AND_ASSIGN(result, jit->Tick(*continuation));
+      }
+      EXPECT_EQ(result.execution_state, TickExecutionState::kCompleted);
+    }
+    EXPECT_THAT(continuation->GetState(),
+                ElementsAre(Value(UBits(2, 2)),
+                            Value::UBitsArray({14, 15, 12, 13}, 32).value()));
+
+    // Overwriting the state resets the memory.
+    XLS_ASSERT_OK(jit_continuation->SetState({Value(UBits(0, 2)),
+                                               ZeroMemory()}));
+    EXPECT_THAT(continuation->GetState(),
+                ElementsAre(Value(UBits(0, 2)), ZeroMemory()));
+  }
+}
+
+TEST_F(ProcJitInPlaceTest, TickLanes) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc,
+                           BuildMemoryProc(package.get(), /*send_read=*/false));
+  Channel* in_channel = package->GetChannel("in").value();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> queue_manager,
+      JitChannelQueueManager::CreateThreadSafe(package.get()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ProcJit> single_jit,
+      ProcJit::Create(proc, GetJitRuntime(), queue_manager.get()));
+  EXPECT_FALSE(single_jit->NewLanes({queue_manager.get()}).ok());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ProcJit> jit,
+      ProcJit::Create(proc, GetJitRuntime(), queue_manager.get(),
+                      JitTargetOptions(), /*enable_lanes=*/true));
+
+  // Each lane has its own channel queues.
+  std::vector<std::unique_ptr<JitChannelQueueManager>> lane_queue_managers;
+  std::vector<JitChannelQueueManager*> lane_queue_manager_ptrs;
+  for (int64_t lane = 0; lane < 3; ++lane) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<JitChannelQueueManager> lane_queue_manager,
+        JitChannelQueueManager::CreateThreadSafe(package.get()));
+    lane_queue_manager_ptrs.push_back(lane_queue_manager.get());
+    lane_queue_managers.push_back(std::move(lane_queue_manager));
+  }
+  auto lane_in_queue = [&](int64_t lane) -> ChannelQueue& {
+    return lane_queue_managers[lane]->GetQueue(in_channel);
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ProcJitLanes> lanes,
+                           jit->NewLanes(lane_queue_manager_ptrs));
+  ASSERT_EQ(lanes->lane_count(), 3);
+  XLS_ASSERT_OK(lanes->SetState(
+      1, {Value(UBits(3, 2)), Value::UBitsArray({1, 2, 3, 4}, 32).value()}));
+
+  // The last lane has nothing to receive on its own queue so it blocks.
+  XLS_ASSERT_OK(lane_in_queue(0).Write(Value(UBits(10, 32))));
+  XLS_ASSERT_OK(lane_in_queue(1).Write(Value(UBits(11, 32))));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<TickResult> results,
+                           jit->TickLanes(*lanes));
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_EQ(results[0].execution_state, TickExecutionState::kCompleted);
+  EXPECT_EQ(results[1].execution_state, TickExecutionState::kCompleted);
+  EXPECT_EQ(results[2].execution_state, TickExecutionState::kBlockedOnReceive);
+  EXPECT_FALSE(lanes->AtStartOfTick(2));
+  EXPECT_THAT(lanes->GetState(0),
+              ElementsAre(Value(UBits(1, 2)),
+                          Value::UBitsArray({10, 0, 0, 0}, 32).value()));
+  EXPECT_THAT(lanes->GetState(1),
+              ElementsAre(Value(UBits(0, 2)),
+                          Value::UBitsArray({1, 2, 3, 11}, 32).value()));
+  EXPECT_THAT(lanes->GetState(2),
+              ElementsAre(Value(UBits(0, 2)), ZeroMemory()));
+
+  // The blocked lane resumes where it stopped; the others start a new tick.
+  for (int64_t lane = 0; lane < 3; ++lane) {
+    XLS_ASSERT_OK(lane_in_queue(lane).Write(Value(UBits(12 + lane, 32))));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(results, jit->TickLanes(*lanes));
+  for (const TickResult& result : results) {
+    EXPECT_EQ(result.execution_state, TickExecutionState::kCompleted);
+  }
+  EXPECT_THAT(lanes->GetState(0),
+              ElementsAre(Value(UBits(2, 2)),
+                          Value::UBitsArray({10, 12, 0, 0}, 32).value()));
+  EXPECT_THAT(lanes->GetState(1),
+              ElementsAre(Value(UBits(1, 2)),
+                          Value::UBitsArray({13, 2, 3, 11}, 32).value()));
+  EXPECT_THAT(lanes->GetState(2),
+              ElementsAre(Value(UBits(1, 2)),
+                          Value::UBitsArray({14, 0, 0, 0}, 32).value()));
+  EXPECT_TRUE(queue_manager->GetQueue(in_channel).IsEmpty());
+
+  // A single continuation of the same JIT uses the queues passed to Create.
+  std::unique_ptr<ProcContinuation> continuation = jit->NewContinuation();
+  XLS_ASSERT_OK(
+      queue_manager->GetQueue(in_channel).Write(Value(UBits(20, 32))));
+  XLS_ASSERT_OK_AND_ASSIGN(TickResult result, jit->Tick(*continuation));
+  EXPECT_EQ(result.execution_state, TickExecutionState::kCompleted);
+  EXPECT_THAT(continuation->GetState(),
+              ElementsAre(Value(UBits(1, 2)),
+                          Value::UBitsArray({20, 0, 0, 0}, 32).value()));
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,115 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/tiered_evaluator.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/casts.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/proc_jit.h"
+
+namespace xls {
+
+TieredFunctionEvaluator::TieredFunctionEvaluator(Function* function,
+                                                 int64_t opt_level)
+    : function_(function), compilation_([function, opt_level]() {
+        return FunctionJit::Create(function, opt_level);
+      }) {}
+
+absl::StatusOr<std::unique_ptr<TieredFunctionEvaluator>>
+TieredFunctionEvaluator::Create(Function* function, int64_t opt_level) {
+  return absl::WrapUnique(new TieredFunctionEvaluator(function, opt_level));
+}
+
+absl::StatusOr<InterpreterResult<Value>> TieredFunctionEvaluator::Run(
+    absl::Span<const Value> args) {
+  if (FunctionJit* jit = compilation_.GetIfReady()) {
+    return jit->Run(args);
+  }
+  return InterpretFunction(function_, args);
+}
+
+absl::Status TieredProcContinuation::SwitchToJit(
+    std::unique_ptr<ProcJitContinuation> jit_continuation) {
+  XLS_RET_CHECK(!IsJitted());
+  XLS_RET_CHECK(interpreter_continuation_->AtStartOfTick());
+  XLS_RETURN_IF_ERROR(
+      jit_continuation->SetState(interpreter_continuation_->GetState()));
+  // Carry over events which have not yet been consumed.
+  jit_continuation->GetEvents() =
+      std::move(interpreter_continuation_->GetEvents());
+  jit_continuation_ = std::move(jit_continuation);
+  interpreter_continuation_.reset();
+  return absl::OkStatus();
+}
+
+TieredProcEvaluator::TieredProcEvaluator(Proc* proc,
+                                         JitChannelQueueManager* queue_mgr)
+    : ProcEvaluator(proc),
+      interpreter_(proc, queue_mgr),
+      compilation_([proc, queue_mgr]() {
+        return ProcJit::Create(proc, &queue_mgr->runtime(), queue_mgr);
+      }) {}
+
+absl::StatusOr<std::unique_ptr<TieredProcEvaluator>>
+TieredProcEvaluator::Create(Proc* proc, JitChannelQueueManager* queue_mgr) {
+  return absl::WrapUnique(new TieredProcEvaluator(proc, queue_mgr));
+}
+
+std::unique_ptr<ProcContinuation> TieredProcEvaluator::NewContinuation()
+    const {
+  return std::make_unique<TieredProcContinuation>(
+      interpreter_.NewContinuation());
+}
+
+absl::StatusOr<TickResult> TieredProcEvaluator::Tick(
+    ProcContinuation& continuation) const {
+  TieredProcContinuation* cont =
+      dynamic_cast<TieredProcContinuation*>(&continuation);
+  XLS_RET_CHECK_NE(cont, nullptr)
+      << "TieredProcEvaluator requires a continuation of type "
+         "TieredProcContinuation";
+
+  // Execution can only move to the JIT between ticks because the interpreter
+  // and the JIT represent a partially executed tick differently.
+  if (!cont->IsJitted() && cont->AtStartOfTick()) {
+    if (ProcJit* jit = compilation_.GetIfReady()) {
+      std::unique_ptr<ProcContinuation> jit_continuation =
+          jit->NewContinuation();
+      XLS_RETURN_IF_ERROR(cont->SwitchToJit(absl::WrapUnique(
+          down_cast<ProcJitContinuation*>(jit_continuation.release()))));
+    }
+  }
+
+  if (cont->IsJitted()) {
+    return compilation_.GetIfReady()->Tick(cont->active());
+  }
+  return interpreter_.Tick(cont->active());
+}
+
+}  // namespace xls
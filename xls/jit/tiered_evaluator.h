@@ -0,0 +1,203 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_TIERED_EVALUATOR_H_
+#define XLS_JIT_TIERED_EVALUATOR_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/proc_checkpoint.pb.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_interpreter.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/proc_jit.h"
+
+namespace xls {
+namespace internal {
+
+// Runs a JIT factory on a background thread and publishes the result. The
+// destructor blocks until the compilation finishes as LLVM compilation cannot
+// be interrupted.
+template <typename JitT>
+class BackgroundCompilation {
+ public:
+  using CompileFn = std::function<absl::StatusOr<std::unique_ptr<JitT>>()>;
+
+  explicit BackgroundCompilation(CompileFn compile) {
+    thread_ = std::make_unique<Thread>(
+        [this, compile = std::move(compile)]() { Publish(compile()); });
+  }
+
+  // Returns the compiled object if compilation has completed successfully,
+  // nullptr otherwise. Never blocks.
+  JitT* GetIfReady() const { return ready_.load(std::memory_order_acquire); }
+
+  // Blocks until compilation completes and returns its status.
+  absl::Status Wait() const {
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(&done_));
+    return status_;
+  }
+
+ private:
+  void Publish(absl::StatusOr<std::unique_ptr<JitT>> result) {
+    absl::MutexLock lock(&mutex_);
+    if (result.ok()) {
+      jit_ = std::move(result).value();
+      ready_.store(jit_.get(), std::memory_order_release);
+    } else {
+      XLS_LOG(WARNING) << "Background JIT compilation failed, evaluation "
+                          "continues in the interpreter: "
+                       << result.status();
+      status_ = result.status();
+    }
+    done_ = true;
+  }
+
+  mutable absl::Mutex mutex_;
+  std::unique_ptr<JitT> jit_ ABSL_GUARDED_BY(mutex_);
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+  bool done_ ABSL_GUARDED_BY(mutex_) = false;
+  std::atomic<JitT*> ready_ = nullptr;
+
+  // Declared last so the thread is joined before the other members are
+  // destroyed.
+  std::unique_ptr<Thread> thread_;
+};
+
+}  // namespace internal
+
+// Evaluates an XLS function with the IR interpreter while a FunctionJit for it
+// is compiled on a background thread. Once compilation finishes, subsequent
+// calls to Run execute native code. This avoids paying LLVM compilation latency
+// up front when the number of invocations is small while still running long
+// evaluations natively. Like FunctionJit, Run is not thread-safe.
+class TieredFunctionEvaluator {
+ public:
+  static absl::StatusOr<std::unique_ptr<TieredFunctionEvaluator>> Create(
+      Function* function, int64_t opt_level = 3);
+
+  // Evaluates the function with the given arguments using the fastest tier
+  // currently available.
+  absl::StatusOr<InterpreterResult<Value>> Run(absl::Span<const Value> args);
+
+  // Returns true if Run executes jitted code.
+  bool IsJitReady() const { return compilation_.GetIfReady() != nullptr; }
+
+  // Blocks until background compilation finishes and returns its status.
+  absl::Status WaitForJit() const { return compilation_.Wait(); }
+
+  Function* function() const { return function_; }
+
+ private:
+  TieredFunctionEvaluator(Function* function, int64_t opt_level);
+
+  Function* function_;
+  internal::BackgroundCompilation<FunctionJit> compilation_;
+};
+
+// A continuation used by the TieredProcEvaluator. Wraps a
+// ProcInterpreterContinuation until the proc switches to jitted code at which
+// point the state and pending events are moved into a ProcJitContinuation.
+class TieredProcContinuation : public ProcContinuation {
+ public:
+  explicit TieredProcContinuation(
+      std::unique_ptr<ProcContinuation> interpreter_continuation)
+      : interpreter_continuation_(std::move(interpreter_continuation)) {}
+
+  ~TieredProcContinuation() override = default;
+
+  std::vector<Value> GetState() const override { return active().GetState(); }
+  const InterpreterEvents& GetEvents() const override {
+    return active().GetEvents();
+  }
+  InterpreterEvents& GetEvents() override { return active().GetEvents(); }
+  void ClearEvents() override { active().ClearEvents(); }
+  bool AtStartOfTick() const override { return active().AtStartOfTick(); }
+
+  // Checkpoints are those of the active continuation, so a checkpoint taken
+  // before the switch to the JIT can only be restored before the switch.
+  absl::StatusOr<ProcContinuationProto> ToProto() const override {
+    return active().ToProto();
+  }
+  absl::Status RestoreFromProto(const ProcContinuationProto& proto) override {
+    return active().RestoreFromProto(proto);
+  }
+
+  // Returns true if execution has been handed off to the JIT.
+  bool IsJitted() const { return jit_continuation_ != nullptr; }
+
+  // Hands execution off to the given JIT continuation. Must be called at the
+  // start of a tick.
+  absl::Status SwitchToJit(
+      std::unique_ptr<ProcJitContinuation> jit_continuation);
+
+  ProcContinuation& active() {
+    return IsJitted() ? *jit_continuation_ : *interpreter_continuation_;
+  }
+  const ProcContinuation& active() const {
+    return IsJitted() ? *jit_continuation_ : *interpreter_continuation_;
+  }
+
+ private:
+  std::unique_ptr<ProcContinuation> interpreter_continuation_;
+  std::unique_ptr<ProcJitContinuation> jit_continuation_;
+};
+
+// A proc evaluator which starts ticking the proc in the ProcInterpreter and
+// compiles a ProcJit on a background thread. Each continuation switches to the
+// JIT at the first tick boundary after compilation finishes.
+class TieredProcEvaluator : public ProcEvaluator {
+ public:
+  static absl::StatusOr<std::unique_ptr<TieredProcEvaluator>> Create(
+      Proc* proc, JitChannelQueueManager* queue_mgr);
+
+  ~TieredProcEvaluator() override = default;
+
+  std::unique_ptr<ProcContinuation> NewContinuation() const override;
+  absl::StatusOr<TickResult> Tick(
+      ProcContinuation& continuation) const override;
+
+  // Returns true if the ProcJit has been compiled.
+  bool IsJitReady() const { return compilation_.GetIfReady() != nullptr; }
+
+  // Blocks until background compilation finishes and returns its status.
+  absl::Status WaitForJit() const { return compilation_.Wait(); }
+
+ private:
+  TieredProcEvaluator(Proc* proc, JitChannelQueueManager* queue_mgr);
+
+  ProcInterpreter interpreter_;
+  internal::BackgroundCompilation<ProcJit> compilation_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_TIERED_EVALUATOR_H_
@@ -0,0 +1,173 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/tiered_evaluator.h"
+
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_evaluator_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_channel_queue.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::ElementsAre;
+using ::testing::Optional;
+
+std::unique_ptr<ProcEvaluator> CreateTieredProcEvaluator(
+    Proc* proc, ChannelQueueManager* queue_manager, bool wait_for_jit) {
+  JitChannelQueueManager* jit_queue_manager =
+      dynamic_cast<JitChannelQueueManager*>(queue_manager);
+  XLS_CHECK(jit_queue_manager != nullptr);
+  std::unique_ptr<TieredProcEvaluator> evaluator =
+      TieredProcEvaluator::Create(proc, jit_queue_manager).value();
+  if (wait_for_jit) {
+    XLS_CHECK_OK(evaluator->WaitForJit());
+  }
+  return evaluator;
+}
+
+// Instantiate and run all the tests in proc_evaluator_test_base.cc. The first
+// variant may switch tiers at any tick boundary during the test, the second
+// runs entirely in the JIT.
+INSTANTIATE_TEST_SUITE_P(
+    TieredProcEvaluatorTest, ProcEvaluatorTestBase,
+    testing::Values(
+        ProcEvaluatorTestParam(
+            [](Proc* proc, ChannelQueueManager* queue_manager)
+                -> std::unique_ptr<ProcEvaluator> {
+              return CreateTieredProcEvaluator(proc, queue_manager,
+                                               /*wait_for_jit=*/false);
+            },
+            [](Package* package) -> std::unique_ptr<ChannelQueueManager> {
+              return JitChannelQueueManager::CreateThreadSafe(package).value();
+            }),
+        ProcEvaluatorTestParam(
+            [](Proc* proc, ChannelQueueManager* queue_manager)
+                -> std::unique_ptr<ProcEvaluator> {
+              return CreateTieredProcEvaluator(proc, queue_manager,
+                                               /*wait_for_jit=*/true);
+            },
+            [](Package* package) -> std::unique_ptr<ChannelQueueManager> {
+              return JitChannelQueueManager::CreateThreadSafe(package).value();
+            })));
+
+class TieredEvaluatorTest : public IrTestBase {};
+
+TEST_F(TieredEvaluatorTest, FunctionSwitchesToJit) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Add(fb.Param("x", p->GetBitsType(32)), fb.Param("y", p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TieredFunctionEvaluator> evaluator,
+                           TieredFunctionEvaluator::Create(f));
+  // Results are the same whichever tier is in use.
+  for (int64_t i = 0; i < 10; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        InterpreterResult<Value> result,
+        evaluator->Run(std::vector<Value>{Value(UBits(i, 32)),
+                                          Value(UBits(100, 32))}));
+    EXPECT_EQ(result.value, Value(UBits(100 + i, 32)));
+  }
+
+  XLS_ASSERT_OK(evaluator->WaitForJit());
+  EXPECT_TRUE(evaluator->IsJitReady());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpreterResult<Value> result,
+      evaluator->Run(
+          std::vector<Value>{Value(UBits(3, 32)), Value(UBits(4, 32))}));
+  EXPECT_EQ(result.value, Value(UBits(7, 32)));
+}
+
+TEST_F(TieredEvaluatorTest, ProcStateCarriesOverToJit) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      p->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                p->GetBitsType(32)));
+  ProcBuilder pb(TestName(), /*token_name=*/"tok", p.get());
+  BValue counter = pb.StateElement("cnt", Value(UBits(10, 32)));
+  BValue send_token = pb.Send(channel, pb.GetTokenParam(), counter);
+  BValue trace_token =
+      pb.Trace(send_token, pb.Literal(UBits(1, 1)), {counter}, "cnt: {}");
+  BValue next = pb.Add(counter, pb.Literal(UBits(1, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build(trace_token, {next}));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitChannelQueueManager> queue_mgr,
+                           JitChannelQueueManager::CreateThreadSafe(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<TieredProcEvaluator> evaluator,
+      TieredProcEvaluator::Create(proc, queue_mgr.get()));
+  std::unique_ptr<ProcContinuation> continuation = evaluator->NewContinuation();
+  TieredProcContinuation* tiered_continuation =
+      dynamic_cast<TieredProcContinuation*>(continuation.get());
+  ASSERT_NE(tiered_continuation, nullptr);
+
+  // Tick once and stop in the middle of the second tick (after the send).
+  // Whichever tier executes these ticks, the JIT must only take over at the
+  // next tick boundary.
+  auto tick_until_complete = [&]() -> absl::Status {
+    while (true) {
+      XLS_ASSIGN_OR_RETURN(TickResult result, evaluator->Tick(*continuation));
+      if (result.execution_state == TickExecutionState::kCompleted) {
+        return absl::OkStatus();
+      }
+    }
+  };
+  XLS_ASSERT_OK(tick_until_complete());
+  EXPECT_THAT(evaluator->Tick(*continuation),
+              IsOkAndHolds(TickResult{
+                  .execution_state = TickExecutionState::kSentOnChannel,
+                  .channel = channel,
+                  .progress_made = true}));
+  bool jitted_mid_tick = tiered_continuation->IsJitted();
+
+  XLS_ASSERT_OK(evaluator->WaitForJit());
+  EXPECT_EQ(tiered_continuation->IsJitted(), jitted_mid_tick);
+  XLS_ASSERT_OK(tick_until_complete());
+  EXPECT_THAT(continuation->GetState(), ElementsAre(Value(UBits(12, 32))));
+
+  // The next tick starts at a tick boundary so it runs in the JIT.
+  XLS_ASSERT_OK(tick_until_complete());
+  EXPECT_TRUE(tiered_continuation->IsJitted());
+  EXPECT_THAT(continuation->GetState(), ElementsAre(Value(UBits(13, 32))));
+
+  // Trace messages recorded by either tier are retained.
+  EXPECT_THAT(continuation->GetEvents().trace_msgs,
+              ElementsAre("cnt: 10", "cnt: 11", "cnt: 12"));
+
+  ChannelQueue& queue = queue_mgr->GetQueue(channel);
+  EXPECT_THAT(queue.Read(), Optional(Value(UBits(10, 32))));
+  EXPECT_THAT(queue.Read(), Optional(Value(UBits(11, 32))));
+  EXPECT_THAT(queue.Read(), Optional(Value(UBits(12, 32))));
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+}  // namespace
+}  // namespace xls
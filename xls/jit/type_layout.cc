@@ -14,12 +14,16 @@
 
 #include "xls/jit/type_layout.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
+#include <iterator>
 #include <ostream>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "xls/ir/bits.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/value_helpers.h"
 
@@ -29,21 +33,26 @@ static bool IsLeafValue(const Value& value) {
   return value.IsBits() || value.IsToken();
 }
 
+static void LeafBitsToNativeLayout(const Bits& bits,
+                                   const ElementLayout& element_layout,
+                                   uint8_t* buffer) {
+  uint8_t* element_buffer = buffer + element_layout.offset;
+  // Write the bytes from the Bits object into the buffer.
+  bits.ToBytes(absl::MakeSpan(element_buffer, element_layout.data_size));
+  // Clear any padding bytes.
+  std::memset(element_buffer + element_layout.data_size, 0,
+              element_layout.padded_size - element_layout.data_size);
+}
+
 static void LeafValueToNativeLayout(const Value& value,
                                     const ElementLayout& element_layout,
                                     uint8_t* buffer) {
-  uint8_t* element_buffer = buffer + element_layout.offset;
   if (value.IsBits()) {
-    // Write the bytes from the Bits object into the buffer.
-    value.bits().ToBytes(
-        absl::MakeSpan(element_buffer, element_layout.data_size));
-    // Clear any padding bytes.
-    std::memset(element_buffer + element_layout.data_size, 0,
-                element_layout.padded_size - element_layout.data_size);
+    LeafBitsToNativeLayout(value.bits(), element_layout, buffer);
     return;
   }
   XLS_CHECK(value.IsToken());
-  std::memset(buffer, 0, element_layout.padded_size);
+  std::memset(buffer + element_layout.offset, 0, element_layout.padded_size);
 }
 
 void TypeLayout::ValueToNativeLayout(const Value& value,
@@ -82,9 +91,17 @@ void TypeLayout::ValueToNativeLayout(const Value& value,
       stack.pop_back();
       continue;
     }
+    if (frame.value->IsPackedArray()) {
+      // Write the elements of packed arrays without unpacking them.
+      for (; frame.index < frame.limit; ++frame.index, ++leaf_index) {
+        LeafBitsToNativeLayout(frame.value->GetPackedElement(frame.index),
+                               elements_[leaf_index], buffer);
+      }
+      continue;
+    }
     const Value& value_element = frame.value->element(frame.index);
     if (IsLeafValue(value_element)) {
-      LeafValueToNativeLayout(value_element, elements_.at(leaf_index), buffer);
+      LeafValueToNativeLayout(value_element, elements_[leaf_index], buffer);
       ++frame.index;
       ++leaf_index;
     } else {
@@ -95,40 +112,74 @@ void TypeLayout::ValueToNativeLayout(const Value& value,
   XLS_CHECK_EQ(leaf_index, elements_.size());
 }
 
-Value TypeLayout::NativeLayoutToValueInternal(Type* element_type,
-                                              const uint8_t* buffer,
-                                              int64_t* leaf_index) const {
-  if (element_type->IsBits()) {
-    int64_t bit_count = element_type->AsBitsOrDie()->bit_count();
-    const ElementLayout& element_layout = elements_.at(*leaf_index);
-    ++(*leaf_index);
-    return Value(
-        Bits::FromBytes(absl::MakeSpan(buffer + element_layout.offset,
-                                       CeilOfRatio(bit_count, int64_t{8})),
-                        bit_count));
+void TypeLayout::BuildConversionOps() {
+  int64_t leaf_index = 0;
+  AppendConversionOps(type_, &leaf_index, /*depth=*/0);
+  XLS_CHECK_EQ(leaf_index, elements_.size());
+  int64_t covered_size = 0;
+  for (const ElementLayout& element : elements_) {
+    covered_size += element.padded_size;
   }
-  if (element_type->IsToken()) {
-    ++(*leaf_index);
-    return Value::Token();
+  dense_ = covered_size == size_;
+}
+
+void TypeLayout::AppendConversionOps(Type* type, int64_t* leaf_index,
+                                     int64_t depth) {
+  max_stack_depth_ = std::max(max_stack_depth_, depth + 1);
+  if (type->IsBits()) {
+    ops_.push_back(ConversionOp{.kind = ConversionOp::Kind::kBits,
+                                .count = 1,
+                                .leaf_index = (*leaf_index)++,
+                                .bit_count = type->AsBitsOrDie()->bit_count()});
+    return;
   }
-  if (element_type->IsTuple()) {
-    TupleType* tuple_type = element_type->AsTupleOrDie();
-    std::vector<Value> elements;
+  if (type->IsToken()) {
+    ops_.push_back(ConversionOp{.kind = ConversionOp::Kind::kToken,
+                                .count = 1,
+                                .leaf_index = (*leaf_index)++,
+                                .bit_count = 0});
+    return;
+  }
+  if (type->IsArray() && type->AsArrayOrDie()->element_type()->IsBits() &&
+      type->AsArrayOrDie()->size() > 0) {
+    ArrayType* array_type = type->AsArrayOrDie();
+    ops_.push_back(ConversionOp{
+        .kind = ConversionOp::Kind::kBitsArray,
+        .count = array_type->size(),
+        .leaf_index = *leaf_index,
+        .bit_count = array_type->element_type()->AsBitsOrDie()->bit_count()});
+    *leaf_index += array_type->size();
+    return;
+  }
+  if (type->IsTuple()) {
+    TupleType* tuple_type = type->AsTupleOrDie();
     for (int64_t i = 0; i < tuple_type->size(); ++i) {
-      elements.push_back(NativeLayoutToValueInternal(
-          tuple_type->element_type(i), buffer, leaf_index));
+      AppendConversionOps(tuple_type->element_type(i), leaf_index, depth + i);
     }
-    return Value::TupleOwned(std::move(elements));
+    ops_.push_back(ConversionOp{.kind = ConversionOp::Kind::kTuple,
+                                .count = tuple_type->size(),
+                                .leaf_index = 0,
+                                .bit_count = 0});
+    return;
   }
-
-  XLS_CHECK(element_type->IsArray());
-  ArrayType* array_type = element_type->AsArrayOrDie();
-  std::vector<Value> elements;
+  XLS_CHECK(type->IsArray());
+  ArrayType* array_type = type->AsArrayOrDie();
   for (int64_t i = 0; i < array_type->size(); ++i) {
-    elements.push_back(NativeLayoutToValueInternal(array_type->element_type(),
-                                                   buffer, leaf_index));
+    AppendConversionOps(array_type->element_type(), leaf_index, depth + i);
   }
-  return Value::ArrayOwned(std::move(elements));
+  ops_.push_back(ConversionOp{.kind = ConversionOp::Kind::kArray,
+                              .count = array_type->size(),
+                              .leaf_index = 0,
+                              .bit_count = 0});
+}
+
+static Value LeafNativeLayoutToValue(const uint8_t* buffer,
+                                     const ElementLayout& element_layout,
+                                     int64_t bit_count) {
+  return Value(
+      Bits::FromBytes(absl::MakeSpan(buffer + element_layout.offset,
+                                     CeilOfRatio(bit_count, int64_t{8})),
+                      bit_count));
 }
 
 Value TypeLayout::NativeLayoutToValue(const uint8_t* buffer) const {
@@ -137,8 +188,42 @@ Value TypeLayout::NativeLayoutToValue(const uint8_t* buffer) const {
   // sanitizers.
   __msan_unpoison(buffer, size());
 #endif  // ABSL_HAVE_MEMORY_SANITIZER
-  int64_t leaf_index = 0;
-  return NativeLayoutToValueInternal(type_, buffer, &leaf_index);
+  std::vector<Value> stack;
+  stack.reserve(max_stack_depth_);
+  for (const ConversionOp& op : ops_) {
+    switch (op.kind) {
+      case ConversionOp::Kind::kBits:
+        stack.push_back(LeafNativeLayoutToValue(
+            buffer, elements_[op.leaf_index], op.bit_count));
+        break;
+      case ConversionOp::Kind::kBitsArray: {
+        std::vector<Value> elements;
+        elements.reserve(op.count);
+        for (int64_t i = 0; i < op.count; ++i) {
+          elements.push_back(LeafNativeLayoutToValue(
+              buffer, elements_[op.leaf_index + i], op.bit_count));
+        }
+        stack.push_back(Value::ArrayOwned(std::move(elements)));
+        break;
+      }
+      case ConversionOp::Kind::kToken:
+        stack.push_back(Value::Token());
+        break;
+      case ConversionOp::Kind::kTuple:
+      case ConversionOp::Kind::kArray: {
+        auto first = stack.end() - op.count;
+        std::vector<Value> elements(std::make_move_iterator(first),
+                                    std::make_move_iterator(stack.end()));
+        stack.erase(first, stack.end());
+        stack.push_back(op.kind == ConversionOp::Kind::kTuple
+                            ? Value::TupleOwned(std::move(elements))
+                            : Value::ArrayOwned(std::move(elements)));
+        break;
+      }
+    }
+  }
+  XLS_DCHECK_EQ(stack.size(), 1);
+  return std::move(stack.back());
 }
 
 std::string TypeLayout::ToString() const {
@@ -89,6 +89,7 @@ class TypeLayout {
                       absl::Span<const ElementLayout> elements)
       : type_(type), size_(size), elements_(elements.begin(), elements.end()) {
     XLS_CHECK_EQ(elements.size(), type->leaf_count());
+    BuildConversionOps();
   }
 
   // Converts TypeLayout objects to/from TypeLayoutProtos.
@@ -104,6 +105,10 @@ class TypeLayout {
   // `buffer`.
   Value NativeLayoutToValue(const uint8_t* buffer) const;
 
+  // Returns true if the leaf elements and their padding cover every byte of the
+  // layout, in which case ValueToNativeLayout writes the entire buffer.
+  bool IsDense() const { return dense_; }
+
   absl::Span<const ElementLayout> elements() const { return elements_; }
 
   // Returns the number of bytes an instances of the type occupies.
@@ -114,12 +119,41 @@ class TypeLayout {
   std::string ToString() const;
 
  private:
-  Value NativeLayoutToValueInternal(Type* element_type, const uint8_t* buffer,
-                                    int64_t* leaf_index) const;
+  // A step of the conversion of a native layout to a Value. The steps are the
+  // type tree in post-order, so a Value is built by a single pass over the
+  // steps with a stack of constructed elements rather than by walking the type
+  // for every conversion.
+  struct ConversionOp {
+    enum class Kind : int8_t {
+      // Pushes the bits leaf `leaf_index`.
+      kBits,
+      // Pushes an array of the `count` bits leaves starting at `leaf_index`.
+      kBitsArray,
+      // Pushes a token.
+      kToken,
+      // Replaces the top `count` elements of the stack with a tuple or array
+      // of them.
+      kTuple,
+      kArray,
+    };
+    Kind kind;
+    int64_t count;
+    int64_t leaf_index;
+    int64_t bit_count;
+  };
+
+  // Computes `ops_`, `max_stack_depth_` and `dense_` from the type and
+  // elements.
+  void BuildConversionOps();
+  void AppendConversionOps(Type* type, int64_t* leaf_index, int64_t depth);
 
   Type* type_;
   int64_t size_;
   std::vector<ElementLayout> elements_;
+
+  std::vector<ConversionOp> ops_;
+  int64_t max_stack_depth_ = 0;
+  bool dense_ = false;
 };
 
 std::ostream& operator<<(std::ostream& os, ElementLayout layout);
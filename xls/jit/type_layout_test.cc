@@ -292,6 +292,40 @@ TEST_F(TypeLayoutTest, SimpleArray) {
           ElementLayout{.offset = 4, .data_size = 2, .padded_size = 2}));
 }
 
+TEST_F(TypeLayoutTest, ConverterCachesByStructure) {
+  std::unique_ptr<OrcJit> orc_jit = OrcJit::Create().value();
+  LlvmTypeConverter type_converter(orc_jit->GetContext(),
+                                   orc_jit->CreateDataLayout().value());
+  auto package_a = CreatePackage();
+  Type* type_a = package_a->GetTupleType(
+      {package_a->GetBitsType(3), package_a->GetArrayType(
+                                      2, package_a->GetBitsType(17))});
+  TypeLayout layout_a = type_converter.CreateTypeLayout(type_a);
+  llvm::Type* llvm_type_a = type_converter.ConvertToLlvmType(type_a);
+  package_a.reset();
+
+  // A structurally equal type from another package shares the cached
+  // conversions, but the layout refers to the type it was created for.
+  auto package_b = CreatePackage();
+  Type* type_b = package_b->GetTupleType(
+      {package_b->GetBitsType(3), package_b->GetArrayType(
+                                      2, package_b->GetBitsType(17))});
+  EXPECT_EQ(type_converter.ConvertToLlvmType(type_b), llvm_type_a);
+  TypeLayout layout_b = type_converter.CreateTypeLayout(type_b);
+  EXPECT_EQ(layout_b.type(), type_b);
+  EXPECT_EQ(layout_b.size(), layout_a.size());
+  EXPECT_THAT(layout_b.elements(), ElementsAre(layout_a.elements()[0],
+                                               layout_a.elements()[1],
+                                               layout_a.elements()[2]));
+
+  // A structurally different type is not confused with a cached one.
+  Type* other = package_b->GetTupleType(
+      {package_b->GetBitsType(3), package_b->GetArrayType(
+                                      2, package_b->GetBitsType(8))});
+  EXPECT_NE(type_converter.ConvertToLlvmType(other), llvm_type_a);
+  EXPECT_EQ(type_converter.CreateTypeLayout(other).type(), other);
+}
+
 TEST_F(TypeLayoutTest, JitTypes) {
   // Randomly test the layout of a bunch of types. TypeLayouts are generated by
   // the JIT and random xls::Values are round-tripped through the native layout.
@@ -351,5 +385,33 @@ TEST_F(TypeLayoutTest, JitTypes) {
   }
 }
 
+TEST_F(TypeLayoutTest, PackedArrayRoundTrip) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Type * type,
+                           Parser::ParseType("bits[13][70]", package.get()));
+  TypeLayout layout = CreateTypeLayout(type);
+  std::minstd_rand bitgen;
+  Value value = RandomValue(type, &bitgen);
+  Value packed = Value::MaybePack(value);
+  ASSERT_TRUE(packed.IsPackedArray());
+
+  std::vector<uint8_t> buffer(layout.size(), 0xff);
+  layout.ValueToNativeLayout(packed, buffer.data());
+  EXPECT_EQ(layout.NativeLayoutToValue(buffer.data()), value);
+}
+
+TEST_F(TypeLayoutTest, Dense) {
+  auto package = CreatePackage();
+  for (const char* type_str : {"bits[32]", "bits[42]", "bits[16][7]"}) {
+    XLS_ASSERT_OK_AND_ASSIGN(Type * type,
+                             Parser::ParseType(type_str, package.get()));
+    EXPECT_TRUE(CreateTypeLayout(type).IsDense()) << type_str;
+  }
+  // The 64-bit element is aligned, leaving a gap after the 8-bit element.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Type * type, Parser::ParseType("(bits[8], bits[64])", package.get()));
+  EXPECT_FALSE(CreateTypeLayout(type).IsDense());
+}
+
 }  // namespace
 }  // namespace xls
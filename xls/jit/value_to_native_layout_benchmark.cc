@@ -20,6 +20,7 @@
 #include "xls/interpreter/random_value.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
+#include "xls/jit/jit_runtime.h"
 #include "xls/jit/llvm_type_converter.h"
 #include "xls/jit/orc_jit.h"
 
@@ -71,8 +72,45 @@ static void BM_NativeLayoutToValue(benchmark::State& state) {
   }
 }
 
+// Returns a runtime shared by all benchmark threads.
+static JitRuntime* GetSharedJitRuntime() {
+  static JitRuntime* runtime = JitRuntime::Create().value().release();
+  return runtime;
+}
+
+// Measure the conversion paths of a JitRuntime shared by multiple threads, as
+// when many proc or function jits created from the same runtime run
+// concurrently.
+static void BM_JitRuntimeBlitValueToBuffer(benchmark::State& state) {
+  JitRuntime* runtime = GetSharedJitRuntime();
+  Package package("BM");
+  Type* type = Parser::ParseType(kValueTypes[state.range(0)], &package).value();
+  std::minstd_rand bitgen;
+  Value value = RandomValue(type, &bitgen);
+  std::vector<uint8_t> buffer(runtime->GetTypeByteSize(type));
+  for (auto _ : state) {
+    runtime->BlitValueToBuffer(value, type, absl::MakeSpan(buffer));
+  }
+}
+
+static void BM_JitRuntimeUnpackBuffer(benchmark::State& state) {
+  JitRuntime* runtime = GetSharedJitRuntime();
+  Package package("BM");
+  Type* type = Parser::ParseType(kValueTypes[state.range(0)], &package).value();
+  std::vector<uint8_t> buffer(runtime->GetTypeByteSize(type), 0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(runtime->UnpackBuffer(buffer.data(), type));
+  }
+}
+
 BENCHMARK(BM_ValueToNativeLayout)->DenseRange(0, kNumTypes - 1);
 BENCHMARK(BM_NativeLayoutToValue)->DenseRange(0, kNumTypes - 1);
+BENCHMARK(BM_JitRuntimeBlitValueToBuffer)
+    ->DenseRange(0, kNumTypes - 1)
+    ->ThreadRange(1, 8);
+BENCHMARK(BM_JitRuntimeUnpackBuffer)
+    ->DenseRange(0, kNumTypes - 1)
+    ->ThreadRange(1, 8);
 
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,750 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NETLIST_COMPILED_NETLIST_H_
+#define XLS_NETLIST_COMPILED_NETLIST_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/function_parser.h"
+#include "xls/netlist/interpreter.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+
+// A netlist module compiled into a flat, levelized instruction sequence.
+//
+// AbstractInterpreter::InterpretModule discovers an evaluation order on every
+// call by propagating values through a ready queue of cells keyed by hash
+// maps. For repeated evaluation of the same module (e.g., simulating many
+// input vectors) this class does that work once: Compile() topologically sorts
+// the cells, inlines submodules, parses each cell's pin functions and lowers
+// them to AND/OR/XOR/NOT instructions over a dense array of value slots (one
+// per net plus temporaries). Evaluate() is then a single pass over the
+// instructions with no hashing or allocation beyond the slot array.
+//
+// Cells whose outputs have custom evaluation functions or are defined by state
+// tables are supported through out-of-line call instructions.
+//
+// The instructions are ordered by level: an instruction only depends on
+// instructions of earlier levels. Evaluate() can therefore spread the
+// instructions of each level over several threads, which speeds up the
+// evaluation of a single input vector of a very large netlist.
+//
+// The compiled module refers to cell library entries owned by the netlist's
+// cell library, which must outlive it.
+template <typename EvalT = bool>
+class AbstractCompiledModule {
+ public:
+  // Compiles `module`, with submodule cells resolved against `netlist`.
+  static absl::StatusOr<AbstractCompiledModule> Compile(
+      const rtl::AbstractNetlist<EvalT>* netlist,
+      const rtl::AbstractModule<EvalT>* module, EvalT zero, EvalT one);
+
+  template <typename T = EvalT,
+            std::enable_if_t<std::is_constructible_v<T, bool>, int> = 0>
+  static absl::StatusOr<AbstractCompiledModule> Compile(
+      const rtl::AbstractNetlist<EvalT>* netlist,
+      const rtl::AbstractModule<EvalT>* module) {
+    return Compile(netlist, module, EvalT{false}, EvalT{true});
+  }
+
+  // Evaluates the module. `inputs` holds one value per module input, in the
+  // order of module->inputs(); the result holds one value per module output,
+  // in the order of module->outputs().
+  //
+  // If `num_threads` is greater than one, the instructions of each level with
+  // at least kMinParallelLevelSize instructions are split between that many
+  // threads (the calling thread and `num_threads - 1` new ones); smaller
+  // levels are evaluated by the calling thread alone. Custom cell evaluation
+  // functions must then be thread-safe.
+  absl::StatusOr<std::vector<EvalT>> Evaluate(const std::vector<EvalT>& inputs,
+                                              int64_t num_threads = 1) const;
+
+  // Evaluates the module with the same interface as
+  // AbstractInterpreter::InterpretModule.
+  absl::StatusOr<AbstractNetRef2Value<EvalT>> InterpretModule(
+      const AbstractNetRef2Value<EvalT>& inputs,
+      int64_t num_threads = 1) const;
+
+  const rtl::AbstractModule<EvalT>* module() const { return module_; }
+  int64_t slot_count() const { return slot_count_; }
+  int64_t instruction_count() const { return instructions_.size(); }
+  int64_t level_count() const { return level_starts_.size() - 1; }
+
+  // Minimum number of instructions in a level for it to be split between
+  // threads. Below this, synchronizing the threads costs more than it saves.
+  static constexpr int64_t kMinParallelLevelSize = 4096;
+
+ private:
+  enum class Op : uint8_t { kCopy, kNot, kAnd, kOr, kXor, kCall };
+
+  // Computes slots[dst] = slots[lhs] <op> slots[rhs]. For kCall, `lhs` is
+  // instead an index into calls_.
+  struct Instruction {
+    Op op;
+    int32_t dst;
+    int32_t lhs;
+    int32_t rhs;
+  };
+
+  // An out-of-line evaluation of a cell output.
+  struct Call {
+    std::function<absl::StatusOr<EvalT>(std::vector<EvalT>)> fn;
+    std::vector<int32_t> args;
+  };
+
+  // A range of instructions evaluated between two synchronizations of the
+  // threads of a parallel evaluation: either a single level which is split
+  // between the threads or a run of consecutive small levels which is
+  // evaluated by one thread.
+  struct Stage {
+    int64_t begin;
+    int64_t end;
+    bool parallel;
+  };
+
+  // Slots holding the constant zero and one.
+  static constexpr int32_t kZeroSlot = 0;
+  static constexpr int32_t kOneSlot = 1;
+
+  using NetSlots = absl::flat_hash_map<rtl::AbstractNetRef<EvalT>, int32_t>;
+
+  AbstractCompiledModule(const rtl::AbstractNetlist<EvalT>* netlist,
+                         const rtl::AbstractModule<EvalT>* module, EvalT zero,
+                         EvalT one)
+      : netlist_(netlist),
+        module_(module),
+        zero_(std::move(zero)),
+        one_(std::move(one)) {}
+
+  int32_t NewSlot() { return slot_count_++; }
+
+  // Emits instructions computing `module`. `net_slots` must hold the slots of
+  // the module inputs and may hold pre-assigned slots for the module outputs.
+  // On return it holds the slots of every net of the module which has a value.
+  absl::Status CompileModule(const rtl::AbstractModule<EvalT>* module,
+                             NetSlots& net_slots);
+
+  absl::Status CompileSubmodule(const rtl::AbstractCell<EvalT>* cell,
+                                const rtl::AbstractModule<EvalT>* submodule,
+                                absl::Span<const int32_t> input_slots,
+                                NetSlots& net_slots);
+
+  absl::Status CompileCell(const rtl::AbstractCell<EvalT>* cell,
+                           absl::Span<const int32_t> input_slots,
+                           NetSlots& net_slots);
+
+  // Emits instructions evaluating `ast` for `cell` and returns the slot
+  // holding the result. If `dst` is given the result is placed there.
+  absl::StatusOr<int32_t> CompileFunction(const rtl::AbstractCell<EvalT>* cell,
+                                          const function::Ast& ast,
+                                          absl::Span<const int32_t> input_slots,
+                                          std::optional<int32_t> dst);
+
+  // Sorts the instructions by level and computes `level_starts_` and
+  // `stages_`.
+  void Levelize();
+
+  // Evaluates the given instructions, in order, on `slots`.
+  absl::Status Execute(absl::Span<const Instruction> instructions,
+                       EvalT* slots) const;
+
+  // Evaluates all instructions on `slots` using `num_threads` threads.
+  absl::Status ExecuteParallel(int64_t num_threads, EvalT* slots) const;
+
+  int32_t EmitCall(Call call, std::optional<int32_t> dst) {
+    int32_t slot = dst.has_value() ? *dst : NewSlot();
+    instructions_.push_back(
+        {Op::kCall, slot, static_cast<int32_t>(calls_.size()), 0});
+    calls_.push_back(std::move(call));
+    return slot;
+  }
+
+  const rtl::AbstractNetlist<EvalT>* netlist_;
+  const rtl::AbstractModule<EvalT>* module_;
+  EvalT zero_;
+  EvalT one_;
+
+  int32_t slot_count_ = 2;
+  std::vector<Instruction> instructions_;
+  std::vector<Call> calls_;
+  std::vector<int32_t> input_slots_;
+  std::vector<int32_t> output_slots_;
+
+  // The instructions of level `i` are instructions_[level_starts_[i],
+  // level_starts_[i + 1]).
+  std::vector<int64_t> level_starts_;
+  std::vector<Stage> stages_;
+
+  // Pin functions are parsed once per distinct function string.
+  absl::flat_hash_map<std::string, function::Ast> parsed_functions_;
+};
+
+using CompiledModule = AbstractCompiledModule<>;
+
+template <typename EvalT>
+absl::StatusOr<AbstractCompiledModule<EvalT>>
+AbstractCompiledModule<EvalT>::Compile(
+    const rtl::AbstractNetlist<EvalT>* netlist,
+    const rtl::AbstractModule<EvalT>* module, EvalT zero, EvalT one) {
+  AbstractCompiledModule compiled(netlist, module, std::move(zero),
+                                  std::move(one));
+  NetSlots net_slots;
+  for (const rtl::AbstractNetRef<EvalT> input : module->inputs()) {
+    int32_t slot = compiled.NewSlot();
+    net_slots[input] = slot;
+    compiled.input_slots_.push_back(slot);
+  }
+  XLS_RETURN_IF_ERROR(compiled.CompileModule(module, net_slots));
+  for (const rtl::AbstractNetRef<EvalT> output : module->outputs()) {
+    compiled.output_slots_.push_back(net_slots.at(output));
+  }
+  compiled.Levelize();
+  return compiled;
+}
+
+template <typename EvalT>
+void AbstractCompiledModule<EvalT>::Levelize() {
+  // The level of an instruction is one more than the levels of the
+  // instructions which last wrote its operands. Slots are (nearly) only
+  // written once, but to be safe a write is also placed after every earlier
+  // access of its slot.
+  std::vector<int64_t> write_levels(slot_count_, -1);
+  std::vector<int64_t> access_levels(slot_count_, -1);
+  std::vector<int64_t> levels;
+  levels.reserve(instructions_.size());
+  auto for_each_operand = [&](const Instruction& instruction, auto fn) {
+    switch (instruction.op) {
+      case Op::kCopy:
+      case Op::kNot:
+        fn(instruction.lhs);
+        break;
+      case Op::kAnd:
+      case Op::kOr:
+      case Op::kXor:
+        fn(instruction.lhs);
+        fn(instruction.rhs);
+        break;
+      case Op::kCall:
+        for (int32_t arg : calls_[instruction.lhs].args) {
+          fn(arg);
+        }
+        break;
+    }
+  };
+  int64_t level_count = 0;
+  for (const Instruction& instruction : instructions_) {
+    int64_t level = access_levels[instruction.dst] + 1;
+    for_each_operand(instruction, [&](int32_t operand) {
+      level = std::max(level, write_levels[operand] + 1);
+    });
+    for_each_operand(instruction, [&](int32_t operand) {
+      access_levels[operand] = std::max(access_levels[operand], level);
+    });
+    write_levels[instruction.dst] = level;
+    access_levels[instruction.dst] = level;
+    levels.push_back(level);
+    level_count = std::max(level_count, level + 1);
+  }
+
+  // Stable counting sort of the instructions by level.
+  level_starts_.assign(level_count + 1, 0);
+  for (int64_t level : levels) {
+    ++level_starts_[level + 1];
+  }
+  for (int64_t level = 0; level < level_count; ++level) {
+    level_starts_[level + 1] += level_starts_[level];
+  }
+  std::vector<int64_t> next(level_starts_.begin(), level_starts_.end() - 1);
+  std::vector<Instruction> sorted(instructions_.size());
+  for (int64_t i = 0; i < instructions_.size(); ++i) {
+    sorted[next[levels[i]]++] = instructions_[i];
+  }
+  instructions_ = std::move(sorted);
+
+  stages_.clear();
+  for (int64_t level = 0; level < level_count; ++level) {
+    int64_t begin = level_starts_[level];
+    int64_t end = level_starts_[level + 1];
+    bool parallel = end - begin >= kMinParallelLevelSize;
+    if (!parallel && !stages_.empty() && !stages_.back().parallel) {
+      stages_.back().end = end;
+    } else {
+      stages_.push_back({begin, end, parallel});
+    }
+  }
+}
+
+template <typename EvalT>
+absl::Status AbstractCompiledModule<EvalT>::CompileModule(
+    const rtl::AbstractModule<EvalT>* module, NetSlots& net_slots) {
+  // Maps each net driven by a cell output to the cell driving it.
+  absl::flat_hash_map<rtl::AbstractNetRef<EvalT>,
+                      const rtl::AbstractCell<EvalT>*>
+      drivers;
+  for (const auto& cell : module->cells()) {
+    for (const auto& output : cell->outputs()) {
+      if (output.netref != module->GetDummyRef()) {
+        drivers[output.netref] = cell.get();
+      }
+    }
+  }
+
+  // Follows assignments from `net` to the net which provides its value.
+  auto resolve = [&](rtl::AbstractNetRef<EvalT> net) {
+    while (!drivers.contains(net) && module->assigns().contains(net)) {
+      net = module->assigns().at(net);
+    }
+    return net;
+  };
+  auto slot_of =
+      [&](rtl::AbstractNetRef<EvalT> net) -> absl::StatusOr<int32_t> {
+    net = resolve(net);
+    if (net == module->zero()) {
+      return kZeroSlot;
+    }
+    if (net == module->one()) {
+      return kOneSlot;
+    }
+    auto it = net_slots.find(net);
+    if (it == net_slots.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Net %s in module %s is not driven.", net->name(),
+                          module->name()));
+    }
+    return it->second;
+  };
+
+  // Levelize the cells: a cell is ready once every cell driving one of its
+  // inputs has been scheduled.
+  absl::flat_hash_map<const rtl::AbstractCell<EvalT>*, int64_t> pending;
+  absl::flat_hash_map<const rtl::AbstractCell<EvalT>*,
+                      std::vector<const rtl::AbstractCell<EvalT>*>>
+      dependents;
+  std::deque<const rtl::AbstractCell<EvalT>*> ready;
+  for (const auto& cell : module->cells()) {
+    int64_t count = 0;
+    for (const auto& input : cell->inputs()) {
+      auto it = drivers.find(resolve(input.netref));
+      if (it != drivers.end()) {
+        dependents[it->second].push_back(cell.get());
+        ++count;
+      }
+    }
+    pending[cell.get()] = count;
+    if (count == 0) {
+      ready.push_back(cell.get());
+    }
+  }
+
+  int64_t scheduled = 0;
+  while (!ready.empty()) {
+    const rtl::AbstractCell<EvalT>* cell = ready.front();
+    ready.pop_front();
+    ++scheduled;
+
+    std::vector<int32_t> input_slots;
+    input_slots.reserve(cell->inputs().size());
+    for (const auto& input : cell->inputs()) {
+      XLS_ASSIGN_OR_RETURN(int32_t slot, slot_of(input.netref));
+      input_slots.push_back(slot);
+    }
+    for (const auto& output : cell->outputs()) {
+      if (!net_slots.contains(output.netref)) {
+        net_slots[output.netref] = NewSlot();
+      }
+    }
+
+    std::optional<const rtl::AbstractModule<EvalT>*> submodule =
+        netlist_->MaybeGetModule(cell->cell_library_entry()->name());
+    if (submodule.has_value()) {
+      XLS_RETURN_IF_ERROR(
+          CompileSubmodule(cell, *submodule, input_slots, net_slots));
+    } else {
+      XLS_RETURN_IF_ERROR(CompileCell(cell, input_slots, net_slots));
+    }
+
+    for (const rtl::AbstractCell<EvalT>* dependent : dependents[cell]) {
+      if (--pending[dependent] == 0) {
+        ready.push_back(dependent);
+      }
+    }
+  }
+  if (scheduled != module->cells().size()) {
+    for (const auto& cell : module->cells()) {
+      if (pending[cell.get()] > 0) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Netlist contains unconnected subgraphs or combinational cycles "
+            "and cannot be compiled. Example: cell %s",
+            cell->name()));
+      }
+    }
+  }
+
+  // Outputs not driven by a cell take their value through assignments. If the
+  // output slot is already fixed by an enclosing module, copy the value into
+  // it; otherwise alias the source slot.
+  for (const rtl::AbstractNetRef<EvalT> output : module->outputs()) {
+    if (drivers.contains(output)) {
+      continue;
+    }
+    XLS_RET_CHECK(module->assigns().contains(output))
+        << absl::StrFormat("Output %s of module %s is undefined.",
+                           output->name(), module->name());
+    XLS_ASSIGN_OR_RETURN(int32_t source, slot_of(module->assigns().at(output)));
+    auto it = net_slots.find(output);
+    if (it == net_slots.end()) {
+      net_slots[output] = source;
+    } else if (it->second != source) {
+      instructions_.push_back({Op::kCopy, it->second, source, 0});
+    }
+  }
+  return absl::OkStatus();
+}
+
+template <typename EvalT>
+absl::Status AbstractCompiledModule<EvalT>::CompileSubmodule(
+    const rtl::AbstractCell<EvalT>* cell,
+    const rtl::AbstractModule<EvalT>* submodule,
+    absl::Span<const int32_t> input_slots, NetSlots& net_slots) {
+  // Pins are matched to the submodule's ports by name, as in
+  // AbstractInterpreter::InterpretCell. The submodule's instructions are
+  // inlined, reading the cell's input slots and writing its output slots
+  // directly.
+  NetSlots submodule_slots;
+  const std::vector<rtl::AbstractNetRef<EvalT>>& submodule_inputs =
+      submodule->inputs();
+  const absl::Span<const std::string> submodule_input_names =
+      submodule->AsCellLibraryEntry()->input_names();
+  for (int64_t i = 0; i < cell->inputs().size(); ++i) {
+    const auto& input = cell->inputs()[i];
+    bool input_found = false;
+    for (int64_t j = 0; j < submodule_input_names.size(); ++j) {
+      if (submodule_input_names[j] == input.name) {
+        submodule_slots[submodule_inputs[j]] = input_slots[i];
+        input_found = true;
+        break;
+      }
+    }
+    XLS_RET_CHECK(input_found) << absl::StrFormat(
+        "Could not find input pin \"%s\" in module \"%s\", referenced in "
+        "cell \"%s\"!",
+        input.name, submodule->name(), cell->name());
+  }
+  for (const rtl::AbstractNetRef<EvalT> submodule_output :
+       submodule->outputs()) {
+    bool output_found = false;
+    for (const auto& output : cell->outputs()) {
+      if (output.name == submodule_output->name()) {
+        submodule_slots[submodule_output] = net_slots.at(output.netref);
+        output_found = true;
+        break;
+      }
+    }
+    XLS_RET_CHECK(output_found) << absl::StrFormat(
+        "Could not find cell output pin \"%s\" in cell \"%s\", referenced in "
+        "child module \"%s\"!",
+        submodule_output->name(), cell->name(), submodule->name());
+  }
+  return CompileModule(submodule, submodule_slots);
+}
+
+template <typename EvalT>
+absl::Status AbstractCompiledModule<EvalT>::CompileCell(
+    const rtl::AbstractCell<EvalT>* cell, absl::Span<const int32_t> input_slots,
+    NetSlots& net_slots) {
+  const auto& pins = cell->cell_library_entry()->output_pin_to_function();
+  for (const auto& output : cell->outputs()) {
+    int32_t dst = net_slots.at(output.netref);
+    if (output.eval != nullptr) {
+      EmitCall({[eval = output.eval](std::vector<EvalT> args) {
+                  return eval(args);
+                },
+                std::vector<int32_t>(input_slots.begin(), input_slots.end())},
+               dst);
+      continue;
+    }
+    auto pin_it = pins.find(output.name);
+    XLS_RET_CHECK(pin_it != pins.end()) << absl::StrFormat(
+        "No function for output pin %s of cell %s.", output.name,
+        cell->name());
+    auto ast_it = parsed_functions_.find(pin_it->second);
+    if (ast_it == parsed_functions_.end()) {
+      XLS_ASSIGN_OR_RETURN(function::Ast ast,
+                           function::Parser::ParseFunction(pin_it->second));
+      ast_it = parsed_functions_.emplace(pin_it->second, std::move(ast)).first;
+    }
+    XLS_RETURN_IF_ERROR(
+        CompileFunction(cell, ast_it->second, input_slots, dst).status());
+  }
+  return absl::OkStatus();
+}
+
+template <typename EvalT>
+absl::StatusOr<int32_t> AbstractCompiledModule<EvalT>::CompileFunction(
+    const rtl::AbstractCell<EvalT>* cell, const function::Ast& ast,
+    absl::Span<const int32_t> input_slots, std::optional<int32_t> dst) {
+  // Places the value of `slot` in `dst`, if one is requested.
+  auto place = [&](int32_t slot) {
+    if (dst.has_value() && *dst != slot) {
+      instructions_.push_back({Op::kCopy, *dst, slot, 0});
+      return *dst;
+    }
+    return slot;
+  };
+  auto emit = [&](Op op, int32_t lhs, int32_t rhs) {
+    int32_t slot = dst.has_value() ? *dst : NewSlot();
+    instructions_.push_back({op, slot, lhs, rhs});
+    return slot;
+  };
+
+  switch (ast.kind()) {
+    case function::Ast::Kind::kLiteralZero:
+      return place(kZeroSlot);
+    case function::Ast::Kind::kLiteralOne:
+      return place(kOneSlot);
+    case function::Ast::Kind::kIdentifier: {
+      std::optional<int32_t> slot;
+      for (int64_t i = 0; i < cell->inputs().size(); ++i) {
+        if (cell->inputs()[i].name == ast.name()) {
+          slot = input_slots[i];
+        }
+      }
+      if (slot.has_value()) {
+        return place(*slot);
+      }
+      for (const auto& internal : cell->internal_pins()) {
+        if (internal.name != ast.name()) {
+          continue;
+        }
+        XLS_RET_CHECK(cell->cell_library_entry()->state_table());
+        const AbstractStateTable<EvalT>* state_table =
+            &cell->cell_library_entry()->state_table().value();
+        std::vector<std::string> input_names;
+        for (const auto& input : cell->inputs()) {
+          input_names.push_back(input.name);
+        }
+        return EmitCall(
+            {[state_table, input_names = std::move(input_names),
+              pin_name = internal.name](std::vector<EvalT> args) {
+               typename AbstractStateTable<EvalT>::InputStimulus stimulus;
+               for (int64_t i = 0; i < input_names.size(); ++i) {
+                 stimulus.emplace(input_names[i], std::move(args[i]));
+               }
+               return state_table->GetSignalValue(stimulus, pin_name);
+             },
+             std::vector<int32_t>(input_slots.begin(), input_slots.end())},
+            dst);
+      }
+      return absl::NotFoundError(
+          absl::StrFormat("Identifier \"%s\" not found in cell %s's inputs "
+                          "or internal signals.",
+                          ast.name(), cell->name()));
+    }
+    case function::Ast::Kind::kNot: {
+      XLS_ASSIGN_OR_RETURN(int32_t operand,
+                           CompileFunction(cell, ast.children()[0], input_slots,
+                                           std::nullopt));
+      return emit(Op::kNot, operand, 0);
+    }
+    case function::Ast::Kind::kAnd:
+    case function::Ast::Kind::kOr:
+    case function::Ast::Kind::kXor: {
+      XLS_ASSIGN_OR_RETURN(int32_t lhs,
+                           CompileFunction(cell, ast.children()[0], input_slots,
+                                           std::nullopt));
+      XLS_ASSIGN_OR_RETURN(int32_t rhs,
+                           CompileFunction(cell, ast.children()[1], input_slots,
+                                           std::nullopt));
+      Op op = ast.kind() == function::Ast::Kind::kAnd  ? Op::kAnd
+              : ast.kind() == function::Ast::Kind::kOr ? Op::kOr
+                                                       : Op::kXor;
+      return emit(op, lhs, rhs);
+    }
+  }
+  return absl::InvalidArgumentError(
+      absl::StrCat("Unknown AST element type: ", ast.kind()));
+}
+
+template <typename EvalT>
+absl::Status AbstractCompiledModule<EvalT>::Execute(
+    absl::Span<const Instruction> instructions, EvalT* slots) const {
+  for (const Instruction& instruction : instructions) {
+    switch (instruction.op) {
+      case Op::kCopy:
+        slots[instruction.dst] = slots[instruction.lhs];
+        break;
+      case Op::kNot:
+        slots[instruction.dst] = !slots[instruction.lhs];
+        break;
+      case Op::kAnd:
+        slots[instruction.dst] =
+            slots[instruction.lhs] & slots[instruction.rhs];
+        break;
+      case Op::kOr:
+        slots[instruction.dst] =
+            slots[instruction.lhs] | slots[instruction.rhs];
+        break;
+      case Op::kXor:
+        slots[instruction.dst] =
+            slots[instruction.lhs] ^ slots[instruction.rhs];
+        break;
+      case Op::kCall: {
+        const Call& call = calls_[instruction.lhs];
+        std::vector<EvalT> args;
+        args.reserve(call.args.size());
+        for (int32_t arg : call.args) {
+          args.push_back(slots[arg]);
+        }
+        XLS_ASSIGN_OR_RETURN(slots[instruction.dst], call.fn(std::move(args)));
+        break;
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+template <typename EvalT>
+absl::Status AbstractCompiledModule<EvalT>::ExecuteParallel(
+    int64_t num_threads, EvalT* slots) const {
+  absl::Mutex mutex;
+  absl::Status status;
+  std::atomic<bool> failed = false;
+  // Threads wait at the end of each stage until all of them are done with it.
+  int64_t arrived = 0;
+  int64_t generation = 0;
+  auto barrier = [&]() {
+    absl::MutexLock lock(&mutex);
+    if (++arrived == num_threads) {
+      arrived = 0;
+      ++generation;
+      return;
+    }
+    int64_t current = generation;
+    auto released = [&]() { return generation != current; };
+    mutex.Await(absl::Condition(&released));
+  };
+
+  auto worker = [&](int64_t thread_index) {
+    for (const Stage& stage : stages_) {
+      absl::Span<const Instruction> instructions =
+          absl::MakeConstSpan(instructions_)
+              .subspan(stage.begin, stage.end - stage.begin);
+      if (stage.parallel) {
+        int64_t chunk = (instructions.size() + num_threads - 1) / num_threads;
+        instructions = instructions.subspan(
+            std::min<int64_t>(thread_index * chunk, instructions.size()),
+            chunk);
+      } else if (thread_index != 0) {
+        instructions = {};
+      }
+      if (!failed.load(std::memory_order_relaxed)) {
+        absl::Status execute_status = Execute(instructions, slots);
+        if (!execute_status.ok()) {
+          absl::MutexLock lock(&mutex);
+          status.Update(execute_status);
+          failed = true;
+        }
+      }
+      barrier();
+    }
+  };
+
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < num_threads; ++i) {
+    threads.push_back(std::make_unique<Thread>([&worker, i]() { worker(i); }));
+  }
+  worker(0);
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  return status;
+}
+
+template <typename EvalT>
+absl::StatusOr<std::vector<EvalT>> AbstractCompiledModule<EvalT>::Evaluate(
+    const std::vector<EvalT>& inputs, int64_t num_threads) const {
+  XLS_RET_CHECK_EQ(inputs.size(), input_slots_.size());
+  XLS_RET_CHECK_GE(num_threads, 1);
+  // Unlike the elements of a std::vector<bool>, the slots of an array can be
+  // written concurrently.
+  auto slots = std::make_unique<EvalT[]>(slot_count_);
+  std::fill_n(slots.get(), slot_count_, zero_);
+  slots[kOneSlot] = one_;
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    slots[input_slots_[i]] = inputs[i];
+  }
+  if (num_threads == 1) {
+    XLS_RETURN_IF_ERROR(Execute(instructions_, slots.get()));
+  } else {
+    XLS_RETURN_IF_ERROR(ExecuteParallel(num_threads, slots.get()));
+  }
+
+  std::vector<EvalT> outputs;
+  outputs.reserve(output_slots_.size());
+  for (int32_t slot : output_slots_) {
+    outputs.push_back(slots[slot]);
+  }
+  return outputs;
+}
+
+template <typename EvalT>
+absl::StatusOr<AbstractNetRef2Value<EvalT>>
+AbstractCompiledModule<EvalT>::InterpretModule(
+    const AbstractNetRef2Value<EvalT>& inputs, int64_t num_threads) const {
+  std::vector<EvalT> input_values;
+  input_values.reserve(module_->inputs().size());
+  for (const rtl::AbstractNetRef<EvalT> input : module_->inputs()) {
+    auto it = inputs.find(input);
+    XLS_RET_CHECK(it != inputs.end())
+        << "No value given for input " << input->name();
+    input_values.push_back(it->second);
+  }
+  XLS_ASSIGN_OR_RETURN(std::vector<EvalT> output_values,
+                       Evaluate(input_values, num_threads));
+  AbstractNetRef2Value<EvalT> outputs;
+  outputs.reserve(output_values.size());
+  for (int64_t i = 0; i < output_values.size(); ++i) {
+    outputs.insert({module_->outputs()[i], std::move(output_values[i])});
+  }
+  return outputs;
+}
+
+}  // namespace netlist
+}  // namespace xls
+
+#endif  // XLS_NETLIST_COMPILED_NETLIST_H_
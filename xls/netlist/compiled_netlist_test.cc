@@ -0,0 +1,233 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/compiled_netlist.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "xls/common/status/matchers.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/fake_cell_library.h"
+#include "xls/netlist/interpreter.h"
+#include "xls/netlist/netlist.h"
+#include "xls/netlist/netlist_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+using status_testing::StatusIs;
+
+// Checks that the compiled form of module `module_name` agrees with the
+// interpreter on every combination of input values.
+void ExpectMatchesInterpreter(const std::string& module_text,
+                              const std::string& module_name) {
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule(module_name));
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledModule compiled,
+                           CompiledModule::Compile(netlist.get(), module));
+  Interpreter interpreter(netlist.get());
+
+  const int64_t input_count = module->inputs().size();
+  ASSERT_LE(input_count, 8);
+  for (int64_t value = 0; value < (int64_t{1} << input_count); ++value) {
+    NetRef2Value inputs;
+    for (int64_t i = 0; i < input_count; ++i) {
+      inputs[module->inputs()[i]] = (value >> i) & 1;
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(NetRef2Value expected,
+                             interpreter.InterpretModule(module, inputs));
+    XLS_ASSERT_OK_AND_ASSIGN(NetRef2Value actual,
+                             compiled.InterpretModule(inputs));
+    EXPECT_EQ(actual, expected) << "inputs: " << value;
+    XLS_ASSERT_OK_AND_ASSIGN(
+        NetRef2Value actual_parallel,
+        compiled.InterpretModule(inputs, /*num_threads=*/3));
+    EXPECT_EQ(actual_parallel, expected) << "inputs: " << value;
+  }
+}
+
+TEST(CompiledNetlistTest, Tree) {
+  std::string module_text = R"(
+module main(i0, i1, i2, i3, o0, o1);
+  input i0, i1, i2, i3;
+  output o0, o1;
+  wire and_o, or_o, inv_o;
+
+  AND and0 ( .A(i0), .B(i1), .Z(and_o) );
+  OR or0 ( .A(i2), .B(i3), .Z(or_o) );
+  XOR xor0 ( .A(and_o), .B(or_o), .Z(o0) );
+  INV inv0 ( .A(and_o), .ZN(inv_o) );
+  AND and1 ( .A(inv_o), .B(i3), .Z(o1) );
+endmodule
+)";
+  ExpectMatchesInterpreter(module_text, "main");
+}
+
+TEST(CompiledNetlistTest, Submodules) {
+  std::string module_text = R"(
+module submodule_0 (i2_0, i2_1, o2_0);
+  input i2_0, i2_1;
+  output o2_0;
+
+  AND and0( .A(i2_0), .B(i2_1), .Z(o2_0) );
+endmodule
+
+module submodule_1 (i2_2, i2_3, o2_1);
+  input i2_2, i2_3;
+  output o2_1;
+
+  OR or0( .A(i2_2), .B(i2_3), .Z(o2_1) );
+endmodule
+
+module submodule_2 (i1_0, i1_1, i1_2, i1_3, o1_0);
+  input i1_0, i1_1, i1_2, i1_3;
+  output o1_0;
+  wire res0, res1;
+
+  submodule_0 and0 ( .i2_0(i1_0), .i2_1(i1_1), .o2_0(res0) );
+  submodule_1 or0 ( .i2_2(i1_2), .i2_3(i1_3), .o2_1(res1) );
+  XOR xor0 ( .A(res0), .B(res1), .Z(o1_0) );
+endmodule
+
+module main (i0, i1, i2, i3, o0);
+  input i0, i1, i2, i3;
+  output o0;
+
+  submodule_2 bleh( .i1_0(i0), .i1_1(i1), .i1_2(i2), .i1_3(i3), .o1_0(o0) );
+endmodule
+)";
+  ExpectMatchesInterpreter(module_text, "main");
+}
+
+TEST(CompiledNetlistTest, StateTablesAndAssigns) {
+  std::string module_text = R"(
+module main(i0, i1, i2, i3, o0, o1, o2);
+  input i0, i1, i2, i3;
+  output o0, o1, o2;
+  wire and0_out, and1_out;
+
+  AND and0 ( .A(i0), .B(i1), .Z(and0_out) );
+  STATETABLE_AND and1 (.A(i2), .B(i3), .Z(and1_out) );
+  AND and2 ( .A(and0_out), .B(and1_out), .Z(o0) );
+  assign o1 = i2;
+  assign o2 = 1'b1;
+endmodule
+)";
+  ExpectMatchesInterpreter(module_text, "main");
+}
+
+TEST(CompiledNetlistTest, Evaluate) {
+  std::string module_text = R"(
+module main(a, b, o);
+  input a, b;
+  output o;
+
+  XOR xor0 ( .A(a), .B(b), .Z(o) );
+endmodule
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledModule compiled,
+                           CompiledModule::Compile(netlist.get(), module));
+  EXPECT_EQ(compiled.Evaluate({true, false}).value(), std::vector<bool>{true});
+  EXPECT_EQ(compiled.Evaluate({true, true}).value(), std::vector<bool>{false});
+  EXPECT_THAT(compiled.Evaluate({true}),
+              StatusIs(absl::StatusCode::kInternal));
+}
+
+TEST(CompiledNetlistTest, ParallelEvaluation) {
+  // Three levels of cells, each wide enough to be split between threads.
+  constexpr int64_t kInputCount = 8;
+  constexpr int64_t kOutputCount = 16;
+  const int64_t width = CompiledModule::kMinParallelLevelSize + 100;
+  std::vector<std::string> inputs;
+  for (int64_t i = 0; i < kInputCount; ++i) {
+    inputs.push_back(absl::StrCat("i", i));
+  }
+  std::vector<std::string> outputs;
+  for (int64_t i = 0; i < kOutputCount; ++i) {
+    outputs.push_back(absl::StrCat("o", i));
+  }
+  std::vector<std::string> wires;
+  for (int64_t level = 0; level < 3; ++level) {
+    for (int64_t i = 0; i < width; ++i) {
+      wires.push_back(absl::StrFormat("l%d_%d", level, i));
+    }
+  }
+  std::string module_text = absl::StrFormat(
+      "module main(%s, %s);\n  input %s;\n  output %s;\n  wire %s;\n",
+      absl::StrJoin(inputs, ", "), absl::StrJoin(outputs, ", "),
+      absl::StrJoin(inputs, ", "), absl::StrJoin(outputs, ", "),
+      absl::StrJoin(wires, ", "));
+  for (int64_t i = 0; i < width; ++i) {
+    absl::StrAppendFormat(&module_text,
+                          "  XOR x%d ( .A(i%d), .B(i%d), .Z(l0_%d) );\n", i,
+                          i % kInputCount, (i / kInputCount) % kInputCount, i);
+    absl::StrAppendFormat(&module_text,
+                          "  AND a%d ( .A(l0_%d), .B(l0_%d), .Z(l1_%d) );\n",
+                          i, i, (i + 1) % width, i);
+    absl::StrAppendFormat(&module_text,
+                          "  OR o%d ( .A(l1_%d), .B(l0_%d), .Z(l2_%d) );\n",
+                          i, i, (i + 3) % width, i);
+  }
+  for (int64_t i = 0; i < kOutputCount; ++i) {
+    absl::StrAppendFormat(&module_text,
+                          "  XOR out%d ( .A(l2_%d), .B(l2_%d), .Z(o%d) );\n",
+                          i, i * 101, i * 211 + 5, i);
+  }
+  module_text += "endmodule\n";
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledModule compiled,
+                           CompiledModule::Compile(netlist.get(), module));
+  EXPECT_EQ(compiled.level_count(), 4);
+
+  for (int64_t value : {0x00, 0x5a, 0xc3, 0xff}) {
+    std::vector<bool> input_values;
+    for (int64_t i = 0; i < kInputCount; ++i) {
+      input_values.push_back((value >> i) & 1);
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(std::vector<bool> expected,
+                             compiled.Evaluate(input_values));
+    for (int64_t num_threads : {2, 4, 7}) {
+      EXPECT_EQ(compiled.Evaluate(input_values, num_threads).value(),
+                expected)
+          << "inputs: " << value << " threads: " << num_threads;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace netlist
+}  // namespace xls
@@ -14,18 +14,23 @@
 
 #include "xls/netlist/function_extractor.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/crc/crc32c.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_split.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -298,6 +303,42 @@ absl::StatusOr<CellLibraryProto> ExtractFunctions(
   return proto;
 }
 
+absl::StatusOr<CellLibraryProto> ExtractFunctionsCached(
+    std::string_view liberty_path, std::string_view cache_path) {
+  XLS_ASSIGN_OR_RETURN(MappedFile liberty_file, MappedFile::Open(liberty_path));
+  std::string_view liberty_text = liberty_file.contents();
+  uint32_t crc = static_cast<uint32_t>(absl::ComputeCrc32c(liberty_text));
+
+  if (FileExists(cache_path).ok()) {
+    XLS_ASSIGN_OR_RETURN(std::string cache_text, GetFileContents(cache_path));
+    CellLibraryCacheProto cache;
+    if (cache.ParseFromString(cache_text) && cache.source_crc32c() == crc &&
+        cache.source_size() == liberty_text.size()) {
+      XLS_VLOG(1) << "Loaded cell library from cache " << cache_path;
+      return std::move(*cache.mutable_library());
+    }
+    XLS_VLOG(1) << "Cell library cache " << cache_path << " is stale";
+  }
+
+  int64_t liberty_size = liberty_text.size();
+  XLS_ASSIGN_OR_RETURN(
+      auto char_stream,
+      cell_lib::CharStream::FromMappedFile(std::move(liberty_file)));
+  CellLibraryCacheProto cache;
+  XLS_ASSIGN_OR_RETURN(*cache.mutable_library(),
+                       ExtractFunctions(&char_stream));
+  cache.set_source_crc32c(crc);
+  cache.set_source_size(liberty_size);
+  // Failing to write the cache only costs time on the next run.
+  absl::Status write_status =
+      SetFileContents(cache_path, cache.SerializeAsString());
+  if (!write_status.ok()) {
+    XLS_LOG(WARNING) << "Unable to write cell library cache " << cache_path
+                     << ": " << write_status;
+  }
+  return std::move(*cache.mutable_library());
+}
+
 }  // namespace function
 }  // namespace netlist
 }  // namespace xls
@@ -16,6 +16,7 @@
 #define XLS_NETLIST_FUNCTION_EXTRACTOR_H_
 
 #include <string>
+#include <string_view>
 
 #include "absl/status/statusor.h"
 #include "xls/netlist/lib_parser.h"
@@ -31,6 +32,13 @@ namespace function {
 // logical operation of the cell or pin (in the case of multiple output pins).
 absl::StatusOr<CellLibraryProto> ExtractFunctions(cell_lib::CharStream* stream);
 
+// As ExtractFunctions but for the Liberty file at `liberty_path` and cached in
+// binary form at `cache_path`. If the cache exists and its checksum matches
+// the Liberty file the library is loaded directly from the cache. Otherwise
+// the Liberty file is parsed and the cache is (re)written.
+absl::StatusOr<CellLibraryProto> ExtractFunctionsCached(
+    std::string_view liberty_path, std::string_view cache_path);
+
 }  // namespace function
 }  // namespace netlist
 }  // namespace xls
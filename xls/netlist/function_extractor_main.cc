@@ -16,12 +16,14 @@
 // CellLibraryProto for colocation with the original library.
 
 #include <string>
+#include <utility>
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "google/protobuf/text_format.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
@@ -41,11 +43,11 @@ namespace xls::netlist::function {
 static absl::Status RealMain(const std::string& cell_library_path,
                              const std::string& output_path,
                              bool output_textproto) {
-  XLS_ASSIGN_OR_RETURN(std::string cell_library_text,
-                       GetFileContents(cell_library_path));
-  XLS_ASSIGN_OR_RETURN(
-      auto char_stream,
-      netlist::cell_lib::CharStream::FromText(cell_library_text));
+  XLS_ASSIGN_OR_RETURN(MappedFile cell_library_file,
+                       MappedFile::Open(cell_library_path));
+  XLS_ASSIGN_OR_RETURN(auto char_stream,
+                       netlist::cell_lib::CharStream::FromMappedFile(
+                           std::move(cell_library_file)));
   XLS_ASSIGN_OR_RETURN(netlist::CellLibraryProto lib_proto,
                        netlist::function::ExtractFunctions(&char_stream));
 
@@ -19,6 +19,9 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_replace.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/status/matchers.h"
 #include "xls/netlist/lib_parser.h"
 #include "xls/netlist/netlist.pb.h"
@@ -66,6 +69,52 @@ library (blah) {
   ASSERT_EQ(output_pin.function(), "meow");
 }
 
+TEST(FunctionExtractorTest, CachedExtraction) {
+  std::string lib = R"(
+library (blah) {
+  cell (cell_1) {
+    pin (i) {
+      direction: input;
+    }
+    pin (o) {
+      direction: output;
+      function: "meow";
+    }
+  }
+}
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::string lib_path = (temp_dir.path() / "cells.lib").string();
+  std::string cache_path = (temp_dir.path() / "cells.cache").string();
+  XLS_ASSERT_OK(SetFileContents(lib_path, lib));
+
+  // The first extraction parses the Liberty file and writes the cache.
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto proto,
+                           ExtractFunctionsCached(lib_path, cache_path));
+  EXPECT_EQ(proto.entries(0).output_pin_list().pins(0).function(), "meow");
+  XLS_ASSERT_OK(FileExists(cache_path));
+
+  // Doctor the cached library to observe that the next extraction is loaded
+  // from the cache.
+  XLS_ASSERT_OK_AND_ASSIGN(std::string cache_text, GetFileContents(cache_path));
+  CellLibraryCacheProto cache;
+  ASSERT_TRUE(cache.ParseFromString(cache_text));
+  cache.mutable_library()
+      ->mutable_entries(0)
+      ->mutable_output_pin_list()
+      ->mutable_pins(0)
+      ->set_function("purr");
+  XLS_ASSERT_OK(SetFileContents(cache_path, cache.SerializeAsString()));
+  XLS_ASSERT_OK_AND_ASSIGN(proto, ExtractFunctionsCached(lib_path, cache_path));
+  EXPECT_EQ(proto.entries(0).output_pin_list().pins(0).function(), "purr");
+
+  // Changing the Liberty file invalidates the cache.
+  XLS_ASSERT_OK(
+      SetFileContents(lib_path, absl::StrReplaceAll(lib, {{"meow", "woof"}})));
+  XLS_ASSERT_OK_AND_ASSIGN(proto, ExtractFunctionsCached(lib_path, cache_path));
+  EXPECT_EQ(proto.entries(0).output_pin_list().pins(0).function(), "woof");
+}
+
 TEST(FunctionExtractorTest, HippetyHoppetyTestTheFlippetyFloppety) {
   std::string lib = R"(
 library (blah) {
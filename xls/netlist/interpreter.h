@@ -19,6 +19,7 @@
 #include <memory>
 #include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/base/thread_annotations.h"
@@ -124,6 +125,11 @@ class AbstractInterpreter {
       const rtl::AbstractCell<EvalT>& cell, const function::Ast& ast,
       const AbstractNetRef2Value<EvalT>& inputs);
 
+  // Returns the parsed form of the given cell pin function. Each distinct
+  // function string is parsed once per interpreter.
+  absl::StatusOr<const function::Ast*> GetFunctionAst(
+      const std::string& function);
+
   // Returns the value of the internal/output pin from the cell (defined by a
   // "statetable" attribute under the conditions defined in "inputs".
   absl::StatusOr<EvalT> InterpretStateTable(
@@ -170,6 +176,12 @@ class AbstractInterpreter {
   std::atomic_size_t num_available_threads_ ABSL_GUARDED_BY(input_queue_guard_);
   // Set to shut down thread pool.
   std::atomic_bool threads_should_exit_ ABSL_GUARDED_BY(input_queue_guard_);
+
+  // Parsed cell pin functions keyed by function string. Shared by the worker
+  // threads.
+  absl::Mutex function_asts_guard_;
+  absl::flat_hash_map<std::string, std::unique_ptr<function::Ast>>
+      function_asts_ ABSL_GUARDED_BY(function_asts_guard_);
 };
 
 using Interpreter = AbstractInterpreter<>;
@@ -473,10 +485,9 @@ AbstractInterpreter<EvalT>::InterpretCell(
       XLS_ASSIGN_OR_RETURN(EvalT value, cell->outputs()[i].eval(args));
       results.insert({cell->outputs()[i].netref, value});
     } else {
-      XLS_ASSIGN_OR_RETURN(
-          function::Ast ast,
-          function::Parser::ParseFunction(pins.at(cell->outputs()[i].name)));
-      XLS_ASSIGN_OR_RETURN(EvalT value, InterpretFunction(*cell, ast, inputs));
+      XLS_ASSIGN_OR_RETURN(const function::Ast* ast,
+                           GetFunctionAst(pins.at(cell->outputs()[i].name)));
+      XLS_ASSIGN_OR_RETURN(EvalT value, InterpretFunction(*cell, *ast, inputs));
       results.insert({cell->outputs()[i].netref, value});
     }
   }
@@ -512,6 +523,21 @@ absl::Status AbstractInterpreter<EvalT>::ThreadBody() {
   return absl::OkStatus();
 }
 
+template <typename EvalT>
+absl::StatusOr<const function::Ast*>
+AbstractInterpreter<EvalT>::GetFunctionAst(const std::string& function) {
+  absl::MutexLock lock(&function_asts_guard_);
+  auto it = function_asts_.find(function);
+  if (it != function_asts_.end()) {
+    return it->second.get();
+  }
+  XLS_ASSIGN_OR_RETURN(function::Ast ast,
+                       function::Parser::ParseFunction(function));
+  auto [inserted, _] = function_asts_.emplace(
+      function, std::make_unique<function::Ast>(std::move(ast)));
+  return inserted->second.get();
+}
+
 template <typename EvalT>
 absl::StatusOr<EvalT> AbstractInterpreter<EvalT>::InterpretFunction(
     const rtl::AbstractCell<EvalT>& cell, const function::Ast& ast,
@@ -24,6 +24,7 @@
 
 #include "absl/status/statusor.h"
 #include "absl/strings/str_join.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/logging/logging.h"
 
 namespace xls {
@@ -44,6 +45,11 @@ namespace cell_lib {
   return CharStream(std::move(text));
 }
 
+/* static */ absl::StatusOr<CharStream> CharStream::FromMappedFile(
+    MappedFile file) {
+  return CharStream(std::move(file));
+}
+
 std::string TokenKindToString(TokenKind kind) {
   switch (kind) {
     case TokenKind::kIdentifier:
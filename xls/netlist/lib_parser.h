@@ -34,6 +34,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 
@@ -57,6 +58,8 @@ class CharStream {
  public:
   static absl::StatusOr<CharStream> FromPath(std::string_view path);
   static absl::StatusOr<CharStream> FromText(std::string text);
+  // Reads the contents of `file` in place, without copying them.
+  static absl::StatusOr<CharStream> FromMappedFile(MappedFile file);
 
   ~CharStream() {
     if (if_.has_value()) {
@@ -64,7 +67,17 @@ class CharStream {
     }
   }
 
-  CharStream(CharStream&& other) = default;
+  CharStream(CharStream&& other)
+      : pos_(other.pos_),
+        if_(std::move(other.if_)),
+        owned_text_(std::move(other.owned_text_)),
+        mapped_file_(std::move(other.mapped_file_)),
+        cursor_(other.cursor_),
+        last_colno_(other.last_colno_) {
+    // Moving may have relocated the owned text.
+    text_ = mapped_file_.has_value() ? mapped_file_->contents()
+                                     : std::string_view(owned_text_);
+  }
 
   Pos GetPos() const { return pos_; }
   bool AtEof() const {
@@ -117,7 +130,10 @@ class CharStream {
  private:
   explicit CharStream(std::ifstream file_stream)
       : if_(std::move(file_stream)) {}
-  explicit CharStream(std::string text) : text_(std::move(text)) {}
+  explicit CharStream(std::string text)
+      : owned_text_(std::move(text)), text_(owned_text_) {}
+  explicit CharStream(MappedFile file)
+      : mapped_file_(std::move(file)), text_(mapped_file_->contents()) {}
 
   void Unget(char c) {
     cursor_--;
@@ -150,8 +166,10 @@ class CharStream {
   // ifstream mode
   std::optional<std::ifstream> if_;
 
-  // text mode
-  std::string text_;
+  // text mode, over either owned text or a mapped file.
+  std::string owned_text_;
+  std::optional<MappedFile> mapped_file_;
+  std::string_view text_;
   int64_t cursor_ = 0;
   int64_t last_colno_ = 0;
 };
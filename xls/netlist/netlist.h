@@ -166,11 +166,16 @@ template <typename EvalT>
 class AbstractNetDef {
  public:
   explicit AbstractNetDef(std::string_view name,
-                          NetDeclKind kind = NetDeclKind::kWire)
-      : name_(name), kind_(kind) {}
+                          NetDeclKind kind = NetDeclKind::kWire, int64_t id = 0)
+      : name_(name), kind_(kind), id_(id) {}
 
   const std::string& name() const { return name_; }
 
+  // Dense identifier of the net within its module: the index of the net in
+  // AbstractModule::nets(). Clients can use it to index vectors rather than
+  // hashing net pointers or names.
+  int64_t id() const { return id_; }
+
   // Called to note that a cell is connected to this net.
   void NoteConnectedCell(AbstractCell<EvalT>* cell) {
     connected_cells_.push_back(cell);
@@ -208,6 +213,7 @@ class AbstractNetDef {
   // connected_cells_--all pointes in the former are also in the latter..
   std::vector<AbstractCell<EvalT>*> connected_input_cells_;
   NetDeclKind kind_;
+  int64_t id_;
 };
 
 using NetDef = AbstractNetDef<>;
@@ -475,7 +481,9 @@ class AbstractModule {
   absl::flat_hash_map<AbstractNetRef<EvalT>, AbstractNetRef<EvalT>>
       assign_nets_;
   std::vector<std::unique_ptr<AbstractNetDef<EvalT>>> nets_;
-  absl::flat_hash_map<std::string, AbstractNetRef<EvalT>> name_to_netref_;
+  // Keyed by views of the names held by the nets themselves so each net name
+  // is stored once.
+  absl::flat_hash_map<std::string_view, AbstractNetRef<EvalT>> name_to_netref_;
   std::vector<std::unique_ptr<AbstractCell<EvalT>>> cells_;
   absl::flat_hash_map<std::string, AbstractCell<EvalT>*> name_to_cell_;
   AbstractNetRef<EvalT> zero_;
@@ -613,9 +621,10 @@ absl::Status AbstractModule<EvalT>::AddNetDecl(NetDeclKind kind,
     return absl::OkStatus();
   }
 
-  nets_.emplace_back(std::make_unique<AbstractNetDef<EvalT>>(name, kind));
+  nets_.emplace_back(
+      std::make_unique<AbstractNetDef<EvalT>>(name, kind, nets_.size()));
   AbstractNetRef<EvalT> ref = nets_.back().get();
-  name_to_netref_[name] = ref;
+  name_to_netref_[ref->name()] = ref;
   switch (kind) {
     case NetDeclKind::kInput:
       input_nets_.push_back(ref);
@@ -83,6 +83,27 @@ endmodule)";
   EXPECT_EQ("baz", baz->name());
 }
 
+TEST(NetlistParserTest, NetIdsAreDense) {
+  std::string netlist = R"(module main(a, b);
+  input a;
+  output b;
+  wire foo, bar;
+endmodule)";
+  Scanner scanner(netlist);
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Netlist> n,
+                           Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* m, n->GetModule("main"));
+
+  for (int64_t i = 0; i < m->nets().size(); ++i) {
+    EXPECT_EQ(m->nets()[i]->id(), i);
+    XLS_ASSERT_OK_AND_ASSIGN(NetRef net, m->ResolveNet(m->nets()[i]->name()));
+    EXPECT_EQ(net, m->nets()[i].get());
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(NetRef bar, m->ResolveNet("bar"));
+  EXPECT_EQ(m->nets()[bar->id()].get(), bar);
+}
+
 TEST(NetlistParserTest, Attributes) {
   std::string netlist = R"((* on_module  = "foo" *)
 module main(_a, z);
@@ -0,0 +1,98 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/packed_interpreter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/netlist/compiled_netlist.h"
+#include "xls/netlist/interpreter.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+using PackedEvaluateFn =
+    std::function<absl::StatusOr<AbstractNetRef2Value<PackedBool>>(
+        const AbstractNetRef2Value<PackedBool>&)>;
+
+absl::StatusOr<std::vector<PackedNetRef2Bool>> EvaluateBatch(
+    const rtl::AbstractModule<PackedBool>* module,
+    absl::Span<const PackedNetRef2Bool> input_vectors,
+    const PackedEvaluateFn& evaluate) {
+  std::vector<PackedNetRef2Bool> results;
+  results.reserve(input_vectors.size());
+  for (int64_t start = 0; start < input_vectors.size();
+       start += PackedBool::kLaneCount) {
+    int64_t lane_count = std::min<int64_t>(PackedBool::kLaneCount,
+                                           input_vectors.size() - start);
+    AbstractNetRef2Value<PackedBool> packed_inputs;
+    for (const rtl::AbstractNetRef<PackedBool> input : module->inputs()) {
+      uint64_t lanes = 0;
+      for (int64_t lane = 0; lane < lane_count; ++lane) {
+        const PackedNetRef2Bool& vector = input_vectors[start + lane];
+        auto it = vector.find(input);
+        XLS_RET_CHECK(it != vector.end())
+            << "Missing value for input " << input->name() << " in vector "
+            << start + lane;
+        lanes |= static_cast<uint64_t>(it->second) << lane;
+      }
+      packed_inputs.emplace(input, PackedBool::FromLanes(lanes));
+    }
+
+    XLS_ASSIGN_OR_RETURN(AbstractNetRef2Value<PackedBool> packed_outputs,
+                         evaluate(packed_inputs));
+    for (int64_t lane = 0; lane < lane_count; ++lane) {
+      PackedNetRef2Bool& outputs = results.emplace_back();
+      for (const auto& [output, value] : packed_outputs) {
+        outputs[output] = value.lane(lane);
+      }
+    }
+  }
+  return results;
+}
+
+}  // namespace
+
+absl::StatusOr<std::vector<PackedNetRef2Bool>> InterpretModuleBatch(
+    PackedInterpreter& interpreter,
+    const rtl::AbstractModule<PackedBool>* module,
+    absl::Span<const PackedNetRef2Bool> input_vectors) {
+  return EvaluateBatch(
+      module, input_vectors,
+      [&](const AbstractNetRef2Value<PackedBool>& inputs) {
+        return interpreter.InterpretModule(module, inputs);
+      });
+}
+
+absl::StatusOr<std::vector<PackedNetRef2Bool>> InterpretModuleBatch(
+    const PackedCompiledModule& compiled,
+    absl::Span<const PackedNetRef2Bool> input_vectors) {
+  return EvaluateBatch(
+      compiled.module(), input_vectors,
+      [&](const AbstractNetRef2Value<PackedBool>& inputs) {
+        return compiled.InterpretModule(inputs);
+      });
+}
+
+}  // namespace netlist
+}  // namespace xls
@@ -0,0 +1,99 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NETLIST_PACKED_INTERPRETER_H_
+#define XLS_NETLIST_PACKED_INTERPRETER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/netlist/compiled_netlist.h"
+#include "xls/netlist/interpreter.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+
+// The values of a netlist signal for PackedBool::kLaneCount independent input
+// vectors ("lanes") packed into a single word, one lane per bit. The logical
+// operators act lane-wise so interpreting a netlist with PackedBool values
+// simulates every lane with a single evaluation of each cell.
+//
+// Cells must be defined by functions (or by cell evaluation functions); cells
+// defined only by state tables cannot be evaluated with packed values.
+class PackedBool {
+ public:
+  static constexpr int64_t kLaneCount = 64;
+
+  PackedBool() : lanes_(0) {}
+
+  // Returns a value with every lane equal to `value`.
+  explicit PackedBool(bool value) : lanes_(value ? ~uint64_t{0} : 0) {}
+
+  // Returns a value whose lane `i` is bit `i` of `lanes`.
+  static PackedBool FromLanes(uint64_t lanes) {
+    PackedBool result;
+    result.lanes_ = lanes;
+    return result;
+  }
+
+  uint64_t lanes() const { return lanes_; }
+  bool lane(int64_t i) const { return (lanes_ >> i) & 1; }
+
+  PackedBool operator&(const PackedBool& rhs) const {
+    return FromLanes(lanes_ & rhs.lanes_);
+  }
+  PackedBool operator|(const PackedBool& rhs) const {
+    return FromLanes(lanes_ | rhs.lanes_);
+  }
+  PackedBool operator^(const PackedBool& rhs) const {
+    return FromLanes(lanes_ ^ rhs.lanes_);
+  }
+  PackedBool operator!() const { return FromLanes(~lanes_); }
+
+  bool operator==(const PackedBool& rhs) const { return lanes_ == rhs.lanes_; }
+  bool operator!=(const PackedBool& rhs) const { return lanes_ != rhs.lanes_; }
+
+ private:
+  uint64_t lanes_;
+};
+
+using PackedInterpreter = AbstractInterpreter<PackedBool>;
+using PackedCompiledModule = AbstractCompiledModule<PackedBool>;
+using PackedNetRef2Bool =
+    absl::flat_hash_map<const rtl::AbstractNetRef<PackedBool>, bool>;
+
+// Interprets `module` for each of `input_vectors` where `input_vectors[i]`
+// holds the value of every module input in the i-th vector. Returns the values
+// of the module outputs for each vector. The vectors are packed into
+// PackedBool lanes so PackedBool::kLaneCount of them are simulated per
+// evaluation of the module.
+absl::StatusOr<std::vector<PackedNetRef2Bool>> InterpretModuleBatch(
+    PackedInterpreter& interpreter,
+    const rtl::AbstractModule<PackedBool>* module,
+    absl::Span<const PackedNetRef2Bool> input_vectors);
+
+// As above, but evaluates the precompiled `compiled` module, which avoids
+// rediscovering the evaluation order of the cells for every group of lanes.
+absl::StatusOr<std::vector<PackedNetRef2Bool>> InterpretModuleBatch(
+    const PackedCompiledModule& compiled,
+    absl::Span<const PackedNetRef2Bool> input_vectors);
+
+}  // namespace netlist
+}  // namespace xls
+
+#endif  // XLS_NETLIST_PACKED_INTERPRETER_H_
@@ -0,0 +1,176 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/packed_interpreter.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/function_extractor.h"
+#include "xls/netlist/lib_parser.h"
+#include "xls/netlist/netlist.h"
+#include "xls/netlist/netlist_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+constexpr std::string_view kLibertySrc = R"lib(
+library(notandor) {
+  cell(and2) {
+    pin(A) {
+      direction : input;
+    }
+    pin(B) {
+      direction : input;
+    }
+    pin(Y) {
+      direction: output;
+      function : "(A * B)";
+    }
+  }
+  cell(or2) {
+    pin(A) {
+      direction : input;
+    }
+    pin(B) {
+      direction : input;
+    }
+    pin(Y) {
+      direction: output;
+      function : "(A + B)";
+    }
+  }
+  cell(not1) {
+    pin(A) {
+      direction : input;
+    }
+    pin(Y) {
+      direction : output;
+      function : "A'";
+    }
+  }
+}
+)lib";
+
+// out = (x ^ y) | !z
+constexpr std::string_view kNetlistSrc = R"(
+module m(x, y, z, out);
+  wire _0_;
+  wire _1_;
+  wire _2_;
+  wire _3_;
+  wire _4_;
+  output out;
+  input x;
+  input y;
+  input z;
+  or2 _5_ (
+    .A(x),
+    .B(y),
+    .Y(_0_)
+  );
+  and2 _6_ (
+    .A(x),
+    .B(y),
+    .Y(_1_)
+  );
+  not1 _7_ (
+    .A(_1_),
+    .Y(_2_)
+  );
+  and2 _8_ (
+    .A(_0_),
+    .B(_2_),
+    .Y(_3_)
+  );
+  not1 _9_ (
+    .A(z),
+    .Y(_4_)
+  );
+  or2 _10_ (
+    .A(_3_),
+    .B(_4_),
+    .Y(out)
+  );
+endmodule
+)";
+
+TEST(PackedInterpreterTest, PackedBoolOperatorsAreLaneWise) {
+  PackedBool a = PackedBool::FromLanes(0b1100);
+  PackedBool b = PackedBool::FromLanes(0b1010);
+  EXPECT_EQ((a & b).lanes(), 0b1000);
+  EXPECT_EQ((a | b).lanes(), 0b1110);
+  EXPECT_EQ((a ^ b).lanes(), 0b0110);
+  EXPECT_EQ((!a).lanes(), ~uint64_t{0b1100});
+  EXPECT_EQ(PackedBool(true).lanes(), ~uint64_t{0});
+  EXPECT_TRUE(a.lane(2));
+  EXPECT_FALSE(a.lane(1));
+}
+
+TEST(PackedInterpreterTest, InterpretModuleBatch) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto stream, cell_lib::CharStream::FromText(std::string(kLibertySrc)));
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto proto,
+                           function::ExtractFunctions(&stream));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      AbstractCellLibrary<PackedBool> cell_library,
+      AbstractCellLibrary<PackedBool>::FromProto(proto, PackedBool(false),
+                                                 PackedBool(true)));
+  rtl::Scanner scanner(kNetlistSrc);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<rtl::AbstractNetlist<PackedBool>> netlist,
+      rtl::AbstractParser<PackedBool>::ParseNetlist(
+          &cell_library, &scanner, PackedBool(false), PackedBool(true)));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::AbstractModule<PackedBool>* module,
+                           netlist->GetModule("m"));
+  rtl::AbstractNetRef<PackedBool> x = module->inputs()[0];
+  rtl::AbstractNetRef<PackedBool> y = module->inputs()[1];
+  rtl::AbstractNetRef<PackedBool> z = module->inputs()[2];
+  rtl::AbstractNetRef<PackedBool> out = module->outputs()[0];
+
+  // More vectors than lanes so the last batch is partial.
+  std::vector<PackedNetRef2Bool> inputs;
+  for (int64_t i = 0; i < 100; ++i) {
+    inputs.push_back({{x, (i & 1) != 0}, {y, (i & 2) != 0}, {z, i % 3 == 0}});
+  }
+
+  PackedInterpreter interpreter(netlist.get(), PackedBool(false),
+                                PackedBool(true));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<PackedNetRef2Bool> outputs,
+                           InterpretModuleBatch(interpreter, module, inputs));
+  ASSERT_EQ(outputs.size(), inputs.size());
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    bool expected = (inputs[i].at(x) != inputs[i].at(y)) || !inputs[i].at(z);
+    EXPECT_EQ(outputs[i].at(out), expected) << "vector " << i;
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PackedCompiledModule compiled,
+      PackedCompiledModule::Compile(netlist.get(), module, PackedBool(false),
+                                    PackedBool(true)));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<PackedNetRef2Bool> compiled_outputs,
+                           InterpretModuleBatch(compiled, inputs));
+  EXPECT_EQ(compiled_outputs, outputs);
+}
+
+}  // namespace
+}  // namespace netlist
+}  // namespace xls
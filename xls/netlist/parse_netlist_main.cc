@@ -22,6 +22,7 @@
 #include "absl/strings/str_format.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
@@ -44,8 +45,10 @@ absl::Status RealMain(std::string_view netlist_path,
                          netlist::CellLibrary::FromProto(cell_library_proto));
   }
 
-  XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
-  netlist::rtl::Scanner scanner(netlist_text);
+  // The netlist is mapped rather than read so large netlists are paged in as
+  // they are scanned.
+  XLS_ASSIGN_OR_RETURN(MappedFile netlist_file, MappedFile::Open(netlist_path));
+  netlist::rtl::Scanner scanner(netlist_file.contents());
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<netlist::rtl::Netlist> netlist,
       netlist::rtl::Parser::ParseNetlist(&cell_library, &scanner));
@@ -15,13 +15,19 @@
 #include "xls/noc/drivers/experiment.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/variant.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/thread.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/global_routing_table.h"
 #include "xls/noc/simulation/network_graph.h"
@@ -171,6 +177,7 @@ absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
   NocSimulator simulator;
   XLS_RET_CHECK_OK(simulator.Initialize(graph, params, routing_table,
                                         graph.GetNetworkIds()[0]));
+  XLS_RET_CHECK_OK(simulator.PartitionNetwork(partition_count_));
   simulator.Dump();
 
   // Hook traffic injector and simulator together.
@@ -183,8 +190,12 @@ absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
   simulator.RegisterPostCycleService(link_monitor);
 
   // Run simulation.
-  for (int64_t i = 0; i < total_simulation_cycle_count_; ++i) {
+  while (simulator.GetCurrentCycle() + 1 < total_simulation_cycle_count_) {
     XLS_RET_CHECK_OK(simulator.RunCycle());
+    if (fast_forward_idle_cycles_) {
+      XLS_RETURN_IF_ERROR(
+          simulator.FastForward(total_simulation_cycle_count_ - 1).status());
+    }
   }
 
   // Obtain metrics.  For now, the runner will measure traffic rate
@@ -323,4 +334,67 @@ absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
   return experiment_data;
 }
 
+absl::Status Experiment::RunSteps(
+    int64_t thread_count, const StepCallback& on_step_done,
+    const RoutingTableBuilderFactory& routing_table_builder_factory) const {
+  XLS_RET_CHECK_GT(thread_count, 0);
+  int64_t step_count = GetStepCount();
+
+  std::atomic<int64_t> next_step = 0;
+  absl::Mutex mutex;
+  absl::Status status;
+  auto run_steps = [&]() {
+    while (true) {
+      {
+        absl::MutexLock lock(&mutex);
+        if (!status.ok()) {
+          return;
+        }
+      }
+      int64_t step = next_step.fetch_add(1);
+      if (step >= step_count) {
+        return;
+      }
+      std::unique_ptr<DistributedRoutingTableBuilderBase> builder =
+          routing_table_builder_factory();
+      absl::StatusOr<ExperimentData> data = RunStep(step, std::move(*builder));
+
+      absl::MutexLock lock(&mutex);
+      if (!status.ok()) {
+        return;
+      }
+      status = data.ok() ? on_step_done(step, std::move(data).value())
+                         : data.status();
+    }
+  };
+
+  // The calling thread runs steps too.
+  std::vector<std::unique_ptr<Thread>> workers;
+  for (int64_t i = 1; i < std::min(thread_count, step_count); ++i) {
+    workers.push_back(std::make_unique<Thread>(run_steps));
+  }
+  run_steps();
+  for (std::unique_ptr<Thread>& worker : workers) {
+    worker->Join();
+  }
+
+  return status;
+}
+
+absl::StatusOr<std::vector<ExperimentData>> Experiment::RunAllSteps(
+    int64_t thread_count,
+    const RoutingTableBuilderFactory& routing_table_builder_factory) const {
+  std::vector<ExperimentData> experiment_data(GetStepCount());
+  XLS_RETURN_IF_ERROR(RunSteps(
+      thread_count,
+      [&](int64_t step, ExperimentData data) {
+        XLS_LOG(INFO) << absl::StreamFormat("Finished experiment step %d",
+                                            step);
+        experiment_data.at(step) = std::move(data);
+        return absl::OkStatus();
+      },
+      routing_table_builder_factory));
+  return experiment_data;
+}
+
 }  // namespace xls::noc
@@ -15,8 +15,10 @@
 #ifndef XLS_NOC_EXPERIMENT_H_
 #define XLS_NOC_EXPERIMENT_H_
 
+#include <cstdint>
 #include <functional>
 #include <limits>
+#include <memory>
 #include <queue>
 #include <string>
 #include <string_view>
@@ -247,18 +249,37 @@ class ExperimentRunner {
     return *this;
   }
 
+  // Sets the number of partitions (and so threads) the network is simulated
+  // with; see NocSimulator::PartitionNetwork(). Results don't depend on it.
+  ExperimentRunner& SetSimulationPartitionCount(int64_t count) {
+    XLS_CHECK_GT(count, 0);
+    partition_count_ = count;
+    return *this;
+  }
+
+  // Enables skipping cycles in which the network is idle and no traffic is
+  // injected; see NocSimulator::FastForward(). Results don't depend on it.
+  ExperimentRunner& SetFastForwardIdleCycles(bool enable) {
+    fast_forward_idle_cycles_ = enable;
+    return *this;
+  }
+
   int64_t GetSimulationCycleCount() const {
     return total_simulation_cycle_count_;
   }
   int64_t GetCycleTimeInPs() const { return cycle_time_in_ps_; }
 
   int16_t GetSeed() const { return seed_; }
+  int64_t GetSimulationPartitionCount() const { return partition_count_; }
+  bool GetFastForwardIdleCycles() const { return fast_forward_idle_cycles_; }
   std::string_view GetTrafficMode() const { return mode_name_; }
 
  private:
   int64_t total_simulation_cycle_count_;
   int64_t cycle_time_in_ps_;
   int16_t seed_;
+  int64_t partition_count_ = 1;
+  bool fast_forward_idle_cycles_ = false;
 
   std::string mode_name_;
 };
@@ -291,6 +312,34 @@ class Experiment {
                                 std::move(distributed_routing_table_builder));
   }
 
+  // Creates the routing table builder used to run a step.
+  using RoutingTableBuilderFactory =
+      std::function<std::unique_ptr<DistributedRoutingTableBuilderBase>()>;
+
+  // Called with each step index and its results as the step completes.
+  using StepCallback =
+      std::function<absl::Status(int64_t step, ExperimentData data)>;
+
+  // Runs every step of the experiment, up to "thread_count" at a time.
+  //
+  // Each step is run as by RunStep(), building its own network, simulator and
+  // random number generator seeded from the runner, so the results of a step
+  // don't depend on the thread count or on the order steps are run in.
+  //
+  // "on_step_done" is called for each step in order of completion, one call
+  // at a time, from the thread that ran the step. Once any step or callback
+  // fails no further steps are started and the first error is returned.
+  absl::Status RunSteps(int64_t thread_count, const StepCallback& on_step_done,
+                        const RoutingTableBuilderFactory&
+                            routing_table_builder_factory =
+                                DefaultRoutingTableBuilderFactory) const;
+
+  // Runs every step as RunSteps() does and returns the results in step order.
+  absl::StatusOr<std::vector<ExperimentData>> RunAllSteps(
+      int64_t thread_count,
+      const RoutingTableBuilderFactory& routing_table_builder_factory =
+          DefaultRoutingTableBuilderFactory) const;
+
   // Get the configuration for step N.
   absl::StatusOr<ExperimentConfig> GetConfigForStep(int64_t step) const {
     XLS_RET_CHECK(step >= 0 && step < GetStepCount());
@@ -316,6 +365,11 @@ class Experiment {
  private:
   friend ExperimentBuilderBase;
 
+  static std::unique_ptr<DistributedRoutingTableBuilderBase>
+  DefaultRoutingTableBuilderFactory() {
+    return std::make_unique<DistributedRoutingTableBuilderForTrees>();
+  }
+
   ExperimentConfig config_;
   ExperimentSweeps sweeps_;
   ExperimentRunner runner_;
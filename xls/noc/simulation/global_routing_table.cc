@@ -14,7 +14,10 @@
 
 #include "xls/noc/simulation/global_routing_table.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <iterator>
+#include <optional>
 #include <ostream>
 #include <queue>
 #include <sstream>
@@ -29,6 +32,8 @@
 #include "absl/strings/str_format.h"
 #include "absl/types/variant.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/noc/config/network_config.pb.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/network_graph.h"
@@ -176,12 +181,17 @@ absl::StatusOr<PortAndVCIndex> DistributedRoutingTable::GetRouterOutputPort(
 absl::StatusOr<PortAndVCIndex>
 DistributedRoutingTable::GetRouterOutputPortByIndex(PortAndVCIndex from,
                                                     int64_t destination_index) {
-  PortRoutingList& routes = GetRoutingList(from);
-
-  for (std::pair<int64_t, PortAndVCIndex>& hop : routes) {
-    if (hop.first == destination_index) {
-      return hop.second;
-    }
+  const PortRoutingList& routes = GetRoutingList(from);
+
+  // Find the last range starting at or before the destination.
+  auto range = std::upper_bound(
+      routes.begin(), routes.end(), destination_index,
+      [](int64_t index, const RouteRange& r) {
+        return index < r.first_destination_index;
+      });
+  if (range != routes.begin() &&
+      std::prev(range)->last_destination_index >= destination_index) {
+    return std::prev(range)->hop;
   }
 
   XLS_ASSIGN_OR_RETURN(
@@ -202,7 +212,7 @@ DistributedRoutingTable::GetRouterOutputPortByIndex(PortAndVCIndex from,
 absl::Status DistributedRoutingTable::DumpRouterRoutingTable(
     NetworkId network_id) const {
   const Network& network = network_manager_->GetNetwork(network_id);
-  std::vector<RouterRoutingTable> nc_routing_tables =
+  const std::vector<RouterRoutingTable>& nc_routing_tables =
       routing_tables_.at(network_id.id());
   XLS_ASSIGN_OR_RETURN(NetworkParam network_param,
                        network_parameters_->GetNetworkParam(network_id));
@@ -218,7 +228,8 @@ absl::Status DistributedRoutingTable::DumpRouterRoutingTable(
                   << std::get<RouterParam>(nc_param).GetName();
     XLS_LOG(INFO) << "Input Port Name | Input VC Name | Sink Name | Output "
                      "Port Name | Output VC Name";
-    RouterRoutingTable& router_routing_table = nc_routing_tables.at(nc_id.id());
+    const RouterRoutingTable& router_routing_table =
+        nc_routing_tables.at(nc_id.id());
     for (PortId input_port_id : nc.GetInputPortIds()) {
       XLS_ASSIGN_OR_RETURN(PortParam input_port_param,
                            network_parameters_->GetPortParam(input_port_id));
@@ -239,24 +250,29 @@ absl::Status DistributedRoutingTable::DumpRouterRoutingTable(
         }
         const PortRoutingList& routes =
             router_routing_table.routes.at(input_port_id.id()).at(vc_index);
-        for (auto& [destination_index, port_id_vc_index] : routes) {
-          XLS_ASSIGN_OR_RETURN(
-              NetworkComponentId sink_id,
-              sink_indices_.GetNetworkComponentByIndex(destination_index));
-          XLS_ASSIGN_OR_RETURN(
-              NetworkComponentParam sink_param,
-              network_parameters_->GetNetworkComponentParam(sink_id));
+        for (const RouteRange& range : routes) {
+          const PortAndVCIndex& port_id_vc_index = range.hop;
           XLS_ASSIGN_OR_RETURN(
               PortParam output_port_param,
               network_parameters_->GetPortParam(port_id_vc_index.port_id_));
           std::string_view output_port_name = output_port_param.GetName();
           std::vector<VirtualChannelParam> output_vc_params =
               output_port_param.GetVirtualChannels();
-          XLS_LOG(INFO)
-              << input_port_name << "   " << vc_name << "   "
-              << std::get<NetworkInterfaceSinkParam>(sink_param).GetName()
-              << "   " << output_port_name << "   "
-              << output_vc_params.at(port_id_vc_index.vc_index_).GetName();
+          for (int64_t destination_index = range.first_destination_index;
+               destination_index <= range.last_destination_index;
+               ++destination_index) {
+            XLS_ASSIGN_OR_RETURN(
+                NetworkComponentId sink_id,
+                sink_indices_.GetNetworkComponentByIndex(destination_index));
+            XLS_ASSIGN_OR_RETURN(
+                NetworkComponentParam sink_param,
+                network_parameters_->GetNetworkComponentParam(sink_id));
+            XLS_LOG(INFO)
+                << input_port_name << "   " << vc_name << "   "
+                << std::get<NetworkInterfaceSinkParam>(sink_param).GetName()
+                << "   " << output_port_name << "   "
+                << output_vc_params.at(port_id_vc_index.vc_index_).GetName();
+          }
         }
       }
     }
@@ -275,6 +291,83 @@ void DistributedRoutingTable::AllocateTableForNetwork(NetworkId network_id,
   routing_tables_[network_index].resize(component_count);
 }
 
+absl::Status DistributedRoutingTable::AllocateDenseRoutesForNetwork(
+    NetworkId network_id) {
+  int64_t destination_count = sink_indices_.NetworkComponentCount();
+
+  for (NetworkComponent& nc :
+       network_manager_->GetNetwork(network_id).GetNetworkComponents()) {
+    if (nc.kind() != NetworkComponentKind::kRouter) {
+      continue;
+    }
+
+    RouterRoutingTable& table = GetRoutingTable(nc.id());
+    table.routes.resize(nc.GetPortCount());
+    table.dense_routes.resize(nc.GetPortCount());
+
+    for (PortId input_port_id : nc.GetInputPortIds()) {
+      XLS_ASSIGN_OR_RETURN(PortParam input_port_param,
+                           network_parameters_->GetPortParam(input_port_id));
+      // Ports without vcs are routed using a single default vc.
+      int64_t vc_count =
+          std::max(input_port_param.VirtualChannelCount(), int64_t{1});
+      table.routes[input_port_id.id()].resize(vc_count);
+      table.dense_routes[input_port_id.id()].assign(
+          vc_count, DenseRoutingList(destination_count));
+    }
+  }
+
+  return absl::OkStatus();
+}
+
+void DistributedRoutingTable::SetRoute(PortAndVCIndex from,
+                                       int64_t destination_index,
+                                       PortAndVCIndex hop) {
+  NetworkComponentId nc_id = from.port_id_.GetNetworkComponentId();
+  GetRoutingTable(nc_id)
+      .dense_routes.at(from.port_id_.id())
+      .at(from.vc_index_)
+      .at(destination_index) = hop;
+}
+
+void DistributedRoutingTable::CompressRoutesForNetwork(NetworkId network_id) {
+  std::vector<RouterRoutingTable>& tables = routing_tables_.at(network_id.id());
+
+  ParallelFor(0, tables.size(), [&](int64_t nc_index) {
+    RouterRoutingTable& table = tables[nc_index];
+    for (int64_t port_index = 0; port_index < table.dense_routes.size();
+         ++port_index) {
+      for (int64_t vc_index = 0;
+           vc_index < table.dense_routes[port_index].size(); ++vc_index) {
+        const DenseRoutingList& dense =
+            table.dense_routes[port_index][vc_index];
+        PortRoutingList& routes = table.routes[port_index][vc_index];
+        routes.clear();
+        for (int64_t i = 0; i < dense.size(); ++i) {
+          if (!dense[i].has_value()) {
+            continue;
+          }
+          // Extend the previous range if it ends just before this destination
+          // and leads to the same hop.
+          if (!routes.empty() &&
+              routes.back().last_destination_index == i - 1 &&
+              routes.back().hop.port_id_ == dense[i]->port_id_ &&
+              routes.back().hop.vc_index_ == dense[i]->vc_index_) {
+            routes.back().last_destination_index = i;
+          } else {
+            routes.push_back(RouteRange{.first_destination_index = i,
+                                        .last_destination_index = i,
+                                        .hop = *dense[i]});
+          }
+        }
+        routes.shrink_to_fit();
+      }
+    }
+    table.dense_routes.clear();
+    table.dense_routes.shrink_to_fit();
+  });
+}
+
 absl::Status DistributedRoutingTableBuilderBase::BuildNetworkInterfaceIndices(
     NetworkId network_id, DistributedRoutingTable* routing_table) {
   NetworkComponentIndexMapBuilder source_index_builder;
@@ -380,22 +473,37 @@ absl::Status DistributedRoutingTableBuilderForTrees::BuildRoutingTable(
       network_manager->GetNetwork(network_id).GetNetworkComponentCount();
 
   routing_table->AllocateTableForNetwork(network_id, component_count);
+  XLS_RETURN_IF_ERROR(
+      routing_table->AllocateDenseRoutesForNetwork(network_id));
 
   const NetworkComponentIndexMap& sink_indices =
       routing_table->GetSinkIndices();
 
   // Algorithm:
-  //  For each sink
+  //  For each sink (in parallel)
   //   Perform DFS to srcs
   //     Record hop needed to reach destination
-  for (int64_t i = 0; i < sink_indices.NetworkComponentCount(); ++i) {
-    XLS_ASSIGN_OR_RETURN(NetworkComponentId sink_id,
-                         sink_indices.GetNetworkComponentByIndex(i));
+  //
+  // Each sink only writes the routes to its own destination index, so sinks
+  // do not contend on the routing tables.
+  std::vector<absl::Status> statuses(sink_indices.NetworkComponentCount());
+  ParallelFor(0, sink_indices.NetworkComponentCount(), [&](int64_t i) {
+    absl::StatusOr<NetworkComponentId> sink_id =
+        sink_indices.GetNetworkComponentByIndex(i);
+    if (!sink_id.ok()) {
+      statuses[i] = sink_id.status();
+      return;
+    }
     absl::flat_hash_set<NetworkComponentId> visited_components;
-    XLS_RET_CHECK_OK(AddRoutes(i, sink_id, PortId::kInvalid, routing_table,
-                               visited_components));
+    statuses[i] = AddRoutes(i, *sink_id, PortId::kInvalid, routing_table,
+                            visited_components);
+  });
+  for (const absl::Status& status : statuses) {
+    XLS_RET_CHECK_OK(status);
   }
 
+  routing_table->CompressRoutesForNetwork(network_id);
+
   return absl::OkStatus();
 }
 
@@ -413,11 +521,6 @@ absl::Status DistributedRoutingTableBuilderForTrees::AddRoutes(
   }
 
   if (nc.kind() == NetworkComponentKind::kRouter) {
-    // Size routing table appropriately.
-    DistributedRoutingTable::RouterRoutingTable& table =
-        routing_table->GetRoutingTable(nc_id);
-    table.routes.resize(nc.GetPortCount());
-
     // Update routing table.
     for (Port& port : nc.GetPorts()) {
       if (port.direction() == PortDirection::kInput) {
@@ -442,19 +545,19 @@ absl::Status DistributedRoutingTableBuilderForTrees::AddRoutes(
         if (from_port_param.VirtualChannelCount() == 0 &&
             via_port_param.VirtualChannelCount() == 0) {
           int64_t default_vc = 0;
-          table.routes[from_port.id()].resize(1);
-          table.routes[from_port.id()][default_vc].emplace_back(
-              destination_index, PortAndVCIndex{via_port, default_vc});
+          routing_table->SetRoute(PortAndVCIndex{from_port, default_vc},
+                                  destination_index,
+                                  PortAndVCIndex{via_port, default_vc});
         } else {
           // VCs are mapped in-order,
           // ie traffic is rounded from the vc at index 0 to the
           //    vc at index 0 of the next port.
           // TODO(tedhong): 2020-01-15 Update this to use global virtual
           //                           channels to allow for more flexibility.
-          table.routes[from_port.id()].resize(from_port_vc_count);
           for (int64_t i = 0; i < from_port_vc_count; ++i) {
-            table.routes[from_port.id()][i].emplace_back(
-                destination_index, PortAndVCIndex{via_port, i});
+            routing_table->SetRoute(PortAndVCIndex{from_port, i},
+                                    destination_index,
+                                    PortAndVCIndex{via_port, i});
           }
         }
       }
@@ -588,6 +691,8 @@ absl::Status DistributedRoutingTableBuilderForMultiplePaths::BuildRoutingTable(
       network_manager->GetNetwork(network_id).GetNetworkComponentCount();
 
   routing_table->AllocateTableForNetwork(network_id, component_count);
+  XLS_RETURN_IF_ERROR(
+      routing_table->AllocateDenseRoutesForNetwork(network_id));
 
   Network& network = network_manager->GetNetwork(network_id);
 
@@ -595,18 +700,30 @@ absl::Status DistributedRoutingTableBuilderForMultiplePaths::BuildRoutingTable(
       routing_table->GetSinkIndices();
 
   // Algorithm:
-  //  For each sink
+  //  For each sink (in parallel)
   //   Perform BFS to srcs
-  for (int64_t i = 0; i < sink_indices.NetworkComponentCount(); ++i) {
-    XLS_ASSIGN_OR_RETURN(NetworkComponentId sink_id,
-                         sink_indices.GetNetworkComponentByIndex(i));
-    absl::flat_hash_map<NetworkComponentId, std::vector<PortId>> nc_ports_map;
-    XLS_ASSIGN_OR_RETURN(
-        nc_ports_map,
-        CalculateRoutes(network, sink_id, *routing_table->network_parameters_));
-    XLS_RET_CHECK_OK(AddRoutes(i, network, nc_ports_map, routing_table));
+  //
+  // Each sink only writes the routes to its own destination index, so sinks
+  // do not contend on the routing tables.
+  std::vector<absl::Status> statuses(sink_indices.NetworkComponentCount());
+  ParallelFor(0, sink_indices.NetworkComponentCount(), [&](int64_t i) {
+    statuses[i] = [&]() -> absl::Status {
+      XLS_ASSIGN_OR_RETURN(NetworkComponentId sink_id,
+                           sink_indices.GetNetworkComponentByIndex(i));
+      absl::flat_hash_map<NetworkComponentId, std::vector<PortId>>
+          nc_ports_map;
+      XLS_ASSIGN_OR_RETURN(
+          nc_ports_map, CalculateRoutes(network, sink_id,
+                                        *routing_table->network_parameters_));
+      return AddRoutes(i, network, nc_ports_map, routing_table);
+    }();
+  });
+  for (const absl::Status& status : statuses) {
+    XLS_RET_CHECK_OK(status);
   }
 
+  routing_table->CompressRoutesForNetwork(network_id);
+
   return absl::OkStatus();
 }
 
@@ -632,9 +749,6 @@ absl::Status DistributedRoutingTableBuilderForMultiplePaths::AddRoutes(
           absl::StrFormat("There are no ports for network component: %s.",
                           std::get<RouterParam>(nc_param).GetName()));
     }
-    DistributedRoutingTable::RouterRoutingTable& table =
-        routing_table->GetRoutingTable(current_nc_id);
-    table.routes.resize(nc.GetPortCount());
     const int64_t output_port_count = output_port_ids.size();
     int64_t output_port_index = 0;
     // for each input port
@@ -662,17 +776,17 @@ absl::Status DistributedRoutingTableBuilderForMultiplePaths::AddRoutes(
       if (input_port_param.VirtualChannelCount() == 0 &&
           output_port_param.VirtualChannelCount() == 0) {
         int64_t default_vc = 0;
-        table.routes[input_port_id.id()].resize(1);
-        table.routes[input_port_id.id()][default_vc].emplace_back(
-            destination_index, PortAndVCIndex{output_port_id, default_vc});
+        routing_table->SetRoute(PortAndVCIndex{input_port_id, default_vc},
+                                destination_index,
+                                PortAndVCIndex{output_port_id, default_vc});
       } else {
         // VCs are mapped in-order,
         // ie traffic is rounded from the vc at index 0 to the
         //    vc at index 0 of the next port.
-        table.routes[input_port_id.id()].resize(input_port_vc_count);
         for (int64_t i = 0; i < input_port_vc_count; ++i) {
-          table.routes[input_port_id.id()][i].emplace_back(
-              destination_index, PortAndVCIndex{output_port_id, i});
+          routing_table->SetRoute(PortAndVCIndex{input_port_id, i},
+                                  destination_index,
+                                  PortAndVCIndex{output_port_id, i});
         }
       }
       output_port_index++;
@@ -19,10 +19,14 @@
 #ifndef XLS_NOC_SIMULATION_GLOBAL_ROUTING_TABLE_H_
 #define XLS_NOC_SIMULATION_GLOBAL_ROUTING_TABLE_H_
 
+#include <cstdint>
+#include <optional>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/indexer.h"
 #include "xls/noc/simulation/network_graph.h"
@@ -51,23 +55,43 @@ class DistributedRoutingTable {
   // Stores a routing table for a single network component (ex. Router).
   //
   // For each port/vc pair, it stores the routing table as a list of
-  // tuples <destination, output_port, vc_output_index>
+  // destination ranges, each routed to a single output port and vc.
   //
   // RouterRoutingTable::routes[port_index][vc_input_index]
   //   is a PortRoutingList corresponding to the given input port and vc.
   //
   // PortRoutingList
-  //   is a list of tuples of <destination, PortAndVCIndex>
+  //   is a list of RouteRange sorted by destination index.  Contiguous
+  //   destinations routed to the same output port and vc share a single
+  //   range.
   //
   // To find the output port for a flit arriving at index and vc that has
   // a specific destination
   //   1. Retrieve the associated PortRoutingList
-  //   2. Find the tuple that matched the given destination within the list.
-  using PortRoutingList = std::vector<std::pair<int64_t, PortAndVCIndex>>;
+  //   2. Binary search for the range containing the given destination.
+  struct RouteRange {
+    int64_t first_destination_index;
+    // Inclusive.
+    int64_t last_destination_index;
+    PortAndVCIndex hop;
+  };
+
+  // See comment above.
+  using PortRoutingList = std::vector<RouteRange>;
+
+  // Routes of a port/vc pair while the routing table is being built, indexed
+  // by destination index.  Builders compute routes to different destinations
+  // in parallel, each writing only its own entries, and then compress these
+  // into PortRoutingLists.
+  using DenseRoutingList = std::vector<std::optional<PortAndVCIndex>>;
 
   // See comment above.
   struct RouterRoutingTable {
     std::vector<std::vector<PortRoutingList>> routes;
+
+    // Only populated while the routing table is being built.
+    // dense_routes[port_index][vc_input_index][destination_index].
+    std::vector<std::vector<DenseRoutingList>> dense_routes;
   };
 
   // Returns route to destination from a particular source network interface
@@ -132,6 +156,21 @@ class DistributedRoutingTable {
   // number of components in a network.
   void AllocateTableForNetwork(NetworkId network_id, int64_t component_count);
 
+  // Allocates the dense routing lists of every router in the network for
+  // all input ports, vcs and destinations.  Must be called after the sink
+  // indices have been built and before routes are added with SetRoute().
+  absl::Status AllocateDenseRoutesForNetwork(NetworkId network_id);
+
+  // Records that flits arriving at port and vc `from` with the given
+  // destination leave via `hop`.  Calls for distinct destinations may be made
+  // concurrently.
+  void SetRoute(PortAndVCIndex from, int64_t destination_index,
+                PortAndVCIndex hop);
+
+  // Compresses the dense routing lists of every component in the network into
+  // PortRoutingLists and releases them.  Components are processed in parallel.
+  void CompressRoutesForNetwork(NetworkId network_id);
+
   // Get (and create if necessary) routing table associated for a component.
   RouterRoutingTable& GetRoutingTable(NetworkComponentId nc_id) {
     return routing_tables_[nc_id.network()][nc_id.id()];
@@ -14,7 +14,9 @@
 
 #include "xls/noc/simulation/global_routing_table.h"
 
+#include <cstdint>
 #include <string_view>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -214,6 +216,55 @@ TEST(GlobalRoutingTableTest, Index) {
   EXPECT_EQ(route00[4], recvport0);
 }
 
+TEST(GlobalRoutingTableTest, RoutesToDestinationRanges) {
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_ASSERT_OK(BuildNetworkGraphTree000(&proto, &graph, &params));
+
+  DistributedRoutingTableBuilderForTrees route_builder;
+  XLS_ASSERT_OK_AND_ASSIGN(DistributedRoutingTable routing_table,
+                           route_builder.BuildNetworkRoutingTables(
+                               graph.GetNetworkIds()[0], graph, params));
+
+  XLS_ASSERT_OK_AND_ASSIGN(PortId ain0, FindPortByName("Ain0", graph, params));
+  XLS_ASSERT_OK_AND_ASSIGN(PortId aout0,
+                           FindPortByName("Aout0", graph, params));
+  XLS_ASSERT_OK_AND_ASSIGN(PortId aout1,
+                           FindPortByName("Aout1", graph, params));
+  XLS_ASSERT_OK_AND_ASSIGN(PortId bin1, FindPortByName("Bin1", graph, params));
+
+  // RecvPort1 to RecvPort3 are all reached from RouterA via Aout1 and from
+  // RouterB via distinct ports, while RecvPort0 is unreachable from RouterB.
+  std::vector<PortId> routerb_hops;
+  for (int64_t i = 0; i < 4; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        NetworkComponentId recvport,
+        FindNetworkComponentByName(absl::StrFormat("RecvPort%d", i), graph,
+                                   params));
+    for (int64_t vc = 0; vc < 2; ++vc) {
+      XLS_ASSERT_OK_AND_ASSIGN(
+          PortAndVCIndex hop,
+          routing_table.GetRouterOutputPort(PortAndVCIndex{ain0, vc},
+                                            recvport));
+      EXPECT_EQ(hop.port_id_, i == 0 ? aout0 : aout1);
+      EXPECT_EQ(hop.vc_index_, vc);
+    }
+
+    absl::StatusOr<PortAndVCIndex> routerb_hop =
+        routing_table.GetRouterOutputPort(PortAndVCIndex{bin1, 0}, recvport);
+    if (i == 0) {
+      EXPECT_THAT(routerb_hop.status(),
+                  status_testing::StatusIs(absl::StatusCode::kNotFound));
+    } else {
+      XLS_ASSERT_OK(routerb_hop.status());
+      EXPECT_THAT(routerb_hops, testing::Not(testing::Contains(
+                                    routerb_hop->port_id_)));
+      routerb_hops.push_back(routerb_hop->port_id_);
+    }
+  }
+}
+
 TEST(GlobalRoutingTableTest, RouterLoop) {
   // Build and assign simulation objects
   NetworkConfigProto proto;
@@ -15,6 +15,10 @@
 #include "xls/noc/simulation/noc_traffic_injector.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <string_view>
 #include <utility>
 #include <variant>
@@ -37,10 +41,18 @@ absl::Status NocTrafficInjector::RunCycle() {
 
   ++cycle_;
 
-  for (int64_t i = 0; i < traffic_models_.size(); ++i) {
+  // Only the flows whose traffic model may inject packets this cycle are run,
+  // in flow order.
+  while (!injection_schedule_.empty() &&
+         injection_schedule_.top().first <= cycle_) {
+    int64_t i = injection_schedule_.top().second;
+    injection_schedule_.pop();
+
     // Retrieve packets.
     std::vector<DataPacket> packets =
         traffic_models_[i]->GetNewCyclePackets(cycle_);
+    injection_schedule_.emplace(
+        std::max(traffic_models_[i]->GetNextPacketCycle(), cycle_ + 1), i);
 
     this->traffic_model_monitor_[i].AcceptNewPackets(absl::MakeSpan(packets),
                                                      cycle_);
@@ -78,6 +90,32 @@ absl::Status NocTrafficInjector::RunCycle() {
   return absl::OkStatus();
 }
 
+int64_t NocTrafficInjector::GetNextPacketCycle() const {
+  int64_t next_cycle = injection_schedule_.empty()
+                           ? std::numeric_limits<int64_t>::max()
+                           : injection_schedule_.top().first;
+  return std::max(next_cycle, cycle_ + 1);
+}
+
+absl::Status NocTrafficInjector::SkipToCycle(int64_t cycle) {
+  XLS_RET_CHECK_GT(cycle, cycle_);
+  XLS_RET_CHECK_LE(cycle, GetNextPacketCycle());
+
+  // No flow is scheduled to inject packets in the skipped cycles.  The
+  // monitors measure rates up to cycle_, so need not be told of them.
+  cycle_ = cycle - 1;
+
+  return absl::OkStatus();
+}
+
+void NocTrafficInjector::BuildInjectionSchedule() {
+  injection_schedule_ = InjectionSchedule();
+  for (int64_t i = 0; i < traffic_models_.size(); ++i) {
+    injection_schedule_.emplace(
+        std::max(traffic_models_[i]->GetNextPacketCycle(), cycle_ + 1), i);
+  }
+}
+
 namespace {
 
 // Function that calls run_action(i, j) for each flow and network_component
@@ -302,6 +340,7 @@ absl::Status NocTrafficInjectorBuilder::BuildPerFlowTrafficModels(
           std::unique_ptr<GeneralizedGeometricTrafficModel> model,
           GeneralizedGeometricTrafficModelBuilder(
               lambda, burst_prob, bits_per_packet, random_number_interface)
+              .SetSampleBatchSize(sample_batch_size_)
               .SetVCIndex(vc_index)
               .SetSourceIndex(source_index)
               .SetDestinationIndex(sink_index)
@@ -15,8 +15,11 @@
 #ifndef XLS_NOC_SIMULATION_NOC_TRAFFIC_INJECTOR_H_
 #define XLS_NOC_SIMULATION_NOC_TRAFFIC_INJECTOR_H_
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <queue>
+#include <utility>
 #include <vector>
 
 #include "absl/status/statusor.h"
@@ -46,6 +49,14 @@ class NocTrafficInjector {
   // on the current_cycle.
   absl::Status RunCycle();
 
+  // Returns the earliest cycle after the last one run in which any traffic
+  // model may inject packets.
+  int64_t GetNextPacketCycle() const;
+
+  // Skips the cycles up to "cycle", in which no traffic model injects packets,
+  // so the next RunCycle() is for "cycle".
+  absl::Status SkipToCycle(int64_t cycle);
+
   // Provides the interface between this object and the NOC simulator.
   void SetSimulatorShim(NocSimulatorTrafficServiceShim& simulator) {
     simulator_ = &simulator;
@@ -94,7 +105,7 @@ class NocTrafficInjector {
   double MeasuredTrafficRateInMiBps(int64_t cycle_time_in_ps,
                                     int64_t flow_index) const {
     return traffic_model_monitor_[flow_index].MeasuredTrafficRateInMiBps(
-        cycle_time_in_ps);
+        cycle_time_in_ps, cycle_);
   }
 
   // Get measured bits injected during simulation for a single flow.
@@ -105,6 +116,17 @@ class NocTrafficInjector {
  private:
   friend NocTrafficInjectorBuilder;
 
+  // Cycle and index of the next run of a flow, earliest cycle (then lowest
+  // index) first.
+  using InjectionSchedule =
+      std::priority_queue<std::pair<int64_t, int64_t>,
+                          std::vector<std::pair<int64_t, int64_t>>,
+                          std::greater<std::pair<int64_t, int64_t>>>;
+
+  // Schedules every flow for the next cycle its traffic model may inject
+  // packets in.
+  void BuildInjectionSchedule();
+
   // Interface to simulator for injecting flits.
   NocSimulatorTrafficServiceShim* simulator_ = nullptr;
 
@@ -143,6 +165,11 @@ class NocTrafficInjector {
 
   // Measure injected traffic rate.
   std::vector<TrafficModelMonitor> traffic_model_monitor_;
+
+  // Flows are only run on the cycles their traffic models may inject packets
+  // in, so the cost of a cycle scales with the packets injected rather than
+  // the number of flows.
+  InjectionSchedule injection_schedule_;
 };
 
 // Builder for constructing a NocTrafficInjector.
@@ -182,10 +209,20 @@ class NocTrafficInjectorBuilder {
     XLS_RET_CHECK_OK(BuildPerInterfaceDepacketizer(
         network_sources, absl::MakeSpan(max_packet_size_per_source),
         network_manager, noc_parameters, traffic_injector));
+    traffic_injector.BuildInjectionSchedule();
 
     return traffic_injector;
   }
 
+  // Number of packet inter-arrival times each generalized geometric traffic
+  // model precomputes at once (see
+  // GeneralizedGeometricTrafficModel::SetSampleBatchSize()).  Defaults to 1,
+  // drawing each when needed.
+  NocTrafficInjectorBuilder& SetSampleBatchSize(int64_t batch_size) {
+    sample_batch_size_ = batch_size;
+    return *this;
+  }
+
  private:
   // Compute the max packet size for each source among all the possible flows.
   // Note: this is independent of the actual mode being simulated.
@@ -243,6 +280,8 @@ class NocTrafficInjectorBuilder {
       absl::Span<int64_t> max_packet_size_per_source,
       const NetworkManager& network_manager,
       const NocParameters& noc_parameters, NocTrafficInjector& injector);
+
+  int64_t sample_batch_size_ = 1;
 };
 
 // Shim to call the NocTrafficInjector from a simulator.
@@ -253,6 +292,14 @@ class NocTrafficInjectorService : public NocSimulatorServiceShim {
 
   absl::Status RunCycle() override { return injector_->RunCycle(); }
 
+  int64_t GetNextActiveCycle(int64_t cycle) override {
+    return injector_->GetNextPacketCycle();
+  }
+
+  absl::Status SkipToCycle(int64_t cycle) override {
+    return injector_->SkipToCycle(cycle);
+  }
+
  private:
   NocTrafficInjector* injector_;
 };
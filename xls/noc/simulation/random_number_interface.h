@@ -15,8 +15,11 @@
 #ifndef XLS_NOC_SIMULATION_RANDOM_NUMBER_INTERFACE_H_
 #define XLS_NOC_SIMULATION_RANDOM_NUMBER_INTERFACE_H_
 
+#include <cstdint>
 #include <random>
 
+#include "absl/types/span.h"
+
 // This file contains classes used manage and obtain random numbers
 // from different distributions.
 
@@ -65,6 +68,20 @@ class RandomNumberInterface {
     return 1 + GeometricDistribution(geo_p);
   }
 
+  // Fills inter_arrival_times with successive values of
+  // GeneralizedGeometric(lambda, burst_prob).
+  //
+  // The sequence is the same as that of repeated calls to
+  // GeneralizedGeometric(), but the distributions are only set up once.
+  void GeneralizedGeometricBatch(double lambda, double burst_prob,
+                                 absl::Span<int64_t> inter_arrival_times) {
+    std::bernoulli_distribution burst(burst_prob);
+    std::geometric_distribution<int64_t> geo(lambda * (1.0 - burst_prob));
+    for (int64_t& time : inter_arrival_times) {
+      time = burst(random_engine_) ? 0 : 1 + geo(random_engine_);
+    }
+  }
+
  private:
   // Random engine with a single int as state.
   std::minstd_rand random_engine_;
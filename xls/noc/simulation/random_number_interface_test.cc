@@ -14,6 +14,7 @@
 
 #include "xls/noc/simulation/random_number_interface.h"
 
+#include <cstdint>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -78,5 +79,20 @@ TEST(RandomNumberInterfaceTest, SmokeTest) {
   }
 }
 
+TEST(RandomNumberInterfaceTest, GeneralizedGeometricBatch) {
+  RandomNumberInterface rnd0;
+  RandomNumberInterface rnd1;
+
+  rnd0.SetSeed(100);
+  rnd1.SetSeed(100);
+
+  std::vector<int64_t> batch(1000);
+  rnd1.GeneralizedGeometricBatch(0.25, 0.1, absl::MakeSpan(batch));
+
+  for (int64_t time : batch) {
+    EXPECT_EQ(rnd0.GeneralizedGeometric(0.25, 0.1), time);
+  }
+}
+
 }  // namespace
 }  // namespace xls::noc
@@ -14,14 +14,22 @@
 
 #include "xls/noc/simulation/sim_objects.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <queue>
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/noc/config/network_config.pb.h"
 #include "xls/noc/simulation/common.h"
@@ -122,8 +130,117 @@ bool SimplePipelineImpl<DataTimePhitT>::TryPropagation(
   return internal_propagated_cycle_ == current_cycle;
 }
 
+// Returns true if "credit" carries a non-zero credit update.
+bool CarriesCredit(const TimedMetadataFlit& credit) {
+  return credit.flit.type != FlitType::kInvalid && !credit.flit.data.IsZero();
+}
+
+// Returns true if the pipeline "stages" of a link is full (so it is in
+// its steady state rather than still filling up from reset) and "is_idle"
+// holds for each flit in it.
+template <typename DataTimePhitT, typename IsIdleFn>
+bool IsIdlePipeline(std::queue<DataTimePhitT> stages, int64_t stage_count,
+                    IsIdleFn is_idle) {
+  if (stage_count > 0 && stages.size() != stage_count) {
+    return false;
+  }
+  for (; !stages.empty(); stages.pop()) {
+    if (!is_idle(stages.front())) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
+// Ticks each partition of the network's components on its own thread. The
+// calling thread ticks the first partition and a persistent worker thread
+// ticks each of the others; this is done once per tick so workers wait on a
+// generation count rather than being respawned.
+class PartitionedTicker {
+ public:
+  PartitionedTicker(
+      NocSimulator& simulator,
+      std::vector<std::vector<SimNetworkComponentBase*>> partitions)
+      : simulator_(simulator), partitions_(std::move(partitions)) {
+    for (int64_t i = 1; i < partitions_.size(); ++i) {
+      workers_.push_back(std::make_unique<Thread>([this, i]() { Work(i); }));
+    }
+  }
+
+  ~PartitionedTicker() {
+    {
+      absl::MutexLock lock(&mutex_);
+      stop_ = true;
+    }
+    for (std::unique_ptr<Thread>& worker : workers_) {
+      worker->Join();
+    }
+  }
+
+  // Ticks every partition once, returning true if all components converged.
+  bool Tick() {
+    {
+      absl::MutexLock lock(&mutex_);
+      ++generation_;
+      pending_ = workers_.size();
+      converged_ = true;
+    }
+    bool converged = TickPartition(0);
+
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(
+        +[](PartitionedTicker* ticker) ABSL_EXCLUSIVE_LOCKS_REQUIRED(
+             ticker->mutex_) { return ticker->pending_ == 0; },
+        this));
+    return converged && converged_;
+  }
+
+ private:
+  bool TickPartition(int64_t index) {
+    bool converged = true;
+    for (SimNetworkComponentBase* component : partitions_[index]) {
+      converged &= component->Tick(simulator_);
+    }
+    return converged;
+  }
+
+  void Work(int64_t index) {
+    int64_t generation = 0;
+    while (true) {
+      {
+        absl::MutexLock lock(&mutex_);
+        auto ready = [&]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+          return stop_ || generation_ != generation;
+        };
+        mutex_.Await(absl::Condition(&ready));
+        if (stop_) {
+          return;
+        }
+        generation = generation_;
+      }
+      bool converged = TickPartition(index);
+
+      absl::MutexLock lock(&mutex_);
+      converged_ &= converged;
+      --pending_;
+    }
+  }
+
+  NocSimulator& simulator_;
+  std::vector<std::vector<SimNetworkComponentBase*>> partitions_;
+  std::vector<std::unique_ptr<Thread>> workers_;
+
+  absl::Mutex mutex_;
+  int64_t generation_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t pending_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool converged_ ABSL_GUARDED_BY(mutex_) = true;
+  bool stop_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+NocSimulator::~NocSimulator() = default;
+
 absl::Status NocSimulator::CreateSimulationObjects(NetworkId network) {
   Network& network_obj = mgr_->GetNetwork(network);
 
@@ -272,7 +389,9 @@ absl::Status NocSimulator::RunCycle(int64_t max_ticks) {
     }
   }
 
-  for (int64_t i = 0; i < connections_.size(); ++i) {
+  // Partition boundary copies are left out as, once converged, they match the
+  // connections they're copies of.
+  for (int64_t i = 0; i < connection_index_map_.size(); ++i) {
     XLS_VLOG(2) << absl::StreamFormat("  Connection %d (%x)", i,
                                       connections_[i].id.AsUInt64());
 
@@ -292,10 +411,90 @@ absl::Status NocSimulator::RunCycle(int64_t max_ticks) {
   return absl::OkStatus();
 }
 
+bool NocSimulator::IsIdle() {
+  // The initial credits are sent on cycle 0.
+  if (cycle_ < 0) {
+    return false;
+  }
+
+  for (const SimConnectionState& connection : connections_) {
+    if (connection.forward_channels.flit.type != FlitType::kInvalid) {
+      return false;
+    }
+    for (const TimedMetadataFlit& credit : connection.reverse_channels) {
+      if (CarriesCredit(credit)) {
+        return false;
+      }
+    }
+  }
+
+  for (SimNetworkInterfaceSrc& nc : network_interface_sources_) {
+    if (!nc.IsIdle(*this)) {
+      return false;
+    }
+  }
+  for (SimInputBufferedVCRouter& nc : routers_) {
+    if (!nc.IsIdle(*this)) {
+      return false;
+    }
+  }
+  for (SimNetworkInterfaceSink& nc : network_interface_sinks_) {
+    if (!nc.IsIdle(*this)) {
+      return false;
+    }
+  }
+  // Links are checked last as it requires walking their pipelines.
+  for (SimLink& nc : links_) {
+    if (!nc.IsIdle(*this)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+absl::StatusOr<int64_t> NocSimulator::FastForward(int64_t max_cycle) {
+  if (!IsIdle()) {
+    return 0;
+  }
+
+  // An idle network stays idle, with every component's state unchanged other
+  // than its time stamps, until a service injects new traffic.
+  int64_t next_cycle = max_cycle;
+  for (NocSimulatorServiceShim* svc : pre_cycle_services_) {
+    next_cycle = std::min(next_cycle, svc->GetNextActiveCycle(cycle_));
+  }
+  for (NocSimulatorServiceShim* svc : post_cycle_services_) {
+    next_cycle = std::min(next_cycle, svc->GetNextActiveCycle(cycle_));
+  }
+  if (next_cycle <= cycle_ + 1) {
+    return 0;
+  }
+
+  for (NocSimulatorServiceShim* svc : pre_cycle_services_) {
+    XLS_RETURN_IF_ERROR(svc->SkipToCycle(next_cycle));
+  }
+  for (NocSimulatorServiceShim* svc : post_cycle_services_) {
+    XLS_RETURN_IF_ERROR(svc->SkipToCycle(next_cycle));
+  }
+
+  int64_t skipped_cycles = next_cycle - 1 - cycle_;
+  XLS_VLOG(2) << absl::StreamFormat("Skipping %d idle cycles to cycle %d",
+                                    skipped_cycles, next_cycle);
+  cycle_ = next_cycle - 1;
+  return skipped_cycles;
+}
+
 bool NocSimulator::Tick() {
   // Goes through each simulator object and run atick.
   // Converges when everyone returns True -- that determines new cycle
 
+  if (partitioned_ticker_ != nullptr) {
+    bool converged = partitioned_ticker_->Tick();
+    ExchangeBoundaryConnections();
+    return converged;
+  }
+
   bool converged = true;
 
   XLS_VLOG(2) << " Network Interfaces";
@@ -337,6 +536,133 @@ bool NocSimulator::Tick() {
   return converged;
 }
 
+void NocSimulator::ExchangeBoundaryConnections() {
+  // Each channel is written at most once per cycle and always stamped with
+  // that cycle, so a differing stamp means the owning side has written it.
+  for (const BoundaryConnection& boundary : boundary_connections_) {
+    SimConnectionState& source = connections_[boundary.source_index];
+    SimConnectionState& sink = connections_[boundary.sink_index];
+    if (sink.forward_channels.cycle != source.forward_channels.cycle) {
+      sink.forward_channels = source.forward_channels;
+    }
+    for (int64_t vc = 0; vc < source.reverse_channels.size(); ++vc) {
+      TimedMetadataFlit& source_flit = source.reverse_channels[vc];
+      TimedMetadataFlit& sink_flit = sink.reverse_channels[vc];
+      if (source_flit.cycle != sink_flit.cycle) {
+        source_flit = sink_flit;
+      }
+    }
+  }
+}
+
+absl::Status NocSimulator::PartitionNetwork(int64_t partition_count) {
+  XLS_RET_CHECK_GE(partition_count, 1);
+  XLS_RET_CHECK_EQ(cycle_, -1) << "Network must be partitioned before the "
+                                  "first cycle is run.";
+  XLS_RET_CHECK(partitioned_ticker_ == nullptr)
+      << "Network is already partitioned.";
+  if (partition_count == 1) {
+    return absl::OkStatus();
+  }
+
+  // All components in the order the unpartitioned simulator ticks them.
+  std::vector<SimNetworkComponentBase*> components;
+  for (SimNetworkInterfaceSrc& nc : network_interface_sources_) {
+    components.push_back(&nc);
+  }
+  for (SimLink& nc : links_) {
+    components.push_back(&nc);
+  }
+  int64_t first_router = components.size();
+  for (SimInputBufferedVCRouter& nc : routers_) {
+    components.push_back(&nc);
+  }
+  for (SimNetworkInterfaceSink& nc : network_interface_sinks_) {
+    components.push_back(&nc);
+  }
+
+  // Find the components at either end of each connection.
+  std::vector<std::vector<int64_t*>> inputs(components.size());
+  std::vector<std::vector<int64_t*>> outputs(components.size());
+  std::vector<int64_t> connection_source(connections_.size(), -1);
+  std::vector<int64_t> connection_sink(connections_.size(), -1);
+  for (int64_t i = 0; i < components.size(); ++i) {
+    components[i]->GetConnectionIndexSlots(*this, &inputs[i], &outputs[i]);
+    for (int64_t* index : inputs[i]) {
+      connection_sink[*index] = i;
+    }
+    for (int64_t* index : outputs[i]) {
+      connection_source[*index] = i;
+    }
+  }
+
+  // Routers are split into contiguous groups, and the remaining components
+  // (links and network interfaces) are then pulled into the partition of a
+  // neighboring component, preferring the downstream side, until all are
+  // assigned.
+  std::vector<int64_t> partition_of(components.size(), -1);
+  for (int64_t i = 0; i < routers_.size(); ++i) {
+    partition_of[first_router + i] = i * partition_count / routers_.size();
+  }
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (int64_t i = 0; i < components.size(); ++i) {
+      if (partition_of[i] != -1) {
+        continue;
+      }
+      std::vector<int64_t> neighbors;
+      for (int64_t* index : outputs[i]) {
+        neighbors.push_back(connection_sink[*index]);
+      }
+      for (int64_t* index : inputs[i]) {
+        neighbors.push_back(connection_source[*index]);
+      }
+      for (int64_t neighbor : neighbors) {
+        if (neighbor != -1 && partition_of[neighbor] != -1) {
+          partition_of[i] = partition_of[neighbor];
+          changed = true;
+          break;
+        }
+      }
+    }
+  }
+  std::vector<std::vector<SimNetworkComponentBase*>> partitions(
+      partition_count);
+  for (int64_t i = 0; i < components.size(); ++i) {
+    // Components not connected to any router (e.g. a network without routers)
+    // all go in the first partition.
+    if (partition_of[i] == -1) {
+      partition_of[i] = 0;
+    }
+    partitions[partition_of[i]].push_back(components[i]);
+  }
+
+  // Give the sink side of each connection crossing a partition boundary its
+  // own copy of the connection state.
+  for (int64_t i = 0; i < components.size(); ++i) {
+    for (int64_t* index : inputs[i]) {
+      int64_t source = connection_source[*index];
+      if (source == -1 || partition_of[source] == partition_of[i]) {
+        continue;
+      }
+      int64_t sink_index = connections_.size();
+      SimConnectionState copy = connections_[*index];
+      connections_.push_back(std::move(copy));
+      boundary_connections_.push_back(
+          BoundaryConnection{.source_index = *index, .sink_index = sink_index});
+      *index = sink_index;
+    }
+  }
+  XLS_VLOG(1) << absl::StreamFormat(
+      "Partitioned network into %d partitions with %d boundary connections",
+      partition_count, boundary_connections_.size());
+
+  partitioned_ticker_ =
+      std::make_unique<PartitionedTicker>(*this, std::move(partitions));
+  return absl::OkStatus();
+}
+
 bool SimNetworkComponentBase::Tick(NocSimulator& simulator) {
   int64_t cycle = simulator.GetCurrentCycle();
 
@@ -362,6 +688,24 @@ int64_t SimLink::GetSourceConnectionIndex() const {
   return src_connection_index_;
 }
 
+bool SimLink::IsIdle(NocSimulator& simulator) {
+  if (!IsIdlePipeline(forward_data_stages_, forward_pipeline_stages_,
+                      [](const TimedDataFlit& flit) {
+                        return flit.flit.type == FlitType::kInvalid;
+                      })) {
+    return false;
+  }
+  for (const std::queue<TimedMetadataFlit>& stages : reverse_credit_stages_) {
+    if (!IsIdlePipeline(stages, reverse_pipeline_stages_,
+                        [](const TimedMetadataFlit& credit) {
+                          return !CarriesCredit(credit);
+                        })) {
+      return false;
+    }
+  }
+  return true;
+}
+
 absl::Status SimLink::InitializeImpl(NocSimulator& simulator) {
   XLS_ASSIGN_OR_RETURN(
       NetworkComponentParam nc_param,
@@ -430,6 +774,15 @@ absl::Status SimNetworkInterfaceSrc::InitializeImpl(NocSimulator& simulator) {
   return absl::OkStatus();
 }
 
+bool SimNetworkInterfaceSrc::IsIdle(NocSimulator& simulator) {
+  for (int64_t vc = 0; vc < data_to_send_.size(); ++vc) {
+    if (!data_to_send_[vc].empty() || credit_update_[vc].credit != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
 absl::Status SimNetworkInterfaceSrc::SendFlitAtTime(TimedDataFlit flit) {
   int64_t vc_index = flit.flit.vc;
 
@@ -480,15 +833,15 @@ absl::Status SimInputBufferedVCRouter::InitializeImpl(NocSimulator& simulator) {
 
   // Setup structures associated with the inputs.
   //  - input to SimConnectionState (input_connection_index_start_ and count_)
-  //  - input_buffers_
+  //  - input vc slots (buffers and credits to send)
   input_connection_count_ = nc.GetInputPortIds().size();
   input_connection_index_start_ =
       simulator.GetNewConnectionIndicesStore(input_connection_count_);
   absl::Span<int64_t> input_indices = simulator.GetConnectionIndicesStore(
       input_connection_index_start_, input_connection_count_);
 
-  input_buffers_.resize(input_connection_count_);
-  input_credit_to_send_.resize(input_connection_count_);
+  VirtualChannelStateStore& vc_state = simulator.GetVirtualChannelStateStore();
+  input_vc_slot_.clear();
   max_vc_ = 0;
   for (int64_t i = 0; i < input_connection_count_; ++i) {
     XLS_ASSIGN_OR_RETURN(
@@ -502,15 +855,18 @@ absl::Status SimInputBufferedVCRouter::InitializeImpl(NocSimulator& simulator) {
     std::vector<VirtualChannelParam> vc_params =
         port_param.GetVirtualChannels();
 
-    input_buffers_[i].resize(port_param.VirtualChannelCount());
+    int64_t slot = simulator.GetNewInputVirtualChannelSlots(
+        port_param.VirtualChannelCount());
+    input_vc_slot_.push_back(slot);
     for (int64_t vc = 0; vc < port_param.VirtualChannelCount(); ++vc) {
-      input_buffers_[i][vc].max_queue_size = vc_params[vc].GetDepth();
+      vc_state.input_buffers[slot + vc].max_queue_size =
+          vc_params[vc].GetDepth();
     }
-    input_credit_to_send_[i].resize(port_param.VirtualChannelCount());
     if (max_vc_ < port_param.VirtualChannelCount()) {
       max_vc_ = port_param.VirtualChannelCount();
     }
   }
+  input_vc_slot_.push_back(simulator.GetNewInputVirtualChannelSlots(0));
 
   // Setup structures associated with the outputs.
   //  - output to SimConnectionState (output_connection_index_start_ and count_)
@@ -520,8 +876,7 @@ absl::Status SimInputBufferedVCRouter::InitializeImpl(NocSimulator& simulator) {
       simulator.GetNewConnectionIndicesStore(output_connection_count_);
   absl::Span<int64_t> output_indices = simulator.GetConnectionIndicesStore(
       output_connection_index_start_, output_connection_count_);
-  credit_.resize(output_connection_count_);
-  credit_update_.resize(output_connection_count_);
+  output_vc_slot_.clear();
   for (int64_t i = 0; i < output_connection_count_; ++i) {
     XLS_ASSIGN_OR_RETURN(
         PortId port_id,
@@ -531,10 +886,10 @@ absl::Status SimInputBufferedVCRouter::InitializeImpl(NocSimulator& simulator) {
 
     XLS_ASSIGN_OR_RETURN(PortParam port_param,
                          simulator.GetNocParameters()->GetPortParam(port_id));
-    credit_[i].resize(port_param.VirtualChannelCount(), 0);
-    credit_update_[i].resize(port_param.VirtualChannelCount(),
-                             CreditState{simulator.GetCurrentCycle(), 0});
+    output_vc_slot_.push_back(simulator.GetNewOutputVirtualChannelSlots(
+        port_param.VirtualChannelCount()));
   }
+  output_vc_slot_.push_back(simulator.GetNewOutputVirtualChannelSlots(0));
 
   internal_propagated_cycle_ = simulator.GetCurrentCycle();
   utilization_cycle_count_ = 0;
@@ -722,6 +1077,36 @@ SimInputBufferedVCRouter::GetDestinationPortIndexAndVcIndex(
   return PortIndexAndVCIndex{output_port_index, port_to.vc_index_};
 }
 
+bool SimInputBufferedVCRouter::IsIdle(NocSimulator& simulator) {
+  VirtualChannelStateStore& vc_state = simulator.GetVirtualChannelStateStore();
+  for (int64_t slot = input_vc_slot_.front(); slot < input_vc_slot_.back();
+       ++slot) {
+    if (!vc_state.input_buffers[slot].queue.empty()) {
+      return false;
+    }
+  }
+  for (int64_t slot = output_vc_slot_.front(); slot < output_vc_slot_.back();
+       ++slot) {
+    if (vc_state.output_credit_update[slot].credit != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void SimInputBufferedVCRouter::GetConnectionIndexSlots(
+    NocSimulator& simulator, std::vector<int64_t*>* inputs,
+    std::vector<int64_t*>* outputs) {
+  for (int64_t& index : simulator.GetConnectionIndicesStore(
+           input_connection_index_start_, input_connection_count_)) {
+    inputs->push_back(&index);
+  }
+  for (int64_t& index : simulator.GetConnectionIndicesStore(
+           output_connection_index_start_, output_connection_count_)) {
+    outputs->push_back(&index);
+  }
+}
+
 bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
   // TODO(tedhong): 2020-02-16 Factor out with strategy pattern.
 
@@ -733,22 +1118,25 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
       simulator.GetConnectionIndicesStore(output_connection_index_start_,
                                           output_connection_count_);
 
+  VirtualChannelStateStore& vc_state = simulator.GetVirtualChannelStateStore();
+
   // Update credits (for output ports)
   if (internal_propagated_cycle_ != current_cycle) {
-    for (int64_t i = 0; i < credit_update_.size(); ++i) {
-      for (int64_t vc = 0; vc < credit_update_[i].size(); ++vc) {
-        if (credit_update_[i][vc].credit > 0) {
-          credit_[i][vc] += credit_update_[i][vc].credit;
+    for (int64_t i = 0; i < output_connection_count_; ++i) {
+      for (int64_t vc = 0; vc < OutputVcCount(i); ++vc) {
+        int64_t slot = OutputVcSlot(i, vc);
+        int64_t& credit = vc_state.output_credit[slot];
+        const CreditState& credit_update = vc_state.output_credit_update[slot];
+        if (credit_update.credit > 0) {
+          credit += credit_update.credit;
           XLS_VLOG(2) << absl::StrFormat(
               "... router %x output port %d vc %d added credits %d, now %d",
-              GetId().AsUInt64(), i, vc, credit_update_[i][vc].credit,
-              credit_[i][vc]);
+              GetId().AsUInt64(), i, vc, credit_update.credit, credit);
         } else {
           XLS_VLOG(2) << absl::StrFormat(
               "... router %x output port %d vc %d did not add credits %d, now "
               "%d",
-              GetId().AsUInt64(), i, vc, credit_update_[i][vc].credit,
-              credit_[i][vc]);
+              GetId().AsUInt64(), i, vc, credit_update.credit, credit);
         }
       }
     }
@@ -773,11 +1161,9 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
   }
 
   // Reset credits to send on reverse channel to 0.
-  for (int64_t i = 0; i < input_connection_count_; ++i) {
-    for (int64_t vc = 0; vc < input_credit_to_send_[i].size(); ++vc) {
-      input_credit_to_send_[i][vc] = 0;
-    }
-  }
+  std::fill(
+      vc_state.input_credit_to_send.begin() + input_vc_slot_.front(),
+      vc_state.input_credit_to_send.begin() + input_vc_slot_.back(), 0);
 
   bool flit_sent = false;
   // This router supports bypass so a flit arriving at the
@@ -788,7 +1174,7 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
 
     if (input.forward_channels.flit.type != FlitType::kInvalid) {
       int64_t vc = input.forward_channels.flit.vc;
-      input_buffers_[i][vc].queue.push(
+      vc_state.input_buffers[InputVcSlot(i, vc)].queue.push(
           {input.forward_channels.flit, input.forward_channels.metadata});
 
       XLS_VLOG(2) << absl::StrFormat(
@@ -801,18 +1187,20 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
   // Use fixed priority to route to output ports.
   // Priority goes to the port with the least vc and the least port index.
   for (int64_t vc = 0; vc < max_vc_; ++vc) {
-    for (int64_t i = 0; i < input_buffers_.size(); ++i) {
-      if (vc >= input_buffers_[i].size()) {
+    for (int64_t i = 0; i < input_connection_count_; ++i) {
+      if (vc >= InputVcCount(i)) {
         continue;
       }
 
       // See if we have a flit to route and can route it.
-      if (input_buffers_[i][vc].queue.empty()) {
+      int64_t input_slot = InputVcSlot(i, vc);
+      DataFlitQueue& input_buffer = vc_state.input_buffers[input_slot];
+      if (input_buffer.queue.empty()) {
         continue;
       }
 
-      DataFlit flit = input_buffers_[i][vc].queue.front().flit;
-      TimedDataFlitInfo metadata = input_buffers_[i][vc].queue.front().metadata;
+      DataFlit flit = input_buffer.queue.front().flit;
+      TimedDataFlitInfo metadata = input_buffer.queue.front().metadata;
       int64_t destination_index = flit.destination_index;
 
       PortIndexAndVCIndex input{i, vc};
@@ -823,12 +1211,13 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
       PortIndexAndVCIndex output = output_status.value();
 
       // Now see if we have sufficient credits.
-      if (credit_.at(output.port_index).at(output.vc_index) <= 0) {
+      int64_t& output_credit = vc_state.output_credit.at(
+          OutputVcSlot(output.port_index, output.vc_index));
+      if (output_credit <= 0) {
         XLS_VLOG(2) << absl::StreamFormat(
             "... router unable to send data %s vc %d credit now %d"
             " from port index %d to port index %d.",
-            flit, flit.vc, credit_.at(output.port_index).at(output.vc_index), i,
-            output.port_index);
+            flit, flit.vc, output_credit, i, output.port_index);
         continue;
       }
 
@@ -849,11 +1238,11 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
           TimedRouteItem{id_, current_cycle});
 
       // Update credit on output.
-      --credit_.at(output.port_index).at(output.vc_index);
+      --output_credit;
 
       // Update credit to send back to input.
-      ++input_credit_to_send_[i][vc];
-      input_buffers_[i][vc].queue.pop();
+      ++vc_state.input_credit_to_send[input_slot];
+      input_buffer.queue.pop();
 
       flit_sent = true;
 
@@ -861,8 +1250,7 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
           "... router sending data %s vc %d credit now %d"
           " from port index %d to port index %d on %x.",
           output_state.forward_channels.flit,
-          output_state.forward_channels.flit.vc,
-          credit_.at(output.port_index).at(output.vc_index), i,
+          output_state.forward_channels.flit.vc, output_credit, i,
           output.port_index, output_state.id.AsUInt64());
     }
   }
@@ -900,6 +1288,8 @@ bool SimInputBufferedVCRouter::TryReversePropagation(NocSimulator& simulator) {
       simulator.GetConnectionIndicesStore(input_connection_index_start_,
                                           input_connection_count_);
 
+  VirtualChannelStateStore& vc_state = simulator.GetVirtualChannelStateStore();
+
   // Send credit upstream.
   for (int64_t i = 0; i < input_connection_count_; ++i) {
     SimConnectionState& input =
@@ -911,10 +1301,11 @@ bool SimInputBufferedVCRouter::TryReversePropagation(NocSimulator& simulator) {
       // Upon reset (cycle-0) a full update of credits is sent.
       if (current_cycle == 0) {
         input.reverse_channels[vc].flit.data =
-            UBits(input_buffers_[i][vc].max_queue_size, 32);
+            UBits(vc_state.input_buffers[InputVcSlot(i, vc)].max_queue_size,
+                  32);
       } else {
         input.reverse_channels[vc].flit.data =
-            UBits(input_credit_to_send_[i][vc], 32);
+            UBits(vc_state.input_credit_to_send[InputVcSlot(i, vc)], 32);
       }
       input.reverse_channels[vc].cycle = current_cycle;
 
@@ -933,28 +1324,30 @@ bool SimInputBufferedVCRouter::TryReversePropagation(NocSimulator& simulator) {
 
   int64_t num_propagated = 0;
   int64_t possible_propagation = 0;
-  for (int64_t i = 0; i < credit_update_.size(); ++i) {
+  for (int64_t i = 0; i < output_connection_count_; ++i) {
     SimConnectionState& output =
         simulator.GetSimConnectionByIndex(output_connection_index.at(i));
 
-    for (int64_t vc = 0; vc < credit_update_[i].size(); ++vc) {
+    for (int64_t vc = 0; vc < OutputVcCount(i); ++vc) {
       TimedMetadataFlit possible_credit = output.reverse_channels[vc];
 
       if (possible_credit.cycle == current_cycle) {
-        if (credit_update_[i][vc].cycle != current_cycle) {
-          credit_update_[i][vc].cycle = current_cycle;
+        CreditState& credit_update =
+            vc_state.output_credit_update[OutputVcSlot(i, vc)];
+        if (credit_update.cycle != current_cycle) {
+          credit_update.cycle = current_cycle;
 
           if (possible_credit.flit.type != FlitType::kInvalid) {
             int64_t credit = possible_credit.flit.data.ToInt64().value();
-            credit_update_[i][vc].credit = credit;
+            credit_update.credit = credit;
           } else {
-            credit_update_[i][vc].credit = 0;
+            credit_update.credit = 0;
           }
 
           XLS_VLOG(2) << absl::StreamFormat(
               "... router received credit %d output port %d vc %d via "
               "connection %x",
-              credit_update_[i][vc].credit, i, vc, output.id.AsUInt64());
+              credit_update.credit, i, vc, output.id.AsUInt64());
         }
 
         ++num_propagated;
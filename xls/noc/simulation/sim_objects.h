@@ -16,6 +16,7 @@
 #define XLS_NOC_SIMULATION_SIM_OBJECTS_H_
 
 #include <cstdint>
+#include <memory>
 #include <queue>
 #include <vector>
 
@@ -59,9 +60,26 @@ struct DataFlitQueue {
   int64_t max_queue_size;
 };
 
+// Structure-of-arrays store for the per-virtual-channel state of all routers.
+//
+// Each router reserves a contiguous range of input slots (one per vc of each
+// input port) and of output slots (one per vc of each output port) so that
+// the per-cycle loops walk dense arrays of a single field rather than chasing
+// a vector per port.
+struct VirtualChannelStateStore {
+  // Indexed by input slot.
+  std::vector<DataFlitQueue> input_buffers;
+  std::vector<int64_t> input_credit_to_send;
+
+  // Indexed by output slot.
+  std::vector<int64_t> output_credit;
+  std::vector<CreditState> output_credit_update;
+};
+
 // Represents a fifo/buffer used to store metadata phits.
 
 class NocSimulator;
+class PartitionedTicker;
 
 // Common functionality and base class for all simulator objects.
 class SimNetworkComponentBase {
@@ -80,6 +98,24 @@ class SimNetworkComponentBase {
   // Returns the associated NetworkComponentId.
   NetworkComponentId GetId() const { return id_; }
 
+  // Appends pointers to the connection indices this component uses to
+  // "inputs" for the connections on its input ports (whose forward channels it
+  // reads and reverse channels it writes) and to "outputs" for those on its
+  // output ports (the other way around).
+  //
+  // Used by NocSimulator::PartitionNetwork() to redirect connections that
+  // cross partitions.
+  virtual void GetConnectionIndexSlots(NocSimulator& simulator,
+                                       std::vector<int64_t*>* inputs,
+                                       std::vector<int64_t*>* outputs) {}
+
+  // Returns true if this component holds no flits and no credits in flight,
+  // so that simulating a cycle without new traffic leaves its state unchanged
+  // other than time stamps.
+  //
+  // Used by NocSimulator::FastForward() to skip idle cycles.
+  virtual bool IsIdle(NocSimulator& simulator) { return true; }
+
   virtual ~SimNetworkComponentBase() = default;
 
  protected:
@@ -151,6 +187,15 @@ class SimLink : public SimNetworkComponentBase {
 
   // Get the sink connection index that in used in the simulator.
 
+  void GetConnectionIndexSlots(NocSimulator& simulator,
+                               std::vector<int64_t*>* inputs,
+                               std::vector<int64_t*>* outputs) override {
+    inputs->push_back(&src_connection_index_);
+    outputs->push_back(&sink_connection_index_);
+  }
+
+  bool IsIdle(NocSimulator& simulator) override;
+
  private:
   SimLink() = default;
 
@@ -188,6 +233,14 @@ class SimNetworkInterfaceSrc : public SimNetworkComponentBase {
   // Register a flit to be sent at a specific time.
   absl::Status SendFlitAtTime(TimedDataFlit flit);
 
+  void GetConnectionIndexSlots(NocSimulator& simulator,
+                               std::vector<int64_t*>* inputs,
+                               std::vector<int64_t*>* outputs) override {
+    outputs->push_back(&sink_connection_index_);
+  }
+
+  bool IsIdle(NocSimulator& simulator) override;
+
  private:
   SimNetworkInterfaceSrc() = default;
 
@@ -246,6 +299,12 @@ class SimNetworkInterfaceSink : public SimNetworkComponentBase {
     return bits_per_sec / 1024.0 / 1024.0 / 8.0;
   }
 
+  void GetConnectionIndexSlots(NocSimulator& simulator,
+                               std::vector<int64_t*>* inputs,
+                               std::vector<int64_t*>* outputs) override {
+    inputs->push_back(&src_connection_index_);
+  }
+
  private:
   SimNetworkInterfaceSink() = default;
 
@@ -291,6 +350,12 @@ class SimInputBufferedVCRouter : public SimNetworkComponentBase {
 
   int64_t GetUtilizationCycleCount() const;
 
+  void GetConnectionIndexSlots(NocSimulator& simulator,
+                               std::vector<int64_t*>* inputs,
+                               std::vector<int64_t*>* outputs) override;
+
+  bool IsIdle(NocSimulator& simulator) override;
+
  private:
   SimInputBufferedVCRouter() = default;
 
@@ -336,24 +401,39 @@ class SimInputBufferedVCRouter : public SimNetworkComponentBase {
   // updated its credit count from the updates received in the previous cycle.
   int64_t internal_propagated_cycle_;
 
-  // Stores the input buffers associated with each input port and vc.
-  std::vector<std::vector<DataFlitQueue>> input_buffers_;
-
-  // Stores the credit count associated with each output port and vc.
-  // Each cycle, the router updates its credit count from credit_update_.
-  std::vector<std::vector<int64_t>> credit_;
+  // Returns the number of vcs of input/output port "port".
+  int64_t InputVcCount(int64_t port) const {
+    return input_vc_slot_[port + 1] - input_vc_slot_[port];
+  }
+  int64_t OutputVcCount(int64_t port) const {
+    return output_vc_slot_[port + 1] - output_vc_slot_[port];
+  }
 
-  // Stores the credit count received on cycle N-1.
-  std::vector<std::vector<CreditState>> credit_update_;
+  // Index into the simulator's VirtualChannelStateStore of the state for
+  // vc "vc" of input/output port "port".
+  //
+  // input_vc_slot_[i] is the first slot of input port i, with an additional
+  // trailing entry marking the end of the last port, and likewise for
+  // output_vc_slot_.
+  //
+  // The input slots store the input buffers and the credits to send back
+  // upstream (the number of phits that left the input buffers during forward
+  // propagation). The output slots store the credit count and the credit
+  // update received on cycle N-1, which the router adds to its credit count
+  // each cycle.
+  int64_t InputVcSlot(int64_t port, int64_t vc) const {
+    return input_vc_slot_[port] + vc;
+  }
+  int64_t OutputVcSlot(int64_t port, int64_t vc) const {
+    return output_vc_slot_[port] + vc;
+  }
+  std::vector<int64_t> input_vc_slot_;
+  std::vector<int64_t> output_vc_slot_;
 
   // The maximum number of vcs on for an input port.
   // Used for the priority scheme implementation.
   int64_t max_vc_;
 
-  // Used by forward propagation to store the number of phits that left
-  // the input buffers and hence credits that can be sent back upstream.
-  std::vector<std::vector<int64_t>> input_credit_to_send_;
-
   // The number of cycles that a transfer from input to output occurred.
   int64_t utilization_cycle_count_;
 };
@@ -364,6 +444,7 @@ class NocSimulator {
  public:
   NocSimulator()
       : mgr_(nullptr), params_(nullptr), routing_(nullptr), cycle_(-1) {}
+  ~NocSimulator();
 
   // Creates all simulation objects for a given network.
   // NetworkManager, NocParameters, and DistributedRoutingTable should
@@ -417,6 +498,25 @@ class NocSimulator {
     return next_start;
   }
 
+  // Reserves "size" contiguous input/output slots in the virtual channel
+  // state store and returns the index of the first one.
+  int64_t GetNewInputVirtualChannelSlots(int64_t size) {
+    int64_t next_start = vc_state_.input_buffers.size();
+    vc_state_.input_buffers.resize(next_start + size);
+    vc_state_.input_credit_to_send.resize(next_start + size, 0);
+    return next_start;
+  }
+  int64_t GetNewOutputVirtualChannelSlots(int64_t size) {
+    int64_t next_start = vc_state_.output_credit.size();
+    vc_state_.output_credit.resize(next_start + size, 0);
+    vc_state_.output_credit_update.resize(next_start + size,
+                                          CreditState{cycle_, 0});
+    return next_start;
+  }
+
+  // Returns the store of per-virtual-channel router state.
+  VirtualChannelStateStore& GetVirtualChannelStateStore() { return vc_state_; }
+
   // Allocates and returns an index that can be used with
   // GetPortIdStore to retreive an array of size)
 
@@ -432,9 +532,40 @@ class NocSimulator {
   // Run a single cycle of the simulator.
   absl::Status RunCycle(int64_t max_ticks = 9999);
 
+  // Returns true if, after the last simulated cycle, no flits or credits are
+  // in flight and no component has flits waiting to be sent.
+  bool IsIdle();
+
+  // Skips over cycles in which nothing would happen.
+  //
+  // If the network is idle, advances the current cycle so that the next
+  // RunCycle() simulates the earliest cycle in which a registered service may
+  // become active (see NocSimulatorServiceShim::GetNextActiveCycle), but no
+  // later than "max_cycle". Cycles skipped this way leave the simulation
+  // state, including utilization counts and monitored link traffic, exactly
+  // as if they had been simulated.
+  //
+  // Returns the number of cycles skipped.
+  absl::StatusOr<int64_t> FastForward(int64_t max_cycle);
+
   // Runs a single tick of the simulator.
   bool Tick();
 
+  // Splits the network into "partition_count" partitions whose components are
+  // then ticked concurrently, one thread per partition, by each Tick().
+  //
+  // Routers are divided into contiguous groups and every other component joins
+  // the partition of a nearby router. A connection whose two ends land in
+  // different partitions is double-buffered: each side works on its own copy
+  // of the connection state and the copies exchange the channels written by
+  // their owners between ticks. Since every component only propagates once
+  // its inputs carry the current cycle's data, this changes how many ticks a
+  // cycle takes to converge but not the simulation results, which are
+  // identical to those of the unpartitioned simulator.
+  //
+  // Must be called after Initialize() and before the first cycle is run.
+  absl::Status PartitionNetwork(int64_t partition_count);
+
   // Register a service to run once at the beginning of each cycle.
   // TODO(tedhong): 2021-07-27 Add a scheme to provide a total order
   //                of services.
@@ -470,6 +601,10 @@ class NocSimulator {
   absl::Status CreateLink(NetworkComponentId nc_id);
   absl::Status CreateRouter(NetworkComponentId nc_id);
 
+  // Copies the channels of each partition boundary connection that have been
+  // written by their owning side since the last tick to the other side's copy.
+  void ExchangeBoundaryConnections();
+
   NetworkManager* mgr_;
   NocParameters* params_;
   DistributedRoutingTable* routing_;
@@ -501,6 +636,9 @@ class NocSimulator {
   // Stores port ids for routers.
   std::vector<PortId> port_id_store_;
 
+  // Per-virtual-channel router state, see VirtualChannelStateStore.
+  VirtualChannelStateStore vc_state_;
+
   std::vector<SimLink> links_;
   std::vector<SimNetworkInterfaceSrc> network_interface_sources_;
   std::vector<SimNetworkInterfaceSink> network_interface_sinks_;
@@ -511,6 +649,18 @@ class NocSimulator {
 
   // Shims to services to run at the end of each cycle.
   std::vector<NocSimulatorServiceShim*> post_cycle_services_;
+
+  // A connection whose source and sink components are in different
+  // partitions. The source side uses connections_[source_index] and the sink
+  // side connections_[sink_index].
+  struct BoundaryConnection {
+    int64_t source_index;
+    int64_t sink_index;
+  };
+  std::vector<BoundaryConnection> boundary_connections_;
+
+  // Runs the partitions' ticks once PartitionNetwork() has been called.
+  std::unique_ptr<PartitionedTicker> partitioned_ticker_;
 };
 
 }  // namespace noc
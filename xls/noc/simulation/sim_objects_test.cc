@@ -14,6 +14,8 @@
 
 #include "xls/noc/simulation/sim_objects.h"
 
+#include <cstdint>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/logging/logging.h"
@@ -116,7 +118,11 @@ TEST(SimObjectsTest, BackToBackNetwork0) {
   EXPECT_EQ(traffic_recv_port_0[4].flit.data, UBits(707, 64));
 }
 
-TEST(SimObjectsTest, TreeNetwork0) {
+// Runs the tree network with the number of partitions given by the test
+// parameter; the results must not depend on it.
+class SimObjectsPartitionTest : public ::testing::TestWithParam<int64_t> {};
+
+TEST_P(SimObjectsPartitionTest, TreeNetwork0) {
   // Build and assign simulation objects
   NetworkConfigProto proto;
   NetworkManager graph;
@@ -155,6 +161,7 @@ TEST(SimObjectsTest, TreeNetwork0) {
   NocSimulator simulator;
   XLS_ASSERT_OK(simulator.Initialize(graph, params, routing_table,
                                      graph.GetNetworkIds()[0]));
+  XLS_ASSERT_OK(simulator.PartitionNetwork(GetParam()));
   simulator.Dump();
 
   // Retrieve src and sink objects
@@ -295,6 +302,9 @@ TEST(SimObjectsTest, TreeNetwork0) {
       38146);
 }
 
+INSTANTIATE_TEST_SUITE_P(SimObjectsPartitionTestInstantiation,
+                         SimObjectsPartitionTest, ::testing::Values(1, 2, 3));
+
 }  // namespace
 }  // namespace noc
 }  // namespace xls
@@ -12,11 +12,16 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/noc/simulation/noc_traffic_injector.h"
 #include "xls/noc/simulation/sample_network_graphs.h"
 #include "xls/noc/simulation/sim_objects.h"
@@ -379,5 +384,115 @@ TEST(SimTrafficTest, NetworkWithMultiplePathsAndReplay) {
   EXPECT_EQ(simulator.GetRouters()[1].GetUtilizationCycleCount(), 10);
 }
 
+// Observations of a simulation compared with and without fast-forwarding.
+struct SparseReplayResult {
+  std::vector<int64_t> arrival_cycles;
+  int64_t link_packet_count;
+  int64_t router_utilization;
+  double injected_traffic_rate;
+  double received_traffic_rate;
+  int64_t skipped_cycles;
+};
+
+absl::StatusOr<SparseReplayResult> RunSparseReplay(bool fast_forward) {
+  NocTrafficManager traffic_mgr;
+  XLS_ASSIGN_OR_RETURN(TrafficFlowId flow0_id, traffic_mgr.CreateTrafficFlow());
+  traffic_mgr.GetTrafficFlow(flow0_id)
+      .SetName("flow0")
+      .SetSource("SendPort0")
+      .SetDestination("RecvPort0")
+      .SetVC("VC0")
+      .SetPacketSizeInBits(64)
+      .SetClockCycleTimes({0, 40, 41, 42, 300, 999});
+  XLS_ASSIGN_OR_RETURN(TrafficModeId mode0_id, traffic_mgr.CreateTrafficMode());
+  traffic_mgr.GetTrafficMode(mode0_id).SetName("Mode 0").RegisterTrafficFlow(
+      flow0_id);
+
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_RETURN_IF_ERROR(BuildNetworkGraphLinear000(&proto, &graph, &params));
+
+  DistributedRoutingTableBuilderForTrees route_builder;
+  XLS_ASSIGN_OR_RETURN(DistributedRoutingTable routing_table,
+                       route_builder.BuildNetworkRoutingTables(
+                           graph.GetNetworkIds()[0], graph, params));
+
+  RandomNumberInterface rnd;
+  int64_t cycle_time_in_ps = 400;
+  XLS_ASSIGN_OR_RETURN(
+      NocTrafficInjector traffic_injector,
+      NocTrafficInjectorBuilder().Build(
+          cycle_time_in_ps, mode0_id,
+          routing_table.GetSourceIndices().GetNetworkComponents(),
+          routing_table.GetSinkIndices().GetNetworkComponents(),
+          params.GetNetworkParam(graph.GetNetworkIds()[0])
+              ->GetVirtualChannels(),
+          traffic_mgr, graph, params, rnd));
+
+  NocSimulator simulator;
+  XLS_RETURN_IF_ERROR(simulator.Initialize(graph, params, routing_table,
+                                           graph.GetNetworkIds()[0]));
+  NocSimulatorToNocTrafficInjectorShim injector_shim(simulator,
+                                                     traffic_injector);
+  traffic_injector.SetSimulatorShim(injector_shim);
+  simulator.RegisterPreCycleService(injector_shim);
+  NocSimulatorToLinkMonitorServiceShim link_monitor(simulator);
+  simulator.RegisterPostCycleService(link_monitor);
+
+  SparseReplayResult result;
+  result.skipped_cycles = 0;
+  while (simulator.GetCurrentCycle() < 1200) {
+    XLS_RETURN_IF_ERROR(simulator.RunCycle());
+    if (fast_forward) {
+      XLS_ASSIGN_OR_RETURN(int64_t skipped, simulator.FastForward(1200));
+      result.skipped_cycles += skipped;
+    }
+  }
+
+  XLS_ASSIGN_OR_RETURN(NetworkComponentId recv_port_0,
+                       FindNetworkComponentByName("RecvPort0", graph, params));
+  XLS_ASSIGN_OR_RETURN(SimNetworkInterfaceSink * sink,
+                       simulator.GetSimNetworkInterfaceSink(recv_port_0));
+  for (const TimedDataFlit& flit : sink->GetReceivedTraffic()) {
+    result.arrival_cycles.push_back(flit.cycle);
+  }
+  XLS_ASSIGN_OR_RETURN(NetworkComponentId link_a0,
+                       FindNetworkComponentByName("LinkA0", graph, params));
+  result.link_packet_count = 0;
+  for (const auto& [destination, count] :
+       link_monitor.GetLinkToPacketCountMap().at(link_a0)) {
+    result.link_packet_count += count;
+  }
+  result.router_utilization =
+      simulator.GetRouters()[0].GetUtilizationCycleCount();
+  result.injected_traffic_rate =
+      traffic_injector.MeasuredTrafficRateInMiBps(cycle_time_in_ps, 0);
+  result.received_traffic_rate =
+      sink->MeasuredTrafficRateInMiBps(cycle_time_in_ps);
+  return result;
+}
+
+TEST(SimTrafficTest, FastForwardMatchesCycleByCycle) {
+  XLS_ASSERT_OK_AND_ASSIGN(SparseReplayResult expected,
+                           RunSparseReplay(/*fast_forward=*/false));
+  XLS_ASSERT_OK_AND_ASSIGN(SparseReplayResult actual,
+                           RunSparseReplay(/*fast_forward=*/true));
+
+  EXPECT_EQ(expected.skipped_cycles, 0);
+  EXPECT_GT(actual.skipped_cycles, 1000);
+
+  EXPECT_EQ(expected.arrival_cycles.size(), 6);
+  EXPECT_EQ(actual.arrival_cycles, expected.arrival_cycles);
+  EXPECT_EQ(expected.link_packet_count, 6);
+  EXPECT_EQ(actual.link_packet_count, expected.link_packet_count);
+  EXPECT_EQ(expected.router_utilization, 6);
+  EXPECT_EQ(actual.router_utilization, expected.router_utilization);
+  EXPECT_DOUBLE_EQ(actual.injected_traffic_rate,
+                   expected.injected_traffic_rate);
+  EXPECT_DOUBLE_EQ(actual.received_traffic_rate,
+                   expected.received_traffic_rate);
+}
+
 }  // namespace
 }  // namespace xls::noc
@@ -15,6 +15,9 @@
 #ifndef XLS_NOC_SIMULATION_SIMULATOR_SHIMS_H_
 #define XLS_NOC_SIMULATION_SIMULATOR_SHIMS_H_
 
+#include <cstdint>
+
+#include "absl/status/status.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/flit.h"
 
@@ -28,6 +31,17 @@ namespace xls::noc {
 class NocSimulatorServiceShim {
  public:
   virtual absl::Status RunCycle() = 0;
+
+  // Returns the earliest cycle after "cycle" in which this service may act
+  // on an idle network.  Used by NocSimulator::FastForward to decide how
+  // many cycles may be skipped.
+  //
+  // The default never allows cycles to be skipped.
+  virtual int64_t GetNextActiveCycle(int64_t cycle) { return cycle + 1; }
+
+  // Called when the simulator skips directly to "cycle", so the next call to
+  // RunCycle() is for that cycle.
+  virtual absl::Status SkipToCycle(int64_t cycle) { return absl::OkStatus(); }
   virtual ~NocSimulatorServiceShim() = default;
 };
 
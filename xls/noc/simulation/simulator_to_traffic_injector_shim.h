@@ -32,6 +32,15 @@ class NocSimulatorToNocTrafficInjectorShim
   // Called by the simulator each cycle to request for traffic.
   absl::Status RunCycle() override { return traffic_injector_->RunCycle(); }
 
+  // Called by the simulator to find how many idle cycles can be skipped.
+  int64_t GetNextActiveCycle(int64_t cycle) override {
+    return traffic_injector_->GetNextPacketCycle();
+  }
+
+  absl::Status SkipToCycle(int64_t cycle) override {
+    return traffic_injector_->SkipToCycle(cycle);
+  }
+
   // Called by the traffic injector to inject traffic.
   absl::Status SendFlitAtTime(TimedDataFlit flit,
                               NetworkComponentId source) override {
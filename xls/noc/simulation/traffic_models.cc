@@ -42,8 +42,7 @@ std::vector<DataPacket> GeneralizedGeometricTrafficModel::GetNewCyclePackets(
   }
 
   // See if we have a burst of packets.
-  int64_t next_packet_delta =
-      random_interface_->GeneralizedGeometric(lambda_, burst_prob_);
+  int64_t next_packet_delta = NextPacketDelta();
   while (next_packet_delta == 0) {
     // New burst packet.  Rest of the packet fields other than size
     // will be filled later.
@@ -58,8 +57,7 @@ std::vector<DataPacket> GeneralizedGeometricTrafficModel::GetNewCyclePackets(
     XLS_CHECK(burst_packet.ok());
     packets.push_back(burst_packet.value());
 
-    next_packet_delta =
-        random_interface_->GeneralizedGeometric(lambda_, burst_prob_);
+    next_packet_delta = NextPacketDelta();
   }
 
   absl::StatusOr<DataPacket> future_packet =
@@ -77,6 +75,20 @@ std::vector<DataPacket> GeneralizedGeometricTrafficModel::GetNewCyclePackets(
   return packets;
 }
 
+int64_t GeneralizedGeometricTrafficModel::NextPacketDelta() {
+  if (sample_batch_size_ == 1) {
+    return random_interface_->GeneralizedGeometric(lambda_, burst_prob_);
+  }
+
+  if (next_packet_delta_index_ == packet_deltas_.size()) {
+    packet_deltas_.resize(sample_batch_size_);
+    random_interface_->GeneralizedGeometricBatch(
+        lambda_, burst_prob_, absl::MakeSpan(packet_deltas_));
+    next_packet_delta_index_ = 0;
+  }
+  return packet_deltas_[next_packet_delta_index_++];
+}
+
 GeneralizedGeometricTrafficModelBuilder::
     GeneralizedGeometricTrafficModelBuilder(double lambda, double burst_prob,
                                             int64_t packet_size_bits,
@@ -92,6 +104,7 @@ GeneralizedGeometricTrafficModelBuilder::Build() const {
   model->SetLambda(lambda_);
   model->SetBurstProb(burst_prob_);
   model->SetRandomNumberInterface(*random_interface_);
+  model->SetSampleBatchSize(sample_batch_size_);
   return model;
 }
 
@@ -16,6 +16,8 @@
 #define XLS_NOC_SIMULATION_TRAFFIC_MODELS_H_
 
 #include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <queue>
 #include <vector>
@@ -44,10 +46,15 @@ class TrafficModel {
   //       a call to GetNewCyclePackets(N) should not be called multiple times.
   // Note: The simulator will successively call GetNewCyclePackets(0),
   //       GetNewCyclePackets(1), GetNewCyclePackets(2), ...
-  //
-  // TODO(tedhong): 2021-06-27 Add an interface to support fast-forwarding.
+  //       unless GetNextPacketCycle() allows cycles to be skipped.
   virtual std::vector<DataPacket> GetNewCyclePackets(int64_t cycle) = 0;
 
+  // Returns a cycle before which GetNewCyclePackets() will return no packets,
+  // so that the calls for the cycles in between may be skipped.
+  //
+  // The default allows no cycles to be skipped.
+  virtual int64_t GetNextPacketCycle() const { return 0; }
+
   // Returns expected rate of traffic injected in MebiBytes Per Sec.
   virtual double ExpectedTrafficRateInMiBps(int64_t cycle_time_ps) const = 0;
 
@@ -143,6 +150,10 @@ class GeneralizedGeometricTrafficModel : public TrafficModel {
 
   std::vector<DataPacket> GetNewCyclePackets(int64_t cycle) override;
 
+  int64_t GetNextPacketCycle() const override {
+    return std::max<int64_t>(next_packet_cycle_, 0);
+  }
+
   double ExpectedTrafficRateInMiBps(int64_t cycle_time_ps) const override {
     double num_cycles = 1.0e12 / static_cast<double>(cycle_time_ps);
     double num_packets = lambda_ * num_cycles;
@@ -163,7 +174,20 @@ class GeneralizedGeometricTrafficModel : public TrafficModel {
     random_interface_ = &rnd;
   }
 
+  // Number of inter-arrival times drawn from the random number interface at
+  // once.  With a batch size of 1 (the default) each time is drawn when it is
+  // needed.  Larger batches precompute the injection schedule in bulk; the
+  // schedule of a flow is unchanged, but flows sharing a random number
+  // interface interleave their draws differently.
+  int64_t GetSampleBatchSize() const { return sample_batch_size_; }
+  void SetSampleBatchSize(int64_t batch_size) {
+    sample_batch_size_ = std::max<int64_t>(batch_size, 1);
+  }
+
  private:
+  // Returns the number of cycles until the next packet is sent.
+  int64_t NextPacketDelta();
+
   DataPacket next_packet_;
 
   double lambda_;      // Lambda of the distribution (unit 1/cycle)
@@ -172,6 +196,12 @@ class GeneralizedGeometricTrafficModel : public TrafficModel {
   int64_t next_packet_cycle_;
 
   RandomNumberInterface* random_interface_;
+
+  int64_t sample_batch_size_ = 1;
+
+  // Inter-arrival times drawn ahead of time when sample_batch_size_ > 1.
+  std::vector<int64_t> packet_deltas_;
+  int64_t next_packet_delta_index_ = 0;
 };
 
 class GeneralizedGeometricTrafficModelBuilder
@@ -182,6 +212,12 @@ class GeneralizedGeometricTrafficModelBuilder
                                           int64_t packet_size_bits,
                                           RandomNumberInterface& rnd);
 
+  GeneralizedGeometricTrafficModelBuilder& SetSampleBatchSize(
+      int64_t batch_size) {
+    sample_batch_size_ = batch_size;
+    return *this;
+  }
+
   absl::StatusOr<std::unique_ptr<GeneralizedGeometricTrafficModel>> Build()
       const;
 
@@ -190,6 +226,8 @@ class GeneralizedGeometricTrafficModelBuilder
   double burst_prob_;  // Probability of a burst
 
   RandomNumberInterface* random_interface_;
+
+  int64_t sample_batch_size_ = 1;
 };
 
 // Models the traffic injected into a single source according at specified
@@ -205,6 +243,12 @@ class ReplayTrafficModel : public TrafficModel {
 
   std::vector<DataPacket> GetNewCyclePackets(int64_t cycle) override;
 
+  int64_t GetNextPacketCycle() const override {
+    return clock_cycle_iter_ == clock_cycles_.end()
+               ? std::numeric_limits<int64_t>::max()
+               : *clock_cycle_iter_;
+  }
+
   double ExpectedTrafficRateInMiBps(int64_t cycle_time_ps) const override;
 
   // Sets clock cycles to list and sorts the complete list of clock cycle.
@@ -255,7 +299,14 @@ class TrafficModelMonitor {
   // Returns observed rate of traffic in MebiBytes Per Second seen in all
   // previous calls to AcceptNewPackets().
   double MeasuredTrafficRateInMiBps(int64_t cycle_time_ps) const {
-    double total_sec = static_cast<double>(max_cycle_ + 1) *
+    return MeasuredTrafficRateInMiBps(cycle_time_ps, max_cycle_);
+  }
+
+  // As above, but measured over all cycles up to and including "cycle", even
+  // if AcceptNewPackets() was not called for the later ones.
+  double MeasuredTrafficRateInMiBps(int64_t cycle_time_ps,
+                                    int64_t cycle) const {
+    double total_sec = static_cast<double>(std::max(max_cycle_, cycle) + 1) *
                        static_cast<double>(cycle_time_ps) * 1.0e-12;
     double bits_per_sec = static_cast<double>(num_bits_sent_) / total_sec;
     return bits_per_sec / 1024.0 / 1024.0 / 8.0;
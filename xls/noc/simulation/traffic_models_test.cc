@@ -14,6 +14,8 @@
 
 #include "xls/noc/simulation/traffic_models.h"
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -106,6 +108,40 @@ TEST(TrafficModelsTest, GeneralizedGeometricModelBuilderTest) {
   EXPECT_EQ(model->GetDestinationIndex(), 3);
 }
 
+TEST(TrafficModelsTest, GeneralizedGeometricModelBatchedSamplingTest) {
+  double lambda = 0.2;
+  double burst_prob = 0.1;
+  int64_t packet_size_bits = 128;
+
+  RandomNumberInterface rnd0;
+  RandomNumberInterface rnd1;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<GeneralizedGeometricTrafficModel> model0,
+      GeneralizedGeometricTrafficModelBuilder(lambda, burst_prob,
+                                              packet_size_bits, rnd0)
+          .Build());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<GeneralizedGeometricTrafficModel> model1,
+      GeneralizedGeometricTrafficModelBuilder(lambda, burst_prob,
+                                              packet_size_bits, rnd1)
+          .SetSampleBatchSize(64)
+          .Build());
+  EXPECT_EQ(model0->GetSampleBatchSize(), 1);
+  EXPECT_EQ(model1->GetSampleBatchSize(), 64);
+
+  // Precomputing the inter-arrival times does not change the schedule of a
+  // model with its own random number interface.
+  int64_t num_packets = 0;
+  for (int64_t cycle = 0; cycle < 100'000; ++cycle) {
+    ASSERT_EQ(model0->GetNextPacketCycle(), model1->GetNextPacketCycle());
+    std::vector<DataPacket> packets0 = model0->GetNewCyclePackets(cycle);
+    std::vector<DataPacket> packets1 = model1->GetNewCyclePackets(cycle);
+    ASSERT_EQ(packets0.size(), packets1.size());
+    num_packets += packets0.size();
+  }
+  EXPECT_GT(num_packets, 0);
+}
+
 TEST(TrafficModelsTest, ReplayModelTest) {
   int64_t packet_size_bits = 128;
 
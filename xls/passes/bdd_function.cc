@@ -15,6 +15,7 @@
 #include "xls/passes/bdd_function.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -22,6 +23,7 @@
 #include <variant>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/status/statusor.h"
@@ -31,6 +33,7 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/data_structures/union_find.h"
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/ir/abstract_evaluator.h"
 #include "xls/ir/abstract_node_evaluator.h"
@@ -42,6 +45,11 @@
 namespace xls {
 namespace {
 
+// The minimum number of BDD nodes before garbage collecting the BDD during
+// construction. After each collection the threshold is set to twice the number
+// of live nodes so the cost of collection is amortized over node creation.
+constexpr int64_t kMinGarbageCollectionThreshold = 64 * 1024;
+
 // Construct a BDD-based abstract evaluator. The expressions in the BDD
 // saturates at a particular number of paths from the expression node to the
 // terminal nodes 0 and 1 in the BDD. When the path limit is met, a new BDD
@@ -138,8 +146,32 @@ class SaturatingBddEvaluator
   BinaryDecisionDiagram* bdd_;
 };
 
+// Returns whether `node` is a two-operand comparison or addition which can be
+// expressed compactly in the BDD if the variables of its operands are
+// interleaved.
+bool BenefitsFromInterleaving(Node* node) {
+  switch (node->op()) {
+    case Op::kAdd:
+    case Op::kSub:
+    case Op::kEq:
+    case Op::kNe:
+    case Op::kUGe:
+    case Op::kUGt:
+    case Op::kULe:
+    case Op::kULt:
+      return node->operand(0)->GetType()->GetFlatBitCount() <= 64 &&
+             !node->operand(0)->Is<Literal>() &&
+             !node->operand(1)->Is<Literal>();
+    default:
+      return false;
+  }
+}
+
 // Returns whether the given op should be included in BDD computations.
-bool ShouldEvaluate(Node* node) {
+// `interleaved` returns whether the BDD variables of the two nodes passed to it
+// are interleaved.
+bool ShouldEvaluate(Node* node,
+                    const std::function<bool(Node*, Node*)>& interleaved) {
   const int64_t kMaxWidth = 64;
   auto is_wide = [](Node* n) {
     return n->GetType()->GetFlatBitCount() > kMaxWidth;
@@ -190,25 +222,33 @@ bool ShouldEvaluate(Node* node) {
       return true;
 
     // Comparison operation are only expressed if at least one of the operands
-    // is a literal. This avoids the potential exponential explosion of BDD
-    // nodes which can occur with pathological variable ordering.
+    // is a literal or the variables of the operands are interleaved. This
+    // avoids the potential exponential explosion of BDD nodes which can occur
+    // with pathological variable ordering.
     case Op::kUGe:
     case Op::kUGt:
     case Op::kULe:
     case Op::kULt:
     case Op::kEq:
     case Op::kNe:
-      return node->operand(0)->Is<Literal>() || node->operand(1)->Is<Literal>();
+      return node->operand(0)->Is<Literal>() ||
+             node->operand(1)->Is<Literal>() ||
+             interleaved(node->operand(0), node->operand(1));
 
-    // Arithmetic ops
+    // Addition and subtraction are linear in the operand width when the
+    // operand variables are interleaved.
     case Op::kAdd:
+    case Op::kSub:
+      return !is_wide(node) &&
+             interleaved(node->operand(0), node->operand(1));
+
+    // Arithmetic ops
     case Op::kSMul:
     case Op::kUMul:
     case Op::kSMulp:
     case Op::kUMulp:
     case Op::kNeg:
     case Op::kSDiv:
-    case Op::kSub:
     case Op::kUDiv:
     case Op::kSMod:
     case Op::kUMod:
@@ -290,9 +330,88 @@ bool ShouldEvaluate(Node* node) {
     return v;
   };
 
+  // Nodes whose bits are modeled as BDD variables (leaves) are grouped with the
+  // leaves they are compared or added with. The variables of all the leaves in
+  // a group are interleaved (bit 0 of each leaf, then bit 1 of each leaf, etc)
+  // which keeps the BDDs of comparisons and sums of any two of the leaves
+  // linear in the bit width rather than exponential as with the naive ordering
+  // of one leaf after another.
+  absl::flat_hash_set<Node*> leaves;
+  UnionFind<Node*> leaf_groups;
+  auto interleaved = [&](Node* a, Node* b) {
+    return leaves.contains(a) && leaves.contains(b) &&
+           leaf_groups.Find(a) == leaf_groups.Find(b);
+  };
+  auto is_modeled_as_variables = [&](Node* node) {
+    return !ShouldEvaluate(node, interleaved) ||
+           (node_filter.has_value() && !node_filter.value()(node)) ||
+           std::any_of(node->operands().begin(), node->operands().end(),
+                       [](Node* o) { return !o->GetType()->IsBits(); });
+  };
+  std::vector<Node*> topo_sort = TopoSort(f).AsVector();
+  std::vector<Node*> leaf_order;
+  for (Node* node : topo_sort) {
+    if (!node->GetType()->IsBits()) {
+      continue;
+    }
+    if (BenefitsFromInterleaving(node) &&
+        leaves.contains(node->operand(0)) &&
+        leaves.contains(node->operand(1)) &&
+        (!node_filter.has_value() || node_filter.value()(node))) {
+      leaf_groups.Union(node->operand(0), node->operand(1));
+    }
+    if (is_modeled_as_variables(node)) {
+      leaves.insert(node);
+      leaf_groups.Insert(node);
+      leaf_order.push_back(node);
+    }
+  }
+
+  // Create the variables of the leaves, a group at a time. Groups are ordered
+  // by their first leaf in topological order.
+  absl::flat_hash_map<Node*, std::vector<Node*>> group_members;
+  for (Node* leaf : leaf_order) {
+    group_members[leaf_groups.Find(leaf)].push_back(leaf);
+  }
+  absl::flat_hash_map<Node*, SaturatingBddNodeVector> leaf_variables;
+  for (Node* leaf : leaf_order) {
+    std::vector<Node*>& members = group_members.at(leaf_groups.Find(leaf));
+    if (members.empty()) {
+      continue;
+    }
+    int64_t max_width = 0;
+    for (Node* member : members) {
+      max_width = std::max(max_width, member->BitCountOrDie());
+    }
+    for (int64_t i = 0; i < max_width; ++i) {
+      for (Node* member : members) {
+        if (i < member->BitCountOrDie()) {
+          leaf_variables[member].push_back(bdd_function->bdd().NewVariable());
+        }
+      }
+    }
+    XLS_VLOG_IF(3, members.size() > 1) << absl::StreamFormat(
+        "  interleaved the variables of %d nodes", members.size());
+    members.clear();
+  }
+
   XLS_VLOG(3) << "BDD expressions:";
-  absl::flat_hash_map<Node*, SaturatingBddNodeVector> values;
-  for (Node* node : TopoSort(f)) {
+  NodeMap<SaturatingBddNodeVector> values(f);
+
+  // Frees the BDD nodes which are not part of the expression of any XLS node
+  // evaluated so far such as intermediate results and the expressions of bits
+  // which exceeded the path limit.
+  auto collect_garbage = [&]() {
+    std::vector<BddNodeIndex> roots;
+    for (const auto& [_, node_values] : values) {
+      for (const SaturatingBddNodeIndex& value : node_values) {
+        roots.push_back(std::get<BddNodeIndex>(value));
+      }
+    }
+    bdd_function->bdd().GarbageCollect(roots);
+  };
+  int64_t gc_threshold = kMinGarbageCollectionThreshold;
+  for (Node* node : topo_sort) {
     XLS_VLOG(3) << "node: " << node->ToString();
     if (!node->GetType()->IsBits()) {
       XLS_VLOG(3) << "  skipping node, type is not bits: "
@@ -301,13 +420,11 @@ bool ShouldEvaluate(Node* node) {
     }
     // If we shouldn't evaluate this node, the node is to be modeled as
     // variables, or the node includes some non-bits-typed operands, then just
-    // create a vector of new BDD variables for this node.
-    if (!ShouldEvaluate(node) ||
-        (node_filter.has_value() && !node_filter.value()(node)) ||
-        std::any_of(node->operands().begin(), node->operands().end(),
-                    [](Node* o) { return !o->GetType()->IsBits(); })) {
+    // use the BDD variables created for this node above.
+    if (leaves.contains(node)) {
       XLS_VLOG(2) << "  node filtered out.";
-      values[node] = create_new_node_vector(node);
+      values[node] = std::move(leaf_variables.at(node));
+      bdd_function->saturated_expressions_.insert(node);
     } else {
       XLS_VLOG(2) << "  computing BDD value...";
       std::vector<SaturatingBddNodeVector> operand_values;
@@ -328,6 +445,11 @@ bool ShouldEvaluate(Node* node) {
         }
       }
     }
+    if (bdd_function->bdd().size() > gc_threshold) {
+      collect_garbage();
+      gc_threshold = std::max(kMinGarbageCollectionThreshold,
+                              2 * bdd_function->bdd().size());
+    }
     XLS_VLOG(5) << "  " << node->GetName() << ":";
     for (int64_t i = 0; i < node->BitCountOrDie(); ++i) {
       XLS_VLOG(5) << absl::StreamFormat(
@@ -338,6 +460,8 @@ bool ShouldEvaluate(Node* node) {
     }
   }
 
+  collect_garbage();
+
   // Copy over the vector and BDD variables into the node map which is exposed
   // via the BddFunction interface. At this point any TooManyPaths sentinel
   // values have been replaced with new Bdd variables.
@@ -356,7 +480,7 @@ absl::StatusOr<Value> BddFunction::Evaluate(
   Function* function = func_base_->AsFunctionOrDie();
 
   // Map containing the result of each node.
-  absl::flat_hash_map<const Node*, Value> values;
+  NodeMap<Value> values(func_base_);
   // Map of the BDD variable values.
   absl::flat_hash_map<BddNodeIndex, bool> bdd_variable_values;
   XLS_RET_CHECK_EQ(args.size(), function->params().size());
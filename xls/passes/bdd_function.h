@@ -20,18 +20,18 @@
 #include <optional>
 #include <vector>
 
-#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "xls/common/logging/logging.h"
 #include "xls/data_structures/binary_decision_diagram.h"
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/function.h"
+#include "xls/ir/node_map.h"
 #include "xls/ir/op.h"
 
 namespace xls {
 
 using BddNodeVector = std::vector<BddNodeIndex>;
-using NodeMap = absl::flat_hash_map<const Node*, BddNodeVector>;
 
 // A class which represents an XLS function using a binary decision diagram
 // (BDD). The BDD is constructed by an abstract evaluation of the operations in
@@ -41,6 +41,11 @@ using NodeMap = absl::flat_hash_map<const Node*, BddNodeVector>;
 // evaluated as they generally produce very large BDDs. Non-bits types are
 // skipped as well.
 //
+// The bits of nodes which are not evaluated are modeled as BDD variables. The
+// variables of such nodes which are compared with or added to each other are
+// interleaved so these comparisons and additions have BDDs linear in the bit
+// width and can be evaluated precisely.
+//
 // For each bits-typed XLS Node, BddFunction holds a BddNodeVector which is a
 // vector of BDD nodes corresponding to the expression for each bit in the XLS
 // Node output.
@@ -83,14 +88,14 @@ class BddFunction {
   absl::StatusOr<Value> Evaluate(absl::Span<const Value> args) const;
 
  private:
-  explicit BddFunction(FunctionBase* f) : func_base_(f) {}
+  explicit BddFunction(FunctionBase* f) : func_base_(f), node_map_(f) {}
 
   FunctionBase* func_base_;
   BinaryDecisionDiagram bdd_;
 
   // A map from XLS Node to vector of BDD nodes representing the XLS Node's
   // expression.
-  NodeMap node_map_;
+  NodeMap<BddNodeVector> node_map_;
 
   // Set containing the Nodes which have exceeded the maximum number of paths
   // from the XLS node's BDD node to the terminal nodes 0 and 1 in the
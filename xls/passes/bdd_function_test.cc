@@ -114,6 +114,38 @@ TEST_F(BddFunctionTest, Parity) {
   }
 }
 
+TEST_F(BddFunctionTest, InterleavedComparisonAndAddition) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* t = p->GetBitsType(32);
+  BValue x = fb.Param("x", t);
+  BValue y = fb.Param("y", t);
+  BValue x_lt_y = fb.ULt(x, y);
+  BValue sum = fb.Add(x, y);
+  fb.Concat({x_lt_y, sum});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  // With the variables of `x` and `y` interleaved the comparison and the sum
+  // are expressed in the BDD (rather than modeled as new variables) and the
+  // BDD stays small.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BddFunction> bdd_function,
+                           BddFunction::Run(f));
+  EXPECT_FALSE(bdd_function->bdd().IsVariableBaseNode(
+      bdd_function->GetBddNode(x_lt_y.node(), 0)));
+  EXPECT_FALSE(bdd_function->bdd().IsVariableBaseNode(
+      bdd_function->GetBddNode(sum.node(), 31)));
+  EXPECT_EQ(bdd_function->bdd().variable_count(), 64);
+  EXPECT_LT(bdd_function->bdd().size(), 10000);
+
+  std::minstd_rand engine;
+  for (int64_t i = 0; i < 100; ++i) {
+    std::vector<Value> inputs = RandomFunctionArguments(f, &engine);
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Value expected, DropInterpreterEvents(InterpretFunction(f, inputs)));
+    EXPECT_THAT(bdd_function->Evaluate(inputs), IsOkAndHolds(expected));
+  }
+}
+
 TEST_F(BddFunctionTest, BenchmarkTest) {
   // Run samples through various benchmarks and verify against the interpreter.
   //
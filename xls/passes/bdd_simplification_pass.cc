@@ -37,6 +37,7 @@
 #include "xls/passes/bdd_query_engine.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/query_engine_cache.h"
 
 namespace xls {
 
@@ -330,18 +331,24 @@ absl::StatusOr<bool> SimplifyNode(Node* node, const QueryEngine& query_engine,
 absl::StatusOr<bool> BddSimplificationPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
-  BddQueryEngine query_engine(BddFunction::kDefaultPathLimit);
-  XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
+  BddQueryEngine local_query_engine(BddFunction::kDefaultPathLimit);
+  BddQueryEngine* query_engine = &local_query_engine;
+  if (options.query_engine_cache != nullptr) {
+    XLS_ASSIGN_OR_RETURN(query_engine,
+                         options.query_engine_cache->GetBddQueryEngine(f));
+  } else {
+    XLS_RETURN_IF_ERROR(local_query_engine.Populate(f).status());
+  }
 
   bool modified = false;
   for (Node* node : TopoSort(f)) {
     XLS_ASSIGN_OR_RETURN(bool node_modified,
-                         SimplifyNode(node, query_engine, opt_level_));
+                         SimplifyNode(node, *query_engine, opt_level_));
     modified |= node_modified;
   }
 
   XLS_ASSIGN_OR_RETURN(bool selects_collapsed,
-                       CollapseSelectChains(f, query_engine));
+                       CollapseSelectChains(f, *query_engine));
 
   return modified || selects_collapsed;
 }
@@ -15,7 +15,9 @@
 #include "xls/passes/bit_slice_simplification_pass.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <deque>
+#include <optional>
 #include <vector>
 
 #include "absl/status/statusor.h"
@@ -323,10 +325,16 @@ absl::StatusOr<bool> BitSliceSimplificationPass::RunOnFunctionBaseInternal(
     PassResults* results) const {
   bool changed = false;
 
+  // Each simplification below matches a node and its immediate operands (whose
+  // own operand and user changes refresh their change stamps) so only nodes in
+  // the neighborhood of a change since the last run need be considered.
+  std::optional<int64_t> changed_since = LastRunChangeStamp(f);
+
   // Replace dynamic bit slices with literal indices with a non-dynamic bit
   // slice.
   for (Node* node : f->nodes()) {
-    if (node->Is<DynamicBitSlice>() && node->operand(1)->Is<Literal>()) {
+    if (node->Is<DynamicBitSlice>() && node->operand(1)->Is<Literal>() &&
+        NodeOrOperandsChangedSince(node, changed_since)) {
       int64_t result_width = node->BitCountOrDie();
       int64_t operand_width = node->operand(0)->BitCountOrDie();
       const Bits& start_bits = node->operand(1)->As<Literal>()->value().bits();
@@ -351,7 +359,8 @@ absl::StatusOr<bool> BitSliceSimplificationPass::RunOnFunctionBaseInternal(
   // bit slices and concats.
   for (Node* node : f->nodes()) {
     if (node->Is<BitSliceUpdate>() &&
-        node->As<BitSliceUpdate>()->start()->Is<Literal>()) {
+        node->As<BitSliceUpdate>()->start()->Is<Literal>() &&
+        NodeOrOperandsChangedSince(node, changed_since)) {
       BitSliceUpdate* update = node->As<BitSliceUpdate>();
       const Bits start = update->start()->As<Literal>()->value().bits();
       if (bits_ops::UGreaterThanOrEqual(start, update->BitCountOrDie())) {
@@ -438,7 +447,8 @@ absl::StatusOr<bool> BitSliceSimplificationPass::RunOnFunctionBaseInternal(
 
   std::deque<BitSlice*> worklist;
   for (Node* node : f->nodes()) {
-    if (node->Is<BitSlice>()) {
+    if (node->Is<BitSlice>() &&
+        NodeOrOperandsChangedSince(node, changed_since)) {
       worklist.push_back(node->As<BitSlice>());
     }
   }
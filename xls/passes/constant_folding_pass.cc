@@ -15,6 +15,8 @@
 #include "xls/passes/constant_folding_pass.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <optional>
 #include <vector>
 
 #include "absl/algorithm/container.h"
@@ -59,8 +61,16 @@ bool NodeIsConstantFoldable(Node* node) {
 absl::StatusOr<bool> ConstantFoldingPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
+  // Foldability depends only on the operands of a node, and replacing an
+  // operand refreshes the change stamp of the user, so nodes unchanged since
+  // the last run of this pass can be skipped. Users of folded nodes are
+  // refreshed as they are folded and so are still visited in this run.
+  std::optional<int64_t> changed_since = LastRunChangeStamp(f);
   bool changed = false;
   for (Node* node : TopoSort(f)) {
+    if (changed_since.has_value() && node->change_stamp() <= *changed_since) {
+      continue;
+    }
     // Fold any non-side-effecting op with constant parameters. Avoid any types
     // with tokens because literal tokens are not allowed.
     // TODO(meheff): 2019/6/26 Consider not folding loops with large trip counts
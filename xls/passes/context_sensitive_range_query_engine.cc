@@ -28,6 +28,9 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
@@ -481,15 +484,17 @@ class BackPropagate final : public DfsVisitorWithDefault {
 
 // Class to hold givens extracted from select context.
 //
-// This also restricts the range analysis to end at the select we are
-// specializing on since nodes below it can only be specialized to this select
-// if we moved them into the selects branches. This sort of transform is not one
-// we currently perform.
+// The analysis only visits `nodes`, which must be in topological order. For a
+// select context these are the nodes whose ranges the context can affect
+// (ending at the select we are specializing on since nodes below it can only be
+// specialized to this select if we moved them into the selects branches. This
+// sort of transform is not one we currently perform) plus their operands, whose
+// ranges are given.
 class ContextGivens final : public RangeDataProvider {
  public:
-  ContextGivens(const std::vector<Node*>& topo_sort, const Node* finish,
+  ContextGivens(absl::Span<Node* const> nodes,
                 const absl::flat_hash_map<Node*, RangeData>& data)
-      : topo_sort_(topo_sort), finish_(finish), data_(data) {}
+      : nodes_(nodes), data_(data) {}
 
   std::optional<RangeData> GetKnownIntervals(Node* node) final {
     if (data_.contains(node)) {
@@ -499,21 +504,30 @@ class ContextGivens final : public RangeDataProvider {
   }
 
   absl::Status IterateFunction(DfsVisitor* visitor) final {
-    for (Node* n : topo_sort_) {
-      if (n == finish_) {
-        break;
-      }
+    for (Node* n : nodes_) {
       XLS_RETURN_IF_ERROR(n->VisitSingleNode(visitor));
     }
     return absl::OkStatus();
   }
 
  private:
-  const std::vector<Node*>& topo_sort_;
-  const Node* finish_;
+  absl::Span<Node* const> nodes_;
   const absl::flat_hash_map<Node*, RangeData>& data_;
 };
 
+// A set of equivalent predicate states (same selector and arm) along with the
+// givens they imply and the nodes whose ranges need to be recomputed.
+struct Context {
+  std::vector<PredicateState> states;
+  absl::flat_hash_map<Node*, RangeData> givens;
+  // Nodes to visit, in topological order.
+  std::vector<Node*> nodes;
+  // Number of nodes whose ranges the context can refine and the sum of their
+  // bit widths. The latter is used to prioritize contexts.
+  int64_t cone_size = 0;
+  int64_t cone_bit_count = 0;
+};
+
 // Helper to perform the actual analysis and hold together all data needed.
 // This is used to fill in the fields of the actual query engine and therefore
 // does not own the arena/map that it fills in.
@@ -522,15 +536,24 @@ class Analysis {
   Analysis(
       RangeQueryEngine& base_range,
       std::vector<std::unique_ptr<const RangeQueryEngine>>& arena,
-      absl::flat_hash_map<PredicateState, const RangeQueryEngine*>& engines)
-      : base_range_(base_range), arena_(arena), engines_(engines) {}
+      absl::flat_hash_map<PredicateState, const RangeQueryEngine*>& engines,
+      int64_t max_contexts, ContextSensitiveRangeQueryEngine::Stats& stats)
+      : base_range_(base_range),
+        arena_(arena),
+        engines_(engines),
+        max_contexts_(max_contexts),
+        stats_(stats) {}
 
   absl::StatusOr<ReachedFixpoint> Execute(FunctionBase* f) {
+    absl::Time start = absl::Now();
     // Get the topological sort once so we don't recalculate it each time.
     topo_sort_ = TopoSort(f).AsVector();
+    for (int64_t i = 0; i < topo_sort_.size(); ++i) {
+      topo_index_[topo_sort_[i]] = i;
+    }
     // Get the base case.
     absl::flat_hash_map<Node*, RangeData> empty;
-    ContextGivens base_givens(topo_sort_, /*finish=*/nullptr, /* data=*/empty);
+    ContextGivens base_givens(topo_sort_, /* data=*/empty);
     XLS_RETURN_IF_ERROR(base_range_.PopulateWithGivens(base_givens).status());
 
     // Get every possible one-hot state.
@@ -547,45 +570,133 @@ class Analysis {
       }
     }
     // Bucket states into equivalence classes. Any predicate-states where the
-    // arm and selector are identical
-    absl::flat_hash_map<std::pair<Node*, PredicateState::ArmT>,
-                        std::vector<PredicateState>>
-        equivalences;
-    equivalences.reserve(all_states_.size());
+    // arm and selector are identical. Classes are kept in order of first
+    // appearance so the analysis is deterministic.
+    absl::flat_hash_map<std::pair<Node*, PredicateState::ArmT>, int64_t>
+        equivalence_index;
+    equivalence_index.reserve(all_states_.size());
+    std::vector<Context> contexts;
     for (PredicateState s : all_states_) {
-      equivalences.try_emplace({s.node()->As<Select>()->selector(), s.arm()})
-          .first->second.push_back(s);
+      auto [it, inserted] = equivalence_index.try_emplace(
+          {s.node()->As<Select>()->selector(), s.arm()}, contexts.size());
+      if (inserted) {
+        contexts.emplace_back();
+      }
+      contexts[it->second].states.push_back(s);
     }
-    // NB We don't care what order we examine each equivalence (since all are
-    // disjoint).
-    for (const auto& [_, states] : equivalences) {
+    for (Context& context : contexts) {
       // Since the all_states_ is in topo the last equiv state is usable for
       // everything.
-      // We don't care what order we calculate the equivalences because each is
-      // fully disjoint from one another as we consider only a single condition
-      // to be true at a time.
-      XLS_ASSIGN_OR_RETURN(auto tmp, CalculateRangeGiven(states.back()));
+      XLS_ASSIGN_OR_RETURN(context.givens,
+                           ExtractKnownData(context.states.back()));
+      ComputeAffectedNodes(context.states.back().node(), context);
+    }
+
+    // If not every context can be analyzed, analyze the ones which can refine
+    // the most bits first. We don't otherwise care what order we calculate the
+    // equivalences because each is fully disjoint from one another as we
+    // consider only a single condition to be true at a time.
+    std::stable_sort(contexts.begin(), contexts.end(),
+                     [](const Context& a, const Context& b) {
+                       return a.cone_bit_count > b.cone_bit_count;
+                     });
+    for (int64_t i = 0; i < contexts.size(); ++i) {
+      const Context& context = contexts[i];
+      ContextSensitiveRangeQueryEngine::ContextStats& context_stats =
+          stats_.contexts.emplace_back();
+      context_stats.state = context.states.back();
+      context_stats.equivalent_states = context.states.size();
+      context_stats.cone_size = context.cone_size;
+      context_stats.cone_bit_count = context.cone_bit_count;
+      if (max_contexts_ > 0 && i >= max_contexts_) {
+        // Over budget; queries given these states use the base ranges.
+        ++stats_.skipped_contexts;
+        continue;
+      }
+      absl::Time context_start = absl::Now();
+      XLS_ASSIGN_OR_RETURN(auto tmp, CalculateRangeGiven(context));
       auto result =
           arena_
               .emplace_back(std::make_unique<RangeQueryEngine>(std::move(tmp)))
               .get();
-      for (const PredicateState& ps : states) {
+      for (const PredicateState& ps : context.states) {
         engines_[ps] = result;
       }
+      context_stats.evaluated = true;
+      context_stats.duration = absl::Now() - context_start;
+      ++stats_.evaluated_contexts;
     }
+    stats_.total_duration = absl::Now() - start;
+    XLS_VLOG(2) << absl::StreamFormat(
+        "Context sensitive range analysis of %s: %d contexts analyzed, %d "
+        "skipped, took %s",
+        f->name(), stats_.evaluated_contexts, stats_.skipped_contexts,
+        absl::FormatDuration(stats_.total_duration));
     return ReachedFixpoint::Changed;
   }
 
  private:
-  absl::StatusOr<RangeQueryEngine> CalculateRangeGiven(PredicateState s) const {
+  absl::StatusOr<RangeQueryEngine> CalculateRangeGiven(
+      const Context& context) const {
     RangeQueryEngine result;
-    absl::flat_hash_map<Node*, RangeData> known_data;
-    XLS_ASSIGN_OR_RETURN(known_data, ExtractKnownData(s));
-    ContextGivens givens(topo_sort_, s.node(), known_data);
+    ContextGivens givens(context.nodes, context.givens);
     XLS_RETURN_IF_ERROR(result.PopulateWithGivens(givens).status());
     return result;
   }
 
+  // Finds the nodes before `finish` whose ranges may differ from the base case
+  // given `context.givens`: the givens and everything they transitively feed.
+  // Every other node keeps its unconditioned range, so only these nodes (and
+  // their operands, whose base ranges are added to the givens) are analyzed.
+  void ComputeAffectedNodes(Node* finish, Context& context) const {
+    int64_t finish_index = topo_index_.at(finish);
+    absl::flat_hash_set<Node*> cone;
+    std::vector<Node*> worklist;
+    for (const auto& [node, _] : context.givens) {
+      if (cone.insert(node).second) {
+        worklist.push_back(node);
+      }
+    }
+    while (!worklist.empty()) {
+      Node* node = worklist.back();
+      worklist.pop_back();
+      for (Node* user : node->users()) {
+        if (topo_index_.at(user) < finish_index && cone.insert(user).second) {
+          worklist.push_back(user);
+        }
+      }
+    }
+
+    absl::flat_hash_set<Node*> frontier;
+    for (Node* node : cone) {
+      context.cone_bit_count += node->GetType()->GetFlatBitCount();
+      for (Node* operand : node->operands()) {
+        if (!cone.contains(operand) && frontier.insert(operand).second) {
+          context.givens[operand] = BaseRangeData(operand);
+        }
+      }
+    }
+    context.cone_size = cone.size();
+    context.nodes.reserve(cone.size() + frontier.size());
+    context.nodes.insert(context.nodes.end(), cone.begin(), cone.end());
+    context.nodes.insert(context.nodes.end(), frontier.begin(), frontier.end());
+    absl::c_sort(context.nodes, [&](Node* a, Node* b) {
+      return topo_index_.at(a) < topo_index_.at(b);
+    });
+  }
+
+  // Returns the unconditioned range of `node`.
+  RangeData BaseRangeData(Node* node) const {
+    std::optional<TernaryVector> ternary;
+    if (node->GetType()->IsBits() && base_range_.IsTracked(node)) {
+      ternary = base_range_.GetTernary(node).Get({});
+    }
+    return RangeData{
+        .ternary = ternary,
+        .interval_set = base_range_.GetIntervalSetTree(node),
+    };
+  }
+
   absl::StatusOr<absl::flat_hash_map<Node*, RangeData>> ExtractKnownData(
       PredicateState s) const {
     XLS_RET_CHECK(!s.IsBasePredicate())
@@ -635,10 +746,13 @@ class Analysis {
   }
 
   std::vector<Node*> topo_sort_;
+  absl::flat_hash_map<Node*, int64_t> topo_index_;
   std::vector<PredicateState> all_states_;
   RangeQueryEngine& base_range_;
   std::vector<std::unique_ptr<const RangeQueryEngine>>& arena_;
   absl::flat_hash_map<PredicateState, const RangeQueryEngine*>& engines_;
+  int64_t max_contexts_;
+  ContextSensitiveRangeQueryEngine::Stats& stats_;
 };
 
 // A proxy query engine which specializes using select context.
@@ -744,7 +858,9 @@ class ProxyContextQueryEngine final : public QueryEngine {
 
 absl::StatusOr<ReachedFixpoint> ContextSensitiveRangeQueryEngine::Populate(
     FunctionBase* f) {
-  Analysis analysis(base_case_ranges_, arena_, one_hot_ranges_);
+  stats_ = Stats();
+  Analysis analysis(base_case_ranges_, arena_, one_hot_ranges_, max_contexts_,
+                    stats_);
   return analysis.Execute(f);
 }
 
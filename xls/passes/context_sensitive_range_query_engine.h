@@ -15,6 +15,7 @@
 #ifndef XLS_PASSES_CONTEXT_SENSITIVE_RANGE_QUERY_ENGINE_H_
 #define XLS_PASSES_CONTEXT_SENSITIVE_RANGE_QUERY_ENGINE_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -23,6 +24,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/bits.h"
@@ -46,9 +48,42 @@ namespace xls {
 // given their selector is at the appropriate value and propogating that down
 // for each single case. This means the engine is only able to provide
 // information for a single case at a time.
+//
+// Only the nodes a select context can affect (those fed by the values implied
+// by the selector, up to the select) are re-analyzed for it; all other nodes
+// share the unconditioned results.
 class ContextSensitiveRangeQueryEngine final : public QueryEngine {
  public:
-  ContextSensitiveRangeQueryEngine() = default;
+  // Statistics about a single analyzed (or skipped) context. Predicate states
+  // with the same selector and arm share a context.
+  struct ContextStats {
+    // The state the context was computed for.
+    PredicateState state;
+    // Number of predicate states sharing this context.
+    int64_t equivalent_states = 0;
+    // Number of nodes the context can refine and the sum of their bit widths.
+    int64_t cone_size = 0;
+    int64_t cone_bit_count = 0;
+    // Whether the context was analyzed, and how long that took.
+    bool evaluated = false;
+    absl::Duration duration;
+  };
+
+  struct Stats {
+    int64_t evaluated_contexts = 0;
+    int64_t skipped_contexts = 0;
+    // Total time spent in Populate, including the unconditioned analysis.
+    absl::Duration total_duration;
+    // Per-context statistics in the order contexts were considered.
+    std::vector<ContextStats> contexts;
+  };
+
+  // `max_contexts` is the maximum number of select contexts to analyze. When
+  // there are more, the contexts able to refine the largest number of bits are
+  // analyzed and specializing on any other context yields the unconditioned
+  // results. If 0, all contexts are analyzed.
+  explicit ContextSensitiveRangeQueryEngine(int64_t max_contexts = 0)
+      : max_contexts_(max_contexts) {}
 
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
 
@@ -109,7 +144,12 @@ class ContextSensitiveRangeQueryEngine final : public QueryEngine {
   std::unique_ptr<QueryEngine> SpecializeGivenPredicate(
       const absl::flat_hash_set<PredicateState>& state) const override;
 
+  // Returns statistics about the most recent call to Populate.
+  const Stats& stats() const { return stats_; }
+
  private:
+  int64_t max_contexts_;
+  Stats stats_;
   RangeQueryEngine base_case_ranges_;
   std::vector<std::unique_ptr<const RangeQueryEngine>> arena_;
   absl::flat_hash_map<PredicateState, const RangeQueryEngine*>
@@ -1673,6 +1673,66 @@ TEST_F(ContextSensitiveRangeQueryEngineTest, EqTuple) {
               AnyOf(Eq(x_ist), Eq(res_ist)));
 }
 
+TEST_F(ContextSensitiveRangeQueryEngineTest, ContextBudget) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+
+  // if (x == 12) { x + 10 } else { x }
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue x_cond = fb.Eq(x, fb.Literal(UBits(12, 8)));
+  BValue x_add = fb.Add(x, fb.Literal(UBits(10, 8)));
+  BValue x_res = fb.Select(x_cond, {x, x_add});
+  // if (y == 3) { y + 10 } else { y }
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue y_cond = fb.Eq(y, fb.Literal(UBits(3, 32)));
+  BValue y_add = fb.Add(y, fb.Literal(UBits(10, 32)));
+  BValue y_res = fb.Select(y_cond, {y, y_add});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Tuple({x_res, y_res})));
+
+  // Only the contexts of the select refining the wider values fit in the
+  // budget.
+  ContextSensitiveRangeQueryEngine engine(/*max_contexts=*/2);
+  XLS_ASSERT_OK(engine.Populate(f));
+  auto x_consequent = engine.SpecializeGivenPredicate(
+      {PredicateState(x_res.node()->As<Select>(), kConsequentArm)});
+  auto y_consequent = engine.SpecializeGivenPredicate(
+      {PredicateState(y_res.node()->As<Select>(), kConsequentArm)});
+
+  EXPECT_EQ(x_consequent->GetIntervals(x_add.node()),
+            BitsLTT(x_add.node(), {Interval::Maximal(8)}));
+  EXPECT_EQ(y_consequent->GetIntervals(y_add.node()),
+            BitsLTT(y_add.node(), {Interval::Precise(UBits(13, 32))}));
+  // Nodes outside the context's cone reuse the unconditioned results.
+  EXPECT_EQ(y_consequent->GetIntervals(x_add.node()),
+            engine.GetIntervals(x_add.node()));
+
+  const ContextSensitiveRangeQueryEngine::Stats& stats = engine.stats();
+  EXPECT_EQ(stats.evaluated_contexts, 2);
+  EXPECT_EQ(stats.skipped_contexts, 2);
+  ASSERT_EQ(stats.contexts.size(), 4);
+  for (int64_t i = 0; i < stats.contexts.size(); ++i) {
+    EXPECT_EQ(stats.contexts[i].evaluated, i < 2);
+    EXPECT_EQ(stats.contexts[i].state.node(),
+              i < 2 ? y_res.node() : x_res.node());
+    if (i > 0) {
+      EXPECT_GE(stats.contexts[i - 1].cone_bit_count,
+                stats.contexts[i].cone_bit_count);
+    }
+  }
+
+  // Without a budget every context is analyzed.
+  ContextSensitiveRangeQueryEngine unlimited;
+  XLS_ASSERT_OK(unlimited.Populate(f));
+  EXPECT_EQ(unlimited.stats().evaluated_contexts, 4);
+  EXPECT_EQ(unlimited.stats().skipped_contexts, 0);
+  EXPECT_EQ(unlimited
+                .SpecializeGivenPredicate({PredicateState(
+                    x_res.node()->As<Select>(), kConsequentArm)})
+                ->GetIntervals(x_add.node()),
+            BitsLTT(x_add.node(), {Interval::Precise(UBits(22, 8))}));
+}
+
 TEST_P(SignedRangeComparisonContextSensitiveRangeQueryEngineTest,
        UsedInTrueRange) {
   auto p = CreatePackage();
@@ -14,8 +14,12 @@
 
 #include "xls/passes/cse_pass.h"
 
+#include <cstdint>
+#include <optional>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/hash/hash.h"
 #include "absl/status/statusor.h"
 #include "xls/common/logging/logging.h"
@@ -53,10 +57,75 @@ absl::Span<Node* const> GetOperandsForCse(
   return *span_backing_store;
 }
 
+// Incremental form of RunCse which only considers nodes modified after the
+// change stamp `changed_since`. Equivalent nodes with operands have identical
+// operand lists so the candidates for a modified node are the users of its
+// first operand. Nullary nodes (literals, etc) are compared against all other
+// nullary nodes with the same op.
+absl::StatusOr<bool> RunIncrementalCse(
+    FunctionBase* f, absl::flat_hash_map<Node*, Node*>* replacements,
+    int64_t changed_since) {
+  std::vector<Node*> topo_order = TopoSort(f).AsVector();
+  absl::flat_hash_map<Op, std::vector<Node*>> nullary_nodes;
+  for (Node* node : topo_order) {
+    if (node->operand_count() == 0 && !OpIsSideEffecting(node->op())) {
+      nullary_nodes[node->op()].push_back(node);
+    }
+  }
+
+  bool changed = false;
+  absl::flat_hash_set<Node*> replaced;
+  for (Node* node : topo_order) {
+    // Nodes whose uses are replaced below have their users marked as changed
+    // so those users are visited later in the topological order.
+    if (node->change_stamp() <= changed_since ||
+        OpIsSideEffecting(node->op())) {
+      continue;
+    }
+    std::vector<Node*> node_span_backing_store;
+    absl::Span<Node* const> node_operands_for_cse =
+        GetOperandsForCse(node, &node_span_backing_store);
+    std::vector<Node*> candidates;
+    if (node_operands_for_cse.empty()) {
+      candidates = nullary_nodes.at(node->op());
+    } else {
+      candidates.assign(node_operands_for_cse.front()->users().begin(),
+                        node_operands_for_cse.front()->users().end());
+    }
+    for (Node* candidate : candidates) {
+      if (candidate == node || candidate->op() != node->op() ||
+          replaced.contains(candidate)) {
+        continue;
+      }
+      std::vector<Node*> candidate_span_backing_store;
+      if (node_operands_for_cse ==
+              GetOperandsForCse(candidate, &candidate_span_backing_store) &&
+          node->IsDefinitelyEqualTo(candidate)) {
+        XLS_VLOG(3) << absl::StreamFormat(
+            "Replacing %s with equivalent node %s", node->GetName(),
+            candidate->GetName());
+        XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(candidate));
+        if (replacements != nullptr) {
+          (*replacements)[node] = candidate;
+        }
+        replaced.insert(node);
+        changed = true;
+        break;
+      }
+    }
+  }
+  return changed;
+}
+
 }  // namespace
 
 absl::StatusOr<bool> RunCse(FunctionBase* f,
-                            absl::flat_hash_map<Node*, Node*>* replacements) {
+                            absl::flat_hash_map<Node*, Node*>* replacements,
+                            std::optional<int64_t> changed_since) {
+  if (changed_since.has_value()) {
+    return RunIncrementalCse(f, replacements, *changed_since);
+  }
+
   // To improve efficiency, bucket potentially common nodes together. The
   // bucketing is done via an int64_t hash value which is constructed from the
   // op() of the node and the uid's of the node's operands.
@@ -117,7 +186,7 @@ absl::StatusOr<bool> RunCse(FunctionBase* f,
 absl::StatusOr<bool> CsePass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
-  return RunCse(f, nullptr);
+  return RunCse(f, nullptr, LastRunChangeStamp(f));
 }
 
 }  // namespace xls
@@ -15,6 +15,10 @@
 #ifndef XLS_PASSES_CSE_PASS_H_
 #define XLS_PASSES_CSE_PASS_H_
 
+#include <cstdint>
+#include <optional>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "xls/ir/function.h"
 #include "xls/passes/optimization_pass.h"
@@ -27,8 +31,15 @@ namespace xls {
 // to the `replacements` hash map if it is not `nullptr`. Note that for many
 // common uses of the `replacements` map, you'll want to compute the transitive
 // closure of the relation rather than using it as-is.
-absl::StatusOr<bool> RunCse(FunctionBase* f,
-                            absl::flat_hash_map<Node*, Node*>* replacements);
+//
+// If `changed_since` is given, it must be a change stamp (see
+// Node::change_stamp) at which `f` had no common subexpressions, for example
+// the stamp at the start of a previous CSE run. Only nodes modified after that
+// stamp are then considered for replacement since two equivalent nodes cannot
+// both be unmodified.
+absl::StatusOr<bool> RunCse(
+    FunctionBase* f, absl::flat_hash_map<Node*, Node*>* replacements,
+    std::optional<int64_t> changed_since = std::nullopt);
 
 // Computes the fixed point of a strict partial order, i.e.: the relation that
 // solves the equation `F = R ∘ F` where `R` is the given strict partial order.
@@ -15,6 +15,7 @@
 #include "xls/passes/cse_pass.h"
 
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -25,6 +26,7 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/passes/dce_pass.h"
 #include "xls/passes/optimization_pass.h"
@@ -231,5 +233,41 @@ TEST_F(CsePassTest, NonCommutativeOperands) {
   EXPECT_NE(f->return_value()->operand(0), f->return_value()->operand(1));
 }
 
+TEST_F(CsePassTest, IncrementalRerun) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  BValue x = fb.Param("x", u32);
+  BValue y = fb.Param("y", u32);
+  BValue sum = fb.Add(x, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Negate(sum)));
+
+  // Reusing the pass object lets the second and later runs skip nodes which are
+  // unchanged since the previous run.
+  CsePass cse;
+  PassResults results;
+  EXPECT_THAT(cse.RunOnFunctionBase(f, OptimizationPassOptions(), &results),
+              IsOkAndHolds(false));
+
+  // Add a duplicate of neg(add(x, y)) and make the function return both.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * new_add, f->MakeNode<BinOp>(SourceInfo(), FindNode("x", f),
+                                         FindNode("y", f), Op::kAdd));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * new_neg, f->MakeNode<UnOp>(SourceInfo(), new_add, Op::kNeg));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * tuple, f->MakeNode<Tuple>(
+                        SourceInfo(),
+                        std::vector<Node*>{f->return_value(), new_neg}));
+  XLS_ASSERT_OK(f->set_return_value(tuple));
+
+  EXPECT_THAT(cse.RunOnFunctionBase(f, OptimizationPassOptions(), &results),
+              IsOkAndHolds(true));
+  EXPECT_EQ(f->return_value()->operand(0), f->return_value()->operand(1));
+  EXPECT_THAT(cse.RunOnFunctionBase(f, OptimizationPassOptions(), &results),
+              IsOkAndHolds(false));
+}
+
 }  // namespace
 }  // namespace xls
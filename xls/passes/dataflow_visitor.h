@@ -15,13 +15,15 @@
 #ifndef XLS_PASSES_DATAFLOW_VISITOR_H_
 #define XLS_PASSES_DATAFLOW_VISITOR_H_
 
-#include "absl/container/flat_hash_map.h"
+#include <vector>
+
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/node.h"
+#include "xls/ir/node_map.h"
 
 namespace xls {
 
@@ -50,21 +52,20 @@ template <typename T>
 class DataFlowVisitor : public DfsVisitorWithDefault {
  public:
   absl::Status HandleTuple(Tuple* tuple) override {
-    // Use InlinedVector to avoid std::vector<bool> abomination.
-    absl::InlinedVector<T, 1> elements;
+    std::vector<LeafTypeTreeView<const T>> operand_views;
+    operand_views.reserve(tuple->operand_count());
     for (Node* operand : tuple->operands()) {
-      const LeafTypeTree<T>& operand_tree = map_.at(operand);
-      elements.insert(elements.end(), operand_tree.elements().begin(),
-                      operand_tree.elements().end());
+      operand_views.push_back(map_.at(operand).AsView());
     }
-    return SetValue(
-        tuple, LeafTypeTree<T>(tuple->GetType(), absl::MakeSpan(elements)));
+    return SetValue(tuple, LeafTypeTree<T>(tuple->GetType(),
+                                           absl::MakeConstSpan(operand_views)));
   }
 
   absl::Status HandleTupleIndex(TupleIndex* tuple_index) override {
     return SetValue(tuple_index,
-                    map_.at(tuple_index->operand(0))
-                        .CopySubtree(/*index=*/{tuple_index->index()}));
+                    LeafTypeTree<T>(map_.at(tuple_index->operand(0))
+                                        .AsView(/*index=*/{
+                                            tuple_index->index()})));
   }
 
   absl::Status HandleIdentity(UnOp* identity) override {
@@ -90,7 +91,7 @@ class DataFlowVisitor : public DfsVisitorWithDefault {
   }
 
  private:
-  absl::flat_hash_map<Node*, LeafTypeTree<T>> map_;
+  NodeMap<LeafTypeTree<T>> map_;
 };
 
 }  // namespace xls
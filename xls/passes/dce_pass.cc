@@ -14,7 +14,9 @@
 
 #include "xls/passes/dce_pass.h"
 
+#include <cstdint>
 #include <deque>
+#include <optional>
 
 #include "absl/status/statusor.h"
 #include "xls/common/logging/logging.h"
@@ -34,8 +36,15 @@ absl::StatusOr<bool> DeadCodeEliminationPass::RunOnFunctionBaseInternal(
            (!OpIsSideEffecting(n->op()) || n->Is<Gate>());
   };
 
+  // A node only becomes dead by losing users or implicit uses, both of which
+  // refresh its change stamp, so nodes unchanged since the last run of this
+  // pass need not be considered.
+  std::optional<int64_t> changed_since = LastRunChangeStamp(f);
   std::deque<Node*> worklist;
   for (Node* n : f->nodes()) {
+    if (changed_since.has_value() && n->change_stamp() <= *changed_since) {
+      continue;
+    }
     if (n->users().empty() && is_deletable(n)) {
       worklist.push_back(n);
     }
@@ -0,0 +1,208 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/function_deduplication_pass.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/call_graph.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+namespace {
+
+// Returns a hash of the structure of `f` which does not depend on node names
+// or ids, so structurally identical functions have the same hash. Attributes
+// of nodes (literal values, slice bounds, called functions, ...) are not
+// hashed; functions with equal hashes are compared precisely afterwards.
+size_t StructuralHash(Function* f) {
+  absl::flat_hash_map<Node*, size_t> node_hashes;
+  node_hashes.reserve(f->node_count());
+  for (int64_t i = 0; i < f->params().size(); ++i) {
+    node_hashes[f->param(i)] = absl::HashOf(Op::kParam, f->param(i)->GetType(),
+                                            i);
+  }
+  for (Node* node : TopoSort(f)) {
+    if (node->Is<Param>()) {
+      continue;
+    }
+    std::vector<size_t> operand_hashes;
+    operand_hashes.reserve(node->operand_count());
+    for (Node* operand : node->operands()) {
+      operand_hashes.push_back(node_hashes.at(operand));
+    }
+    node_hashes[node] =
+        absl::HashOf(node->op(), node->GetType(), operand_hashes);
+  }
+  return absl::HashOf(f->params().size(), node_hashes.at(f->return_value()));
+}
+
+// Returns true if `f` contains an operation with side effects other than
+// parameters. Function::IsDefinitelyEqualTo treats such operations as never
+// equal and does not look at nodes which do not feed the return value.
+bool HasSideEffects(Function* f) {
+  for (Node* node : f->nodes()) {
+    if (OpIsSideEffecting(node->op()) && !node->Is<Param>()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Rewrites the nodes of `f` which call a function in `replacements` to call
+// its replacement instead.
+absl::StatusOr<bool> ReplaceCalledFunctions(
+    FunctionBase* f,
+    const absl::flat_hash_map<Function*, Function*>& replacements) {
+  auto replacement = [&](Function* callee) -> std::optional<Function*> {
+    auto it = replacements.find(callee);
+    if (it == replacements.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  };
+  // Collect the nodes first as replacing them modifies the node list.
+  std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
+  bool changed = false;
+  for (Node* node : nodes) {
+    Node* new_node = nullptr;
+    switch (node->op()) {
+      case Op::kCountedFor: {
+        CountedFor* loop = node->As<CountedFor>();
+        if (std::optional<Function*> body = replacement(loop->body())) {
+          XLS_ASSIGN_OR_RETURN(new_node, node->ReplaceUsesWithNew<CountedFor>(
+                                             loop->initial_value(),
+                                             loop->invariant_args(),
+                                             loop->trip_count(), loop->stride(),
+                                             body.value()));
+        }
+        break;
+      }
+      case Op::kDynamicCountedFor: {
+        DynamicCountedFor* loop = node->As<DynamicCountedFor>();
+        if (std::optional<Function*> body = replacement(loop->body())) {
+          XLS_ASSIGN_OR_RETURN(
+              new_node, node->ReplaceUsesWithNew<DynamicCountedFor>(
+                            loop->initial_value(), loop->trip_count(),
+                            loop->stride(), loop->invariant_args(),
+                            body.value()));
+        }
+        break;
+      }
+      case Op::kInvoke: {
+        Invoke* invoke = node->As<Invoke>();
+        if (std::optional<Function*> to_apply =
+                replacement(invoke->to_apply())) {
+          XLS_ASSIGN_OR_RETURN(new_node, node->ReplaceUsesWithNew<Invoke>(
+                                             invoke->operands(), *to_apply));
+        }
+        break;
+      }
+      case Op::kMap: {
+        Map* map = node->As<Map>();
+        if (std::optional<Function*> to_apply = replacement(map->to_apply())) {
+          XLS_ASSIGN_OR_RETURN(new_node, node->ReplaceUsesWithNew<Map>(
+                                             map->operand(0), *to_apply));
+        }
+        break;
+      }
+      default:
+        break;
+    }
+    if (new_node == nullptr) {
+      continue;
+    }
+    std::optional<std::string> name;
+    if (node->HasAssignedName()) {
+      name = node->GetName();
+    }
+    XLS_RETURN_IF_ERROR(f->RemoveNode(node));
+    if (name.has_value()) {
+      new_node->SetName(*name);
+    }
+    changed = true;
+  }
+  return changed;
+}
+
+}  // namespace
+
+absl::StatusOr<bool> FunctionDeduplicationPass::RunInternal(
+    Package* p, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  std::optional<FunctionBase*> top = p->GetTop();
+
+  // Map from each duplicate function to the function replacing it.
+  absl::flat_hash_map<Function*, Function*> replacements;
+  std::vector<Function*> duplicates;
+  absl::flat_hash_map<size_t, std::vector<Function*>> buckets;
+  bool changed = false;
+  for (FunctionBase* function_base : FunctionsInPostOrder(p)) {
+    // Callees are visited first so the calls of `function_base` can be
+    // redirected to the representatives before it is compared with others.
+    XLS_ASSIGN_OR_RETURN(bool calls_changed,
+                         ReplaceCalledFunctions(function_base, replacements));
+    changed = changed || calls_changed;
+    if (!function_base->IsFunction()) {
+      continue;
+    }
+    Function* f = function_base->AsFunctionOrDie();
+    // Foreign functions are emitted from their code template rather than their
+    // body, so two with equal bodies may still instantiate different modules.
+    if (HasSideEffects(f) || f->ForeignFunctionData().has_value()) {
+      continue;
+    }
+    std::vector<Function*>& bucket = buckets[StructuralHash(f)];
+    if (top != f) {
+      auto it = std::find_if(bucket.begin(), bucket.end(), [&](Function* g) {
+        return g->GetInitiationInterval() == f->GetInitiationInterval() &&
+               g->IsDefinitelyEqualTo(f);
+      });
+      if (it != bucket.end()) {
+        XLS_VLOG(2) << "Replacing function " << f->name() << " with "
+                    << (*it)->name();
+        replacements[f] = *it;
+        duplicates.push_back(f);
+        continue;
+      }
+    }
+    bucket.push_back(f);
+  }
+
+  for (Function* duplicate : duplicates) {
+    XLS_RETURN_IF_ERROR(p->RemoveFunctionBase(duplicate));
+    changed = true;
+  }
+  return changed;
+}
+
+}  // namespace xls
@@ -0,0 +1,51 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_FUNCTION_DEDUPLICATION_PASS_H_
+#define XLS_PASSES_FUNCTION_DEDUPLICATION_PASS_H_
+
+#include "absl/status/statusor.h"
+#include "xls/ir/package.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+
+// Pass which merges structurally identical functions. Functions are bucketed
+// by a structural hash which ignores node names and ids, and functions in a
+// bucket which are equal by Function::IsDefinitelyEqualTo are merged: every
+// invoke, map and counted for referring to a duplicate is rewritten to refer to
+// a single representative and the duplicate is removed from the package.
+// Functions are visited callees first so callers of merged functions can be
+// merged in the same run. The top function is never removed, and functions
+// containing side-effecting operations (asserts, covers, traces and gates) are
+// left alone because Function::IsDefinitelyEqualTo does not compare them.
+// Foreign functions are never merged since codegen emits them from their code
+// template rather than their body, and functions with different initiation
+// intervals are kept apart.
+class FunctionDeduplicationPass : public OptimizationPass {
+ public:
+  FunctionDeduplicationPass()
+      : OptimizationPass("fdedup", "Function Deduplication") {}
+  ~FunctionDeduplicationPass() override = default;
+
+ protected:
+  absl::StatusOr<bool> RunInternal(Package* p,
+                                   const OptimizationPassOptions& options,
+                                   PassResults* results) const override;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_FUNCTION_DEDUPLICATION_PASS_H_
@@ -0,0 +1,194 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/function_deduplication_pass.h"
+
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace m = ::xls::op_matchers;
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+
+class FunctionDeduplicationPassTest : public IrTestBase {
+ protected:
+  absl::StatusOr<bool> Run(Package* p) {
+    PassResults results;
+    return FunctionDeduplicationPass().Run(p, OptimizationPassOptions(),
+                                           &results);
+  }
+};
+
+TEST_F(FunctionDeduplicationPassTest, MergesIdenticalFunctions) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
+package p
+
+fn add_one(x: bits[32]) -> bits[32] {
+  one: bits[32] = literal(value=1)
+  ret add.2: bits[32] = add(x, one)
+}
+
+fn add_one_again(y: bits[32]) -> bits[32] {
+  literal.3: bits[32] = literal(value=1)
+  ret sum: bits[32] = add(y, literal.3)
+}
+
+top fn main(a: bits[32]) -> bits[32] {
+  first: bits[32] = invoke(a, to_apply=add_one)
+  ret second: bits[32] = invoke(first, to_apply=add_one_again)
+}
+)"));
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(true));
+  EXPECT_EQ(p->functions().size(), 2);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * add_one, p->GetFunction("add_one"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * main, p->GetFunction("main"));
+  EXPECT_THAT(main->return_value(), m::Invoke(m::Invoke(m::Param("a"))));
+  EXPECT_EQ(main->return_value()->GetName(), "second");
+  EXPECT_EQ(main->return_value()->As<Invoke>()->to_apply(), add_one);
+
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(false));
+}
+
+TEST_F(FunctionDeduplicationPassTest, MergesCallersOfMergedFunctions) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
+package p
+
+fn inner_a(x: bits[8]) -> bits[8] {
+  ret neg.1: bits[8] = neg(x)
+}
+
+fn inner_b(x: bits[8]) -> bits[8] {
+  ret neg.2: bits[8] = neg(x)
+}
+
+fn outer_a(x: bits[8][4]) -> bits[8][4] {
+  ret map.3: bits[8][4] = map(x, to_apply=inner_a)
+}
+
+fn outer_b(x: bits[8][4]) -> bits[8][4] {
+  ret map.4: bits[8][4] = map(x, to_apply=inner_b)
+}
+
+fn body_a(i: bits[8], acc: bits[8]) -> bits[8] {
+  ret invoke.5: bits[8] = invoke(acc, to_apply=inner_a)
+}
+
+fn body_b(i: bits[8], acc: bits[8]) -> bits[8] {
+  ret invoke.6: bits[8] = invoke(acc, to_apply=inner_b)
+}
+
+top fn main(a: bits[8][4], b: bits[8]) -> (bits[8][4], bits[8][4], bits[8], bits[8]) {
+  invoke.7: bits[8][4] = invoke(a, to_apply=outer_a)
+  invoke.8: bits[8][4] = invoke(a, to_apply=outer_b)
+  counted_for.9: bits[8] = counted_for(b, trip_count=2, stride=1, body=body_a)
+  counted_for.10: bits[8] = counted_for(b, trip_count=3, stride=1, body=body_b)
+  ret tuple.11: (bits[8][4], bits[8][4], bits[8], bits[8]) = tuple(invoke.7, invoke.8, counted_for.9, counted_for.10)
+}
+)"));
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(true));
+  EXPECT_EQ(p->functions().size(), 4);
+  XLS_ASSERT_OK(p->GetFunction("inner_a").status());
+  XLS_ASSERT_OK(p->GetFunction("outer_a").status());
+  XLS_ASSERT_OK(p->GetFunction("body_a").status());
+  XLS_ASSERT_OK_AND_ASSIGN(Function * main, p->GetFunction("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * body_a, p->GetFunction("body_a"));
+  Node* loop = main->return_value()->operand(3);
+  ASSERT_TRUE(loop->Is<CountedFor>());
+  EXPECT_EQ(loop->As<CountedFor>()->body(), body_a);
+  EXPECT_EQ(loop->As<CountedFor>()->trip_count(), 3);
+}
+
+TEST_F(FunctionDeduplicationPassTest, DifferentFunctionsNotMerged) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
+package p
+
+fn add_one(x: bits[32]) -> bits[32] {
+  literal.1: bits[32] = literal(value=1)
+  ret add.2: bits[32] = add(x, literal.1)
+}
+
+fn add_two(x: bits[32]) -> bits[32] {
+  literal.3: bits[32] = literal(value=2)
+  ret add.4: bits[32] = add(x, literal.3)
+}
+
+fn checked_add_one(x: bits[32], tkn: token) -> bits[32] {
+  literal.5: bits[32] = literal(value=1)
+  literal.6: bits[1] = literal(value=1)
+  assert.7: token = assert(tkn, literal.6, message="never fires")
+  ret add.8: bits[32] = add(x, literal.5)
+}
+
+fn checked_add_one_again(x: bits[32], tkn: token) -> bits[32] {
+  literal.9: bits[32] = literal(value=1)
+  literal.10: bits[1] = literal(value=1)
+  assert.11: token = assert(tkn, literal.10, message="never fires")
+  ret add.12: bits[32] = add(x, literal.9)
+}
+
+top fn main(a: bits[32], tkn: token) -> (bits[32], bits[32], bits[32], bits[32]) {
+  invoke.13: bits[32] = invoke(a, to_apply=add_one)
+  invoke.14: bits[32] = invoke(a, to_apply=add_two)
+  invoke.15: bits[32] = invoke(a, tkn, to_apply=checked_add_one)
+  invoke.16: bits[32] = invoke(a, tkn, to_apply=checked_add_one_again)
+  ret tuple.17: (bits[32], bits[32], bits[32], bits[32]) = tuple(invoke.13, invoke.14, invoke.15, invoke.16)
+}
+)"));
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(false));
+  EXPECT_EQ(p->functions().size(), 5);
+}
+
+TEST_F(FunctionDeduplicationPassTest, ForeignFunctionsNotMerged) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
+package p
+
+#[ffi_proto("""code_template: "adder {fn} (.a({x}), .out({return}));"
+""")]
+fn ffi_adder(x: bits[32]) -> bits[32] {
+  ret identity.1: bits[32] = identity(x)
+}
+
+#[ffi_proto("""code_template: "multiplier {fn} (.a({x}), .out({return}));"
+""")]
+fn ffi_multiplier(x: bits[32]) -> bits[32] {
+  ret identity.2: bits[32] = identity(x)
+}
+
+top fn main(a: bits[32]) -> (bits[32], bits[32]) {
+  invoke.3: bits[32] = invoke(a, to_apply=ffi_adder)
+  invoke.4: bits[32] = invoke(a, to_apply=ffi_multiplier)
+  ret tuple.5: (bits[32], bits[32]) = tuple(invoke.3, invoke.4)
+}
+)"));
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(false));
+  EXPECT_EQ(p->functions().size(), 3);
+}
+
+}  // namespace
+}  // namespace xls
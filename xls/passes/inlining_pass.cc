@@ -14,20 +14,31 @@
 
 #include "xls/passes/inlining_pass.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/call_graph.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/nodes.h"
+#include "xls/passes/arith_simplification_pass.h"
+#include "xls/passes/canonicalization_pass.h"
+#include "xls/passes/constant_folding_pass.h"
+#include "xls/passes/cse_pass.h"
+#include "xls/passes/dce_pass.h"
 #include "xls/passes/optimization_pass.h"
 
 namespace xls {
@@ -193,9 +204,56 @@ absl::Status InlineInvoke(Invoke* invoke, int inline_count) {
 
 }  // namespace
 
+InliningPass::InliningPass(int64_t opt_level)
+    : OptimizationPass("inlining", "Inlines invocations") {
+  callee_passes_.push_back(std::make_unique<ConstantFoldingPass>());
+  callee_passes_.push_back(std::make_unique<DeadCodeEliminationPass>());
+  callee_passes_.push_back(std::make_unique<CanonicalizationPass>());
+  callee_passes_.push_back(
+      std::make_unique<ArithSimplificationPass>(opt_level));
+  callee_passes_.push_back(std::make_unique<DeadCodeEliminationPass>());
+  callee_passes_.push_back(std::make_unique<CsePass>());
+  callee_passes_.push_back(std::make_unique<DeadCodeEliminationPass>());
+}
+
+absl::StatusOr<bool> InliningPass::SimplifyCallee(
+    Function* f, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  bool changed = false;
+  bool iteration_changed = true;
+  while (iteration_changed) {
+    iteration_changed = false;
+    for (const auto& pass : callee_passes_) {
+      XLS_ASSIGN_OR_RETURN(bool pass_changed,
+                           pass->RunOnFunctionBase(f, options, results));
+      iteration_changed = iteration_changed || pass_changed;
+    }
+    changed = changed || iteration_changed;
+  }
+  return changed;
+}
+
 absl::StatusOr<bool> InliningPass::RunInternal(
     Package* p, const OptimizationPassOptions& options,
     PassResults* results) const {
+  std::optional<int64_t> budget = options.inlining_node_budget;
+
+  // In budgeted mode the functions which are inlined somewhere are simplified
+  // before being inlined, and the node count of the package is tracked.
+  absl::flat_hash_set<Function*> inlined_functions;
+  int64_t node_count = 0;
+  if (budget.has_value()) {
+    for (FunctionBase* f : p->GetFunctionBases()) {
+      for (Node* node : f->nodes()) {
+        if (node->Is<Invoke>() && IsInlineable(node->As<Invoke>())) {
+          inlined_functions.insert(node->As<Invoke>()->to_apply());
+        }
+      }
+      node_count += f->node_count();
+    }
+  }
+  int64_t peak_node_count = node_count;
+
   bool changed = false;
   // Inline all the invokes of each function where functions are processed in a
   // post order of the call graph (leaves first). This ensures that when a
@@ -208,10 +266,37 @@ absl::StatusOr<bool> InliningPass::RunInternal(
     std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
     for (Node* node : nodes) {
       if (node->Is<Invoke>() && IsInlineable(node->As<Invoke>())) {
+        if (budget.has_value()) {
+          // The parameters of the callee are not copied and the invoke itself
+          // is removed.
+          Function* callee = node->As<Invoke>()->to_apply();
+          int64_t growth = callee->node_count() - callee->params().size() - 1;
+          if (node_count + growth > *budget) {
+            return absl::ResourceExhaustedError(absl::StrFormat(
+                "Inlining %s into %s would grow package %s to %d nodes which "
+                "exceeds the inlining node budget of %d nodes",
+                callee->name(), f->name(), p->name(), node_count + growth,
+                *budget));
+          }
+          node_count += growth;
+          peak_node_count = std::max(peak_node_count, node_count);
+        }
         XLS_RETURN_IF_ERROR(InlineInvoke(node->As<Invoke>(), inline_count++));
         changed = true;
       }
     }
+    if (f->IsFunction() && inlined_functions.contains(f->AsFunctionOrDie())) {
+      int64_t before = f->node_count();
+      XLS_ASSIGN_OR_RETURN(bool simplified, SimplifyCallee(f->AsFunctionOrDie(),
+                                                           options, results));
+      changed = changed || simplified;
+      node_count += f->node_count() - before;
+    }
+  }
+  if (budget.has_value()) {
+    XLS_VLOG(1) << absl::StreamFormat(
+        "Inlined %d invokes; peak node count %d (budget %d)", inline_count,
+        peak_node_count, *budget);
   }
   return changed;
 }
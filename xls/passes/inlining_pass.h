@@ -15,20 +15,44 @@
 #ifndef XLS_PASSES_INLINING_PASS_H_
 #define XLS_PASSES_INLINING_PASS_H_
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include "absl/status/statusor.h"
 #include "xls/ir/function.h"
 #include "xls/passes/optimization_pass.h"
 
 namespace xls {
 
+// Inlines all invokes of non-foreign functions. Functions are processed in a
+// post order of the call graph so no invokes remain in a function by the time
+// it is inlined into its callers.
+//
+// If OptimizationPassOptions::inlining_node_budget is set the pass runs in
+// budgeted mode: once its invokes are inlined, each invoked function is
+// simplified to a fixed point with a few cheap function-local passes (constant
+// folding, canonicalization, arithmetic simplification, CSE and DCE) so the
+// copies inlined into its callers are already small. The package node count is
+// tracked throughout and the pass fails with a resource exhausted error rather
+// than growing the package beyond the budget.
 class InliningPass : public OptimizationPass {
  public:
-  InliningPass() : OptimizationPass("inlining", "Inlines invocations") {}
+  explicit InliningPass(int64_t opt_level = kMaxOptLevel);
 
  protected:
   absl::StatusOr<bool> RunInternal(Package* p,
                                    const OptimizationPassOptions& options,
                                    PassResults* results) const override;
+
+ private:
+  // Runs the callee simplification passes on `f` until none of them changes
+  // it. Returns whether `f` changed.
+  absl::StatusOr<bool> SimplifyCallee(Function* f,
+                                      const OptimizationPassOptions& options,
+                                      PassResults* results) const;
+
+  std::vector<std::unique_ptr<OptimizationFunctionBasePass>> callee_passes_;
 };
 
 }  // namespace xls
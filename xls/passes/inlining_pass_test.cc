@@ -37,8 +37,10 @@ namespace xls {
 namespace {
 
 using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
 using testing::AnyOf;
 using testing::Eq;
+using testing::HasSubstr;
 
 class InliningPassTest : public IrTestBase {
  protected:
@@ -267,5 +269,59 @@ fn caller(the_token: token, x: bits[32]) -> (token, bits[32]) {
   }
 }
 
+TEST_F(InliningPassTest, BudgetedInliningSimplifiesCallees) {
+  const std::string program = R"(
+package some_package
+
+fn callee(x: bits[32]) -> bits[32] {
+  zero: bits[32] = literal(value=0)
+  x_plus_zero: bits[32] = add(x, zero)
+  ret x_plus_zero_too: bits[32] = add(zero, x)
+}
+
+fn caller(a: bits[32]) -> bits[32] {
+  ret invoke.1: bits[32] = invoke(a, to_apply=callee)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(program));
+  OptimizationPassOptions options;
+  options.inlining_node_budget = 100;
+  PassResults results;
+  ASSERT_THAT(InliningPass().Run(package.get(), options, &results),
+              IsOkAndHolds(true));
+  // The callee was simplified to its parameter before being inlined.
+  EXPECT_THAT(FindFunction("callee", package.get())->return_value(),
+              m::Param("x"));
+  EXPECT_THAT(FindFunction("caller", package.get())->return_value(),
+              m::Param("a"));
+}
+
+TEST_F(InliningPassTest, BudgetExceeded) {
+  const std::string program = R"(
+package some_package
+
+fn callee(x: bits[32], y: bits[32]) -> bits[32] {
+  umul.1: bits[32] = umul(x, y)
+  add.2: bits[32] = add(umul.1, x)
+  ret sub.3: bits[32] = sub(add.2, y)
+}
+
+fn caller(a: bits[32], b: bits[32]) -> bits[32] {
+  invoke.4: bits[32] = invoke(a, b, to_apply=callee)
+  invoke.5: bits[32] = invoke(invoke.4, b, to_apply=callee)
+  ret invoke.6: bits[32] = invoke(invoke.5, b, to_apply=callee)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(program));
+  OptimizationPassOptions options;
+  // The package starts with 10 nodes and each inlined invoke adds 2.
+  options.inlining_node_budget = 14;
+  PassResults results;
+  EXPECT_THAT(
+      InliningPass().Run(package.get(), options, &results),
+      StatusIs(absl::StatusCode::kResourceExhausted,
+               HasSubstr("exceeds the inlining node budget of 14 nodes")));
+}
+
 }  // namespace
 }  // namespace xls
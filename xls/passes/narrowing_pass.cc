@@ -57,6 +57,7 @@
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/range_query_engine.h"
 #include "xls/passes/ternary_query_engine.h"
 #include "xls/passes/union_query_engine.h"
@@ -1286,9 +1287,27 @@ static void RangeAnalysisLog(FunctionBase* f,
   }
 }
 
-static absl::StatusOr<std::unique_ptr<QueryEngine>> GetQueryEngine(
-    FunctionBase* f, AnalysisType analysis) {
-  std::unique_ptr<QueryEngine> query_engine;
+// Returns the query engine to use for `f`. The engine is owned either by
+// `cache` (if non-null) or by `owned`.
+static absl::StatusOr<QueryEngine*> GetQueryEngine(
+    FunctionBase* f, AnalysisType analysis, QueryEngineCache* cache,
+    std::unique_ptr<QueryEngine>& owned) {
+  if (cache != nullptr) {
+    XLS_ASSIGN_OR_RETURN(TernaryQueryEngine * ternary_query_engine,
+                         cache->GetTernaryQueryEngine(f));
+    if (analysis != AnalysisType::kRange) {
+      return ternary_query_engine;
+    }
+    XLS_ASSIGN_OR_RETURN(RangeQueryEngine * range_query_engine,
+                         cache->GetRangeQueryEngine(f));
+    if (XLS_VLOG_IS_ON(3)) {
+      RangeAnalysisLog(f, *ternary_query_engine, *range_query_engine);
+    }
+    owned = std::make_unique<UnionQueryEngine>(UnionQueryEngine::Unowned(
+        {ternary_query_engine, range_query_engine}));
+    return owned.get();
+  }
+
   if (analysis == AnalysisType::kRange) {
     auto ternary_query_engine = std::make_unique<TernaryQueryEngine>();
     auto range_query_engine = std::make_unique<RangeQueryEngine>();
@@ -1300,19 +1319,21 @@ static absl::StatusOr<std::unique_ptr<QueryEngine>> GetQueryEngine(
     std::vector<std::unique_ptr<QueryEngine>> engines;
     engines.push_back(std::move(ternary_query_engine));
     engines.push_back(std::move(range_query_engine));
-    query_engine = std::make_unique<UnionQueryEngine>(std::move(engines));
+    owned = std::make_unique<UnionQueryEngine>(std::move(engines));
   } else {
-    query_engine = std::make_unique<TernaryQueryEngine>();
+    owned = std::make_unique<TernaryQueryEngine>();
   }
-  XLS_RETURN_IF_ERROR(query_engine->Populate(f).status());
-  return std::move(query_engine);
+  XLS_RETURN_IF_ERROR(owned->Populate(f).status());
+  return owned.get();
 }
 
 absl::StatusOr<bool> NarrowingPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<QueryEngine> query_engine,
-                       GetQueryEngine(f, analysis_));
+  std::unique_ptr<QueryEngine> owned_query_engine;
+  XLS_ASSIGN_OR_RETURN(QueryEngine * query_engine,
+                       GetQueryEngine(f, analysis_, options.query_engine_cache,
+                                      owned_query_engine));
 
   NarrowVisitor narrower(*query_engine, analysis_, options,
                          SplitsEnabled(opt_level_));
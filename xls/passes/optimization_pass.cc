@@ -14,28 +14,58 @@
 
 #include "xls/passes/optimization_pass.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <iterator>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/ir/call_graph.h"
 #include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
 #include "xls/ir/package.h"
 #include "xls/ir/ram_rewrite.pb.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/query_engine_cache.h"
 
 namespace xls {
+namespace {
+
+// Node indices are not reused, so a FunctionBase from which many nodes have
+// been removed leaves most slots of its node storage, and of every NodeMap
+// built over it, empty. Such FunctionBases are renumbered densely between
+// passes, when no side tables indexed by node index are live other than those
+// of the cached query engines, which are discarded.
+constexpr int64_t kMinNodeIndexLimitToCompact = 1024;
+
+void MaybeCompactNodeIndices(FunctionBase* f,
+                             const OptimizationPassOptions& options) {
+  if (f->node_index_limit() < kMinNodeIndexLimitToCompact ||
+      f->node_index_limit() < 2 * f->node_count()) {
+    return;
+  }
+  if (f->CompactNodeIndices() && options.query_engine_cache != nullptr) {
+    options.query_engine_cache->Invalidate(f);
+  }
+}
+
+}  // namespace
 
 std::string_view RamKindToString(RamKind kind) {
   switch (kind) {
@@ -135,7 +165,7 @@ absl::StatusOr<bool> OptimizationFunctionBasePass::RunOnFunctionBase(
   XLS_VLOG_LINES(3, f->DumpIr());
 
   XLS_ASSIGN_OR_RETURN(bool changed,
-                       RunOnFunctionBaseInternal(f, options, results));
+                       RunOnFunctionBaseAndRecordStamp(f, options, results));
 
   XLS_VLOG(3) << absl::StreamFormat("After [changed = %d]:", changed);
   XLS_VLOG_LINES(3, f->DumpIr());
@@ -146,14 +176,83 @@ absl::StatusOr<bool> OptimizationFunctionBasePass::RunInternal(
     Package* p, const OptimizationPassOptions& options,
     PassResults* results) const {
   bool changed = false;
-  for (FunctionBase* f : p->GetFunctionBases()) {
-    XLS_ASSIGN_OR_RETURN(bool function_changed,
-                         RunOnFunctionBaseInternal(f, options, results));
-    changed = changed || function_changed;
+  if (options.function_base_parallelism <= 1) {
+    for (FunctionBase* f : p->GetFunctionBases()) {
+      XLS_ASSIGN_OR_RETURN(
+          bool function_changed,
+          RunOnFunctionBaseAndRecordStamp(f, options, results));
+      MaybeCompactNodeIndices(f, options);
+      changed = changed || function_changed;
+    }
+    return changed;
+  }
+
+  for (const std::vector<FunctionBase*>& level : FunctionsByCallGraphLevel(p)) {
+    std::vector<absl::StatusOr<bool>> level_results(level.size(), false);
+    std::atomic<int64_t> next_index = 0;
+    auto worker = [&]() {
+      for (int64_t i = next_index++; i < static_cast<int64_t>(level.size());
+           i = next_index++) {
+        level_results[i] =
+            RunOnFunctionBaseAndRecordStamp(level[i], options, results);
+        if (level_results[i].ok()) {
+          MaybeCompactNodeIndices(level[i], options);
+        }
+      }
+    };
+    {
+      int64_t thread_count = std::min(options.function_base_parallelism,
+                                      static_cast<int64_t>(level.size()));
+      std::vector<std::unique_ptr<Thread>> threads;
+      for (int64_t i = 1; i < thread_count; ++i) {
+        threads.push_back(std::make_unique<Thread>(worker));
+      }
+      worker();
+      for (std::unique_ptr<Thread>& thread : threads) {
+        thread->Join();
+      }
+    }
+    // Report errors in FunctionBase order so failures are deterministic.
+    for (absl::StatusOr<bool>& function_changed : level_results) {
+      XLS_RETURN_IF_ERROR(function_changed.status());
+      changed = changed || function_changed.value();
+    }
   }
   return changed;
 }
 
+absl::StatusOr<bool>
+OptimizationFunctionBasePass::RunOnFunctionBaseAndRecordStamp(
+    FunctionBase* f, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  int64_t start_stamp = Node::CurrentChangeStamp();
+  XLS_ASSIGN_OR_RETURN(bool changed,
+                       RunOnFunctionBaseInternal(f, options, results));
+  absl::MutexLock lock(&last_run_stamps_mutex_);
+  last_run_stamps_[f] = start_stamp;
+  return changed;
+}
+
+std::optional<int64_t> OptimizationFunctionBasePass::LastRunChangeStamp(
+    FunctionBase* f) const {
+  absl::MutexLock lock(&last_run_stamps_mutex_);
+  auto it = last_run_stamps_.find(f);
+  if (it == last_run_stamps_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+bool OptimizationFunctionBasePass::NodeOrOperandsChangedSince(
+    Node* node, std::optional<int64_t> stamp) {
+  if (!stamp.has_value() || node->change_stamp() > *stamp) {
+    return true;
+  }
+  return absl::c_any_of(node->operands(), [&](Node* operand) {
+    return operand->change_stamp() > *stamp;
+  });
+}
+
 absl::StatusOr<bool> OptimizationFunctionBasePass::TransformNodesToFixedPoint(
     FunctionBase* f,
     std::function<absl::StatusOr<bool>(Node*)> simplify_f) const {
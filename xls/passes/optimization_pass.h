@@ -23,9 +23,12 @@
 #include <string_view>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc.h"
 #include "xls/ir/ram_rewrite.pb.h"
@@ -33,6 +36,8 @@
 
 namespace xls {
 
+class QueryEngineCache;
+
 // Metadata for RAMs.
 // TODO(google/xls#873): Ideally this metadata should live in the IR.
 //
@@ -120,6 +125,29 @@ struct OptimizationPassOptions : public PassOptionsBase {
   // List of RAM rewrites, generally lowering abstract RAMs into concrete
   // variants.
   std::vector<RamRewrite> ram_rewrites;
+
+  // Maximum number of threads used to run function-local passes (those derived
+  // from OptimizationFunctionBasePass) over the FunctionBases of a package. A
+  // value of one or less runs them serially. Package-level passes such as
+  // inlining and DFE are unaffected and so act as barriers between the
+  // parallel sections. The optimized IR is equivalent to the serial result
+  // but node ids (and hence default node names) may differ between runs.
+  int64_t function_base_parallelism = 1;
+
+  // If set, the unroll pass completely unrolls only the counted_for loops
+  // whose unrolling adds at most this many nodes and partially unrolls the
+  // others to fit. See UnrollPass.
+  std::optional<int64_t> loop_unroll_node_budget = std::nullopt;
+
+  // If set, the inlining pass simplifies each function before inlining it
+  // into its callers and fails rather than growing the package beyond this
+  // many nodes. See InliningPass.
+  std::optional<int64_t> inlining_node_budget = std::nullopt;
+
+  // If non-null, passes obtain their query engines from this cache instead of
+  // populating their own, sharing the analyses across passes. The cache is
+  // owned by the caller running the pipeline.
+  QueryEngineCache* query_engine_cache = nullptr;
 };
 
 // An object containing information about the invocation of a pass (single call
@@ -156,7 +184,11 @@ class OptimizationFunctionBasePass : public OptimizationPass {
 
  protected:
   // Iterates over each function and proc in the package calling
-  // RunOnFunctionBase.
+  // RunOnFunctionBase. If options.function_base_parallelism is greater than one
+  // the FunctionBases are processed concurrently one call graph level at a
+  // time, callees first, so a FunctionBase is never transformed while one of
+  // its callers is being transformed (e.g., constant folding of invokes reads
+  // the IR of the callee).
   absl::StatusOr<bool> RunInternal(Package* p,
                                    const OptimizationPassOptions& options,
                                    PassResults* results) const override;
@@ -175,6 +207,32 @@ class OptimizationFunctionBasePass : public OptimizationPass {
   absl::StatusOr<bool> TransformNodesToFixedPoint(
       FunctionBase* f,
       std::function<absl::StatusOr<bool>(Node*)> simplify_f) const;
+
+  // Returns the change stamp (see Node::change_stamp) observed when this pass
+  // object last started a successful run on 'f', or std::nullopt if there was
+  // no such run. Nodes whose stamp is no greater than the returned value have
+  // not been modified since, so passes whose transformations depend only on a
+  // node and its immediate neighborhood can skip them when re-run (e.g.,
+  // inside a fixed-point compound pass). Change stamps are process-wide and
+  // monotonic so a FunctionBase allocated at the address of a deleted one
+  // consists entirely of changed nodes.
+  std::optional<int64_t> LastRunChangeStamp(FunctionBase* f) const;
+
+  // Returns true if 'node' or any of its operands has been modified after the
+  // change stamp 'stamp'. Returns true if 'stamp' is std::nullopt.
+  static bool NodeOrOperandsChangedSince(Node* node,
+                                         std::optional<int64_t> stamp);
+
+ private:
+  // Calls RunOnFunctionBaseInternal and records the change stamp at which the
+  // run started for LastRunChangeStamp.
+  absl::StatusOr<bool> RunOnFunctionBaseAndRecordStamp(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      PassResults* results) const;
+
+  mutable absl::Mutex last_run_stamps_mutex_;
+  mutable absl::flat_hash_map<FunctionBase*, int64_t> last_run_stamps_
+      ABSL_GUARDED_BY(last_run_stamps_mutex_);
 };
 
 // Abstract base class for passes operate on procs. The derived
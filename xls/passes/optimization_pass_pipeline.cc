@@ -38,6 +38,7 @@
 #include "xls/passes/cse_pass.h"
 #include "xls/passes/dce_pass.h"
 #include "xls/passes/dfe_pass.h"
+#include "xls/passes/function_deduplication_pass.h"
 #include "xls/passes/identity_removal_pass.h"
 #include "xls/passes/inlining_pass.h"
 #include "xls/passes/label_recovery_pass.h"
@@ -115,6 +116,7 @@ std::unique_ptr<OptimizationCompoundPass> CreateOptimizationPassPipeline(
       "ir", "Top level pass pipeline");
   top->AddInvariantChecker<VerifierChecker>();
 
+  top->Add<FunctionDeduplicationPass>();
   top->Add<DeadFunctionEliminationPass>();
   top->Add<DeadCodeEliminationPass>();
   // At this stage in the pipeline only optimizations up to level 2 should
@@ -124,7 +126,7 @@ std::unique_ptr<OptimizationCompoundPass> CreateOptimizationPassPipeline(
   top->Add<SimplificationPass>(std::min(int64_t{2}, opt_level));
   top->Add<UnrollPass>();
   top->Add<MapInliningPass>();
-  top->Add<InliningPass>();
+  top->Add<InliningPass>(std::min(int64_t{2}, opt_level));
   top->Add<DeadFunctionEliminationPass>();
 
   top->Add<BddSimplificationPass>(std::min(int64_t{2}, opt_level));
@@ -14,6 +14,7 @@
 
 #include "xls/passes/optimization_pass.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -23,10 +24,13 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/algorithm/container.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/casts.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/matchers.h"
@@ -36,6 +40,7 @@
 #include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/ir/ram_rewrite.pb.h"
 #include "xls/ir/type.h"
@@ -506,6 +511,74 @@ TEST(PassesTest, TestTransformNodesToFixedPointWhileRemovingNodes) {
       IsOkAndHolds(false));
 }
 
+// Pass which records the FunctionBases it has finished with and fails if it is
+// run on a FunctionBase before all of that FunctionBase's callees.
+class CalleesFirstPass : public OptimizationFunctionBasePass {
+ public:
+  CalleesFirstPass()
+      : OptimizationFunctionBasePass("callees_first", "callees first") {}
+
+  std::vector<std::string> finished() const {
+    absl::MutexLock lock(&mutex_);
+    return finished_;
+  }
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      PassResults* results) const override {
+    absl::MutexLock lock(&mutex_);
+    for (Node* node : f->nodes()) {
+      if (node->Is<Invoke>() &&
+          !absl::c_linear_search(finished_,
+                                 node->As<Invoke>()->to_apply()->name())) {
+        return absl::InternalError(
+            absl::StrFormat("%s visited before its callee", f->name()));
+      }
+    }
+    finished_.push_back(f->name());
+    return false;
+  }
+
+ private:
+  mutable absl::Mutex mutex_;
+  mutable std::vector<std::string> finished_ ABSL_GUARDED_BY(mutex_);
+};
+
+TEST(PassesTest, ParallelFunctionBasePass) {
+  auto p = std::make_unique<Package>("p");
+  std::vector<Function*> leaves;
+  for (int64_t i = 0; i < 16; ++i) {
+    FunctionBuilder fb(absl::StrCat("leaf", i), p.get());
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    fb.Not(fb.Add(x, fb.Literal(UBits(i, 32))));
+    XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(x));
+    leaves.push_back(f);
+  }
+  FunctionBuilder fb("top", p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  for (Function* leaf : leaves) {
+    x = fb.Invoke({x}, leaf);
+  }
+  XLS_ASSERT_OK(fb.BuildWithReturnValue(x).status());
+
+  OptimizationPassOptions options;
+  options.function_base_parallelism = 4;
+  PassResults results;
+  CalleesFirstPass callees_first;
+  XLS_ASSERT_OK(callees_first.Run(p.get(), options, &results).status());
+  EXPECT_EQ(callees_first.finished().size(), 17);
+  EXPECT_EQ(callees_first.finished().back(), "top");
+
+  EXPECT_THAT(NaiveDcePass().Run(p.get(), options, &results),
+              IsOkAndHolds(true));
+  for (Function* leaf : leaves) {
+    EXPECT_EQ(leaf->node_count(), 1);
+  }
+  EXPECT_THAT(NaiveDcePass().Run(p.get(), options, &results),
+              IsOkAndHolds(false));
+}
+
 TEST(RamDatastructuresTest, AddrWidthCorrect) {
   RamConfig config{.kind = RamKind::kAbstract, .depth = 2};
   EXPECT_EQ(config.addr_width(), 1);
@@ -15,6 +15,7 @@
 #ifndef XLS_PASSES_PASS_BASE_H_
 #define XLS_PASSES_PASS_BASE_H_
 
+#include <cstdint>
 #include <filesystem>
 #include <memory>
 #include <optional>
@@ -31,7 +32,10 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/memory_usage.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/tracing.h"
+#include "xls/data_structures/binary_decision_diagram.h"
 
 namespace xls {
 
@@ -54,6 +58,27 @@ struct PassOptionsBase {
   // both run_only_passes and skip_passes are present, then only passes which
   // are present in run_only_passes and not present in skip_passes will be run.
   std::vector<std::string> skip_passes;
+
+  // Whether to record the memory usage of each pass invocation (see
+  // PassMemoryUsage). Costs a traversal of the IR per pass.
+  bool record_memory_usage = false;
+};
+
+// Memory accounting of a single pass invocation, recorded after the pass ran.
+struct PassMemoryUsage {
+  // The number of nodes and the approximate size in bytes of the IR.
+  int64_t node_count = 0;
+  int64_t ir_byte_size = 0;
+
+  // The resident set size of the process and its high-water mark since the
+  // start of the process. The pass during which the high-water mark rose is
+  // the one which required the memory.
+  std::optional<int64_t> rss_bytes;
+  std::optional<int64_t> peak_rss_bytes;
+
+  // The peak memory used by the tables of any BDD (e.g., for the BDD query
+  // engine) during the pass.
+  int64_t bdd_peak_bytes = 0;
 };
 
 // An object containing information about the invocation of a pass (single call
@@ -67,6 +92,35 @@ struct PassInvocation {
 
   // The run duration of the pass.
   absl::Duration run_duration;
+
+  // The time at which the pass started running.
+  absl::Time start_time;
+
+  // The number of IR nodes created and removed by the pass. Nodes which are
+  // both created and removed during the pass count toward both.
+  int64_t nodes_added = 0;
+  int64_t nodes_removed = 0;
+
+  // Present if PassOptionsBase::record_memory_usage is set.
+  std::optional<PassMemoryUsage> memory_usage;
+};
+
+// An object containing information about a single run of a compound pass
+// nested within (or being) the top-level pass.
+struct CompoundPassInvocation {
+  // The name of the compound pass.
+  std::string pass_name;
+
+  // Whether the IR was changed by the compound pass.
+  bool ir_changed;
+
+  // The time at which the compound pass started running and its duration.
+  absl::Time start_time;
+  absl::Duration run_duration;
+
+  // The number of times the contained passes were run. This is greater than
+  // one only for fixed-point compound passes.
+  int64_t iterations;
 };
 
 // A object to which metadata may be written in each pass invocation. This data
@@ -74,19 +128,25 @@ struct PassInvocation {
 struct PassResults {
   // This vector contains and entry for each invocation of each pass.
   std::vector<PassInvocation> invocations;
+
+  // An entry for each run of each compound pass in the order in which the runs
+  // completed.
+  std::vector<CompoundPassInvocation> compound_invocations;
 };
 
 // Base class for all compiler passes. Template parameters:
 //
 //   IrT : The data type that the pass operates on (e.g., xls::Package). The
 //     type should define 'DumpIr' and 'name' methods used for dumping and
-//     logging in compound passes. A pass which strictly operate on the XLS IR
-//     may use the xls::Package type as the IrT template argument. Passes which
-//     operate on the IR and a schedule may be instantiated on a data structure
-//     containing both an xls::Package and a schedule. Roughly, IrT should
-//     contain the IR and (optionally) any metadata generated or transformed by
-//     the passes which is necessary for the passes to function (e.g., not just
-//     telemetry or logging info which should be held in ResultT).
+//     logging in compound passes, and 'GetNodeCount' and 'next_node_id'
+//     methods used to compute the node metrics of each pass invocation. A pass
+//     which strictly operate on the XLS IR may use the xls::Package type as the
+//     IrT template argument. Passes which operate on the IR and a schedule may
+//     be instantiated on a data structure containing both an xls::Package and
+//     a schedule. Roughly, IrT should contain the IR and (optionally) any
+//     metadata generated or transformed by the passes which is necessary for
+//     the passes to function (e.g., not just telemetry or logging info which
+//     should be held in ResultT).
 //
 //   OptionsT : Options type passed as an immutable object to each invocation of
 //     PassBase::Run. This type should be derived from PassOptions because
@@ -212,11 +272,27 @@ class CompoundPassBase : public PassBase<IrT, OptionsT, ResultsT> {
   virtual absl::StatusOr<bool> RunNested(
       IrT* ir, const OptionsT& options, ResultsT* results,
       std::string_view top_level_name,
-      absl::Span<const InvariantChecker* const> invariant_checkers) const;
+      absl::Span<const InvariantChecker* const> invariant_checkers) const {
+    absl::Time start = absl::Now();
+    XLS_ASSIGN_OR_RETURN(bool changed,
+                         RunPasses(ir, options, results, top_level_name,
+                                   invariant_checkers));
+    results->compound_invocations.push_back(
+        {this->short_name(), changed, start, absl::Now() - start,
+         /*iterations=*/1});
+    return changed;
+  }
 
   bool IsCompound() const override { return true; }
 
  protected:
+  // Runs each contained pass once in order. Returns whether any pass changed
+  // the IR.
+  absl::StatusOr<bool> RunPasses(
+      IrT* ir, const OptionsT& options, ResultsT* results,
+      std::string_view top_level_name,
+      absl::Span<const InvariantChecker* const> invariant_checkers) const;
+
   // Dump the IR to a file in the given directory. Name is determined by the
   // various arguments passed in. File names will be lexographically ordered by
   // package name and ordinal.
@@ -252,21 +328,26 @@ class FixedPointCompoundPassBase
       absl::Span<const typename CompoundPassBase<
           IrT, OptionsT, ResultsT>::InvariantChecker* const>
           invariant_checkers) const override {
+    absl::Time start = absl::Now();
+    int64_t iterations = 0;
     bool local_changed = true;
     bool global_changed = false;
     while (local_changed) {
-      XLS_ASSIGN_OR_RETURN(
-          local_changed,
-          (CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
-              ir, options, results, top_level_name, invariant_checkers)));
+      XLS_ASSIGN_OR_RETURN(local_changed,
+                           this->RunPasses(ir, options, results,
+                                           top_level_name, invariant_checkers));
       global_changed = global_changed || local_changed;
+      ++iterations;
     }
+    results->compound_invocations.push_back(
+        {this->short_name(), global_changed, start, absl::Now() - start,
+         iterations});
     return global_changed;
   }
 };
 
 template <typename IrT, typename OptionsT, typename ResultsT>
-absl::StatusOr<bool> CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
+absl::StatusOr<bool> CompoundPassBase<IrT, OptionsT, ResultsT>::RunPasses(
     IrT* ir, const OptionsT& options, ResultsT* results,
     std::string_view top_level_name,
     absl::Span<const InvariantChecker* const> invariant_checkers) const {
@@ -324,7 +405,14 @@ absl::StatusOr<bool> CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
     // do not check it in optimized builds.
     std::string ir_before = ir->DumpIr();
 #endif
+    ScopedTraceSpan trace_span(pass->IsCompound() ? "compound_pass" : "pass",
+                               pass->short_name());
+    if (options.record_memory_usage) {
+      BinaryDecisionDiagram::PeakMemoryUsage().Reset();
+    }
     absl::Time start = absl::Now();
+    int64_t node_count_before = ir->GetNodeCount();
+    int64_t next_node_id_before = ir->next_node_id();
     bool pass_changed;
     if (pass->IsCompound()) {
       XLS_ASSIGN_OR_RETURN(
@@ -358,8 +446,23 @@ absl::StatusOr<bool> CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
         pass->short_name(),
         (pass_changed ? "changed IR" : "did not change IR"));
     if (!pass->IsCompound()) {
-      results->invocations.push_back(
-          {pass->short_name(), pass_changed, duration});
+      // Node ids are allocated sequentially so the id watermark gives the
+      // number of nodes created by the pass.
+      int64_t nodes_added = ir->next_node_id() - next_node_id_before;
+      int64_t nodes_removed =
+          nodes_added - (ir->GetNodeCount() - node_count_before);
+      results->invocations.push_back({pass->short_name(), pass_changed,
+                                      duration, start, nodes_added,
+                                      nodes_removed});
+      if (options.record_memory_usage) {
+        results->invocations.back().memory_usage = PassMemoryUsage{
+            .node_count = ir->GetNodeCount(),
+            .ir_byte_size = ir->GetApproximateIrByteSize(),
+            .rss_bytes = GetCurrentRssBytes(),
+            .peak_rss_bytes = GetPeakRssBytes(),
+            .bdd_peak_bytes =
+                BinaryDecisionDiagram::PeakMemoryUsage().peak_bytes()};
+      }
     }
     if (!options.ir_dump_path.empty()) {
       XLS_RETURN_IF_ERROR(DumpIr(options.ir_dump_path, ir, top_level_name,
@@ -0,0 +1,250 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/pass_metrics.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/time/time.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+namespace {
+
+// Returns `s` as a quoted JSON string.
+std::string JsonString(std::string_view s) {
+  std::string out = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      absl::StrAppend(&out, "\\", std::string(1, c));
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      absl::StrAppendFormat(&out, "\\u%04x", static_cast<int>(c));
+    } else {
+      out.push_back(c);
+    }
+  }
+  out.push_back('"');
+  return out;
+}
+
+std::string TraceEvent(std::string_view name, std::string_view category,
+                       absl::Time start, absl::Duration duration,
+                       absl::Time origin, std::string_view args) {
+  return absl::StrFormat(
+      "{\"name\":%s,\"cat\":%s,\"ph\":\"X\",\"ts\":%d,\"dur\":%d,\"pid\":0,"
+      "\"tid\":0,\"args\":{%s}}",
+      JsonString(name), JsonString(category),
+      absl::ToInt64Microseconds(start - origin),
+      absl::ToInt64Microseconds(duration), args);
+}
+
+std::string OptionalBytes(std::optional<int64_t> bytes) {
+  return bytes.has_value() ? absl::StrCat(*bytes) : "null";
+}
+
+std::string MemoryUsageArgs(const PassMemoryUsage& usage) {
+  return absl::StrFormat(
+      "\"node_count\":%d,\"ir_bytes\":%d,\"rss_bytes\":%s,"
+      "\"peak_rss_bytes\":%s,\"bdd_peak_bytes\":%d",
+      usage.node_count, usage.ir_byte_size, OptionalBytes(usage.rss_bytes),
+      OptionalBytes(usage.peak_rss_bytes), usage.bdd_peak_bytes);
+}
+
+// Returns `bytes` in mebibytes.
+double ToMiB(int64_t bytes) { return static_cast<double>(bytes) / (1 << 20); }
+
+}  // namespace
+
+std::string PassResultsToChromeTrace(const PassResults& results) {
+  absl::Time origin = absl::InfiniteFuture();
+  for (const PassInvocation& invocation : results.invocations) {
+    origin = std::min(origin, invocation.start_time);
+  }
+  for (const CompoundPassInvocation& invocation :
+       results.compound_invocations) {
+    origin = std::min(origin, invocation.start_time);
+  }
+
+  std::vector<std::string> events;
+  for (const CompoundPassInvocation& invocation :
+       results.compound_invocations) {
+    events.push_back(TraceEvent(
+        invocation.pass_name, "compound_pass", invocation.start_time,
+        invocation.run_duration, origin,
+        absl::StrFormat("\"changed\":%s,\"iterations\":%d",
+                        invocation.ir_changed ? "true" : "false",
+                        invocation.iterations)));
+  }
+  for (const PassInvocation& invocation : results.invocations) {
+    std::string args = absl::StrFormat(
+        "\"changed\":%s,\"nodes_added\":%d,\"nodes_removed\":%d",
+        invocation.ir_changed ? "true" : "false", invocation.nodes_added,
+        invocation.nodes_removed);
+    if (invocation.memory_usage.has_value()) {
+      absl::StrAppend(&args, ",", MemoryUsageArgs(*invocation.memory_usage));
+    }
+    events.push_back(TraceEvent(invocation.pass_name, "pass",
+                                invocation.start_time, invocation.run_duration,
+                                origin, args));
+    if (invocation.memory_usage.has_value()) {
+      // Counter events plot the memory usage over the course of the pipeline.
+      events.push_back(absl::StrFormat(
+          "{\"name\":\"memory\",\"ph\":\"C\",\"ts\":%d,\"pid\":0,"
+          "\"args\":{%s}}",
+          absl::ToInt64Microseconds(invocation.start_time +
+                                    invocation.run_duration - origin),
+          MemoryUsageArgs(*invocation.memory_usage)));
+    }
+  }
+  return absl::StrCat("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n",
+                      absl::StrJoin(events, ",\n"), "\n]}\n");
+}
+
+std::string SummarizePassResults(const PassResults& results) {
+  struct PassSummary {
+    absl::Duration run_duration;
+    int64_t runs = 0;
+    int64_t changed_runs = 0;
+    int64_t nodes_added = 0;
+    int64_t nodes_removed = 0;
+  };
+  absl::flat_hash_map<std::string, PassSummary> summaries;
+  for (const PassInvocation& invocation : results.invocations) {
+    PassSummary& summary = summaries[invocation.pass_name];
+    summary.run_duration += invocation.run_duration;
+    ++summary.runs;
+    summary.changed_runs += invocation.ir_changed ? 1 : 0;
+    summary.nodes_added += invocation.nodes_added;
+    summary.nodes_removed += invocation.nodes_removed;
+  }
+  std::vector<std::string> pass_names;
+  for (const auto& [name, _] : summaries) {
+    pass_names.push_back(name);
+  }
+  std::sort(pass_names.begin(), pass_names.end(),
+            [&](const std::string& a, const std::string& b) {
+              absl::Duration a_time = summaries.at(a).run_duration;
+              absl::Duration b_time = summaries.at(b).run_duration;
+              return a_time == b_time ? a < b : a_time > b_time;
+            });
+
+  std::string out = absl::StrFormat("%-30s %12s %8s %8s %12s %12s\n", "Pass",
+                                    "Time (ms)", "Runs", "Changed",
+                                    "Nodes added", "Nodes removed");
+  for (const std::string& name : pass_names) {
+    const PassSummary& summary = summaries.at(name);
+    absl::StrAppendFormat(
+        &out, "%-30s %12.3f %8d %8d %12d %12d\n", name,
+        absl::ToDoubleMilliseconds(summary.run_duration), summary.runs,
+        summary.changed_runs, summary.nodes_added, summary.nodes_removed);
+  }
+
+  struct CompoundSummary {
+    int64_t runs = 0;
+    int64_t total_iterations = 0;
+    int64_t max_iterations = 0;
+  };
+  absl::flat_hash_map<std::string, CompoundSummary> compound_summaries;
+  std::vector<std::string> compound_names;
+  for (const CompoundPassInvocation& invocation :
+       results.compound_invocations) {
+    auto [it, inserted] = compound_summaries.insert(
+        {invocation.pass_name, CompoundSummary()});
+    if (inserted) {
+      compound_names.push_back(invocation.pass_name);
+    }
+    CompoundSummary& summary = it->second;
+    ++summary.runs;
+    summary.total_iterations += invocation.iterations;
+    summary.max_iterations =
+        std::max(summary.max_iterations, invocation.iterations);
+  }
+  if (!compound_names.empty()) {
+    absl::StrAppendFormat(&out, "\n%-30s %8s %12s %12s\n", "Compound pass",
+                          "Runs", "Iterations", "Max iters");
+    for (const std::string& name : compound_names) {
+      const CompoundSummary& summary = compound_summaries.at(name);
+      absl::StrAppendFormat(&out, "%-30s %8d %12d %12d\n", name, summary.runs,
+                            summary.total_iterations, summary.max_iterations);
+    }
+  }
+
+  // Memory usage aggregated by pass. The peak RSS raise of an invocation is
+  // the amount by which it raised the high-water mark of the process.
+  struct MemorySummary {
+    int64_t max_ir_byte_size = 0;
+    int64_t max_bdd_peak_bytes = 0;
+    int64_t peak_rss_raise = 0;
+  };
+  absl::flat_hash_map<std::string, MemorySummary> memory_summaries;
+  std::vector<std::string> memory_names;
+  std::optional<int64_t> previous_peak_rss;
+  std::optional<int64_t> final_peak_rss;
+  for (const PassInvocation& invocation : results.invocations) {
+    if (!invocation.memory_usage.has_value()) {
+      continue;
+    }
+    const PassMemoryUsage& usage = *invocation.memory_usage;
+    auto [it, inserted] =
+        memory_summaries.insert({invocation.pass_name, MemorySummary()});
+    if (inserted) {
+      memory_names.push_back(invocation.pass_name);
+    }
+    MemorySummary& summary = it->second;
+    summary.max_ir_byte_size =
+        std::max(summary.max_ir_byte_size, usage.ir_byte_size);
+    summary.max_bdd_peak_bytes =
+        std::max(summary.max_bdd_peak_bytes, usage.bdd_peak_bytes);
+    if (usage.peak_rss_bytes.has_value()) {
+      if (previous_peak_rss.has_value()) {
+        summary.peak_rss_raise += *usage.peak_rss_bytes - *previous_peak_rss;
+      }
+      previous_peak_rss = usage.peak_rss_bytes;
+      final_peak_rss = usage.peak_rss_bytes;
+    }
+  }
+  if (!memory_names.empty()) {
+    std::sort(memory_names.begin(), memory_names.end(),
+              [&](const std::string& a, const std::string& b) {
+                int64_t a_raise = memory_summaries.at(a).peak_rss_raise;
+                int64_t b_raise = memory_summaries.at(b).peak_rss_raise;
+                return a_raise == b_raise ? a < b : a_raise > b_raise;
+              });
+    absl::StrAppendFormat(&out, "\n%-30s %16s %16s %16s\n", "Memory",
+                          "RSS raise (MiB)", "Max IR (MiB)", "Max BDD (MiB)");
+    for (const std::string& name : memory_names) {
+      const MemorySummary& summary = memory_summaries.at(name);
+      absl::StrAppendFormat(&out, "%-30s %16.3f %16.3f %16.3f\n", name,
+                            ToMiB(summary.peak_rss_raise),
+                            ToMiB(summary.max_ir_byte_size),
+                            ToMiB(summary.max_bdd_peak_bytes));
+    }
+    if (final_peak_rss.has_value()) {
+      absl::StrAppendFormat(&out, "Peak RSS: %.3f MiB\n",
+                            ToMiB(*final_peak_rss));
+    }
+  }
+  return out;
+}
+
+}  // namespace xls
@@ -0,0 +1,41 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_PASS_METRICS_H_
+#define XLS_PASSES_PASS_METRICS_H_
+
+#include <string>
+
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+
+// Returns the pass and compound pass invocations recorded in `results` as a
+// JSON trace in the Chrome trace event format, suitable for loading into
+// chrome://tracing or Perfetto. Each invocation is a complete ("X") event;
+// compound passes appear as spans enclosing the passes they ran. Node metrics
+// and fixed-point iteration counts are attached as event arguments. Recorded
+// memory usage is attached to pass events and also emitted as a "memory"
+// counter track.
+std::string PassResultsToChromeTrace(const PassResults& results);
+
+// Returns a human-readable table of the invocations in `results` aggregated by
+// pass name and sorted by decreasing total run time, followed by the number of
+// iterations of each fixed-point compound pass and, if recorded, the memory
+// usage of each pass sorted by how much it raised the peak RSS.
+std::string SummarizePassResults(const PassResults& results);
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_PASS_METRICS_H_
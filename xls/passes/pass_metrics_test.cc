@@ -0,0 +1,105 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/pass_metrics.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/passes/dce_pass.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::HasSubstr;
+
+class PassMetricsTest : public IrTestBase {};
+
+TEST_F(PassMetricsTest, RecordsNodeDeltasAndIterations) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  fb.Not(fb.Negate(x));
+  XLS_ASSERT_OK(fb.BuildWithReturnValue(x).status());
+
+  OptimizationCompoundPass top("top", "Top");
+  OptimizationFixedPointCompoundPass* fixed_point =
+      top.Add<OptimizationFixedPointCompoundPass>("fixedpoint", "Fixed point");
+  fixed_point->Add<DeadCodeEliminationPass>();
+
+  PassResults results;
+  EXPECT_THAT(top.Run(p.get(), OptimizationPassOptions(), &results),
+              IsOkAndHolds(true));
+
+  // DCE removes the two dead nodes in the first iteration and changes nothing
+  // in the second.
+  ASSERT_EQ(results.invocations.size(), 2);
+  EXPECT_TRUE(results.invocations[0].ir_changed);
+  EXPECT_EQ(results.invocations[0].nodes_added, 0);
+  EXPECT_EQ(results.invocations[0].nodes_removed, 2);
+  EXPECT_FALSE(results.invocations[1].ir_changed);
+  EXPECT_EQ(results.invocations[1].nodes_removed, 0);
+
+  // Nested compound passes complete before their parents.
+  ASSERT_EQ(results.compound_invocations.size(), 2);
+  EXPECT_EQ(results.compound_invocations[0].pass_name, "fixedpoint");
+  EXPECT_EQ(results.compound_invocations[0].iterations, 2);
+  EXPECT_EQ(results.compound_invocations[1].pass_name, "top");
+  EXPECT_EQ(results.compound_invocations[1].iterations, 1);
+
+  std::string trace = PassResultsToChromeTrace(results);
+  EXPECT_THAT(trace, HasSubstr("\"traceEvents\""));
+  EXPECT_THAT(trace, HasSubstr("\"name\":\"dce\""));
+  EXPECT_THAT(trace, HasSubstr("\"nodes_removed\":2"));
+  EXPECT_THAT(trace, HasSubstr("\"iterations\":2"));
+
+  std::string summary = SummarizePassResults(results);
+  EXPECT_THAT(summary, HasSubstr("dce"));
+  EXPECT_THAT(summary, HasSubstr("fixedpoint"));
+}
+
+TEST_F(PassMetricsTest, RecordsMemoryUsage) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  fb.Not(x);
+  XLS_ASSERT_OK(fb.BuildWithReturnValue(x).status());
+
+  OptimizationCompoundPass top("top", "Top");
+  top.Add<DeadCodeEliminationPass>();
+
+  OptimizationPassOptions options;
+  options.record_memory_usage = true;
+  PassResults results;
+  EXPECT_THAT(top.Run(p.get(), options, &results), IsOkAndHolds(true));
+
+  ASSERT_EQ(results.invocations.size(), 1);
+  ASSERT_TRUE(results.invocations[0].memory_usage.has_value());
+  EXPECT_EQ(results.invocations[0].memory_usage->node_count, 1);
+  EXPECT_GT(results.invocations[0].memory_usage->ir_byte_size, 0);
+
+  EXPECT_THAT(PassResultsToChromeTrace(results), HasSubstr("\"ir_bytes\""));
+  EXPECT_THAT(SummarizePassResults(results), HasSubstr("Memory"));
+}
+
+}  // namespace
+}  // namespace xls
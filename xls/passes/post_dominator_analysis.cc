@@ -14,143 +14,140 @@
 
 #include "xls/passes/post_dominator_analysis.h"
 
-#include <algorithm>
-#include <cstdio>
+#include <cstdint>
 #include <memory>
-#include <queue>
+#include <optional>
 #include <utility>
 #include <vector>
 
-#include "absl/algorithm/container.h"
-#include "absl/container/flat_hash_map.h"
-#include "absl/container/flat_hash_set.h"
-#include "absl/memory/memory.h"
-#include "absl/meta/type_traits.h"
-#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/ir/function.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/node_util.h"
-#include "xls/ir/proc.h"
 
 namespace xls {
-namespace {
 
-using NodeIndex = int64_t;
+/* static */ absl::StatusOr<std::unique_ptr<PostDominatorAnalysis>>
+PostDominatorAnalysis::Run(FunctionBase* f) {
+  auto analysis = std::make_unique<PostDominatorAnalysis>();
 
-// Returns the intersection of the given sorted lists. Lists should be sorted in
-// ascending order.
-std::vector<NodeIndex> IntersectSortedLists(
-    absl::Span<const absl::Span<const NodeIndex>> lists) {
-  std::vector<NodeIndex> intersection;
-  if (lists.empty()) {
-    return intersection;
+  // A reverse topological sort of the function nodes. Users precede the nodes
+  // they use, so a node's post-dominators all have smaller indices.
+  NodeIterator r = ReverseTopoSort(f);
+  analysis->nodes_.assign(r.begin(), r.end());
+  const std::vector<Node*>& nodes = analysis->nodes_;
+  int64_t node_count = nodes.size();
+  analysis->node_index_.reserve(node_count);
+  for (int64_t i = 0; i < node_count; ++i) {
+    analysis->node_index_[nodes[i]] = i;
   }
-  std::vector<int64_t> indices(lists.size(), 0);
 
-  // Returns true if any of the indices are at the end of their respective
-  // lists.
-  auto at_end_of_a_list = [&]() {
-    for (int64_t i = 0; i < indices.size(); ++i) {
-      if (indices[i] == lists[i].size()) {
-        return true;
+  // Returns the nearest common ancestor of `a` and `b` in the (partially
+  // built) tree. Parents have smaller indices than their children and the
+  // root is smaller than every node, so walk the larger index up until the
+  // two meet.
+  std::vector<int64_t>& ipdom = analysis->immediate_post_dominator_;
+  ipdom.resize(node_count, kRoot);
+  auto intersect = [&](int64_t a, int64_t b) {
+    while (a != b) {
+      while (a > b) {
+        a = ipdom[a];
       }
-    }
-    return false;
-  };
-  while (!at_end_of_a_list()) {
-    // Find the minimum value among the list elements at their respective
-    // indices.
-    NodeIndex min_value = lists[0][indices[0]];
-    for (int64_t i = 1; i < lists.size(); ++i) {
-      NodeIndex value = lists[i][indices[i]];
-      if (value < min_value) {
-        min_value = value;
+      while (b > a) {
+        b = ipdom[b];
       }
     }
-
-    // Advance all list indices which hold the minimum value.
-    int64_t match_count = 0;
-    for (int64_t i = 0; i < lists.size(); ++i) {
-      if (lists[i][indices[i]] == min_value) {
-        indices[i]++;
-        match_count++;
-      }
+    return a;
+  };
+  for (int64_t i = 0; i < node_count; ++i) {
+    Node* node = nodes[i];
+    // If a node has an implicit use, then there exists an alternate path to a
+    // root node other than its users, so it can't be dominated by anything
+    // other than itself. The same holds for nodes without users.
+    if (f->HasImplicitUse(node) || node->users().empty()) {
+      ipdom[i] = kRoot;
+      continue;
     }
-
-    // If all lists contained the minimum value then add the value to the
-    // intersection.
-    if (match_count == lists.size()) {
-      intersection.push_back(min_value);
+    // The immediate post-dominator of a node is the nearest common
+    // post-dominator of its users.
+    std::optional<int64_t> common;
+    for (Node* user : node->users()) {
+      int64_t user_index = analysis->node_index_.at(user);
+      XLS_RET_CHECK_LT(user_index, i);
+      common = common.has_value() ? intersect(*common, user_index) : user_index;
     }
+    ipdom[i] = *common;
   }
-  return intersection;
-}
 
-}  // namespace
-
-/* static */ absl::StatusOr<std::unique_ptr<PostDominatorAnalysis>>
-PostDominatorAnalysis::Run(FunctionBase* f) {
-  auto analysis = std::make_unique<PostDominatorAnalysis>();
-
-  // A reverse topological sort of the function nodes.
-  NodeIterator r = ReverseTopoSort(f);
-  std::vector<Node*> reverse_toposort(r.begin(), r.end());
-
-  // Construct the postdominators for each node. Postdominators are gathered as
-  // a sorted vector containing the node indices (in a reverse toposort) of the
-  // post dominator nodes.
-  absl::flat_hash_map<Node*, std::vector<NodeIndex>> postdominators;
-  for (NodeIndex i = 0; i < reverse_toposort.size(); ++i) {
-    Node* node = reverse_toposort[i];
-    std::vector<absl::Span<const NodeIndex>> user_postdominators;
-    for (Node* user : node->users()) {
-      user_postdominators.push_back(postdominators.at(user));
+  // Number the tree in preorder. Children are visited in index order so the
+  // numbering is deterministic.
+  std::vector<std::vector<int64_t>> children(node_count);
+  std::vector<int64_t> roots;
+  for (int64_t i = 0; i < node_count; ++i) {
+    if (ipdom[i] == kRoot) {
+      roots.push_back(i);
+    } else {
+      children[ipdom[i]].push_back(i);
     }
-    // The postdominators of a node is the intersection of the lists of
-    // postdominators for its users plus the node itself.
-    postdominators[node] = IntersectSortedLists(user_postdominators);
-    // If a node has an implicit use, then there exists an alternate path to a
-    // root node other than its users, so it can't be dominated by anything
-    // other than itself.
-    if (f->HasImplicitUse(node)) {
-      postdominators[node] = std::vector<NodeIndex>();
+  }
+  analysis->preorder_.reserve(node_count);
+  analysis->preorder_number_.resize(node_count);
+  analysis->subtree_end_.resize(node_count);
+  // Stack of (node, index of the next child to visit).
+  std::vector<std::pair<int64_t, int64_t>> stack;
+  for (int64_t root : roots) {
+    stack.push_back({root, 0});
+    analysis->preorder_number_[root] = analysis->preorder_.size();
+    analysis->preorder_.push_back(root);
+    while (!stack.empty()) {
+      auto& [current, next_child] = stack.back();
+      if (next_child < children[current].size()) {
+        int64_t child = children[current][next_child++];
+        analysis->preorder_number_[child] = analysis->preorder_.size();
+        analysis->preorder_.push_back(child);
+        stack.push_back({child, 0});
+      } else {
+        analysis->subtree_end_[current] = analysis->preorder_.size();
+        stack.pop_back();
+      }
     }
-    postdominators[node].push_back(i);
   }
+  XLS_RET_CHECK_EQ(analysis->preorder_.size(), node_count);
 
-  for (Node* node : f->nodes()) {
-    for (NodeIndex postdominator_index : postdominators[node]) {
-      Node* postdominator = reverse_toposort.at(postdominator_index);
-      analysis->dominated_node_to_post_dominators_[node].insert(postdominator);
-      analysis->post_dominator_to_dominated_nodes_[postdominator].insert(node);
-    }
+  return std::move(analysis);
+}
+
+std::vector<Node*> PostDominatorAnalysis::GetPostDominatorsOfNode(
+    const Node* node) const {
+  std::vector<Node*> post_dominators;
+  for (int64_t i = node_index_.at(node); i != kRoot;
+       i = immediate_post_dominator_[i]) {
+    post_dominators.push_back(nodes_[i]);
   }
+  SortByNodeId(&post_dominators);
+  return post_dominators;
+}
 
-  // Order nodes.
-  auto generate_ordered_by_id_nodes =
-      [](const absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>>&
-             node_to_node_set,
-         absl::flat_hash_map<Node*, std::vector<Node*>>* node_to_node_vect) {
-        for (auto& [base_node, node_set] : node_to_node_set) {
-          auto& node_vect = (*node_to_node_vect)[base_node];
-          node_vect.insert(node_vect.begin(), node_set.begin(), node_set.end());
-          SortByNodeId(&node_vect);
-        }
-      };
-  XLS_RET_CHECK(
-      analysis->dominated_node_to_post_dominators_ordered_by_id_.empty());
-  XLS_RET_CHECK(
-      analysis->post_dominator_to_dominated_nodes_ordered_by_id_.empty());
-  generate_ordered_by_id_nodes(
-      analysis->dominated_node_to_post_dominators_,
-      &analysis->dominated_node_to_post_dominators_ordered_by_id_);
-  generate_ordered_by_id_nodes(
-      analysis->post_dominator_to_dominated_nodes_,
-      &analysis->post_dominator_to_dominated_nodes_ordered_by_id_);
+std::vector<Node*> PostDominatorAnalysis::GetNodesPostDominatedByNode(
+    const Node* node) const {
+  int64_t index = node_index_.at(node);
+  std::vector<Node*> dominated;
+  dominated.reserve(subtree_end_[index] - preorder_number_[index]);
+  for (int64_t i = preorder_number_[index]; i < subtree_end_[index]; ++i) {
+    dominated.push_back(nodes_[preorder_[i]]);
+  }
+  SortByNodeId(&dominated);
+  return dominated;
+}
 
-  return std::move(analysis);
+std::optional<Node*> PostDominatorAnalysis::GetImmediatePostDominator(
+    const Node* node) const {
+  int64_t parent = immediate_post_dominator_[node_index_.at(node)];
+  if (parent == kRoot) {
+    return std::nullopt;
+  }
+  return nodes_[parent];
 }
 
 }  // namespace xls
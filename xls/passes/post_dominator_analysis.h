@@ -15,54 +15,72 @@
 #ifndef XLS_PASSES_POSTDOMINATOR_FUNCTION_H_
 #define XLS_PASSES_POSTDOMINATOR_FUNCTION_H_
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <vector>
 
-#include "absl/container/flat_hash_set.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
-#include "absl/types/span.h"
 #include "xls/ir/function.h"
 #include "xls/ir/node.h"
 
 namespace xls {
 
 // A class for post-dominator analysis of the IR instructions in a function.
+//
+// The analysis builds the post-dominator tree of the function's nodes in a
+// single pass over a reverse topological sort (the Cooper-Harvey-Kennedy
+// algorithm, which needs no iteration on an acyclic graph). A node's
+// post-dominators are its ancestors in the tree, so dominance queries are
+// answered in constant time from DFS numbering of the tree and no per-node
+// dominator sets are stored.
 class PostDominatorAnalysis {
  public:
   // Performs post-dominator analysis on the function and returns the result.
   static absl::StatusOr<std::unique_ptr<PostDominatorAnalysis>> Run(
       FunctionBase* f);
 
-  // Returns the nodes that post-dominate this node.
-  absl::Span<Node* const> GetPostDominatorsOfNode(const Node* node) const {
-    return dominated_node_to_post_dominators_ordered_by_id_.at(node);
-  }
-  // Returns the nodes that are post-dominated by this node.
-  absl::Span<Node* const> GetNodesPostDominatedByNode(const Node* node) const {
-    return post_dominator_to_dominated_nodes_ordered_by_id_.at(node);
-  }
+  // Returns the nodes that post-dominate this node, ordered by node id.
+  std::vector<Node*> GetPostDominatorsOfNode(const Node* node) const;
+  // Returns the nodes that are post-dominated by this node, ordered by node id.
+  std::vector<Node*> GetNodesPostDominatedByNode(const Node* node) const;
   // Returns true if 'node' is post-dominated by 'post_dominator'.
   bool NodeIsPostDominatedBy(const Node* node,
                              const Node* post_dominator) const {
-    return dominated_node_to_post_dominators_.at(node).contains(post_dominator);
+    return NodePostDominates(post_dominator, node);
   }
   // Returns true if 'node' post_dominates 'post_dominated'.
   bool NodePostDominates(const Node* node, const Node* post_dominated) const {
-    return post_dominator_to_dominated_nodes_.at(node).contains(post_dominated);
+    int64_t dominator = node_index_.at(node);
+    int64_t dominated = node_index_.at(post_dominated);
+    return preorder_number_[dominator] <= preorder_number_[dominated] &&
+           preorder_number_[dominated] < subtree_end_[dominator];
   }
+  // Returns the immediate post-dominator of 'node': the nearest node other
+  // than 'node' which post-dominates it. Returns std::nullopt if only 'node'
+  // post-dominates itself.
+  std::optional<Node*> GetImmediatePostDominator(const Node* node) const;
 
  private:
-  // Maps from a node to all nodes that post-dominate the node.
-  absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>>
-      dominated_node_to_post_dominators_;
-  absl::flat_hash_map<Node*, std::vector<Node*>>
-      dominated_node_to_post_dominators_ordered_by_id_;
+  // Index of the virtual root of the tree, which post-dominates every node
+  // with no users or with an implicit use.
+  static constexpr int64_t kRoot = -1;
+
+  // The nodes in reverse topological order; a node's index in this vector is
+  // used to identify it in the vectors below.
+  std::vector<Node*> nodes_;
+  absl::flat_hash_map<const Node*, int64_t> node_index_;
+
+  // Index of the immediate post-dominator of each node, or kRoot.
+  std::vector<int64_t> immediate_post_dominator_;
 
-  // Maps from a node to all nodes that are post-dominated by the node.
-  absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>>
-      post_dominator_to_dominated_nodes_;
-  absl::flat_hash_map<Node*, std::vector<Node*>>
-      post_dominator_to_dominated_nodes_ordered_by_id_;
+  // The nodes in a preorder traversal of the tree, and the position of each
+  // node in it. The nodes post-dominated by a node are exactly those in the
+  // half-open range [preorder_number_[n], subtree_end_[n]) of preorder_.
+  std::vector<int64_t> preorder_;
+  std::vector<int64_t> preorder_number_;
+  std::vector<int64_t> subtree_end_;
 };
 
 }  // namespace xls
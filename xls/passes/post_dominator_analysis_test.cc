@@ -14,6 +14,11 @@
 
 #include "xls/passes/post_dominator_analysis.h"
 
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
@@ -24,6 +29,7 @@ namespace xls {
 namespace {
 
 using ::testing::ElementsAre;
+using ::testing::Optional;
 
 class PostDominatorAnalysisTest : public IrTestBase {};
 
@@ -117,6 +123,41 @@ TEST_F(PostDominatorAnalysisTest, DiamondShape) {
               ElementsAre(and_op.node()));
   EXPECT_THAT(analysis->GetNodesPostDominatedByNode(and_op.node()),
               ElementsAre(x.node(), a.node(), b.node(), and_op.node()));
+
+  EXPECT_THAT(analysis->GetImmediatePostDominator(x.node()),
+              Optional(and_op.node()));
+  EXPECT_THAT(analysis->GetImmediatePostDominator(a.node()),
+              Optional(and_op.node()));
+  EXPECT_EQ(analysis->GetImmediatePostDominator(and_op.node()), std::nullopt);
+}
+
+TEST_F(PostDominatorAnalysisTest, LongChainWithFanout) {
+  // A chain in which every link also feeds a final and; the and is the only
+  // common post-dominator of the links.
+  constexpr int64_t kLength = 1000;
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  std::vector<BValue> links = {x};
+  for (int64_t i = 0; i < kLength; ++i) {
+    links.push_back(fb.Not(links.back()));
+  }
+  BValue and_op = fb.And(links);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PostDominatorAnalysis> analysis,
+                           PostDominatorAnalysis::Run(f));
+
+  for (const BValue& link : links) {
+    EXPECT_THAT(analysis->GetPostDominatorsOfNode(link.node()),
+                ElementsAre(link.node(), and_op.node()));
+    EXPECT_THAT(analysis->GetImmediatePostDominator(link.node()),
+                Optional(and_op.node()));
+    EXPECT_TRUE(analysis->NodePostDominates(and_op.node(), link.node()));
+  }
+  EXPECT_FALSE(analysis->NodePostDominates(links[1].node(), x.node()));
+  EXPECT_EQ(analysis->GetNodesPostDominatedByNode(and_op.node()).size(),
+            kLength + 2);
 }
 
 TEST_F(PostDominatorAnalysisTest, DoubleDiamondShape) {
@@ -0,0 +1,106 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/query_engine_cache.h"
+
+#include <cstdint>
+#include <memory>
+
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/passes/bdd_function.h"
+#include "xls/passes/bdd_query_engine.h"
+#include "xls/passes/range_query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
+
+namespace xls {
+namespace {
+
+// Returns true if no node of `f` has been added, removed or modified since the
+// change stamp `change_stamp` at which `f` had `node_count` nodes. A removed
+// node either changes the node count or, if it had operands, the change stamps
+// of its operands.
+bool UnchangedSince(FunctionBase* f, int64_t change_stamp,
+                    int64_t node_count) {
+  if (f->node_count() != node_count) {
+    return false;
+  }
+  for (Node* node : f->nodes()) {
+    if (node->change_stamp() > change_stamp) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+QueryEngineCache::Entry& QueryEngineCache::GetEntry(FunctionBase* f) {
+  absl::MutexLock lock(&mutex_);
+  std::unique_ptr<Entry>& entry = entries_[f];
+  if (entry == nullptr) {
+    entry = std::make_unique<Entry>();
+  }
+  return *entry;
+}
+
+void QueryEngineCache::Invalidate(FunctionBase* f) {
+  absl::MutexLock lock(&mutex_);
+  entries_.erase(f);
+}
+
+template <typename EngineT, typename MakeEngineT>
+absl::StatusOr<EngineT*> QueryEngineCache::GetOrRebuild(
+    FunctionBase* f, CachedEngine<EngineT>& cached, MakeEngineT make_engine) {
+  if (cached.engine == nullptr ||
+      !UnchangedSince(f, cached.change_stamp, cached.node_count)) {
+    cached.engine = make_engine();
+    XLS_RETURN_IF_ERROR(cached.engine->Populate(f).status());
+    cached.change_stamp = Node::CurrentChangeStamp();
+    cached.node_count = f->node_count();
+  }
+  return cached.engine.get();
+}
+
+absl::StatusOr<TernaryQueryEngine*> QueryEngineCache::GetTernaryQueryEngine(
+    FunctionBase* f) {
+  CachedEngine<TernaryQueryEngine>& cached = GetEntry(f).ternary;
+  if (cached.engine == nullptr) {
+    cached.engine = std::make_unique<TernaryQueryEngine>();
+    XLS_RETURN_IF_ERROR(cached.engine->Populate(f).status());
+  } else if (!UnchangedSince(f, cached.change_stamp, cached.node_count)) {
+    XLS_RETURN_IF_ERROR(cached.engine->Update(f, cached.change_stamp).status());
+  }
+  cached.change_stamp = Node::CurrentChangeStamp();
+  cached.node_count = f->node_count();
+  return cached.engine.get();
+}
+
+absl::StatusOr<RangeQueryEngine*> QueryEngineCache::GetRangeQueryEngine(
+    FunctionBase* f) {
+  return GetOrRebuild(f, GetEntry(f).range,
+                      [] { return std::make_unique<RangeQueryEngine>(); });
+}
+
+absl::StatusOr<BddQueryEngine*> QueryEngineCache::GetBddQueryEngine(
+    FunctionBase* f) {
+  return GetOrRebuild(f, GetEntry(f).bdd, [] {
+    return std::make_unique<BddQueryEngine>(BddFunction::kDefaultPathLimit);
+  });
+}
+
+}  // namespace xls
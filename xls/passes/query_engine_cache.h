@@ -0,0 +1,100 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_QUERY_ENGINE_CACHE_H_
+#define XLS_PASSES_QUERY_ENGINE_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/function_base.h"
+#include "xls/passes/bdd_query_engine.h"
+#include "xls/passes/range_query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
+
+namespace xls {
+
+// A cache of query engines shared by the passes of a pass pipeline. Rather than
+// each pass building and populating its own engine from scratch, a pass
+// requests the engine of a FunctionBase from the cache and the cache brings
+// the engine it handed out previously up to date using node change stamps
+// (see Node::change_stamp):
+//
+//  * The ternary engine is updated incrementally. Only nodes modified since
+//    the previous request, and the nodes downstream of them whose operands'
+//    known bits changed, are re-evaluated.
+//  * The range and BDD engines are reused as long as the FunctionBase has not
+//    been modified since they were populated and are rebuilt otherwise.
+//
+// The returned engines reflect the IR at the time of the request. A pass which
+// modifies the IR may continue to query its engine as it would a locally
+// populated one (nodes added after the request are not tracked) but must not
+// call Populate on it. Engines for different FunctionBases may be requested
+// concurrently.
+class QueryEngineCache {
+ public:
+  QueryEngineCache() = default;
+
+  // Returns the ternary query engine for `f`.
+  absl::StatusOr<TernaryQueryEngine*> GetTernaryQueryEngine(FunctionBase* f);
+
+  // Returns the range query engine (without givens) for `f`.
+  absl::StatusOr<RangeQueryEngine*> GetRangeQueryEngine(FunctionBase* f);
+
+  // Returns the BDD query engine for `f` using BddFunction::kDefaultPathLimit
+  // and no node filter.
+  absl::StatusOr<BddQueryEngine*> GetBddQueryEngine(FunctionBase* f);
+
+  // Discards the engines held for `f`.
+  void Invalidate(FunctionBase* f);
+
+ private:
+  template <typename EngineT>
+  struct CachedEngine {
+    std::unique_ptr<EngineT> engine;
+    // The change stamp and node count of the FunctionBase when `engine` was
+    // last brought up to date.
+    int64_t change_stamp = 0;
+    int64_t node_count = 0;
+  };
+  struct Entry {
+    CachedEngine<TernaryQueryEngine> ternary;
+    CachedEngine<RangeQueryEngine> range;
+    CachedEngine<BddQueryEngine> bdd;
+  };
+
+  // Returns the (possibly newly created) entry for `f`. The returned entry is
+  // stable and is only accessed by the thread processing `f`.
+  Entry& GetEntry(FunctionBase* f);
+
+  // Returns the engine held in `cached`, first replacing it with a freshly
+  // populated one created by `make_engine` if `f` has been modified since the
+  // engine was populated.
+  template <typename EngineT, typename MakeEngineT>
+  static absl::StatusOr<EngineT*> GetOrRebuild(FunctionBase* f,
+                                               CachedEngine<EngineT>& cached,
+                                               MakeEngineT make_engine);
+
+  absl::Mutex mutex_;
+  absl::flat_hash_map<FunctionBase*, std::unique_ptr<Entry>> entries_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_QUERY_ENGINE_CACHE_H_
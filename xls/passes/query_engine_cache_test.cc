@@ -0,0 +1,91 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/query_engine_cache.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/passes/range_query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
+
+namespace xls {
+namespace {
+
+class QueryEngineCacheTest : public IrTestBase {};
+
+TEST_F(QueryEngineCacheTest, TernaryEngineUpdatedIncrementally) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(4));
+  BValue masked = fb.And(x, fb.Literal(UBits(0b0011, 4)));
+  BValue result = fb.Or(masked, fb.Literal(UBits(0b1000, 4)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(result));
+
+  QueryEngineCache cache;
+  XLS_ASSERT_OK_AND_ASSIGN(TernaryQueryEngine * engine,
+                           cache.GetTernaryQueryEngine(f));
+  EXPECT_EQ(engine->ToString(masked.node()), "0b00XX");
+  EXPECT_EQ(engine->ToString(result.node()), "0b10XX");
+
+  // Narrow the mask. The user of the masked value is not itself modified but
+  // must be re-evaluated because the known bits of its operand change.
+  XLS_ASSERT_OK_AND_ASSIGN(Node * new_mask,
+                           f->MakeNode<Literal>(SourceInfo(),
+                                                Value(UBits(0b0001, 4))));
+  XLS_ASSERT_OK(masked.node()->ReplaceOperandNumber(1, new_mask));
+
+  XLS_ASSERT_OK_AND_ASSIGN(TernaryQueryEngine * updated_engine,
+                           cache.GetTernaryQueryEngine(f));
+  EXPECT_EQ(updated_engine, engine);
+  EXPECT_TRUE(updated_engine->IsTracked(new_mask));
+  EXPECT_EQ(updated_engine->ToString(masked.node()), "0b000X");
+  EXPECT_EQ(updated_engine->ToString(result.node()), "0b100X");
+}
+
+TEST_F(QueryEngineCacheTest, RangeEngineRebuiltOnlyAfterModification) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue sum = fb.Add(x, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(sum));
+
+  QueryEngineCache cache;
+  XLS_ASSERT_OK_AND_ASSIGN(RangeQueryEngine * engine,
+                           cache.GetRangeQueryEngine(f));
+  XLS_ASSERT_OK_AND_ASSIGN(RangeQueryEngine * same_engine,
+                           cache.GetRangeQueryEngine(f));
+  EXPECT_EQ(same_engine, engine);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * sub, f->MakeNode<BinOp>(SourceInfo(), x.node(), y.node(),
+                                     Op::kSub));
+  XLS_ASSERT_OK(f->set_return_value(sub));
+  XLS_ASSERT_OK_AND_ASSIGN(RangeQueryEngine * rebuilt_engine,
+                           cache.GetRangeQueryEngine(f));
+  EXPECT_NE(rebuilt_engine, engine);
+  EXPECT_TRUE(rebuilt_engine->IsTracked(sub));
+}
+
+}  // namespace
+}  // namespace xls
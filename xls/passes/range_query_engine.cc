@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <iterator>
 #include <limits>
 #include <optional>
 #include <ostream>
@@ -24,6 +25,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/btree_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -297,109 +299,6 @@ class RangeQueryVisitor : public DfsVisitor {
   ReachedFixpoint rf_;
 };
 
-struct MergeInterval {
-  int64_t start;
-  int64_t end;
-
-  friend bool operator<(const MergeInterval& lhs, const MergeInterval& rhs) {
-    std::pair<int64_t, int64_t> lhs_pair{lhs.start, lhs.end};
-    std::pair<int64_t, int64_t> rhs_pair{rhs.start, rhs.end};
-    return lhs_pair < rhs_pair;
-  }
-};
-
-struct BitsWithIndex {
-  Bits bits;
-  int64_t index;
-
-  friend bool operator<(const BitsWithIndex& lhs, const BitsWithIndex& rhs) {
-    if (bits_ops::ULessThan(lhs.bits, rhs.bits)) {
-      return true;
-    }
-    if (bits_ops::UEqual(lhs.bits, rhs.bits)) {
-      return lhs.index < rhs.index;
-    }
-    return false;
-  }
-};
-
-// Given a set of `Bits` (all the same bit-width) and a desired size for that
-// set, reduce the number of elements in the set to the desired size by
-// computing a way to merge together small elements of the set. Returns a list
-// of ranges in the input vector that should be merged (i.e.: each range should
-// be compacted down to a single point by whatever processes the output of
-// this function).
-static std::vector<MergeInterval> ReduceByMerging(
-    absl::Span<Bits const> elements, int64_t desired_size) {
-  if (elements.size() <= desired_size) {
-    return {};
-  }
-
-  std::vector<BitsWithIndex> elements_with_index;
-
-  {
-    int64_t i = 0;
-    for (const Bits& element : elements) {
-      elements_with_index.push_back(BitsWithIndex{element, i});
-      ++i;
-    }
-  }
-
-  std::sort(elements_with_index.begin(), elements_with_index.end());
-
-  std::vector<int64_t> indexes_to_merge;
-  indexes_to_merge.reserve(elements.size() - desired_size);
-  for (int64_t i = 0; i < elements.size() - desired_size; ++i) {
-    indexes_to_merge.push_back(elements_with_index[i].index);
-  }
-  std::sort(indexes_to_merge.begin(), indexes_to_merge.end());
-
-  // Merge contiguous runs of indices into intervals
-  std::vector<MergeInterval> result;
-  for (int64_t i = 0; i < indexes_to_merge.size(); ++i) {
-    int64_t range_start = indexes_to_merge[i];
-    while (((i + 1) < indexes_to_merge.size()) &&
-           ((indexes_to_merge[i] + 1) == indexes_to_merge[i + 1])) {
-      ++i;
-    }
-    int64_t range_end = indexes_to_merge[i];
-    result.push_back({range_start, range_end});
-  }
-
-  return result;
-}
-
-IntervalSet MinimizeIntervals(IntervalSet intervals, int64_t size) {
-  intervals.Normalize();
-
-  if (intervals.NumberOfIntervals() <= 1) {
-    return intervals;
-  }
-
-  std::vector<Bits> gap_vector;
-  for (int64_t i = 0; i < intervals.NumberOfIntervals() - 1; ++i) {
-    const Bits& x = intervals.Intervals()[i].UpperBound();
-    const Bits& y = intervals.Intervals()[i + 1].LowerBound();
-    gap_vector.push_back(bits_ops::Sub(y, x));
-  }
-
-  std::vector<MergeInterval> merges = ReduceByMerging(gap_vector, size - 1);
-
-  IntervalSet result = intervals;
-
-  for (const auto& m : merges) {
-    Interval merged = intervals.Intervals()[m.start];
-    for (int64_t i = m.start; i <= m.end + 1; ++i) {
-      merged = Interval::ConvexHull(merged, intervals.Intervals()[i]);
-    }
-    result.AddInterval(merged);
-  }
-
-  result.Normalize();
-
-  return result;
-}
-
 absl::StatusOr<ReachedFixpoint> RangeQueryEngine::PopulateWithGivens(
     RangeDataProvider& givens) {
   RangeQueryVisitor visitor(this, givens);
@@ -471,7 +370,8 @@ absl::Status RangeQueryVisitor::HandleVariadicOp(
       // that have the smallest difference between convex hull size and size.
 
       // Limit exponential growth after 12 parameters. 5^12 = 244 million
-      interval_set = MinimizeIntervals(interval_set, (i < 12) ? 5 : 1);
+      interval_set =
+          interval_ops::MinimizeIntervals(interval_set, (i < 12) ? 5 : 1);
       operands.push_back(interval_set);
       ++i;
     }
@@ -529,6 +429,13 @@ absl::Status RangeQueryVisitor::HandleVariadicOp(
           return true;
         }
         result_intervals.AddInterval(Interval(lower.value(), upper.value()));
+        // Keep the accumulated set bounded so that normalizing it stays cheap
+        // when the operands have many intervals.
+        if (result_intervals.NumberOfIntervals() >
+            2 * kMaxResIntervalSetSize) {
+          result_intervals = interval_ops::MinimizeIntervals(
+              result_intervals, kMaxResIntervalSetSize);
+        }
         return false;
       });
 
@@ -536,7 +443,7 @@ absl::Status RangeQueryVisitor::HandleVariadicOp(
     return early_status;
   }
 
-  result_intervals = MinimizeIntervals(result_intervals);
+  result_intervals = interval_ops::MinimizeIntervals(result_intervals);
 
   LeafTypeTree<IntervalSet> result(op->GetType());
   result.Set({}, result_intervals);
@@ -726,23 +633,25 @@ absl::Status RangeQueryVisitor::HandleArray(Array* array) {
   for (Node* element : array->operands()) {
     children.push_back(GetIntervalSetTree(element));
   }
-  SetIntervalSetTree(array,
-                     LeafTypeTree<IntervalSet>(array->GetType(), children));
+  SetIntervalSetTree(
+      array, LeafTypeTree<IntervalSet>(array->GetType(), std::move(children)));
   return absl::OkStatus();
 }
 
 absl::Status RangeQueryVisitor::HandleArrayConcat(ArrayConcat* array_concat) {
   INITIALIZE_OR_SKIP(array_concat);
-  std::vector<LeafTypeTree<IntervalSet>> elements;
+  // The leaves of the concatenation are the leaves of the operands in order.
+  std::vector<IntervalSet> elements;
+  elements.reserve(array_concat->GetType()->leaf_count());
   for (Node* element : array_concat->operands()) {
     LeafTypeTree<IntervalSet> concatee = GetIntervalSetTree(element);
-    const int64_t arr_size = element->GetType()->AsArrayOrDie()->size();
-    for (int32_t i = 0; i < arr_size; ++i) {
-      elements.push_back(concatee.CopySubtree({i}));
-    }
+    absl::Span<IntervalSet> concatee_elements = concatee.elements();
+    std::move(concatee_elements.begin(), concatee_elements.end(),
+              std::back_inserter(elements));
   }
-  SetIntervalSetTree(array_concat, LeafTypeTree<IntervalSet>(
-                                       array_concat->GetType(), elements));
+  SetIntervalSetTree(array_concat,
+                     LeafTypeTree<IntervalSet>(array_concat->GetType(),
+                                               absl::MakeSpan(elements)));
   return absl::OkStatus();
 }
 
@@ -968,9 +877,12 @@ absl::Status RangeQueryVisitor::HandleArrayIndex(ArrayIndex* array_index) {
         return false;
       }
     }
-    result = IntervalSetTree::Zip<IntervalSet, IntervalSet>(
-        IntervalSet::Combine, result,
-        array_interval_set_tree.CopySubtree(indexes));
+    LeafTypeTreeView<const IntervalSet> element =
+        array_interval_set_tree.AsView(indexes);
+    for (int64_t i = 0; i < result.size(); ++i) {
+      result.elements()[i] =
+          IntervalSet::Combine(result.elements()[i], element.elements()[i]);
+    }
     return false;
   });
 
@@ -1080,7 +992,11 @@ absl::Status RangeQueryVisitor::HandlePrioritySel(PrioritySelect* sel) {
   auto combine = [&](Node* node) {
     LeafTypeTree<IntervalSet> tree = GetIntervalSetTree(node);
     result = LeafTypeTree<IntervalSet>::Zip<IntervalSet, IntervalSet>(
-        IntervalSet::Combine, result, tree);
+        [](const IntervalSet& lhs, const IntervalSet& rhs) {
+          return interval_ops::CombineBounded(lhs, rhs,
+                                              kMaxResIntervalSetSize);
+        },
+        result, tree);
   };
   for (int64_t i = 0; i < sel->cases().size(); ++i) {
     // TODO(vmirian): Make implementation more efficient by considering only the
@@ -1091,7 +1007,7 @@ absl::Status RangeQueryVisitor::HandlePrioritySel(PrioritySelect* sel) {
     }
   }
   for (IntervalSet& intervals : result.elements()) {
-    intervals = MinimizeIntervals(intervals);
+    intervals = interval_ops::MinimizeIntervals(intervals);
   }
   SetIntervalSetTree(sel, result);
   return absl::OkStatus();
@@ -1228,7 +1144,11 @@ absl::Status RangeQueryVisitor::HandleSel(Select* sel) {
   auto combine = [&](Node* node) {
     LeafTypeTree<IntervalSet> tree = GetIntervalSetTree(node);
     result = LeafTypeTree<IntervalSet>::Zip<IntervalSet, IntervalSet>(
-        IntervalSet::Combine, result, tree);
+        [](const IntervalSet& lhs, const IntervalSet& rhs) {
+          return interval_ops::CombineBounded(lhs, rhs,
+                                              kMaxResIntervalSetSize);
+        },
+        result, tree);
   };
   for (int64_t i = 0; i < sel->cases().size(); ++i) {
     if (selector_values.contains(i)) {
@@ -1239,7 +1159,7 @@ absl::Status RangeQueryVisitor::HandleSel(Select* sel) {
     combine(sel->default_value().value());
   }
   for (IntervalSet& intervals : result.elements()) {
-    intervals = MinimizeIntervals(intervals);
+    intervals = interval_ops::MinimizeIntervals(intervals);
   }
   SetIntervalSetTree(sel, result);
   return absl::OkStatus();
@@ -1298,15 +1218,16 @@ absl::Status RangeQueryVisitor::HandleTuple(Tuple* tuple) {
   for (Node* element : tuple->operands()) {
     children.push_back(GetIntervalSetTree(element));
   }
-  SetIntervalSetTree(tuple,
-                     LeafTypeTree<IntervalSet>(tuple->GetType(), children));
+  SetIntervalSetTree(
+      tuple, LeafTypeTree<IntervalSet>(tuple->GetType(), std::move(children)));
   return absl::OkStatus();
 }
 
 absl::Status RangeQueryVisitor::HandleTupleIndex(TupleIndex* index) {
   INITIALIZE_OR_SKIP(index);
   LeafTypeTree<IntervalSet> arg = GetIntervalSetTree(index->operand(0));
-  SetIntervalSetTree(index, arg.CopySubtree({index->index()}));
+  SetIntervalSetTree(index,
+                     LeafTypeTree<IntervalSet>(arg.AsView({index->index()})));
   return absl::OkStatus();
 }
 
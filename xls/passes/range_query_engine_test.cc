@@ -39,6 +39,7 @@
 #include "xls/ir/function_base.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/interval.h"
+#include "xls/ir/interval_ops.h"
 #include "xls/ir/interval_set.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/node.h"
@@ -102,7 +103,8 @@ TEST_F(RangeQueryEngineTest, MinimizeIntervals) {
       for (int64_t i = 0; i < 10; ++i) {
         uint32_t seed = 802103005;
         IntervalSet interval_set = RandomIntervalSet(seed, bits);
-        IntervalSet minimized = MinimizeIntervals(interval_set, size);
+        IntervalSet minimized =
+            interval_ops::MinimizeIntervals(interval_set, size);
         EXPECT_EQ(interval_set.BitCount(), minimized.BitCount());
         EXPECT_LE(minimized.NumberOfIntervals(), size)
             << "interval_set = " << interval_set.ToString() << "\n"
@@ -0,0 +1,264 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/sat_query_engine.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/ternary.h"
+#include "xls/solvers/z3_ir_translator.h"
+#include "xls/solvers/z3_utils.h"
+#include "../z3/src/api/z3_api.h"
+
+namespace xls {
+
+SatQueryEngine::~SatQueryEngine() {
+  if (solver_ != nullptr) {
+    Z3_solver_dec_ref(ctx(), solver_);
+  }
+}
+
+absl::StatusOr<ReachedFixpoint> SatQueryEngine::Populate(FunctionBase* f) {
+  if (solver_ != nullptr) {
+    Z3_solver_dec_ref(ctx(), solver_);
+    solver_ = nullptr;
+  }
+  sat_cache_.clear();
+  ternary_cache_.clear();
+  function_base_ = f;
+  XLS_ASSIGN_OR_RETURN(translator_,
+                       solvers::z3::IrTranslator::CreateAndTranslate(
+                           f, /*allow_unsupported=*/true));
+  solver_ = solvers::z3::CreateSolver(ctx(), /*num_threads=*/1);
+  Z3_params params = Z3_mk_params(ctx());
+  Z3_params_inc_ref(ctx(), params);
+  Z3_params_set_uint(
+      ctx(), params, Z3_mk_string_symbol(ctx(), "timeout"),
+      static_cast<unsigned>(std::clamp<int64_t>(
+          absl::ToInt64Milliseconds(query_timeout_), 1,
+          std::numeric_limits<unsigned>::max())));
+  Z3_solver_set_params(ctx(), solver_, params);
+  Z3_params_dec_ref(ctx(), params);
+  return ReachedFixpoint::Changed;
+}
+
+std::optional<Z3_ast> SatQueryEngine::GetBit(
+    const TreeBitLocation& location) const {
+  if (!IsTracked(location.node()) || !location.tree_index().empty() ||
+      !location.node()->GetType()->IsBits()) {
+    return std::nullopt;
+  }
+  Z3_ast bit = Z3_mk_extract(ctx(), location.bit_index(), location.bit_index(),
+                             translator_->GetTranslation(location.node()));
+  return solvers::z3::BitVectorToBoolean(ctx(), bit);
+}
+
+Z3_lbool SatQueryEngine::CheckSat(Z3_ast condition) const {
+  unsigned id = Z3_get_ast_id(ctx(), condition);
+  auto it = sat_cache_.find(id);
+  if (it != sat_cache_.end()) {
+    return it->second;
+  }
+  ++solver_query_count_;
+  solvers::z3::ScopedErrorHandler seh(ctx());
+  Z3_solver_push(ctx(), solver_);
+  Z3_solver_assert(ctx(), solver_, condition);
+  Z3_lbool result = Z3_solver_check(ctx(), solver_);
+  Z3_solver_pop(ctx(), solver_, 1);
+  if (!seh.status().ok()) {
+    XLS_VLOG(2) << "Z3 error in SAT query: " << seh.status();
+    result = Z3_L_UNDEF;
+  }
+  sat_cache_[id] = result;
+  return result;
+}
+
+bool SatQueryEngine::Prove(Z3_ast condition) const {
+  return CheckSat(Z3_mk_not(ctx(), condition)) == Z3_L_FALSE;
+}
+
+std::optional<Bits> SatQueryEngine::FindValue(Z3_ast condition,
+                                              Node* node) const {
+  ++solver_query_count_;
+  solvers::z3::ScopedErrorHandler seh(ctx());
+  Z3_solver_push(ctx(), solver_);
+  Z3_solver_assert(ctx(), solver_, condition);
+  std::optional<Bits> result;
+  if (Z3_solver_check(ctx(), solver_) == Z3_L_TRUE) {
+    Z3_model model = Z3_solver_get_model(ctx(), solver_);
+    Z3_ast value = translator_->GetTranslation(node);
+    absl::InlinedVector<bool, 64> bits;
+    for (int64_t i = 0; i < node->BitCountOrDie(); ++i) {
+      Z3_ast bit_value;
+      uint64_t bit = 0;
+      Z3_model_eval(ctx(), model, Z3_mk_extract(ctx(), i, i, value),
+                    /*model_completion=*/true, &bit_value);
+      Z3_get_numeral_uint64(ctx(), bit_value, &bit);
+      bits.push_back(bit != 0);
+    }
+    result = Bits(bits);
+  }
+  Z3_solver_pop(ctx(), solver_, 1);
+  if (!seh.status().ok()) {
+    XLS_VLOG(2) << "Z3 error in SAT query: " << seh.status();
+    return std::nullopt;
+  }
+  return result;
+}
+
+LeafTypeTree<TernaryVector> SatQueryEngine::GetTernary(Node* node) const {
+  LeafTypeTree<TernaryVector> result(node->GetType());
+  for (int64_t i = 0; i < result.size(); ++i) {
+    result.elements()[i] = TernaryVector(
+        result.leaf_types()[i]->GetFlatBitCount(), TernaryValue::kUnknown);
+  }
+  if (!IsTracked(node) || !node->GetType()->IsBits()) {
+    return result;
+  }
+  auto it = ternary_cache_.find(node);
+  if (it != ternary_cache_.end()) {
+    result.Set({}, it->second);
+    return result;
+  }
+
+  // Any value the node can take is the only candidate for the known bits so a
+  // single query per bit suffices.
+  TernaryVector ternary(node->BitCountOrDie(), TernaryValue::kUnknown);
+  std::optional<Bits> value = FindValue(Z3_mk_true(ctx()), node);
+  if (value.has_value()) {
+    for (int64_t i = 0; i < node->BitCountOrDie(); ++i) {
+      Z3_ast bit = GetBit(TreeBitLocation(node, i)).value();
+      bool bit_value = value->Get(i);
+      if (Prove(bit_value ? bit : Z3_mk_not(ctx(), bit))) {
+        ternary[i] =
+            bit_value ? TernaryValue::kKnownOne : TernaryValue::kKnownZero;
+      }
+    }
+  }
+  ternary_cache_[node] = ternary;
+  result.Set({}, ternary);
+  return result;
+}
+
+bool SatQueryEngine::AtMostOneTrue(
+    absl::Span<TreeBitLocation const> bits) const {
+  if (bits.size() <= 1) {
+    return true;
+  }
+  std::vector<Z3_ast> terms;
+  for (const TreeBitLocation& location : bits) {
+    std::optional<Z3_ast> bit = GetBit(location);
+    if (!bit.has_value()) {
+      return false;
+    }
+    terms.push_back(*bit);
+  }
+  return Prove(Z3_mk_atmost(ctx(), terms.size(), terms.data(), 1));
+}
+
+bool SatQueryEngine::AtLeastOneTrue(
+    absl::Span<TreeBitLocation const> bits) const {
+  std::vector<Z3_ast> terms;
+  for (const TreeBitLocation& location : bits) {
+    std::optional<Z3_ast> bit = GetBit(location);
+    if (bit.has_value()) {
+      terms.push_back(*bit);
+    }
+  }
+  if (terms.empty()) {
+    return false;
+  }
+  return Prove(Z3_mk_or(ctx(), terms.size(), terms.data()));
+}
+
+bool SatQueryEngine::Implies(const TreeBitLocation& a,
+                             const TreeBitLocation& b) const {
+  std::optional<Z3_ast> a_bit = GetBit(a);
+  std::optional<Z3_ast> b_bit = GetBit(b);
+  if (!a_bit.has_value() || !b_bit.has_value()) {
+    return false;
+  }
+  return Prove(Z3_mk_implies(ctx(), *a_bit, *b_bit));
+}
+
+std::optional<Bits> SatQueryEngine::ImpliedNodeValue(
+    absl::Span<const std::pair<TreeBitLocation, bool>> predicate_bit_values,
+    Node* node) const {
+  if (!IsTracked(node) || !node->GetType()->IsBits()) {
+    return std::nullopt;
+  }
+  std::vector<Z3_ast> terms;
+  for (const auto& [location, value] : predicate_bit_values) {
+    std::optional<Z3_ast> bit = GetBit(location);
+    if (!bit.has_value()) {
+      return std::nullopt;
+    }
+    terms.push_back(value ? *bit : Z3_mk_not(ctx(), *bit));
+  }
+  Z3_ast predicate = terms.empty()
+                         ? Z3_mk_true(ctx())
+                         : Z3_mk_and(ctx(), terms.size(), terms.data());
+
+  // If the predicate can't be satisfied it implies no particular value.
+  // Otherwise, the value in any satisfying assignment is the only candidate.
+  std::optional<Bits> value = FindValue(predicate, node);
+  if (!value.has_value()) {
+    return std::nullopt;
+  }
+  absl::StatusOr<Z3_ast> literal = translator_->TranslateLiteralBits(*value);
+  if (!literal.ok()) {
+    return std::nullopt;
+  }
+  Z3_ast node_has_value =
+      Z3_mk_eq(ctx(), translator_->GetTranslation(node), *literal);
+  if (!Prove(Z3_mk_implies(ctx(), predicate, node_has_value))) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+bool SatQueryEngine::KnownEquals(const TreeBitLocation& a,
+                                 const TreeBitLocation& b) const {
+  std::optional<Z3_ast> a_bit = GetBit(a);
+  std::optional<Z3_ast> b_bit = GetBit(b);
+  if (!a_bit.has_value() || !b_bit.has_value()) {
+    return false;
+  }
+  return Prove(Z3_mk_eq(ctx(), *a_bit, *b_bit));
+}
+
+bool SatQueryEngine::KnownNotEquals(const TreeBitLocation& a,
+                                    const TreeBitLocation& b) const {
+  std::optional<Z3_ast> a_bit = GetBit(a);
+  std::optional<Z3_ast> b_bit = GetBit(b);
+  if (!a_bit.has_value() || !b_bit.has_value()) {
+    return false;
+  }
+  return Prove(Z3_mk_xor(ctx(), *a_bit, *b_bit));
+}
+
+}  // namespace xls
@@ -0,0 +1,117 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_SAT_QUERY_ENGINE_H_
+#define XLS_PASSES_SAT_QUERY_ENGINE_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/ternary.h"
+#include "xls/passes/query_engine.h"
+#include "xls/solvers/z3_ir_translator.h"
+#include "../z3/src/api/z3_api.h"
+
+namespace xls {
+
+// A query engine which answers queries with a SAT/SMT solver (Z3). Unlike a
+// BDD the cost of the analysis does not depend on a variable ordering so
+// arithmetic and comparisons are handled precisely. The function is translated
+// into word-level Z3 terms once when the engine is populated; the solver only
+// bit-blasts the cone of logic reached by each query. All queries share a
+// single incremental solver: each query is checked in its own solver scope so
+// what the solver learns about the function carries over to later queries.
+//
+// Each query is limited to `query_timeout`. Queries which time out are
+// answered conservatively (e.g., Implies returns false). Results are cached so
+// repeated queries are free. Only bits-typed values are analyzed; queries
+// about bits inside tuples or arrays are answered conservatively.
+//
+// Answering GetTernary requires a solver query per bit so this engine is best
+// used for the relational queries (AtMostOneTrue, Implies, KnownEquals, etc)
+// or combined with a cheaper engine in a UnionQueryEngine.
+class SatQueryEngine : public QueryEngine {
+ public:
+  static constexpr absl::Duration kDefaultQueryTimeout =
+      absl::Milliseconds(100);
+
+  explicit SatQueryEngine(absl::Duration query_timeout = kDefaultQueryTimeout)
+      : query_timeout_(query_timeout) {}
+  ~SatQueryEngine() override;
+
+  absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
+
+  bool IsTracked(Node* node) const override {
+    return translator_ != nullptr && node->function_base() == function_base_;
+  }
+
+  LeafTypeTree<TernaryVector> GetTernary(Node* node) const override;
+
+  bool AtMostOneTrue(absl::Span<TreeBitLocation const> bits) const override;
+  bool AtLeastOneTrue(absl::Span<TreeBitLocation const> bits) const override;
+  bool Implies(const TreeBitLocation& a,
+               const TreeBitLocation& b) const override;
+  std::optional<Bits> ImpliedNodeValue(
+      absl::Span<const std::pair<TreeBitLocation, bool>> predicate_bit_values,
+      Node* node) const override;
+  bool KnownEquals(const TreeBitLocation& a,
+                   const TreeBitLocation& b) const override;
+  bool KnownNotEquals(const TreeBitLocation& a,
+                      const TreeBitLocation& b) const override;
+
+  // Returns the number of queries sent to the solver (excluding cache hits).
+  int64_t solver_query_count() const { return solver_query_count_; }
+
+ private:
+  Z3_context ctx() const { return translator_->ctx(); }
+
+  // Returns the boolean Z3 term for the given bit or std::nullopt if the bit
+  // is not analyzed.
+  std::optional<Z3_ast> GetBit(const TreeBitLocation& location) const;
+
+  // Returns the satisfiability of `condition`. The result is cached. Queries
+  // which time out are Z3_L_UNDEF.
+  Z3_lbool CheckSat(Z3_ast condition) const;
+
+  // Returns true if `condition` is proven to hold for all inputs.
+  bool Prove(Z3_ast condition) const;
+
+  // Returns a value of the bits-typed `node` for which `condition` holds or
+  // std::nullopt if no value is found within the query timeout. Not cached.
+  std::optional<Bits> FindValue(Z3_ast condition, Node* node) const;
+
+  absl::Duration query_timeout_;
+  FunctionBase* function_base_ = nullptr;
+  std::unique_ptr<solvers::z3::IrTranslator> translator_;
+  Z3_solver solver_ = nullptr;
+
+  // Satisfiability of the conditions queried so far keyed by Z3 AST id. ASTs
+  // are hash-consed by Z3 so structurally equal conditions share an id.
+  mutable absl::flat_hash_map<unsigned, Z3_lbool> sat_cache_;
+  mutable absl::flat_hash_map<Node*, TernaryVector> ternary_cache_;
+  mutable int64_t solver_query_count_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_SAT_QUERY_ENGINE_H_
@@ -0,0 +1,102 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/sat_query_engine.h"
+
+#include <optional>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/ternary.h"
+
+namespace xls {
+namespace {
+
+using ::testing::Optional;
+
+class SatQueryEngineTest : public IrTestBase {};
+
+TEST_F(SatQueryEngineTest, ArithmeticRelations) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  // x + y == y + x regardless of the values, which BDDs generally can't show
+  // for wide operands.
+  BValue sums_equal = fb.Eq(fb.Add(x, y), fb.Add(y, x));
+  BValue x_lt_y = fb.ULt(x, y);
+  BValue y_lt_x = fb.ULt(y, x);
+  BValue x_eq_y = fb.Eq(x, y);
+  BValue x_le_y = fb.ULe(x, y);
+  XLS_ASSERT_OK(fb.Build().status());
+
+  SatQueryEngine query_engine;
+  XLS_ASSERT_OK(query_engine.Populate(fb.function()).status());
+
+  EXPECT_TRUE(query_engine.IsOne(TreeBitLocation(sums_equal.node(), 0)));
+  EXPECT_TRUE(query_engine.AtMostOneNodeTrue(
+      {x_lt_y.node(), y_lt_x.node(), x_eq_y.node()}));
+  EXPECT_TRUE(query_engine.AtLeastOneNodeTrue(
+      {x_lt_y.node(), y_lt_x.node(), x_eq_y.node()}));
+  EXPECT_TRUE(query_engine.Implies(TreeBitLocation(x_lt_y.node(), 0),
+                                   TreeBitLocation(x_le_y.node(), 0)));
+  EXPECT_FALSE(query_engine.Implies(TreeBitLocation(x_le_y.node(), 0),
+                                    TreeBitLocation(x_lt_y.node(), 0)));
+  EXPECT_TRUE(query_engine.KnownNotEquals(TreeBitLocation(x_le_y.node(), 0),
+                                          TreeBitLocation(y_lt_x.node(), 0)));
+  EXPECT_FALSE(query_engine.KnownEquals(TreeBitLocation(x_lt_y.node(), 0),
+                                        TreeBitLocation(y_lt_x.node(), 0)));
+
+  // Repeated queries are answered from the cache.
+  int64_t query_count = query_engine.solver_query_count();
+  EXPECT_TRUE(query_engine.Implies(TreeBitLocation(x_lt_y.node(), 0),
+                                   TreeBitLocation(x_le_y.node(), 0)));
+  EXPECT_EQ(query_engine.solver_query_count(), query_count);
+}
+
+TEST_F(SatQueryEngineTest, TernaryAndImpliedValues) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue x_or_1 = fb.Or(x, fb.Literal(UBits(1, 8)));
+  BValue x_eq_42 = fb.Eq(x, fb.Literal(UBits(42, 8)));
+  BValue x_plus_1 = fb.Add(x, fb.Literal(UBits(1, 8)));
+  XLS_ASSERT_OK(fb.Build().status());
+
+  SatQueryEngine query_engine;
+  XLS_ASSERT_OK(query_engine.Populate(fb.function()).status());
+
+  EXPECT_EQ(ToString(query_engine.GetTernary(x_or_1.node()).Get({})),
+            "0bXXXX_XXX1");
+  EXPECT_EQ(ToString(query_engine.GetTernary(x.node()).Get({})),
+            "0bXXXX_XXXX");
+
+  EXPECT_THAT(query_engine.ImpliedNodeValue(
+                  {{TreeBitLocation(x_eq_42.node(), 0), true}},
+                  x_plus_1.node()),
+              Optional(UBits(43, 8)));
+  EXPECT_EQ(query_engine.ImpliedNodeValue(
+                {{TreeBitLocation(x_eq_42.node(), 0), false}},
+                x_plus_1.node()),
+            std::nullopt);
+}
+
+}  // namespace
+}  // namespace xls
@@ -42,6 +42,7 @@
 #include "xls/ir/node_util.h"
 #include "xls/ir/nodes.h"
 #include "xls/passes/optimization_pass.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/ternary_query_engine.h"
 
 namespace xls {
@@ -938,12 +939,18 @@ absl::StatusOr<bool> SimplifyNode(Node* node, const QueryEngine& query_engine,
 absl::StatusOr<bool> SelectSimplificationPass::RunOnFunctionBaseInternal(
     FunctionBase* func, const OptimizationPassOptions& options,
     PassResults* results) const {
-  TernaryQueryEngine query_engine;
-  XLS_RETURN_IF_ERROR(query_engine.Populate(func).status());
+  TernaryQueryEngine local_query_engine;
+  TernaryQueryEngine* query_engine = &local_query_engine;
+  if (options.query_engine_cache != nullptr) {
+    XLS_ASSIGN_OR_RETURN(
+        query_engine, options.query_engine_cache->GetTernaryQueryEngine(func));
+  } else {
+    XLS_RETURN_IF_ERROR(local_query_engine.Populate(func).status());
+  }
   bool changed = false;
   for (Node* node : TopoSort(func)) {
     XLS_ASSIGN_OR_RETURN(bool node_changed,
-                         SimplifyNode(node, query_engine, opt_level_));
+                         SimplifyNode(node, *query_engine, opt_level_));
     changed = changed || node_changed;
   }
 
@@ -964,7 +971,7 @@ absl::StatusOr<bool> SelectSimplificationPass::RunOnFunctionBaseInternal(
       // ok. TernaryQueryEngine::IsTracked will return false for new nodes which
       // have not been analyzed.
       XLS_ASSIGN_OR_RETURN(std::vector<OneHotSelect*> new_ohses,
-                           MaybeSplitOneHotSelect(ohs, query_engine));
+                           MaybeSplitOneHotSelect(ohs, *query_engine));
       if (!new_ohses.empty()) {
         changed = true;
         worklist.insert(worklist.end(), new_ohses.begin(), new_ohses.end());
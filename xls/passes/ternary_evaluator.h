@@ -16,6 +16,7 @@
 #define XLS_PASSES_TERNARY_EVALUATOR_H_
 
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/ir/abstract_evaluator.h"
 #include "xls/ir/bits.h"
@@ -49,6 +50,61 @@ class TernaryEvaluator
   TernaryValue Or(const TernaryValue& a, const TernaryValue& b) const {
     return ternary_ops::Or(a, b);
   }
+
+  // Word-parallel versions of the bitwise and arithmetic operations of
+  // AbstractEvaluator which would otherwise be evaluated position by position.
+  // The operands are packed (see PackedTernaryVector), combined 64 positions at
+  // a time and unpacked.
+  Vector BitwiseNot(const Vector& input) const {
+    return ternary_ops::Unpack(ternary_ops::Not(ternary_ops::Pack(input)));
+  }
+  Vector BitwiseAnd(absl::Span<const Vector> inputs) const {
+    return ReducePacked(inputs, [](const auto& a, const auto& b) {
+      return ternary_ops::And(a, b);
+    });
+  }
+  Vector BitwiseOr(absl::Span<const Vector> inputs) const {
+    return ReducePacked(inputs, [](const auto& a, const auto& b) {
+      return ternary_ops::Or(a, b);
+    });
+  }
+  Vector BitwiseXor(absl::Span<const Vector> inputs) const {
+    return ReducePacked(inputs, [](const auto& a, const auto& b) {
+      return ternary_ops::Xor(a, b);
+    });
+  }
+  Vector BitwiseAnd(const Vector& a, const Vector& b) const {
+    return BitwiseAnd({a, b});
+  }
+  Vector BitwiseOr(const Vector& a, const Vector& b) const {
+    return BitwiseOr({a, b});
+  }
+  Vector BitwiseXor(const Vector& a, const Vector& b) const {
+    return BitwiseXor({a, b});
+  }
+
+  Vector Add(const Vector& a, const Vector& b) const {
+    return ternary_ops::Unpack(
+        ternary_ops::Add(ternary_ops::Pack(a), ternary_ops::Pack(b)));
+  }
+  Vector Neg(const Vector& x) const {
+    return ternary_ops::Unpack(ternary_ops::Add(
+        ternary_ops::Not(ternary_ops::Pack(x)),
+        ternary_ops::Pack(ternary_ops::BitsToTernary(UBits(1, x.size())))));
+  }
+
+ private:
+  // Folds the packed `inputs` with `f`.
+  template <typename F>
+  Vector ReducePacked(absl::Span<const Vector> inputs, F f) const {
+    XLS_CHECK_GT(inputs.size(), 0);
+    PackedTernaryVector result = ternary_ops::Pack(inputs.front());
+    for (const Vector& input : inputs.subspan(1)) {
+      XLS_CHECK_EQ(input.size(), inputs.front().size());
+      result = f(result, ternary_ops::Pack(input));
+    }
+    return ternary_ops::Unpack(result);
+  }
 };
 
 }  // namespace xls
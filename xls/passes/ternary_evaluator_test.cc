@@ -167,6 +167,50 @@ TEST_F(TernaryLogicTest, BitwiseOps) {
             "0b1_X0XX_X0X1");
 }
 
+TEST_F(TernaryLogicTest, AddAndNeg) {
+  // Enumerate all 3-wide ternary inputs. The word-parallel ternary adder is
+  // maximally precise.
+  for (const TernaryVector& lhs : EnumerateTernaryVectors(/*width=*/3)) {
+    std::vector<Bits> neg_results;
+    for (const Bits& lhs_bits : ExpandToBits(lhs)) {
+      neg_results.push_back(bits_ops::Negate(lhs_bits));
+    }
+    EXPECT_EQ(ToString(evaluator_.Neg(lhs)),
+              ToString(ReduceFromBits(neg_results)))
+        << "-" << ToString(lhs);
+    for (const TernaryVector& rhs : EnumerateTernaryVectors(/*width=*/3)) {
+      std::vector<Bits> results;
+      for (const Bits& lhs_bits : ExpandToBits(lhs)) {
+        for (const Bits& rhs_bits : ExpandToBits(rhs)) {
+          results.push_back(bits_ops::Add(lhs_bits, rhs_bits));
+        }
+      }
+      EXPECT_EQ(ToString(evaluator_.Add(lhs, rhs)),
+                ToString(ReduceFromBits(results)))
+          << ToString(lhs) << " + " << ToString(rhs);
+    }
+  }
+}
+
+TEST_F(TernaryLogicTest, WideAdd) {
+  // The carry out of the low word is known.
+  TernaryVector lhs = evaluator_.BitsToVector(
+      bits_ops::ZeroExtend(Bits::AllOnes(64), 130));
+  TernaryVector rhs = evaluator_.BitsToVector(UBits(1, 130));
+  rhs[129] = TernaryValue::kUnknown;
+  TernaryVector expected = evaluator_.BitsToVector(
+      bits_ops::ShiftLeftLogical(UBits(1, 130), 64));
+  expected[129] = TernaryValue::kUnknown;
+  EXPECT_EQ(evaluator_.Add(lhs, rhs), expected);
+
+  // An unknown low bit makes the carry chain unknown.
+  rhs[0] = TernaryValue::kUnknown;
+  TernaryVector sum = evaluator_.Add(lhs, rhs);
+  EXPECT_EQ(sum[0], TernaryValue::kUnknown);
+  EXPECT_EQ(sum[64], TernaryValue::kUnknown);
+  EXPECT_EQ(sum[65], TernaryValue::kKnownZero);
+}
+
 TEST_F(TernaryLogicTest, Equals) {
   EXPECT_EQ(evaluator_.Equals(FromString("0b101"), FromString("0bXXX")),
             TernaryValue::kUnknown);
@@ -16,9 +16,9 @@
 
 #include <algorithm>
 #include <limits>
+#include <utility>
 #include <vector>
 
-#include "absl/container/inlined_vector.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "xls/common/status/status_macros.h"
@@ -27,6 +27,7 @@
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/node_iterator.h"
+#include "xls/ir/ternary.h"
 #include "xls/passes/ternary_evaluator.h"
 
 namespace xls {
@@ -44,53 +45,46 @@ static bool IsExpensiveToEvaluate(Node* node) {
          node->GetType()->GetFlatBitCount() > 256;
 }
 
-static Bits TernaryVectorToKnownBits(
+// Returns the known bits and known bit values of `ternary_vector`.
+static std::pair<Bits, Bits> TernaryVectorToKnownBits(
     const TernaryEvaluator::Vector& ternary_vector) {
-  // Use InlinedVector to avoid std::vector<bool> specialization madness.
-  absl::InlinedVector<bool, 1> bits(ternary_vector.size());
-  for (int64_t i = 0; i < bits.size(); ++i) {
-    bits[i] = (ternary_vector[i] == TernaryValue::kKnownOne ||
-               ternary_vector[i] == TernaryValue::kKnownZero);
-  }
-  return Bits(bits);
+  PackedTernaryVector packed = ternary_ops::Pack(ternary_vector);
+  return {Bits::FromBitmap(std::move(packed.known)),
+          Bits::FromBitmap(std::move(packed.value))};
 }
 
-static Bits TernaryVectorToValueBits(
-    const TernaryEvaluator::Vector& ternary_vector) {
-  // Use InlinedVector to avoid std::vector<bool> specialization madness.
-  absl::InlinedVector<bool, 1> bits(ternary_vector.size());
-  for (int64_t i = 0; i < bits.size(); ++i) {
-    bits[i] = ternary_vector[i] == TernaryValue::kKnownOne;
+// Evaluates the bits-typed `node` over the ternary domain given the values of
+// its operands.
+static absl::StatusOr<TernaryEvaluator::Vector> EvaluateNode(
+    Node* node, TernaryEvaluator& evaluator,
+    std::vector<TernaryEvaluator::Vector> operand_values) {
+  auto create_unknown_vector = [](Node* n) {
+    return TernaryEvaluator::Vector(n->BitCountOrDie(), TernaryValue::kUnknown);
+  };
+  if (IsExpensiveToEvaluate(node) ||
+      std::any_of(node->operands().begin(), node->operands().end(),
+                  [](Node* o) { return !o->GetType()->IsBits(); })) {
+    return create_unknown_vector(node);
   }
-  return Bits(bits);
+  return AbstractEvaluate(node, operand_values, &evaluator,
+                          /*default_handler=*/create_unknown_vector);
 }
 
 absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::Populate(FunctionBase* f) {
   TernaryEvaluator evaluator;
-  absl::flat_hash_map<Node*, TernaryEvaluator::Vector> values;
+  NodeMap<TernaryEvaluator::Vector> values(f);
   for (Node* node : TopoSort(f)) {
     if (!node->GetType()->IsBits()) {
       continue;
     }
-    auto create_unknown_vector = [](Node* n) {
-      return TernaryEvaluator::Vector(n->BitCountOrDie(),
-                                      TernaryValue::kUnknown);
-    };
-    if (IsExpensiveToEvaluate(node) ||
-        std::any_of(node->operands().begin(), node->operands().end(),
-                    [](Node* o) { return !o->GetType()->IsBits(); })) {
-      values[node] = create_unknown_vector(node);
-      continue;
-    }
-
     std::vector<TernaryEvaluator::Vector> operand_values;
     for (Node* operand : node->operands()) {
-      operand_values.push_back(values.at(operand));
+      if (operand->GetType()->IsBits()) {
+        operand_values.push_back(values.at(operand));
+      }
     }
-    XLS_ASSIGN_OR_RETURN(
-        values[node],
-        AbstractEvaluate(node, operand_values, &evaluator,
-                         /*default_handler=*/create_unknown_vector));
+    XLS_ASSIGN_OR_RETURN(values[node],
+                         EvaluateNode(node, evaluator, operand_values));
   }
 
   ReachedFixpoint rf = ReachedFixpoint::Unchanged;
@@ -101,10 +95,10 @@ absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::Populate(FunctionBase* f) {
         known_bits_[node] = Bits(values.at(node).size());
         bits_values_[node] = Bits(values.at(node).size());
       }
-      Bits combined_known_bits = bits_ops::Or(
-          known_bits_[node], TernaryVectorToKnownBits(values.at(node)));
-      Bits combined_bits_values = bits_ops::Or(
-          bits_values_[node], TernaryVectorToValueBits(values.at(node)));
+      auto [known_bits, bits_values] =
+          TernaryVectorToKnownBits(values.at(node));
+      Bits combined_known_bits = bits_ops::Or(known_bits_[node], known_bits);
+      Bits combined_bits_values = bits_ops::Or(bits_values_[node], bits_values);
       if ((combined_known_bits != known_bits_[node]) ||
           (combined_bits_values != bits_values_[node])) {
         rf = ReachedFixpoint::Changed;
@@ -116,6 +110,48 @@ absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::Populate(FunctionBase* f) {
   return rf;
 }
 
+absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::Update(
+    FunctionBase* f, int64_t changed_since) {
+  TernaryEvaluator evaluator;
+  // Nodes whose known bits differ from those previously recorded.
+  NodeSet changed(f);
+  NodeSet live(f);
+  for (Node* node : TopoSort(f)) {
+    live.insert(node);
+    if (!node->GetType()->IsBits()) {
+      continue;
+    }
+    if (node->change_stamp() <= changed_since && known_bits_.contains(node) &&
+        std::none_of(node->operands().begin(), node->operands().end(),
+                     [&](Node* o) { return changed.contains(o); })) {
+      continue;
+    }
+    std::vector<TernaryEvaluator::Vector> operand_values;
+    for (Node* operand : node->operands()) {
+      if (operand->GetType()->IsBits()) {
+        operand_values.push_back(ternary_ops::FromKnownBits(
+            known_bits_.at(operand), bits_values_.at(operand)));
+      }
+    }
+    XLS_ASSIGN_OR_RETURN(TernaryEvaluator::Vector value,
+                         EvaluateNode(node, evaluator, operand_values));
+    auto [known_bits, bits_values] = TernaryVectorToKnownBits(value);
+    auto it = known_bits_.find(node);
+    if (it == known_bits_.end() || it->second != known_bits ||
+        bits_values_.at(node) != bits_values) {
+      changed.insert(node);
+      known_bits_[node] = std::move(known_bits);
+      bits_values_[node] = std::move(bits_values);
+    }
+  }
+  known_bits_.erase_if(
+      [&](const auto& kv) { return !live.contains(kv.first); });
+  bits_values_.erase_if(
+      [&](const auto& kv) { return !live.contains(kv.first); });
+  return changed.empty() ? ReachedFixpoint::Unchanged
+                         : ReachedFixpoint::Changed;
+}
+
 bool TernaryQueryEngine::AtMostOneTrue(
     absl::Span<TreeBitLocation const> bits) const {
   int64_t maybe_one_count = 0;
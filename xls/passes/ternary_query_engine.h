@@ -15,12 +15,14 @@
 #ifndef XLS_PASSES_TERNARY_QUERY_ENGINE_H_
 #define XLS_PASSES_TERNARY_QUERY_ENGINE_H_
 
+#include <cstdint>
 #include <optional>
 #include <utility>
 
 #include "absl/status/statusor.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function.h"
+#include "xls/ir/node_map.h"
 #include "xls/ir/nodes.h"
 #include "xls/passes/query_engine.h"
 
@@ -37,18 +39,28 @@ class TernaryQueryEngine : public QueryEngine {
 
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
 
+  // Brings a previously populated engine up to date with `f` after it has been
+  // modified. `changed_since` is the change stamp (see Node::change_stamp) at
+  // which the engine was last brought up to date. Only nodes modified after
+  // that stamp, and nodes whose operands' known bits changed as a result, are
+  // re-evaluated, and nodes which are no longer in `f` are dropped. Unlike
+  // Populate, the re-evaluated values replace the previous ones rather than
+  // refining them.
+  absl::StatusOr<ReachedFixpoint> Update(FunctionBase* f,
+                                         int64_t changed_since);
+
   bool IsTracked(Node* node) const override {
     return known_bits_.contains(node);
   }
 
   LeafTypeTree<TernaryVector> GetTernary(Node* node) const override {
     if (!node->GetType()->IsBits()) {
-      LeafTypeTree<absl::monostate> shape(node->GetType());
-      return LeafTypeTree<Type*>(shape.type(), shape.leaf_types())
-          .Map<TernaryVector>([](Type* type) -> TernaryVector {
-            return TernaryVector(type->GetFlatBitCount(),
-                                 TernaryValue::kUnknown);
-          });
+      LeafTypeTree<TernaryVector> result(node->GetType());
+      for (int64_t i = 0; i < result.size(); ++i) {
+        result.elements()[i] = TernaryVector(
+            result.leaf_types()[i]->GetFlatBitCount(), TernaryValue::kUnknown);
+      }
+      return result;
     }
     TernaryVector ternary =
         ternary_ops::FromKnownBits(known_bits_.at(node), bits_values_.at(node));
@@ -80,10 +92,10 @@ class TernaryQueryEngine : public QueryEngine {
   // Holds which bits values are known for nodes in the function. A one in a bit
   // position indications the respective bit value in the respective node is
   // statically known.
-  absl::flat_hash_map<Node*, Bits> known_bits_;
+  NodeMap<Bits> known_bits_;
 
   // Holds the values of statically known bits of nodes in the function.
-  absl::flat_hash_map<Node*, Bits> bits_values_;
+  NodeMap<Bits> bits_values_;
 };
 
 }  // namespace xls
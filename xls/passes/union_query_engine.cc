@@ -31,7 +31,7 @@ namespace xls {
 
 absl::StatusOr<ReachedFixpoint> UnionQueryEngine::Populate(FunctionBase* f) {
   ReachedFixpoint result = ReachedFixpoint::Unchanged;
-  for (const std::unique_ptr<QueryEngine>& engine : engines_) {
+  for (QueryEngine* engine : engines_) {
     XLS_ASSIGN_OR_RETURN(ReachedFixpoint rf, engine->Populate(f));
     // Unchanged is the top of the lattice so it's an identity
     if (result == ReachedFixpoint::Unchanged) {
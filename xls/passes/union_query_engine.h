@@ -44,8 +44,19 @@ namespace xls {
 // will be fixed at some point.
 class UnionQueryEngine : public QueryEngine {
  public:
-  explicit UnionQueryEngine(std::vector<std::unique_ptr<QueryEngine>> engines) {
-    engines_ = std::move(engines);
+  explicit UnionQueryEngine(std::vector<std::unique_ptr<QueryEngine>> engines)
+      : owned_engines_(std::move(engines)) {
+    for (const std::unique_ptr<QueryEngine>& engine : owned_engines_) {
+      engines_.push_back(engine.get());
+    }
+  }
+
+  // Constructs a union of engines owned elsewhere (e.g., by a
+  // QueryEngineCache) which must outlive this object.
+  static UnionQueryEngine Unowned(std::vector<QueryEngine*> engines) {
+    UnionQueryEngine result({});
+    result.engines_ = std::move(engines);
+    return result;
   }
 
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
@@ -79,7 +90,8 @@ class UnionQueryEngine : public QueryEngine {
  private:
   absl::flat_hash_map<Node*, Bits> known_bits_;
   absl::flat_hash_map<Node*, Bits> known_bit_values_;
-  std::vector<std::unique_ptr<QueryEngine>> engines_;
+  std::vector<std::unique_ptr<QueryEngine>> owned_engines_;
+  std::vector<QueryEngine*> engines_;
 };
 
 }  // namespace xls
@@ -14,37 +14,47 @@
 
 #include "xls/passes/unroll_pass.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/node_iterator.h"
+#include "xls/ir/package.h"
 #include "xls/passes/optimization_pass.h"
 
 namespace xls {
 namespace {
 
-// Finds an "effectively used" (has users or is return value) counted for in the
-// function f, or returns nullptr if none is found.
-CountedFor* FindCountedFor(FunctionBase* f) {
+// Finds the "effectively used" (has users or is return value) counted fors in
+// the function f.
+std::vector<CountedFor*> FindCountedFors(FunctionBase* f) {
+  std::vector<CountedFor*> loops;
   for (Node* node : TopoSort(f)) {
     if (node->Is<CountedFor>() &&
         (f->HasImplicitUse(node) || !node->users().empty())) {
-      return node->As<CountedFor>();
+      loops.push_back(node->As<CountedFor>());
     }
   }
-  return nullptr;
+  return loops;
 }
 
-// Unrolls the node "loop" by replacing it with a sequence of dependent
-// invocations.
-absl::Status UnrollCountedFor(CountedFor* loop) {
+// Emits invokes of the body of `loop` for the iterations [first_trip,
+// end_trip) starting from the loop carry value `loop_carry`. Returns the final
+// loop carry value.
+absl::StatusOr<Node*> EmitIterations(CountedFor* loop, int64_t first_trip,
+                                     int64_t end_trip, Node* loop_carry) {
   FunctionBase* f = loop->function_base();
-  Node* loop_carry = loop->initial_value();
   int64_t ivar_bit_count = loop->body()->params()[0]->BitCountOrDie();
-  for (int64_t trip = 0, iv = 0; trip < loop->trip_count();
-       ++trip, iv += loop->stride()) {
+  for (int64_t trip = first_trip, iv = first_trip * loop->stride();
+       trip < end_trip; ++trip, iv += loop->stride()) {
     XLS_ASSIGN_OR_RETURN(
         Literal * iv_node,
         f->MakeNode<Literal>(loop->loc(), Value(UBits(iv, ivar_bit_count))));
@@ -60,20 +70,125 @@ absl::Status UnrollCountedFor(CountedFor* loop) {
         f->MakeNode<Invoke>(loop->loc(), absl::MakeSpan(invoke_args),
                             loop->body()));
   }
+  return loop_carry;
+}
+
+// Unrolls the node "loop" by replacing it with a sequence of dependent
+// invocations.
+absl::Status UnrollCountedFor(CountedFor* loop) {
+  XLS_ASSIGN_OR_RETURN(Node * loop_carry,
+                       EmitIterations(loop, 0, loop->trip_count(),
+                                      loop->initial_value()));
   XLS_RETURN_IF_ERROR(loop->ReplaceUsesWith(loop_carry));
-  return f->RemoveNode(loop);
+  return loop->function_base()->RemoveNode(loop);
+}
+
+// Returns the number of nodes (other than parameters) of `f` and, for invokes
+// and counted fors, of the functions they call as many times as they are
+// called. This is the number of nodes added by inlining `f` after unrolling
+// all its loops.
+int64_t InlinedNodeCount(Function* f,
+                         absl::flat_hash_map<Function*, int64_t>& cache) {
+  auto it = cache.find(f);
+  if (it != cache.end()) {
+    return it->second;
+  }
+  int64_t count = 0;
+  for (Node* node : f->nodes()) {
+    if (node->Is<Invoke>()) {
+      count += InlinedNodeCount(node->As<Invoke>()->to_apply(), cache);
+    } else if (node->Is<CountedFor>()) {
+      CountedFor* loop = node->As<CountedFor>();
+      count += loop->trip_count() * InlinedNodeCount(loop->body(), cache);
+    } else if (!node->Is<Param>()) {
+      ++count;
+    }
+  }
+  cache[f] = count;
+  return count;
 }
 
 }  // namespace
 
+absl::StatusOr<CountedFor*> PartiallyUnrollCountedFor(CountedFor* loop,
+                                                      int64_t factor) {
+  XLS_RET_CHECK_GE(factor, 2);
+  XLS_RET_CHECK_LE(factor, loop->trip_count());
+  Function* body = loop->body();
+  Package* p = body->package();
+
+  // Build a body which runs `factor` consecutive iterations of the original
+  // body, offsetting the induction variable by multiples of the stride.
+  std::string name = absl::StrFormat("%s_unrolled_%d", body->name(), factor);
+  for (int64_t i = 1; p->HasFunctionWithName(name); ++i) {
+    name = absl::StrFormat("%s_unrolled_%d__%d", body->name(), factor, i);
+  }
+  FunctionBuilder fb(name, p);
+  std::vector<BValue> params;
+  for (Param* param : body->params()) {
+    params.push_back(fb.Param(param->GetName(), param->GetType()));
+  }
+  int64_t ivar_bit_count = body->param(0)->BitCountOrDie();
+  BValue carry = params[1];
+  for (int64_t i = 0; i < factor; ++i) {
+    std::vector<BValue> args = params;
+    if (i > 0) {
+      args[0] = fb.Add(params[0], fb.Literal(UBits(i * loop->stride(),
+                                                   ivar_bit_count)));
+    }
+    args[1] = carry;
+    carry = fb.Invoke(args, body, loop->loc());
+  }
+  XLS_ASSIGN_OR_RETURN(Function * unrolled_body,
+                       fb.BuildWithReturnValue(carry));
+
+  FunctionBase* f = loop->function_base();
+  int64_t trip_count = loop->trip_count() / factor;
+  XLS_ASSIGN_OR_RETURN(
+      CountedFor * new_loop,
+      f->MakeNode<CountedFor>(loop->loc(), loop->initial_value(),
+                              loop->invariant_args(), trip_count,
+                              loop->stride() * factor, unrolled_body));
+  XLS_ASSIGN_OR_RETURN(Node * loop_carry,
+                       EmitIterations(loop, trip_count * factor,
+                                      loop->trip_count(), new_loop));
+  XLS_RETURN_IF_ERROR(loop->ReplaceUsesWith(loop_carry));
+  XLS_RETURN_IF_ERROR(f->RemoveNode(loop));
+  return new_loop;
+}
+
+absl::StatusOr<bool> UnrollPass::RunInternal(
+    Package* p, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  bool changed = false;
+  for (FunctionBase* f : p->GetFunctionBases()) {
+    XLS_ASSIGN_OR_RETURN(bool function_changed,
+                         RunOnFunctionBase(f, options, results));
+    changed = changed || function_changed;
+  }
+  return changed;
+}
+
 absl::StatusOr<bool> UnrollPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
   bool changed = false;
-  while (true) {
-    CountedFor* loop = FindCountedFor(f);
-    if (loop == nullptr) {
-      break;
+  absl::flat_hash_map<Function*, int64_t> inlined_node_counts;
+  for (CountedFor* loop : FindCountedFors(f)) {
+    if (options.loop_unroll_node_budget.has_value()) {
+      int64_t budget = *options.loop_unroll_node_budget;
+      int64_t body_node_count =
+          std::max(int64_t{1}, InlinedNodeCount(loop->body(),
+                                                inlined_node_counts));
+      int64_t factor = budget / body_node_count;
+      if (factor < loop->trip_count()) {
+        if (factor >= 2) {
+          XLS_RETURN_IF_ERROR(
+              PartiallyUnrollCountedFor(loop, factor).status());
+          changed = true;
+        }
+        continue;
+      }
     }
     XLS_RETURN_IF_ERROR(UnrollCountedFor(loop));
     changed = true;
@@ -15,18 +15,44 @@
 #ifndef XLS_PASSES_UNROLL_PASS_H_
 #define XLS_PASSES_UNROLL_PASS_H_
 
+#include <cstdint>
+
 #include "absl/status/statusor.h"
 #include "xls/ir/function.h"
+#include "xls/ir/nodes.h"
 #include "xls/passes/optimization_pass.h"
 
 namespace xls {
 
+// Partially unrolls `loop` by `factor`. The loop is replaced by a counted_for
+// with trip count trip_count / factor and stride stride * factor whose body
+// is a new function invoking the original body `factor` times, followed by
+// invokes of the original body for the trip_count % factor remaining
+// iterations. `factor` must be at least two and at most the trip count. Returns
+// the new counted_for.
+absl::StatusOr<CountedFor*> PartiallyUnrollCountedFor(CountedFor* loop,
+                                                      int64_t factor);
+
+// Unrolls counted_for loops into sequences of invokes of the loop body.
+//
+// By default every loop is unrolled completely. If
+// OptimizationPassOptions::loop_unroll_node_budget is set, loops whose
+// complete unrolling would add more nodes than the budget (counting the nodes
+// of the body and of the functions it invokes) are instead partially unrolled
+// by the largest factor which fits in the budget, or left alone if no factor
+// of two or more fits.
 class UnrollPass : public OptimizationFunctionBasePass {
  public:
   UnrollPass()
       : OptimizationFunctionBasePass("loop_unroll", "Unroll counted loops") {}
 
  protected:
+  // Partial unrolling adds loop body functions to the package so function
+  // bases are always unrolled one at a time.
+  absl::StatusOr<bool> RunInternal(Package* p,
+                                   const OptimizationPassOptions& options,
+                                   PassResults* results) const override;
+
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
       PassResults* results) const override;
@@ -60,5 +60,80 @@ fn unrollable() -> bits[32] {
                         m::Literal(0)));
 }
 
+constexpr char kFiveTripProgram[] = R"(
+package some_package
+
+fn body(i: bits[8], accum: bits[32]) -> bits[32] {
+  zero_ext.3: bits[32] = zero_ext(i, new_bit_count=32)
+  ret add.4: bits[32] = add(zero_ext.3, accum)
+}
+
+fn unrollable(x: bits[32]) -> bits[32] {
+  ret counted_for.2: bits[32] = counted_for(x, trip_count=5, stride=3, body=body)
+}
+)";
+
+TEST(UnrollPassTest, PartiallyUnrollsWithResidualIterations) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(kFiveTripProgram));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("unrollable"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * body, p->GetFunction("body"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      CountedFor * loop,
+      PartiallyUnrollCountedFor(f->return_value()->As<CountedFor>(), 2));
+  EXPECT_EQ(loop->trip_count(), 2);
+  EXPECT_EQ(loop->stride(), 6);
+  // The fifth iteration follows the loop.
+  EXPECT_THAT(f->return_value(),
+              m::Invoke(m::Literal(12), m::CountedFor(m::Param("x"))));
+  EXPECT_EQ(f->return_value()->As<Invoke>()->to_apply(), body);
+
+  // The new body runs two iterations of the original body.
+  Function* unrolled = loop->body();
+  EXPECT_EQ(unrolled->name(), "body_unrolled_2");
+  EXPECT_THAT(
+      unrolled->return_value(),
+      m::Invoke(m::Add(m::Param("i"), m::Literal(3)),
+                m::Invoke(m::Param("i"), m::Param("accum"))));
+}
+
+TEST(UnrollPassTest, UnrollsWithinNodeBudget) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(kFiveTripProgram));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("unrollable"));
+  PassResults results;
+  OptimizationPassOptions options;
+  // The body has two nodes so a budget of 10 fits the whole loop.
+  options.loop_unroll_node_budget = 10;
+  EXPECT_THAT(UnrollPass().RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(), m::Invoke(m::Literal(12), m::Invoke()));
+}
+
+TEST(UnrollPassTest, PartiallyUnrollsToFitNodeBudget) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(kFiveTripProgram));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("unrollable"));
+  PassResults results;
+  OptimizationPassOptions options;
+  options.loop_unroll_node_budget = 6;
+  EXPECT_THAT(UnrollPass().RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(true));
+  // Three iterations fit in the budget, leaving a loop of one trip followed
+  // by two unrolled iterations.
+  ASSERT_THAT(f->return_value(),
+              m::Invoke(m::Literal(12),
+                        m::Invoke(m::Literal(9), m::CountedFor())));
+  CountedFor* loop =
+      f->return_value()->operand(1)->operand(1)->As<CountedFor>();
+  EXPECT_EQ(loop->trip_count(), 1);
+  EXPECT_EQ(loop->stride(), 9);
+
+  // Budgets too small for two iterations leave the loop alone.
+  options.loop_unroll_node_budget = 3;
+  EXPECT_THAT(UnrollPass().RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(false));
+}
+
 }  // namespace
 }  // namespace xls
@@ -14,7 +14,12 @@
 
 #include "xls/passes/verifier_checker.h"
 
+#include <cstdint>
+
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/node.h"
 #include "xls/ir/verifier.h"
 #include "xls/passes/optimization_pass.h"
 
@@ -23,7 +28,19 @@ namespace xls {
 absl::Status VerifierChecker::Run(Package* p,
                                   const OptimizationPassOptions& options,
                                   PassResults* results) const {
-  return VerifyPackage(p);
+  VerifierOptions verifier_options{.thread_count = thread_count_};
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = verified_stamps_.find(p);
+    if (it != verified_stamps_.end()) {
+      verifier_options.changed_since = it->second;
+    }
+  }
+  int64_t stamp = Node::CurrentChangeStamp();
+  XLS_RETURN_IF_ERROR(VerifyPackage(p, verifier_options));
+  absl::MutexLock lock(&mutex_);
+  verified_stamps_[p] = stamp;
+  return absl::OkStatus();
 }
 
 }  // namespace xls
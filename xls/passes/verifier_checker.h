@@ -15,16 +15,39 @@
 #ifndef XLS_PASSES_VERIFIER_CHECKER_H_
 #define XLS_PASSES_VERIFIER_CHECKER_H_
 
+#include <cstdint>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/thread.h"
+#include "xls/ir/package.h"
 #include "xls/passes/optimization_pass.h"
 
 namespace xls {
 
-// Invariant checker which just runs xls::Verifier.
+// Invariant checker which runs xls::Verifier using up to `thread_count`
+// threads. After a package passes verification later runs only recheck
+// individually the nodes modified since (see VerifierOptions::changed_since).
 class VerifierChecker : public OptimizationInvariantChecker {
  public:
+  explicit VerifierChecker(int64_t thread_count = AvailableCPUs())
+      : thread_count_(thread_count) {}
+
   absl::Status Run(Package* p, const OptimizationPassOptions& options,
                    PassResults* results) const override;
+
+ private:
+  int64_t thread_count_;
+
+  // The change stamp taken before the last successful verification of each
+  // package. A stale entry left by a destroyed package is harmless: every node
+  // of a package later allocated at the same address is created after the
+  // stamp and is therefore checked.
+  mutable absl::Mutex mutex_;
+  mutable absl::flat_hash_map<Package*, int64_t> verified_stamps_
+      ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace xls
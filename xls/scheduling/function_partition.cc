@@ -42,6 +42,7 @@ std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
       partitionable_nodes.begin(), partitionable_nodes.end());
   XLS_CHECK_EQ(partitionable_nodes_set.size(), partitionable_nodes.size());
 
+  const bool log_names = XLS_VLOG_IS_ON(4);
   min_cut::Graph graph;
   auto source = graph.AddNode("source");
   auto sink = graph.AddNode("sink");
@@ -64,7 +65,10 @@ std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
 
   auto add_node_to_mincut_graph = [&](Node* node) {
     XLS_CHECK(!xls_to_mincut_node.contains(node));
-    min_cut::NodeId graph_node_id = graph.AddNode(node->GetName());
+    // Node names are only used for logging; generating them for every node
+    // of a large function dominates the cost of building the graph.
+    min_cut::NodeId graph_node_id =
+        graph.AddNode(log_names ? node->GetName() : "");
     xls_to_mincut_node[node] = graph_node_id;
     mincut_to_xls_node[graph_node_id] = node;
     xls_nodes_in_mincut_graph.push_back(node);
@@ -155,7 +159,8 @@ std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
     //      \ | / kWeightFactor * C/3
     //     x_fanin
     //
-    min_cut::NodeId node_sink = graph.AddNode(node->GetName() + "_fanin");
+    min_cut::NodeId node_sink =
+        graph.AddNode(log_names ? node->GetName() + "_fanin" : "");
     int64_t weight = edge_weight(node, /*fan_out=*/successors.size());
     for (min_cut::NodeId successor : successors) {
       add_edge(xls_to_mincut_node.at(node), successor, weight);
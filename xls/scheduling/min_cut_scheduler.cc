@@ -15,9 +15,12 @@
 #include "xls/scheduling/min_cut_scheduler.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
 #include <functional>
 #include <limits>
+#include <memory>
 #include <numeric>
 #include <optional>
 #include <random>
@@ -30,9 +33,12 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/node_util.h"
 #include "xls/ir/nodes.h"
@@ -44,6 +50,10 @@ namespace xls {
 
 namespace {
 
+// Functions with fewer nodes than this try the cut orders serially; for them
+// the cost of starting threads outweighs the cuts.
+constexpr int64_t kMinNodesForParallelCutOrders = 1024;
+
 // Splits the nodes at the boundary between 'cycle' and 'cycle + 1' by
 // performing a minimum cost cut and tightens the bounds accordingly. Upon
 // return no node in the function will have a range which spans both 'cycle' and
@@ -76,6 +86,26 @@ absl::Status SplitAfterCycle(FunctionBase* f, int64_t cycle,
   return absl::OkStatus();
 }
 
+// Partitions the nodes at each cycle boundary in the order given by
+// `cut_order`, starting from `bounds`. Each split divides the nodes into those
+// which must be scheduled at or before the cycle and those which must be
+// scheduled after. Upon return each node has a range of exactly one cycle.
+absl::StatusOr<sched::ScheduleBounds> SplitInCutOrder(
+    FunctionBase* f, absl::Span<const int64_t> cut_order,
+    const DelayEstimator& delay_estimator,
+    const sched::ScheduleBounds& bounds) {
+  XLS_VLOG(3) << absl::StreamFormat("Trying cycle order: {%s}",
+                                    absl::StrJoin(cut_order, ", "));
+  sched::ScheduleBounds trial_bounds = bounds;
+  for (int64_t cycle : cut_order) {
+    XLS_RETURN_IF_ERROR(
+        SplitAfterCycle(f, cycle, delay_estimator, &trial_bounds));
+    XLS_RETURN_IF_ERROR(trial_bounds.PropagateLowerBounds());
+    XLS_RETURN_IF_ERROR(trial_bounds.PropagateUpperBounds());
+  }
+  return trial_bounds;
+}
+
 // Returns the number of pipeline registers (flops) on the interior of the
 // pipeline not counting the input and output flops (if any).
 absl::StatusOr<int64_t> CountInteriorPipelineRegisters(
@@ -195,24 +225,42 @@ absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
   }
 
   // Try a number of different orderings of cycle boundary at which the min-cut
-  // is performed and keep the best one.
+  // is performed and keep the best one. The orderings only read the function
+  // and each works on its own copy of the bounds, so large functions evaluate
+  // them in parallel. The best trial is picked in order, so the result does not
+  // depend on the number of threads.
+  std::vector<std::vector<int64_t>> cut_orders =
+      GetMinCutCycleOrders(pipeline_stages - 1);
+  std::vector<std::optional<absl::StatusOr<sched::ScheduleBounds>>> trials(
+      cut_orders.size());
+  std::atomic<int64_t> next_index = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_index++; i < static_cast<int64_t>(cut_orders.size());
+         i = next_index++) {
+      trials[i] = SplitInCutOrder(f, cut_orders[i], delay_estimator, *bounds);
+    }
+  };
+  {
+    int64_t thread_count = 1;
+    if (f->node_count() >= kMinNodesForParallelCutOrders) {
+      thread_count = std::clamp<int64_t>(AvailableCPUs(), 1, cut_orders.size());
+    }
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t i = 1; i < thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    worker();
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+
   int64_t best_register_count = std::numeric_limits<int64_t>::max();
   std::optional<sched::ScheduleBounds> best_bounds;
-  for (const std::vector<int64_t>& cut_order :
-       GetMinCutCycleOrders(pipeline_stages - 1)) {
-    XLS_VLOG(3) << absl::StreamFormat("Trying cycle order: {%s}",
-                                      absl::StrJoin(cut_order, ", "));
-    sched::ScheduleBounds trial_bounds = *bounds;
-    // Partition the nodes at each cycle boundary. For each iteration, this
-    // splits the nodes into those which must be scheduled at or before the
-    // cycle and those which must be scheduled after. Upon loop completion each
-    // node will have a range of exactly one cycle.
-    for (int64_t cycle : cut_order) {
-      XLS_RETURN_IF_ERROR(
-          SplitAfterCycle(f, cycle, delay_estimator, &trial_bounds));
-      XLS_RETURN_IF_ERROR(trial_bounds.PropagateLowerBounds());
-      XLS_RETURN_IF_ERROR(trial_bounds.PropagateUpperBounds());
-    }
+  for (std::optional<absl::StatusOr<sched::ScheduleBounds>>& trial : trials) {
+    XLS_RET_CHECK(trial.has_value());
+    XLS_ASSIGN_OR_RETURN(sched::ScheduleBounds trial_bounds,
+                         *std::move(trial));
     XLS_ASSIGN_OR_RETURN(int64_t trial_register_count,
                          CountInteriorPipelineRegisters(f, trial_bounds));
     if (!best_bounds.has_value() ||
@@ -15,6 +15,7 @@
 #include "xls/scheduling/mutual_exclusion_pass.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -33,11 +34,14 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/logging/vlog_is_on.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/data_structures/graph_coloring.h"
 #include "xls/data_structures/transitive_closure.h"
 #include "xls/ir/bits.h"
@@ -50,7 +54,10 @@
 #include "xls/ir/source_location.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_helpers.h"
+#include "xls/passes/bdd_function.h"
+#include "xls/passes/bdd_query_engine.h"
 #include "xls/passes/post_dominator_analysis.h"
+#include "xls/passes/query_engine.h"
 #include "xls/passes/token_provenance_analysis.h"
 #include "xls/scheduling/scheduling_options.h"
 #include "xls/scheduling/scheduling_pass.h"
@@ -91,12 +98,72 @@ bool HasIntersection(const absl::flat_hash_set<T>& lhs,
                      [&bigger](T element) { return bigger.contains(element); });
 }
 
-Z3_lbool RunSolver(Z3_context c, Z3_ast asserted) {
-  Z3_solver solver = solvers::z3::CreateSolver(c, 1);
-  Z3_solver_assert(c, solver, asserted);
-  Z3_lbool satisfiable = Z3_solver_check(c, solver);
-  Z3_solver_dec_ref(c, solver);
-  return satisfiable;
+// A satisfiability query on the conjunction of one or two predicates. `b` is
+// null for a query on `a` alone.
+struct PredicateQuery {
+  Node* a;
+  Node* b;
+};
+
+// Runs the given queries on Z3 using up to one thread per element of
+// `caches`, each thread using the translation of `f` held by its own cache.
+// The caches are reused across calls so `f` is translated at most once per
+// thread. Queries which are not started before `deadline` are not run and,
+// like queries which run out of resources, have result Z3_L_UNDEF. Queries
+// are independent so the results do not depend on the number of threads.
+absl::StatusOr<std::vector<Z3_lbool>> RunPredicateQueries(
+    FunctionBase* f, absl::Span<const PredicateQuery> queries,
+    absl::Span<solvers::z3::IrTranslatorCache> caches,
+    std::optional<absl::Time> deadline) {
+  std::vector<Z3_lbool> results(queries.size(), Z3_L_UNDEF);
+  if (queries.empty()) {
+    return results;
+  }
+  int64_t thread_count = std::min(caches.size(), queries.size());
+  std::vector<absl::Status> statuses(thread_count);
+  std::atomic<int64_t> next_index = 0;
+  auto run_queries = [&](int64_t thread) -> absl::Status {
+    solvers::z3::IrTranslatorCache& cache = caches[thread];
+    XLS_ASSIGN_OR_RETURN(solvers::z3::IrTranslator * translator,
+                         cache.GetTranslator(f));
+    Z3_context ctx = translator->ctx();
+    solvers::z3::ScopedErrorHandler seh(ctx);
+    for (int64_t i = next_index++; i < static_cast<int64_t>(queries.size());
+         i = next_index++) {
+      std::optional<absl::Duration> timeout;
+      if (deadline.has_value()) {
+        timeout = *deadline - absl::Now();
+        if (*timeout <= absl::ZeroDuration()) {
+          break;
+        }
+      }
+      Z3_ast asserted = translator->GetTranslation(queries[i].a);
+      if (queries[i].b != nullptr) {
+        asserted = Z3_mk_bvand(ctx, asserted,
+                               translator->GetTranslation(queries[i].b));
+      }
+      XLS_ASSIGN_OR_RETURN(
+          results[i],
+          cache.CheckSat(f, solvers::z3::BitVectorToBoolean(ctx, asserted),
+                         timeout));
+    }
+    return seh.status();
+  };
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t i = 1; i < thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(
+          [&statuses, &run_queries, i]() { statuses[i] = run_queries(i); }));
+    }
+    statuses[0] = run_queries(0);
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return results;
 }
 
 // Returns a list of all predicates in a deterministic order, paired with their
@@ -175,14 +242,6 @@ absl::flat_hash_set<Node*> LargestConnectedSubgraph(
 //    dependency relation can be merged.
 absl::StatusOr<NodeRelation> ComputeMergableEffects(FunctionBase* f) {
   XLS_ASSIGN_OR_RETURN(TokenDAG token_dag, ComputeTokenDAG(f));
-  absl::flat_hash_set<Node*> token_nodes;
-  for (const auto& [node, children] : token_dag) {
-    token_nodes.insert(node);
-    for (const auto& child : children) {
-      token_nodes.insert(child);
-    }
-  }
-
   auto get_channel_id = [](Node* node) -> int64_t {
     if (node->Is<Receive>()) {
       return node->As<Receive>()->channel_id();
@@ -205,7 +264,7 @@ absl::StatusOr<NodeRelation> ComputeMergableEffects(FunctionBase* f) {
   };
 
   NodeRelation result;
-  NodeRelation transitive_closure = TransitiveClosure<Node*>(token_dag);
+  ReachabilityIndex<Node*> token_reachability(token_dag);
   for (Node* node : ReverseTopoSort(f)) {
     if (node->Is<Send>() || node->Is<Receive>()) {
       absl::flat_hash_set<Node*> subgraph =
@@ -238,14 +297,14 @@ absl::StatusOr<NodeRelation> ComputeMergableEffects(FunctionBase* f) {
       }
     }
   }
-  for (Node* x : token_nodes) {
-    for (Node* y : token_nodes) {
-      if (!(transitive_closure.contains(x) &&
-            transitive_closure.at(x).contains(y)) &&
-          !(transitive_closure.contains(y) &&
-            transitive_closure.at(y).contains(x))) {
-        result[x].insert(y);
-        result[y].insert(x);
+  // The elements of `token_reachability` are all nodes of the token DAG.
+  absl::Span<Node* const> token_nodes = token_reachability.elements();
+  for (int64_t i = 0; i < token_nodes.size(); ++i) {
+    for (int64_t j = 0; j < token_nodes.size(); ++j) {
+      if (!token_reachability.ReachesByIndex(i, j) &&
+          !token_reachability.ReachesByIndex(j, i)) {
+        result[token_nodes[i]].insert(token_nodes[j]);
+        result[token_nodes[j]].insert(token_nodes[i]);
       }
     }
   }
@@ -692,9 +751,9 @@ struct PredicateSet {
   }
 };
 
-using NodeSet = absl::btree_set<Node*, Node::NodeIdLessThan>;
+using OrderedNodeSet = absl::btree_set<Node*, Node::NodeIdLessThan>;
 template <typename T>
-using NodeMap = absl::btree_map<Node*, T, Node::NodeIdLessThan>;
+using OrderedNodeMap = absl::btree_map<Node*, T, Node::NodeIdLessThan>;
 
 absl::Status AddSelectPredicates(Predicates* p, FunctionBase* f) {
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<PostDominatorAnalysis> pda,
@@ -708,7 +767,7 @@ absl::Status AddSelectPredicates(Predicates* p, FunctionBase* f) {
   // First, take each select and add to the `PredicateSet` of all nodes
   // that are postdominated by one of its cases a predicate of the form
   // `selector == case_number`.
-  NodeMap<PredicateSet> predicate_sets;
+  OrderedNodeMap<PredicateSet> predicate_sets;
   for (Node* node : TopoSort(f)) {
     if (node->Is<Select>()) {
       Select* select = node->As<Select>();
@@ -746,7 +805,7 @@ absl::Status AddSelectPredicates(Predicates* p, FunctionBase* f) {
   // Second, create a map from predicate set to nodes, which is intended to
   // exploit the fact that two nodes may (and will often) have the same
   // predicate set, so we only want to create nodes for that predicate set once.
-  absl::btree_map<PredicateSet, NodeSet> inverse_predicate_sets;
+  absl::btree_map<PredicateSet, OrderedNodeSet> inverse_predicate_sets;
   for (const auto& [node, predicate_set] : predicate_sets) {
     inverse_predicate_sets[predicate_set].insert(node);
   }
@@ -781,7 +840,8 @@ absl::Status AddSelectPredicates(Predicates* p, FunctionBase* f) {
   // Fourth, we create a mapping from selector to the value of the selector
   // to set of nodes that contain that selector-value pair, which will be used
   // later in creating mutual exclusion edges.
-  NodeMap<absl::btree_map<Bits, NodeSet, BitsLT>> selector_to_value_to_preds;
+  OrderedNodeMap<absl::btree_map<Bits, OrderedNodeSet, BitsLT>>
+      selector_to_value_to_preds;
 
   // Fifth, we AND together all the select predicates that apply to a given node
   // and then AND that with the current predicate of that node via the call to
@@ -827,45 +887,81 @@ absl::Status AddSelectPredicates(Predicates* p, FunctionBase* f) {
   return absl::OkStatus();
 }
 
-absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f) {
+absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
+                                    const MutualExclusionOptions& options) {
   if (f->IsBlock()) {
     return absl::OkStatus();
   }
 
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<solvers::z3::IrTranslator> translator,
-                       solvers::z3::IrTranslator::CreateAndTranslate(f, true));
-
-  Z3_context ctx = translator->ctx();
-
-  solvers::z3::ScopedErrorHandler seh(ctx);
+  std::optional<absl::Time> deadline;
+  if (options.z3_time_budget.has_value()) {
+    deadline = absl::Now() + *options.z3_time_budget;
+  }
 
   std::vector<std::pair<Node*, int64_t>> predicate_nodes = PredicateNodes(p, f);
 
-  // Determine for each predicate whether it is always false using Z3.
-  // Dead nodes are mutually exclusive with all other nodes, so this can reduce
-  // the runtime  by doing only a linear amount of Z3 calls to remove
-  // quadratically many Z3 calls.
   for (const auto& [node, index] : predicate_nodes) {
-    Z3_ast translated = translator->GetTranslation(node);
-    if (RunSolver(ctx, solvers::z3::BitVectorToBoolean(ctx, translated)) ==
-        Z3_L_FALSE) {
-      XLS_VLOG(3) << "Proved that " << node << " is always false";
-      // A constant false node is mutually exclusive with all other nodes.
-      for (const auto& [other, other_index] : predicate_nodes) {
-        if (index != other_index) {
-          XLS_RETURN_IF_ERROR(p->MarkMutuallyExclusive(node, other));
-        }
+    XLS_VLOG(3) << "Predicate: " << node;
+  }
+
+  // One translation cache per Z3 thread, shared by the liveness and pairwise
+  // queries below so `f` is translated at most once per thread.
+  std::vector<solvers::z3::IrTranslatorCache> z3_caches;
+  for (int64_t i = 0; i < std::max(options.z3_threads, int64_t{1}); ++i) {
+    z3_caches.emplace_back(/*allow_unsupported=*/true);
+  }
+
+  // Cheap proofs and disproofs come from a BDD of the function; only the
+  // questions it cannot settle are sent to Z3. The BDD is queried only from
+  // this thread.
+  BddQueryEngine bdd_engine(BddFunction::kDefaultPathLimit);
+  XLS_RETURN_IF_ERROR(bdd_engine.Populate(f).status());
+  auto is_known = [&](Node* node, bool value) {
+    return bdd_engine.IsTracked(node) &&
+           (value ? bdd_engine.IsOne(TreeBitLocation(node, 0))
+                  : bdd_engine.IsZero(TreeBitLocation(node, 0)));
+  };
+
+  // A constant false node is mutually exclusive with all other nodes.
+  auto mark_always_false = [&](Node* node, int64_t index) -> absl::Status {
+    XLS_VLOG(3) << "Proved that " << node << " is always false";
+    for (const auto& [other, other_index] : predicate_nodes) {
+      if (index != other_index) {
+        XLS_RETURN_IF_ERROR(p->MarkMutuallyExclusive(node, other));
       }
     }
-  }
+    return absl::OkStatus();
+  };
 
+  // Determine for each predicate whether it is always false, first using the
+  // BDD and then Z3. Dead nodes are mutually exclusive with all other nodes, so
+  // this can reduce the runtime by doing only a linear amount of Z3 calls to
+  // remove quadratically many Z3 calls.
+  std::vector<PredicateQuery> liveness_queries;
+  std::vector<std::pair<Node*, int64_t>> liveness_query_nodes;
   for (const auto& [node, index] : predicate_nodes) {
-    XLS_VLOG(3) << "Predicate: " << node;
+    if (is_known(node, false)) {
+      XLS_RETURN_IF_ERROR(mark_always_false(node, index));
+    } else if (!is_known(node, true)) {
+      liveness_queries.push_back(PredicateQuery{node, nullptr});
+      liveness_query_nodes.push_back({node, index});
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<Z3_lbool> liveness_results,
+      RunPredicateQueries(f, liveness_queries, absl::MakeSpan(z3_caches),
+                          deadline));
+  for (int64_t i = 0; i < liveness_results.size(); ++i) {
+    if (liveness_results[i] == Z3_L_FALSE) {
+      XLS_RETURN_IF_ERROR(mark_always_false(liveness_query_nodes[i].first,
+                                            liveness_query_nodes[i].second));
+    }
   }
 
   int64_t known_false = 0;
   int64_t known_true = 0;
   int64_t unknown = 0;
+  int64_t decided_by_bdd = 0;
 
   absl::flat_hash_map<Node*, absl::flat_hash_set<Op>> ops_for_pred;
   for (const auto& [node, index] : predicate_nodes) {
@@ -886,6 +982,7 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f) {
     }
   }
 
+  std::vector<PredicateQuery> pair_queries;
   for (const auto& [node_a, index_a] : predicate_nodes) {
     for (const auto& [node_b, index_b] : predicate_nodes) {
       // This prevents checking `a NAND b` and then later checking `b NAND a`.
@@ -903,35 +1000,52 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f) {
         continue;
       }
 
-      Z3_ast z3_a = translator->GetTranslation(node_a);
-      Z3_ast z3_b = translator->GetTranslation(node_b);
-
-      // We try to find out if `a ∧ b` is satisfiable, which is true iff
-      // `a NAND b` is not valid.
-      Z3_ast a_and_b =
-          solvers::z3::BitVectorToBoolean(ctx, Z3_mk_bvand(ctx, z3_a, z3_b));
-
-      Z3_lbool satisfiable = RunSolver(ctx, a_and_b);
-
-      if (satisfiable == Z3_L_FALSE) {
+      if (bdd_engine.IsTracked(node_a) && bdd_engine.IsTracked(node_b) &&
+          bdd_engine.AtMostOneTrue(
+              {TreeBitLocation(node_a, 0), TreeBitLocation(node_b, 0)})) {
+        ++decided_by_bdd;
         known_true += 1;
         XLS_RETURN_IF_ERROR(p->MarkMutuallyExclusive(node_a, node_b));
-      } else if (satisfiable == Z3_L_TRUE) {
+        continue;
+      }
+      if (is_known(node_a, true) && is_known(node_b, true)) {
+        ++decided_by_bdd;
         known_false += 1;
         XLS_RETURN_IF_ERROR(p->MarkNotMutuallyExclusive(node_a, node_b));
-      } else {
-        unknown += 1;
-        XLS_VLOG(3) << "Z3 ran out of time checking mutual exclusion of "
-                    << node_a->GetName() << " and " << node_b->GetName();
+        continue;
       }
+
+      // We try to find out if `a ∧ b` is satisfiable, which is true iff
+      // `a NAND b` is not valid.
+      pair_queries.push_back(PredicateQuery{node_a, node_b});
+    }
+  }
+
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<Z3_lbool> pair_results,
+      RunPredicateQueries(f, pair_queries, absl::MakeSpan(z3_caches),
+                          deadline));
+  for (int64_t i = 0; i < pair_results.size(); ++i) {
+    Node* node_a = pair_queries[i].a;
+    Node* node_b = pair_queries[i].b;
+    if (pair_results[i] == Z3_L_FALSE) {
+      known_true += 1;
+      XLS_RETURN_IF_ERROR(p->MarkMutuallyExclusive(node_a, node_b));
+    } else if (pair_results[i] == Z3_L_TRUE) {
+      known_false += 1;
+      XLS_RETURN_IF_ERROR(p->MarkNotMutuallyExclusive(node_a, node_b));
+    } else {
+      unknown += 1;
+      XLS_VLOG(3) << "Z3 ran out of time checking mutual exclusion of "
+                  << node_a->GetName() << " and " << node_b->GetName();
     }
   }
 
   XLS_VLOG(3) << "known_false = " << known_false;
   XLS_VLOG(3) << "known_true  = " << known_true;
   XLS_VLOG(3) << "unknown     = " << unknown;
-
-  XLS_RETURN_IF_ERROR(seh.status());
+  XLS_VLOG(3) << "decided without Z3 = " << decided_by_bdd << ", Z3 queries = "
+              << liveness_queries.size() + pair_queries.size();
 
   return absl::OkStatus();
 }
@@ -965,7 +1079,15 @@ absl::StatusOr<bool> MutualExclusionPass::RunOnFunctionBaseInternal(
 
   Predicates p;
   XLS_RETURN_IF_ERROR(AddSendReceivePredicates(&p, f));
-  XLS_RETURN_IF_ERROR(ComputeMutualExclusion(&p, f));
+  MutualExclusionOptions mutual_exclusion_options;
+  mutual_exclusion_options.z3_threads =
+      options.scheduling_options.mutual_exclusion_z3_threads();
+  if (std::optional<int64_t> budget_ms =
+          options.scheduling_options.mutual_exclusion_z3_time_budget_ms()) {
+    mutual_exclusion_options.z3_time_budget = absl::Milliseconds(*budget_ms);
+  }
+  XLS_RETURN_IF_ERROR(
+      ComputeMutualExclusion(&p, f, mutual_exclusion_options));
   XLS_ASSIGN_OR_RETURN(std::vector<absl::flat_hash_set<Node*>> merge_classes,
                        ComputeMergeClasses(&p, f, scm));
 
@@ -15,9 +15,11 @@
 #ifndef XLS_SCHEDULING_MUTUAL_EXCLUSION_PASS_H_
 #define XLS_SCHEDULING_MUTUAL_EXCLUSION_PASS_H_
 
+#include <cstdint>
 #include <optional>
 
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "xls/ir/function.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/scheduling/scheduling_pass.h"
@@ -98,9 +100,23 @@ absl::StatusOr<Node*> AddPredicate(Predicates* p, Node* node, Node* pred);
 // another pass.
 absl::Status AddSelectPredicates(Predicates* p, FunctionBase* f);
 
-// Use an SMT solver to populate the given `Predicates*` with information about
-// whether nodes are used in a mutually exclusive way.
-absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f);
+// Options for ComputeMutualExclusion.
+struct MutualExclusionOptions {
+  // Number of threads issuing Z3 queries. Each thread translates the function
+  // into its own Z3 context.
+  int64_t z3_threads = 1;
+
+  // Wall-clock budget for all Z3 queries. Pairs of predicates not decided
+  // within the budget are left unknown.
+  std::optional<absl::Duration> z3_time_budget;
+};
+
+// Populate the given `Predicates*` with information about whether nodes are
+// used in a mutually exclusive way. Pairs are first checked with a BDD of the
+// function; the pairs it cannot decide are checked with an SMT solver.
+absl::Status ComputeMutualExclusion(
+    Predicates* p, FunctionBase* f,
+    const MutualExclusionOptions& options = MutualExclusionOptions());
 
 // Pass which merges together nodes that are determined to be mutually exclusive
 // via SMT solver analysis.
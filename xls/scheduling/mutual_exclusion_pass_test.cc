@@ -14,9 +14,13 @@
 
 #include "xls/scheduling/mutual_exclusion_pass.h"
 
+#include <cstdint>
+#include <memory>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
@@ -390,6 +394,57 @@ TEST_F(MutualExclusionPassTest, TwoReceivesDependingOnReceive) {
   EXPECT_EQ(NumberOfOp(proc, Op::kReceive), 2);
 }
 
+TEST_F(MutualExclusionPassTest, ComputeMutualExclusionInParallel) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
+     package test_module
+
+     chan test_channel(
+       bits[32], id=0, kind=streaming, ops=send_only,
+       flow_control=ready_valid, metadata="""""")
+
+     top proc main(__token: token, __state: bits[2], x: bits[8], init={0, 0}) {
+       literal.1: bits[2] = literal(value=1)
+       add.2: bits[2] = add(literal.1, __state)
+       umul.3: bits[8] = umul(x, x)
+       literal.4: bits[2] = literal(value=2)
+       literal.5: bits[8] = literal(value=2)
+       eq.6: bits[1] = eq(add.2, literal.1)
+       eq.7: bits[1] = eq(add.2, literal.4)
+       eq.8: bits[1] = eq(umul.3, literal.5)
+       ne.9: bits[1] = ne(umul.3, literal.5)
+       ult.10: bits[1] = ult(x, literal.5)
+       send.11: token = send(__token, x, predicate=eq.6, channel_id=0)
+       send.12: token = send(send.11, x, predicate=eq.7, channel_id=0)
+       send.13: token = send(send.12, x, predicate=eq.8, channel_id=0)
+       send.14: token = send(send.13, x, predicate=ne.9, channel_id=0)
+       send.15: token = send(send.14, x, predicate=ult.10, channel_id=0)
+       next (send.15, add.2, x)
+     }
+  )"));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, p->GetTopAsProc());
+  Node* eq6 = *proc->GetNode("eq.6");
+  Node* eq7 = *proc->GetNode("eq.7");
+  Node* eq8 = *proc->GetNode("eq.8");
+  Node* ne9 = *proc->GetNode("ne.9");
+  Node* ult10 = *proc->GetNode("ult.10");
+
+  // The answers must not depend on the number of threads.
+  for (int64_t threads : {1, 4}) {
+    Predicates preds;
+    for (int64_t i = 11; i <= 15; ++i) {
+      Node* send = *proc->GetNode(absl::StrCat("send.", i));
+      preds.SetPredicate(send, send->As<Send>()->predicate().value());
+    }
+    MutualExclusionOptions options;
+    options.z3_threads = threads;
+    XLS_ASSERT_OK(ComputeMutualExclusion(&preds, proc, options));
+    EXPECT_EQ(preds.QueryMutuallyExclusive(eq6, eq7), true);
+    EXPECT_EQ(preds.QueryMutuallyExclusive(eq8, ne9), true);
+    EXPECT_EQ(preds.QueryMutuallyExclusive(eq6, ult10), false);
+    EXPECT_EQ(preds.QueryMutuallyExclusive(ne9, ult10), false);
+  }
+}
+
 TEST_F(MutualExclusionPassTest, SelectPredicates) {
   XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
      package test_module
@@ -0,0 +1,51 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/pipeline_retiming_pass.h"
+
+#include <cstdint>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/run_pipeline_schedule.h"
+#include "xls/scheduling/scheduling_pass.h"
+
+namespace xls {
+
+absl::StatusOr<bool> PipelineRetimingPass::RunInternal(
+    SchedulingUnit<>* unit, const SchedulingPassOptions& options,
+    SchedulingPassResults* results) const {
+  if (!options.scheduling_options.retime_pipeline_registers() ||
+      !unit->schedule.has_value()) {
+    return false;
+  }
+  XLS_RET_CHECK_NE(options.delay_estimator, nullptr);
+
+  XLS_ASSIGN_OR_RETURN(
+      PipelineSchedule retimed,
+      RetimePipelineSchedule(*unit->schedule, *options.delay_estimator,
+                             options.scheduling_options));
+  int64_t registers_saved =
+      unit->schedule->CountFinalInteriorPipelineRegisters() -
+      retimed.CountFinalInteriorPipelineRegisters();
+  bool changed = retimed.GetCycleMap() != unit->schedule->GetCycleMap();
+  retimed.set_register_bits_saved_by_retiming(registers_saved);
+  unit->schedule = std::move(retimed);
+  return changed;
+}
+
+}  // namespace xls
@@ -0,0 +1,43 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SCHEDULING_PIPELINE_RETIMING_PASS_H_
+#define XLS_SCHEDULING_PIPELINE_RETIMING_PASS_H_
+
+#include "absl/status/statusor.h"
+#include "xls/scheduling/scheduling_pass.h"
+
+namespace xls {
+
+// Pass which moves nodes between the stages of an existing pipeline schedule
+// to reduce the number of pipeline register bits, without lengthening the
+// longest combinational path of any stage. Each stage boundary is placed by a
+// min-cut of the nodes which may be scheduled on either side of it. Only runs
+// if enabled in the scheduling options; the number of register bits removed is
+// recorded in the schedule and reported in the block metrics.
+class PipelineRetimingPass : public SchedulingPass {
+ public:
+  PipelineRetimingPass()
+      : SchedulingPass("retime", "Pipeline Register Retiming") {}
+  ~PipelineRetimingPass() override = default;
+
+ protected:
+  absl::StatusOr<bool> RunInternal(
+      SchedulingUnit<>* unit, const SchedulingPassOptions& options,
+      SchedulingPassResults* results) const override;
+};
+
+}  // namespace xls
+
+#endif  // XLS_SCHEDULING_PIPELINE_RETIMING_PASS_H_
@@ -0,0 +1,115 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/pipeline_retiming_pass.h"
+
+#include <optional>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+#include "xls/scheduling/scheduling_pass.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::Optional;
+
+class PipelineRetimingPassTest : public IrTestBase {};
+
+TEST_F(PipelineRetimingPassTest, MovesNarrowingNodeBeforeRegister) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue neg = fb.Negate(x);
+  BValue slice = fb.BitSlice(neg, /*start=*/0, /*width=*/1);
+  BValue result = fb.Not(slice);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(result));
+
+  // Registering the negate costs 32 bits; the bit slice has no delay, so it
+  // fits in the first stage and only one bit needs to be registered.
+  SchedulingUnit<> unit{p.get(),
+                        PipelineSchedule(f,
+                                         {{x.node(), 0},
+                                          {neg.node(), 0},
+                                          {slice.node(), 1},
+                                          {result.node(), 1}},
+                                         /*length=*/2)};
+  EXPECT_EQ(unit.schedule->CountFinalInteriorPipelineRegisters(), 32);
+
+  TestDelayEstimator delay_estimator;
+  SchedulingPassOptions options;
+  options.delay_estimator = &delay_estimator;
+  SchedulingPassResults results;
+
+  // Retiming is disabled by default.
+  EXPECT_THAT(PipelineRetimingPass().Run(&unit, options, &results),
+              IsOkAndHolds(false));
+  EXPECT_EQ(unit.schedule->register_bits_saved_by_retiming(), std::nullopt);
+
+  options.scheduling_options.retime_pipeline_registers(true);
+  EXPECT_THAT(PipelineRetimingPass().Run(&unit, options, &results),
+              IsOkAndHolds(true));
+  EXPECT_EQ(unit.schedule->length(), 2);
+  EXPECT_EQ(unit.schedule->cycle(slice.node()), 0);
+  EXPECT_EQ(unit.schedule->cycle(result.node()), 1);
+  EXPECT_EQ(unit.schedule->CountFinalInteriorPipelineRegisters(), 1);
+  EXPECT_THAT(unit.schedule->register_bits_saved_by_retiming(), Optional(31));
+  XLS_EXPECT_OK(unit.schedule->VerifyTiming(/*clock_period_ps=*/1,
+                                            delay_estimator));
+
+  // The schedule is already minimal, so retiming again changes nothing.
+  EXPECT_THAT(PipelineRetimingPass().Run(&unit, options, &results),
+              IsOkAndHolds(false));
+  EXPECT_THAT(unit.schedule->register_bits_saved_by_retiming(), Optional(0));
+}
+
+TEST_F(PipelineRetimingPassTest, DoesNotLengthenCriticalStage) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue neg = fb.Negate(x);
+  BValue or_reduce = fb.OrReduce(neg);
+  BValue result = fb.Concat({or_reduce, or_reduce});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(result));
+
+  // Each stage has a one picosecond path. Registering the or-reduce instead of
+  // the negate would save 31 bits but needs a two picosecond path in the first
+  // stage.
+  SchedulingUnit<> unit{p.get(),
+                        PipelineSchedule(f,
+                                         {{x.node(), 0},
+                                          {neg.node(), 0},
+                                          {or_reduce.node(), 1},
+                                          {result.node(), 1}},
+                                         /*length=*/2)};
+
+  TestDelayEstimator delay_estimator;
+  SchedulingPassOptions options;
+  options.delay_estimator = &delay_estimator;
+  options.scheduling_options.retime_pipeline_registers(true);
+  SchedulingPassResults results;
+  EXPECT_THAT(PipelineRetimingPass().Run(&unit, options, &results),
+              IsOkAndHolds(false));
+  EXPECT_EQ(unit.schedule->cycle(or_reduce.node()), 1);
+  EXPECT_THAT(unit.schedule->register_bits_saved_by_retiming(), Optional(0));
+}
+
+}  // namespace
+}  // namespace xls
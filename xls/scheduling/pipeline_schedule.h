@@ -106,6 +106,16 @@ class PipelineSchedule {
   // Returns the underlying cycle map.
   const ScheduleCycleMap& GetCycleMap() const { return cycle_map_; }
 
+  // Returns the number of pipeline register bits removed by retiming this
+  // schedule (see PipelineRetimingPass), or std::nullopt if the schedule was
+  // not retimed.
+  std::optional<int64_t> register_bits_saved_by_retiming() const {
+    return register_bits_saved_by_retiming_;
+  }
+  void set_register_bits_saved_by_retiming(int64_t value) {
+    register_bits_saved_by_retiming_ = value;
+  }
+
  private:
   FunctionBase* function_base_;
 
@@ -114,6 +124,8 @@ class PipelineSchedule {
 
   // The nodes scheduled each cycle.
   std::vector<std::vector<Node*>> cycle_to_nodes_;
+
+  std::optional<int64_t> register_bits_saved_by_retiming_;
 };
 
 }  // namespace xls
@@ -23,6 +23,7 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
 #include "xls/delay_model/delay_estimator.h"
@@ -78,6 +79,46 @@ TEST_F(PipelineScheduleTest, SelectsEntry) {
   EXPECT_THAT(schedule.nodes_in_cycle(0), UnorderedElementsAre(m::Literal()));
 }
 
+TEST_F(PipelineScheduleTest, ScheduleFunctionBasesInParallel) {
+  auto p = CreatePackage();
+  std::vector<FunctionBase*> fbs;
+  for (int64_t i = 0; i < 8; ++i) {
+    FunctionBuilder fb(absl::StrCat("f", i), p.get());
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    BValue y = x;
+    for (int64_t j = 0; j <= i; ++j) {
+      y = fb.Not(y);
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(y));
+    fbs.push_back(f);
+  }
+
+  SchedulingOptions options = SchedulingOptions().clock_period_ps(2);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<PipelineSchedule> serial,
+      RunPipelineSchedules(fbs, TestDelayEstimator(), options));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<PipelineSchedule> parallel,
+      RunPipelineSchedules(fbs, TestDelayEstimator(), options,
+                           /*synthesizer=*/nullptr, /*parallelism=*/4));
+  ASSERT_EQ(serial.size(), fbs.size());
+  ASSERT_EQ(parallel.size(), fbs.size());
+  for (int64_t i = 0; i < fbs.size(); ++i) {
+    EXPECT_EQ(serial[i].function_base(), fbs[i]);
+    EXPECT_EQ(parallel[i].function_base(), fbs[i]);
+    EXPECT_EQ(parallel[i].ToString(), serial[i].ToString());
+  }
+
+  // Two 2ps stages fit at most four nots, so f4 is the first function which
+  // fails to schedule.
+  EXPECT_THAT(RunPipelineSchedules(
+                  fbs, TestDelayEstimator(),
+                  SchedulingOptions().clock_period_ps(2).pipeline_stages(2),
+                  /*synthesizer=*/nullptr, /*parallelism=*/4),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Scheduling f4 failed")));
+}
+
 TEST_F(PipelineScheduleTest, AsapScheduleTrivial) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
@@ -160,6 +201,39 @@ TEST_F(PipelineScheduleTest, InfeasibleScheduleWithReturnValueUsers) {
               "that is impossible due to users of these node(s): ret_value")));
 }
 
+TEST_F(PipelineScheduleTest, MinCutScheduleOfLargeFunction) {
+  // Large enough for the min-cut scheduler to try its cut orders in parallel.
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue narrow = fb.Param("narrow", p->GetBitsType(1));
+  BValue v = x;
+  for (int64_t i = 0; i < 900; ++i) {
+    // Every tenth step passes through a single bit, which is where the
+    // pipeline registers should go.
+    v = i % 10 == 9 ? fb.SignExtend(fb.And(fb.BitSlice(v, 0, 1), narrow), 32)
+                    : fb.Not(v);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  ASSERT_GE(f->node_count(), 1024);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(f, TestDelayEstimator(),
+                          SchedulingOptions(SchedulingStrategy::MIN_CUT)
+                              .clock_period_ps(300)
+                              .pipeline_stages(4)));
+  EXPECT_EQ(schedule.length(), 4);
+  XLS_EXPECT_OK(schedule.VerifyTiming(300, TestDelayEstimator()));
+  for (int64_t stage = 0; stage < 3; ++stage) {
+    for (Node* node : schedule.GetLiveOutOfCycle(stage)) {
+      if (node != x.node() && node != narrow.node()) {
+        EXPECT_EQ(node->GetType()->GetFlatBitCount(), 1) << node->GetName();
+      }
+    }
+  }
+}
+
 TEST_F(PipelineScheduleTest, AsapScheduleNoParameters) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
@@ -401,6 +475,34 @@ TEST_F(PipelineScheduleTest, JustPipelineLengthGiven) {
   EXPECT_THAT(scheduled_ops(5), UnorderedElementsAre(Op::kNeg));
 }
 
+TEST_F(PipelineScheduleTest, JustPipelineLengthGivenWithSlowNode) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  auto x = fb.Param("x", u32);
+  auto slow = fb.UMul(fb.Negate(x), x);
+  fb.Not(fb.Negate(fb.Not(slow)));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  // The multiply takes longer than the critical path divided by the number of
+  // stages, so the shortest feasible clock period is the multiply's delay.
+  DecoratingDelayEstimator delay_estimator(
+      "slow_multiply", TestDelayEstimator(),
+      [](Node* node, int64_t base_delay) {
+        return node->op() == Op::kUMul ? 5 * base_delay : base_delay;
+      });
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(func, delay_estimator,
+                          SchedulingOptions().pipeline_stages(5)));
+
+  EXPECT_EQ(schedule.length(), 5);
+  XLS_EXPECT_OK(schedule.VerifyTiming(/*clock_period_ps=*/5, delay_estimator));
+  EXPECT_THAT(schedule.VerifyTiming(/*clock_period_ps=*/4, delay_estimator),
+              StatusIs(absl::StatusCode::kInternal));
+}
+
 TEST_F(PipelineScheduleTest, LongPipelineLength) {
   // Generate an absurdly long pipeline schedule. Most stages are empty, but it
   // should not crash.
@@ -1247,6 +1349,35 @@ TEST_F(PipelineScheduleTest, ProcParamsScheduledInSameStage) {
   EXPECT_EQ(schedule.cycle(next_b.node()), 1);
 }
 
+TEST_F(PipelineScheduleTest, MinimizeWorstCaseThroughput) {
+  Package p("p");
+  TokenlessProcBuilder pb(TestName(), "tkn", &p);
+  BValue st = pb.StateElement("st", Value(UBits(0, 16)));
+  BValue next = pb.Negate(pb.Not(pb.Negate(st)));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({next}));
+
+  // The state loop takes three cycles at this clock period, so that is the best
+  // worst-case throughput within the stage budget.
+  SchedulingOptions options = SchedulingOptions()
+                                  .clock_period_ps(1)
+                                  .pipeline_stages(5)
+                                  .minimize_worst_case_throughput(true);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(proc, TestDelayEstimator(), options));
+  EXPECT_EQ(schedule.length(), 5);
+  EXPECT_EQ(proc->GetInitiationInterval(), 3);
+  EXPECT_LT(schedule.cycle(next.node()) - schedule.cycle(st.node()), 3);
+
+  EXPECT_THAT(
+      RunPipelineSchedule(
+          proc, TestDelayEstimator(),
+          SchedulingOptions().pipeline_stages(5).minimize_worst_case_throughput(
+              true)),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("requires both a clock period")));
+}
+
 TEST_F(PipelineScheduleTest, ProcScheduleWithInputDelay) {
   Package p("p");
 
@@ -15,12 +15,14 @@
 #include "xls/scheduling/run_pipeline_schedule.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <optional>
 #include <random>
 #include <string>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -34,6 +36,7 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/data_structures/binary_search.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/fdo/delay_manager.h"
@@ -43,12 +46,15 @@
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
+#include "xls/ir/proc.h"
 #include "xls/scheduling/min_cut_scheduler.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/schedule_bounds.h"
 #include "xls/scheduling/scheduling_options.h"
 #include "xls/scheduling/sdc_scheduler.h"
+#include "xls/scheduling/state_backedge_analysis.h"
 
 namespace xls {
 
@@ -149,50 +155,55 @@ absl::Status TightenBounds(sched::ScheduleBounds& bounds, FunctionBase* f,
   return absl::OkStatus();
 }
 
-// Returns the critical path through the given nodes (ordered topologically).
-absl::StatusOr<int64_t> ComputeCriticalPath(
-    absl::Span<Node* const> topo_sort, const DelayEstimator& delay_estimator) {
+// Returns the critical path through `f`, using the node delays already computed
+// by `scheduler` rather than querying the delay estimator again.
+int64_t ComputeCriticalPath(FunctionBase* f, const SDCScheduler& scheduler) {
+  const absl::flat_hash_map<Node*, int64_t>& delays = scheduler.delay_map();
   int64_t function_cp = 0;
   absl::flat_hash_map<Node*, int64_t> node_cp;
-  for (Node* node : topo_sort) {
+  for (Node* node : TopoSort(f)) {
     int64_t node_start = 0;
     for (Node* operand : node->operands()) {
       node_start = std::max(node_start, node_cp[operand]);
     }
-    XLS_ASSIGN_OR_RETURN(int64_t node_delay,
-                         delay_estimator.GetOperationDelayInPs(node));
-    node_cp[node] = node_start + node_delay;
+    node_cp[node] = node_start + delays.at(node);
     function_cp = std::max(function_cp, node_cp[node]);
   }
   return function_cp;
 }
-absl::StatusOr<int64_t> ComputeCriticalPath(
-    FunctionBase* f, const DelayEstimator& delay_estimator) {
-  return ComputeCriticalPath(TopoSort(f).AsVector(), delay_estimator);
-}
 
 // Returns the minimum clock period in picoseconds for which it is feasible to
 // schedule the function into a pipeline with the given number of stages. If
 // `target_clock_period_ps` is specified, will not try to check lower clock
 // periods than this.
+//
+// Every probe of the search reuses `scheduler`: the node delays are estimated
+// once when the scheduler is created, and each change of clock period only
+// swaps the timing constraints which differ, so the LP solver warm-starts from
+// the previous probe.
 absl::StatusOr<int64_t> FindMinimumClockPeriod(
     FunctionBase* f, std::optional<int64_t> pipeline_stages,
-    const DelayEstimator& delay_estimator, SDCScheduler& scheduler,
+    SDCScheduler& scheduler,
     std::optional<int64_t> target_clock_period_ps = std::nullopt) {
   XLS_VLOG(4) << "FindMinimumClockPeriod()";
   XLS_VLOG(4) << "  pipeline stages = "
               << (pipeline_stages.has_value() ? absl::StrCat(*pipeline_stages)
                                               : "(unspecified)");
-  XLS_ASSIGN_OR_RETURN(int64_t function_cp_ps,
-                       ComputeCriticalPath(f, delay_estimator));
+  int64_t function_cp_ps = ComputeCriticalPath(f, scheduler);
+  int64_t max_node_delay_ps = 0;
+  for (const auto& [_, delay] : scheduler.delay_map()) {
+    max_node_delay_ps = std::max(max_node_delay_ps, delay);
+  }
 
   // The upper bound of the search is simply the critical path of the entire
   // function, and the lower bound is the critical path delay evenly distributed
   // across our pipeline stages (rounded up). It's possible the upper bound is
   // the best you can do if there exists a single operation with delay equal to
-  // the critical-path delay of the function.
+  // the critical-path delay of the function. No operation can be split across
+  // stages, so the lower bound is also at least the largest node delay; the
+  // SDC constraints alone do not enforce this.
   int64_t pessimistic_clk_period_ps = std::max(int64_t{1}, function_cp_ps);
-  int64_t optimistic_clk_period_ps = 1;
+  int64_t optimistic_clk_period_ps = std::max(int64_t{1}, max_node_delay_ps);
   if (pipeline_stages.has_value()) {
     optimistic_clk_period_ps =
         std::max(optimistic_clk_period_ps,
@@ -235,6 +246,58 @@ absl::StatusOr<int64_t> FindMinimumClockPeriod(
   return min_clk_period_ps;
 }
 
+// Returns the smallest initiation interval at which it is feasible to schedule
+// `proc` into a pipeline with the given number of stages and clock period. The
+// search starts from the bound imposed by the state backedges of the proc. An
+// initiation interval equal to the pipeline length cannot constrain any
+// backedge, so that is the largest interval checked unless the options give a
+// smaller worst-case throughput.
+//
+// The backedge constraints of an SDCScheduler are fixed when its constraints
+// are added, so each probe builds a new scheduler.
+absl::StatusOr<int64_t> FindMinimumInitiationInterval(
+    Proc* proc, const DelayEstimator& delay_estimator,
+    const SchedulingOptions& options, int64_t clock_period_ps) {
+  XLS_RET_CHECK(options.pipeline_stages().has_value());
+  const int64_t pipeline_stages = *options.pipeline_stages();
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<StateBackedge> backedges,
+      AnalyzeStateBackedges(proc, delay_estimator, clock_period_ps));
+  XLS_VLOG(2) << "State backedges of " << proc->name() << ":\n"
+              << StateBackedgesToString(backedges);
+
+  const int64_t max_ii = std::max(
+      int64_t{1}, options.worst_case_throughput().value_or(pipeline_stages));
+  const int64_t min_ii = std::min(MinimumInitiationInterval(backedges), max_ii);
+  XLS_VLOG(4) << absl::StreamFormat(
+      "Binary searching for initiation interval over [%d, %d]", min_ii, max_ii);
+
+  auto schedule_at = [&](int64_t ii,
+                         bool explain_infeasibility) -> absl::Status {
+    proc->SetInitiationInterval(ii);
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<SDCScheduler> scheduler,
+                         SDCScheduler::Create(proc, delay_estimator));
+    XLS_RETURN_IF_ERROR(scheduler->AddConstraints(options.constraints()));
+    return scheduler
+        ->Schedule(pipeline_stages, clock_period_ps,
+                   /*check_feasibility=*/true, explain_infeasibility)
+        .status();
+  };
+  XLS_RETURN_IF_ERROR(schedule_at(max_ii, /*explain_infeasibility=*/true))
+          .SetPrepend()
+      << absl::StrFormat("Impossible to schedule proc %s as specified; ",
+                         proc->name());
+
+  int64_t min_feasible_ii = BinarySearchMinTrue(
+      min_ii, max_ii,
+      [&](int64_t ii) {
+        return schedule_at(ii, /*explain_infeasibility=*/false).ok();
+      },
+      BinarySearchAssumptions::kEndKnownTrue);
+  XLS_VLOG(4) << "minimum initiation interval = " << min_feasible_ii;
+  return min_feasible_ii;
+}
+
 }  // namespace
 
 absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
@@ -255,6 +318,15 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
   if (options.worst_case_throughput().has_value()) {
     f->SetInitiationInterval(*options.worst_case_throughput());
   }
+  const bool minimize_initiation_interval =
+      f->IsProc() && options.minimize_worst_case_throughput();
+  if (minimize_initiation_interval &&
+      (!options.clock_period_ps().has_value() ||
+       !options.pipeline_stages().has_value())) {
+    return absl::InvalidArgumentError(
+        "Minimizing the worst-case throughput requires both a clock period and "
+        "a pipeline length.");
+  }
 
   std::unique_ptr<SDCScheduler> sdc_scheduler;
   if (!options.clock_period_ps().has_value() ||
@@ -290,8 +362,7 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
     XLS_CHECK(sdc_scheduler != nullptr);
     XLS_ASSIGN_OR_RETURN(
         clock_period_ps,
-        FindMinimumClockPeriod(f, options.pipeline_stages(), input_delay_added,
-                               *sdc_scheduler));
+        FindMinimumClockPeriod(f, options.pipeline_stages(), *sdc_scheduler));
 
     if (options.period_relaxation_percent().has_value()) {
       int64_t relaxation_percent = options.period_relaxation_percent().value();
@@ -300,6 +371,21 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
     }
   }
 
+  if (minimize_initiation_interval) {
+    XLS_ASSIGN_OR_RETURN(
+        int64_t initiation_interval,
+        FindMinimumInitiationInterval(f->AsProcOrDie(), input_delay_added,
+                                      options, clock_period_ps));
+    f->SetInitiationInterval(initiation_interval);
+    if (sdc_scheduler != nullptr) {
+      // Rebuild the scheduler so its backedge constraints use the new
+      // initiation interval.
+      XLS_ASSIGN_OR_RETURN(sdc_scheduler,
+                           SDCScheduler::Create(f, input_delay_added));
+      XLS_RETURN_IF_ERROR(sdc_scheduler->AddConstraints(options.constraints()));
+    }
+  }
+
   ScheduleCycleMap cycle_map;
   if (options.strategy() == SchedulingStrategy::SDC) {
     // Enable iterative SDC scheduling when use_fdo is true
@@ -357,7 +443,7 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
                  "the shortest feasible clock period...";
           int64_t target_clock_period_ps = clock_period_ps + 1;
           absl::StatusOr<int64_t> min_clock_period_ps = FindMinimumClockPeriod(
-              f, options.pipeline_stages(), input_delay_added, *sdc_scheduler,
+              f, options.pipeline_stages(), *sdc_scheduler,
               target_clock_period_ps);
           if (min_clock_period_ps.ok()) {
             // Just increasing the clock period suffices.
@@ -382,8 +468,8 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
         }
 
         // Check if just increasing the clock period would have helped.
-        XLS_ASSIGN_OR_RETURN(int64_t pessimistic_clock_period_ps,
-                             ComputeCriticalPath(f, input_delay_added));
+        int64_t pessimistic_clock_period_ps =
+            ComputeCriticalPath(f, *sdc_scheduler);
         absl::Status pessimistic_status =
             sdc_scheduler
                 ->Schedule(options.pipeline_stages(),
@@ -467,4 +553,111 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
   return schedule;
 }
 
+absl::StatusOr<PipelineSchedule> RetimePipelineSchedule(
+    const PipelineSchedule& schedule, const DelayEstimator& delay_estimator,
+    const SchedulingOptions& options) {
+  FunctionBase* f = schedule.function_base();
+  if (!f->IsFunction() || schedule.length() <= 1) {
+    return schedule;
+  }
+  // The min-cut scheduler only understands receives-first-sends-last
+  // constraints. Backedge and send-then-receive constraints are vacuous for
+  // functions, which have neither state nor channel operations.
+  std::vector<SchedulingConstraint> constraints;
+  for (const SchedulingConstraint& constraint : options.constraints()) {
+    if (std::holds_alternative<RecvsFirstSendsLastConstraint>(constraint)) {
+      constraints.push_back(constraint);
+    } else if (!std::holds_alternative<BackedgeConstraint>(constraint) &&
+               !std::holds_alternative<SendThenRecvConstraint>(constraint)) {
+      return schedule;
+    }
+  }
+  for (Node* node : f->nodes()) {
+    if (node->Is<MinDelay>()) {
+      return schedule;
+    }
+  }
+
+  // Retime against the longest combinational path of any stage of the existing
+  // schedule rather than the target clock period so the result is never
+  // slower.
+  std::vector<Node*> topo_sort = TopoSort(f).AsVector();
+  int64_t clock_period_ps = 1;
+  absl::flat_hash_map<Node*, int64_t> path_delay;
+  for (Node* node : topo_sort) {
+    int64_t start = 0;
+    for (Node* operand : node->operands()) {
+      if (schedule.cycle(operand) == schedule.cycle(node)) {
+        start = std::max(start, path_delay.at(operand));
+      }
+    }
+    XLS_ASSIGN_OR_RETURN(int64_t delay,
+                         delay_estimator.GetOperationDelayInPs(node));
+    path_delay[node] = start + delay;
+    clock_period_ps = std::max(clock_period_ps, path_delay[node]);
+  }
+
+  sched::ScheduleBounds bounds(f, std::move(topo_sort), clock_period_ps,
+                               delay_estimator);
+  XLS_RETURN_IF_ERROR(TightenBounds(bounds, f, schedule.length()));
+  XLS_ASSIGN_OR_RETURN(
+      ScheduleCycleMap cycle_map,
+      MinCutScheduler(f, schedule.length(), clock_period_ps, delay_estimator,
+                      &bounds, constraints));
+  PipelineSchedule retimed(f, std::move(cycle_map), schedule.length());
+  XLS_RETURN_IF_ERROR(retimed.Verify());
+  XLS_RETURN_IF_ERROR(retimed.VerifyTiming(clock_period_ps, delay_estimator));
+  XLS_RETURN_IF_ERROR(retimed.VerifyConstraints(options.constraints(),
+                                                f->GetInitiationInterval()));
+
+  int64_t registers_before = schedule.CountFinalInteriorPipelineRegisters();
+  int64_t registers_after = retimed.CountFinalInteriorPipelineRegisters();
+  XLS_VLOG(2) << absl::StreamFormat(
+      "Retiming %s: %d -> %d pipeline register bits", f->name(),
+      registers_before, registers_after);
+  if (registers_after >= registers_before) {
+    return schedule;
+  }
+  return retimed;
+}
+
+absl::StatusOr<std::vector<PipelineSchedule>> RunPipelineSchedules(
+    absl::Span<FunctionBase* const> fbs, const DelayEstimator& delay_estimator,
+    const SchedulingOptions& options,
+    const synthesis::Synthesizer* synthesizer, int64_t parallelism) {
+  XLS_RET_CHECK_GE(parallelism, 1);
+  std::vector<std::optional<absl::StatusOr<PipelineSchedule>>> results(
+      fbs.size());
+  std::atomic<int64_t> next_index = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_index++; i < static_cast<int64_t>(fbs.size());
+         i = next_index++) {
+      results[i] =
+          RunPipelineSchedule(fbs[i], delay_estimator, options, synthesizer);
+    }
+  };
+  {
+    int64_t thread_count =
+        std::min(parallelism, static_cast<int64_t>(fbs.size()));
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t i = 1; i < thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    worker();
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+
+  std::vector<PipelineSchedule> schedules;
+  schedules.reserve(fbs.size());
+  for (int64_t i = 0; i < fbs.size(); ++i) {
+    XLS_RET_CHECK(results[i].has_value());
+    XLS_ASSIGN_OR_RETURN(PipelineSchedule schedule, *std::move(results[i]),
+                         _ << "Scheduling " << fbs[i]->name() << " failed");
+    schedules.push_back(std::move(schedule));
+  }
+  return schedules;
+}
+
 }  // namespace xls
@@ -15,7 +15,11 @@
 #ifndef XLS_SCHEDULING_RUN_PIPELINE_SCHEDULE_H_
 #define XLS_SCHEDULING_RUN_PIPELINE_SCHEDULE_H_
 
+#include <cstdint>
+#include <vector>
+
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/fdo/synthesizer.h"
 #include "xls/ir/function_base.h"
@@ -32,6 +36,31 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
     const SchedulingOptions& options,
     const synthesis::Synthesizer* synthesizer = nullptr);
 
+// Produces a pipeline schedule for each of `fbs` (e.g., the procs of a
+// multi-proc package) using the given delay model and scheduling options. The
+// scheduling problems are independent, so up to `parallelism` of them are
+// solved concurrently. The schedules are returned in the order of `fbs`; if
+// any function base fails to schedule, the error for the first such function
+// base in that order is returned, so the result does not depend on thread
+// interleaving. The options must not contain constraints which refer to nodes
+// of only some of the function bases.
+absl::StatusOr<std::vector<PipelineSchedule>> RunPipelineSchedules(
+    absl::Span<FunctionBase* const> fbs, const DelayEstimator& delay_estimator,
+    const SchedulingOptions& options,
+    const synthesis::Synthesizer* synthesizer = nullptr,
+    int64_t parallelism = 1);
+
+// Returns a schedule of the same length as `schedule` which needs fewer
+// pipeline register bits, found by a min-cut of the nodes at each stage
+// boundary. The longest combinational path of any stage of `schedule` bounds
+// the stage delays of the result, so timing does not get worse. Returns
+// `schedule` unchanged if no schedule with fewer register bits is found or if
+// the function base cannot be retimed; currently only functions without IO,
+// node-in-cycle or difference constraints are retimed.
+absl::StatusOr<PipelineSchedule> RetimePipelineSchedule(
+    const PipelineSchedule& schedule, const DelayEstimator& delay_estimator,
+    const SchedulingOptions& options);
+
 }  // namespace xls
 
 #endif  // XLS_SCHEDULING_RUN_PIPELINE_SCHEDULE_H_
@@ -191,15 +191,19 @@ class SchedulingOptions {
       SchedulingStrategy strategy = SchedulingStrategy::SDC)
       : strategy_(strategy),
         minimize_clock_on_failure_(true),
+        retime_pipeline_registers_(false),
+        minimize_worst_case_throughput_(false),
         constraints_({BackedgeConstraint(),
                       SendThenRecvConstraint(/*minimum_latency=*/1)}),
+        mutual_exclusion_z3_threads_(1),
         use_fdo_(false),
         fdo_iteration_number_(5),
         fdo_delay_driven_path_number_(1),
         fdo_fanout_driven_path_number_(0),
         fdo_refinement_stochastic_ratio_(1.0),
         fdo_path_evaluate_strategy_(PathEvaluateStrategy::WINDOW),
-        fdo_synthesizer_name_("yosys")
+        fdo_synthesizer_name_("yosys"),
+        fdo_max_concurrent_synthesis_jobs_(0)
         {}
 
   // Returns the scheduling strategy.
@@ -258,6 +262,15 @@ class SchedulingOptions {
     return minimize_clock_on_failure_;
   }
 
+  // Sets/gets whether to move nodes between stages after scheduling to reduce
+  // the number of pipeline register bits without lengthening the critical
+  // stage (see PipelineRetimingPass).
+  SchedulingOptions& retime_pipeline_registers(bool value) {
+    retime_pipeline_registers_ = value;
+    return *this;
+  }
+  bool retime_pipeline_registers() const { return retime_pipeline_registers_; }
+
   // Sets/gets the worst-case throughput bound to use when scheduling; for
   // procs, controls the length of state backedges allowed in scheduling.
   SchedulingOptions& worst_case_throughput(int64_t value) {
@@ -268,6 +281,19 @@ class SchedulingOptions {
     return worst_case_throughput_;
   }
 
+  // Sets/gets whether to schedule procs at the smallest initiation interval
+  // (i.e., the best worst-case throughput) which fits in the given number of
+  // pipeline stages at the given clock period. If a worst-case throughput is
+  // also set, it bounds the initiation interval searched. Requires both a clock
+  // period and a pipeline length; ignored for functions.
+  SchedulingOptions& minimize_worst_case_throughput(bool value) {
+    minimize_worst_case_throughput_ = value;
+    return *this;
+  }
+  bool minimize_worst_case_throughput() const {
+    return minimize_worst_case_throughput_;
+  }
+
   // Sets/gets the additional delay added to each receive node.
   //
   // TODO(tedhong): 2022-02-11, Update so that this sets/gets the
@@ -289,6 +315,14 @@ class SchedulingOptions {
     return ffi_fallback_delay_ps_;
   }
 
+  // Sets/gets the path of the file in which delay estimates are memoized
+  // across runs (see DelayCache).
+  SchedulingOptions& delay_cache_path(std::string_view value) {
+    delay_cache_path_ = value;
+    return *this;
+  }
+  const std::string& delay_cache_path() const { return delay_cache_path_; }
+
   // Add a constraint to the set of scheduling constraints.
   SchedulingOptions& add_constraint(const SchedulingConstraint& constraint) {
     constraints_.push_back(constraint);
@@ -318,6 +352,26 @@ class SchedulingOptions {
     return mutual_exclusion_z3_rlimit_;
   }
 
+  // The number of threads issuing Z3 queries in mutual exclusion analysis.
+  SchedulingOptions& mutual_exclusion_z3_threads(int64_t value) {
+    mutual_exclusion_z3_threads_ = value;
+    return *this;
+  }
+  int64_t mutual_exclusion_z3_threads() const {
+    return mutual_exclusion_z3_threads_;
+  }
+
+  // The wall-clock budget in milliseconds for all Z3 queries of mutual
+  // exclusion analysis. Unlike the rlimit this makes the result depend on the
+  // speed of the machine.
+  SchedulingOptions& mutual_exclusion_z3_time_budget_ms(int64_t value) {
+    mutual_exclusion_z3_time_budget_ms_ = value;
+    return *this;
+  }
+  std::optional<int64_t> mutual_exclusion_z3_time_budget_ms() const {
+    return mutual_exclusion_z3_time_budget_ms_;
+  }
+
   // Enable FDO
   SchedulingOptions& use_fdo(bool value) {
     use_fdo_ = value;
@@ -408,6 +462,25 @@ class SchedulingOptions {
     return fdo_synthesis_libraries_;
   }
 
+  // File in which synthesized delays are memoized across runs.
+  SchedulingOptions& fdo_synthesis_cache_path(std::string_view value) {
+    fdo_synthesis_cache_path_ = value;
+    return *this;
+  }
+  const std::string& fdo_synthesis_cache_path() const {
+    return fdo_synthesis_cache_path_;
+  }
+
+  // Maximum number of concurrent synthesis jobs; zero means one per hardware
+  // thread.
+  SchedulingOptions& fdo_max_concurrent_synthesis_jobs(int64_t value) {
+    fdo_max_concurrent_synthesis_jobs_ = value;
+    return *this;
+  }
+  int64_t fdo_max_concurrent_synthesis_jobs() const {
+    return fdo_max_concurrent_synthesis_jobs_;
+  }
+
 
  private:
   SchedulingStrategy strategy_;
@@ -417,12 +490,17 @@ class SchedulingOptions {
   std::optional<int64_t> clock_margin_percent_;
   std::optional<int64_t> period_relaxation_percent_;
   bool minimize_clock_on_failure_;
+  bool retime_pipeline_registers_;
   std::optional<int64_t> worst_case_throughput_;
+  bool minimize_worst_case_throughput_;
   std::optional<int64_t> additional_input_delay_ps_;
   std::optional<int64_t> ffi_fallback_delay_ps_;
+  std::string delay_cache_path_;
   std::vector<SchedulingConstraint> constraints_;
   std::optional<int32_t> seed_;
   std::optional<int64_t> mutual_exclusion_z3_rlimit_;
+  int64_t mutual_exclusion_z3_threads_;
+  std::optional<int64_t> mutual_exclusion_z3_time_budget_ms_;
   bool use_fdo_;
   int64_t fdo_iteration_number_;
   int64_t fdo_delay_driven_path_number_;
@@ -433,6 +511,8 @@ class SchedulingOptions {
   std::string fdo_yosys_path_;
   std::string fdo_sta_path_;
   std::string fdo_synthesis_libraries_;
+  std::string fdo_synthesis_cache_path_;
+  int64_t fdo_max_concurrent_synthesis_jobs_;
 };
 
 // A map from node to cycle as a bare-bones representation of a schedule.
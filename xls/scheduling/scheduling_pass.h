@@ -15,6 +15,7 @@
 #ifndef XLS_SCHEDULING_SCHEDULING_PASS_H_
 #define XLS_SCHEDULING_SCHEDULING_PASS_H_
 
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -55,6 +56,11 @@ struct SchedulingUnit {
     return out;
   }
   std::string name() const { return ir->name(); }
+  int64_t GetNodeCount() const { return ir->GetNodeCount(); }
+  int64_t GetApproximateIrByteSize() const {
+    return ir->GetApproximateIrByteSize();
+  }
+  int64_t next_node_id() const { return ir->next_node_id(); }
 };
 
 // Options passed to each scheduling pass.
@@ -38,6 +38,7 @@
 #include "xls/common/logging/vlog_is_on.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/tracing.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/function.h"
@@ -59,12 +60,16 @@ using DelayMap = absl::flat_hash_map<Node*, int64_t>;
 namespace math_opt = ::operations_research::math_opt;
 
 // A helper function to compute each node's delay by calling the delay estimator
+// once with all nodes of `f`.
 absl::StatusOr<DelayMap> ComputeNodeDelays(
     FunctionBase* f, const DelayEstimator& delay_estimator) {
+  std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
+  std::vector<absl::StatusOr<int64_t>> delays =
+      delay_estimator.GetOperationDelaysInPs(nodes);
   DelayMap result;
-  for (Node* node : f->nodes()) {
-    XLS_ASSIGN_OR_RETURN(result[node],
-                         delay_estimator.GetOperationDelayInPs(node));
+  result.reserve(nodes.size());
+  for (int64_t i = 0; i < nodes.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(result[nodes[i]], std::move(delays[i]));
   }
   return result;
 }
@@ -533,31 +538,46 @@ absl::StatusOr<ScheduleCycleMap> SDCSchedulingModel::ExtractResult(
 }
 
 void SDCSchedulingModel::SetClockPeriod(int64_t clock_period_ps) {
-  absl::flat_hash_map<Node*, std::vector<Node*>> prev_delay_constraints =
-      std::move(delay_constraints_);
-  delay_constraints_ = ComputeCombinationalDelayConstraints(
-      func_, topo_sort_, clock_period_ps, distances_to_node_, delay_map_);
-
-  for (Node* source : topo_sort_) {
-    if (!prev_delay_constraints.empty()) {
-      // Check over all the prior constraints, dropping any that are obsolete.
-      absl::flat_hash_set<Node*> new_targets(
-          delay_constraints_.at(source).begin(),
-          delay_constraints_.at(source).end());
-      for (Node* target : prev_delay_constraints.at(source)) {
-        if (new_targets.contains(target)) {
-          continue;
-        }
+  if (clock_period_ps_ == clock_period_ps) {
+    return;
+  }
+  clock_period_ps_ = clock_period_ps;
+  SetTimingConstraints(ComputeCombinationalDelayConstraints(
+      func_, topo_sort_, clock_period_ps, distances_to_node_, delay_map_));
+}
 
-        // No longer related; remove constraint.
-        auto it = timing_constraint_.find(std::make_pair(source, target));
-        model_.DeleteLinearConstraint(it->second);
-        timing_constraint_.erase(it);
-      }
+void SDCSchedulingModel::SetTimingConstraints(
+    const absl::flat_hash_map<Node*, std::vector<Node*>>& delay_constraints) {
+  // Only the timing constraints which differ from those currently in the model
+  // are added or deleted, so an incremental solver can reuse its previous
+  // solution as a warm start.
+  absl::flat_hash_set<std::pair<Node*, Node*>> new_keys;
+  for (const auto& [source, targets] : delay_constraints) {
+    for (Node* target : targets) {
+      new_keys.insert({source, target});
     }
+  }
 
-    // Add all new constraints, avoiding duplicates for any that already exist.
-    for (Node* target : delay_constraints_.at(source)) {
+  // Drop any prior constraints which are obsolete.
+  int64_t removed = 0;
+  absl::erase_if(timing_constraint_, [&](const auto& entry) {
+    if (new_keys.contains(entry.first)) {
+      return false;
+    }
+    model_.DeleteLinearConstraint(entry.second);
+    ++removed;
+    return true;
+  });
+
+  // Add all new constraints, avoiding duplicates for any that already exist.
+  // Iterate in topological order so the model is built deterministically.
+  int64_t added = 0;
+  for (Node* source : topo_sort_) {
+    auto it = delay_constraints.find(source);
+    if (it == delay_constraints.end()) {
+      continue;
+    }
+    for (Node* target : it->second) {
       auto key = std::make_pair(source, target);
       if (timing_constraint_.contains(key)) {
         continue;
@@ -569,8 +589,12 @@ void SDCSchedulingModel::SetClockPeriod(int64_t clock_period_ps) {
                                      source->GetName());
       timing_constraint_.emplace(
           key, DiffAtLeastConstraint(target, source, 1, "timing"));
+      ++added;
     }
   }
+  XLS_VLOG(2) << absl::StreamFormat(
+      "Timing constraints: %d added, %d removed, %d total", added, removed,
+      timing_constraint_.size());
 }
 
 void SDCSchedulingModel::SetPipelineLength(
@@ -651,6 +675,22 @@ absl::Status SDCSchedulingModel::AddSlackVariables() {
   return absl::OkStatus();
 }
 
+void SDCSchedulingModel::RemoveSlackVariables() {
+  // Deleting a variable also removes it from every constraint & the objective,
+  // restoring the constraints relaxed by AddSlackVariables. The pipeline-length
+  // bound & objective are reset by the next call to SetPipelineLength and
+  // SetObjective/MinimizePipelineLength.
+  if (backedge_slack_.has_value()) {
+    model_.DeleteVariable(*backedge_slack_);
+    backedge_slack_.reset();
+  }
+  for (auto& [io_constraint, slack] : io_slack_) {
+    model_.DeleteVariable(slack.min);
+    model_.DeleteVariable(slack.max);
+  }
+  io_slack_.clear();
+}
+
 absl::Status SDCSchedulingModel::ExtractError(
     const math_opt::VariableMap<double>& variable_values) const {
   std::vector<std::string> problems;
@@ -857,6 +897,10 @@ SDCScheduler::SDCScheduler(FunctionBase* f, DelayMap delay_map)
       model_(f, delay_map_, absl::StrCat("sdc_model:", f->name())) {}
 
 absl::Status SDCScheduler::Initialize() {
+  // The incremental solver tracks changes to the model between solves; Glop
+  // applies them to its existing state and warm-starts from the previous basis,
+  // so repeated calls to Schedule (e.g., binary-searching the clock period)
+  // only pay for the constraints that changed.
   XLS_ASSIGN_OR_RETURN(
       solver_, math_opt::IncrementalSolver::New(&model_.UnderlyingModel(),
                                                 math_opt::SolverType::kGlop));
@@ -904,15 +948,22 @@ absl::Status SDCScheduler::BuildError(const math_opt::SolveResult& result,
        result.termination.reason ==
            math_opt::TerminationReason::kInfeasibleOrUnbounded)) {
     XLS_RETURN_IF_ERROR(model_.AddSlackVariables());
-    XLS_ASSIGN_OR_RETURN(math_opt::SolveResult result_with_slack,
-                         solver_->Solve());
-    if (result_with_slack.termination.reason ==
-            math_opt::TerminationReason::kOptimal ||
-        result_with_slack.termination.reason ==
-            math_opt::TerminationReason::kFeasible) {
-      XLS_RETURN_IF_ERROR(
-          model_.ExtractError(result_with_slack.variable_values()));
+    absl::StatusOr<math_opt::SolveResult> result_with_slack = solver_->Solve();
+    absl::Status error = absl::OkStatus();
+    if (!result_with_slack.ok()) {
+      error = result_with_slack.status();
+    } else if (result_with_slack->termination.reason ==
+                   math_opt::TerminationReason::kOptimal ||
+               result_with_slack->termination.reason ==
+                   math_opt::TerminationReason::kFeasible) {
+      error = model_.ExtractError(result_with_slack->variable_values());
     }
+
+    // Restore the original constraints so later calls to Schedule (e.g., while
+    // searching for a feasible clock period) re-solve the same model rather
+    // than the relaxed one.
+    model_.RemoveSlackVariables();
+    XLS_RETURN_IF_ERROR(error);
   }
 
   // We don't know why the solver failed to find an optimal solution to our LP
@@ -928,6 +979,7 @@ absl::Status SDCScheduler::BuildError(const math_opt::SolveResult& result,
 absl::StatusOr<ScheduleCycleMap> SDCScheduler::Schedule(
     std::optional<int64_t> pipeline_stages, int64_t clock_period_ps,
     bool check_feasibility, bool explain_infeasibility) {
+  ScopedTraceSpan trace_span("scheduling", "sdc_solve");
   model_.SetClockPeriod(clock_period_ps);
 
   model_.SetPipelineLength(pipeline_stages);
@@ -63,6 +63,10 @@ class SDCSchedulingModel {
   absl::Status AddSendThenRecvConstraint(
       const SendThenRecvConstraint& constraint);
 
+  // Updates the timing constraints for the given clock period. Only the
+  // constraints which differ from those for the previous clock period are
+  // added to or removed from the model; this is a no-op if the clock period is
+  // unchanged.
   void SetClockPeriod(int64_t clock_period_ps);
 
   void SetPipelineLength(std::optional<int64_t> pipeline_length);
@@ -77,6 +81,10 @@ class SDCSchedulingModel {
 
   absl::Status AddSlackVariables();
 
+  // Removes the slack variables added by AddSlackVariables, restoring the
+  // original constraints so the model can be re-solved.
+  void RemoveSlackVariables();
+
   operations_research::math_opt::Model& UnderlyingModel() { return model_; }
   const operations_research::math_opt::Model& UnderlyingModel() const {
     return model_;
@@ -115,6 +123,13 @@ class SDCSchedulingModel {
   operations_research::math_opt::LinearConstraint DiffEqualsConstraint(
       Node* x, Node* y, int64_t diff, std::string_view name);
 
+ protected:
+  // Replaces the timing constraints in the model with `delay_constraints`,
+  // which maps each node to the nodes which must be scheduled in a strictly
+  // later stage. Constraints already present in the model are left untouched.
+  void SetTimingConstraints(
+      const absl::flat_hash_map<Node*, std::vector<Node*>>& delay_constraints);
+
  private:
   operations_research::math_opt::Variable AddUpperBoundSlack(
       operations_research::math_opt::LinearConstraint c,
@@ -170,8 +185,8 @@ class SDCSchedulingModel {
   // data-dependence graph.
   operations_research::math_opt::Variable cycle_at_sinknode_;
 
-  // A cache of the delay constraints.
-  absl::flat_hash_map<Node*, std::vector<Node*>> delay_constraints_;
+  // The clock period the current timing constraints were computed for.
+  std::optional<int64_t> clock_period_ps_;
 
   absl::flat_hash_map<std::pair<Node*, Node*>,
                       operations_research::math_opt::LinearConstraint>
@@ -231,6 +246,11 @@ class SDCScheduler {
       std::optional<int64_t> pipeline_stages, int64_t clock_period_ps,
       bool check_feasibility = false, bool explain_infeasibility = true);
 
+  // Returns the estimated delay of every node, computed once at construction.
+  const absl::flat_hash_map<Node*, int64_t>& delay_map() const {
+    return delay_map_;
+  }
+
  private:
   SDCScheduler(FunctionBase* f, DelayMap delay_map);
   absl::Status Initialize();
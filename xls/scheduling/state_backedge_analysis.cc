@@ -0,0 +1,163 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/state_backedge_analysis.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/node.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/proc.h"
+
+namespace xls {
+namespace {
+
+// The earliest placement of a node relative to the cycle in which a state
+// parameter is read: the cycle offset and the delay into that cycle at which
+// the node's result is available.
+struct Placement {
+  int64_t cycle;
+  int64_t arrival_ps;
+};
+
+absl::StatusOr<StateBackedge> AnalyzeStateBackedge(
+    Proc* proc, int64_t state_index, absl::Span<Node* const> topo_sort,
+    const absl::flat_hash_map<Node*, int64_t>& delays,
+    int64_t clock_period_ps) {
+  Param* state = proc->GetStateParam(state_index);
+  Node* next_state = proc->GetNextStateElement(state_index);
+  StateBackedge backedge{.state_index = state_index,
+                         .state = state,
+                         .next_state = next_state,
+                         .critical_path_ps = 0,
+                         .min_initiation_interval = 1};
+  if (next_state == state) {
+    return backedge;
+  }
+
+  // Place each node depending on the state parameter as early as possible.
+  // Values which do not depend on the state can be computed in any earlier
+  // cycle, so only the operands within the cone of the state parameter delay a
+  // node.
+  absl::flat_hash_map<Node*, Placement> placements;
+  absl::flat_hash_map<Node*, int64_t> path_ps;
+  placements[state] = Placement{.cycle = 0, .arrival_ps = delays.at(state)};
+  path_ps[state] = delays.at(state);
+  for (Node* node : topo_sort) {
+    if (node == state) {
+      continue;
+    }
+    int64_t cycle = -1;
+    int64_t arrival_ps = 0;
+    int64_t node_path_ps = 0;
+    for (Node* operand : node->operands()) {
+      auto it = placements.find(operand);
+      if (it == placements.end()) {
+        continue;
+      }
+      if (it->second.cycle > cycle) {
+        cycle = it->second.cycle;
+        arrival_ps = it->second.arrival_ps;
+      } else if (it->second.cycle == cycle) {
+        arrival_ps = std::max(arrival_ps, it->second.arrival_ps);
+      }
+      node_path_ps = std::max(node_path_ps, path_ps.at(operand));
+    }
+    if (cycle < 0) {
+      continue;
+    }
+    int64_t delay = delays.at(node);
+    // A node which does not fit in the remainder of the cycle of its operands
+    // starts the next one. Nodes slower than the clock are left in place; the
+    // scheduler reports those.
+    if (arrival_ps > 0 && arrival_ps + delay > clock_period_ps) {
+      ++cycle;
+      arrival_ps = 0;
+    }
+    placements[node] =
+        Placement{.cycle = cycle, .arrival_ps = arrival_ps + delay};
+    path_ps[node] = node_path_ps + delay;
+  }
+
+  auto it = placements.find(next_state);
+  if (it != placements.end()) {
+    backedge.critical_path_ps = path_ps.at(next_state);
+    backedge.min_initiation_interval = it->second.cycle + 1;
+  }
+  return backedge;
+}
+
+}  // namespace
+
+absl::StatusOr<std::vector<StateBackedge>> AnalyzeStateBackedges(
+    Proc* proc, const DelayEstimator& delay_estimator,
+    int64_t clock_period_ps) {
+  std::vector<Node*> topo_sort = TopoSort(proc).AsVector();
+  absl::flat_hash_map<Node*, int64_t> delays;
+  for (Node* node : topo_sort) {
+    XLS_ASSIGN_OR_RETURN(delays[node],
+                         delay_estimator.GetOperationDelayInPs(node));
+  }
+
+  std::vector<StateBackedge> backedges;
+  backedges.reserve(proc->GetStateElementCount());
+  for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
+    XLS_ASSIGN_OR_RETURN(
+        StateBackedge backedge,
+        AnalyzeStateBackedge(proc, i, topo_sort, delays, clock_period_ps));
+    backedges.push_back(backedge);
+  }
+  return backedges;
+}
+
+int64_t MinimumInitiationInterval(absl::Span<const StateBackedge> backedges) {
+  int64_t ii = 1;
+  for (const StateBackedge& backedge : backedges) {
+    ii = std::max(ii, backedge.min_initiation_interval);
+  }
+  return ii;
+}
+
+std::string StateBackedgesToString(absl::Span<const StateBackedge> backedges) {
+  std::vector<StateBackedge> sorted(backedges.begin(), backedges.end());
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const StateBackedge& a, const StateBackedge& b) {
+                     if (a.min_initiation_interval !=
+                         b.min_initiation_interval) {
+                       return a.min_initiation_interval >
+                              b.min_initiation_interval;
+                     }
+                     return a.critical_path_ps > b.critical_path_ps;
+                   });
+  std::string result;
+  for (const StateBackedge& backedge : sorted) {
+    absl::StrAppendFormat(
+        &result, "  %s -> %s: critical path %dps, minimum II %d\n",
+        backedge.state->GetName(), backedge.next_state->GetName(),
+        backedge.critical_path_ps, backedge.min_initiation_interval);
+  }
+  return result;
+}
+
+}  // namespace xls
@@ -0,0 +1,67 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SCHEDULING_STATE_BACKEDGE_ANALYSIS_H_
+#define XLS_SCHEDULING_STATE_BACKEDGE_ANALYSIS_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/proc.h"
+
+namespace xls {
+
+// The throughput limit imposed by the backedge of a single proc state element.
+// The BackedgeConstraint requires the next-state value of each element to be
+// computed within `initiation interval` cycles of the cycle in which the state
+// parameter is read, so the longest path from the state parameter to its
+// next-state value bounds the achievable initiation interval from below.
+struct StateBackedge {
+  int64_t state_index;
+  Param* state;
+  Node* next_state;
+
+  // Delay of the longest combinational path from the state parameter to its
+  // next-state value, in picoseconds. Zero if the next-state value does not
+  // depend on the state parameter.
+  int64_t critical_path_ps;
+
+  // The smallest initiation interval for which the path from the state
+  // parameter to its next-state value can be scheduled at the given clock
+  // period, ignoring all other constraints.
+  int64_t min_initiation_interval;
+};
+
+// Returns the backedge of each state element of `proc` along with the minimum
+// initiation interval it permits, in state element order.
+absl::StatusOr<std::vector<StateBackedge>> AnalyzeStateBackedges(
+    Proc* proc, const DelayEstimator& delay_estimator,
+    int64_t clock_period_ps);
+
+// Returns the smallest initiation interval permitted by all of `backedges`.
+int64_t MinimumInitiationInterval(absl::Span<const StateBackedge> backedges);
+
+// Returns a human-readable report of `backedges`, ordered from the most to the
+// least limiting.
+std::string StateBackedgesToString(absl::Span<const StateBackedge> backedges);
+
+}  // namespace xls
+
+#endif  // XLS_SCHEDULING_STATE_BACKEDGE_ANALYSIS_H_
@@ -0,0 +1,82 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/state_backedge_analysis.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::testing::HasSubstr;
+
+class StateBackedgeAnalysisTest : public IrTestBase {};
+
+TEST_F(StateBackedgeAnalysisTest, ReportsLongestStateLoop) {
+  auto p = CreatePackage();
+  TokenlessProcBuilder pb(TestName(), "tkn", p.get());
+  BValue slow = pb.StateElement("slow", Value(UBits(0, 16)));
+  BValue fast = pb.StateElement("fast", Value(UBits(0, 16)));
+  BValue constant = pb.StateElement("constant", Value(UBits(0, 16)));
+  BValue unchanged = pb.StateElement("unchanged", Value(UBits(0, 16)));
+  BValue slow_next = pb.Negate(pb.Not(pb.Negate(slow)));
+  BValue fast_next = pb.Add(fast, pb.Not(pb.Not(constant)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * proc,
+      pb.Build({slow_next, fast_next, pb.Literal(UBits(1, 16)), unchanged}));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<StateBackedge> backedges,
+      AnalyzeStateBackedges(proc, TestDelayEstimator(), /*clock_period_ps=*/1));
+  ASSERT_EQ(backedges.size(), 4);
+
+  EXPECT_EQ(backedges[0].state, slow.node());
+  EXPECT_EQ(backedges[0].next_state, slow_next.node());
+  EXPECT_EQ(backedges[0].critical_path_ps, 3);
+  EXPECT_EQ(backedges[0].min_initiation_interval, 3);
+
+  // Only the path through the state parameter counts; the longer path from the
+  // other state element can be computed in earlier cycles.
+  EXPECT_EQ(backedges[1].critical_path_ps, 1);
+  EXPECT_EQ(backedges[1].min_initiation_interval, 1);
+
+  // Next-state values which do not depend on the state impose no limit.
+  EXPECT_EQ(backedges[2].critical_path_ps, 0);
+  EXPECT_EQ(backedges[2].min_initiation_interval, 1);
+  EXPECT_EQ(backedges[3].critical_path_ps, 0);
+  EXPECT_EQ(backedges[3].min_initiation_interval, 1);
+
+  EXPECT_EQ(MinimumInitiationInterval(backedges), 3);
+  EXPECT_THAT(StateBackedgesToString(backedges),
+              HasSubstr("slow -> " + slow_next.node()->GetName() +
+                        ": critical path 3ps, minimum II 3"));
+
+  // A longer clock period fits more of the loop in each cycle.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      backedges,
+      AnalyzeStateBackedges(proc, TestDelayEstimator(), /*clock_period_ps=*/2));
+  EXPECT_EQ(backedges[0].min_initiation_interval, 2);
+  EXPECT_EQ(MinimumInitiationInterval(backedges), 2);
+}
+
+}  // namespace
+}  // namespace xls
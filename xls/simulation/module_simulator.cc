@@ -15,6 +15,9 @@
 #include "xls/simulation/module_simulator.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <string>
@@ -23,17 +26,27 @@
 #include <variant>
 #include <vector>
 
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/codegen/flattening.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/logging/vlog_is_on.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/number_parser.h"
 #include "xls/tools/eval_helpers.h"
 
 namespace xls {
@@ -263,6 +276,223 @@ absl::StatusOr<std::vector<std::unique_ptr<Bits>>> CaptureOutputChannel(
   return outputs;
 }
 
+// Names of the files in the data directory of a CompiledBatchSimulator through
+// which a batch is passed to the testbench.
+constexpr std::string_view kBatchInputsFileName = "inputs.hex";
+constexpr std::string_view kBatchCountFileName = "count.hex";
+
+// Prefix of the lines with which the batch testbench prints the outputs of
+// each input vector.
+constexpr std::string_view kBatchOutputPrefix = "__xls_batch_output";
+
+// Returns the ports of the signature which appear in the Verilog module, i.e.,
+// excluding zero-width ports.
+std::vector<PortProto> NonZeroWidthPorts(absl::Span<const PortProto> ports) {
+  std::vector<PortProto> result;
+  for (const PortProto& port : ports) {
+    if (port.width() > 0) {
+      result.push_back(port);
+    }
+  }
+  return result;
+}
+
+int64_t TotalWidth(absl::Span<const PortProto> ports) {
+  int64_t width = 0;
+  for (const PortProto& port : ports) {
+    width += port.width();
+  }
+  return width;
+}
+
+// Returns the concatenation of the given ports as a Verilog expression.
+std::string PortConcat(absl::Span<const PortProto> ports) {
+  std::vector<std::string> names;
+  for (const PortProto& port : ports) {
+    names.push_back(port.name());
+  }
+  return absl::StrCat("{", absl::StrJoin(names, ", "), "}");
+}
+
+// Returns a Verilog testbench which instantiates the module described by
+// "signature", loads up to "max_batch_size" concatenated input vectors and
+// their count from the given files in "data_dir", and prints the concatenated
+// outputs for each input vector on a line starting with kBatchOutputPrefix.
+absl::StatusOr<std::string> GenerateBatchTestbench(
+    const ModuleSignature& signature, int64_t max_batch_size,
+    const std::filesystem::path& data_dir) {
+  const ModuleSignatureProto& proto = signature.proto();
+  std::optional<int64_t> latency;
+  if (proto.has_fixed_latency()) {
+    latency = proto.fixed_latency().latency();
+  } else if (proto.has_pipeline()) {
+    latency = proto.pipeline().latency();
+  } else if (!proto.has_combinational()) {
+    return absl::UnimplementedError(absl::StrCat(
+        "Unsupported interface: ", proto.interface_oneof_case()));
+  }
+  if (latency.has_value() && !proto.has_clock_name()) {
+    return absl::InvalidArgumentError("Expected clock in signature");
+  }
+  std::optional<PipelineControl> pipeline_control;
+  if (proto.has_pipeline() && proto.pipeline().has_pipeline_control()) {
+    pipeline_control = proto.pipeline().pipeline_control();
+  }
+
+  std::vector<PortProto> inputs = NonZeroWidthPorts(signature.data_inputs());
+  std::vector<PortProto> outputs = NonZeroWidthPorts(signature.data_outputs());
+  int64_t input_width = TotalWidth(inputs);
+
+  std::string tb = "module __xls_batch_testbench;\n";
+  std::vector<std::string> connections;
+  auto add_signal = [&](std::string_view kind, std::string_view name,
+                        int64_t width) {
+    absl::StrAppendFormat(&tb, "  %s [%d:0] %s;\n", kind, width - 1, name);
+    connections.push_back(absl::StrFormat(".%s(%s)", name, name));
+  };
+  if (latency.has_value()) {
+    add_signal("reg", proto.clock_name(), 1);
+  }
+  if (proto.has_reset()) {
+    add_signal("reg", proto.reset().name(), 1);
+  }
+  if (pipeline_control.has_value() && pipeline_control->has_valid()) {
+    add_signal("reg", pipeline_control->valid().input_name(), 1);
+    if (pipeline_control->valid().has_output_name()) {
+      add_signal("wire", pipeline_control->valid().output_name(), 1);
+    }
+  }
+  if (pipeline_control.has_value() && pipeline_control->has_manual()) {
+    add_signal("reg", pipeline_control->manual().input_name(), *latency);
+  }
+  for (const PortProto& input : inputs) {
+    add_signal("reg", input.name(), input.width());
+  }
+  for (const PortProto& output : outputs) {
+    add_signal("wire", output.name(), output.width());
+  }
+  absl::StrAppendFormat(&tb, "  %s dut(\n    %s\n  );\n",
+                        proto.module_name(),
+                        absl::StrJoin(connections, ",\n    "));
+
+  absl::StrAppendFormat(&tb, "  reg [31:0] __count [0:0];\n");
+  if (input_width > 0) {
+    absl::StrAppendFormat(&tb, "  reg [%d:0] __inputs [0:%d];\n",
+                          input_width - 1, max_batch_size - 1);
+  }
+  tb += "  integer __i;\n";
+  if (proto.has_pipeline()) {
+    tb += "  integer __j;\n  event __xls_issue_started;\n";
+  }
+  if (latency.has_value()) {
+    absl::StrAppendFormat(&tb,
+                          "  initial begin\n"
+                          "    %s = 0;\n"
+                          "    forever #5 %s = !%s;\n"
+                          "  end\n",
+                          proto.clock_name(), proto.clock_name(),
+                          proto.clock_name());
+  }
+
+  tb += "  initial begin\n";
+  absl::StrAppendFormat(&tb, "    $readmemh(\"%s\", __count);\n",
+                        (data_dir / kBatchCountFileName).string());
+  if (input_width > 0) {
+    absl::StrAppendFormat(&tb, "    $readmemh(\"%s\", __inputs);\n",
+                          (data_dir / kBatchInputsFileName).string());
+  }
+  // Hold all control inputs unasserted through reset, except for the pipeline
+  // register load enables which are always asserted.
+  if (pipeline_control.has_value() && pipeline_control->has_valid()) {
+    absl::StrAppendFormat(&tb, "    %s = 0;\n",
+                          pipeline_control->valid().input_name());
+  }
+  if (pipeline_control.has_value() && pipeline_control->has_manual()) {
+    absl::StrAppendFormat(&tb, "    %s = {%d{1'b1}};\n",
+                          pipeline_control->manual().input_name(), *latency);
+  }
+  if (latency.has_value()) {
+    if (proto.has_reset()) {
+      absl::StrAppendFormat(&tb,
+                            "    %s = %d;\n"
+                            "    repeat (5) @(posedge %s);\n"
+                            "    #1 %s = %d;\n",
+                            proto.reset().name(),
+                            proto.reset().active_low() ? 0 : 1,
+                            proto.clock_name(), proto.reset().name(),
+                            proto.reset().active_low() ? 1 : 0);
+    } else {
+      absl::StrAppendFormat(&tb, "    @(posedge %s);\n    #1;\n",
+                            proto.clock_name());
+    }
+  }
+  std::string display =
+      outputs.empty()
+          ? absl::StrFormat("$display(\"%s \")", kBatchOutputPrefix)
+          : absl::StrFormat("$display(\"%s %%h\", %s)", kBatchOutputPrefix,
+                            PortConcat(outputs));
+  if (proto.has_pipeline()) {
+    // A pipelined module accepts new inputs every cycle, so issue one input
+    // per cycle and capture the outputs in a separate process which starts
+    // `latency` cycles behind. A batch of N inputs takes N + latency cycles.
+    tb += "    -> __xls_issue_started;\n";
+  }
+  tb += "    for (__i = 0; __i < __count[0]; __i = __i + 1) begin\n";
+  if (input_width > 0) {
+    absl::StrAppendFormat(&tb, "      %s = __inputs[__i];\n",
+                          PortConcat(inputs));
+  }
+  if (pipeline_control.has_value() && pipeline_control->has_valid()) {
+    absl::StrAppendFormat(&tb, "      %s = 1;\n",
+                          pipeline_control->valid().input_name());
+  }
+  if (proto.has_pipeline()) {
+    absl::StrAppendFormat(&tb,
+                          "      @(posedge %s);\n"
+                          "      #1;\n"
+                          "    end\n",
+                          proto.clock_name());
+    if (pipeline_control.has_value() && pipeline_control->has_valid()) {
+      absl::StrAppendFormat(&tb, "    %s = 0;\n",
+                            pipeline_control->valid().input_name());
+    }
+    // The outputs of input i are captured just before the clock edge which
+    // ends cycle i + latency, counting from the cycle input 0 was applied.
+    absl::StrAppendFormat(&tb,
+                          "  end\n"
+                          "  initial begin\n"
+                          "    @(__xls_issue_started);\n"
+                          "    repeat (%d) @(posedge %s);\n"
+                          "    for (__j = 0; __j < __count[0]; __j = __j + 1) "
+                          "begin\n"
+                          "      #8 %s;\n"
+                          "      @(posedge %s);\n"
+                          "    end\n"
+                          "    $finish;\n"
+                          "  end\n"
+                          "endmodule\n",
+                          *latency, proto.clock_name(), display,
+                          proto.clock_name());
+    return tb;
+  }
+  if (latency.has_value()) {
+    // Hold the inputs until the outputs are captured just before the clock
+    // edge which ends cycle `latency` after the inputs were applied, then
+    // apply the next inputs just after that edge.
+    absl::StrAppendFormat(&tb,
+                          "      repeat (%d) @(posedge %s);\n"
+                          "      #8 %s;\n"
+                          "      @(posedge %s);\n"
+                          "      #1;\n",
+                          *latency, proto.clock_name(), display,
+                          proto.clock_name());
+  } else {
+    absl::StrAppendFormat(&tb, "      #1 %s;\n      #1;\n", display);
+  }
+  tb += "    end\n    $finish;\n  end\nendmodule\n";
+  return tb;
+}
+
 }  // namespace
 
 absl::flat_hash_map<std::string, Bits> ModuleSimulator::DeassertControlSignals()
@@ -480,6 +710,131 @@ ModuleSimulator::RunBatched(absl::Span<const BitsMap> inputs) const {
   return outputs;
 }
 
+absl::StatusOr<std::unique_ptr<CompiledBatchSimulator>>
+ModuleSimulator::CompileBatchSimulator(int64_t max_batch_size) const {
+  XLS_RET_CHECK_GT(max_batch_size, 0);
+  XLS_ASSIGN_OR_RETURN(TempDirectory data_dir, TempDirectory::Create());
+  XLS_ASSIGN_OR_RETURN(
+      std::string testbench,
+      GenerateBatchTestbench(signature_, max_batch_size, data_dir.path()));
+  XLS_VLOG(2) << "Batch testbench:\n" << testbench;
+  auto batch_simulator = absl::WrapUnique(
+      new CompiledBatchSimulator(signature_, max_batch_size,
+                                 std::move(data_dir)));
+  XLS_ASSIGN_OR_RETURN(
+      batch_simulator->simulation_,
+      simulator_->Compile(absl::StrCat(verilog_text_, "\n", testbench),
+                          file_type_, includes_));
+  return batch_simulator;
+}
+
+absl::StatusOr<std::vector<ModuleSimulator::BitsMap>>
+CompiledBatchSimulator::Run(
+    absl::Span<const ModuleSimulator::BitsMap> inputs) const {
+  std::vector<ModuleSimulator::BitsMap> outputs;
+  outputs.reserve(inputs.size());
+  for (int64_t begin = 0; begin < inputs.size(); begin += max_batch_size_) {
+    XLS_ASSIGN_OR_RETURN(
+        std::vector<ModuleSimulator::BitsMap> batch_outputs,
+        RunBatch(inputs.subspan(begin, max_batch_size_)));
+    std::move(batch_outputs.begin(), batch_outputs.end(),
+              std::back_inserter(outputs));
+  }
+  return outputs;
+}
+
+absl::StatusOr<std::vector<Value>> CompiledBatchSimulator::Run(
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs) const {
+  XLS_RET_CHECK_EQ(signature_.data_outputs().size(), 1);
+  std::vector<ModuleSimulator::BitsMap> bits_inputs;
+  bits_inputs.reserve(inputs.size());
+  for (const auto& input : inputs) {
+    XLS_RETURN_IF_ERROR(signature_.ValidateInputs(input));
+    bits_inputs.push_back(ValueMapToBitsMap(input));
+  }
+  XLS_ASSIGN_OR_RETURN(std::vector<ModuleSimulator::BitsMap> bits_outputs,
+                       Run(bits_inputs));
+  const PortProto& output_port = signature_.data_outputs().front();
+  std::vector<Value> outputs;
+  outputs.reserve(bits_outputs.size());
+  for (const ModuleSimulator::BitsMap& bits_output : bits_outputs) {
+    XLS_ASSIGN_OR_RETURN(
+        Value output, UnflattenBitsToValue(bits_output.at(output_port.name()),
+                                           output_port.type()));
+    outputs.push_back(std::move(output));
+  }
+  return outputs;
+}
+
+absl::StatusOr<std::vector<ModuleSimulator::BitsMap>>
+CompiledBatchSimulator::RunBatch(
+    absl::Span<const ModuleSimulator::BitsMap> inputs) const {
+  std::vector<PortProto> input_ports =
+      NonZeroWidthPorts(signature_.data_inputs());
+  std::vector<PortProto> output_ports =
+      NonZeroWidthPorts(signature_.data_outputs());
+
+  std::string inputs_text;
+  for (const ModuleSimulator::BitsMap& input : inputs) {
+    XLS_RETURN_IF_ERROR(signature_.ValidateInputs(input));
+    std::vector<Bits> values;
+    for (const PortProto& port : input_ports) {
+      values.push_back(input.at(port.name()));
+    }
+    absl::StrAppend(&inputs_text,
+                    BitsToRawDigits(bits_ops::Concat(values),
+                                    FormatPreference::kPlainHex),
+                    "\n");
+  }
+
+  std::pair<std::string, std::string> stdout_stderr;
+  {
+    absl::MutexLock lock(&mutex_);
+    XLS_RETURN_IF_ERROR(SetFileContents(
+        data_dir_.path() / kBatchCountFileName,
+        absl::StrFormat("%x\n", inputs.size())));
+    if (!input_ports.empty()) {
+      XLS_RETURN_IF_ERROR(SetFileContents(
+          data_dir_.path() / kBatchInputsFileName, inputs_text));
+    }
+    XLS_ASSIGN_OR_RETURN(stdout_stderr, simulation_->Run());
+  }
+
+  int64_t output_width = TotalWidth(output_ports);
+  std::vector<ModuleSimulator::BitsMap> outputs;
+  outputs.reserve(inputs.size());
+  for (std::string_view line : absl::StrSplit(stdout_stderr.first, '\n')) {
+    if (!absl::ConsumePrefix(&line, kBatchOutputPrefix)) {
+      continue;
+    }
+    line = absl::StripAsciiWhitespace(line);
+    Bits concat_value;
+    if (output_width > 0) {
+      XLS_ASSIGN_OR_RETURN(
+          concat_value,
+          ParseUnsignedNumberWithoutPrefix(line, FormatPreference::kHex,
+                                           output_width),
+          _ << "Unable to parse simulation output \"" << line << "\"");
+    }
+    ModuleSimulator::BitsMap& output = outputs.emplace_back();
+    int64_t lsb = output_width;
+    for (const PortProto& port : signature_.data_outputs()) {
+      if (port.width() == 0) {
+        output[port.name()] = Bits();
+        continue;
+      }
+      lsb -= port.width();
+      output[port.name()] = concat_value.Slice(lsb, port.width());
+    }
+  }
+  if (outputs.size() != inputs.size()) {
+    return absl::InternalError(absl::StrFormat(
+        "Expected %d outputs from batch simulation, got %d:\n%s",
+        inputs.size(), outputs.size(), stdout_stderr.second));
+  }
+  return outputs;
+}
+
 absl::StatusOr<Value> ModuleSimulator::RunFunction(
     const absl::flat_hash_map<std::string, Value>& inputs) const {
   absl::flat_hash_map<std::string, Value> input_map(inputs.begin(),
@@ -15,16 +15,20 @@
 #ifndef XLS_SIMULATION_MODULE_SIMULATOR_H_
 #define XLS_SIMULATION_MODULE_SIMULATOR_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/vast.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/ir/value.h"
 #include "xls/simulation/module_testbench.h"
 #include "xls/simulation/verilog_simulator.h"
@@ -70,6 +74,8 @@ struct ReadyValidHoldoffs {
   absl::flat_hash_map<std::string, std::vector<int64_t>> ready_holdoffs;
 };
 
+class CompiledBatchSimulator;
+
 // Abstraction for simulating a module described by a SignatureProto using a
 // testbench run under the Verilog simulator.
 class ModuleSimulator {
@@ -105,6 +111,15 @@ class ModuleSimulator {
   absl::StatusOr<std::vector<BitsMap>> RunBatched(
       absl::Span<const BitsMap> inputs) const;
 
+  // Generates and compiles a testbench for the (function) module which reads
+  // its input vectors from a file, so that any number of batches of up to
+  // "max_batch_size" inputs can then be run through the module without
+  // regenerating or recompiling the testbench. Supports combinational,
+  // fixed-latency, and pipelined interfaces; pipelined modules are issued one
+  // input per cycle.
+  absl::StatusOr<std::unique_ptr<CompiledBatchSimulator>> CompileBatchSimulator(
+      int64_t max_batch_size) const;
+
   // Overloads which accept Values rather than Bits.
   absl::StatusOr<Value> RunFunction(
       const absl::flat_hash_map<std::string, Value>& inputs) const;
@@ -160,6 +175,50 @@ class ModuleSimulator {
   absl::Span<const VerilogInclude> includes_;
 };
 
+// A testbench compiled once for a function module, created by
+// ModuleSimulator::CompileBatchSimulator. Each batch of inputs is written to a
+// file which the testbench loads with $readmemh, and the outputs are read back
+// from the simulation output, so running a batch only costs the simulation
+// itself. Modules with a pipeline interface are fed a new input every cycle
+// and their outputs are collected `latency` cycles later, so a batch of N
+// inputs takes about N + latency cycles. For other interfaces inputs are
+// applied one at a time and held until their outputs are captured.
+class CompiledBatchSimulator {
+ public:
+  // Runs the given inputs through the module, in batches of at most
+  // max_batch_size() inputs, and returns the outputs in order.
+  absl::StatusOr<std::vector<ModuleSimulator::BitsMap>> Run(
+      absl::Span<const ModuleSimulator::BitsMap> inputs) const;
+
+  // Overload which accepts Values rather than Bits. The module must have a
+  // single data output.
+  absl::StatusOr<std::vector<Value>> Run(
+      absl::Span<const absl::flat_hash_map<std::string, Value>> inputs) const;
+
+  int64_t max_batch_size() const { return max_batch_size_; }
+
+ private:
+  friend class ModuleSimulator;
+
+  CompiledBatchSimulator(const ModuleSignature& signature,
+                         int64_t max_batch_size, TempDirectory data_dir)
+      : signature_(signature),
+        max_batch_size_(max_batch_size),
+        data_dir_(std::move(data_dir)) {}
+
+  // Runs a single batch of at most max_batch_size_ inputs.
+  absl::StatusOr<std::vector<ModuleSimulator::BitsMap>> RunBatch(
+      absl::Span<const ModuleSimulator::BitsMap> inputs) const;
+
+  ModuleSignature signature_;
+  int64_t max_batch_size_;
+  // Holds the files through which batches are passed to the testbench. Runs
+  // are serialized as they share these files.
+  TempDirectory data_dir_;
+  std::unique_ptr<CompiledVerilogSimulation> simulation_;
+  mutable absl::Mutex mutex_;
+};
+
 }  // namespace verilog
 }  // namespace xls
 
@@ -14,6 +14,8 @@
 
 #include "xls/simulation/module_simulator.h"
 
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
@@ -21,12 +23,14 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/value.h"
 #include "xls/simulation/verilog_test_base.h"
 
 namespace xls {
@@ -332,6 +336,123 @@ TEST_P(ModuleSimulatorTest, CombinationalBatched) {
   EXPECT_THAT(outputs[2], ElementsAre(Pair("out", UBits(100, 8))));
 }
 
+TEST_P(ModuleSimulatorTest, FixedLatencyCompiledBatch) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto verilog_signature, MakeFixedLatencyModule());
+  ModuleSimulator simulator =
+      NewModuleSimulator(verilog_signature.first, verilog_signature.second);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledBatchSimulator> batch,
+                           simulator.CompileBatchSimulator(
+                               /*max_batch_size=*/2));
+
+  // Three inputs are split into two batches.
+  using BitsMap = ModuleSimulator::BitsMap;
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<BitsMap> outputs,
+                           batch->Run({BitsMap{{"x", UBits(44, 8)}},
+                                       BitsMap{{"x", UBits(123, 8)}},
+                                       BitsMap{{"x", UBits(7, 8)}}}));
+  EXPECT_EQ(outputs.size(), 3);
+  EXPECT_THAT(outputs[0], ElementsAre(Pair("out", UBits(88, 8))));
+  EXPECT_THAT(outputs[1], ElementsAre(Pair("out", UBits(246, 8))));
+  EXPECT_THAT(outputs[2], ElementsAre(Pair("out", UBits(14, 8))));
+
+  // The compiled simulation can be rerun with new inputs.
+  XLS_ASSERT_OK_AND_ASSIGN(outputs, batch->Run({BitsMap{{"x", UBits(1, 8)}}}));
+  EXPECT_EQ(outputs.size(), 1);
+  EXPECT_THAT(outputs[0], ElementsAre(Pair("out", UBits(2, 8))));
+}
+
+TEST_P(ModuleSimulatorTest, CombinationalCompiledBatch) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto verilog_signature, MakeCombinationalModule());
+  ModuleSimulator simulator =
+      NewModuleSimulator(verilog_signature.first, verilog_signature.second);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledBatchSimulator> batch,
+                           simulator.CompileBatchSimulator(
+                               /*max_batch_size=*/16));
+
+  using BitsMap = ModuleSimulator::BitsMap;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<BitsMap> outputs,
+      batch->Run({BitsMap{{"x", UBits(99, 8)}, {"y", UBits(12, 8)}},
+                  BitsMap{{"x", UBits(100, 8)}, {"y", UBits(25, 8)}},
+                  BitsMap{{"x", UBits(255, 8)}, {"y", UBits(155, 8)}}}));
+  EXPECT_EQ(outputs.size(), 3);
+  EXPECT_THAT(outputs[0], ElementsAre(Pair("out", UBits(87, 8))));
+  EXPECT_THAT(outputs[1], ElementsAre(Pair("out", UBits(75, 8))));
+  EXPECT_THAT(outputs[2], ElementsAre(Pair("out", UBits(100, 8))));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<Value> values,
+      batch->Run({absl::flat_hash_map<std::string, Value>{
+          {"x", Value(UBits(10, 8))}, {"y", Value(UBits(3, 8))}}}));
+  EXPECT_THAT(values, ElementsAre(Value(UBits(7, 8))));
+}
+
+TEST_P(ModuleSimulatorTest, PipelinedCompiledBatch) {
+  const std::string text = R"(
+module pipeline_2(
+  input wire clk,
+  input wire rst,
+  input wire in_valid,
+  input wire [7:0] x,
+  output wire out_valid,
+  output wire [7:0] out
+);
+  reg [7:0] p0;
+  reg [7:0] p1;
+  reg p0_valid;
+  reg p1_valid;
+  always @ (posedge clk) begin
+    if (rst) begin
+      p0_valid <= 0;
+      p1_valid <= 0;
+    end else begin
+      p0_valid <= in_valid;
+      p1_valid <= p0_valid;
+    end
+    p0 <= x + 8'd1;
+    p1 <= p0 + p0;
+  end
+  assign out = p1;
+  assign out_valid = p1_valid;
+endmodule
+)";
+  PipelineControl pipeline_control;
+  pipeline_control.mutable_valid()->set_input_name("in_valid");
+  pipeline_control.mutable_valid()->set_output_name("out_valid");
+  ModuleSignatureBuilder b("pipeline_2");
+  b.WithClock("clk");
+  b.WithReset("rst", /*asynchronous=*/false, /*active_low=*/false);
+  b.WithPipelineInterface(/*latency=*/2, /*initiation_interval=*/1,
+                          pipeline_control);
+  b.AddDataInputAsBits("x", 8);
+  b.AddDataOutputAsBits("out", 8);
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleSignature signature, b.Build());
+
+  ModuleSimulator simulator = NewModuleSimulator(text, signature);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledBatchSimulator> batch,
+                           simulator.CompileBatchSimulator(
+                               /*max_batch_size=*/4));
+
+  // Inputs are issued back to back so consecutive outputs must not be mixed
+  // up. Six inputs are split into two batches.
+  using BitsMap = ModuleSimulator::BitsMap;
+  std::vector<BitsMap> inputs;
+  for (int64_t i = 0; i < 6; ++i) {
+    inputs.push_back(BitsMap{{"x", UBits(10 * i, 8)}});
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<BitsMap> outputs, batch->Run(inputs));
+  ASSERT_EQ(outputs.size(), 6);
+  for (int64_t i = 0; i < 6; ++i) {
+    EXPECT_THAT(outputs[i],
+                ElementsAre(Pair("out", UBits(2 * (10 * i + 1), 8))));
+  }
+
+  // The results match the step-by-step testbench.
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<BitsMap> expected,
+                           simulator.RunBatched(inputs));
+  EXPECT_EQ(outputs, expected);
+}
+
 TEST_P(ModuleSimulatorTest, MultipleOutputs) {
   const std::string text = R"(
 module delay_3(
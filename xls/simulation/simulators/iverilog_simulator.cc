@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <filesystem>  // NOLINT
+#include <memory>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -71,6 +73,23 @@ absl::StatusOr<std::pair<std::string, std::string>> InvokeVvp(
       SubprocessErrorAsStatus(InvokeSubprocess(args_vec)));
 }
 
+// A testbench compiled by iverilog into a vvp program. The temporary directory
+// holding the program lives as long as the simulation.
+class IcarusVerilogCompiledSimulation : public CompiledVerilogSimulation {
+ public:
+  IcarusVerilogCompiledSimulation(TempDirectory temp_dir,
+                                  std::filesystem::path vvp_path)
+      : temp_dir_(std::move(temp_dir)), vvp_path_(std::move(vvp_path)) {}
+
+  absl::StatusOr<std::pair<std::string, std::string>> Run() const override {
+    return InvokeVvp({vvp_path_.string()});
+  }
+
+ private:
+  TempDirectory temp_dir_;
+  std::filesystem::path vvp_path_;
+};
+
 class IcarusVerilogSimulator : public VerilogSimulator {
  public:
   absl::StatusOr<std::pair<std::string, std::string>> Run(
@@ -122,6 +141,29 @@ class IcarusVerilogSimulator : public VerilogSimulator {
 
     return absl::OkStatus();
   }
+
+  absl::StatusOr<std::unique_ptr<CompiledVerilogSimulation>> Compile(
+      std::string_view text, FileType file_type,
+      absl::Span<const VerilogInclude> includes) const override {
+    if (file_type == FileType::kSystemVerilog) {
+      return absl::UnimplementedError(
+          "iverilog does not support SystemVerilog");
+    }
+    XLS_ASSIGN_OR_RETURN(TempDirectory temp_top, TempDirectory::Create());
+    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(temp_top.path()));
+    std::filesystem::path temp_dir = temp_top.path();
+
+    std::string top_v_path = temp_dir / GetTopFileName(file_type);
+    XLS_RETURN_IF_ERROR(SetFileContents(top_v_path, text));
+    std::filesystem::path vvp_path = temp_dir / "top.vvp";
+
+    XLS_RETURN_IF_ERROR(SetUpIncludes(temp_dir, includes));
+    XLS_RETURN_IF_ERROR(InvokeIverilog({top_v_path, "-o", vvp_path.string(),
+                                        "-I", temp_dir.string()})
+                            .status());
+    return std::make_unique<IcarusVerilogCompiledSimulation>(
+        std::move(temp_top), std::move(vvp_path));
+  }
 };
 
 XLS_REGISTER_MODULE_INITIALIZER(iverilog_simulator, {
@@ -0,0 +1,267 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/flags/flag.h"
+#include "absl/hash/hash.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/module_initializer.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/subprocess.h"
+#include "xls/simulation/verilog_simulator.h"
+#include "xls/tools/verilog_include.h"
+
+ABSL_FLAG(std::string, verilator_path, "verilator",
+          "Path of the Verilator executable used by the \"verilator\" Verilog "
+          "simulator. A name without a slash is looked up in the directories "
+          "listed in the PATH environment variable; a relative path is "
+          "resolved against the current working directory.");
+ABSL_FLAG(int64_t, verilator_model_cache_size, 32,
+          "Maximum number of compiled Verilator models kept in memory for "
+          "reuse by later simulations of identical Verilog.");
+
+namespace xls {
+namespace verilog {
+namespace {
+
+// Name of the executable produced by Verilator inside its object directory.
+constexpr std::string_view kModelBinaryName = "Vtop";
+
+static absl::Status SetUpIncludes(const std::filesystem::path& temp_dir,
+                                  absl::Span<const VerilogInclude> includes) {
+  for (const VerilogInclude& include : includes) {
+    std::filesystem::path path = temp_dir / include.relative_path;
+    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(path.parent_path()));
+    XLS_RETURN_IF_ERROR(SetFileContents(path, include.verilog_text));
+  }
+  return absl::OkStatus();
+}
+
+// Writes the top file and the includes into `temp_dir` and returns the path of
+// the top file.
+absl::StatusOr<std::filesystem::path> SetUpSources(
+    const std::filesystem::path& temp_dir, std::string_view text,
+    std::string_view top_file_name,
+    absl::Span<const VerilogInclude> includes) {
+  std::filesystem::path top_path = temp_dir / top_file_name;
+  XLS_RETURN_IF_ERROR(SetFileContents(top_path, text));
+  XLS_RETURN_IF_ERROR(SetUpIncludes(temp_dir, includes));
+  return top_path;
+}
+
+// Returns the absolute path of the Verilator executable named by
+// --verilator_path. InvokeSubprocess does not search PATH and runs Verilator
+// in a temporary directory, so the path must be resolved up front.
+absl::StatusOr<std::filesystem::path> ResolveVerilatorPath() {
+  std::string verilator_path = absl::GetFlag(FLAGS_verilator_path);
+  if (verilator_path.find('/') != std::string::npos) {
+    return std::filesystem::absolute(verilator_path);
+  }
+  const char* path_env = std::getenv("PATH");
+  if (path_env != nullptr) {
+    for (std::string_view dir : absl::StrSplit(path_env, ':')) {
+      std::filesystem::path candidate =
+          std::filesystem::absolute(dir.empty() ? "." : dir) / verilator_path;
+      if (FileExists(candidate).ok()) {
+        absl::StatusOr<bool> executable = FileIsExecutable(candidate);
+        if (executable.ok() && *executable) {
+          return candidate;
+        }
+      }
+    }
+  }
+  return absl::NotFoundError(
+      absl::StrCat("Verilator executable `", verilator_path,
+                   "` not found in PATH; set --verilator_path."));
+}
+
+absl::StatusOr<std::pair<std::string, std::string>> InvokeVerilator(
+    const std::filesystem::path& temp_dir,
+    absl::Span<const std::string> args) {
+  XLS_ASSIGN_OR_RETURN(std::filesystem::path verilator_path,
+                       ResolveVerilatorPath());
+  std::vector<std::string> args_vec;
+  args_vec.push_back(verilator_path.string());
+  // The generated Verilog is not lint clean by Verilator's standards (unused
+  // signals, width extensions etc.) which is fine for simulation purposes.
+  args_vec.push_back("-Wno-fatal");
+  args_vec.push_back("-Wno-lint");
+  args_vec.push_back("-Wno-style");
+  args_vec.push_back(absl::StrCat("-I", temp_dir.string()));
+  args_vec.insert(args_vec.end(), args.begin(), args.end());
+  return SubprocessResultToStrings(
+      SubprocessErrorAsStatus(InvokeSubprocess(args_vec, temp_dir)));
+}
+
+// A Verilog testbench compiled by Verilator into a native executable. Models
+// are shared between all simulations of the same source.
+struct VerilatorModel {
+  // Everything the model was built from; used to rule out hash collisions.
+  std::string source_key;
+  TempDirectory temp_dir;
+  std::filesystem::path binary_path;
+};
+
+class VerilatorCompiledSimulation : public CompiledVerilogSimulation {
+ public:
+  explicit VerilatorCompiledSimulation(
+      std::shared_ptr<const VerilatorModel> model)
+      : model_(std::move(model)) {}
+
+  absl::StatusOr<std::pair<std::string, std::string>> Run() const override {
+    return SubprocessResultToStrings(SubprocessErrorAsStatus(
+        InvokeSubprocess({model_->binary_path.string()},
+                         model_->temp_dir.path())));
+  }
+
+ private:
+  std::shared_ptr<const VerilatorModel> model_;
+};
+
+// Verilog simulator which compiles the testbench with Verilator into a
+// cycle-accurate native model. Compilation is expensive (it runs a C++
+// compiler) but the resulting simulation is orders of magnitude faster than
+// an interpreted simulator on large designs. Compiled models are cached in
+// memory keyed on a hash of the Verilog source and its includes, so repeated
+// simulations of the same text only pay for compilation once.
+//
+// Testbench delays (`#10`) and event controls require Verilator 5 or later
+// (`--timing`).
+class VerilatorSimulator : public VerilogSimulator {
+ public:
+  absl::StatusOr<std::pair<std::string, std::string>> Run(
+      std::string_view text, FileType file_type,
+      absl::Span<const VerilogInclude> includes) const override {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<CompiledVerilogSimulation> simulation,
+                         Compile(text, file_type, includes));
+    return simulation->Run();
+  }
+
+  absl::Status RunSyntaxChecking(
+      std::string_view text, FileType file_type,
+      absl::Span<const VerilogInclude> includes) const override {
+    XLS_ASSIGN_OR_RETURN(TempDirectory temp_top, TempDirectory::Create());
+    std::filesystem::path temp_dir = temp_top.path();
+    XLS_ASSIGN_OR_RETURN(
+        std::filesystem::path top_path,
+        SetUpSources(temp_dir, text, GetTopFileName(file_type), includes));
+    return InvokeVerilator(temp_dir, {"--lint-only", "--timing",
+                                      top_path.string()})
+        .status();
+  }
+
+  absl::StatusOr<std::unique_ptr<CompiledVerilogSimulation>> Compile(
+      std::string_view text, FileType file_type,
+      absl::Span<const VerilogInclude> includes) const override {
+    std::string source_key = SourceKey(text, file_type, includes);
+    uint64_t hash = absl::HashOf(source_key);
+    {
+      absl::MutexLock lock(&mutex_);
+      auto it = models_.find(hash);
+      if (it != models_.end() && it->second->source_key == source_key) {
+        return std::make_unique<VerilatorCompiledSimulation>(it->second);
+      }
+    }
+
+    // Build outside of the lock; concurrent compilations of the same source
+    // are harmless, the last one to finish replaces the others in the cache.
+    XLS_ASSIGN_OR_RETURN(
+        std::shared_ptr<const VerilatorModel> model,
+        BuildModel(std::move(source_key), text, file_type, includes));
+    absl::MutexLock lock(&mutex_);
+    if (!models_.contains(hash)) {
+      insertion_order_.push_back(hash);
+    }
+    models_[hash] = model;
+    while (!insertion_order_.empty() &&
+           static_cast<int64_t>(insertion_order_.size()) >
+               absl::GetFlag(FLAGS_verilator_model_cache_size)) {
+      models_.erase(insertion_order_.front());
+      insertion_order_.pop_front();
+    }
+    return std::make_unique<VerilatorCompiledSimulation>(std::move(model));
+  }
+
+ private:
+  // Returns a string which uniquely identifies the model built from the given
+  // sources.
+  static std::string SourceKey(std::string_view text, FileType file_type,
+                               absl::Span<const VerilogInclude> includes) {
+    std::string key =
+        absl::StrCat(file_type == FileType::kSystemVerilog ? "sv" : "v", ":",
+                     text.size(), ":", text);
+    for (const VerilogInclude& include : includes) {
+      std::string path = include.relative_path.string();
+      absl::StrAppend(&key, ";", path.size(), ":", path, ":",
+                      include.verilog_text.size(), ":", include.verilog_text);
+    }
+    return key;
+  }
+
+  absl::StatusOr<std::shared_ptr<const VerilatorModel>> BuildModel(
+      std::string source_key, std::string_view text, FileType file_type,
+      absl::Span<const VerilogInclude> includes) const {
+    XLS_ASSIGN_OR_RETURN(TempDirectory temp_top, TempDirectory::Create());
+    std::filesystem::path temp_dir = temp_top.path();
+    XLS_ASSIGN_OR_RETURN(
+        std::filesystem::path top_path,
+        SetUpSources(temp_dir, text, GetTopFileName(file_type), includes));
+    std::filesystem::path obj_dir = temp_dir / "obj_dir";
+    XLS_RETURN_IF_ERROR(
+        InvokeVerilator(temp_dir, {"--binary", "--timing", "-j", "0", "--Mdir",
+                                   obj_dir.string(), "-o",
+                                   std::string(kModelBinaryName),
+                                   top_path.string()})
+            .status());
+    std::filesystem::path binary_path = obj_dir / kModelBinaryName;
+    XLS_RETURN_IF_ERROR(FileExists(binary_path));
+    return std::make_shared<const VerilatorModel>(
+        VerilatorModel{.source_key = std::move(source_key),
+                       .temp_dir = std::move(temp_top),
+                       .binary_path = std::move(binary_path)});
+  }
+
+  mutable absl::Mutex mutex_;
+  mutable absl::flat_hash_map<uint64_t, std::shared_ptr<const VerilatorModel>>
+      models_ ABSL_GUARDED_BY(mutex_);
+  // Keys of `models_` from oldest to newest, for eviction.
+  mutable std::deque<uint64_t> insertion_order_ ABSL_GUARDED_BY(mutex_);
+};
+
+XLS_REGISTER_MODULE_INITIALIZER(verilator_simulator, {
+  XLS_CHECK_OK(GetVerilogSimulatorManagerSingleton().RegisterVerilogSimulator(
+      "verilator", std::make_unique<VerilatorSimulator>()));
+});
+
+}  // namespace
+}  // namespace verilog
+}  // namespace xls
@@ -90,6 +90,28 @@ absl::StatusOr<std::vector<Observation>> StdoutToObservations(
   return result;
 }
 
+// A compiled simulation which simply reruns the simulator on the full text.
+class RecompilingSimulation : public CompiledVerilogSimulation {
+ public:
+  RecompilingSimulation(const VerilogSimulator* simulator,
+                        std::string_view text, FileType file_type,
+                        absl::Span<const VerilogInclude> includes)
+      : simulator_(simulator),
+        text_(text),
+        file_type_(file_type),
+        includes_(includes.begin(), includes.end()) {}
+
+  absl::StatusOr<std::pair<std::string, std::string>> Run() const override {
+    return simulator_->Run(text_, file_type_, includes_);
+  }
+
+ private:
+  const VerilogSimulator* simulator_;
+  std::string text_;
+  FileType file_type_;
+  std::vector<VerilogInclude> includes_;
+};
+
 }  // namespace
 
 absl::StatusOr<std::pair<std::string, std::string>> VerilogSimulator::Run(
@@ -102,6 +124,13 @@ absl::Status VerilogSimulator::RunSyntaxChecking(std::string_view text,
   return RunSyntaxChecking(text, file_type, /*includes=*/{});
 }
 
+absl::StatusOr<std::unique_ptr<CompiledVerilogSimulation>>
+VerilogSimulator::Compile(std::string_view text, FileType file_type,
+                          absl::Span<const VerilogInclude> includes) const {
+  return std::make_unique<RecompilingSimulation>(this, text, file_type,
+                                                 includes);
+}
+
 absl::StatusOr<std::vector<Observation>>
 VerilogSimulator::SimulateCombinational(
     std::string_view text, FileType file_type,
@@ -40,6 +40,17 @@ struct Observation {
   Bits value;
 };
 
+// A simulation compiled by a VerilogSimulator which can be run any number of
+// times without recompiling. Runs differ only in the contents of the files the
+// simulation reads, e.g., with $readmemh.
+class CompiledVerilogSimulation {
+ public:
+  virtual ~CompiledVerilogSimulation() = default;
+
+  // Runs the simulation and returns the stdout/stderr as a string pair.
+  virtual absl::StatusOr<std::pair<std::string, std::string>> Run() const = 0;
+};
+
 // Interface wrapping a Verilog simulator such Icarus verilog.
 class VerilogSimulator {
  public:
@@ -60,6 +71,14 @@ class VerilogSimulator {
   absl::Status RunSyntaxChecking(std::string_view text,
                                  FileType file_type) const;
 
+  // Compiles the given Verilog text into a simulation which can be run
+  // repeatedly. The default implementation compiles the text anew on every
+  // run; simulators with a separate compilation step should override it so
+  // that only the simulation itself is repeated.
+  virtual absl::StatusOr<std::unique_ptr<CompiledVerilogSimulation>> Compile(
+      std::string_view text, FileType file_type,
+      absl::Span<const VerilogInclude> includes) const;
+
   // Simulation runner harness: runs the given Verilog text using the verilog
   // simulator infrastructure and returns observations of data values that arose
   // during simulation.
@@ -0,0 +1,394 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/smtlib_emitter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/node.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+
+namespace xls {
+namespace solvers {
+namespace {
+
+std::string BitVecSort(int64_t width) {
+  return absl::StrFormat("(_ BitVec %d)", width);
+}
+
+// Returns the SMT-LIB binary literal for `bits`.
+std::string BitsLiteral(const Bits& bits) {
+  std::string result = "#b";
+  for (int64_t i = bits.bit_count() - 1; i >= 0; --i) {
+    result.push_back(bits.Get(i) ? '1' : '0');
+  }
+  return result;
+}
+
+std::string UnsignedLiteral(uint64_t value, int64_t width) {
+  return BitsLiteral(UBits(value, width));
+}
+
+// Converts a boolean term into a bits[1] term.
+std::string BoolToBit(std::string_view term) {
+  return absl::StrCat("(ite ", term, " #b1 #b0)");
+}
+
+// Zero- or sign-extends or truncates `term` of width `from` to width `to`.
+std::string Resize(std::string term, int64_t from, int64_t to,
+                   bool is_signed) {
+  if (from == to) {
+    return term;
+  }
+  if (from > to) {
+    return absl::StrFormat("((_ extract %d 0) %s)", to - 1, term);
+  }
+  return absl::StrFormat("((_ %s %d) %s)",
+                         is_signed ? "sign_extend" : "zero_extend", to - from,
+                         term);
+}
+
+class SmtLibEmitter {
+ public:
+  SmtLibEmitter(Function* function, std::ostream& os, int64_t max_inline_depth)
+      : function_(function), os_(os), max_inline_depth_(max_inline_depth) {}
+
+  absl::Status Run() {
+    for (Node* node : TopoSort(function_)) {
+      if (!node->GetType()->IsBits() || node->BitCountOrDie() == 0) {
+        return absl::UnimplementedError(absl::StrFormat(
+            "SMT-LIB emission supports only non-empty bits types: %s",
+            node->ToString()));
+      }
+      if (node->Is<Param>()) {
+        os_ << absl::StreamFormat("(declare-const %s %s)\n", node->GetName(),
+                                  BitVecSort(node->BitCountOrDie()));
+        if (node == function_->return_value()) {
+          os_ << absl::StreamFormat("(define-fun %s () %s %s)\n",
+                                    function_->name(),
+                                    BitVecSort(node->BitCountOrDie()),
+                                    node->GetName());
+        }
+        continue;
+      }
+      int64_t depth = 0;
+      for (Node* operand : node->operands()) {
+        auto it = inlined_.find(operand);
+        if (it != inlined_.end()) {
+          depth = std::max(depth, it->second.depth + 1);
+        }
+      }
+      XLS_ASSIGN_OR_RETURN(std::string term, Translate(node));
+      if (node != function_->return_value() && IsSingleUse(node) &&
+          depth < max_inline_depth_) {
+        inlined_[node] = Inlined{std::move(term), depth};
+        continue;
+      }
+      os_ << absl::StreamFormat(
+          "(define-fun %s () %s %s)\n",
+          node == function_->return_value() ? function_->name()
+                                            : node->GetName(),
+          BitVecSort(node->BitCountOrDie()), term);
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  // A term waiting to be inlined into the single user of its node.
+  struct Inlined {
+    std::string term;
+    int64_t depth;
+  };
+
+  // Returns true if the term of `node` may reference one of its operands more
+  // than once, in which case its operands are not inlined.
+  static bool MayRepeatOperands(Node* node) {
+    switch (node->op()) {
+      case Op::kSel:
+      case Op::kOneHotSel:
+      case Op::kPrioritySel:
+      case Op::kShll:
+      case Op::kShrl:
+      case Op::kShra:
+      case Op::kXorReduce:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  static bool IsSingleUse(Node* node) {
+    if (node->users().size() != 1) {
+      return false;
+    }
+    Node* user = *node->users().begin();
+    return user->OperandInstanceCount(node) == 1 && !MayRepeatOperands(user);
+  }
+
+  // Returns the term referring to `node`. An inlined term is consumed.
+  std::string Term(Node* node) {
+    auto it = inlined_.find(node);
+    if (it == inlined_.end()) {
+      return node->GetName();
+    }
+    std::string term = std::move(it->second.term);
+    inlined_.erase(it);
+    return term;
+  }
+
+  std::string Operand(Node* node, int64_t i) {
+    return Term(node->operand(i));
+  }
+
+  int64_t OperandWidth(Node* node, int64_t i) {
+    return node->operand(i)->BitCountOrDie();
+  }
+
+  // Applies the n-ary SMT-LIB function `op` to the operands of `node`.
+  std::string Nary(Node* node, std::string_view op) {
+    if (node->operand_count() == 1) {
+      return Operand(node, 0);
+    }
+    std::vector<std::string> operands;
+    for (int64_t i = 0; i < node->operand_count(); ++i) {
+      operands.push_back(Operand(node, i));
+    }
+    return absl::StrCat("(", op, " ", absl::StrJoin(operands, " "), ")");
+  }
+
+  std::string Binary(Node* node, std::string_view op) {
+    std::string lhs = Operand(node, 0);
+    std::string rhs = Operand(node, 1);
+    return absl::StrCat("(", op, " ", lhs, " ", rhs, ")");
+  }
+
+  // Shifts in XLS allow any amount width; SMT-LIB requires equal widths.
+  std::string Shift(Node* node, std::string_view op) {
+    int64_t width = node->BitCountOrDie();
+    int64_t amount_width = OperandWidth(node, 1);
+    std::string value = Operand(node, 0);
+    std::string amount = Operand(node, 1);
+    if (amount_width <= width) {
+      return absl::StrFormat("(%s %s %s)", op, value,
+                             Resize(amount, amount_width, width, false));
+    }
+    // Amounts too wide to truncate must be checked for overflow. Shifting by
+    // at least the width gives zero, or copies of the sign bit for shra.
+    std::string overflow_value =
+        op == "bvashr"
+            ? absl::StrFormat("(bvashr %s %s)", value,
+                              UnsignedLiteral(width - 1, width))
+            : UnsignedLiteral(0, width);
+    return absl::StrFormat(
+        "(ite (bvuge %s %s) %s (%s %s ((_ extract %d 0) %s)))", amount,
+        UnsignedLiteral(width, amount_width), overflow_value, op, value,
+        width - 1, amount);
+  }
+
+  std::string Compare(Node* node, std::string_view op) {
+    return BoolToBit(Binary(node, op));
+  }
+
+  std::string Multiply(Node* node, bool is_signed) {
+    int64_t width = node->BitCountOrDie();
+    std::string lhs =
+        Resize(Operand(node, 0), OperandWidth(node, 0), width, is_signed);
+    std::string rhs =
+        Resize(Operand(node, 1), OperandWidth(node, 1), width, is_signed);
+    return absl::StrFormat("(bvmul %s %s)", lhs, rhs);
+  }
+
+  absl::StatusOr<std::string> Translate(Node* node) {
+    int64_t width = node->BitCountOrDie();
+    switch (node->op()) {
+      case Op::kLiteral:
+        return BitsLiteral(node->As<Literal>()->value().bits());
+      case Op::kIdentity:
+        return Operand(node, 0);
+      case Op::kNot:
+        return absl::StrCat("(bvnot ", Operand(node, 0), ")");
+      case Op::kNeg:
+        return absl::StrCat("(bvneg ", Operand(node, 0), ")");
+      case Op::kAnd:
+        return Nary(node, "bvand");
+      case Op::kOr:
+        return Nary(node, "bvor");
+      case Op::kXor:
+        return Nary(node, "bvxor");
+      case Op::kNand:
+        return absl::StrCat("(bvnot ", Nary(node, "bvand"), ")");
+      case Op::kNor:
+        return absl::StrCat("(bvnot ", Nary(node, "bvor"), ")");
+      case Op::kAdd:
+        return Binary(node, "bvadd");
+      case Op::kSub:
+        return Binary(node, "bvsub");
+      case Op::kUMul:
+        return Multiply(node, /*is_signed=*/false);
+      case Op::kSMul:
+        return Multiply(node, /*is_signed=*/true);
+      case Op::kUDiv:
+        // Like XLS, SMT-LIB defines unsigned division by zero as all ones.
+        return Binary(node, "bvudiv");
+      case Op::kEq:
+        return Compare(node, "=");
+      case Op::kNe:
+        return BoolToBit(absl::StrCat("(not ", Binary(node, "="), ")"));
+      case Op::kULt:
+        return Compare(node, "bvult");
+      case Op::kULe:
+        return Compare(node, "bvule");
+      case Op::kUGt:
+        return Compare(node, "bvugt");
+      case Op::kUGe:
+        return Compare(node, "bvuge");
+      case Op::kSLt:
+        return Compare(node, "bvslt");
+      case Op::kSLe:
+        return Compare(node, "bvsle");
+      case Op::kSGt:
+        return Compare(node, "bvsgt");
+      case Op::kSGe:
+        return Compare(node, "bvsge");
+      case Op::kShll:
+        return Shift(node, "bvshl");
+      case Op::kShrl:
+        return Shift(node, "bvlshr");
+      case Op::kShra:
+        return Shift(node, "bvashr");
+      case Op::kConcat: {
+        // Operand zero is the most significant.
+        std::string result = Operand(node, node->operand_count() - 1);
+        for (int64_t i = node->operand_count() - 2; i >= 0; --i) {
+          result = absl::StrFormat("(concat %s %s)", Operand(node, i), result);
+        }
+        return result;
+      }
+      case Op::kBitSlice: {
+        BitSlice* slice = node->As<BitSlice>();
+        return absl::StrFormat("((_ extract %d %d) %s)",
+                               slice->start() + width - 1, slice->start(),
+                               Operand(node, 0));
+      }
+      case Op::kZeroExt:
+      case Op::kSignExt:
+        return Resize(Operand(node, 0), OperandWidth(node, 0), width,
+                      node->op() == Op::kSignExt);
+      case Op::kAndReduce:
+        return BoolToBit(absl::StrFormat(
+            "(= %s %s)", Operand(node, 0),
+            BitsLiteral(Bits::AllOnes(OperandWidth(node, 0)))));
+      case Op::kOrReduce:
+        return BoolToBit(absl::StrFormat(
+            "(not (= %s %s))", Operand(node, 0),
+            UnsignedLiteral(0, OperandWidth(node, 0))));
+      case Op::kXorReduce: {
+        std::string operand = Operand(node, 0);
+        std::vector<std::string> bits;
+        for (int64_t i = 0; i < OperandWidth(node, 0); ++i) {
+          bits.push_back(absl::StrFormat("((_ extract %d %d) %s)", i, i,
+                                         operand));
+        }
+        return bits.size() == 1
+                   ? bits.front()
+                   : absl::StrCat("(bvxor ", absl::StrJoin(bits, " "), ")");
+      }
+      case Op::kSel: {
+        Select* sel = node->As<Select>();
+        int64_t selector_width = sel->selector()->BitCountOrDie();
+        std::string selector = Term(sel->selector());
+        std::vector<std::string> cases;
+        for (Node* c : sel->cases()) {
+          cases.push_back(Term(c));
+        }
+        std::string result = sel->default_value().has_value()
+                                 ? Term(*sel->default_value())
+                                 : cases.back();
+        int64_t last = sel->default_value().has_value() ? cases.size()
+                                                        : cases.size() - 1;
+        for (int64_t i = last - 1; i >= 0; --i) {
+          result = absl::StrFormat("(ite (= %s %s) %s %s)", selector,
+                                   UnsignedLiteral(i, selector_width),
+                                   cases[i], result);
+        }
+        return result;
+      }
+      case Op::kOneHotSel: {
+        OneHotSelect* sel = node->As<OneHotSelect>();
+        std::string selector = Term(sel->selector());
+        std::vector<std::string> terms;
+        for (int64_t i = 0; i < sel->cases().size(); ++i) {
+          terms.push_back(absl::StrFormat(
+              "(ite (= ((_ extract %d %d) %s) #b1) %s %s)", i, i, selector,
+              Term(sel->get_case(i)), UnsignedLiteral(0, width)));
+        }
+        return terms.size() == 1
+                   ? terms.front()
+                   : absl::StrCat("(bvor ", absl::StrJoin(terms, " "), ")");
+      }
+      case Op::kPrioritySel: {
+        PrioritySelect* sel = node->As<PrioritySelect>();
+        std::string selector = Term(sel->selector());
+        std::vector<std::string> cases;
+        for (Node* c : sel->cases()) {
+          cases.push_back(Term(c));
+        }
+        // The lowest set selector bit wins; a zero selector gives zero.
+        std::string result = UnsignedLiteral(0, width);
+        for (int64_t i = cases.size() - 1; i >= 0; --i) {
+          result = absl::StrFormat("(ite (= ((_ extract %d %d) %s) #b1) %s %s)",
+                                   i, i, selector, cases[i], result);
+        }
+        return result;
+      }
+      default:
+        return absl::UnimplementedError(absl::StrFormat(
+            "SMT-LIB emission does not support op %s: %s",
+            OpToString(node->op()), node->ToString()));
+    }
+  }
+
+  Function* function_;
+  std::ostream& os_;
+  int64_t max_inline_depth_;
+
+  // Terms of single-use nodes not yet consumed by their user.
+  absl::flat_hash_map<Node*, Inlined> inlined_;
+};
+
+}  // namespace
+
+absl::Status EmitSmtLib(Function* function, std::ostream& os,
+                        int64_t max_inline_depth) {
+  return SmtLibEmitter(function, os, max_inline_depth).Run();
+}
+
+}  // namespace solvers
+}  // namespace xls
@@ -0,0 +1,44 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SOLVERS_SMTLIB_EMITTER_H_
+#define XLS_SOLVERS_SMTLIB_EMITTER_H_
+
+#include <cstdint>
+#include <ostream>
+
+#include "absl/status/status.h"
+#include "xls/ir/function.h"
+
+namespace xls {
+namespace solvers {
+
+// Writes `function` to `os` as SMT-LIB2, directly from the IR rather than via
+// a Z3 AST. Each param becomes a declare-const and the return value a nullary
+// define-fun named after the function. A node used more than once gets its
+// own define-fun (named after the node) and is referenced by name, so the
+// output is linear in the size of the function. Single-use nodes are inlined
+// into their users up to `max_inline_depth` levels of nesting. The output is
+// written node by node as the function is traversed.
+//
+// Only bits-typed nodes are supported; zero-width values and ops without a
+// direct SMT-LIB counterpart with matching semantics (e.g., signed division)
+// return an UnimplementedError.
+absl::Status EmitSmtLib(Function* function, std::ostream& os,
+                        int64_t max_inline_depth = 16);
+
+}  // namespace solvers
+}  // namespace xls
+
+#endif  // XLS_SOLVERS_SMTLIB_EMITTER_H_
@@ -0,0 +1,152 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/smtlib_emitter.h"
+
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/value.h"
+#include "../z3/src/api/z3.h"  // IWYU pragma: keep
+#include "../z3/src/api/z3_api.h"
+
+namespace xls::solvers {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+class SmtLibEmitterTest : public IrTestBase {
+ protected:
+  absl::StatusOr<std::string> Emit(Function* f) {
+    std::ostringstream os;
+    XLS_RETURN_IF_ERROR(EmitSmtLib(f, os));
+    return os.str();
+  }
+
+  // Checks with Z3 that the emitted function agrees with the interpreter on
+  // the given arguments.
+  void ExpectAgreesWithInterpreter(Function* f,
+                                   const std::vector<Value>& args) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::string smtlib, Emit(f));
+    XLS_ASSERT_OK_AND_ASSIGN(Value expected,
+                             DropInterpreterEvents(InterpretFunction(f, args)));
+    for (int64_t i = 0; i < args.size(); ++i) {
+      absl::StrAppendFormat(&smtlib, "(assert (= %s %s))\n",
+                            f->param(i)->GetName(),
+                            BitsToSmtLib(args[i].bits()));
+    }
+    absl::StrAppendFormat(&smtlib, "(assert (not (= %s %s)))\n(check-sat)\n",
+                          f->name(), BitsToSmtLib(expected.bits()));
+
+    Z3_config config = Z3_mk_config();
+    Z3_context ctx = Z3_mk_context(config);
+    std::string result = Z3_eval_smtlib2_string(ctx, smtlib.c_str());
+    EXPECT_EQ(result, "unsat\n") << smtlib;
+    Z3_del_context(ctx);
+    Z3_del_config(config);
+  }
+
+  static std::string BitsToSmtLib(const Bits& bits) {
+    std::string result = "#b";
+    for (int64_t i = bits.bit_count() - 1; i >= 0; --i) {
+      result.push_back(bits.Get(i) ? '1' : '0');
+    }
+    return result;
+  }
+};
+
+TEST_F(SmtLibEmitterTest, SharesMultiplyUsedNodes) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  add.1: bits[8] = add(x, y)
+  not.2: bits[8] = not(add.1)
+  ret and.3: bits[8] = and(add.1, not.2)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string smtlib, Emit(f));
+  EXPECT_THAT(smtlib, HasSubstr("(declare-const x (_ BitVec 8))\n"));
+  EXPECT_THAT(smtlib, HasSubstr("(declare-const y (_ BitVec 8))\n"));
+  EXPECT_THAT(smtlib,
+              HasSubstr("(define-fun add.1 () (_ BitVec 8) (bvadd x y))\n"
+                        "(define-fun f () (_ BitVec 8) "
+                        "(bvand add.1 (bvnot add.1)))\n"));
+  EXPECT_THAT(smtlib, Not(HasSubstr("not.2")));
+}
+
+TEST_F(SmtLibEmitterTest, AgreesWithInterpreter) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[8], y: bits[8], s: bits[2]) -> bits[16] {
+  umul.1: bits[12] = umul(x, y)
+  smul.2: bits[12] = smul(x, y)
+  sub.3: bits[12] = sub(umul.1, smul.2)
+  literal.4: bits[16] = literal(value=300)
+  shll.5: bits[8] = shll(x, literal.4)
+  shra.6: bits[8] = shra(y, s)
+  sel.7: bits[8] = sel(s, cases=[x, y, shll.5], default=shra.6)
+  one_hot_sel.8: bits[8] = one_hot_sel(s, cases=[x, y])
+  priority_sel.9: bits[8] = priority_sel(s, cases=[shra.6, x])
+  xor_reduce.10: bits[1] = xor_reduce(x)
+  ult.11: bits[1] = ult(x, y)
+  sge.12: bits[1] = sge(x, y)
+  concat.13: bits[14] = concat(xor_reduce.10, ult.11, sub.3)
+  bit_slice.14: bits[6] = bit_slice(concat.13, start=7, width=6)
+  sign_ext.15: bits[8] = sign_ext(bit_slice.14, new_bit_count=8)
+  xor.16: bits[8] = xor(sel.7, one_hot_sel.8, priority_sel.9, sign_ext.15)
+  ne.17: bits[1] = ne(xor.16, x)
+  ret concat.18: bits[16] = concat(xor.16, sge.12, ne.17, s, sge.12, s, ult.11)
+}
+)",
+                                                       p.get()));
+  for (int64_t x : {0, 5, 130, 255}) {
+    for (int64_t y : {0, 3, 200}) {
+      for (int64_t s = 0; s < 4; ++s) {
+        ExpectAgreesWithInterpreter(f, {Value(UBits(x, 8)), Value(UBits(y, 8)),
+                                        Value(UBits(s, 2))});
+      }
+    }
+  }
+}
+
+TEST_F(SmtLibEmitterTest, UnsupportedTypes) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[8]) -> (bits[8]) {
+  ret tuple.1: (bits[8]) = tuple(x)
+}
+)",
+                                                       p.get()));
+  EXPECT_THAT(Emit(f), StatusIs(absl::StatusCode::kUnimplemented,
+                                HasSubstr("bits types")));
+}
+
+}  // namespace
+}  // namespace xls::solvers
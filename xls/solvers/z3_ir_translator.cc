@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <string>
@@ -161,7 +162,8 @@ IrTranslator::IrTranslator(Z3_config config, FunctionBase* source)
       ctx_(Z3_mk_context(config_)),
       borrowed_context_(false),
       xls_function_(source),
-      current_symbol_(0) {}
+      current_symbol_(0),
+      hasher_(ctx_) {}
 
 IrTranslator::IrTranslator(
     Z3_context ctx, FunctionBase* source,
@@ -170,7 +172,8 @@ IrTranslator::IrTranslator(
       borrowed_context_(true),
       imported_params_(imported_params),
       xls_function_(source),
-      current_symbol_(0) {}
+      current_symbol_(0),
+      hasher_(ctx_) {}
 
 IrTranslator::~IrTranslator() {
   if (!borrowed_context_) {
@@ -449,30 +452,37 @@ absl::Status IrTranslator::HandleNary(OpT* op, FnT f, bool invert_result) {
     accum = f(ctx_, accum, GetBitVec(op->operand(i)));
   }
   if (invert_result) {
-    accum = Z3OpTranslator(ctx_).Not(accum);
+    accum = hasher_.Not(accum);
   }
   NoteTranslation(op, accum);
   return seh.status();
 }
 
+// Bitwise operations are built through the structural hasher so equivalent
+// gates are shared.
 absl::Status IrTranslator::HandleNaryAnd(NaryOp* and_op) {
-  return HandleNary(and_op, Z3_mk_bvand, /*invert_result=*/false);
+  auto f = [this](Z3_context, Z3_ast a, Z3_ast b) { return hasher_.And(a, b); };
+  return HandleNary(and_op, f, /*invert_result=*/false);
 }
 
 absl::Status IrTranslator::HandleNaryNand(NaryOp* nand_op) {
-  return HandleNary(nand_op, Z3_mk_bvand, /*invert_result=*/true);
+  auto f = [this](Z3_context, Z3_ast a, Z3_ast b) { return hasher_.And(a, b); };
+  return HandleNary(nand_op, f, /*invert_result=*/true);
 }
 
 absl::Status IrTranslator::HandleNaryNor(NaryOp* nor_op) {
-  return HandleNary(nor_op, Z3_mk_bvor, /*invert_result=*/true);
+  auto f = [this](Z3_context, Z3_ast a, Z3_ast b) { return hasher_.Or(a, b); };
+  return HandleNary(nor_op, f, /*invert_result=*/true);
 }
 
 absl::Status IrTranslator::HandleNaryOr(NaryOp* or_op) {
-  return HandleNary(or_op, Z3_mk_bvor, /*invert_result=*/false);
+  auto f = [this](Z3_context, Z3_ast a, Z3_ast b) { return hasher_.Or(a, b); };
+  return HandleNary(or_op, f, /*invert_result=*/false);
 }
 
 absl::Status IrTranslator::HandleNaryXor(NaryOp* op) {
-  return HandleNary(op, Z3_mk_bvxor, /*invert_result=*/false);
+  auto f = [this](Z3_context, Z3_ast a, Z3_ast b) { return hasher_.Xor(a, b); };
+  return HandleNary(op, f, /*invert_result=*/false);
 }
 
 absl::Status IrTranslator::HandleConcat(Concat* concat) {
@@ -811,7 +821,8 @@ absl::Status IrTranslator::HandleNeg(UnOp* neg) {
 }
 
 absl::Status IrTranslator::HandleNot(UnOp* not_op) {
-  return HandleUnary(not_op, Z3_mk_bvnot);
+  return HandleUnary(not_op,
+                     [this](Z3_context, Z3_ast a) { return hasher_.Not(a); });
 }
 
 absl::Status IrTranslator::HandleReverse(UnOp* reverse) {
@@ -1417,14 +1428,11 @@ static absl::StatusOr<Z3_ast> PredicateToNegatedObjective(
   return objective;
 }
 
-absl::StatusOr<bool> TryProveConjunction(
-    Function* f, absl::Span<const PredicateOfNode> terms,
-    absl::Duration timeout) {
+// Returns the disjunction of the negations of "terms", which is unsatisfiable
+// iff the conjunction of "terms" holds for all inputs.
+static absl::StatusOr<Z3_ast> NegatedConjunctionObjective(
+    absl::Span<const PredicateOfNode> terms, IrTranslator* translator) {
   XLS_RET_CHECK(!terms.empty());
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
-                       IrTranslator::CreateAndTranslate(f));
-  translator->SetTimeout(timeout);
-
   Z3OpTranslator t(translator->ctx());
   std::optional<Z3_ast> objective;
 
@@ -1433,9 +1441,9 @@ absl::StatusOr<bool> TryProveConjunction(
     XLS_RET_CHECK(value != nullptr);
 
     // Translate the predicate to a term we can throw into the conjunction.
-    XLS_ASSIGN_OR_RETURN(Z3_ast objective_term,
-                         PredicateToNegatedObjective(term.p, term.subject,
-                                                     value, translator.get()));
+    XLS_ASSIGN_OR_RETURN(
+        Z3_ast objective_term,
+        PredicateToNegatedObjective(term.p, term.subject, value, translator));
     XLS_RET_CHECK(objective_term != nullptr);
 
     if (objective.has_value()) {
@@ -1449,13 +1457,26 @@ absl::StatusOr<bool> TryProveConjunction(
 
   XLS_CHECK(objective.has_value());
   XLS_CHECK(objective.value() != nullptr);
+  XLS_VLOG(1) << "objective:\n"
+              << Z3_ast_to_string(translator->ctx(), objective.value());
+  return objective.value();
+}
+
+absl::StatusOr<bool> TryProveConjunction(
+    Function* f, absl::Span<const PredicateOfNode> terms,
+    absl::Duration timeout) {
+  XLS_RET_CHECK(!terms.empty());
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
+                       IrTranslator::CreateAndTranslate(f));
+  translator->SetTimeout(timeout);
+  XLS_ASSIGN_OR_RETURN(Z3_ast objective,
+                       NegatedConjunctionObjective(terms, translator.get()));
 
   Z3_context ctx = translator->ctx();
-  XLS_VLOG(1) << "objective:\n" << Z3_ast_to_string(ctx, objective.value());
   Z3_solver solver = solvers::z3::CreateSolver(ctx, /*num_threads=*/1);
   auto cleanup = absl::Cleanup([&] { Z3_solver_dec_ref(ctx, solver); });
 
-  Z3_solver_assert(ctx, solver, objective.value());
+  Z3_solver_assert(ctx, solver, objective);
   Z3_lbool satisfiable = Z3_solver_check(ctx, solver);
 
   // Implementation note: satisfiable can be one of:
@@ -1475,6 +1496,74 @@ absl::StatusOr<bool> TryProveConjunction(
   return false;
 }
 
+absl::StatusOr<bool> TryProveConjunction(
+    Function* f, absl::Span<const PredicateOfNode> terms,
+    absl::Duration timeout, IrTranslatorCache& cache) {
+  XLS_RET_CHECK(!terms.empty());
+  XLS_ASSIGN_OR_RETURN(IrTranslator * translator, cache.GetTranslator(f));
+  XLS_ASSIGN_OR_RETURN(Z3_ast objective,
+                       NegatedConjunctionObjective(terms, translator));
+  XLS_ASSIGN_OR_RETURN(Z3_lbool satisfiable,
+                       cache.CheckSat(f, objective, timeout));
+  return satisfiable == Z3_L_FALSE;
+}
+
+IrTranslatorCache::Entry::~Entry() {
+  if (solver != nullptr) {
+    Z3_solver_dec_ref(translator->ctx(), solver);
+  }
+}
+
+absl::StatusOr<IrTranslatorCache::Entry*> IrTranslatorCache::GetEntry(
+    FunctionBase* f) {
+  auto it = entries_.find(f);
+  if (it != entries_.end()) {
+    return it->second.get();
+  }
+  auto entry = std::make_unique<Entry>();
+  XLS_ASSIGN_OR_RETURN(entry->translator,
+                       IrTranslator::CreateAndTranslate(f, allow_unsupported_));
+  entry->solver = CreateSolver(entry->translator->ctx(), /*num_threads=*/1);
+  ++translation_count_;
+  XLS_VLOG(2) << "Translated " << f->name() << " into Z3 ("
+              << translation_count_ << " translations made by this cache)";
+  Entry* result = entry.get();
+  entries_[f] = std::move(entry);
+  return result;
+}
+
+absl::StatusOr<IrTranslator*> IrTranslatorCache::GetTranslator(
+    FunctionBase* f) {
+  XLS_ASSIGN_OR_RETURN(Entry * entry, GetEntry(f));
+  return entry->translator.get();
+}
+
+absl::StatusOr<Z3_lbool> IrTranslatorCache::CheckSat(
+    FunctionBase* f, Z3_ast term, std::optional<absl::Duration> timeout) {
+  XLS_ASSIGN_OR_RETURN(Entry * entry, GetEntry(f));
+  Z3_context ctx = entry->translator->ctx();
+
+  // The timeout is a solver parameter, so it is reset on every query; an
+  // absent timeout must not inherit the previous query's.
+  uint64_t timeout_ms = std::numeric_limits<unsigned>::max();
+  if (timeout.has_value()) {
+    timeout_ms = std::clamp<int64_t>(absl::ToInt64Milliseconds(*timeout), 1,
+                                     std::numeric_limits<unsigned>::max());
+  }
+  Z3_params params = Z3_mk_params(ctx);
+  Z3_params_inc_ref(ctx, params);
+  Z3_params_set_uint(ctx, params, Z3_mk_string_symbol(ctx, "timeout"),
+                     static_cast<unsigned>(timeout_ms));
+  Z3_solver_set_params(ctx, entry->solver, params);
+  Z3_params_dec_ref(ctx, params);
+
+  Z3_solver_push(ctx, entry->solver);
+  Z3_solver_assert(ctx, entry->solver, term);
+  Z3_lbool satisfiable = Z3_solver_check(ctx, entry->solver);
+  Z3_solver_pop(ctx, entry->solver, 1);
+  return satisfiable;
+}
+
 absl::StatusOr<bool> TryProve(Function* f, Node* subject, Predicate p,
                               absl::Duration timeout) {
   PredicateOfNode term{subject, std::move(p)};
@@ -26,6 +26,7 @@
 #include <string_view>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/time/time.h"
@@ -34,6 +35,7 @@
 #include "xls/ir/bits.h"
 #include "xls/ir/function.h"
 #include "xls/ir/nodes.h"
+#include "xls/solvers/z3_structural_hasher.h"
 #include "../z3/src/api/z3.h"  // IWYU pragma: keep
 #include "../z3/src/api/z3_api.h"
 
@@ -132,6 +134,11 @@ class IrTranslator : public DfsVisitorWithDefault {
 
   Z3_context ctx() { return ctx_; }
 
+  // Returns the hasher through which bitwise and/or/xor/not operations are
+  // built. Other translators sharing the context (e.g., a NetlistTranslator on
+  // the other side of an equivalence check) may use it to share gates.
+  StructuralHasher& hasher() { return hasher_; }
+
   // DfsVisitorWithDefault override decls.
   absl::Status DefaultHandler(Node* node) override;
   absl::Status HandleAdd(BinOp* add) override;
@@ -299,6 +306,56 @@ class IrTranslator : public DfsVisitorWithDefault {
   std::optional<absl::Span<const Z3_ast>> imported_params_;
   FunctionBase* xls_function_;
   int current_symbol_;
+  StructuralHasher hasher_;
+};
+
+// Translations of functions into Z3, each made once in its own context and
+// reused across queries. Repeated satisfiability checks against the same
+// function (e.g., the predicate queries of the mutual exclusion analysis) then
+// pay for translation once, and each query runs in a push/pop scope of a
+// per-function incremental solver, so the solver state built from the function
+// itself is kept between queries.
+//
+// A cached translation is only valid while its function is unchanged; call
+// Invalidate() after mutating it. Not thread-safe: Z3 contexts may only be
+// used from one thread at a time, so use one cache per thread.
+class IrTranslatorCache {
+ public:
+  // `allow_unsupported` is passed to IrTranslator::CreateAndTranslate.
+  explicit IrTranslatorCache(bool allow_unsupported = false)
+      : allow_unsupported_(allow_unsupported) {}
+
+  // Returns the translation of `f`, translating it on first use.
+  absl::StatusOr<IrTranslator*> GetTranslator(FunctionBase* f);
+
+  // Checks whether the boolean-sorted `term` (built in the context of
+  // GetTranslator(f)) is satisfiable, giving up after `timeout` if given.
+  // `term` is checked on its own; it is retracted before returning.
+  absl::StatusOr<Z3_lbool> CheckSat(
+      FunctionBase* f, Z3_ast term,
+      std::optional<absl::Duration> timeout = std::nullopt);
+
+  // Drops the translation of `f`, if any. Z3_ast values obtained from it are
+  // invalidated.
+  void Invalidate(FunctionBase* f) { entries_.erase(f); }
+  void Clear() { entries_.clear(); }
+
+  // Returns the number of translations made, including those since dropped.
+  int64_t translation_count() const { return translation_count_; }
+
+ private:
+  struct Entry {
+    ~Entry();
+
+    std::unique_ptr<IrTranslator> translator;
+    Z3_solver solver = nullptr;
+  };
+
+  absl::StatusOr<Entry*> GetEntry(FunctionBase* f);
+
+  bool allow_unsupported_;
+  int64_t translation_count_ = 0;
+  absl::flat_hash_map<FunctionBase*, std::unique_ptr<Entry>> entries_;
 };
 
 // Describes a predicate to compute about a subject node in an XLS IR function.
@@ -363,6 +420,12 @@ absl::StatusOr<bool> TryProveConjunction(
     Function* f, absl::Span<const PredicateOfNode> terms,
     absl::Duration timeout);
 
+// As above, but reuses the translation of "f" held by "cache" (translating it
+// there on first use).
+absl::StatusOr<bool> TryProveConjunction(
+    Function* f, absl::Span<const PredicateOfNode> terms,
+    absl::Duration timeout, IrTranslatorCache& cache);
+
 // Attempts to prove node "subject" in function "f" satisfies the given
 // predicate (over all possible inputs) within the duration "timeout".
 //
@@ -113,6 +113,46 @@ TEST_F(Z3IrTranslatorTest, ParamsEqualToSelfButUnequalToEachOther) {
   EXPECT_FALSE(proven);
 }
 
+TEST_F(Z3IrTranslatorTest, CacheTranslatesOncePerFunction) {
+  auto p = CreatePackage();
+  Type* u8 = p->GetBitsType(8);
+  FunctionBuilder b("f", p.get());
+  auto x = b.Param("x", u8);
+  auto y = b.Param("y", u8);
+  auto x_and_y = b.And(x, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, b.Build());
+
+  solvers::z3::IrTranslatorCache cache;
+  std::vector<PredicateOfNode> holds = {
+      PredicateOfNode{x_and_y.node(), Predicate::UnsignedLessOrEqual(
+                                          UBits(0xff, /*bit_count=*/8))},
+  };
+  std::vector<PredicateOfNode> fails = {
+      PredicateOfNode{x_and_y.node(), Predicate::EqualToZero()},
+  };
+  EXPECT_THAT(TryProveConjunction(f, holds, absl::InfiniteDuration(), cache),
+              IsOkAndHolds(true));
+  // Terms of earlier queries are retracted, so they do not leak into later
+  // ones.
+  EXPECT_THAT(TryProveConjunction(f, fails, absl::InfiniteDuration(), cache),
+              IsOkAndHolds(false));
+  EXPECT_THAT(TryProveConjunction(f, holds, absl::InfiniteDuration(), cache),
+              IsOkAndHolds(true));
+  EXPECT_EQ(cache.translation_count(), 1);
+
+  XLS_ASSERT_OK_AND_ASSIGN(IrTranslator * translator, cache.GetTranslator(f));
+  Z3_context ctx = translator->ctx();
+  Z3_ast x_and_y_is_one =
+      Z3_mk_eq(ctx, translator->GetTranslation(x_and_y.node()),
+               Z3_mk_int(ctx, 1, Z3_mk_bv_sort(ctx, 8)));
+  EXPECT_THAT(cache.CheckSat(f, x_and_y_is_one), IsOkAndHolds(Z3_L_TRUE));
+  EXPECT_EQ(cache.translation_count(), 1);
+
+  cache.Invalidate(f);
+  XLS_ASSERT_OK(cache.GetTranslator(f).status());
+  EXPECT_EQ(cache.translation_count(), 2);
+}
+
 TEST_F(Z3IrTranslatorTest, ParamAddOneIsGeParam) {
   auto p = CreatePackage();
   Type* u32 = p->GetBitsType(32);
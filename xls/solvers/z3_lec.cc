@@ -15,8 +15,11 @@
 #include "xls/solvers/z3_lec.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <deque>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <string>
@@ -25,13 +28,21 @@
 #include <vector>
 
 #include "absl/base/internal/sysinfo.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/codegen/vast.h"
+#include "xls/common/thread.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/node_util.h"
+#include "xls/solvers/z3_structural_hasher.h"
 #include "xls/solvers/z3_utils.h"
 #include "../z3/src/api/z3_api.h"
 
@@ -78,6 +89,7 @@ Lec::Lec(Function* ir_function, Netlist* netlist,
     : ir_function_(ir_function),
       netlist_(netlist),
       netlist_module_name_(netlist_module_name),
+      solver_threads_(std::thread::hardware_concurrency()),
       schedule_(schedule),
       stage_(stage) {}
 
@@ -108,7 +120,6 @@ absl::Status Lec::Init() {
   // Helpful for reading result output.
   Z3_ast x = Z3_mk_const(ctx(), Z3_mk_string_symbol(ctx(), "X"),
                          Z3_mk_bv_sort(ctx(), 1));
-  std::vector<Z3_ast> eq_nodes;
   for (const Node* node : ir_output_nodes_) {
     // Extract the individual bits out of each IR output node, and match those
     // up the corresponding netlist bits. The netlist outputs do not contain
@@ -132,19 +143,27 @@ absl::Status Lec::Init() {
       } else {
         ir_outputs_.push_back(ir_bits[i]);
         netlist_outputs_.push_back(netlist_bits[i]);
-        eq_nodes.push_back(Z3_mk_eq(ctx(), ir_bits[i], netlist_bits[i]));
+        output_eqs_.push_back(Z3_mk_eq(ctx(), ir_bits[i], netlist_bits[i]));
       }
     }
   }
 
-  Z3_ast eval_node = Z3_mk_and(ctx(), eq_nodes.size(), eq_nodes.data());
-  eval_node = Z3_mk_not(ctx(), eval_node);
-  solver_ = CreateSolver(ctx(), std::thread::hardware_concurrency());
-  Z3_solver_assert(ctx(), solver_.value(), eval_node);
-
+  solver_ = CreateSolver(ctx(), solver_threads_);
   return absl::OkStatus();
 }
 
+absl::StatusOr<std::unique_ptr<Lec>> Lec::CreateWorker() const {
+  auto lec = absl::WrapUnique<Lec>(
+      new Lec(ir_function_, netlist_, netlist_module_name_, schedule_, stage_));
+  // The workers already run in parallel with one another.
+  lec->solver_threads_ = 1;
+  XLS_RETURN_IF_ERROR(lec->Init());
+  if (constraints_ != nullptr) {
+    XLS_RETURN_IF_ERROR(lec->AddConstraints(constraints_));
+  }
+  return lec;
+}
+
 absl::Status Lec::CollectIrInputs() {
   if (CheckingSingleStage(schedule_, stage_) && stage_ != 0) {
     // If we're evaluating a single stage (aside from the first), then we need
@@ -260,19 +279,239 @@ absl::Status Lec::AddConstraints(Function* constraints) {
   Z3_ast eq_node = Z3_mk_eq(ctx(), constraint_translator->GetReturnNode(),
                             Z3_mk_int(ctx(), 1, Z3_mk_bv_sort(ctx(), 1)));
   Z3_solver_assert(ctx(), solver_.value(), eq_node);
+  constraints_ = constraints;
   return absl::OkStatus();
 }
 
-bool Lec::Run() {
-  XLS_LOG(INFO) << "Beginning execution";
-  satisfiable_ = Z3_solver_check(ctx(), solver_.value()) == Z3_L_TRUE;
+void Lec::SetResult(Z3_lbool result) {
+  if (model_) {
+    Z3_model_dec_ref(ctx(), model_.value());
+    model_.reset();
+  }
+  satisfiable_ = result == Z3_L_TRUE;
   if (satisfiable_) {
     model_ = Z3_solver_get_model(ctx(), solver_.value());
     Z3_model_inc_ref(ctx(), model_.value());
   }
+}
+
+bool Lec::Run() {
+  XLS_LOG(INFO) << "Beginning execution";
+  Z3_ast eval_node = Z3_mk_and(ctx(), output_eqs_.size(), output_eqs_.data());
+  Z3_solver_assert(ctx(), solver_.value(), Z3_mk_not(ctx(), eval_node));
+  SetResult(Z3_solver_check(ctx(), solver_.value()));
   return !satisfiable_;
 }
 
+bool Lec::RunIncremental() {
+  XLS_LOG(INFO) << "Beginning incremental execution over "
+                << output_eqs_.size() << " output bits";
+  int64_t failing_index;
+  Z3_lbool result = ProveEachIncrementally(ctx(), solver_.value(),
+                                           output_eqs_, &failing_index);
+  SetResult(result);
+  return result == Z3_L_FALSE;
+}
+
+absl::StatusOr<bool> Lec::RunParallel(int64_t num_threads) {
+  XLS_RET_CHECK_GE(num_threads, 1);
+  const int64_t num_outputs = output_eqs_.size();
+  num_threads = std::min(num_threads, num_outputs);
+  if (num_threads <= 1) {
+    return RunIncremental();
+  }
+  XLS_LOG(INFO) << "Beginning parallel execution over " << num_outputs
+                << " output bits with " << num_threads << " threads";
+
+  // Each worker proves the bits congruent to its shard index, stopping once
+  // any worker finds a bit it can't prove.
+  std::atomic<bool> done = false;
+  absl::Mutex mutex;
+  absl::Status status;                  // Guarded by mutex.
+  std::optional<int64_t> first_failure;  // Guarded by mutex.
+  auto worker = [&](int64_t shard) {
+    absl::StatusOr<std::unique_ptr<Lec>> lec = CreateWorker();
+    if (!lec.ok()) {
+      absl::MutexLock lock(&mutex);
+      status.Update(lec.status());
+      done = true;
+      return;
+    }
+    for (int64_t i = shard; i < num_outputs && !done; i += num_threads) {
+      int64_t unused;
+      Z3_lbool result = ProveEachIncrementally(
+          (*lec)->ctx(), (*lec)->solver_.value(),
+          absl::MakeConstSpan(&(*lec)->output_eqs_[i], 1), &unused);
+      if (result != Z3_L_FALSE) {
+        absl::MutexLock lock(&mutex);
+        if (!first_failure.has_value() || i < first_failure.value()) {
+          first_failure = i;
+        }
+        done = true;
+        return;
+      }
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t shard = 0; shard < num_threads; ++shard) {
+    threads.push_back(
+        std::make_unique<Thread>([&worker, shard]() { worker(shard); }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  XLS_RETURN_IF_ERROR(status);
+
+  if (!first_failure.has_value()) {
+    SetResult(Z3_L_FALSE);
+    return true;
+  }
+  // Models can't be moved between contexts, so re-check the failing bit here.
+  int64_t unused;
+  SetResult(ProveEachIncrementally(
+      ctx(), solver_.value(),
+      absl::MakeConstSpan(&output_eqs_[first_failure.value()], 1), &unused));
+  return false;
+}
+
+std::vector<Z3_ast> Lec::InputBits() {
+  std::vector<const Node*> inputs;
+  for (const auto& [node, _] : input_mapping_) {
+    inputs.push_back(node);
+  }
+  std::sort(inputs.begin(), inputs.end(), [](const Node* a, const Node* b) {
+    return a->id() < b->id();
+  });
+  std::vector<std::vector<Z3_ast>> input_bits;
+  int64_t max_width = 0;
+  for (const Node* input : inputs) {
+    input_bits.push_back(ir_translator_->FlattenValue(
+        input->GetType(), input_mapping_.at(input), /*little_endian=*/true));
+    max_width = std::max<int64_t>(max_width, input_bits.back().size());
+  }
+  std::vector<Z3_ast> bits;
+  for (int64_t i = 0; i < max_width; ++i) {
+    for (const std::vector<Z3_ast>& input : input_bits) {
+      if (i < input.size()) {
+        bits.push_back(input[i]);
+      }
+    }
+  }
+  return bits;
+}
+
+Z3_lbool Lec::RunCube(absl::Span<const bool> cube) {
+  std::vector<Z3_ast> input_bits = InputBits();
+  XLS_CHECK_LE(cube.size(), input_bits.size());
+  Z3_solver_push(ctx(), solver_.value());
+  Z3_ast eval_node = Z3_mk_and(ctx(), output_eqs_.size(), output_eqs_.data());
+  Z3_solver_assert(ctx(), solver_.value(), Z3_mk_not(ctx(), eval_node));
+  Z3_sort bit_sort = Z3_mk_bv_sort(ctx(), 1);
+  for (int64_t i = 0; i < cube.size(); ++i) {
+    Z3_solver_assert(
+        ctx(), solver_.value(),
+        Z3_mk_eq(ctx(), input_bits[i], Z3_mk_int(ctx(), cube[i], bit_sort)));
+  }
+  Z3_lbool result = Z3_solver_check(ctx(), solver_.value());
+  SetResult(result);
+  Z3_solver_pop(ctx(), solver_.value(), 1);
+  return result;
+}
+
+void Lec::SetTimeout(absl::Duration timeout) {
+  Z3_params params = Z3_mk_params(ctx());
+  Z3_params_inc_ref(ctx(), params);
+  Z3_params_set_uint(ctx(), params, Z3_mk_string_symbol(ctx(), "timeout"),
+                     timeout == absl::InfiniteDuration()
+                         ? std::numeric_limits<unsigned>::max()
+                         : static_cast<unsigned>(std::clamp<int64_t>(
+                               absl::ToInt64Milliseconds(timeout), 1,
+                               std::numeric_limits<unsigned>::max())));
+  Z3_solver_set_params(ctx(), solver_.value(), params);
+  Z3_params_dec_ref(ctx(), params);
+}
+
+absl::StatusOr<StageLecResult> Lec::CheckStage(
+    const LecParams& params, const PipelineSchedule& schedule, int stage,
+    const StagedLecOptions& options) {
+  absl::Time start = absl::Now();
+  auto lec = absl::WrapUnique<Lec>(new Lec(params.ir_function, params.netlist,
+                                           params.netlist_module_name, schedule,
+                                           stage));
+  // Stages are already checked in parallel with one another.
+  lec->solver_threads_ = 1;
+  XLS_RETURN_IF_ERROR(lec->Init());
+
+  StageLecResult result{.stage = stage};
+  lec->SetTimeout(options.stage_timeout);
+  result.result = lec->RunCube({});
+  if (result.result == Z3_L_UNDEF && options.cube_bits > 0) {
+    int64_t cube_bits =
+        std::min<int64_t>(options.cube_bits, lec->InputBits().size());
+    XLS_VLOG(1) << "Stage " << stage << " timed out; splitting into "
+                << (int64_t{1} << cube_bits) << " cubes";
+    lec->SetTimeout(options.cube_timeout);
+    result.result = Z3_L_FALSE;
+    absl::InlinedVector<bool, 16> cube(cube_bits);
+    for (int64_t i = 0; i < (int64_t{1} << cube_bits); ++i) {
+      for (int64_t bit = 0; bit < cube_bits; ++bit) {
+        cube[bit] = ((i >> bit) & 1) != 0;
+      }
+      ++result.cubes_checked;
+      Z3_lbool cube_result = lec->RunCube(cube);
+      if (cube_result == Z3_L_TRUE) {
+        result.result = Z3_L_TRUE;
+        break;
+      }
+      // Keep going after a timeout; a later cube may yet find a mismatch.
+      if (cube_result == Z3_L_UNDEF) {
+        result.result = Z3_L_UNDEF;
+      }
+    }
+  }
+  if (result.result == Z3_L_TRUE) {
+    result.counterexample = lec->ResultToString();
+  }
+  result.elapsed = absl::Now() - start;
+  return result;
+}
+
+absl::StatusOr<std::vector<StageLecResult>> Lec::RunStaged(
+    const LecParams& params, const PipelineSchedule& schedule,
+    const StagedLecOptions& options) {
+  XLS_RET_CHECK_GE(options.num_threads, 1);
+  XLS_RET_CHECK_GE(options.cube_bits, 0);
+  const int64_t num_stages = schedule.length();
+  std::vector<StageLecResult> results(num_stages);
+
+  // Workers claim stages in order until none remain.
+  std::atomic<int64_t> next_stage = 0;
+  absl::Mutex mutex;
+  absl::Status status;  // Guarded by mutex.
+  auto worker = [&]() {
+    for (int64_t stage = next_stage++; stage < num_stages;
+         stage = next_stage++) {
+      absl::StatusOr<StageLecResult> result =
+          CheckStage(params, schedule, stage, options);
+      if (!result.ok()) {
+        absl::MutexLock lock(&mutex);
+        status.Update(result.status());
+        continue;
+      }
+      results[stage] = *std::move(result);
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 0; i < std::min(options.num_threads, num_stages); ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  XLS_RETURN_IF_ERROR(status);
+  return results;
+}
+
 std::string Lec::ResultToString() {
   std::vector<std::string> output;
   output.push_back(SolverResultToString(ctx(), solver_.value(),
@@ -394,9 +633,17 @@ absl::Status Lec::CreateNetlistTranslator() {
     }
   }
 
-  XLS_ASSIGN_OR_RETURN(netlist_translator_,
-                       NetlistTranslator::CreateAndTranslate(
-                           ir_translator_->ctx(), module_, module_refs));
+  // Share the IR translator's hasher so gates common to both sides of the
+  // check are built once.
+  XLS_ASSIGN_OR_RETURN(
+      netlist_translator_,
+      NetlistTranslator::CreateAndTranslate(ir_translator_->ctx(), module_,
+                                            module_refs,
+                                            &ir_translator_->hasher()));
+  const StructuralHasher& hasher = ir_translator_->hasher();
+  XLS_VLOG(1) << absl::StrFormat(
+      "LEC gates: %d requests, %d unique, sharing ratio %.2f",
+      hasher.gate_requests(), hasher.unique_gates(), hasher.sharing_ratio());
 
   return absl::OkStatus();
 }
@@ -15,6 +15,7 @@
 #ifndef XLS_SOLVERS_Z3_LEC_H_
 #define XLS_SOLVERS_Z3_LEC_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -23,6 +24,8 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/ir/package.h"
 #include "xls/netlist/netlist.h"
 #include "xls/scheduling/pipeline_schedule.h"
@@ -50,6 +53,38 @@ struct LecParams {
   std::string netlist_module_name;
 };
 
+// Options for Lec::RunStaged().
+struct StagedLecOptions {
+  // The number of stages checked concurrently, each with its own Z3 context.
+  int64_t num_threads = 1;
+
+  // Time allowed to check a stage as a whole.
+  absl::Duration stage_timeout = absl::InfiniteDuration();
+
+  // A stage which times out is split into 2^cube_bits cubes, each fixing the
+  // value of cube_bits of its input bits (see Lec::RunCube()), which are
+  // checked one by one with cube_timeout each. Zero disables splitting.
+  int64_t cube_bits = 0;
+  absl::Duration cube_timeout = absl::InfiniteDuration();
+};
+
+// The outcome of checking one stage in Lec::RunStaged().
+struct StageLecResult {
+  int stage;
+
+  // Z3_L_FALSE if the stage was proven equivalent, Z3_L_TRUE if a mismatch was
+  // found and Z3_L_UNDEF if the check (or some cube of it) timed out.
+  Z3_lbool result;
+
+  // The number of cubes checked; zero if the stage was decided as a whole.
+  int64_t cubes_checked = 0;
+
+  // ResultToString() of the stage's check if a mismatch was found.
+  std::string counterexample;
+
+  absl::Duration elapsed;
+};
+
 // Class for performing logical equivalence checks between a function specified
 // in XLS IR (perhaps converted from DSLX) and a netlist.
 class Lec {
@@ -65,6 +100,14 @@ class Lec {
       const LecParams& params, const PipelineSchedule& schedule, int stage);
   ~Lec();
 
+  // Checks every stage of the schedule, running up to options.num_threads
+  // stage checks concurrently (each with its own Z3 context). Stages which
+  // time out are split into cubes as described in StagedLecOptions. Returns
+  // the result of each stage, indexed by stage. Constraints are not supported.
+  static absl::StatusOr<std::vector<StageLecResult>> RunStaged(
+      const LecParams& params, const PipelineSchedule& schedule,
+      const StagedLecOptions& options);
+
   // Applies additional constraints (aside from the LEC itself), such as
   // restricting the input space.
   // This function must have the same signature as the function being compared
@@ -78,6 +121,34 @@ class Lec {
   // Returns true of the netlist and IR are proved to be equivalent.
   bool Run();
 
+  // As Run(), but proves the output bits equivalent one at a time on a single
+  // solver, carrying each proven bit forward as a lemma (see
+  // ProveEachIncrementally()). Wide datapaths that time out as one query are
+  // often tractable this way. Only one of the Run*() methods may be called.
+  bool RunIncremental();
+
+  // As RunIncremental(), but splits the output bits across "num_threads"
+  // independent Lec objects - each with its own Z3 context, as contexts can't
+  // be shared between threads - run concurrently. If a mismatch is found it
+  // is re-derived on this object so ResultToString() can describe it.
+  absl::StatusOr<bool> RunParallel(int64_t num_threads);
+
+  // Checks equivalence assuming the first cube.size() bits of InputBits()
+  // have the given values, returning Z3_L_FALSE if equivalent under that
+  // assumption, Z3_L_TRUE if not and Z3_L_UNDEF on timeout. An empty cube
+  // checks the whole input space. May be called any number of times; each
+  // call replaces the result reported by ResultToString().
+  Z3_lbool RunCube(absl::Span<const bool> cube);
+
+  // Returns the bits of the inputs of the check (function params or stage
+  // inputs) in the order used by RunCube(): the low bits of every input, then
+  // the next bits of every input and so on, so short cubes split across
+  // inputs.
+  std::vector<Z3_ast> InputBits();
+
+  // Limits the duration of each subsequent solver check.
+  void SetTimeout(absl::Duration timeout);
+
   // Dumps all Z3 values corresponding to IR nodes in the input function.
   void DumpIrTree();
 
@@ -91,6 +162,19 @@ class Lec {
       const std::string& netlist_module_name,
       std::optional<PipelineSchedule> schedule, int stage);
   absl::Status Init();
+
+  // Creates a copy of this object (over the same IR, netlist and constraints)
+  // with its own Z3 context, for use by RunParallel().
+  absl::StatusOr<std::unique_ptr<Lec>> CreateWorker() const;
+
+  // Records the result of a check on solver_, fetching its model if
+  // satisfiable.
+  void SetResult(Z3_lbool result);
+
+  // Checks the given stage for RunStaged().
+  static absl::StatusOr<StageLecResult> CheckStage(
+      const LecParams& params, const PipelineSchedule& schedule, int stage,
+      const StagedLecOptions& options);
   absl::Status CreateIrTranslator();
   absl::Status CreateNetlistTranslator();
 
@@ -153,6 +237,16 @@ class Lec {
   std::vector<Z3_ast> ir_outputs_;
   std::vector<Z3_ast> netlist_outputs_;
 
+  // The equality of each IR output bit with its netlist counterpart, for those
+  // bits present in the netlist.
+  std::vector<Z3_ast> output_eqs_;
+
+  // The constraints function given to AddConstraints(), if any.
+  Function* constraints_ = nullptr;
+
+  // The number of threads the solver may use.
+  int solver_threads_;
+
   std::optional<PipelineSchedule> schedule_;
   int stage_;
 
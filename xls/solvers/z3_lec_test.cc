@@ -15,9 +15,11 @@
 #include "xls/solvers/z3_lec.h"
 
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/ir_parser.h"
@@ -33,8 +35,15 @@ namespace {
 
 using netlist::rtl::Netlist;
 
+// How Match() runs the LEC.
+enum class RunMode { kMonolithic, kIncremental, kParallel };
+
+constexpr RunMode kAllRunModes[] = {RunMode::kMonolithic, RunMode::kIncremental,
+                                    RunMode::kParallel};
+
 absl::StatusOr<bool> Match(const std::string& ir_text,
-                           const std::string& netlist_text, bool expect_equal) {
+                           const std::string& netlist_text, bool expect_equal,
+                           RunMode mode = RunMode::kMonolithic) {
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
                        Parser::ParsePackage(ir_text));
   XLS_ASSIGN_OR_RETURN(Function * entry_function, package->GetTopAsFunction());
@@ -54,7 +63,15 @@ absl::StatusOr<bool> Match(const std::string& ir_text,
   params.netlist_module_name = "main";
 
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Lec> lec, Lec::Create(params));
-  return lec->Run();
+  switch (mode) {
+    case RunMode::kMonolithic:
+      return lec->Run();
+    case RunMode::kIncremental:
+      return lec->RunIncremental();
+    case RunMode::kParallel:
+      return lec->RunParallel(/*num_threads=*/2);
+  }
+  return absl::InternalError("Unknown run mode");
 }
 
 // This test verifies that we can do a simple LEC.
@@ -128,9 +145,11 @@ module main(clk, a_1_, a_0_, b_1_, b_0_, out_1_, out_0_);
 endmodule
 )";
 
-  XLS_ASSERT_OK_AND_ASSIGN(bool match,
-                           Match(ir_text, netlist_text, /*expect_equal=*/true));
-  ASSERT_TRUE(match);
+  for (RunMode mode : kAllRunModes) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        bool match, Match(ir_text, netlist_text, /*expect_equal=*/true, mode));
+    ASSERT_TRUE(match);
+  }
 }
 
 // Test verifies that z3::Lec correctly reports a mismatch in cases where the
@@ -168,9 +187,11 @@ module main ( clk, input_3_, input_2_, input_1_, input_0_, out_3_, out_2_, out_1
   DFF p0_not_2_reg_0_ (.D(p0_not_2_comb_0_), .CLK(clk), .Q(out_0_));
 endmodule
 )";
-  XLS_ASSERT_OK_AND_ASSIGN(
-      bool match, Match(ir_text, netlist_text, /*expect_equal=*/false));
-  ASSERT_FALSE(match);
+  for (RunMode mode : kAllRunModes) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        bool match, Match(ir_text, netlist_text, /*expect_equal=*/false, mode));
+    ASSERT_FALSE(match);
+  }
 }
 
 // This test verifies that we can do a simple multi-stage LEC.
@@ -349,6 +370,24 @@ endmodule
     }
     XLS_LOG(INFO) << "Pass stage " << i;
   }
+
+  // Stage 0 only mismatches when exactly one of i2 and i3 is set.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Lec> lec,
+                           Lec::CreateForStage(params, schedule, 0));
+  EXPECT_EQ(lec->InputBits().size(), 4);
+  EXPECT_EQ(lec->RunCube({false, false, true, true}), Z3_L_FALSE);
+  EXPECT_EQ(lec->RunCube({false, false, true, false}), Z3_L_TRUE);
+  EXPECT_EQ(lec->RunCube({}), Z3_L_TRUE);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<StageLecResult> results,
+      Lec::RunStaged(params, schedule,
+                     StagedLecOptions{.num_threads = 3, .cube_bits = 2}));
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_EQ(results[0].result, Z3_L_TRUE);
+  EXPECT_FALSE(results[0].counterexample.empty());
+  EXPECT_EQ(results[1].result, Z3_L_FALSE);
+  EXPECT_EQ(results[2].result, Z3_L_FALSE);
 }
 
 // This test verifies that we can do a multibit LEC with >1b inputs.
@@ -50,9 +50,10 @@ using netlist::rtl::NetRef;
 absl::StatusOr<std::unique_ptr<NetlistTranslator>>
 NetlistTranslator::CreateAndTranslate(
     Z3_context ctx, const Module* module,
-    const absl::flat_hash_map<std::string, const Module*>& module_refs) {
-  auto translator =
-      absl::WrapUnique(new NetlistTranslator(ctx, module, module_refs));
+    const absl::flat_hash_map<std::string, const Module*>& module_refs,
+    StructuralHasher* hasher) {
+  auto translator = absl::WrapUnique(
+      new NetlistTranslator(ctx, module, module_refs, hasher));
   XLS_RETURN_IF_ERROR(translator->Init());
   XLS_RETURN_IF_ERROR(translator->Translate());
   return translator;
@@ -65,8 +66,14 @@ absl::StatusOr<Z3_ast> NetlistTranslator::GetTranslation(NetRef ref) {
 
 NetlistTranslator::NetlistTranslator(
     Z3_context ctx, const Module* module,
-    const absl::flat_hash_map<std::string, const Module*>& module_refs)
-    : ctx_(ctx), module_(module), module_refs_(module_refs) {}
+    const absl::flat_hash_map<std::string, const Module*>& module_refs,
+    StructuralHasher* hasher)
+    : ctx_(ctx), module_(module), module_refs_(module_refs), hasher_(hasher) {
+  if (hasher_ == nullptr) {
+    owned_hasher_ = std::make_unique<StructuralHasher>(ctx);
+    hasher_ = owned_hasher_.get();
+  }
+}
 
 absl::Status NetlistTranslator::Init() {
   // Create a symbolic constant for each module input and make it available for
@@ -187,6 +194,11 @@ absl::Status NetlistTranslator::Translate() {
     }
   }
 
+  XLS_VLOG(1) << absl::StrFormat(
+      "Translated module %s: %d gate requests, %d unique gates, sharing "
+      "ratio %.2f",
+      module_->name(), hasher_->gate_requests(), hasher_->unique_gates(),
+      hasher_->sharing_ratio());
   return absl::Status();
 }
 
@@ -205,7 +217,8 @@ absl::Status NetlistTranslator::TranslateCell(const Cell& cell) {
     const Module* module_ref = module_refs_.at(entry_name);
     XLS_ASSIGN_OR_RETURN(
         auto subtranslator,
-        NetlistTranslator::CreateAndTranslate(ctx_, module_ref, module_refs_));
+        NetlistTranslator::CreateAndTranslate(ctx_, module_ref, module_refs_,
+                                              hasher_));
 
     // Now match the module outputs to the corresponding netref in this module's
     // corresponding cell.
@@ -259,7 +272,7 @@ absl::StatusOr<Z3_ast> NetlistTranslator::TranslateFunction(
       XLS_ASSIGN_OR_RETURN(
           Z3_ast rhs,
           TranslateFunction(cell, ast.children()[1], state_table_values));
-      return Z3_mk_bvand(ctx_, lhs, rhs);
+      return hasher_->And(lhs, rhs);
     }
     case Ast::Kind::kIdentifier: {
       for (const auto& input : cell.inputs()) {
@@ -286,7 +299,7 @@ absl::StatusOr<Z3_ast> NetlistTranslator::TranslateFunction(
       XLS_ASSIGN_OR_RETURN(
           Z3_ast child,
           TranslateFunction(cell, ast.children()[0], state_table_values));
-      return Z3_mk_bvnot(ctx_, child);
+      return hasher_->Not(child);
     }
     case Ast::Kind::kOr: {
       XLS_ASSIGN_OR_RETURN(
@@ -295,7 +308,7 @@ absl::StatusOr<Z3_ast> NetlistTranslator::TranslateFunction(
       XLS_ASSIGN_OR_RETURN(
           Z3_ast rhs,
           TranslateFunction(cell, ast.children()[1], state_table_values));
-      return Z3_mk_bvor(ctx_, lhs, rhs);
+      return hasher_->Or(lhs, rhs);
     }
     case Ast::Kind::kXor: {
       XLS_ASSIGN_OR_RETURN(
@@ -304,7 +317,7 @@ absl::StatusOr<Z3_ast> NetlistTranslator::TranslateFunction(
       XLS_ASSIGN_OR_RETURN(
           Z3_ast rhs,
           TranslateFunction(cell, ast.children()[1], state_table_values));
-      return Z3_mk_bvxor(ctx_, lhs, rhs);
+      return hasher_->Xor(lhs, rhs);
     }
     default:
       return absl::InvalidArgumentError(absl::StrFormat(
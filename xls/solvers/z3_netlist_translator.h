@@ -23,6 +23,7 @@
 #include "absl/status/statusor.h"
 #include "xls/netlist/function_parser.h"
 #include "xls/netlist/netlist.h"
+#include "xls/solvers/z3_structural_hasher.h"
 #include "../z3/src/api/z3.h"
 
 namespace xls {
@@ -43,10 +44,15 @@ class NetlistTranslator {
   //    references in the module being processed.
   //  - inputs is a map of wire/net name to Z3 one-bit vectors; this requires
   //    "exploding" values, such as a bits[8] into 8 single-bit inputs.
+  //  - hasher, if given, is used to build all gates so that structurally
+  //    equivalent gates are shared with other users of the hasher (e.g., the
+  //    other side of an equivalence check). It must outlive the translator. If
+  //    null, the translator uses its own hasher.
   static absl::StatusOr<std::unique_ptr<NetlistTranslator>> CreateAndTranslate(
       Z3_context ctx, const netlist::rtl::Module* module,
       const absl::flat_hash_map<std::string, const netlist::rtl::Module*>&
-          module_refs);
+          module_refs,
+      StructuralHasher* hasher = nullptr);
 
   // Returns the Z3 equivalent for the specified net.
   absl::StatusOr<Z3_ast> GetTranslation(netlist::rtl::NetRef ref);
@@ -77,11 +83,15 @@ class NetlistTranslator {
   void PrintValueCone(const ValueCone& value_cone, Z3_model model,
                       int level = 0);
 
+  // Returns the hasher used to build gates, e.g., to query sharing statistics.
+  const StructuralHasher& hasher() const { return *hasher_; }
+
  private:
   NetlistTranslator(
       Z3_context ctx, const netlist::rtl::Module* module,
       const absl::flat_hash_map<std::string, const netlist::rtl::Module*>&
-          module_refs);
+          module_refs,
+      StructuralHasher* hasher);
   absl::Status Init();
 
   // Translates the module, cell, or cell function, respectively, into Z3-space.
@@ -101,6 +111,11 @@ class NetlistTranslator {
 
   const absl::flat_hash_map<std::string, const netlist::rtl::Module*>
       module_refs_;
+
+  // Set only if no hasher was provided at creation; hasher_ points to the
+  // hasher in use either way. Sub-module translators share the hasher.
+  std::unique_ptr<StructuralHasher> owned_hasher_;
+  StructuralHasher* hasher_;
 };
 
 }  // namespace z3
@@ -0,0 +1,157 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/z3_structural_hasher.h"
+
+#include <cstdint>
+#include <utility>
+
+#include "../z3/src/api/z3.h"  // IWYU pragma: keep
+#include "../z3/src/api/z3_api.h"
+
+namespace xls {
+namespace solvers {
+namespace z3 {
+
+bool StructuralHasher::IsAllZeros(Z3_ast a) const {
+  uint64_t value;
+  return Z3_is_numeral_ast(ctx_, a) && Z3_get_numeral_uint64(ctx_, a, &value) &&
+         value == 0;
+}
+
+bool StructuralHasher::IsAllOnes(Z3_ast a) const {
+  if (!Z3_is_numeral_ast(ctx_, a)) {
+    return false;
+  }
+  unsigned width = Z3_get_bv_sort_size(ctx_, Z3_get_sort(ctx_, a));
+  uint64_t value;
+  // Wider numerals are not folded.
+  return width <= 64 && Z3_get_numeral_uint64(ctx_, a, &value) &&
+         value == (width == 64 ? ~uint64_t{0} : (uint64_t{1} << width) - 1);
+}
+
+Z3_ast StructuralHasher::UnwrapNot(Z3_ast a) const {
+  if (Z3_get_ast_kind(ctx_, a) != Z3_APP_AST) {
+    return nullptr;
+  }
+  Z3_app app = Z3_to_app(ctx_, a);
+  if (Z3_get_decl_kind(ctx_, Z3_get_app_decl(ctx_, app)) != Z3_OP_BNOT) {
+    return nullptr;
+  }
+  return Z3_get_app_arg(ctx_, app, 0);
+}
+
+bool StructuralHasher::IsComplement(Z3_ast a, Z3_ast b) const {
+  return UnwrapNot(a) == b || UnwrapNot(b) == a;
+}
+
+Z3_ast StructuralHasher::Zeros(Z3_ast like) const {
+  return Z3_mk_int(ctx_, 0, Z3_get_sort(ctx_, like));
+}
+
+Z3_ast StructuralHasher::Ones(Z3_ast like) const {
+  return Z3_mk_int(ctx_, -1, Z3_get_sort(ctx_, like));
+}
+
+Z3_ast StructuralHasher::Note(Z3_ast gate) {
+  unique_gates_.insert(Z3_get_ast_id(ctx_, gate));
+  return gate;
+}
+
+Z3_ast StructuralHasher::Not(Z3_ast a) {
+  ++gate_requests_;
+  if (Z3_ast operand = UnwrapNot(a); operand != nullptr) {
+    return operand;
+  }
+  return Note(Z3_mk_bvnot(ctx_, a));
+}
+
+Z3_ast StructuralHasher::And(Z3_ast a, Z3_ast b) {
+  ++gate_requests_;
+  if (IsAllZeros(a) || IsAllOnes(b)) {
+    return a;
+  }
+  if (IsAllZeros(b) || IsAllOnes(a) || a == b) {
+    return b;
+  }
+  if (IsComplement(a, b)) {
+    return Zeros(a);
+  }
+  if (Z3_get_ast_id(ctx_, a) > Z3_get_ast_id(ctx_, b)) {
+    std::swap(a, b);
+  }
+  return Note(Z3_mk_bvand(ctx_, a, b));
+}
+
+Z3_ast StructuralHasher::Or(Z3_ast a, Z3_ast b) {
+  ++gate_requests_;
+  if (IsAllOnes(a) || IsAllZeros(b)) {
+    return a;
+  }
+  if (IsAllOnes(b) || IsAllZeros(a) || a == b) {
+    return b;
+  }
+  if (IsComplement(a, b)) {
+    return Ones(a);
+  }
+  if (Z3_get_ast_id(ctx_, a) > Z3_get_ast_id(ctx_, b)) {
+    std::swap(a, b);
+  }
+  return Note(Z3_mk_bvor(ctx_, a, b));
+}
+
+Z3_ast StructuralHasher::Xor(Z3_ast a, Z3_ast b) {
+  if (IsAllZeros(a)) {
+    ++gate_requests_;
+    return b;
+  }
+  if (IsAllZeros(b)) {
+    ++gate_requests_;
+    return a;
+  }
+  if (a == b) {
+    ++gate_requests_;
+    return Zeros(a);
+  }
+  if (IsComplement(a, b)) {
+    ++gate_requests_;
+    return Ones(a);
+  }
+  // Push negations out of the xor so x ^ !y and !x ^ y share the gate x ^ y.
+  Z3_ast a_operand = UnwrapNot(a);
+  Z3_ast b_operand = UnwrapNot(b);
+  bool invert = (a_operand != nullptr) != (b_operand != nullptr);
+  if (a_operand != nullptr) {
+    a = a_operand;
+  }
+  if (b_operand != nullptr) {
+    b = b_operand;
+  }
+  if (IsAllOnes(a) || IsAllOnes(b)) {
+    // x ^ 1...1 == !x.
+    invert = !invert;
+    a = IsAllOnes(a) ? b : a;
+    return invert ? Not(a) : (++gate_requests_, a);
+  }
+  ++gate_requests_;
+  if (Z3_get_ast_id(ctx_, a) > Z3_get_ast_id(ctx_, b)) {
+    std::swap(a, b);
+  }
+  Z3_ast gate = Note(Z3_mk_bvxor(ctx_, a, b));
+  return invert ? Not(gate) : gate;
+}
+
+}  // namespace z3
+}  // namespace solvers
+}  // namespace xls
@@ -0,0 +1,86 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SOLVERS_Z3_STRUCTURAL_HASHER_H_
+#define XLS_SOLVERS_Z3_STRUCTURAL_HASHER_H_
+
+#include <cstdint>
+
+#include "absl/container/flat_hash_set.h"
+#include "../z3/src/api/z3.h"  // IWYU pragma: keep
+#include "../z3/src/api/z3_api.h"
+
+namespace xls {
+namespace solvers {
+namespace z3 {
+
+// Builds bitwise and/or/xor/not gates on Z3 bit vectors in a canonical form so
+// structurally equivalent gates map to the same Z3 term. Z3 already
+// hash-conses identical applications; on top of that the operands of
+// commutative gates are ordered, double negations are removed, and gates with
+// constant, identical or complementary operands are folded (as in an
+// and-inverter graph). Translators sharing a hasher (e.g., all modules of a
+// netlist, or both sides of an equivalence check) share their gates.
+class StructuralHasher {
+ public:
+  explicit StructuralHasher(Z3_context ctx) : ctx_(ctx) {}
+
+  Z3_ast And(Z3_ast a, Z3_ast b);
+  Z3_ast Or(Z3_ast a, Z3_ast b);
+  Z3_ast Xor(Z3_ast a, Z3_ast b);
+  Z3_ast Not(Z3_ast a);
+
+  // Returns the number of gates requested of the hasher.
+  int64_t gate_requests() const { return gate_requests_; }
+
+  // Returns the number of distinct gates created.
+  int64_t unique_gates() const { return unique_gates_.size(); }
+
+  // Returns the average number of requests served by each distinct gate. Gates
+  // folded to constants or operands count as requests but create no gate.
+  double sharing_ratio() const {
+    return unique_gates_.empty()
+               ? 1.0
+               : static_cast<double>(gate_requests_) / unique_gates_.size();
+  }
+
+ private:
+  // Returns whether `a` is a numeral with all bits zero (or one).
+  bool IsAllZeros(Z3_ast a) const;
+  bool IsAllOnes(Z3_ast a) const;
+
+  // Returns true if `a` is the bitwise negation of `b` or vice versa.
+  bool IsComplement(Z3_ast a, Z3_ast b) const;
+
+  // Returns the operand of `a` if `a` is a bitwise negation.
+  Z3_ast UnwrapNot(Z3_ast a) const;
+
+  Z3_ast Zeros(Z3_ast like) const;
+  Z3_ast Ones(Z3_ast like) const;
+
+  // Records `gate` as created and returns it.
+  Z3_ast Note(Z3_ast gate);
+
+  Z3_context ctx_;
+  int64_t gate_requests_ = 0;
+
+  // Z3 AST ids of the distinct gates created.
+  absl::flat_hash_set<unsigned> unique_gates_;
+};
+
+}  // namespace z3
+}  // namespace solvers
+}  // namespace xls
+
+#endif  // XLS_SOLVERS_Z3_STRUCTURAL_HASHER_H_
@@ -0,0 +1,88 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/z3_structural_hasher.h"
+
+#include "gtest/gtest.h"
+#include "../z3/src/api/z3.h"  // IWYU pragma: keep
+#include "../z3/src/api/z3_api.h"
+
+namespace xls::solvers::z3 {
+namespace {
+
+class StructuralHasherTest : public testing::Test {
+ public:
+  StructuralHasherTest() {
+    config_ = Z3_mk_config();
+    ctx_ = Z3_mk_context(config_);
+  }
+
+  ~StructuralHasherTest() override {
+    Z3_del_context(ctx_);
+    Z3_del_config(config_);
+  }
+
+ protected:
+  Z3_ast MakeParam(const char* name, int width = 1) {
+    return Z3_mk_const(ctx_, Z3_mk_string_symbol(ctx_, name),
+                       Z3_mk_bv_sort(ctx_, width));
+  }
+
+  Z3_ast MakeValue(int value, int width = 1) {
+    return Z3_mk_int(ctx_, value, Z3_mk_bv_sort(ctx_, width));
+  }
+
+  Z3_config config_;
+  Z3_context ctx_;
+};
+
+TEST_F(StructuralHasherTest, CommutativeGatesAreShared) {
+  StructuralHasher hasher(ctx_);
+  Z3_ast a = MakeParam("a");
+  Z3_ast b = MakeParam("b");
+  EXPECT_EQ(hasher.And(a, b), hasher.And(b, a));
+  EXPECT_EQ(hasher.Or(a, b), hasher.Or(b, a));
+  EXPECT_EQ(hasher.Xor(a, b), hasher.Xor(b, a));
+  EXPECT_EQ(hasher.gate_requests(), 6);
+  EXPECT_EQ(hasher.unique_gates(), 3);
+  EXPECT_DOUBLE_EQ(hasher.sharing_ratio(), 2.0);
+}
+
+TEST_F(StructuralHasherTest, TrivialGatesAreFolded) {
+  StructuralHasher hasher(ctx_);
+  Z3_ast a = MakeParam("a", 8);
+  Z3_ast b = MakeParam("b", 8);
+  Z3_ast zero = MakeValue(0, 8);
+  Z3_ast ones = MakeValue(255, 8);
+  Z3_ast not_a = hasher.Not(a);
+
+  EXPECT_EQ(hasher.Not(not_a), a);
+  EXPECT_EQ(hasher.And(a, a), a);
+  EXPECT_EQ(hasher.Or(a, a), a);
+  EXPECT_EQ(hasher.And(a, ones), a);
+  EXPECT_EQ(hasher.And(zero, a), zero);
+  EXPECT_EQ(hasher.Or(a, zero), a);
+  EXPECT_EQ(hasher.Or(ones, a), ones);
+  EXPECT_EQ(hasher.Xor(a, zero), a);
+  EXPECT_EQ(hasher.Xor(a, ones), not_a);
+  EXPECT_EQ(hasher.Xor(hasher.Not(a), b), hasher.Xor(a, hasher.Not(b)));
+
+  // Gates with complementary operands fold to constants.
+  EXPECT_TRUE(Z3_is_numeral_ast(ctx_, hasher.And(a, not_a)));
+  EXPECT_TRUE(Z3_is_numeral_ast(ctx_, hasher.Or(not_a, a)));
+  EXPECT_TRUE(Z3_is_numeral_ast(ctx_, hasher.Xor(a, a)));
+}
+
+}  // namespace
+}  // namespace xls::solvers::z3
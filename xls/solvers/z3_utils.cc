@@ -14,6 +14,7 @@
 #include "xls/solvers/z3_utils.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -21,6 +22,7 @@
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/source_location.h"
 #include "xls/ir/bits.h"
@@ -107,6 +109,23 @@ Z3_solver CreateSolver(Z3_context ctx, int num_threads) {
   return solver;
 }
 
+Z3_lbool ProveEachIncrementally(Z3_context ctx, Z3_solver solver,
+                                absl::Span<const Z3_ast> conditions,
+                                int64_t* failing_index) {
+  for (int64_t i = 0; i < conditions.size(); ++i) {
+    Z3_solver_push(ctx, solver);
+    Z3_solver_assert(ctx, solver, Z3_mk_not(ctx, conditions[i]));
+    Z3_lbool result = Z3_solver_check(ctx, solver);
+    if (result != Z3_L_FALSE) {
+      *failing_index = i;
+      return result;
+    }
+    Z3_solver_pop(ctx, solver, 1);
+    Z3_solver_assert(ctx, solver, conditions[i]);
+  }
+  return Z3_L_FALSE;
+}
+
 std::string SolverResultToString(Z3_context ctx, Z3_solver solver,
                                  Z3_lbool satisfiable, bool hexify) {
   std::string result_str;
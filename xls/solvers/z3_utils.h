@@ -16,9 +16,11 @@
 #ifndef XLS_SOLVERS_Z3_UTILS_H_
 #define XLS_SOLVERS_Z3_UTILS_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
+#include "absl/types/span.h"
 #include "xls/common/source_location.h"
 #include "xls/ir/type.h"
 #include "../z3/src/api/z3.h"  // IWYU pragma: keep
@@ -54,6 +56,22 @@ class ScopedErrorHandler {
 // needed.
 Z3_solver CreateSolver(Z3_context ctx, int num_threads);
 
+// Tries to prove each of the boolean "conditions" in turn on "solver", which is
+// shared across the checks so that Z3 can reuse what it learns from one to the
+// next: each check pushes a scope asserting the negated condition, and once a
+// condition is proven it is asserted in the base scope as a lemma for the
+// checks that follow. This is often much faster than one query over the
+// conjunction when the conditions are, e.g., the individual bits of a wide
+// output.
+//
+// Returns Z3_L_FALSE if every condition holds. Otherwise returns the result
+// (Z3_L_TRUE or Z3_L_UNDEF) of the first condition that could not be proven and
+// sets "failing_index" to its index; that check's scope is left on the solver
+// so a counterexample model can be retrieved from it.
+Z3_lbool ProveEachIncrementally(Z3_context ctx, Z3_solver solver,
+                                absl::Span<const Z3_ast> conditions,
+                                int64_t* failing_index);
+
 // Printing / output functions ------------------------------------------------
 // Prints the solver's result, and, if satisfiable, prints a model demonstrating
 // such a case.
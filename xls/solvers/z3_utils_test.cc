@@ -13,10 +13,15 @@
 // limitations under the License.
 #include "xls/solvers/z3_utils.h"
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/types/span.h"
+#include "xls/solvers/z3_utils.h"
+#include "../z3/src/api/z3_api.h"
 
 namespace {
 
@@ -29,4 +34,37 @@ TEST(Z3UtilsTest, Hexifies) {
             "This is some fun text. It has a boolean string, #xa5a5 .");
 }
 
+TEST(Z3UtilsTest, ProveEachIncrementally) {
+  Z3_config config = Z3_mk_config();
+  Z3_context ctx = Z3_mk_context(config);
+  Z3_sort sort = Z3_mk_bv_sort(ctx, 8);
+  Z3_ast x = Z3_mk_const(ctx, Z3_mk_string_symbol(ctx, "x"), sort);
+  Z3_ast zero = Z3_mk_int(ctx, 0, sort);
+  Z3_ast one = Z3_mk_int(ctx, 1, sort);
+  std::vector<Z3_ast> conditions = {
+      Z3_mk_eq(ctx, Z3_mk_bvadd(ctx, x, zero), x),
+      Z3_mk_eq(ctx, Z3_mk_bvxor(ctx, x, x), zero),
+      Z3_mk_eq(ctx, Z3_mk_bvand(ctx, x, one), one),
+      Z3_mk_eq(ctx, x, x),
+  };
+  Z3_solver solver = xls::solvers::z3::CreateSolver(ctx, /*num_threads=*/1);
+
+  int64_t failing_index = -1;
+  EXPECT_EQ(xls::solvers::z3::ProveEachIncrementally(
+                ctx, solver, absl::MakeConstSpan(conditions).first(2),
+                &failing_index),
+            Z3_L_FALSE);
+  EXPECT_EQ(failing_index, -1);
+
+  // The third condition doesn't hold for even x.
+  EXPECT_EQ(xls::solvers::z3::ProveEachIncrementally(ctx, solver, conditions,
+                                                     &failing_index),
+            Z3_L_TRUE);
+  EXPECT_EQ(failing_index, 2);
+
+  Z3_solver_dec_ref(ctx, solver);
+  Z3_del_context(ctx);
+  Z3_del_config(config);
+}
+
 }  // namespace
@@ -26,6 +26,7 @@
 #include "grpcpp/server_builder.h"
 #include "grpcpp/server_context.h"
 #include "grpcpp/support/status.h"
+#include "grpcpp/support/sync_stream.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
 #include "xls/synthesis/credentials.h"
@@ -36,7 +37,8 @@
 const char kUsage[] = R"(
 Launches a XLS synthesis server which serves fake results. The flag
 --max_frequency_ghz is used to determine whether a negative slack value is
-returned in the response.
+returned in the response. Both single compile requests and batches of
+requests streamed over one call are served.
 
 Invocation:
 
@@ -63,12 +65,41 @@ class FakeSynthesisServiceImpl : public SynthesisService::Service {
   ::grpc::Status Compile(::grpc::ServerContext* server_context,
                          const CompileRequest* request,
                          CompileResponse* result) override {
+    return FakeCompile(*request, result);
+  }
+
+  ::grpc::Status BatchCompile(
+      ::grpc::ServerContext* server_context,
+      ::grpc::ServerReaderWriter<BatchCompileResponse, BatchCompileRequest>*
+          stream) override {
+    BatchCompileRequest request;
+    while (stream->Read(&request)) {
+      BatchCompileResponse response;
+      response.set_index(request.index());
+      ::grpc::Status status =
+          FakeCompile(request.request(), response.mutable_response());
+      if (!status.ok()) {
+        response.clear_response();
+        response.set_error_code(status.error_code());
+        response.set_error_message(status.error_message());
+      }
+      if (!stream->Write(response)) {
+        return ::grpc::Status(grpc::StatusCode::CANCELLED,
+                              "Client closed the stream");
+      }
+    }
+    return ::grpc::Status::OK;
+  }
+
+ private:
+  ::grpc::Status FakeCompile(const CompileRequest& request,
+                             CompileResponse* result) const {
     auto start = absl::Now();
 
     result->set_slack_ps(
-        request->target_frequency_hz() <= max_frequency_hz_
+        request.target_frequency_hz() <= max_frequency_hz_
             ? 0
-            : static_cast<int64_t>(1e12L / request->target_frequency_hz() -
+            : static_cast<int64_t>(1e12L / request.target_frequency_hz() -
                                    1e12L / max_frequency_hz_));
     result->set_power(42);
     result->set_area(123);
@@ -82,7 +113,6 @@ class FakeSynthesisServiceImpl : public SynthesisService::Service {
     return ::grpc::Status::OK;
   }
 
- private:
   int64_t max_frequency_hz_;
   bool serve_errors_;
 };
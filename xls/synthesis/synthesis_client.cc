@@ -14,17 +14,25 @@
 
 #include "xls/synthesis/synthesis_client.h"
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "grpcpp/support/status.h"
 #include "grpcpp/channel.h"
 #include "grpcpp/client_context.h"
 #include "grpcpp/create_channel.h"
 #include "grpcpp/security/credentials.h"
+#include "grpcpp/support/sync_stream.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/synthesis/credentials.h"
 #include "xls/synthesis/synthesis.pb.h"
 #include "xls/synthesis/synthesis_service.grpc.pb.h"
@@ -40,17 +48,17 @@ static absl::Status GrpcToAbslStatus(const grpc::Status& grpc_status) {
       grpc_status.error_message());
 }
 
-// This creates a new channel and stub *each* invocation
-absl::StatusOr<CompileResponse> SynthesizeViaClient(
-    const std::string& server,
-    const CompileRequest& request) {
+static std::unique_ptr<SynthesisService::Stub> NewStub(
+    const std::string& server) {
   // Create a channel, a logical connection an endpoint.
   std::shared_ptr<grpc::ChannelCredentials> creds = GetChannelCredentials();
   std::shared_ptr<grpc::Channel> channel = grpc::CreateChannel(server, creds);
   // Creation of a RPC stub for the channel.
-  std::unique_ptr<SynthesisService::Stub> stub(
-      SynthesisService::NewStub(channel));
+  return SynthesisService::NewStub(channel);
+}
 
+static absl::StatusOr<CompileResponse> Compile(
+    SynthesisService::Stub& stub, const CompileRequest& request) {
   // Context for the client. It could be used to convey extra information to
   // the server and/or tweak certain RPC behaviors.
   grpc::ClientContext context;
@@ -58,9 +66,107 @@ absl::StatusOr<CompileResponse> SynthesizeViaClient(
   // The actual RPC.
   CompileResponse response;
   XLS_RETURN_IF_ERROR(
-      GrpcToAbslStatus(stub->Compile(&context, request, &response)));
+      GrpcToAbslStatus(stub.Compile(&context, request, &response)));
   return response;
 }
 
+// This creates a new channel and stub *each* invocation
+absl::StatusOr<CompileResponse> SynthesizeViaClient(
+    const std::string& server,
+    const CompileRequest& request) {
+  std::unique_ptr<SynthesisService::Stub> stub = NewStub(server);
+  return Compile(*stub, request);
+}
+
+absl::Status SynthesizeBatchViaClient(const std::string& server,
+                                      absl::Span<const CompileRequest> requests,
+                                      const BatchCompileCallback& callback) {
+  std::unique_ptr<SynthesisService::Stub> stub = NewStub(server);
+  std::vector<bool> received(requests.size(), false);
+  int64_t received_count = 0;
+  grpc::Status grpc_status;
+  {
+    grpc::ClientContext context;
+    std::unique_ptr<
+        grpc::ClientReaderWriter<BatchCompileRequest, BatchCompileResponse>>
+        stream = stub->BatchCompile(&context);
+
+    // Requests are written from a separate thread so that responses are
+    // consumed as soon as they arrive rather than after the whole batch has
+    // been sent.
+    Thread writer([&]() {
+      for (int64_t i = 0; i < requests.size(); ++i) {
+        BatchCompileRequest batch_request;
+        batch_request.set_index(i);
+        *batch_request.mutable_request() = requests[i];
+        if (!stream->Write(batch_request)) {
+          // The stream is broken; Finish reports why.
+          break;
+        }
+      }
+      stream->WritesDone();
+    });
+
+    BatchCompileResponse batch_response;
+    while (stream->Read(&batch_response)) {
+      int64_t index = batch_response.index();
+      if (index < 0 || index >= requests.size() || received[index]) {
+        context.TryCancel();
+        writer.Join();
+        stream->Finish().IgnoreError();
+        return absl::InternalError(absl::StrFormat(
+            "Unexpected response index %d in a batch of %d requests", index,
+            requests.size()));
+      }
+      received[index] = true;
+      ++received_count;
+      if (batch_response.error_code() != 0) {
+        callback(index,
+                 absl::Status(static_cast<absl::StatusCode>(
+                                  batch_response.error_code()),
+                              batch_response.error_message()));
+      } else {
+        callback(index, std::move(*batch_response.mutable_response()));
+      }
+    }
+    writer.Join();
+    grpc_status = stream->Finish();
+  }
+
+  if (grpc_status.error_code() == grpc::StatusCode::UNIMPLEMENTED &&
+      received_count == 0) {
+    // Older servers only implement the unary call.
+    for (int64_t i = 0; i < requests.size(); ++i) {
+      callback(i, Compile(*stub, requests[i]));
+    }
+    return absl::OkStatus();
+  }
+  XLS_RETURN_IF_ERROR(GrpcToAbslStatus(grpc_status));
+  if (received_count != requests.size()) {
+    return absl::InternalError(
+        absl::StrFormat("Received %d responses to a batch of %d requests",
+                        received_count, requests.size()));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<CompileResponse>> SynthesizeBatchViaClient(
+    const std::string& server, absl::Span<const CompileRequest> requests) {
+  std::vector<std::optional<absl::StatusOr<CompileResponse>>> results(
+      requests.size());
+  XLS_RETURN_IF_ERROR(SynthesizeBatchViaClient(
+      server, requests,
+      [&](int64_t index, absl::StatusOr<CompileResponse> result) {
+        results[index] = std::move(result);
+      }));
+  std::vector<CompileResponse> responses;
+  responses.reserve(results.size());
+  for (std::optional<absl::StatusOr<CompileResponse>>& result : results) {
+    XLS_RETURN_IF_ERROR(result->status());
+    responses.push_back(std::move(result->value()));
+  }
+  return responses;
+}
+
 }  // namespace synthesis
 }  // namespace xls
@@ -15,9 +15,14 @@
 #ifndef XLS_SYNTHESIS_CLIENT_H_
 #define XLS_SYNTHESIS_CLIENT_H_
 
+#include <cstdint>
+#include <functional>
 #include <string>
+#include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/synthesis/synthesis.pb.h"
 
 namespace xls {
@@ -28,6 +33,26 @@ absl::StatusOr<CompileResponse> SynthesizeViaClient(
     const std::string& server,
     const CompileRequest& request);
 
+// Called with the index of a request within the batch passed to
+// SynthesizeBatchViaClient and the result of synthesizing it.
+using BatchCompileCallback =
+    std::function<void(int64_t index, absl::StatusOr<CompileResponse> result)>;
+
+// Synthesizes all of "requests" over a single streaming call on one channel,
+// invoking "callback" for each request as its result arrives (in completion
+// order, not request order). Failures of individual requests are passed to the
+// callback; the returned status reports failures of the call itself. Falls
+// back to one Compile call per request if the server does not implement
+// BatchCompile.
+absl::Status SynthesizeBatchViaClient(const std::string& server,
+                                      absl::Span<const CompileRequest> requests,
+                                      const BatchCompileCallback& callback);
+
+// As above, but returns the responses in the order of "requests", or the first
+// error (in request order) if any request failed.
+absl::StatusOr<std::vector<CompileResponse>> SynthesizeBatchViaClient(
+    const std::string& server, absl::Span<const CompileRequest> requests);
+
 }  // namespace synthesis
 }  // namespace xls
 
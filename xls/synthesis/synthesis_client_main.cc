@@ -42,7 +42,11 @@ The default port matches that used by the Yosys synth server.
        [--port=10000] \
        [--server=localhost] \
        [--top="main"] \
-       <path_to_verilog>
+       <path_to_verilog>...
+
+If more than one Verilog file is given, all of them are synthesized over a
+single streaming call and the responses are printed in the order of the files,
+each preceded by a comment line naming its file.
 )";
 
 int main(int argc, char** argv) {
@@ -59,18 +63,33 @@ int main(int argc, char** argv) {
       static_cast<int64_t>(absl::GetFlag(FLAGS_ghz) * 1e9));
 
   // Check that input Verilog is provided, and get it
-  if (positional_arguments.size() != 1) {
+  if (positional_arguments.empty()) {
     XLS_LOG(QFATAL) << absl::StrCat("Expected invocation: ", argv[0],
-                                    " [flags] VERILOG_FILE\n");
+                                    " [flags] VERILOG_FILE...\n");
+  }
+  std::vector<xls::synthesis::CompileRequest> requests;
+  for (std::string_view vpath : positional_arguments) {
+    absl::StatusOr<std::string> verilog_contents = xls::GetFileContents(vpath);
+    XLS_QCHECK_OK(verilog_contents.status());
+    request.set_module_text(verilog_contents.value());
+    requests.push_back(request);
+  }
+
+  if (requests.size() > 1) {
+    absl::StatusOr<std::vector<xls::synthesis::CompileResponse>> responses =
+        xls::synthesis::SynthesizeBatchViaClient(server, requests);
+    if (responses.ok()) {
+      for (int64_t i = 0; i < responses->size(); ++i) {
+        std::cout << "# " << positional_arguments[i] << '\n'
+                  << responses->at(i).DebugString() << '\n';
+      }
+    }
+    return xls::ExitStatus(responses.status());
   }
-  std::string_view vpath = positional_arguments[0];
-  absl::StatusOr<std::string> verilog_contents = xls::GetFileContents(vpath);
-  XLS_QCHECK_OK(verilog_contents.status());
-  request.set_module_text(verilog_contents.value());
 
   // Use the client to perform the RPC
   absl::StatusOr<xls::synthesis::CompileResponse> compile_response_status =
-      xls::synthesis::SynthesizeViaClient(server, request);
+      xls::synthesis::SynthesizeViaClient(server, requests.front());
 
   // Examine the response
   if (compile_response_status.ok()) {
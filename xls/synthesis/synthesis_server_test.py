@@ -72,6 +72,42 @@ class SynthesisServerTest(absltest.TestCase):
     proc.terminate()
     proc.wait()
 
+  def test_batch(self):
+    port, proc = self._start_server(['--max_frequency_ghz=2.0'])
+
+    verilog_files = [self.create_tempfile(content=VERILOG) for _ in range(3)]
+
+    output = subprocess.check_output(
+        [CLIENT_PATH] + [f.full_path for f in verilog_files] +
+        [f'--port={port}', '--ghz=4.0']).decode('utf-8')
+
+    # Each response is preceded by a comment line naming its file.
+    chunks = output.split('# ')[1:]
+    self.assertLen(chunks, len(verilog_files))
+    for verilog_file, chunk in zip(verilog_files, chunks):
+      path, response_text = chunk.split('\n', 1)
+      self.assertEqual(path, verilog_file.full_path)
+      response = text_format.Parse(response_text,
+                                   synthesis_pb2.CompileResponse())
+      self.assertLess(response.slack_ps, 0)
+
+    proc.terminate()
+    proc.wait()
+
+  def test_batch_error(self):
+    port, proc = self._start_server(
+        ['--max_frequency_ghz=2.0', '--serve_errors'])
+
+    verilog_files = [self.create_tempfile(content=VERILOG) for _ in range(2)]
+    # pylint: disable=subprocess-run-check
+    comp = subprocess.run([CLIENT_PATH] + [f.full_path for f in verilog_files] +
+                          [f'--port={port}', '--ghz=1.0'])
+
+    self.assertNotEqual(comp.returncode, 0)
+
+    proc.terminate()
+    proc.wait()
+
   def test_error(self):
     port, proc = self._start_server(
         ['--max_frequency_ghz=2.0', '--serve_errors'])
@@ -127,7 +127,7 @@ absl::Status RealMain(std::string_view input_path) {
     std::cout << "Bits in graph: " << number_bits << "\n";
 
     int64_t max_paths = 0;
-    for (int64_t i = 0; i < bdd_function->bdd().size(); ++i) {
+    for (int64_t i = 0; i < bdd_function->bdd().node_index_limit(); ++i) {
       max_paths =
           std::max(max_paths, bdd_function->bdd().path_count(BddNodeIndex(i)));
     }
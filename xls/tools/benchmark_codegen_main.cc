@@ -12,15 +12,22 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
 #include "absl/time/time.h"
@@ -30,7 +37,9 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/block.h"
 #include "xls/ir/ir_parser.h"
@@ -38,6 +47,8 @@
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/run_pipeline_schedule.h"
 #include "xls/scheduling/scheduling_options.h"
+#include "xls/tools/codegen.h"
+#include "xls/tools/codegen_flags.pb.h"
 #include "xls/tools/scheduling_options_flags.h"
 #include "xls/tools/scheduling_options_flags.pb.h"
 
@@ -48,11 +59,32 @@ file. Designed to be used with run_benchmarks.py script.
 Usage:
    benchmark_codegen_main --delay_model=DELAY_MODEL \
      OPT_IR_FILE BLOCK_IR_FILE VERILOG_FILE
+
+In sweep mode (any of the --sweep_* lists is given), schedules and generates a
+pipeline for each combination of the listed clock periods, pipeline stage
+counts and delay models and prints a table of the resulting designs:
+   benchmark_codegen_main --sweep_clock_periods_ps=500,1000 \
+     --sweep_pipeline_stages=2,4 --delay_model=DELAY_MODEL OPT_IR_FILE
 )";
 
 ABSL_FLAG(std::string, top, "",
           "Name of top block to use in lieu of the default.");
 ABSL_FLAG(bool, schedule, true, "Enable running the scheduler.");
+ABSL_FLAG(std::vector<std::string>, sweep_clock_periods_ps,
+          std::vector<std::string>(),
+          "Comma-separated list of clock periods to sweep over. If empty, "
+          "--clock_period_ps is used.");
+ABSL_FLAG(std::vector<std::string>, sweep_pipeline_stages,
+          std::vector<std::string>(),
+          "Comma-separated list of pipeline stage counts to sweep over. If "
+          "empty, --pipeline_stages is used.");
+ABSL_FLAG(std::vector<std::string>, sweep_delay_models,
+          std::vector<std::string>(),
+          "Comma-separated list of delay models to sweep over. If empty, "
+          "--delay_model is used.");
+ABSL_FLAG(int64_t, sweep_threads, 0,
+          "Number of configurations of a sweep to run concurrently. If zero, "
+          "the number of hardware threads is used.");
 
 namespace xls {
 namespace {
@@ -92,6 +124,229 @@ absl::StatusOr<Block*> GetTopBlock(Package* package) {
   return top.value()->AsBlockOrDie();
 }
 
+// A point of the design space explored by a sweep. Unset fields take their
+// values from the scheduling flags.
+struct SweepPoint {
+  std::optional<int64_t> clock_period_ps;
+  std::optional<int64_t> pipeline_stages;
+  std::optional<std::string> delay_model;
+};
+
+// Metrics of the pipeline generated for a sweep point.
+struct SweepResult {
+  absl::Status status;
+  int64_t stages = 0;
+  int64_t flop_count = 0;
+  // The longest delay between registers and/or ports of the pipeline.
+  int64_t critical_path_ps = 0;
+  // Time taken to schedule and generate the pipeline.
+  absl::Duration runtime;
+};
+
+absl::StatusOr<std::vector<int64_t>> ParseSweepValues(
+    std::string_view flag_name, const std::vector<std::string>& values) {
+  std::vector<int64_t> result;
+  for (const std::string& value : values) {
+    int64_t parsed;
+    if (!absl::SimpleAtoi(value, &parsed)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Invalid value in --%s: \"%s\"", flag_name, value));
+    }
+    result.push_back(parsed);
+  }
+  return result;
+}
+
+absl::StatusOr<SweepResult> RunSweepPoint(
+    std::string_view opt_ir_contents,
+    SchedulingOptionsFlagsProto scheduling_options_flags_proto,
+    const SweepPoint& point) {
+  if (point.clock_period_ps.has_value()) {
+    scheduling_options_flags_proto.set_clock_period_ps(*point.clock_period_ps);
+  }
+  if (point.pipeline_stages.has_value()) {
+    scheduling_options_flags_proto.set_pipeline_stages(*point.pipeline_stages);
+  }
+  if (point.delay_model.has_value()) {
+    scheduling_options_flags_proto.set_delay_model(*point.delay_model);
+  }
+  // Concurrent runs must not race on the delay cache file.
+  scheduling_options_flags_proto.clear_delay_cache_path();
+  CodegenFlagsProto codegen_flags_proto;
+  codegen_flags_proto.set_generator(GENERATOR_KIND_PIPELINE);
+  codegen_flags_proto.set_flop_inputs(true);
+  codegen_flags_proto.set_flop_outputs(true);
+
+  SweepResult result;
+  absl::Time start = absl::Now();
+  // Scheduling and codegen modify the package, so each point works on its own
+  // copy of the optimized IR.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(opt_ir_contents));
+  absl::StatusOr<CodegenResult> codegen_result =
+      ScheduleAndCodegen(package.get(), scheduling_options_flags_proto,
+                         codegen_flags_proto, /*with_delay_model=*/true);
+  result.runtime = absl::Now() - start;
+  if (!codegen_result.ok()) {
+    result.status = codegen_result.status();
+    return result;
+  }
+  XLS_RET_CHECK(codegen_result->pipeline_schedule_proto.has_value());
+  result.stages = codegen_result->pipeline_schedule_proto->stages_size();
+
+  XLS_ASSIGN_OR_RETURN(
+      Block * block,
+      package->GetBlock(
+          codegen_result->module_generator_result.signature.module_name()));
+  XLS_ASSIGN_OR_RETURN(const DelayEstimator* delay_estimator,
+                       SetUpDelayEstimator(scheduling_options_flags_proto));
+  XLS_ASSIGN_OR_RETURN(verilog::BlockMetricsProto metrics,
+                       verilog::GenerateBlockMetrics(block, delay_estimator));
+  result.flop_count = metrics.flop_count();
+  result.critical_path_ps = std::max(
+      {metrics.max_reg_to_reg_delay_ps(), metrics.max_input_to_reg_delay_ps(),
+       metrics.max_reg_to_output_delay_ps(),
+       metrics.max_feedthrough_path_delay_ps()});
+  return result;
+}
+
+// Schedules and generates a pipeline for every combination of the swept
+// values, running up to --sweep_threads combinations concurrently, and prints
+// the metrics of each. Designs which no other design beats or matches in
+// every one of stage count, flop count and critical path are marked as
+// Pareto-optimal.
+absl::Status RealMainSweep(std::string_view opt_ir_path) {
+  XLS_VLOG(1) << "Reading optimized IR file: " << opt_ir_path;
+  XLS_ASSIGN_OR_RETURN(std::string opt_ir_contents,
+                       GetFileContents(opt_ir_path));
+  // Check the IR once up front rather than in every configuration.
+  XLS_RETURN_IF_ERROR(Parser::ParsePackage(opt_ir_contents).status());
+  XLS_ASSIGN_OR_RETURN(
+      SchedulingOptionsFlagsProto scheduling_options_flags_proto,
+      GetSchedulingOptionsFlagsProto());
+
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<int64_t> clock_periods,
+      ParseSweepValues("sweep_clock_periods_ps",
+                       absl::GetFlag(FLAGS_sweep_clock_periods_ps)));
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<int64_t> pipeline_stages,
+      ParseSweepValues("sweep_pipeline_stages",
+                       absl::GetFlag(FLAGS_sweep_pipeline_stages)));
+  std::vector<std::string> delay_models =
+      absl::GetFlag(FLAGS_sweep_delay_models);
+
+  std::vector<std::optional<int64_t>> clock_period_options = {std::nullopt};
+  if (!clock_periods.empty()) {
+    clock_period_options.assign(clock_periods.begin(), clock_periods.end());
+  }
+  std::vector<std::optional<int64_t>> pipeline_stage_options = {std::nullopt};
+  if (!pipeline_stages.empty()) {
+    pipeline_stage_options.assign(pipeline_stages.begin(),
+                                  pipeline_stages.end());
+  }
+  std::vector<std::optional<std::string>> delay_model_options = {std::nullopt};
+  if (!delay_models.empty()) {
+    delay_model_options.assign(delay_models.begin(), delay_models.end());
+  }
+  std::vector<SweepPoint> points;
+  for (const std::optional<std::string>& delay_model : delay_model_options) {
+    for (const std::optional<int64_t>& clock_period_ps :
+         clock_period_options) {
+      for (const std::optional<int64_t>& stages : pipeline_stage_options) {
+        SweepPoint point{clock_period_ps, stages, delay_model};
+        if (!point.clock_period_ps.has_value() &&
+            !point.pipeline_stages.has_value() &&
+            scheduling_options_flags_proto.clock_period_ps() == 0 &&
+            scheduling_options_flags_proto.pipeline_stages() == 0) {
+          return absl::InvalidArgumentError(
+              "Each configuration of a sweep needs a clock period or a "
+              "pipeline stage count.");
+        }
+        points.push_back(std::move(point));
+      }
+    }
+  }
+
+  int64_t num_threads = absl::GetFlag(FLAGS_sweep_threads);
+  if (num_threads <= 0) {
+    num_threads = std::max<int64_t>(1, std::thread::hardware_concurrency());
+  }
+  num_threads = std::min<int64_t>(num_threads, points.size());
+  std::vector<absl::StatusOr<SweepResult>> results(
+      points.size(), absl::UnknownError("Not run"));
+  std::atomic<int64_t> next_point = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_point++; i < points.size(); i = next_point++) {
+      results[i] = RunSweepPoint(opt_ir_contents,
+                                 scheduling_options_flags_proto, points[i]);
+    }
+  };
+  absl::Time start = absl::Now();
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < num_threads; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  worker();
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  absl::Duration total_time = absl::Now() - start;
+
+  for (const absl::StatusOr<SweepResult>& result : results) {
+    XLS_RETURN_IF_ERROR(result.status());
+  }
+  auto dominates = [](const SweepResult& a, const SweepResult& b) {
+    return a.stages <= b.stages && a.flop_count <= b.flop_count &&
+           a.critical_path_ps <= b.critical_path_ps &&
+           (a.stages < b.stages || a.flop_count < b.flop_count ||
+            a.critical_path_ps < b.critical_path_ps);
+  };
+
+  std::cout << absl::StreamFormat("%-14s %-10s %-16s %6s %8s %15s %12s %s\n",
+                                  "Clock period", "Stages", "Delay model",
+                                  "Actual", "Flops", "Critical path",
+                                  "Runtime", "Pareto");
+  for (int64_t i = 0; i < points.size(); ++i) {
+    const SweepPoint& point = points[i];
+    const SweepResult& result = *results[i];
+    // Unconstrained clock periods and stage counts are shown as "-".
+    int64_t shown_clock_period_ps = point.clock_period_ps.value_or(
+        scheduling_options_flags_proto.clock_period_ps());
+    int64_t shown_pipeline_stages = point.pipeline_stages.value_or(
+        scheduling_options_flags_proto.pipeline_stages());
+    std::string clock_period = shown_clock_period_ps == 0
+                                   ? "-"
+                                   : absl::StrCat(shown_clock_period_ps, "ps");
+    std::string stages =
+        shown_pipeline_stages == 0 ? "-" : absl::StrCat(shown_pipeline_stages);
+    std::string delay_model = point.delay_model.value_or(
+        scheduling_options_flags_proto.delay_model());
+    if (!result.status.ok()) {
+      std::cout << absl::StreamFormat("%-14s %-10s %-16s failed (%dms): %s\n",
+                                      clock_period, stages, delay_model,
+                                      result.runtime / absl::Milliseconds(1),
+                                      result.status.message());
+      continue;
+    }
+    bool pareto = true;
+    for (const absl::StatusOr<SweepResult>& other : results) {
+      if (other->status.ok() && dominates(*other, result)) {
+        pareto = false;
+        break;
+      }
+    }
+    std::cout << absl::StreamFormat(
+        "%-14s %-10s %-16s %6d %8d %13dps %10dms %s\n", clock_period, stages,
+        delay_model, result.stages, result.flop_count, result.critical_path_ps,
+        result.runtime / absl::Milliseconds(1), pareto ? "*" : "");
+  }
+  std::cout << absl::StreamFormat(
+      "Sweep time: %dms (%d configurations on %d threads)\n",
+      total_time / absl::Milliseconds(1), points.size(), num_threads);
+  return absl::OkStatus();
+}
+
 absl::Status RealMain(std::string_view opt_ir_path,
                       std::string_view block_ir_path,
                       std::string_view verilog_path) {
@@ -150,6 +405,18 @@ absl::Status RealMain(std::string_view opt_ir_path,
     std::cout << absl::StreamFormat("Max feedthrough path delay: %dps\n",
                                     metrics.max_feedthrough_path_delay_ps());
   }
+  for (const verilog::FeedthroughPathProto& path :
+       metrics.feedthrough_paths()) {
+    std::cout << absl::StreamFormat("  Feedthrough path: %s -> %s",
+                                    path.input_port(), path.output_port());
+    if (path.has_delay_ps()) {
+      std::cout << absl::StreamFormat(" (%dps)", path.delay_ps());
+    }
+    std::cout << "\n";
+  }
+  std::cout << absl::StreamFormat("Max fanout: %d\n", metrics.max_fanout());
+  std::cout << absl::StreamFormat("Average fanout: %.2f\n",
+                                  metrics.average_fanout());
   std::cout << absl::StreamFormat(
       "Lines of Verilog: %d\n",
       std::vector<std::string>(absl::StrSplit(verilog_contents, '\n')).size());
@@ -164,6 +431,16 @@ int main(int argc, char** argv) {
   std::vector<std::string_view> positional_arguments =
       xls::InitXls(kUsage, argc, argv);
 
+  if (!absl::GetFlag(FLAGS_sweep_clock_periods_ps).empty() ||
+      !absl::GetFlag(FLAGS_sweep_pipeline_stages).empty() ||
+      !absl::GetFlag(FLAGS_sweep_delay_models).empty()) {
+    if (positional_arguments.size() != 1) {
+      XLS_LOG(QFATAL) << absl::StreamFormat(
+          "Expected invocation:\n  %s --sweep_... OPT_IR_FILE", argv[0]);
+    }
+    return xls::ExitStatus(xls::RealMainSweep(positional_arguments[0]));
+  }
+
   if (positional_arguments.size() != 3) {
     XLS_LOG(QFATAL) << absl::StreamFormat(
         "Expected invocation:\n  %s OPT_IR_FILE BLOCK_IR_FILE VERILOG_FILE",
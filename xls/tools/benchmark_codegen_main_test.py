@@ -103,6 +103,38 @@ class CodeGenMainTest(test_base.TestCase):
     self.assertNotIn('Max reg-to-output delay', output)
     self.assertIn('Lines of Verilog: 7', output)
 
+  def test_sweep(self):
+    opt_ir_file = self.create_tempfile(content=OPT_IR)
+    output = subprocess.check_output([
+        BENCHMARK_CODEGEN_MAIN_PATH, '--delay_model=unit',
+        '--sweep_pipeline_stages=1,2,3', '--sweep_threads=2',
+        opt_ir_file.full_path
+    ]).decode('utf-8')
+
+    lines = output.strip().splitlines()
+    self.assertIn('Critical path', lines[0])
+    self.assertLen(lines, 5)
+    for line, stages in zip(lines[1:4], ('1', '2', '3')):
+      self.assertEqual(line.split()[1], stages)
+      self.assertEqual(line.split()[3], stages)
+      self.assertNotIn('failed', line)
+    # Fewer stages give fewer flops, so the single stage design is optimal.
+    self.assertTrue(lines[1].endswith('*'))
+    self.assertIn('3 configurations on 2 threads', lines[4])
+
+  def test_sweep_infeasible_configuration(self):
+    opt_ir_file = self.create_tempfile(content=OPT_IR)
+    output = subprocess.check_output([
+        BENCHMARK_CODEGEN_MAIN_PATH, '--delay_model=unit',
+        '--pipeline_stages=1', '--sweep_clock_periods_ps=1,10',
+        opt_ir_file.full_path
+    ]).decode('utf-8')
+
+    lines = output.strip().splitlines()
+    self.assertLen(lines, 4)
+    self.assertIn('failed', lines[1])
+    self.assertNotIn('failed', lines[2])
+
 
 if __name__ == '__main__':
   absltest.main()
@@ -37,7 +37,9 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/math_util.h"
+#include "xls/common/memory_usage.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/data_structures/binary_decision_diagram.h"
 #include "xls/delay_model/analyze_critical_path.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/delay_model/delay_estimators.h"
@@ -52,6 +54,7 @@
 #include "xls/passes/optimization_pass_pipeline.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/scheduling_pass_pipeline.h"
+#include "xls/scheduling/state_backedge_analysis.h"
 
 const char kUsage[] = R"(
 Prints numerous metrics and other information about an XLS IR file including:
@@ -134,6 +137,21 @@ int64_t DurationToMs(absl::Duration duration) {
   return duration / absl::Milliseconds(1);
 }
 
+int64_t BytesToMiB(int64_t bytes) { return bytes >> 20; }
+
+// Prints the resident set size of the process and its high-water mark so far,
+// if the platform exposes them.
+void PrintMemoryUsage(std::string_view phase) {
+  std::optional<int64_t> rss = GetCurrentRssBytes();
+  std::optional<int64_t> peak_rss = GetPeakRssBytes();
+  if (!rss.has_value() || !peak_rss.has_value()) {
+    return;
+  }
+  std::cout << absl::StreamFormat(
+      "Memory after %s: RSS %dMiB, peak RSS %dMiB\n", phase, BytesToMiB(*rss),
+      BytesToMiB(*peak_rss));
+}
+
 // Run the standard pipeline on the given package and prints stats about the
 // passes and execution time.
 absl::Status RunOptimizationAndPrintStats(Package* package) {
@@ -150,6 +168,8 @@ absl::Status RunOptimizationAndPrintStats(Package* package) {
           : std::make_optional(convert_array_index_to_select);
   // TODO(meheff): 2022/3/23 Add this as a flag and benchmark_ir option.
   pass_options.inline_procs = true;
+  pass_options.record_memory_usage = true;
+  std::optional<int64_t> peak_rss_before = GetPeakRssBytes();
   PassResults pass_results;
   XLS_RETURN_IF_ERROR(
       pipeline->Run(package, pass_options, &pass_results).status());
@@ -186,6 +206,43 @@ absl::Status RunOptimizationAndPrintStats(Package* package) {
                                     changed_counts.at(name),
                                     pass_counts.at(name));
   }
+
+  // Attribute the growth of the peak RSS to the passes during which it
+  // occurred, and report the largest IR and BDD each pass saw.
+  absl::flat_hash_map<std::string, int64_t> rss_raises;
+  absl::flat_hash_map<std::string, int64_t> max_ir_bytes;
+  absl::flat_hash_map<std::string, int64_t> max_bdd_bytes;
+  std::optional<int64_t> previous_peak_rss = peak_rss_before;
+  for (const PassInvocation& invocation : pass_results.invocations) {
+    if (!invocation.memory_usage.has_value()) {
+      continue;
+    }
+    const PassMemoryUsage& usage = *invocation.memory_usage;
+    if (usage.peak_rss_bytes.has_value()) {
+      if (previous_peak_rss.has_value()) {
+        rss_raises[invocation.pass_name] +=
+            *usage.peak_rss_bytes - *previous_peak_rss;
+      }
+      previous_peak_rss = usage.peak_rss_bytes;
+    }
+    max_ir_bytes[invocation.pass_name] =
+        std::max(max_ir_bytes[invocation.pass_name], usage.ir_byte_size);
+    max_bdd_bytes[invocation.pass_name] =
+        std::max(max_bdd_bytes[invocation.pass_name], usage.bdd_peak_bytes);
+  }
+  std::sort(pass_names.begin(), pass_names.end(),
+            [&](const std::string& a, const std::string& b) {
+              return rss_raises[a] > rss_raises[b];
+            });
+  std::cout << "Pass memory usage (peak RSS raise / max IR size / max BDD "
+               "size):"
+            << std::endl;
+  for (const std::string& name : pass_names) {
+    std::cout << absl::StreamFormat(
+        "  %-20s : %5dMiB / %5dMiB / %5dMiB\n", name,
+        BytesToMiB(rss_raises[name]), BytesToMiB(max_ir_bytes[name]),
+        BytesToMiB(max_bdd_bytes[name]));
+  }
   return absl::OkStatus();
 }
 
@@ -419,7 +476,8 @@ absl::Status PrintScheduleInfo(FunctionBase* f,
   return absl::OkStatus();
 }
 
-absl::Status PrintProcInfo(Proc* p) {
+absl::Status PrintProcInfo(Proc* p, const DelayEstimator& delay_estimator,
+                           std::optional<int64_t> clock_period_ps) {
   XLS_RET_CHECK(p != nullptr);
 
   int64_t total_flops = 0;
@@ -429,6 +487,16 @@ absl::Status PrintProcInfo(Proc* p) {
 
   std::cout << absl::StreamFormat("Total state flops: %d\n", total_flops);
 
+  if (clock_period_ps.has_value() && p->GetStateElementCount() > 0) {
+    XLS_ASSIGN_OR_RETURN(
+        std::vector<StateBackedge> backedges,
+        AnalyzeStateBackedges(p, delay_estimator, *clock_period_ps));
+    std::cout << absl::StreamFormat(
+        "State backedges (minimum worst-case throughput %d):\n%s",
+        MinimumInitiationInterval(backedges),
+        StateBackedgesToString(backedges));
+  }
+
   return absl::OkStatus();
 }
 
@@ -568,14 +636,20 @@ absl::Status RealMain(std::string_view path,
     return absl::InternalError(absl::StrFormat(
         "Top entity not set for package: %s.", package->name()));
   }
+  PrintMemoryUsage("parsing");
   XLS_RETURN_IF_ERROR(
       RunInterpeterAndJit(package->GetTop().value(), "unoptimized"));
 
   XLS_RETURN_IF_ERROR(RunOptimizationAndPrintStats(package.get()));
+  PrintMemoryUsage("optimization");
 
   FunctionBase* f = package->GetTop().value();
+  BinaryDecisionDiagram::PeakMemoryUsage().Reset();
   BddQueryEngine query_engine(BddFunction::kDefaultPathLimit);
   XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
+  std::cout << absl::StreamFormat(
+      "BDD query engine peak memory: %dMiB\n",
+      BytesToMiB(BinaryDecisionDiagram::PeakMemoryUsage().peak_bytes()));
   PrintNodeBreakdown(f);
 
   std::optional<int64_t> effective_clock_period_ps;
@@ -604,6 +678,7 @@ absl::Status RealMain(std::string_view path,
         PipelineSchedule schedule,
         ScheduleAndPrintStats(package.get(), delay_estimator, clock_period_ps,
                               pipeline_stages, clock_margin_percent));
+    PrintMemoryUsage("scheduling");
 
     // Only print codegen info for functions.
     //
@@ -611,6 +686,7 @@ absl::Status RealMain(std::string_view path,
     // to benchmark_main to be able to codegen procs.
     if (f->IsFunction()) {
       XLS_RETURN_IF_ERROR(PrintCodegenInfo(f, schedule));
+      PrintMemoryUsage("codegen");
     }
 
     XLS_RETURN_IF_ERROR(PrintScheduleInfo(f, schedule, query_engine,
@@ -618,11 +694,13 @@ absl::Status RealMain(std::string_view path,
 
     // Print out state information for procs.
     if (f->IsProc()) {
-      XLS_RETURN_IF_ERROR(PrintProcInfo(f->AsProcOrDie()));
+      XLS_RETURN_IF_ERROR(PrintProcInfo(f->AsProcOrDie(), delay_estimator,
+                                        effective_clock_period_ps));
     }
   }
 
   XLS_RETURN_IF_ERROR(RunInterpeterAndJit(f, "optimized"));
+  PrintMemoryUsage("JIT");
   return absl::OkStatus();
 }
 
@@ -20,15 +20,20 @@
 #include <algorithm>
 #include <cstdint>
 #include <filesystem>
+#include <functional>
 #include <memory>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/data_structures/and_inverter_graph.h"
 #include "xls/ir/abstract_evaluator.h"
 #include "xls/ir/abstract_node_evaluator.h"
 #include "xls/ir/bits_ops.h"
@@ -65,26 +70,75 @@ class BitEvaluator : public AbstractEvaluator<Node*, BitEvaluator> {
   BValue zero_;
 };
 
-absl::StatusOr<Function*> Booleanifier::Booleanify(
-    Function* f, std::string_view boolean_function_name) {
-  Booleanifier b(f, boolean_function_name);
-  return b.Run();
-}
+namespace {
 
-Booleanifier::Booleanifier(Function* f, std::string_view boolean_function_name)
-    : input_fn_(f),
-      builder_(boolean_function_name.empty()
-                   ? absl::StrCat(input_fn_->name(), "_boolean")
-                   : boolean_function_name,
-               input_fn_->package()),
-      evaluator_(std::make_unique<BitEvaluator>(&builder_)) {}
+// Evaluator for lowering Nodes into the single-bit gates of an AIG.
+class AigEvaluator : public AbstractEvaluator<AigLiteral, AigEvaluator> {
+ public:
+  explicit AigEvaluator(AndInverterGraph* aig) : aig_(aig) {}
 
-absl::StatusOr<Function*> Booleanifier::Run() {
-  for (const Param* param : input_fn_->params()) {
-    params_[param->name()] = builder_.Param(param->name(), param->GetType());
+  AigLiteral One() const { return AndInverterGraph::True(); }
+  AigLiteral Zero() const { return AndInverterGraph::False(); }
+  AigLiteral Not(const AigLiteral& input) const { return !input; }
+  AigLiteral And(const AigLiteral& a, const AigLiteral& b) const {
+    return aig_->And(a, b);
+  }
+  AigLiteral Or(const AigLiteral& a, const AigLiteral& b) const {
+    return aig_->Or(a, b);
   }
 
-  for (Node* node : TopoSort(input_fn_)) {
+ private:
+  AndInverterGraph* aig_;
+};
+
+// Lowers each node of a function to a vector of single-bit elements of
+// `EvaluatorT`. Arrays and tuples are held as flat vectors of their leaf bits
+// in element order; the bits of params are provided by `lower_param`.
+template <typename EvaluatorT>
+class BitLowering {
+ public:
+  using Element = typename EvaluatorT::Element;
+  using Vector = typename EvaluatorT::Vector;
+
+  BitLowering(EvaluatorT* evaluator, std::function<Vector(Param*)> lower_param)
+      : evaluator_(evaluator), lower_param_(std::move(lower_param)) {}
+
+  // Lowers all the nodes of `f`.
+  absl::Status Run(Function* f);
+
+  // Returns the lowering of `node`.
+  const Vector& Get(Node* node) const { return node_map_.at(node); }
+
+ private:
+  // "Callback" from the AbstractEvaluator for ops that don't make sense there.
+  // So far, these are ops that involve data layouts: param handling, tuple
+  // construction/access, etc.
+  Vector HandleSpecialOps(Node* node);
+
+  Vector HandleLiteralArrayIndex(const ArrayType* array_type,
+                                 const Vector& array, const Value& index,
+                                 int64_t start_offset);
+
+  Vector HandleArrayIndex(const ArrayType* array_type, const Vector& array,
+                          absl::Span<Node* const> indices,
+                          int64_t start_offset);
+
+  Vector HandleArrayUpdate(const ArrayType* array_type, const Vector& array,
+                           absl::Span<Node* const> indices,
+                           const Vector& update_value, int64_t start_offset);
+
+  // Takes in the given Value (not BValue!) and converts it into an
+  // AbstractEvaluator Vector type.
+  Vector FlattenValue(const Value& value);
+
+  EvaluatorT* evaluator_;
+  std::function<Vector(Param*)> lower_param_;
+  absl::flat_hash_map<Node*, Vector> node_map_;
+};
+
+template <typename EvaluatorT>
+absl::Status BitLowering<EvaluatorT>::Run(Function* f) {
+  for (Node* node : TopoSort(f)) {
     std::vector<Vector> operands;
     // Not the most efficient way of doing this, but not an issue yet.
     for (Node* node : node->operands()) {
@@ -93,18 +147,17 @@ absl::StatusOr<Function*> Booleanifier::Run() {
 
     XLS_ASSIGN_OR_RETURN(
         Vector result,
-        AbstractEvaluate(node, operands, evaluator_.get(), [this](Node* node) {
+        AbstractEvaluate(node, operands, evaluator_, [this](Node* node) {
           return HandleSpecialOps(node);
         }));
     node_map_[node] = result;
   }
-
-  Node* return_node = input_fn_->return_value();
-  return builder_.BuildWithReturnValue(
-      PackReturnValue(node_map_.at(return_node), return_node->GetType()));
+  return absl::OkStatus();
 }
 
-Booleanifier::Vector Booleanifier::FlattenValue(const Value& value) {
+template <typename EvaluatorT>
+typename BitLowering<EvaluatorT>::Vector
+BitLowering<EvaluatorT>::FlattenValue(const Value& value) {
   if (value.IsBits()) {
     return evaluator_->BitsToVector(value.bits());
   }
@@ -117,7 +170,9 @@ Booleanifier::Vector Booleanifier::FlattenValue(const Value& value) {
   return result;
 }
 
-Booleanifier::Vector Booleanifier::HandleLiteralArrayIndex(
+template <typename EvaluatorT>
+typename BitLowering<EvaluatorT>::Vector
+BitLowering<EvaluatorT>::HandleLiteralArrayIndex(
     const ArrayType* array_type, const Vector& array, const Value& index,
     int64_t start_offset) {
   const int64_t element_size = array_type->element_type()->GetFlatBitCount();
@@ -131,7 +186,9 @@ Booleanifier::Vector Booleanifier::HandleLiteralArrayIndex(
   return evaluator_->BitSlice(array, start_offset, element_size);
 }
 
-Booleanifier::Vector Booleanifier::HandleArrayIndex(
+template <typename EvaluatorT>
+typename BitLowering<EvaluatorT>::Vector
+BitLowering<EvaluatorT>::HandleArrayIndex(
     const ArrayType* array_type, const Vector& array,
     absl::Span<Node* const> indices, int64_t start_offset) {
   Type* element_type = array_type->element_type();
@@ -169,7 +226,9 @@ Booleanifier::Vector Booleanifier::HandleArrayIndex(
   return evaluator_->Select(node_map_.at(indices[0]), cases, cases.back());
 }
 
-Booleanifier::Vector Booleanifier::HandleArrayUpdate(
+template <typename EvaluatorT>
+typename BitLowering<EvaluatorT>::Vector
+BitLowering<EvaluatorT>::HandleArrayUpdate(
     const ArrayType* array_type, const Vector& array,
     absl::Span<Node* const> indices, const Vector& update_value,
     int64_t start_offset) {
@@ -257,7 +316,9 @@ Booleanifier::Vector Booleanifier::HandleArrayUpdate(
   return result;
 }
 
-Booleanifier::Vector Booleanifier::HandleSpecialOps(Node* node) {
+template <typename EvaluatorT>
+typename BitLowering<EvaluatorT>::Vector
+BitLowering<EvaluatorT>::HandleSpecialOps(Node* node) {
   switch (node->op()) {
     case Op::kArray:
     case Op::kTuple: {
@@ -298,8 +359,7 @@ Booleanifier::Vector Booleanifier::HandleSpecialOps(Node* node) {
       // Params are special, as they come in as n-bit objects. They're one of
       // the interfaces to the outside world that convert N-bit items into N
       // 1-bit items.
-      Param* param = node->As<Param>();
-      return UnpackParam(param->GetType(), params_.at(param->name()));
+      return lower_param_(node->As<Param>());
     }
     case Op::kTupleIndex: {
       // Tuples are flat vectors, so we just need to extract the right
@@ -320,6 +380,59 @@ Booleanifier::Vector Booleanifier::HandleSpecialOps(Node* node) {
   }
 }
 
+}  // namespace
+
+absl::StatusOr<Function*> Booleanifier::Booleanify(
+    Function* f, std::string_view boolean_function_name) {
+  Booleanifier b(f, boolean_function_name);
+  return b.Run();
+}
+
+absl::StatusOr<AndInverterGraph> Booleanifier::BooleanifyToAig(Function* f) {
+  AndInverterGraph aig;
+  absl::flat_hash_map<Param*, std::vector<AigLiteral>> param_bits;
+  for (Param* param : f->params()) {
+    std::vector<AigLiteral>& bits = param_bits[param];
+    for (int64_t i = 0; i < param->GetType()->GetFlatBitCount(); ++i) {
+      bits.push_back(aig.AddInput(absl::StrCat(param->name(), "[", i, "]")));
+    }
+  }
+
+  AigEvaluator evaluator(&aig);
+  BitLowering<AigEvaluator> lowering(
+      &evaluator, [&](Param* param) { return param_bits.at(param); });
+  XLS_RETURN_IF_ERROR(lowering.Run(f));
+
+  const std::vector<AigLiteral>& result = lowering.Get(f->return_value());
+  for (int64_t i = 0; i < result.size(); ++i) {
+    aig.AddOutput(result[i], absl::StrCat("out[", i, "]"));
+  }
+  return aig;
+}
+
+Booleanifier::Booleanifier(Function* f, std::string_view boolean_function_name)
+    : input_fn_(f),
+      builder_(boolean_function_name.empty()
+                   ? absl::StrCat(input_fn_->name(), "_boolean")
+                   : boolean_function_name,
+               input_fn_->package()),
+      evaluator_(std::make_unique<BitEvaluator>(&builder_)) {}
+
+absl::StatusOr<Function*> Booleanifier::Run() {
+  for (const Param* param : input_fn_->params()) {
+    params_[param->name()] = builder_.Param(param->name(), param->GetType());
+  }
+
+  BitLowering<BitEvaluator> lowering(evaluator_.get(), [this](Param* param) {
+    return UnpackParam(param->GetType(), params_.at(param->name()));
+  });
+  XLS_RETURN_IF_ERROR(lowering.Run(input_fn_));
+
+  Node* return_node = input_fn_->return_value();
+  return builder_.BuildWithReturnValue(
+      PackReturnValue(lowering.Get(return_node), return_node->GetType()));
+}
+
 Booleanifier::Vector Booleanifier::UnpackParam(Type* type, BValue bv_node) {
   int64_t bit_count = type->GetFlatBitCount();
   switch (type->kind()) {
@@ -22,6 +22,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "xls/data_structures/and_inverter_graph.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/node.h"
@@ -46,29 +47,20 @@ class Booleanifier {
   static absl::StatusOr<Function*> Booleanify(
       Function* f, std::string_view boolean_function_name = "");
 
+  // Returns an and-inverter graph equivalent to the given function: a much
+  // more compact bit-level form than a booleanified Function. The graph has one
+  // input per flat bit of each param, in param order, and one output per flat
+  // bit of the return value. Values are flattened as in the booleanified
+  // function: array and tuple elements in index order, bits LSb first. Inputs
+  // are named "<param>[<i>]" and outputs "out[<i>]".
+  static absl::StatusOr<AndInverterGraph> BooleanifyToAig(Function* f);
+
  private:
   Booleanifier(Function* f, std::string_view boolean_function_name);
 
   // Driver for doing the actual conversion.
   absl::StatusOr<Function*> Run();
 
-  // "Callback" from the AbstractEvaluator for ops that don't make sense there.
-  // So far, these are ops that involve data layouts: param handling, tuple
-  // construction/access, etc.
-  Vector HandleSpecialOps(Node* node);
-
-  Vector HandleLiteralArrayIndex(const ArrayType* array_type,
-                                 const Vector& array, const Value& index,
-                                 int64_t start_offset);
-
-  Vector HandleArrayIndex(const ArrayType* array_type, const Vector& array,
-                          absl::Span<Node* const> indices,
-                          int64_t start_offset);
-
-  Vector HandleArrayUpdate(const ArrayType* array_type, const Vector& array,
-                           absl::Span<Node* const> indices,
-                           const Vector& update_value, int64_t start_offset);
-
   // Converts a structured input param into a flat bit array.
   Vector UnpackParam(Type* type, BValue bv_node);
 
@@ -76,15 +68,10 @@ class Booleanifier {
   // We take a span here, instead of a Vector, so we can easily create subspans.
   BValue PackReturnValue(absl::Span<const Element> bits, const Type* type);
 
-  // Takes in the given Value (not BValue!) and converts it into an
-  // AbstractEvaluator Vector type.
-  Vector FlattenValue(const Value& value);
-
   Function* input_fn_;
   FunctionBuilder builder_;
   std::unique_ptr<BitEvaluator> evaluator_;
   absl::flat_hash_map<std::string, BValue> params_;
-  absl::flat_hash_map<Node*, Vector> node_map_;
 };
 
 }  // namespace xls
@@ -14,6 +14,7 @@
 #include "xls/tools/booleanifier.h"
 
 #include <array>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
@@ -24,6 +25,7 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/status/matchers.h"
+#include "xls/data_structures/and_inverter_graph.h"
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/jit/function_jit.h"
@@ -94,6 +96,39 @@ TEST_F(BooleanifierTest, Crc32_Jit) {
   }
 }
 
+// Verifies the AIG form of CRC32 by simulating 64 messages at a time.
+TEST_F(BooleanifierTest, Crc32_Aig) {
+  const std::string kIrPath = "xls/examples/crc32.opt.ir";
+  XLS_ASSERT_OK_AND_ASSIGN(FunctionData fd,
+                           GetFunctionDataFromFile(kIrPath, "__crc32__main"));
+  XLS_ASSERT_OK_AND_ASSIGN(AndInverterGraph aig,
+                           Booleanifier::BooleanifyToAig(fd.source));
+  ASSERT_EQ(aig.inputs().size(), 8);
+  ASSERT_EQ(aig.outputs().size(), 32);
+
+  for (int base = 0; base < 256; base += 64) {
+    std::vector<uint64_t> input_values(8, 0);
+    for (int pattern = 0; pattern < 64; ++pattern) {
+      for (int bit = 0; bit < 8; ++bit) {
+        uint64_t value = ((base + pattern) >> bit) & 1;
+        input_values[bit] |= value << pattern;
+      }
+    }
+    std::vector<uint64_t> output_values = aig.Simulate(input_values);
+    for (int pattern = 0; pattern < 64; ++pattern) {
+      std::vector<Value> inputs({Value(UBits(base + pattern, 8))});
+      XLS_ASSERT_OK_AND_ASSIGN(
+          Value fancy_value,
+          DropInterpreterEvents(InterpretFunction(fd.source, inputs)));
+      for (int bit = 0; bit < 32; ++bit) {
+        ASSERT_EQ(fancy_value.bits().Get(bit),
+                  ((output_values[bit] >> pattern) & 1) != 0)
+            << "message " << base + pattern << ", bit " << bit;
+      }
+    }
+  }
+}
+
 // This test verifies that the Boolifier can properly handle extracting from
 // and packing into tuples.
 TEST_F(BooleanifierTest, MarshalsTuples) {
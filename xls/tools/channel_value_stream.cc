@@ -0,0 +1,289 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/channel_value_stream.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/codegen/flattening.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/fast_value_parser.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/value_helpers.h"
+
+namespace xls {
+namespace {
+
+constexpr std::string_view kBinaryMagic = "xls_channel_values v1";
+
+// Returns an error describing the failure of the last I/O operation on `file`.
+absl::Status IoError(const FileStream& file) {
+  return absl::InternalError(absl::StrFormat(
+      "I/O error on `%s`: %s", file.path().string(), strerror(errno)));
+}
+
+// Reads a line from `file` without the trailing newline. Returns std::nullopt
+// at the end of the file.
+absl::StatusOr<std::optional<std::string>> ReadLine(const FileStream& file) {
+  char* line = nullptr;
+  size_t capacity = 0;
+  ssize_t length = getline(&line, &capacity, file.get());
+  std::unique_ptr<char, decltype(&free)> line_deleter(line, &free);
+  if (length < 0) {
+    if (ferror(file.get())) {
+      return IoError(file);
+    }
+    return std::nullopt;
+  }
+  std::string result(line, length);
+  if (!result.empty() && result.back() == '\n') {
+    result.pop_back();
+  }
+  return result;
+}
+
+absl::Status WriteBytes(const FileStream& file,
+                        absl::Span<const uint8_t> bytes) {
+  if (!bytes.empty() &&
+      fwrite(bytes.data(), 1, bytes.size(), file.get()) != bytes.size()) {
+    return IoError(file);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status WriteString(const FileStream& file, std::string_view s) {
+  if (fwrite(s.data(), 1, s.size(), file.get()) != s.size()) {
+    return IoError(file);
+  }
+  return absl::OkStatus();
+}
+
+class TextChannelValueReader : public ChannelValueReader {
+ public:
+  TextChannelValueReader(FileStream file, Type* type)
+      : ChannelValueReader(std::move(file), type) {}
+
+ protected:
+  absl::StatusOr<std::optional<Value>> ReadValue() override {
+    while (true) {
+      XLS_ASSIGN_OR_RETURN(std::optional<std::string> line,
+                           ReadLine(file_));
+      if (!line.has_value()) {
+        return std::nullopt;
+      }
+      std::string_view stripped = absl::StripAsciiWhitespace(line.value());
+      if (stripped.empty()) {
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(Value value, ParseTypedValueFast(stripped));
+      return value;
+    }
+  }
+};
+
+class BinaryChannelValueReader : public ChannelValueReader {
+ public:
+  BinaryChannelValueReader(FileStream file, Type* type)
+      : ChannelValueReader(std::move(file), type),
+        record_(CeilOfRatio(type->GetFlatBitCount(), int64_t{8})) {}
+
+  // Reads and validates the header of the file.
+  absl::Status ReadHeader() {
+    XLS_ASSIGN_OR_RETURN(std::optional<std::string> magic,
+                         ReadLine(file_));
+    if (magic != kBinaryMagic) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "File `%s` is not a binary channel values file",
+          file_.path().string()));
+    }
+    XLS_ASSIGN_OR_RETURN(std::optional<std::string> type_string,
+                         ReadLine(file_));
+    if (type_string != type_->ToString()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "File `%s` holds values of type `%s`, expected `%s`",
+          file_.path().string(), type_string.value_or(""), type_->ToString()));
+    }
+    return absl::OkStatus();
+  }
+
+ protected:
+  absl::StatusOr<std::optional<Value>> ReadValue() override {
+    size_t bytes_read = fread(record_.data(), 1, record_.size(), file_.get());
+    if (bytes_read == 0 && feof(file_.get())) {
+      return std::nullopt;
+    }
+    if (bytes_read != record_.size()) {
+      if (ferror(file_.get())) {
+        return IoError(file_);
+      }
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "File `%s` ends with a truncated record", file_.path().string()));
+    }
+    return UnflattenBitsToValue(
+        Bits::FromBytes(record_, type_->GetFlatBitCount()), type_);
+  }
+
+ private:
+  std::vector<uint8_t> record_;
+};
+
+class TextChannelValueWriter : public ChannelValueWriter {
+ public:
+  TextChannelValueWriter(FileStream file, Type* type)
+      : ChannelValueWriter(std::move(file), type) {}
+
+ protected:
+  absl::Status WriteValue(const Value& value) override {
+    return WriteString(file_,
+                       absl::StrCat(value.ToString(FormatPreference::kHex),
+                                    "\n"));
+  }
+};
+
+class BinaryChannelValueWriter : public ChannelValueWriter {
+ public:
+  BinaryChannelValueWriter(FileStream file, Type* type)
+      : ChannelValueWriter(std::move(file), type) {}
+
+  absl::Status WriteHeader() {
+    return WriteString(file_, absl::StrFormat("%s\n%s\n", kBinaryMagic,
+                                                    type_->ToString()));
+  }
+
+ protected:
+  absl::Status WriteValue(const Value& value) override {
+    return WriteBytes(file_, FlattenValueToBits(value).ToBytes());
+  }
+};
+
+absl::Status CheckBinaryFormatSupported(Type* type) {
+  if (type->GetFlatBitCount() == 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Type `%s` has no bits and cannot be stored in the binary channel "
+        "values format",
+        type->ToString()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<ChannelValueFormat> ChannelValueFormatFromString(
+    std::string_view s) {
+  if (s == "text") {
+    return ChannelValueFormat::kText;
+  }
+  if (s == "binary") {
+    return ChannelValueFormat::kBinary;
+  }
+  return absl::InvalidArgumentError(absl::StrFormat(
+      "Unknown channel value format `%s`, expected `text` or `binary`", s));
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<ChannelValueReader>>
+ChannelValueReader::Open(const std::filesystem::path& path,
+                         ChannelValueFormat format, Type* type) {
+  XLS_ASSIGN_OR_RETURN(FileStream file, FileStream::Open(path, "r"));
+  if (format == ChannelValueFormat::kText) {
+    return std::make_unique<TextChannelValueReader>(std::move(file), type);
+  }
+  XLS_RETURN_IF_ERROR(CheckBinaryFormatSupported(type));
+  auto reader =
+      std::make_unique<BinaryChannelValueReader>(std::move(file), type);
+  XLS_RETURN_IF_ERROR(reader->ReadHeader());
+  return reader;
+}
+
+absl::StatusOr<std::optional<Value>> ChannelValueReader::Next() {
+  XLS_ASSIGN_OR_RETURN(std::optional<Value> value, ReadValue());
+  if (!value.has_value()) {
+    return std::nullopt;
+  }
+  if (!ValueConformsToType(value.value(), type_)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Value %d of `%s` is `%s` which is not of type `%s`", values_read_,
+        file_.path().string(), value->ToString(), type_->ToString()));
+  }
+  ++values_read_;
+  return value;
+}
+
+ChannelQueue::GeneratorFn ChannelValueReader::AsGenerator(
+    std::optional<int64_t> max_values) {
+  return [this, max_values]() -> std::optional<Value> {
+    if (!status_.ok() ||
+        (max_values.has_value() && values_read_ >= max_values.value())) {
+      return std::nullopt;
+    }
+    absl::StatusOr<std::optional<Value>> value = Next();
+    if (!value.ok()) {
+      status_ = value.status();
+      return std::nullopt;
+    }
+    return std::move(value).value();
+  };
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<ChannelValueWriter>>
+ChannelValueWriter::Open(const std::filesystem::path& path,
+                         ChannelValueFormat format, Type* type) {
+  XLS_ASSIGN_OR_RETURN(FileStream file, FileStream::Open(path, "w"));
+  if (format == ChannelValueFormat::kText) {
+    return std::make_unique<TextChannelValueWriter>(std::move(file), type);
+  }
+  XLS_RETURN_IF_ERROR(CheckBinaryFormatSupported(type));
+  auto writer =
+      std::make_unique<BinaryChannelValueWriter>(std::move(file), type);
+  XLS_RETURN_IF_ERROR(writer->WriteHeader());
+  return writer;
+}
+
+absl::Status ChannelValueWriter::Write(const Value& value) {
+  if (!ValueConformsToType(value, type_)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Cannot write value `%s` to `%s` which holds values of type `%s`",
+        value.ToString(), file_.path().string(), type_->ToString()));
+  }
+  XLS_RETURN_IF_ERROR(WriteValue(value));
+  ++values_written_;
+  return absl::OkStatus();
+}
+
+absl::Status ChannelValueWriter::Flush() {
+  if (fflush(file_.get()) != 0) {
+    return IoError(file_);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace xls
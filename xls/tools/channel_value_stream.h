@@ -0,0 +1,127 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_TOOLS_CHANNEL_VALUE_STREAM_H_
+#define XLS_TOOLS_CHANNEL_VALUE_STREAM_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/file_descriptor.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// Formats of files holding the sequence of values of a single channel.
+//
+//   kText:   One XLS value in human-readable typed form per line, e.g.
+//            `bits[32]:0x42`. Blank lines are ignored.
+//   kBinary: The header line `xls_channel_values v1`, followed by a line
+//            holding the channel type (e.g. `(bits[8], bits[3])`), followed by
+//            one fixed-size record per value. Each record holds the value
+//            flattened to bits (see FlattenValueToBits) as
+//            ceil(flat_bit_count / 8) little-endian bytes. Types with a flat
+//            bit count of zero are not supported.
+enum class ChannelValueFormat { kText, kBinary };
+
+// Parses "text" or "binary" into the corresponding format.
+absl::StatusOr<ChannelValueFormat> ChannelValueFormatFromString(
+    std::string_view s);
+
+// Reads the values of a channel from a file one at a time so files much larger
+// than memory may be consumed.
+class ChannelValueReader {
+ public:
+  // Opens the file at `path`. Values read from the file must conform to
+  // `type`.
+  static absl::StatusOr<std::unique_ptr<ChannelValueReader>> Open(
+      const std::filesystem::path& path, ChannelValueFormat format, Type* type);
+
+  virtual ~ChannelValueReader() = default;
+
+  // Returns the next value in the file or std::nullopt if the end of the file
+  // has been reached.
+  absl::StatusOr<std::optional<Value>> Next();
+
+  // Returns the number of values returned by Next so far.
+  int64_t values_read() const { return values_read_; }
+
+  // Returns a generator suitable for ChannelQueue::AttachGenerator which
+  // produces at most `max_values` values from the file. Generators cannot
+  // return errors so the generator ends the stream on an error, which is then
+  // returned by status(). The reader must outlive the generator.
+  ChannelQueue::GeneratorFn AsGenerator(
+      std::optional<int64_t> max_values = std::nullopt);
+
+  // Returns the first error encountered by a generator returned by
+  // AsGenerator.
+  const absl::Status& status() const { return status_; }
+
+ protected:
+  ChannelValueReader(FileStream file, Type* type)
+      : file_(std::move(file)), type_(type) {}
+
+  // Reads the next value from `file_`.
+  virtual absl::StatusOr<std::optional<Value>> ReadValue() = 0;
+
+  FileStream file_;
+  Type* type_;
+
+ private:
+  int64_t values_read_ = 0;
+  absl::Status status_;
+};
+
+// Writes the values of a channel to a file as they are produced.
+class ChannelValueWriter {
+ public:
+  // Creates (or truncates) the file at `path`. Values written must conform to
+  // `type`.
+  static absl::StatusOr<std::unique_ptr<ChannelValueWriter>> Open(
+      const std::filesystem::path& path, ChannelValueFormat format, Type* type);
+
+  virtual ~ChannelValueWriter() = default;
+
+  absl::Status Write(const Value& value);
+
+  // Flushes buffered values to the file.
+  absl::Status Flush();
+
+  // Returns the number of values written so far.
+  int64_t values_written() const { return values_written_; }
+
+ protected:
+  ChannelValueWriter(FileStream file, Type* type)
+      : file_(std::move(file)), type_(type) {}
+
+  virtual absl::Status WriteValue(const Value& value) = 0;
+
+  FileStream file_;
+  Type* type_;
+
+ private:
+  int64_t values_written_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_CHANNEL_VALUE_STREAM_H_
@@ -0,0 +1,162 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/channel_value_stream.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/temp_file.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+using ::testing::Optional;
+
+class ChannelValueStreamTest
+    : public ::testing::TestWithParam<ChannelValueFormat> {
+ protected:
+  ChannelValueStreamTest() : package_("test") {}
+
+  // Writes `values` to a new file in the current format and returns the file.
+  absl::StatusOr<TempFile> WriteValues(Type* type,
+                                       const std::vector<Value>& values) {
+    XLS_ASSIGN_OR_RETURN(TempFile file, TempFile::Create());
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<ChannelValueWriter> writer,
+        ChannelValueWriter::Open(file.path(), GetParam(), type));
+    for (const Value& value : values) {
+      XLS_RETURN_IF_ERROR(writer->Write(value));
+    }
+    XLS_RETURN_IF_ERROR(writer->Flush());
+    return file;
+  }
+
+  Package package_;
+};
+
+TEST_P(ChannelValueStreamTest, RoundTrip) {
+  Type* type = package_.GetTupleType(
+      {package_.GetBitsType(3),
+       package_.GetArrayType(2, package_.GetBitsType(17))});
+  std::vector<Value> values;
+  for (int64_t i = 0; i < 10; ++i) {
+    Value array =
+        Value::ArrayOrDie({Value(UBits(i, 17)), Value(UBits(1000 * i, 17))});
+    values.push_back(Value::Tuple({Value(UBits(i % 8, 3)), array}));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file, WriteValues(type, values));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ChannelValueReader> reader,
+      ChannelValueReader::Open(file.path(), GetParam(), type));
+  for (const Value& value : values) {
+    EXPECT_THAT(reader->Next(), IsOkAndHolds(Optional(value)));
+  }
+  EXPECT_THAT(reader->Next(), IsOkAndHolds(std::nullopt));
+  EXPECT_EQ(reader->values_read(), values.size());
+}
+
+TEST_P(ChannelValueStreamTest, GeneratorStopsAtLimit) {
+  Type* type = package_.GetBitsType(32);
+  std::vector<Value> values;
+  for (int64_t i = 0; i < 5; ++i) {
+    values.push_back(Value(UBits(i, 32)));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file, WriteValues(type, values));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ChannelValueReader> reader,
+      ChannelValueReader::Open(file.path(), GetParam(), type));
+  ChannelQueue::GeneratorFn generator =
+      reader->AsGenerator(/*max_values=*/3);
+  EXPECT_THAT(generator(), Optional(Value(UBits(0, 32))));
+  EXPECT_THAT(generator(), Optional(Value(UBits(1, 32))));
+  EXPECT_THAT(generator(), Optional(Value(UBits(2, 32))));
+  EXPECT_EQ(generator(), std::nullopt);
+  XLS_EXPECT_OK(reader->status());
+}
+
+TEST_P(ChannelValueStreamTest, WrongType) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TempFile file,
+      WriteValues(package_.GetBitsType(8), {Value(UBits(42, 8))}));
+  absl::StatusOr<std::unique_ptr<ChannelValueReader>> reader =
+      ChannelValueReader::Open(file.path(), GetParam(),
+                               package_.GetBitsType(16));
+  if (GetParam() == ChannelValueFormat::kBinary) {
+    // The type is recorded in the header of binary files.
+    EXPECT_THAT(reader, StatusIs(absl::StatusCode::kInvalidArgument,
+                                 HasSubstr("expected `bits[16]`")));
+    return;
+  }
+  XLS_ASSERT_OK(reader.status());
+  ChannelQueue::GeneratorFn generator = reader.value()->AsGenerator();
+  EXPECT_EQ(generator(), std::nullopt);
+  EXPECT_THAT(reader.value()->status(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("not of type `bits[16]`")));
+}
+
+INSTANTIATE_TEST_SUITE_P(ChannelValueStreamTestInstantiation,
+                         ChannelValueStreamTest,
+                         testing::Values(ChannelValueFormat::kText,
+                                         ChannelValueFormat::kBinary),
+                         [](const auto& info) {
+                           return info.param == ChannelValueFormat::kText
+                                      ? "Text"
+                                      : "Binary";
+                         });
+
+TEST(ChannelValueStreamTextTest, SkipsBlankLines) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TempFile file,
+      TempFile::CreateWithContent("bits[4]:1\n\n  bits[4]:0xf  \n\n"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ChannelValueReader> reader,
+      ChannelValueReader::Open(file.path(), ChannelValueFormat::kText,
+                               package.GetBitsType(4)));
+  EXPECT_THAT(reader->Next(), IsOkAndHolds(Optional(Value(UBits(1, 4)))));
+  EXPECT_THAT(reader->Next(), IsOkAndHolds(Optional(Value(UBits(15, 4)))));
+  EXPECT_THAT(reader->Next(), IsOkAndHolds(std::nullopt));
+}
+
+TEST(ChannelValueStreamBinaryTest, TruncatedRecord) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TempFile file,
+      TempFile::CreateWithContent("xls_channel_values v1\nbits[16]\n\x01"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ChannelValueReader> reader,
+      ChannelValueReader::Open(file.path(), ChannelValueFormat::kBinary,
+                               package.GetBitsType(16)));
+  EXPECT_THAT(reader->Next(), StatusIs(absl::StatusCode::kInvalidArgument,
+                                       HasSubstr("truncated")));
+}
+
+}  // namespace
+}  // namespace xls
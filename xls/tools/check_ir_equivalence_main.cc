@@ -12,8 +12,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <atomic>
+#include <cstdint>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <thread>  // NOLINT(build/c++11)
@@ -25,6 +28,9 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
@@ -32,6 +38,7 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
 #include "xls/passes/dce_pass.h"
@@ -65,29 +72,143 @@ ABSL_FLAG(std::string, top, "",
           "Functions are supported.");
 ABSL_FLAG(absl::Duration, timeout, absl::InfiniteDuration(),
           "How long to wait for any proof to complete.");
+ABSL_FLAG(bool, incremental, false,
+          "Prove the output bits equal one at a time on a single solver, "
+          "reusing each proven bit in the proofs of the rest, instead of "
+          "issuing a single query over the whole output. Wide outputs that "
+          "time out as a single query are often tractable this way.");
+ABSL_FLAG(int64_t, parallelism, 1,
+          "If greater than one, prove the output bits incrementally, split "
+          "across this many independent solvers running concurrently, each on "
+          "its own translation of the functions. Implies --incremental.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
 
 namespace xls {
 
 using solvers::z3::IrTranslator;
 
+// The two functions translated into one Z3 context, with their parameters
+// identified, and the conditions under which their outputs agree.
+struct Comparison {
+  std::vector<std::unique_ptr<IrTranslator>> translators;
+
+  // Whether the two return values are equal.
+  Z3_ast results_equal;
+
+  // Whether each bit of the two (flattened) return values is equal.
+  std::vector<Z3_ast> result_bits_equal;
+
+  Z3_context ctx() const { return translators[0]->ctx(); }
+};
+
 // To compare, simply take the output nodes of each function and compare them.
-static absl::StatusOr<Z3_ast> CreateComparisonFunction(
-    absl::Span<std::unique_ptr<IrTranslator>> translators,
-    const std::vector<Function*>& functions) {
-  Z3_context ctx = translators[0]->ctx();
-  Z3_ast result1 = translators[0]->GetReturnNode();
-  Z3_ast result2 = translators[1]->GetReturnNode();
+static absl::StatusOr<Comparison> CreateComparison(
+    const std::vector<Function*>& functions, absl::Duration timeout) {
+  Comparison comparison;
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
+                       IrTranslator::CreateAndTranslate(functions[0]));
+  comparison.translators.push_back(std::move(translator));
+
+  // Get the params for the first function, so we can map the second function's
+  // parameters to them.
+  Z3_context ctx = comparison.ctx();
+  std::vector<Z3_ast> z3_params;
+  for (const Param* param : functions[0]->params()) {
+    z3_params.push_back(comparison.translators[0]->GetTranslation(param));
+  }
+
+  XLS_ASSIGN_OR_RETURN(
+      translator, IrTranslator::CreateAndTranslate(ctx, functions[1],
+                                                   absl::MakeSpan(z3_params)));
+  comparison.translators.push_back(std::move(translator));
+  comparison.translators[0]->SetTimeout(timeout);
+
+  Z3_ast result1 = comparison.translators[0]->GetReturnNode();
+  Z3_ast result2 = comparison.translators[1]->GetReturnNode();
 
   Z3_sort opt_sort = Z3_get_sort(ctx, result1);
   Z3_sort unopt_sort = Z3_get_sort(ctx, result2);
   XLS_RET_CHECK(Z3_is_eq_sort(ctx, opt_sort, unopt_sort));
+  comparison.results_equal = Z3_mk_eq(ctx, result1, result2);
 
-  return Z3_mk_eq(ctx, result1, result2);
+  Type* type = functions[0]->return_value()->GetType();
+  std::vector<Z3_ast> bits1 = comparison.translators[0]->FlattenValue(
+      type, result1, /*little_endian=*/true);
+  std::vector<Z3_ast> bits2 = comparison.translators[1]->FlattenValue(
+      type, result2, /*little_endian=*/true);
+  XLS_RET_CHECK_EQ(bits1.size(), bits2.size());
+  for (int64_t i = 0; i < bits1.size(); ++i) {
+    comparison.result_bits_equal.push_back(Z3_mk_eq(ctx, bits1[i], bits2[i]));
+  }
+  return comparison;
+}
+
+// Proves the output bits of "comparison" equal with "parallelism" independent
+// solvers, each working through its own share of the bits incrementally. As Z3
+// contexts can't be shared between threads, each solver gets its own
+// translation of "functions". If some bit can't be proven, it is re-checked on
+// "solver" (over "comparison") so that its model can be reported from there.
+static absl::StatusOr<Z3_lbool> ProveInParallel(
+    const std::vector<Function*>& functions, absl::Duration timeout,
+    int64_t parallelism, const Comparison& comparison, Z3_solver solver) {
+  const int64_t num_bits = comparison.result_bits_equal.size();
+  std::atomic<bool> done = false;
+  absl::Mutex mutex;
+  absl::Status status;                   // Guarded by mutex.
+  std::optional<int64_t> first_failure;  // Guarded by mutex.
+  auto worker = [&](int64_t shard) {
+    absl::StatusOr<Comparison> worker_comparison =
+        CreateComparison(functions, timeout);
+    if (!worker_comparison.ok()) {
+      absl::MutexLock lock(&mutex);
+      status.Update(worker_comparison.status());
+      done = true;
+      return;
+    }
+    Z3_context ctx = worker_comparison->ctx();
+    Z3_solver worker_solver =
+        solvers::z3::CreateSolver(ctx, /*num_threads=*/1);
+    for (int64_t i = shard; i < num_bits && !done; i += parallelism) {
+      int64_t unused;
+      Z3_lbool result = solvers::z3::ProveEachIncrementally(
+          ctx, worker_solver,
+          absl::MakeConstSpan(&worker_comparison->result_bits_equal[i], 1),
+          &unused);
+      if (result != Z3_L_FALSE) {
+        absl::MutexLock lock(&mutex);
+        if (!first_failure.has_value() || i < first_failure.value()) {
+          first_failure = i;
+        }
+        done = true;
+        break;
+      }
+    }
+    Z3_solver_dec_ref(ctx, worker_solver);
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t shard = 0; shard < parallelism; ++shard) {
+    threads.push_back(
+        std::make_unique<Thread>([&worker, shard]() { worker(shard); }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  XLS_RETURN_IF_ERROR(status);
+
+  if (!first_failure.has_value()) {
+    return Z3_L_FALSE;
+  }
+  int64_t unused;
+  return solvers::z3::ProveEachIncrementally(
+      comparison.ctx(), solver,
+      absl::MakeConstSpan(
+          &comparison.result_bits_equal[first_failure.value()], 1),
+      &unused);
 }
 
 static absl::Status RealMain(const std::vector<std::string_view>& ir_paths,
-                             const std::string& entry, absl::Duration timeout) {
+                             const std::string& entry, absl::Duration timeout,
+                             bool incremental, int64_t parallelism) {
   std::vector<std::unique_ptr<Package>> packages;
   for (const auto ir_path : ir_paths) {
     XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
@@ -127,28 +248,9 @@ static absl::Status RealMain(const std::vector<std::string_view>& ir_paths,
     functions.push_back(func);
   }
 
-  std::vector<std::unique_ptr<IrTranslator>> translators;
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
-                       IrTranslator::CreateAndTranslate(functions[0]));
-  translators.push_back(std::move(translator));
-
-  // Get the params for the first function, so we can map the second function's
-  // parameters to them.
-  Z3_context ctx = translators[0]->ctx();
-  std::vector<Z3_ast> z3_params;
-  for (const Param* param : functions[0]->params()) {
-    z3_params.push_back(translators[0]->GetTranslation(param));
-  }
-
-  XLS_ASSIGN_OR_RETURN(
-      translator, IrTranslator::CreateAndTranslate(ctx, functions[1],
-                                                   absl::MakeSpan(z3_params)));
-  translators.push_back(std::move(translator));
-
-  XLS_ASSIGN_OR_RETURN(
-      Z3_ast results_equal,
-      CreateComparisonFunction(absl::MakeSpan(translators), functions));
-  translators[0]->SetTimeout(timeout);
+  XLS_ASSIGN_OR_RETURN(Comparison comparison,
+                       CreateComparison(functions, timeout));
+  Z3_context ctx = comparison.ctx();
 
   Z3_solver solver =
       solvers::z3::CreateSolver(ctx, std::thread::hardware_concurrency());
@@ -156,11 +258,23 @@ static absl::Status RealMain(const std::vector<std::string_view>& ir_paths,
   // Remember: we try to prove the condition by searching for a model that
   // produces the opposite result. Thus, we want to find a model where the
   // results are _not_ equal.
-  Z3_ast objective = Z3_mk_eq(ctx, Z3_mk_false(ctx), results_equal);
-  Z3_solver_assert(ctx, solver, objective);
+  Z3_lbool satisfiable;
+  if (parallelism > 1) {
+    XLS_ASSIGN_OR_RETURN(satisfiable,
+                         ProveInParallel(functions, timeout, parallelism,
+                                         comparison, solver));
+  } else if (incremental) {
+    int64_t failing_bit;
+    satisfiable = solvers::z3::ProveEachIncrementally(
+        ctx, solver, comparison.result_bits_equal, &failing_bit);
+  } else {
+    Z3_ast objective =
+        Z3_mk_eq(ctx, Z3_mk_false(ctx), comparison.results_equal);
+    Z3_solver_assert(ctx, solver, objective);
+    satisfiable = Z3_solver_check(ctx, solver);
+  }
 
   // Finally, print the output to the terminal in gorgeous two-color ASCII.
-  Z3_lbool satisfiable = Z3_solver_check(ctx, solver);
   std::cout << solvers::z3::SolverResultToString(ctx, solver, satisfiable)
             << std::endl;
 
@@ -175,6 +289,9 @@ int main(int argc, char** argv) {
   std::vector<std::string_view> positional_args =
       xls::InitXls(kUsage, argc, argv);
   XLS_QCHECK_EQ(positional_args.size(), 2) << "Two IR files must be specified!";
+  XLS_QCHECK_GE(absl::GetFlag(FLAGS_parallelism), 1)
+      << "--parallelism must be at least 1.";
   return xls::ExitStatus(xls::RealMain(
-      positional_args, absl::GetFlag(FLAGS_top), absl::GetFlag(FLAGS_timeout)));
+      positional_args, absl::GetFlag(FLAGS_top), absl::GetFlag(FLAGS_timeout),
+      absl::GetFlag(FLAGS_incremental), absl::GetFlag(FLAGS_parallelism)));
 }
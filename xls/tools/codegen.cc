@@ -23,6 +23,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/combinational_generator.h"
@@ -33,6 +34,7 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/delay_model/delay_cache.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/delay_model/ffi_delay_estimator.h"
 #include "xls/fdo/synthesizer.h"
@@ -147,7 +149,7 @@ absl::StatusOr<verilog::CodegenOptions> CodegenOptionsFromProto(
 absl::StatusOr<PipelineSchedule> RunSchedulingPipeline(
     FunctionBase* main, const SchedulingOptions& scheduling_options,
     const DelayEstimator* delay_estimator,
-    synthesis::Synthesizer* synthesizer) {
+    synthesis::Synthesizer* synthesizer, SchedulingPassResults* results) {
   Package* p = main->package();
   SchedulingPassOptions sched_options;
   sched_options.scheduling_options = scheduling_options;
@@ -155,10 +157,9 @@ absl::StatusOr<PipelineSchedule> RunSchedulingPipeline(
   sched_options.synthesizer = synthesizer;
   std::unique_ptr<SchedulingCompoundPass> scheduling_pipeline =
       CreateSchedulingPassPipeline();
-  SchedulingPassResults results;
   SchedulingUnit<> scheduling_unit = {p, /*schedule=*/std::nullopt};
   absl::Status scheduling_status =
-      scheduling_pipeline->Run(&scheduling_unit, sched_options, &results)
+      scheduling_pipeline->Run(&scheduling_unit, sched_options, results)
           .status();
   if (!scheduling_status.ok()) {
     if (absl::IsResourceExhausted(scheduling_status)) {
@@ -221,8 +222,23 @@ absl::StatusOr<CodegenResult> ScheduleAndCodegen(
     const FfiDelayEstimator ffi_estimator(
         scheduling_options.ffi_fallback_delay_ps());
 
-    FirstMatchDelayEstimator delay_estimator("combined_estimator",
-                                             {base_estimator, &ffi_estimator});
+    FirstMatchDelayEstimator combined_estimator(
+        "combined_estimator", {base_estimator, &ffi_estimator});
+
+    // Memoize estimates on node signatures so that each distinct operation is
+    // only estimated once, and across runs if a cache file is given.
+    std::string estimator_key(base_estimator->name());
+    if (scheduling_options.ffi_fallback_delay_ps().has_value()) {
+      absl::StrAppend(&estimator_key, ",ffi_fallback_delay_ps=",
+                      *scheduling_options.ffi_fallback_delay_ps());
+    }
+    DelayCache delay_cache(estimator_key);
+    if (!scheduling_options.delay_cache_path().empty()) {
+      XLS_RETURN_IF_ERROR(
+          delay_cache.Load(scheduling_options.delay_cache_path()));
+    }
+    CachingDelayEstimator delay_estimator("caching_estimator",
+                                          combined_estimator, &delay_cache);
 
     synthesis::Synthesizer* synthesizer = nullptr;
     if (scheduling_options.use_fdo() &&
@@ -230,20 +246,39 @@ absl::StatusOr<CodegenResult> ScheduleAndCodegen(
       XLS_ASSIGN_OR_RETURN(synthesizer,
                            SetUpSynthesizer(scheduling_options));
     }
+    std::optional<DelayCache> synthesis_cache;
+    if (synthesizer != nullptr &&
+        !scheduling_options.fdo_synthesis_cache_path().empty()) {
+      synthesis_cache.emplace(synthesizer->GetDelayCacheKey());
+      XLS_RETURN_IF_ERROR(synthesis_cache->Load(
+          scheduling_options.fdo_synthesis_cache_path()));
+      synthesizer->SetDelayCache(&*synthesis_cache);
+    }
 
-    XLS_ASSIGN_OR_RETURN(PipelineSchedule schedule,
-                         RunSchedulingPipeline(main(), scheduling_options,
-                                               &delay_estimator, synthesizer));
+    PassResults pass_results;
+    XLS_ASSIGN_OR_RETURN(
+        PipelineSchedule schedule,
+        RunSchedulingPipeline(main(), scheduling_options, &delay_estimator,
+                              synthesizer, &pass_results));
+    if (!scheduling_options.delay_cache_path().empty()) {
+      XLS_RETURN_IF_ERROR(
+          delay_cache.Save(scheduling_options.delay_cache_path()));
+    }
+    if (synthesis_cache.has_value()) {
+      XLS_RETURN_IF_ERROR(synthesis_cache->Save(
+          scheduling_options.fdo_synthesis_cache_path()));
+    }
 
     XLS_RETURN_IF_ERROR(VerifyPackage(p, /*codegen=*/true));
 
     XLS_ASSIGN_OR_RETURN(
         verilog::ModuleGeneratorResult result,
         verilog::ToPipelineModuleText(schedule, main(), codegen_options,
-                                      &delay_estimator));
+                                      &delay_estimator, &pass_results));
     return CodegenResult{
         .module_generator_result = result,
         .pipeline_schedule_proto = schedule.ToProto(delay_estimator),
+        .pass_results = std::move(pass_results),
     };
   }
 
@@ -253,10 +288,13 @@ absl::StatusOr<CodegenResult> ScheduleAndCodegen(
       XLS_ASSIGN_OR_RETURN(delay_estimator,
                            SetUpDelayEstimator(scheduling_options_flags_proto));
     }
-    XLS_ASSIGN_OR_RETURN(verilog::ModuleGeneratorResult result,
-                         verilog::GenerateCombinationalModule(
-                             main(), codegen_options, delay_estimator));
-    return CodegenResult{.module_generator_result = result};
+    PassResults pass_results;
+    XLS_ASSIGN_OR_RETURN(
+        verilog::ModuleGeneratorResult result,
+        verilog::GenerateCombinationalModule(main(), codegen_options,
+                                             delay_estimator, &pass_results));
+    return CodegenResult{.module_generator_result = result,
+                         .pass_results = std::move(pass_results)};
   }
 
   // Note: this should already be validated by CodegenFlagsFromAbslFlags().
@@ -17,6 +17,7 @@
 #include "absl/status/statusor.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/ir/package.h"
+#include "xls/passes/pass_base.h"
 #include "xls/scheduling/pipeline_schedule.pb.h"
 #include "xls/tools/codegen_flags.pb.h"
 #include "xls/tools/scheduling_options_flags.pb.h"
@@ -29,6 +30,8 @@ namespace xls {
 struct CodegenResult {
   verilog::ModuleGeneratorResult module_generator_result;
   std::optional<PipelineScheduleProto> pipeline_schedule_proto = std::nullopt;
+  // Invocations of the scheduling and codegen passes.
+  PassResults pass_results;
 };
 
 absl::StatusOr<CodegenResult> ScheduleAndCodegen(
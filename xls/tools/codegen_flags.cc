@@ -45,6 +45,16 @@ ABSL_FLAG(
 ABSL_FLAG(std::string, output_verilog_line_map_path, "",
           "Specific output path for Verilog line map. If not specified then "
           "Verilog line map is not generated.");
+ABSL_FLAG(bool, output_verilog_line_map_delimited, false,
+          "If true, the Verilog line map is written as a stream of "
+          "length-delimited binary VerilogLineMapping protos rather than a "
+          "VerilogLineMap text proto. This avoids building the text of the "
+          "whole line map in memory and lets readers process the mappings "
+          "incrementally.");
+ABSL_FLAG(std::string, output_pass_trace_path, "",
+          "Specific output path for a trace of the scheduling and codegen "
+          "passes in the Chrome trace event format. If not specified then no "
+          "trace is generated.");
 ABSL_FLAG(std::string, top, "",
           "Top entity of the package to generate the (System)Verilog code.");
 ABSL_FLAG(std::string, generator, "pipeline",
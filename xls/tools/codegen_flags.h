@@ -25,6 +25,8 @@ ABSL_DECLARE_FLAG(std::string, output_schedule_ir_path);
 ABSL_DECLARE_FLAG(std::string, output_block_ir_path);
 ABSL_DECLARE_FLAG(std::string, output_signature_path);
 ABSL_DECLARE_FLAG(std::string, output_verilog_line_map_path);
+ABSL_DECLARE_FLAG(bool, output_verilog_line_map_delimited);
+ABSL_DECLARE_FLAG(std::string, output_pass_trace_path);
 
 namespace xls {
 
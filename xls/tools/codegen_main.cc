@@ -13,28 +13,43 @@
 // limitations under the License.
 #include <cstdint>
 #include <filesystem>  // NOLINT
+#include <fstream>
+#include <ios>
 #include <iostream>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+#include "google/protobuf/message.h"
+#include "google/protobuf/util/delimited_message_util.h"
 #include "xls/codegen/module_signature.h"
+#include "xls/codegen/verilog_line_map.pb.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/init_xls.h"
+#include "xls/common/logging/log_lines.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/tracing.h"
+#include "xls/dslx/output_cache.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/verifier.h"
+#include "xls/passes/pass_metrics.h"
 #include "xls/scheduling/pipeline_schedule.pb.h"
 #include "xls/tools/codegen.h"
+#include "xls/tools/codegen_cache_entry.pb.h"
 #include "xls/tools/codegen_flags.h"
 #include "xls/tools/codegen_flags.pb.h"
 #include "xls/tools/scheduling_options_flags.h"
@@ -55,50 +70,192 @@ Emit a feed-forward pipelined module:
        IR_FILE
 )";
 
+ABSL_FLAG(std::string, trace_output, "",
+          "If non-empty, writes a Chrome trace of the phases of this "
+          "invocation (loadable in chrome://tracing or Perfetto) to this "
+          "path.");
+ABSL_FLAG(std::string, cache_dir, "",
+          "If given, directory in which the outputs are cached across "
+          "invocations, keyed on the IR contents and the scheduling and "
+          "codegen options. When an entry exists, the Verilog, signature, "
+          "schedule and block IR are emitted without rerunning scheduling or "
+          "codegen. Not used when --output_pass_trace_path is given.");
+
 namespace xls {
 namespace {
 
-absl::Status RealMain(std::string_view ir_path) {
-  if (ir_path == "-") {
-    ir_path = "/dev/stdin";
+// Writes the mappings of `line_map` to `path` one length-delimited
+// VerilogLineMapping at a time.
+absl::Status WriteDelimitedLineMap(std::string_view path,
+                                   const verilog::VerilogLineMap& line_map) {
+  std::ofstream out{std::string(path), std::ios::binary};
+  if (!out) {
+    return absl::InternalError(
+        absl::StrFormat("Unable to open file %s for writing", path));
+  }
+  for (const verilog::VerilogLineMapping& mapping : line_map.mapping()) {
+    if (!google::protobuf::util::SerializeDelimitedToOstream(mapping, &out)) {
+      return absl::InternalError(
+          absl::StrFormat("Failed writing line map to %s", path));
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Returns a deterministic serialization of `message` for use in cache keys.
+std::string SerializeForKey(const google::protobuf::Message& message) {
+  std::string out;
+  {
+    google::protobuf::io::StringOutputStream stream(&out);
+    google::protobuf::io::CodedOutputStream coded(&stream);
+    coded.SetSerializationDeterministic(true);
+    XLS_CHECK(message.SerializeToCodedStream(&coded));
+  }
+  return out;
+}
+
+// Returns the key under which the outputs of scheduling and generating code
+// for `ir_contents` with the given options are cached.
+std::string CacheKey(
+    std::string_view ir_contents, const CodegenFlagsProto& codegen_flags_proto,
+    const SchedulingOptionsFlagsProto& scheduling_options_flags_proto,
+    bool delay_model_flag_passed) {
+  std::string codegen_flags = SerializeForKey(codegen_flags_proto);
+  std::string scheduling_options_flags =
+      SerializeForKey(scheduling_options_flags_proto);
+  std::string key = "codegen_main\n";
+  for (std::string_view piece :
+       {std::string_view(codegen_flags),
+        std::string_view(scheduling_options_flags),
+        std::string_view(delay_model_flag_passed ? "1" : "0"), ir_contents}) {
+    absl::StrAppend(&key, piece.size(), ":", piece, "\n");
   }
-  XLS_ASSIGN_OR_RETURN(std::string ir_contents, GetFileContents(ir_path));
+  return key;
+}
+
+// Schedules and generates code for the top of the package in `ir_contents`.
+// If `pass_trace` is non-null it is populated with a Chrome trace of the
+// passes that ran.
+absl::StatusOr<CodegenCacheEntryProto> Codegen(
+    std::string_view ir_contents, std::string_view ir_path,
+    const CodegenFlagsProto& codegen_flags_proto,
+    const SchedulingOptionsFlagsProto& scheduling_options_flags_proto,
+    bool delay_model_flag_passed, std::string* pass_trace) {
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> p,
                        Parser::ParsePackage(ir_contents, ir_path));
-
-  XLS_ASSIGN_OR_RETURN(CodegenFlagsProto codegen_flags_proto,
-                       GetCodegenFlags());
   if (!codegen_flags_proto.top().empty()) {
     XLS_RETURN_IF_ERROR(p->SetTopByName(codegen_flags_proto.top()));
   }
 
   XLS_RET_CHECK(p->GetTop().has_value())
       << "Package " << p->name() << " needs a top function/proc.";
-  auto main = [&p]() -> FunctionBase* { return p->GetTop().value(); };
 
+  XLS_ASSIGN_OR_RETURN(
+      CodegenResult r,
+      ScheduleAndCodegen(p.get(), scheduling_options_flags_proto,
+                         codegen_flags_proto, delay_model_flag_passed));
+  verilog::ModuleGeneratorResult& result = r.module_generator_result;
+
+  if (!absl::GetFlag(FLAGS_output_block_ir_path).empty()) {
+    XLS_QCHECK_EQ(p->blocks().size(), 1)
+        << "There should be exactly one block in the package after generating "
+           "module text.";
+  }
+
+  XLS_VLOG_LINES(1, SummarizePassResults(r.pass_results));
+  if (pass_trace != nullptr) {
+    *pass_trace = PassResultsToChromeTrace(r.pass_results);
+  }
+
+  CodegenCacheEntryProto entry;
+  entry.set_verilog_text(std::move(result.verilog_text));
+  *entry.mutable_signature() = result.signature.proto();
+  if (r.pipeline_schedule_proto.has_value()) {
+    *entry.mutable_schedule() = *std::move(r.pipeline_schedule_proto);
+  }
+  *entry.mutable_verilog_line_map() = std::move(result.verilog_line_map);
+  entry.set_package_ir(p->DumpIr());
+  return entry;
+}
+
+absl::Status RealMain(std::string_view ir_path,
+                      std::optional<std::filesystem::path> cache_dir) {
+  if (ir_path == "-") {
+    ir_path = "/dev/stdin";
+  }
+  XLS_ASSIGN_OR_RETURN(MappedFile ir_file, MappedFile::Open(ir_path));
+  std::string_view ir_contents = ir_file.contents();
+
+  XLS_ASSIGN_OR_RETURN(CodegenFlagsProto codegen_flags_proto,
+                       GetCodegenFlags());
   XLS_ASSIGN_OR_RETURN(
       SchedulingOptionsFlagsProto scheduling_options_flags_proto,
       GetSchedulingOptionsFlagsProto());
   XLS_ASSIGN_OR_RETURN(
       bool delay_model_flag_passed,
       IsDelayModelSpecifiedViaFlag(scheduling_options_flags_proto));
-  XLS_ASSIGN_OR_RETURN(
-      CodegenResult r,
-      ScheduleAndCodegen(p.get(), scheduling_options_flags_proto,
-                         codegen_flags_proto, delay_model_flag_passed));
-  verilog::ModuleGeneratorResult result = r.module_generator_result;
-  std::optional<PipelineScheduleProto> schedule = r.pipeline_schedule_proto;
+
+  // The pass trace describes the passes that actually ran, so it cannot be
+  // served from the cache.
+  const std::string& pass_trace_path =
+      absl::GetFlag(FLAGS_output_pass_trace_path);
+  std::optional<dslx::OutputCache> cache;
+  if (cache_dir.has_value() && pass_trace_path.empty()) {
+    cache.emplace(*cache_dir);
+  }
+
+  std::string cache_key;
+  std::optional<CodegenCacheEntryProto> entry;
+  if (cache.has_value()) {
+    cache_key = CacheKey(ir_contents, codegen_flags_proto,
+                         scheduling_options_flags_proto,
+                         delay_model_flag_passed);
+    XLS_ASSIGN_OR_RETURN(std::optional<std::string> cached,
+                         cache->Lookup(cache_key));
+    if (cached.has_value()) {
+      entry.emplace();
+      if (!entry->ParseFromString(*cached)) {
+        XLS_LOG(WARNING) << "Ignoring corrupt codegen cache entry.";
+        entry.reset();
+      } else {
+        XLS_VLOG(1) << "Using cached codegen output.";
+      }
+    }
+  }
+
+  if (!entry.has_value()) {
+    std::string pass_trace;
+    XLS_ASSIGN_OR_RETURN(
+        entry, Codegen(ir_contents, ir_path, codegen_flags_proto,
+                       scheduling_options_flags_proto, delay_model_flag_passed,
+                       pass_trace_path.empty() ? nullptr : &pass_trace));
+    if (!pass_trace_path.empty()) {
+      XLS_RETURN_IF_ERROR(SetFileContents(pass_trace_path, pass_trace));
+    }
+    if (cache.has_value()) {
+      // The delay cache feeds scheduling, so entries depend on its contents.
+      std::vector<std::filesystem::path> dependencies;
+      if (!scheduling_options_flags_proto.delay_cache_path().empty()) {
+        dependencies.push_back(
+            scheduling_options_flags_proto.delay_cache_path());
+      }
+      if (absl::Status status = cache->Insert(cache_key, dependencies,
+                                              entry->SerializeAsString());
+          !status.ok()) {
+        XLS_LOG(WARNING) << "Failed to cache codegen output: " << status;
+      }
+    }
+  }
 
   if (!absl::GetFlag(FLAGS_output_schedule_ir_path).empty()) {
-    XLS_RETURN_IF_ERROR(
-        SetFileContents(absl::GetFlag(FLAGS_output_schedule_ir_path),
-                        main()->package()->DumpIr()));
+    XLS_RETURN_IF_ERROR(SetFileContents(
+        absl::GetFlag(FLAGS_output_schedule_ir_path), entry->package_ir()));
   }
 
   if (!absl::GetFlag(FLAGS_output_schedule_path).empty()) {
-    if (schedule.has_value()) {
+    if (entry->has_schedule()) {
       XLS_RETURN_IF_ERROR(SetTextProtoFile(
-          absl::GetFlag(FLAGS_output_schedule_path), schedule.value()));
+          absl::GetFlag(FLAGS_output_schedule_path), entry->schedule()));
     } else {
       XLS_RETURN_IF_ERROR(
           SetFileContents(absl::GetFlag(FLAGS_output_schedule_path), ""));
@@ -106,37 +263,41 @@ absl::Status RealMain(std::string_view ir_path) {
   }
 
   if (!absl::GetFlag(FLAGS_output_block_ir_path).empty()) {
-    XLS_QCHECK_EQ(p->blocks().size(), 1)
-        << "There should be exactly one block in the package after generating "
-           "module text.";
     XLS_RETURN_IF_ERROR(SetFileContents(
-        absl::GetFlag(FLAGS_output_block_ir_path), p->DumpIr()));
+        absl::GetFlag(FLAGS_output_block_ir_path), entry->package_ir()));
   }
 
   if (!absl::GetFlag(FLAGS_output_signature_path).empty()) {
     XLS_RETURN_IF_ERROR(SetTextProtoFile(
-        absl::GetFlag(FLAGS_output_signature_path), result.signature.proto()));
+        absl::GetFlag(FLAGS_output_signature_path), entry->signature()));
   }
 
+  verilog::VerilogLineMap& verilog_line_map =
+      *entry->mutable_verilog_line_map();
   const std::string& verilog_path = absl::GetFlag(FLAGS_output_verilog_path);
   if (!verilog_path.empty()) {
     std::filesystem::path absolute = std::filesystem::absolute(verilog_path);
-    for (int64_t i = 0; i < result.verilog_line_map.mapping_size(); ++i) {
-      result.verilog_line_map.mutable_mapping(i)->set_verilog_file(absolute);
+    for (int64_t i = 0; i < verilog_line_map.mapping_size(); ++i) {
+      verilog_line_map.mutable_mapping(i)->set_verilog_file(absolute);
     }
   }
 
   const std::string& verilog_line_map_path =
       absl::GetFlag(FLAGS_output_verilog_line_map_path);
   if (!verilog_line_map_path.empty()) {
-    XLS_RETURN_IF_ERROR(
-        SetTextProtoFile(verilog_line_map_path, result.verilog_line_map));
+    if (absl::GetFlag(FLAGS_output_verilog_line_map_delimited)) {
+      XLS_RETURN_IF_ERROR(
+          WriteDelimitedLineMap(verilog_line_map_path, verilog_line_map));
+    } else {
+      XLS_RETURN_IF_ERROR(
+          SetTextProtoFile(verilog_line_map_path, verilog_line_map));
+    }
   }
 
   if (verilog_path.empty()) {
-    std::cout << result.verilog_text;
+    std::cout << entry->verilog_text();
   } else {
-    XLS_RETURN_IF_ERROR(SetFileContents(verilog_path, result.verilog_text));
+    XLS_RETURN_IF_ERROR(SetFileContents(verilog_path, entry->verilog_text()));
   }
   return absl::OkStatus();
 }
@@ -147,11 +308,16 @@ absl::Status RealMain(std::string_view ir_path) {
 int main(int argc, char** argv) {
   std::vector<std::string_view> positional_arguments =
       xls::InitXls(kUsage, argc, argv);
+  xls::ScopedTraceOutput trace_output(absl::GetFlag(FLAGS_trace_output));
 
   if (positional_arguments.size() != 1) {
     XLS_LOG(QFATAL) << absl::StreamFormat("Expected invocation: %s IR_FILE",
                                           argv[0]);
   }
   std::string_view ir_path = positional_arguments[0];
-  return xls::ExitStatus(xls::RealMain(ir_path));
+  std::optional<std::filesystem::path> cache_dir;
+  if (std::string flag = absl::GetFlag(FLAGS_cache_dir); !flag.empty()) {
+    cache_dir = flag;
+  }
+  return xls::ExitStatus(xls::RealMain(ir_path, cache_dir));
 }
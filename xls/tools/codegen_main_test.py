@@ -135,6 +135,34 @@ class CodeGenMainTest(parameterized.TestCase):
     ]).decode('utf-8')
     self._compare_to_golden(verilog)
 
+  def test_cached_outputs(self):
+    ir_file = self.create_tempfile(content=NOT_ADD_IR)
+    cache_dir = self.create_tempdir().full_path
+
+    def run_codegen(name):
+      signature_path = test_base.create_named_output_text_file(
+          f'{name}_sig.textproto')
+      schedule_path = test_base.create_named_output_text_file(
+          f'{name}_schedule.textproto')
+      verilog = subprocess.check_output([
+          CODEGEN_MAIN_PATH, '--generator=pipeline', '--delay_model=unit',
+          '--pipeline_stages=2', '--alsologtostderr', '--top=not_add',
+          '--cache_dir=' + cache_dir,
+          '--output_signature_path=' + signature_path,
+          '--output_schedule_path=' + schedule_path, ir_file.full_path
+      ]).decode('utf-8')
+      with open(signature_path, 'r') as f:
+        signature = f.read()
+      with open(schedule_path, 'r') as f:
+        schedule = f.read()
+      return verilog, signature, schedule
+
+    uncached = run_codegen('uncached')
+    self.assertNotEmpty(os.listdir(cache_dir))
+    cached = run_codegen('cached')
+    self.assertEqual(uncached, cached)
+    self.assertIn('module not_add(', cached[0])
+
   @parameterized.parameters(range(1, 6))
   def test_fixed_pipeline_length(self, pipeline_stages):
     signature_path = test_base.create_named_output_text_file(
@@ -18,6 +18,7 @@
 // TODO(leary): 2019-04-07 Probably want a way to select the desired output
 // format; e.g. -hex, -dec, -bin and so on.
 
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <ostream>
@@ -27,11 +28,17 @@
 #include <vector>
 
 #include "absl/flags/flag.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
 #include "absl/types/span.h"
 #include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/ir/format_preference.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/tools/device_rpc_strategy.h"
@@ -43,11 +50,38 @@ ABSL_FLAG(int64_t, device_ordinal, 0,
           "Device ordinal within the -target_device category, useful when "
           "multiple are present.");
 ABSL_FLAG(std::string, function_type, "", "Function type being invoked.");
+ABSL_FLAG(std::string, input_file, "",
+          "Argument sets to invoke the function with, one set per line. Each "
+          "line should contain a semicolon-separated list of values. The "
+          "results are printed one per line in the same order. Cannot be "
+          "specified with positional arguments.");
+ABSL_FLAG(int64_t, max_in_flight, 4,
+          "Maximum number of invocations from --input_file that may be "
+          "outstanding on the device at once.");
 
 namespace xls {
 namespace tools {
 namespace {
 
+absl::StatusOr<std::vector<Value>> ParseArguments(
+    const FunctionType& function_type,
+    absl::Span<const std::string_view> args) {
+  if (args.size() != function_type.parameter_count()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Expected %d arguments, got %d",
+                        function_type.parameter_count(), args.size()));
+  }
+  std::vector<Value> arguments;
+  for (int64_t i = 0; i < args.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(
+        Value argument,
+        Parser::ParseValue(absl::StripAsciiWhitespace(args[i]),
+                           function_type.parameter_type(i)));
+    arguments.push_back(std::move(argument));
+  }
+  return arguments;
+}
+
 absl::Status RealMain(absl::Span<const std::string_view> args) {
   std::string target_device = absl::GetFlag(FLAGS_target_device);
   XLS_QCHECK(!target_device.empty()) << "Must provide -target_device";
@@ -61,24 +95,49 @@ absl::Status RealMain(absl::Span<const std::string_view> args) {
   XLS_QCHECK_OK(function_type_status.status());
   FunctionType* function_type = function_type_status.value();
 
-  std::vector<Value> arguments;
-  for (int64_t i = 0; i < args.size(); ++i) {
-    std::string_view s = args[i];
-    absl::StatusOr<Value> argument =
-        Parser::ParseValue(s, function_type->parameter_type(i));
-    XLS_QCHECK_OK(argument.status());
-    arguments.push_back(std::move(argument).value());
-  }
-
   absl::StatusOr<std::unique_ptr<DeviceRpcStrategy>> drpc_status =
       DeviceRpcStrategyFactory::GetSingleton()->Create(target_device);
   XLS_QCHECK_OK(drpc_status.status());
 
   std::unique_ptr<DeviceRpcStrategy> drpc = std::move(drpc_status).value();
+
+  std::string input_file = absl::GetFlag(FLAGS_input_file);
+  if (!input_file.empty()) {
+    XLS_QCHECK(args.empty())
+        << "Cannot specify both --input_file and positional arguments";
+    XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(input_file));
+    std::vector<std::vector<Value>> argument_sets;
+    for (std::string_view line :
+         absl::StrSplit(contents, '\n', absl::SkipWhitespace())) {
+      std::vector<std::string_view> pieces = absl::StrSplit(line, ';');
+      absl::StatusOr<std::vector<Value>> arguments =
+          ParseArguments(*function_type, pieces);
+      XLS_QCHECK_OK(arguments.status())
+          << absl::StreamFormat("Invalid line in input file %s: %s",
+                                input_file, line);
+      argument_sets.push_back(std::move(arguments).value());
+    }
+
+    XLS_QCHECK_OK(drpc->Connect(absl::GetFlag(FLAGS_device_ordinal)));
+    XLS_ASSIGN_OR_RETURN(
+        std::vector<Value> results,
+        drpc->CallUnnamedBatch(*function_type, argument_sets,
+                               absl::GetFlag(FLAGS_max_in_flight)));
+    for (const Value& result : results) {
+      std::cout << result.ToString(FormatPreference::kHex) << "\n";
+    }
+    std::cout << std::flush;
+    return absl::OkStatus();
+  }
+
+  absl::StatusOr<std::vector<Value>> arguments =
+      ParseArguments(*function_type, args);
+  XLS_QCHECK_OK(arguments.status());
+
   XLS_QCHECK_OK(drpc->Connect(absl::GetFlag(FLAGS_device_ordinal)));
 
   absl::StatusOr<Value> rpc_status =
-      drpc->CallUnnamed(*function_type, arguments);
+      drpc->CallUnnamed(*function_type, *arguments);
   if (rpc_status.ok()) {
     std::cout << rpc_status->ToString(FormatPreference::kHex) << std::endl;
   }
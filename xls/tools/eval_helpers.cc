@@ -23,7 +23,8 @@
 #include "absl/strings/str_split.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/indent.h"
-#include "xls/ir/ir_parser.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/fast_value_parser.h"
 #include "re2/re2.h"
 
 namespace xls {
@@ -93,7 +94,7 @@ ParseChannelValues(std::string_view all_channel_values,
             values_per_channel == max_values_count.value()) {
           break;
         }
-        XLS_ASSIGN_OR_RETURN(Value value, Parser::ParseTypedValue(line));
+        XLS_ASSIGN_OR_RETURN(Value value, ParseTypedValueFast(line));
         channel_values.push_back(value);
         values_per_channel++;
         break;
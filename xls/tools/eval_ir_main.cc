@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdio>
+#include <cstdlib>
 #include <filesystem>  // NOLINT
 #include <iostream>
 #include <memory>
@@ -24,16 +26,22 @@
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/types/span.h"
 #include "xls/common/exit_status.h"
+#include "xls/common/file/file_descriptor.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/common/tracing.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
 #include "xls/dslx/import_data.h"
@@ -43,10 +51,14 @@
 #include "xls/dslx/warning_kind.h"
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/interpreter/random_value.h"
+#include "xls/ir/fast_value_parser.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
 #include "xls/ir/value_helpers.h"
 #include "xls/jit/function_jit.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/tiered_evaluator.h"
+#include "xls/jit/type_layout.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_pipeline.h"
 
@@ -91,6 +103,10 @@ Evaluate IR after every optimization pass:
 
    eval_ir_main --random_inputs=100 --optimize_ir --eval_after_each_pass IR_FILE
 
+Evaluate a large INPUT_FILE without loading it into memory, using 8 threads:
+
+   eval_ir_main --input_file=INPUT_FILE --streaming_threads=8 IR_FILE
+
 Evaluate IR using the JIT and with the interpreter and compare the results:
 
    eval_ir_main --test_llvm_jit --random_inputs=100  IR_FILE
@@ -125,12 +141,25 @@ ABSL_FLAG(
     "When specified with --optimize_ir, run evaluation after each pass. "
     "A non-zero error status is returned if any of the results do not match.");
 ABSL_FLAG(bool, use_llvm_jit, true, "Use the LLVM IR JIT for execution.");
+ABSL_FLAG(bool, use_tiered_jit, false,
+          "When used with --use_llvm_jit, start evaluating in the interpreter "
+          "while the JIT compiles in the background and switch to native code "
+          "once compilation finishes.");
 ABSL_FLAG(bool, test_llvm_jit, false,
           "If true, then run the JIT and compare the results against the "
           "interpereter.");
 ABSL_FLAG(int64_t, llvm_opt_level, 3,
           "The optimization level of the LLVM JIT. Valid values are from 0 (no "
           "optimizations) to 3 (maximum optimizations).");
+ABSL_FLAG(int64_t, streaming_threads, 0,
+          "If non-zero, --input_file (and --expected_file) are streamed "
+          "rather than loaded into memory and chunks of inputs are evaluated "
+          "in parallel on this many threads, each with its own JIT (or "
+          "interpreter). Results are printed in input order. Cannot be "
+          "specified with --optimize_ir, --test_llvm_jit or --use_tiered_jit.");
+ABSL_FLAG(int64_t, streaming_chunk_size, 4096,
+          "Number of inputs evaluated by a thread at a time when "
+          "--streaming_threads is specified.");
 ABSL_FLAG(std::string, input_validator_expr, "",
           "DSLX expression to validate randomly-generated inputs. "
           "The expression can reference entry function input arguments "
@@ -153,6 +182,11 @@ ABSL_FLAG(
     "force mismatches between JIT and interpreter for testing purposed.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
 
+ABSL_FLAG(std::string, trace_output, "",
+          "If non-empty, writes a Chrome trace of the phases of this "
+          "invocation (loadable in chrome://tracing or Perfetto) to this "
+          "path.");
+
 namespace xls {
 namespace {
 
@@ -180,22 +214,32 @@ absl::StatusOr<std::vector<Value>> Eval(
     std::string_view actual_src = "actual",
     std::string_view expected_src = "expected") {
   std::unique_ptr<FunctionJit> jit;
+  std::unique_ptr<TieredFunctionEvaluator> tiered;
   if (use_jit) {
     // No support for procs yet.
-    XLS_ASSIGN_OR_RETURN(
-        jit, FunctionJit::Create(f, absl::GetFlag(FLAGS_llvm_opt_level)));
+    if (absl::GetFlag(FLAGS_use_tiered_jit)) {
+      XLS_ASSIGN_OR_RETURN(tiered,
+                           TieredFunctionEvaluator::Create(
+                               f, absl::GetFlag(FLAGS_llvm_opt_level)));
+    } else {
+      XLS_ASSIGN_OR_RETURN(
+          jit, FunctionJit::Create(f, absl::GetFlag(FLAGS_llvm_opt_level)));
+    }
   }
 
   std::vector<Value> results;
   for (const ArgSet& arg_set : arg_sets) {
     Value result;
     if (use_jit) {
-      if (absl::GetFlag(FLAGS_test_only_inject_jit_result).empty()) {
-        XLS_ASSIGN_OR_RETURN(result,
-                             DropInterpreterEvents(jit->Run(arg_set.args)));
-      } else {
+      if (!absl::GetFlag(FLAGS_test_only_inject_jit_result).empty()) {
         XLS_ASSIGN_OR_RETURN(result, Parser::ParseTypedValue(absl::GetFlag(
                                          FLAGS_test_only_inject_jit_result)));
+      } else if (tiered != nullptr) {
+        XLS_ASSIGN_OR_RETURN(result,
+                             DropInterpreterEvents(tiered->Run(arg_set.args)));
+      } else {
+        XLS_ASSIGN_OR_RETURN(result,
+                             DropInterpreterEvents(jit->Run(arg_set.args)));
       }
     } else {
       // TODO(https://github.com/google/xls/issues/506): 2021-10-12 Also compare
@@ -314,12 +358,173 @@ absl::StatusOr<ArgSet> ArgSetFromString(std::string_view args_string) {
   ArgSet arg_set;
   for (const std::string_view& value_string :
        absl::StrSplit(args_string, ';')) {
-    XLS_ASSIGN_OR_RETURN(Value arg, Parser::ParseTypedValue(value_string));
+    XLS_ASSIGN_OR_RETURN(Value arg, ParseTypedValueFast(value_string));
     arg_set.args.push_back(arg);
   }
   return arg_set;
 }
 
+// Reads the next line of `file` which is not entirely whitespace. Returns
+// std::nullopt at the end of the file.
+absl::StatusOr<std::optional<std::string>> ReadNonEmptyLine(
+    const FileStream& file) {
+  while (true) {
+    char* line = nullptr;
+    size_t capacity = 0;
+    ssize_t length = getline(&line, &capacity, file.get());
+    std::unique_ptr<char, decltype(&free)> line_deleter(line, &free);
+    if (length < 0) {
+      if (ferror(file.get())) {
+        return absl::InternalError(
+            absl::StrFormat("Error reading `%s`", file.path().string()));
+      }
+      return std::nullopt;
+    }
+    std::string_view stripped =
+        absl::StripAsciiWhitespace(std::string_view(line, length));
+    if (!stripped.empty()) {
+      return std::string(stripped);
+    }
+  }
+}
+
+// A contiguous range of the lines of the input (and expected) file evaluated
+// by a single thread when streaming.
+struct InputChunk {
+  // Index of the first input of the chunk in the input file.
+  int64_t first_index = 0;
+  std::vector<std::string> input_lines;
+  // Empty if no expected file is given.
+  std::vector<std::string> expected_lines;
+  // The formatted results, one per line.
+  std::string output;
+};
+
+// Evaluates the inputs of `chunk` and fills in its output. `jit` may be null
+// in which case the interpreter is used.
+absl::Status EvalChunk(Function* f, FunctionJit* jit, InputChunk& chunk) {
+  chunk.output.clear();
+  for (int64_t i = 0; i < chunk.input_lines.size(); ++i) {
+    int64_t index = chunk.first_index + i;
+    absl::StatusOr<ArgSet> arg_set = ArgSetFromString(chunk.input_lines[i]);
+    if (!arg_set.ok()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid line %d in input file: %s: %s", index,
+                          chunk.input_lines[i], arg_set.status().message()));
+    }
+    Value result;
+    if (jit != nullptr) {
+      XLS_ASSIGN_OR_RETURN(result,
+                           DropInterpreterEvents(jit->Run(arg_set->args)));
+    } else {
+      XLS_ASSIGN_OR_RETURN(
+          result, DropInterpreterEvents(InterpretFunction(f, arg_set->args)));
+    }
+    absl::StrAppend(&chunk.output, result.ToString(FormatPreference::kHex),
+                    "\n");
+    if (chunk.expected_lines.empty()) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(Value expected,
+                         ParseTypedValueFast(chunk.expected_lines[i]));
+    if (result != expected) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Miscompare for input[%i] \"%s\"\n  actual: %s\n  expected: %s",
+          index, ArgsToString(arg_set->args),
+          result.ToString(FormatPreference::kHex),
+          expected.ToString(FormatPreference::kHex)));
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Evaluates the inputs in `input_path` without loading the file into memory.
+// Rounds of up to `thread_count` chunks of `chunk_size` inputs are read and
+// evaluated in parallel, then the results are printed in input order.
+absl::Status RunStreaming(Function* f, const std::filesystem::path& input_path,
+                          const std::filesystem::path& expected_path,
+                          int64_t thread_count, int64_t chunk_size) {
+  XLS_RET_CHECK_GT(thread_count, 0);
+  XLS_RET_CHECK_GT(chunk_size, 0);
+  XLS_ASSIGN_OR_RETURN(FileStream input_file,
+                       FileStream::Open(input_path, "r"));
+  std::optional<FileStream> expected_file;
+  if (!expected_path.empty()) {
+    XLS_ASSIGN_OR_RETURN(expected_file, FileStream::Open(expected_path, "r"));
+  }
+
+  // JIT instances are not thread-safe so each thread gets its own. Compile
+  // them up front so compilation does not race with output.
+  std::vector<std::unique_ptr<FunctionJit>> jits(thread_count);
+  if (absl::GetFlag(FLAGS_use_llvm_jit)) {
+    for (std::unique_ptr<FunctionJit>& jit : jits) {
+      XLS_ASSIGN_OR_RETURN(
+          jit, FunctionJit::Create(f, absl::GetFlag(FLAGS_llvm_opt_level)));
+    }
+  }
+
+  std::vector<InputChunk> chunks(thread_count);
+  std::vector<absl::Status> statuses(thread_count);
+  int64_t input_count = 0;
+  bool done = false;
+  while (!done) {
+    // Read the next round of chunks.
+    int64_t chunk_count = 0;
+    while (chunk_count < thread_count && !done) {
+      InputChunk& chunk = chunks[chunk_count];
+      chunk.first_index = input_count;
+      chunk.input_lines.clear();
+      chunk.expected_lines.clear();
+      while (chunk.input_lines.size() < chunk_size) {
+        XLS_ASSIGN_OR_RETURN(std::optional<std::string> input_line,
+                             ReadNonEmptyLine(input_file));
+        std::optional<std::string> expected_line;
+        if (expected_file.has_value()) {
+          XLS_ASSIGN_OR_RETURN(expected_line,
+                               ReadNonEmptyLine(expected_file.value()));
+          if (input_line.has_value() != expected_line.has_value()) {
+            return absl::InvalidArgumentError(
+                "Number of values in expected file does not match the number "
+                "of inputs.");
+          }
+        }
+        if (!input_line.has_value()) {
+          done = true;
+          break;
+        }
+        chunk.input_lines.push_back(std::move(input_line).value());
+        if (expected_line.has_value()) {
+          chunk.expected_lines.push_back(std::move(expected_line).value());
+        }
+        ++input_count;
+      }
+      if (!chunk.input_lines.empty()) {
+        ++chunk_count;
+      }
+    }
+
+    {
+      std::vector<std::unique_ptr<Thread>> threads;
+      for (int64_t i = 0; i < chunk_count; ++i) {
+        threads.push_back(std::make_unique<Thread>([&, i]() {
+          statuses[i] = EvalChunk(f, jits[i].get(), chunks[i]);
+        }));
+      }
+      for (std::unique_ptr<Thread>& thread : threads) {
+        thread->Join();
+      }
+    }
+
+    // Print the results in order, stopping at the first error.
+    for (int64_t i = 0; i < chunk_count; ++i) {
+      XLS_RETURN_IF_ERROR(statuses[i]);
+      std::cout << chunks[i].output;
+    }
+    std::cout.flush();
+  }
+  return absl::OkStatus();
+}
+
 // Converts the given DSLX validation function into IR.
 absl::StatusOr<std::unique_ptr<Package>> ConvertValidator(
     Function* f, std::string_view dslx_stdlib_path,
@@ -371,6 +576,26 @@ absl::StatusOr<bool> ValidateInput(Function* validator, const ArgSet& arg_set) {
   return bits.IsOne();
 }
 
+// Returns `count` argument sets for `f` with random uniformly distributed bits.
+// The arguments are generated in bulk in the JIT's native layout and then
+// converted to Values, which is much faster than calling RandomValue for each.
+absl::StatusOr<std::vector<ArgSet>> GenerateRandomArgSets(
+    Function* f, int64_t count, std::minstd_rand* rng_engine) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitRuntime> runtime,
+                       JitRuntime::Create());
+  std::vector<ArgSet> arg_sets(count);
+  for (Param* param : f->params()) {
+    const TypeLayout& layout = runtime->GetTypeLayout(param->GetType());
+    std::vector<uint8_t> buffer(count * layout.size());
+    RandomNativeValues(layout, count, rng_engine, absl::MakeSpan(buffer));
+    for (int64_t i = 0; i < count; ++i) {
+      arg_sets[i].args.push_back(
+          layout.NativeLayoutToValue(buffer.data() + i * layout.size()));
+    }
+  }
+  return arg_sets;
+}
+
 absl::StatusOr<ArgSet> GenerateArgSet(Function* f, Function* validator,
                                       std::minstd_rand* rng_engine) {
   ArgSet arg_set;
@@ -406,14 +631,33 @@ absl::Status RealMain(std::string_view input_path,
   if (input_path == "-") {
     input_path = "/dev/stdin";
   }
-  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(input_path));
+  XLS_ASSIGN_OR_RETURN(MappedFile ir_file, MappedFile::Open(input_path));
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
-                       Parser::ParsePackage(contents, input_path));
+                       Parser::ParsePackage(ir_file.contents(), input_path));
   if (!absl::GetFlag(FLAGS_top).empty()) {
     XLS_RETURN_IF_ERROR(package->SetTopByName(absl::GetFlag(FLAGS_top)));
   }
   XLS_ASSIGN_OR_RETURN(Function * f, package->GetTopAsFunction());
 
+  if (absl::GetFlag(FLAGS_streaming_threads) != 0) {
+    XLS_QCHECK(!absl::GetFlag(FLAGS_input_file).empty())
+        << "--streaming_threads requires --input_file";
+    XLS_QCHECK(absl::GetFlag(FLAGS_input).empty() &&
+               absl::GetFlag(FLAGS_random_inputs) == 0 &&
+               absl::GetFlag(FLAGS_expected).empty())
+        << "Cannot specify --input, --random_inputs or --expected with "
+           "--streaming_threads";
+    XLS_QCHECK(!absl::GetFlag(FLAGS_optimize_ir) &&
+               !absl::GetFlag(FLAGS_test_llvm_jit) &&
+               !absl::GetFlag(FLAGS_use_tiered_jit))
+        << "Cannot specify --optimize_ir, --test_llvm_jit or --use_tiered_jit "
+           "with --streaming_threads";
+    return RunStreaming(f, absl::GetFlag(FLAGS_input_file),
+                        absl::GetFlag(FLAGS_expected_file),
+                        absl::GetFlag(FLAGS_streaming_threads),
+                        absl::GetFlag(FLAGS_streaming_chunk_size));
+  }
+
   std::vector<ArgSet> arg_sets;
   if (!absl::GetFlag(FLAGS_input).empty()) {
     XLS_QCHECK_EQ(absl::GetFlag(FLAGS_random_inputs), 0)
@@ -429,11 +673,11 @@ absl::Status RealMain(std::string_view input_path,
   } else if (!absl::GetFlag(FLAGS_input_file).empty()) {
     XLS_QCHECK_EQ(absl::GetFlag(FLAGS_random_inputs), 0)
         << "Cannot specify both --input_file and --random_inputs";
-    absl::StatusOr<std::string> args_input_file =
-        GetFileContents(absl::GetFlag(FLAGS_input_file));
+    absl::StatusOr<MappedFile> args_input_file =
+        MappedFile::Open(absl::GetFlag(FLAGS_input_file));
     XLS_QCHECK_OK(args_input_file.status());
-    for (const auto& arg_line : absl::StrSplit(args_input_file.value(), '\n',
-                                               absl::SkipWhitespace())) {
+    for (const auto& arg_line : absl::StrSplit(args_input_file->contents(),
+                                               '\n', absl::SkipWhitespace())) {
       absl::StatusOr<ArgSet> arg_set_status = ArgSetFromString(arg_line);
       XLS_QCHECK_OK(arg_set_status.status())
           << absl::StreamFormat("Invalid line in input file %s: %s",
@@ -464,8 +708,14 @@ absl::Status RealMain(std::string_view input_path,
       XLS_ASSIGN_OR_RETURN(validator, validator_pkg->GetFunction(mangled_name));
     }
 
-    for (ArgSet& arg_set : arg_sets) {
-      XLS_ASSIGN_OR_RETURN(arg_set, GenerateArgSet(f, validator, &rng_engine));
+    if (validator == nullptr) {
+      XLS_ASSIGN_OR_RETURN(
+          arg_sets, GenerateRandomArgSets(f, arg_sets.size(), &rng_engine));
+    } else {
+      for (ArgSet& arg_set : arg_sets) {
+        XLS_ASSIGN_OR_RETURN(arg_set,
+                             GenerateArgSet(f, validator, &rng_engine));
+      }
     }
   }
 
@@ -481,14 +731,14 @@ absl::Status RealMain(std::string_view input_path,
       arg_set.expected = expected_status.value();
     }
   } else if (!absl::GetFlag(FLAGS_expected_file).empty()) {
-    absl::StatusOr<std::string> expected_file =
-        GetFileContents(absl::GetFlag(FLAGS_expected_file));
+    absl::StatusOr<MappedFile> expected_file =
+        MappedFile::Open(absl::GetFlag(FLAGS_expected_file));
     XLS_QCHECK_OK(expected_file.status());
     std::vector<Value> expecteds;
-    for (const auto& expected_line :
-         absl::StrSplit(expected_file.value(), '\n', absl::SkipWhitespace())) {
+    for (const auto& expected_line : absl::StrSplit(
+             expected_file->contents(), '\n', absl::SkipWhitespace())) {
       absl::StatusOr<Value> expected_status =
-          Parser::ParseTypedValue(expected_line);
+          ParseTypedValueFast(expected_line);
       XLS_QCHECK_OK(expected_status.status())
           << absl::StreamFormat("Failed to parse line in expected file %s: %s",
                                 expected_line, expected_line);
@@ -511,6 +761,7 @@ absl::Status RealMain(std::string_view input_path,
 int main(int argc, char** argv) {
   std::vector<std::string_view> positional_arguments =
       xls::InitXls(kUsage, argc, argv);
+  xls::ScopedTraceOutput trace_output(absl::GetFlag(FLAGS_trace_output));
   if (positional_arguments.empty()) {
     XLS_LOG(QFATAL) << absl::StreamFormat("Expected invocation: %s <ir-path>",
                                           argv[0]);
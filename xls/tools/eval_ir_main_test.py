@@ -165,6 +165,42 @@ class EvalMainTest(absltest.TestCase):
     self.assertIn('Miscompare for input[1] "bits[32]:0x10; bits[32]:0x0"',
                   comp.stderr.decode('utf-8'))
 
+  def test_streaming_input_file(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    inputs = ['bits[32]:0x{:x}; bits[32]:0x{:x}'.format(i, 2 * i)
+              for i in range(100)]
+    input_file = self.create_tempfile(content='\n\n'.join(inputs))
+    expected = ['bits[32]:0x{:x}'.format(3 * i) for i in range(100)]
+    expected_file = self.create_tempfile(content='\n'.join(expected))
+    for use_jit in (True, False):
+      results = subprocess.check_output([
+          EVAL_IR_MAIN_PATH, '--input_file=' + input_file.full_path,
+          '--expected_file=' + expected_file.full_path,
+          '--streaming_threads=3', '--streaming_chunk_size=7',
+          '--use_llvm_jit={}'.format(str(use_jit).lower()), ir_file.full_path
+      ])
+      self.assertSequenceEqual(expected,
+                               results.decode('utf-8').strip().split('\n'))
+
+  def test_streaming_input_file_with_failed_expected_file(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    input_file = self.create_tempfile(
+        content='\n'.join(('bits[32]:0x42; bits[32]:0x123',
+                           'bits[32]:0x10; bits[32]:0x00')))
+    expected_file = self.create_tempfile(content='\n'.join(('bits[32]:0x165',
+                                                            'bits[32]:0xf1f')))
+    comp = subprocess.run([
+        EVAL_IR_MAIN_PATH, '--input_file=' + input_file.full_path,
+        '--expected_file=' + expected_file.full_path, '--streaming_threads=2',
+        '--streaming_chunk_size=1', ir_file.full_path
+    ],
+                          stdout=subprocess.PIPE,
+                          stderr=subprocess.PIPE,
+                          check=False)
+    self.assertNotEqual(comp.returncode, 0)
+    self.assertIn('Miscompare for input[1] "bits[32]:0x10; bits[32]:0x0"',
+                  comp.stderr.decode('utf-8'))
+
   def test_empty_input_file(self):
     ir_file = self.create_tempfile(content=ADD_IR)
     input_file = self.create_tempfile(content='')
@@ -36,6 +36,7 @@
 #include "absl/strings/escaping.h"
 #include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
@@ -51,7 +52,10 @@
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/interpreter_proc_runtime.h"
 #include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/activity_profile.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/fast_value_parser.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/nodes.h"
@@ -60,6 +64,8 @@
 #include "xls/ir/value.h"
 #include "xls/ir/value_helpers.h"
 #include "xls/jit/jit_proc_runtime.h"
+#include "xls/jit/orc_jit.h"
+#include "xls/tools/channel_value_stream.h"
 #include "xls/tools/eval_helpers.h"
 
 constexpr const char* kUsage = R"(
@@ -78,6 +84,8 @@ ABSL_FLAG(std::vector<std::string>, ticks, {},
 ABSL_FLAG(std::string, backend, "serial_jit",
           "Backend to use for evaluation. Valid options are:\n"
           " * serial_jit: JIT-backed single-stepping runtime.\n"
+          " * tiered_jit: Single-stepping runtime which starts in the "
+          "interpreter and switches to the JIT once compilation finishes.\n"
           " * ir_interpreter: Interpreter at the IR level.\n"
           " * block_interpreter: Interpret a block generated from a proc.");
 ABSL_FLAG(std::string, block_signature_proto, "",
@@ -87,14 +95,17 @@ ABSL_FLAG(int64_t, max_cycles_no_output, 100,
 ABSL_FLAG(
     std::vector<std::string>, inputs_for_channels, {},
     "Comma separated list of channel=filename pairs, for example: ch_a=foo.ir. "
-    "Files contain one XLS Value in human-readable form per line. Either "
-    "'inputs_for_channels' or 'inputs_for_all_channels' can be defined.");
+    "Files are in the format given by 'channel_file_format'. For proc "
+    "backends the files are read lazily as the procs consume the values. "
+    "Either 'inputs_for_channels' or 'inputs_for_all_channels' can be "
+    "defined.");
 ABSL_FLAG(
     std::vector<std::string>, expected_outputs_for_channels, {},
     "Comma separated list of channel=filename pairs, for example: ch_a=foo.ir. "
-    "Files contain one XLS Value in human-readable form per line. Either "
-    "'expected_outputs_for_channels' or 'expected_outputs_for_all_channels' "
-    "can be defined.\n"
+    "Files are in the format given by 'channel_file_format'. For proc "
+    "backends the outputs are compared to the files as they are produced. "
+    "Either 'expected_outputs_for_channels' or "
+    "'expected_outputs_for_all_channels' can be defined.\n"
     "For procs, when 'expected_outputs_for_channels' or "
     "'expected_outputs_for_all_channels' are not specified the values of all "
     "the channel are displayed on stdout.");
@@ -125,6 +136,19 @@ ABSL_FLAG(
     "For procs, when 'expected_outputs_for_channels' or "
     "'expected_outputs_for_all_channels' are not specified the values of all "
     "the channel are displayed on stdout.");
+ABSL_FLAG(std::vector<std::string>, outputs_for_channels, {},
+          "Comma separated list of channel=filename pairs, for example: "
+          "ch_a=foo.ir. The values sent on each channel are written to the "
+          "file as they are produced in the format given by "
+          "'channel_file_format' rather than being printed on stdout. Only "
+          "supported by the proc backends.");
+ABSL_FLAG(std::string, channel_file_format, "text",
+          "Format of the files given to 'inputs_for_channels', "
+          "'expected_outputs_for_channels' and 'outputs_for_channels'. Valid "
+          "options are:\n"
+          " * text: one XLS Value in human-readable form per line.\n"
+          " * binary: a header naming the channel type followed by one "
+          "fixed-size record per value (see channel_value_stream.h).");
 ABSL_FLAG(std::string, streaming_channel_data_suffix, "_data",
           "Suffix to data signals for streaming channels.");
 ABSL_FLAG(std::string, streaming_channel_valid_suffix, "_vld",
@@ -148,6 +172,11 @@ ABSL_FLAG(int64_t, random_seed, 42, "Random seed");
 ABSL_FLAG(double, prob_input_valid_assert, 1.0,
           "Single-cycle probability of asserting valid with more input ready.");
 ABSL_FLAG(bool, show_trace, false, "Whether or not to print trace messages.");
+ABSL_FLAG(std::string, activity_profile, "",
+          "If non-empty, the path of a file to which the activity counters of "
+          "each proc (how often select arms are chosen, predicates hold and "
+          "channel operations fire or block) are written after evaluation. "
+          "Only supported by the serial_jit and ir_interpreter backends.");
 ABSL_FLAG(std::vector<std::string>, model_memories, {},
           "Comma separated list of memory=depth/element_type:initial_value "
           "pairs, for example: "
@@ -155,17 +184,62 @@ ABSL_FLAG(std::vector<std::string>, model_memories, {},
 
 namespace xls {
 
+// Per-channel files which are streamed while evaluating procs rather than
+// loaded into memory. Each map is from channel name to file path.
+struct ChannelFiles {
+  ChannelValueFormat format = ChannelValueFormat::kText;
+  absl::flat_hash_map<std::string, std::string> inputs;
+  absl::flat_hash_map<std::string, std::string> expected_outputs;
+  absl::flat_hash_map<std::string, std::string> outputs;
+  // Maximum number of values read from each input or expected output file.
+  int64_t max_values = 0;
+};
+
+// The streams attached to a single output channel. Values sent on the channel
+// are drained from its queue after each tick.
+struct OutputStream {
+  ChannelQueue* queue = nullptr;
+  std::unique_ptr<ChannelValueReader> expected;
+  // Whether all values in `expected` have been verified.
+  bool expected_done = false;
+  std::unique_ptr<ChannelValueWriter> writer;
+};
+
 static absl::Status EvaluateProcs(
-    Package* package, bool use_jit, const std::vector<int64_t>& ticks,
+    Package* package, std::string_view backend,
+    const std::vector<int64_t>& ticks,
     const absl::flat_hash_map<std::string, std::vector<Value>>&
         inputs_for_channels,
     absl::flat_hash_map<std::string, std::vector<Value>>&
-        expected_outputs_for_channels) {
+        expected_outputs_for_channels,
+    const ChannelFiles& channel_files) {
+  // Declared before the runtime as the runtime's queues call into the
+  // readers.
+  std::vector<std::unique_ptr<ChannelValueReader>> input_readers;
+  absl::flat_hash_map<std::string, OutputStream> output_streams;
+
+  std::string activity_profile_path = absl::GetFlag(FLAGS_activity_profile);
+  bool activity_profile = !activity_profile_path.empty();
   std::unique_ptr<SerialProcRuntime> runtime;
-  if (use_jit) {
-    XLS_ASSIGN_OR_RETURN(runtime, CreateJitSerialProcRuntime(package));
+  if (backend == "serial_jit") {
+    // Traces are only read when shown, so don't generate code to record them
+    // otherwise.
+    JitTargetOptions target_options;
+    target_options.trace_recording = absl::GetFlag(FLAGS_show_trace)
+                                         ? TraceRecording::kEager
+                                         : TraceRecording::kDisabled;
+    target_options.activity_profile = activity_profile;
+    XLS_ASSIGN_OR_RETURN(runtime,
+                         CreateJitSerialProcRuntime(package, target_options));
+  } else if (backend == "tiered_jit") {
+    if (activity_profile) {
+      return absl::InvalidArgumentError(
+          "--activity_profile is not supported by the tiered_jit backend");
+    }
+    XLS_ASSIGN_OR_RETURN(runtime, CreateTieredSerialProcRuntime(package));
   } else {
-    XLS_ASSIGN_OR_RETURN(runtime, CreateInterpreterSerialProcRuntime(package));
+    XLS_ASSIGN_OR_RETURN(runtime, CreateInterpreterSerialProcRuntime(
+                                      package, activity_profile));
   }
 
   ChannelQueueManager& queue_manager = runtime->queue_manager();
@@ -177,6 +251,70 @@ static absl::Status EvaluateProcs(
     }
   }
 
+  for (const auto& [channel_name, path] : channel_files.inputs) {
+    XLS_ASSIGN_OR_RETURN(Channel * channel, package->GetChannel(channel_name));
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<ChannelValueReader> reader,
+        ChannelValueReader::Open(path, channel_files.format, channel->type()));
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * in_queue,
+                         queue_manager.GetQueueByName(channel_name));
+    XLS_RETURN_IF_ERROR(in_queue->AttachGenerator(
+        reader->AsGenerator(channel_files.max_values)));
+    input_readers.push_back(std::move(reader));
+  }
+  for (const auto& [channel_name, path] : channel_files.expected_outputs) {
+    XLS_ASSIGN_OR_RETURN(Channel * channel, package->GetChannel(channel_name));
+    OutputStream& stream = output_streams[channel_name];
+    XLS_ASSIGN_OR_RETURN(
+        stream.expected,
+        ChannelValueReader::Open(path, channel_files.format, channel->type()));
+  }
+  for (const auto& [channel_name, path] : channel_files.outputs) {
+    XLS_ASSIGN_OR_RETURN(Channel * channel, package->GetChannel(channel_name));
+    OutputStream& stream = output_streams[channel_name];
+    XLS_ASSIGN_OR_RETURN(
+        stream.writer,
+        ChannelValueWriter::Open(path, channel_files.format, channel->type()));
+  }
+  for (auto& [channel_name, stream] : output_streams) {
+    XLS_ASSIGN_OR_RETURN(stream.queue,
+                         queue_manager.GetQueueByName(channel_name));
+  }
+
+  bool checked_any_output = false;
+  // Moves the values produced on streamed output channels out of their queues,
+  // writing and verifying them along the way.
+  auto drain_output_streams = [&]() -> absl::Status {
+    for (const std::unique_ptr<ChannelValueReader>& reader : input_readers) {
+      XLS_RETURN_IF_ERROR(reader->status());
+    }
+    for (auto& [channel_name, stream] : output_streams) {
+      while (std::optional<Value> out_val = stream.queue->Read()) {
+        if (stream.writer != nullptr) {
+          XLS_RETURN_IF_ERROR(stream.writer->Write(out_val.value()));
+        }
+        if (stream.expected == nullptr || stream.expected_done) {
+          continue;
+        }
+        std::optional<Value> value;
+        if (stream.expected->values_read() < channel_files.max_values) {
+          XLS_ASSIGN_OR_RETURN(value, stream.expected->Next());
+        }
+        if (!value.has_value()) {
+          // Values beyond the expected ones are not checked.
+          stream.expected_done = true;
+          continue;
+        }
+        XLS_RET_CHECK_EQ(value.value(), out_val.value()) << absl::StreamFormat(
+            "Mismatched (channel=%s) after %d outputs (%s != %s)", channel_name,
+            stream.expected->values_read() - 1, value->ToString(),
+            out_val->ToString());
+        checked_any_output = true;
+      }
+    }
+    return absl::OkStatus();
+  };
+
   for (int64_t this_ticks : ticks) {
     if (absl::GetFlag(FLAGS_show_trace)) {
       XLS_LOG(INFO) << "Resetting proc state";
@@ -191,6 +329,7 @@ static absl::Status EvaluateProcs(
       // Don't double print events (traces, assertions, etc)
       runtime->ClearInterpreterEvents();
       XLS_RETURN_IF_ERROR(runtime->Tick());
+      XLS_RETURN_IF_ERROR(drain_output_streams());
 
       // Sort the keys for stable print order.
       absl::flat_hash_map<Proc*, std::vector<Value>> states;
@@ -231,7 +370,38 @@ static absl::Status EvaluateProcs(
     }
   }
 
-  bool checked_any_output = false;
+  if (activity_profile) {
+    std::vector<Proc*> sorted_procs;
+    for (const auto& proc : package->procs()) {
+      sorted_procs.push_back(proc.get());
+    }
+    std::sort(sorted_procs.begin(), sorted_procs.end(),
+              [](Proc* a, Proc* b) { return a->name() < b->name(); });
+    std::string profile_text;
+    for (Proc* proc : sorted_procs) {
+      const ActivityProfile* profile = runtime->GetActivityProfile(proc);
+      XLS_RET_CHECK(profile != nullptr);
+      absl::StrAppend(&profile_text, profile->ToString());
+    }
+    XLS_RETURN_IF_ERROR(SetFileContents(activity_profile_path, profile_text));
+  }
+
+  for (auto& [channel_name, stream] : output_streams) {
+    if (stream.writer != nullptr) {
+      XLS_RETURN_IF_ERROR(stream.writer->Flush());
+    }
+    if (stream.expected == nullptr || stream.expected_done ||
+        stream.expected->values_read() >= channel_files.max_values) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(std::optional<Value> value, stream.expected->Next());
+    if (value.has_value()) {
+      return absl::UnknownError(absl::StrFormat(
+          "Channel %s didn't produce all expected values, %d values verified",
+          channel_name, stream.expected->values_read() - 1));
+    }
+  }
+
   for (const auto& [channel_name, values] : expected_outputs_for_channels) {
     XLS_ASSIGN_OR_RETURN(ChannelQueue * out_queue,
                          queue_manager.GetQueueByName(channel_name));
@@ -253,13 +423,16 @@ static absl::Status EvaluateProcs(
     }
   }
 
-  if (!checked_any_output && !expected_outputs_for_channels.empty()) {
+  if (!checked_any_output && (!expected_outputs_for_channels.empty() ||
+                              !channel_files.expected_outputs.empty())) {
     return absl::UnknownError("No output verified (empty expected values?)");
   }
 
-  if (expected_outputs_for_channels.empty()) {
+  if (expected_outputs_for_channels.empty() &&
+      channel_files.expected_outputs.empty()) {
     for (const Channel* channel : package->channels()) {
-      if (!channel->CanSend()) {
+      // Values of streamed channels have already been written out.
+      if (!channel->CanSend() || output_streams.contains(channel->name())) {
         continue;
       }
       XLS_ASSIGN_OR_RETURN(ChannelQueue * out_queue,
@@ -804,7 +977,7 @@ static absl::StatusOr<std::vector<Value>> ParseValuesFile(
       XLS_VLOG(1) << "Parsing values file at line " << li;
     }
     li++;
-    XLS_ASSIGN_OR_RETURN(Value expected_status, Parser::ParseTypedValue(line));
+    XLS_ASSIGN_OR_RETURN(Value expected_status, ParseTypedValueFast(line));
     ret.push_back(expected_status);
     if (li == max_lines) {
       break;
@@ -876,6 +1049,8 @@ static absl::Status RealMain(
     const int64_t max_cycles_no_output,
     const std::vector<std::string>& inputs_for_channels_text,
     const std::vector<std::string>& expected_outputs_for_channels_text,
+    const std::vector<std::string>& outputs_for_channels_text,
+    std::string_view channel_file_format,
     const std::vector<std::string>& model_memories_text,
     const std::string& inputs_for_all_channels_text,
     const std::string& expected_outputs_for_all_channels_text,
@@ -895,11 +1070,38 @@ static absl::Status RealMain(
   const int64_t total_ticks =
       std::accumulate(ticks.begin(), ticks.end(), static_cast<int64_t>(0));
 
+  // The proc backends stream per-channel files through the channel queues
+  // instead of loading them into memory.
+  const bool is_proc_backend = backend == "serial_jit" ||
+                               backend == "tiered_jit" ||
+                               backend == "ir_interpreter";
+  ChannelFiles channel_files;
+  XLS_ASSIGN_OR_RETURN(channel_files.format,
+                       ChannelValueFormatFromString(channel_file_format));
+  channel_files.max_values = total_ticks;
+  if (is_proc_backend) {
+    XLS_ASSIGN_OR_RETURN(channel_files.inputs,
+                         ParseChannelFilenames(inputs_for_channels_text));
+    XLS_ASSIGN_OR_RETURN(
+        channel_files.expected_outputs,
+        ParseChannelFilenames(expected_outputs_for_channels_text));
+    XLS_ASSIGN_OR_RETURN(channel_files.outputs,
+                         ParseChannelFilenames(outputs_for_channels_text));
+  } else if (!outputs_for_channels_text.empty()) {
+    return absl::InvalidArgumentError(
+        "--outputs_for_channels is only supported by the proc backends");
+  } else if (channel_files.format != ChannelValueFormat::kText) {
+    return absl::InvalidArgumentError(
+        "--channel_file_format=binary is only supported by the proc backends");
+  }
+
   absl::flat_hash_map<std::string, std::vector<Value>> inputs_for_channels;
   if (!inputs_for_channels_text.empty()) {
-    XLS_ASSIGN_OR_RETURN(
-        inputs_for_channels,
-        GetValuesForEachChannels(inputs_for_channels_text, total_ticks));
+    if (!is_proc_backend) {
+      XLS_ASSIGN_OR_RETURN(
+          inputs_for_channels,
+          GetValuesForEachChannels(inputs_for_channels_text, total_ticks));
+    }
   } else if (!inputs_for_all_channels_text.empty()) {
     XLS_ASSIGN_OR_RETURN(
         inputs_for_channels,
@@ -909,9 +1111,12 @@ static absl::Status RealMain(
   absl::flat_hash_map<std::string, std::vector<Value>>
       expected_outputs_for_channels;
   if (!expected_outputs_for_channels_text.empty()) {
-    XLS_ASSIGN_OR_RETURN(expected_outputs_for_channels,
-                         GetValuesForEachChannels(
-                             expected_outputs_for_channels_text, total_ticks));
+    if (!is_proc_backend) {
+      XLS_ASSIGN_OR_RETURN(
+          expected_outputs_for_channels,
+          GetValuesForEachChannels(expected_outputs_for_channels_text,
+                                   total_ticks));
+    }
   } else if (!expected_outputs_for_all_channels_text.empty()) {
     XLS_ASSIGN_OR_RETURN(
         expected_outputs_for_channels,
@@ -933,13 +1138,9 @@ static absl::Status RealMain(
                        "specified to eval_proc_main";
   }
 
-  if (backend == "serial_jit") {
-    return EvaluateProcs(package.get(), /*use_jit=*/true, ticks,
-                         inputs_for_channels, expected_outputs_for_channels);
-  }
-  if (backend == "ir_interpreter") {
-    return EvaluateProcs(package.get(), /*use_jit=*/false, ticks,
-                         inputs_for_channels, expected_outputs_for_channels);
+  if (is_proc_backend) {
+    return EvaluateProcs(package.get(), backend, ticks, inputs_for_channels,
+                         expected_outputs_for_channels, channel_files);
   }
   if (backend == "block_interpreter") {
     verilog::ModuleSignatureProto proto;
@@ -967,8 +1168,8 @@ int main(int argc, char* argv[]) {
   }
 
   std::string backend = absl::GetFlag(FLAGS_backend);
-  if (backend != "serial_jit" && backend != "ir_interpreter" &&
-      backend != "block_interpreter") {
+  if (backend != "serial_jit" && backend != "tiered_jit" &&
+      backend != "ir_interpreter" && backend != "block_interpreter") {
     XLS_LOG(QFATAL) << "Unrecognized backend choice.";
   }
 
@@ -1007,6 +1208,8 @@ int main(int argc, char* argv[]) {
       ticks, absl::GetFlag(FLAGS_max_cycles_no_output),
       absl::GetFlag(FLAGS_inputs_for_channels),
       absl::GetFlag(FLAGS_expected_outputs_for_channels),
+      absl::GetFlag(FLAGS_outputs_for_channels),
+      absl::GetFlag(FLAGS_channel_file_format),
       absl::GetFlag(FLAGS_model_memories),
       absl::GetFlag(FLAGS_inputs_for_all_channels),
       absl::GetFlag(FLAGS_expected_outputs_for_all_channels),
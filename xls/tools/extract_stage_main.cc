@@ -21,6 +21,7 @@
 #include "absl/status/status.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
@@ -46,8 +47,15 @@ static absl::Status RealMain(const std::string& ir_path,
                              std::optional<std::string> function_name,
                              const std::string& schedule_path, int stage,
                              const std::string& output_path) {
-  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
-  XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
+  // Only the function being staged (and its callees) needs to be parsed.
+  XLS_ASSIGN_OR_RETURN(MappedFile ir_file, MappedFile::Open(ir_path));
+  std::vector<std::string> roots;
+  if (function_name) {
+    roots.push_back(*function_name);
+  }
+  XLS_ASSIGN_OR_RETURN(
+      auto package,
+      Parser::ParsePackageSubset(ir_file.contents(), roots, ir_path));
   FunctionBase* function;
   if (function_name) {
     auto get_proc = package->GetFunction(function_name.value());
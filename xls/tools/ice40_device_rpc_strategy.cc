@@ -20,18 +20,23 @@
 #include <termios.h>
 #include <unistd.h>
 
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>
 #include <ios>
 #include <optional>
 #include <string>
 #include <system_error>
+#include <utility>
 #include <vector>
 
+#include "absl/cleanup/cleanup.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/math_util.h"
@@ -167,6 +172,81 @@ std::string LocalModesToString(tcflag_t local_modes) {
   return absl::StrJoin(pieces, ", ");
 }
 
+// Packs the arguments of a single invocation into the byte stream the uncore
+// expects.
+absl::StatusOr<std::vector<uint8_t>> FlattenArguments(
+    absl::Span<const Value> arguments) {
+  BitPushBuffer buffer;
+  for (const Value& arg : arguments) {
+    arg.FlattenTo(&buffer);
+  }
+
+  if (buffer.empty()) {
+    // TODO(leary): 2019-04-07 We probably want this to be possible eventually,
+    // but we'd have to decide whether in this case the device function is
+    // constantly producing output data since there's no input event to trigger
+    // it, so we'd just move on to the read itself.
+    return absl::InvalidArgumentError("Cannot perform an empty-payload RPC.");
+  }
+  return buffer.GetUint8Data();
+}
+
+int64_t ResultSizeInBytes(const FunctionType& function_type) {
+  return CeilOfRatio(function_type.return_type()->GetFlatBitCount(),
+                     int64_t{8});
+}
+
+absl::Status WriteAll(int fd, absl::Span<const uint8_t> data) {
+  int64_t bytes_written = 0;
+  while (bytes_written < data.size()) {
+    int ret =
+        write(fd, data.data() + bytes_written, data.size() - bytes_written);
+    if (ret < 0) {
+      return absl::InternalError(
+          absl::StrFormat("Could not write partial data of %d remaining bytes "
+                          "(originally %d) to ICE40: %s",
+                          data.size() - bytes_written, data.size(),
+                          Strerror(errno)));
+    }
+    bytes_written += ret;
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<uint8_t>> ReadAll(int fd, int64_t size) {
+  XLS_VLOG(3) << "Reading device response; expecting " << size << " bytes.";
+  std::vector<uint8_t> result(size);
+  int64_t bytes_read = 0;
+  while (bytes_read < result.size()) {
+    int ret =
+        read(fd, result.data() + bytes_read, result.size() - bytes_read);
+    if (ret < 0) {
+      return absl::InternalError(
+          absl::StrFormat("Could not read partial data of %d remaining bytes "
+                          "(originally %d) from ICE40: %s",
+                          result.size() - bytes_read, result.size(),
+                          Strerror(errno)));
+    }
+    bytes_read += ret;
+  }
+  return result;
+}
+
+absl::StatusOr<Value> DecodeResult(const FunctionType& function_type,
+                                   absl::Span<const uint8_t> result) {
+  if (function_type.return_type()->IsBits() &&
+      function_type.return_type()->AsBitsOrDie()->bit_count() == 8) {
+    return Value(UBits(result[0], 8));
+  }
+
+  if (function_type.return_type()->IsBits() &&
+      function_type.return_type()->AsBitsOrDie()->bit_count() == 32) {
+    return Value(UBits(*absl::bit_cast<uint32_t*>(result.data()), 32));
+  }
+
+  return absl::UnimplementedError("NYI: convert result to Value");
+}
+
 }  // namespace
 
 Ice40DeviceRpcStrategy::~Ice40DeviceRpcStrategy() {
@@ -262,70 +342,78 @@ absl::Status Ice40DeviceRpcStrategy::Connect(int64_t device_ordinal) {
 
 absl::StatusOr<Value> Ice40DeviceRpcStrategy::CallUnnamed(
     const FunctionType& function_type, absl::Span<const Value> arguments) {
-  BitPushBuffer buffer;
-  for (const Value& arg : arguments) {
-    arg.FlattenTo(&buffer);
-  }
-
-  if (buffer.empty()) {
-    // TODO(leary): 2019-04-07 We probably want this to be possible eventually,
-    // but we'd have to decide whether in this case the device function is
-    // constantly producing output data since there's no input event to trigger
-    // it, so we'd just move on to the read itself.
-    return absl::InvalidArgumentError("Cannot perform an empty-payload RPC.");
-  }
-
-  std::vector<uint8_t> u8_data = buffer.GetUint8Data();
-
-  int64_t bytes_written = 0;
-  while (bytes_written < buffer.size_in_bytes()) {
-    int ret = write(tty_fd_.value(), u8_data.data() + bytes_written,
-                    u8_data.size() - bytes_written);
-    if (ret < 0) {
-      return absl::InternalError(
-          absl::StrFormat("Could not write partial data of %d remaining bytes "
-                          "(originally %d) to ICE40: %s",
-                          buffer.size_in_bytes() - bytes_written,
-                          buffer.size_in_bytes(), Strerror(errno)));
-    }
-    bytes_written += ret;
-  }
+  XLS_RET_CHECK(tty_fd_.has_value()) << "Not connected to an ICE40 device.";
+  XLS_ASSIGN_OR_RETURN(std::vector<uint8_t> u8_data,
+                       FlattenArguments(arguments));
+  XLS_RETURN_IF_ERROR(WriteAll(tty_fd_.value(), u8_data));
 
   if (tcflush(tty_fd_.value(), TCOFLUSH) != 0) {
     return absl::InternalError("Could not flush write(s) to device.");
   }
 
-  int64_t output_bits = function_type.return_type()->GetFlatBitCount();
-  std::vector<uint8_t> result(CeilOfRatio(output_bits, int64_t{8}));
-
-  XLS_VLOG(3) << "Reading device response; expecting " << result.size()
-              << " bytes.";
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<uint8_t> result,
+      ReadAll(tty_fd_.value(), ResultSizeInBytes(function_type)));
+  return DecodeResult(function_type, result);
+}
 
-  int64_t bytes_read = 0;
-  while (bytes_read < result.size()) {
-    int ret = read(tty_fd_.value(), result.data() + bytes_read,
-                   result.size() - bytes_read);
-    if (ret < 0) {
-      return absl::InternalError(
-          absl::StrFormat("Could not read partial data of %d remaining bytes "
-                          "(originally %d) from ICE40: %s",
-                          buffer.size_in_bytes() - bytes_written,
-                          buffer.size_in_bytes(), Strerror(errno)));
-    }
-    bytes_read += ret;
+absl::StatusOr<std::vector<Value>> Ice40DeviceRpcStrategy::CallUnnamedBatch(
+    const FunctionType& function_type,
+    absl::Span<const std::vector<Value>> argument_sets,
+    int64_t max_in_flight) {
+  XLS_RET_CHECK(tty_fd_.has_value()) << "Not connected to an ICE40 device.";
+  XLS_RET_CHECK_GE(max_in_flight, 1);
+  const int fd = tty_fd_.value();
+
+  // Flatten everything up front so the link is not idle while we pack bits.
+  std::vector<std::vector<uint8_t>> requests;
+  requests.reserve(argument_sets.size());
+  for (const std::vector<Value>& arguments : argument_sets) {
+    XLS_ASSIGN_OR_RETURN(std::vector<uint8_t> request,
+                         FlattenArguments(arguments));
+    requests.push_back(std::move(request));
   }
 
-  if (function_type.return_type()->IsBits() &&
-      function_type.return_type()->AsBitsOrDie()->bit_count() == 8) {
-    return Value(UBits(result[0], 8));
+  // Let the uncore's clear-to-send output throttle our writes for the duration
+  // of the batch; restore the original attributes afterwards.
+  struct termios original;
+  if (tcgetattr(fd, &original) != 0) {
+    return absl::InternalError(absl::StrFormat(
+        "Could not retrieve terminal attributes from file descriptor; got: %s",
+        Strerror(errno)));
   }
-
-  if (function_type.return_type()->IsBits() &&
-      function_type.return_type()->AsBitsOrDie()->bit_count() == 32) {
-    return Value(UBits(*absl::bit_cast<uint32_t*>(result.data()), 32));
+  struct termios flow_controlled = original;
+  flow_controlled.c_cflag |= CRTSCTS;
+  if (tcsetattr(fd, TCSADRAIN, &flow_controlled) != 0) {
+    return absl::InternalError("Could not enable hardware flow control.");
   }
-
-  return absl::UnimplementedError("NYI: convert result to Value");
+  absl::Cleanup restore_attributes = [&] {
+    if (tcsetattr(fd, TCSADRAIN, &original) != 0) {
+      XLS_LOG(ERROR) << "Could not restore terminal attributes: "
+                     << Strerror(errno);
+    }
+  };
+
+  // Keep up to max_in_flight requests outstanding: each result that comes back
+  // makes room for the next request, so the device never waits on a host
+  // round trip between invocations. Bounding the window also bounds how many
+  // result bytes can pile up in the host's receive buffer.
+  const int64_t result_bytes = ResultSizeInBytes(function_type);
+  std::vector<Value> results;
+  results.reserve(requests.size());
+  int64_t sent = 0;
+  while (results.size() < requests.size()) {
+    while (sent < requests.size() &&
+           sent - static_cast<int64_t>(results.size()) < max_in_flight) {
+      XLS_RETURN_IF_ERROR(WriteAll(fd, requests[sent]));
+      ++sent;
+    }
+    XLS_ASSIGN_OR_RETURN(std::vector<uint8_t> result,
+                         ReadAll(fd, result_bytes));
+    XLS_ASSIGN_OR_RETURN(Value value, DecodeResult(function_type, result));
+    results.push_back(std::move(value));
+  }
+  return results;
 }
 
 }  // namespace xls
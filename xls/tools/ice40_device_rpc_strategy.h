@@ -15,7 +15,9 @@
 #ifndef XLS_TOOLS_ICE40_DEVICE_RPC_STRATEGY_H_
 #define XLS_TOOLS_ICE40_DEVICE_RPC_STRATEGY_H_
 
+#include <cstdint>
 #include <optional>
+#include <vector>
 
 #include "absl/status/statusor.h"
 #include "xls/tools/device_rpc_strategy.h"
@@ -31,6 +33,14 @@ class Ice40DeviceRpcStrategy : public DeviceRpcStrategy {
   absl::StatusOr<Value> CallUnnamed(const FunctionType& function_type,
                                     absl::Span<const Value> arguments) override;
 
+  // Streams the argument sets to the device with hardware (CTS) flow control
+  // enabled for the duration of the batch; the uncore deasserts clear-to-send
+  // while it cannot accept more input bytes.
+  absl::StatusOr<std::vector<Value>> CallUnnamedBatch(
+      const FunctionType& function_type,
+      absl::Span<const std::vector<Value>> argument_sets,
+      int64_t max_in_flight) override;
+
  private:
   std::optional<int> tty_fd_;
 };
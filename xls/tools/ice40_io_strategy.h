@@ -37,6 +37,10 @@ class Ice40IoStrategy : public IOStrategy {
 
   absl::StatusOr<std::vector<VerilogInclude>> GetIncludes() override;
 
+  // The UART receiver deasserts clear-to-send while it holds a byte the
+  // uncore has not consumed yet.
+  bool SupportsStreamingInput() const override { return true; }
+
  private:
   // The files tick-included by the IO strategy.
   constexpr static const char* kIncludes[] = {
@@ -81,6 +81,13 @@ class IOStrategy {
   // is included with (eg, "foo/bar.v" for "`include "foo/bar.v") and the
   // Verilog text of the included file.
   virtual absl::StatusOr<std::vector<VerilogInclude>> GetIncludes() = 0;
+
+  // Returns whether the byte transport applies backpressure to the host while
+  // the uncore cannot accept more input (e.g. via a clear-to-send line). When
+  // true, the host may stream several invocations back to back (see
+  // DeviceRpcStrategy::CallUnnamedBatch) rather than waiting for each result
+  // before sending the next set of arguments.
+  virtual bool SupportsStreamingInput() const { return false; }
 };
 
 }  // namespace verilog
@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <iostream>
 #include <iterator>
@@ -31,6 +33,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/types/span.h"
 #include "xls/common/exit_status.h"
@@ -42,6 +45,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/subprocess.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
@@ -100,6 +104,12 @@ from the interpreter results. Example invocation:
   ir_minimizer_main --test_llvm_jit --use_optimization_pipeline \
     --input='bits[32]:42; bits[1]:0' IR_FILE
 
+For large inputs, --parallelism=N generates N candidate reductions per round
+and tests them concurrently. In addition to the random simplifications, each
+round includes delta-debugging style candidates which replace a whole subset of
+the nodes with literals, so large irrelevant portions of the IR can be removed
+in a single step.
+
 )";
 
 ABSL_FLAG(bool, can_remove_params, false,
@@ -159,6 +169,13 @@ ABSL_FLAG(int64_t, simplifications_between_tests, 1,
           "Number of simplifications to do in-between tests. Increasing this "
           "value may speed minimization for large designs, especially when "
           "--test_executable is long-running.");
+ABSL_FLAG(int64_t, parallelism, 1,
+          "Number of candidate reductions to generate and test concurrently in "
+          "each round. If greater than one, each round derives this many "
+          "candidates from the last known failing IR, some by replacing a "
+          "subset of the nodes with literals (delta debugging) and the rest by "
+          "random simplification, tests them in parallel and keeps the "
+          "failing candidate with the fewest nodes.");
 ABSL_FLAG(
     bool, verify_ir, true,
     "Verify IR whenever parsing. In most cases, this is a good check that the "
@@ -787,6 +804,233 @@ absl::Status CleanUp(FunctionBase* f, bool can_remove_params) {
   return absl::OkStatus();
 }
 
+// Divides the nodes of `f` which can be replaced by a literal into
+// `chunk_count` contiguous chunks (in node order) and replaces the nodes in
+// chunk `chunk` with zero-valued literals. This is the subset-removal step of
+// delta debugging.
+absl::StatusOr<SimplificationResult> ReplaceNodeChunkWithLiterals(
+    FunctionBase* f, int64_t chunk, int64_t chunk_count,
+    std::string* which_transform) {
+  std::vector<Node*> replaceable;
+  for (Node* node : f->nodes()) {
+    if (TypeHasToken(node->GetType()) || node->Is<Literal>() ||
+        (node->Is<Param>() && node->IsDead()) ||
+        (OpIsSideEffecting(node->op()) && !node->Is<Param>())) {
+      continue;
+    }
+    replaceable.push_back(node);
+  }
+  if (replaceable.size() < chunk_count) {
+    return SimplificationResult::kCannotChange;
+  }
+  int64_t begin = replaceable.size() * chunk / chunk_count;
+  int64_t end = replaceable.size() * (chunk + 1) / chunk_count;
+  for (int64_t i = begin; i < end; ++i) {
+    XLS_RETURN_IF_ERROR(replaceable[i]
+                            ->ReplaceUsesWithNew<Literal>(
+                                ZeroOfType(replaceable[i]->GetType()))
+                            .status());
+  }
+  *which_transform =
+      absl::StrFormat("replace node chunk %d of %d (%d nodes) with zero",
+                      chunk, chunk_count, end - begin);
+  return SimplificationResult::kDidChange;
+}
+
+// Checks that the minimized IR still fails and writes it to stdout.
+absl::Status OutputMinimized(std::string_view ir_text,
+                             const std::optional<std::vector<Value>>& inputs) {
+  // Run the last test verification without the cache.
+  XLS_RETURN_IF_ERROR(VerifyStillFails(ir_text, inputs,
+                                       "Minimized function does not fail!",
+                                       /*test_cache=*/nullptr));
+  std::cout << ir_text;
+  return absl::OkStatus();
+}
+
+// A candidate reduction of the last known failing IR.
+struct Candidate {
+  std::string ir_text;
+  std::string which_transform;
+  int64_t node_count;
+  // Whether the candidate was produced by ReplaceNodeChunkWithLiterals.
+  bool is_chunk_replacement;
+};
+
+// Minimizes `knownf_ir_text` by generating `parallelism` candidate reductions
+// per round and testing them concurrently. Each round starts with
+// delta-debugging candidates which each replace one of `granularity` chunks of
+// the nodes with literals, continuing where the previous round left off. Once
+// every chunk has been tried, the next pass starts again at the first chunk;
+// the granularity is doubled only if no chunk replacement of the finished pass
+// was kept. The remaining candidates of the round are produced by random
+// simplification as in the sequential mode. Of the candidates which still
+// fail, the one with the fewest nodes is kept. Returns the minimized IR text.
+absl::StatusOr<std::string> MinimizeInParallel(
+    std::string knownf_ir_text, const std::optional<std::vector<Value>>& inputs,
+    int64_t parallelism, int64_t failed_attempt_limit,
+    int64_t total_attempt_limit, int64_t simplifications_between_tests,
+    absl::flat_hash_map<std::string, bool>* test_cache) {
+  const bool can_remove_params = absl::GetFlag(FLAGS_can_remove_params);
+  std::mt19937 rng;  // Default constructor uses deterministic seed.
+  int64_t failed_simplification_attempts = 0;
+  int64_t total_attempts = 0;
+  int64_t granularity = 2;
+  int64_t next_chunk = 0;
+  // Whether a chunk replacement was kept during the current pass over the
+  // chunks.
+  bool chunk_pass_succeeded = false;
+  bool chunks_exhausted = false;
+
+  while (failed_simplification_attempts < failed_attempt_limit &&
+         total_attempts < total_attempt_limit) {
+    if (next_chunk == granularity) {
+      if (!chunk_pass_succeeded) {
+        granularity *= 2;
+      }
+      next_chunk = 0;
+      chunk_pass_succeeded = false;
+    }
+    std::vector<Candidate> candidates;
+    bool cannot_change = false;
+    // A round never spans two passes, so the outcome of a pass is known before
+    // the next one starts.
+    int64_t chunk_candidates =
+        chunks_exhausted ? 0
+                         : std::min(std::max<int64_t>(1, parallelism / 2),
+                                    granularity - next_chunk);
+    for (int64_t i = 0; i < parallelism; ++i) {
+      ++total_attempts;
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                           ParsePackage(knownf_ir_text));
+      FunctionBase* f = package->GetTop().value();
+      std::string which_transform;
+      SimplificationResult simplification;
+      bool is_chunk_replacement = !chunks_exhausted && i < chunk_candidates;
+      if (is_chunk_replacement) {
+        XLS_ASSIGN_OR_RETURN(
+            simplification,
+            ReplaceNodeChunkWithLiterals(f, next_chunk, granularity,
+                                         &which_transform));
+        if (simplification == SimplificationResult::kCannotChange) {
+          // Chunks are down to single nodes; rely on random simplifications
+          // from here on.
+          chunks_exhausted = true;
+          continue;
+        }
+        ++next_chunk;
+      } else {
+        std::vector<std::string> transforms;
+        simplification = SimplificationResult::kDidNotChange;
+        for (int64_t j = 0; j < simplifications_between_tests; ++j) {
+          XLS_ASSIGN_OR_RETURN(SimplificationResult result,
+                               Simplify(f, inputs, &rng, &which_transform));
+          if (result == SimplificationResult::kCannotChange) {
+            cannot_change = true;
+            break;
+          }
+          if (result == SimplificationResult::kDidChange) {
+            simplification = result;
+            transforms.push_back(which_transform);
+            XLS_RETURN_IF_ERROR(CleanUp(f, can_remove_params));
+          }
+        }
+        which_transform = absl::StrJoin(transforms, ", ");
+      }
+      if (simplification != SimplificationResult::kDidChange) {
+        ++failed_simplification_attempts;
+        continue;
+      }
+      XLS_RETURN_IF_ERROR(CleanUp(f, can_remove_params));
+      std::string ir_text = package->DumpIr();
+      if (ir_text == knownf_ir_text) {
+        ++failed_simplification_attempts;
+        continue;
+      }
+      candidates.push_back(Candidate{.ir_text = std::move(ir_text),
+                                     .which_transform = which_transform,
+                                     .node_count = f->node_count(),
+                                     .is_chunk_replacement =
+                                         is_chunk_replacement});
+    }
+    if (candidates.empty()) {
+      if (cannot_change && chunks_exhausted) {
+        XLS_LOG(INFO) << "Cannot simplify any further, done!";
+        break;
+      }
+      continue;
+    }
+
+    // Test the candidates which are not in the cache concurrently.
+    std::vector<std::optional<absl::StatusOr<bool>>> results(candidates.size());
+    std::vector<int64_t> to_test;
+    for (int64_t i = 0; i < candidates.size(); ++i) {
+      auto it = test_cache->find(candidates[i].ir_text);
+      if (it != test_cache->end()) {
+        results[i] = it->second;
+      } else {
+        to_test.push_back(i);
+      }
+    }
+    std::atomic<int64_t> next_index = 0;
+    auto worker = [&]() {
+      for (int64_t i = next_index++; i < to_test.size(); i = next_index++) {
+        results[to_test[i]] =
+            StillFailsHelper(candidates[to_test[i]].ir_text, inputs);
+      }
+    };
+    {
+      std::vector<std::unique_ptr<Thread>> threads;
+      for (int64_t i = 1; i < to_test.size(); ++i) {
+        threads.push_back(std::make_unique<Thread>(worker));
+      }
+      worker();
+      for (std::unique_ptr<Thread>& thread : threads) {
+        thread->Join();
+      }
+    }
+
+    std::optional<int64_t> best;
+    for (int64_t i = 0; i < candidates.size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(bool still_fails, *results[i]);
+      (*test_cache)[candidates[i].ir_text] = still_fails;
+      if (!still_fails) {
+        ++failed_simplification_attempts;
+        continue;
+      }
+      if (!best.has_value() ||
+          candidates[i].node_count < candidates[*best].node_count) {
+        best = i;
+      }
+    }
+    if (!best.has_value()) {
+      XLS_LOG(INFO) << absl::StreamFormat(
+          "None of %d candidates still fails. Failed simplification attempts "
+          "now: %d",
+          candidates.size(), failed_simplification_attempts);
+      continue;
+    }
+
+    Candidate& winner = candidates[*best];
+    knownf_ir_text = std::move(winner.ir_text);
+    failed_simplification_attempts = 0;
+    if (winner.is_chunk_replacement) {
+      chunk_pass_succeeded = true;
+    }
+    std::cerr << "---\ntransform: " << winner.which_transform << "\n"
+              << (winner.node_count > 50 ? "" : knownf_ir_text) << "("
+              << winner.node_count << " nodes)\n";
+  }
+  if (failed_simplification_attempts >= failed_attempt_limit) {
+    XLS_LOG(INFO) << "Hit failed-simplification-attempt-limit: "
+                  << failed_simplification_attempts;
+  }
+  if (total_attempts >= total_attempt_limit) {
+    XLS_LOG(INFO) << "Hit total-attempt-limit: " << total_attempts;
+  }
+  return knownf_ir_text;
+}
+
 absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
                       const int64_t total_attempt_limit,
                       const int64_t simplifications_between_tests) {
@@ -832,6 +1076,16 @@ absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
     XLS_LOG(INFO) << "=== Done cleaning up initial garbage";
   }
 
+  if (absl::GetFlag(FLAGS_parallelism) > 1) {
+    XLS_ASSIGN_OR_RETURN(
+        knownf_ir_text,
+        MinimizeInParallel(knownf_ir_text, inputs,
+                           absl::GetFlag(FLAGS_parallelism),
+                           failed_attempt_limit, total_attempt_limit,
+                           simplifications_between_tests, &test_cache));
+    return OutputMinimized(knownf_ir_text, inputs);
+  }
+
   // If so, we start simplifying via this seeded RNG.
   std::mt19937 rng;  // Default constructor uses deterministic seed.
 
@@ -929,14 +1183,7 @@ absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
     failed_simplification_attempts = 0;
   }
 
-  // Run the last test verification without the cache.
-  XLS_RETURN_IF_ERROR(VerifyStillFails(knownf_ir_text, inputs,
-                                       "Minimized function does not fail!",
-                                       /*test_cache=*/nullptr));
-
-  std::cout << knownf_ir_text;
-
-  return absl::OkStatus();
+  return OutputMinimized(knownf_ir_text, inputs);
 }
 
 }  // namespace
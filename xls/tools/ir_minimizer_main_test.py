@@ -415,6 +415,22 @@ top fn foo() -> (bits[1], (bits[42]), bits[32]) {
     )
     self.assertEqual(ADD_IR, minimized_ir)
 
+  def test_minimize_in_parallel(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    test_sh_file = self.create_tempfile()
+    self._write_sh_script(test_sh_file.full_path, ['/usr/bin/env grep add $1'])
+    minimized_ir = subprocess.check_output(
+        [
+            IR_MINIMIZER_MAIN_PATH,
+            '--test_executable=' + test_sh_file.full_path,
+            '--can_remove_params',
+            '--parallelism=4',
+            ir_file.full_path,
+        ],
+        encoding='utf-8',
+    )
+    self.assertIn('add', minimized_ir)
+    self.assertNotIn('not', minimized_ir)
 
 if __name__ == '__main__':
   absltest.main()
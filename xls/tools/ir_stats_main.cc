@@ -16,6 +16,7 @@
 // Output will be added as needs warrant, so feel free to make additions!
 
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -24,11 +25,12 @@
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "xls/common/exit_status.h"
-#include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
 
 ABSL_FLAG(
     std::string, top, "",
@@ -40,8 +42,18 @@ namespace xls {
 
 static absl::Status RealMain(std::string_view ir_path,
                              std::optional<std::string> restrict_fn) {
-  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(ir_path));
-  XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(contents));
+  XLS_ASSIGN_OR_RETURN(MappedFile file, MappedFile::Open(ir_path));
+  // When restricted to a single function only that function and its callees
+  // need to be parsed.
+  std::unique_ptr<Package> package;
+  if (restrict_fn.has_value()) {
+    XLS_ASSIGN_OR_RETURN(package,
+                         Parser::ParsePackageSubset(file.contents(),
+                                                    {*restrict_fn}, ir_path));
+  } else {
+    XLS_ASSIGN_OR_RETURN(package,
+                         Parser::ParsePackage(file.contents(), ir_path));
+  }
 
   std::cout << "Package \"" << package->name() << "\"" << std::endl;
   for (const auto& f : package->functions()) {
@@ -14,11 +14,14 @@
 
 // Tool to prove or disprove logical equivalence of XLS IR and a netlist.
 
+#include <algorithm>
 #include <csignal>
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/base/internal/sysinfo.h"
@@ -27,8 +30,10 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/time/time.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
@@ -91,6 +96,18 @@ ABSL_FLAG(int32_t, stage, -1,
           "Pipeline stage to evaluate. Requires --schedule.\n"
           "If \"schedule\" is set, but this is not, then the entire module "
           "will be evaluated.");
+ABSL_FLAG(int32_t, stage_threads, 0,
+          "If positive, checks every stage of the schedule given by "
+          "--schedule_path, running this many stage checks concurrently (each "
+          "with its own Z3 context), and reports the results together. "
+          "--timeout_sec then applies to each stage. Also used by "
+          "--auto_stage, defaulting to one thread.");
+ABSL_FLAG(int32_t, cube_bits, 0,
+          "With --stage_threads or --auto_stage, a stage which times out is "
+          "split into 2^cube_bits cubes, each fixing that many of the stage's "
+          "input bits, which are then checked one by one.");
+ABSL_FLAG(int32_t, cube_timeout_sec, -1,
+          "Amount of time to allow for each cube of a split stage.");
 
 namespace xls {
 namespace {
@@ -109,9 +126,10 @@ absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
     XLS_RET_CHECK(cell_proto.ParseFromString(cell_proto_text));
     return netlist::CellLibrary::FromProto(cell_proto);
   }
-  XLS_ASSIGN_OR_RETURN(std::string lib_text, GetFileContents(cell_lib_path));
-  XLS_ASSIGN_OR_RETURN(auto stream,
-                       netlist::cell_lib::CharStream::FromText(lib_text));
+  XLS_ASSIGN_OR_RETURN(MappedFile lib_file, MappedFile::Open(cell_lib_path));
+  XLS_ASSIGN_OR_RETURN(
+      auto stream,
+      netlist::cell_lib::CharStream::FromMappedFile(std::move(lib_file)));
   XLS_ASSIGN_OR_RETURN(netlist::CellLibraryProto proto,
                        netlist::function::ExtractFunctions(&stream));
   return netlist::CellLibrary::FromProto(proto);
@@ -120,8 +138,8 @@ absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
 // Loads and parses a netlist from a file.
 absl::StatusOr<std::unique_ptr<netlist::rtl::Netlist>> GetNetlist(
     std::string_view netlist_path, netlist::CellLibrary* cell_library) {
-  XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
-  netlist::rtl::Scanner scanner(netlist_text);
+  XLS_ASSIGN_OR_RETURN(MappedFile netlist_file, MappedFile::Open(netlist_path));
+  netlist::rtl::Scanner scanner(netlist_file.contents());
   return netlist::rtl::Parser::ParseNetlist(cell_library, &scanner);
 }
 
@@ -173,50 +191,71 @@ void CancelAlarm(struct sigaction old_action) {
   sigaction(SIGALRM, &old_action, &dummy);
 }
 
+// Checks every stage of the schedule (concurrently, as the options allow) and
+// prints the result of each along with any mismatches found.
+absl::Status RunAllStages(const solvers::z3::LecParams& lec_params,
+                          const PipelineSchedule& schedule,
+                          const solvers::z3::StagedLecOptions& options) {
+  std::cout << "Performing staged LEC with " << options.num_threads
+            << " thread(s).\n";
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<solvers::z3::StageLecResult> results,
+      solvers::z3::Lec::RunStaged(lec_params, schedule, options));
+  int64_t failed = 0;
+  int64_t timed_out = 0;
+  for (const solvers::z3::StageLecResult& result : results) {
+    std::cout << "Stage " << result.stage << "...";
+    switch (result.result) {
+      case Z3_L_FALSE:
+        std::cout << "PASSED!";
+        break;
+      case Z3_L_TRUE:
+        std::cout << "FAILED!";
+        ++failed;
+        break;
+      default:
+        std::cout << "TIMED OUT!";
+        ++timed_out;
+        break;
+    }
+    if (result.cubes_checked > 0) {
+      std::cout << " (" << result.cubes_checked << " cubes)";
+    }
+    std::cout << " [" << absl::FormatDuration(result.elapsed) << "]\n";
+  }
+  for (const solvers::z3::StageLecResult& result : results) {
+    if (result.result == Z3_L_TRUE) {
+      std::cout << "\nStage " << result.stage << " mismatch:\n"
+                << result.counterexample << std::endl;
+    }
+  }
+  std::cout << results.size() - failed - timed_out << " stage(s) passed, "
+            << failed << " failed, " << timed_out << " timed out.\n";
+  return absl::OkStatus();
+}
+
 // This function applies heuristics to determine whether or not a full LEC can
 // be performed or if we should break into stages. For now, these are simple:
 // does the IR contain a greater-than-8-bit MUL?
 absl::Status AutoStage(const solvers::z3::LecParams& lec_params,
-                       const PipelineSchedule& schedule, int timeout_sec) {
+                       const PipelineSchedule& schedule,
+                       const solvers::z3::StagedLecOptions& staged_options) {
   bool do_staged = false;
 
   // Other staged/full heuristics should go here.
   do_staged |= IrContainsBigMul(lec_params.ir_function);
 
   if (do_staged) {
-    std::cout << "Performing staged LEC.\n";
-    for (int i = 0; i < schedule.length(); i++) {
-      std::cout << "Stage " << i << "...";
-      XLS_ASSIGN_OR_RETURN(
-          auto lec, solvers::z3::Lec::CreateForStage(lec_params, schedule, i));
-
-      z3_interrupted = false;
-      struct sigaction old_action = SetAlarm(timeout_sec);
-      bool equal = lec->Run();
-      CancelAlarm(old_action);
-      absl::MutexLock lock(&mutex);
-      if (z3_interrupted) {
-        std::cout << "TIMED OUT!\n";
-        continue;
-      }
+    return RunAllStages(lec_params, schedule, staged_options);
+  }
 
-      if (equal) {
-        std::cout << "PASSED!\n";
-      } else {
-        std::cout << "FAILED!\n";
-        std::cout << std::endl << "IR/netlist value dump:" << std::endl;
-        lec->DumpIrTree();
-      }
-    }
-  } else {
-    std::cout << "Performing full LEC.\n";
-    XLS_ASSIGN_OR_RETURN(auto lec, solvers::z3::Lec::Create(lec_params));
-    bool equal = lec->Run();
-    std::cout << lec->ResultToString() << std::endl;
-    if (!equal) {
-      std::cout << std::endl << "IR/netlist value dump:" << std::endl;
-      lec->DumpIrTree();
-    }
+  std::cout << "Performing full LEC.\n";
+  XLS_ASSIGN_OR_RETURN(auto lec, solvers::z3::Lec::Create(lec_params));
+  bool equal = lec->Run();
+  std::cout << lec->ResultToString() << std::endl;
+  if (!equal) {
+    std::cout << std::endl << "IR/netlist value dump:" << std::endl;
+    lec->DumpIrTree();
   }
 
   return absl::OkStatus();
@@ -229,10 +268,11 @@ static absl::Status RealMain(
     std::string_view netlist_module_name, std::string_view cell_lib_path,
     std::string_view cell_proto_path, std::string_view netlist_path,
     std::string_view constraints_file, std::string_view schedule_path,
-    int stage, bool auto_stage, int timeout_sec) {
+    int stage, bool auto_stage, int timeout_sec, int stage_threads,
+    const solvers::z3::StagedLecOptions& staged_options) {
   solvers::z3::LecParams lec_params;
-  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
-  XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSIGN_OR_RETURN(MappedFile ir_file, MappedFile::Open(ir_path));
+  XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_file.contents()));
   lec_params.ir_package = package.get();
   if (entry_function_name.empty()) {
     XLS_ASSIGN_OR_RETURN(lec_params.ir_function,
@@ -257,7 +297,10 @@ static absl::Status RealMain(
         PipelineSchedule schedule,
         PipelineSchedule::FromProto(lec_params.ir_function, proto));
     if (auto_stage) {
-      return AutoStage(lec_params, schedule, timeout_sec);
+      return AutoStage(lec_params, schedule, staged_options);
+    }
+    if (stage_threads > 0) {
+      return RunAllStages(lec_params, schedule, staged_options);
     }
     XLS_ASSIGN_OR_RETURN(
         lec, solvers::z3::Lec::CreateForStage(lec_params, schedule, stage));
@@ -334,9 +377,25 @@ int main(int argc, char* argv[]) {
   XLS_QCHECK(!(auto_stage && schedule_path.empty()))
       << "--schedule_path must be specified with --auto_stage.";
 
+  int stage_threads = absl::GetFlag(FLAGS_stage_threads);
+  XLS_QCHECK(stage_threads <= 0 || (!schedule_path.empty() && stage == -1))
+      << "--stage_threads requires --schedule_path and excludes --stage.";
+
+  int timeout_sec = absl::GetFlag(FLAGS_timeout_sec);
+  int cube_timeout_sec = absl::GetFlag(FLAGS_cube_timeout_sec);
+  xls::solvers::z3::StagedLecOptions staged_options;
+  staged_options.num_threads = std::max(stage_threads, 1);
+  staged_options.cube_bits = absl::GetFlag(FLAGS_cube_bits);
+  if (timeout_sec != -1) {
+    staged_options.stage_timeout = absl::Seconds(timeout_sec);
+  }
+  if (cube_timeout_sec != -1) {
+    staged_options.cube_timeout = absl::Seconds(cube_timeout_sec);
+  }
+
   return xls::ExitStatus(xls::RealMain(
       ir_path, absl::GetFlag(FLAGS_entry_function_name),
       absl::GetFlag(FLAGS_netlist_module_name), cell_lib_path, cell_proto_path,
       netlist_path, absl::GetFlag(FLAGS_constraints_file), schedule_path, stage,
-      auto_stage, absl::GetFlag(FLAGS_timeout_sec)));
+      auto_stage, timeout_sec, stage_threads, staged_options));
 }
@@ -15,17 +15,23 @@
 // Driver for NetlistInterpreter: loads a netlist from disk, feeds Value input
 // (taken from the command line) into it, and prints the result.
 
+#include <cstdint>
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_split.h"
+#include "absl/types/span.h"
 #include "xls/codegen/flattening.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -33,16 +39,24 @@
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/value.h"
 #include "xls/netlist/cell_library.h"
+#include "xls/netlist/compiled_netlist.h"
 #include "xls/netlist/function_extractor.h"
 #include "xls/netlist/interpreter.h"
 #include "xls/netlist/lib_parser.h"
 #include "xls/netlist/netlist.pb.h"
 #include "xls/netlist/netlist_parser.h"
+#include "xls/netlist/packed_interpreter.h"
 
 ABSL_FLAG(std::string, cell_library, "",
           "Cell library to use for interpretation.");
 ABSL_FLAG(std::string, cell_library_proto, "",
           "Preprocessed cell library proto to use for interpretation.");
+ABSL_FLAG(std::string, cell_library_cache, "",
+          "If set along with --cell_library, the path of a binary cache of the "
+          "functions extracted from the cell library. The cache is created or "
+          "refreshed when missing or stale (as determined by a checksum of the "
+          "cell library) and otherwise loaded in place of parsing the cell "
+          "library.");
 // TODO(rspringer): Eliminate the need for this flag.
 // This one is a hidden temporary flag until we can properly handle cells
 // with state_function attributes (e.g., some latches).
@@ -53,15 +67,27 @@ ABSL_FLAG(std::string, input, "",
           "The input to the function as a semicolon-separated list of typed "
           "values. For example: \"bits[32]:42; (bits[7]:0, bits[20]:4)\". "
           "Values must be listed in the same order as the module inputs.");
+ABSL_FLAG(std::string, input_file, "",
+          "Path to a file of inputs to the function, one per line in the "
+          "format of --input. The inputs are simulated 64 at a time using "
+          "bit-parallel evaluation of the cells and one output is printed per "
+          "line. Requires a cell library whose cells are defined by functions "
+          "(not state tables). Mutually exclusive with --input.");
 ABSL_FLAG(std::string, output_type, "",
           "Type of the value as an XLS-formatted string. If un-set, then the "
           "output will be printed as flat uninterpreted bits.");
 ABSL_FLAG(std::string, module_name, "", "Module in the netlist to interpret.");
 ABSL_FLAG(std::string, netlist, "", "Path to the netlist to interpret.");
+ABSL_FLAG(int64_t, threads, 0,
+          "If positive, the module is compiled into a levelized sequence of "
+          "instructions and the --input vector is evaluated with this many "
+          "threads, each level of the netlist being split between them. "
+          "Intended for very large netlists. Not compatible with "
+          "--dump_cells.");
 
 namespace xls {
 
-static absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
+static absl::StatusOr<netlist::CellLibraryProto> GetCellLibraryProto(
     const std::string& cell_library_path,
     const std::string& cell_library_proto_path) {
   if (!cell_library_proto_path.empty()) {
@@ -69,48 +95,41 @@ static absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
                          GetFileContents(cell_library_proto_path));
     netlist::CellLibraryProto lib_proto;
     XLS_RET_CHECK(lib_proto.ParseFromString(proto_text));
-    return netlist::CellLibrary::FromProto(lib_proto);
+    return lib_proto;
   }
-  XLS_ASSIGN_OR_RETURN(std::string cell_library_text,
-                       GetFileContents(cell_library_path));
-  XLS_ASSIGN_OR_RETURN(
-      auto char_stream,
-      netlist::cell_lib::CharStream::FromText(cell_library_text));
-  XLS_ASSIGN_OR_RETURN(netlist::CellLibraryProto lib_proto,
-                       netlist::function::ExtractFunctions(&char_stream));
-  return netlist::CellLibrary::FromProto(lib_proto);
+  std::string cache_path = absl::GetFlag(FLAGS_cell_library_cache);
+  if (!cache_path.empty()) {
+    return netlist::function::ExtractFunctionsCached(cell_library_path,
+                                                     cache_path);
+  }
+  XLS_ASSIGN_OR_RETURN(MappedFile cell_library_file,
+                       MappedFile::Open(cell_library_path));
+  XLS_ASSIGN_OR_RETURN(auto char_stream,
+                       netlist::cell_lib::CharStream::FromMappedFile(
+                           std::move(cell_library_file)));
+  return netlist::function::ExtractFunctions(&char_stream);
 }
 
-static absl::Status RealMain(const std::string& netlist_path,
-                             const std::string& cell_library_path,
-                             const std::string& cell_library_proto_path,
-                             const std::string& module_name,
-                             absl::Span<const std::string> inputs,
-                             const std::string& output_type_string,
-                             absl::Span<const std::string> dump_cells) {
-  XLS_ASSIGN_OR_RETURN(
-      netlist::CellLibrary cell_library,
-      GetCellLibrary(cell_library_path, cell_library_proto_path));
-
-  XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
-  netlist::rtl::Scanner scanner(netlist_text);
-  XLS_ASSIGN_OR_RETURN(auto netlist, netlist::rtl::Parser::ParseNetlist(
-                                         &cell_library, &scanner));
-  XLS_ASSIGN_OR_RETURN(const auto* module, netlist->GetModule(module_name));
-
-  // Input values are listed in the same order as inputs are declared by
-  // the netlist module declaration, which may be different from the order of
-  // Module::inputs().  For example:
-  //
-  //  module ifte(i, t, e, out);
-  //    input [7:0] e;
-  //    input i;
-  //    output [7:0] out;
-  //    input [7:0] t;
-  //
-  // The values of --inputs should follow the module declaration, which would
-  // also follow the declaration of the source language (e.g. C++ or XLS).
-
+// Returns the values of the inputs of `module` given the semicolon-separated
+// typed values of a single input vector.
+//
+// Input values are listed in the same order as inputs are declared by
+// the netlist module declaration, which may be different from the order of
+// Module::inputs().  For example:
+//
+//  module ifte(i, t, e, out);
+//    input [7:0] e;
+//    input i;
+//    output [7:0] out;
+//    input [7:0] t;
+//
+// The values of --inputs should follow the module declaration, which would
+// also follow the declaration of the source language (e.g. C++ or XLS).
+template <typename EvalT>
+static absl::StatusOr<
+    absl::flat_hash_map<const netlist::rtl::AbstractNetRef<EvalT>, bool>>
+ParseInputNets(const netlist::rtl::AbstractModule<EvalT>* module,
+               absl::Span<const std::string> inputs) {
   Bits input_bits;
   for (const auto& input_string : inputs) {
     XLS_ASSIGN_OR_RETURN(Value input, Parser::ParseTypedValue(input_string));
@@ -119,22 +138,29 @@ static absl::Status RealMain(const std::string& netlist_path,
   }
   input_bits = bits_ops::Reverse(input_bits);
 
-  netlist::NetRef2Value input_nets;
-  const std::vector<netlist::rtl::NetRef>& module_inputs = module->inputs();
+  absl::flat_hash_map<const netlist::rtl::AbstractNetRef<EvalT>, bool>
+      input_nets;
+  const std::vector<netlist::rtl::AbstractNetRef<EvalT>>& module_inputs =
+      module->inputs();
   XLS_RET_CHECK(module_inputs.size() == input_bits.bit_count());
 
   for (int i = 0; i < module->inputs().size(); i++) {
-    const netlist::rtl::NetRef in = module_inputs[i];
+    const netlist::rtl::AbstractNetRef<EvalT> in = module_inputs[i];
     input_nets[in] = input_bits.Get(module->GetInputPortOffset(in->name()));
   }
+  return input_nets;
+}
 
-  netlist::Interpreter interpreter(netlist.get());
-  XLS_ASSIGN_OR_RETURN(auto output_nets, interpreter.InterpretModule(
-                                             module, input_nets, dump_cells));
-
+// Prints the values of the outputs of `module` as a single value.
+template <typename EvalT>
+static absl::Status PrintOutput(
+    const netlist::rtl::AbstractModule<EvalT>* module,
+    const absl::flat_hash_map<const netlist::rtl::AbstractNetRef<EvalT>, bool>&
+        output_nets,
+    const std::string& output_type_string) {
   BitsRope rope(output_nets.size());
-  for (const netlist::rtl::NetRef ref : module->outputs()) {
-    rope.push_back(output_nets[ref]);
+  for (const netlist::rtl::AbstractNetRef<EvalT> ref : module->outputs()) {
+    rope.push_back(output_nets.at(ref));
   }
   Bits output_bits = rope.Build();
 
@@ -154,6 +180,93 @@ static absl::Status RealMain(const std::string& netlist_path,
   return absl::OkStatus();
 }
 
+static absl::Status RealMain(const std::string& netlist_path,
+                             const std::string& cell_library_path,
+                             const std::string& cell_library_proto_path,
+                             const std::string& module_name,
+                             absl::Span<const std::string> inputs,
+                             const std::string& output_type_string,
+                             absl::Span<const std::string> dump_cells) {
+  XLS_ASSIGN_OR_RETURN(
+      netlist::CellLibraryProto lib_proto,
+      GetCellLibraryProto(cell_library_path, cell_library_proto_path));
+  XLS_ASSIGN_OR_RETURN(netlist::CellLibrary cell_library,
+                       netlist::CellLibrary::FromProto(lib_proto));
+
+  // The netlist is mapped rather than read so large netlists are paged in as
+  // they are scanned.
+  XLS_ASSIGN_OR_RETURN(MappedFile netlist_file, MappedFile::Open(netlist_path));
+  netlist::rtl::Scanner scanner(netlist_file.contents());
+  XLS_ASSIGN_OR_RETURN(auto netlist, netlist::rtl::Parser::ParseNetlist(
+                                         &cell_library, &scanner));
+  XLS_ASSIGN_OR_RETURN(const auto* module, netlist->GetModule(module_name));
+
+  XLS_ASSIGN_OR_RETURN(netlist::NetRef2Value input_nets,
+                       ParseInputNets(module, inputs));
+
+  int64_t threads = absl::GetFlag(FLAGS_threads);
+  if (threads > 0) {
+    XLS_ASSIGN_OR_RETURN(
+        netlist::CompiledModule compiled,
+        netlist::CompiledModule::Compile(netlist.get(), module));
+    XLS_ASSIGN_OR_RETURN(netlist::NetRef2Value output_nets,
+                         compiled.InterpretModule(input_nets, threads));
+    return PrintOutput(module, output_nets, output_type_string);
+  }
+
+  netlist::Interpreter interpreter(netlist.get());
+  XLS_ASSIGN_OR_RETURN(auto output_nets, interpreter.InterpretModule(
+                                             module, input_nets, dump_cells));
+  return PrintOutput(module, output_nets, output_type_string);
+}
+
+static absl::Status RealMainBatch(const std::string& netlist_path,
+                                  const std::string& cell_library_path,
+                                  const std::string& cell_library_proto_path,
+                                  const std::string& module_name,
+                                  const std::string& input_file,
+                                  const std::string& output_type_string) {
+  using netlist::PackedBool;
+  XLS_ASSIGN_OR_RETURN(
+      netlist::CellLibraryProto lib_proto,
+      GetCellLibraryProto(cell_library_path, cell_library_proto_path));
+  XLS_ASSIGN_OR_RETURN(
+      netlist::AbstractCellLibrary<PackedBool> cell_library,
+      netlist::AbstractCellLibrary<PackedBool>::FromProto(
+          lib_proto, PackedBool(false), PackedBool(true)));
+
+  // The netlist is mapped rather than read so large netlists are paged in as
+  // they are scanned.
+  XLS_ASSIGN_OR_RETURN(MappedFile netlist_file, MappedFile::Open(netlist_path));
+  netlist::rtl::Scanner scanner(netlist_file.contents());
+  XLS_ASSIGN_OR_RETURN(auto netlist,
+                       netlist::rtl::AbstractParser<PackedBool>::ParseNetlist(
+                           &cell_library, &scanner, PackedBool(false),
+                           PackedBool(true)));
+  XLS_ASSIGN_OR_RETURN(const auto* module, netlist->GetModule(module_name));
+
+  XLS_ASSIGN_OR_RETURN(MappedFile input, MappedFile::Open(input_file));
+  std::vector<netlist::PackedNetRef2Bool> input_vectors;
+  for (std::string_view line :
+       absl::StrSplit(input.contents(), '\n', absl::SkipWhitespace())) {
+    std::vector<std::string> inputs = absl::StrSplit(line, ';');
+    XLS_ASSIGN_OR_RETURN(input_vectors.emplace_back(),
+                         ParseInputNets(module, inputs));
+  }
+
+  XLS_ASSIGN_OR_RETURN(
+      netlist::PackedCompiledModule compiled,
+      netlist::PackedCompiledModule::Compile(netlist.get(), module,
+                                             PackedBool(false),
+                                             PackedBool(true)));
+  XLS_ASSIGN_OR_RETURN(std::vector<netlist::PackedNetRef2Bool> output_vectors,
+                       netlist::InterpretModuleBatch(compiled, input_vectors));
+  for (const netlist::PackedNetRef2Bool& output_nets : output_vectors) {
+    XLS_RETURN_IF_ERROR(PrintOutput(module, output_nets, output_type_string));
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace xls
 
 int main(int argc, char* argv[]) {
@@ -172,14 +285,23 @@ int main(int argc, char* argv[]) {
   XLS_QCHECK(!module_name.empty()) << "--module_name must be specified.";
 
   std::string input = absl::GetFlag(FLAGS_input);
-  XLS_QCHECK(!input.empty()) << "--input must be specified.";
+  std::string input_file = absl::GetFlag(FLAGS_input_file);
+  XLS_QCHECK(!input.empty() ^ !input_file.empty())
+      << "One (and only one) of --input or --input_file must be specified.";
+
+  std::string output_type = absl::GetFlag(FLAGS_output_type);
+  if (!input_file.empty()) {
+    return xls::ExitStatus(xls::RealMainBatch(
+        netlist_path, cell_library_path, cell_library_proto_path, module_name,
+        input_file, output_type));
+  }
   std::vector<std::string> inputs = absl::StrSplit(input, ';');
 
   std::string dump_cells_str = absl::GetFlag(FLAGS_dump_cells);
+  XLS_QCHECK(dump_cells_str.empty() || absl::GetFlag(FLAGS_threads) <= 0)
+      << "--dump_cells cannot be combined with --threads.";
   std::vector<std::string> dump_cells = absl::StrSplit(dump_cells_str, ',');
 
-  std::string output_type = absl::GetFlag(FLAGS_output_type);
-
   return xls::ExitStatus(xls::RealMain(netlist_path, cell_library_path,
                                        cell_library_proto_path, module_name,
                                        inputs, output_type, dump_cells));
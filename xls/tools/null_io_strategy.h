@@ -41,6 +41,9 @@ class NullIOStrategy : public IOStrategy {
     return std::vector<VerilogInclude>();
   }
 
+  // Input flow control is exposed directly via the byte_in_ready port.
+  bool SupportsStreamingInput() const override { return true; }
+
  private:
   // Top-level ports.
   LogicRef* byte_in_;
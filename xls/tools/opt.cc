@@ -14,6 +14,8 @@
 
 #include "xls/tools/opt.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -22,15 +24,85 @@
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
+#include "xls/common/logging/log_lines.h"
+#include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dslx/ir_convert/ir_converter.h"
+#include "xls/dslx/output_cache.h"
 #include "xls/dslx/parse_and_typecheck.h"
+#include "xls/ir/binary_ir.h"
+#include "xls/ir/call_graph.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/verifier.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_pipeline.h"
+#include "xls/passes/pass_metrics.h"
+#include "xls/passes/query_engine_cache.h"
 
 namespace xls::tools {
+namespace {
+
+// Returns the key under which the result of optimizing `package` for `top`
+// with `options` is cached.
+//
+// Optimization of a function top removes everything it does not call (dead
+// function elimination), so for proc-free packages only the call graph below
+// the top is keyed on, along with the next node id which determines the ids
+// of nodes created during optimization. This requires the full pipeline to
+// run; if passes are filtered the entire package is keyed on instead.
+std::string OptimizationCacheKey(Package* package, FunctionBase* top,
+                                 const OptOptions& options) {
+  std::string key = absl::StrCat(
+      "opt_main\nopt_level=", options.opt_level,
+      "\nrun_only_passes=",
+      options.run_only_passes.has_value()
+          ? absl::StrJoin(*options.run_only_passes, ",")
+          : "<all>",
+      "\nskip_passes=", absl::StrJoin(options.skip_passes, ","),
+      "\nconvert_array_index_to_select=",
+      options.convert_array_index_to_select.value_or(-1),
+      "\ninline_procs=", options.inline_procs,
+      "\ninlining_node_budget=", options.inlining_node_budget.value_or(-1),
+      "\nloop_unroll_node_budget=",
+      options.loop_unroll_node_budget.value_or(-1),
+      "\nbinary_output=", options.binary_output, "\ntop=", top->name(), "\n");
+  bool closure_only = top->IsFunction() && package->procs().empty() &&
+                      package->blocks().empty() &&
+                      package->channels().empty() &&
+                      !options.run_only_passes.has_value() &&
+                      options.skip_passes.empty();
+  if (!closure_only) {
+    absl::StrAppend(&key, package->DumpIr());
+    return key;
+  }
+  absl::StrAppend(&key, "package ", package->name(), "\n");
+  // Nodes created by the passes are numbered from the package-wide next node
+  // id, which the parser raises above every id in the package (including
+  // functions outside the closure), so it is part of the output too.
+  absl::StrAppend(&key, "next_node_id=", package->next_node_id(), "\n");
+  // The file table is emitted in full with the optimized package.
+  std::vector<std::pair<int32_t, std::string_view>> files;
+  for (const auto& [fileno, filename] : package->fileno_to_name()) {
+    files.push_back({static_cast<int32_t>(fileno), filename});
+  }
+  std::sort(files.begin(), files.end());
+  for (const auto& [fileno, filename] : files) {
+    absl::StrAppend(&key, "file_number ", fileno, " ", filename, "\n");
+  }
+  // GetDependentFunctions returns callees before callers (ending with the top)
+  // in a deterministic order.
+  for (FunctionBase* fb : GetDependentFunctions(top)) {
+    absl::StrAppend(&key, absl::StrJoin(fb->AttributeIrStrings(), ", "), "\n",
+                    fb->DumpIr(), "\n");
+  }
+  return key;
+}
+
+}  // namespace
 
 absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
                                              const OptOptions& options) {
@@ -53,6 +125,20 @@ absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
   }
   XLS_VLOG(3) << "Top entity: '" << top.value()->name() << "'";
 
+  std::optional<dslx::OutputCache> cache;
+  std::string cache_key;
+  if (!options.cache_dir.empty() && options.ir_dump_path.empty() &&
+      options.pass_trace_path.empty() && options.ram_rewrites.empty()) {
+    cache.emplace(options.cache_dir);
+    cache_key = OptimizationCacheKey(package.get(), top.value(), options);
+    XLS_ASSIGN_OR_RETURN(std::optional<std::string> cached,
+                         cache->Lookup(cache_key));
+    if (cached.has_value()) {
+      XLS_VLOG(1) << "Using cached optimized IR for: " << top.value()->name();
+      return *std::move(cached);
+    }
+  }
+
   std::unique_ptr<OptimizationCompoundPass> pipeline =
       CreateOptimizationPassPipeline(options.opt_level);
   OptimizationPassOptions pass_options;
@@ -63,10 +149,33 @@ absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
   pass_options.convert_array_index_to_select =
       options.convert_array_index_to_select;
   pass_options.ram_rewrites = options.ram_rewrites;
+  pass_options.function_base_parallelism = options.function_base_parallelism;
+  pass_options.inlining_node_budget = options.inlining_node_budget;
+  pass_options.loop_unroll_node_budget = options.loop_unroll_node_budget;
+  pass_options.record_memory_usage = !options.pass_trace_path.empty();
+  QueryEngineCache query_engine_cache;
+  pass_options.query_engine_cache = &query_engine_cache;
   PassResults results;
   XLS_RETURN_IF_ERROR(
       pipeline->Run(package.get(), pass_options, &results).status());
-  return package->DumpIr();
+  XLS_VLOG_LINES(1, SummarizePassResults(results));
+  if (!options.pass_trace_path.empty()) {
+    XLS_RETURN_IF_ERROR(SetFileContents(options.pass_trace_path,
+                                        PassResultsToChromeTrace(results)));
+  }
+  std::string output;
+  if (options.binary_output) {
+    XLS_ASSIGN_OR_RETURN(output, PackageToBinaryIr(package.get()));
+  } else {
+    output = package->DumpIr();
+  }
+  if (cache.has_value()) {
+    if (absl::Status status = cache->Insert(cache_key, {}, output);
+        !status.ok()) {
+      XLS_LOG(WARNING) << "Failed to cache optimized IR: " << status;
+    }
+  }
+  return output;
 }
 
 absl::StatusOr<std::string> OptimizeIrForTop(
@@ -75,8 +184,12 @@ absl::StatusOr<std::string> OptimizeIrForTop(
     absl::Span<const std::string> run_only_passes,
     absl::Span<const std::string> skip_passes,
     int64_t convert_array_index_to_select, bool inline_procs,
-    std::string_view ram_rewrites_pb) {
-  XLS_ASSIGN_OR_RETURN(std::string ir, GetFileContents(input_path));
+    std::string_view ram_rewrites_pb, int64_t function_base_parallelism,
+    std::string_view pass_trace_path, bool binary_output,
+    int64_t inlining_node_budget, int64_t loop_unroll_node_budget,
+    std::string_view cache_dir) {
+  XLS_ASSIGN_OR_RETURN(MappedFile ir_file, MappedFile::Open(input_path));
+  std::string_view ir = ir_file.contents();
   std::vector<RamRewrite> ram_rewrites;
   if (!ram_rewrites_pb.empty()) {
     RamRewritesProto ram_rewrite_proto;
@@ -101,6 +214,17 @@ absl::StatusOr<std::string> OptimizeIrForTop(
               : std::make_optional(convert_array_index_to_select),
       .inline_procs = inline_procs,
       .ram_rewrites = std::move(ram_rewrites),
+      .function_base_parallelism = function_base_parallelism,
+      .inlining_node_budget = (inlining_node_budget < 0)
+                                  ? std::nullopt
+                                  : std::make_optional(inlining_node_budget),
+      .loop_unroll_node_budget =
+          (loop_unroll_node_budget < 0)
+              ? std::nullopt
+              : std::make_optional(loop_unroll_node_budget),
+      .pass_trace_path = std::string(pass_trace_path),
+      .binary_output = binary_output,
+      .cache_dir = std::string(cache_dir),
   };
   return OptimizeIrForTop(ir, options);
 }
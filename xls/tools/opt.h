@@ -42,6 +42,26 @@ struct OptOptions {
   std::optional<int64_t> convert_array_index_to_select = std::nullopt;
   bool inline_procs;
   std::vector<RamRewrite> ram_rewrites = {};
+  int64_t function_base_parallelism = 1;
+  // If set, inlining simplifies callees before inlining them and fails rather
+  // than growing the package beyond this many nodes.
+  std::optional<int64_t> inlining_node_budget = std::nullopt;
+  // If set, counted_for loops are only unrolled completely if that adds at
+  // most this many nodes and are otherwise partially unrolled to fit.
+  std::optional<int64_t> loop_unroll_node_budget = std::nullopt;
+  // If non-empty, a Chrome trace of the pass invocations (durations, node
+  // deltas, fixed-point iteration counts) is written to this path.
+  std::string pass_trace_path = "";
+  // If true, the optimized package is returned in the binary IR format (see
+  // xls/ir/binary_ir.h) rather than as IR text.
+  bool binary_output = false;
+  // If non-empty, directory in which optimized packages are cached across
+  // invocations. Entries are keyed on the options above and the canonical IR
+  // of the input: when the top is a function of a proc-free package, only the
+  // functions it (transitively) calls, so edits to unrelated functions do not
+  // invalidate the entry. Not used with an IR dump path, a pass trace path or
+  // RAM rewrites, which need the passes to actually run.
+  std::string cache_dir = "";
 };
 
 // Helper used in the opt_main tool, optimizes the given IR for a particular
@@ -58,7 +78,10 @@ absl::StatusOr<std::string> OptimizeIrForTop(
     absl::Span<const std::string> run_only_passes,
     absl::Span<const std::string> skip_passes,
     int64_t convert_array_index_to_select, bool inline_procs,
-    std::string_view ram_rewrites_pb);
+    std::string_view ram_rewrites_pb, int64_t function_base_parallelism = 1,
+    std::string_view pass_trace_path = "", bool binary_output = false,
+    int64_t inlining_node_budget = -1, int64_t loop_unroll_node_budget = -1,
+    std::string_view cache_dir = "");
 
 }  // namespace xls::tools
 
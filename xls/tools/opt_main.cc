@@ -27,6 +27,7 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/tracing.h"
 #include "xls/ir/ram_rewrite.pb.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
@@ -71,8 +72,39 @@ ABSL_FLAG(bool, inline_procs, false,
           "Whether to inline all procs by calling the proc inlining pass.");
 ABSL_FLAG(std::string, ram_rewrites_pb, "",
           "Path to protobuf describing ram rewrites.");
+ABSL_FLAG(std::string, pass_trace_path, "",
+          "If specified, write a trace of the optimization passes in the "
+          "Chrome trace event format (viewable in chrome://tracing or "
+          "Perfetto) to this path. Each pass invocation records its run time "
+          "and the number of nodes it added and removed.");
+ABSL_FLAG(int64_t, function_base_parallelism, 1,
+          "Maximum number of threads used to run function-local passes over "
+          "the functions and procs of the package. A value of one runs them "
+          "serially.");
+ABSL_FLAG(int64_t, inlining_node_budget, -1,
+          "If non-negative, inline in budgeted mode: each function is "
+          "simplified before it is inlined into its callers and optimization "
+          "fails rather than growing the package beyond this many nodes.");
+ABSL_FLAG(int64_t, loop_unroll_node_budget, -1,
+          "If non-negative, counted_for loops are only unrolled completely if "
+          "that adds at most this many nodes; other loops are partially "
+          "unrolled by the largest factor which fits.");
+ABSL_FLAG(bool, binary_output, false,
+          "Emit the optimized package in the binary IR format, which is much "
+          "faster to load than IR text. All tools which read IR accept it.");
+ABSL_FLAG(std::string, cache_dir, "",
+          "If specified, directory in which optimized packages are cached "
+          "across invocations. A package whose relevant input (the functions "
+          "called by a function top, otherwise the whole package) and flags "
+          "are unchanged is emitted from the cache without running the "
+          "optimization pipeline.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
 
+ABSL_FLAG(std::string, trace_output, "",
+          "If non-empty, writes a Chrome trace of the phases of this "
+          "invocation (loadable in chrome://tracing or Perfetto) to this "
+          "path.");
+
 namespace xls::tools {
 namespace {
 
@@ -90,6 +122,14 @@ absl::Status RealMain(std::string_view input_path) {
       absl::GetFlag(FLAGS_convert_array_index_to_select);
   bool inline_procs = absl::GetFlag(FLAGS_inline_procs);
   std::string ram_rewrites_pb = absl::GetFlag(FLAGS_ram_rewrites_pb);
+  int64_t function_base_parallelism =
+      absl::GetFlag(FLAGS_function_base_parallelism);
+  std::string pass_trace_path = absl::GetFlag(FLAGS_pass_trace_path);
+  bool binary_output = absl::GetFlag(FLAGS_binary_output);
+  int64_t inlining_node_budget = absl::GetFlag(FLAGS_inlining_node_budget);
+  int64_t loop_unroll_node_budget =
+      absl::GetFlag(FLAGS_loop_unroll_node_budget);
+  std::string cache_dir = absl::GetFlag(FLAGS_cache_dir);
   XLS_ASSIGN_OR_RETURN(
       std::string opt_ir,
       tools::OptimizeIrForTop(
@@ -100,7 +140,13 @@ absl::Status RealMain(std::string_view input_path) {
           /*skip_passes=*/skip_passes,
           /*convert_array_index_to_select=*/convert_array_index_to_select,
           /*inline_procs=*/inline_procs,
-          /*ram_rewrites_pb=*/ram_rewrites_pb));
+          /*ram_rewrites_pb=*/ram_rewrites_pb,
+          /*function_base_parallelism=*/function_base_parallelism,
+          /*pass_trace_path=*/pass_trace_path,
+          /*binary_output=*/binary_output,
+          /*inlining_node_budget=*/inlining_node_budget,
+          /*loop_unroll_node_budget=*/loop_unroll_node_budget,
+          /*cache_dir=*/cache_dir));
   std::cout << opt_ir;
   return absl::OkStatus();
 }
@@ -111,6 +157,7 @@ absl::Status RealMain(std::string_view input_path) {
 int main(int argc, char **argv) {
   std::vector<std::string_view> positional_arguments =
       xls::InitXls(kUsage, argc, argv);
+  xls::ScopedTraceOutput trace_output(absl::GetFlag(FLAGS_trace_output));
 
   if (positional_arguments.empty()) {
     XLS_LOG(QFATAL) << absl::StreamFormat("Expected invocation: %s <path>",
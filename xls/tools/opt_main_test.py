@@ -15,6 +15,7 @@
 
 """Tests for xls.tools.codegen_main."""
 
+import os
 import subprocess
 
 from xls.common import runfiles
@@ -102,6 +103,31 @@ class OptMainTest(test_base.TestCase):
     # Skipping DFE should leave the dead function in the IR.
     self.assertIn('dead_function', optimized_ir)
 
+  def test_cache_dir(self):
+    cache_dir = self.create_tempdir().full_path
+    ir_file = self.create_tempfile(content=DEAD_FUNCTION_IR)
+    optimized_ir = subprocess.check_output(
+        [OPT_MAIN_PATH, '--cache_dir=' + cache_dir,
+         ir_file.full_path]).decode('utf-8')
+    self.assertLen(os.listdir(cache_dir), 1)
+
+    # Editing a function the top does not call hits the same entry.
+    edited_file = self.create_tempfile(
+        content=DEAD_FUNCTION_IR.replace('value=0)\n  ret add.2',
+                                         'value=1)\n  ret add.2'))
+    cached_ir = subprocess.check_output(
+        [OPT_MAIN_PATH, '--cache_dir=' + cache_dir,
+         edited_file.full_path]).decode('utf-8')
+    self.assertEqual(cached_ir, optimized_ir)
+    self.assertLen(os.listdir(cache_dir), 1)
+
+    # Different flags get a separate entry.
+    skip_dfe_ir = subprocess.check_output(
+        [OPT_MAIN_PATH, '--cache_dir=' + cache_dir, '--skip_passes=dfe',
+         ir_file.full_path]).decode('utf-8')
+    self.assertIn('dead_function', skip_dfe_ir)
+    self.assertLen(os.listdir(cache_dir), 2)
+
   def test_opt_level(self):
     ir_file = self.create_tempfile(content=ADD_LITERAL_IR)
 
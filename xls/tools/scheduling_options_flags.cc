@@ -61,15 +61,32 @@ ABSL_FLAG(
     "If true, when `--clock_period_ps` is given but is infeasible for "
     "scheduling, search for & report the shortest feasible clock period. "
     "Otherwise, just reports whether increasing the clock period can help.");
+ABSL_FLAG(bool, retime_pipeline_registers, false,
+          "If true, after scheduling move nodes between pipeline stages to "
+          "reduce the number of pipeline register bits, without lengthening "
+          "the longest combinational path of any stage. Currently only "
+          "functions without IO or node-in-cycle constraints are retimed.");
 ABSL_FLAG(int64_t, worst_case_throughput, 1,
           "Allow scheduling a pipeline with worst-case throughput no slower "
           "than once per N cycles. If unspecified, enforce throughput 1. Note: "
           "a higher value for --worst_case_throughput *decreases* the "
           "worst-case throughput, since this controls inverse throughput.");
+ABSL_FLAG(bool, minimize_worst_case_throughput, false,
+          "If true, schedule procs at the best worst-case throughput (i.e., "
+          "the smallest initiation interval) achievable within "
+          "--pipeline_stages at --clock_period_ps. A --worst_case_throughput "
+          "other than 1 is the largest initiation interval considered. "
+          "Requires both --pipeline_stages and --clock_period_ps.");
 ABSL_FLAG(int64_t, additional_input_delay_ps, 0,
           "The additional delay added to each receive node.");
 ABSL_FLAG(int64_t, ffi_fallback_delay_ps, 0,
           "Delay of foreign function calls if not otherwise specified.");
+ABSL_FLAG(std::string, delay_cache_path, "",
+          "Path of a file in which operation delay estimates are memoized "
+          "across runs, keyed on the op and its operand and result types. "
+          "Estimates are loaded from the file if it exists and the file is "
+          "updated after scheduling. Useful when estimates are expensive, "
+          "e.g., with foreign function or synthesis-backed delay models.");
 ABSL_FLAG(std::vector<std::string>, io_constraints, {},
           "A comma-separated list of IO constraints, each of which is "
           "specified by a literal like `foo:send:bar:recv:3:5` which means "
@@ -87,6 +104,12 @@ ABSL_FLAG(bool, receives_first_sends_last, false,
           "the last cycle.");
 ABSL_FLAG(int64_t, mutual_exclusion_z3_rlimit, -1,
           "Resource limit for solver in mutual exclusion pass");
+ABSL_FLAG(int64_t, mutual_exclusion_z3_threads, 1,
+          "Number of threads issuing solver queries in the mutual exclusion "
+          "pass.");
+ABSL_FLAG(int64_t, mutual_exclusion_z3_time_budget_ms, -1,
+          "Wall-clock budget in milliseconds for all solver queries of the "
+          "mutual exclusion pass. If negative there is no budget.");
 ABSL_FLAG(std::string, scheduling_options_proto, "",
           "Path to a protobuf containing all scheduling options args.");
 ABSL_FLAG(bool, use_fdo, false,
@@ -114,6 +137,14 @@ ABSL_FLAG(std::string, fdo_yosys_path, "", "Absolute path of Yosys");
 ABSL_FLAG(std::string, fdo_sta_path, "", "Absolute path of OpenSTA");
 ABSL_FLAG(std::string, fdo_synthesis_libraries, "",
           "Synthesis and STA libraries");
+ABSL_FLAG(std::string, fdo_synthesis_cache_path, "",
+          "Path of a file in which the delays of synthesized node sets are "
+          "memoized across runs, keyed on the structure of the extracted "
+          "module. Delays are loaded from the file if it exists and the file "
+          "is updated after scheduling.");
+ABSL_FLAG(int64_t, fdo_max_concurrent_synthesis_jobs, 0,
+          "Maximum number of synthesis jobs run concurrently. If zero, the "
+          "number of hardware threads is used.");
 // LINT.ThenChange(
 //   //xls/build_rules/xls_codegen_rules.bzl,
 //   //docs_src/codegen_options.md
@@ -144,12 +175,17 @@ static absl::StatusOr<bool> SetOptionsFromFlags(
   POPULATE_FLAG(clock_margin_percent);
   POPULATE_FLAG(period_relaxation_percent);
   POPULATE_FLAG(minimize_clock_on_failure);
+  POPULATE_FLAG(retime_pipeline_registers);
   POPULATE_FLAG(worst_case_throughput);
+  POPULATE_FLAG(minimize_worst_case_throughput);
   POPULATE_FLAG(additional_input_delay_ps);
   POPULATE_FLAG(ffi_fallback_delay_ps);
+  POPULATE_FLAG(delay_cache_path);
   POPULATE_REPEATED_FLAG(io_constraints);
   POPULATE_FLAG(receives_first_sends_last);
   POPULATE_FLAG(mutual_exclusion_z3_rlimit);
+  POPULATE_FLAG(mutual_exclusion_z3_threads);
+  POPULATE_FLAG(mutual_exclusion_z3_time_budget_ms);
   POPULATE_FLAG(use_fdo);
   POPULATE_FLAG(fdo_iteration_number);
   POPULATE_FLAG(fdo_delay_driven_path_number);
@@ -160,6 +196,8 @@ static absl::StatusOr<bool> SetOptionsFromFlags(
   POPULATE_FLAG(fdo_yosys_path);
   POPULATE_FLAG(fdo_sta_path);
   POPULATE_FLAG(fdo_synthesis_libraries);
+  POPULATE_FLAG(fdo_synthesis_cache_path);
+  POPULATE_FLAG(fdo_max_concurrent_synthesis_jobs);
 #undef POPULATE_FLAG
 #undef POPULATE_REPEATED_FLAG
   return any_flags_set;
@@ -203,9 +241,13 @@ static absl::StatusOr<SchedulingOptions> OptionsFromFlagProto(
   }
   scheduling_options.minimize_clock_on_failure(
       proto.minimize_clock_on_failure());
+  scheduling_options.retime_pipeline_registers(
+      proto.retime_pipeline_registers());
   if (proto.worst_case_throughput() != 1) {
     scheduling_options.worst_case_throughput(proto.worst_case_throughput());
   }
+  scheduling_options.minimize_worst_case_throughput(
+      proto.minimize_worst_case_throughput());
   if (proto.additional_input_delay_ps() != 0) {
     scheduling_options.additional_input_delay_ps(
         proto.additional_input_delay_ps());
@@ -213,6 +255,9 @@ static absl::StatusOr<SchedulingOptions> OptionsFromFlagProto(
   if (proto.ffi_fallback_delay_ps() != 0) {
     scheduling_options.ffi_fallback_delay_ps(proto.ffi_fallback_delay_ps());
   }
+  if (!proto.delay_cache_path().empty()) {
+    scheduling_options.delay_cache_path(proto.delay_cache_path());
+  }
 
   for (const std::string& c : proto.io_constraints()) {
     std::vector<std::string> components = absl::StrSplit(c, ':');
@@ -265,6 +310,17 @@ static absl::StatusOr<SchedulingOptions> OptionsFromFlagProto(
     scheduling_options.mutual_exclusion_z3_rlimit(
         proto.mutual_exclusion_z3_rlimit());
   }
+  if (proto.has_mutual_exclusion_z3_threads()) {
+    if (proto.mutual_exclusion_z3_threads() < 1) {
+      return absl::InternalError("mutual_exclusion_z3_threads must be >= 1");
+    }
+    scheduling_options.mutual_exclusion_z3_threads(
+        proto.mutual_exclusion_z3_threads());
+  }
+  if (proto.mutual_exclusion_z3_time_budget_ms() >= 0) {
+    scheduling_options.mutual_exclusion_z3_time_budget_ms(
+        proto.mutual_exclusion_z3_time_budget_ms());
+  }
 
   if (p != nullptr) {
     for (const SchedulingConstraint& c : scheduling_options.constraints()) {
@@ -355,6 +411,17 @@ static absl::StatusOr<SchedulingOptions> OptionsFromFlagProto(
   scheduling_options.fdo_yosys_path(proto.fdo_yosys_path());
   scheduling_options.fdo_sta_path(proto.fdo_sta_path());
   scheduling_options.fdo_synthesis_libraries(proto.fdo_synthesis_libraries());
+  scheduling_options.fdo_synthesis_cache_path(
+      proto.fdo_synthesis_cache_path());
+
+  if (proto.has_fdo_max_concurrent_synthesis_jobs()) {
+    if (proto.fdo_max_concurrent_synthesis_jobs() < 0) {
+      return absl::InternalError(
+          "fdo_max_concurrent_synthesis_jobs must be >= 0");
+    }
+    scheduling_options.fdo_max_concurrent_synthesis_jobs(
+        proto.fdo_max_concurrent_synthesis_jobs());
+  }
 
   return scheduling_options;
 }
@@ -386,6 +453,10 @@ absl::StatusOr<synthesis::Synthesizer*> SetUpSynthesizer(
         new synthesis::YosysSynthesizer(flags.fdo_yosys_path(),
                                         flags.fdo_sta_path(),
                                         flags.fdo_synthesis_libraries());
+    if (flags.fdo_max_concurrent_synthesis_jobs() > 0) {
+      yosys_synthesizer->SetMaxConcurrentJobs(
+          flags.fdo_max_concurrent_synthesis_jobs());
+    }
     return yosys_synthesizer;
   }
 
@@ -31,6 +31,7 @@
 #include "xls/codegen/vast.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
@@ -225,18 +226,18 @@ int main(int argc, char** argv) {
     input =
         xls::FunctionInput{std::vector<std::string>{absl::GetFlag(FLAGS_args)}};
   } else if (!absl::GetFlag(FLAGS_args_file).empty()) {
-    absl::StatusOr<std::string> args_file_contents_or =
-        xls::GetFileContents(absl::GetFlag(FLAGS_args_file));
-    XLS_QCHECK_OK(args_file_contents_or.status());
-    input = xls::FunctionInput{absl::StrSplit(args_file_contents_or.value(),
-                                              '\n', absl::SkipWhitespace())};
+    absl::StatusOr<xls::MappedFile> args_file =
+        xls::MappedFile::Open(absl::GetFlag(FLAGS_args_file));
+    XLS_QCHECK_OK(args_file.status());
+    input = xls::FunctionInput{absl::StrSplit(args_file->contents(), '\n',
+                                              absl::SkipWhitespace())};
   } else {
-    absl::StatusOr<std::string> channel_values_file_contents =
-        xls::GetFileContents(absl::GetFlag(FLAGS_channel_values_file));
-    XLS_QCHECK_OK(channel_values_file_contents.status());
+    absl::StatusOr<xls::MappedFile> channel_values_file =
+        xls::MappedFile::Open(absl::GetFlag(FLAGS_channel_values_file));
+    XLS_QCHECK_OK(channel_values_file.status());
     absl::StatusOr<absl::flat_hash_map<std::string, std::vector<xls::Value>>>
         channel_values_or =
-            xls::ParseChannelValues(channel_values_file_contents.value());
+            xls::ParseChannelValues(channel_values_file->contents());
     XLS_QCHECK_OK(channel_values_or.status());
     absl::flat_hash_map<std::string, int64_t> output_channel_counts;
     for (std::string_view output_channel_count :
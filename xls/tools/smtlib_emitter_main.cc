@@ -31,6 +31,7 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/solvers/smtlib_emitter.h"
 #include "xls/solvers/z3_ir_translator.h"
 #include "../z3/src/api/z3.h"
 #include "../z3/src/api/z3_api.h"
@@ -42,11 +43,16 @@ ABSL_FLAG(
     "will be made to try to find the package's entry function. "
     "If that fails, an error will be returned.");
 ABSL_FLAG(std::string, ir_path, "", "Path to the XLS IR to process.");
+ABSL_FLAG(bool, streaming, false,
+          "If true, emits SMT-LIB2 directly from the IR as it is traversed, "
+          "with a define-fun for each multiply-used node, instead of printing "
+          "a Z3 AST as a single expression. The output is linear in the size "
+          "of the function. Supports bits-typed functions only.");
 
 namespace xls {
 
 static absl::Status RealMain(const std::filesystem::path& ir_path,
-                             std::optional<std::string> top) {
+                             std::optional<std::string> top, bool streaming) {
   XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
   XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
   Function* function;
@@ -56,6 +62,10 @@ static absl::Status RealMain(const std::filesystem::path& ir_path,
     XLS_ASSIGN_OR_RETURN(function, package->GetFunction(top.value()));
   }
 
+  if (streaming) {
+    return solvers::EmitSmtLib(function, std::cout);
+  }
+
   XLS_ASSIGN_OR_RETURN(auto translator,
                        solvers::z3::IrTranslator::CreateAndTranslate(function));
   Z3_set_ast_print_mode(translator->ctx(), Z3_PRINT_SMTLIB2_COMPLIANT);
@@ -73,5 +83,6 @@ int main(int argc, char* argv[]) {
   if (!absl::GetFlag(FLAGS_top).empty()) {
     top = absl::GetFlag(FLAGS_top);
   }
-  return xls::ExitStatus(xls::RealMain(absl::GetFlag(FLAGS_ir_path), top));
+  return xls::ExitStatus(xls::RealMain(absl::GetFlag(FLAGS_ir_path), top,
+                                       absl::GetFlag(FLAGS_streaming)));
 }
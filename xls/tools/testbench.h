@@ -15,10 +15,12 @@
 #ifndef XLS_TOOLS_TESTBENCH_H_
 #define XLS_TOOLS_TESTBENCH_H_
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <functional>
 #include <iostream>
+#include <memory>
 #include <thread>  // NOLINT(build/c++11)
 #include <type_traits>
 
@@ -32,15 +34,14 @@ namespace xls {
 
 // Testbench is a helper class to test an XLS module (or...anything, really)
 // across a range of inputs. This class creates a set of worker threads and
-// divides the input across them, and sets them to go until complete.
-// Execution status (percent complete, number of result mismatches) will be
-// periodically printed to the terminal, as this class' primary use is for
-// exploring large test spaces.
+// sets them to go until complete.
+// Execution status (percent complete, throughput, number of result mismatches)
+// will be periodically printed to the terminal, as this class' primary use is
+// for exploring large test spaces.
 //
-// Presently, work is parititioned uniformly across threads at startup. This can
-// lead to work imbalance if certain areas of the input space execute faster
-// than others. More advanced strategies can be explored in the future if this
-// becomes a problem.
+// Work is handed out dynamically: worker threads repeatedly claim the next
+// chunk of the input space, so threads that get through cheap regions of the
+// space pick up more work instead of idling until the slowest thread finishes.
 
 namespace internal {
 // Forward decl of common Testbench base class.
@@ -73,6 +74,9 @@ class Testbench : public internal::TestbenchBase<InputT, ResultT, ShardDataT> {
   //                     are considered equivalent.
   //   log_errors      : The function to log errors when compare_results returns
   //                     false.
+  //   chunk_size      : The number of consecutive indices a worker claims at a
+  //                     time. If 0, a size is chosen based on the size of the
+  //                     space and the number of threads.
   //
   // All lambdas must be thread-safe.
   //
@@ -87,16 +91,17 @@ class Testbench : public internal::TestbenchBase<InputT, ResultT, ShardDataT> {
             std::function<ResultT(ShardDataT*, InputT)> compute_expected,
             std::function<ResultT(ShardDataT*, InputT)> compute_actual,
             std::function<bool(ResultT, ResultT)> compare_results,
-            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
+            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors,
+            uint64_t chunk_size = 0)
       : internal::TestbenchBase<InputT, ResultT, ShardDataT>(
             start, end, num_threads, max_failures, index_to_input,
-            compare_results, log_errors),
+            compare_results, log_errors, chunk_size),
         create_shard_(create_shard),
         compute_expected_(compute_expected),
         compute_actual_(compute_actual) {
-    this->thread_create_fn_ = [this](uint64_t start, uint64_t end) {
+    this->thread_create_fn_ = [this](TestbenchWorkQueue* work_queue) {
       return std::make_unique<TestbenchThread<InputT, ResultT, ShardDataT>>(
-          &this->mutex_, &this->wake_me_, start, end, this->max_failures_,
+          &this->mutex_, &this->wake_me_, work_queue, this->max_failures_,
           this->index_to_input_, create_shard_, compute_expected_,
           compute_actual_, this->compare_results_, this->log_errors_);
     };
@@ -120,15 +125,16 @@ class Testbench<InputT, ResultT, ShardDataT,
             std::function<ResultT(InputT)> compute_expected,
             std::function<ResultT(InputT)> compute_actual,
             std::function<bool(ResultT, ResultT)> compare_results,
-            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
+            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors,
+            uint64_t chunk_size = 0)
       : internal::TestbenchBase<InputT, ResultT, ShardDataT>(
             start, end, num_threads, max_failures, index_to_input,
-            compare_results, log_errors),
+            compare_results, log_errors, chunk_size),
         compute_expected_(compute_expected),
         compute_actual_(compute_actual) {
-    this->thread_create_fn_ = [this](uint64_t start, uint64_t end) {
+    this->thread_create_fn_ = [this](TestbenchWorkQueue* work_queue) {
       return std::make_unique<TestbenchThread<InputT, ResultT, ShardDataT>>(
-          &this->mutex_, &this->wake_me_, start, end, this->max_failures_,
+          &this->mutex_, &this->wake_me_, work_queue, this->max_failures_,
           this->index_to_input_, compute_expected_, compute_actual_,
           this->compare_results_, this->log_errors_);
     };
@@ -151,12 +157,14 @@ class TestbenchBase {
       uint64_t start, uint64_t end, uint64_t num_threads, uint64_t max_failures,
       std::function<InputT(uint64_t)> index_to_input,
       std::function<bool(ResultT, ResultT)> compare_results,
-      std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
+      std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors,
+      uint64_t chunk_size)
       : started_(false),
         num_threads_(num_threads),
         start_(start),
         end_(end),
         max_failures_(max_failures),
+        chunk_size_(chunk_size),
         num_samples_processed_(0),
         index_to_input_(index_to_input),
         compare_results_(compare_results),
@@ -173,6 +181,18 @@ class TestbenchBase {
     return absl::OkStatus();
   }
 
+  // Sets the number of consecutive indices a worker thread claims at a time;
+  // 0 picks a size automatically. Must be called before Run().
+  absl::Status SetChunkSize(uint64_t chunk_size) {
+    absl::MutexLock lock(&mutex_);
+    if (this->started_) {
+      return absl::FailedPreconditionError(
+          "Can't change the chunk size after starting execution.");
+    }
+    chunk_size_ = chunk_size;
+    return absl::OkStatus();
+  }
+
   // Executes the test.
   absl::Status Run() {
     // Lock before spawning threads to prevent missing any early wakeup signals
@@ -181,23 +201,11 @@ class TestbenchBase {
     started_ = true;
 
     // Set up all the workers.
-    uint64_t chunk_size = (end_ - start_) / num_threads_;
-    uint64_t chunk_remainder =
-        chunk_size == 0 ? (end_ - start_) : (end_ - start_) % chunk_size;
-    uint64_t first = 0;
-    uint64_t last;
+    work_queue_ =
+        std::make_unique<TestbenchWorkQueue>(start_, end_, GetChunkSize());
     for (int i = 0; i < num_threads_; i++) {
-      last = first + chunk_size;
-      // Distribute any remainder evenly amongst the threads.
-      if (chunk_remainder > 0) {
-        last++;
-        chunk_remainder--;
-      }
-
-      threads_.push_back(thread_create_fn_(first, last));
+      threads_.push_back(thread_create_fn_(work_queue_.get()));
       threads_.back()->Run();
-
-      first = last + 1;
     }
 
     // Wait for all to be ready.
@@ -216,6 +224,7 @@ class TestbenchBase {
 
     // Don't include startup time.
     start_time_ = absl::Now();
+    last_print_time_ = start_time_;
 
     for (int i = 0; i < threads_.size(); i++) {
       threads_[i]->SignalStart();
@@ -268,54 +277,70 @@ class TestbenchBase {
   // How many seconds to wait before printing status (at most).
   static constexpr absl::Duration kPrintInterval = absl::Seconds(5);
 
+  // Bounds on the automatically chosen chunk size. Chunks should be large
+  // enough that claiming one is rare relative to evaluating its inputs, and
+  // small enough that threads finish at nearly the same time.
+  static constexpr uint64_t kMinChunkSize = 1;
+  static constexpr uint64_t kMaxChunkSize = 4096;
+
+  // Returns the number of consecutive indices a worker claims at a time.
+  uint64_t GetChunkSize() const {
+    if (chunk_size_ != 0) {
+      return chunk_size_;
+    }
+    // Aim for many chunks per thread so that the last ones to finish don't
+    // leave the other threads idle for long.
+    uint64_t num_threads = std::max(num_threads_, 1);
+    return std::clamp<uint64_t>((end_ - start_) / (num_threads * 64),
+                                kMinChunkSize, kMaxChunkSize);
+  }
+
   // Prints the current execution status across all threads.
   void PrintStatus() {
-    // Get the remainder-adjusted chunk size for this thread.
-    auto thread_chunk_size = [this](int thread_index) {
-      uint64_t total_size = end_ - start_;
-      uint64_t chunk_size = total_size / threads_.size();
-      uint64_t remainder =
-          chunk_size == 0 ? total_size : total_size % chunk_size;
-      if (thread_index < remainder) {
-        chunk_size++;
-      }
-      return chunk_size;
-    };
-
-    // Ignore remainder issues here. It shouldn't matter much at all.
     absl::Time now = absl::Now();
     auto delta = now - start_time_;
+    auto delta_this_print = now - last_print_time_;
     uint64_t total_done = 0;
     for (int64_t i = 0; i < threads_.size(); ++i) {
       uint64_t num_passes = threads_[i]->num_passes();
       uint64_t num_failures = threads_[i]->num_failures();
       uint64_t thread_done = num_passes + num_failures;
-      uint64_t chunk_size = thread_chunk_size(i);
       total_done += thread_done;
       std::cout << absl::StreamFormat(
-                       "thread %02d: %f%% @ %.1f us/sample :: failures %d", i,
-                       static_cast<double>(thread_done) / chunk_size * 100.0,
-                       absl::ToDoubleMicroseconds(delta) / thread_done,
+                       "thread %02d: %d samples @ %.1f us/sample :: "
+                       "failures %d",
+                       i, thread_done,
+                       thread_done == 0 ? 0.0
+                                        : absl::ToDoubleMicroseconds(delta) /
+                                              thread_done,
                        num_failures)
                 << "\n";
     }
+    uint64_t total_size = end_ - start_;
     double done_per_second = delta == absl::ZeroDuration()
                                  ? 0.0
                                  : total_done / absl::ToDoubleSeconds(delta);
-    int64_t remaining = end_ - start_ - total_done;
+    int64_t remaining = total_size - total_done;
     auto estimate = absl::Seconds(
         done_per_second == 0.0 ? 0.0 : remaining / done_per_second);
     double throughput_this_print =
-        static_cast<double>(total_done - num_samples_processed_) /
-        ToInt64Seconds(kPrintInterval);
+        delta_this_print == absl::ZeroDuration()
+            ? 0.0
+            : static_cast<double>(total_done - num_samples_processed_) /
+                  absl::ToDoubleSeconds(delta_this_print);
     std::cout << absl::StreamFormat(
-                     "--- ^ after %s elapsed; %f Misamples/s; estimate %s "
-                     "remaining ...",
+                     "--- ^ after %s elapsed; %f%% done; %f Misamples/s "
+                     "(%f Misamples/s average); estimate %s remaining ...",
                      absl::FormatDuration(delta),
+                     total_size == 0 ? 100.0
+                                     : static_cast<double>(total_done) /
+                                           total_size * 100.0,
                      throughput_this_print / std::pow(2, 20),
+                     done_per_second / std::pow(2, 20),
                      absl::FormatDuration(estimate))
               << std::endl;
     num_samples_processed_ = total_done;
+    last_print_time_ = now;
   }
 
   // Requests that all running threads terminate (but doesn't Join() them).
@@ -328,18 +353,24 @@ class TestbenchBase {
   bool started_;
   int num_threads_;
   absl::Time start_time_;
+  absl::Time last_print_time_;
   uint64_t start_;
   uint64_t end_;
   uint64_t max_failures_;
+  uint64_t chunk_size_;
   uint64_t num_samples_processed_;
   std::function<InputT(uint64_t)> index_to_input_;
   std::function<bool(ResultT, ResultT)> compare_results_;
   std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors_;
 
   using ThreadT = TestbenchThread<InputT, ResultT, ShardDataT>;
-  std::function<std::unique_ptr<ThreadT>(uint64_t, uint64_t)> thread_create_fn_;
+  std::function<std::unique_ptr<ThreadT>(TestbenchWorkQueue*)>
+      thread_create_fn_;
   std::vector<std::unique_ptr<ThreadT>> threads_;
 
+  // Shared by all workers; outlives them since they are joined in Run().
+  std::unique_ptr<TestbenchWorkQueue> work_queue_;
+
   // The main thread sleeps while tests are running. As worker threads finish,
   // they'll wake us up via this condvar.
   absl::Mutex mutex_;
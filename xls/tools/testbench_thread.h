@@ -15,7 +15,9 @@
 #ifndef XLS_TOOLS_TESTBENCH_THREAD_H_
 #define XLS_TOOLS_TESTBENCH_THREAD_H_
 
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
@@ -32,9 +34,43 @@ namespace xls {
 template <typename InputT, typename ResultT, typename ShardDataT>
 class TestbenchThreadBase;
 
+// Hands out chunks of the index space [start, end) to worker threads on
+// demand. Threads which get through their chunks quickly simply claim more, so
+// all threads stay busy until the space is exhausted even when the cost per
+// input varies across the space.
+class TestbenchWorkQueue {
+ public:
+  TestbenchWorkQueue(uint64_t start, uint64_t end, uint64_t chunk_size)
+      : end_(end), chunk_size_(std::max<uint64_t>(chunk_size, 1)),
+        next_(start) {}
+
+  // Claims the next chunk [*chunk_start, *chunk_end). Returns false once the
+  // index space is exhausted.
+  bool NextChunk(uint64_t* chunk_start, uint64_t* chunk_end) {
+    uint64_t first = next_.load(std::memory_order_relaxed);
+    uint64_t last;
+    do {
+      if (first >= end_) {
+        return false;
+      }
+      // Written to avoid overflow when end_ is close to the maximum index.
+      last = first + std::min(chunk_size_, end_ - first);
+    } while (!next_.compare_exchange_weak(first, last,
+                                          std::memory_order_relaxed));
+    *chunk_start = first;
+    *chunk_end = last;
+    return true;
+  }
+
+ private:
+  const uint64_t end_;
+  const uint64_t chunk_size_;
+  std::atomic<uint64_t> next_;
+};
+
 // TestbenchThread handles the work of _actually_ running tests.
-// It simply iterates over its given range of the index space and calls the
-// expected/actual calculators.
+// It repeatedly claims a chunk of the index space from the shared work queue
+// and calls the expected/actual calculators on each index in it.
 //
 // Just as with Testbench, TestbenchThread supports execution both with and
 // without per-shard data, and uses the same type of construct to expose an API
@@ -48,6 +84,7 @@ class TestbenchThread
   // All specified functions must be thread-safe.
   //  - wake_parent_mutex: A mutex that protects:
   //  - wake_parent: A condvar to kick the parent when this thread has finished.
+  //  - work_queue: The parent-owned source of indices to evaluate.
   //  - max_failures: The number of failures that will cause us to bail out.
   //                  If 0, then there will be no limit.
   //  - index_to_input: A function that can convert an index to an input to the
@@ -57,7 +94,7 @@ class TestbenchThread
   //                     under test.
   TestbenchThread(
       absl::Mutex* wake_parent_mutex, absl::CondVar* wake_parent,
-      uint64_t start_index, uint64_t end_index, uint64_t max_failures,
+      TestbenchWorkQueue* work_queue, uint64_t max_failures,
       std::function<InputT(uint64_t)> index_to_input,
       std::function<std::unique_ptr<ShardDataT>()> create_shard,
       std::function<ResultT(ShardDataT*, InputT)> generate_expected,
@@ -65,8 +102,8 @@ class TestbenchThread
       std::function<bool(ResultT, ResultT)> compare_results,
       std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
       : TestbenchThreadBase<InputT, ResultT, ShardDataT>(
-            wake_parent_mutex, wake_parent, start_index, end_index,
-            max_failures, index_to_input, compare_results, log_errors),
+            wake_parent_mutex, wake_parent, work_queue, max_failures,
+            index_to_input, compare_results, log_errors),
         create_shard_fn_(create_shard),
         generate_expected_(generate_expected),
         generate_actual_(generate_actual) {
@@ -97,15 +134,15 @@ class TestbenchThread<
  public:
   TestbenchThread(
       absl::Mutex* wake_parent_mutex, absl::CondVar* wake_parent,
-      uint64_t start_index, uint64_t end_index, uint64_t max_failures,
+      TestbenchWorkQueue* work_queue, uint64_t max_failures,
       std::function<InputT(uint64_t)> index_to_input,
       std::function<ResultT(InputT)> generate_expected,
       std::function<ResultT(InputT)> generate_actual,
       std::function<bool(ResultT, ResultT)> compare_results,
       std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
       : TestbenchThreadBase<InputT, ResultT, ShardDataT>(
-            wake_parent_mutex, wake_parent, start_index, end_index,
-            max_failures, index_to_input, compare_results, log_errors),
+            wake_parent_mutex, wake_parent, work_queue, max_failures,
+            index_to_input, compare_results, log_errors),
         generate_expected_(generate_expected),
         generate_actual_(generate_actual) {
     this->generate_expected_fn_ = [this](InputT& input) {
@@ -130,7 +167,7 @@ class TestbenchThreadBase {
  public:
   TestbenchThreadBase(
       absl::Mutex* wake_parent_mutex, absl::CondVar* wake_parent,
-      uint64_t start_index, uint64_t end_index, uint64_t max_failures,
+      TestbenchWorkQueue* work_queue, uint64_t max_failures,
       std::function<InputT(uint64_t)> index_to_input,
       std::function<bool(ResultT, ResultT)> compare_results,
       std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
@@ -140,8 +177,7 @@ class TestbenchThreadBase {
         running_(false),
         ready_(false),
         start_(false),
-        start_index_(start_index),
-        end_index_(end_index),
+        work_queue_(work_queue),
         max_failures_(max_failures),
         num_passes_(0),
         num_failures_(0),
@@ -176,25 +212,30 @@ class TestbenchThreadBase {
     }
 
     running_.store(true);
-    for (uint64_t i = start_index_; i < end_index_; i++) {
-      // Don't check for cancelled on every iteration; it's a touch slow.
-      if (i % 128 == 0 && cancelled_.load()) {
-        return_status = absl::CancelledError("This thread was cancelled.");
-        break;
-      }
-
-      InputT input = index_to_input_(i);
-      ResultT expected = generate_expected_fn_(input);
-      ResultT actual = generate_actual_fn_(input);
-      if (!compare_results_(expected, actual)) {
-        num_failures_.store(num_failures_.load() + 1);
-        log_errors_(i, input, expected, actual);
-        if (max_failures_ <= num_failures_.load()) {
-          return_status = absl::UnknownError("Maximum error count reached.");
+    uint64_t chunk_start;
+    uint64_t chunk_end;
+    while (return_status.ok() &&
+           work_queue_->NextChunk(&chunk_start, &chunk_end)) {
+      for (uint64_t i = chunk_start; i < chunk_end; i++) {
+        // Don't check for cancelled on every iteration; it's a touch slow.
+        if (i % 128 == 0 && cancelled_.load()) {
+          return_status = absl::CancelledError("This thread was cancelled.");
           break;
         }
-      } else {
-        num_passes_.store(num_passes_.load() + 1);
+
+        InputT input = index_to_input_(i);
+        ResultT expected = generate_expected_fn_(input);
+        ResultT actual = generate_actual_fn_(input);
+        if (!compare_results_(expected, actual)) {
+          num_failures_.store(num_failures_.load() + 1);
+          log_errors_(i, input, expected, actual);
+          if (max_failures_ <= num_failures_.load()) {
+            return_status = absl::UnknownError("Maximum error count reached.");
+            break;
+          }
+        } else {
+          num_passes_.store(num_passes_.load() + 1);
+        }
       }
     }
 
@@ -256,8 +297,8 @@ class TestbenchThreadBase {
   std::atomic<bool> ready_;
   std::atomic<bool> start_;
 
-  uint64_t start_index_;
-  uint64_t end_index_;
+  // Parent-owned source of the indices to evaluate.
+  TestbenchWorkQueue* work_queue_;
 
   // Bookkeeping data.
   uint64_t max_failures_;
@@ -0,0 +1,379 @@
+// Copyright 2023 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the speed of the XLS toolchain itself (as opposed to the quality of
+// the generated designs, which benchmark_main reports). Each DSLX function of
+// the corpus is taken through every stage of the flow and the wall time and
+// peak resident set size of each stage are emitted as JSON.
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/codegen/module_signature.h"
+#include "xls/codegen/pipeline_generator.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/memory_usage.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/stopwatch.h"
+#include "xls/delay_model/delay_estimators.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/ir_convert/convert_options.h"
+#include "xls/dslx/ir_convert/ir_converter.h"
+#include "xls/dslx/mangle.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/warning_kind.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/optimization_pass_pipeline.h"
+#include "xls/passes/pass_base.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/run_pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+
+const char kUsage[] = R"(
+Runs a corpus of DSLX functions through parsing, type checking, IR
+conversion, optimization, scheduling, codegen, JIT compilation and JIT
+execution, and emits the wall time and peak RSS of every stage as JSON.
+
+Expected invocation:
+  toolchain_benchmark_main [<DSLX file>:<function> ...]
+where each positional argument names a DSLX file and the function within it to
+benchmark. Without positional arguments the built-in corpus (xls/examples,
+xls/modules/aes and the floating-point operations of the DSLX standard
+library) is used.
+
+The peak RSS of a stage is the high-water mark of the process's resident set
+during the stage. It is reset between stages where the kernel supports it
+(Linux, via /proc/self/clear_refs); otherwise it is the high-water mark of the
+process so far.
+
+Example invocation:
+  toolchain_benchmark_main --json_output=/tmp/toolchain.json
+)";
+
+ABSL_FLAG(std::string, json_output, "",
+          "Path of the file to write the JSON results to. If empty, the "
+          "results are written to stdout.");
+ABSL_FLAG(std::string, dslx_stdlib_path,
+          std::string(xls::kDefaultDslxStdlibPath),
+          "Path to the DSLX standard library.");
+ABSL_FLAG(std::string, dslx_path, "",
+          "Additional paths to search for modules (colon delimited).");
+ABSL_FLAG(int64_t, pipeline_stages, 4,
+          "Number of pipeline stages to schedule each function into.");
+ABSL_FLAG(int64_t, jit_run_count, 1000,
+          "Number of random argument sets for which each function is run in "
+          "the JIT stage.");
+
+namespace xls {
+namespace {
+
+struct CorpusEntry {
+  // Path of the DSLX file relative to the root of the XLS source tree.
+  std::string path;
+  std::string function;
+};
+
+// The built-in corpus. The functions are chosen to cover a range of sizes and
+// styles of design; changing the corpus invalidates comparisons against
+// earlier results.
+const CorpusEntry kDefaultCorpus[] = {
+    {"xls/examples/adler32.x", "main"},
+    {"xls/examples/crc32.x", "main"},
+    {"xls/examples/sha256.x", "main"},
+    {"xls/modules/aes/aes.x", "encrypt"},
+    {"xls/modules/aes/aes.x", "decrypt"},
+    {"xls/dslx/stdlib/float32.x", "add"},
+    {"xls/dslx/stdlib/float32.x", "mul"},
+    {"xls/dslx/stdlib/float32.x", "fma"},
+    {"xls/dslx/stdlib/float64.x", "add"},
+    {"xls/dslx/stdlib/float64.x", "mul"},
+    {"xls/dslx/stdlib/bfloat16.x", "add"},
+};
+
+struct StageResult {
+  std::string stage;
+  absl::Duration duration;
+  std::optional<int64_t> peak_rss_bytes;
+};
+
+struct EntryResult {
+  std::string path;
+  std::string function;
+  std::vector<StageResult> stages;
+};
+
+// Runs `stage_fn` as the stage named `stage` and appends its measurements to
+// `result`.
+absl::Status RunStage(std::string_view stage,
+                      const std::function<absl::Status()>& stage_fn,
+                      EntryResult& result) {
+  ResetPeakRss();
+  Stopwatch stopwatch;
+  XLS_RETURN_IF_ERROR(stage_fn()) << "in stage " << stage;
+  absl::Duration duration = stopwatch.GetElapsedTime();
+  result.stages.push_back(StageResult{.stage = std::string(stage),
+                                      .duration = duration,
+                                      .peak_rss_bytes = GetPeakRssBytes()});
+  XLS_VLOG(1) << absl::StreamFormat("%s:%s %s: %s", result.path,
+                                    result.function, stage,
+                                    absl::FormatDuration(duration));
+  return absl::OkStatus();
+}
+
+absl::StatusOr<EntryResult> BenchmarkEntry(
+    const std::filesystem::path& path, std::string_view function,
+    const std::filesystem::path& stdlib_path,
+    absl::Span<const std::filesystem::path> dslx_paths) {
+  EntryResult result{.path = path.string(),
+                     .function = std::string(function)};
+  XLS_ASSIGN_OR_RETURN(std::string dslx_text, GetFileContents(path));
+  std::string module_name = path.stem().string();
+
+  // Each entry gets fresh import data so imported modules are parsed and type
+  // checked again rather than served from an earlier entry's cache.
+  dslx::ImportData import_data =
+      dslx::CreateImportData(stdlib_path, dslx_paths, dslx::kAllWarningsSet);
+
+  std::unique_ptr<dslx::Module> module;
+  XLS_RETURN_IF_ERROR(RunStage(
+      "parse",
+      [&]() -> absl::Status {
+        XLS_ASSIGN_OR_RETURN(
+            module, dslx::ParseModule(dslx_text, path.string(), module_name));
+        return absl::OkStatus();
+      },
+      result));
+
+  // Imported modules are parsed as part of type checking the entry module.
+  dslx::Module* typechecked_module = nullptr;
+  XLS_RETURN_IF_ERROR(RunStage(
+      "typecheck",
+      [&]() -> absl::Status {
+        XLS_ASSIGN_OR_RETURN(dslx::TypecheckedModule tm,
+                             dslx::TypecheckModule(std::move(module),
+                                                   path.string(),
+                                                   &import_data));
+        typechecked_module = tm.module;
+        return absl::OkStatus();
+      },
+      result));
+
+  Package package(module_name);
+  XLS_RETURN_IF_ERROR(RunStage(
+      "ir_convert",
+      [&]() -> absl::Status {
+        XLS_RETURN_IF_ERROR(dslx::ConvertOneFunctionIntoPackage(
+            typechecked_module, function, &import_data,
+            /*parametric_env=*/nullptr, dslx::ConvertOptions(), &package));
+        XLS_ASSIGN_OR_RETURN(
+            std::string top_name,
+            dslx::MangleDslxName(module_name, function,
+                                 dslx::CallingConvention::kTypical));
+        return package.SetTopByName(top_name);
+      },
+      result));
+
+  XLS_RETURN_IF_ERROR(RunStage(
+      "opt",
+      [&]() -> absl::Status {
+        std::unique_ptr<OptimizationCompoundPass> pipeline =
+            CreateOptimizationPassPipeline();
+        PassResults pass_results;
+        return pipeline
+            ->Run(&package, OptimizationPassOptions(), &pass_results)
+            .status();
+      },
+      result));
+  XLS_ASSIGN_OR_RETURN(Function * f, package.GetTopAsFunction());
+
+  std::optional<PipelineSchedule> schedule;
+  XLS_RETURN_IF_ERROR(RunStage(
+      "schedule",
+      [&]() -> absl::Status {
+        XLS_ASSIGN_OR_RETURN(
+            schedule,
+            RunPipelineSchedule(f, GetStandardDelayEstimator(),
+                                SchedulingOptions().pipeline_stages(
+                                    absl::GetFlag(FLAGS_pipeline_stages))));
+        return absl::OkStatus();
+      },
+      result));
+
+  XLS_RETURN_IF_ERROR(RunStage(
+      "codegen",
+      [&]() -> absl::Status {
+        return verilog::ToPipelineModuleText(*schedule, f).status();
+      },
+      result));
+
+  std::unique_ptr<FunctionJit> jit;
+  XLS_RETURN_IF_ERROR(RunStage(
+      "jit_compile",
+      [&]() -> absl::Status {
+        XLS_ASSIGN_OR_RETURN(jit, FunctionJit::Create(f));
+        return absl::OkStatus();
+      },
+      result));
+
+  std::minstd_rand rng_engine;
+  std::vector<std::vector<Value>> arg_batches(
+      absl::GetFlag(FLAGS_jit_run_count));
+  for (std::vector<Value>& args : arg_batches) {
+    for (Param* param : f->params()) {
+      args.push_back(RandomValue(param->GetType(), &rng_engine));
+    }
+  }
+  XLS_RETURN_IF_ERROR(RunStage(
+      "jit_run",
+      [&]() -> absl::Status {
+        return DropInterpreterEvents(jit->RunBatched(arg_batches)).status();
+      },
+      result));
+  return result;
+}
+
+// Returns `s` as a quoted JSON string.
+std::string JsonString(std::string_view s) {
+  std::string out = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      absl::StrAppend(&out, "\\", std::string(1, c));
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      absl::StrAppendFormat(&out, "\\u%04x", static_cast<int>(c));
+    } else {
+      out.push_back(c);
+    }
+  }
+  out.push_back('"');
+  return out;
+}
+
+std::string ResultsToJson(absl::Span<const EntryResult> results) {
+  std::vector<std::string> entries;
+  for (const EntryResult& result : results) {
+    std::vector<std::string> stages;
+    for (const StageResult& stage : result.stages) {
+      stages.push_back(absl::StrFormat(
+          "{\"stage\":%s,\"time_us\":%d,\"peak_rss_bytes\":%s}",
+          JsonString(stage.stage), absl::ToInt64Microseconds(stage.duration),
+          stage.peak_rss_bytes.has_value()
+              ? absl::StrCat(*stage.peak_rss_bytes)
+              : "null"));
+    }
+    entries.push_back(absl::StrFormat(
+        "{\"path\":%s,\"function\":%s,\"stages\":[%s]}",
+        JsonString(result.path), JsonString(result.function),
+        absl::StrJoin(stages, ",")));
+  }
+  return absl::StrFormat("{\"benchmarks\":[%s]}\n",
+                         absl::StrJoin(entries, ","));
+}
+
+absl::Status RealMain(absl::Span<const std::string_view> specs) {
+  std::vector<std::filesystem::path> dslx_paths;
+  for (std::string_view path :
+       absl::StrSplit(absl::GetFlag(FLAGS_dslx_path), ':',
+                      absl::SkipEmpty())) {
+    dslx_paths.push_back(std::filesystem::path(path));
+  }
+
+  std::vector<std::pair<std::filesystem::path, std::string>> corpus;
+  if (specs.empty()) {
+    for (const CorpusEntry& entry : kDefaultCorpus) {
+      XLS_ASSIGN_OR_RETURN(std::filesystem::path path,
+                           GetXlsRunfilePath(entry.path));
+      corpus.push_back({path, entry.function});
+    }
+    // Imports within the corpus are relative to the root of the source tree.
+    std::string first_path = corpus.front().first.string();
+    XLS_RET_CHECK(absl::EndsWith(first_path, kDefaultCorpus[0].path));
+    dslx_paths.push_back(std::filesystem::path(
+        absl::StripSuffix(first_path, kDefaultCorpus[0].path)));
+  } else {
+    for (std::string_view spec : specs) {
+      std::vector<std::string_view> pieces =
+          absl::StrSplit(spec, absl::MaxSplits(':', 1));
+      if (pieces.size() != 2 || pieces[1].empty()) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Expected benchmark of the form <DSLX file>:<function>, got: %s",
+            spec));
+      }
+      corpus.push_back({std::filesystem::path(pieces[0]),
+                        std::string(pieces[1])});
+    }
+  }
+
+  std::vector<EntryResult> results;
+  for (const auto& [path, function] : corpus) {
+    XLS_ASSIGN_OR_RETURN(
+        EntryResult result,
+        BenchmarkEntry(path, function,
+                       absl::GetFlag(FLAGS_dslx_stdlib_path), dslx_paths));
+    results.push_back(std::move(result));
+  }
+
+  std::string json = ResultsToJson(results);
+  if (absl::GetFlag(FLAGS_json_output).empty()) {
+    std::cout << json;
+    return absl::OkStatus();
+  }
+  return SetFileContents(absl::GetFlag(FLAGS_json_output), json);
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+  XLS_QCHECK_GT(absl::GetFlag(FLAGS_pipeline_stages), 0)
+      << "--pipeline_stages must be positive";
+  XLS_QCHECK_GE(absl::GetFlag(FLAGS_jit_run_count), 0)
+      << "--jit_run_count must not be negative";
+  return xls::ExitStatus(xls::RealMain(positional_arguments));
+}
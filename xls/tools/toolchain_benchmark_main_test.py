@@ -0,0 +1,65 @@
+#
+# Copyright 2023 The XLS Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Tests for xls.tools.toolchain_benchmark_main."""
+
+import json
+import subprocess
+
+from xls.common import runfiles
+from xls.common import test_base
+
+TOOLCHAIN_BENCHMARK_MAIN_PATH = runfiles.get_path(
+    'xls/tools/toolchain_benchmark_main')
+
+ADD_DSLX = """fn add(x: u32, y: u32) -> u32 {
+  x + y
+}
+"""
+
+EXPECTED_STAGES = [
+    'parse', 'typecheck', 'ir_convert', 'opt', 'schedule', 'codegen',
+    'jit_compile', 'jit_run'
+]
+
+
+class ToolchainBenchmarkMainTest(test_base.TestCase):
+
+  def test_reports_every_stage(self):
+    dslx_file = self.create_tempfile(file_path='add.x', content=ADD_DSLX)
+    json_file = self.create_tempfile()
+    subprocess.check_call([
+        TOOLCHAIN_BENCHMARK_MAIN_PATH, '--pipeline_stages=2',
+        '--jit_run_count=10', f'--json_output={json_file.full_path}',
+        f'{dslx_file.full_path}:add'
+    ])
+    results = json.loads(json_file.read_text())
+    self.assertLen(results['benchmarks'], 1)
+    benchmark = results['benchmarks'][0]
+    self.assertEqual(benchmark['function'], 'add')
+    self.assertEqual([s['stage'] for s in benchmark['stages']],
+                     EXPECTED_STAGES)
+    for stage in benchmark['stages']:
+      self.assertGreaterEqual(stage['time_us'], 0)
+
+  def test_malformed_spec(self):
+    comp = subprocess.run([TOOLCHAIN_BENCHMARK_MAIN_PATH, 'no_function.x'],
+                          stderr=subprocess.PIPE,
+                          check=False)
+    self.assertNotEqual(comp.returncode, 0)
+    self.assertIn('<DSLX file>:<function>', comp.stderr.decode('utf-8'))
+
+
+if __name__ == '__main__':
+  test_base.main()